@@ -1339,6 +1339,43 @@ class Cursor(Structure):
             children)
         return iter(children)
 
+    def get_descendants(self):
+        """Return an iterator over (cursor, parent) pairs for all the
+        descendants of this cursor, in preorder.
+
+        The descendants are retrieved from libclang in a single call, which is
+        much cheaper than recursing through get_children() for large trees.
+        """
+        cursors_memory = POINTER(Cursor)()
+        parents_memory = POINTER(c_int)()
+        cursors_count = c_uint()
+
+        conf.lib.clang_getCursorDescendants(self, byref(cursors_memory),
+                byref(parents_memory), byref(cursors_count))
+
+        count = int(cursors_count.value)
+        if count < 1:
+            return iter([])
+
+        cursors_array = cast(cursors_memory, POINTER(Cursor * count)).contents
+        parents_array = cast(parents_memory, POINTER(c_int * count)).contents
+
+        descendants = []
+        for i in xrange(0, count):
+            cursor = Cursor.from_buffer_copy(cursors_array[i])
+            # Create reference to TU so it isn't GC'd before Cursor.
+            cursor._tu = self._tu
+            parent_index = parents_array[i]
+            if parent_index < 0:
+                parent = self
+            else:
+                parent = descendants[parent_index][0]
+            descendants.append((cursor, parent))
+
+        conf.lib.clang_disposeCursorDescendants(cursors_memory,
+                parents_memory)
+        return iter(descendants)
+
     def get_tokens(self):
         """Obtain Token instances formulating that compose this Cursor.
 
@@ -2645,6 +2682,9 @@ functionList = [
   ("clang_disposeCodeCompleteResults",
    [CodeCompletionResults]),
 
+  ("clang_disposeCursorDescendants",
+   [POINTER(Cursor), POINTER(c_int)]),
+
 # ("clang_disposeCXTUResourceUsage",
 #  [CXTUResourceUsage]),
 
@@ -2744,6 +2784,10 @@ functionList = [
    Cursor,
    Cursor.from_result),
 
+  ("clang_getCursorDescendants",
+   [Cursor, POINTER(POINTER(Cursor)), POINTER(POINTER(c_int)),
+    POINTER(c_uint)]),
+
   ("clang_getCursorDisplayName",
    [Cursor],
    _CXString,
@@ -73,6 +73,35 @@ def test_get_children():
     assert tu_nodes[2].displayname == 'f0(int, int)'
     assert tu_nodes[2].is_definition() == True
 
+def test_get_descendants():
+    tu = get_tu(kInput)
+    s0 = get_cursor(tu, 's0')
+    assert s0 is not None
+
+    descendants = list(s0.get_descendants())
+    assert len(descendants) == 2
+    assert descendants[0][0].kind == CursorKind.FIELD_DECL
+    assert descendants[0][0].spelling == 'a'
+    assert descendants[0][1] == s0
+    assert descendants[1][0].spelling == 'b'
+    assert descendants[1][0].translation_unit is not None
+
+    # The descendants are the cursors of a recursive get_children().
+    def preorder(cursor):
+        for child in cursor.get_children():
+            yield child
+            for descendant in preorder(child):
+                yield descendant
+
+    f0 = get_cursor(tu, 'f0')
+    expected = list(preorder(f0))
+    descendants = list(f0.get_descendants())
+    assert len(descendants) == len(expected)
+    for (cursor, parent), child in zip(descendants, expected):
+        assert cursor == child
+        assert cursor.kind == child.kind
+        assert parent == f0 or parent in [c for c, p in descendants]
+
 def test_references():
     """Ensure that references to TranslationUnit are kept."""
     tu = get_tu('int x;')
@@ -32,7 +32,7 @@
  * compatible, thus CINDEX_VERSION_MAJOR is expected to remain stable.
  */
 #define CINDEX_VERSION_MAJOR 0
-#define CINDEX_VERSION_MINOR 19
+#define CINDEX_VERSION_MINOR 26
 
 #define CINDEX_VERSION_ENCODE(major, minor) ( \
       ((major) * 10000)                       \
@@ -205,6 +205,15 @@ typedef struct CXVersion {
  * This process of creating the 'pch', loading it separately, and using it (via
  * -include-pch) allows 'excludeDeclsFromPCH' to remove redundant callbacks
  * (which gives the indexer the same performance benefit as the compiler).
+ *
+ * Threads may use libclang concurrently as long as they work on different
+ * translation units, whether or not those come from the same index; the state
+ * that translation units share, such as the index options and the shared
+ * precompiled preambles, is protected by locks. A translation unit, and
+ * everything obtained from it (cursors, tokens, diagnostics, code-completion
+ * results), must only be used by one thread at a time. As a safety net, the
+ * operations that parse, reparse, save, complete, tokenize or look up cursors
+ * in a translation unit wait for each other, but the other operations do not.
  */
 CINDEX_LINKAGE CXIndex clang_createIndex(int excludeDeclarationsFromPCH,
                                          int displayDiagnostics);
@@ -274,6 +283,21 @@ CINDEX_LINKAGE void clang_CXIndex_setGlobalOptions(CXIndex, unsigned options);
  */
 CINDEX_LINKAGE unsigned clang_CXIndex_getGlobalOptions(CXIndex);
 
+/**
+ * \brief Sets the amount of memory, in bytes, that the translation units of
+ * an index may use before the least recently used ones are hibernated (see
+ * \c clang_hibernateTranslationUnit()). Zero, the default, means no limit.
+ *
+ * The budget is enforced whenever a translation unit of the index is
+ * created, reparsed or reloaded, and never hibernates that translation unit
+ * itself. Since hibernating invalidates the cursors and other objects of the
+ * translation unit, a client that sets a budget should only hold on to those
+ * of the translation unit that it is using, and should not use the
+ * translation units of the index from several threads at once.
+ */
+CINDEX_LINKAGE void clang_CXIndex_setMemoryBudget(CXIndex,
+                                                  unsigned long long bytes);
+
 /**
  * \defgroup CINDEX_FILES File manipulation routines
  *
@@ -1147,7 +1171,50 @@ enum CXTranslationUnit_Flags {
    * included into the set of code completions returned from this translation
    * unit.
    */
-  CXTranslationUnit_IncludeBriefCommentsInCodeCompletion = 0x80
+  CXTranslationUnit_IncludeBriefCommentsInCodeCompletion = 0x80,
+
+  /**
+   * \brief Used to indicate that, when a file included by the precompiled
+   * preamble changes, the preamble should be rebuilt on another thread.
+   *
+   * Until the new preamble is ready, reparsing and code completion go on
+   * using the old one, which may no longer match the files it includes, so
+   * that they do not wait for the rebuild. The first reparse after the
+   * rebuild finishes starts using the new preamble. Use
+   * \c clang_setPreambleRebuiltCallback() to learn when that is.
+   *
+   * This option only has an effect together with
+   * \c CXTranslationUnit_PrecompiledPreamble.
+   */
+  CXTranslationUnit_BackgroundPreambleRebuild = 0x100,
+
+  /**
+   * \brief Used to indicate that reparsing should reuse the declarations of
+   * the main file that precede the first edit.
+   *
+   * The precompiled preamble is extended to cover the top-level declarations
+   * of the main file that were left unchanged since the previous parse, so
+   * that reparsing only has to parse the file from the first edit onward.
+   * Editing one of those declarations rebuilds the preamble. The cursors of
+   * declarations reused this way keep their usual locations and extents.
+   *
+   * This option only has an effect together with
+   * \c CXTranslationUnit_PrecompiledPreamble, and not for Objective-C.
+   */
+  CXTranslationUnit_IncrementalReparse = 0x200,
+
+  /**
+   * \brief Used to indicate that the precompiled preamble may be shared with
+   * the other translation units of the process that parse the same main
+   * file, with the same preamble, unsaved files and options.
+   *
+   * A translation unit that finds such a preamble uses it instead of
+   * precompiling its own, even on its first parse.
+   *
+   * This option only has an effect together with
+   * \c CXTranslationUnit_PrecompiledPreamble.
+   */
+  CXTranslationUnit_SharePreamble = 0x400
 };
 
 /**
@@ -1375,6 +1442,56 @@ CINDEX_LINKAGE int clang_reparseTranslationUnit(CXTranslationUnit TU,
                                           struct CXUnsavedFile *unsaved_files,
                                                 unsigned options);
 
+/**
+ * \brief Called when a precompiled preamble rebuilt in the background for
+ * \p TU is ready.
+ *
+ * \param succeeded Non-zero if a new preamble was built, in which case the
+ * next call to \c clang_reparseTranslationUnit() will start using it.
+ *
+ * The callback is invoked on the thread that built the preamble, so it
+ * should do no more than arrange for \p TU to be reparsed.
+ */
+typedef void (*CXPreambleRebuiltCallback)(CXTranslationUnit TU,
+                                          int succeeded,
+                                          CXClientData client_data);
+
+/**
+ * \brief Set the function to call when a precompiled preamble rebuilt in
+ * the background for \p TU is ready.
+ *
+ * See \c CXTranslationUnit_BackgroundPreambleRebuild. The callback is only
+ * invoked for rebuilds started after this call; pass a NULL callback to stop
+ * being notified.
+ */
+CINDEX_LINKAGE void
+clang_setPreambleRebuiltCallback(CXTranslationUnit TU,
+                                 CXPreambleRebuiltCallback callback,
+                                 CXClientData client_data);
+
+/**
+ * \brief Release most of the memory used by an idle translation unit until
+ * it is used again.
+ *
+ * The AST of the translation unit is written to a temporary file, and the
+ * AST, preprocessor state and source buffers are released. The next function
+ * that uses the translation unit reloads the AST from that file first, after
+ * which the translation unit behaves as one loaded with
+ * \c clang_createTranslationUnit(), with the same diagnostics, until it is
+ * reparsed. If a file that it was parsed from has changed in the meantime,
+ * it is parsed again instead. Reparsing a hibernating translation unit does
+ * not reload it.
+ *
+ * As with \c clang_reparseTranslationUnit(), all cursors, source locations,
+ * diagnostics and other objects that refer to the translation unit become
+ * invalid.
+ *
+ * \returns 0 if the translation unit hibernated, or non-zero if it cannot:
+ * only translation units parsed from source can, and not while another
+ * thread is using them.
+ */
+CINDEX_LINKAGE int clang_hibernateTranslationUnit(CXTranslationUnit TU);
+
 /**
   * \brief Categorizes how memory is being used by a translation unit.
   */
@@ -2066,7 +2183,11 @@ enum CXCursorKind {
    */
   CXCursor_OMPParallelDirective          = 232,
 
-  CXCursor_LastStmt                      = CXCursor_OMPParallelDirective,
+  /** \brief OpenMP simd directive.
+   */
+  CXCursor_OMPSimdDirective              = 233,
+
+  CXCursor_LastStmt                      = CXCursor_OMPSimdDirective,
 
   /**
    * \brief Cursor that represents the translation unit itself.
@@ -3167,6 +3288,35 @@ unsigned clang_visitChildrenWithBlock(CXCursor parent,
 #  endif
 #endif
 
+/**
+ * \brief Retrieve all the descendants of a cursor in a single call.
+ *
+ * This performs the traversal that clang_visitChildren() performs when the
+ * visitor always returns \c CXChildVisit_Recurse, without calling back into
+ * the client for each cursor, which is expensive for clients such as the
+ * bindings of other languages.
+ *
+ * \param parent the cursor whose descendants are retrieved.
+ *
+ * \param cursors set to an array of the descendants of \p parent, in
+ * preorder, which must be freed with clang_disposeCursorDescendants().
+ *
+ * \param parents set to an array holding, for each cursor of \p cursors, the
+ * index in \p cursors of its parent, or -1 if its parent is \p parent.
+ *
+ * \param num_cursors set to the number of descendants.
+ */
+CINDEX_LINKAGE void clang_getCursorDescendants(CXCursor parent,
+                                               CXCursor **cursors,
+                                               int **parents,
+                                               unsigned *num_cursors);
+
+/**
+ * \brief Free the arrays retrieved by clang_getCursorDescendants().
+ */
+CINDEX_LINKAGE void clang_disposeCursorDescendants(CXCursor *cursors,
+                                                   int *parents);
+
 /**
  * @}
  */
@@ -4735,7 +4885,23 @@ enum CXCodeComplete_Flags {
    * \brief Whether to include brief documentation within the set of code
    * completions returned.
    */
-  CXCodeComplete_IncludeBriefComments = 0x04
+  CXCodeComplete_IncludeBriefComments = 0x04,
+
+  /**
+   * \brief Whether to keep the complete set of results in the translation
+   * unit, so that a later completion at the same location, with the same
+   * options and the same text before the completion point, reuses it instead
+   * of parsing again.
+   *
+   * This is meant for completing while the user is typing an identifier:
+   * each completion is requested at the start of the identifier with a
+   * longer filter (see \c clang_codeCompleteAtWithFilter), and the results
+   * that matched the previous filter are all that need to be filtered again.
+   * Results are only reused when the file being completed in is one of the
+   * unsaved files, and until the translation unit is reparsed or a completion
+   * produces diagnostics.
+   */
+  CXCodeComplete_ReuseResults = 0x08
 };
 
 /**
@@ -4952,6 +5118,45 @@ CXCodeCompleteResults *clang_codeCompleteAt(CXTranslationUnit TU,
                                             unsigned num_unsaved_files,
                                             unsigned options);
 
+/**
+ * \brief Perform code completion at a given location in a translation unit,
+ * returning only the best results for the text that the user has typed so
+ * far.
+ *
+ * This behaves like #clang_codeCompleteAt, except that the results are
+ * filtered and ranked before their completion strings are built, which is
+ * much cheaper than building all of them when there are many results and the
+ * client only shows a few.
+ *
+ * A result passes the filter if the text it would insert starts with
+ * \p filter, ignoring case, or contains the characters of \p filter in order,
+ * ignoring case. The results are ranked first by how well they match (a
+ * prefix with the same case, then a prefix in any case, then the other
+ * matches), then by priority, then by their typed text, and only the best
+ * \p max_results are kept, in rank order. Overload candidates are neither
+ * filtered nor counted.
+ *
+ * \param filter The text typed so far at the completion location, or NULL to
+ * keep all results.
+ *
+ * \param max_results The maximum number of results to return, or 0 for no
+ * limit.
+ *
+ * The rest of the parameters and the result are the same as for
+ * #clang_codeCompleteAt.
+ */
+CINDEX_LINKAGE
+CXCodeCompleteResults *
+clang_codeCompleteAtWithFilter(CXTranslationUnit TU,
+                               const char *complete_filename,
+                               unsigned complete_line,
+                               unsigned complete_column,
+                               struct CXUnsavedFile *unsaved_files,
+                               unsigned num_unsaved_files,
+                               unsigned options,
+                               const char *filter,
+                               unsigned max_results);
+
 /**
  * \brief Sort the code-completion results in case-insensitive alphabetical 
  * order.
@@ -5709,9 +5914,19 @@ typedef enum {
   /**
    * \brief Skip a function/method body that was already parsed during an
    * indexing session assosiated with a \c CXIndexAction object.
-   * Bodies in system headers are always skipped.
+   * Bodies in system headers are always skipped. If the action has a unit
+   * index directory (see #clang_IndexAction_setUnitIndexDirectory), bodies
+   * parsed by the units recorded there count as parsed as well.
+   */
+  CXIndexOpt_SkipParsedBodiesInSession = 0x10,
+
+  /**
+   * \brief The USRs of entities given to the indexer callbacks are interned:
+   * they remain valid until indexing of the translation unit is finished, and
+   * equal USRs are given as the same pointer, so they can be compared and
+   * hashed as pointers. Otherwise a USR is only valid during the callback.
    */
-  CXIndexOpt_SkipParsedBodiesInSession = 0x10
+  CXIndexOpt_InternUSRs = 0x20
 
 } CXIndexOptFlags;
 
@@ -5752,6 +5967,63 @@ CINDEX_LINKAGE int clang_indexSourceFile(CXIndexAction,
                                          CXTranslationUnit *out_TU,
                                          unsigned TU_options);
 
+/**
+ * \brief Describes one translation unit to be indexed by
+ * #clang_indexSourceFiles.
+ */
+typedef struct {
+  /**
+   * \brief The directory that relative paths in the command line are
+   * relative to, or NULL for the current directory.
+   */
+  const char *working_directory;
+
+  /**
+   * \brief The source file to index, or NULL if the command line names it.
+   */
+  const char *source_filename;
+
+  /**
+   * \brief The command-line arguments, as for #clang_indexSourceFile, which
+   * must not include the name of the compiler.
+   */
+  const char * const *command_line_args;
+  int num_command_line_args;
+} CXIndexSourceFileCommand;
+
+/**
+ * \brief Index the translation units described by \p commands, as
+ * #clang_indexSourceFile would one after another with the same \p action,
+ * but on up to \p num_threads threads at once.
+ *
+ * Each thread takes the next translation unit to index as soon as it has
+ * finished the previous one. The callbacks are invoked from all of the
+ * threads concurrently, with the same \p client_data, so they must be safe to
+ * call concurrently.
+ *
+ * With \c CXIndexOpt_SkipParsedBodiesInSession, a function body is skipped
+ * as soon as another translation unit has started to parse the region of the
+ * header that it is in, even if that translation unit is still being
+ * indexed on another thread.
+ *
+ * \param num_threads The maximum number of threads to use, or 0 for one per
+ * hardware thread.
+ *
+ * \returns The number of translation units that could not be indexed.
+ *
+ * The rest of the parameters are the same as #clang_indexSourceFile.
+ */
+CINDEX_LINKAGE unsigned
+clang_indexSourceFiles(CXIndexAction,
+                       CXClientData client_data,
+                       IndexerCallbacks *index_callbacks,
+                       unsigned index_callbacks_size,
+                       unsigned index_options,
+                       const CXIndexSourceFileCommand *commands,
+                       unsigned num_commands,
+                       unsigned num_threads,
+                       unsigned TU_options);
+
 /**
  * \brief Index the given translation unit via callbacks implemented through
  * #IndexerCallbacks.
@@ -5796,6 +6068,89 @@ CINDEX_LINKAGE void clang_indexLoc_getFileLocation(CXIdxLoc loc,
 CINDEX_LINKAGE
 CXSourceLocation clang_indexLoc_getCXSourceLocation(CXIdxLoc loc);
 
+/**
+ * \brief Make #clang_indexSourceFile write a unit index for every translation
+ * unit that it subsequently indexes with \p action into the directory
+ * \p path, which is created if necessary.
+ *
+ * A unit index is a compact file, which can be memory-mapped, recording the
+ * USRs of the entities that the translation unit declares and references,
+ * with the location and role of each occurrence, and the translation unit's
+ * include graph. The unit index of a main file replaces the one written for
+ * it before. Unit indexes can be combined into a project index with
+ * #clang_mergeUnitIndexes and queried with #clang_UnitIndex_findOccurrences
+ * and #clang_UnitIndex_visitInclusions.
+ *
+ * With \c CXIndexOpt_SkipParsedBodiesInSession, the unit indexes also record
+ * which regions of headers had their function bodies parsed, and bodies that
+ * the other units in the directory parsed are skipped, as if they had been
+ * parsed earlier in the same session.
+ *
+ * \returns 0 on success, non-zero if the directory could not be created.
+ */
+CINDEX_LINKAGE int clang_IndexAction_setUnitIndexDirectory(CXIndexAction action,
+                                                           const char *path);
+
+/**
+ * \brief Combine all the unit indexes in the directory \p unit_dir into the
+ * project index \p output_path, which has the same format as a unit index.
+ *
+ * \returns 0 on success, non-zero if the project index could not be written.
+ * Files in the directory that are not valid unit indexes are ignored.
+ */
+CINDEX_LINKAGE int clang_mergeUnitIndexes(const char *unit_dir,
+                                          const char *output_path);
+
+/**
+ * \brief The role of an occurrence of an entity recorded in a unit index.
+ */
+typedef enum {
+  CXUnitIndexRole_Declaration = 1,
+  CXUnitIndexRole_Definition = 2,
+  CXUnitIndexRole_Reference = 3
+} CXUnitIndexRole;
+
+/**
+ * \brief Visitor invoked for each occurrence found by
+ * #clang_UnitIndex_findOccurrences.
+ */
+typedef void (*CXUnitIndexOccurrenceVisitor)(CXClientData client_data,
+                                             const char *file,
+                                             unsigned line, unsigned column,
+                                             CXUnitIndexRole role);
+
+/**
+ * \brief Visit the occurrences of the entity with the given USR that the unit
+ * or project index \p index_path records, in file and line order.
+ *
+ * \returns 0 on success, including when there are no occurrences, and
+ * non-zero if \p index_path is not a valid index.
+ */
+CINDEX_LINKAGE int clang_UnitIndex_findOccurrences(const char *index_path,
+                                                const char *usr,
+                                                CXUnitIndexOccurrenceVisitor visitor,
+                                                CXClientData client_data);
+
+/**
+ * \brief Visitor invoked for each edge of the include graph visited by
+ * #clang_UnitIndex_visitInclusions. \p line is the line of the inclusion
+ * directive in \p includer.
+ */
+typedef void (*CXUnitIndexInclusionVisitor)(CXClientData client_data,
+                                            const char *includer,
+                                            const char *included,
+                                            unsigned line);
+
+/**
+ * \brief Visit the edges of the include graph that the unit or project index
+ * \p index_path records.
+ *
+ * \returns 0 on success, non-zero if \p index_path is not a valid index.
+ */
+CINDEX_LINKAGE int clang_UnitIndex_visitInclusions(const char *index_path,
+                                                CXUnitIndexInclusionVisitor visitor,
+                                                CXClientData client_data);
+
 /**
  * @}
  */
@@ -54,6 +54,10 @@ public:
 
   void remap(StringRef filePath, llvm::MemoryBuffer *memBuf);
 
+  /// \brief Returns true if \p filePath, or the original file it overrides,
+  /// is remapped.
+  bool hasMapping(StringRef filePath);
+
   void applyMappings(PreprocessorOptions &PPOpts) const;
 
   void transferMappingsAndClear(PreprocessorOptions &PPOpts);
@@ -32,6 +32,7 @@
 #include "clang/Basic/PartialDiagnostic.h"
 #include "clang/Basic/VersionTuple.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/FoldingSet.h"
 #include "llvm/ADT/IntrusiveRefCntPtr.h"
 #include "llvm/ADT/OwningPtr.h"
@@ -59,6 +60,9 @@ namespace clang {
   class SelectorTable;
   class TargetInfo;
   class CXXABI;
+  class CXXBaseSubobjects;
+  class ConstexprBytecode;
+  class ConstexprCallCache;
   // Decls
   class MangleContext;
   class ObjCIvarDecl;
@@ -149,6 +153,14 @@ class ASTContext : public RefCountedBase<ASTContext> {
 
   /// \brief A cache mapping from CXXRecordDecls to key functions.
   llvm::DenseMap<const CXXRecordDecl*, const CXXMethodDecl*> KeyFunctions;
+
+  /// \brief A cache mapping from the canonical declarations of complete
+  /// classes to their base class subobjects.
+  ///
+  /// This is lazily created. The bases of a class cannot change once it is
+  /// complete, so entries are never invalidated.
+  mutable llvm::DenseMap<const CXXRecordDecl*, const CXXBaseSubobjects*>
+    BaseSubobjects;
   
   /// \brief Mapping from ObjCContainers to their ObjCImplementations.
   llvm::DenseMap<ObjCContainerDecl*, ObjCImplDecl*> ObjCImpls;
@@ -165,6 +177,11 @@ class ASTContext : public RefCountedBase<ASTContext> {
   llvm::DenseMap<const FunctionDecl*, FunctionDecl*>
     ClassScopeSpecializationPattern;
 
+  /// \brief Mapping from the few functions that declare something other than
+  /// their parameters in their prototype scope to those declarations.
+  llvm::DenseMap<const FunctionDecl*, ArrayRef<NamedDecl *> >
+    DeclsInPrototypeScope;
+
   /// \brief Mapping from materialized temporaries with static storage duration
   /// that appear in constant initializers to their evaluated values.
   llvm::DenseMap<const MaterializeTemporaryExpr*, APValue>
@@ -390,6 +407,12 @@ private:
   OwningPtr<CXXABI> ABI;
   CXXABI *createCXXABI(const TargetInfo &T);
 
+  /// \brief The constexpr functions compiled to bytecode, created on demand.
+  OwningPtr<ConstexprBytecode> ConstexprInterp;
+
+  /// \brief The values of constexpr calls evaluated so far, created on demand.
+  OwningPtr<ConstexprCallCache> ConstexprCalls;
+
   /// \brief The logical -> physical address space map.
   const LangAS::Map *AddrSpaceMap;
 
@@ -412,30 +435,15 @@ public:
   /// \brief Contains parents of a node.
   typedef llvm::SmallVector<ast_type_traits::DynTypedNode, 1> ParentVector;
 
-  /// \brief Maps from a node to its parents.
-  typedef llvm::DenseMap<const void *, ParentVector> ParentMap;
-
   /// \brief Returns the parents of the given node.
   ///
-  /// Note that this will lazily compute the parents of all nodes
-  /// and store them for later retrieval. Thus, the first call is O(n)
-  /// in the number of AST nodes.
-  ///
-  /// Caveats and FIXMEs:
-  /// Calculating the parent map over all AST nodes will need to load the
-  /// full AST. This can be undesirable in the case where the full AST is
-  /// expensive to create (for example, when using precompiled header
-  /// preambles). Thus, there are good opportunities for optimization here.
-  /// One idea is to walk the given node downwards, looking for references
-  /// to declaration contexts - once a declaration context is found, compute
-  /// the parent map for the declaration context; if that can satisfy the
-  /// request, loading the whole AST can be avoided. Note that this is made
-  /// more complex by statements in templates having multiple parents - those
-  /// problems can be solved by building closure over the templated parts of
-  /// the AST, which also avoids touching large parts of the AST.
-  /// Additionally, we will want to add an interface to already give a hint
-  /// where to search for the parents, for example when looking at a statement
-  /// inside a certain function.
+  /// The parents are computed lazily, one top-level declaration of the
+  /// translation unit at a time: the first query about a node inside a
+  /// top-level declaration traverses only that declaration. Nodes that can be
+  /// reached from more than one top-level declaration, which happens with
+  /// template instantiations and out-of-line definitions, make the whole
+  /// translation unit be traversed, as does asking for the parents of a node
+  /// that has none.
   ///
   /// 'NodeT' can be one of Decl, Stmt, Type, TypeLoc,
   /// NestedNameSpecifier or NestedNameSpecifierLoc.
@@ -446,6 +454,10 @@ public:
 
   ParentVector getParents(const ast_type_traits::DynTypedNode &Node);
 
+  /// \brief Computes the parents of every node now, so that later calls to
+  /// \c getParents only read them, e.g. from several threads at once.
+  void buildParentMap();
+
   const clang::PrintingPolicy &getPrintingPolicy() const {
     return PrintingPolicy;
   }
@@ -486,6 +498,14 @@ public:
 
   DiagnosticsEngine &getDiagnostics() const;
 
+  /// \brief Returns the bytecode of the constexpr functions compiled so far,
+  /// which evaluates calls to them with -fconstexpr-bytecode.
+  ConstexprBytecode &getConstexprBytecode();
+
+  /// \brief Returns the values of the constexpr function calls evaluated so
+  /// far, which the constant evaluator reuses.
+  ConstexprCallCache &getConstexprCallCache();
+
   FullSourceLoc getFullLoc(SourceLocation Loc) const {
     return FullSourceLoc(Loc,SourceMgr);
   }
@@ -493,8 +513,9 @@ public:
   /// \brief All comments in this translation unit.
   RawCommentList Comments;
 
-  /// \brief True if comments are already loaded from ExternalASTSource.
-  mutable bool CommentsLoaded;
+  /// \brief The files loaded from an ExternalASTSource whose comments have
+  /// already been read from it.
+  mutable llvm::DenseSet<FileID> CommentsLoaded;
 
   class RawCommentAndCacheFlags {
   public:
@@ -565,6 +586,10 @@ public:
   /// without looking into cache.
   RawComment *getRawCommentForDeclNoCache(const Decl *D) const;
 
+  /// \brief Return the comments in the given file, reading them from the
+  /// external source the first time they are needed.
+  ArrayRef<RawComment *> getRawCommentsInFile(FileID File) const;
+
 public:
   RawCommentList &getRawCommentList() {
     return Comments;
@@ -630,6 +655,14 @@ public:
   void setClassScopeSpecializationPattern(FunctionDecl *FD,
                                           FunctionDecl *Pattern);
 
+  /// \brief Returns the declarations, other than parameters, in the
+  /// prototype scope of \p FD. Use FunctionDecl::getDeclsInPrototypeScope,
+  /// which only looks them up for the functions that have some.
+  ArrayRef<NamedDecl *> getDeclsInPrototypeScope(const FunctionDecl *FD) const;
+
+  void setDeclsInPrototypeScope(const FunctionDecl *FD,
+                                ArrayRef<NamedDecl *> Decls);
+
   /// \brief Note that the static data member \p Inst is an instantiation of
   /// the static data member template \p Tmpl of a class template.
   void setInstantiatedFromStaticDataMember(VarDecl *Inst, VarDecl *Tmpl,
@@ -1668,6 +1701,13 @@ public:
   /// \param method should be the declaration from the class definition
   void setNonKeyFunction(const CXXMethodDecl *method);
 
+  /// \brief Get the base class subobjects of the given class, computing
+  /// them the first time they are asked for.
+  ///
+  /// Returns null if the class is not complete or is a dependent context,
+  /// since its bases are not fixed yet.
+  const CXXBaseSubobjects *getBaseSubobjects(const CXXRecordDecl *RD) const;
+
   /// Get the offset of a FieldDecl or IndirectFieldDecl, in bits.
   uint64_t getFieldOffset(const ValueDecl *FD) const;
 
@@ -2235,7 +2275,10 @@ private:
   friend class DeclarationNameTable;
   void ReleaseDeclContextMaps();
 
-  llvm::OwningPtr<ParentMap> AllParents;
+  /// \brief The parents of the nodes of the top-level declarations that
+  /// have been traversed so far.
+  class ParentIndex;
+  llvm::OwningPtr<ParentIndex> Parents;
 };
 
 /// \brief Utility function for constructing a nullary selector.
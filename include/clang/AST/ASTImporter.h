@@ -20,6 +20,7 @@
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
 
 namespace clang {
   class ASTContext;
@@ -33,11 +34,50 @@ namespace clang {
   class Stmt;
   class TypeSourceInfo;
   
+  /// \brief The declarations that importers into one AST context have
+  /// produced, keyed by where and how they were written in the contexts they
+  /// were imported from.
+  ///
+  /// Importers that share a cache, such as the importers for each of the AST
+  /// files merged into one context, map a declaration that another file has
+  /// already brought in straight to the earlier result. They would otherwise
+  /// look it up again and check it for structural equivalence with the
+  /// declaration they find.
+  class ImportedDeclCache {
+    ASTContext &ToContext;
+    llvm::StringMap<Decl *> Decls;
+    unsigned NumHits;
+
+  public:
+    explicit ImportedDeclCache(ASTContext &ToContext)
+      : ToContext(ToContext), NumHits(0) { }
+
+    /// \brief Retrieve the context the cached declarations belong to.
+    ASTContext &getToContext() const { return ToContext; }
+
+    /// \brief Find the declaration imported under the given key, if any.
+    Decl *lookup(StringRef Key) {
+      llvm::StringMap<Decl *>::iterator Pos = Decls.find(Key);
+      if (Pos == Decls.end())
+        return 0;
+      ++NumHits;
+      return Pos->second;
+    }
+
+    /// \brief Note that the declaration with the given key was imported as
+    /// \p To.
+    void insert(StringRef Key, Decl *To) { Decls[Key] = To; }
+
+    /// \brief The number of declarations imported from the cache.
+    unsigned getNumHits() const { return NumHits; }
+  };
+
   /// \brief Imports selected nodes from one AST context into another context,
   /// merging AST nodes where appropriate.
   class ASTImporter {
   public:
     typedef llvm::DenseSet<std::pair<Decl *, Decl *> > NonEquivalentDeclSet;
+    typedef llvm::DenseSet<std::pair<Decl *, Decl *> > EquivalentDeclSet;
     
   private:
     /// \brief The contexts we're importing to and from.
@@ -75,6 +115,15 @@ namespace clang {
     /// \brief Declaration (from, to) pairs that are known not to be equivalent
     /// (which we have already complained about).
     NonEquivalentDeclSet NonEquivalentDecls;
+
+    /// \brief Declaration (from, to) pairs that are known to be equivalent.
+    EquivalentDeclSet EquivalentDecls;
+
+    /// \brief The declarations imported by the importers we share a cache
+    /// with, or null.
+    ImportedDeclCache *SharedDecls;
+
+    bool getSharedDeclKey(Decl *D, SmallVectorImpl<char> &Key);
     
   public:
     /// \brief Create a new AST importer.
@@ -90,9 +139,13 @@ namespace clang {
     /// \param MinimalImport If true, the importer will attempt to import
     /// as little as it can, e.g., by importing declarations as forward
     /// declarations that can be completed at a later point.
+    ///
+    /// \param SharedDecls If non-null, the declarations that other importers
+    /// into \p ToContext have already imported, which this importer will
+    /// reuse and add to.
     ASTImporter(ASTContext &ToContext, FileManager &ToFileManager,
                 ASTContext &FromContext, FileManager &FromFileManager,
-                bool MinimalImport);
+                bool MinimalImport, ImportedDeclCache *SharedDecls = 0);
     
     virtual ~ASTImporter();
     
@@ -259,6 +312,9 @@ namespace clang {
     /// \brief Return the set of declarations that we know are not equivalent.
     NonEquivalentDeclSet &getNonEquivalentDecls() { return NonEquivalentDecls; }
 
+    /// \brief Return the set of declarations that we know are equivalent.
+    EquivalentDeclSet &getEquivalentDecls() { return EquivalentDecls; }
+
     /// \brief Called for ObjCInterfaceDecl, ObjCProtocolDecl, and TagDecl.
     /// Mark the Decl as complete, filling it in as much as possible.
     ///
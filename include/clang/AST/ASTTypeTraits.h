@@ -50,6 +50,11 @@ public:
   /// \brief Returns \c true if \c this is a base kind of (or same as) \c Other.
   bool isBaseOf(ASTNodeKind Other) const;
 
+  /// \brief Strict weak ordering for ASTNodeKind.
+  bool operator<(const ASTNodeKind &Other) const {
+    return KindId < Other.KindId;
+  }
+
   /// \brief String representation of the kind.
   StringRef asStringRef() const;
 
@@ -161,6 +166,9 @@ public:
     return BaseConverter<T>::get(NodeKind, Storage.buffer);
   }
 
+  /// \brief Returns the kind of the node as it was passed to \c create().
+  ASTNodeKind getNodeKind() const { return NodeKind; }
+
   /// \brief Returns a pointer that identifies the stored AST node.
   ///
   /// Note that this is not supported by all AST nodes. For AST nodes
@@ -158,6 +158,7 @@ class CXXBasePaths {
   NamedDecl **DeclsFound;
   unsigned NumDeclsFound;
   
+  friend class CXXBaseSubobjects;
   friend class CXXRecordDecl;
   
   void ComputeDeclsFound();
@@ -229,6 +230,45 @@ public:
   void swap(CXXBasePaths &Other);
 };
 
+/// \brief The base class subobjects of a complete class, found by walking
+/// its whole inheritance graph once.
+///
+/// ASTContext::getBaseSubobjects caches these so that derivation queries on
+/// the same class do not walk its bases again.
+class CXXBaseSubobjects {
+  /// Records, for the canonical declaration of each base class, whether the
+  /// class has a virtual base class subobject of that type and how many
+  /// non-virtual ones it has, as in CXXBasePaths::ClassSubobjects.
+  typedef llvm::SmallDenseMap<const CXXRecordDecl *,
+                              std::pair<bool, unsigned>, 8> SubobjectMap;
+  SubobjectMap Subobjects;
+
+public:
+  explicit CXXBaseSubobjects(const CXXRecordDecl *Record);
+
+  /// \brief Determine whether the class has a subobject of type \p Base.
+  bool hasBase(const CXXRecordDecl *Base) const {
+    return Subobjects.count(Base->getCanonicalDecl());
+  }
+
+  /// \brief Determine whether the class has a virtual base class subobject
+  /// of type \p Base.
+  bool hasVirtualBase(const CXXRecordDecl *Base) const {
+    SubobjectMap::const_iterator Pos
+      = Subobjects.find(Base->getCanonicalDecl());
+    return Pos != Subobjects.end() && Pos->second.first;
+  }
+
+  /// \brief Determine the number of distinct subobjects of type \p Base.
+  unsigned getNumSubobjects(const CXXRecordDecl *Base) const {
+    SubobjectMap::const_iterator Pos
+      = Subobjects.find(Base->getCanonicalDecl());
+    if (Pos == Subobjects.end())
+      return 0;
+    return Pos->second.second + (Pos->second.first ? 1 : 0);
+  }
+};
+
 /// \brief Uniquely identifies a virtual method within a class
 /// hierarchy by the method itself and a class subobject number.
 struct UniqueVirtualMethod {
@@ -801,6 +801,9 @@ public:
   static void add(Kind k);
   static void EnableStatistics();
   static void PrintStats();
+  /// \brief The number of declarations of kind \p K created since the
+  /// statistics were enabled.
+  static unsigned getNumDeclsCreated(Kind K);
 
   /// isTemplateParameter - Determines whether this declaration is a
   /// template parameter.
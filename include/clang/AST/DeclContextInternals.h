@@ -217,6 +217,13 @@ class StoredDeclsMap
 public:
   static void DestroyAll(StoredDeclsMap *Map, bool Dependent);
 
+  /// \brief Make room for \p NumNames more names, so that adding many names
+  /// at once grows the table once instead of rehashing it again and again.
+  void reserve(unsigned NumNames) {
+    // The table grows when it becomes three quarters full.
+    resize((size() + NumNames) * 4 / 3 + 1);
+  }
+
 private:
   friend class ASTContext; // walks the chain deleting these
   friend class DeclContext;
@@ -0,0 +1,84 @@
+//===--- DeclHasher.h - Structural hashing of declarations ------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file defines the DeclHasher class, which computes hashes of the
+//  structure of declarations that do not depend on the ASTContext they live
+//  in.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_AST_DECLHASHER_H
+#define LLVM_CLANG_AST_DECLHASHER_H
+
+#include "clang/AST/DeclarationName.h"
+#include "clang/AST/TemplateName.h"
+#include "clang/AST/Type.h"
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/Support/DataTypes.h"
+
+namespace llvm {
+  class FoldingSetNodeID;
+}
+
+namespace clang {
+
+class ASTContext;
+class Decl;
+class NestedNameSpecifier;
+class Stmt;
+class TemplateParameterList;
+
+/// \brief Computes hashes of the structure of declarations, including the
+/// bodies of functions and the initializers of variables.
+///
+/// Unlike Stmt::Profile, the hash does not depend on the addresses of the
+/// declarations, types and names that are referenced: they are identified by
+/// their spelling. Equivalent declarations therefore have the same hash in
+/// different ASTContexts and in different runs of the compiler, which makes
+/// the hash suitable for detecting ODR violations between AST files, for
+/// detecting changes to a declaration and as part of build-cache keys.
+///
+/// The name of a hashed declaration is part of its hash, but the declaration
+/// context it lives in is not. Hashes are cached for the lifetime of the
+/// DeclHasher, so a DeclHasher should not outlive changes to the AST.
+class DeclHasher {
+  const ASTContext &Context;
+  llvm::DenseMap<const Decl *, uint64_t> Hashes;
+
+public:
+  explicit DeclHasher(const ASTContext &Context) : Context(Context) {}
+
+  const ASTContext &getASTContext() const { return Context; }
+
+  /// \brief Returns the hash of the structure of \p D.
+  uint64_t getHash(const Decl *D);
+
+  /// \brief Add the structure of \p D to \p ID.
+  void AddDecl(const Decl *D, llvm::FoldingSetNodeID &ID);
+
+  /// \brief Add \p S, which is part of a declaration, to \p ID.
+  void AddStmt(const Stmt *S, llvm::FoldingSetNodeID &ID);
+
+  /// \brief Add a reference to \p D, identified by its kind, qualified name
+  /// and type, to \p ID.
+  void AddDeclRef(const Decl *D, llvm::FoldingSetNodeID &ID);
+
+  void AddType(QualType T, llvm::FoldingSetNodeID &ID);
+  void AddName(DeclarationName Name, llvm::FoldingSetNodeID &ID);
+  void AddNestedNameSpecifier(NestedNameSpecifier *NNS,
+                              llvm::FoldingSetNodeID &ID);
+  void AddTemplateName(TemplateName Name, llvm::FoldingSetNodeID &ID);
+  void AddTemplateParameterList(const TemplateParameterList *Params,
+                                llvm::FoldingSetNodeID &ID);
+};
+
+} // end namespace clang
+
+#endif
@@ -187,8 +187,9 @@ public:
   /// \c ObjCInterfaceDecl::setExternallyCompleted().
   virtual void CompleteType(ObjCInterfaceDecl *Class) { }
 
-  /// \brief Loads comment ranges.
-  virtual void ReadComments() { }
+  /// \brief Loads the comment ranges in the given file, which was loaded
+  /// from this source.
+  virtual void ReadCommentsInFile(FileID File) { }
 
   /// \brief Notify ExternalASTSource that we started deserialization of
   /// a decl or type so until FinishedDeserializing is called there may be
@@ -284,6 +285,11 @@ protected:
   static DeclContextLookupResult
   SetNoExternalVisibleDeclsForName(const DeclContext *DC,
                                    DeclarationName Name);
+
+  /// \brief Make room in the lookup table of \p DC for \p NumNames more
+  /// names, before adding them with SetExternalVisibleDeclsForName.
+  static void ReserveExternalVisibleDecls(const DeclContext *DC,
+                                          unsigned NumNames);
 };
 
 /// \brief A lazy pointer to an AST node (of base type T) that resides
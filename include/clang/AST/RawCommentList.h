@@ -13,6 +13,8 @@
 #include "clang/Basic/CommentOptions.h"
 #include "clang/Basic/SourceManager.h"
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
+#include <vector>
 
 namespace clang {
 
@@ -188,7 +190,7 @@ public:
 };
 
 /// \brief This class represents all comments included in the translation unit,
-/// sorted in order of appearance in the translation unit.
+/// grouped by the file they appear in and sorted in order of appearance.
 class RawCommentList {
 public:
   RawCommentList(SourceManager &SourceMgr) :
@@ -196,22 +198,36 @@ public:
 
   void addComment(const RawComment &RC, llvm::BumpPtrAllocator &Allocator);
 
-  ArrayRef<RawComment *> getComments() const {
-    return Comments;
+  /// \brief Retrieve the comments in the given file, sorted in order of
+  /// appearance.
+  ArrayRef<RawComment *> getCommentsInFile(FileID File) const {
+    llvm::DenseMap<FileID, std::vector<RawComment *> >::const_iterator Pos
+      = FileComments.find(File);
+    if (Pos == FileComments.end())
+      return ArrayRef<RawComment *>();
+    return Pos->second;
+  }
+
+  /// \brief Retrieve the files that contain comments, in the order they were
+  /// entered.
+  void getFilesWithComments(SmallVectorImpl<FileID> &Files) const;
+
+  /// \brief Retrieve the documentation comment that was added last, or null if
+  /// there is none.
+  const RawComment *getLastComment() const {
+    ArrayRef<RawComment *> Comments = getCommentsInFile(LastCommentFile);
+    return Comments.empty() ? 0 : Comments.back();
   }
 
 private:
   SourceManager &SourceMgr;
-  std::vector<RawComment *> Comments;
+  llvm::DenseMap<FileID, std::vector<RawComment *> > FileComments;
+  FileID LastCommentFile;
   SourceLocation PrevCommentEndLoc;
   bool OnlyWhitespaceSeen;
 
-  void addCommentsToFront(const std::vector<RawComment *> &C) {
-    size_t OldSize = Comments.size();
-    Comments.resize(C.size() + OldSize);
-    std::copy_backward(Comments.begin(), Comments.begin() + OldSize,
-                       Comments.end());
-    std::copy(C.begin(), C.end(), Comments.begin());
+  void addDeserializedComments(FileID File, std::vector<RawComment *> &C) {
+    FileComments[File].swap(C);
   }
 
   friend class ASTReader;
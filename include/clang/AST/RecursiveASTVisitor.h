@@ -32,6 +32,8 @@
 #include "clang/AST/TemplateName.h"
 #include "clang/AST/Type.h"
 #include "clang/AST/TypeLoc.h"
+#include "llvm/Support/SaveAndRestore.h"
+#include <algorithm>
 
 // The following three macros are used for meta programming.  The code
 // using them is responsible for defining macro OPERATOR().
@@ -139,6 +141,8 @@ namespace clang {
 template<typename Derived>
 class RecursiveASTVisitor {
 public:
+  RecursiveASTVisitor() : DataRecursionQueue(0), DataRecursionParent(0) {}
+
   /// \brief Return a reference to the derived class.
   Derived &getDerived() { return *static_cast<Derived*>(this); }
 
@@ -161,6 +165,16 @@ public:
            isa<CaseStmt>(S) || isa<CXXOperatorCallExpr>(S);
   }
 
+  /// \brief Return whether the children of every statement should be
+  /// traversed using data recursion, so that the depth of the traversal does
+  /// not grow with the nesting of statements.
+  ///
+  /// A statement is still traversed recursively if the derived class
+  /// overrides its Traverse* function, so that code the override runs after
+  /// calling the base function still sees the children traversed. This has
+  /// no effect if the derived class overrides TraverseStmt().
+  bool shouldUseDataRecursionForAllStmts() const { return false; }
+
   /// \brief Recursively visit a statement or expression, by
   /// dispatching to Traverse*() based on the argument's dynamic type.
   ///
@@ -432,6 +446,17 @@ private:
   };
   bool dataTraverse(Stmt *S);
   bool dataTraverseNode(Stmt *S, bool &EnqueueChildren);
+  bool dataTraverseAnyNode(Stmt *S);
+  bool shouldDataTraverseAnyNode();
+  void dataEnqueueChildren(Stmt *S);
+
+  /// \brief The queue of the innermost data recursion, if the children of
+  /// DataRecursionParent should be added to it instead of being traversed.
+  SmallVectorImpl<EnqueueJob> *DataRecursionQueue;
+
+  /// \brief The statement being traversed by the innermost data recursion
+  /// whose Traverse* function is not overridden by the derived class.
+  Stmt *DataRecursionParent;
 };
 
 template<typename Derived>
@@ -440,6 +465,10 @@ bool RecursiveASTVisitor<Derived>::dataTraverse(Stmt *S) {
   SmallVector<EnqueueJob, 16> Queue;
   Queue.push_back(S);
 
+  llvm::SaveAndRestore<SmallVectorImpl<EnqueueJob> *>
+    SavedQueue(DataRecursionQueue, &Queue);
+  llvm::SaveAndRestore<Stmt *> SavedParent(DataRecursionParent, 0);
+
   while (!Queue.empty()) {
     EnqueueJob &job = Queue.back();
     Stmt *CurrS = job.S;
@@ -469,12 +498,67 @@ bool RecursiveASTVisitor<Derived>::dataTraverse(Stmt *S) {
     }
 
     Queue.pop_back();
-    TRY_TO(TraverseStmt(CurrS));
+    if (shouldDataTraverseAnyNode())
+      TRY_TO(dataTraverseAnyNode(CurrS));
+    else
+      TRY_TO(TraverseStmt(CurrS));
+  }
+
+  return true;
+}
+
+template<typename Derived>
+bool RecursiveASTVisitor<Derived>::shouldDataTraverseAnyNode() {
+  bool (Derived::*DerivedFn)(Stmt*) = &Derived::TraverseStmt;
+  bool (Derived::*BaseFn)(Stmt*) = &RecursiveASTVisitor::TraverseStmt;
+  return DerivedFn == BaseFn &&
+         getDerived().shouldUseDataRecursionForAllStmts();
+}
+
+template<typename Derived>
+bool RecursiveASTVisitor<Derived>::dataTraverseAnyNode(Stmt *S) {
+  // Operators are dispatched on their opcode, and their traversal visits
+  // their operands directly.
+  if (isa<BinaryOperator>(S) || isa<UnaryOperator>(S))
+    return TraverseStmt(S);
+
+  // Dispatch to the corresponding Traverse* function. If the derived class
+  // didn't override it, it leaves the children of the statement on the
+  // queue instead of traversing them.
+#define DISPATCH_ENQUEUE(NAME, CLASS, VAR) \
+  { \
+    bool (Derived::*DerivedFn)(CLASS*) = &Derived::Traverse##NAME; \
+    bool (Derived::*BaseFn)(CLASS*) = &RecursiveASTVisitor::Traverse##NAME; \
+    DataRecursionParent = DerivedFn == BaseFn ? VAR : 0; \
+    bool Result = getDerived().Traverse##NAME(static_cast<CLASS*>(VAR)); \
+    DataRecursionParent = 0; \
+    return Result; \
+  }
+
+  switch (S->getStmtClass()) {
+  case Stmt::NoStmtClass: break;
+#define ABSTRACT_STMT(STMT)
+#define STMT(CLASS, PARENT) \
+  case Stmt::CLASS##Class: DISPATCH_ENQUEUE(CLASS, CLASS, S);
+#include "clang/AST/StmtNodes.inc"
   }
 
+#undef DISPATCH_ENQUEUE
+
   return true;
 }
 
+template<typename Derived>
+void RecursiveASTVisitor<Derived>::dataEnqueueChildren(Stmt *S) {
+  // The queue is a stack, so push the children in reverse to traverse them
+  // in order.
+  unsigned FirstChild = DataRecursionQueue->size();
+  for (Stmt::child_range range = S->children(); range; ++range)
+    DataRecursionQueue->push_back(*range);
+  std::reverse(DataRecursionQueue->begin() + FirstChild,
+               DataRecursionQueue->end());
+}
+
 template<typename Derived>
 bool RecursiveASTVisitor<Derived>::dataTraverseNode(Stmt *S,
                                                     bool &EnqueueChildren) {
@@ -538,7 +622,8 @@ bool RecursiveASTVisitor<Derived>::TraverseStmt(Stmt *S) {
   if (!S)
     return true;
 
-  if (getDerived().shouldUseDataRecursionFor(S))
+  if (getDerived().shouldUseDataRecursionFor(S) ||
+      shouldDataTraverseAnyNode())
     return dataTraverse(S);
 
   // If we have a binary expr, dispatch to the subcode of the binop.  A smart
@@ -1960,6 +2045,10 @@ template<typename Derived>                                              \
 bool RecursiveASTVisitor<Derived>::Traverse##STMT (STMT *S) {           \
   TRY_TO(WalkUpFrom##STMT(S));                                          \
   { CODE; }                                                             \
+  if (S == DataRecursionParent) {                                       \
+    dataEnqueueChildren(S);                                             \
+    return true;                                                        \
+  }                                                                     \
   for (Stmt::child_range range = S->children(); range; ++range) {       \
     TRY_TO(TraverseStmt(*range));                                       \
   }                                                                     \
@@ -2399,6 +2488,13 @@ DEF_TRAVERSE_STMT(OMPParallelDirective, {
     if (!TraverseOMPClause(*I)) return false;
 })
 
+DEF_TRAVERSE_STMT(OMPSimdDirective, {
+  ArrayRef<OMPClause *> Clauses = S->clauses();
+  for (ArrayRef<OMPClause *>::iterator I = Clauses.begin(), E = Clauses.end();
+       I != E; ++I)
+    if (!TraverseOMPClause(*I)) return false;
+})
+
 // OpenMP clauses.
 template<typename Derived>
 bool RecursiveASTVisitor<Derived>::TraverseOMPClause(OMPClause *C) {
@@ -2418,6 +2514,12 @@ bool RecursiveASTVisitor<Derived>::VisitOMPDefaultClause(OMPDefaultClause *C) {
   return true;
 }
 
+template<typename Derived>
+bool RecursiveASTVisitor<Derived>::VisitOMPSafelenClause(OMPSafelenClause *C) {
+  TraverseStmt(C->getSafelen());
+  return true;
+}
+
 #define PROCESS_OMP_CLAUSE_LIST(Class, Node)                                   \
   for (OMPVarList<Class>::varlist_iterator I = Node->varlist_begin(),          \
                                            E = Node->varlist_end();            \
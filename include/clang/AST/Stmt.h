@@ -35,6 +35,7 @@ namespace clang {
   class Attr;
   class CapturedDecl;
   class Decl;
+  class DeclHasher;
   class Expr;
   class IdentifierInfo;
   class LabelDecl;
@@ -366,6 +367,9 @@ public:
   static void addStmtClass(const StmtClass s);
   static void EnableStatistics();
   static void PrintStats();
+  /// \brief The number of statements of class \p S created since the
+  /// statistics were enabled.
+  static unsigned getNumStmtsCreated(StmtClass S);
 
   /// \brief Dumps the specified AST fragment and all subtrees to
   /// \c llvm::errs().
@@ -431,6 +435,14 @@ public:
   /// written in the source.
   void Profile(llvm::FoldingSetNodeID &ID, const ASTContext &Context,
                bool Canonical) const;
+
+  /// \brief Produce a canonical profile of this statement that identifies
+  /// the declarations, types and names it refers to by their spelling rather
+  /// than their address, so that it does not depend on the ASTContext.
+  ///
+  /// \param Hasher the hasher that adds the entities this statement refers
+  /// to, and that knows the AST context in which the statement resides
+  void Profile(llvm::FoldingSetNodeID &ID, DeclHasher &Hasher) const;
 };
 
 /// DeclStmt - Adaptor class for mixing declarations with statements and
@@ -2878,6 +2878,10 @@ private:
   /// This is a value of type \c RefQualifierKind.
   unsigned RefQualifier : 2;
 
+  /// \brief The hash of the profile of this type, stored by ASTContext when
+  /// it uniques the type.
+  unsigned ProfileHash;
+
   // ArgInfo - There is an variable size array after the class in memory that
   // holds the argument types.
 
@@ -3068,6 +3072,10 @@ public:
     return T->getTypeClass() == FunctionProto;
   }
 
+  /// \brief Retrieve the hash of the profile of this type, if it was uniqued
+  /// by an ASTContext.
+  unsigned getProfileHash() const { return ProfileHash; }
+
   void Profile(llvm::FoldingSetNodeID &ID, const ASTContext &Ctx);
   static void Profile(llvm::FoldingSetNodeID &ID, QualType Result,
                       arg_type_iterator ArgTys, unsigned NumArgs,
@@ -3694,6 +3702,10 @@ class TemplateSpecializationType
   /// \brief Whether this template specialization type is a substituted
   /// type alias.
   bool TypeAlias : 1;
+
+  /// \brief The hash of the profile of this type, stored by ASTContext when
+  /// it uniques the type.
+  unsigned ProfileHash;
     
   TemplateSpecializationType(TemplateName T,
                              const TemplateArgument *Args,
@@ -3784,6 +3796,10 @@ public:
   }
   QualType desugar() const { return getCanonicalTypeInternal(); }
 
+  /// \brief Retrieve the hash of the profile of this type, if it was uniqued
+  /// by an ASTContext.
+  unsigned getProfileHash() const { return ProfileHash; }
+
   void Profile(llvm::FoldingSetNodeID &ID, const ASTContext &Ctx) {
     Profile(ID, Template, getArgs(), NumArgs, Ctx);
     if (isTypeAlias())
@@ -4087,6 +4103,10 @@ class DependentTemplateSpecializationType :
   /// template specialization.
   unsigned NumArgs;
 
+  /// \brief The hash of the profile of this type, stored by ASTContext when
+  /// it uniques the type.
+  unsigned ProfileHash;
+
   const TemplateArgument *getArgBuffer() const {
     return reinterpret_cast<const TemplateArgument*>(this+1);
   }
@@ -4124,6 +4144,10 @@ public:
   bool isSugared() const { return false; }
   QualType desugar() const { return QualType(this, 0); }
 
+  /// \brief Retrieve the hash of the profile of this type, if it was uniqued
+  /// by an ASTContext.
+  unsigned getProfileHash() const { return ProfileHash; }
+
   void Profile(llvm::FoldingSetNodeID &ID, const ASTContext &Context) {
     Profile(ID, Context, getKeyword(), NNS, Name, NumArgs, getArgs());
   }
@@ -5196,4 +5220,40 @@ inline const ArrayType *Type::castAsArrayTypeUnsafe() const {
 
 }  // end namespace clang
 
+namespace llvm {
+
+/// \brief The types that an ASTContext uniques in a ContextualFoldingSet
+/// store the hash of their profile, so that a lookup only profiles the
+/// nodes whose hash matches and growing the set profiles none.
+template <typename T>
+struct ProfileHashFoldingSetTrait
+  : DefaultContextualFoldingSetTrait<T, clang::ASTContext &> {
+  static bool Equals(T &X, const FoldingSetNodeID &ID, unsigned IDHash,
+                     FoldingSetNodeID &TempID, clang::ASTContext &Context) {
+    return X.getProfileHash() == IDHash &&
+           DefaultContextualFoldingSetTrait<T, clang::ASTContext &>::Equals(
+               X, ID, IDHash, TempID, Context);
+  }
+  static unsigned ComputeHash(T &X, FoldingSetNodeID &TempID,
+                              clang::ASTContext &Context) {
+    return X.getProfileHash();
+  }
+};
+
+template <>
+struct ContextualFoldingSetTrait<clang::FunctionProtoType, clang::ASTContext &>
+  : ProfileHashFoldingSetTrait<clang::FunctionProtoType> {};
+
+template <>
+struct ContextualFoldingSetTrait<clang::TemplateSpecializationType,
+                                 clang::ASTContext &>
+  : ProfileHashFoldingSetTrait<clang::TemplateSpecializationType> {};
+
+template <>
+struct ContextualFoldingSetTrait<clang::DependentTemplateSpecializationType,
+                                 clang::ASTContext &>
+  : ProfileHashFoldingSetTrait<clang::DependentTemplateSpecializationType> {};
+
+}  // end namespace llvm
+
 #endif
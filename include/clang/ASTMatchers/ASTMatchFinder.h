@@ -91,6 +91,10 @@ public:
     virtual ~MatchCallback();
 
     /// \brief Called on every match by the \c MatchFinder.
+    ///
+    /// Always called on the thread that runs the \c ASTConsumer, in
+    /// traversal order, even when matching uses several threads (see
+    /// \c setNumThreads).
     virtual void run(const MatchResult &Result) = 0;
 
     /// \brief Called at the start of each translation unit.
@@ -139,6 +143,25 @@ public:
   /// \brief Creates a clang ASTConsumer that finds all matches.
   clang::ASTConsumer *newASTConsumer();
 
+  /// \brief Sets the number of threads the ASTConsumers created by
+  /// newASTConsumer() use to match a translation unit.
+  ///
+  /// \param NumThreads The number of worker threads; 0 means one per
+  ///        hardware thread. The default is 1, which traverses the AST on
+  ///        the calling thread.
+  ///
+  /// With more than one thread, the top-level declarations of the
+  /// translation unit are traversed concurrently, each by a visitor of its
+  /// own, so the matchers themselves must only read the AST: custom
+  /// matchers must neither modify the ASTContext nor use the SourceManager.
+  /// The matches are buffered and the callbacks run afterwards, serially and
+  /// in the order of a single-threaded traversal, so \c MatchCallback
+  /// implementations need no synchronization. The parent map is built
+  /// up front, and isDerivedFrom() also sees typedefs declared later in the
+  /// translation unit. ASTs that are loaded lazily from an AST file are
+  /// always matched serially.
+  void setNumThreads(unsigned NumThreads) { this->NumThreads = NumThreads; }
+
   /// \brief Calls the registered callbacks on all matches on the given \p Node.
   ///
   /// Note that there can be multiple matches on a single node, for
@@ -167,6 +190,8 @@ private:
 
   /// \brief Called when parsing is done.
   ParsingDoneTestCallback *ParsingDone;
+
+  unsigned NumThreads;
 };
 
 /// \brief Returns the results of matching \p Matcher on \p Node.
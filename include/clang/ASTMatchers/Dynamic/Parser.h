@@ -37,6 +37,7 @@
 #include "clang/ASTMatchers/Dynamic/VariantValue.h"
 #include "clang/Basic/LLVM.h"
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
 
 namespace clang {
@@ -143,6 +144,36 @@ private:
   Diagnostics *const Error;
 };
 
+/// \brief Remembers the matchers parsed from matcher expressions.
+///
+/// Tools that run the same matcher expressions repeatedly, like an
+/// interactive query loop, can parse them through a cache so that each
+/// expression is parsed and built from the registry only once. All the
+/// lookups of an expression return the same matcher, so its memoized
+/// results in a \c MatchFinder are shared as well.
+class ParsedMatcherCache {
+public:
+  ParsedMatcherCache() {}
+  ~ParsedMatcherCache();
+
+  /// \brief Returns the matcher for \p MatcherCode, parsing it with
+  ///   \c Parser::parseMatcherExpression() if it was not parsed before.
+  ///
+  /// \return The matcher, owned by the cache, or NULL if an error occurred.
+  ///   In that case, \c Error will contain a description of the error.
+  ///   Failed parses are not remembered.
+  const DynTypedMatcher *getMatcher(StringRef MatcherCode, Diagnostics *Error);
+
+  /// \brief Forgets all the matchers parsed so far.
+  void clear();
+
+private:
+  ParsedMatcherCache(const ParsedMatcherCache &) LLVM_DELETED_FUNCTION;
+  void operator=(const ParsedMatcherCache &) LLVM_DELETED_FUNCTION;
+
+  llvm::StringMap<DynTypedMatcher *> Matchers;
+};
+
 }  // namespace dynamic
 }  // namespace ast_matchers
 }  // namespace clang
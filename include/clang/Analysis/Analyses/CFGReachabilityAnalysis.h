@@ -16,8 +16,9 @@
 #ifndef CLANG_ANALYSIS_CFG_REACHABILITY
 #define CLANG_ANALYSIS_CFG_REACHABILITY
 
+#include "clang/Analysis/AnalysisContext.h"
 #include "llvm/ADT/BitVector.h"
-#include "llvm/ADT/DenseMap.h"
+#include <vector>
 
 namespace clang {
 
@@ -28,18 +29,25 @@ class CFGBlock;
 // checks in this checker require reachability information. The requests all
 // tend to have a common destination, so we lazily do a predecessor search
 // from the destination node and cache the results to prevent work
-// duplication.
-class CFGReverseBlockReachabilityAnalysis {
+// duplication.  Only the destinations that were queried get a set of the
+// blocks reaching them.
+class CFGReverseBlockReachabilityAnalysis : public ManagedAnalysis {
   typedef llvm::BitVector ReachableSet;
-  typedef llvm::DenseMap<unsigned, ReachableSet> ReachableMap;
-  ReachableSet analyzed;
-  ReachableMap reachable;
+  /// The blocks reaching each block, indexed by block ID.  The set of a
+  /// block that was not analyzed yet is empty.
+  std::vector<ReachableSet> reachable;
 public:
   CFGReverseBlockReachabilityAnalysis(const CFG &cfg);
 
   /// Returns true if the block 'Dst' can be reached from block 'Src'.
   bool isReachable(const CFGBlock *Src, const CFGBlock *Dst);
 
+  // Used by AnalysisDeclContext to construct this object.
+  static const void *getTag();
+
+  static CFGReverseBlockReachabilityAnalysis *
+  create(AnalysisDeclContext &analysisContext);
+
 private:
   void mapReachability(const CFGBlock *Dst);
 };
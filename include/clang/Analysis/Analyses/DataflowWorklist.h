@@ -0,0 +1,100 @@
+//===- DataflowWorklist.h - Worklist for dataflow over CFGs -----*- C++ --*-//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the worklist and the variable numbering shared by the
+// dataflow analyses over source-level CFGs that keep their values in dense
+// bit vectors, such as LiveVariables and UninitializedValues.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_DATAFLOW_WORKLIST_H
+#define LLVM_CLANG_DATAFLOW_WORKLIST_H
+
+#include "clang/Analysis/Analyses/PostOrderCFGView.h"
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/BitVector.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Optional.h"
+#include "llvm/ADT/SmallVector.h"
+#include <vector>
+
+namespace clang {
+
+class CFG;
+class CFGBlock;
+class VarDecl;
+
+/// \brief Assigns consecutive indices to the variables tracked by a dataflow
+/// analysis, so that their values can be stored in bit vectors.
+class VarDeclNumbering {
+  llvm::DenseMap<const VarDecl *, unsigned> Indices;
+  std::vector<const VarDecl *> Decls;
+
+public:
+  /// \brief Returns the index of \p D, giving it the next free index if it
+  /// did not have one yet.
+  unsigned getOrAssignIndex(const VarDecl *D);
+
+  /// \brief Returns the index of \p D, if it has one.
+  Optional<unsigned> getIndex(const VarDecl *D) const;
+
+  const VarDecl *getDecl(unsigned Index) const { return Decls[Index]; }
+
+  /// \brief Returns the number of variables that have an index.
+  unsigned size() const { return Decls.size(); }
+};
+
+/// \brief A worklist of the CFG blocks whose dataflow values need to be
+/// recomputed.
+///
+/// Forward analyses get the blocks in reverse post order and backward
+/// analyses in post order, as given by the PostOrderCFGView of the CFG, so
+/// that a block is usually visited after the blocks its value depends on.
+/// Each block is in the worklist at most once.
+class DataflowWorklist {
+public:
+  enum Direction { Forward, Backward };
+
+private:
+  class BlockCompare {
+    PostOrderCFGView::BlockOrderCompare POCompare;
+    Direction Dir;
+  public:
+    BlockCompare(const PostOrderCFGView &POV, Direction Dir)
+      : POCompare(POV.getComparator()), Dir(Dir) {}
+
+    /// Orders the blocks so that the block to visit first is the greatest.
+    bool operator()(const CFGBlock *B1, const CFGBlock *B2) const {
+      return Dir == Backward ? POCompare(B1, B2) : POCompare(B2, B1);
+    }
+  };
+
+  /// A heap of the blocks in the worklist, ordered by BlockCompare.
+  SmallVector<const CFGBlock *, 20> Worklist;
+  llvm::BitVector EnqueuedBlocks;
+  BlockCompare Compare;
+
+public:
+  DataflowWorklist(const CFG &cfg, const PostOrderCFGView &POV,
+                   Direction Dir);
+
+  /// \brief Adds \p Block to the worklist, unless it is null or already
+  /// there.
+  void enqueueBlock(const CFGBlock *Block);
+  void enqueueSuccessors(const CFGBlock *Block);
+  void enqueuePredecessors(const CFGBlock *Block);
+
+  /// \brief Removes the next block to visit from the worklist and returns
+  /// it, or returns null if the worklist is empty.
+  const CFGBlock *dequeue();
+};
+
+} // end namespace clang
+
+#endif
@@ -151,6 +151,12 @@ public:
     DT->print(OS);
   }
 
+  // Used by AnalysisDeclContext to construct this object, so that the clients
+  // of a declaration share one dominator tree.
+  static const void *getTag();
+
+  static DominatorTree *create(AnalysisDeclContext &analysisContext);
+
 private:
   CFG *cfg;
 };
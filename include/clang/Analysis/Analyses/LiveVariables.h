@@ -15,7 +15,9 @@
 #define LLVM_CLANG_LIVEVARIABLES_H
 
 #include "clang/AST/Decl.h"
+#include "clang/Analysis/Analyses/DataflowWorklist.h"
 #include "clang/Analysis/AnalysisContext.h"
+#include "llvm/ADT/BitVector.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/ImmutableSet.h"
 
@@ -33,16 +35,21 @@ public:
   public:
 
     llvm::ImmutableSet<const Stmt *> liveStmts;
-    llvm::ImmutableSet<const VarDecl *> liveDecls;
+
+    /// The live variables, indexed by their numbers in \c declNumbering.
+    llvm::BitVector liveDecls;
+    const VarDeclNumbering *declNumbering;
     
     bool equals(const LivenessValues &V) const;
 
     LivenessValues()
-      : liveStmts(0), liveDecls(0) {}
+      : liveStmts(0), declNumbering(0) {}
 
     LivenessValues(llvm::ImmutableSet<const Stmt *> LiveStmts,
-                   llvm::ImmutableSet<const VarDecl *> LiveDecls)
-      : liveStmts(LiveStmts), liveDecls(LiveDecls) {}
+                   const llvm::BitVector &LiveDecls,
+                   const VarDeclNumbering *DeclNumbering)
+      : liveStmts(LiveStmts), liveDecls(LiveDecls),
+        declNumbering(DeclNumbering) {}
 
     ~LivenessValues() {}
     
@@ -72,8 +72,9 @@ private:
   typedef llvm::po_iterator<const CFG*, CFGBlockSet, true>  po_iterator;
   std::vector<const CFGBlock*> Blocks;
 
-  typedef llvm::DenseMap<const CFGBlock *, unsigned> BlockOrderTy;
-  BlockOrderTy BlockOrder;
+  /// The position of each block in the post order plus one, indexed by
+  /// block ID, or zero for blocks that are not reachable from the entry.
+  std::vector<unsigned> BlockOrder;
 
 public:
   typedef std::vector<const CFGBlock*>::reverse_iterator iterator;
@@ -23,10 +23,12 @@
 #include "llvm/ADT/IntrusiveRefCntPtr.h"
 #include "llvm/ADT/OwningPtr.h"
 #include "llvm/ADT/PointerUnion.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/Allocator.h"
 
 namespace clang {
 
+class BodyFarm;
 class Decl;
 class Stmt;
 class CFGReverseBlockReachabilityAnalysis;
@@ -74,7 +76,10 @@ class AnalysisDeclContext {
 
   const Decl * const D;
 
-  OwningPtr<CFG> cfg, completeCFG;
+  CFG *cfg, *completeCFG;
+  /// The CFGs above when this context built them itself, rather than
+  /// getting them from its manager.
+  OwningPtr<CFG> ownedCFG, ownedCompleteCFG;
   OwningPtr<CFGStmtMap> cfgStmtMap;
 
   CFG::BuildOptions cfgBuildOptions;
@@ -83,7 +88,6 @@ class AnalysisDeclContext {
   bool builtCFG, builtCompleteCFG;
   OwningPtr<ParentMap> PM;
   OwningPtr<PseudoConstantAnalysis> PCA;
-  OwningPtr<CFGReverseBlockReachabilityAnalysis> CFA;
 
   llvm::BumpPtrAllocator A;
 
@@ -201,6 +205,10 @@ private:
   ManagedAnalysis *&getAnalysisImpl(const void* tag);
 
   LocationContextManager &getLocationContextManager();
+
+  /// Build the CFG of the body with \p Options, or get it from the manager
+  /// if it has already built a suitable one.
+  CFG *buildCFG(const CFG::BuildOptions &Options, OwningPtr<CFG> &Owned);
 };
 
 class LocationContext : public llvm::FoldingSetNode {
@@ -401,6 +409,18 @@ class AnalysisDeclContextManager {
   typedef llvm::DenseMap<const Decl*, AnalysisDeclContext*> ContextMap;
 
   ContextMap Contexts;
+
+  struct CachedCFG {
+    CFG::BuildOptions Options;
+    CFG *TheCFG;
+  };
+  typedef llvm::DenseMap<const Decl*, SmallVector<CachedCFG, 1> > CFGMap;
+
+  /// The CFGs built for the contexts of this manager, which are kept when the
+  /// contexts are discarded so that a declaration analyzed again, such as a
+  /// function inlined into several callers, does not have its CFG rebuilt.
+  /// A failed build is cached as a null CFG.
+  CFGMap CFGs;
   LocationContextManager LocContexts;
   CFG::BuildOptions cfgBuildOptions;
   
@@ -408,6 +428,10 @@ class AnalysisDeclContextManager {
   /// for well-known functions.
   bool SynthesizeBodies;
 
+  /// The factory of the synthesized bodies, which caches them for the
+  /// declarations of the AST analyzed with this manager.
+  OwningPtr<BodyFarm> BdyFrm;
+
 public:
   AnalysisDeclContextManager(bool useUnoptimizedCFG = false,
                              bool addImplicitDtors = false,
@@ -432,6 +456,10 @@ public:
   /// functions.
   bool synthesizeBodies() const { return SynthesizeBodies; }
 
+  /// Return the factory of the synthesized bodies of the declarations of
+  /// \p C.
+  BodyFarm &getBodyFarm(ASTContext &C);
+
   const StackFrameContext *getStackFrame(AnalysisDeclContext *Ctx,
                                          LocationContext const *Parent,
                                          const Stmt *S,
@@ -454,9 +482,15 @@ public:
     return LocContexts.getStackFrame(getContext(D), Parent, S, Blk, Idx);
   }
 
-  /// Discard all previously created AnalysisDeclContexts.
+  /// Discard all previously created AnalysisDeclContexts. The CFGs built
+  /// for them are kept.
   void clear();
 
+  /// Return the CFG of \p D with body \p Body, built with options that
+  /// subsume \p Options. The CFG is built only if no suitable one has been
+  /// built before, and is owned by the manager.
+  CFG *getCFG(const Decl *D, Stmt *Body, const CFG::BuildOptions &Options);
+
 private:
   friend class AnalysisDeclContext;
 
@@ -539,6 +539,11 @@ public:
     Succs.push_back(Block, C);
   }
 
+  /// Make room for \p N successors, for blocks that will have many.
+  void reserveSuccessors(unsigned N, BumpVectorContext &C) {
+    Succs.reserve(C, N);
+  }
+
   void appendStmt(Stmt *statement, BumpVectorContext &C) {
     Elements.push_back(CFGStmt(statement), C);
   }
@@ -617,6 +622,23 @@ public:
       return *this;
     }
 
+    /// \brief Returns true if a CFG built with these options can be used
+    /// in place of one built with \p Other.
+    ///
+    /// The options have to agree on everything except the statements that
+    /// are always added, of which these options have to add at least those
+    /// that \p Other adds; clients of the CFG do not depend on the absence
+    /// of elements. Forced block expressions are not compared.
+    bool subsumes(const BuildOptions &Other) const {
+      return PruneTriviallyFalseEdges == Other.PruneTriviallyFalseEdges &&
+             AddEHEdges == Other.AddEHEdges &&
+             AddInitializers == Other.AddInitializers &&
+             AddImplicitDtors == Other.AddImplicitDtors &&
+             AddTemporaryDtors == Other.AddTemporaryDtors &&
+             AddStaticInitBranches == Other.AddStaticInitBranches &&
+             (Other.alwaysAddMask & ~alwaysAddMask).none();
+    }
+
     BuildOptions()
     : forcedBlkExprs(0), PruneTriviallyFalseEdges(true)
       ,AddEHEdges(false)
@@ -16,8 +16,11 @@
 #ifndef LLVM_CLANG_BASIC_BUILTINS_H
 #define LLVM_CLANG_BASIC_BUILTINS_H
 
+#include "clang/Basic/IdentifierTable.h"
 #include "clang/Basic/LLVM.h"
+#include "llvm/Support/Compiler.h"
 #include <cstring>
+#include <vector>
 
 // VC++ defines 'alloca' as an object-like macro, which interferes with our
 // builtins.
@@ -25,7 +28,6 @@
 
 namespace clang {
   class TargetInfo;
-  class IdentifierTable;
   class ASTContext;
   class QualType;
   class LangOptions;
@@ -61,9 +63,15 @@ struct Info {
 
 /// \brief Holds information about both target-independent and
 /// target-specific builtins, allowing easy queries by clients.
-class Context {
+class Context : public BuiltinIdentifierLookup {
   const Info *TSRecords;
   unsigned NumTSRecords;
+
+  /// \brief An open-addressing hash table of the IDs of the builtins
+  /// supported by the language options, indexed by the hash of their names.
+  /// Empty slots hold 0.
+  std::vector<unsigned> LookupTable;
+
 public:
   Context();
 
@@ -73,8 +81,15 @@ public:
   /// \brief Mark the identifiers for all the builtins with their
   /// appropriate builtin ID # and mark any non-portable builtin identifiers as
   /// such.
+  ///
+  /// The identifiers are marked as \p Table creates them, so this must
+  /// outlive \p Table's use.
   void InitializeBuiltins(IdentifierTable &Table, const LangOptions& LangOpts);
 
+  /// \brief Return the ID of the builtin called \p Name, or 0 if there is no
+  /// such builtin or InitializeBuiltins() has not been called.
+  unsigned getBuiltinID(StringRef Name) const LLVM_OVERRIDE;
+
   /// \brief Populate the vector with the names of all of the builtins.
   void GetBuiltinNames(SmallVectorImpl<const char *> &Names);
 
@@ -175,6 +190,10 @@ private:
   /// \brief Is this builtin supported according to the given language options?
   bool BuiltinIsSupported(const Builtin::Info &BuiltinInfo,
                           const LangOptions &LangOpts);
+
+  /// \brief Add \p ID to the lookup table, replacing any builtin of the same
+  /// name.
+  void AddToLookupTable(unsigned ID);
 };
 
 }
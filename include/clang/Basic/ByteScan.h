@@ -0,0 +1,50 @@
+//===--- ByteScan.h - Vectorized scans over source buffers ------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Defines the byte scanning primitives used by the lexer and the
+/// source manager to skip over uninteresting runs of characters.
+///
+/// Each scan examines the half-open range [Ptr, End) and returns a pointer to
+/// the first byte that stops the scan, or \p End if there is none. The scans
+/// never read at or past \p End. Where the host supports it (AVX2, SSE2, NEON
+/// or AltiVec), whole vectors of bytes are examined at once.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_BASIC_BYTESCAN_H
+#define LLVM_CLANG_BASIC_BYTESCAN_H
+
+#include "llvm/Support/Compiler.h"
+
+namespace clang {
+
+/// \brief Returns the first occurrence of \p C in [Ptr, End).
+LLVM_READONLY const char *scanForByte(const char *Ptr, const char *End,
+                                      char C);
+
+/// \brief Returns the first '\\n', '\\r' or '\\0' in [Ptr, End).
+LLVM_READONLY const char *scanForLineEnd(const char *Ptr, const char *End);
+
+/// \brief Returns the first byte in [Ptr, End) that is not horizontal
+/// whitespace, as defined by \c isHorizontalWhitespace.
+LLVM_READONLY const char *skipHorizontalWhitespace(const char *Ptr,
+                                                   const char *End);
+
+/// \brief Returns the first byte in [Ptr, End) that is not in [_A-Za-z0-9].
+LLVM_READONLY const char *skipIdentifierBody(const char *Ptr,
+                                             const char *End);
+
+/// \brief Returns the name of the vector instruction set the scans were
+/// built for: "avx2", "sse2", "neon", "altivec" or "scalar".
+const char *getByteScanImplementationName();
+
+} // end namespace clang
+
+#endif
@@ -22,8 +22,11 @@
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/IntrusiveRefCntPtr.h"
 #include "llvm/ADT/OwningPtr.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/Support/type_traits.h"
 #include <list>
+#include <map>
 #include <vector>
 
 namespace clang {
@@ -252,6 +255,55 @@ private:
   typedef std::vector<DiagStatePoint> DiagStatePointsTy;
   mutable DiagStatePointsTy DiagStatePoints;
 
+  /// \brief The diagnostic state transitions that happen in one file, so that
+  /// the state at a location can be found without comparing locations across
+  /// files and macro expansions.
+  struct DiagStateFile {
+    /// \brief The file that includes this one, or null for the imaginary
+    /// file that includes all the top-level files.
+    DiagStateFile *Parent;
+
+    /// \brief The offset of the include in the parent file.
+    unsigned ParentOffset;
+
+    /// \brief Whether the state changes in this file or in any file it
+    /// includes. If it does not, the state is the one of the parent at the
+    /// point of the include.
+    bool HasLocalTransitions;
+
+    /// \brief The state from each offset onwards, sorted by offset. The first
+    /// transition is at offset 0, and gives the state at the start of the
+    /// file.
+    SmallVector<std::pair<unsigned, DiagState *>, 2> Transitions;
+
+    DiagStateFile() : Parent(0), ParentOffset(0), HasLocalTransitions(false) {}
+
+    DiagState *lookup(unsigned Offset) const;
+
+    static bool isBeforeTransition(unsigned Offset,
+                                   const std::pair<unsigned, DiagState *> &T) {
+      return Offset < T.first;
+    }
+  };
+
+  /// \brief An index of DiagStatePoints by the file they are in, built lazily
+  /// and kept up to date as points are appended.
+  mutable std::map<FileID, DiagStateFile> DiagStateFiles;
+
+  /// \brief The number of DiagStatePoints in DiagStateFiles.
+  mutable unsigned NumIndexedDiagStatePoints;
+
+  /// \brief For each group queried by isDiagnosticGroupIgnored(), whether the
+  /// group is ignored in a diagnostic state, given the options that affect it.
+  ///
+  /// The value has GroupIgnored set if every diagnostic of the group is
+  /// ignored, and GroupIgnoredInSystemHeaders if every diagnostic is either
+  /// ignored or suppressed in system headers.
+  enum { GroupIgnored = 1, GroupIgnoredInSystemHeaders = 2 };
+  typedef llvm::DenseMap<std::pair<const DiagState *, unsigned>, unsigned>
+    GroupIgnoredStatesTy;
+  mutable llvm::StringMap<GroupIgnoredStatesTy> GroupIgnoredCache;
+
   /// \brief Keeps the DiagState that was active during each diagnostic 'push'
   /// so we can get back at it when we 'pop'.
   std::vector<DiagState *> DiagStateOnPushStack;
@@ -276,6 +328,26 @@ private:
   /// the given source location.
   DiagStatePointsTy::iterator GetDiagStatePointForLoc(SourceLocation Loc) const;
 
+  /// \brief Returns the diagnostic state of the given source location.
+  ///
+  /// This gives the same state as GetDiagStatePointForLoc(), but only looks
+  /// at the state transitions in the file of \p Loc and the files including
+  /// it.
+  DiagState *GetDiagStateForLoc(SourceLocation Loc) const;
+
+  /// \brief Returns the index entry of \p ID, creating it if needed.
+  DiagStateFile *getDiagStateFile(FileID ID) const;
+
+  /// \brief Adds the DiagStatePoints that are not in DiagStateFiles yet.
+  void updateDiagStateFiles() const;
+
+  /// \brief Forgets DiagStateFiles, after DiagStatePoints changed other than
+  /// by appending to it.
+  void invalidateDiagStateFiles() const {
+    DiagStateFiles.clear();
+    NumIndexedDiagStatePoints = 0;
+  }
+
   /// \brief Sticky flag set to \c true when an error is emitted.
   bool ErrorOccurred;
 
@@ -370,7 +442,10 @@ public:
     assert(SourceMgr && "SourceManager not set!");
     return *SourceMgr;
   }
-  void setSourceManager(SourceManager *SrcMgr) { SourceMgr = SrcMgr; }
+  void setSourceManager(SourceManager *SrcMgr) {
+    SourceMgr = SrcMgr;
+    invalidateDiagStateFiles();
+  }
 
   //===--------------------------------------------------------------------===//
   //  DiagnosticsEngine characterization methods, used by a client to customize
@@ -638,6 +713,18 @@ public:
     return (Level)Diags->getDiagnosticLevel(DiagID, Loc, *this);
   }
 
+  /// \brief Determine whether every diagnostic in the given group, and in its
+  /// subgroups, would be ignored at the given location.
+  ///
+  /// Checks whose expensive analysis can only produce diagnostics of one group
+  /// use this to skip the analysis. The answer is cached for each diagnostic
+  /// state, so this is cheaper than asking for the level of each diagnostic.
+  ///
+  /// \returns false if the group is unknown.
+  bool isDiagnosticGroupIgnored(StringRef Group, SourceLocation Loc) const {
+    return Diags->isDiagnosticGroupIgnored(Group, Loc, *this);
+  }
+
   /// \brief Issue the message to the client.
   ///
   /// This actually returns an instance of DiagnosticBuilder which emits the
@@ -264,6 +264,17 @@ private:
                                           SourceLocation Loc,
                                           const DiagnosticsEngine &Diag) const;
 
+  /// \brief Classify a diagnostic from its mapping and the command-line
+  /// options alone, without looking at the location it is reported at.
+  DiagnosticIDs::Level getMappedLevel(unsigned DiagID, bool IsExtensionDiag,
+                                      const DiagnosticMappingInfo &MappingInfo,
+                                      const DiagnosticsEngine &Diag) const;
+
+  /// \brief Determine whether every diagnostic in \p Group, and in its
+  /// subgroups, would be ignored at \p Loc.
+  bool isDiagnosticGroupIgnored(StringRef Group, SourceLocation Loc,
+                                const DiagnosticsEngine &Diag) const;
+
   /// \brief Used to report a diagnostic that is finally fully formed.
   ///
   /// \returns \c true if the diagnostic was emitted, \c false if it was
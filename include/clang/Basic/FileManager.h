@@ -17,6 +17,7 @@
 
 #include "clang/Basic/FileSystemOptions.h"
 #include "clang/Basic/LLVM.h"
+#include "clang/Basic/VirtualFileSystem.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/IntrusiveRefCntPtr.h"
 #include "llvm/ADT/OwningPtr.h"
@@ -171,6 +172,10 @@ class FileManager : public RefCountedBase<FileManager> {
   // Caching.
   OwningPtr<FileSystemStatCache> StatCache;
 
+  /// \brief The file system the files are looked up in and read from, or
+  /// null to use the disk through the stat caches.
+  IntrusiveRefCntPtr<vfs::FileSystem> FS;
+
   bool getStatValue(const char *Path, FileData &Data, bool isFile,
                     int *FileDescriptor);
 
@@ -201,6 +206,27 @@ public:
   /// \brief Removes all FileSystemStatCache objects from the manager.
   void clearStatCaches();
 
+  /// \brief Asks the installed FileSystemStatCache objects to persist the
+  /// results they have gathered.
+  void flushStatCaches();
+
+  /// \brief Look the files up in, and read them from, \p FS instead of the
+  /// disk. The stat caches aren't used for such files.
+  void setVirtualFileSystem(IntrusiveRefCntPtr<vfs::FileSystem> FS) {
+    this->FS = FS;
+  }
+
+  /// \brief Returns the file system set by setVirtualFileSystem, if any.
+  vfs::FileSystem *getVirtualFileSystem() const { return FS.getPtr(); }
+
+  /// \brief Look up the macro that the stat caches remember to guard the
+  /// whole of \p File, as recorded by an earlier compilation.
+  bool getCachedControllingMacro(const FileEntry *File, std::string &Macro);
+
+  /// \brief Tell the stat caches that \p File is guarded by \p Macro, for
+  /// the benefit of later compilations.
+  void setCachedControllingMacro(const FileEntry *File, StringRef Macro);
+
   /// \brief Lookup, cache, and verify the specified directory (real or
   /// virtual).
   ///
@@ -238,8 +264,17 @@ public:
   llvm::MemoryBuffer *getBufferForFile(const FileEntry *Entry,
                                        std::string *ErrorStr = 0,
                                        bool isVolatile = false);
+
+  /// \brief Open the specified file as a MemoryBuffer, returning a new
+  /// MemoryBuffer if successful, otherwise returning null.
+  ///
+  /// \param RequiresNullTerminator Whether the buffer must be followed by a
+  /// null character. Without that requirement, large files are always
+  /// memory-mapped rather than copied into memory, so that processes reading
+  /// the same file share its pages.
   llvm::MemoryBuffer *getBufferForFile(StringRef Filename,
-                                       std::string *ErrorStr = 0);
+                                       std::string *ErrorStr = 0,
+                                       bool RequiresNullTerminator = true);
 
   /// \brief Get the 'stat' information for the given \p Path.
   ///
@@ -256,6 +291,10 @@ public:
   /// working directory.
   void FixupRelativePath(SmallVectorImpl<char> &path) const;
 
+  /// \brief Determine whether any files have been added with
+  /// getVirtualFile(), which a listing of their directory won't show.
+  bool hasVirtualFiles() const { return !VirtualFileEntries.empty(); }
+
   /// \brief Produce an array mapping from the unique IDs assigned to each
   /// file to the corresponding FileEntry pointer.
   void GetUniqueIDMapping(
@@ -25,6 +25,10 @@ public:
   /// \brief If set, paths are resolved as if the working directory was
   /// set to the value of WorkingDir.
   std::string WorkingDir;
+
+  /// \brief If set, the path of a persistent stat cache (see
+  /// PersistentStatCache) which is consulted and updated by the compilation.
+  std::string StatCacheFile;
 };
 
 } // end namespace clang
@@ -19,8 +19,11 @@
 #include "llvm/ADT/OwningPtr.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include <string>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <vector>
 
 namespace clang {
 
@@ -75,6 +78,40 @@ public:
   /// ownership of this cache (and, transitively, all of the remaining caches)
   /// to the caller.
   FileSystemStatCache *takeNextStatCache() { return NextStatCache.take(); }
+
+  /// \brief Persist any results gathered by this cache and the remaining
+  /// caches in the chain. The default implementation only forwards.
+  virtual void flush() {
+    if (FileSystemStatCache *Next = getNextStatCache())
+      Next->flush();
+  }
+
+  /// \brief Print statistics about this cache and the remaining caches in
+  /// the chain to stderr. The default implementation only forwards.
+  virtual void PrintStats() const {
+    if (NextStatCache)
+      NextStatCache->PrintStats();
+  }
+
+  /// \brief Look up the macro that an earlier compilation found to guard the
+  /// whole of the file at the absolute path \p Path, provided that the file
+  /// is still the one described by \p Data. The default implementation only
+  /// forwards.
+  virtual bool getControllingMacro(StringRef Path, const FileData &Data,
+                                   std::string &Macro) {
+    if (FileSystemStatCache *Next = getNextStatCache())
+      return Next->getControllingMacro(Path, Data, Macro);
+    return false;
+  }
+
+  /// \brief Remember that the file at the absolute path \p Path, described
+  /// by \p Data, is guarded by \p Macro. The default implementation only
+  /// forwards.
+  virtual void setControllingMacro(StringRef Path, const FileData &Data,
+                                   StringRef Macro) {
+    if (FileSystemStatCache *Next = getNextStatCache())
+      Next->setControllingMacro(Path, Data, Macro);
+  }
   
 protected:
   virtual LookupResult getStat(const char *Path, FileData &Data, bool isFile,
@@ -110,6 +147,90 @@ public:
                                int *FileDescriptor);
 };
 
+/// \brief A stat cache whose contents are kept in a file, so that they can be
+/// memory-mapped and shared by all the compilations of a build.
+///
+/// Only absolute paths are cached. Every entry remembers the state of the
+/// directory containing the path when the entry was recorded, and is only
+/// used as long as that directory has not been modified since; creating or
+/// removing a file updates its directory and therefore invalidates the entry.
+/// Because the contents of a file can change without its directory changing,
+/// only failed lookups and directories are answered from the cache. That
+/// covers the bulk of header search, which mostly probes for files that do
+/// not exist.
+///
+/// The cache also remembers the include guards of headers, so that later
+/// compilations can skip a header whose guard macro is already defined
+/// without opening it. Those entries are only used while the file has the
+/// same identity, size and modification time.
+class PersistentStatCache : public FileSystemStatCache {
+public:
+  /// \brief A single cached lookup result.
+  struct Entry {
+    /// \brief Whether the path existed, as a directory or, for entries
+    /// recording an include guard, as a file.
+    bool Exists;
+    /// \brief Whether the parent directory existed.
+    bool ParentExists;
+    /// \brief The modification time of the parent directory, if it existed.
+    uint64_t ParentModTime;
+    /// \brief The directory's or file's data, if it existed.
+    FileData Data;
+    /// \brief The macro guarding the file, if the path is a file.
+    std::string ControllingMacro;
+  };
+
+private:
+  std::string CachePath;
+  OwningPtr<llvm::MemoryBuffer> Buffer;
+  /// \brief The on-disk hash table in \c Buffer, if any.
+  void *Table;
+  /// \brief Entries recorded by this process, which are not in \c Table yet.
+  llvm::StringMap<Entry> NewEntries;
+  /// \brief The current state of every parent directory consulted so far,
+  /// as (exists, modification time).
+  llvm::StringMap<std::pair<bool, uint64_t> > DirStates;
+  /// \brief Directories whose contents are never cached, because the
+  /// compilation itself may modify them.
+  std::vector<std::string> UncachedDirs;
+  unsigned NumHits, NumMisses;
+  bool Dirty;
+
+  std::pair<bool, uint64_t> getDirState(StringRef Dir);
+  bool lookupEntry(StringRef Path, Entry &E);
+
+public:
+  /// \brief Open the cache stored at \p CachePath. A missing or malformed
+  /// cache file is treated as an empty cache.
+  explicit PersistentStatCache(StringRef CachePath);
+  ~PersistentStatCache();
+
+  /// \brief Never cache lookups of paths within \p Dir, for example because
+  /// the compiler writes files into it.
+  void addUncachedDirectory(StringRef Dir) { UncachedDirs.push_back(Dir); }
+
+  /// \brief The number of lookups answered without going to the file system.
+  unsigned getNumHits() const { return NumHits; }
+  /// \brief The number of lookups forwarded to the next cache in the chain.
+  unsigned getNumMisses() const { return NumMisses; }
+
+  virtual LookupResult getStat(const char *Path, FileData &Data, bool isFile,
+                               int *FileDescriptor);
+
+  virtual bool getControllingMacro(StringRef Path, const FileData &Data,
+                                   std::string &Macro);
+  virtual void setControllingMacro(StringRef Path, const FileData &Data,
+                                   StringRef Macro);
+
+  /// \brief Merge the new entries into the cache file.
+  ///
+  /// The file is re-read first, to pick up entries written by other
+  /// processes in the meantime, and then atomically replaced.
+  virtual void flush();
+
+  virtual void PrintStats() const;
+};
+
 } // end namespace clang
 
 #endif
@@ -396,6 +396,10 @@ public:
   /// \returns A new iterator into the set of known identifiers. The
   /// caller is responsible for deleting this iterator.
   virtual IdentifierIterator *getIdentifiers();
+
+  /// \brief Retrieve a number that changes whenever the set of identifiers
+  /// returned by getIdentifiers() changes, allowing clients to cache it.
+  virtual unsigned getIdentifiersGeneration() const { return 0; }
 };
 
 /// \brief An abstract class used to resolve numerical identifier
@@ -411,6 +415,20 @@ public:
   virtual IdentifierInfo *GetIdentifier(unsigned ID) = 0;
 };
 
+/// \brief An abstract class used to find the builtin ID of an identifier
+/// when the identifier table creates it.
+///
+/// This lets the builtins be registered without creating an IdentifierInfo
+/// for each of them up front; most translation units use only a few.
+class BuiltinIdentifierLookup {
+public:
+  virtual ~BuiltinIdentifierLookup();
+
+  /// \brief Return the builtin ID of the given name, or 0 if it does not
+  /// name a builtin.
+  virtual unsigned getBuiltinID(StringRef Name) const = 0;
+};
+
 /// \brief Implements an efficient mapping from strings to IdentifierInfo nodes.
 ///
 /// This has no other purpose, but this is an extremely performance-critical
@@ -424,6 +442,8 @@ class IdentifierTable {
 
   IdentifierInfoLookup* ExternalLookup;
 
+  const BuiltinIdentifierLookup *BuiltinLookup;
+
 public:
   /// \brief Create the identifier table, populating it with info about the
   /// language keywords for the language specified by \p LangOpts.
@@ -439,6 +459,13 @@ public:
   IdentifierInfoLookup *getExternalIdentifierLookup() const {
     return ExternalLookup;
   }
+
+  /// \brief Set the object giving the builtin IDs of new identifiers, and
+  /// give the identifiers already in the table their builtin IDs.
+  ///
+  /// Identifiers deserialized from an AST file keep the builtin ID they were
+  /// stored with.
+  void setBuiltinLookup(const BuiltinIdentifierLookup *Lookup);
   
   llvm::BumpPtrAllocator& getAllocator() {
     return HashTable.getAllocator();
@@ -459,6 +486,8 @@ public:
       if (II) {
         // Cache in the StringMap for subsequent lookups.
         Entry.setValue(II);
+        if (BuiltinLookup && !II->isFromAST())
+          assignBuiltinID(*II, Name);
         return *II;
       }
     }
@@ -472,6 +501,9 @@ public:
     // contents.
     II->Entry = &Entry;
 
+    if (BuiltinLookup)
+      assignBuiltinID(*II, Name);
+
     return *II;
   }
 
@@ -524,6 +556,12 @@ public:
   void PrintStats() const;
 
   void AddKeywords(const LangOptions &LangOpts);
+
+private:
+  void assignBuiltinID(IdentifierInfo &II, StringRef Name) {
+    if (unsigned ID = BuiltinLookup->getBuiltinID(Name))
+      II.setBuiltinID(ID);
+  }
 };
 
 /// \brief A family of Objective-C methods. 
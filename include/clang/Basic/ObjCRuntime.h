@@ -172,6 +172,31 @@ public:
     }
   }
 
+  /// \brief Does this runtime provide entrypoints that are likely to be
+  /// faster than an ordinary message send of the "retain", "release" and
+  /// "autorelease" selectors?
+  ///
+  /// The entrypoints still send the messages to objects whose class
+  /// overrides them.
+  bool shouldUseRuntimeFunctionsForRetainRelease() const {
+    switch (getKind()) {
+    case MacOSX: return getVersion() >= VersionTuple(10, 10);
+    case iOS: return getVersion() >= VersionTuple(8);
+    default: return false;
+    }
+  }
+
+  /// \brief Does this runtime provide an objc_alloc entrypoint that is
+  /// likely to be faster than an ordinary message send of the "alloc"
+  /// selector to a class?
+  bool shouldUseRuntimeFunctionsForAlloc() const {
+    switch (getKind()) {
+    case MacOSX: return getVersion() >= VersionTuple(10, 10);
+    case iOS: return getVersion() >= VersionTuple(8);
+    default: return false;
+    }
+  }
+
   /// Does this runtime allow the use of __weak?
   bool allowsWeak() const {
     return hasNativeWeak();
@@ -286,9 +286,19 @@ public:
     if (!InfoPtr)
       InfoPtr = &InfoObj;
 
-    using namespace io;
     const internal_key_type& iKey = InfoObj.GetInternalKey(eKey);
-    unsigned key_hash = InfoObj.ComputeHash(iKey);
+    return find_hashed(iKey, InfoObj.ComputeHash(iKey), InfoPtr);
+  }
+
+  /// \brief Look up the stored data for \p iKey, whose hash the caller has
+  /// already computed as \p key_hash, avoiding recomputing it when the same
+  /// key is looked up in many tables.
+  iterator find_hashed(const internal_key_type& iKey, unsigned key_hash,
+                       Info *InfoPtr = 0) {
+    if (!InfoPtr)
+      InfoPtr = &InfoObj;
+
+    using namespace io;
 
     // Each bucket is just a 32-bit offset into the hash table file.
     unsigned idx = key_hash & (NumBuckets - 1);
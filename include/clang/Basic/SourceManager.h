@@ -436,6 +436,13 @@ public:
   /// entry from being loaded.
   virtual bool ReadSLocEntry(int ID) = 0;
 
+  /// \brief Retrieve the offset of the source location entry with index ID,
+  /// without loading the entry itself.
+  ///
+  /// \returns the offset, or zero if it cannot be determined, in which case
+  /// the entry will be loaded to find its offset.
+  virtual unsigned getSLocEntryOffset(int ID) = 0;
+
   /// \brief Retrieve the module import location and name for the given ID, if
   /// in fact it was loaded from a module (rather than, say, a precompiled
   /// header).
@@ -616,6 +623,14 @@ class SourceManager : public RefCountedBase<SourceManager> {
   /// Same indexing as LoadedSLocEntryTable.
   std::vector<bool> SLocEntryLoaded;
 
+  /// \brief The offsets of the entries of LoadedSLocEntryTable that have been
+  /// looked up without loading the entries, or zero where not yet known.
+  ///
+  /// Searching the loaded entries only needs their offsets, and loading an
+  /// entry may require finding and reading its file. Same indexing as
+  /// LoadedSLocEntryTable.
+  mutable std::vector<unsigned> LoadedSLocEntryOffsets;
+
   /// \brief An external source for source location entries.
   ExternalSLocEntrySource *ExternalSLocEntries;
 
@@ -625,6 +640,22 @@ class SourceManager : public RefCountedBase<SourceManager> {
   /// is very common to look up many tokens from the same file.
   mutable FileID LastFileIDLookup;
 
+  /// LastExpansionFileIDLookup records the last local macro expansion FileID
+  /// looked up or created.  Expansions aren't kept in LastFileIDLookup, so
+  /// that they don't evict the file being lexed, but the locations of the
+  /// tokens of an expansion tend to be looked up together too.
+  mutable FileID LastExpansionFileIDLookup;
+
+  /// FileIDLookupCache - A direct-mapped cache of the FileIDs that
+  /// getFileIDLocal found, indexed by the offset looked up, for clients that
+  /// look up locations all over the translation unit.
+  enum { FileIDLookupCacheSize = 64 };
+  mutable FileID FileIDLookupCache[FileIDLookupCacheSize];
+
+  static unsigned getFileIDLookupCacheSlot(unsigned SLocOffset) {
+    return (SLocOffset >> 6) % FileIDLookupCacheSize;
+  }
+
   /// \brief Holds information for \#line directives.
   ///
   /// This is referenced by indices from SLocEntryTable.
@@ -644,7 +675,8 @@ class SourceManager : public RefCountedBase<SourceManager> {
   FileID PreambleFileID;
 
   // Statistics for -print-stats.
-  mutable unsigned NumLinearScans, NumBinaryProbes;
+  mutable unsigned NumLinearScans, NumBinaryProbes, NumExpansionCacheHits;
+  mutable unsigned NumFileIDCacheHits;
 
   /// \brief Associates a FileID with its "included/expanded in" decomposed
   /// location.
@@ -849,6 +881,15 @@ public:
   void overrideFileContents(const FileEntry *SourceFile,
                             const FileEntry *NewFile);
 
+  /// \brief Provide the contents of \p SourceFile, read ahead of time, for
+  /// when they are first needed.
+  ///
+  /// Unlike overrideFileContents(), the buffer stands for the contents on
+  /// disk, and is only used if they weren't read or overridden already. The
+  /// source manager takes ownership of it either way.
+  void setPrefetchedFileContents(const FileEntry *SourceFile,
+                                 const llvm::MemoryBuffer *Buffer);
+
   /// \brief Returns true if the file contents have been overridden.
   bool isFileOverridden(const FileEntry *File) {
     if (OverriddenFilesInfo) {
@@ -934,6 +975,14 @@ public:
   /// \param Invalid If non-NULL, will be set true if an error occurred.
   StringRef getBufferData(FileID FID, bool *Invalid = 0) const;
 
+  /// \brief Tell the system that the contents of the file \p FID won't be
+  /// needed for a while, such as when it was lexed to the end.
+  ///
+  /// The pages of a memory mapped file are dropped, and read back from the
+  /// file when they are used again, so that the buffer and every pointer into
+  /// it stay valid. Other buffers are kept as they are.
+  void releaseFileContents(FileID FID) const;
+
   /// \brief Get the number of FileIDs (files and macros) that were created
   /// during preprocessing of \p FID, including it.
   unsigned getNumCreatedFIDsForFileID(FileID FID) const {
@@ -1546,6 +1595,10 @@ private:
 
   const SrcMgr::SLocEntry &loadSLocEntry(unsigned Index, bool *Invalid) const;
 
+  /// \brief Get the offset of the loaded entry at \p Index, loading the entry
+  /// only if the external source cannot provide the offset by itself.
+  unsigned getLoadedSLocEntryOffset(unsigned Index) const;
+
   /// \brief Get the entry with the given unwrapped FileID.
   const SrcMgr::SLocEntry &getSLocEntryByID(int ID, bool *Invalid = 0) const {
     assert(ID != -1 && "Using FileID sentinel value");
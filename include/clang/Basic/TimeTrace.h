@@ -0,0 +1,106 @@
+//===--- TimeTrace.h - Hierarchical trace of compile time -------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Defines the TimeTrace class, which records where the compiler spends
+/// its time for -ftime-trace, and the TimeTraceScope class, which records a
+/// scope of it.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_BASIC_TIMETRACE_H
+#define LLVM_CLANG_BASIC_TIMETRACE_H
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Compiler.h"
+
+namespace clang {
+
+/// \brief Records nested, named scopes of compile time, and writes them in the
+/// Chrome trace-event format, which about:tracing and most trace viewers read.
+///
+/// The recording is process-wide, so that every library can add scopes
+/// without having one passed around; when it is not enabled, beginning and
+/// ending a scope only tests a pointer.
+///
+/// Scopes are kept on separate tracks, each of which must nest properly on its
+/// own. Scopes of the preprocessor's include stack go on their own track,
+/// since a header may begin in one top-level declaration and end in another.
+class TimeTrace {
+public:
+  enum Track {
+    /// \brief Scopes of the frontend and the backend.
+    MainTrack,
+    /// \brief Scopes of the files on the include stack.
+    IncludeTrack,
+    NumTracks
+  };
+
+  /// \brief Start recording scopes.
+  static void start();
+
+  /// \brief Stop recording, and write the scopes recorded to \p OS, ending
+  /// any that have not ended yet.
+  static void finish(raw_ostream &OS);
+
+  /// \brief Determine whether scopes are being recorded.
+  static bool isEnabled() { return Instance != 0; }
+
+  /// \brief Begin a scope named \p Name (such as "ParseTopLevelDecl"), with
+  /// \p Detail (such as the name of the declaration) to tell its instances
+  /// apart.
+  static void begin(StringRef Name, StringRef Detail = StringRef(),
+                    Track T = MainTrack);
+
+  /// \brief Set the detail of the innermost scope on \p T.
+  static void setDetail(StringRef Detail, Track T = MainTrack);
+
+  /// \brief End the innermost scope on \p T.
+  static void end(Track T = MainTrack);
+
+private:
+  class Impl;
+  static Impl *Instance;
+};
+
+/// \brief Records a scope on the main track for the lifetime of the object.
+class TimeTraceScope {
+  bool Active;
+
+public:
+  explicit TimeTraceScope(StringRef Name, StringRef Detail = StringRef())
+    : Active(TimeTrace::isEnabled()) {
+    if (Active)
+      TimeTrace::begin(Name, Detail);
+  }
+
+  ~TimeTraceScope() {
+    if (Active)
+      TimeTrace::end();
+  }
+
+  /// \brief Determine whether the scope is being recorded, which tells
+  /// whether it is worth computing its detail.
+  bool isActive() const { return Active; }
+
+  /// \brief Set the detail of the scope, which must be the innermost one.
+  void setDetail(StringRef Detail) {
+    if (Active)
+      TimeTrace::setDetail(Detail);
+  }
+
+private:
+  TimeTraceScope(const TimeTraceScope &) LLVM_DELETED_FUNCTION;
+  void operator=(const TimeTraceScope &) LLVM_DELETED_FUNCTION;
+};
+
+} // end namespace clang
+
+#endif
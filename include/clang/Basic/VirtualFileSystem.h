@@ -0,0 +1,112 @@
+//===--- VirtualFileSystem.h - Virtual File System Layer --------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Defines the file systems that a FileManager can look files up in
+/// and read them from instead of the disk.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_BASIC_VIRTUALFILESYSTEM_H
+#define LLVM_CLANG_BASIC_VIRTUALFILESYSTEM_H
+
+#include "clang/Basic/FileSystemStatCache.h"
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/IntrusiveRefCntPtr.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
+#include <string>
+
+namespace llvm {
+class MemoryBuffer;
+}
+
+namespace clang {
+namespace vfs {
+
+/// \brief The files and directories a FileManager works with.
+class FileSystem : public RefCountedBase<FileSystem> {
+  virtual void anchor();
+
+public:
+  virtual ~FileSystem();
+
+  /// \brief Get the status of the file at \p Path, or of the directory if
+  /// \p IsFile is false.
+  ///
+  /// \returns \c true if there is no such file or directory.
+  virtual bool getStatus(StringRef Path, FileData &Data, bool IsFile) = 0;
+
+  /// \brief Get the contents of the file at \p Path, whose size is
+  /// \p FileSize if it is known and -1 otherwise.
+  ///
+  /// \returns the contents, owned by the caller, or null with \p ErrorStr
+  /// set if the file can't be read.
+  virtual llvm::MemoryBuffer *getBuffer(StringRef Path, std::string *ErrorStr,
+                                        int64_t FileSize,
+                                        bool RequiresNullTerminator) = 0;
+};
+
+/// \brief Returns the file system of the disk.
+IntrusiveRefCntPtr<FileSystem> getRealFileSystem();
+
+/// \brief A file system of files held in memory.
+///
+/// Files are looked up by the exact paths they were added with, and the
+/// parent directories of those paths exist as well.
+class InMemoryFileSystem : public FileSystem {
+  /// A file, or a directory without a buffer.
+  struct Entry {
+    llvm::MemoryBuffer *Buffer;
+    FileData Data;
+    Entry() : Buffer(0) {}
+  };
+  llvm::StringMap<Entry> Entries;
+
+  /// The next unique ID given to a file or directory; they all have the
+  /// same device.
+  uint64_t NextFileID;
+
+public:
+  InMemoryFileSystem() : NextFileID(0) {}
+  virtual ~InMemoryFileSystem();
+
+  /// \brief Add the file \p Path with the contents \p Buffer, taking ownership
+  /// of it. A file already at \p Path is replaced.
+  void addFile(StringRef Path, llvm::MemoryBuffer *Buffer);
+
+  virtual bool getStatus(StringRef Path, FileData &Data, bool IsFile);
+  virtual llvm::MemoryBuffer *getBuffer(StringRef Path, std::string *ErrorStr,
+                                        int64_t FileSize,
+                                        bool RequiresNullTerminator);
+};
+
+/// \brief A file system that layers other ones on top of each other.
+///
+/// A path is looked up in the file systems in the reverse order they were
+/// pushed, so that the last one overlays the others.
+class OverlayFileSystem : public FileSystem {
+  SmallVector<IntrusiveRefCntPtr<FileSystem>, 2> FileSystems;
+
+public:
+  explicit OverlayFileSystem(IntrusiveRefCntPtr<FileSystem> Base);
+
+  /// \brief Put \p FS on top of the file systems of this overlay.
+  void pushOverlay(IntrusiveRefCntPtr<FileSystem> FS);
+
+  virtual bool getStatus(StringRef Path, FileData &Data, bool IsFile);
+  virtual llvm::MemoryBuffer *getBuffer(StringRef Path, std::string *ErrorStr,
+                                        int64_t FileSize,
+                                        bool RequiresNullTerminator);
+};
+
+} // end namespace vfs
+} // end namespace clang
+
+#endif
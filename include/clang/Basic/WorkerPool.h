@@ -0,0 +1,75 @@
+//===--- WorkerPool.h - Run independent tasks on several threads -*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Defines a minimal facility for running a fixed number of
+/// independent tasks on a bounded number of worker threads, and for running
+/// a single task in the background.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_BASIC_WORKERPOOL_H
+#define LLVM_CLANG_BASIC_WORKERPOOL_H
+
+#include "llvm/Support/Compiler.h"
+
+namespace clang {
+
+/// \brief The signature of a task run by \c runTasksInParallel.
+///
+/// \param Context The opaque context pointer passed to
+/// \c runTasksInParallel.
+/// \param Index The index of the task to run, in [0, NumTasks).
+typedef void (*WorkerPoolTaskFn)(void *Context, unsigned Index);
+
+/// \brief Returns the number of worker threads to use when the user asked for
+/// \p Requested threads, where zero means "one per hardware thread".
+///
+/// The result is never zero. When LLVM was built without thread support the
+/// result is always one.
+unsigned getEffectiveWorkerCount(unsigned Requested);
+
+/// \brief Runs \p Fn for every index in [0, NumTasks), using up to
+/// \p NumThreads threads, and returns only when all tasks have finished.
+///
+/// Tasks are handed out in increasing index order, but may complete in any
+/// order; callers that need deterministic results should store them per
+/// index and merge them after this function returns. When \p NumThreads is
+/// one, or threads are unavailable, all tasks run on the calling thread in
+/// index order.
+void runTasksInParallel(unsigned NumTasks, unsigned NumThreads,
+                        WorkerPoolTaskFn Fn, void *Context);
+
+/// \brief The signature of the task run by a \c BackgroundThread.
+typedef void (*BackgroundTaskFn)(void *Context);
+
+/// \brief Runs a single task on a thread of its own.
+///
+/// The task starts when the object is constructed, and the object waits for
+/// it to finish when it is destroyed. When threads are unavailable, or a
+/// thread cannot be created, the task runs to completion on the calling
+/// thread before the constructor returns.
+class BackgroundThread {
+  void *Handle;
+
+  BackgroundThread(const BackgroundThread &) LLVM_DELETED_FUNCTION;
+  void operator=(const BackgroundThread &) LLVM_DELETED_FUNCTION;
+
+public:
+  BackgroundThread(BackgroundTaskFn Fn, void *Context);
+  ~BackgroundThread();
+
+  /// \brief Waits for the task to finish. Does nothing if it already has
+  /// been waited for.
+  void join();
+};
+
+} // end namespace clang
+
+#endif
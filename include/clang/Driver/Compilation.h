@@ -69,6 +69,12 @@ class Compilation {
   /// Redirection for stdout, stderr, etc.
   const StringRef **Redirects;
 
+  /// The maximum number of commands to run concurrently; see -j.
+  unsigned MaxParallelJobs;
+
+  /// Whether -cc1 jobs run in the driver's process; see -fintegrated-cc1.
+  bool RunCC1InProcess;
+
 public:
   Compilation(const Driver &D, const ToolChain &DefaultToolChain,
               llvm::opt::InputArgList *Args,
@@ -104,6 +110,18 @@ public:
   /// Returns the sysroot path.
   StringRef getSysRoot() const;
 
+  /// Returns the maximum number of commands ExecuteJob runs concurrently.
+  /// Zero means one per hardware thread.
+  unsigned getMaxParallelJobs() const { return MaxParallelJobs; }
+
+  void setMaxParallelJobs(unsigned N) { MaxParallelJobs = N; }
+
+  /// Returns whether ExecuteJob runs -cc1 jobs through Driver::CC1Main
+  /// instead of spawning them.
+  bool getRunCC1InProcess() const { return RunCC1InProcess; }
+
+  void setRunCC1InProcess(bool Value) { RunCC1InProcess = Value; }
+
   /// getArgsForToolChain - Return the derived argument list for the
   /// tool chain \p TC (or the default tool chain, if TC is not specified).
   ///
@@ -181,11 +199,32 @@ public:
 
   /// ExecuteJob - Execute a single job.
   ///
+  /// If more than one parallel job is allowed, the commands of a job list are
+  /// run concurrently whenever they do not depend on each other's outputs.
+  ///
   /// \param FailingCommands - For non-zero results, this will be a vector of
   /// failing commands and their associated result code.
   void ExecuteJob(const Job &J,
      SmallVectorImpl< std::pair<int, const Command *> > &FailingCommands) const;
 
+private:
+  /// PrintCommandIfRequested - Print \p C for -v and CC_PRINT_OPTIONS.
+  ///
+  /// \return False if the CC_PRINT_OPTIONS log could not be opened.
+  bool PrintCommandIfRequested(const Command &C) const;
+
+  /// CanRunInProcess - Returns whether \p C is a -cc1 job that can be run
+  /// through Driver::CC1Main.
+  bool CanRunInProcess(const Command &C) const;
+
+  /// ExecuteJobsInParallel - Execute the commands of \p Jobs, running
+  /// independent commands concurrently. The commands are always spawned, even
+  /// with -fintegrated-cc1, because the frontend is not reentrant.
+  void ExecuteJobsInParallel(const JobList &Jobs, unsigned NumWorkers,
+     SmallVectorImpl< std::pair<int, const Command *> > &FailingCommands) const;
+
+public:
+
   /// initCompilationForDiagnostics - Remove stale state and suppress output
   /// so compilation can be reexecuted to generate additional diagnostic
   /// information (e.g., preprocessed source(s)).
@@ -151,6 +151,15 @@ public:
   /// Whether the driver is generating diagnostics for debugging purposes.
   unsigned CCGenDiagnostics : 1;
 
+  /// A function that runs the frontend on the arguments of a -cc1 job, not
+  /// including "-cc1", and returns its exit status.
+  typedef int (*CC1ToolFunc)(const char **ArgBegin, const char **ArgEnd,
+                             const char *Argv0);
+
+  /// The function that runs -cc1 jobs in the driver's process for
+  /// -fintegrated-cc1, or null if the frontend is not linked in.
+  CC1ToolFunc CC1Main;
+
 private:
   /// Name to use when invoking gcc/g++.
   std::string CCCGenericGCCName;
@@ -115,6 +115,13 @@ public:
   }
 };
 
+/// setsLLVMOptions - Returns whether the -cc1 arguments \p Args set any of
+/// LLVM's command line options, either with -mllvm or through an option that
+/// the backend forwards to llvm::cl::ParseCommandLineOptions. Those options
+/// may only be given once per process, so such a job can't share its process
+/// with another one.
+bool setsLLVMOptions(ArrayRef<const char *> Args);
+
 } // end namespace driver
 } // end namespace clang
 
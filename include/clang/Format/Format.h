@@ -17,6 +17,7 @@
 
 #include "clang/Frontend/FrontendAction.h"
 #include "clang/Tooling/Refactoring.h"
+#include "llvm/Support/Timer.h"
 #include "llvm/Support/system_error.h"
 
 namespace clang {
@@ -52,6 +53,13 @@ struct FormatStyle {
   /// \brief The penalty for breaking before the first "<<".
   unsigned PenaltyBreakFirstLessLess;
 
+  /// \brief The maximum number of ways to break a line that are considered
+  /// when looking for the best one.
+  ///
+  /// When the limit is reached, the rest of the line is broken greedily. A
+  /// limit of \c 0 means that there is no limit.
+  unsigned MaxStatesPerLine;
+
   /// \brief Set whether & and * bind to the type as opposed to the variable.
   bool PointerBindsToType;
 
@@ -213,6 +221,7 @@ struct FormatStyle {
            IndentCaseLabels == R.IndentCaseLabels &&
            IndentWidth == R.IndentWidth &&
            MaxEmptyLinesToKeep == R.MaxEmptyLinesToKeep &&
+           MaxStatesPerLine == R.MaxStatesPerLine &&
            NamespaceIndentation == R.NamespaceIndentation &&
            ObjCSpaceBeforeProtocolList == R.ObjCSpaceBeforeProtocolList &&
            PenaltyBreakComment == R.PenaltyBreakComment &&
@@ -263,6 +272,32 @@ llvm::error_code parseConfiguration(StringRef Text, FormatStyle *Style);
 /// \brief Gets configuration in a YAML string.
 std::string configurationAsText(const FormatStyle &Style);
 
+/// \brief Where \c reformat() spends its time.
+///
+/// Every call of \c reformat() that is given a \c FormatStatistics adds to
+/// it, so that the totals for formatting many files can be collected.
+struct FormatStatistics {
+  FormatStatistics()
+      : NumUnwrappedLines(0), NumFormattedLines(0), NumStateNodes(0) {}
+
+  /// \brief Splitting the input into tokens.
+  llvm::TimeRecord Lexing;
+  /// \brief Grouping the tokens into unwrapped lines.
+  llvm::TimeRecord Parsing;
+  /// \brief Annotating the tokens of the lines that are looked at.
+  llvm::TimeRecord Annotating;
+  /// \brief Finding the best line breaks for the lines that are formatted.
+  llvm::TimeRecord LineFormatting;
+  /// \brief Turning the whitespace changes into replacements.
+  llvm::TimeRecord Replacements;
+
+  unsigned NumUnwrappedLines;
+  unsigned NumFormattedLines;
+  /// \brief The number of states created while searching for the best line
+  /// breaks.
+  unsigned NumStateNodes;
+};
+
 /// \brief Reformats the given \p Ranges in the token stream coming out of
 /// \c Lex.
 ///
@@ -272,16 +307,21 @@ std::string configurationAsText(const FormatStyle &Style);
 ///
 /// Returns the \c Replacements necessary to make all \p Ranges comply with
 /// \p Style.
+///
+/// If \p Statistics is not null, the time spent in each phase of formatting
+/// is added to it.
 tooling::Replacements reformat(const FormatStyle &Style, Lexer &Lex,
                                SourceManager &SourceMgr,
-                               std::vector<CharSourceRange> Ranges);
+                               std::vector<CharSourceRange> Ranges,
+                               FormatStatistics *Statistics = 0);
 
 /// \brief Reformats the given \p Ranges in \p Code.
 ///
 /// Otherwise identical to the reformat() function consuming a \c Lexer.
 tooling::Replacements reformat(const FormatStyle &Style, StringRef Code,
                                std::vector<tooling::Range> Ranges,
-                               StringRef FileName = "<stdin>");
+                               StringRef FileName = "<stdin>",
+                               FormatStatistics *Statistics = 0);
 
 /// \brief Returns the \c LangOpts that the formatter expects you to set.
 ///
@@ -44,6 +44,11 @@ ASTConsumer *CreateASTDeclNodeLister();
 // format; this is intended for particularly intense debugging.
 ASTConsumer *CreateASTDumperXML(raw_ostream &OS);
 
+// AST exporter: writes the declarations and statements of the AST to OS in
+// a compact binary format, read by ASTExportReader, for tools that analyze
+// ASTs outside of clang.
+ASTConsumer *CreateASTExporter(raw_ostream &OS);
+
 // Graphical AST viewer: for each function definition, creates a graph of
 // the AST and displays it with the graph viewer "dotty".  Also outputs
 // function declarations to stderr.
@@ -0,0 +1,124 @@
+//===--- ASTExportReader.h - Read binary AST exports ------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the format written by -ast-export-binary, and a reader
+// for it.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_FRONTEND_ASTEXPORTREADER_H
+#define LLVM_CLANG_FRONTEND_ASTEXPORTREADER_H
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/DataTypes.h"
+#include <vector>
+
+namespace clang {
+
+/// \brief The binary AST export format.
+///
+/// An export starts with the magic bytes "CLAX" and the version, followed by
+/// records, each starting with its code, until the end record. All numbers
+/// are unsigned LEB128. The records are:
+///
+/// - string: the length and the bytes of the next string of the string
+///   table. The strings are numbered from 1, and each is written before the
+///   first record that refers to it.
+/// - node: whether the node is a declaration or a statement, the strings of
+///   its kind and its file, the line and column its source range begins and
+///   ends at, the string of its name and of its type, and its parent. Strings
+///   that are 0 are empty. The nodes are numbered from 1 and written before
+///   their children; the parent is 0 for the translation unit.
+///
+/// Each record can be read once the ones before it are, so an export can be
+/// written and read as a stream.
+namespace ast_export {
+  const char Magic[] = { 'C', 'L', 'A', 'X' };
+  const unsigned Version = 1;
+
+  enum RecordCode {
+    REC_End = 0,
+    REC_String = 1,
+    REC_Node = 2
+  };
+
+  enum NodeClass {
+    NC_Decl = 0,
+    NC_Stmt = 1
+  };
+}
+
+/// \brief A node read from a binary AST export. Its strings point into the
+/// export.
+struct ASTExportNode {
+  /// The number of the node, from 1.
+  unsigned Index;
+  /// The number of the node's parent, or 0.
+  unsigned Parent;
+  ast_export::NodeClass Class;
+  /// The name of the kind of the node, such as "Function" or "CallExpr".
+  StringRef Kind;
+  StringRef File;
+  unsigned BeginLine, BeginColumn, EndLine, EndColumn;
+  /// The name of the declaration, or of the one that an expression refers
+  /// to, if any.
+  StringRef Name;
+  /// The type of the declaration or expression, if any.
+  StringRef Type;
+};
+
+/// \brief Reads the nodes of a binary AST export one at a time.
+///
+/// \code
+///   ASTExportReader Reader(Buffer->getBuffer());
+///   ASTExportNode Node;
+///   while (Reader.readNode(Node))
+///     ...
+///   if (Reader.hasError())
+///     ...
+/// \endcode
+class ASTExportReader {
+  StringRef Data;
+  size_t Pos;
+  bool Error;
+  bool AtEnd;
+  unsigned NumNodes;
+  std::vector<StringRef> Strings;
+
+  bool readNumber(uint64_t &Value);
+  bool readNumber(unsigned &Value);
+  bool readString(StringRef &Str);
+  bool fail() {
+    Error = true;
+    return false;
+  }
+
+public:
+  /// \brief Starts reading the export \p Data, which must outlive the reader
+  /// and the nodes it reads.
+  explicit ASTExportReader(StringRef Data);
+
+  /// \brief Reads the next node into \p Node. Returns false at the end of
+  /// the export, or if it is malformed.
+  bool readNode(ASTExportNode &Node);
+
+  /// \brief Whether the export is malformed, or has a version this reader
+  /// doesn't know.
+  bool hasError() const { return Error; }
+
+  /// \brief The strings read so far, by number. The one numbered 0 is
+  /// empty.
+  ArrayRef<StringRef> getStrings() const { return Strings; }
+};
+
+} // end namespace clang
+
+#endif
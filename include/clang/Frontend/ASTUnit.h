@@ -27,6 +27,7 @@
 #include "clang/Sema/CodeCompleteConsumer.h"
 #include "clang/Sema/Sema.h"
 #include "clang/Serialization/ASTBitCodes.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/IntrusiveRefCntPtr.h"
 #include "llvm/ADT/OwningPtr.h"
 #include "llvm/ADT/SmallVector.h"
@@ -105,6 +106,18 @@ private:
   /// \brief Track whether the main file was loaded from an AST or not.
   bool MainFileIsAST;
 
+  /// \brief Whether the AST has been released until the translation unit is
+  /// used again (see \c hibernate).
+  bool Hibernated;
+
+  /// \brief The AST file that the translation unit was written to when it
+  /// last hibernated, if it has not been reparsed since.
+  std::string HibernationFile;
+
+  /// \brief The diagnostics of the translation unit as they were when it was
+  /// written to \c HibernationFile.
+  SmallVector<StoredDiagnostic, 4> HibernatedDiagnostics;
+
   /// \brief What kind of translation unit this AST represents.
   TranslationUnitKind TUKind;
 
@@ -205,7 +218,47 @@ public:
     return Preamble;
   }
 
+  /// \brief The signature of the function notified when a precompiled
+  /// preamble built in the background is ready.
+  ///
+  /// \param Context The context pointer given along with the function.
+  /// \param Succeeded Whether a new precompiled preamble was produced.
+  typedef void (*PreambleRebuiltCallback)(void *Context, bool Succeeded);
+
 private:
+  struct BackgroundPreamble;
+
+  /// \brief Whether an out-of-date precompiled preamble should keep being
+  /// used while its replacement is built on another thread.
+  bool RebuildPreambleInBackground;
+
+  /// \brief Whether the precompiled preamble is being used although some
+  /// file that it includes changed, which ASTReader must then not diagnose.
+  bool PreambleOutOfDate;
+
+  /// \brief The function to notify, and its context, when a preamble built
+  /// in the background is ready.
+  PreambleRebuiltCallback PreambleRebuiltFn;
+  void *PreambleRebuiltContext;
+
+  /// \brief The precompiled preamble being built in the background, if any.
+  OwningPtr<BackgroundPreamble> PendingPreamble;
+
+  /// \brief Whether the precompiled preamble should also cover the top-level
+  /// declarations of the main file that precede the first edit.
+  bool ReparseIncrementally;
+
+  /// \brief Whether the precompiled preamble may be shared with the other
+  /// ASTUnits that parse the same main file with the same preamble, remapped
+  /// files and options.
+  bool SharePreambles;
+
+  /// \brief The offsets in the main file, in increasing order, at which a
+  /// precompiled preamble may end right after a top-level declaration.
+  std::vector<unsigned> DeclBoundaries;
+
+  /// \brief The contents of the main file that \c DeclBoundaries refer to.
+  std::string DeclBoundariesMainFile;
 
   /// \brief The contents of the preamble that has been precompiled to
   /// \c PreambleFile.
@@ -275,6 +328,22 @@ private:
 
   void clearFileLevelDecls();
 
+  /// \brief Read the AST file \p Filename into a new preprocessor, AST
+  /// context and semantic analysis object, using the existing file and source
+  /// managers and header search.
+  ///
+  /// \returns true if the file could not be read.
+  bool readASTFile(const std::string &Filename,
+                   bool AllowPCHWithCompilerErrors);
+
+  /// \brief Release the AST, the preprocessor and the objects that depend on
+  /// them.
+  void releaseAST();
+
+  /// \brief Forget about the AST file written when hibernating, once the
+  /// translation unit is about to be parsed from source again.
+  void stopHibernating();
+
 public:
   /// \brief A cached code-completion result, which may be introduced in one of
   /// many different contexts.
@@ -346,6 +415,29 @@ private:
   /// \brief A mapping from the formatted type name to a unique number for that
   /// type, which is used for type equality comparisons.
   llvm::StringMap<unsigned> CachedCompletionTypes;
+
+  /// \brief The cached code-completion strings for the results declared in one
+  /// file of the preamble, which can be reused when the cache is refreshed as
+  /// long as the file has not changed.
+  struct CachedCompletionFile {
+    /// \brief The size and modification time of the file when its strings
+    /// were created, as in \c FilesInPreamble.
+    std::pair<off_t, time_t> Stamp;
+
+    /// \brief The strings, keyed by the offset of the declaration or macro
+    /// definition in the file and the kind of result (see
+    /// \c CacheCodeCompletionResults).
+    llvm::DenseMap<uint64_t, CodeCompletionString *> Strings;
+  };
+
+  /// \brief The reusable cached code-completion strings, by file name.
+  llvm::StringMap<CachedCompletionFile> CachedCompletionFiles;
+
+  /// \brief The number of code-completion strings that have been created in
+  /// \c CachedCompletionAllocator, including the ones no longer cached.
+  ///
+  /// Once most of them are dead, the cache is rebuilt in a fresh allocator.
+  unsigned NumCachedCompletionStringsAllocated;
   
   /// \brief A string hash of the top-level declaration and macro definition 
   /// names processed the last time that we reparsed the file.
@@ -372,6 +464,13 @@ private:
   /// \brief Cache any "global" code-completion results, so that we can avoid
   /// recomputing them with each completion.
   void CacheCodeCompletionResults();
+
+  /// \brief Returns the cached code-completion string for \p Result, reusing
+  /// the one in \p OldFiles if its file has not changed.
+  CodeCompletionString *
+  getCachedCompletionString(CodeCompletionResult &Result, unsigned ResultKind,
+                            CodeCompletionTUInfo &CCTUInfo,
+                            llvm::StringMap<CachedCompletionFile> &OldFiles);
   
   /// \brief Clear out and deallocate 
   void ClearCachedCompletionResults();
@@ -383,38 +482,78 @@ private:
 
   void CleanTemporaryFiles();
   bool Parse(llvm::MemoryBuffer *OverrideMainBuffer);
+
+  /// \brief Parse the main file again, with the files currently remapped by
+  /// the invocation, reusing or rebuilding the precompiled preamble.
+  bool ParseRemappedFiles();
   
   std::pair<llvm::MemoryBuffer *, std::pair<unsigned, bool> >
   ComputePreamble(CompilerInvocation &Invocation, 
                   unsigned MaxLines, bool &CreatedBuffer);
   
+  /// \brief Use the precompiled preamble registered under \p Key by another
+  /// ASTUnit, if there is one and it suits \p MainBuffer.
+  ///
+  /// \returns the padded main file buffer to parse with the preamble, or
+  /// null if there is no such preamble.
+  llvm::MemoryBuffer *
+  useSharedPreamble(StringRef Key, llvm::MemoryBuffer *MainBuffer,
+                    std::pair<unsigned, bool> PreambleBounds,
+                    CompilerInvocation &PreambleInvocation);
+
+  /// \brief Let other ASTUnits whose preambles have the given key use the
+  /// preamble this ASTUnit just precompiled.
+  void sharePreamble(StringRef Key);
+
   llvm::MemoryBuffer *getMainBufferWithPrecompiledPreamble(
                                const CompilerInvocation &PreambleInvocationIn,
                                                      bool AllowRebuild = true,
                                                         unsigned MaxLines = 0);
+
+  /// \brief Start building the preamble of \p PreambleInvocation on another
+  /// thread, unless a build is already under way.
+  void startBackgroundPreambleBuild(
+                                 const CompilerInvocation &PreambleInvocation);
+
+  /// \brief If the preamble being built in the background is ready, take it
+  /// over in place of the current one, provided that it was built for the
+  /// preamble \p NewPreamble bounds in \p MainBuffer.
+  void adoptBackgroundPreamble(const llvm::MemoryBuffer *MainBuffer,
+                               std::pair<unsigned, bool> NewPreamble);
+
+  /// \brief Extend the bounds of the preamble of \p MainBuffer, as computed
+  /// from its directives, over the top-level declarations that are unchanged
+  /// since the last parse.
+  std::pair<unsigned, bool>
+  getIncrementalPreambleBounds(const llvm::MemoryBuffer *MainBuffer,
+                               std::pair<unsigned, bool> DirectiveBounds,
+                               unsigned MaxLines);
+
+  /// \brief Recompute \c DeclBoundaries from the top-level declarations of
+  /// the parse that just finished.
+  void recordDeclBoundaries(bool UsedPreamble);
   void RealizeTopLevelDeclsFromPreamble();
 
   /// \brief Transfers ownership of the objects (like SourceManager) from
   /// \param CI to this ASTUnit.
   void transferASTDataFromCompilerInstance(CompilerInstance &CI);
 
-  /// \brief Allows us to assert that ASTUnit is not being used concurrently,
-  /// which is not supported.
+  /// \brief Serializes the uses of an ASTUnit from different threads, which
+  /// cannot run concurrently.
   ///
   /// Clients should create instances of the ConcurrencyCheck class whenever
   /// using the ASTUnit in a way that isn't intended to be concurrent, which is
-  /// just about any usage.
-  /// Becomes a noop in release mode; only useful for debug mode checking.
+  /// just about any usage. A thread that creates one waits until no other
+  /// thread holds one for the same ASTUnit; the same thread may nest them.
   class ConcurrencyState {
-#ifndef NDEBUG
-    void *Mutex; // a llvm::sys::MutexImpl in debug;
-#endif
+    void *Mutex; // a llvm::sys::MutexImpl
 
   public:
     ConcurrencyState();
     ~ConcurrencyState();
 
     void start();
+    bool tryStart();
     void finish();
   };
   ConcurrencyState ConcurrencyCheckValue;
@@ -485,6 +624,39 @@ public:
   bool getOwnsRemappedFileBuffers() const { return OwnsRemappedFileBuffers; }
   void setOwnsRemappedFileBuffers(bool val) { OwnsRemappedFileBuffers = val; }
 
+  /// \brief Keep using an out-of-date precompiled preamble while a new one is
+  /// built on another thread.
+  ///
+  /// This only applies when the preamble of the main file is unchanged and
+  /// some file that it includes changed. Reparses and code completion go on
+  /// using the old preamble, which may no longer match the included files,
+  /// until one of the reparses that follow the end of the build takes the
+  /// new preamble over.
+  void setRebuildPreambleInBackground(bool Val) {
+    RebuildPreambleInBackground = Val;
+  }
+
+  /// \brief Set the function to notify when a preamble built in the
+  /// background is ready.
+  ///
+  /// The function is called on the thread that built the preamble, and only
+  /// for builds started after it was set.
+  void setPreambleRebuiltCallback(PreambleRebuiltCallback Fn, void *Context) {
+    PreambleRebuiltFn = Fn;
+    PreambleRebuiltContext = Context;
+  }
+
+  /// \brief Precompile, along with the preamble, the top-level declarations
+  /// of the main file that precede the first edit, so that reparses only
+  /// parse the main file from there on.
+  ///
+  /// The precompiled part ends after the last top-level declaration of the
+  /// previous parse that lies wholly before the first change, outside of any
+  /// braces or conditional directives and before any error. The preamble is
+  /// rebuilt when an edit reaches into it. Where no such declaration exists,
+  /// as in Objective-C, only the directives are precompiled, as usual.
+  void setReparseIncrementally(bool Val) { ReparseIncrementally = Val; }
+
   StringRef getMainFileName() const;
 
   /// \brief If this ASTUnit came from an AST file, returns the filename for it.
@@ -784,6 +956,7 @@ public:
                                       bool SkipFunctionBodies = false,
                                       bool UserFilesAreVolatile = false,
                                       bool ForSerialization = false,
+                                      bool SharePreamble = false,
                                       OwningPtr<ASTUnit> *ErrAST = 0);
   
   /// \brief Reparse the source files using the same command-line options that
@@ -834,6 +1007,34 @@ public:
   ///
   /// \returns True if an error occurred, false otherwise.
   bool serialize(raw_ostream &OS);
+
+  /// \brief Write the AST of this translation unit to a temporary file and
+  /// release the AST, the preprocessor and the source manager, until
+  /// \c wakeUp is called.
+  ///
+  /// Only translation units parsed from source can hibernate. The objects
+  /// that refer to the released AST, such as declarations and source
+  /// locations, become invalid.
+  ///
+  /// \returns true if the translation unit could not hibernate, e.g. because
+  /// another thread is using it.
+  bool hibernate();
+
+  /// \brief Whether the translation unit has hibernated and not been woken
+  /// up since.
+  bool isHibernating() const { return Hibernated; }
+
+  /// \brief Reload the AST of a hibernating translation unit from the file
+  /// it was written to.
+  ///
+  /// Until it is reparsed, the translation unit then behaves as one loaded
+  /// from an AST file. If the file is out of date, because one of the files
+  /// it was parsed from changed since, it is parsed from source again
+  /// instead.
+  ///
+  /// \returns true if the translation unit no longer contains any
+  /// translation-unit information, as with \c Reparse.
+  bool wakeUp();
   
   virtual ModuleLoadResult loadModule(SourceLocation ImportLoc,
                                       ModuleIdPath Path,
@@ -14,6 +14,7 @@
 #ifndef LLVM_CLANG_FRONTEND_CODEGENOPTIONS_H
 #define LLVM_CLANG_FRONTEND_CODEGENOPTIONS_H
 
+#include "clang/Basic/LangOptions.h"
 #include <string>
 #include <vector>
 
@@ -87,6 +88,12 @@ public:
   /// The version string to put into coverage files.
   char CoverageVersion[4];
 
+  /// The profile data file to use with -fprofile-instr-use.
+  std::string InstrProfileInput;
+
+  /// The sampling profile to use with -fprofile-sample-use.
+  std::string SampleProfileFile;
+
   /// Enable additional debugging information.
   std::string DebugPass;
 
@@ -121,6 +128,10 @@ public:
   /// Path to blacklist file for sanitizers.
   std::string SanitizerBlacklistFile;
 
+  /// The sanitizers whose failed checks trap instead of calling the runtime,
+  /// from -fsanitize-trap=.
+  SanitizerOptions SanitizeTrap;
+
   /// If not an empty string, trap intrinsics are lowered to calls to this
   /// function instead of to trap instructions.
   std::string TrapFuncName;
@@ -128,6 +139,11 @@ public:
   /// A list of command-line options to forward to the LLVM backend.
   std::vector<std::string> BackendOptions;
 
+  /// The GPU binaries, such as the fat binaries of the device side of a CUDA
+  /// translation unit, to embed in the host object and register with the
+  /// CUDA runtime.
+  std::vector<std::string> CudaGpuBinaryFileNames;
+
 public:
   // Define accessors/mutators for code generation options of enumeration type.
 #define CODEGENOPT(Name, Bits, Default)
@@ -144,6 +160,7 @@ public:
 
     RelocationModel = "pic";
     memcpy(CoverageVersion, "402*", 4);
+    SanitizeTrap = SanitizerOptions::Disabled;
   }
 };
 
@@ -41,6 +41,10 @@ public:
 
   /// \brief The file to write GraphViz-formatted header dependencies to.
   std::string DOTOutputFile;
+
+  /// \brief The file to write the time, bytes, tokens and declarations that
+  /// each included file costs to, as JSON.
+  std::string HeaderProfileFile;
   
 public:
   DependencyOutputOptions() {
@@ -39,6 +39,7 @@ class FrontendAction {
   CompilerInstance *Instance;
   friend class ASTMergeAction;
   friend class WrapperFrontendAction;
+  friend class MultiplexFrontendAction;
 
 private:
   ASTConsumer* CreateWrappedASTConsumer(CompilerInstance &CI,
@@ -286,6 +287,33 @@ public:
   virtual bool hasCodeCompletionSupport() const;
 };
 
+/// \brief A frontend action which runs several AST consumer-based actions
+/// over a single parse of the input.
+///
+/// The consumers of all the actions see the same AST, through a
+/// MultiplexConsumer, in the order the actions were given.
+class MultiplexFrontendAction : public ASTFrontendAction {
+  std::vector<FrontendAction *> Actions;
+
+protected:
+  virtual ASTConsumer *CreateASTConsumer(CompilerInstance &CI,
+                                         StringRef InFile);
+  virtual bool BeginInvocation(CompilerInstance &CI);
+  virtual bool BeginSourceFileAction(CompilerInstance &CI,
+                                     StringRef Filename);
+  virtual void EndSourceFileAction();
+
+public:
+  /// Construct a MultiplexFrontendAction from existing actions, none of
+  /// which may use the preprocessor only, taking ownership of them.
+  explicit MultiplexFrontendAction(ArrayRef<FrontendAction *> Actions);
+  ~MultiplexFrontendAction();
+
+  virtual TranslationUnitKind getTranslationUnitKind();
+  virtual bool hasPCHSupport() const;
+  virtual bool hasASTFileSupport() const;
+};
+
 }  // end namespace clang
 
 #endif
@@ -62,6 +62,12 @@ protected:
                                          StringRef InFile);
 };
 
+class ASTExportAction : public ASTFrontendAction {
+protected:
+  virtual ASTConsumer *CreateASTConsumer(CompilerInstance &CI,
+                                         StringRef InFile);
+};
+
 class ASTViewAction : public ASTFrontendAction {
 protected:
   virtual ASTConsumer *CreateASTConsumer(CompilerInstance &CI,
@@ -222,6 +228,11 @@ protected:
   void ExecuteAction();
 };
 
+class RawLexOnlyAction : public PreprocessorFrontendAction {
+protected:
+  void ExecuteAction();
+};
+
 class PrintPreprocessedAction : public PreprocessorFrontendAction {
 protected:
   void ExecuteAction();
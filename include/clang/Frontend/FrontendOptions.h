@@ -27,6 +27,7 @@ namespace frontend {
     ASTDeclList,            ///< Parse ASTs and list Decl nodes.
     ASTDump,                ///< Parse ASTs and dump them.
     ASTDumpXML,             ///< Parse ASTs and dump them in XML.
+    ASTExport,              ///< Parse ASTs and export them in binary.
     ASTPrint,               ///< Parse ASTs and print them.
     ASTView,                ///< Parse ASTs and view them in Graphviz.
     DumpRawTokens,          ///< Dump out raw tokens.
@@ -49,6 +50,7 @@ namespace frontend {
     PrintDeclContext,       ///< Print DeclContext and their Decls.
     PrintPreamble,          ///< Print the "preamble" of the input file
     PrintPreprocessedInput, ///< -E mode.
+    RawLexOnly,             ///< Just run the raw lexer, no output.
     RewriteMacros,          ///< Expand macros but not \#includes.
     RewriteObjC,            ///< ObjC->C Rewriter.
     RewriteTest,            ///< Rewriter playground
@@ -144,6 +146,8 @@ public:
                                            ///< global module index if needed.
   unsigned ASTDumpLookups : 1;             ///< Whether we include lookup table
                                            ///< dumps in AST dumps.
+  unsigned CompressASTFiles : 1;           ///< Whether to compress the PCH
+                                           ///< and module files we write.
 
   CodeCompleteOptions CodeCompleteOpts;
 
@@ -211,6 +215,18 @@ public:
   /// \brief File name of the file that will provide record layouts
   /// (in the format produced by -fdump-record-layouts).
   std::string OverrideRecordLayoutsFile;
+
+  /// \brief File name of the file to write the profile of template
+  /// instantiation to (-ftemplate-profile=).
+  std::string TemplateProfileFile;
+
+  /// \brief File name of the file to write the trace of where the compiler
+  /// spent its time to (-ftime-trace=).
+  std::string TimeTraceFile;
+
+  /// \brief File name of the file to write the report of the memory used by
+  /// each part of the front end to (-fmemory-report=).
+  std::string MemoryReportFile;
   
 public:
   FrontendOptions() :
@@ -220,6 +236,7 @@ public:
     FixToTemporaries(false), ARCMTMigrateEmitARCErrors(false),
     SkipFunctionBodies(false), UseGlobalModuleIndex(true),
     GenerateGlobalModuleIndex(true), ASTDumpLookups(false),
+    CompressASTFiles(false),
     ARCMTAction(ARCMT_None), ObjCMTAction(ObjCMT_None),
     ProgramAction(frontend::ParseSyntaxOnly)
   {}
@@ -17,9 +17,12 @@
 #define LLVM_CLANG_FRONTEND_TEXT_DIAGNOSTIC_H_
 
 #include "clang/Frontend/DiagnosticRenderer.h"
+#include "llvm/ADT/OwningPtr.h"
 
 namespace clang {
 
+struct SourceColumnMap;
+
 /// \brief Class to encapsulate the logic for formatting and printing a textual
 /// diagnostic message.
 ///
@@ -35,6 +38,9 @@ namespace clang {
 class TextDiagnostic : public DiagnosticRenderer {
   raw_ostream &OS;
 
+  /// \brief The column map of the last source line that was printed.
+  OwningPtr<const SourceColumnMap> LastColumnMap;
+
 public:
   TextDiagnostic(raw_ostream &OS,
                  const LangOptions &LangOpts,
@@ -95,6 +95,22 @@ void AttachHeaderIncludeGen(Preprocessor &PP, bool ShowAllHeaders = false,
                             StringRef OutputPath = "",
                             bool ShowDepth = true);
 
+/// CreateIncludeProfiler - Create an include profiler, and attach it to the
+/// given preprocessor.
+///
+/// \returns the AST consumer that counts the declarations of each included
+/// file, and writes the cost of each of them to \p OutputFile as JSON at the
+/// end of the translation unit.
+ASTConsumer *CreateIncludeProfiler(Preprocessor &PP, StringRef OutputFile);
+
+/// WriteMemoryReport - Write the memory held by the AST context, the
+/// preprocessor, the source manager and Sema of the given compiler instance,
+/// whichever of them it has, to \p OutputFile as JSON.
+///
+/// The declarations and statements of each kind are only counted once
+/// Decl::EnableStatistics() and Stmt::EnableStatistics() have been called.
+void WriteMemoryReport(CompilerInstance &CI, StringRef OutputFile);
+
 /// CacheTokens - Cache tokens for use with PCH. Note that this requires
 /// a seekable stream.
 void CacheTokens(Preprocessor &PP, llvm::raw_fd_ostream* OS);
@@ -0,0 +1,49 @@
+//===--- DependencyDirectives.h - Minimize sources for dep scans -*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Defines a function that reduces a source file to the preprocessor
+/// directives that can affect which files it includes.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_LEX_DEPENDENCYDIRECTIVES_H
+#define LLVM_CLANG_LEX_DEPENDENCYDIRECTIVES_H
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+
+namespace clang {
+
+class LangOptions;
+
+/// \brief Reduces \p Input to the directives that determine its dependencies.
+///
+/// The result keeps, verbatim and in order, every \#include, \#include_next,
+/// \#import, \#__include_macros, \#define, \#undef and conditional directive,
+/// the \#pragmas that affect inclusion (once, push_macro, pop_macro,
+/// include_alias and system_header), and \@import declarations. Everything
+/// else is dropped, so preprocessing the result visits the same files as
+/// preprocessing \p Input, with far fewer tokens to lex.
+///
+/// Source locations in the result do not correspond to those in \p Input,
+/// so it is only suitable for discovering dependencies.
+///
+/// \param Input The contents of the file, which must be null-terminated.
+/// \param Output Receives the minimized contents.
+/// \returns false if \p Input could not be minimized, in which case it should
+/// be used unchanged.
+bool minimizeSourceToDependencyDirectives(StringRef Input,
+                                          const LangOptions &LangOpts,
+                                          SmallVectorImpl<char> &Output);
+
+} // end namespace clang
+
+#endif
@@ -32,6 +32,7 @@ class FileEntry;
 class FileManager;
 class HeaderSearchOptions;
 class IdentifierInfo;
+class IdentifierTable;
 
 /// \brief The preprocessor keeps track of this information for each
 /// file that is \#included.
@@ -215,6 +216,24 @@ class HeaderSearch {
   
   /// \brief Describes whether a given directory has a module map in it.
   llvm::DenseMap<const DirectoryEntry *, bool> DirectoryHasModuleMap;
+
+  /// \brief The lowercased names of the entries of each search directory in
+  /// which a lookup has failed, or null if the directory couldn't be read.
+  ///
+  /// A header whose first path component isn't in the listing can't be in
+  /// the directory, which saves a stat for each search directory that a
+  /// header isn't in.  Names are compared without case, so that this stays
+  /// correct on case-insensitive file systems.
+  llvm::DenseMap<const DirectoryEntry *, llvm::StringSet<> *>
+    DirectoryContents;
+
+  /// \brief The names that follow a \c module keyword in each module map
+  /// file that lookupModule scanned, with "*" standing for any name.
+  ///
+  /// lookupModule only parses the module maps in the subdirectories of a
+  /// search directory that may declare the module it is looking for; the
+  /// others are left for whatever else loads them.
+  llvm::DenseMap<const FileEntry *, llvm::StringSet<> *> ModuleMapNames;
   
   /// \brief Uniqued set of framework names, which is used to track which 
   /// headers were included as framework headers.
@@ -230,7 +249,10 @@ class HeaderSearch {
   // Various statistics we track for performance analysis.
   unsigned NumIncluded;
   unsigned NumMultiIncludeFileOptzn;
+  unsigned NumCachedControllingMacroOptzn;
   unsigned NumFrameworkLookups, NumSubFrameworkLookups;
+  unsigned NumListedDirectories, NumStatsAvoided;
+  unsigned NumModuleMapsSkipped;
 
   // HeaderSearch doesn't support default or copy construction.
   HeaderSearch(const HeaderSearch&) LLVM_DELETED_FUNCTION;
@@ -397,9 +419,14 @@ public:
   /// \brief Mark the specified file as a target of of a \#include,
   /// \#include_next, or \#import directive.
   ///
+  /// \param CachedGuardNames If non-null, the controlling macros that earlier
+  /// compilations recorded in the stat caches may be used to skip a file that
+  /// has not been entered yet; their names are looked up in this table.
+  ///
   /// \return false if \#including the file will have no effect or true
   /// if we should include it.
-  bool ShouldEnterIncludeFile(const FileEntry *File, bool isImport);
+  bool ShouldEnterIncludeFile(const FileEntry *File, bool isImport,
+                              IdentifierTable *CachedGuardNames = 0);
 
 
   /// \brief Return whether the specified file is a normal header,
@@ -489,6 +516,14 @@ public:
   
   void IncrementFrameworkLookupCount() { ++NumFrameworkLookups; }
 
+  /// \brief Determine whether the file \p Filename, relative to the
+  /// directory \p Dir, is known not to exist from a listing of \p Dir.
+  bool isKnownMissing(const DirectoryEntry *Dir, StringRef Filename);
+
+  /// \brief Note that a lookup in the directory \p Dir has failed, which
+  /// reads a listing of \p Dir for isKnownMissing to use.
+  void noteMissingFile(const DirectoryEntry *Dir);
+
   /// \brief Determine whether there is a module map that may map the header
   /// with the given file name to a (sub)module.
   ///
@@ -541,7 +576,15 @@ private:
 
   /// \brief Load all of the module maps within the immediate subdirectories
   /// of the given search directory.
-  void loadSubdirectoryModuleMaps(DirectoryLookup &SearchDir);
+  ///
+  /// \param ModuleName If non-empty, only load the module maps that may
+  /// declare the module with this name.
+  void loadSubdirectoryModuleMaps(DirectoryLookup &SearchDir,
+                                  StringRef ModuleName = StringRef());
+
+  /// \brief Determine whether the module map \p File, if there is one, may
+  /// declare a module named \p ModuleName, without parsing it.
+  bool moduleMapMayDeclare(const FileEntry *File, StringRef ModuleName);
 
 public:
   /// \brief Retrieve the module map.
@@ -89,6 +89,15 @@ public:
   /// \brief The directory used for the module cache.
   std::string ModuleCachePath;
 
+  /// \brief The directory that the paths of the inputs of the modules built
+  /// are written relative to, and that they are looked up in when the module
+  /// files are read, if not empty.
+  ///
+  /// The module files in the cache then refer to each other by their names
+  /// alone, so the module cache can be moved, or shared between machines
+  /// that keep the sources under different directories.
+  std::string ModulesRelocatableRoot;
+
   /// \brief Whether we should disable the use of the hash string within the
   /// module cache.
   ///
@@ -0,0 +1,98 @@
+//===--- IncludePrefetcher.h - Read included files ahead of time -*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Defines the IncludePrefetcher, which looks up and reads the files
+/// that are likely to be included on a background thread.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_LEX_INCLUDEPREFETCHER_H
+#define LLVM_CLANG_LEX_INCLUDEPREFETCHER_H
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/OwningPtr.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringSet.h"
+#include "llvm/Support/Compiler.h"
+#include "llvm/Support/Mutex.h"
+#include <string>
+#include <vector>
+
+namespace llvm {
+class MemoryBuffer;
+}
+
+namespace clang {
+
+class BackgroundThread;
+class FileEntry;
+class HeaderSearch;
+class SourceManager;
+
+/// \brief Looks up and reads the files that the files being preprocessed are
+/// likely to include, before their \#include directives are reached.
+///
+/// Each file entered is scanned for the lines that look like inclusions, and
+/// the paths that the header search would try for them are checked in order
+/// on a background thread, up to the first that exists, which is read. The
+/// results of those checks answer the stats of the file manager, and the
+/// contents are handed to the source manager when the file is included, so
+/// that file systems with a high latency are waited on in parallel with the
+/// preprocessing. Anything that isn't ready in time is looked up and read as
+/// usual on the preprocessing thread.
+class IncludePrefetcher {
+public:
+  class PrefetchedStatCache;
+
+private:
+  SourceManager &SourceMgr;
+  HeaderSearch &HeaderInfo;
+
+  /// The stat cache that answers from the checks done so far, which is owned
+  /// by the file manager.
+  PrefetchedStatCache *StatCache;
+
+  /// The paths to try in order for each inclusion found, and whether a
+  /// background thread is working on them, guarded by Lock.
+  llvm::sys::Mutex Lock;
+  std::vector<std::vector<std::string> > Queue;
+  bool WorkerRunning;
+
+  /// The contents of the files that were read, by path, guarded by Lock.
+  llvm::StringMap<llvm::MemoryBuffer *> Buffers;
+
+  OwningPtr<BackgroundThread> Worker;
+
+  /// The paths that were queued already, only used by the preprocessing
+  /// thread.
+  llvm::StringSet<> Requested;
+
+  static void runWorker(void *Context);
+  void prefetch(const std::vector<std::string> &Candidates);
+
+  IncludePrefetcher(const IncludePrefetcher &) LLVM_DELETED_FUNCTION;
+  void operator=(const IncludePrefetcher &) LLVM_DELETED_FUNCTION;
+
+public:
+  IncludePrefetcher(SourceManager &SourceMgr, HeaderSearch &HeaderInfo);
+  ~IncludePrefetcher();
+
+  /// \brief Start looking up and reading the files included by \p File,
+  /// whose contents are \p Buffer.
+  void scanFile(const FileEntry *File, const llvm::MemoryBuffer *Buffer);
+
+  /// \brief Hand the contents of \p File to the source manager, if they were
+  /// read already.
+  void provideContents(const FileEntry *File);
+};
+
+} // end namespace clang
+
+#endif
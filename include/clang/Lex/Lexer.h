@@ -569,6 +569,12 @@ private:
 
   void SkipBytes(unsigned Bytes, bool StartOfLine);
 
+  /// SkipToPossibleDirective - In an excluded conditional block, skip the
+  /// text that cannot contain a directive without forming tokens, stopping
+  /// before the first '#' that starts a line, or before anything that only
+  /// the full lexer can get right.  Returns the number of bytes skipped.
+  unsigned SkipToPossibleDirective();
+
   const char *LexUDSuffix(Token &Result, const char *CurPtr,
                           bool IsStringLiteral);
 
@@ -49,6 +49,15 @@ class MacroArgs {
   /// stringified form of an argument has not yet been computed, this is empty.
   std::vector<Token> StringifiedArgs;
 
+  /// UnexpArgStarts - The first token of each unexpanded argument.  Empty if
+  /// not yet computed.  This lets each use of an argument in the macro body
+  /// find it without rescanning the arguments before it.
+  mutable std::vector<const Token *> UnexpArgStarts;
+
+  /// ArgPreexpansionKinds - For each argument, 0 if ArgNeedsPreexpansion has
+  /// not been asked about it yet, and otherwise 1 plus its answer.
+  mutable std::vector<unsigned char> ArgPreexpansionKinds;
+
   /// ArgCache - This is a linked list of MacroArgs objects that the
   /// Preprocessor owns which we use to avoid thrashing malloc/free.
   MacroArgs *ArgCache;
@@ -71,6 +80,11 @@ public:
   /// by pre-expansion, return false.  Otherwise, conservatively return true.
   bool ArgNeedsPreexpansion(const Token *ArgTok, Preprocessor &PP) const;
 
+  /// ArgNeedsPreexpansion - Return ArgNeedsPreexpansion for the unexpanded
+  /// tokens of the specified formal, remembering the answer for the other uses
+  /// of the formal in the macro body.
+  bool ArgNeedsPreexpansion(unsigned Arg, Preprocessor &PP) const;
+
   /// getUnexpArgument - Return a pointer to the first token of the unexpanded
   /// token list for the specified formal.
   ///
@@ -100,7 +100,7 @@ class PTHManager : public IdentifierInfoLookup {
 
 public:
   // The current PTH version.
-  enum { Version = 10 };
+  enum { Version = 11 };
 
   ~PTHManager();
 
@@ -117,13 +117,25 @@ public:
   IdentifierInfo *get(StringRef Name);
 
   /// Create - This method creates PTHManager objects.  The 'file' argument
-  ///  is the name of the PTH file.  This method returns NULL upon failure.
-  static PTHManager *Create(const std::string& file, DiagnosticsEngine &Diags);
+  ///  is the name of the PTH file.  This method returns NULL upon failure,
+  ///  including when the PTH file was generated with language options that
+  ///  would lex the cached files differently than \p LangOpts.
+  static PTHManager *Create(const std::string& file, DiagnosticsEngine &Diags,
+                            const LangOptions &LangOpts);
+
+  /// getLangOptsSignature - Returns a value summarizing the language options
+  ///  that must match between PTH generation and use.
+  static uint32_t getLangOptsSignature(const LangOptions &LangOpts);
+
+  /// getContentHash - Returns the hash of a file's contents that is stored
+  ///  with its cached tokens, to detect files changed since PTH generation.
+  static uint64_t getContentHash(StringRef Contents);
 
   void setPreprocessor(Preprocessor *pp) { PP = pp; }
 
   /// CreateLexer - Return a PTHLexer that "lexes" the cached tokens for the
-  ///  specified file.  This method returns NULL if no cached tokens exist.
+  ///  specified file.  This method returns NULL if no cached tokens exist, or
+  ///  if the file's contents no longer match the ones the tokens came from.
   ///  It is the responsibility of the caller to 'delete' the returned object.
   PTHLexer *CreateLexer(FileID FID);
 
@@ -293,9 +293,42 @@ namespace clang {
     /// \brief Allocator used to store preprocessing objects.
     llvm::BumpPtrAllocator BumpAlloc;
 
+    /// \brief A local preprocessed entity, as stored in the record.
+    ///
+    /// Macro expansions make up most of a detailed record and few of them are
+    /// ever looked at, so an expansion is only stored as its source range and
+    /// the index of its definition in \c ExpansionDefinitions until it is
+    /// first asked for; see \c getLocalPreprocessedEntity.
+    struct LocalEntity {
+      SourceLocation Begin, End;
+      /// \brief If \c DeferredExpansionBit is set, the index of the
+      /// expansion's definition in \c ExpansionDefinitions; otherwise, the
+      /// index of the entity in \c LocalEntityObjects.
+      unsigned Ref;
+    };
+
+    enum { DeferredExpansionBit = 1u << 31 };
+
+    /// \brief Orders local entities by their begin locations.
+    struct PPEntityComp;
+
     /// \brief The set of preprocessed entities in this record, in order they
     /// were seen.
-    std::vector<PreprocessedEntity *> PreprocessedEntities;
+    std::vector<LocalEntity> PreprocessedEntities;
+
+    /// \brief The local preprocessed entities that have been created, to
+    /// which \c PreprocessedEntities refers.
+    std::vector<PreprocessedEntity *> LocalEntityObjects;
+
+    /// \brief The definition of a macro expansion, or the name of the macro if
+    /// it is a builtin macro.
+    typedef llvm::PointerUnion<IdentifierInfo *, MacroDefinition *>
+      ExpansionDefinition;
+
+    /// \brief The distinct definitions of the macro expansions that have not
+    /// been created yet, indexed by their opaque values.
+    std::vector<ExpansionDefinition> ExpansionDefinitions;
+    llvm::DenseMap<void *, unsigned> ExpansionDefinitionIndices;
     
     /// \brief The set of preprocessed entities in this record that have been
     /// loaded from external sources.
@@ -336,6 +369,14 @@ namespace clang {
 
     /// \brief Retrieve the loaded preprocessed entity at the given index.
     PreprocessedEntity *getLoadedPreprocessedEntity(unsigned Index);
+
+    /// \brief Retrieve the local preprocessed entity at the given index,
+    /// creating it if it is a macro expansion that nobody has asked for yet.
+    PreprocessedEntity *getLocalPreprocessedEntity(unsigned Index);
+
+    /// \brief Add a local entity to the record, keeping the record sorted by
+    /// the entities' begin locations.
+    PPEntityID addLocalEntity(const LocalEntity &Entity, bool IsMacroDefinition);
     
     /// \brief Determine the number of preprocessed entities that were
     /// loaded (or can be loaded) from an external source.
@@ -45,6 +45,7 @@ class ExternalPreprocessorSource;
 class FileManager;
 class FileEntry;
 class HeaderSearch;
+class IncludePrefetcher;
 class PragmaNamespace;
 class PragmaHandler;
 class CommentHandler;
@@ -102,6 +103,10 @@ class Preprocessor : public RefCountedBase<Preprocessor> {
   ///  a token cache rather than lexing the original source file.
   OwningPtr<PTHManager> PTH;
 
+  /// \brief Reads the files that are likely to be included ahead of time,
+  /// with -fprefetch-includes.
+  OwningPtr<IncludePrefetcher> Prefetcher;
+
   /// BP - A BumpPtrAllocator object used to quickly allocate and release
   ///  objects internal to the Preprocessor.
   llvm::BumpPtrAllocator BP;
@@ -337,7 +342,7 @@ class Preprocessor : public RefCountedBase<Preprocessor> {
   unsigned NumEnteredSourceFiles, MaxIncludeStackDepth;
   unsigned NumMacroExpanded, NumFnMacroExpanded, NumBuiltinMacroExpanded;
   unsigned NumFastMacroExpanded, NumTokenPaste, NumFastTokenPaste;
-  unsigned NumSkipped;
+  unsigned NumSkipped, NumSkippedBytes;
 
   /// Predefines - This string is the predefined macros that preprocessor
   /// should use from the command line etc.
@@ -1108,6 +1113,15 @@ public:
 
   size_t getTotalMemory() const;
 
+  /// \brief Return the bytes taken by the MacroInfos that are in use, with
+  /// their parameter lists and replacement tokens, and set \p NumMacroInfos
+  /// to their number.
+  size_t getMacroInfoMemory(unsigned &NumMacroInfos) const;
+
+  /// \brief Return the bytes taken by the TokenLexers kept for reuse, and by
+  /// the tokens of the macro expansions in progress.
+  size_t getTokenLexerCacheMemory() const;
+
   /// HandleMicrosoftCommentPaste - When the macro expander pastes together a
   /// comment (/##/) in microsoft mode, this method handles updating the current
   /// state, returning the token on the next source line.
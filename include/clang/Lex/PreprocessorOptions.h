@@ -81,6 +81,11 @@ public:
   /// The boolean indicates whether the preamble ends at the start of a new
   /// line.
   std::pair<unsigned, bool> PrecompiledPreambleBytes;
+
+  /// \brief When true, the files included by the precompiled preamble are not
+  /// checked for changes, so that a preamble known to be out of date can keep
+  /// being used while its replacement is built.
+  bool AllowOutOfDatePreamble;
   
   /// The implicit PTH input included at the start of the translation unit, or
   /// empty.
@@ -89,6 +94,21 @@ public:
   /// If given, a PTH cache file to use for speeding up header parsing.
   std::string TokenCache;
 
+  /// \brief When true, every file is reduced to the directives that affect
+  /// its dependencies before it is preprocessed. Only useful when the output
+  /// is a dependency file.
+  bool DependencyDirectivesOnly;
+
+  /// \brief When true, the files that the files being preprocessed seem to
+  /// include are looked up and read on a background thread, ahead of their
+  /// inclusion.
+  bool PrefetchIncludes;
+
+  /// \brief When true, the memory of an included file is given back to the
+  /// system once the file was lexed to the end, and read back if it is needed
+  /// again.
+  bool ReleaseFinishedFiles;
+
   /// \brief True if the SourceManager should report the original file name for
   /// contents of files that were remapped to other files. Defaults to true.
   bool RemappedFilesKeepOriginalName;
@@ -180,6 +200,10 @@ public:
                           AllowPCHWithCompilerErrors(false),
                           DumpDeserializedPCHDecls(false),
                           PrecompiledPreambleBytes(0, true),
+                          AllowOutOfDatePreamble(false),
+                          DependencyDirectivesOnly(false),
+                          PrefetchIncludes(false),
+                          ReleaseFinishedFiles(false),
                           RemappedFilesKeepOriginalName(true),
                           RetainRemappedFileBuffers(false),
                           ObjCXXARCStandardLibrary(ARCXX_nolib) { }
@@ -225,6 +249,7 @@ public:
     RetainRemappedFileBuffers = true;
     PrecompiledPreambleBytes.first = 0;
     PrecompiledPreambleBytes.second = 0;
+    AllowOutOfDatePreamble = false;
   }
 };
 
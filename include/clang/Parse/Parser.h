@@ -151,6 +151,7 @@ class Parser : public CodeCompletionHandler {
   OwningPtr<PragmaHandler> OpenCLExtensionHandler;
   OwningPtr<CommentHandler> CommentSemaHandler;
   OwningPtr<PragmaHandler> OpenMPHandler;
+  OwningPtr<PragmaHandler> LoopHintHandler;
   OwningPtr<PragmaHandler> MSCommentHandler;
   OwningPtr<PragmaHandler> MSDetectMismatchHandler;
 
@@ -205,6 +206,41 @@ class Parser : public CodeCompletionHandler {
   /// \brief Identifiers which have been declared within a tentative parse.
   SmallVector<IdentifierInfo *, 8> TentativelyDeclaredIdentifiers;
 
+  /// \brief The disambiguations whose results are kept in
+  /// TentativeParseResults.
+  enum TentativeParseQuery {
+    TPQ_SimpleDeclaration,
+    TPQ_ForRangeDeclaration,
+    TPQ_FunctionDeclarator,
+    TPQ_TypeIdInParens,
+    TPQ_TypeIdAsTemplateArgument
+  };
+
+  /// \brief The result of a disambiguation that needed a tentative parse.
+  /// Besides the tokens, it depends on the scope and on the identifiers that
+  /// were tentatively declared.
+  struct TentativeParseResult {
+    Scope *S;
+    unsigned NumTentativelyDeclared;
+    IdentifierInfo *LastTentativelyDeclared;
+    bool Result;
+    bool IsAmbiguous;
+  };
+
+  /// \brief The results of the disambiguations done within the current
+  /// top-level declaration, indexed by the raw location of the token they
+  /// started at and the kind of query.  Without them, the tokens of a
+  /// nested ambiguous construct are scanned again by every enclosing
+  /// tentative parse and by the real parse.
+  typedef llvm::DenseMap<std::pair<unsigned, unsigned>, TentativeParseResult>
+    TentativeParseResultMap;
+  TentativeParseResultMap TentativeParseResults;
+
+  const TentativeParseResult *
+  findTentativeParseResult(TentativeParseQuery Query) const;
+  void rememberTentativeParseResult(TentativeParseQuery Query, bool Result,
+                                    bool IsAmbiguous = false);
+
   IdentifierInfo *getSEHExceptKeyword();
 
   /// True if we are within an Objective-C container while parsing C-like decls.
@@ -454,6 +490,10 @@ private:
   /// #pragma clang __debug captured
   StmtResult HandlePragmaCaptured();
 
+  /// \brief Handle one of the annotation tokens produced for
+  /// #pragma clang loop...
+  LoopHint HandlePragmaLoopHint();
+
   /// GetLookAheadToken - This peeks ahead N tokens and returns that token
   /// without consuming any tokens.  LookAhead(0) returns 'Tok', LookAhead(1)
   /// returns the token after Tok, etc.
@@ -1084,6 +1124,9 @@ private:
                                 const VirtSpecifiers& VS,
                                 FunctionDefinitionKind DefinitionKind,
                                 ExprResult& Init);
+  bool canDelayInlineMethodParsing(const ParsingDeclarator &D,
+                                   const ParsedTemplateInfo &TemplateInfo,
+                                   const FunctionDecl *FD);
   void ParseCXXNonStaticMemberInitializer(Decl *VarD);
   void ParseLexedAttributes(ParsingClass &Class);
   void ParseLexedAttributeList(LateParsedAttrList &LAs, Decl *D,
@@ -1484,6 +1527,8 @@ private:
                                          SourceLocation *TrailingElseLoc,
                                          ParsedAttributesWithRange &Attrs);
   StmtResult ParseExprStatement();
+  StmtResult ParsePragmaLoopHint(StmtVector &Stmts, bool OnlyStatement,
+                                 SourceLocation *TrailingElseLoc);
   StmtResult ParseLabeledStatement(ParsedAttributesWithRange &attrs);
   StmtResult ParseCaseStatement(bool MissingCase = false,
                                 ExprResult Expr = ExprResult());
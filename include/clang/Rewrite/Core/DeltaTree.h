@@ -14,6 +14,7 @@
 #ifndef CLANG_REWRITE_DELTATREE_H
 #define CLANG_REWRITE_DELTATREE_H
 
+#include "llvm/Support/Allocator.h"
 #include "llvm/Support/Compiler.h"
 
 namespace clang {
@@ -27,6 +28,11 @@ namespace clang {
   /// as well, without traversing the whole tree.
   class DeltaTree {
     void *Root;    // "DeltaTreeNode *"
+
+    /// Allocator - All the nodes of the tree live here, next to each other.
+    /// Nodes are never freed individually, so they all go away with it.
+    llvm::BumpPtrAllocator Allocator;
+
     void operator=(const DeltaTree &) LLVM_DELETED_FUNCTION;
   public:
     DeltaTree();
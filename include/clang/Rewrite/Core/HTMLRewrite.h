@@ -17,6 +17,7 @@
 
 #include "clang/Basic/SourceLocation.h"
 #include <string>
+#include <vector>
 
 namespace clang {
 
@@ -26,6 +27,18 @@ class Preprocessor;
 
 namespace html {
 
+  /// HighlightedRange - A range of a file, given as offsets, to highlight
+  /// with the specified start/end tags.
+  struct HighlightedRange {
+    unsigned Begin, End;
+    std::string StartTag, EndTag;
+
+    HighlightedRange(unsigned Begin, unsigned End, StringRef StartTag,
+                     StringRef EndTag)
+      : Begin(Begin), End(End), StartTag(StartTag), EndTag(EndTag) {}
+  };
+  typedef std::vector<HighlightedRange> HighlightedRanges;
+
   /// HighlightRange - Highlight a range in the source code with the specified
   /// start/end tags.  B/E must be in the same file.  This ensures that
   /// start/end tags are placed at the start/end of each line if the range is
@@ -69,12 +82,28 @@ namespace html {
   /// information about keywords, comments, etc.
   void SyntaxHighlight(Rewriter &R, FileID FID, const Preprocessor &PP);
 
+  /// SyntaxHighlight - This is the same as the above method, but appends the
+  /// ranges to highlight to \p Ranges, so that they can be applied with
+  /// ApplyHighlighting to any number of rewriters of the file.
+  void SyntaxHighlight(HighlightedRanges &Ranges, FileID FID,
+                       const Preprocessor &PP);
+
   /// HighlightMacros - This uses the macro table state from the end of the
   /// file, to reexpand macros and insert (into the HTML) information about the
   /// macro expansions.  This won't be perfectly perfect, but it will be
   /// reasonably close.
   void HighlightMacros(Rewriter &R, FileID FID, const Preprocessor &PP);
 
+  /// HighlightMacros - This is the same as the above method, but appends the
+  /// ranges to highlight to \p Ranges.
+  void HighlightMacros(HighlightedRanges &Ranges, FileID FID,
+                       const Preprocessor &PP);
+
+  /// ApplyHighlighting - Highlight the ranges of the specified FileID
+  /// computed by SyntaxHighlight and HighlightMacros, in order.
+  void ApplyHighlighting(Rewriter &R, FileID FID,
+                         const HighlightedRanges &Ranges);
+
 } // end html namespace
 } // end clang namespace
 
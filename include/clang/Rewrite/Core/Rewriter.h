@@ -285,10 +285,15 @@ public:
 
   /// overwriteChangedFiles - Save all changed files to disk.
   ///
+  /// Each file is written to a temporary file that is then moved over it.
+  /// With more than one thread (0 means one per hardware thread) several
+  /// files are written at the same time; the rewrite buffers must not be
+  /// changed meanwhile.
+  ///
   /// Returns whether not all changes were saved successfully.
   /// Outputs diagnostics via the source manager's diagnostic engine
-  /// in case of an error.
-  bool overwriteChangedFiles();
+  /// in case of an error, after all files have been written.
+  bool overwriteChangedFiles(unsigned NumThreads = 1);
 
 private:
   unsigned getLocationOffsetAndFileID(SourceLocation Loc, FileID &FID) const;
@@ -0,0 +1,45 @@
+//===--- LoopHint.h - Types for LoopHint ------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file defines the LoopHint struct, which is used to pass the hints of
+//  a #pragma clang loop directive from the parser to Sema.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_SEMA_LOOPHINT_H
+#define LLVM_CLANG_SEMA_LOOPHINT_H
+
+#include "clang/Basic/SourceLocation.h"
+
+namespace clang {
+
+class Expr;
+class IdentifierInfo;
+
+/// \brief One 'option(value)' hint of a \#pragma clang loop directive.
+struct LoopHint {
+  /// \brief The source range of the whole hint.
+  SourceRange Range;
+
+  /// \brief The name of the option, such as 'vectorize_width'.
+  IdentifierInfo *Option;
+  SourceLocation OptionLoc;
+
+  /// \brief The value, if it was written as an identifier, such as 'enable'.
+  IdentifierInfo *ValueIdent;
+  /// \brief The value, if it was written as a number.
+  Expr *ValueExpr;
+  SourceLocation ValueLoc;
+
+  LoopHint() : Option(0), ValueIdent(0), ValueExpr(0) {}
+};
+
+} // end namespace clang
+
+#endif
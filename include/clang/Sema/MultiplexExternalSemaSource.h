@@ -136,8 +136,8 @@ public:
   /// \c ObjCInterfaceDecl::setExternallyCompleted().
   virtual void CompleteType(ObjCInterfaceDecl *Class);
 
-  /// \brief Loads comment ranges.
-  virtual void ReadComments();
+  /// \brief Loads the comment ranges in the given file.
+  virtual void ReadCommentsInFile(FileID File);
 
   /// \brief Notify ExternalASTSource that we started deserialization of
   /// a decl or type so until FinishedDeserializing is called there may be
@@ -21,6 +21,8 @@
 #include "clang/AST/TemplateBase.h"
 #include "clang/AST/Type.h"
 #include "clang/AST/UnresolvedSet.h"
+#include "clang/Sema/ResultCache.h"
+#include "clang/Sema/ScratchArena.h"
 #include "clang/Sema/SemaFixItUtils.h"
 #include "clang/Sema/TemplateDeduction.h"
 #include "llvm/ADT/SmallPtrSet.h"
@@ -699,8 +701,10 @@ namespace clang {
     llvm::SmallPtrSet<Decl *, 16> Functions;
 
     // Allocator for OverloadCandidate::Conversions. We store the first few
-    // elements inline to avoid allocation for small sets.
+    // elements inline to avoid allocation for small sets, and take the rest
+    // from the scratch arena if the set was given one.
     llvm::BumpPtrAllocator ConversionSequenceAllocator;
+    ScratchArena::Scope Scratch;
 
     SourceLocation Loc;
 
@@ -713,7 +717,11 @@ namespace clang {
     void destroyCandidates();
 
   public:
-    OverloadCandidateSet(SourceLocation Loc) : Loc(Loc), NumInlineSequences(0){}
+    /// \brief Create an empty set of candidates. If \p Arena is given, the
+    /// set must be an automatic variable, so that it ends before any set
+    /// created after it.
+    explicit OverloadCandidateSet(SourceLocation Loc, ScratchArena *Arena = 0)
+      : Scratch(Arena), Loc(Loc), NumInlineSequences(0) {}
     ~OverloadCandidateSet() { destroyCandidates(); }
 
     SourceLocation getLocation() const { return Loc; }
@@ -748,9 +756,13 @@ namespace clang {
         C.Conversions = &I[NumInlineSequences];
         NumInlineSequences += NumConversions;
       } else {
-        // Otherwise get memory from the allocator.
-        C.Conversions = ConversionSequenceAllocator
-                          .Allocate<ImplicitConversionSequence>(NumConversions);
+        // Otherwise get memory from the scratch arena or, if it has none to
+        // give, from the allocator.
+        C.Conversions =
+          Scratch.Allocate<ImplicitConversionSequence>(NumConversions);
+        if (!C.Conversions)
+          C.Conversions = ConversionSequenceAllocator
+                            .Allocate<ImplicitConversionSequence>(NumConversions);
       }
 
       // Construct the new objects.
@@ -778,6 +790,35 @@ namespace clang {
                                  const OverloadCandidate& Cand2,
                                  SourceLocation Loc,
                                  bool UserDefinedConversion = false);
+
+  /// \brief Determine whether \p T names, directly or through a reference,
+  /// pointer, array or member pointer, a class or enumeration that is not
+  /// complete yet, and whose completion could change the result of overload
+  /// resolution or template argument deduction for arguments or parameters
+  /// of type \p T.
+  bool mayBeCompletedLater(QualType T);
+
+  /// \brief The result of overload resolution for a call, as cached by
+  /// OverloadResolutionCache.
+  struct OverloadCacheResult {
+    FunctionDecl *Function;
+    DeclAccessPair FoundDecl;
+    bool HadMultipleCandidates;
+  };
+
+  /// \brief Remembers the functions that overload resolution chose for calls
+  /// and overloaded operators in non-dependent code, so that repeating a call
+  /// with arguments of the same types does not repeat overload resolution.
+  ///
+  /// A call is keyed on the functions that name lookup found for it and on
+  /// the canonical types and value kinds of its arguments; the caller only
+  /// caches calls whose result depends on nothing else. Since
+  /// argument-dependent lookup can find functions declared after a call was
+  /// cached, Sema clears the cache whenever it declares a function that is
+  /// not a class member.
+  class OverloadResolutionCache
+      : public ResultCache<SmallVector<uintptr_t, 16>, OverloadCacheResult> {
+  };
 } // end namespace clang
 
 #endif // LLVM_CLANG_SEMA_OVERLOAD_H
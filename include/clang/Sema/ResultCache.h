@@ -0,0 +1,100 @@
+//===--- ResultCache.h - Caches of semantic analysis results ----*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines ResultCache, the bounded hash table behind the caches of
+// overload resolution and template argument deduction.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_SEMA_RESULT_CACHE_H
+#define LLVM_CLANG_SEMA_RESULT_CACHE_H
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Hashing.h"
+#include "llvm/ADT/SmallVector.h"
+
+namespace clang {
+
+/// \brief Maps keys, which are sequences of hashable values such as pointers
+/// to canonical types and declarations, to the results that Sema computed
+/// for them.
+///
+/// The results are kept by the hash of their keys, with the few keys that
+/// share a hash in a bucket. Once the cache holds \c MaxEntries results it
+/// starts over, so that it does not grow without bound.
+template <typename KeyT, typename ResultT, unsigned MaxEntries = 16384>
+class ResultCache {
+public:
+  typedef KeyT KeyTy;
+  typedef ResultT Result;
+
+  ResultCache() : NumEntries(0) {}
+
+  /// \brief Find the result cached for \p Key, if any.
+  const Result *lookup(const KeyTy &Key) const {
+    typename BucketMap::const_iterator Known = Buckets.find(hashKey(Key));
+    if (Known == Buckets.end())
+      return 0;
+
+    for (typename BucketTy::const_iterator I = Known->second.begin(),
+           E = Known->second.end(); I != E; ++I)
+      if (I->Key == Key)
+        return &I->R;
+    return 0;
+  }
+
+  /// \brief Cache the result \p R for \p Key.
+  void insert(const KeyTy &Key, const Result &R) {
+    if (NumEntries == MaxEntries)
+      clear();
+
+    Entry New;
+    New.Key = Key;
+    New.R = R;
+    Buckets[hashKey(Key)].push_back(New);
+    ++NumEntries;
+  }
+
+  /// \brief Forget every cached result.
+  void clear() {
+    if (NumEntries) {
+      Buckets.clear();
+      NumEntries = 0;
+    }
+  }
+
+  /// \brief The number of cached results.
+  unsigned size() const { return NumEntries; }
+
+  /// \brief The bytes taken by the buckets of the cache.
+  size_t getMemorySize() const { return llvm::capacity_in_bytes(Buckets); }
+
+private:
+  struct Entry {
+    KeyTy Key;
+    Result R;
+  };
+  typedef SmallVector<Entry, 1> BucketTy;
+  typedef llvm::DenseMap<unsigned, BucketTy> BucketMap;
+
+  static unsigned hashKey(const KeyTy &Key) {
+    // Drop a bit, since DenseMap reserves the largest keys.
+    return static_cast<unsigned>(
+             size_t(llvm::hash_combine_range(Key.begin(), Key.end()))) >> 1;
+  }
+
+  /// \brief The cached results, by the hash of their keys.
+  BucketMap Buckets;
+  unsigned NumEntries;
+};
+
+} // end namespace clang
+
+#endif
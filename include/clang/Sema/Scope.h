@@ -15,6 +15,8 @@
 #define LLVM_CLANG_SEMA_SCOPE_H
 
 #include "clang/Basic/Diagnostic.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/OwningPtr.h"
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallVector.h"
 
@@ -143,6 +145,15 @@ private:
   typedef llvm::SmallPtrSet<Decl *, 32> DeclSetTy;
   DeclSetTy DeclsInScope;
 
+  /// DeclDepths - The depth of the scope that each declaration was last
+  /// added to, shared by all the scopes with the same outermost scope, which
+  /// owns it. It lets getDeclScope find the scope of a declaration without
+  /// probing every scope in between. Since scopes are reused, an entry only
+  /// says where to look, and is checked against DeclsInScope.
+  typedef llvm::DenseMap<Decl *, unsigned> DeclDepthMap;
+  DeclDepthMap *DeclDepths;
+  OwningPtr<DeclDepthMap> OwnedDeclDepths;
+
   /// Entity - The entity with which this scope is associated. For
   /// example, the entity of a class scope is the class itself, the
   /// entity of a function scope is a function, etc. This field is
@@ -222,13 +233,8 @@ public:
   decl_iterator decl_end()   const { return DeclsInScope.end(); }
   bool decl_empty()          const { return DeclsInScope.empty(); }
 
-  void AddDecl(Decl *D) {
-    DeclsInScope.insert(D);
-  }
-
-  void RemoveDecl(Decl *D) {
-    DeclsInScope.erase(D);
-  }
+  void AddDecl(Decl *D);
+  void RemoveDecl(Decl *D);
 
   /// isDeclScope - Return true if this is the scope that the specified decl is
   /// declared in.
@@ -236,6 +242,10 @@ public:
     return DeclsInScope.count(D) != 0;
   }
 
+  /// getDeclScope - Return the innermost of this scope and its parents that
+  /// the specified decl is declared in, or null if there is none.
+  Scope *getDeclScope(Decl *D);
+
   void* getEntity() const { return Entity; }
   void setEntity(void *E) { Entity = E; }
 
@@ -0,0 +1,118 @@
+//===--- ScratchArena.h - Scoped scratch memory for Sema --------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the ScratchArena class, which provides memory for the
+// structures that Sema builds and throws away while analyzing a single
+// expression, such as the conversion sequences of overload candidates and
+// the type source information of types being transformed.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_SEMA_SCRATCHARENA_H
+#define LLVM_CLANG_SEMA_SCRATCHARENA_H
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/AlignOf.h"
+#include "llvm/Support/Compiler.h"
+#include "llvm/Support/DataTypes.h"
+#include <cstddef>
+
+namespace clang {
+
+/// \brief A stack of memory for short-lived structures.
+///
+/// Memory is allocated through a ScratchArena::Scope and released all at
+/// once when the scope ends, and the slabs it came from are kept for the
+/// scopes that follow, so that once the arena has grown to the size the
+/// translation unit needs, scratch allocation no longer calls malloc.
+///
+/// Scopes must end in the reverse of the order in which they began, as
+/// automatic variables do, and only the innermost scope can allocate: an
+/// outer scope that asks for memory while an inner one is open gets null,
+/// and its owner should fall back to an allocator of its own.
+class ScratchArena {
+public:
+  /// \brief A scope of allocations from a ScratchArena. A scope created
+  /// without an arena never allocates.
+  class Scope {
+  public:
+    explicit Scope(ScratchArena *Arena);
+    ~Scope();
+
+    /// \brief Allocate \p Size bytes aligned to \p Alignment, or return null
+    /// if this scope has no arena or is not the innermost scope.
+    void *Allocate(size_t Size, size_t Alignment);
+
+    template <typename T> T *Allocate(size_t Num) {
+      return static_cast<T *>(
+          Allocate(Num * sizeof(T), llvm::AlignOf<T>::Alignment));
+    }
+
+    /// \brief Release the memory allocated through this scope so far, if it
+    /// is the innermost scope; otherwise the memory is released when the
+    /// scope ends.
+    void reset();
+
+  private:
+    ScratchArena *Arena;
+    Scope *Parent;
+
+    /// The position of the arena when the scope began.
+    unsigned NumSlabs;
+    char *Ptr;
+    unsigned NumLargeAllocations;
+
+    Scope(const Scope &) LLVM_DELETED_FUNCTION;
+    void operator=(const Scope &) LLVM_DELETED_FUNCTION;
+  };
+
+  ScratchArena();
+  ~ScratchArena();
+
+  /// \brief Print the number of allocations made from the arena, and how
+  /// many of them had to malloc memory.
+  void PrintStats() const;
+
+  /// \brief Return the bytes of the slabs the arena holds.
+  size_t getTotalMemory() const { return Slabs.size() * SlabSize; }
+
+private:
+  enum { SlabSize = 16384 };
+
+  void *AllocateSlow(size_t Size, size_t Alignment);
+  void releaseTo(const Scope &Mark);
+
+  /// \brief The slabs the arena has allocated; the first NumUsedSlabs of
+  /// them are in use, and the rest are kept for reuse.
+  SmallVector<char *, 4> Slabs;
+  unsigned NumUsedSlabs;
+
+  /// \brief The free space in the last slab in use.
+  char *Ptr, *End;
+
+  /// \brief Allocations too large for a slab, which are freed when the scope
+  /// that made them ends.
+  SmallVector<void *, 4> LargeAllocations;
+
+  /// \brief The innermost scope, which is the only one that can allocate.
+  Scope *Innermost;
+
+  unsigned NumAllocations, NumMallocs, NumRefused;
+  uint64_t BytesAllocated;
+
+  ScratchArena(const ScratchArena &) LLVM_DELETED_FUNCTION;
+  void operator=(const ScratchArena &) LLVM_DELETED_FUNCTION;
+
+  friend class Scope;
+};
+
+} // end namespace clang
+
+#endif
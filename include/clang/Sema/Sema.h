@@ -39,6 +39,7 @@
 #include "clang/Sema/ObjCMethodList.h"
 #include "clang/Sema/Ownership.h"
 #include "clang/Sema/ScopeInfo.h"
+#include "clang/Sema/ScratchArena.h"
 #include "clang/Sema/TypoCorrection.h"
 #include "clang/Sema/Weak.h"
 #include "llvm/ADT/ArrayRef.h"
@@ -121,6 +122,7 @@ namespace clang {
   class LangOptions;
   class LocalInstantiationScope;
   class LookupResult;
+  struct LoopHint;
   class MacroInfo;
   class MultiLevelTemplateArgumentList;
   class NamedDecl;
@@ -142,12 +144,14 @@ namespace clang {
   class OMPClause;
   class OverloadCandidateSet;
   class OverloadExpr;
+  class OverloadResolutionCache;
   class ParenListExpr;
   class ParmVarDecl;
   class Preprocessor;
   class PseudoDestructorTypeStorage;
   class PseudoObjectExpr;
   class QualType;
+  class RawComment;
   class StandardConversionSequence;
   class Stmt;
   class StringLiteral;
@@ -157,8 +161,10 @@ namespace clang {
   class TemplateArgumentList;
   class TemplateArgumentLoc;
   class TemplateDecl;
+  class TemplateDeductionCache;
   class TemplateParameterList;
   class TemplatePartialOrderingContext;
+  class TemplateProfiler;
   class TemplateTemplateParmDecl;
   class Token;
   class TypeAliasDecl;
@@ -404,6 +410,21 @@ public:
     OpaqueParser = P;
   }
 
+  /// \brief The inline member functions whose bodies were left as cached
+  /// tokens by -fdelayed-inline-method-parsing, in declaration order.
+  SmallVector<FunctionDecl *, 16> LateParsedInlineMethods;
+
+  /// \brief The late parsed inline member functions that are not used yet.
+  llvm::SmallPtrSet<const FunctionDecl *, 16> UnusedLateParsedInlineMethods;
+
+  /// \brief The late parsed inline member functions that were used, and
+  /// whose bodies still need to be parsed.
+  SmallVector<FunctionDecl *, 8> UsedLateParsedInlineMethods;
+
+  /// \brief Parse the bodies of the late parsed inline member functions that
+  /// were used, through the LateTemplateParser callback.
+  void ParseUsedLateParsedInlineMethods();
+
   class DelayedDiagnostics;
 
   class DelayedDiagnosticsState {
@@ -769,9 +790,42 @@ public:
 
   llvm::BumpPtrAllocator BumpAlloc;
 
+  /// \brief Memory for the structures, such as overload candidate sets, that
+  /// only live while one expression is being analyzed.
+  ScratchArena Scratch;
+
   /// \brief The number of SFINAE diagnostics that have been trapped.
   unsigned NumSFINAEErrors;
 
+  /// \brief The number of conversions of arguments to the parameters of
+  /// overload candidates that a cheap test ruled out, without checking them.
+  unsigned NumOverloadConversionsRuledOut;
+
+  /// \brief The results of overload resolution for calls in non-dependent
+  /// C++ code.
+  OwningPtr<OverloadResolutionCache> OverloadCache;
+
+  /// \brief The number of calls whose overload resolution was found in, and
+  /// missing from, OverloadCache.
+  unsigned NumOverloadCacheHits, NumOverloadCacheMisses;
+
+  /// \brief The results of template argument deduction from calls in
+  /// non-dependent C++ code.
+  OwningPtr<TemplateDeductionCache> DeductionCache;
+
+  /// \brief The number of deductions that were found in, and missing from,
+  /// DeductionCache.
+  unsigned NumDeductionCacheHits, NumDeductionCacheMisses;
+
+  /// \brief The number of accesses to members that are not public that were
+  /// checked, which depend on the context they are checked in.
+  unsigned NumNonPublicAccessChecks;
+
+  /// \brief Forget the results of overload resolution and template argument
+  /// deduction cached so far, because a function that argument-dependent
+  /// lookup could find was declared.
+  void invalidateOverloadCache();
+
   typedef llvm::DenseMap<ParmVarDecl *, SmallVector<ParmVarDecl *, 1> >
     UnparsedDefaultArgInstantiationsMap;
 
@@ -888,6 +942,22 @@ public:
 
   void PrintStats() const;
 
+  /// \brief The memory held by the caches that Sema keeps for the whole
+  /// translation unit.
+  struct MemoryUsage {
+    /// The special member lookups cached; their results, the lists of the
+    /// global method pool and the types with source information are all
+    /// allocated in the bytes of the allocator.
+    unsigned NumSpecialMembers;
+    size_t AllocatorBytes;
+    unsigned NumOverloads;
+    size_t OverloadCacheBytes;
+    unsigned NumDeductions;
+    size_t DeductionCacheBytes;
+    size_t ScratchBytes;
+  };
+  MemoryUsage getMemoryUsage() const;
+
   /// \brief Helper class that creates diagnostics with optional
   /// template instantiation stacks.
   ///
@@ -1295,6 +1365,12 @@ public:
   ///     void f(void (*g)(), ...)
   unsigned InFunctionDeclarator;
 
+  /// \brief The last comment that isn't attached to a declaration, although
+  /// a declaration after it was checked for documentation. Since the later
+  /// declarations can't take it either, they needn't look for their
+  /// comments while it is the last one.
+  const RawComment *StaleDocComment;
+
   DeclGroupPtrTy ConvertDeclToDeclGroup(Decl *Ptr, Decl *OwnedType = 0);
 
   void DiagnoseUseOfUnimplementedSelectors();
@@ -2262,6 +2338,14 @@ public:
                                    const UnresolvedSetImpl &Fns,
                                    Expr *LHS, Expr *RHS);
 
+  /// \brief Build a call to the overloaded operator \p FnDecl, which overload
+  /// resolution chose for a binary operator.
+  ExprResult BuildCallToOverloadedBinOp(SourceLocation OpLoc,
+                                        OverloadedOperatorKind Op,
+                                        Expr **Args, FunctionDecl *FnDecl,
+                                        DeclAccessPair FoundDecl,
+                                        bool HadMultipleCandidates);
+
   ExprResult CreateOverloadedArraySubscriptExpr(SourceLocation LLoc,
                                                 SourceLocation RLoc,
                                                 Expr *Base,Expr *Idx);
@@ -2526,6 +2610,10 @@ public:
   StmtResult ProcessStmtAttributes(Stmt *Stmt, AttributeList *Attrs,
                                    SourceRange Range);
 
+  /// \brief Called on the hints of '#pragma clang loop' in front of the loop
+  /// \p Loop, which they are attached to as LoopHintAttrs.
+  StmtResult ActOnPragmaLoopHints(ArrayRef<LoopHint> Hints, Stmt *Loop);
+
   void WarnUndefinedMethod(SourceLocation ImpLoc, ObjCMethodDecl *method,
                            bool &IncompleteImpl, unsigned DiagID);
   void WarnConflictingTypedMethods(ObjCMethodDecl *Method,
@@ -4689,6 +4777,7 @@ public:
   void ActOnFinishDelayedCXXMethodDeclaration(Scope *S, Decl *Method);
   void ActOnFinishDelayedMemberInitializers(Decl *Record);
   void MarkAsLateParsedTemplate(FunctionDecl *FD, bool Flag = true);
+  void MarkAsLateParsedInlineMethod(FunctionDecl *FD);
   bool IsInsideALocalClassWithinATemplateFunction();
 
   Decl *ActOnStaticAssertDeclaration(SourceLocation StaticAssertLoc,
@@ -5766,6 +5855,13 @@ public:
                           FunctionDecl *&Specialization,
                           sema::TemplateDeductionInfo &Info);
 
+  /// \brief Perform template argument deduction from a function call,
+  /// without looking in or adding to DeductionCache.
+  TemplateDeductionResult DeduceTemplateArgumentsUncached(
+      FunctionTemplateDecl *FunctionTemplate,
+      TemplateArgumentListInfo *ExplicitTemplateArgs, ArrayRef<Expr *> Args,
+      FunctionDecl *&Specialization, sema::TemplateDeductionInfo &Info);
+
   TemplateDeductionResult
   DeduceTemplateArguments(FunctionTemplateDecl *FunctionTemplate,
                           TemplateArgumentListInfo *ExplicitTemplateArgs,
@@ -6223,9 +6319,26 @@ public:
   /// variables.
   LocalInstantiationScope *CurrentInstantiationScope;
 
+  /// \brief The profile of template instantiation, deduction and overload
+  /// resolution, if -ftemplate-profile is in effect.
+  OwningPtr<TemplateProfiler> TemplateProf;
+
+  /// \brief Start recording the profile of template instantiation.
+  void startTemplateProfiling();
+
+  /// \brief Retrieve the profile of template instantiation, or null if it is
+  /// not being recorded.
+  TemplateProfiler *getTemplateProfiler() const { return TemplateProf.get(); }
+
   /// \brief The number of typos corrected by CorrectTypo.
   unsigned TyposCorrected;
 
+  /// \brief The time, in seconds, spent in CorrectTypo so far.
+  double TypoCorrectionTime;
+
+  /// \brief The identifiers typo correction considers, grouped by length.
+  TypoCorrectionNameIndex TypoNames;
+
   typedef llvm::DenseMap<IdentifierInfo *, TypoCorrection>
     UnqualifiedTyposCorrectedMap;
 
@@ -6885,6 +6998,23 @@ public:
                                           Stmt *AStmt,
                                           SourceLocation StartLoc,
                                           SourceLocation EndLoc);
+  /// \brief Called on well-formed '\#pragma omp simd' after parsing
+  /// of the associated statement.
+  StmtResult ActOnOpenMPSimdDirective(ArrayRef<OMPClause *> Clauses,
+                                      Stmt *AStmt,
+                                      SourceLocation StartLoc,
+                                      SourceLocation EndLoc);
+
+  OMPClause *ActOnOpenMPSingleExprClause(OpenMPClauseKind Kind,
+                                         Expr *E,
+                                         SourceLocation StartLoc,
+                                         SourceLocation LParenLoc,
+                                         SourceLocation EndLoc);
+  /// \brief Called on well-formed 'safelen' clause.
+  OMPClause *ActOnOpenMPSafelenClause(Expr *Length,
+                                      SourceLocation StartLoc,
+                                      SourceLocation LParenLoc,
+                                      SourceLocation EndLoc);
 
   OMPClause *ActOnOpenMPSimpleClause(OpenMPClauseKind Kind,
                                      unsigned Argument,
@@ -6910,6 +7040,12 @@ public:
                                       SourceLocation LParenLoc,
                                       SourceLocation EndLoc);
 
+  /// \brief Checks that \p Op is a constant positive integer expression, as
+  /// required by the OpenMP clause \p CKind. Dependent expressions are
+  /// checked when the template is instantiated.
+  ExprResult VerifyPositiveIntegerConstantInClause(Expr *Op,
+                                                   OpenMPClauseKind CKind);
+
   /// \brief The kind of conversion being performed.
   enum CheckedConversionKind {
     /// \brief An implicit conversion.
@@ -7647,6 +7783,8 @@ public:
 private:
   bool SemaBuiltinPrefetch(CallExpr *TheCall);
   bool SemaBuiltinObjectSize(CallExpr *TheCall);
+  bool SemaBuiltinAssume(CallExpr *TheCall);
+  bool SemaBuiltinAssumeAligned(CallExpr *TheCall);
   bool SemaBuiltinLongjmp(CallExpr *TheCall);
   ExprResult SemaBuiltinAtomicOverloaded(ExprResult TheCallResult);
   ExprResult SemaAtomicOpsOverloaded(ExprResult TheCallResult,
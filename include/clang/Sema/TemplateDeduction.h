@@ -15,6 +15,7 @@
 
 #include "clang/AST/DeclTemplate.h"
 #include "clang/Basic/PartialDiagnostic.h"
+#include "clang/Sema/ResultCache.h"
 #include "llvm/ADT/SmallVector.h"
 
 namespace clang {
@@ -78,6 +79,12 @@ public:
     Deduced = NewDeduced;
   }
 
+  /// \brief The deduced template argument list, if any, without taking
+  /// ownership of it.
+  TemplateArgumentList *getDeduced() const {
+    return Deduced;
+  }
+
   /// \brief Is a SFINAE diagnostic available?
   bool hasSFINAEDiagnostic() const {
     return HasSFINAEDiagnostic;
@@ -281,6 +288,46 @@ public:
   }
 };
 
+/// \brief The result of a deduction, as cached by TemplateDeductionCache.
+struct DeductionCacheResult {
+  /// A Sema::TemplateDeductionResult.
+  unsigned Kind;
+  /// The specialization, if deduction succeeded.
+  FunctionDecl *Specialization;
+
+  /// The parts of the TemplateDeductionInfo of a failure.
+  TemplateParameter Param;
+  TemplateArgument FirstArg, SecondArg;
+  TemplateArgumentList *Deduced;
+  bool HasSFINAEDiagnostic;
+  SmallVector<PartialDiagnosticAt, 1> Diagnostics;
+
+  /// \brief Remember the result \p Kind, and what \p Info holds.
+  void save(unsigned Kind, FunctionDecl *Specialization,
+            const sema::TemplateDeductionInfo &Info);
+
+  /// \brief Put what \p Info held back into it.
+  void restore(sema::TemplateDeductionInfo &Info) const;
+};
+
+/// \brief Remembers the results of template argument deduction from calls in
+/// non-dependent code, so that calling a function template again with
+/// arguments of the same types does not repeat the deduction and the
+/// substitution into the function type.
+///
+/// A deduction is keyed on the function template, its explicit template
+/// arguments, and the canonical types and value kinds of the call
+/// arguments; the caller only caches deductions whose result depends on
+/// nothing else. Failures are cached together with what the
+/// TemplateDeductionInfo held, so that the notes about candidates that were
+/// ignored are the same as without the cache. Like OverloadResolutionCache,
+/// it is cleared whenever a function that argument-dependent lookup could
+/// find is declared, since substituting into a function type can depend on
+/// the result of overload resolution.
+class TemplateDeductionCache
+    : public ResultCache<SmallVector<uintptr_t, 16>, DeductionCacheResult> {
+};
+
 } // end namespace clang
 
 #endif
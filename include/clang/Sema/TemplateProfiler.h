@@ -0,0 +1,114 @@
+//===--- TemplateProfiler.h - Profile of template instantiation -*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the TemplateProfiler class, which records the time and
+// memory that template instantiation, template argument deduction and
+// overload resolution take (-ftemplate-profile).
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_SEMA_TEMPLATEPROFILER_H
+#define LLVM_CLANG_SEMA_TEMPLATEPROFILER_H
+
+#include "clang/AST/DeclarationName.h"
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/Compiler.h"
+#include "llvm/Support/DataTypes.h"
+#include <vector>
+
+namespace clang {
+
+class ASTContext;
+class Decl;
+
+/// \brief Records how long each template instantiation, deduction and
+/// overload resolution took, and how much AST memory it allocated.
+///
+/// The profile is written as a trace-event file, which Chrome's
+/// about:tracing can display, with the totals for each primary template
+/// appended, most expensive first.
+class TemplateProfiler {
+public:
+  explicit TemplateProfiler(ASTContext &Context);
+
+  /// \brief Note that \p Activity (e.g., "instantiate") on \p D has started.
+  void enter(const char *Activity, const Decl *D);
+
+  /// \brief Note that \p Activity on the entity named \p Name has started.
+  void enter(const char *Activity, DeclarationName Name);
+
+  /// \brief Note that the innermost activity has finished.
+  void exit();
+
+  /// \brief Write the profile to \p OS.
+  void write(raw_ostream &OS) const;
+
+  /// \brief Profiles an activity for the lifetime of the scope, if there is
+  /// a profiler.
+  class Scope {
+    TemplateProfiler *Profiler;
+
+  public:
+    Scope(TemplateProfiler *Profiler, const char *Activity,
+          DeclarationName Name)
+      : Profiler(Profiler) {
+      if (Profiler)
+        Profiler->enter(Activity, Name);
+    }
+    Scope(TemplateProfiler *Profiler, const char *Activity, const Decl *D)
+      : Profiler(Profiler) {
+      if (Profiler)
+        Profiler->enter(Activity, D);
+    }
+    ~Scope() {
+      if (Profiler)
+        Profiler->exit();
+    }
+  };
+
+private:
+  struct Event {
+    const char *Activity;
+    const Decl *D;
+    DeclarationName Name;
+    /// The primary template whose totals this event counts towards, or null
+    /// if it counts towards the totals for Name.
+    const Decl *Template;
+    const void *Key;
+    /// The times, in seconds since the profiler was created, and the time
+    /// spent in nested events.
+    double Start, Duration, NestedDuration;
+    uint64_t StartMemory, Memory;
+    /// Whether no enclosing event counts towards the same template, so that
+    /// the event's duration counts towards the template's total time.
+    bool Outermost;
+  };
+
+  void enter(const char *Activity, const Decl *D, DeclarationName Name);
+  double now() const;
+
+  ASTContext &Context;
+  double StartTime;
+  std::vector<Event> Events;
+
+  /// \brief The events that have not finished yet, innermost last.
+  SmallVector<unsigned, 16> Active;
+
+  /// \brief The number of unfinished events for each key of the totals.
+  llvm::DenseMap<const void *, unsigned> ActiveKeys;
+
+  TemplateProfiler(const TemplateProfiler &) LLVM_DELETED_FUNCTION;
+  void operator=(const TemplateProfiler &) LLVM_DELETED_FUNCTION;
+};
+
+} // end namespace clang
+
+#endif
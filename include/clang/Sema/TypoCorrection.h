@@ -18,6 +18,7 @@
 #include "clang/AST/DeclCXX.h"
 #include "clang/Sema/DeclSpec.h"
 #include "llvm/ADT/SmallVector.h"
+#include <vector>
 
 namespace clang {
 
@@ -310,6 +311,41 @@ public:
   }
 };
 
+/// @brief The identifiers known to a translation unit, grouped by length.
+///
+/// Typo correction only considers names whose length is close to that of the
+/// typo, so grouping them lets it skip most identifiers without computing
+/// their edit distance. The identifiers of the external identifier source
+/// (e.g., a PCH or modules) are only collected again when that set changes.
+class TypoCorrectionNameIndex {
+public:
+  TypoCorrectionNameIndex()
+    : NumLocalNames(0), External(0), ExternalGeneration(0) {}
+
+  /// @brief Bring the index up to date with the identifiers in \p Idents,
+  /// including those of its external identifier source.
+  void update(IdentifierTable &Idents);
+
+  /// @brief Add to \p Names each known identifier whose length is between
+  /// \p MinLength and \p MaxLength, inclusive.
+  void getNames(unsigned MinLength, unsigned MaxLength,
+                SmallVectorImpl<StringRef> &Names) const;
+
+private:
+  typedef std::vector<std::vector<StringRef> > NamesByLength;
+
+  static void addName(NamesByLength &Index, StringRef Name);
+
+  NamesByLength LocalNames;
+  /// The size of the identifier table when LocalNames was built.
+  unsigned NumLocalNames;
+
+  NamesByLength ExternalNames;
+  /// The source and generation of the identifiers in ExternalNames.
+  IdentifierInfoLookup *External;
+  unsigned ExternalGeneration;
+};
+
 }
 
 #endif
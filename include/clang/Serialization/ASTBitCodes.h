@@ -45,7 +45,7 @@ namespace clang {
     /// for the previous version could still support reading the new
     /// version by ignoring new kinds of subblocks), this number
     /// should be increased.
-    const unsigned VERSION_MINOR = 0;
+    const unsigned VERSION_MINOR = 1;
 
     /// \brief An ID number that refers to an identifier in an AST file.
     /// 
@@ -535,7 +535,30 @@ namespace clang {
 
       /// \brief Record code for undefined but used functions and variables that
       /// need a definition in this TU.
-      UNDEFINED_BUT_USED = 49
+      UNDEFINED_BUT_USED = 49,
+
+      /// \brief Record code for the Bloom filter of the identifiers in the
+      /// IDENTIFIER_TABLE record.
+      ///
+      /// The filter is a blob of 2^N bits, where N is the record's only
+      /// operand. Each identifier in the table sets the bits selected by
+      /// getIdentifierFilterBit for the hash of its name, so a lookup can
+      /// skip the table when any of those bits is clear.
+      IDENTIFIER_FILTER = 50,
+
+      /// \brief Record code for map of record definition IDs to the
+      /// precomputed layouts of those records.
+      RECORD_LAYOUTS_MAP = 51,
+
+      /// \brief Record code for the array of precomputed record layouts.
+      ///
+      /// This array can only be interpreted properly using the record
+      /// layouts map.
+      RECORD_LAYOUTS = 52,
+
+      /// \brief Record code for the index of the comments block, which gives
+      /// the position and number of the comments in each file.
+      COMMENTS_FILE_INDEX = 53
     };
 
     /// \brief Record types used within a source manager block.
@@ -1328,6 +1351,7 @@ namespace clang {
 
       // OpenMP drectives
       STMT_OMP_PARALLEL_DIRECTIVE,
+      STMT_OMP_SIMD_DIRECTIVE,
 
       // ARC
       EXPR_OBJC_BRIDGED_CAST,     // ObjCBridgedCastExpr
@@ -1411,6 +1435,17 @@ namespace clang {
       }
     };
 
+    /// \brief Describes the precomputed layout of a record definition.
+    struct RecordLayoutsInfo {
+      DeclID DefinitionID; // The ID of the definition
+      unsigned Offset;     // Offset into the array of record layouts.
+
+      friend bool operator<(const RecordLayoutsInfo &X,
+                            const RecordLayoutsInfo &Y) {
+        return X.DefinitionID < Y.DefinitionID;
+      }
+    };
+
     /// @}
   }
 } // end namespace clang
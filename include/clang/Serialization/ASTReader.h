@@ -763,6 +763,14 @@ private:
   /// in the chain.
   unsigned TotalNumStatements;
 
+  /// \brief The number of function and method bodies de-serialized from
+  /// the chain.
+  unsigned NumFunctionBodiesRead;
+
+  /// \brief The total number of function and method bodies stored in the
+  /// chain.
+  unsigned TotalNumFunctionBodies;
+
   /// \brief The number of macros de-serialized from the chain.
   unsigned NumMacrosRead;
 
@@ -775,6 +783,10 @@ private:
   /// \brief The number of lookups into identifier tables that succeed.
   unsigned NumIdentifierLookupHits;
 
+  /// \brief The number of lookups into identifier tables that were skipped
+  /// because the table's filter ruled the identifier out.
+  unsigned NumIdentifierLookupsFiltered;
+
   /// \brief The number of selectors that have been read.
   unsigned NumSelectorsRead;
 
@@ -800,6 +812,17 @@ private:
   /// \brief The total number of method pool entries in the selector table.
   unsigned TotalNumMethodPoolEntries;
 
+  /// \brief The number of record layouts taken from AST files instead of
+  /// being computed.
+  unsigned NumRecordLayoutsRead;
+
+  /// \brief The number of modules whose names were made visible.
+  unsigned NumModulesMadeVisible;
+
+  /// \brief The number of deserialized names that were hidden until their
+  /// module was made visible.
+  unsigned NumHiddenNamesMadeVisible;
+
   /// Number of lexical decl contexts read/total.
   unsigned NumLexicalDeclContextsRead, TotalLexicalDeclContexts;
 
@@ -1534,6 +1557,15 @@ public:
   /// the ASTConsumer.
   virtual void StartTranslationUnit(ASTConsumer *Consumer);
 
+  /// \brief Provide the layout of a record definition from an AST file that
+  /// stores its precomputed layout.
+  virtual bool
+  layoutRecordType(const RecordDecl *Record,
+                   uint64_t &Size, uint64_t &Alignment,
+                   llvm::DenseMap<const FieldDecl *, uint64_t> &FieldOffsets,
+                 llvm::DenseMap<const CXXRecordDecl *, CharUnits> &BaseOffsets,
+          llvm::DenseMap<const CXXRecordDecl *, CharUnits> &VirtualBaseOffsets);
+
   /// \brief Print some statistics about AST usage.
   virtual void PrintStats();
 
@@ -1567,6 +1599,12 @@ public:
   /// in all loaded AST files.
   virtual IdentifierIterator *getIdentifiers();
 
+  /// \brief The identifiers in the loaded AST files only change when another
+  /// AST file is loaded, which starts a new generation.
+  virtual unsigned getIdentifiersGeneration() const {
+    return CurrentGeneration;
+  }
+
   /// \brief Load the contents of the global method pool for a given
   /// selector.
   virtual void ReadMethodPool(Selector Sel);
@@ -1658,6 +1696,9 @@ public:
   /// \brief Read the source location entry with index ID.
   virtual bool ReadSLocEntry(int ID);
 
+  /// \brief Read the offset of the source location entry with index ID.
+  virtual unsigned getSLocEntryOffset(int ID);
+
   /// \brief Retrieve the module import location and module name for the
   /// given source manager entry ID.
   virtual std::pair<SourceLocation, StringRef> getModuleImportLoc(int ID);
@@ -1875,12 +1916,9 @@ public:
 
   void ClearSwitchCaseIDs();
 
-  /// \brief Cursors for comments blocks.
-  SmallVector<std::pair<llvm::BitstreamCursor,
-                        serialization::ModuleFile *>, 8> CommentsCursors;
-
-  /// \brief Loads comments ranges.
-  void ReadComments();
+  /// \brief Loads the comment ranges in the given file from the AST file
+  /// that contains it.
+  virtual void ReadCommentsInFile(FileID File);
 };
 
 /// \brief Helper class that saves the current stream position and
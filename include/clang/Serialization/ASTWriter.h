@@ -367,6 +367,10 @@ private:
   /// \brief The number of statements written to the AST file.
   unsigned NumStatements;
 
+  /// \brief The number of function and method bodies written to the AST
+  /// file, each of which is only deserialized on demand.
+  unsigned NumFunctionBodies;
+
   /// \brief The number of macros written to the AST file.
   unsigned NumMacros;
 
@@ -455,6 +459,7 @@ private:
   void WriteFPPragmaOptions(const FPOptions &Opts);
   void WriteOpenCLExtensions(Sema &SemaRef);
   void WriteObjCCategories();
+  void WriteRecordLayouts(ASTContext &Context);
   void WriteRedeclarations();
   void WriteMergedDecls();
                         
@@ -752,6 +757,7 @@ class PCHGenerator : public SemaConsumer {
   llvm::BitstreamWriter Stream;
   ASTWriter Writer;
   bool AllowASTWithErrors;
+  bool Compress;
   bool HasEmittedPCH;
 
 protected:
@@ -762,7 +768,7 @@ public:
   PCHGenerator(const Preprocessor &PP, StringRef OutputFile,
                clang::Module *Module,
                StringRef isysroot, raw_ostream *Out,
-               bool AllowASTWithErrors = false);
+               bool AllowASTWithErrors = false, bool Compress = false);
   ~PCHGenerator();
   virtual void InitializeSema(Sema &S) { SemaPtr = &S; }
   virtual void HandleTranslationUnit(ASTContext &Ctx);
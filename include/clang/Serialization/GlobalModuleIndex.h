@@ -187,6 +187,11 @@ public:
 
   /// \brief Write a global index into the given
   ///
+  /// Module files that haven't changed since the existing index was written
+  /// are described by its entries instead of being read again; the others
+  /// are read in parallel. The existing index remains readable until the new
+  /// one atomically replaces it.
+  ///
   /// \param FileMgr The file manager to use to load module files.
   ///
   /// \param Path The path to the directory containing module files, into
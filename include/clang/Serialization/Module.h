@@ -229,6 +229,13 @@ public:
   /// IdentifierHashTable.
   void *IdentifierLookupTable;
 
+  /// \brief The Bloom filter of the names in IdentifierLookupTable, or null
+  /// if the AST file has none.
+  const unsigned char *IdentifierFilter;
+
+  /// \brief The base 2 logarithm of the number of bits in IdentifierFilter.
+  unsigned IdentifierFilterLog2Bits;
+
   // === Macros ===
 
   /// \brief The cursor to the start of the preprocessor block, which stores
@@ -397,6 +404,27 @@ public:
   /// module.
   SmallVector<uint64_t, 1> ObjCCategories;
 
+  /// \brief Array of record layout location information within this module
+  /// file, sorted by the definition ID.
+  const serialization::RecordLayoutsInfo *RecordLayoutsMap;
+
+  /// \brief The number of entries in RecordLayoutsMap.
+  unsigned LocalNumRecordLayoutsInMap;
+
+  /// \brief The precomputed layouts of the record definitions in this module
+  /// file.
+  SmallVector<uint64_t, 1> RecordLayouts;
+
+  // === Comments ===
+
+  /// \brief Cursor used to read the comments in this AST file.
+  llvm::BitstreamCursor CommentsCursor;
+
+  /// \brief The files of this AST file that contain comments, as triples of
+  /// the start location of the file, the bit offset of its first comment in
+  /// the comments block and the number of its comments, sorted by location.
+  SmallVector<uint64_t, 1> CommentsFileIndex;
+
   // === Types ===
 
   /// \brief The number of types in this AST file.
@@ -44,6 +44,10 @@ class ModuleManager {
 
   /// \brief The visitation order.
   SmallVector<ModuleFile *, 4> VisitOrder;
+
+  /// \brief The position of each module file in the visitation order, by the
+  /// index of the module file.
+  SmallVector<unsigned, 4> VisitOrderPosition;
       
   /// \brief The list of module files that both we and the global module index
   /// know about.
@@ -55,6 +59,16 @@ class ModuleManager {
   /// known to the global index.
   SmallVector<ModuleFile *, 4> ModulesInCommonWithGlobalIndex;
 
+  /// \brief The module files that the global module index doesn't know
+  /// about, in visitation order.
+  ///
+  /// These are visited by every lookup, whether the global module index had
+  /// a hit in them or not.
+  SmallVector<ModuleFile *, 4> ModulesNotInGlobalIndex;
+
+  /// \brief Whether ModulesNotInGlobalIndex needs to be recomputed.
+  bool ModulesNotInGlobalIndexOutOfDate;
+
   /// \brief The global module index, if one is attached.
   ///
   /// The global module index will actually be owned by the ASTReader; this is
@@ -78,6 +92,10 @@ class ModuleManager {
     /// as not-to-be-visited.
     SmallVector<ModuleFile *, 4> Stack;
 
+    /// \brief The module files that may be visited, when the global module
+    /// index narrowed them down.
+    SmallVector<ModuleFile *, 4> Candidates;
+
     /// \brief The visit number of each module file, which indicates when
     /// this module file was last visited.
     SmallVector<unsigned, 4> VisitNumber;
@@ -116,6 +116,26 @@ enum IPAKind {
   IPAK_DynamicDispatchBifurcate = 5
 };
 
+/// \brief Describes the order in which the analyzer explores the nodes of
+/// the exploded graph.
+enum ExplorationStrategyKind {
+  ESK_NotSet = 0,
+
+  /// Explore the most recently generated node first.
+  ESK_DFS = 1,
+
+  /// Explore the nodes in the order in which they were generated.
+  ESK_BFS = 2,
+
+  /// Explore the blocks breadth-first, and the nodes within each block
+  /// depth-first.
+  ESK_BFSBlockDFSContents = 3,
+
+  /// Prefer the nodes entering blocks that no path has reached yet, and among
+  /// the others, those whose path has visited their block the fewest times.
+  ESK_UnexploredFirst = 4
+};
+
 class AnalyzerOptions : public RefCountedBase<AnalyzerOptions> {
 public:
   typedef llvm::StringMap<std::string> ConfigTable;
@@ -131,6 +151,15 @@ public:
   AnalysisPurgeMode AnalysisPurgeOpt;
   
   std::string AnalyzeSpecificFunction;
+
+  /// \brief The file keeping inlining decisions across translation units, or
+  /// empty if they aren't kept.
+  std::string SummaryCacheFile;
+
+  /// \brief The file recording the functions whose analysis reported nothing,
+  /// so that later runs skip them while they are unchanged, or empty if
+  /// every function is analyzed.
+  std::string IncrementalDatabaseFile;
   
   /// \brief The maximum number of times the analyzer visits a block.
   unsigned maxBlockVisitOnPath;
@@ -139,6 +168,7 @@ public:
   unsigned ShowCheckerHelp : 1;
   unsigned AnalyzeAll : 1;
   unsigned AnalyzerDisplayProgress : 1;
+  unsigned AnalyzerDisplayCosts : 1;
   unsigned AnalyzeNestedBlocks : 1;
   
   /// \brief The flag regulates if we should eagerly assume evaluations of
@@ -186,6 +216,9 @@ private:
   /// Controls the mode of inter-procedural analysis.
   IPAKind IPAMode;
 
+  /// Controls the order in which the exploded graph is explored.
+  ExplorationStrategyKind ExplorationStrategy;
+
   /// Controls which C++ member functions will be considered for inlining.
   CXXInlineableMemberKind CXXMemberInliningMode;
   
@@ -198,6 +231,9 @@ private:
   /// \sa mayInlineTemplateFunctions
   Optional<bool> InlineTemplateFunctions;
 
+  /// \sa shouldUseSideEffectSummaries
+  Optional<bool> UseSideEffectSummaries;
+
   /// \sa mayInlineCXXContainerCtorsAndDtors
   Optional<bool> InlineCXXContainerCtorsAndDtors;
 
@@ -235,9 +271,24 @@ private:
   /// \sa getMaxTimesInlineLarge
   Optional<unsigned> MaxTimesInlineLarge;
 
+  /// \sa getMaxBifurcationsPerPath
+  Optional<unsigned> MaxBifurcationsPerPath;
+
+  /// \sa getDeadSymbolSweepInterval
+  Optional<unsigned> DeadSymbolSweepInterval;
+
   /// \sa getMaxNodesPerTopLevelFunction
   Optional<unsigned> MaxNodesPerTopLevelFunction;
 
+  /// \sa getPathDiagnosticTimeLimit
+  Optional<unsigned> PathDiagnosticTimeLimit;
+
+  /// \sa getAnalysisShardCount
+  Optional<unsigned> AnalysisShardCount;
+
+  /// \sa getAnalysisShardIndex
+  Optional<unsigned> AnalysisShardIndex;
+
 public:
   /// Interprets an option's string value as a boolean.
   ///
@@ -259,6 +310,13 @@ public:
   /// \brief Returns the inter-procedural analysis mode.
   IPAKind getIPAMode();
 
+  /// \brief Returns the order in which the exploded graph is explored.
+  ///
+  /// This is controlled by the 'exploration_strategy' config option, which
+  /// accepts the values "dfs" (the default), "bfs", "bfs_block_dfs_contents"
+  /// and "unexplored_first".
+  ExplorationStrategyKind getExplorationStrategy();
+
   /// Returns the option controlling which C++ member functions will be
   /// considered for inlining.
   ///
@@ -376,6 +434,16 @@ public:
   /// for well-known functions.
   bool shouldSynthesizeBodies();
 
+  /// Returns true if the calls that aren't inlined should be evaluated with
+  /// a summary of the side effects of the callee, so that the calls to C
+  /// functions that only write to their own locals don't invalidate the
+  /// arguments and globals. This applies to the calls beyond the inlining
+  /// budget as well as to all calls with 'ipa=none'.
+  ///
+  /// This is controlled by the 'side-effect-summaries' config option, which
+  /// defaults to false.
+  bool shouldUseSideEffectSummaries();
+
   /// Returns how often nodes in the ExplodedGraph should be recycled to save
   /// memory.
   ///
@@ -383,11 +451,32 @@ public:
   /// node reclamation, set the option to "0".
   unsigned getGraphTrimInterval();
 
+  /// Returns how many statements of a basic block the analyzer evaluates
+  /// between the removals of dead bindings and symbols, which are otherwise
+  /// done before every statement that isn't consumed by another expression.
+  /// The removals at the beginning of basic blocks, before calls and at the
+  /// end of functions are always done, so larger values make the states
+  /// carry dead symbols for a few more statements and may report leaks a
+  /// little later.
+  ///
+  /// This is controlled by the 'dead-symbol-sweep-interval' config option,
+  /// which defaults to 1.
+  unsigned getDeadSymbolSweepInterval();
+
   /// Returns the maximum times a large function could be inlined.
   ///
   /// This is controlled by the 'max-times-inline-large' config option.
   unsigned getMaxTimesInlineLarge();
 
+  /// Returns the maximum number of times a path may be split in two by
+  /// the dynamic dispatch bifurcation of 'ipa=dynamic-bifurcate'. Past the
+  /// limit, the calls on new receivers are inlined with their most likely
+  /// definition without keeping a path that doesn't inline them, as with
+  /// 'ipa=dynamic'. 0 means no limit, which is the default.
+  ///
+  /// This is controlled by the 'max-bifurcations-per-path' config option.
+  unsigned getMaxBifurcationsPerPath();
+
   /// Returns the maximum number of nodes the analyzer can generate while
   /// exploring a top level function (for each exploded graph).
   /// 150000 is default; 0 means no limit.
@@ -395,6 +484,32 @@ public:
   /// This is controlled by the 'max-nodes' config option.
   unsigned getMaxNodesPerTopLevelFunction();
 
+  /// Returns the time, in milliseconds, the bug reporter may spend building
+  /// the paths of the reports found while analyzing a top level function.
+  /// The reports flushed after that time get the paths of the 'none' scheme,
+  /// which still run the bug report visitors but have no path pieces.
+  /// 0 is default and means no limit.
+  ///
+  /// This is controlled by the 'path-diagnostics-time-limit' config option.
+  unsigned getPathDiagnosticTimeLimit();
+
+  /// Returns the number of shards the functions of a translation unit are
+  /// split into for path-sensitive analysis. Each function is analyzed as a
+  /// top-level function only by the shard returned by getAnalysisShardIndex,
+  /// and AST-only checks run only in shard 0, so several analyzer processes
+  /// with different shard indices can split the work on one file.
+  ///
+  /// This is controlled by the 'shard-count' config option, which defaults
+  /// to 1.
+  unsigned getAnalysisShardCount();
+
+  /// Returns the shard whose functions this analyzer run analyzes, in
+  /// [0, getAnalysisShardCount()).
+  ///
+  /// This is controlled by the 'shard-index' config option, which defaults
+  /// to 0.
+  unsigned getAnalysisShardIndex();
+
 public:
   AnalyzerOptions() :
     AnalysisStoreOpt(RegionStoreModel),
@@ -404,6 +519,7 @@ public:
     ShowCheckerHelp(0),
     AnalyzeAll(0),
     AnalyzerDisplayProgress(0),
+    AnalyzerDisplayCosts(0),
     AnalyzeNestedBlocks(0),
     eagerlyAssumeBinOpBifurcation(0),
     TrimGraph(0),
@@ -417,6 +533,7 @@ public:
     InliningMode(NoRedundancy),
     UserMode(UMK_NotSet),
     IPAMode(IPAK_NotSet),
+    ExplorationStrategy(ESK_NotSet),
     CXXMemberInliningMode() {}
 
 };
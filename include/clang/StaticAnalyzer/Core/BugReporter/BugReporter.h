@@ -492,9 +492,14 @@ private:
 // FIXME: Get rid of GRBugReporter.  It's the wrong abstraction.
 class GRBugReporter : public BugReporter {
   ExprEngine& Eng;
+
+  /// The wall time, in seconds, spent in generatePathDiagnostic so far. Only
+  /// kept when 'path-diagnostics-time-limit' is set.
+  double PathGenerationTime;
+
 public:
   GRBugReporter(BugReporterData& d, ExprEngine& eng)
-    : BugReporter(d, GRBugReporterKind), Eng(eng) {}
+    : BugReporter(d, GRBugReporterKind), Eng(eng), PathGenerationTime(0) {}
 
   virtual ~GRBugReporter();
 
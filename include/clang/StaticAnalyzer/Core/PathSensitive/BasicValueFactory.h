@@ -70,6 +70,23 @@ class BasicValueFactory {
   void *        PersistentSVals;
   void *        PersistentSValPairs;
 
+  /// The small values of the common integer widths, such as the results of
+  /// comparisons and the literals of loop bounds, are found in this table
+  /// without profiling them for APSIntSet. It is filled in as the values are
+  /// first uniqued.
+  enum {
+    NumSmallValueWidths = 5,      // i1, i8, i16, i32 and i64.
+    MinSmallValue = -1,
+    MaxSmallValue = 63
+  };
+  const llvm::APSInt *
+    SmallValues[NumSmallValueWidths][2][MaxSmallValue - MinSmallValue + 1];
+
+  const llvm::APSInt **getSmallValueSlot(unsigned BitWidth, bool IsUnsigned,
+                                          int64_t X);
+  const llvm::APSInt **getSmallValueSlot(const llvm::APSInt &X);
+  const llvm::APSInt &getUniquedValue(const llvm::APSInt &X);
+
   llvm::ImmutableList<SVal>::Factory SValListFactory;
   llvm::FoldingSet<CompoundValData>  CompoundValDataSet;
   llvm::FoldingSet<LazyCompoundValData> LazyCompoundValDataSet;
@@ -81,7 +98,9 @@ class BasicValueFactory {
 public:
   BasicValueFactory(ASTContext &ctx, llvm::BumpPtrAllocator& Alloc)
   : Ctx(ctx), BPAlloc(Alloc), PersistentSVals(0), PersistentSValPairs(0),
-    SValListFactory(Alloc) {}
+    SValListFactory(Alloc) {
+    memset(SmallValues, 0, sizeof(SmallValues));
+  }
 
   ~BasicValueFactory();
 
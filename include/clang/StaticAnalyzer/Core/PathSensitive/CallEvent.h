@@ -23,6 +23,7 @@
 #include "clang/Basic/SourceManager.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/ProgramState.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/SVals.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/PointerIntPair.h"
 
 namespace clang {
@@ -923,6 +924,11 @@ class CallEventManager {
   llvm::BumpPtrAllocator &Alloc;
   SmallVector<void *, 8> Cache;
 
+  typedef llvm::DenseMap<std::pair<const CXXMethodDecl *,
+                                   const CXXRecordDecl *>,
+                         const FunctionDecl *> OverriderMapTy;
+  OverriderMapTy OverriderDefinitions;
+
   void reclaim(const void *Memory) {
     Cache.push_back(const_cast<void *>(Memory));
   }
@@ -961,6 +967,14 @@ class CallEventManager {
 public:
   CallEventManager(llvm::BumpPtrAllocator &alloc) : Alloc(alloc) {}
 
+  /// \brief Returns the definition of the method of \p RD that overrides
+  /// the virtual method \p MD, or null if it isn't known or has no body.
+  ///
+  /// The lookup walks the class hierarchy, and is asked again on every path
+  /// that reaches the call with the same dynamic type, so its results are
+  /// cached.
+  const FunctionDecl *getOverriderDefinition(const CXXMethodDecl *MD,
+                                             const CXXRecordDecl *RD);
 
   CallEventRef<>
   getCaller(const StackFrameContext *CalleeCtx, ProgramStateRef State);
@@ -151,6 +151,13 @@ protected:
 ConstraintManager* CreateRangeConstraintManager(ProgramStateManager& statemgr,
                                                 SubEngine *subengine);
 
+/// Creates a range constraint manager that also tracks whether two integer
+/// symbols are less than, equal to or greater than each other, so that
+/// paths that contradict comparisons such as "a < b" are pruned.
+ConstraintManager *
+CreateRelationalConstraintManager(ProgramStateManager &statemgr,
+                                  SubEngine *subengine);
+
 } // end GR namespace
 
 } // end clang namespace
@@ -25,6 +25,7 @@
 
 namespace clang {
 
+class AnalyzerOptions;
 class ProgramPointTag;
   
 namespace ento {
@@ -107,13 +108,11 @@ private:
   ExplodedNode *generateCallExitBeginNode(ExplodedNode *N);
 
 public:
-  /// Construct a CoreEngine object to analyze the provided CFG.
+  /// Construct a CoreEngine object to analyze the provided CFG, exploring it
+  /// in the order selected by \p Opts.
   CoreEngine(SubEngine& subengine,
-             FunctionSummariesTy *FS)
-    : SubEng(subengine), G(new ExplodedGraph()),
-      WList(WorkList::makeDFS()),
-      BCounterFactory(G->getAllocator()),
-      FunctionSummaries(FS){}
+             FunctionSummariesTy *FS,
+             AnalyzerOptions &Opts);
 
   /// getGraph - Returns the exploded graph.
   ExplodedGraph& getGraph() { return *G.get(); }
@@ -16,7 +16,9 @@
 
 #include "clang/Analysis/AnalysisContext.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/SVals.h"
+#include "llvm/ADT/FoldingSet.h"
 #include "llvm/ADT/ImmutableMap.h"
+#include "llvm/Support/Allocator.h"
 
 namespace clang {
 
@@ -51,7 +53,40 @@ public:
   }
 };
 
+/// The bindings of an Environment that has only a few of them, sorted by
+/// entry. Like the trees of the larger environments, they are uniqued by the
+/// EnvironmentManager, so that equal environments share their bindings.
+class EnvironmentSmallBindings : public llvm::FoldingSetNode {
+public:
+  typedef std::pair<EnvironmentEntry, SVal> value_type;
+
+private:
+  unsigned NumBindings;
+
+  EnvironmentSmallBindings(ArrayRef<value_type> Bindings);
+  friend class EnvironmentManager;
+
+public:
+  const value_type *begin() const {
+    return reinterpret_cast<const value_type *>(this + 1);
+  }
+  const value_type *end() const { return begin() + NumBindings; }
+  unsigned size() const { return NumBindings; }
+
+  static void Profile(llvm::FoldingSetNodeID &ID,
+                      ArrayRef<value_type> Bindings);
+  void Profile(llvm::FoldingSetNodeID &ID) const {
+    Profile(ID, ArrayRef<value_type>(begin(), end()));
+  }
+};
+
 /// An immutable map from EnvironemntEntries to SVals.
+///
+/// An environment with at most SmallBindingsLimit bindings keeps them in a
+/// sorted array instead of a tree, which is cheaper to build and to look up
+/// for the handful of subexpressions that are usually live at once. Which
+/// form is used only depends on the number of bindings, so that equal
+/// environments are still identical.
 class Environment {
 private:
   friend class EnvironmentManager;
@@ -59,18 +94,70 @@ private:
   // Type definitions.
   typedef llvm::ImmutableMap<EnvironmentEntry, SVal> BindingsTy;
 
+  enum { SmallBindingsLimit = 8 };
+
   // Data.
+  /// The bindings, if there are at most SmallBindingsLimit of them and at
+  /// least one. Otherwise ExprBindings has them.
+  const EnvironmentSmallBindings *SmallBindings;
   BindingsTy ExprBindings;
+  unsigned NumBindings;
+
+  Environment(BindingsTy eb, unsigned NumBindings)
+    : SmallBindings(0), ExprBindings(eb), NumBindings(NumBindings) {}
 
-  Environment(BindingsTy eb)
-    : ExprBindings(eb) {}
+  Environment(const EnvironmentSmallBindings *SB, BindingsTy Empty)
+    : SmallBindings(SB), ExprBindings(Empty), NumBindings(SB->size()) {}
 
+  const SVal *lookup(const EnvironmentEntry &E) const;
   SVal lookupExpr(const EnvironmentEntry &E) const;
 
 public:
-  typedef BindingsTy::iterator iterator;
-  iterator begin() const { return ExprBindings.begin(); }
-  iterator end() const { return ExprBindings.end(); }
+  /// Iterates over the bindings, in either form.
+  class iterator {
+    const EnvironmentSmallBindings::value_type *SmallI;
+    BindingsTy::iterator TreeI;
+
+    iterator(const EnvironmentSmallBindings::value_type *SmallI,
+             BindingsTy::iterator TreeI)
+      : SmallI(SmallI), TreeI(TreeI) {}
+    friend class Environment;
+
+  public:
+    const EnvironmentEntry &getKey() const {
+      return SmallI ? SmallI->first : TreeI.getKey();
+    }
+    const SVal &getData() const {
+      return SmallI ? SmallI->second : TreeI.getData();
+    }
+
+    iterator &operator++() {
+      if (SmallI)
+        ++SmallI;
+      else
+        ++TreeI;
+      return *this;
+    }
+
+    bool operator==(const iterator &RHS) const {
+      return SmallI == RHS.SmallI && TreeI == RHS.TreeI;
+    }
+    bool operator!=(const iterator &RHS) const { return !(*this == RHS); }
+  };
+
+  iterator begin() const {
+    if (SmallBindings)
+      return iterator(SmallBindings->begin(), ExprBindings.end());
+    return iterator(0, ExprBindings.begin());
+  }
+  iterator end() const {
+    if (SmallBindings)
+      return iterator(SmallBindings->end(), ExprBindings.end());
+    return iterator(0, ExprBindings.end());
+  }
+
+  /// Returns the number of bindings.
+  unsigned size() const { return NumBindings; }
 
   /// Fetches the current binding of the expression in the
   /// Environment.
@@ -79,6 +166,7 @@ public:
   /// Profile - Profile the contents of an Environment object for use
   ///  in a FoldingSet.
   static void Profile(llvm::FoldingSetNodeID& ID, const Environment* env) {
+    ID.AddPointer(env->SmallBindings);
     env->ExprBindings.Profile(ID);
   }
 
@@ -89,7 +177,8 @@ public:
   }
 
   bool operator==(const Environment& RHS) const {
-    return ExprBindings == RHS.ExprBindings;
+    return SmallBindings == RHS.SmallBindings &&
+           ExprBindings == RHS.ExprBindings;
   }
   
   void print(raw_ostream &Out, const char *NL, const char *Sep) const;
@@ -104,12 +193,20 @@ private:
   typedef Environment::BindingsTy::Factory FactoryTy;
   FactoryTy F;
 
+  llvm::BumpPtrAllocator &Alloc;
+  llvm::FoldingSet<EnvironmentSmallBindings> SmallBindingsSet;
+
+  /// Returns the environment with \p Bindings, which are sorted by entry.
+  Environment
+  makeEnvironment(ArrayRef<EnvironmentSmallBindings::value_type> Bindings);
+
 public:
-  EnvironmentManager(llvm::BumpPtrAllocator& Allocator) : F(Allocator) {}
+  EnvironmentManager(llvm::BumpPtrAllocator& Allocator)
+    : F(Allocator), Alloc(Allocator) {}
   ~EnvironmentManager() {}
 
   Environment getInitialEnvironment() {
-    return Environment(F.getEmptyMap());
+    return Environment(F.getEmptyMap(), 0);
   }
 
   /// Bind a symbolic value to the given environment entry.
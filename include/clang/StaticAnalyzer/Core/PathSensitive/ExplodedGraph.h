@@ -275,6 +275,13 @@ protected:
   
   /// A list of recently allocated nodes that can potentially be recycled.
   NodeVector ChangedNodes;
+
+  /// Nodes that had no successors yet when they were last considered for
+  /// reclamation, and get one more chance to be reclaimed.
+  NodeVector FrontierNodes;
+
+  /// The number of nodes that have been reclaimed.
+  unsigned NumReclaimedNodes;
   
   /// A list of nodes that can be reused.
   NodeVector FreeNodes;
@@ -358,6 +365,14 @@ public:
   const_eop_iterator eop_end() const { return EndNodes.end(); }
 
   llvm::BumpPtrAllocator & getAllocator() { return BVC.getAllocator(); }
+
+  /// Returns the number of bytes allocated with getAllocator(), for nodes,
+  /// their edge lists and the program states. Reclaimed nodes are reused
+  /// rather than freed, so this is also the peak usage so far.
+  size_t getAllocatedMemory() { return BVC.getAllocator().getTotalMemory(); }
+
+  /// Returns the number of nodes that have been reclaimed so far.
+  unsigned getNumReclaimedNodes() const { return NumReclaimedNodes; }
   BumpVectorContext &getNodeAllocator() { return BVC; }
 
   typedef llvm::DenseMap<const ExplodedNode*, ExplodedNode*> NodeMap;
@@ -383,7 +398,8 @@ public:
   }
 
   /// Reclaim "uninteresting" nodes created since the last time this method
-  /// was called.
+  /// was called. Nodes that haven't got a successor yet are considered again
+  /// the next time.
   void reclaimRecentlyAllocatedNodes();
 
   /// \brief Returns true if nodes for the given expression kind are always
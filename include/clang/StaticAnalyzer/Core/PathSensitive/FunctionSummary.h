@@ -15,19 +15,74 @@
 #define LLVM_CLANG_GR_FUNCTIONSUMMARY_H
 
 #include "clang/Basic/LLVM.h"
+#include "clang/StaticAnalyzer/Core/PersistentAnalysisFile.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/Optional.h"
 #include "llvm/ADT/SmallBitVector.h"
+#include "llvm/ADT/StringMap.h"
 #include <deque>
+#include <string>
 
 namespace clang {
 class Decl;
+class FunctionDecl;
+class Stmt;
 
 namespace ento {
 typedef std::deque<Decl*> SetOfDecls;
 typedef llvm::DenseSet<const Decl*> SetOfConstDecls;
 
+/// \brief Inlining decisions that persist across translation units.
+///
+/// The decisions are kept in a file shared by all the analyzer runs over a
+/// project, so that a function defined in a header (and thus analyzed in
+/// every translation unit including it) is only found to be a bad inlining
+/// candidate once. Functions are identified by their qualified name, type
+/// and pretty-printed body, so a changed or differently preprocessed
+/// definition starts afresh. Decisions made under different analyzer options
+/// are not shared.
+class PersistentFunctionSummaries {
+public:
+  enum Verdict {
+    /// The function may never be inlined: its static properties or the
+    /// analyzer options rule it out.
+    NotInlinable = 'n',
+
+    /// Inlining the function exhausted the block visit budget.
+    ReachedMaxBlockCount = 'b'
+  };
+
+private:
+  PersistentAnalysisFile File;
+
+  /// The verdicts, keyed by the hash of the function's identity.
+  llvm::StringMap<char> Verdicts;
+
+  /// The verdicts reached by this run, to be merged into the file.
+  llvm::StringMap<char> NewVerdicts;
+
+  /// The hashes of the functions seen so far, or the empty string for
+  /// functions that can't be identified across translation units.
+  llvm::DenseMap<const Decl *, std::string> Keys;
+
+  const std::string &getKey(const Decl *D);
+
+public:
+  /// \brief Loads the decisions stored in the file at \p Path, if it exists
+  /// and was written with the same \p OptionsSignature.
+  PersistentFunctionSummaries(StringRef Path, StringRef OptionsSignature);
+
+  /// \brief Returns true if an earlier run decided against inlining \p D.
+  bool shouldNotInline(const Decl *D);
+
+  /// \brief Records the decision not to inline \p D.
+  void recordVerdict(const Decl *D, Verdict V);
+
+  /// \brief Merges the decisions made by this run into the file.
+  void save();
+};
+
 class FunctionSummariesTy {
   class FunctionSummary {
   public:
@@ -47,16 +102,33 @@ class FunctionSummariesTy {
     /// The number of times the function has been inlined.
     unsigned TimesInlined : 32;
 
+    /// True if the side effects of this function have been looked for.
+    unsigned SideEffectsChecked : 1;
+
+    /// True if this function may write to memory outside of its own stack
+    /// frame, directly or through the functions it calls.
+    unsigned MayHaveSideEffects : 1;
+
     FunctionSummary() :
       TotalBasicBlocks(0),
       InlineChecked(0),
-      TimesInlined(0) {}
+      TimesInlined(0),
+      SideEffectsChecked(0) {}
   };
 
   typedef llvm::DenseMap<const Decl *, FunctionSummary> MapTy;
   MapTy Map;
 
+  /// The decisions shared with other translation units, if any.
+  PersistentFunctionSummaries *Persistent;
+
 public:
+  FunctionSummariesTy() : Persistent(0) {}
+
+  void setPersistentSummaries(PersistentFunctionSummaries *P) {
+    Persistent = P;
+  }
+
   MapTy::iterator findOrInsertSummary(const Decl *D) {
     MapTy::iterator I = Map.find(D);
     if (I != Map.end())
@@ -78,16 +150,32 @@ public:
     MapTy::iterator I = findOrInsertSummary(D);
     I->second.InlineChecked = 1;
     I->second.MayInline = 0;
+    if (Persistent)
+      Persistent->recordVerdict(D, PersistentFunctionSummaries::NotInlinable);
   }
 
   void markReachedMaxBlockCount(const Decl *D) {
-    markShouldNotInline(D);
+    MapTy::iterator I = findOrInsertSummary(D);
+    I->second.InlineChecked = 1;
+    I->second.MayInline = 0;
+    if (Persistent)
+      Persistent->recordVerdict(
+          D, PersistentFunctionSummaries::ReachedMaxBlockCount);
   }
 
   Optional<bool> mayInline(const Decl *D) {
-    MapTy::const_iterator I = Map.find(D);
+    MapTy::iterator I = Map.find(D);
     if (I != Map.end() && I->second.InlineChecked)
       return I->second.MayInline;
+
+    // Fall back to what other translation units found out.
+    if (Persistent && Persistent->shouldNotInline(D)) {
+      if (I == Map.end())
+        I = findOrInsertSummary(D);
+      I->second.InlineChecked = 1;
+      I->second.MayInline = 0;
+      return false;
+    }
     return None;
   }
 
@@ -130,9 +218,22 @@ public:
     return 0;
   }
 
+  /// \brief Returns false if the C function \p FD is known to only write to
+  /// its own local variables, and to only call functions that do the same,
+  /// so that a call to it can't change the memory of the caller. The result
+  /// is computed from the bodies the first time \p FD is asked about.
+  ///
+  /// The summaries aren't shared through the persistent summaries: they
+  /// depend on the bodies of the callees as well, which the keys of the
+  /// persistent summaries don't cover.
+  bool mayHaveSideEffects(const FunctionDecl *FD);
+
   unsigned getTotalNumBasicBlocks();
   unsigned getTotalNumVisitedBasicBlocks();
 
+private:
+  bool stmtMayHaveSideEffects(const Stmt *S);
+
 };
 
 }} // end clang ento namespaces
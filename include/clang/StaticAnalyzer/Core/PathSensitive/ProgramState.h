@@ -466,6 +466,9 @@ private:
   /// A vector of ProgramStates that we can reuse.
   std::vector<ProgramState *> freeStates;
 
+  /// The largest number of states that were alive at the same time.
+  unsigned MaxNumStates;
+
 public:
   ProgramStateManager(ASTContext &Ctx,
                  StoreManagerCreator CreateStoreManager,
@@ -497,6 +500,10 @@ public:
 
   llvm::BumpPtrAllocator& getAllocator() { return Alloc; }
 
+  /// Returns the largest number of states that were alive at the same
+  /// time so far.
+  unsigned getMaxNumStates() const { return MaxNumStates; }
+
   MemRegionManager& getRegionManager() {
     return svalBuilder->getRegionManager();
   }
@@ -0,0 +1,72 @@
+//===--- PersistentAnalysisFile.h - Results shared by runs ------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines PersistentAnalysisFile, the file format of the results
+// that analyzer runs share with later runs, and the digests that key them.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_GR_PERSISTENTANALYSISFILE_H
+#define LLVM_CLANG_GR_PERSISTENTANALYSISFILE_H
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include <string>
+
+namespace llvm {
+class MD5;
+}
+
+namespace clang {
+namespace ento {
+
+/// \brief A text file of keys and values that may be shared by the analyzer
+/// runs of a whole project.
+///
+/// The first line is "<magic> <options signature>", followed by one
+/// "<key> <value>" line per entry, or just "<key>" if the value is empty.
+/// A file written with another magic or options signature is ignored. The
+/// file is only ever replaced atomically, so concurrent readers always see
+/// a complete one.
+class PersistentAnalysisFile {
+  std::string Path;
+  std::string Magic;
+  std::string OptionsSignature;
+
+public:
+  typedef llvm::StringMap<std::string> EntryMap;
+
+  /// \param Magic The first word of the file. It should name the contents,
+  /// with a version to bump whenever the way the keys are computed changes.
+  PersistentAnalysisFile(StringRef Path, StringRef Magic,
+                         StringRef OptionsSignature)
+    : Path(Path), Magic(Magic), OptionsSignature(OptionsSignature) {}
+
+  /// \brief Adds the entries of the file to \p Into. Returns false if the
+  /// file doesn't exist, or was written with another magic or signature.
+  bool read(EntryMap &Into) const;
+
+  /// \brief Replaces the file with its current contents, which other runs
+  /// may have updated since it was read, updated with \p NewEntries.
+  /// Returns false if the file could not be written.
+  bool merge(const EntryMap &NewEntries) const;
+};
+
+/// \brief Returns the MD5 hash of \p Data, in hexadecimal.
+std::string getHexDigest(StringRef Data);
+
+/// \brief Finishes \p Hash and returns it in hexadecimal.
+std::string getHexDigest(llvm::MD5 &Hash);
+
+} // end GR namespace
+
+} // end clang namespace
+
+#endif
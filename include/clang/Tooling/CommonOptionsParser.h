@@ -55,6 +55,7 @@ namespace tooling {
 ///   CommonOptionsParser OptionsParser(argc, argv);
 ///   ClangTool Tool(OptionsParser.getCompilations(),
 ///                  OptionsParser.getSourcePathListi());
+///   Tool.setNumThreads(OptionsParser.getNumThreads());
 ///   return Tool.run(newFrontendActionFactory<clang::SyntaxOnlyAction>());
 /// }
 /// \endcode
@@ -76,11 +77,18 @@ public:
     return SourcePathList;
   }
 
+  /// Returns the number of translation units to process concurrently, as
+  /// given by -j. Zero means one per hardware thread.
+  unsigned getNumThreads() const {
+    return NumThreads;
+  }
+
   static const char *const HelpMessage;
 
 private:
   OwningPtr<CompilationDatabase> Compilations;
   std::vector<std::string> SourcePathList;
+  unsigned NumThreads;
 };
 
 }  // namespace tooling
@@ -21,9 +21,8 @@
 #include "llvm/ADT/OwningPtr.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/StringSet.h"
 #include "llvm/Support/MemoryBuffer.h"
-#include "llvm/Support/SourceMgr.h"
-#include "llvm/Support/YAMLParser.h"
 #include <string>
 #include <vector>
 
@@ -70,6 +69,17 @@ public:
   virtual std::vector<CompileCommand> getCompileCommands(
     StringRef FilePath) const;
 
+  /// \brief Returns the compile commands of \p FilePath, or, if it has none
+  /// (as for a header), those of the file of the database that is closest to
+  /// it, with that file replaced by \p FilePath in the command lines.
+  ///
+  /// The closest file is one with the same name but another extension in
+  /// the same directory, or else a file in the nearest directory that
+  /// contains \p FilePath. The candidates are indexed when the database is
+  /// loaded, so this only looks up the file and its parent directories.
+  std::vector<CompileCommand> getInferredCompileCommands(
+    StringRef FilePath) const;
+
   /// \brief Returns the list of all files available in the compilation database.
   ///
   /// These are the 'file' entries of the JSON objects.
@@ -82,7 +92,7 @@ public:
 private:
   /// \brief Constructs a JSON compilation database on a memory buffer.
   JSONCompilationDatabase(llvm::MemoryBuffer *Database)
-    : Database(Database), YAMLStream(Database->getBuffer(), SM) {}
+    : Database(Database) {}
 
   /// \brief Parses the database file and creates the index.
   ///
@@ -90,10 +100,35 @@ private:
   /// failed.
   bool parse(std::string &ErrorMessage);
 
-  // Tuple (directory, commandline) where 'commandline' pointing to the
-  // corresponding nodes in the YAML stream.
-  typedef std::pair<llvm::yaml::ScalarNode*,
-                    llvm::yaml::ScalarNode*> CompileCommandRef;
+  /// \brief Parses the database with a scanner for the plain JSON that
+  /// build systems write, which is much faster than the YAML parser.
+  ///
+  /// Returns false, without indexing anything, if the database uses any
+  /// syntax the scanner does not handle or is malformed; parse() then falls
+  /// back to the YAML parser, which also produces the error messages.
+  bool parseSimpleJSON();
+
+  /// \brief Parses the database with the YAML parser.
+  bool parseYAML(std::string &ErrorMessage);
+
+  /// \brief Adds an entry to the index.
+  void addCommand(StringRef Directory, StringRef Command, StringRef File);
+
+  /// \brief Indexes the files of the database by their paths without
+  /// extension and by the directories containing them, for
+  /// getInferredCompileCommands.
+  void buildInferenceIndex();
+
+  /// \brief Returns a copy of \p Value that lives as long as the database.
+  ///
+  /// Values that are part of the database buffer are returned unchanged;
+  /// others, like strings that had escape sequences, are interned so that
+  /// the many entries sharing a value share its storage.
+  StringRef save(StringRef Value);
+
+  // Tuple (directory, commandline) of the values of an entry, which point
+  // into the database buffer or into Strings.
+  typedef std::pair<StringRef, StringRef> CompileCommandRef;
 
   /// \brief Converts the given array of CompileCommandRefs to CompileCommands.
   void getCommands(ArrayRef<CompileCommandRef> CommandsRef,
@@ -104,9 +139,15 @@ private:
 
   FileMatchTrie MatchTrie;
 
+  // Map the paths of the files without their extension, and every directory
+  // containing files, to the first such file of the database.
+  llvm::StringMap<StringRef> FileByStem;
+  llvm::StringMap<StringRef> FileByDirectory;
+
   OwningPtr<llvm::MemoryBuffer> Database;
-  llvm::SourceMgr SM;
-  llvm::yaml::Stream YAMLStream;
+
+  // The values that could not point into the database buffer.
+  llvm::StringSet<> Strings;
 };
 
 } // end namespace tooling
@@ -22,6 +22,7 @@
 #include "clang/Basic/SourceLocation.h"
 #include "clang/Tooling/Tooling.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Mutex.h"
 #include <set>
 #include <string>
 
@@ -140,7 +141,8 @@ typedef std::set<Replacement, Replacement::Less> Replacements;
 /// \brief Apply all replacements in \p Replaces to the Rewriter \p Rewrite.
 ///
 /// Replacement applications happen independently of the success of
-/// other applications.
+/// other applications. Each file is looked up once, and its replacements
+/// are applied to its rewrite buffer in one go.
 ///
 /// \returns true if all replacements apply. false otherwise.
 bool applyAllReplacements(const Replacements &Replaces, Rewriter &Rewrite);
@@ -151,6 +153,18 @@ bool applyAllReplacements(const Replacements &Replaces, Rewriter &Rewrite);
 /// replacements cannot be applied, this returns an empty \c string.
 std::string applyAllReplacements(StringRef Code, const Replacements &Replaces);
 
+/// \brief Finds the replacements of \p Replaces that conflict with another
+/// replacement of the same file, and adds them to \p Conflicts.
+///
+/// Two replacements conflict if their ranges overlap, or if both insert text
+/// at the same offset, since the order of the insertions is then arbitrary.
+/// Identical replacements, such as those made in a shared header by several
+/// translation units, are merged by the set and don't conflict. Since the
+/// replacements are ordered, this takes a single pass over them.
+///
+/// \returns true if any replacements conflict.
+bool findConflicts(const Replacements &Replaces, Replacements &Conflicts);
+
 /// \brief Calculates how a code \p Position is shifted when \p Replaces are
 /// applied.
 unsigned shiftedCodePosition(const Replacements& Replaces, unsigned Position);
@@ -170,9 +184,20 @@ public:
   /// be added during the run of the tool.
   Replacements &getReplacements();
 
+  /// \brief Adds \p Replaces to the set of replacements of this tool.
+  ///
+  /// Unlike inserting into getReplacements() directly, this may be called
+  /// from FrontendActions running concurrently (see
+  /// ClangTool::setNumThreads). Since Replacements is ordered, the merged
+  /// result does not depend on the order in which translation units finish.
+  void addReplacements(const Replacements &Replaces);
+
   /// \brief Call run(), apply all generated replacements, and immediately save
   /// the results to disk.
   ///
+  /// Replacements that conflict with each other (see findConflicts) are
+  /// reported and skipped, rather than applied in an arbitrary order.
+  ///
   /// \returns 0 upon success. Non-zero upon failure.
   int runAndSave(FrontendActionFactory *ActionFactory);
 
@@ -185,11 +210,13 @@ public:
   bool applyAllReplacements(Rewriter &Rewrite);
 
 private:
-  /// \brief Write all refactored files to disk.
+  /// \brief Write all refactored files to disk, using as many threads as
+  /// set by setNumThreads().
   int saveRewrittenFiles(Rewriter &Rewrite);
 
 private:
   Replacements Replace;
+  llvm::sys::Mutex ReplaceLock;
 };
 
 template <typename Node>
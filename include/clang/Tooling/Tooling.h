@@ -107,6 +107,20 @@ template <typename FactoryT>
 inline FrontendActionFactory *newFrontendActionFactory(
     FactoryT *ConsumerFactory, SourceFileCallbacks *Callbacks = NULL);
 
+/// \brief Returns a new FrontendActionFactory whose actions run the actions of
+/// all of \p Factories over a single parse of each translation unit.
+///
+/// The actions created by \p Factories must be AST consumer-based actions,
+/// like those of the factories returned by newFrontendActionFactory() for a
+/// consumer factory. The factories are not owned by the result and must
+/// outlive it.
+///
+/// Example:
+/// FrontendActionFactory *Factories[] = { LintFactory, IndexFactory };
+/// Tool.run(newMultiplexFrontendActionFactory(Factories));
+FrontendActionFactory *
+newMultiplexFrontendActionFactory(ArrayRef<FrontendActionFactory *> Factories);
+
 /// \brief Runs (and deletes) the tool on 'Code' with the -fsyntax-only flag.
 ///
 /// \param ToolAction The action to run over the code.
@@ -213,6 +227,23 @@ class ClangTool {
   /// \brief Clear the command line arguments adjuster chain.
   void clearArgumentsAdjusters();
 
+  /// \brief Sets the number of translation units run() processes
+  /// concurrently.
+  ///
+  /// \param NumThreads The number of worker threads; 0 means one per
+  ///        hardware thread. The default is 1, which processes all files
+  ///        serially on the calling thread using getFiles().
+  ///
+  /// With more than one thread, each translation unit gets its own
+  /// FileManager and DiagnosticsEngine, and the FrontendActions created by
+  /// the factory run concurrently, so any state they share must be
+  /// synchronized (see RefactoringTool::addReplacements). Translation units
+  /// are still processed one compile directory at a time.
+  void setNumThreads(unsigned NumThreads) { this->NumThreads = NumThreads; }
+
+  /// \brief Returns the number of threads set by setNumThreads().
+  unsigned getNumThreads() const { return NumThreads; }
+
   /// Runs a frontend action over all files specified in the command line.
   ///
   /// \param ActionFactory Factory generating the frontend actions. The function
@@ -222,10 +253,20 @@ class ClangTool {
 
   /// \brief Returns the file manager used in the tool.
   ///
-  /// The file manager is shared between all translation units.
+  /// The file manager is shared between all translation units that are
+  /// processed serially.
   FileManager &getFiles() { return Files; }
 
  private:
+  /// \brief Returns the adjusted command line for the \p I'th compile
+  /// command, with the tool's binary as argv[0].
+  std::vector<std::string> getCommandLine(unsigned I,
+                                          StringRef MainExecutable);
+
+  /// \brief Implements run() for more than one worker thread.
+  int runInParallel(FrontendActionFactory *ActionFactory,
+                    StringRef MainExecutable, unsigned NumWorkers);
+
   // We store compile commands as pair (file name, compile command).
   std::vector< std::pair<std::string, CompileCommand> > CompileCommands;
 
@@ -234,6 +275,8 @@ class ClangTool {
   std::vector< std::pair<StringRef, StringRef> > MappedFileContents;
 
   SmallVector<ArgumentsAdjuster *, 2> ArgsAdjusters;
+
+  unsigned NumThreads;
 };
 
 template <typename T>
@@ -230,6 +230,11 @@ void FileRemapper::remap(StringRef filePath, llvm::MemoryBuffer *memBuf) {
   remap(getOriginalFile(filePath), memBuf);
 }
 
+bool FileRemapper::hasMapping(StringRef filePath) {
+  const FileEntry *file = getOriginalFile(filePath);
+  return file && FromToMappings.count(file);
+}
+
 void FileRemapper::remap(const FileEntry *file, llvm::MemoryBuffer *memBuf) {
   assert(file);
   Target &targ = FromToMappings[file];
@@ -45,6 +45,9 @@ class ObjCMigrateASTConsumer : public ASTConsumer {
                             ObjCMethodDecl *OM,
                             ObjCInstanceTypeFamily OIT_Family = OIT_None);
 
+  /// Whether the files of the translation unit can be migrated, by FileID.
+  llvm::DenseMap<FileID, bool> ModifiableFiles;
+
 public:
   std::string MigrateDir;
   bool MigrateLiterals;
@@ -96,6 +99,10 @@ protected:
   }
 
   virtual void HandleTranslationUnit(ASTContext &Ctx);
+
+  /// \brief Returns false if \p Loc is in a header that was already migrated
+  /// by an earlier translation unit, whose edits are kept.
+  bool canModify(SourceLocation Loc);
 };
 
 }
@@ -197,11 +204,31 @@ public:
 };
 }
 
+bool ObjCMigrateASTConsumer::canModify(SourceLocation Loc) {
+  SourceManager &SM = PP.getSourceManager();
+  FileID FID = SM.getFileID(SM.getExpansionLoc(Loc));
+  if (FID.isInvalid() || FID == SM.getMainFileID())
+    return true;
+
+  std::pair<llvm::DenseMap<FileID, bool>::iterator, bool> Entry =
+    ModifiableFiles.insert(std::make_pair(FID, true));
+  if (Entry.second) {
+    if (const FileEntry *File = SM.getFileEntryForID(FID)) {
+      SmallString<64> FilePath(File->getName());
+      FileMgr.FixupRelativePath(FilePath);
+      Entry.first->second = !Remapper.hasMapping(FilePath.str());
+    }
+  }
+  return Entry.first->second;
+}
+
 void ObjCMigrateASTConsumer::migrateDecl(Decl *D) {
   if (!D)
     return;
   if (isa<ObjCMethodDecl>(D))
     return; // Wait for the ObjC container declaration.
+  if (!canModify(D->getLocation()))
+    return;
 
   BodyMigrator(*this).TraverseDecl(D);
 }
@@ -716,6 +743,13 @@ void ObjCMigrateASTConsumer::HandleTranslationUnit(ASTContext &Ctx) {
   if (MigrateProperty)
     for (DeclContext::decl_iterator D = TU->decls_begin(), DEnd = TU->decls_end();
          D != DEnd; ++D) {
+      // The protocols of the headers migrated by an earlier translation unit
+      // are still needed to check the conformance of the classes.
+      if (!canModify((*D)->getLocation())) {
+        if (ObjCProtocolDecl *PDecl = dyn_cast<ObjCProtocolDecl>(*D))
+          ObjCProtocolDecls.insert(PDecl);
+        continue;
+      }
       if (ObjCInterfaceDecl *CDecl = dyn_cast<ObjCInterfaceDecl>(*D))
         migrateObjCInterfaceDecl(Ctx, CDecl);
       else if (ObjCProtocolDecl *PDecl = dyn_cast<ObjCProtocolDecl>(*D))
@@ -742,6 +776,8 @@ void ObjCMigrateASTConsumer::HandleTranslationUnit(ASTContext &Ctx) {
   for (Rewriter::buffer_iterator
         I = rewriter.buffer_begin(), E = rewriter.buffer_end(); I != E; ++I) {
     FileID FID = I->first;
+    if (!canModify(Ctx.getSourceManager().getLocForStartOfFile(FID)))
+      continue;
     RewriteBuffer &buf = I->second;
     const FileEntry *file = Ctx.getSourceManager().getFileEntryForID(FID);
     assert(file);
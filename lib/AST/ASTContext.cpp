@@ -13,8 +13,11 @@
 
 #include "clang/AST/ASTContext.h"
 #include "CXXABI.h"
+#include "ConstexprBytecode.h"
+#include "ConstexprCallCache.h"
 #include "clang/AST/ASTMutationListener.h"
 #include "clang/AST/Attr.h"
+#include "clang/AST/CXXInheritance.h"
 #include "clang/AST/CharUnits.h"
 #include "clang/AST/Comment.h"
 #include "clang/AST/CommentCommandTraits.h"
@@ -31,6 +34,8 @@
 #include "clang/Basic/Builtins.h"
 #include "clang/Basic/SourceManager.h"
 #include "clang/Basic/TargetInfo.h"
+#include "llvm/ADT/BitVector.h"
+#include "llvm/ADT/PointerUnion.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/Support/Capacity.h"
@@ -57,12 +62,14 @@ enum FloatingRank {
   HalfRank, FloatRank, DoubleRank, LongDoubleRank
 };
 
-RawComment *ASTContext::getRawCommentForDeclNoCache(const Decl *D) const {
-  if (!CommentsLoaded && ExternalSource) {
-    ExternalSource->ReadComments();
-    CommentsLoaded = true;
-  }
+ArrayRef<RawComment *> ASTContext::getRawCommentsInFile(FileID File) const {
+  if (ExternalSource && SourceMgr.isLoadedFileID(File) &&
+      CommentsLoaded.insert(File).second)
+    ExternalSource->ReadCommentsInFile(File);
+  return Comments.getCommentsInFile(File);
+}
 
+RawComment *ASTContext::getRawCommentForDeclNoCache(const Decl *D) const {
   assert(D);
 
   // User can not attach documentation to implicit declarations.
@@ -115,12 +122,6 @@ RawComment *ASTContext::getRawCommentForDeclNoCache(const Decl *D) const {
       isa<TemplateTemplateParmDecl>(D))
     return NULL;
 
-  ArrayRef<RawComment *> RawComments = Comments.getComments();
-
-  // If there are no comments anywhere, we won't find anything.
-  if (RawComments.empty())
-    return NULL;
-
   // Find declaration location.
   // For Objective-C declarations we generally don't expect to have multiple
   // declarators, thus use declaration starting location as the "declaration
@@ -147,6 +148,16 @@ RawComment *ASTContext::getRawCommentForDeclNoCache(const Decl *D) const {
   if (DeclLoc.isInvalid() || !DeclLoc.isFileID())
     return NULL;
 
+  // A comment is only attached to a declaration in the same file, so only the
+  // comments in that file need to be searched (and, for a file from an AST
+  // file, read).
+  ArrayRef<RawComment *> RawComments =
+      getRawCommentsInFile(SourceMgr.getFileID(DeclLoc));
+
+  // If there are no comments in the file, we won't find anything.
+  if (RawComments.empty())
+    return NULL;
+
   // Find the comment that occurs just after this declaration.
   ArrayRef<RawComment *>::iterator Comment;
   {
@@ -659,6 +670,18 @@ ASTContext::getCanonicalTemplateTemplateParmDecl(
   return CanonTTP;
 }
 
+ConstexprBytecode &ASTContext::getConstexprBytecode() {
+  if (!ConstexprInterp)
+    ConstexprInterp.reset(new ConstexprBytecode(*this));
+  return *ConstexprInterp;
+}
+
+ConstexprCallCache &ASTContext::getConstexprCallCache() {
+  if (!ConstexprCalls)
+    ConstexprCalls.reset(new ConstexprCallCache(LangOpts.ConstexprCacheSize));
+  return *ConstexprCalls;
+}
+
 CXXABI *ASTContext::createCXXABI(const TargetInfo &T) {
   if (!LangOpts.CPlusPlus) return 0;
 
@@ -722,7 +745,7 @@ ASTContext::ASTContext(LangOptions& LOpts, SourceManager &SM,
     BuiltinInfo(builtins),
     DeclarationNames(*this),
     ExternalSource(0), Listener(0),
-    Comments(SM), CommentsLoaded(false),
+    Comments(SM),
     CommentCommandTraits(BumpAlloc, LOpts.CommentOpts),
     LastSDM(0, 0)
 {
@@ -766,6 +789,10 @@ ASTContext::~ASTContext() {
                                                     AEnd = DeclAttrs.end();
        A != AEnd; ++A)
     A->second->~AttrVec();
+
+  for (llvm::DenseMap<const CXXRecordDecl*, const CXXBaseSubobjects*>::iterator
+         I = BaseSubobjects.begin(), E = BaseSubobjects.end(); I != E; ++I)
+    I->second->~CXXBaseSubobjects();
 }
 
 void ASTContext::AddDeallocation(void (*Callback)(void*), void *Data) {
@@ -798,7 +825,8 @@ void ASTContext::PrintStats() const {
 #define TYPE(Name, Parent)                                              \
   if (counts[Idx])                                                      \
     llvm::errs() << "    " << counts[Idx] << " " << #Name               \
-                 << " types\n";                                         \
+                 << " types, " << sizeof(Name##Type) << " each ("       \
+                 << counts[Idx] * sizeof(Name##Type) << " bytes)\n";    \
   TotalBytes += counts[Idx] * sizeof(Name##Type);                       \
   ++Idx;
 #define ABSTRACT_TYPE(Name, Parent)
@@ -828,6 +856,11 @@ void ASTContext::PrintStats() const {
                << NumImplicitDestructors
                << " implicit destructors created\n";
 
+  // Rarely-used data that is kept out of the nodes it belongs to.
+  llvm::errs() << DeclAttrs.size() << " declarations with attributes\n";
+  llvm::errs() << DeclsInPrototypeScope.size()
+               << " functions with declarations in their prototype scope\n";
+
   if (ExternalSource.get()) {
     llvm::errs() << "\n";
     ExternalSource->PrintStats();
@@ -1096,6 +1129,24 @@ void ASTContext::setClassScopeSpecializationPattern(FunctionDecl *FD,
   ClassScopeSpecializationPattern[FD] = Pattern;
 }
 
+ArrayRef<NamedDecl *>
+ASTContext::getDeclsInPrototypeScope(const FunctionDecl *FD) const {
+  llvm::DenseMap<const FunctionDecl*, ArrayRef<NamedDecl *> >::const_iterator
+    Pos = DeclsInPrototypeScope.find(FD);
+  if (Pos == DeclsInPrototypeScope.end())
+    return ArrayRef<NamedDecl *>();
+
+  return Pos->second;
+}
+
+void ASTContext::setDeclsInPrototypeScope(const FunctionDecl *FD,
+                                          ArrayRef<NamedDecl *> Decls) {
+  assert(FD && "Function is 0");
+  NamedDecl **Copy = new (*this) NamedDecl*[Decls.size()];
+  std::copy(Decls.begin(), Decls.end(), Copy);
+  DeclsInPrototypeScope[FD] = ArrayRef<NamedDecl *>(Copy, Decls.size());
+}
+
 NamedDecl *
 ASTContext::getInstantiatedFromUsingDecl(UsingDecl *UUD) {
   llvm::DenseMap<UsingDecl *, NamedDecl *>::const_iterator Pos
@@ -2866,6 +2917,7 @@ ASTContext::getFunctionType(QualType ResultTy, ArrayRef<QualType> ArgArray,
   FunctionProtoType::ExtProtoInfo newEPI = EPI;
   newEPI.ExtInfo = EPI.ExtInfo.withCallingConv(CallConv);
   new (FTP) FunctionProtoType(ResultTy, ArgArray, Canonical, newEPI);
+  FTP->ProfileHash = ID.ComputeHash();
   Types.push_back(FTP);
   FunctionProtoTypes.InsertNode(FTP, InsertPos);
   return QualType(FTP, 0);
@@ -3219,6 +3271,7 @@ ASTContext::getCanonicalTemplateSpecializationType(TemplateName Template,
     Spec = new (Mem) TemplateSpecializationType(CanonTemplate,
                                                 CanonArgs.data(), NumArgs,
                                                 QualType(), QualType());
+    Spec->ProfileHash = ID.ComputeHash();
     Types.push_back(Spec);
     TemplateSpecializationTypes.InsertNode(Spec, InsertPos);
   }
@@ -3372,6 +3425,7 @@ ASTContext::getDependentTemplateSpecializationType(
                        TypeAlignment);
   T = new (Mem) DependentTemplateSpecializationType(Keyword, NNS,
                                                     Name, NumArgs, Args, Canon);
+  T->ProfileHash = ID.ComputeHash();
   Types.push_back(T);
   DependentTemplateSpecializationTypes.InsertNode(T, InsertPos);
   return QualType(T, 0);
@@ -8058,8 +8112,65 @@ bool ASTContext::AtomicUsesUnsupportedLibcall(const AtomicExpr *E) const {
   return (Size != Align || toBits(sizeChars) > MaxInlineWidthInBits);
 }
 
+/// \brief A parent of a node in the parent map, which is always a \c Decl or
+/// a \c Stmt, or the parents of a node that has several.
+typedef llvm::PointerUnion3<const Decl *, const Stmt *,
+                            ASTContext::ParentVector *> ParentMapEntry;
+
+/// \brief Maps from a node to its parents. Most nodes have a single parent,
+/// which is stored inline.
+typedef llvm::DenseMap<const void *, ParentMapEntry> ParentNodeMap;
+
+class ASTContext::ParentIndex {
+public:
+  ParentNodeMap Map;
+
+  /// \brief The top-level declarations of the translation unit, in the order
+  /// in which they are traversed.
+  SmallVector<Decl *, 16> TopLevelDecls;
+  /// \brief The index in \c TopLevelDecls of each top-level declaration.
+  llvm::DenseMap<const Decl *, unsigned> TopLevelIDs;
+  /// \brief Whether the nodes of each top-level declaration are in the map.
+  llvm::BitVector Traversed;
+  /// \brief The expansion locations of the top-level declarations and their
+  /// indices, sorted by location.
+  SmallVector<std::pair<SourceRange, unsigned>, 16> ByLocation;
+
+  /// \brief Whether every top-level declaration has been traversed.
+  bool TraversedAll;
+
+  TranslationUnitDecl *TU;
+
+  ParentIndex(ASTContext &Ctx);
+  ~ParentIndex();
+
+  /// \brief Returns the top-level declaration that contains \p Node, or -1 if
+  /// it is not known.
+  int findTopLevelDecl(ASTContext &Ctx,
+                       const ast_type_traits::DynTypedNode &Node) const;
+
+  /// \brief Traverses the given top-level declaration, or every one that has
+  /// not been traversed yet if it shares nodes with other ones.
+  void traverse(unsigned ID);
+  void traverseAll();
+};
+
 namespace {
 
+  /// \brief Returns the single parent in \p Entry.
+  ast_type_traits::DynTypedNode getParentNode(ParentMapEntry Entry) {
+    if (const Decl *D = Entry.dyn_cast<const Decl *>())
+      return ast_type_traits::DynTypedNode::create(*D);
+    return ast_type_traits::DynTypedNode::create(*Entry.get<const Stmt *>());
+  }
+
+  ASTContext::ParentVector getParentVector(ParentMapEntry Entry) {
+    if (ASTContext::ParentVector *V
+          = Entry.dyn_cast<ASTContext::ParentVector *>())
+      return *V;
+    return ASTContext::ParentVector(1, getParentNode(Entry));
+  }
+
   /// \brief A \c RecursiveASTVisitor that builds a map from nodes to their
   /// parents as defined by the \c RecursiveASTVisitor.
   ///
@@ -8071,19 +8182,24 @@ namespace {
   class ParentMapASTVisitor : public RecursiveASTVisitor<ParentMapASTVisitor> {
 
   public:
-    /// \brief Builds and returns the translation unit's parent map.
+    /// \brief Adds the parents of the nodes in the top-level declaration
+    /// \p D to \p Parents.
     ///
-    ///  The caller takes ownership of the returned \c ParentMap.
-    static ASTContext::ParentMap *buildMap(TranslationUnitDecl &TU) {
-      ParentMapASTVisitor Visitor(new ASTContext::ParentMap);
-      Visitor.TraverseDecl(&TU);
-      return Visitor.Parents;
+    /// Returns false if some of those nodes may also be reached from other
+    /// top-level declarations, in which case their parents there are missing.
+    static bool addTopLevelDecl(ParentNodeMap &Parents,
+                                TranslationUnitDecl &TU, Decl *D) {
+      ParentMapASTVisitor Visitor(Parents);
+      Visitor.ParentStack.push_back(&TU);
+      Visitor.TraverseDecl(D);
+      return Visitor.SelfContained;
     }
 
   private:
     typedef RecursiveASTVisitor<ParentMapASTVisitor> VisitorBase;
 
-    ParentMapASTVisitor(ASTContext::ParentMap *Parents) : Parents(Parents) {
+    ParentMapASTVisitor(ParentNodeMap &Parents)
+      : Parents(Parents), SelfContained(true) {
     }
 
     bool shouldVisitTemplateInstantiations() const {
@@ -8098,6 +8214,26 @@ namespace {
       return false;
     }
 
+    /// \brief Returns whether the nodes of \p D can only be reached through
+    /// \p D. Templates, their instantiations and declarations outside their
+    /// semantic context can share nodes with other top-level declarations.
+    static bool isSelfContained(const Decl *D) {
+      if (D->getDeclContext() != D->getLexicalDeclContext() ||
+          D->getDeclContext()->isDependentContext() ||
+          isa<TemplateDecl>(D) || isa<ClassScopeFunctionSpecializationDecl>(D))
+        return false;
+      if (const FunctionDecl *FD = dyn_cast<FunctionDecl>(D))
+        return FD->getTemplatedKind() == FunctionDecl::TK_NonTemplate;
+      if (const CXXRecordDecl *RD = dyn_cast<CXXRecordDecl>(D))
+        return !RD->getDescribedClassTemplate() &&
+               RD->getTemplateSpecializationKind() == TSK_Undeclared;
+      if (const VarDecl *VD = dyn_cast<VarDecl>(D))
+        return VD->getTemplateSpecializationKind() == TSK_Undeclared;
+      if (const EnumDecl *ED = dyn_cast<EnumDecl>(D))
+        return !ED->getInstantiatedFromMemberEnum();
+      return true;
+    }
+
     template <typename T>
     bool TraverseNode(T *Node, bool(VisitorBase:: *traverse) (T *)) {
       if (Node == NULL)
@@ -8111,14 +8247,16 @@ namespace {
         // map. The main problem there is to implement hash functions /
         // comparison operators for all types that DynTypedNode supports that
         // do not have pointer identity.
-        (*Parents)[Node].push_back(ParentStack.back());
-      ParentStack.push_back(ast_type_traits::DynTypedNode::create(*Node));
+        addParent(Node, ParentStack.back());
+      ParentStack.push_back(Node);
       bool Result = (this ->* traverse) (Node);
       ParentStack.pop_back();
       return Result;
     }
 
     bool TraverseDecl(Decl *DeclNode) {
+      if (SelfContained && DeclNode && !isSelfContained(DeclNode))
+        SelfContained = false;
       return TraverseNode(DeclNode, &VisitorBase::TraverseDecl);
     }
 
@@ -8126,30 +8264,165 @@ namespace {
       return TraverseNode(StmtNode, &VisitorBase::TraverseStmt);
     }
 
-    ASTContext::ParentMap *Parents;
-    llvm::SmallVector<ast_type_traits::DynTypedNode, 16> ParentStack;
+    void addParent(const void *Node, ParentMapEntry Parent) {
+      ParentMapEntry &Entry = Parents[Node];
+      if (Entry.isNull()) {
+        Entry = Parent;
+        return;
+      }
+      ASTContext::ParentVector *V
+        = Entry.dyn_cast<ASTContext::ParentVector *>();
+      if (!V) {
+        V = new ASTContext::ParentVector(1, getParentNode(Entry));
+        Entry = V;
+      }
+      V->push_back(getParentNode(Parent));
+    }
+
+    ParentNodeMap &Parents;
+    llvm::SmallVector<ParentMapEntry, 16> ParentStack;
+    bool SelfContained;
 
     friend class RecursiveASTVisitor<ParentMapASTVisitor>;
   };
 
+  /// \brief Orders the top-level declarations by their locations.
+  class TopLevelLocationLess {
+    SourceManager &SM;
+
+  public:
+    TopLevelLocationLess(SourceManager &SM) : SM(SM) { }
+
+    bool operator()(const std::pair<SourceRange, unsigned> &X,
+                    const std::pair<SourceRange, unsigned> &Y) const {
+      return SM.isBeforeInTranslationUnit(X.first.getBegin(),
+                                          Y.first.getBegin());
+    }
+    bool operator()(SourceLocation Loc,
+                    const std::pair<SourceRange, unsigned> &X) const {
+      return SM.isBeforeInTranslationUnit(Loc, X.first.getBegin());
+    }
+    bool operator()(const std::pair<SourceRange, unsigned> &X,
+                    SourceLocation Loc) const {
+      return SM.isBeforeInTranslationUnit(X.first.getBegin(), Loc);
+    }
+  };
+
 } // end namespace
 
+ASTContext::ParentIndex::ParentIndex(ASTContext &Ctx)
+  : TraversedAll(false), TU(Ctx.getTranslationUnitDecl()) {
+  SourceManager &SM = Ctx.getSourceManager();
+  for (DeclContext::decl_iterator D = TU->decls_begin(), DEnd = TU->decls_end();
+       D != DEnd; ++D) {
+    if (isa<BlockDecl>(*D) || isa<CapturedDecl>(*D))
+      continue;
+    unsigned ID = TopLevelDecls.size();
+    TopLevelDecls.push_back(*D);
+    TopLevelIDs[*D] = ID;
+    SourceRange Range = (*D)->getSourceRange();
+    if (Range.isValid())
+      ByLocation.push_back(std::make_pair(
+          SourceRange(SM.getExpansionLoc(Range.getBegin()),
+                      SM.getExpansionRange(Range.getEnd()).second), ID));
+  }
+  Traversed.resize(TopLevelDecls.size());
+  std::sort(ByLocation.begin(), ByLocation.end(), TopLevelLocationLess(SM));
+}
+
+ASTContext::ParentIndex::~ParentIndex() {
+  for (ParentNodeMap::iterator I = Map.begin(), E = Map.end(); I != E; ++I)
+    delete I->second.dyn_cast<ParentVector *>();
+}
+
+int ASTContext::ParentIndex::findTopLevelDecl(
+    ASTContext &Ctx, const ast_type_traits::DynTypedNode &Node) const {
+  SourceLocation Loc;
+  if (const Decl *D = Node.get<Decl>()) {
+    // Look for the outermost lexical context below the translation unit.
+    while (const DeclContext *DC = D->getLexicalDeclContext()) {
+      if (isa<TranslationUnitDecl>(DC))
+        break;
+      D = cast<Decl>(DC);
+    }
+    llvm::DenseMap<const Decl *, unsigned>::const_iterator I
+      = TopLevelIDs.find(D);
+    if (I != TopLevelIDs.end())
+      return I->second;
+    Loc = D->getLocStart();
+  } else if (const Stmt *S = Node.get<Stmt>()) {
+    Loc = S->getLocStart();
+  }
+  if (Loc.isInvalid())
+    return -1;
+
+  // Find the last top-level declaration that starts before the node.
+  SourceManager &SM = Ctx.getSourceManager();
+  Loc = SM.getExpansionLoc(Loc);
+  SmallVectorImpl<std::pair<SourceRange, unsigned> >::const_iterator I
+    = std::upper_bound(ByLocation.begin(), ByLocation.end(), Loc,
+                       TopLevelLocationLess(SM));
+  if (I == ByLocation.begin())
+    return -1;
+  --I;
+  if (SM.isBeforeInTranslationUnit(I->first.getEnd(), Loc))
+    return -1;
+  return I->second;
+}
+
+void ASTContext::ParentIndex::traverse(unsigned ID) {
+  if (Traversed[ID])
+    return;
+  Traversed.set(ID);
+  if (!ParentMapASTVisitor::addTopLevelDecl(Map, *TU, TopLevelDecls[ID]))
+    traverseAll();
+}
+
+void ASTContext::ParentIndex::traverseAll() {
+  if (TraversedAll)
+    return;
+  TraversedAll = true;
+  for (unsigned ID = 0, N = TopLevelDecls.size(); ID != N; ++ID) {
+    if (Traversed[ID])
+      continue;
+    Traversed.set(ID);
+    ParentMapASTVisitor::addTopLevelDecl(Map, *TU, TopLevelDecls[ID]);
+  }
+}
+
 ASTContext::ParentVector
 ASTContext::getParents(const ast_type_traits::DynTypedNode &Node) {
   assert(Node.getMemoizationData() &&
          "Invariant broken: only nodes that support memoization may be "
          "used in the parent map.");
-  if (!AllParents) {
-    // We always need to run over the whole translation unit, as
-    // hasAncestor can escape any subtree.
-    AllParents.reset(
-        ParentMapASTVisitor::buildMap(*getTranslationUnitDecl()));
-  }
-  ParentMap::const_iterator I = AllParents->find(Node.getMemoizationData());
-  if (I == AllParents->end()) {
+  if (!Parents)
+    Parents.reset(new ParentIndex(*this));
+
+  const void *Key = Node.getMemoizationData();
+  ParentNodeMap::const_iterator I = Parents->Map.find(Key);
+  if (I == Parents->Map.end() && !Parents->TraversedAll) {
+    // hasAncestor can escape any subtree, but the nodes of most top-level
+    // declarations can only be reached from the declaration itself.
+    int ID = Parents->findTopLevelDecl(*this, Node);
+    if (ID >= 0 && !Parents->Traversed[ID]) {
+      Parents->traverse(ID);
+      I = Parents->Map.find(Key);
+    }
+    if (I == Parents->Map.end()) {
+      Parents->traverseAll();
+      I = Parents->Map.find(Key);
+    }
+  }
+  if (I == Parents->Map.end()) {
     return ParentVector();
   }
-  return I->second;
+  return getParentVector(I->second);
+}
+
+void ASTContext::buildParentMap() {
+  if (!Parents)
+    Parents.reset(new ParentIndex(*this));
+  Parents->traverseAll();
 }
 
 bool
@@ -15,13 +15,16 @@
 #include "clang/AST/ASTContext.h"
 #include "clang/AST/ASTDiagnostic.h"
 #include "clang/AST/DeclCXX.h"
+#include "clang/AST/DeclHasher.h"
 #include "clang/AST/DeclObjC.h"
 #include "clang/AST/DeclVisitor.h"
 #include "clang/AST/StmtVisitor.h"
 #include "clang/AST/TypeVisitor.h"
 #include "clang/Basic/FileManager.h"
 #include "clang/Basic/SourceManager.h"
+#include "llvm/ADT/SmallString.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
 #include <deque>
 
 namespace clang {
@@ -205,6 +208,10 @@ namespace {
     /// \brief Declaration (from, to) pairs that are known not to be equivalent
     /// (which we have already complained about).
     llvm::DenseSet<std::pair<Decl *, Decl *> > &NonEquivalentDecls;
+
+    /// \brief Declaration (from, to) pairs that earlier checks found to be
+    /// equivalent, or null if they are not remembered.
+    llvm::DenseSet<std::pair<Decl *, Decl *> > *EquivalentDecls;
     
     /// \brief Whether we're being strict about the spelling of types when 
     /// unifying two types.
@@ -219,8 +226,10 @@ namespace {
     StructuralEquivalenceContext(ASTContext &C1, ASTContext &C2,
                llvm::DenseSet<std::pair<Decl *, Decl *> > &NonEquivalentDecls,
                                  bool StrictTypeSpelling = false,
-                                 bool Complain = true)
+                                 bool Complain = true,
+               llvm::DenseSet<std::pair<Decl *, Decl *> > *EquivalentDecls = 0)
       : C1(C1), C2(C2), NonEquivalentDecls(NonEquivalentDecls),
+        EquivalentDecls(EquivalentDecls),
         StrictTypeSpelling(StrictTypeSpelling), Complain(Complain),
         LastDiagFromC2(false) {}
 
@@ -236,6 +245,9 @@ namespace {
     ///
     /// \returns true if an error occurred, false otherwise.
     bool Finish();
+
+    /// \brief Remember the tentative equivalences of a successful check.
+    void RecordEquivalences();
     
   public:
     DiagnosticBuilder Diag1(SourceLocation Loc, unsigned DiagID) {
@@ -1272,13 +1284,13 @@ static bool IsStructurallyEquivalent(StructuralEquivalenceContext &Context,
 /// \brief Determine structural equivalence of two declarations.
 static bool IsStructurallyEquivalent(StructuralEquivalenceContext &Context,
                                      Decl *D1, Decl *D2) {
-  // FIXME: Check for known structural equivalences via a callback of some sort.
-  
-  // Check whether we already know that these two declarations are not
+  // Check whether we already know whether these two declarations are
   // structurally equivalent.
-  if (Context.NonEquivalentDecls.count(std::make_pair(D1->getCanonicalDecl(),
-                                                      D2->getCanonicalDecl())))
+  std::pair<Decl *, Decl *> P(D1->getCanonicalDecl(), D2->getCanonicalDecl());
+  if (Context.NonEquivalentDecls.count(P))
     return false;
+  if (Context.EquivalentDecls && Context.EquivalentDecls->count(P))
+    return true;
   
   // Determine whether we've already produced a tentative equivalence for D1.
   Decl *&EquivToD1 = Context.TentativeEquivalences[D1->getCanonicalDecl()];
@@ -1296,7 +1308,10 @@ bool StructuralEquivalenceContext::IsStructurallyEquivalent(Decl *D1,
   if (!::IsStructurallyEquivalent(*this, D1, D2))
     return false;
   
-  return !Finish();
+  if (Finish())
+    return false;
+  RecordEquivalences();
+  return true;
 }
 
 bool StructuralEquivalenceContext::IsStructurallyEquivalent(QualType T1, 
@@ -1304,7 +1319,20 @@ bool StructuralEquivalenceContext::IsStructurallyEquivalent(QualType T1,
   if (!::IsStructurallyEquivalent(*this, T1, T2))
     return false;
   
-  return !Finish();
+  if (Finish())
+    return false;
+  RecordEquivalences();
+  return true;
+}
+
+void StructuralEquivalenceContext::RecordEquivalences() {
+  // Every tentative equivalence has been verified by now.
+  if (!EquivalentDecls)
+    return;
+  for (llvm::DenseMap<Decl *, Decl *>::iterator
+         I = TentativeEquivalences.begin(), E = TentativeEquivalences.end();
+       I != E; ++I)
+    EquivalentDecls->insert(*I);
 }
 
 bool StructuralEquivalenceContext::Finish() {
@@ -2180,7 +2208,8 @@ bool ASTNodeImporter::IsStructuralMatch(RecordDecl *FromRecord,
   StructuralEquivalenceContext Ctx(Importer.getFromContext(),
                                    Importer.getToContext(),
                                    Importer.getNonEquivalentDecls(),
-                                   false, Complain);
+                                   false, Complain,
+                                   &Importer.getEquivalentDecls());
   return Ctx.IsStructurallyEquivalent(FromRecord, ToRecord);
 }
 
@@ -2188,14 +2217,17 @@ bool ASTNodeImporter::IsStructuralMatch(VarDecl *FromVar, VarDecl *ToVar,
                                         bool Complain) {
   StructuralEquivalenceContext Ctx(
       Importer.getFromContext(), Importer.getToContext(),
-      Importer.getNonEquivalentDecls(), false, Complain);
+      Importer.getNonEquivalentDecls(), false, Complain,
+      &Importer.getEquivalentDecls());
   return Ctx.IsStructurallyEquivalent(FromVar, ToVar);
 }
 
 bool ASTNodeImporter::IsStructuralMatch(EnumDecl *FromEnum, EnumDecl *ToEnum) {
   StructuralEquivalenceContext Ctx(Importer.getFromContext(),
                                    Importer.getToContext(),
-                                   Importer.getNonEquivalentDecls());
+                                   Importer.getNonEquivalentDecls(),
+                                   false, true,
+                                   &Importer.getEquivalentDecls());
   return Ctx.IsStructurallyEquivalent(FromEnum, ToEnum);
 }
 
@@ -2214,15 +2246,19 @@ bool ASTNodeImporter::IsStructuralMatch(ClassTemplateDecl *From,
                                         ClassTemplateDecl *To) {
   StructuralEquivalenceContext Ctx(Importer.getFromContext(),
                                    Importer.getToContext(),
-                                   Importer.getNonEquivalentDecls());
-  return Ctx.IsStructurallyEquivalent(From, To);  
+                                   Importer.getNonEquivalentDecls(),
+                                   false, true,
+                                   &Importer.getEquivalentDecls());
+  return Ctx.IsStructurallyEquivalent(From, To);
 }
 
 bool ASTNodeImporter::IsStructuralMatch(VarTemplateDecl *From,
                                         VarTemplateDecl *To) {
   StructuralEquivalenceContext Ctx(Importer.getFromContext(),
                                    Importer.getToContext(),
-                                   Importer.getNonEquivalentDecls());
+                                   Importer.getNonEquivalentDecls(),
+                                   false, true,
+                                   &Importer.getEquivalentDecls());
   return Ctx.IsStructurallyEquivalent(From, To);
 }
 
@@ -4565,15 +4601,66 @@ Expr *ASTNodeImporter::VisitCStyleCastExpr(CStyleCastExpr *E) {
 
 ASTImporter::ASTImporter(ASTContext &ToContext, FileManager &ToFileManager,
                          ASTContext &FromContext, FileManager &FromFileManager,
-                         bool MinimalImport)
+                         bool MinimalImport, ImportedDeclCache *SharedDecls)
   : ToContext(ToContext), FromContext(FromContext),
     ToFileManager(ToFileManager), FromFileManager(FromFileManager),
-    Minimal(MinimalImport), LastDiagFromFrom(false)
+    Minimal(MinimalImport), LastDiagFromFrom(false), SharedDecls(SharedDecls)
 {
+  assert((!SharedDecls || &SharedDecls->getToContext() == &ToContext) &&
+         "Shared import cache belongs to another context");
   ImportedDecls[FromContext.getTranslationUnitDecl()]
     = ToContext.getTranslationUnitDecl();
 }
 
+/// \brief Compute the key of \p D in the shared import cache.
+///
+/// \returns false if \p D is not a declaration that importers can share.
+bool ASTImporter::getSharedDeclKey(Decl *D, SmallVectorImpl<char> &Key) {
+  // Only named tag definitions and typedefs outside of functions and
+  // templates are shared. These are the declarations that common headers
+  // bring into every AST file, and that cost a structural equivalence check
+  // to merge.
+  NamedDecl *ND = dyn_cast<NamedDecl>(D);
+  if (!ND || !ND->getIdentifier() || D->isInvalidDecl() ||
+      D->getDeclContext()->isFunctionOrMethod() ||
+      D->getDeclContext()->isDependentContext())
+    return false;
+  if (TagDecl *Tag = dyn_cast<TagDecl>(D)) {
+    if (!Tag->isCompleteDefinition() || Tag->isDependentContext())
+      return false;
+    if (CXXRecordDecl *Record = dyn_cast<CXXRecordDecl>(D))
+      if (Record->getTemplateSpecializationKind() != TSK_Undeclared)
+        return false;
+  } else if (TypedefNameDecl *Typedef = dyn_cast<TypedefNameDecl>(D)) {
+    // The typedef names an anonymous tag, which is linked to it on import.
+    if (const TagType *Tag = Typedef->getUnderlyingType()->getAs<TagType>())
+      if (!Tag->getDecl()->getIdentifier())
+        return false;
+  } else {
+    return false;
+  }
+
+  // Identify the declaration by the file, and the version of that file, it
+  // was written in, and by its offset there. Its hash tells apart
+  // declarations written at the same place but preprocessed differently.
+  SourceManager &SM = FromContext.getSourceManager();
+  SourceLocation Loc = SM.getExpansionLoc(D->getLocation());
+  if (Loc.isInvalid())
+    return false;
+  std::pair<FileID, unsigned> Decomposed = SM.getDecomposedLoc(Loc);
+  const FileEntry *File = SM.getFileEntryForID(Decomposed.first);
+  if (!File)
+    return false;
+
+  llvm::raw_svector_ostream OS(Key);
+  OS << ND->getQualifiedNameAsString() << '@' << File->getName() << ':'
+     << File->getSize() << ':' << File->getModificationTime() << ':'
+     << Decomposed.second << ':'
+     << DeclHasher(FromContext).getHash(D);
+  OS.flush();
+  return true;
+}
+
 ASTImporter::~ASTImporter() { }
 
 QualType ASTImporter::Import(QualType FromT) {
@@ -4628,6 +4715,14 @@ Decl *ASTImporter::Import(Decl *FromD) {
     return ToD;
   }
   
+  // Reuse the declaration that an importer sharing our cache produced for
+  // the same source declaration.
+  SmallString<128> SharedKey;
+  if (SharedDecls && !Minimal && getSharedDeclKey(FromD, SharedKey)) {
+    if (Decl *ToD = SharedDecls->lookup(SharedKey))
+      return Imported(FromD, ToD);
+  }
+
   // Import the type
   Decl *ToD = Importer.Visit(FromD);
   if (!ToD)
@@ -4635,6 +4730,9 @@ Decl *ASTImporter::Import(Decl *FromD) {
   
   // Record the imported declaration.
   ImportedDecls[FromD] = ToD;
+  if (!SharedKey.empty() && ToD->getKind() == FromD->getKind() &&
+      (!isa<TagDecl>(ToD) || cast<TagDecl>(ToD)->isCompleteDefinition()))
+    SharedDecls->insert(SharedKey, ToD);
   
   if (TagDecl *FromTag = dyn_cast<TagDecl>(FromD)) {
     // Keep track of anonymous tags that have an associated typedef.
@@ -5119,6 +5217,6 @@ bool ASTImporter::IsStructurallyEquivalent(QualType From, QualType To,
     return true;
       
   StructuralEquivalenceContext Ctx(FromContext, ToContext, NonEquivalentDecls,
-                                   false, Complain);
+                                   false, Complain, &EquivalentDecls);
   return Ctx.IsStructurallyEquivalent(From, To);
 }
@@ -38,6 +38,8 @@ clang_ast_SRC_FILES :=	\
 	CommentLexer.cpp \
 	CommentParser.cpp \
 	CommentSema.cpp \
+	ConstexprBytecode.cpp \
+	ConstexprCallCache.cpp \
 	CXXInheritance.cpp	\
 	Decl.cpp	\
 	DeclarationName.cpp	\
@@ -77,7 +77,49 @@ void CXXBasePaths::swap(CXXBasePaths &Other) {
   std::swap(DetectedVirtual, Other.DetectedVirtual);
 }
 
+static bool NoBaseMatches(const CXXBaseSpecifier *Specifier,
+                          CXXBasePath &Path, void *UserData) {
+  return false;
+}
+
+CXXBaseSubobjects::CXXBaseSubobjects(const CXXRecordDecl *Record) {
+  // Walk every base class subobject by searching for a base that never
+  // matches, then keep the subobject counts the search made along the way.
+  CXXBasePaths Paths(/*FindAmbiguities=*/true, /*RecordPaths=*/false,
+                     /*DetectVirtual=*/false);
+  Paths.lookupInBases(Record->getASTContext(), Record, &NoBaseMatches, 0);
+
+  for (llvm::SmallDenseMap<QualType, std::pair<bool, unsigned>, 8>::iterator
+         I = Paths.ClassSubobjects.begin(), E = Paths.ClassSubobjects.end();
+       I != E; ++I) {
+    const RecordType *Ty = I->first->getAs<RecordType>();
+    Subobjects[Ty->getDecl()->getCanonicalDecl()] = I->second;
+  }
+}
+
+const CXXBaseSubobjects *
+ASTContext::getBaseSubobjects(const CXXRecordDecl *RD) const {
+  RD = RD->getDefinition();
+  if (!RD || !RD->isCompleteDefinition() || RD->isDependentContext())
+    return 0;
+
+  const CXXBaseSubobjects *&Entry = BaseSubobjects[RD->getCanonicalDecl()];
+  if (!Entry) {
+    // Computing the subobjects never asks for those of another class, so the
+    // reference into the cache stays valid.
+    Entry = new (*this) CXXBaseSubobjects(RD);
+  }
+  return Entry;
+}
+
 bool CXXRecordDecl::isDerivedFrom(const CXXRecordDecl *Base) const {
+  if (getCanonicalDecl() == Base->getCanonicalDecl())
+    return false;
+
+  if (const CXXBaseSubobjects *Subobjects
+        = getASTContext().getBaseSubobjects(this))
+    return Subobjects->hasBase(Base);
+
   CXXBasePaths Paths(/*FindAmbiguities=*/false, /*RecordPaths=*/false,
                      /*DetectVirtual=*/false);
   return isDerivedFrom(Base, Paths);
@@ -89,6 +131,13 @@ bool CXXRecordDecl::isDerivedFrom(const CXXRecordDecl *Base,
     return false;
   
   Paths.setOrigin(const_cast<CXXRecordDecl*>(this));
+
+  // Most queries fail; answer those without walking the bases.
+  if (const CXXBaseSubobjects *Subobjects
+        = getASTContext().getBaseSubobjects(this))
+    if (!Subobjects->hasBase(Base))
+      return false;
+
   return lookupInBases(&FindBaseClass,
                        const_cast<CXXRecordDecl*>(Base->getCanonicalDecl()),
                        Paths);
@@ -98,12 +147,15 @@ bool CXXRecordDecl::isVirtuallyDerivedFrom(const CXXRecordDecl *Base) const {
   if (!getNumVBases())
     return false;
 
-  CXXBasePaths Paths(/*FindAmbiguities=*/false, /*RecordPaths=*/false,
-                     /*DetectVirtual=*/false);
-
   if (getCanonicalDecl() == Base->getCanonicalDecl())
     return false;
+
+  if (const CXXBaseSubobjects *Subobjects
+        = getASTContext().getBaseSubobjects(this))
+    return Subobjects->hasVirtualBase(Base);
   
+  CXXBasePaths Paths(/*FindAmbiguities=*/false, /*RecordPaths=*/false,
+                     /*DetectVirtual=*/false);
   Paths.setOrigin(const_cast<CXXRecordDecl*>(this));
 
   const void *BasePtr = static_cast<const void*>(Base->getCanonicalDecl());
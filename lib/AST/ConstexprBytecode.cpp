@@ -0,0 +1,998 @@
+//===--- ConstexprBytecode.cpp - Bytecode for constexpr calls -------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements ConstexprBytecode, a compiler from constexpr function
+// bodies to bytecode for a stack machine, and the interpreter that runs it.
+//
+// Only integer computations are supported: a function is compiled if its
+// parameters, result and local variables have integral or enumeration types
+// of at most 64 bits, and its body consists of the statements and
+// expressions handled below. Values are kept in 64-bit slots, truncated to
+// the width of their type and then sign- or zero-extended.
+//
+//===----------------------------------------------------------------------===//
+
+#include "ConstexprBytecode.h"
+#include "clang/AST/APValue.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/DeclCXX.h"
+#include "clang/AST/Expr.h"
+#include "clang/AST/ExprCXX.h"
+#include "clang/AST/Stmt.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/DataTypes.h"
+#include <algorithm>
+#include <vector>
+
+using namespace clang;
+
+namespace {
+
+/// The width and signedness of the type of a value.
+struct IntType {
+  unsigned char Width;
+  bool Signed;
+
+  IntType() : Width(0), Signed(false) {}
+  IntType(unsigned Width, bool Signed) : Width(Width), Signed(Signed) {}
+
+  bool operator==(IntType RHS) const {
+    return Width == RHS.Width && Signed == RHS.Signed;
+  }
+  bool operator!=(IntType RHS) const { return !(*this == RHS); }
+};
+
+enum Opcode {
+  OP_Const,       // Push Arg.
+  OP_Load,        // Push local variable Arg.
+  OP_Store,       // Pop into local variable Arg.
+  OP_LoadGlobal,  // Push the value of global variable Arg.
+  OP_Pop,         // Pop and discard.
+  OP_Step,        // Count one evaluation step.
+  OP_Jump,        // Continue at instruction Arg.
+  OP_JumpIfFalse, // Pop, and continue at instruction Arg if zero.
+  OP_JumpIfTrue,  // Pop, and continue at instruction Arg if non-zero.
+  OP_Convert,     // Convert the top of the stack to Type.
+  OP_Neg,
+  OP_Not,
+  OP_LNot,
+  // Binary operators pop their RHS, then replace their LHS with the result.
+  OP_Add,
+  OP_Sub,
+  OP_Mul,
+  OP_Div,
+  OP_Rem,
+  OP_Shl,
+  OP_Shr,
+  OP_And,
+  OP_Or,
+  OP_Xor,
+  OP_LT,
+  OP_GT,
+  OP_LE,
+  OP_GE,
+  OP_EQ,
+  OP_NE,
+  OP_Call,        // Call function Arg, with its arguments on the stack.
+  OP_Return,      // Return the top of the stack.
+  OP_Fail         // Give up evaluating.
+};
+
+/// A single instruction. Depending on the opcode, Arg is a value, the slot
+/// of a local variable, the index of the instruction to jump to, or an index
+/// into the function's table of callees or global variables.
+struct Instr {
+  Opcode Op;
+  IntType Type;
+  int64_t Arg;
+};
+
+} // end anonymous namespace
+
+struct ConstexprBytecode::Function {
+  std::vector<Instr> Code;
+  SmallVector<IntType, 4> ParamTypes;
+  IntType ResultType;
+
+  /// The number of slots for parameters and local variables.
+  unsigned NumLocals;
+
+  std::vector<const FunctionDecl *> Callees;
+  std::vector<const VarDecl *> Globals;
+
+  Function() : NumLocals(0) {}
+};
+
+/// Truncates \p V to the width of \p T, and sign- or zero-extends the result
+/// to 64 bits, which is how values of type \p T are represented.
+static int64_t normalize(uint64_t V, IntType T) {
+  if (T.Width >= 64)
+    return V;
+  uint64_t Mask = (uint64_t(1) << T.Width) - 1;
+  V &= Mask;
+  if (T.Signed && (V >> (T.Width - 1)))
+    V |= ~Mask;
+  return V;
+}
+
+static bool fitsIn(int64_t V, IntType T) {
+  return normalize(V, T) == V;
+}
+
+static bool getIntType(ASTContext &Ctx, QualType T, IntType &Result) {
+  if (!T->isIntegralOrEnumerationType() || T.isVolatileQualified())
+    return false;
+  unsigned Width = Ctx.getIntWidth(T);
+  if (Width == 0 || Width > 64)
+    return false;
+  Result = IntType(Width, T->isSignedIntegerOrEnumerationType());
+  return true;
+}
+
+static int64_t getValue(const llvm::APSInt &V, IntType T) {
+  return normalize(V.isSigned() ? V.getSExtValue() : V.getZExtValue(), T);
+}
+
+/// Performs a binary operation on two values of type \p T (for shifts, only
+/// \p L has type \p T). Returns false if the constant evaluator would not
+/// perform the operation without a diagnostic.
+static bool evaluateBinOp(Opcode Op, IntType T, int64_t L, int64_t R,
+                          int64_t &Result) {
+  uint64_t UL = L, UR = R;
+  switch (Op) {
+  default:
+    llvm_unreachable("not a binary operator");
+
+  case OP_Add:
+    if (!T.Signed) {
+      Result = normalize(UL + UR, T);
+      return true;
+    }
+    if (T.Width == 64 &&
+        ((R > 0 && L > INT64_MAX - R) || (R < 0 && L < INT64_MIN - R)))
+      return false;
+    Result = L + R;
+    return fitsIn(Result, T);
+
+  case OP_Sub:
+    if (!T.Signed) {
+      Result = normalize(UL - UR, T);
+      return true;
+    }
+    if (T.Width == 64 &&
+        ((R < 0 && L > INT64_MAX + R) || (R > 0 && L < INT64_MIN + R)))
+      return false;
+    Result = L - R;
+    return fitsIn(Result, T);
+
+  case OP_Mul:
+    if (!T.Signed) {
+      Result = normalize(UL * UR, T);
+      return true;
+    }
+    if (T.Width > 32 &&
+        (L > 0 ? (R > 0 ? L > INT64_MAX / R : R < INT64_MIN / L)
+               : (R > 0 ? L < INT64_MIN / R : (L != 0 && R < INT64_MAX / L))))
+      return false;
+    Result = L * R;
+    return fitsIn(Result, T);
+
+  case OP_Div:
+  case OP_Rem:
+    if (R == 0)
+      return false;
+    if (!T.Signed) {
+      Result = Op == OP_Div ? UL / UR : UL % UR;
+      return true;
+    }
+    // The quotient of the smallest value and -1 overflows.
+    if (R == -1) {
+      if (L == INT64_MIN || !fitsIn(-L, T))
+        return false;
+      Result = Op == OP_Div ? -L : 0;
+      return true;
+    }
+    Result = Op == OP_Div ? L / R : L % R;
+    return true;
+
+  case OP_Shl:
+    if (R < 0 || R >= T.Width)
+      return false;
+    // A signed left shift must not shift out any bits of a non-negative
+    // value, but may shift into the sign bit.
+    if (T.Signed && (L < 0 || (R && UL >> (T.Width - R))))
+      return false;
+    Result = normalize(UL << R, T);
+    return true;
+
+  case OP_Shr:
+    if (R < 0 || R >= T.Width)
+      return false;
+    if (T.Signed)
+      Result = L < 0 ? ~(~L >> R) : L >> R;
+    else
+      Result = UL >> R;
+    return true;
+
+  case OP_And: Result = L & R; return true;
+  case OP_Or:  Result = L | R; return true;
+  case OP_Xor: Result = L ^ R; return true;
+
+  case OP_LT: Result = T.Signed ? L < R : UL < UR; return true;
+  case OP_GT: Result = T.Signed ? L > R : UL > UR; return true;
+  case OP_LE: Result = T.Signed ? L <= R : UL <= UR; return true;
+  case OP_GE: Result = T.Signed ? L >= R : UL >= UR; return true;
+  case OP_EQ: Result = L == R; return true;
+  case OP_NE: Result = L != R; return true;
+  }
+}
+
+static Opcode getBinOpcode(BinaryOperatorKind Kind) {
+  switch (Kind) {
+  case BO_Mul: case BO_MulAssign: return OP_Mul;
+  case BO_Div: case BO_DivAssign: return OP_Div;
+  case BO_Rem: case BO_RemAssign: return OP_Rem;
+  case BO_Add: case BO_AddAssign: return OP_Add;
+  case BO_Sub: case BO_SubAssign: return OP_Sub;
+  case BO_Shl: case BO_ShlAssign: return OP_Shl;
+  case BO_Shr: case BO_ShrAssign: return OP_Shr;
+  case BO_And: case BO_AndAssign: return OP_And;
+  case BO_Xor: case BO_XorAssign: return OP_Xor;
+  case BO_Or:  case BO_OrAssign:  return OP_Or;
+  case BO_LT: return OP_LT;
+  case BO_GT: return OP_GT;
+  case BO_LE: return OP_LE;
+  case BO_GE: return OP_GE;
+  case BO_EQ: return OP_EQ;
+  case BO_NE: return OP_NE;
+  default:    return OP_Fail;
+  }
+}
+
+namespace {
+
+/// Compiles the body of a single function. Each statement starts with an
+/// OP_Step, so that steps are counted exactly as the constant evaluator
+/// counts them.
+class FunctionCompiler {
+  ASTContext &Ctx;
+  ConstexprBytecode::Function &Fn;
+
+  /// The slot and type of each parameter and local variable.
+  llvm::DenseMap<const VarDecl *, std::pair<unsigned, IntType> > Locals;
+
+  /// The jumps out of each enclosing loop that still need a target.
+  struct Loop {
+    SmallVector<unsigned, 4> Breaks;
+    SmallVector<unsigned, 4> Continues;
+  };
+  SmallVector<Loop, 4> Loops;
+
+public:
+  FunctionCompiler(ASTContext &Ctx, ConstexprBytecode::Function &Fn)
+      : Ctx(Ctx), Fn(Fn) {}
+
+  bool compile(const FunctionDecl *FD);
+
+private:
+  unsigned emit(Opcode Op, IntType Type = IntType(), int64_t Arg = 0) {
+    Instr I = { Op, Type, Arg };
+    Fn.Code.push_back(I);
+    return Fn.Code.size() - 1;
+  }
+
+  /// Makes the given jump continue at the next instruction emitted.
+  void setJumpTarget(unsigned Jump) { Fn.Code[Jump].Arg = Fn.Code.size(); }
+
+  void setJumpTargets(ArrayRef<unsigned> Jumps) {
+    for (unsigned I = 0, E = Jumps.size(); I != E; ++I)
+      setJumpTarget(Jumps[I]);
+  }
+
+  bool compileStmt(const Stmt *S);
+  bool compileLoopBody(const Stmt *Body, unsigned &ContinueJumps);
+  bool compileVarDecl(const VarDecl *VD);
+  bool compileExpr(const Expr *E, IntType &T);
+  bool compileExpr(const Expr *E, IntType Expected, bool AllowConversion);
+  bool compileLoad(const Expr *E, IntType T);
+  bool compileBinaryOperator(const BinaryOperator *E, IntType T);
+  bool compileAssignment(const BinaryOperator *E, IntType T);
+  bool compileIncDec(const UnaryOperator *E, IntType T);
+  bool compileCall(const CallExpr *E, IntType T);
+  bool getLocal(const Expr *E, unsigned &Slot, IntType &T);
+};
+
+} // end anonymous namespace
+
+bool FunctionCompiler::compile(const FunctionDecl *FD) {
+  if (FD->isVariadic())
+    return false;
+  if (const CXXMethodDecl *MD = dyn_cast<CXXMethodDecl>(FD))
+    if (!MD->isStatic())
+      return false;
+  if (!getIntType(Ctx, FD->getResultType(), Fn.ResultType))
+    return false;
+
+  for (unsigned I = 0, E = FD->getNumParams(); I != E; ++I) {
+    IntType T;
+    if (!getIntType(Ctx, FD->getParamDecl(I)->getType(), T))
+      return false;
+    Fn.ParamTypes.push_back(T);
+    Locals[FD->getParamDecl(I)] = std::make_pair(Fn.NumLocals++, T);
+  }
+
+  const Stmt *Body = FD->getBody();
+  if (!Body || !compileStmt(Body))
+    return false;
+
+  // Flowing off the end of the function is diagnosed by the evaluator.
+  emit(OP_Fail);
+  return true;
+}
+
+bool FunctionCompiler::compileStmt(const Stmt *S) {
+  emit(OP_Step);
+
+  switch (S->getStmtClass()) {
+  default:
+    if (const Expr *E = dyn_cast<Expr>(S)) {
+      IntType T;
+      if (!compileExpr(E, T))
+        return false;
+      emit(OP_Pop);
+      return true;
+    }
+    return false;
+
+  case Stmt::NullStmtClass:
+    return true;
+
+  case Stmt::LabelStmtClass:
+    return compileStmt(cast<LabelStmt>(S)->getSubStmt());
+
+  case Stmt::AttributedStmtClass:
+    return compileStmt(cast<AttributedStmt>(S)->getSubStmt());
+
+  case Stmt::DeclStmtClass: {
+    // Declarations other than variables need no evaluation.
+    const DeclStmt *DS = cast<DeclStmt>(S);
+    for (DeclStmt::const_decl_iterator I = DS->decl_begin(),
+           E = DS->decl_end(); I != E; ++I)
+      if (const VarDecl *VD = dyn_cast<VarDecl>(*I))
+        if (!compileVarDecl(VD))
+          return false;
+    return true;
+  }
+
+  case Stmt::ReturnStmtClass: {
+    const Expr *RetExpr = cast<ReturnStmt>(S)->getRetValue();
+    if (!RetExpr || !compileExpr(RetExpr, Fn.ResultType, false))
+      return false;
+    emit(OP_Return);
+    return true;
+  }
+
+  case Stmt::CompoundStmtClass: {
+    const CompoundStmt *CS = cast<CompoundStmt>(S);
+    for (CompoundStmt::const_body_iterator I = CS->body_begin(),
+           E = CS->body_end(); I != E; ++I)
+      if (!compileStmt(*I))
+        return false;
+    return true;
+  }
+
+  case Stmt::IfStmtClass: {
+    const IfStmt *IS = cast<IfStmt>(S);
+    IntType CondT;
+    if ((IS->getConditionVariable() &&
+         !compileVarDecl(IS->getConditionVariable())) ||
+        !compileExpr(IS->getCond(), CondT))
+      return false;
+    unsigned ToElse = emit(OP_JumpIfFalse);
+    if (!compileStmt(IS->getThen()))
+      return false;
+    if (!IS->getElse()) {
+      setJumpTarget(ToElse);
+      return true;
+    }
+    unsigned ToEnd = emit(OP_Jump);
+    setJumpTarget(ToElse);
+    if (!compileStmt(IS->getElse()))
+      return false;
+    setJumpTarget(ToEnd);
+    return true;
+  }
+
+  case Stmt::WhileStmtClass: {
+    const WhileStmt *WS = cast<WhileStmt>(S);
+    unsigned Top = Fn.Code.size();
+    IntType CondT;
+    if ((WS->getConditionVariable() &&
+         !compileVarDecl(WS->getConditionVariable())) ||
+        !compileExpr(WS->getCond(), CondT))
+      return false;
+    unsigned ToEnd = emit(OP_JumpIfFalse);
+
+    Loops.push_back(Loop());
+    if (!compileStmt(WS->getBody()))
+      return false;
+    Loop L = Loops.pop_back_val();
+    setJumpTargets(L.Continues);
+    emit(OP_Jump, IntType(), Top);
+    setJumpTarget(ToEnd);
+    setJumpTargets(L.Breaks);
+    return true;
+  }
+
+  case Stmt::DoStmtClass: {
+    const DoStmt *DS = cast<DoStmt>(S);
+    unsigned Top = Fn.Code.size();
+    Loops.push_back(Loop());
+    if (!compileStmt(DS->getBody()))
+      return false;
+    Loop L = Loops.pop_back_val();
+    setJumpTargets(L.Continues);
+    IntType CondT;
+    if (!compileExpr(DS->getCond(), CondT))
+      return false;
+    emit(OP_JumpIfTrue, IntType(), Top);
+    setJumpTargets(L.Breaks);
+    return true;
+  }
+
+  case Stmt::ForStmtClass: {
+    const ForStmt *FS = cast<ForStmt>(S);
+    if (FS->getInit() && !compileStmt(FS->getInit()))
+      return false;
+
+    unsigned Top = Fn.Code.size();
+    if (FS->getConditionVariable() &&
+        !compileVarDecl(FS->getConditionVariable()))
+      return false;
+    unsigned ToEnd = 0;
+    if (FS->getCond()) {
+      IntType CondT;
+      if (!compileExpr(FS->getCond(), CondT))
+        return false;
+      ToEnd = emit(OP_JumpIfFalse);
+    }
+
+    Loops.push_back(Loop());
+    if (!compileStmt(FS->getBody()))
+      return false;
+    Loop L = Loops.pop_back_val();
+    setJumpTargets(L.Continues);
+    if (FS->getInc()) {
+      IntType IncT;
+      if (!compileExpr(FS->getInc(), IncT))
+        return false;
+      emit(OP_Pop);
+    }
+    emit(OP_Jump, IntType(), Top);
+    if (FS->getCond())
+      setJumpTarget(ToEnd);
+    setJumpTargets(L.Breaks);
+    return true;
+  }
+
+  case Stmt::BreakStmtClass:
+    if (Loops.empty())
+      return false;
+    Loops.back().Breaks.push_back(emit(OP_Jump));
+    return true;
+
+  case Stmt::ContinueStmtClass:
+    if (Loops.empty())
+      return false;
+    Loops.back().Continues.push_back(emit(OP_Jump));
+    return true;
+  }
+}
+
+bool FunctionCompiler::compileVarDecl(const VarDecl *VD) {
+  IntType T;
+  if (!VD->hasLocalStorage() || !getIntType(Ctx, VD->getType(), T) ||
+      !VD->getInit() || !compileExpr(VD->getInit(), T, false))
+    return false;
+
+  // The variable is only added once its initializer is compiled, so that
+  // initializers reading the variable itself are not supported.
+  unsigned Slot = Fn.NumLocals++;
+  Locals[VD] = std::make_pair(Slot, T);
+  emit(OP_Store, T, Slot);
+  return true;
+}
+
+bool FunctionCompiler::getLocal(const Expr *E, unsigned &Slot, IntType &T) {
+  const DeclRefExpr *DRE = dyn_cast<DeclRefExpr>(E->IgnoreParens());
+  if (!DRE)
+    return false;
+  const VarDecl *VD = dyn_cast<VarDecl>(DRE->getDecl());
+  if (!VD)
+    return false;
+  llvm::DenseMap<const VarDecl *, std::pair<unsigned, IntType> >::iterator
+    Known = Locals.find(VD);
+  if (Known == Locals.end())
+    return false;
+  Slot = Known->second.first;
+  T = Known->second.second;
+  return true;
+}
+
+/// Compiles the lvalue-to-rvalue conversion of \p E, which has type \p T.
+bool FunctionCompiler::compileLoad(const Expr *E, IntType T) {
+  unsigned Slot;
+  IntType VarT;
+  if (getLocal(E, Slot, VarT)) {
+    if (VarT != T)
+      return false;
+    emit(OP_Load, T, Slot);
+    return true;
+  }
+
+  // Constant global variables are read at run time, because their values
+  // may not be known yet.
+  const DeclRefExpr *DRE = dyn_cast<DeclRefExpr>(E->IgnoreParens());
+  if (!DRE)
+    return false;
+  const VarDecl *VD = dyn_cast<VarDecl>(DRE->getDecl());
+  if (!VD || !VD->hasGlobalStorage() ||
+      !(VD->isConstexpr() || VD->getType().isConstQualified()))
+    return false;
+  Fn.Globals.push_back(VD);
+  emit(OP_LoadGlobal, T, Fn.Globals.size() - 1);
+  return true;
+}
+
+/// Compiles \p E, which must have type \p Expected, or, if \p AllowConversion
+/// is true, any integer type that is then converted to \p Expected.
+bool FunctionCompiler::compileExpr(const Expr *E, IntType Expected,
+                                   bool AllowConversion) {
+  IntType T;
+  if (!compileExpr(E, T))
+    return false;
+  if (T == Expected)
+    return true;
+  if (!AllowConversion)
+    return false;
+  emit(OP_Convert, Expected);
+  return true;
+}
+
+/// Compiles \p E to code that pushes its value, and sets \p T to its type.
+bool FunctionCompiler::compileExpr(const Expr *E, IntType &T) {
+  if (!getIntType(Ctx, E->getType(), T))
+    return false;
+
+  switch (E->getStmtClass()) {
+  default:
+    return false;
+
+  case Stmt::IntegerLiteralClass:
+    emit(OP_Const, T,
+         normalize(cast<IntegerLiteral>(E)->getValue().getZExtValue(), T));
+    return true;
+
+  case Stmt::CharacterLiteralClass:
+    emit(OP_Const, T, normalize(cast<CharacterLiteral>(E)->getValue(), T));
+    return true;
+
+  case Stmt::CXXBoolLiteralExprClass:
+    emit(OP_Const, T, cast<CXXBoolLiteralExpr>(E)->getValue());
+    return true;
+
+  case Stmt::ParenExprClass:
+    return compileExpr(cast<ParenExpr>(E)->getSubExpr(), T, false);
+
+  case Stmt::SubstNonTypeTemplateParmExprClass:
+    return compileExpr(
+        cast<SubstNonTypeTemplateParmExpr>(E)->getReplacement(), T, false);
+
+  case Stmt::CXXDefaultArgExprClass:
+    return compileExpr(cast<CXXDefaultArgExpr>(E)->getExpr(), T, false);
+
+  case Stmt::UnaryExprOrTypeTraitExprClass: {
+    llvm::APSInt Value;
+    if (!E->EvaluateAsInt(Value, Ctx))
+      return false;
+    emit(OP_Const, T, getValue(Value, T));
+    return true;
+  }
+
+  case Stmt::DeclRefExprClass: {
+    const EnumConstantDecl *ECD =
+        dyn_cast<EnumConstantDecl>(cast<DeclRefExpr>(E)->getDecl());
+    if (!ECD)
+      return false;
+    emit(OP_Const, T, getValue(ECD->getInitVal(), T));
+    return true;
+  }
+
+  case Stmt::ImplicitCastExprClass:
+  case Stmt::CStyleCastExprClass:
+  case Stmt::CXXFunctionalCastExprClass:
+  case Stmt::CXXStaticCastExprClass: {
+    const CastExpr *CE = cast<CastExpr>(E);
+    IntType SubT;
+    switch (CE->getCastKind()) {
+    default:
+      return false;
+    case CK_LValueToRValue:
+      return compileLoad(CE->getSubExpr(), T);
+    case CK_NoOp:
+    case CK_IntegralCast:
+      return compileExpr(CE->getSubExpr(), T, true);
+    case CK_IntegralToBoolean:
+      if (!compileExpr(CE->getSubExpr(), SubT))
+        return false;
+      emit(OP_Const, SubT, 0);
+      emit(OP_NE, SubT);
+      return true;
+    }
+  }
+
+  case Stmt::UnaryOperatorClass: {
+    const UnaryOperator *UO = cast<UnaryOperator>(E);
+    switch (UO->getOpcode()) {
+    default:
+      return false;
+    case UO_Plus:
+      return compileExpr(UO->getSubExpr(), T, false);
+    case UO_Minus:
+    case UO_Not:
+      if (!compileExpr(UO->getSubExpr(), T, false))
+        return false;
+      emit(UO->getOpcode() == UO_Minus ? OP_Neg : OP_Not, T);
+      return true;
+    case UO_LNot: {
+      IntType SubT;
+      if (!compileExpr(UO->getSubExpr(), SubT))
+        return false;
+      emit(OP_LNot, T);
+      return true;
+    }
+    case UO_PreInc:
+    case UO_PreDec:
+    case UO_PostInc:
+    case UO_PostDec:
+      return compileIncDec(UO, T);
+    }
+  }
+
+  case Stmt::BinaryOperatorClass:
+  case Stmt::CompoundAssignOperatorClass:
+    return compileBinaryOperator(cast<BinaryOperator>(E), T);
+
+  case Stmt::ConditionalOperatorClass: {
+    const ConditionalOperator *CO = cast<ConditionalOperator>(E);
+    IntType CondT;
+    if (!compileExpr(CO->getCond(), CondT))
+      return false;
+    unsigned ToFalse = emit(OP_JumpIfFalse);
+    if (!compileExpr(CO->getTrueExpr(), T, false))
+      return false;
+    unsigned ToEnd = emit(OP_Jump);
+    setJumpTarget(ToFalse);
+    if (!compileExpr(CO->getFalseExpr(), T, false))
+      return false;
+    setJumpTarget(ToEnd);
+    return true;
+  }
+
+  case Stmt::CallExprClass:
+  case Stmt::CXXOperatorCallExprClass:
+    return compileCall(cast<CallExpr>(E), T);
+  }
+}
+
+bool FunctionCompiler::compileBinaryOperator(const BinaryOperator *E,
+                                             IntType T) {
+  BinaryOperatorKind Kind = E->getOpcode();
+  if (E->isAssignmentOp())
+    return compileAssignment(E, T);
+
+  IntType LHST, RHST;
+  if (Kind == BO_Comma) {
+    if (!compileExpr(E->getLHS(), LHST))
+      return false;
+    emit(OP_Pop);
+    return compileExpr(E->getRHS(), T, false);
+  }
+
+  if (Kind == BO_LAnd || Kind == BO_LOr) {
+    if (!compileExpr(E->getLHS(), LHST))
+      return false;
+    unsigned Decided = emit(Kind == BO_LAnd ? OP_JumpIfFalse : OP_JumpIfTrue);
+    if (!compileExpr(E->getRHS(), T, false))
+      return false;
+    unsigned ToEnd = emit(OP_Jump);
+    setJumpTarget(Decided);
+    emit(OP_Const, T, Kind == BO_LOr);
+    setJumpTarget(ToEnd);
+    return true;
+  }
+
+  Opcode Op = getBinOpcode(Kind);
+  if (Op == OP_Fail || !compileExpr(E->getLHS(), LHST) ||
+      !compileExpr(E->getRHS(), RHST))
+    return false;
+  if (Op != OP_Shl && Op != OP_Shr && LHST != RHST)
+    return false;
+  if (!E->isComparisonOp() && LHST != T)
+    return false;
+  emit(Op, LHST);
+  return true;
+}
+
+bool FunctionCompiler::compileAssignment(const BinaryOperator *E, IntType T) {
+  unsigned Slot;
+  IntType VarT;
+  if (!getLocal(E->getLHS(), Slot, VarT) || VarT != T)
+    return false;
+
+  if (E->getOpcode() == BO_Assign) {
+    if (!compileExpr(E->getRHS(), VarT, false))
+      return false;
+  } else {
+    // Compute in the computation type, then convert back.
+    const CompoundAssignOperator *CAO = cast<CompoundAssignOperator>(E);
+    Opcode Op = getBinOpcode(E->getOpcode());
+    IntType CompT, RHST;
+    if (Op == OP_Fail ||
+        !getIntType(Ctx, CAO->getComputationLHSType(), CompT))
+      return false;
+    emit(OP_Load, VarT, Slot);
+    if (CompT != VarT)
+      emit(OP_Convert, CompT);
+    if (!compileExpr(E->getRHS(), RHST) ||
+        (Op != OP_Shl && Op != OP_Shr && RHST != CompT))
+      return false;
+    emit(Op, CompT);
+    if (CompT != VarT)
+      emit(OP_Convert, VarT);
+  }
+
+  // The value of an assignment is that of its left-hand side.
+  emit(OP_Store, VarT, Slot);
+  emit(OP_Load, VarT, Slot);
+  return true;
+}
+
+bool FunctionCompiler::compileIncDec(const UnaryOperator *E, IntType T) {
+  unsigned Slot;
+  IntType VarT;
+  if (!getLocal(E->getSubExpr(), Slot, VarT) || VarT != T || T.Width == 1)
+    return false;
+
+  if (E->isPostfix())
+    emit(OP_Load, T, Slot);
+  emit(OP_Load, T, Slot);
+  emit(OP_Const, T, 1);
+  emit(E->isIncrementOp() ? OP_Add : OP_Sub, T);
+  emit(OP_Store, T, Slot);
+  if (E->isPrefix())
+    emit(OP_Load, T, Slot);
+  return true;
+}
+
+bool FunctionCompiler::compileCall(const CallExpr *E, IntType T) {
+  const FunctionDecl *Callee = E->getDirectCallee();
+  if (!Callee || Callee->getBuiltinID() || Callee->isVariadic() ||
+      !isa<DeclRefExpr>(E->getCallee()->IgnoreParenImpCasts()) ||
+      E->getNumArgs() != Callee->getNumParams())
+    return false;
+  if (const CXXMethodDecl *MD = dyn_cast<CXXMethodDecl>(Callee))
+    if (!MD->isStatic())
+      return false;
+
+  for (unsigned I = 0, N = E->getNumArgs(); I != N; ++I) {
+    IntType ParamT;
+    if (!getIntType(Ctx, Callee->getParamDecl(I)->getType(), ParamT) ||
+        !compileExpr(E->getArg(I), ParamT, false))
+      return false;
+  }
+
+  Fn.Callees.push_back(Callee);
+  emit(OP_Call, T, Fn.Callees.size() - 1);
+  return true;
+}
+
+ConstexprBytecode::~ConstexprBytecode() {
+  llvm::DeleteContainerSeconds(Functions);
+}
+
+const ConstexprBytecode::Function *
+ConstexprBytecode::getFunction(const FunctionDecl *Definition) {
+  llvm::DenseMap<const FunctionDecl *, Function *>::iterator Known =
+    Functions.find(Definition);
+  if (Known != Functions.end())
+    return Known->second;
+
+  Function *Fn = new Function();
+  if (!FunctionCompiler(Ctx, *Fn).compile(Definition)) {
+    delete Fn;
+    Fn = 0;
+  }
+  Functions[Definition] = Fn;
+  return Fn;
+}
+
+namespace {
+/// An active call in the interpreter.
+struct CallFrame {
+  const ConstexprBytecode::Function *Fn;
+  /// The index of the next instruction.
+  unsigned PC;
+  /// The index in the stack of the first parameter.
+  unsigned Base;
+};
+} // end anonymous namespace
+
+/// Reads a constant global variable whose value the evaluator has already
+/// computed, and which it would read without a diagnostic.
+static bool loadGlobal(const VarDecl *VD, IntType T, int64_t &Value) {
+  if (VD->isWeak())
+    return false;
+  const Expr *Init = VD->getAnyInitializer(VD);
+  if (!Init || Init->isValueDependent())
+    return false;
+  const APValue *V = VD->getEvaluatedValue();
+  if (!V || !V->isInt() || V->getInt().getBitWidth() != T.Width ||
+      !VD->isInitKnownICE() || !VD->isInitICE())
+    return false;
+  Value = getValue(V->getInt(), T);
+  return true;
+}
+
+bool ConstexprBytecode::call(const FunctionDecl *Definition,
+                             ArrayRef<APValue> Args, unsigned Depth,
+                             unsigned &StepsLeft, unsigned &MaxDepth,
+                             APValue &Result) {
+  const Function *Fn = getFunction(Definition);
+  if (!Fn || Args.size() != Fn->ParamTypes.size())
+    return false;
+
+  // The stack holds, for each active call, its parameters and local
+  // variables followed by its operands.
+  std::vector<int64_t> Stack;
+  for (unsigned I = 0, E = Args.size(); I != E; ++I) {
+    if (!Args[I].isInt() ||
+        Args[I].getInt().getBitWidth() != Fn->ParamTypes[I].Width)
+      return false;
+    Stack.push_back(getValue(Args[I].getInt(), Fn->ParamTypes[I]));
+  }
+  Stack.resize(Fn->NumLocals);
+
+  CallFrame F = { Fn, 0, 0 };
+  SmallVector<CallFrame, 16> Callers;
+  unsigned Steps = StepsLeft;
+  unsigned MaxCallerDepth = 0;
+
+  while (true) {
+    const Instr &I = F.Fn->Code[F.PC++];
+    switch (I.Op) {
+    case OP_Const:
+      Stack.push_back(I.Arg);
+      break;
+
+    case OP_Load:
+      Stack.push_back(Stack[F.Base + I.Arg]);
+      break;
+
+    case OP_Store:
+      Stack[F.Base + I.Arg] = Stack.back();
+      Stack.pop_back();
+      break;
+
+    case OP_LoadGlobal: {
+      int64_t Value;
+      if (!loadGlobal(F.Fn->Globals[I.Arg], I.Type, Value))
+        return false;
+      Stack.push_back(Value);
+      break;
+    }
+
+    case OP_Pop:
+      Stack.pop_back();
+      break;
+
+    case OP_Step:
+      if (!Steps)
+        return false;
+      --Steps;
+      break;
+
+    case OP_Jump:
+      F.PC = I.Arg;
+      break;
+
+    case OP_JumpIfFalse:
+    case OP_JumpIfTrue: {
+      bool Cond = Stack.back() != 0;
+      Stack.pop_back();
+      if (Cond == (I.Op == OP_JumpIfTrue))
+        F.PC = I.Arg;
+      break;
+    }
+
+    case OP_Convert:
+      Stack.back() = normalize(Stack.back(), I.Type);
+      break;
+
+    case OP_Neg: {
+      int64_t &V = Stack.back();
+      if (!I.Type.Signed)
+        V = normalize(-uint64_t(V), I.Type);
+      else if (V == INT64_MIN || !fitsIn(-V, I.Type))
+        return false;
+      else
+        V = -V;
+      break;
+    }
+
+    case OP_Not:
+      Stack.back() = normalize(~uint64_t(Stack.back()), I.Type);
+      break;
+
+    case OP_LNot:
+      Stack.back() = !Stack.back();
+      break;
+
+    case OP_Call: {
+      // Make the same checks as the evaluator does before a call.
+      const FunctionDecl *Callee = F.Fn->Callees[I.Arg];
+      const FunctionDecl *CalleeDefinition = 0;
+      unsigned CallerDepth = Depth + Callers.size() + 1;
+      if (Callee->isInvalidDecl() || !Callee->getBody(CalleeDefinition) ||
+          !CalleeDefinition->isConstexpr() ||
+          CalleeDefinition->isInvalidDecl() ||
+          CallerDepth > Ctx.getLangOpts().ConstexprCallDepth)
+        return false;
+      MaxCallerDepth = std::max(MaxCallerDepth, CallerDepth);
+      const Function *CalleeFn = getFunction(CalleeDefinition);
+      if (!CalleeFn)
+        return false;
+      Callers.push_back(F);
+      F.Fn = CalleeFn;
+      F.PC = 0;
+      F.Base = Stack.size() - CalleeFn->ParamTypes.size();
+      Stack.resize(F.Base + CalleeFn->NumLocals);
+      break;
+    }
+
+    case OP_Return: {
+      int64_t V = Stack.back();
+      if (Callers.empty()) {
+        IntType T = F.Fn->ResultType;
+        Result = APValue(llvm::APSInt(llvm::APInt(T.Width, V, T.Signed),
+                                      !T.Signed));
+        StepsLeft = Steps;
+        MaxDepth = std::max(MaxDepth, MaxCallerDepth);
+        return true;
+      }
+      Stack.resize(F.Base);
+      Stack.push_back(V);
+      F = Callers.pop_back_val();
+      break;
+    }
+
+    case OP_Fail:
+      return false;
+
+    default: {
+      int64_t R = Stack.back();
+      Stack.pop_back();
+      if (!evaluateBinOp(I.Op, I.Type, Stack.back(), R, Stack.back()))
+        return false;
+      break;
+    }
+    }
+  }
+}
@@ -0,0 +1,75 @@
+//===--- ConstexprBytecode.h - Bytecode for constexpr calls -----*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines ConstexprBytecode, which compiles constexpr functions to
+// bytecode so that calls to them can be evaluated without walking their
+// bodies again and again.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_AST_CONSTEXPRBYTECODE_H
+#define LLVM_CLANG_AST_CONSTEXPRBYTECODE_H
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/Support/Compiler.h"
+
+namespace clang {
+
+class APValue;
+class ASTContext;
+class FunctionDecl;
+
+/// \brief Evaluates calls to constexpr functions that only compute with
+/// integers, using a stack machine. Each function is compiled the first time
+/// it is called, and its bytecode is kept for the lifetime of the ASTContext.
+///
+/// The interpreter only ever produces the values the constant evaluator
+/// would produce without a diagnostic. On anything else (overflow, division
+/// by zero, a call to a function it cannot compile, exceeding the depth or
+/// step limits) it gives up, and the call has to be evaluated the usual way,
+/// which then produces the usual diagnostics.
+class ConstexprBytecode {
+public:
+  struct Function;
+
+  explicit ConstexprBytecode(ASTContext &Ctx) : Ctx(Ctx) {}
+  ~ConstexprBytecode();
+
+  /// \brief Tries to evaluate a call to \p Definition.
+  ///
+  /// \param Args The values of the arguments of the call.
+  /// \param Depth The depth of the constexpr call stack below this call.
+  /// \param StepsLeft The number of evaluation steps left, which is only
+  /// updated if the call could be evaluated.
+  /// \param MaxDepth Raised, if the call could be evaluated, to the greatest
+  /// depth of the call stack at which the call made a further call.
+  /// \returns true, with the value of the call in \p Result, or false if the
+  /// call has to be evaluated some other way.
+  bool call(const FunctionDecl *Definition, ArrayRef<APValue> Args,
+            unsigned Depth, unsigned &StepsLeft, unsigned &MaxDepth,
+            APValue &Result);
+
+private:
+  const Function *getFunction(const FunctionDecl *Definition);
+
+  ASTContext &Ctx;
+
+  /// \brief The compiled functions, or null for those that cannot be
+  /// compiled.
+  llvm::DenseMap<const FunctionDecl *, Function *> Functions;
+
+  ConstexprBytecode(const ConstexprBytecode &) LLVM_DELETED_FUNCTION;
+  void operator=(const ConstexprBytecode &) LLVM_DELETED_FUNCTION;
+};
+
+} // end namespace clang
+
+#endif
@@ -0,0 +1,103 @@
+//===--- ConstexprCallCache.cpp - Memoized constexpr calls ----------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements ConstexprCallCache.
+//
+//===----------------------------------------------------------------------===//
+
+#include "ConstexprCallCache.h"
+#include "llvm/ADT/Hashing.h"
+#include "llvm/ADT/STLExtras.h"
+
+using namespace clang;
+
+static llvm::hash_code hashValue(const APValue &Value) {
+  if (Value.isInt())
+    return llvm::hash_combine(Value.getInt().isSigned(),
+                              llvm::hash_value(Value.getInt()));
+  return llvm::hash_value(Value.getFloat().bitcastToAPInt());
+}
+
+static bool isSameValue(const APValue &A, const APValue &B) {
+  if (A.getKind() != B.getKind())
+    return false;
+  if (A.isInt())
+    return A.getInt().isSigned() == B.getInt().isSigned() &&
+           A.getInt().getBitWidth() == B.getInt().getBitWidth() &&
+           A.getInt() == B.getInt();
+  return &A.getFloat().getSemantics() == &B.getFloat().getSemantics() &&
+         A.getFloat().bitwiseIsEqual(B.getFloat());
+}
+
+ConstexprCallCache::~ConstexprCallCache() {
+  clear();
+}
+
+bool ConstexprCallCache::isMemoizableValue(const APValue &Value) {
+  return Value.isInt() || Value.isFloat();
+}
+
+ConstexprCallCache::KeyTy
+ConstexprCallCache::getKey(const FunctionDecl *Callee,
+                           ArrayRef<APValue> Args) {
+  llvm::hash_code Hash = llvm::hash_value(Args.size());
+  for (unsigned I = 0, E = Args.size(); I != E; ++I)
+    Hash = llvm::hash_combine(Hash, hashValue(Args[I]));
+  return KeyTy(Callee, static_cast<unsigned>(size_t(Hash)));
+}
+
+const ConstexprCallCache::Entry *
+ConstexprCallCache::lookup(const FunctionDecl *Callee,
+                           ArrayRef<APValue> Args) const {
+  llvm::DenseMap<KeyTy, BucketTy>::const_iterator Known =
+    Buckets.find(getKey(Callee, Args));
+  if (Known == Buckets.end())
+    return 0;
+
+  for (BucketTy::const_iterator I = Known->second.begin(),
+         E = Known->second.end(); I != E; ++I) {
+    const Entry *Candidate = *I;
+    if (Candidate->Callee != Callee || Candidate->Args.size() != Args.size())
+      continue;
+    bool Same = true;
+    for (unsigned Arg = 0, NumArgs = Args.size(); Same && Arg != NumArgs;
+         ++Arg)
+      Same = isSameValue(Candidate->Args[Arg], Args[Arg]);
+    if (Same)
+      return Candidate;
+  }
+  return 0;
+}
+
+void ConstexprCallCache::insert(const FunctionDecl *Callee,
+                                ArrayRef<APValue> Args,
+                                const APValue &Result, unsigned Steps,
+                                unsigned Depth) {
+  if (!MaxEntries)
+    return;
+  if (NumEntries == MaxEntries)
+    clear();
+
+  Entry *New = new Entry();
+  New->Callee = Callee;
+  New->Args.append(Args.begin(), Args.end());
+  New->Result = Result;
+  New->Steps = Steps;
+  New->Depth = Depth;
+  Buckets[getKey(Callee, Args)].push_back(New);
+  ++NumEntries;
+}
+
+void ConstexprCallCache::clear() {
+  for (llvm::DenseMap<KeyTy, BucketTy>::iterator I = Buckets.begin(),
+         E = Buckets.end(); I != E; ++I)
+    llvm::DeleteContainerPointers(I->second);
+  Buckets.clear();
+  NumEntries = 0;
+}
@@ -0,0 +1,87 @@
+//===--- ConstexprCallCache.h - Memoized constexpr calls --------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines ConstexprCallCache, which remembers the values of
+// constexpr function calls so that they need not be evaluated again.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_AST_CONSTEXPRCALLCACHE_H
+#define LLVM_CLANG_AST_CONSTEXPRCALLCACHE_H
+
+#include "clang/AST/APValue.h"
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/Compiler.h"
+
+namespace clang {
+
+class FunctionDecl;
+
+/// \brief The values of the constexpr function calls evaluated so far, keyed
+/// by the function and the values of the arguments.
+///
+/// Only calls whose arguments and value are integers or floating-point
+/// numbers are remembered, since such a call cannot depend on any state
+/// other than its arguments and constant global variables. The evaluator
+/// only adds calls whose evaluation produced no diagnostic.
+class ConstexprCallCache {
+public:
+  struct Entry {
+    const FunctionDecl *Callee;
+    SmallVector<APValue, 2> Args;
+    APValue Result;
+
+    /// The number of evaluation steps the call took.
+    unsigned Steps;
+
+    /// How much deeper than the call itself the call stack grew.
+    unsigned Depth;
+  };
+
+  /// \param MaxEntries The number of calls to remember. When that many calls
+  /// are known, the cache starts afresh.
+  explicit ConstexprCallCache(unsigned MaxEntries)
+    : MaxEntries(MaxEntries), NumEntries(0) {}
+  ~ConstexprCallCache();
+
+  /// \brief Determines whether calls with \p Value as an argument or result
+  /// can be remembered.
+  static bool isMemoizableValue(const APValue &Value);
+
+  /// \brief Returns the remembered call to \p Callee with \p Args, if any.
+  const Entry *lookup(const FunctionDecl *Callee,
+                      ArrayRef<APValue> Args) const;
+
+  /// \brief Remembers that the call to \p Callee with \p Args evaluated to
+  /// \p Result.
+  void insert(const FunctionDecl *Callee, ArrayRef<APValue> Args,
+              const APValue &Result, unsigned Steps, unsigned Depth);
+
+private:
+  typedef std::pair<const FunctionDecl *, unsigned> KeyTy;
+  typedef SmallVector<Entry *, 1> BucketTy;
+
+  static KeyTy getKey(const FunctionDecl *Callee, ArrayRef<APValue> Args);
+  void clear();
+
+  /// The entries, by callee and hash of the arguments.
+  llvm::DenseMap<KeyTy, BucketTy> Buckets;
+  unsigned MaxEntries;
+  unsigned NumEntries;
+
+  ConstexprCallCache(const ConstexprCallCache &) LLVM_DELETED_FUNCTION;
+  void operator=(const ConstexprCallCache &) LLVM_DELETED_FUNCTION;
+};
+
+} // end namespace clang
+
+#endif
@@ -134,6 +134,15 @@ void Decl::add(Kind k) {
   }
 }
 
+unsigned Decl::getNumDeclsCreated(Kind K) {
+  switch (K) {
+#define DECL(DERIVED, BASE) case DERIVED: return n##DERIVED##s;
+#define ABSTRACT_DECL(DECL)
+#include "clang/AST/DeclNodes.inc"
+  }
+  llvm_unreachable("Declaration not in DeclNodes.inc!");
+}
+
 bool Decl::isTemplateParameterPack() const {
   if (const TemplateTypeParmDecl *TTP = dyn_cast<TemplateTypeParmDecl>(this))
     return TTP->isParameterPack();
@@ -979,6 +988,14 @@ ExternalASTSource::SetNoExternalVisibleDeclsForName(const DeclContext *DC,
   return DeclContext::lookup_result();
 }
 
+void ExternalASTSource::ReserveExternalVisibleDecls(const DeclContext *DC,
+                                                    unsigned NumNames) {
+  StoredDeclsMap *Map;
+  if (!(Map = DC->LookupPtr.getPointer()))
+    Map = DC->CreateStoredDeclsMap(DC->getParentASTContext());
+  Map->reserve(NumNames);
+}
+
 DeclContext::lookup_result
 ExternalASTSource::SetExternalVisibleDeclsForName(const DeclContext *DC,
                                                   DeclarationName Name,
@@ -1160,6 +1177,22 @@ static bool shouldBeHidden(NamedDecl *D) {
   return false;
 }
 
+/// countLookupDecls - Count the named declarations buildLookupImpl may add
+/// to the lookup data structure for DCtx.
+static unsigned countLookupDecls(DeclContext *DCtx) {
+  unsigned NumDecls = 0;
+  for (DeclContext::decl_iterator I = DCtx->decls_begin(),
+                                  E = DCtx->decls_end();
+       I != E; ++I) {
+    if (isa<NamedDecl>(*I))
+      ++NumDecls;
+    if (DeclContext *InnerCtx = dyn_cast<DeclContext>(*I))
+      if (InnerCtx->isTransparentContext() || InnerCtx->isInlineNamespace())
+        NumDecls += countLookupDecls(InnerCtx);
+  }
+  return NumDecls;
+}
+
 /// buildLookup - Build the lookup data structure with all of the
 /// declarations in this DeclContext (and any other contexts linked
 /// to it or transparent contexts nested within it) and return it.
@@ -1172,6 +1205,22 @@ StoredDeclsMap *DeclContext::buildLookup() {
 
   SmallVector<DeclContext *, 2> Contexts;
   collectAllContexts(Contexts);
+
+  // Size the table for all of the declarations up front. Walking the chains
+  // is cheap next to rehashing a table as big as that of namespace std a
+  // dozen times while it fills up. Small contexts fit in the table's inline
+  // buckets anyway.
+  unsigned NumDecls = 0;
+  for (unsigned I = 0, N = Contexts.size(); I != N; ++I)
+    NumDecls += countLookupDecls(Contexts[I]);
+  if (NumDecls > 4) {
+    StoredDeclsMap *Map = LookupPtr.getPointer();
+    if (!Map)
+      Map = CreateStoredDeclsMap(getParentASTContext());
+    if (NumDecls > Map->size())
+      Map->reserve(NumDecls - Map->size());
+  }
+
   for (unsigned I = 0, N = Contexts.size(); I != N; ++I)
     buildLookupImpl<&DeclContext::decls_begin,
                     &DeclContext::decls_end>(Contexts[I]);
@@ -0,0 +1,286 @@
+//===--- DeclHasher.cpp - Structural hashing of declarations --------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file implements the DeclHasher class, which computes hashes of the
+//  structure of declarations that do not depend on the ASTContext they live
+//  in.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/AST/DeclHasher.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/DeclCXX.h"
+#include "clang/AST/DeclObjC.h"
+#include "clang/AST/DeclTemplate.h"
+#include "clang/AST/Expr.h"
+#include "clang/AST/NestedNameSpecifier.h"
+#include "clang/AST/PrettyPrinter.h"
+#include "llvm/ADT/FoldingSet.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/Allocator.h"
+#include "llvm/Support/raw_ostream.h"
+using namespace clang;
+
+/// \brief Returns the policy used to spell the entities a declaration refers
+/// to, which must not depend on where the declaration is.
+static PrintingPolicy getHashingPolicy(const ASTContext &Context) {
+  PrintingPolicy Policy(Context.getLangOpts());
+  Policy.AnonymousTagLocations = false;
+  return Policy;
+}
+
+uint64_t DeclHasher::getHash(const Decl *D) {
+  llvm::DenseMap<const Decl *, uint64_t>::iterator Pos = Hashes.find(D);
+  if (Pos != Hashes.end())
+    return Pos->second;
+
+  llvm::FoldingSetNodeID ID;
+  AddDecl(D, ID);
+
+  // FoldingSetNodeID::ComputeHash only produces 32 bits and need not be the
+  // same in different runs, so hash the profile with 64-bit FNV-1a instead.
+  llvm::BumpPtrAllocator Allocator;
+  llvm::FoldingSetNodeIDRef Data = ID.Intern(Allocator);
+  uint64_t Hash = 14695981039346656037ULL;
+  for (size_t I = 0, N = Data.getSize(); I != N; ++I) {
+    unsigned Word = Data.getData()[I];
+    for (unsigned Byte = 0; Byte != 4; ++Byte) {
+      Hash ^= (Word >> (Byte * 8)) & 0xFF;
+      Hash *= 1099511628211ULL;
+    }
+  }
+
+  Hashes[D] = Hash;
+  return Hash;
+}
+
+void DeclHasher::AddDecl(const Decl *D, llvm::FoldingSetNodeID &ID) {
+  if (!D) {
+    ID.AddInteger(0);
+    return;
+  }
+
+  ID.AddInteger(D->getKind());
+  ID.AddInteger(D->getAccessUnsafe());
+  if (const NamedDecl *ND = dyn_cast<NamedDecl>(D))
+    AddName(ND->getDeclName(), ID);
+  if (const ValueDecl *VD = dyn_cast<ValueDecl>(D))
+    AddType(VD->getType(), ID);
+
+  if (const FunctionDecl *FD = dyn_cast<FunctionDecl>(D)) {
+    ID.AddInteger(FD->getStorageClass());
+    ID.AddBoolean(FD->isInlineSpecified());
+    ID.AddBoolean(FD->isVirtualAsWritten());
+    ID.AddBoolean(FD->isPure());
+    ID.AddBoolean(FD->isConstexpr());
+    ID.AddBoolean(FD->isDeletedAsWritten());
+    ID.AddBoolean(FD->isExplicitlyDefaulted());
+    ID.AddInteger(FD->getNumParams());
+    for (unsigned I = 0, N = FD->getNumParams(); I != N; ++I) {
+      const ParmVarDecl *Param = FD->getParamDecl(I);
+      AddName(Param->getDeclName(), ID);
+      bool HasDefaultArg = Param->hasDefaultArg() &&
+                           !Param->hasUnparsedDefaultArg() &&
+                           !Param->hasUninstantiatedDefaultArg();
+      AddStmt(HasDefaultArg ? Param->getDefaultArg() : 0, ID);
+    }
+
+    if (const CXXConstructorDecl *Ctor = dyn_cast<CXXConstructorDecl>(FD)) {
+      ID.AddBoolean(Ctor->isExplicitSpecified());
+      ID.AddInteger(Ctor->getNumCtorInitializers());
+      for (CXXConstructorDecl::init_const_iterator
+             Init = Ctor->init_begin(), InitEnd = Ctor->init_end();
+           Init != InitEnd; ++Init) {
+        ID.AddBoolean((*Init)->isWritten());
+        if (TypeSourceInfo *TInfo = (*Init)->getTypeSourceInfo())
+          AddType(TInfo->getType(), ID);
+        else
+          AddDeclRef((*Init)->getAnyMember(), ID);
+        AddStmt((*Init)->getInit(), ID);
+      }
+    } else if (const CXXConversionDecl *Conv = dyn_cast<CXXConversionDecl>(FD))
+      ID.AddBoolean(Conv->isExplicitSpecified());
+
+    AddStmt(FD->doesThisDeclarationHaveABody() ? FD->getBody() : 0, ID);
+    return;
+  }
+
+  if (const VarDecl *VD = dyn_cast<VarDecl>(D)) {
+    ID.AddInteger(VD->getStorageClass());
+    ID.AddInteger(VD->getTLSKind());
+    ID.AddBoolean(VD->isConstexpr());
+    if (!isa<ParmVarDecl>(VD))
+      AddStmt(VD->getInit(), ID);
+    return;
+  }
+
+  if (const FieldDecl *FD = dyn_cast<FieldDecl>(D)) {
+    ID.AddBoolean(FD->isMutable());
+    AddStmt(FD->getBitWidth(), ID);
+    AddStmt(FD->getInClassInitializer(), ID);
+    return;
+  }
+
+  if (const EnumConstantDecl *EC = dyn_cast<EnumConstantDecl>(D)) {
+    EC->getInitVal().Profile(ID);
+    return;
+  }
+
+  if (const TypedefNameDecl *Typedef = dyn_cast<TypedefNameDecl>(D)) {
+    AddType(Typedef->getUnderlyingType(), ID);
+    return;
+  }
+
+  if (const TemplateDecl *Template = dyn_cast<TemplateDecl>(D)) {
+    AddTemplateParameterList(Template->getTemplateParameters(), ID);
+    AddDecl(Template->getTemplatedDecl(), ID);
+    return;
+  }
+
+  if (const TagDecl *Tag = dyn_cast<TagDecl>(D)) {
+    ID.AddInteger(Tag->getTagKind());
+    ID.AddBoolean(Tag->isCompleteDefinition());
+    if (const ClassTemplateSpecializationDecl *Spec =
+          dyn_cast<ClassTemplateSpecializationDecl>(Tag)) {
+      // The name of a specialization is the name of its template; tell the
+      // specializations apart by their arguments.
+      ID.AddInteger(Spec->getSpecializationKind());
+      SmallString<64> Args;
+      llvm::raw_svector_ostream OS(Args);
+      const TemplateArgumentList &TemplateArgs = Spec->getTemplateArgs();
+      TemplateSpecializationType::PrintTemplateArgumentList(
+          OS, TemplateArgs.data(), TemplateArgs.size(),
+          getHashingPolicy(Context));
+      ID.AddString(OS.str());
+    }
+    if (const EnumDecl *Enum = dyn_cast<EnumDecl>(Tag)) {
+      ID.AddBoolean(Enum->isScoped());
+      AddType(Enum->getIntegerType(), ID);
+    }
+    if (!Tag->isCompleteDefinition())
+      return;
+
+    if (const CXXRecordDecl *Record = dyn_cast<CXXRecordDecl>(Tag)) {
+      ID.AddInteger(Record->getNumBases());
+      for (CXXRecordDecl::base_class_const_iterator
+             Base = Record->bases_begin(), BaseEnd = Record->bases_end();
+           Base != BaseEnd; ++Base) {
+        ID.AddBoolean(Base->isVirtual());
+        ID.AddInteger(Base->getAccessSpecifierAsWritten());
+        AddType(Base->getType(), ID);
+      }
+    }
+  } else if (!isa<NamespaceDecl>(D) && !isa<LinkageSpecDecl>(D) &&
+             !isa<ObjCContainerDecl>(D)) {
+    // The contexts of other declarations, such as blocks, are covered by
+    // their bodies.
+    return;
+  }
+
+  // Add the members that were written, in order.
+  const DeclContext *DC = cast<DeclContext>(D);
+  for (DeclContext::decl_iterator Member = DC->decls_begin(),
+                               MemberEnd = DC->decls_end();
+       Member != MemberEnd; ++Member) {
+    if (!Member->isImplicit())
+      AddDecl(*Member, ID);
+  }
+  ID.AddInteger(0);
+}
+
+void DeclHasher::AddStmt(const Stmt *S, llvm::FoldingSetNodeID &ID) {
+  if (!S) {
+    ID.AddInteger(0);
+    return;
+  }
+
+  S->Profile(ID, *this);
+}
+
+void DeclHasher::AddDeclRef(const Decl *D, llvm::FoldingSetNodeID &ID) {
+  if (!D) {
+    ID.AddInteger(0);
+    return;
+  }
+
+  ID.AddInteger(D->getKind());
+  if (const NamedDecl *ND = dyn_cast<NamedDecl>(D)) {
+    SmallString<64> Name;
+    llvm::raw_svector_ostream OS(Name);
+    ND->printQualifiedName(OS, getHashingPolicy(Context));
+    ID.AddString(OS.str());
+  }
+
+  // Tell overloaded functions apart by their types.
+  if (const ValueDecl *VD = dyn_cast<ValueDecl>(D))
+    AddType(VD->getType(), ID);
+}
+
+void DeclHasher::AddType(QualType T, llvm::FoldingSetNodeID &ID) {
+  if (T.isNull()) {
+    ID.AddInteger(0);
+    return;
+  }
+
+  ID.AddString(
+      Context.getCanonicalType(T).getAsString(getHashingPolicy(Context)));
+}
+
+void DeclHasher::AddName(DeclarationName Name, llvm::FoldingSetNodeID &ID) {
+  ID.AddInteger(Name.getNameKind());
+  ID.AddString(Name.getAsString());
+}
+
+void DeclHasher::AddNestedNameSpecifier(NestedNameSpecifier *NNS,
+                                        llvm::FoldingSetNodeID &ID) {
+  NNS = Context.getCanonicalNestedNameSpecifier(NNS);
+  if (!NNS) {
+    ID.AddInteger(0);
+    return;
+  }
+
+  SmallString<64> Spelling;
+  llvm::raw_svector_ostream OS(Spelling);
+  NNS->print(OS, getHashingPolicy(Context));
+  ID.AddString(OS.str());
+}
+
+void DeclHasher::AddTemplateName(TemplateName Name,
+                                 llvm::FoldingSetNodeID &ID) {
+  Name = Context.getCanonicalTemplateName(Name);
+  SmallString<64> Spelling;
+  llvm::raw_svector_ostream OS(Spelling);
+  Name.print(OS, getHashingPolicy(Context));
+  ID.AddString(OS.str());
+}
+
+void DeclHasher::AddTemplateParameterList(const TemplateParameterList *Params,
+                                          llvm::FoldingSetNodeID &ID) {
+  ID.AddInteger(Params->size());
+  for (TemplateParameterList::const_iterator P = Params->begin(),
+                                          PEnd = Params->end();
+       P != PEnd; ++P) {
+    ID.AddInteger((*P)->getKind());
+    if (const TemplateTypeParmDecl *TTP = dyn_cast<TemplateTypeParmDecl>(*P)) {
+      ID.AddBoolean(TTP->isParameterPack());
+      AddType(TTP->hasDefaultArgument() ? TTP->getDefaultArgument()
+                                        : QualType(), ID);
+    } else if (const NonTypeTemplateParmDecl *NTTP =
+                 dyn_cast<NonTypeTemplateParmDecl>(*P)) {
+      ID.AddBoolean(NTTP->isParameterPack());
+      AddType(NTTP->getType(), ID);
+      AddStmt(NTTP->hasDefaultArgument() ? NTTP->getDefaultArgument() : 0,
+              ID);
+    } else {
+      const TemplateTemplateParmDecl *TTP = cast<TemplateTemplateParmDecl>(*P);
+      ID.AddBoolean(TTP->isParameterPack());
+      AddTemplateParameterList(TTP->getTemplateParameters(), ID);
+    }
+  }
+}
@@ -33,6 +33,8 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "ConstexprBytecode.h"
+#include "ConstexprCallCache.h"
 #include "clang/AST/APValue.h"
 #include "clang/AST/ASTContext.h"
 #include "clang/AST/ASTDiagnostic.h"
@@ -450,6 +452,15 @@ namespace {
 
     bool IntOverflowCheckMode;
 
+    /// MaxCallStackDepth - The greatest call stack depth at which a call has
+    /// been made, which tells how deep a memoized call went.
+    unsigned MaxCallStackDepth;
+
+    /// AccessedEvaluatingDecl - Whether the object under construction has
+    /// been accessed. The values read from it depend on how far its
+    /// construction has progressed, so such calls are not memoized.
+    bool AccessedEvaluatingDecl;
+
     EvalInfo(const ASTContext &C, Expr::EvalStatus &S,
              bool OverflowCheckMode = false)
       : Ctx(const_cast<ASTContext&>(C)), EvalStatus(S), CurrentCall(0),
@@ -458,7 +469,8 @@ namespace {
         BottomFrame(*this, SourceLocation(), 0, 0, 0),
         EvaluatingDecl((const ValueDecl*)0), EvaluatingDeclValue(0),
         HasActiveDiagnostic(false), CheckingPotentialConstantExpression(false),
-        IntOverflowCheckMode(OverflowCheckMode) {}
+        IntOverflowCheckMode(OverflowCheckMode), MaxCallStackDepth(0),
+        AccessedEvaluatingDecl(false) {}
 
     void setEvaluatingDecl(APValue::LValueBase Base, APValue &Value) {
       EvaluatingDecl = Base;
@@ -477,8 +489,10 @@ namespace {
         Diag(Loc, diag::note_constexpr_call_limit_exceeded);
         return false;
       }
-      if (CallStackDepth <= getLangOpts().ConstexprCallDepth)
+      if (CallStackDepth <= getLangOpts().ConstexprCallDepth) {
+        MaxCallStackDepth = std::max(MaxCallStackDepth, CallStackDepth);
         return true;
+      }
       Diag(Loc, diag::note_constexpr_depth_limit_exceeded)
         << getLangOpts().ConstexprCallDepth;
       return false;
@@ -1817,6 +1831,7 @@ static bool evaluateVarDeclInit(EvalInfo &Info, const Expr *E,
   // If we're currently evaluating the initializer of this declaration, use that
   // in-flight value.
   if (Info.EvaluatingDecl.dyn_cast<const ValueDecl*>() == VD) {
+    Info.AccessedEvaluatingDecl = true;
     Result = Info.EvaluatingDeclValue;
     return true;
   }
@@ -2280,6 +2295,9 @@ CompleteObject findCompleteObject(EvalInfo &Info, const Expr *E, AccessKinds AK,
     return CompleteObject();
   }
 
+  if (LVal.Base == Info.EvaluatingDecl)
+    Info.AccessedEvaluatingDecl = true;
+
   CallStackFrame *Frame = 0;
   if (LVal.CallIndex) {
     Frame = Info.getCallFrame(LVal.CallIndex);
@@ -3453,17 +3471,24 @@ static bool EvaluateArgs(ArrayRef<const Expr*> Args, ArgVector &ArgValues,
   return Success;
 }
 
-/// Evaluate a function call.
-static bool HandleFunctionCall(SourceLocation CallLoc,
-                               const FunctionDecl *Callee, const LValue *This,
-                               ArrayRef<const Expr*> Args, const Stmt *Body,
-                               EvalInfo &Info, APValue &Result) {
-  ArgVector ArgValues(Args.size());
-  if (!EvaluateArgs(Args, ArgValues, Info))
-    return false;
-
-  if (!Info.CheckCallLimit(CallLoc))
-    return false;
+/// Evaluate the body of a function call, given the values of its arguments.
+static bool EvaluateFunctionCall(SourceLocation CallLoc,
+                                 const FunctionDecl *Callee,
+                                 const LValue *This,
+                                 ArrayRef<const Expr*> Args,
+                                 ArgVector &ArgValues, const Stmt *Body,
+                                 EvalInfo &Info, APValue &Result) {
+  // With -fconstexpr-bytecode, calls to functions that only compute with
+  // integers are run by the bytecode interpreter. It gives up on anything that
+  // needs a diagnostic, and then we evaluate the call here instead, producing
+  // that diagnostic.
+  if (Info.getLangOpts().ConstexprBytecode && !This &&
+      !Info.CheckingPotentialConstantExpression &&
+      Info.Ctx.getConstexprBytecode().call(Callee, ArgValues,
+                                           Info.CallStackDepth,
+                                           Info.StepsLeft,
+                                           Info.MaxCallStackDepth, Result))
+    return true;
 
   CallStackFrame Frame(Info, CallLoc, Callee, This, ArgValues.data());
 
@@ -3496,6 +3521,76 @@ static bool HandleFunctionCall(SourceLocation CallLoc,
   return ESR == ESR_Returned;
 }
 
+/// Determine whether the value of a call can be memoized. Calls of free
+/// functions on numbers can only depend on their arguments and on constant
+/// global variables.
+static bool isMemoizableCall(EvalInfo &Info, const LValue *This,
+                             ArrayRef<APValue> ArgValues) {
+  if (!Info.getLangOpts().ConstexprCacheSize || This ||
+      Info.CheckingPotentialConstantExpression)
+    return false;
+  for (unsigned I = 0, N = ArgValues.size(); I != N; ++I)
+    if (!ConstexprCallCache::isMemoizableValue(ArgValues[I]))
+      return false;
+  return true;
+}
+
+/// Evaluate a function call.
+static bool HandleFunctionCall(SourceLocation CallLoc,
+                               const FunctionDecl *Callee, const LValue *This,
+                               ArrayRef<const Expr*> Args, const Stmt *Body,
+                               EvalInfo &Info, APValue &Result) {
+  ArgVector ArgValues(Args.size());
+  if (!EvaluateArgs(Args, ArgValues, Info))
+    return false;
+
+  if (!Info.CheckCallLimit(CallLoc))
+    return false;
+
+  if (!isMemoizableCall(Info, This, ArgValues))
+    return EvaluateFunctionCall(CallLoc, Callee, This, Args, ArgValues, Body,
+                                Info, Result);
+
+  // Reuse the value of an earlier identical call, charging the steps and the
+  // call depth it took. If evaluating it again would exceed a limit, do so to
+  // produce the diagnostic.
+  ConstexprCallCache &Cache = Info.Ctx.getConstexprCallCache();
+  if (const ConstexprCallCache::Entry *Known = Cache.lookup(Callee, ArgValues))
+    if (Info.CallStackDepth + Known->Depth <=
+            Info.getLangOpts().ConstexprCallDepth &&
+        Known->Steps <= Info.StepsLeft) {
+      Info.StepsLeft -= Known->Steps;
+      Info.MaxCallStackDepth = std::max(Info.MaxCallStackDepth,
+                                        Info.CallStackDepth + Known->Depth);
+      Result = Known->Result;
+      return true;
+    }
+
+  // Only a call that produced no notes is known to be a constant expression,
+  // and we can only tell that if notes are being collected.
+  bool CanMemoize = Info.EvalStatus.Diag && Info.EvalStatus.Diag->empty() &&
+                    !Info.EvalStatus.HasSideEffects &&
+                    !Info.IntOverflowCheckMode;
+  unsigned StepsLeft = Info.StepsLeft;
+  unsigned OuterMaxCallStackDepth = Info.MaxCallStackDepth;
+  bool OuterAccessedEvaluatingDecl = Info.AccessedEvaluatingDecl;
+  Info.MaxCallStackDepth = Info.CallStackDepth;
+  Info.AccessedEvaluatingDecl = false;
+
+  bool Success = EvaluateFunctionCall(CallLoc, Callee, This, Args, ArgValues,
+                                      Body, Info, Result);
+  if (Success && CanMemoize && Info.EvalStatus.Diag->empty() &&
+      !Info.EvalStatus.HasSideEffects && !Info.AccessedEvaluatingDecl &&
+      ConstexprCallCache::isMemoizableValue(Result))
+    Cache.insert(Callee, ArgValues, Result, StepsLeft - Info.StepsLeft,
+                 Info.MaxCallStackDepth - Info.CallStackDepth);
+
+  Info.MaxCallStackDepth = std::max(Info.MaxCallStackDepth,
+                                    OuterMaxCallStackDepth);
+  Info.AccessedEvaluatingDecl |= OuterAccessedEvaluatingDecl;
+  return Success;
+}
+
 /// Evaluate a constructor call.
 static bool HandleConstructorCall(SourceLocation CallLoc, const LValue &This,
                                   ArrayRef<const Expr*> Args,
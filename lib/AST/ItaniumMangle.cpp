@@ -109,12 +109,36 @@ class ItaniumMangleContext : public MangleContext {
   typedef std::pair<const DeclContext*, IdentifierInfo*> DiscriminatorKeyTy;
   llvm::DenseMap<DiscriminatorKeyTy, unsigned> Discriminator;
   llvm::DenseMap<const NamedDecl*, unsigned> Uniquifier;
-  
+
+public:
+  /// \brief How a prefix is mangled at the start of a name: its mangling and
+  /// the substitutions that it adds, in order.
+  struct PrefixMangling {
+    std::string Mangling;
+    SmallVector<uintptr_t, 4> Substitutions;
+  };
+
+private:
+  llvm::DenseMap<const DeclContext *, PrefixMangling> PrefixManglings;
+
 public:
   explicit ItaniumMangleContext(ASTContext &Context,
                                 DiagnosticsEngine &Diags)
     : MangleContext(Context, Diags) { }
 
+  /// \brief Find how \p DC was mangled when it started a name, if it has
+  /// been.
+  const PrefixMangling *getPrefixMangling(const DeclContext *DC) const {
+    llvm::DenseMap<const DeclContext *, PrefixMangling>::const_iterator Known
+      = PrefixManglings.find(DC);
+    return Known == PrefixManglings.end() ? 0 : &Known->second;
+  }
+
+  const PrefixMangling *addPrefixMangling(const DeclContext *DC,
+                                          const PrefixMangling &Prefix) {
+    return &(PrefixManglings[DC] = Prefix);
+  }
+
   uint64_t getAnonymousStructId(const TagDecl *TD) {
     std::pair<llvm::DenseMap<const TagDecl *,
       uint64_t>::iterator, bool> Result =
@@ -340,6 +364,7 @@ private:
                         unsigned NumTemplateArgs);
   void manglePrefix(NestedNameSpecifier *qualifier);
   void manglePrefix(const DeclContext *DC, bool NoFunction=false);
+  void mangleUncachedPrefix(const DeclContext *DC, bool NoFunction);
   void manglePrefix(QualType type);
   void mangleTemplatePrefix(const TemplateDecl *ND, bool NoFunction=false);
   void mangleTemplatePrefix(TemplateName Template);
@@ -1490,7 +1515,59 @@ void CXXNameMangler::manglePrefix(NestedNameSpecifier *qualifier) {
   llvm_unreachable("unexpected nested name specifier");
 }
 
+/// \brief Determine whether the mangling of \p DC as the prefix that starts
+/// a name depends on nothing but \p DC: that is, whether it is a namespace
+/// or a class other than a lambda nested only in namespaces and such classes,
+/// so that the mangling involves no enclosing function and no template
+/// parameters.
+static bool isCacheablePrefix(const DeclContext *DC) {
+  if (DC->isTranslationUnit() || DC->isDependentContext())
+    return false;
+  for (; !DC->isTranslationUnit(); DC = DC->getParent()) {
+    if (const CXXRecordDecl *RD = dyn_cast<CXXRecordDecl>(DC)) {
+      if (RD->isLambda())
+        return false;
+    } else if (!isa<NamespaceDecl>(DC) && !isa<LinkageSpecDecl>(DC)) {
+      return false;
+    }
+  }
+  return true;
+}
+
 void CXXNameMangler::manglePrefix(const DeclContext *DC, bool NoFunction) {
+  DC = IgnoreLinkageSpecDecls(DC);
+
+  // A prefix that starts a name comes out the same every time, and members
+  // of one class all start with it, so mangle it once and then replay it
+  // along with the substitutions it adds.
+  if (SeqID == 0 && isCacheablePrefix(DC)) {
+    const ItaniumMangleContext::PrefixMangling *Known =
+      Context.getPrefixMangling(DC);
+    if (!Known) {
+      ItaniumMangleContext::PrefixMangling Prefix;
+      llvm::raw_string_ostream PrefixOut(Prefix.Mangling);
+      CXXNameMangler PrefixMangler(Context, PrefixOut);
+      PrefixMangler.mangleUncachedPrefix(DC, NoFunction);
+      PrefixOut.flush();
+      Prefix.Substitutions.resize(PrefixMangler.SeqID);
+      for (llvm::DenseMap<uintptr_t, unsigned>::iterator
+             I = PrefixMangler.Substitutions.begin(),
+             E = PrefixMangler.Substitutions.end(); I != E; ++I)
+        Prefix.Substitutions[I->second] = I->first;
+      Known = Context.addPrefixMangling(DC, Prefix);
+    }
+
+    Out << Known->Mangling;
+    for (unsigned I = 0, N = Known->Substitutions.size(); I != N; ++I)
+      addSubstitution(Known->Substitutions[I]);
+    return;
+  }
+
+  mangleUncachedPrefix(DC, NoFunction);
+}
+
+void CXXNameMangler::mangleUncachedPrefix(const DeclContext *DC,
+                                          bool NoFunction) {
   //  <prefix> ::= <prefix> <unqualified-name>
   //           ::= <template-prefix> <template-args>
   //           ::= <template-param>
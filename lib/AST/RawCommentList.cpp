@@ -16,6 +16,7 @@
 #include "clang/AST/CommentParser.h"
 #include "clang/AST/CommentSema.h"
 #include "llvm/ADT/STLExtras.h"
+#include <algorithm>
 
 using namespace clang;
 
@@ -213,6 +214,11 @@ void RawCommentList::addComment(const RawComment &RC,
   if (RC.isInvalid())
     return;
 
+  // Comments are only ever attached to declarations in the same file, so
+  // keep each file's comments apart.
+  FileID File = SourceMgr.getFileID(RC.getSourceRange().getBegin());
+  std::vector<RawComment *> &Comments = FileComments[File];
+
   // Check if the comments are not in source order.
   while (!Comments.empty() &&
          !SourceMgr.isBeforeInTranslationUnit(
@@ -238,6 +244,7 @@ void RawCommentList::addComment(const RawComment &RC,
 
   // If this is the first Doxygen comment, save it (because there isn't
   // anything to merge it with).
+  LastCommentFile = File;
   if (Comments.empty()) {
     Comments.push_back(new (Allocator) RawComment(RC));
     OnlyWhitespaceSeen = true;
@@ -268,3 +275,12 @@ void RawCommentList::addComment(const RawComment &RC,
 
   OnlyWhitespaceSeen = true;
 }
+
+void
+RawCommentList::getFilesWithComments(SmallVectorImpl<FileID> &Files) const {
+  for (llvm::DenseMap<FileID, std::vector<RawComment *> >::const_iterator
+         I = FileComments.begin(), E = FileComments.end(); I != E; ++I)
+    if (!I->second.empty())
+      Files.push_back(I->first);
+  std::sort(Files.begin(), Files.end());
+}
@@ -92,6 +92,10 @@ void Stmt::addStmtClass(StmtClass s) {
   ++getStmtInfoTableEntry(s).Counter;
 }
 
+unsigned Stmt::getNumStmtsCreated(StmtClass S) {
+  return getStmtInfoTableEntry(S).Counter;
+}
+
 bool Stmt::StatisticsEnabled = false;
 void Stmt::EnableStatistics() {
   StatisticsEnabled = true;
@@ -1170,3 +1174,26 @@ OMPParallelDirective *OMPParallelDirective::CreateEmpty(ASTContext &C,
                          llvm::alignOf<OMPParallelDirective>());
   return new (Mem) OMPParallelDirective(N);
 }
+
+OMPSimdDirective *OMPSimdDirective::Create(ASTContext &C,
+                                           SourceLocation StartLoc,
+                                           SourceLocation EndLoc,
+                                           ArrayRef<OMPClause *> Clauses,
+                                           Stmt *AssociatedStmt) {
+  void *Mem = C.Allocate(sizeof(OMPSimdDirective) +
+                         sizeof(OMPClause *) * Clauses.size() + sizeof(Stmt *),
+                         llvm::alignOf<OMPSimdDirective>());
+  OMPSimdDirective *Dir = new (Mem) OMPSimdDirective(StartLoc, EndLoc,
+                                                     Clauses.size());
+  Dir->setClauses(Clauses);
+  Dir->setAssociatedStmt(AssociatedStmt);
+  return Dir;
+}
+
+OMPSimdDirective *OMPSimdDirective::CreateEmpty(ASTContext &C, unsigned N,
+                                                EmptyShell) {
+  void *Mem = C.Allocate(sizeof(OMPSimdDirective) +
+                         sizeof(OMPClause *) * N + sizeof(Stmt *),
+                         llvm::alignOf<OMPSimdDirective>());
+  return new (Mem) OMPSimdDirective(N);
+}
@@ -70,6 +70,7 @@ namespace  {
     void PrintCallArgs(CallExpr *E);
     void PrintRawSEHExceptHandler(SEHExceptStmt *S);
     void PrintRawSEHFinallyStmt(SEHFinallyStmt *S);
+    void PrintOMPExecutableDirective(OMPExecutableDirective *S);
 
     void PrintExpr(Expr *E) {
       if (E)
@@ -172,6 +173,21 @@ void StmtPrinter::VisitLabelStmt(LabelStmt *Node) {
 }
 
 void StmtPrinter::VisitAttributedStmt(AttributedStmt *Node) {
+  // The loop hints come from a '#pragma clang loop', which is printed on its
+  // own line in front of the loop.
+  if (isa<LoopHintAttr>(Node->getAttrs().front())) {
+    Indent() << "#pragma clang loop";
+    for (ArrayRef<const Attr*>::iterator it = Node->getAttrs().begin(),
+                                         end = Node->getAttrs().end();
+         it != end; ++it) {
+      OS << ' ';
+      cast<LoopHintAttr>(*it)->printPrettyPragma(OS, Policy);
+    }
+    OS << "\n";
+    PrintStmt(Node->getSubStmt(), 0);
+    return;
+  }
+
   OS << "[[";
   bool first = true;
   for (ArrayRef<const Attr*>::iterator it = Node->getAttrs().begin(),
@@ -586,8 +602,10 @@ void StmtPrinter::VisitSEHFinallyStmt(SEHFinallyStmt *Node) {
 namespace {
 class OMPClausePrinter : public OMPClauseVisitor<OMPClausePrinter> {
   raw_ostream &OS;
+  const PrintingPolicy &Policy;
 public:
-  OMPClausePrinter(raw_ostream &OS) : OS(OS) { }
+  OMPClausePrinter(raw_ostream &OS, const PrintingPolicy &Policy)
+    : OS(OS), Policy(Policy) { }
 #define OPENMP_CLAUSE(Name, Class)                              \
   void Visit##Class(Class *S);
 #include "clang/Basic/OpenMPKinds.def"
@@ -599,6 +617,12 @@ void OMPClausePrinter::VisitOMPDefaultClause(OMPDefaultClause *Node) {
      << ")";
 }
 
+void OMPClausePrinter::VisitOMPSafelenClause(OMPSafelenClause *Node) {
+  OS << "safelen(";
+  Node->getSafelen()->printPretty(OS, 0, Policy, 0);
+  OS << ")";
+}
+
 #define PROCESS_OMP_CLAUSE_LIST(Class, Node, StartSym)                         \
   for (OMPVarList<Class>::varlist_iterator I = Node->varlist_begin(),          \
                                            E = Node->varlist_end();            \
@@ -621,11 +645,9 @@ void OMPClausePrinter::VisitOMPPrivateClause(OMPPrivateClause *Node) {
 //  OpenMP directives printing methods
 //===----------------------------------------------------------------------===//
 
-void StmtPrinter::VisitOMPParallelDirective(OMPParallelDirective *Node) {
-  Indent() << "#pragma omp parallel ";
-
-  OMPClausePrinter Printer(OS);
-  ArrayRef<OMPClause *> Clauses = Node->clauses();
+void StmtPrinter::PrintOMPExecutableDirective(OMPExecutableDirective *S) {
+  OMPClausePrinter Printer(OS, Policy);
+  ArrayRef<OMPClause *> Clauses = S->clauses();
   for (ArrayRef<OMPClause *>::iterator I = Clauses.begin(), E = Clauses.end();
        I != E; ++I)
     if (*I && !(*I)->isImplicit()) {
@@ -633,6 +655,11 @@ void StmtPrinter::VisitOMPParallelDirective(OMPParallelDirective *Node) {
       OS << ' ';
     }
   OS << "\n";
+}
+
+void StmtPrinter::VisitOMPParallelDirective(OMPParallelDirective *Node) {
+  Indent() << "#pragma omp parallel ";
+  PrintOMPExecutableDirective(Node);
   if (Node->getAssociatedStmt()) {
     assert(isa<CapturedStmt>(Node->getAssociatedStmt()) &&
            "Expected captured statement!");
@@ -640,6 +667,13 @@ void StmtPrinter::VisitOMPParallelDirective(OMPParallelDirective *Node) {
     PrintStmt(CS);
   }
 }
+
+void StmtPrinter::VisitOMPSimdDirective(OMPSimdDirective *Node) {
+  Indent() << "#pragma omp simd ";
+  PrintOMPExecutableDirective(Node);
+  if (Node->getAssociatedStmt())
+    PrintStmt(Node->getAssociatedStmt());
+}
 //===----------------------------------------------------------------------===//
 //  Expr printing methods.
 //===----------------------------------------------------------------------===//
@@ -13,6 +13,7 @@
 //===----------------------------------------------------------------------===//
 #include "clang/AST/ASTContext.h"
 #include "clang/AST/DeclCXX.h"
+#include "clang/AST/DeclHasher.h"
 #include "clang/AST/DeclObjC.h"
 #include "clang/AST/DeclTemplate.h"
 #include "clang/AST/Expr.h"
@@ -27,11 +28,18 @@ namespace {
     llvm::FoldingSetNodeID &ID;
     const ASTContext &Context;
     bool Canonical;
+    /// \brief If non-null, the hasher that adds the declarations, types and
+    /// names referenced by the statement, instead of their addresses.
+    DeclHasher *Hasher;
 
   public:
     StmtProfiler(llvm::FoldingSetNodeID &ID, const ASTContext &Context,
                  bool Canonical)
-      : ID(ID), Context(Context), Canonical(Canonical) { }
+      : ID(ID), Context(Context), Canonical(Canonical), Hasher(0) { }
+
+    StmtProfiler(llvm::FoldingSetNodeID &ID, DeclHasher &Hasher)
+      : ID(ID), Context(Hasher.getASTContext()), Canonical(true),
+        Hasher(&Hasher) { }
 
     void VisitStmt(const Stmt *S);
 
@@ -263,6 +271,10 @@ public:
 };
 
 void OMPClauseProfiler::VisitOMPDefaultClause(const OMPDefaultClause *C) { }
+void OMPClauseProfiler::VisitOMPSafelenClause(const OMPSafelenClause *C) {
+  if (C->getSafelen())
+    Profiler->VisitStmt(C->getSafelen());
+}
 #define PROCESS_OMP_CLAUSE_LIST(Class, Node)                                   \
   for (OMPVarList<Class>::varlist_const_iterator I = Node->varlist_begin(),    \
                                                  E = Node->varlist_end();      \
@@ -276,7 +288,7 @@ void OMPClauseProfiler::VisitOMPPrivateClause(const OMPPrivateClause *C) {
 }
 
 void
-StmtProfiler::VisitOMPParallelDirective(const OMPParallelDirective *S) {
+StmtProfiler::VisitOMPExecutableDirective(const OMPExecutableDirective *S) {
   VisitStmt(S);
   OMPClauseProfiler P(this);
   ArrayRef<OMPClause *> Clauses = S->clauses();
@@ -286,6 +298,15 @@ StmtProfiler::VisitOMPParallelDirective(const OMPParallelDirective *S) {
       P.Visit(*I);
 }
 
+void
+StmtProfiler::VisitOMPParallelDirective(const OMPParallelDirective *S) {
+  VisitOMPExecutableDirective(S);
+}
+
+void StmtProfiler::VisitOMPSimdDirective(const OMPSimdDirective *S) {
+  VisitOMPExecutableDirective(S);
+}
+
 void StmtProfiler::VisitExpr(const Expr *S) {
   VisitStmt(S);
 }
@@ -360,7 +381,10 @@ void StmtProfiler::VisitOffsetOfExpr(const OffsetOfExpr *S) {
       break;
 
     case OffsetOfExpr::OffsetOfNode::Identifier:
-      ID.AddPointer(ON.getFieldName());
+      if (Hasher)
+        ID.AddString(ON.getFieldName()->getName());
+      else
+        ID.AddPointer(ON.getFieldName());
       break;
         
     case OffsetOfExpr::OffsetOfNode::Base:
@@ -1180,10 +1204,20 @@ void StmtProfiler::VisitDecl(const Decl *D) {
     }
   }
 
+  if (Hasher) {
+    Hasher->AddDeclRef(D, ID);
+    return;
+  }
+
   ID.AddPointer(D? D->getCanonicalDecl() : 0);
 }
 
 void StmtProfiler::VisitType(QualType T) {
+  if (Hasher) {
+    Hasher->AddType(T, ID);
+    return;
+  }
+
   if (Canonical)
     T = Context.getCanonicalType(T);
 
@@ -1191,16 +1225,31 @@ void StmtProfiler::VisitType(QualType T) {
 }
 
 void StmtProfiler::VisitName(DeclarationName Name) {
+  if (Hasher) {
+    Hasher->AddName(Name, ID);
+    return;
+  }
+
   ID.AddPointer(Name.getAsOpaquePtr());
 }
 
 void StmtProfiler::VisitNestedNameSpecifier(NestedNameSpecifier *NNS) {
+  if (Hasher) {
+    Hasher->AddNestedNameSpecifier(NNS, ID);
+    return;
+  }
+
   if (Canonical)
     NNS = Context.getCanonicalNestedNameSpecifier(NNS);
   ID.AddPointer(NNS);
 }
 
 void StmtProfiler::VisitTemplateName(TemplateName Name) {
+  if (Hasher) {
+    Hasher->AddTemplateName(Name, ID);
+    return;
+  }
+
   if (Canonical)
     Name = Context.getCanonicalTemplateName(Name);
 
@@ -1260,3 +1309,8 @@ void Stmt::Profile(llvm::FoldingSetNodeID &ID, const ASTContext &Context,
   StmtProfiler Profiler(ID, Context, Canonical);
   Profiler.Visit(this);
 }
+
+void Stmt::Profile(llvm::FoldingSetNodeID &ID, DeclHasher &Hasher) const {
+  StmtProfiler Profiler(ID, Hasher);
+  Profiler.Visit(this);
+}
@@ -20,6 +20,8 @@
 #include "clang/AST/ASTConsumer.h"
 #include "clang/AST/ASTContext.h"
 #include "clang/AST/RecursiveASTVisitor.h"
+#include "clang/Basic/WorkerPool.h"
+#include <algorithm>
 #include <deque>
 #include <set>
 
@@ -295,10 +297,30 @@ private:
 class MatchASTVisitor : public RecursiveASTVisitor<MatchASTVisitor>,
                         public ASTMatchFinder {
 public:
+  typedef llvm::DenseMap<const Type*, std::set<const TypedefNameDecl*> >
+      TypeAliasMap;
+  typedef std::pair<MatchCallback*, BoundNodes> DeferredMatch;
+
   MatchASTVisitor(std::vector<std::pair<const internal::DynTypedMatcher*,
                                         MatchCallback*> > *MatcherCallbackPairs)
      : MatcherCallbackPairs(MatcherCallbackPairs),
-       ActiveASTContext(NULL) {
+       ActiveASTContext(NULL),
+       NumIndexedMatchers(0),
+       SharedTypeAliases(NULL),
+       DeferredMatches(NULL) {
+  }
+
+  // Makes this visitor look up type aliases in those \p Other collected,
+  // instead of collecting them itself while traversing. \p Other must not
+  // be traversing at the same time.
+  void useTypeAliasesOf(const MatchASTVisitor &Other) {
+    SharedTypeAliases = &Other.TypeAliases;
+  }
+
+  // Makes this visitor append its matches to \p Matches instead of running
+  // their callbacks.
+  void deferMatchesTo(std::vector<DeferredMatch> *Matches) {
+    DeferredMatches = Matches;
   }
 
   void onStartOfTranslationUnit() {
@@ -354,6 +376,8 @@ public:
     // E are aliases, even though neither is a typedef of the other.
     // Therefore, we cannot simply walk through one typedef chain to
     // find out whether the type name matches.
+    if (SharedTypeAliases)
+      return true;
     const Type *TypeNode = DeclNode->getUnderlyingType().getTypePtr();
     const Type *CanonicalType =  // root of the typedef tree
         ActiveASTContext->getCanonicalType(TypeNode);
@@ -450,13 +474,16 @@ public:
   // Matches all registered matchers on the given node and calls the
   // result callback for every node that matches.
   void match(const ast_type_traits::DynTypedNode& Node) {
-    for (std::vector<std::pair<const internal::DynTypedMatcher*,
-                               MatchCallback*> >::const_iterator
-             I = MatcherCallbackPairs->begin(), E = MatcherCallbackPairs->end();
+    const std::vector<unsigned> &Applicable =
+        getMatchersForKind(Node.getNodeKind());
+    for (std::vector<unsigned>::const_iterator I = Applicable.begin(),
+                                               E = Applicable.end();
          I != E; ++I) {
+      const std::pair<const internal::DynTypedMatcher*, MatchCallback*> &Pair =
+          (*MatcherCallbackPairs)[*I];
       BoundNodesTreeBuilder Builder;
-      if (I->first->matches(Node, this, &Builder)) {
-        MatchVisitor Visitor(ActiveASTContext, I->second);
+      if (Pair.first->matches(Node, this, &Builder)) {
+        MatchVisitor Visitor(ActiveASTContext, Pair.second, DeferredMatches);
         Builder.visitMatches(&Visitor);
       }
     }
@@ -476,6 +503,35 @@ public:
   bool shouldUseDataRecursionFor(clang::Stmt *S) const { return false; }
 
 private:
+  // Returns the indices into MatcherCallbackPairs of the matchers that can
+  // match a node of the given kind, in registration order.
+  //
+  // A matcher can only match nodes of its supported kind or of a kind derived
+  // from it, but a node created with a base kind may turn out to be of the
+  // matcher's kind dynamically, so matchers for derived kinds are kept too.
+  // This drops e.g. all statement matchers from the list tried on a Decl.
+  const std::vector<unsigned> &
+  getMatchersForKind(ast_type_traits::ASTNodeKind Kind) {
+    if (NumIndexedMatchers != MatcherCallbackPairs->size()) {
+      MatchersByKind.clear();
+      NumIndexedMatchers = MatcherCallbackPairs->size();
+    }
+    std::map<ast_type_traits::ASTNodeKind, std::vector<unsigned> >::iterator
+        I = MatchersByKind.find(Kind);
+    if (I != MatchersByKind.end())
+      return I->second;
+
+    std::vector<unsigned> &Indices = MatchersByKind[Kind];
+    for (unsigned Index = 0, E = MatcherCallbackPairs->size(); Index != E;
+         ++Index) {
+      ast_type_traits::ASTNodeKind MatcherKind =
+          (*MatcherCallbackPairs)[Index].first->getSupportedKind();
+      if (MatcherKind.isBaseOf(Kind) || Kind.isBaseOf(MatcherKind))
+        Indices.push_back(Index);
+    }
+    return Indices;
+  }
+
   // Returns whether an ancestor of \p Node matches \p Matcher.
   //
   // The order of matching ((which can lead to different nodes being bound in
@@ -566,21 +622,28 @@ private:
   }
 
   // Implements a BoundNodesTree::Visitor that calls a MatchCallback with
-  // the aggregated bound nodes for each match.
+  // the aggregated bound nodes for each match, or records the match in
+  // Deferred for the callback to be called later.
   class MatchVisitor : public BoundNodesTreeBuilder::Visitor {
   public:
     MatchVisitor(ASTContext* Context,
-                 MatchFinder::MatchCallback* Callback)
+                 MatchFinder::MatchCallback* Callback,
+                 std::vector<DeferredMatch> *Deferred)
       : Context(Context),
-        Callback(Callback) {}
+        Callback(Callback),
+        Deferred(Deferred) {}
 
     virtual void visitMatch(const BoundNodes& BoundNodesView) {
-      Callback->run(MatchFinder::MatchResult(BoundNodesView, Context));
+      if (Deferred)
+        Deferred->push_back(std::make_pair(Callback, BoundNodesView));
+      else
+        Callback->run(MatchFinder::MatchResult(BoundNodesView, Context));
     }
 
   private:
     ASTContext* Context;
     MatchFinder::MatchCallback* Callback;
+    std::vector<DeferredMatch> *Deferred;
   };
 
   // Returns true if 'TypeNode' has an alias that matches the given matcher.
@@ -589,8 +652,12 @@ private:
                             BoundNodesTreeBuilder *Builder) {
     const Type *const CanonicalType =
       ActiveASTContext->getCanonicalType(TypeNode);
-    const std::set<const TypedefNameDecl *> &Aliases =
-        TypeAliases[CanonicalType];
+    const TypeAliasMap &AllAliases =
+        SharedTypeAliases ? *SharedTypeAliases : TypeAliases;
+    TypeAliasMap::const_iterator Found = AllAliases.find(CanonicalType);
+    if (Found == AllAliases.end())
+      return false;
+    const std::set<const TypedefNameDecl *> &Aliases = Found->second;
     for (std::set<const TypedefNameDecl*>::const_iterator
            It = Aliases.begin(), End = Aliases.end();
          It != End; ++It) {
@@ -607,8 +674,19 @@ private:
                         MatchCallback*> > *const MatcherCallbackPairs;
   ASTContext *ActiveASTContext;
 
+  // Maps a node kind to the matchers that can match nodes of that kind. Only
+  // valid while MatcherCallbackPairs has NumIndexedMatchers entries.
+  std::map<ast_type_traits::ASTNodeKind, std::vector<unsigned> > MatchersByKind;
+  size_t NumIndexedMatchers;
+
   // Maps a canonical type to its TypedefDecls.
-  llvm::DenseMap<const Type*, std::set<const TypedefNameDecl*> > TypeAliases;
+  TypeAliasMap TypeAliases;
+
+  // If set, the aliases to use instead of TypeAliases.
+  const TypeAliasMap *SharedTypeAliases;
+
+  // If set, receives the matches instead of their callbacks being called.
+  std::vector<DeferredMatch> *DeferredMatches;
 
   // Maps (matcher, node) -> the match result for memoization.
   typedef std::map<MatchKey, MemoizedMatchResult> MemoizationMap;
@@ -740,14 +818,104 @@ bool MatchASTVisitor::TraverseNestedNameSpecifierLoc(
       RecursiveASTVisitor<MatchASTVisitor>::TraverseNestedNameSpecifierLoc(NNS);
 }
 
+// The state shared by the tasks of matchInParallel.
+struct ParallelMatchRun {
+  std::vector<std::pair<const internal::DynTypedMatcher*,
+                        MatchCallback*> > *MatcherCallbackPairs;
+  ASTContext *Context;
+  const MatchASTVisitor *AliasCollector;
+  std::vector<Decl *> Decls;
+  // Chunk I holds the declarations [ChunkBegin[I], ChunkBegin[I + 1]).
+  std::vector<unsigned> ChunkBegin;
+  std::vector<std::vector<MatchASTVisitor::DeferredMatch> > Matches;
+};
+
+static void matchChunkTask(void *Context, unsigned Index) {
+  ParallelMatchRun &Run = *static_cast<ParallelMatchRun *>(Context);
+  MatchASTVisitor Visitor(Run.MatcherCallbackPairs);
+  Visitor.set_active_ast_context(Run.Context);
+  Visitor.useTypeAliasesOf(*Run.AliasCollector);
+  Visitor.deferMatchesTo(&Run.Matches[Index]);
+  for (unsigned I = Run.ChunkBegin[Index], E = Run.ChunkBegin[Index + 1];
+       I != E; ++I)
+    Visitor.TraverseDecl(Run.Decls[I]);
+}
+
+// Matches the translation unit of \p Context on up to \p NumThreads
+// threads, by traversing its top-level declarations concurrently, and then
+// runs the callbacks of all matches on this thread in traversal order.
+// Returns false, without matching anything, if the translation unit cannot
+// be traversed concurrently.
+static bool matchInParallel(
+    std::vector<std::pair<const internal::DynTypedMatcher*,
+                          MatchCallback*> > *MatcherCallbackPairs,
+    ASTContext &Context, unsigned NumThreads) {
+  // Deserializing declarations on demand is not thread-safe.
+  if (Context.getExternalSource())
+    return false;
+
+  ParallelMatchRun Run;
+  TranslationUnitDecl *TU = Context.getTranslationUnitDecl();
+  for (DeclContext::decl_iterator I = TU->decls_begin(), E = TU->decls_end();
+       I != E; ++I) {
+    // Mirror RecursiveASTVisitor::TraverseDeclContextHelper.
+    if (!isa<BlockDecl>(*I) && !isa<CapturedDecl>(*I))
+      Run.Decls.push_back(*I);
+  }
+  unsigned NumWorkers = getEffectiveWorkerCount(NumThreads);
+  if (NumWorkers == 1 || Run.Decls.size() < 2)
+    return false;
+
+  // Collect the type aliases of the whole translation unit up front, for
+  // isDerivedFrom(), as the workers cannot see each other's.
+  std::vector<std::pair<const internal::DynTypedMatcher*,
+                        MatchCallback*> > NoMatchers;
+  MatchASTVisitor AliasCollector(&NoMatchers);
+  AliasCollector.set_active_ast_context(&Context);
+  AliasCollector.TraverseDecl(TU);
+
+  // The parent map is built as it is queried; build all of it now rather
+  // than from several threads at once.
+  Context.buildParentMap();
+
+  // The translation unit itself is matched first, as in a serial traversal.
+  MatchASTVisitor Visitor(MatcherCallbackPairs);
+  Visitor.set_active_ast_context(&Context);
+  Visitor.useTypeAliasesOf(AliasCollector);
+  Visitor.match(*TU);
+
+  // Use several chunks per worker, so that one large declaration does not
+  // leave the other workers idle.
+  unsigned NumChunks = std::min<unsigned>(Run.Decls.size(), NumWorkers * 8);
+  for (unsigned I = 0; I != NumChunks; ++I)
+    Run.ChunkBegin.push_back(I * Run.Decls.size() / NumChunks);
+  Run.ChunkBegin.push_back(Run.Decls.size());
+  Run.MatcherCallbackPairs = MatcherCallbackPairs;
+  Run.Context = &Context;
+  Run.AliasCollector = &AliasCollector;
+  Run.Matches.resize(NumChunks);
+  runTasksInParallel(NumChunks, NumWorkers, matchChunkTask, &Run);
+
+  for (unsigned I = 0; I != NumChunks; ++I) {
+    const std::vector<MatchASTVisitor::DeferredMatch> &Matches = Run.Matches[I];
+    for (unsigned J = 0, E = Matches.size(); J != E; ++J)
+      Matches[J].first->run(
+          MatchFinder::MatchResult(Matches[J].second, &Context));
+  }
+  return true;
+}
+
 class MatchASTConsumer : public ASTConsumer {
 public:
   MatchASTConsumer(
     std::vector<std::pair<const internal::DynTypedMatcher*,
                           MatchCallback*> > *MatcherCallbackPairs,
-    MatchFinder::ParsingDoneTestCallback *ParsingDone)
+    MatchFinder::ParsingDoneTestCallback *ParsingDone,
+    unsigned NumThreads)
     : Visitor(MatcherCallbackPairs),
-      ParsingDone(ParsingDone) {}
+      MatcherCallbackPairs(MatcherCallbackPairs),
+      ParsingDone(ParsingDone),
+      NumThreads(NumThreads) {}
 
 private:
   virtual void HandleTranslationUnit(ASTContext &Context) {
@@ -756,13 +924,18 @@ private:
     }
     Visitor.set_active_ast_context(&Context);
     Visitor.onStartOfTranslationUnit();
-    Visitor.TraverseDecl(Context.getTranslationUnitDecl());
+    if (NumThreads == 1 ||
+        !matchInParallel(MatcherCallbackPairs, Context, NumThreads))
+      Visitor.TraverseDecl(Context.getTranslationUnitDecl());
     Visitor.onEndOfTranslationUnit();
     Visitor.set_active_ast_context(NULL);
   }
 
   MatchASTVisitor Visitor;
+  std::vector<std::pair<const internal::DynTypedMatcher*,
+                        MatchCallback*> > *MatcherCallbackPairs;
   MatchFinder::ParsingDoneTestCallback *ParsingDone;
+  unsigned NumThreads;
 };
 
 } // end namespace
@@ -776,7 +949,7 @@ MatchFinder::MatchResult::MatchResult(const BoundNodes &Nodes,
 MatchFinder::MatchCallback::~MatchCallback() {}
 MatchFinder::ParsingDoneTestCallback::~ParsingDoneTestCallback() {}
 
-MatchFinder::MatchFinder() : ParsingDone(NULL) {}
+MatchFinder::MatchFinder() : ParsingDone(NULL), NumThreads(1) {}
 
 MatchFinder::~MatchFinder() {
   for (std::vector<std::pair<const internal::DynTypedMatcher*,
@@ -824,7 +997,8 @@ void MatchFinder::addMatcher(const TypeLocMatcher &NodeMatch,
 }
 
 ASTConsumer *MatchFinder::newASTConsumer() {
-  return new internal::MatchASTConsumer(&MatcherCallbackPairs, ParsingDone);
+  return new internal::MatchASTConsumer(&MatcherCallbackPairs, ParsingDone,
+                                        NumThreads);
 }
 
 void MatchFinder::match(const clang::ast_type_traits::DynTypedNode &Node,
@@ -414,6 +414,27 @@ DynTypedMatcher *Parser::parseMatcherExpression(StringRef Code,
   return Value.getMatchers().matchers()[0]->clone();
 }
 
+ParsedMatcherCache::~ParsedMatcherCache() { clear(); }
+
+const DynTypedMatcher *ParsedMatcherCache::getMatcher(StringRef Code,
+                                                      Diagnostics *Error) {
+  llvm::StringMap<DynTypedMatcher *>::iterator I = Matchers.find(Code);
+  if (I != Matchers.end())
+    return I->getValue();
+  DynTypedMatcher *Matcher = Parser::parseMatcherExpression(Code, Error);
+  if (Matcher)
+    Matchers[Code] = Matcher;
+  return Matcher;
+}
+
+void ParsedMatcherCache::clear() {
+  for (llvm::StringMap<DynTypedMatcher *>::iterator I = Matchers.begin(),
+                                                    E = Matchers.end();
+       I != E; ++I)
+    delete I->getValue();
+  Matchers.clear();
+}
+
 }  // namespace dynamic
 }  // namespace ast_matchers
 }  // namespace clang
@@ -40,6 +40,8 @@ AnalysisDeclContext::AnalysisDeclContext(AnalysisDeclContextManager *Mgr,
                                          const CFG::BuildOptions &buildOptions)
   : Manager(Mgr),
     D(d),
+    cfg(0),
+    completeCFG(0),
     cfgBuildOptions(buildOptions),
     forcedBlkExprs(0),
     builtCFG(false),
@@ -54,6 +56,8 @@ AnalysisDeclContext::AnalysisDeclContext(AnalysisDeclContextManager *Mgr,
                                          const Decl *d)
 : Manager(Mgr),
   D(d),
+  cfg(0),
+  completeCFG(0),
   forcedBlkExprs(0),
   builtCFG(false),
   builtCompleteCFG(false),
@@ -84,9 +88,29 @@ void AnalysisDeclContextManager::clear() {
   Contexts.clear();
 }
 
-static BodyFarm &getBodyFarm(ASTContext &C) {
-  static BodyFarm *BF = new BodyFarm(C);
-  return *BF;
+CFG *AnalysisDeclContextManager::getCFG(const Decl *D, Stmt *Body,
+                                        const CFG::BuildOptions &Options) {
+  SmallVectorImpl<CachedCFG> &Cached = CFGs[D];
+  for (SmallVectorImpl<CachedCFG>::iterator I = Cached.begin(),
+                                            E = Cached.end(); I != E; ++I)
+    if (I->Options.subsumes(Options))
+      return I->TheCFG;
+
+  CachedCFG Entry;
+  Entry.Options = Options;
+  // The forced block expressions belong to the context that asked.
+  Entry.Options.forcedBlkExprs = 0;
+  Entry.TheCFG = CFG::buildCFG(D, Body, &D->getASTContext(), Options);
+  Cached.push_back(Entry);
+  return Entry.TheCFG;
+}
+
+BodyFarm &AnalysisDeclContextManager::getBodyFarm(ASTContext &C) {
+  if (!BdyFrm)
+    BdyFrm.reset(new BodyFarm(C));
+  assert(&BdyFrm->getASTContext() == &C &&
+         "a manager analyzes the declarations of a single AST");
+  return *BdyFrm;
 }
 
 Stmt *AnalysisDeclContext::getBody(bool &IsAutosynthesized) const {
@@ -95,7 +119,7 @@ Stmt *AnalysisDeclContext::getBody(bool &IsAutosynthesized) const {
     Stmt *Body = FD->getBody();
     if (!Body && Manager && Manager->synthesizeBodies()) {
       IsAutosynthesized = true;
-      return getBodyFarm(getASTContext()).getBody(FD);
+      return Manager->getBodyFarm(getASTContext()).getBody(FD);
     }
     return Body;
   }
@@ -170,37 +194,46 @@ static void addParentsForSyntheticStmts(const CFG *TheCFG, ParentMap &PM) {
   }
 }
 
+CFG *AnalysisDeclContext::buildCFG(const CFG::BuildOptions &Options,
+                                   OwningPtr<CFG> &Owned) {
+  // Forced block expressions are recorded while the CFG is built, so they
+  // cannot be found in a CFG that was built for another context.
+  if (Manager && !forcedBlkExprs)
+    return Manager->getCFG(D, getBody(), Options);
+
+  Owned.reset(CFG::buildCFG(D, getBody(), &D->getASTContext(), Options));
+  return Owned.get();
+}
+
 CFG *AnalysisDeclContext::getCFG() {
   if (!cfgBuildOptions.PruneTriviallyFalseEdges)
     return getUnoptimizedCFG();
 
   if (!builtCFG) {
-    cfg.reset(CFG::buildCFG(D, getBody(),
-                            &D->getASTContext(), cfgBuildOptions));
+    cfg = buildCFG(cfgBuildOptions, ownedCFG);
     // Even when the cfg is not successfully built, we don't
     // want to try building it again.
     builtCFG = true;
 
     if (PM)
-      addParentsForSyntheticStmts(cfg.get(), *PM);
+      addParentsForSyntheticStmts(cfg, *PM);
   }
-  return cfg.get();
+  return cfg;
 }
 
 CFG *AnalysisDeclContext::getUnoptimizedCFG() {
   if (!builtCompleteCFG) {
     SaveAndRestore<bool> NotPrune(cfgBuildOptions.PruneTriviallyFalseEdges,
                                   false);
-    completeCFG.reset(CFG::buildCFG(D, getBody(), &D->getASTContext(),
-                                    cfgBuildOptions));
+    completeCFG = buildCFG(cfgBuildOptions, ownedCompleteCFG);
     // Even when the cfg is not successfully built, we don't
     // want to try building it again.
     builtCompleteCFG = true;
 
     if (PM)
-      addParentsForSyntheticStmts(completeCFG.get(), *PM);
+      addParentsForSyntheticStmts(completeCFG, *PM);
   }
-  return completeCFG.get();
+  return completeCFG;
 }
 
 CFGStmtMap *AnalysisDeclContext::getCFGStmtMap() {
@@ -216,15 +249,7 @@ CFGStmtMap *AnalysisDeclContext::getCFGStmtMap() {
 }
 
 CFGReverseBlockReachabilityAnalysis *AnalysisDeclContext::getCFGReachablityAnalysis() {
-  if (CFA)
-    return CFA.get();
-  
-  if (CFG *c = getCFG()) {
-    CFA.reset(new CFGReverseBlockReachabilityAnalysis(*c));
-    return CFA.get();
-  }
-  
-  return 0;
+  return getAnalysis<CFGReverseBlockReachabilityAnalysis>();
 }
 
 void AnalysisDeclContext::dumpCFG(bool ShowColors) {
@@ -557,6 +582,11 @@ AnalysisDeclContext::~AnalysisDeclContext() {
 AnalysisDeclContextManager::~AnalysisDeclContextManager() {
   for (ContextMap::iterator I = Contexts.begin(), E = Contexts.end(); I!=E; ++I)
     delete I->second;
+  for (CFGMap::iterator I = CFGs.begin(), E = CFGs.end(); I != E; ++I)
+    for (SmallVectorImpl<CachedCFG>::iterator CI = I->second.begin(),
+                                              CE = I->second.end();
+         CI != CE; ++CI)
+      delete CI->TheCFG;
 }
 
 LocationContext::~LocationContext() {}
@@ -24,6 +24,7 @@ clang_analysis_SRC_FILES := \
   CFGStmtMap.cpp \
   CocoaConventions.cpp \
   Consumed.cpp \
+  DataflowWorklist.cpp \
   Dominators.cpp \
   FormatString.cpp \
   LiveVariables.cpp \
@@ -32,6 +32,8 @@ public:
   
   /// Factory method for creating bodies for ordinary functions.
   Stmt *getBody(const FunctionDecl *D);
+
+  ASTContext &getASTContext() const { return C; }
   
 private:
   typedef llvm::DenseMap<const Decl *, Optional<Stmt *> > BodyMap;
@@ -159,6 +159,12 @@ public:
       return *this != const_iterator();
     }
 
+    /// Returns the number of variables between this position and the root of
+    /// the scopes tree.
+    unsigned getDepth() const {
+      return Scope ? Scope->PrevDepth + VarIter : 0;
+    }
+
     int distance(const_iterator L);
   };
 
@@ -172,11 +178,14 @@ private:
   /// Iterator to variable in previous scope that was declared just before
   /// begin of this scope.
   const_iterator Prev;
+  /// Depth of Prev, cached so that distances between positions can be
+  /// computed without walking the scopes between them.
+  unsigned PrevDepth;
 
 public:
   /// Constructs empty scope linked to previous scope in specified place.
   LocalScope(BumpVectorContext &ctx, const_iterator P)
-      : ctx(ctx), Vars(ctx, 4), Prev(P) {}
+      : ctx(ctx), Vars(ctx, 4), Prev(P), PrevDepth(P.getDepth()) {}
 
   /// Begin of scope in direction of CFG building (backwards).
   const_iterator begin() const { return const_iterator(*this, Vars.size()); }
@@ -187,19 +196,12 @@ public:
 };
 
 /// distance - Calculates distance from this to L. L must be reachable from this
-/// (with use of ++ operator). Cost of calculating the distance is linear w.r.t.
-/// number of scopes between this and L.
+/// (with use of ++ operator). The distance is the difference of the depths of
+/// the two positions, so it takes constant time.
 int LocalScope::const_iterator::distance(LocalScope::const_iterator L) {
-  int D = 0;
-  const_iterator F = *this;
-  while (F.Scope != L.Scope) {
-    assert (F != const_iterator()
-        && "L iterator is not reachable from F iterator.");
-    D += F.VarIter;
-    F = F.Scope->Prev;
-  }
-  D += F.VarIter - L.VarIter;
-  return D;
+  assert(getDepth() >= L.getDepth() &&
+         "L iterator is not reachable from F iterator.");
+  return getDepth() - L.getDepth();
 }
 
 /// BlockScopePosPair - Structure for specifying position in CFG during its
@@ -2652,8 +2654,16 @@ CFGBlock *CFGBuilder::VisitSwitchStmt(SwitchStmt *Terminator) {
   // the block for that code.
   DefaultCaseBlock = SwitchSuccessor;
 
-  // Create a new block that will contain the switch statement.
+  // Create a new block that will contain the switch statement. It gets an
+  // edge for each case and one for the default, so make room for them all
+  // up front rather than regrowing the list for huge switches.
   SwitchTerminatedBlock = createBlock(false);
+  unsigned NumEdges = 1;
+  for (const SwitchCase *SC = Terminator->getSwitchCaseList(); SC;
+       SC = SC->getNextSwitchCase())
+    ++NumEdges;
+  SwitchTerminatedBlock->reserveSuccessors(NumEdges,
+                                           cfg->getBumpVectorContext());
 
   // Now process the switch body.  The code after the switch is the implicit
   // successor.
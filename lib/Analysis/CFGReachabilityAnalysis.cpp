@@ -20,52 +20,45 @@
 using namespace clang;
 
 CFGReverseBlockReachabilityAnalysis::CFGReverseBlockReachabilityAnalysis(const CFG &cfg)
-  : analyzed(cfg.getNumBlockIDs(), false) {}
+  : reachable(cfg.getNumBlockIDs()) {}
 
 bool CFGReverseBlockReachabilityAnalysis::isReachable(const CFGBlock *Src,
                                           const CFGBlock *Dst) {
 
-  const unsigned DstBlockID = Dst->getBlockID();
+  ReachableSet &DstReachability = reachable[Dst->getBlockID()];
   
   // If we haven't analyzed the destination node, run the analysis now
-  if (!analyzed[DstBlockID]) {
+  if (DstReachability.empty())
     mapReachability(Dst);
-    analyzed[DstBlockID] = true;
-  }
   
   // Return the cached result
-  return reachable[DstBlockID][Src->getBlockID()];
+  return DstReachability[Src->getBlockID()];
 }
 
 // Maps reachability to a common node by walking the predecessors of the
 // destination node.
 void CFGReverseBlockReachabilityAnalysis::mapReachability(const CFGBlock *Dst) {
   SmallVector<const CFGBlock *, 11> worklist;
-  llvm::BitVector visited(analyzed.size());
   
+  // The set of blocks found so far doubles as the visited set of the search.
   ReachableSet &DstReachability = reachable[Dst->getBlockID()];
-  DstReachability.resize(analyzed.size(), false);
+  DstReachability.resize(reachable.size(), false);
   
-  // Start searching from the destination node, since we commonly will perform
-  // multiple queries relating to a destination node.
-  worklist.push_back(Dst);
-  bool firstRun = true;
+  // Start searching from the predecessors of the destination node, since we
+  // commonly will perform multiple queries relating to a destination node.
+  for (CFGBlock::const_pred_iterator i = Dst->pred_begin(),
+       e = Dst->pred_end(); i != e; ++i)
+    worklist.push_back(*i);
   
   while (!worklist.empty()) {    
     const CFGBlock *block = worklist.back();
     worklist.pop_back();
     
-    if (visited[block->getBlockID()])
+    if (!block || DstReachability[block->getBlockID()])
       continue;
-    visited[block->getBlockID()] = true;
-    
+
     // Update reachability information for this node -> Dst
-    if (!firstRun) {
-      // Don't insert Dst -> Dst unless it was a predecessor of itself
-      DstReachability[block->getBlockID()] = true;
-    }
-    else
-      firstRun = false;
+    DstReachability[block->getBlockID()] = true;
     
     // Add the predecessors to the worklist.
     for (CFGBlock::const_pred_iterator i = block->pred_begin(), 
@@ -73,4 +66,20 @@ void CFGReverseBlockReachabilityAnalysis::mapReachability(const CFGBlock *Dst) {
       worklist.push_back(*i);
     }
   }
+
+  // Dst is never considered to be reachable from itself.
+  DstReachability[Dst->getBlockID()] = false;
+}
+
+CFGReverseBlockReachabilityAnalysis *
+CFGReverseBlockReachabilityAnalysis::create(AnalysisDeclContext &ctx) {
+  const CFG *cfg = ctx.getCFG();
+  if (!cfg)
+    return 0;
+  return new CFGReverseBlockReachabilityAnalysis(*cfg);
+}
+
+const void *CFGReverseBlockReachabilityAnalysis::getTag() {
+  static int x;
+  return &x;
 }
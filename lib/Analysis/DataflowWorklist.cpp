@@ -0,0 +1,68 @@
+//===- DataflowWorklist.cpp - Worklist for dataflow over CFGs ---*- C++ --*-//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the worklist and the variable numbering shared by the
+// dataflow analyses over source-level CFGs.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Analysis/Analyses/DataflowWorklist.h"
+#include "clang/Analysis/CFG.h"
+#include <algorithm>
+
+using namespace clang;
+
+unsigned VarDeclNumbering::getOrAssignIndex(const VarDecl *D) {
+  std::pair<llvm::DenseMap<const VarDecl *, unsigned>::iterator, bool> Result =
+    Indices.insert(std::make_pair(D, unsigned(Decls.size())));
+  if (Result.second)
+    Decls.push_back(D);
+  return Result.first->second;
+}
+
+Optional<unsigned> VarDeclNumbering::getIndex(const VarDecl *D) const {
+  llvm::DenseMap<const VarDecl *, unsigned>::const_iterator I = Indices.find(D);
+  if (I == Indices.end())
+    return None;
+  return I->second;
+}
+
+DataflowWorklist::DataflowWorklist(const CFG &cfg, const PostOrderCFGView &POV,
+                                   Direction Dir)
+  : EnqueuedBlocks(cfg.getNumBlockIDs()), Compare(POV, Dir) {}
+
+void DataflowWorklist::enqueueBlock(const CFGBlock *Block) {
+  if (!Block || EnqueuedBlocks[Block->getBlockID()])
+    return;
+  EnqueuedBlocks[Block->getBlockID()] = true;
+  Worklist.push_back(Block);
+  std::push_heap(Worklist.begin(), Worklist.end(), Compare);
+}
+
+void DataflowWorklist::enqueueSuccessors(const CFGBlock *Block) {
+  for (CFGBlock::const_succ_iterator I = Block->succ_begin(),
+       E = Block->succ_end(); I != E; ++I)
+    enqueueBlock(*I);
+}
+
+void DataflowWorklist::enqueuePredecessors(const CFGBlock *Block) {
+  for (CFGBlock::const_pred_iterator I = Block->pred_begin(),
+       E = Block->pred_end(); I != E; ++I)
+    enqueueBlock(*I);
+}
+
+const CFGBlock *DataflowWorklist::dequeue() {
+  if (Worklist.empty())
+    return 0;
+  std::pop_heap(Worklist.begin(), Worklist.end(), Compare);
+  const CFGBlock *B = Worklist.back();
+  Worklist.pop_back();
+  EnqueuedBlocks[B->getBlockID()] = false;
+  return B;
+}
@@ -12,3 +12,13 @@
 using namespace clang;
 
 void DominatorTree::anchor() { }
+
+DominatorTree *DominatorTree::create(AnalysisDeclContext &ctx) {
+  if (!ctx.getCFG())
+    return 0;
+  DominatorTree *DT = new DominatorTree();
+  DT->buildDominatorTree(ctx);
+  return DT;
+}
+
+const void *DominatorTree::getTag() { static int x; return &x; }
@@ -14,6 +14,7 @@
 #include "clang/Analysis/Analyses/LiveVariables.h"
 #include "clang/AST/Stmt.h"
 #include "clang/AST/StmtVisitor.h"
+#include "clang/Analysis/Analyses/DataflowWorklist.h"
 #include "clang/Analysis/Analyses/PostOrderCFGView.h"
 #include "clang/Analysis/AnalysisContext.h"
 #include "clang/Analysis/CFG.h"
@@ -25,87 +26,27 @@
 
 using namespace clang;
 
-namespace {
-
-class DataflowWorklist {
-  SmallVector<const CFGBlock *, 20> worklist;
-  llvm::BitVector enqueuedBlocks;
-  PostOrderCFGView *POV;
-public:
-  DataflowWorklist(const CFG &cfg, AnalysisDeclContext &Ctx)
-    : enqueuedBlocks(cfg.getNumBlockIDs()),
-      POV(Ctx.getAnalysis<PostOrderCFGView>()) {}
-  
-  void enqueueBlock(const CFGBlock *block);
-  void enqueueSuccessors(const CFGBlock *block);
-  void enqueuePredecessors(const CFGBlock *block);
-
-  const CFGBlock *dequeue();
-
-  void sortWorklist();
-};
-
-}
-
-void DataflowWorklist::enqueueBlock(const clang::CFGBlock *block) {
-  if (block && !enqueuedBlocks[block->getBlockID()]) {
-    enqueuedBlocks[block->getBlockID()] = true;
-    worklist.push_back(block);
-  }
-}
-  
-void DataflowWorklist::enqueueSuccessors(const clang::CFGBlock *block) {
-  const unsigned OldWorklistSize = worklist.size();
-  for (CFGBlock::const_succ_iterator I = block->succ_begin(),
-       E = block->succ_end(); I != E; ++I) {
-    enqueueBlock(*I);
-  }
-
-  if (OldWorklistSize == 0 || OldWorklistSize == worklist.size())
-    return;
-
-  sortWorklist();
-}
-
-void DataflowWorklist::enqueuePredecessors(const clang::CFGBlock *block) {
-  const unsigned OldWorklistSize = worklist.size();
-  for (CFGBlock::const_pred_iterator I = block->pred_begin(),
-       E = block->pred_end(); I != E; ++I) {
-    enqueueBlock(*I);
-  }
-  
-  if (OldWorklistSize == 0 || OldWorklistSize == worklist.size())
-    return;
-
-  sortWorklist();
-}
-
-void DataflowWorklist::sortWorklist() {
-  std::sort(worklist.begin(), worklist.end(), POV->getComparator());
-}
-
-const CFGBlock *DataflowWorklist::dequeue() {
-  if (worklist.empty())
-    return 0;
-  const CFGBlock *b = worklist.back();
-  worklist.pop_back();
-  enqueuedBlocks[b->getBlockID()] = false;
-  return b;
-}
-
 namespace {
 class LiveVariablesImpl {
 public:  
   AnalysisDeclContext &analysisContext;
   std::vector<LiveVariables::LivenessValues> cfgBlockValues;
   llvm::ImmutableSet<const Stmt *>::Factory SSetFact;
-  llvm::ImmutableSet<const VarDecl *>::Factory DSetFact;
+  VarDeclNumbering declNumbering;
   llvm::DenseMap<const CFGBlock *, LiveVariables::LivenessValues> blocksEndToLiveness;
   llvm::DenseMap<const CFGBlock *, LiveVariables::LivenessValues> blocksBeginToLiveness;
   llvm::DenseMap<const Stmt *, LiveVariables::LivenessValues> stmtsToLiveness;
   llvm::DenseMap<const DeclRefExpr *, unsigned> inAssignment;
   const bool killAtAssign;
   
+  LiveVariables::LivenessValues getEmptyValues() {
+    return LiveVariables::LivenessValues(SSetFact.getEmptySet(),
+                                         llvm::BitVector(), &declNumbering);
+  }
+
+  void addLiveDecl(LiveVariables::LivenessValues &val, const VarDecl *D);
+  void removeLiveDecl(LiveVariables::LivenessValues &val, const VarDecl *D);
+
   LiveVariables::LivenessValues
   merge(LiveVariables::LivenessValues valsA,
         LiveVariables::LivenessValues valsB);
@@ -119,7 +60,7 @@ public:
   LiveVariablesImpl(AnalysisDeclContext &ac, bool KillAtAssign)
     : analysisContext(ac),
       SSetFact(false), // Do not canonicalize ImmutableSets by default.
-      DSetFact(false), // This is a *major* performance win.
+                       // This is a *major* performance win.
       killAtAssign(KillAtAssign) {}
 };
 }
@@ -137,7 +78,25 @@ bool LiveVariables::LivenessValues::isLive(const Stmt *S) const {
 }
 
 bool LiveVariables::LivenessValues::isLive(const VarDecl *D) const {
-  return liveDecls.contains(D);
+  if (!declNumbering)
+    return false;
+  Optional<unsigned> Index = declNumbering->getIndex(D);
+  return Index && *Index < liveDecls.size() && liveDecls.test(*Index);
+}
+
+void LiveVariablesImpl::addLiveDecl(LiveVariables::LivenessValues &val,
+                                    const VarDecl *D) {
+  unsigned Index = declNumbering.getOrAssignIndex(D);
+  if (Index >= val.liveDecls.size())
+    val.liveDecls.resize(declNumbering.size());
+  val.liveDecls.set(Index);
+}
+
+void LiveVariablesImpl::removeLiveDecl(LiveVariables::LivenessValues &val,
+                                       const VarDecl *D) {
+  Optional<unsigned> Index = declNumbering.getIndex(D);
+  if (Index && *Index < val.liveDecls.size())
+    val.liveDecls.reset(*Index);
 }
 
 namespace {
@@ -164,21 +123,21 @@ LiveVariablesImpl::merge(LiveVariables::LivenessValues valsA,
     SSetRefB(valsB.liveStmts.getRootWithoutRetain(), SSetFact.getTreeFactory());
                                                 
   
-  llvm::ImmutableSetRef<const VarDecl *>
-    DSetRefA(valsA.liveDecls.getRootWithoutRetain(), DSetFact.getTreeFactory()),
-    DSetRefB(valsB.liveDecls.getRootWithoutRetain(), DSetFact.getTreeFactory());
-  
-
   SSetRefA = mergeSets(SSetRefA, SSetRefB);
-  DSetRefA = mergeSets(DSetRefA, DSetRefB);
+
+  // The sets of live variables can have different sizes if variables were
+  // numbered between their computations; |= makes room for the larger one.
+  valsA.liveDecls |= valsB.liveDecls;
   
   // asImmutableSet() canonicalizes the tree, allowing us to do an easy
   // comparison afterwards.
   return LiveVariables::LivenessValues(SSetRefA.asImmutableSet(),
-                                       DSetRefA.asImmutableSet());  
+                                       valsA.liveDecls, &declNumbering);
 }
 
 bool LiveVariables::LivenessValues::equals(const LivenessValues &V) const {
+  // BitVector equality ignores trailing unset bits, so sets of different
+  // sizes compare equal if they contain the same variables.
   return liveStmts == V.liveStmts && liveDecls == V.liveDecls;
 }
 
@@ -298,8 +257,7 @@ void TransferFunctions::Visit(Stmt *S) {
       // In calls to super, include the implicit "self" pointer as being live.
       ObjCMessageExpr *CE = cast<ObjCMessageExpr>(S);
       if (CE->getReceiverKind() == ObjCMessageExpr::SuperInstance)
-        val.liveDecls = LV.DSetFact.add(val.liveDecls,
-                                        LV.analysisContext.getSelfDecl());
+        LV.addLiveDecl(val, LV.analysisContext.getSelfDecl());
       break;
     }
     case Stmt::DeclStmtClass: {
@@ -362,7 +320,7 @@ void TransferFunctions::VisitBinaryOperator(BinaryOperator *B) {
 
         if (!isAlwaysAlive(VD)) {
           // The variable is now dead.
-          val.liveDecls = LV.DSetFact.remove(val.liveDecls, VD);
+          LV.removeLiveDecl(val, VD);
         }
 
         if (observer)
@@ -379,14 +337,14 @@ void TransferFunctions::VisitBlockExpr(BlockExpr *BE) {
     const VarDecl *VD = *I;
     if (isAlwaysAlive(VD))
       continue;
-    val.liveDecls = LV.DSetFact.add(val.liveDecls, VD);
+    LV.addLiveDecl(val, VD);
   }
 }
 
 void TransferFunctions::VisitDeclRefExpr(DeclRefExpr *DR) {
   if (const VarDecl *D = dyn_cast<VarDecl>(DR->getDecl()))
     if (!isAlwaysAlive(D) && LV.inAssignment.find(DR) == LV.inAssignment.end())
-      val.liveDecls = LV.DSetFact.add(val.liveDecls, D);
+      LV.addLiveDecl(val, D);
 }
 
 void TransferFunctions::VisitDeclStmt(DeclStmt *DS) {
@@ -394,7 +352,7 @@ void TransferFunctions::VisitDeclStmt(DeclStmt *DS) {
        DI != DE; ++DI)
     if (VarDecl *VD = dyn_cast<VarDecl>(*DI)) {
       if (!isAlwaysAlive(VD))
-        val.liveDecls = LV.DSetFact.remove(val.liveDecls, VD);
+        LV.removeLiveDecl(val, VD);
     }
 }
 
@@ -412,7 +370,7 @@ void TransferFunctions::VisitObjCForCollectionStmt(ObjCForCollectionStmt *OS) {
   }
   
   if (VD) {
-    val.liveDecls = LV.DSetFact.remove(val.liveDecls, VD);
+    LV.removeLiveDecl(val, VD);
     if (observer && DR)
       observer->observerKill(DR);
   }
@@ -476,7 +434,7 @@ LiveVariablesImpl::runOnBlock(const CFGBlock *block,
 
     if (Optional<CFGAutomaticObjDtor> Dtor =
             elem.getAs<CFGAutomaticObjDtor>()) {
-      val.liveDecls = DSetFact.add(val.liveDecls, Dtor->getVarDecl());
+      addLiveDecl(val, Dtor->getVarDecl());
       continue;
     }
 
@@ -520,10 +478,10 @@ LiveVariables::computeLiveness(AnalysisDeclContext &AC,
 
   // Construct the dataflow worklist.  Enqueue the exit block as the
   // start of the analysis.
-  DataflowWorklist worklist(*cfg, AC);
+  DataflowWorklist worklist(*cfg, *AC.getAnalysis<PostOrderCFGView>(),
+                            DataflowWorklist::Backward);
   llvm::BitVector everAnalyzedBlock(cfg->getNumBlockIDs());
 
-  // FIXME: we should enqueue using post order.
   for (CFG::const_iterator it = cfg->begin(), ei = cfg->end(); it != ei; ++it) {
     const CFGBlock *block = *it;
     worklist.enqueueBlock(block);
@@ -549,15 +507,13 @@ LiveVariables::computeLiveness(AnalysisDeclContext &AC,
       }
   }
   
-  worklist.sortWorklist();
-  
   while (const CFGBlock *block = worklist.dequeue()) {
     // Determine if the block's end value has changed.  If not, we
     // have nothing left to do for this block.
     LivenessValues &prevVal = LV->blocksEndToLiveness[block];
     
     // Merge the values of all successor blocks.
-    LivenessValues val;
+    LivenessValues val = LV->getEmptyValues();
     for (CFGBlock::const_succ_iterator it = block->succ_begin(),
                                        ei = block->succ_end(); it != ei; ++it) {
       if (const CFGBlock *succ = *it) {     
@@ -615,10 +571,9 @@ void LiveVariablesImpl::dumpBlockLiveness(const SourceManager &M) {
     LiveVariables::LivenessValues vals = blocksEndToLiveness[*it];
     declVec.clear();
     
-    for (llvm::ImmutableSet<const VarDecl *>::iterator si =
-          vals.liveDecls.begin(),
-          se = vals.liveDecls.end(); si != se; ++si) {
-      declVec.push_back(*si);      
+    for (int i = vals.liveDecls.find_first(); i != -1;
+         i = vals.liveDecls.find_next(i)) {
+      declVec.push_back(declNumbering.getDecl(i));
     }
     
     std::sort(declVec.begin(), declVec.end(), compare_vd_entries);
@@ -17,13 +17,14 @@ using namespace clang;
 
 void PostOrderCFGView::anchor() { }
 
-PostOrderCFGView::PostOrderCFGView(const CFG *cfg) {
+PostOrderCFGView::PostOrderCFGView(const CFG *cfg)
+  : BlockOrder(cfg->getNumBlockIDs(), 0) {
   Blocks.reserve(cfg->getNumBlockIDs());
   CFGBlockSet BSet(cfg);
     
   for (po_iterator I = po_iterator::begin(cfg, BSet),
                    E = po_iterator::end(cfg, BSet); I != E; ++I) {
-    BlockOrder[*I] = Blocks.size() + 1;
+    BlockOrder[(*I)->getBlockID()] = Blocks.size() + 1;
     Blocks.push_back(*I);      
   }
 }
@@ -39,11 +40,6 @@ const void *PostOrderCFGView::getTag() { static int x; return &x; }
 
 bool PostOrderCFGView::BlockOrderCompare::operator()(const CFGBlock *b1,
                                                      const CFGBlock *b2) const {
-  PostOrderCFGView::BlockOrderTy::const_iterator b1It = POV.BlockOrder.find(b1);
-  PostOrderCFGView::BlockOrderTy::const_iterator b2It = POV.BlockOrder.find(b2);
-    
-  unsigned b1V = (b1It == POV.BlockOrder.end()) ? 0 : b1It->second;
-  unsigned b2V = (b2It == POV.BlockOrder.end()) ? 0 : b2It->second;
-  return b1V > b2V;
+  return POV.BlockOrder[b1->getBlockID()] > POV.BlockOrder[b2->getBlockID()];
 }
 
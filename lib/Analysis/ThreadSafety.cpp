@@ -30,6 +30,7 @@
 #include "clang/Basic/SourceManager.h"
 #include "llvm/ADT/BitVector.h"
 #include "llvm/ADT/FoldingSet.h"
+#include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/ImmutableMap.h"
 #include "llvm/ADT/PostOrderIterator.h"
 #include "llvm/ADT/SmallVector.h"
@@ -104,6 +105,7 @@ private:
     void     setSize(unsigned S) { Sz = S;    }
 
     ExprOp   kind() const { return static_cast<ExprOp>(Op); }
+    const void* data() const { return Data; }
 
     const NamedDecl* getNamedDecl() const {
       assert(Op == EOP_NVar || Op == EOP_LVar || Op == EOP_Dot);
@@ -147,6 +149,8 @@ private:
       return !(*this == Other);
     }
 
+    bool isWildcard() const { return Op == EOP_Wildcard; }
+
     bool matches(const SExprNode& Other) const {
       return (*this == Other) ||
              (Op == EOP_Wildcard) ||
@@ -187,6 +191,16 @@ private:
   // the list to be traversed as a tree.
   NodeVector NodeVec;
 
+  // A hash of the opcodes, data and arities of the nodes, which is computed
+  // once the SExpr has been built.  Lock sets are searched by comparing
+  // SExprs with every lock in the set, and the hash lets most of those
+  // comparisons fail without walking the nodes.
+  unsigned Hash;
+
+  // True if some node is a wildcard, which can match SExprs with a
+  // different hash.
+  bool HasWildcard;
+
 private:
   unsigned makeNop() {
     NodeVec.push_back(SExprNode(EOP_Nop, 0, 0));
@@ -542,8 +556,21 @@ private:
     return i + NodeVec[i].size();
   }
 
+  /// \brief Compute Hash and HasWildcard from the nodes.
+  void computeHash() {
+    Hash = 0;
+    HasWildcard = false;
+    for (unsigned i = 0, n = NodeVec.size(); i < n; ++i) {
+      const SExprNode &N = NodeVec[i];
+      Hash = llvm::hash_combine(Hash, N.kind(), N.arity(), N.data());
+      HasWildcard |= N.isWildcard();
+    }
+  }
+
 public:
-  explicit SExpr(clang::Decl::EmptyShell e) { NodeVec.clear(); }
+  explicit SExpr(clang::Decl::EmptyShell e) : Hash(0), HasWildcard(false) {
+    NodeVec.clear();
+  }
 
   /// \param MutexExp The original mutex expression within an attribute
   /// \param DeclExp An expression involving the Decl on which the attribute
@@ -553,6 +580,7 @@ public:
   SExpr(const Expr* MutexExp, const Expr *DeclExp, const NamedDecl* D,
         VarDecl *SelfDecl=0) {
     buildSExprFromExpr(MutexExp, DeclExp, D, SelfDecl);
+    computeHash();
   }
 
   /// Return true if this is a valid decl sequence.
@@ -586,17 +614,29 @@ public:
   }
 
   bool operator==(const SExpr &other) const {
-    return NodeVec == other.NodeVec;
+    return Hash == other.Hash && NodeVec == other.NodeVec;
   }
 
   bool operator!=(const SExpr &other) const {
     return !(*this == other);
   }
 
-  bool matches(const SExpr &Other, unsigned i = 0, unsigned j = 0) const {
+  bool matches(const SExpr &Other) const {
+    // Without wildcards, matching SExprs have the same nodes.
+    if (Hash != Other.Hash && !HasWildcard && !Other.HasWildcard)
+      return false;
+    return matches(Other, 0, 0);
+  }
+
+  bool matches(const SExpr &Other, unsigned i, unsigned j) const {
     if (NodeVec[i].matches(Other.NodeVec[j])) {
       unsigned ni = NodeVec[i].arity();
       unsigned nj = Other.NodeVec[j].arity();
+      // Calls with different numbers of arguments are different, unless one
+      // of them is a wildcard, which has no children.
+      if (ni != nj && !NodeVec[i].isWildcard() &&
+          !Other.NodeVec[j].isWildcard())
+        return false;
       unsigned n = (ni < nj) ? ni : nj;
       bool Result = true;
       unsigned ci = i+1;  // first child of i
@@ -22,6 +22,7 @@ TBLGEN_TABLES := \
 
 clang_basic_SRC_FILES := \
   Builtins.cpp \
+  ByteScan.cpp \
   CharInfo.cpp \
   Diagnostic.cpp \
   DiagnosticIDs.cpp \
@@ -37,9 +38,12 @@ clang_basic_SRC_FILES := \
   SourceManager.cpp \
   TargetInfo.cpp \
   Targets.cpp \
+  TimeTrace.cpp \
   TokenKinds.cpp \
   Version.cpp \
-  VersionTuple.cpp
+  VersionTuple.cpp \
+  VirtualFileSystem.cpp \
+  WorkerPool.cpp
 
 LOCAL_SRC_FILES := $(clang_basic_SRC_FILES)
 LOCAL_CFLAGS := -fno-strict-aliasing $(call-cc-cpp-option,-Qunused-arguments)
@@ -16,7 +16,9 @@
 #include "clang/Basic/LangOptions.h"
 #include "clang/Basic/TargetInfo.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/Support/MathExtras.h"
 using namespace clang;
 
 static const Builtin::Info BuiltinInfo[] = {
@@ -65,16 +67,49 @@ bool Builtin::Context::BuiltinIsSupported(const Builtin::Info &BuiltinInfo,
 /// such.
 void Builtin::Context::InitializeBuiltins(IdentifierTable &Table,
                                           const LangOptions& LangOpts) {
-  // Step #1: mark all target-independent builtins with their ID's.
+  // Size the table so that it is at most half full.
+  unsigned NumBuiltins = Builtin::FirstTSBuiltin + NumTSRecords;
+  LookupTable.assign(llvm::NextPowerOf2(2 * NumBuiltins), 0);
+
+  // Step #1: Register target-independent builtins.
   for (unsigned i = Builtin::NotBuiltin+1; i != Builtin::FirstTSBuiltin; ++i)
-    if (BuiltinIsSupported(BuiltinInfo[i], LangOpts)) {
-      Table.get(BuiltinInfo[i].Name).setBuiltinID(i);
-    }
+    if (BuiltinIsSupported(BuiltinInfo[i], LangOpts))
+      AddToLookupTable(i);
 
   // Step #2: Register target-specific builtins.
   for (unsigned i = 0, e = NumTSRecords; i != e; ++i)
     if (!LangOpts.NoBuiltin || !strchr(TSRecords[i].Attributes, 'f'))
-      Table.get(TSRecords[i].Name).setBuiltinID(i+Builtin::FirstTSBuiltin);
+      AddToLookupTable(i+Builtin::FirstTSBuiltin);
+
+  // Rather than creating an identifier for each of the thousands of builtins,
+  // let the table mark the identifiers that are actually used.
+  Table.setBuiltinLookup(this);
+}
+
+void Builtin::Context::AddToLookupTable(unsigned ID) {
+  StringRef Name = GetRecord(ID).Name;
+  unsigned Mask = LookupTable.size() - 1;
+  for (unsigned Slot = llvm::HashString(Name) & Mask; ;
+       Slot = (Slot + 1) & Mask) {
+    unsigned &Entry = LookupTable[Slot];
+    if (!Entry || Name == GetRecord(Entry).Name) {
+      Entry = ID;
+      return;
+    }
+  }
+}
+
+unsigned Builtin::Context::getBuiltinID(StringRef Name) const {
+  if (LookupTable.empty())
+    return 0;
+
+  unsigned Mask = LookupTable.size() - 1;
+  for (unsigned Slot = llvm::HashString(Name) & Mask; ;
+       Slot = (Slot + 1) & Mask) {
+    unsigned ID = LookupTable[Slot];
+    if (!ID || Name == GetRecord(ID).Name)
+      return ID;
+  }
 }
 
 void
@@ -0,0 +1,238 @@
+//===--- ByteScan.cpp - Vectorized scans over source buffers --------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file implements the byte scanning primitives declared in ByteScan.h.
+//
+//  Each supported instruction set provides the same handful of operations on
+//  a "vector" of VecSize bytes; the scans themselves are written once in terms
+//  of those operations and finish with a scalar loop for the tail.  The
+//  instruction set is selected when clang itself is compiled.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Basic/ByteScan.h"
+#include "clang/Basic/CharInfo.h"
+#include "llvm/Support/DataTypes.h"
+#include "llvm/Support/MathExtras.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define CLANG_BYTESCAN_VECTORS 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define CLANG_BYTESCAN_VECTORS 1
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define CLANG_BYTESCAN_VECTORS 1
+#elif defined(__ALTIVEC__)
+#include <altivec.h>
+#undef bool
+#define CLANG_BYTESCAN_VECTORS 1
+#endif
+
+using namespace clang;
+
+#ifdef CLANG_BYTESCAN_VECTORS
+namespace {
+#if defined(__AVX2__)
+typedef __m256i Vec;
+enum { VecSize = 32 };
+const char *const ImplementationName = "avx2";
+
+inline Vec load(const char *P) {
+  return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(P));
+}
+inline Vec splat(char C) { return _mm256_set1_epi8(C); }
+inline Vec equal(Vec A, Vec B) { return _mm256_cmpeq_epi8(A, B); }
+inline Vec either(Vec A, Vec B) { return _mm256_or_si256(A, B); }
+
+/// Marks the bytes of \p X in [Lo, Hi]. There are no unsigned byte compares,
+/// so bias the range to start at -128 and use a signed compare instead.
+inline Vec inRange(Vec X, unsigned char Lo, unsigned char Hi) {
+  Vec Biased = _mm256_add_epi8(X, splat(char(0x80 - Lo)));
+  return _mm256_cmpgt_epi8(splat(char(Hi - Lo + 1 - 0x80)), Biased);
+}
+
+/// Returns the index of the first marked byte of \p M, or VecSize.
+inline unsigned firstSet(Vec M) {
+  uint32_t Mask = _mm256_movemask_epi8(M);
+  return Mask ? llvm::countTrailingZeros(Mask) : VecSize;
+}
+/// Returns the index of the first unmarked byte of \p M, or VecSize.
+inline unsigned firstClear(Vec M) {
+  uint32_t Mask = ~uint32_t(_mm256_movemask_epi8(M));
+  return Mask ? llvm::countTrailingZeros(Mask) : VecSize;
+}
+#elif defined(__SSE2__)
+typedef __m128i Vec;
+enum { VecSize = 16 };
+const char *const ImplementationName = "sse2";
+
+inline Vec load(const char *P) {
+  return _mm_loadu_si128(reinterpret_cast<const __m128i *>(P));
+}
+inline Vec splat(char C) { return _mm_set1_epi8(C); }
+inline Vec equal(Vec A, Vec B) { return _mm_cmpeq_epi8(A, B); }
+inline Vec either(Vec A, Vec B) { return _mm_or_si128(A, B); }
+
+inline Vec inRange(Vec X, unsigned char Lo, unsigned char Hi) {
+  Vec Biased = _mm_add_epi8(X, splat(char(0x80 - Lo)));
+  return _mm_cmplt_epi8(Biased, splat(char(Hi - Lo + 1 - 0x80)));
+}
+
+inline unsigned firstSet(Vec M) {
+  uint32_t Mask = _mm_movemask_epi8(M);
+  return Mask ? llvm::countTrailingZeros(Mask) : VecSize;
+}
+inline unsigned firstClear(Vec M) {
+  uint32_t Mask = ~uint32_t(_mm_movemask_epi8(M)) & 0xFFFF;
+  return Mask ? llvm::countTrailingZeros(Mask) : VecSize;
+}
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+typedef uint8x16_t Vec;
+enum { VecSize = 16 };
+const char *const ImplementationName = "neon";
+
+inline Vec load(const char *P) {
+  return vld1q_u8(reinterpret_cast<const uint8_t *>(P));
+}
+inline Vec splat(char C) { return vdupq_n_u8(C); }
+inline Vec equal(Vec A, Vec B) { return vceqq_u8(A, B); }
+inline Vec either(Vec A, Vec B) { return vorrq_u8(A, B); }
+
+inline Vec inRange(Vec X, unsigned char Lo, unsigned char Hi) {
+  return vcleq_u8(vsubq_u8(X, vdupq_n_u8(Lo)), vdupq_n_u8(Hi - Lo));
+}
+
+/// NEON has no movemask; narrowing each 16-bit lane by four bits leaves one
+/// nibble per byte in a 64-bit scalar instead.
+inline unsigned firstSet(Vec M) {
+  uint8x8_t Narrowed = vshrn_n_u16(vreinterpretq_u16_u8(M), 4);
+  uint64_t Mask = vget_lane_u64(vreinterpret_u64_u8(Narrowed), 0);
+  return Mask ? llvm::countTrailingZeros(Mask) / 4 : VecSize;
+}
+inline unsigned firstClear(Vec M) { return firstSet(vmvnq_u8(M)); }
+#else
+typedef __vector unsigned char Vec;
+enum { VecSize = 16 };
+const char *const ImplementationName = "altivec";
+
+inline Vec load(const char *P) {
+  return vec_perm(vec_ld(0, reinterpret_cast<const unsigned char *>(P)),
+                  vec_ld(15, reinterpret_cast<const unsigned char *>(P)),
+                  vec_lvsl(0, reinterpret_cast<const unsigned char *>(P)));
+}
+inline Vec splat(char C) {
+  unsigned char U = C;
+  Vec V = { U, U, U, U, U, U, U, U, U, U, U, U, U, U, U, U };
+  return V;
+}
+inline Vec equal(Vec A, Vec B) { return (Vec)vec_cmpeq(A, B); }
+inline Vec either(Vec A, Vec B) { return vec_or(A, B); }
+
+inline Vec inRange(Vec X, unsigned char Lo, unsigned char Hi) {
+  return vec_and((Vec)vec_cmpgt(X, splat(Lo - 1)),
+                 (Vec)vec_cmplt(X, splat(Hi + 1)));
+}
+
+/// AltiVec can cheaply tell whether any byte matched, but not which one, so
+/// find the byte with a scalar loop once a match is known to exist.
+inline unsigned firstSet(Vec M) {
+  if (vec_all_eq(M, splat(0)))
+    return VecSize;
+  union { Vec V; unsigned char Bytes[VecSize]; } U;
+  U.V = M;
+  unsigned I = 0;
+  while (!U.Bytes[I])
+    ++I;
+  return I;
+}
+inline unsigned firstClear(Vec M) { return firstSet(vec_nor(M, M)); }
+#endif
+
+inline Vec isLineEnd(Vec X) {
+  return either(either(equal(X, splat('\n')), equal(X, splat('\r'))),
+                equal(X, splat('\0')));
+}
+
+inline Vec isHorzWhitespace(Vec X) {
+  // '\t', '\v' and '\f' surround '\n', so this can't be a range check.
+  return either(either(equal(X, splat(' ')), equal(X, splat('\t'))),
+                either(equal(X, splat('\f')), equal(X, splat('\v'))));
+}
+
+inline Vec isIdentBody(Vec X) {
+  // Setting bit 5 folds 'A'-'Z' onto 'a'-'z' without admitting anything else.
+  Vec Letters = inRange(either(X, splat(0x20)), 'a', 'z');
+  return either(either(Letters, inRange(X, '0', '9')), equal(X, splat('_')));
+}
+} // end anonymous namespace
+#endif
+
+const char *clang::scanForByte(const char *Ptr, const char *End, char C) {
+#ifdef CLANG_BYTESCAN_VECTORS
+  Vec Cs = splat(C);
+  for (; End - Ptr >= VecSize; Ptr += VecSize) {
+    unsigned I = firstSet(equal(load(Ptr), Cs));
+    if (I != VecSize)
+      return Ptr + I;
+  }
+#endif
+  while (Ptr != End && *Ptr != C)
+    ++Ptr;
+  return Ptr;
+}
+
+const char *clang::scanForLineEnd(const char *Ptr, const char *End) {
+#ifdef CLANG_BYTESCAN_VECTORS
+  for (; End - Ptr >= VecSize; Ptr += VecSize) {
+    unsigned I = firstSet(isLineEnd(load(Ptr)));
+    if (I != VecSize)
+      return Ptr + I;
+  }
+#endif
+  while (Ptr != End && *Ptr != '\n' && *Ptr != '\r' && *Ptr != '\0')
+    ++Ptr;
+  return Ptr;
+}
+
+const char *clang::skipHorizontalWhitespace(const char *Ptr,
+                                            const char *End) {
+#ifdef CLANG_BYTESCAN_VECTORS
+  for (; End - Ptr >= VecSize; Ptr += VecSize) {
+    unsigned I = firstClear(isHorzWhitespace(load(Ptr)));
+    if (I != VecSize)
+      return Ptr + I;
+  }
+#endif
+  while (Ptr != End && isHorizontalWhitespace(*Ptr))
+    ++Ptr;
+  return Ptr;
+}
+
+const char *clang::skipIdentifierBody(const char *Ptr, const char *End) {
+#ifdef CLANG_BYTESCAN_VECTORS
+  for (; End - Ptr >= VecSize; Ptr += VecSize) {
+    unsigned I = firstClear(isIdentBody(load(Ptr)));
+    if (I != VecSize)
+      return Ptr + I;
+  }
+#endif
+  while (Ptr != End && isIdentifierBody(*Ptr))
+    ++Ptr;
+  return Ptr;
+}
+
+const char *clang::getByteScanImplementationName() {
+#ifdef CLANG_BYTESCAN_VECTORS
+  return ImplementationName;
+#else
+  return "scalar";
+#endif
+}
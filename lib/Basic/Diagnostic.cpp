@@ -16,6 +16,7 @@
 #include "clang/Basic/DiagnosticOptions.h"
 #include "clang/Basic/IdentifierTable.h"
 #include "clang/Basic/PartialDiagnostic.h"
+#include "clang/Basic/SourceManager.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/Support/CrashRecoveryContext.h"
@@ -115,6 +116,8 @@ void DiagnosticsEngine::Reset() {
   DiagStates.clear();
   DiagStatePoints.clear();
   DiagStateOnPushStack.clear();
+  invalidateDiagStateFiles();
+  GroupIgnoredCache.clear();
 
   // Create a DiagState and DiagStatePoint representing diagnostic changes
   // through command-line.
@@ -162,6 +165,79 @@ DiagnosticsEngine::GetDiagStatePointForLoc(SourceLocation L) const {
   return Pos;
 }
 
+DiagnosticsEngine::DiagState *
+DiagnosticsEngine::DiagStateFile::lookup(unsigned Offset) const {
+  if (!HasLocalTransitions)
+    return Parent->lookup(ParentOffset);
+
+  assert(!Transitions.empty() && Transitions.front().first == 0);
+  return (std::upper_bound(Transitions.begin(), Transitions.end(), Offset,
+                           DiagStateFile::isBeforeTransition) - 1)->second;
+}
+
+DiagnosticsEngine::DiagStateFile *
+DiagnosticsEngine::getDiagStateFile(FileID ID) const {
+  std::map<FileID, DiagStateFile>::iterator Known = DiagStateFiles.find(ID);
+  if (Known != DiagStateFiles.end())
+    return &Known->second;
+
+  // The imaginary root file is created with the command-line state.
+  assert(ID.isValid() && "Root of the diagnostic state index is missing");
+  std::pair<FileID, unsigned> Included =
+    SourceMgr->getDecomposedIncludedLoc(ID);
+  DiagStateFile *Parent = getDiagStateFile(Included.first);
+
+  DiagStateFile &F = DiagStateFiles[ID];
+  F.Parent = Parent;
+  F.ParentOffset = Included.second;
+  F.Transitions.push_back(std::make_pair(0u, Parent->lookup(F.ParentOffset)));
+  return &F;
+}
+
+void DiagnosticsEngine::updateDiagStateFiles() const {
+  for (unsigned I = NumIndexedDiagStatePoints, E = DiagStatePoints.size();
+       I != E; ++I) {
+    const DiagStatePoint &Point = DiagStatePoints[I];
+    if (Point.Loc.isInvalid()) {
+      // The command-line state, at the start of the imaginary root file.
+      DiagStateFile &Root = DiagStateFiles[FileID()];
+      Root.HasLocalTransitions = true;
+      Root.Transitions.clear();
+      Root.Transitions.push_back(std::make_pair(0u, Point.State));
+      continue;
+    }
+
+    // A diagnostic pragma in a file also changes the state of the files
+    // including it, from the point of the include onwards.
+    std::pair<FileID, unsigned> Decomp =
+      SourceMgr->getDecomposedExpansionLoc(Point.Loc);
+    unsigned Offset = Decomp.second;
+    for (DiagStateFile *F = getDiagStateFile(Decomp.first); F;
+         Offset = F->ParentOffset, F = F->Parent) {
+      F->HasLocalTransitions = true;
+      std::pair<unsigned, DiagState *> *Pos =
+        std::upper_bound(F->Transitions.begin(), F->Transitions.end(), Offset,
+                         DiagStateFile::isBeforeTransition);
+      if ((Pos - 1)->first == Offset)
+        (Pos - 1)->second = Point.State;
+      else
+        F->Transitions.insert(Pos, std::make_pair(Offset, Point.State));
+    }
+  }
+  NumIndexedDiagStatePoints = DiagStatePoints.size();
+}
+
+DiagnosticsEngine::DiagState *
+DiagnosticsEngine::GetDiagStateForLoc(SourceLocation L) const {
+  assert(!DiagStatePoints.empty());
+  if (!SourceMgr || L.isInvalid())
+    return GetCurDiagState();
+
+  updateDiagStateFiles();
+  std::pair<FileID, unsigned> Decomp = SourceMgr->getDecomposedExpansionLoc(L);
+  return getDiagStateFile(Decomp.first)->lookup(Decomp.second);
+}
+
 void DiagnosticsEngine::setDiagnosticMapping(diag::kind Diag, diag::Mapping Map,
                                              SourceLocation L) {
   assert(Diag < diag::DIAG_UPPER_LIMIT &&
@@ -171,6 +247,7 @@ void DiagnosticsEngine::setDiagnosticMapping(diag::kind Diag, diag::Mapping Map,
          "Cannot map errors into warnings!");
   assert(!DiagStatePoints.empty());
   assert((L.isInvalid() || SourceMgr) && "No SourceMgr for valid location");
+  GroupIgnoredCache.clear();
 
   FullSourceLoc Loc = SourceMgr? FullSourceLoc(L, *SourceMgr) : FullSourceLoc();
   FullSourceLoc LastStateChangePos = DiagStatePoints.back().Loc;
@@ -228,6 +305,7 @@ void DiagnosticsEngine::setDiagnosticMapping(diag::kind Diag, diag::Mapping Map,
   GetCurDiagState()->setMappingInfo(Diag, MappingInfo);
   DiagStatePoints.insert(Pos+1, DiagStatePoint(NewState,
                                                FullSourceLoc(Loc, *SourceMgr)));
+  invalidateDiagStateFiles();
 }
 
 bool DiagnosticsEngine::setDiagnosticGroupMapping(
@@ -247,6 +325,8 @@ bool DiagnosticsEngine::setDiagnosticGroupMapping(
 
 void DiagnosticsEngine::setDiagnosticWarningAsError(diag::kind Diag,
                                                     bool Enabled) {
+  GroupIgnoredCache.clear();
+
   // If we are enabling this feature, just set the diagnostic mappings to map to
   // errors.
   if (Enabled) 
@@ -272,6 +352,7 @@ bool DiagnosticsEngine::setDiagnosticGroupWarningAsError(StringRef Group,
 
   // Otherwise, we want to set the diagnostic mapping's "no Werror" bit, and
   // potentially downgrade anything already mapped to be a warning.
+  GroupIgnoredCache.clear();
 
   // Get the diagnostics in this group.
   SmallVector<diag::kind, 8> GroupDiags;
@@ -295,6 +376,8 @@ bool DiagnosticsEngine::setDiagnosticGroupWarningAsError(StringRef Group,
 
 void DiagnosticsEngine::setDiagnosticErrorAsFatal(diag::kind Diag,
                                                   bool Enabled) {
+  GroupIgnoredCache.clear();
+
   // If we are enabling this feature, just set the diagnostic mappings to map to
   // errors.
   if (Enabled)
@@ -319,6 +402,7 @@ bool DiagnosticsEngine::setDiagnosticGroupErrorAsFatal(StringRef Group,
 
   // Otherwise, we want to set the diagnostic mapping's "no Werror" bit, and
   // potentially downgrade anything already mapped to be an error.
+  GroupIgnoredCache.clear();
 
   // Get the diagnostics in this group.
   SmallVector<diag::kind, 8> GroupDiags;
@@ -403,18 +403,48 @@ DiagnosticIDs::Level
 DiagnosticIDs::getDiagnosticLevel(unsigned DiagID, unsigned DiagClass,
                                   SourceLocation Loc,
                                   const DiagnosticsEngine &Diag) const {
-  // Specific non-error diagnostics may be mapped to various levels from ignored
-  // to error.  Errors can only be mapped to fatal.
-  DiagnosticIDs::Level Result = DiagnosticIDs::Fatal;
+  // Ignore -pedantic diagnostics inside __extension__ blocks.
+  // (The diagnostics controlled by -pedantic are the extension diagnostics
+  // that are not enabled by default.)
+  bool EnabledByDefault = false;
+  bool IsExtensionDiag = isBuiltinExtensionDiag(DiagID, EnabledByDefault);
+  if (Diag.AllExtensionsSilenced && IsExtensionDiag && !EnabledByDefault)
+    return DiagnosticIDs::Ignored;
 
-  DiagnosticsEngine::DiagStatePointsTy::iterator
-    Pos = Diag.GetDiagStatePointForLoc(Loc);
-  DiagnosticsEngine::DiagState *State = Pos->State;
+  DiagnosticsEngine::DiagState *State = Diag.GetDiagStateForLoc(Loc);
 
   // Get the mapping information, or compute it lazily.
   DiagnosticMappingInfo &MappingInfo = State->getOrAddMappingInfo(
     (diag::kind)DiagID);
 
+  DiagnosticIDs::Level Result = getMappedLevel(DiagID, IsExtensionDiag,
+                                               MappingInfo, Diag);
+
+  // If we are in a system header, we ignore it. We look at the diagnostic class
+  // because we also want to ignore extensions and warnings in -Werror and
+  // -pedantic-errors modes, which *map* warnings/extensions to errors.
+  if (Result >= DiagnosticIDs::Warning &&
+      DiagClass != CLASS_ERROR &&
+      // Custom diagnostics always are emitted in system headers.
+      DiagID < diag::DIAG_UPPER_LIMIT &&
+      !MappingInfo.hasShowInSystemHeader() &&
+      Diag.SuppressSystemWarnings &&
+      Loc.isValid() &&
+      Diag.getSourceManager().isInSystemHeader(
+          Diag.getSourceManager().getExpansionLoc(Loc)))
+    return DiagnosticIDs::Ignored;
+
+  return Result;
+}
+
+DiagnosticIDs::Level
+DiagnosticIDs::getMappedLevel(unsigned DiagID, bool IsExtensionDiag,
+                              const DiagnosticMappingInfo &MappingInfo,
+                              const DiagnosticsEngine &Diag) const {
+  // Specific non-error diagnostics may be mapped to various levels from ignored
+  // to error.  Errors can only be mapped to fatal.
+  DiagnosticIDs::Level Result = DiagnosticIDs::Fatal;
+
   switch (MappingInfo.getMapping()) {
   case diag::MAP_IGNORE:
     Result = DiagnosticIDs::Ignored;
@@ -435,14 +465,6 @@ DiagnosticIDs::getDiagnosticLevel(unsigned DiagID, unsigned DiagClass,
       !MappingInfo.isUser())
     Result = DiagnosticIDs::Warning;
 
-  // Ignore -pedantic diagnostics inside __extension__ blocks.
-  // (The diagnostics controlled by -pedantic are the extension diagnostics
-  // that are not enabled by default.)
-  bool EnabledByDefault = false;
-  bool IsExtensionDiag = isBuiltinExtensionDiag(DiagID, EnabledByDefault);
-  if (Diag.AllExtensionsSilenced && IsExtensionDiag && !EnabledByDefault)
-    return DiagnosticIDs::Ignored;
-
   // For extension diagnostics that haven't been explicitly mapped, check if we
   // should upgrade the diagnostic.
   if (IsExtensionDiag && !MappingInfo.isUser()) {
@@ -484,23 +506,55 @@ DiagnosticIDs::getDiagnosticLevel(unsigned DiagID, unsigned DiagClass,
       Result = DiagnosticIDs::Fatal;
   }
 
-  // If we are in a system header, we ignore it. We look at the diagnostic class
-  // because we also want to ignore extensions and warnings in -Werror and
-  // -pedantic-errors modes, which *map* warnings/extensions to errors.
-  if (Result >= DiagnosticIDs::Warning &&
-      DiagClass != CLASS_ERROR &&
-      // Custom diagnostics always are emitted in system headers.
-      DiagID < diag::DIAG_UPPER_LIMIT &&
-      !MappingInfo.hasShowInSystemHeader() &&
-      Diag.SuppressSystemWarnings &&
-      Loc.isValid() &&
-      Diag.getSourceManager().isInSystemHeader(
-          Diag.getSourceManager().getExpansionLoc(Loc)))
-    return DiagnosticIDs::Ignored;
-
   return Result;
 }
 
+bool DiagnosticIDs::isDiagnosticGroupIgnored(
+    StringRef Group, SourceLocation Loc,
+    const DiagnosticsEngine &Diag) const {
+  DiagnosticsEngine::DiagState *State = Diag.GetDiagStateForLoc(Loc);
+
+  // The options that getMappedLevel() looks at for whether a diagnostic is
+  // ignored. Mapping changes clear the cache instead.
+  unsigned Options = Diag.IgnoreAllWarnings | (Diag.EnableAllWarnings << 1) |
+                     (Diag.ExtBehavior << 2);
+  DiagnosticsEngine::GroupIgnoredStatesTy &States =
+    Diag.GroupIgnoredCache[Group];
+  std::pair<DiagnosticsEngine::GroupIgnoredStatesTy::iterator, bool> Known =
+    States.insert(std::make_pair(std::make_pair(State, Options), 0u));
+  unsigned &Ignored = Known.first->second;
+  if (Known.second) {
+    SmallVector<diag::kind, 32> GroupDiags;
+    if (getDiagnosticsInGroup(Group, GroupDiags))
+      return false;
+
+    // Extensions silenced by __extension__ don't count, since that changes
+    // within a state.
+    Ignored = DiagnosticsEngine::GroupIgnored |
+              DiagnosticsEngine::GroupIgnoredInSystemHeaders;
+    for (unsigned I = 0, E = GroupDiags.size(); I != E && Ignored; ++I) {
+      DiagnosticMappingInfo &MappingInfo =
+        State->getOrAddMappingInfo(GroupDiags[I]);
+      Level Result = getMappedLevel(GroupDiags[I],
+                                    isBuiltinExtensionDiag(GroupDiags[I]),
+                                    MappingInfo, Diag);
+      if (Result == DiagnosticIDs::Ignored)
+        continue;
+      Ignored &= ~DiagnosticsEngine::GroupIgnored;
+      if (getBuiltinDiagClass(GroupDiags[I]) == CLASS_ERROR ||
+          MappingInfo.hasShowInSystemHeader())
+        Ignored &= ~DiagnosticsEngine::GroupIgnoredInSystemHeaders;
+    }
+  }
+
+  if (Ignored & DiagnosticsEngine::GroupIgnored)
+    return true;
+  return (Ignored & DiagnosticsEngine::GroupIgnoredInSystemHeaders) &&
+         Diag.SuppressSystemWarnings && Loc.isValid() &&
+         Diag.getSourceManager().isInSystemHeader(
+             Diag.getSourceManager().getExpansionLoc(Loc));
+}
+
 struct clang::WarningOption {
   // Be safe with the size of 'NameLen' because we don't statically check if
   // the size will fit in the field; the struct size won't decrease with a
@@ -151,13 +151,61 @@ void FileManager::removeStatCache(FileSystemStatCache *statCache) {
     PrevCache = PrevCache->getNextStatCache();
   
   assert(PrevCache && "Stat cache not found for removal");
-  PrevCache->setNextStatCache(statCache->getNextStatCache());
+  PrevCache->setNextStatCache(statCache->takeNextStatCache());
 }
 
 void FileManager::clearStatCaches() {
   StatCache.reset(0);
 }
 
+void FileManager::flushStatCaches() {
+  if (StatCache)
+    StatCache->flush();
+}
+
+/// \brief Describe \p File in the form that the stat caches record, and find
+/// its absolute path. Returns false if the file should not be described to
+/// the caches.
+static bool getCacheableFileData(const FileManager &FileMgr,
+                                 const FileEntry *File,
+                                 SmallVectorImpl<char> &Path,
+                                 FileData &Data) {
+  if (File->isInPCH())
+    return false;
+  StringRef Name(File->getName());
+  Path.append(Name.begin(), Name.end());
+  FileMgr.FixupRelativePath(Path);
+  if (llvm::sys::fs::make_absolute(Path))
+    return false;
+  Data.Size = File->getSize();
+  Data.ModTime = File->getModificationTime();
+  Data.UniqueID = File->getUniqueID();
+  Data.IsDirectory = false;
+  Data.IsNamedPipe = false;
+  Data.InPCH = false;
+  return true;
+}
+
+bool FileManager::getCachedControllingMacro(const FileEntry *File,
+                                            std::string &Macro) {
+  if (!StatCache || File->IsNamedPipe)
+    return false;
+  SmallString<256> Path;
+  FileData Data;
+  return getCacheableFileData(*this, File, Path, Data) &&
+         StatCache->getControllingMacro(Path, Data, Macro);
+}
+
+void FileManager::setCachedControllingMacro(const FileEntry *File,
+                                            StringRef Macro) {
+  if (!StatCache || File->IsNamedPipe)
+    return;
+  SmallString<256> Path;
+  FileData Data;
+  if (getCacheableFileData(*this, File, Path, Data))
+    StatCache->setControllingMacro(Path, Data, Macro);
+}
+
 /// \brief Retrieve the directory that the given file name resides in.
 /// Filename can point to either a real file or a virtual file.
 static const DirectoryEntry *getDirectoryFromFile(FileManager &FileMgr,
@@ -456,6 +504,13 @@ getBufferForFile(const FileEntry *Entry, std::string *ErrorStr,
 
   // Otherwise, open the file.
 
+  if (FS) {
+    SmallString<128> FilePath(Entry->getName());
+    FixupRelativePath(FilePath);
+    return FS->getBuffer(FilePath.str(), ErrorStr, FileSize,
+                         /*RequiresNullTerminator=*/true);
+  }
+
   if (FileSystemOpts.WorkingDir.empty()) {
     ec = llvm::MemoryBuffer::getFile(Filename, Result, FileSize);
     if (ec && ErrorStr)
@@ -472,11 +527,20 @@ getBufferForFile(const FileEntry *Entry, std::string *ErrorStr,
 }
 
 llvm::MemoryBuffer *FileManager::
-getBufferForFile(StringRef Filename, std::string *ErrorStr) {
+getBufferForFile(StringRef Filename, std::string *ErrorStr,
+                 bool RequiresNullTerminator) {
   OwningPtr<llvm::MemoryBuffer> Result;
   llvm::error_code ec;
+  if (FS) {
+    SmallString<128> FilePath(Filename);
+    FixupRelativePath(FilePath);
+    return FS->getBuffer(FilePath.str(), ErrorStr, /*FileSize=*/-1,
+                         RequiresNullTerminator);
+  }
+
   if (FileSystemOpts.WorkingDir.empty()) {
-    ec = llvm::MemoryBuffer::getFile(Filename, Result);
+    ec = llvm::MemoryBuffer::getFile(Filename, Result, /*FileSize=*/-1,
+                                     RequiresNullTerminator);
     if (ec && ErrorStr)
       *ErrorStr = ec.message();
     return Result.take();
@@ -484,7 +548,8 @@ getBufferForFile(StringRef Filename, std::string *ErrorStr) {
 
   SmallString<128> FilePath(Filename);
   FixupRelativePath(FilePath);
-  ec = llvm::MemoryBuffer::getFile(FilePath.c_str(), Result);
+  ec = llvm::MemoryBuffer::getFile(FilePath.c_str(), Result, /*FileSize=*/-1,
+                                   RequiresNullTerminator);
   if (ec && ErrorStr)
     *ErrorStr = ec.message();
   return Result.take();
@@ -497,6 +562,13 @@ getBufferForFile(StringRef Filename, std::string *ErrorStr) {
 /// do directory look-up instead of file look-up.
 bool FileManager::getStatValue(const char *Path, FileData &Data, bool isFile,
                                int *FileDescriptor) {
+  // A virtual file system never hands out file descriptors.
+  if (FS) {
+    SmallString<128> FilePath(Path);
+    FixupRelativePath(FilePath);
+    return FS->getStatus(FilePath.str(), Data, isFile);
+  }
+
   // FIXME: FileSystemOpts shouldn't be passed in here, all paths should be
   // absolute!
   if (FileSystemOpts.WorkingDir.empty())
@@ -590,6 +662,8 @@ void FileManager::PrintStats() const {
                << NumDirCacheMisses << " dir cache misses.\n";
   llvm::errs() << NumFileLookups << " file lookups, "
                << NumFileCacheMisses << " file cache misses.\n";
+  if (StatCache)
+    StatCache->PrintStats();
 
   //llvm::errs() << PagesMapped << BytesOfPagesMapped << FSLookups;
 }
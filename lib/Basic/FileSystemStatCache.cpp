@@ -12,8 +12,13 @@
 //===----------------------------------------------------------------------===//
 
 #include "clang/Basic/FileSystemStatCache.h"
+#include "clang/Basic/OnDiskHashTable.h"
+#include "llvm/ADT/SmallString.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+#include <cstring>
+#include <ctime>
 
 // FIXME: This is terrible, we need this for ::close.
 #if !defined(_MSC_VER) && !defined(__MINGW32__)
@@ -134,3 +139,332 @@ MemorizeStatCalls::getStat(const char *Path, FileData &Data, bool isFile,
 
   return Result;
 }
+
+//===----------------------------------------------------------------------===//
+// PersistentStatCache
+//===----------------------------------------------------------------------===//
+
+// The cache file starts with this magic number, which is followed by the
+// payload of an on-disk hash table, the table's bucket array and finally the
+// 32-bit offset of that bucket array.
+static const char PersistentStatCacheMagic[4] = { 'C', 'S', 'T', 'C' };
+
+namespace {
+/// \brief The kinds of entry in the cache file, as stored in its first byte.
+enum PersistentStatEntryKind {
+  EntryMissing = 0,
+  EntryDirectory = 1,
+  /// \brief An existing file, followed by the name of its guard macro.
+  EntryGuardedFile = 2
+};
+
+class PersistentStatTrait {
+public:
+  typedef const char *external_key_type;
+  typedef const char *internal_key_type;
+  typedef StringRef key_type;
+  typedef StringRef key_type_ref;
+  typedef PersistentStatCache::Entry data_type;
+  typedef const PersistentStatCache::Entry &data_type_ref;
+
+  static unsigned ComputeHash(StringRef Key) {
+    return llvm::HashString(Key);
+  }
+
+  static internal_key_type GetInternalKey(external_key_type Key) {
+    return Key;
+  }
+
+  static external_key_type GetExternalKey(internal_key_type Key) {
+    return Key;
+  }
+
+  static bool EqualKey(internal_key_type A, internal_key_type B) {
+    return strcmp(A, B) == 0;
+  }
+
+  static std::pair<unsigned, unsigned>
+  EmitKeyDataLength(raw_ostream &Out, StringRef Key, data_type_ref E) {
+    unsigned KeyLen = Key.size() + 1;
+    unsigned DataLen = 2 + 8 + (E.Exists ? 4 * 8 : 0) +
+                       E.ControllingMacro.size();
+    io::Emit16(Out, KeyLen);
+    io::Emit8(Out, DataLen);
+    return std::make_pair(KeyLen, DataLen);
+  }
+
+  static void EmitKey(raw_ostream &Out, StringRef Key, unsigned) {
+    Out.write(Key.data(), Key.size());
+    io::Emit8(Out, 0);
+  }
+
+  static void EmitData(raw_ostream &Out, StringRef, data_type_ref E,
+                       unsigned) {
+    io::Emit8(Out, !E.Exists ? EntryMissing
+                             : E.Data.IsDirectory ? EntryDirectory
+                                                  : EntryGuardedFile);
+    io::Emit8(Out, E.ParentExists);
+    io::Emit64(Out, E.ParentModTime);
+    if (E.Exists) {
+      io::Emit64(Out, E.Data.UniqueID.getDevice());
+      io::Emit64(Out, E.Data.UniqueID.getFile());
+      io::Emit64(Out, E.Data.ModTime);
+      io::Emit64(Out, E.Data.Size);
+    }
+    Out.write(E.ControllingMacro.data(), E.ControllingMacro.size());
+  }
+
+  static std::pair<unsigned, unsigned>
+  ReadKeyDataLength(const unsigned char *&D) {
+    unsigned KeyLen = io::ReadUnalignedLE16(D);
+    unsigned DataLen = *D++;
+    return std::make_pair(KeyLen, DataLen);
+  }
+
+  static internal_key_type ReadKey(const unsigned char *D, unsigned) {
+    return reinterpret_cast<const char *>(D);
+  }
+
+  static data_type ReadData(internal_key_type, const unsigned char *D,
+                            unsigned DataLen) {
+    const unsigned char *End = D + DataLen;
+    data_type E;
+    unsigned Kind = *D++;
+    E.Exists = Kind != EntryMissing;
+    E.ParentExists = *D++;
+    E.ParentModTime = io::ReadUnalignedLE64(D);
+    if (E.Exists) {
+      uint64_t Device = io::ReadUnalignedLE64(D);
+      uint64_t File = io::ReadUnalignedLE64(D);
+      E.Data.UniqueID = llvm::sys::fs::UniqueID(Device, File);
+      E.Data.ModTime = io::ReadUnalignedLE64(D);
+      E.Data.Size = io::ReadUnalignedLE64(D);
+      E.Data.IsDirectory = Kind == EntryDirectory;
+      E.Data.IsNamedPipe = false;
+      E.Data.InPCH = false;
+    }
+    if (D < End)
+      E.ControllingMacro.assign(reinterpret_cast<const char *>(D), End - D);
+    return E;
+  }
+};
+
+typedef OnDiskChainedHashTable<PersistentStatTrait> PersistentStatTable;
+}
+
+/// \brief Returns the hash table stored in \p Buffer, or null if the buffer
+/// does not hold a valid cache.
+static PersistentStatTable *loadPersistentStatTable(
+    const llvm::MemoryBuffer &Buffer) {
+  const unsigned char *Start =
+      reinterpret_cast<const unsigned char *>(Buffer.getBufferStart());
+  size_t Size = Buffer.getBufferSize();
+  if (Size < sizeof(PersistentStatCacheMagic) + 12 ||
+      memcmp(Start, PersistentStatCacheMagic, sizeof(PersistentStatCacheMagic)))
+    return 0;
+
+  const unsigned char *Trailer = Start + Size - 4;
+  uint32_t TableOffset = io::ReadUnalignedLE32(Trailer);
+  if (TableOffset % 4 != 0 || TableOffset + 8 > Size - 4)
+    return 0;
+  const unsigned char *Buckets = Start + TableOffset;
+  const unsigned char *Header = Buckets;
+  uint64_t NumBuckets = io::ReadUnalignedLE32(Header);
+  if (TableOffset + 8 + NumBuckets * 4 != Size - 4)
+    return 0;
+  return PersistentStatTable::Create(Buckets, Start);
+}
+
+PersistentStatCache::PersistentStatCache(StringRef CachePath)
+  : CachePath(CachePath), Table(0), NumHits(0), NumMisses(0), Dirty(false) {
+  if (!llvm::MemoryBuffer::getFile(CachePath, Buffer, -1,
+                                   /*RequiresNullTerminator=*/false))
+    Table = loadPersistentStatTable(*Buffer);
+  if (!Table)
+    Buffer.reset();
+}
+
+PersistentStatCache::~PersistentStatCache() {
+  delete static_cast<PersistentStatTable *>(Table);
+}
+
+std::pair<bool, uint64_t> PersistentStatCache::getDirState(StringRef Dir) {
+  llvm::StringMap<std::pair<bool, uint64_t> >::iterator Known =
+      DirStates.find(Dir);
+  if (Known != DirStates.end())
+    return Known->getValue();
+
+  std::pair<bool, uint64_t> State(false, 0);
+  llvm::sys::fs::file_status Status;
+  if (!llvm::sys::fs::status(Dir, Status) && is_directory(Status))
+    State = std::make_pair(true,
+                           Status.getLastModificationTime().toEpochTime());
+  DirStates[Dir] = State;
+  return State;
+}
+
+bool PersistentStatCache::lookupEntry(StringRef Path, Entry &E) {
+  if (!Table)
+    return false;
+  // The table needs a null-terminated key.
+  SmallString<256> Key(Path);
+  PersistentStatTable *T = static_cast<PersistentStatTable *>(Table);
+  PersistentStatTable::iterator I = T->find(Key.c_str());
+  if (I == T->end())
+    return false;
+  E = *I;
+  return true;
+}
+
+PersistentStatCache::LookupResult
+PersistentStatCache::getStat(const char *Path, FileData &Data, bool isFile,
+                             int *FileDescriptor) {
+  StringRef PathRef(Path);
+  StringRef Parent = llvm::sys::path::parent_path(PathRef);
+  if (!llvm::sys::path::is_absolute(PathRef) || Parent.empty())
+    return statChained(Path, Data, isFile, FileDescriptor);
+  for (unsigned I = 0, E = UncachedDirs.size(); I != E; ++I)
+    if (PathRef.startswith(UncachedDirs[I]))
+      return statChained(Path, Data, isFile, FileDescriptor);
+
+  // Only entries written by earlier processes are used; this process sees its
+  // own lookups through the FileManager already, and may itself modify the
+  // directories it has looked at.
+  std::pair<bool, uint64_t> ParentState = getDirState(Parent);
+  Entry Cached;
+  if (lookupEntry(PathRef, Cached) &&
+      (!Cached.Exists || Cached.Data.IsDirectory) &&
+      Cached.ParentExists == ParentState.first &&
+      Cached.ParentModTime == ParentState.second) {
+    ++NumHits;
+    if (!Cached.Exists)
+      return CacheMissing;
+    Data = Cached.Data;
+    return CacheExists;
+  }
+
+  ++NumMisses;
+  LookupResult Result = statChained(Path, Data, isFile, FileDescriptor);
+  if (Result == CacheExists && !Data.IsDirectory)
+    return Result;
+
+  // Modification times have a granularity of one second, so a directory
+  // modified within the last couple of seconds could still change without
+  // its time stamp changing. Don't record anything about it yet.
+  if (ParentState.first && ParentState.second + 2 > (uint64_t)::time(0))
+    return Result;
+
+  Entry &New = NewEntries[PathRef];
+  New.Exists = Result == CacheExists;
+  New.ParentExists = ParentState.first;
+  New.ParentModTime = ParentState.second;
+  if (New.Exists)
+    New.Data = Data;
+  Dirty = true;
+  return Result;
+}
+
+bool PersistentStatCache::getControllingMacro(StringRef Path,
+                                              const FileData &Data,
+                                              std::string &Macro) {
+  Entry Cached;
+  if (!lookupEntry(Path, Cached) || !Cached.Exists || Cached.Data.IsDirectory ||
+      !(Cached.Data.UniqueID == Data.UniqueID) ||
+      Cached.Data.ModTime != Data.ModTime || Cached.Data.Size != Data.Size)
+    return FileSystemStatCache::getControllingMacro(Path, Data, Macro);
+
+  ++NumHits;
+  Macro = Cached.ControllingMacro;
+  return true;
+}
+
+void PersistentStatCache::setControllingMacro(StringRef Path,
+                                              const FileData &Data,
+                                              StringRef Macro) {
+  FileSystemStatCache::setControllingMacro(Path, Data, Macro);
+  if (!llvm::sys::path::is_absolute(Path) || Data.IsDirectory ||
+      Data.IsNamedPipe || Data.InPCH)
+    return;
+  for (unsigned I = 0, E = UncachedDirs.size(); I != E; ++I)
+    if (Path.startswith(UncachedDirs[I]))
+      return;
+
+  // The length of an entry's data is stored in a byte.
+  if (Macro.size() > 200)
+    return;
+
+  // As for directories, a file modified within the last couple of seconds
+  // could still change without its size or time stamp changing.
+  if (uint64_t(Data.ModTime) + 2 > (uint64_t)::time(0))
+    return;
+
+  Entry &New = NewEntries[Path];
+  New.Exists = true;
+  New.ParentExists = true;
+  New.ParentModTime = 0;
+  New.Data = Data;
+  New.ControllingMacro = Macro;
+  Dirty = true;
+}
+
+void PersistentStatCache::flush() {
+  FileSystemStatCache::flush();
+  if (!Dirty)
+    return;
+
+  // Merge with the current contents of the cache file, which other processes
+  // may have updated since we loaded it. Our own entries are more recent.
+  OwningPtr<llvm::MemoryBuffer> Current;
+  OwningPtr<PersistentStatTable> CurrentTable;
+  if (!llvm::MemoryBuffer::getFile(CachePath, Current, -1,
+                                   /*RequiresNullTerminator=*/false))
+    CurrentTable.reset(loadPersistentStatTable(*Current));
+
+  OnDiskChainedHashTableGenerator<PersistentStatTrait> Generator;
+  for (llvm::StringMap<Entry>::iterator I = NewEntries.begin(),
+                                        E = NewEntries.end();
+       I != E; ++I)
+    Generator.insert(I->getKey(), I->getValue());
+  if (CurrentTable) {
+    PersistentStatTable::key_iterator KI = CurrentTable->key_begin(),
+                                      KE = CurrentTable->key_end();
+    PersistentStatTable::data_iterator DI = CurrentTable->data_begin();
+    for (; KI != KE; ++KI, ++DI) {
+      StringRef Key(*KI);
+      if (!NewEntries.count(Key))
+        Generator.insert(Key, *DI);
+    }
+  }
+
+  // Write a temporary file next to the cache and move it into place, so that
+  // concurrent readers always see a complete cache.
+  SmallString<128> TempPath;
+  int FD;
+  if (llvm::sys::fs::createUniqueFile(CachePath + "-%%%%%%%%", FD, TempPath))
+    return;
+  {
+    llvm::raw_fd_ostream Out(FD, /*shouldClose=*/true);
+    Out.write(PersistentStatCacheMagic, sizeof(PersistentStatCacheMagic));
+    io::Offset TableOffset = Generator.Emit(Out);
+    io::Emit32(Out, TableOffset);
+    Out.close();
+    if (Out.has_error()) {
+      Out.clear_error();
+      bool Existed;
+      llvm::sys::fs::remove(TempPath.str(), Existed);
+      return;
+    }
+  }
+  if (llvm::sys::fs::rename(TempPath.str(), CachePath)) {
+    bool Existed;
+    llvm::sys::fs::remove(TempPath.str(), Existed);
+    return;
+  }
+  Dirty = false;
+}
+
+void PersistentStatCache::PrintStats() const {
+  llvm::errs() << NumHits << " persistent stat cache hits, " << NumMisses
+               << " misses.\n";
+  FileSystemStatCache::PrintStats();
+}
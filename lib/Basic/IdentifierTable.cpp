@@ -70,10 +70,12 @@ IdentifierIterator *IdentifierInfoLookup::getIdentifiers() {
 
 ExternalIdentifierLookup::~ExternalIdentifierLookup() {}
 
+BuiltinIdentifierLookup::~BuiltinIdentifierLookup() {}
+
 IdentifierTable::IdentifierTable(const LangOptions &LangOpts,
                                  IdentifierInfoLookup* externalLookup)
   : HashTable(8192), // Start with space for 8K identifiers.
-    ExternalLookup(externalLookup) {
+    ExternalLookup(externalLookup), BuiltinLookup(0) {
 
   // Populate the identifier table with info about keywords for the current
   // language.
@@ -84,6 +86,19 @@ IdentifierTable::IdentifierTable(const LangOptions &LangOpts,
   get("import").setModulesImport(true);
 }
 
+void IdentifierTable::setBuiltinLookup(const BuiltinIdentifierLookup *Lookup) {
+  BuiltinLookup = Lookup;
+  if (!Lookup)
+    return;
+
+  for (HashTableTy::iterator I = HashTable.begin(), E = HashTable.end();
+       I != E; ++I) {
+    IdentifierInfo *II = I->getValue();
+    if (II && !II->isFromAST())
+      assignBuiltinID(*II, I->getKey());
+  }
+}
+
 //===----------------------------------------------------------------------===//
 // Language Keyword Implementation
 //===----------------------------------------------------------------------===//
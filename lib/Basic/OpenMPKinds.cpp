@@ -78,6 +78,7 @@ unsigned clang::getOpenMPSimpleClauseType(OpenMPClauseKind Kind,
   case OMPC_unknown:
   case OMPC_threadprivate:
   case OMPC_private:
+  case OMPC_safelen:
   case NUM_OPENMP_CLAUSES:
     break;
   }
@@ -99,6 +100,7 @@ const char *clang::getOpenMPSimpleClauseTypeName(OpenMPClauseKind Kind,
   case OMPC_unknown:
   case OMPC_threadprivate:
   case OMPC_private:
+  case OMPC_safelen:
   case NUM_OPENMP_CLAUSES:
     break;
   }
@@ -114,6 +116,15 @@ bool clang::isAllowedClauseForDirective(OpenMPDirectiveKind DKind,
     switch (CKind) {
 #define OPENMP_PARALLEL_CLAUSE(Name) \
     case OMPC_##Name: return true;
+#include "clang/Basic/OpenMPKinds.def"
+    default:
+      break;
+    }
+    break;
+  case OMPD_simd:
+    switch (CKind) {
+#define OPENMP_SIMD_CLAUSE(Name) \
+    case OMPC_##Name: return true;
 #include "clang/Basic/OpenMPKinds.def"
     default:
       break;
@@ -12,21 +12,27 @@
 //===----------------------------------------------------------------------===//
 
 #include "clang/Basic/SourceManager.h"
+#include "clang/Basic/ByteScan.h"
 #include "clang/Basic/Diagnostic.h"
 #include "clang/Basic/FileManager.h"
 #include "clang/Basic/SourceManagerInternals.h"
 #include "llvm/ADT/Optional.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/StringSwitch.h"
+#include "llvm/Config/llvm-config.h"
 #include "llvm/Support/Capacity.h"
 #include "llvm/Support/Compiler.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/Process.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
 #include <cstring>
 #include <string>
 #include <sys/stat.h>
+#if defined(LLVM_ON_UNIX)
+#include <sys/mman.h>
+#endif
 
 using namespace clang;
 using namespace SrcMgr;
@@ -375,7 +381,8 @@ SourceManager::SourceManager(DiagnosticsEngine &Diag, FileManager &FileMgr,
   : Diag(Diag), FileMgr(FileMgr), OverridenFilesKeepOriginalName(true),
     UserFilesAreVolatile(UserFilesAreVolatile),
     ExternalSLocEntries(0), LineTable(0), NumLinearScans(0),
-    NumBinaryProbes(0), FakeBufferForRecovery(0),
+    NumBinaryProbes(0), NumExpansionCacheHits(0), NumFileIDCacheHits(0),
+    FakeBufferForRecovery(0),
     FakeContentCacheForRecovery(0) {
   clearIDTables();
   Diag.setSourceManager(this);
@@ -415,9 +422,13 @@ void SourceManager::clearIDTables() {
   LocalSLocEntryTable.clear();
   LoadedSLocEntryTable.clear();
   SLocEntryLoaded.clear();
+  LoadedSLocEntryOffsets.clear();
   LastLineNoFileIDQuery = FileID();
   LastLineNoContentCache = 0;
   LastFileIDLookup = FileID();
+  LastExpansionFileIDLookup = FileID();
+  for (unsigned I = 0; I != FileIDLookupCacheSize; ++I)
+    FileIDLookupCache[I] = FileID();
 
   if (LineTable)
     LineTable->clear();
@@ -502,12 +513,27 @@ const SrcMgr::SLocEntry &SourceManager::loadSLocEntry(unsigned Index,
   return LoadedSLocEntryTable[Index];
 }
 
+unsigned SourceManager::getLoadedSLocEntryOffset(unsigned Index) const {
+  if (SLocEntryLoaded[Index])
+    return LoadedSLocEntryTable[Index].getOffset();
+
+  if (!LoadedSLocEntryOffsets[Index]) {
+    unsigned Offset = ExternalSLocEntries->getSLocEntryOffset(
+        -(static_cast<int>(Index) + 2));
+    if (!Offset)
+      return getLoadedSLocEntry(Index).getOffset();
+    LoadedSLocEntryOffsets[Index] = Offset;
+  }
+  return LoadedSLocEntryOffsets[Index];
+}
+
 std::pair<int, unsigned>
 SourceManager::AllocateLoadedSLocEntries(unsigned NumSLocEntries,
                                          unsigned TotalSize) {
   assert(ExternalSLocEntries && "Don't have an external sloc source");
   LoadedSLocEntryTable.resize(LoadedSLocEntryTable.size() + NumSLocEntries);
   SLocEntryLoaded.resize(LoadedSLocEntryTable.size());
+  LoadedSLocEntryOffsets.resize(LoadedSLocEntryTable.size());
   CurrentLoadedOffset -= TotalSize;
   assert(CurrentLoadedOffset >= NextLocalOffset && "Out of source locations");
   int ID = LoadedSLocEntryTable.size();
@@ -646,6 +672,7 @@ SourceManager::createExpansionLocImpl(const ExpansionInfo &Info,
     SLocEntryLoaded[Index] = true;
     return SourceLocation::getMacroLoc(LoadedOffset);
   }
+  LastExpansionFileIDLookup = FileID::get(LocalSLocEntryTable.size());
   LocalSLocEntryTable.push_back(SLocEntry::get(NextLocalOffset, Info));
   assert(NextLocalOffset + TokLength + 1 > NextLocalOffset &&
          NextLocalOffset + TokLength + 1 <= CurrentLoadedOffset &&
@@ -686,6 +713,18 @@ void SourceManager::overrideFileContents(const FileEntry *SourceFile,
   getOverriddenFilesInfo().OverriddenFiles[SourceFile] = NewFile;
 }
 
+void SourceManager::setPrefetchedFileContents(const FileEntry *SourceFile,
+                                       const llvm::MemoryBuffer *Buffer) {
+  const SrcMgr::ContentCache *IR = getOrCreateContentCache(SourceFile);
+  assert(IR && "getOrCreateContentCache() cannot return NULL");
+  if (IR->getRawBuffer() || IR->ContentsEntry != SourceFile ||
+      isFileOverridden(SourceFile)) {
+    delete Buffer;
+    return;
+  }
+  const_cast<SrcMgr::ContentCache *>(IR)->replaceBuffer(Buffer);
+}
+
 void SourceManager::disableFileContentsOverride(const FileEntry *File) {
   if (!isFileOverridden(File))
     return;
@@ -720,6 +759,30 @@ StringRef SourceManager::getBufferData(FileID FID, bool *Invalid) const {
   return Buf->getBuffer();
 }
 
+void SourceManager::releaseFileContents(FileID FID) const {
+#if defined(LLVM_ON_UNIX) && defined(MADV_DONTNEED)
+  bool Invalid = false;
+  const SLocEntry &SLoc = getSLocEntry(FID, &Invalid);
+  if (Invalid || !SLoc.isFile())
+    return;
+  const ContentCache *Content = SLoc.getFile().getContentCache();
+  const llvm::MemoryBuffer *Buf = Content->getRawBuffer();
+  // Only a mapping of the file can be read back after its pages are dropped.
+  if (!Buf || Content->isBufferInvalid() || Content->BufferOverridden ||
+      Buf->getBufferKind() != llvm::MemoryBuffer::MemoryBuffer_MMap)
+    return;
+
+  // Only the pages that are entirely in the buffer can be dropped.
+  uintptr_t PageSize = llvm::sys::process::get_self()->page_size();
+  uintptr_t Start = reinterpret_cast<uintptr_t>(Buf->getBufferStart());
+  uintptr_t End = reinterpret_cast<uintptr_t>(Buf->getBufferEnd());
+  Start = (Start + PageSize - 1) & ~(PageSize - 1);
+  End &= ~(PageSize - 1);
+  if (Start < End)
+    ::madvise(reinterpret_cast<char *>(Start), End - Start, MADV_DONTNEED);
+#endif
+}
+
 //===----------------------------------------------------------------------===//
 // SourceLocation manipulation methods.
 //===----------------------------------------------------------------------===//
@@ -756,6 +819,22 @@ FileID SourceManager::getFileIDLocal(unsigned SLocOffset) const {
   // then we fall back to a less cache efficient, but more scalable, binary
   // search to find the location.
 
+  // Check the expansion that was looked up last; the tokens of a macro
+  // expansion are usually looked up one after another.
+  if (!LastExpansionFileIDLookup.isInvalid() &&
+      isOffsetInFileID(LastExpansionFileIDLookup, SLocOffset)) {
+    ++NumExpansionCacheHits;
+    return LastExpansionFileIDLookup;
+  }
+
+  // Then check the recent lookups near this offset, which catches clients
+  // such as the preprocessing record that jump back and forth.
+  FileID &Cached = FileIDLookupCache[getFileIDLookupCacheSlot(SLocOffset)];
+  if (!Cached.isInvalid() && isOffsetInFileID(Cached, SLocOffset)) {
+    ++NumFileIDCacheHits;
+    return Cached;
+  }
+
   // See if this is near the file point - worst case we start scanning from the
   // most newly created FileID.
   const SrcMgr::SLocEntry *I;
@@ -781,6 +860,9 @@ FileID SourceManager::getFileIDLocal(unsigned SLocOffset) const {
       // FileID lookups.
       if (!I->isExpansion())
         LastFileIDLookup = Res;
+      else
+        LastExpansionFileIDLookup = Res;
+      Cached = Res;
       NumLinearScans += NumProbes+1;
       return Res;
     }
@@ -791,17 +873,25 @@ FileID SourceManager::getFileIDLocal(unsigned SLocOffset) const {
   // Convert "I" back into an index.  We know that it is an entry whose index is
   // larger than the offset we are looking for.
   unsigned GreaterIndex = I - LocalSLocEntryTable.begin();
+  unsigned GreaterOffset = I->getOffset();
   // LessIndex - This is the lower bound of the range that we're searching.
   // We know that the offset corresponding to the FileID is is less than
   // SLocOffset.
   unsigned LessIndex = 0;
+  unsigned LessOffset = 0;
   NumProbes = 0;
   while (1) {
-    bool Invalid = false;
-    unsigned MiddleIndex = (GreaterIndex-LessIndex)/2+LessIndex;
-    unsigned MidOffset = getLocalSLocEntry(MiddleIndex, &Invalid).getOffset();
-    if (Invalid)
-      return FileID::get(0);
+    // Offsets grow steadily through the table, so guess the entry by
+    // interpolating between the bounds.  Entries differ wildly in size, so
+    // alternate with bisection to keep the worst case logarithmic.
+    unsigned MiddleIndex;
+    if (NumProbes % 2 == 0)
+      MiddleIndex = LessIndex + unsigned(uint64_t(SLocOffset - LessOffset) *
+                                         (GreaterIndex - LessIndex) /
+                                         (GreaterOffset - LessOffset));
+    else
+      MiddleIndex = (GreaterIndex-LessIndex)/2+LessIndex;
+    unsigned MidOffset = LocalSLocEntryTable[MiddleIndex].getOffset();
     
     ++NumProbes;
 
@@ -809,6 +899,7 @@ FileID SourceManager::getFileIDLocal(unsigned SLocOffset) const {
     // range to the midpoint.
     if (MidOffset > SLocOffset) {
       GreaterIndex = MiddleIndex;
+      GreaterOffset = MidOffset;
       continue;
     }
 
@@ -822,12 +913,17 @@ FileID SourceManager::getFileIDLocal(unsigned SLocOffset) const {
       // across FileID lookups.
       if (!LocalSLocEntryTable[MiddleIndex].isExpansion())
         LastFileIDLookup = Res;
+      else
+        LastExpansionFileIDLookup = Res;
+      Cached = Res;
       NumBinaryProbes += NumProbes;
       return Res;
     }
 
-    // Otherwise, move the low-side up to the middle index.
-    LessIndex = MiddleIndex;
+    // Otherwise, the entry is after the middle index, so move the low side
+    // past it.
+    LessIndex = MiddleIndex + 1;
+    LessOffset = LocalSLocEntryTable[LessIndex].getOffset();
   }
 }
 
@@ -853,14 +949,14 @@ FileID SourceManager::getFileIDLoaded(unsigned SLocOffset) const {
   else
     I = (-LastID - 2) + 1;
 
+  // Only the offsets of the entries we skip over are needed, so don't load
+  // those entries; only the one we find is loaded.
   unsigned NumProbes;
   for (NumProbes = 0; NumProbes < 8; ++NumProbes, ++I) {
-    // Make sure the entry is loaded!
-    const SrcMgr::SLocEntry &E = getLoadedSLocEntry(I);
-    if (E.getOffset() <= SLocOffset) {
+    if (getLoadedSLocEntryOffset(I) <= SLocOffset) {
       FileID Res = FileID::get(-int(I) - 2);
 
-      if (!E.isExpansion())
+      if (!getLoadedSLocEntry(I).isExpansion())
         LastFileIDLookup = Res;
       NumLinearScans += NumProbes + 1;
       return Res;
@@ -876,13 +972,13 @@ FileID SourceManager::getFileIDLoaded(unsigned SLocOffset) const {
   while (1) {
     ++NumProbes;
     unsigned MiddleIndex = (LessIndex - GreaterIndex) / 2 + GreaterIndex;
-    const SrcMgr::SLocEntry &E = getLoadedSLocEntry(MiddleIndex);
-    if (E.getOffset() == 0)
+    unsigned MiddleOffset = getLoadedSLocEntryOffset(MiddleIndex);
+    if (MiddleOffset == 0)
       return FileID(); // invalid entry.
 
     ++NumProbes;
 
-    if (E.getOffset() > SLocOffset) {
+    if (MiddleOffset > SLocOffset) {
       // Sanity checking, otherwise a bug may lead to hanging in release build.
       if (GreaterIndex == MiddleIndex) {
         assert(0 && "binary search missed the entry");
@@ -892,7 +988,14 @@ FileID SourceManager::getFileIDLoaded(unsigned SLocOffset) const {
       continue;
     }
 
-    if (isOffsetInFileID(FileID::get(-int(MiddleIndex) - 2), SLocOffset)) {
+    // The entry contains the offset unless the next entry, which is the
+    // previous one in the table, starts at or before it.
+    if (MiddleIndex == 0 ||
+        SLocOffset < getLoadedSLocEntryOffset(MiddleIndex - 1)) {
+      const SrcMgr::SLocEntry &E = getLoadedSLocEntry(MiddleIndex);
+      if (E.getOffset() == 0)
+        return FileID(); // the entry could not be loaded.
+
       FileID Res = FileID::get(-int(MiddleIndex) - 2);
       if (!E.isExpansion())
         LastFileIDLookup = Res;
@@ -1204,10 +1307,6 @@ unsigned SourceManager::getPresumedColumnNumber(SourceLocation Loc,
   return getPresumedLoc(Loc).getColumn();
 }
 
-#ifdef __SSE2__
-#include <emmintrin.h>
-#endif
-
 static LLVM_ATTRIBUTE_NOINLINE void
 ComputeLineNumbers(DiagnosticsEngine &Diag, ContentCache *FI,
                    llvm::BumpPtrAllocator &Alloc,
@@ -1233,44 +1332,11 @@ static void ComputeLineNumbers(DiagnosticsEngine &Diag, ContentCache *FI,
   unsigned Offs = 0;
   while (1) {
     // Skip over the contents of the line.
-    const unsigned char *NextBuf = (const unsigned char *)Buf;
-
-#ifdef __SSE2__
-    // Try to skip to the next newline using SSE instructions. This is very
-    // performance sensitive for programs with lots of diagnostics and in -E
-    // mode.
-    __m128i CRs = _mm_set1_epi8('\r');
-    __m128i LFs = _mm_set1_epi8('\n');
-
-    // First fix up the alignment to 16 bytes.
-    while (((uintptr_t)NextBuf & 0xF) != 0) {
-      if (*NextBuf == '\n' || *NextBuf == '\r' || *NextBuf == '\0')
-        goto FoundSpecialChar;
-      ++NextBuf;
-    }
-
-    // Scan 16 byte chunks for '\r' and '\n'. Ignore '\0'.
-    while (NextBuf+16 <= End) {
-      const __m128i Chunk = *(const __m128i*)NextBuf;
-      __m128i Cmp = _mm_or_si128(_mm_cmpeq_epi8(Chunk, CRs),
-                                 _mm_cmpeq_epi8(Chunk, LFs));
-      unsigned Mask = _mm_movemask_epi8(Cmp);
-
-      // If we found a newline, adjust the pointer and jump to the handling code.
-      if (Mask != 0) {
-        NextBuf += llvm::countTrailingZeros(Mask);
-        goto FoundSpecialChar;
-      }
-      NextBuf += 16;
-    }
-#endif
-
-    while (*NextBuf != '\n' && *NextBuf != '\r' && *NextBuf != '\0')
-      ++NextBuf;
+    // This is very performance sensitive for programs with lots of diagnostics
+    // and in -E mode.
+    const unsigned char *NextBuf = (const unsigned char *)
+        scanForLineEnd((const char *)Buf, (const char *)End);
 
-#ifdef __SSE2__
-FoundSpecialChar:
-#endif
     Offs += NextBuf-Buf;
     Buf = NextBuf;
 
@@ -1432,7 +1498,25 @@ unsigned SourceManager::getExpansionLineNumber(SourceLocation Loc,
 unsigned SourceManager::getPresumedLineNumber(SourceLocation Loc,
                                               bool *Invalid) const {
   if (isInvalid(Loc, Invalid)) return 0;
-  return getPresumedLoc(Loc).getLine();
+
+  // Unless #line directives move it, the presumed line is just the line of
+  // the expansion location; don't work out the filename and column.
+  std::pair<FileID, unsigned> LocInfo = getDecomposedExpansionLoc(Loc);
+  bool MyInvalid = false;
+  const SLocEntry &Entry = getSLocEntry(LocInfo.first, &MyInvalid);
+  if (MyInvalid || !Entry.isFile()) {
+    if (Invalid) *Invalid = true;
+    return 0;
+  }
+  if (!Entry.getFile().hasLineDirectives())
+    return getLineNumber(LocInfo.first, LocInfo.second, Invalid);
+
+  PresumedLoc PLoc = getPresumedLoc(Loc);
+  if (PLoc.isInvalid()) {
+    if (Invalid) *Invalid = true;
+    return 0;
+  }
+  return PLoc.getLine();
 }
 
 /// getFileCharacteristic - return the file characteristic of the specified
@@ -2135,7 +2219,9 @@ void SourceManager::PrintStats() const {
                << NumLineNumsComputed << " files with line #'s computed, "
                << NumMacroArgsComputed << " files with macro args computed.\n";
   llvm::errs() << "FileID scans: " << NumLinearScans << " linear, "
-               << NumBinaryProbes << " binary.\n";
+               << NumBinaryProbes << " binary, " << NumExpansionCacheHits
+               << " macro expansions found in the cache, "
+               << NumFileIDCacheHits << " in the lookup cache.\n";
 }
 
 ExternalSLocEntrySource::~ExternalSLocEntrySource() { }
@@ -2165,6 +2251,7 @@ size_t SourceManager::getDataStructureSizes() const {
     + llvm::capacity_in_bytes(LocalSLocEntryTable)
     + llvm::capacity_in_bytes(LoadedSLocEntryTable)
     + llvm::capacity_in_bytes(SLocEntryLoaded)
+    + llvm::capacity_in_bytes(LoadedSLocEntryOffsets)
     + llvm::capacity_in_bytes(FileInfos);
   
   if (OverriddenFilesInfo)
@@ -1570,7 +1570,7 @@ const TargetInfo::AddlRegName AddlRegNames[] = {
 // most of the implementation can be shared.
 class X86TargetInfo : public TargetInfo {
   enum X86SSEEnum {
-    NoSSE, SSE1, SSE2, SSE3, SSSE3, SSE41, SSE42, AVX, AVX2
+    NoSSE, SSE1, SSE2, SSE3, SSSE3, SSE41, SSE42, AVX, AVX2, AVX512F
   } SSELevel;
   enum MMX3DNowEnum {
     NoMMX3DNow, MMX, AMD3DNow, AMD3DNowAthlon
@@ -1591,6 +1591,8 @@ class X86TargetInfo : public TargetInfo {
   bool HasFMA;
   bool HasXOP;
   bool HasF16C;
+  bool HasAVX512CD;
+  bool HasCX16;
 
   /// \brief Enumeration of all of the X86 CPUs supported by Clang.
   ///
@@ -1675,6 +1677,12 @@ class X86TargetInfo : public TargetInfo {
     CK_CoreAVX2,
     //@}
 
+    /// \name Knights Landing
+    /// Knights Landing processor.
+    //@{
+    CK_KNL,
+    //@}
+
     /// \name K6
     /// K6 architecture processors.
     //@{
@@ -1739,7 +1747,8 @@ public:
         HasAES(false), HasPCLMUL(false), HasLZCNT(false), HasRDRND(false),
         HasBMI(false), HasBMI2(false), HasPOPCNT(false), HasRTM(false),
         HasPRFCHW(false), HasRDSEED(false), HasSSE4a(false), HasFMA4(false),
-        HasFMA(false), HasXOP(false), HasF16C(false), CPU(CK_Generic) {
+        HasFMA(false), HasXOP(false), HasF16C(false), HasAVX512CD(false),
+        HasCX16(false), CPU(CK_Generic) {
     BigEndian = false;
     LongDoubleFormat = &llvm::APFloat::x87DoubleExtended;
   }
@@ -1818,6 +1827,7 @@ public:
       .Case("corei7-avx", CK_Corei7AVX)
       .Case("core-avx-i", CK_CoreAVXi)
       .Case("core-avx2", CK_CoreAVX2)
+      .Case("knl", CK_KNL)
       .Case("k6", CK_K6)
       .Case("k6-2", CK_K6_2)
       .Case("k6-3", CK_K6_3)
@@ -1892,6 +1902,7 @@ public:
     case CK_Corei7AVX:
     case CK_CoreAVXi:
     case CK_CoreAVX2:
+    case CK_KNL:
     case CK_Athlon64:
     case CK_Athlon64SSE3:
     case CK_AthlonFX:
@@ -1953,6 +1964,9 @@ void X86TargetInfo::getDefaultFeatures(llvm::StringMap<bool> &Features) const {
   Features["fma"] = false;
   Features["xop"] = false;
   Features["f16c"] = false;
+  Features["avx512f"] = false;
+  Features["avx512cd"] = false;
+  Features["cx16"] = false;
 
   // FIXME: This *really* should not be here.
 
@@ -1985,28 +1999,37 @@ void X86TargetInfo::getDefaultFeatures(llvm::StringMap<bool> &Features) const {
     break;
   case CK_Yonah:
   case CK_Prescott:
+    setFeatureEnabled(Features, "sse3", true);
+    break;
   case CK_Nocona:
     setFeatureEnabled(Features, "sse3", true);
+    setFeatureEnabled(Features, "cx16", true);
     break;
   case CK_Core2:
     setFeatureEnabled(Features, "ssse3", true);
+    setFeatureEnabled(Features, "cx16", true);
     break;
   case CK_Penryn:
     setFeatureEnabled(Features, "sse4.1", true);
+    setFeatureEnabled(Features, "cx16", true);
     break;
   case CK_Atom:
     setFeatureEnabled(Features, "ssse3", true);
+    setFeatureEnabled(Features, "cx16", true);
     break;
   case CK_Corei7:
     setFeatureEnabled(Features, "sse4", true);
+    setFeatureEnabled(Features, "cx16", true);
     break;
   case CK_Corei7AVX:
     setFeatureEnabled(Features, "avx", true);
+    setFeatureEnabled(Features, "cx16", true);
     setFeatureEnabled(Features, "aes", true);
     setFeatureEnabled(Features, "pclmul", true);
     break;
   case CK_CoreAVXi:
     setFeatureEnabled(Features, "avx", true);
+    setFeatureEnabled(Features, "cx16", true);
     setFeatureEnabled(Features, "aes", true);
     setFeatureEnabled(Features, "pclmul", true);
     setFeatureEnabled(Features, "rdrnd", true);
@@ -2014,6 +2037,7 @@ void X86TargetInfo::getDefaultFeatures(llvm::StringMap<bool> &Features) const {
     break;
   case CK_CoreAVX2:
     setFeatureEnabled(Features, "avx2", true);
+    setFeatureEnabled(Features, "cx16", true);
     setFeatureEnabled(Features, "aes", true);
     setFeatureEnabled(Features, "pclmul", true);
     setFeatureEnabled(Features, "lzcnt", true);
@@ -2024,6 +2048,19 @@ void X86TargetInfo::getDefaultFeatures(llvm::StringMap<bool> &Features) const {
     setFeatureEnabled(Features, "rtm", true);
     setFeatureEnabled(Features, "fma", true);
     break;
+  case CK_KNL:
+    setFeatureEnabled(Features, "avx512f", true);
+    setFeatureEnabled(Features, "cx16", true);
+    setFeatureEnabled(Features, "avx512cd", true);
+    setFeatureEnabled(Features, "aes", true);
+    setFeatureEnabled(Features, "pclmul", true);
+    setFeatureEnabled(Features, "lzcnt", true);
+    setFeatureEnabled(Features, "rdrnd", true);
+    setFeatureEnabled(Features, "f16c", true);
+    setFeatureEnabled(Features, "bmi", true);
+    setFeatureEnabled(Features, "bmi2", true);
+    setFeatureEnabled(Features, "fma", true);
+    break;
   case CK_K6:
   case CK_WinChipC6:
     setFeatureEnabled(Features, "mmx", true);
@@ -2056,10 +2093,12 @@ void X86TargetInfo::getDefaultFeatures(llvm::StringMap<bool> &Features) const {
   case CK_OpteronSSE3:
   case CK_Athlon64SSE3:
     setFeatureEnabled(Features, "sse3", true);
+    setFeatureEnabled(Features, "cx16", true);
     setFeatureEnabled(Features, "3dnowa", true);
     break;
   case CK_AMDFAM10:
     setFeatureEnabled(Features, "sse3", true);
+    setFeatureEnabled(Features, "cx16", true);
     setFeatureEnabled(Features, "sse4a", true);
     setFeatureEnabled(Features, "3dnowa", true);
     setFeatureEnabled(Features, "lzcnt", true);
@@ -2067,12 +2106,14 @@ void X86TargetInfo::getDefaultFeatures(llvm::StringMap<bool> &Features) const {
     break;
   case CK_BTVER1:
     setFeatureEnabled(Features, "ssse3", true);
+    setFeatureEnabled(Features, "cx16", true);
     setFeatureEnabled(Features, "sse4a", true);
     setFeatureEnabled(Features, "lzcnt", true);
     setFeatureEnabled(Features, "popcnt", true);
     break;
   case CK_BTVER2:
     setFeatureEnabled(Features, "avx", true);
+    setFeatureEnabled(Features, "cx16", true);
     setFeatureEnabled(Features, "sse4a", true);
     setFeatureEnabled(Features, "lzcnt", true);
     setFeatureEnabled(Features, "aes", true);
@@ -2082,12 +2123,14 @@ void X86TargetInfo::getDefaultFeatures(llvm::StringMap<bool> &Features) const {
     break;
   case CK_BDVER1:
     setFeatureEnabled(Features, "xop", true);
+    setFeatureEnabled(Features, "cx16", true);
     setFeatureEnabled(Features, "lzcnt", true);
     setFeatureEnabled(Features, "aes", true);
     setFeatureEnabled(Features, "pclmul", true);
     break;
   case CK_BDVER2:
     setFeatureEnabled(Features, "xop", true);
+    setFeatureEnabled(Features, "cx16", true);
     setFeatureEnabled(Features, "lzcnt", true);
     setFeatureEnabled(Features, "aes", true);
     setFeatureEnabled(Features, "pclmul", true);
@@ -2149,6 +2192,16 @@ bool X86TargetInfo::setFeatureEnabled(llvm::StringMap<bool> &Features,
       Features["mmx"] = Features["sse"] = Features["sse2"] = Features["sse3"] =
         Features["ssse3"] = Features["sse41"] = Features["sse42"] =
         Features["popcnt"] = Features["avx"] = Features["avx2"] = true;
+    else if (Name == "avx512f")
+      Features["mmx"] = Features["sse"] = Features["sse2"] = Features["sse3"] =
+        Features["ssse3"] = Features["sse41"] = Features["sse42"] =
+        Features["popcnt"] = Features["avx"] = Features["avx2"] =
+        Features["avx512f"] = true;
+    else if (Name == "avx512cd")
+      Features["mmx"] = Features["sse"] = Features["sse2"] = Features["sse3"] =
+        Features["ssse3"] = Features["sse41"] = Features["sse42"] =
+        Features["popcnt"] = Features["avx"] = Features["avx2"] =
+        Features["avx512f"] = Features["avx512cd"] = true;
     else if (Name == "fma")
       Features["mmx"] = Features["sse"] = Features["sse2"] = Features["sse3"] =
         Features["ssse3"] = Features["sse41"] = Features["sse42"] =
@@ -2184,6 +2237,8 @@ bool X86TargetInfo::setFeatureEnabled(llvm::StringMap<bool> &Features,
       Features["prfchw"] = true;
     else if (Name == "rdseed")
       Features["rdseed"] = true;
+    else if (Name == "cx16")
+      Features["cx16"] = true;
   } else {
     if (Name == "mmx")
       Features["mmx"] = Features["3dnow"] = Features["3dnowa"] = false;
@@ -2226,6 +2281,10 @@ bool X86TargetInfo::setFeatureEnabled(llvm::StringMap<bool> &Features,
         Features["fma4"] = Features["xop"] = false;
     else if (Name == "avx2")
       Features["avx2"] = false;
+    else if (Name == "avx512f")
+      Features["avx512f"] = false;
+    else if (Name == "avx512cd")
+      Features["avx512cd"] = false;
     else if (Name == "fma")
       Features["fma"] = false;
     else if (Name == "sse4a")
@@ -2252,6 +2311,15 @@ bool X86TargetInfo::setFeatureEnabled(llvm::StringMap<bool> &Features,
       Features["prfchw"] = false;
     else if (Name == "rdseed")
       Features["rdseed"] = false;
+    else if (Name == "cx16")
+      Features["cx16"] = false;
+
+    // AVX-512 needs AVX2, so turning off AVX2 or any of the features it
+    // needs turns off AVX-512 too.
+    if (!Features["avx2"])
+      Features["avx512f"] = false;
+    if (!Features["avx512f"])
+      Features["avx512cd"] = false;
   }
 
   return true;
@@ -2343,8 +2411,19 @@ void X86TargetInfo::HandleTargetFeatures(std::vector<std::string> &Features) {
       continue;
     }
 
+    if (Feature == "avx512cd") {
+      HasAVX512CD = true;
+      continue;
+    }
+
+    if (Feature == "cx16") {
+      HasCX16 = true;
+      continue;
+    }
+
     assert(Features[i][0] == '+' && "Invalid target feature!");
     X86SSEEnum Level = llvm::StringSwitch<X86SSEEnum>(Feature)
+      .Case("avx512f", AVX512F)
       .Case("avx2", AVX2)
       .Case("avx", AVX)
       .Case("sse42", SSE42)
@@ -2372,6 +2451,10 @@ void X86TargetInfo::HandleTargetFeatures(std::vector<std::string> &Features) {
   it = std::find(Features.begin(), Features.end(), "-mmx");
   if (it != Features.end())
     Features.erase(it);
+
+  // With cmpxchg16b, x86-64 can do the 16-byte atomic operations inline.
+  if (HasCX16 && getTriple().getArch() == llvm::Triple::x86_64)
+    MaxAtomicInlineWidth = 128;
 }
 
 /// X86TargetInfo::getTargetDefines - Return the set of the X86-specific macro
@@ -2455,6 +2538,9 @@ void X86TargetInfo::getTargetDefines(const LangOptions &Opts,
   case CK_CoreAVX2:
     defineCPUMacros(Builder, "corei7");
     break;
+  case CK_KNL:
+    defineCPUMacros(Builder, "knl");
+    break;
   case CK_K6_2:
     Builder.defineMacro("__k6_2__");
     Builder.defineMacro("__tune_k6_2__");
@@ -2566,8 +2652,13 @@ void X86TargetInfo::getTargetDefines(const LangOptions &Opts,
   if (HasF16C)
     Builder.defineMacro("__F16C__");
 
+  if (HasAVX512CD)
+    Builder.defineMacro("__AVX512CD__");
+
   // Each case falls through to the previous one here.
   switch (SSELevel) {
+  case AVX512F:
+    Builder.defineMacro("__AVX512F__");
   case AVX2:
     Builder.defineMacro("__AVX2__");
   case AVX:
@@ -2592,6 +2683,7 @@ void X86TargetInfo::getTargetDefines(const LangOptions &Opts,
 
   if (Opts.MicrosoftExt && getTriple().getArch() == llvm::Triple::x86) {
     switch (SSELevel) {
+    case AVX512F:
     case AVX2:
     case AVX:
     case SSE42:
@@ -2628,6 +2720,8 @@ void X86TargetInfo::getTargetDefines(const LangOptions &Opts,
   }
   if (CPU >= CK_i586)
     Builder.defineMacro("__GCC_HAVE_SYNC_COMPARE_AND_SWAP_8");
+  if (HasCX16)
+    Builder.defineMacro("__GCC_HAVE_SYNC_COMPARE_AND_SWAP_16");
 }
 
 bool X86TargetInfo::hasFeature(StringRef Feature) const {
@@ -2635,6 +2729,9 @@ bool X86TargetInfo::hasFeature(StringRef Feature) const {
       .Case("aes", HasAES)
       .Case("avx", SSELevel >= AVX)
       .Case("avx2", SSELevel >= AVX2)
+      .Case("avx512f", SSELevel >= AVX512F)
+      .Case("avx512cd", HasAVX512CD)
+      .Case("cx16", HasCX16)
       .Case("bmi", HasBMI)
       .Case("bmi2", HasBMI2)
       .Case("fma", HasFMA)
@@ -3034,9 +3131,8 @@ public:
     // Use fp2ret for _Complex long double.
     ComplexLongDoubleUsesFP2Ret = true;
 
-    // x86-64 has atomics up to 16 bytes.
-    // FIXME: Once the backend is fixed, increase MaxAtomicInlineWidth to 128
-    // on CPUs with cmpxchg16b
+    // x86-64 has atomics up to 16 bytes. The 16-byte ones need cmpxchg16b,
+    // which raises MaxAtomicInlineWidth to 128 in HandleTargetFeatures.
     MaxAtomicPromoteWidth = 128;
     MaxAtomicInlineWidth = 64;
   }
@@ -0,0 +1,206 @@
+//===--- TimeTrace.cpp - Hierarchical trace of compile time ---------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file implements the TimeTrace class.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Basic/TimeTrace.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/Timer.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <string>
+#include <vector>
+
+using namespace clang;
+
+namespace {
+struct Entry {
+  std::string Name;
+  std::string Detail;
+  /// The times, in seconds since recording started.
+  double Start, Duration;
+  unsigned Track;
+};
+
+/// \brief The total time of the scopes with one name, counting only the
+/// outermost of nested scopes with the same name.
+struct Total {
+  unsigned Count;
+  double Duration;
+  /// The number of the scopes with this name that have begun but not ended.
+  unsigned Active;
+
+  Total() : Count(0), Duration(0), Active(0) {}
+};
+}
+
+class TimeTrace::Impl {
+public:
+  Impl() : StartTime(llvm::TimeRecord::getCurrentTime().getWallTime()) {}
+
+  double now() const {
+    return llvm::TimeRecord::getCurrentTime().getWallTime() - StartTime;
+  }
+
+  void begin(StringRef Name, StringRef Detail, unsigned Track) {
+    Entry E;
+    E.Name = Name;
+    E.Detail = Detail;
+    E.Duration = 0;
+    E.Track = Track;
+    ++Totals[Name].Active;
+    Stacks[Track].push_back(E);
+    Stacks[Track].back().Start = now();
+  }
+
+  void end(unsigned Track) {
+    if (Stacks[Track].empty())
+      return;
+    double End = now();
+    Entry &E = Stacks[Track].back();
+    E.Duration = End - E.Start;
+    Total &T = Totals[E.Name];
+    ++T.Count;
+    if (--T.Active == 0)
+      T.Duration += E.Duration;
+    Entries.push_back(E);
+    Stacks[Track].pop_back();
+  }
+
+  void setDetail(StringRef Detail, unsigned Track) {
+    if (!Stacks[Track].empty())
+      Stacks[Track].back().Detail = Detail;
+  }
+
+  void write(raw_ostream &OS);
+
+private:
+  double StartTime;
+  SmallVector<Entry, 16> Stacks[NumTracks];
+  std::vector<Entry> Entries;
+  llvm::StringMap<Total> Totals;
+};
+
+TimeTrace::Impl *TimeTrace::Instance = 0;
+
+/// \brief Write \p Str as a JSON string.
+static void writeString(raw_ostream &OS, StringRef Str) {
+  OS << '"';
+  for (unsigned I = 0, N = Str.size(); I != N; ++I) {
+    unsigned char C = Str[I];
+    if (C == '"' || C == '\\')
+      OS << '\\' << C;
+    else if (C < 0x20)
+      OS << llvm::format("\\u%04x", C);
+    else
+      OS << C;
+  }
+  OS << '"';
+}
+
+static uint64_t toMicroseconds(double Seconds) {
+  return Seconds > 0 ? uint64_t(Seconds * 1000000 + 0.5) : 0;
+}
+
+static void writeEvent(raw_ostream &OS, bool &First, StringRef Name,
+                       StringRef Detail, unsigned Track, double Start,
+                       double Duration) {
+  OS << (First ? "\n" : ",\n") << "{\"name\": ";
+  First = false;
+  writeString(OS, Name);
+  OS << ", \"ph\": \"X\", \"pid\": 0, \"tid\": " << Track
+     << ", \"ts\": " << toMicroseconds(Start)
+     << ", \"dur\": " << toMicroseconds(Duration);
+  if (!Detail.empty()) {
+    OS << ", \"args\": {\"detail\": ";
+    writeString(OS, Detail);
+    OS << "}";
+  }
+  OS << "}";
+}
+
+namespace {
+struct LongerTotal {
+  bool operator()(const llvm::StringMapEntry<Total> *A,
+                  const llvm::StringMapEntry<Total> *B) const {
+    if (A->getValue().Duration != B->getValue().Duration)
+      return A->getValue().Duration > B->getValue().Duration;
+    return A->getKey() < B->getKey();
+  }
+};
+}
+
+void TimeTrace::Impl::write(raw_ostream &OS) {
+  // End the scopes that are still open, innermost first.
+  for (unsigned Track = 0; Track != NumTracks; ++Track)
+    while (!Stacks[Track].empty())
+      end(Track);
+
+  OS << "{\"traceEvents\": [";
+  bool First = true;
+  for (std::vector<Entry>::const_iterator I = Entries.begin(),
+                                          E = Entries.end();
+       I != E; ++I)
+    writeEvent(OS, First, I->Name, I->Detail, I->Track, I->Start,
+               I->Duration);
+
+  // Follow the scopes with the totals for each name, longest first, laid end
+  // to end on a track of their own.
+  SmallVector<const llvm::StringMapEntry<Total> *, 16> Sorted;
+  for (llvm::StringMap<Total>::const_iterator I = Totals.begin(),
+                                              E = Totals.end();
+       I != E; ++I)
+    Sorted.push_back(&*I);
+  std::sort(Sorted.begin(), Sorted.end(), LongerTotal());
+
+  double Start = 0;
+  for (unsigned I = 0, N = Sorted.size(); I != N; ++I) {
+    const Total &T = Sorted[I]->getValue();
+    std::string Detail;
+    llvm::raw_string_ostream DetailOS(Detail);
+    DetailOS << T.Count << (T.Count == 1 ? " time" : " times");
+    DetailOS.flush();
+    writeEvent(OS, First, ("Total " + Sorted[I]->getKey()).str(), Detail,
+               NumTracks, Start, T.Duration);
+    Start += T.Duration;
+  }
+  OS << "\n]}\n";
+}
+
+void TimeTrace::start() {
+  if (!Instance)
+    Instance = new Impl();
+}
+
+void TimeTrace::finish(raw_ostream &OS) {
+  if (!Instance)
+    return;
+  Instance->write(OS);
+  delete Instance;
+  Instance = 0;
+}
+
+void TimeTrace::begin(StringRef Name, StringRef Detail, Track T) {
+  if (Instance)
+    Instance->begin(Name, Detail, T);
+}
+
+void TimeTrace::setDetail(StringRef Detail, Track T) {
+  if (Instance)
+    Instance->setDetail(Detail, T);
+}
+
+void TimeTrace::end(Track T) {
+  if (Instance)
+    Instance->end(T);
+}
@@ -0,0 +1,162 @@
+//===--- VirtualFileSystem.cpp - Virtual File System Layer ------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file implements the real, in-memory and overlay file systems.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Basic/VirtualFileSystem.h"
+#include "llvm/ADT/OwningPtr.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/system_error.h"
+
+using namespace clang;
+using namespace clang::vfs;
+
+void FileSystem::anchor() { }
+
+FileSystem::~FileSystem() { }
+
+//===----------------------------------------------------------------------===//
+// The file system of the disk.
+//===----------------------------------------------------------------------===//
+
+namespace {
+class RealFileSystem : public FileSystem {
+public:
+  virtual bool getStatus(StringRef Path, FileData &Data, bool IsFile) {
+    SmallString<128> PathStr(Path);
+    return FileSystemStatCache::get(PathStr.c_str(), Data, IsFile,
+                                    /*FileDescriptor=*/0, /*Cache=*/0);
+  }
+
+  virtual llvm::MemoryBuffer *getBuffer(StringRef Path, std::string *ErrorStr,
+                                        int64_t FileSize,
+                                        bool RequiresNullTerminator) {
+    OwningPtr<llvm::MemoryBuffer> Result;
+    llvm::error_code ec = llvm::MemoryBuffer::getFile(Path, Result, FileSize,
+                                                      RequiresNullTerminator);
+    if (ec && ErrorStr)
+      *ErrorStr = ec.message();
+    return Result.take();
+  }
+};
+}
+
+IntrusiveRefCntPtr<FileSystem> vfs::getRealFileSystem() {
+  static IntrusiveRefCntPtr<FileSystem> FS = new RealFileSystem();
+  return FS;
+}
+
+//===----------------------------------------------------------------------===//
+// The file system in memory.
+//===----------------------------------------------------------------------===//
+
+/// The device of the unique IDs of the files in memory, which no disk has.
+static const uint64_t InMemoryDevice = ~0ULL;
+
+InMemoryFileSystem::~InMemoryFileSystem() {
+  for (llvm::StringMap<Entry>::iterator I = Entries.begin(),
+                                        E = Entries.end(); I != E; ++I)
+    delete I->getValue().Buffer;
+}
+
+void InMemoryFileSystem::addFile(StringRef Path, llvm::MemoryBuffer *Buffer) {
+  Entry &File = Entries[Path];
+  if (File.Buffer) {
+    // Keep the unique ID of the file being replaced.
+    delete File.Buffer;
+  } else {
+    File.Data.UniqueID = llvm::sys::fs::UniqueID(InMemoryDevice, NextFileID++);
+  }
+  File.Buffer = Buffer;
+  File.Data.Size = Buffer->getBufferSize();
+  File.Data.ModTime = 0;
+  File.Data.IsDirectory = false;
+  File.Data.IsNamedPipe = false;
+  File.Data.InPCH = false;
+
+  // Add the parent directories the file is in.
+  for (StringRef Dir = llvm::sys::path::parent_path(Path); !Dir.empty();
+       Dir = llvm::sys::path::parent_path(Dir)) {
+    if (Entries.count(Dir))
+      continue;
+    Entry &DirEntry = Entries[Dir];
+    DirEntry.Buffer = 0;
+    DirEntry.Data.UniqueID =
+      llvm::sys::fs::UniqueID(InMemoryDevice, NextFileID++);
+    DirEntry.Data.Size = 0;
+    DirEntry.Data.ModTime = 0;
+    DirEntry.Data.IsDirectory = true;
+    DirEntry.Data.IsNamedPipe = false;
+    DirEntry.Data.InPCH = false;
+  }
+}
+
+bool InMemoryFileSystem::getStatus(StringRef Path, FileData &Data,
+                                   bool IsFile) {
+  llvm::StringMap<Entry>::iterator I = Entries.find(Path);
+  if (I == Entries.end() || I->getValue().Data.IsDirectory == IsFile)
+    return true;
+  Data = I->getValue().Data;
+  return false;
+}
+
+llvm::MemoryBuffer *InMemoryFileSystem::getBuffer(StringRef Path,
+                                                  std::string *ErrorStr,
+                                                  int64_t FileSize,
+                                                  bool RequiresNullTerminator) {
+  llvm::StringMap<Entry>::iterator I = Entries.find(Path);
+  if (I == Entries.end() || !I->getValue().Buffer) {
+    if (ErrorStr)
+      *ErrorStr = "no such file in memory";
+    return 0;
+  }
+
+  // The caller owns a buffer referring to the contents kept here.
+  return llvm::MemoryBuffer::getMemBuffer(I->getValue().Buffer->getBuffer(),
+                                          Path, RequiresNullTerminator);
+}
+
+//===----------------------------------------------------------------------===//
+// The overlay of file systems.
+//===----------------------------------------------------------------------===//
+
+OverlayFileSystem::OverlayFileSystem(IntrusiveRefCntPtr<FileSystem> Base) {
+  FileSystems.push_back(Base);
+}
+
+void OverlayFileSystem::pushOverlay(IntrusiveRefCntPtr<FileSystem> FS) {
+  FileSystems.push_back(FS);
+}
+
+bool OverlayFileSystem::getStatus(StringRef Path, FileData &Data,
+                                  bool IsFile) {
+  for (unsigned I = FileSystems.size(); I != 0; --I)
+    if (!FileSystems[I - 1]->getStatus(Path, Data, IsFile))
+      return false;
+  return true;
+}
+
+llvm::MemoryBuffer *OverlayFileSystem::getBuffer(StringRef Path,
+                                                 std::string *ErrorStr,
+                                                 int64_t FileSize,
+                                                 bool RequiresNullTerminator) {
+  // Read the file from the file system that has it.
+  FileData Data;
+  for (unsigned I = FileSystems.size(); I != 0; --I)
+    if (!FileSystems[I - 1]->getStatus(Path, Data, /*IsFile=*/true))
+      return FileSystems[I - 1]->getBuffer(Path, ErrorStr, FileSize,
+                                           RequiresNullTerminator);
+  if (ErrorStr)
+    *ErrorStr = "no such file";
+  return 0;
+}
@@ -0,0 +1,161 @@
+//===--- WorkerPool.cpp - Run independent tasks on several threads --------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file implements runTasksInParallel, a minimal bounded thread pool
+//  used by the tools that can process independent inputs concurrently, and
+//  BackgroundThread.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Basic/WorkerPool.h"
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Config/config.h"
+#include "llvm/Support/Mutex.h"
+#include "llvm/Support/Threading.h"
+
+#if LLVM_ENABLE_THREADS && defined(HAVE_PTHREAD_H)
+#include <pthread.h>
+#include <unistd.h>
+#define CLANG_WORKERPOOL_USE_PTHREADS 1
+#endif
+
+using namespace clang;
+
+unsigned clang::getEffectiveWorkerCount(unsigned Requested) {
+#ifdef CLANG_WORKERPOOL_USE_PTHREADS
+  if (Requested == 0) {
+    long Online = ::sysconf(_SC_NPROCESSORS_ONLN);
+    Requested = Online > 0 ? static_cast<unsigned>(Online) : 1;
+  }
+  return Requested;
+#else
+  (void)Requested;
+  return 1;
+#endif
+}
+
+namespace {
+/// \brief The state shared between all workers of one runTasksInParallel
+/// call.
+struct WorkQueue {
+  WorkerPoolTaskFn Fn;
+  void *Context;
+  unsigned NumTasks;
+  unsigned NextTask;
+  llvm::sys::Mutex Lock;
+
+  WorkQueue(WorkerPoolTaskFn Fn, void *Context, unsigned NumTasks)
+    : Fn(Fn), Context(Context), NumTasks(NumTasks), NextTask(0) {}
+
+  /// \brief Claims the next unprocessed task. Returns false once all tasks
+  /// have been handed out.
+  bool claim(unsigned &Index) {
+    llvm::sys::ScopedLock L(Lock);
+    if (NextTask == NumTasks)
+      return false;
+    Index = NextTask++;
+    return true;
+  }
+
+  void drain() {
+    unsigned Index;
+    while (claim(Index))
+      Fn(Context, Index);
+  }
+};
+}
+
+#ifdef CLANG_WORKERPOOL_USE_PTHREADS
+static void *runWorker(void *Arg) {
+  static_cast<WorkQueue *>(Arg)->drain();
+  return 0;
+}
+#endif
+
+void clang::runTasksInParallel(unsigned NumTasks, unsigned NumThreads,
+                               WorkerPoolTaskFn Fn, void *Context) {
+  WorkQueue Queue(Fn, Context, NumTasks);
+  NumThreads = getEffectiveWorkerCount(NumThreads);
+  if (NumThreads > NumTasks)
+    NumThreads = NumTasks;
+
+#ifdef CLANG_WORKERPOOL_USE_PTHREADS
+  if (NumThreads > 1) {
+    if (!llvm::llvm_is_multithreaded())
+      llvm::llvm_start_multithreaded();
+
+    // The calling thread acts as one of the workers.
+    SmallVector<pthread_t, 8> Threads;
+    for (unsigned I = 1; I < NumThreads; ++I) {
+      pthread_t Thread;
+      if (::pthread_create(&Thread, 0, runWorker, &Queue) != 0)
+        break;
+      Threads.push_back(Thread);
+    }
+    Queue.drain();
+    for (unsigned I = 0, E = Threads.size(); I != E; ++I)
+      ::pthread_join(Threads[I], 0);
+    return;
+  }
+#endif
+
+  Queue.drain();
+}
+
+namespace {
+struct BackgroundTask {
+  BackgroundTaskFn Fn;
+  void *Context;
+};
+}
+
+#ifdef CLANG_WORKERPOOL_USE_PTHREADS
+static void *runBackgroundTask(void *Arg) {
+  BackgroundTask *Task = static_cast<BackgroundTask *>(Arg);
+  Task->Fn(Task->Context);
+  delete Task;
+  return 0;
+}
+#endif
+
+BackgroundThread::BackgroundThread(BackgroundTaskFn Fn, void *Context)
+  : Handle(0) {
+#ifdef CLANG_WORKERPOOL_USE_PTHREADS
+  if (!llvm::llvm_is_multithreaded())
+    llvm::llvm_start_multithreaded();
+
+  BackgroundTask *Task = new BackgroundTask();
+  Task->Fn = Fn;
+  Task->Context = Context;
+  pthread_t *Thread = new pthread_t;
+  if (::pthread_create(Thread, 0, runBackgroundTask, Task) == 0) {
+    Handle = Thread;
+    return;
+  }
+  delete Thread;
+  delete Task;
+#endif
+
+  Fn(Context);
+}
+
+BackgroundThread::~BackgroundThread() {
+  join();
+}
+
+void BackgroundThread::join() {
+#ifdef CLANG_WORKERPOOL_USE_PTHREADS
+  if (pthread_t *Thread = static_cast<pthread_t *>(Handle)) {
+    ::pthread_join(*Thread, 0);
+    delete Thread;
+    Handle = 0;
+  }
+#endif
+}
@@ -42,12 +42,14 @@ clang_codegen_SRC_FILES := \
   CGRTTI.cpp \
   CGRecordLayoutBuilder.cpp \
   CGStmt.cpp \
+  CGStmtOpenMP.cpp \
   CGVTT.cpp \
   CGVTables.cpp \
   CodeGenABITypes.cpp \
   CodeGenAction.cpp \
   CodeGenFunction.cpp \
   CodeGenModule.cpp \
+  CodeGenPGO.cpp \
   CodeGenTBAA.cpp \
   CodeGenTypes.cpp \
   ItaniumCXXABI.cpp \
@@ -19,6 +19,7 @@
 #include "llvm/IR/DataLayout.h"
 #include "llvm/IR/Intrinsics.h"
 #include "llvm/IR/Operator.h"
+#include "llvm/Support/MathExtras.h"
 
 using namespace clang;
 using namespace CodeGen;
@@ -33,6 +34,44 @@ enum AtomicOrderingKind {
   AO_ABI_memory_order_seq_cst = 5
 };
 
+/// \brief Whether an atomic operation on \p SizeInBits bits of memory
+/// aligned to \p AlignInBits can be done with the target's atomic
+/// instructions rather than a library call.
+///
+/// Only an object aligned to its size can be accessed atomically in one
+/// instruction; a smaller alignment may split it across cache lines.
+static bool canLowerAtomicInline(const TargetInfo &Target,
+                                 uint64_t SizeInBits, uint64_t AlignInBits) {
+  return llvm::isPowerOf2_64(SizeInBits) && AlignInBits >= SizeInBits &&
+         SizeInBits <= Target.getMaxAtomicInlineWidth();
+}
+
+/// \brief The alignment of the object that \p Ptr points to, which is
+/// \p TypeAlign unless \p Ptr is the address of a variable whose declared
+/// alignment is known to be larger.
+static CharUnits getAtomicPointeeAlignment(CodeGenFunction &CGF,
+                                           const Expr *Ptr,
+                                           CharUnits TypeAlign) {
+  const Expr *E = Ptr->IgnoreParens();
+  if (const UnaryOperator *UO = dyn_cast<UnaryOperator>(E)) {
+    if (UO->getOpcode() != UO_AddrOf)
+      return TypeAlign;
+    E = UO->getSubExpr()->IgnoreParens();
+  } else if (const ImplicitCastExpr *ICE = dyn_cast<ImplicitCastExpr>(E)) {
+    // The first element of an array is aligned as the array is.
+    if (ICE->getCastKind() != CK_ArrayToPointerDecay)
+      return TypeAlign;
+    E = ICE->getSubExpr()->IgnoreParens();
+  } else {
+    return TypeAlign;
+  }
+
+  const DeclRefExpr *DRE = dyn_cast<DeclRefExpr>(E);
+  if (!DRE || !isa<VarDecl>(DRE->getDecl()))
+    return TypeAlign;
+  return std::max(TypeAlign, CGF.getContext().getDeclAlign(DRE->getDecl()));
+}
+
 namespace {
   class AtomicInfo {
     CodeGenFunction &CGF;
@@ -69,9 +108,8 @@ namespace {
       if (lvalue.getAlignment().isZero())
         lvalue.setAlignment(AtomicAlign);
 
-      UseLibcall =
-        (AtomicSizeInBits > uint64_t(C.toBits(lvalue.getAlignment())) ||
-         AtomicSizeInBits > C.getTargetInfo().getMaxAtomicInlineWidth());
+      UseLibcall = !canLowerAtomicInline(C.getTargetInfo(), AtomicSizeInBits,
+                                         C.toBits(lvalue.getAlignment()));
     }
 
     QualType getAtomicType() const { return AtomicTy; }
@@ -341,12 +379,13 @@ RValue CodeGenFunction::EmitAtomicExpr(AtomicExpr *E, llvm::Value *Dest) {
     MemTy = AT->getValueType();
   CharUnits sizeChars = getContext().getTypeSizeInChars(AtomicTy);
   uint64_t Size = sizeChars.getQuantity();
-  CharUnits alignChars = getContext().getTypeAlignInChars(AtomicTy);
+  CharUnits alignChars =
+    getAtomicPointeeAlignment(*this, E->getPtr(),
+                              getContext().getTypeAlignInChars(AtomicTy));
   unsigned Align = alignChars.getQuantity();
-  unsigned MaxInlineWidthInBits =
-    getTarget().getMaxAtomicInlineWidth();
-  bool UseLibcall = (Size != Align ||
-                     getContext().toBits(sizeChars) > MaxInlineWidthInBits);
+  bool UseLibcall = !canLowerAtomicInline(getTarget(),
+                                          getContext().toBits(sizeChars),
+                                          getContext().toBits(alignChars));
 
   llvm::Value *Ptr, *Order, *OrderFail = 0, *Val1 = 0, *Val2 = 0;
   Ptr = EmitScalarExpr(E->getPtr());
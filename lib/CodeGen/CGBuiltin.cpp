@@ -448,6 +448,25 @@ RValue CodeGenFunction::EmitBuiltinExpr(const FunctionDecl *FD,
 
     return RValue::get(0);
   }
+  case Builtin::BI__builtin_assume: {
+    // Sema warned about the side effects of the condition, which isn't
+    // evaluated. Nor is it at -O0, where nothing would use the assumption.
+    if (E->getArg(0)->HasSideEffects(getContext()) ||
+        CGM.getCodeGenOpts().OptimizationLevel == 0)
+      return RValue::get(0);
+
+    EmitAssumption(EvaluateExprAsBool(E->getArg(0)));
+    return RValue::get(0);
+  }
+  case Builtin::BI__builtin_assume_aligned: {
+    Value *PtrValue = EmitScalarExpr(E->getArg(0));
+    Value *AlignmentValue = EmitScalarExpr(E->getArg(1));
+    Value *OffsetValue =
+      (E->getNumArgs() > 2) ? EmitScalarExpr(E->getArg(2)) : 0;
+
+    EmitAlignmentAssumption(PtrValue, AlignmentValue, OffsetValue);
+    return RValue::get(PtrValue);
+  }
 
   case Builtin::BI__builtin_powi:
   case Builtin::BI__builtin_powif:
@@ -2849,6 +2868,21 @@ BuildVector(ArrayRef<llvm::Value*> Ops) {
   return Result;
 }
 
+/// \brief Converts the AVX-512 mask \p Mask, an integer with a bit for each
+/// of the \p NumElts elements of a vector, to a vector of i1.
+static Value *EmitX86MaskToVector(CGBuilderTy &Builder, Value *Mask,
+                                  unsigned NumElts) {
+  return Builder.CreateBitCast(
+      Mask, llvm::VectorType::get(Builder.getInt1Ty(), NumElts));
+}
+
+/// \brief Converts the vector of i1 \p Cmp, the result of a comparison, to
+/// an AVX-512 mask.
+static Value *EmitX86VectorToMask(CGBuilderTy &Builder, Value *Cmp) {
+  unsigned NumElts = Cmp->getType()->getVectorNumElements();
+  return Builder.CreateBitCast(Cmp, Builder.getIntNTy(NumElts));
+}
+
 Value *CodeGenFunction::EmitX86BuiltinExpr(unsigned BuiltinID,
                                            const CallExpr *E) {
   SmallVector<Value*, 4> Ops;
@@ -3086,6 +3120,92 @@ Value *CodeGenFunction::EmitX86BuiltinExpr(unsigned BuiltinID,
     Builder.CreateStore(Builder.CreateExtractValue(Call, 0), Ops[0]);
     return Builder.CreateExtractValue(Call, 1);
   }
+  // The AVX-512 operations are lowered to generic IR, which the backend
+  // selects the 512-bit instructions for.
+  case X86::BI__builtin_ia32_sqrtps512:
+  case X86::BI__builtin_ia32_sqrtpd512: {
+    llvm::Function *F = CGM.getIntrinsic(Intrinsic::sqrt, Ops[0]->getType());
+    return Builder.CreateCall(F, Ops[0]);
+  }
+  case X86::BI__builtin_ia32_vfmaddps512:
+  case X86::BI__builtin_ia32_vfmaddpd512: {
+    llvm::Function *F = CGM.getIntrinsic(Intrinsic::fma, Ops[0]->getType());
+    return Builder.CreateCall(F, Ops);
+  }
+  case X86::BI__builtin_ia32_vplzcntd512:
+  case X86::BI__builtin_ia32_vplzcntq512: {
+    llvm::Function *F = CGM.getIntrinsic(Intrinsic::ctlz, Ops[0]->getType());
+    return Builder.CreateCall2(F, Ops[0], Builder.getFalse());
+  }
+  // Like the instructions, min and max return their second operand when the
+  // operands are unordered.
+  case X86::BI__builtin_ia32_minps512:
+  case X86::BI__builtin_ia32_minpd512:
+    return Builder.CreateSelect(Builder.CreateFCmpOLT(Ops[0], Ops[1]),
+                                Ops[0], Ops[1]);
+  case X86::BI__builtin_ia32_maxps512:
+  case X86::BI__builtin_ia32_maxpd512:
+    return Builder.CreateSelect(Builder.CreateFCmpOGT(Ops[0], Ops[1]),
+                                Ops[0], Ops[1]);
+  case X86::BI__builtin_ia32_pminsd512:
+  case X86::BI__builtin_ia32_pminsq512:
+    return Builder.CreateSelect(Builder.CreateICmpSLT(Ops[0], Ops[1]),
+                                Ops[0], Ops[1]);
+  case X86::BI__builtin_ia32_pminud512:
+  case X86::BI__builtin_ia32_pminuq512:
+    return Builder.CreateSelect(Builder.CreateICmpULT(Ops[0], Ops[1]),
+                                Ops[0], Ops[1]);
+  case X86::BI__builtin_ia32_pmaxsd512:
+  case X86::BI__builtin_ia32_pmaxsq512:
+    return Builder.CreateSelect(Builder.CreateICmpSGT(Ops[0], Ops[1]),
+                                Ops[0], Ops[1]);
+  case X86::BI__builtin_ia32_pmaxud512:
+  case X86::BI__builtin_ia32_pmaxuq512:
+    return Builder.CreateSelect(Builder.CreateICmpUGT(Ops[0], Ops[1]),
+                                Ops[0], Ops[1]);
+  case X86::BI__builtin_ia32_pabsd512:
+  case X86::BI__builtin_ia32_pabsq512: {
+    Value *Zero = llvm::Constant::getNullValue(Ops[0]->getType());
+    Value *IsNeg = Builder.CreateICmpSLT(Ops[0], Zero);
+    return Builder.CreateSelect(IsNeg, Builder.CreateNeg(Ops[0]), Ops[0]);
+  }
+  case X86::BI__builtin_ia32_cvtdq2ps512:
+    return Builder.CreateSIToFP(Ops[0], ConvertType(E->getType()));
+  case X86::BI__builtin_ia32_cvttps2dq512:
+    return Builder.CreateFPToSI(Ops[0], ConvertType(E->getType()));
+  case X86::BI__builtin_ia32_cmpps512_mask:
+  case X86::BI__builtin_ia32_cmppd512_mask: {
+    // The predicates of the low four bits of the immediate; the upper bit
+    // only changes whether QNaNs signal, which the IR doesn't model.
+    static const llvm::CmpInst::Predicate Preds[16] = {
+      llvm::CmpInst::FCMP_OEQ,   llvm::CmpInst::FCMP_OLT,
+      llvm::CmpInst::FCMP_OLE,   llvm::CmpInst::FCMP_UNO,
+      llvm::CmpInst::FCMP_UNE,   llvm::CmpInst::FCMP_UGE,
+      llvm::CmpInst::FCMP_UGT,   llvm::CmpInst::FCMP_ORD,
+      llvm::CmpInst::FCMP_UEQ,   llvm::CmpInst::FCMP_ULT,
+      llvm::CmpInst::FCMP_ULE,   llvm::CmpInst::FCMP_FALSE,
+      llvm::CmpInst::FCMP_ONE,   llvm::CmpInst::FCMP_OGE,
+      llvm::CmpInst::FCMP_OGT,   llvm::CmpInst::FCMP_TRUE
+    };
+    uint64_t Imm = cast<llvm::ConstantInt>(Ops[2])->getZExtValue();
+    Value *Cmp = Builder.CreateFCmp(Preds[Imm & 15], Ops[0], Ops[1]);
+    return EmitX86VectorToMask(Builder, Cmp);
+  }
+  case X86::BI__builtin_ia32_pcmpeqd512_mask:
+  case X86::BI__builtin_ia32_pcmpeqq512_mask:
+    return EmitX86VectorToMask(Builder, Builder.CreateICmpEQ(Ops[0], Ops[1]));
+  case X86::BI__builtin_ia32_pcmpgtd512_mask:
+  case X86::BI__builtin_ia32_pcmpgtq512_mask:
+    return EmitX86VectorToMask(Builder,
+                               Builder.CreateICmpSGT(Ops[0], Ops[1]));
+  case X86::BI__builtin_ia32_selectps512:
+  case X86::BI__builtin_ia32_selectpd512:
+  case X86::BI__builtin_ia32_selectd512:
+  case X86::BI__builtin_ia32_selectq512: {
+    unsigned NumElts = Ops[1]->getType()->getVectorNumElements();
+    Value *Mask = EmitX86MaskToVector(Builder, Ops[0], NumElts);
+    return Builder.CreateSelect(Mask, Ops[1], Ops[2]);
+  }
   }
 }
 
@@ -16,10 +16,13 @@
 #include "CodeGenFunction.h"
 #include "CodeGenModule.h"
 #include "clang/AST/Decl.h"
+#include "llvm/ADT/OwningPtr.h"
 #include "llvm/IR/BasicBlock.h"
 #include "llvm/IR/Constants.h"
 #include "llvm/IR/DerivedTypes.h"
 #include "llvm/Support/CallSite.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/system_error.h"
 #include <vector>
 
 using namespace clang;
@@ -30,16 +33,26 @@ namespace {
 class CGNVCUDARuntime : public CGCUDARuntime {
 
 private:
-  llvm::Type *IntTy, *SizeTy;
-  llvm::PointerType *CharPtrTy, *VoidPtrTy;
+  llvm::Type *IntTy, *SizeTy, *VoidTy;
+  llvm::PointerType *CharPtrTy, *VoidPtrTy, *VoidPtrPtrTy;
+
+  /// The device stubs emitted so far, whose kernels are registered by the
+  /// module constructor.
+  std::vector<llvm::Function *> EmittedKernels;
+  /// The globals that hold the handles of the registered GPU binaries.
+  std::vector<llvm::GlobalVariable *> GpuBinaryHandles;
 
   llvm::Constant *getSetupArgumentFn() const;
   llvm::Constant *getLaunchFn() const;
 
+  llvm::Function *makeRegisterKernelsFn();
+
 public:
   CGNVCUDARuntime(CodeGenModule &CGM);
 
   void EmitDeviceStubBody(CodeGenFunction &CGF, FunctionArgList &Args);
+  llvm::Function *makeModuleCtorFunction();
+  llvm::Function *makeModuleDtorFunction();
 };
 
 }
@@ -50,9 +63,11 @@ CGNVCUDARuntime::CGNVCUDARuntime(CodeGenModule &CGM) : CGCUDARuntime(CGM) {
 
   IntTy = Types.ConvertType(Ctx.IntTy);
   SizeTy = Types.ConvertType(Ctx.getSizeType());
+  VoidTy = llvm::Type::getVoidTy(CGM.getLLVMContext());
 
   CharPtrTy = llvm::PointerType::getUnqual(Types.ConvertType(Ctx.CharTy));
   VoidPtrTy = cast<llvm::PointerType>(Types.ConvertType(Ctx.VoidPtrTy));
+  VoidPtrPtrTy = VoidPtrTy->getPointerTo();
 }
 
 llvm::Constant *CGNVCUDARuntime::getSetupArgumentFn() const {
@@ -77,6 +92,8 @@ llvm::Constant *CGNVCUDARuntime::getLaunchFn() const {
 
 void CGNVCUDARuntime::EmitDeviceStubBody(CodeGenFunction &CGF,
                                          FunctionArgList &Args) {
+  EmittedKernels.push_back(CGF.CurFn);
+
   // Build the argument value list and the argument stack struct type.
   SmallVector<llvm::Value *, 16> ArgValues;
   std::vector<llvm::Type *> ArgTypes;
@@ -120,6 +137,173 @@ void CGNVCUDARuntime::EmitDeviceStubBody(CodeGenFunction &CGF,
   CGF.EmitBlock(EndBlock);
 }
 
+/// Creates a function that registers the kernels of the module with the GPU
+/// binary whose handle it is passed:
+/// \code
+/// void __cuda_register_kernels(void **GpuBinaryHandle) {
+///   __cudaRegisterFunction(GpuBinaryHandle, Kernel0, ...);
+///   ...
+/// }
+/// \endcode
+/// The kernels are found in the GPU binary by their mangled names, which
+/// are those of their stubs on the host.
+llvm::Function *CGNVCUDARuntime::makeRegisterKernelsFn() {
+  llvm::Function *RegisterKernelsFunc = llvm::Function::Create(
+      llvm::FunctionType::get(VoidTy, VoidPtrPtrTy, false),
+      llvm::GlobalValue::InternalLinkage, "__cuda_register_kernels",
+      &CGM.getModule());
+  llvm::BasicBlock *EntryBB = llvm::BasicBlock::Create(
+      CGM.getLLVMContext(), "entry", RegisterKernelsFunc);
+  CGBuilderTy Builder(CGM.getLLVMContext());
+  Builder.SetInsertPoint(EntryBB);
+
+  // int __cudaRegisterFunction(void **, const char *, char *, const char *,
+  //                            int, uint3 *, uint3 *, dim3 *, dim3 *, int *)
+  llvm::Type *RegisterFuncParams[] = {
+    VoidPtrPtrTy, CharPtrTy, CharPtrTy, CharPtrTy, IntTy,
+    VoidPtrTy, VoidPtrTy, VoidPtrTy, VoidPtrTy, IntTy->getPointerTo()
+  };
+  llvm::Constant *RegisterFunc = CGM.CreateRuntimeFunction(
+      llvm::FunctionType::get(IntTy, RegisterFuncParams, false),
+      "__cudaRegisterFunction");
+
+  llvm::Argument &GpuBinaryHandlePtr = *RegisterKernelsFunc->arg_begin();
+  for (unsigned I = 0, E = EmittedKernels.size(); I != E; ++I) {
+    llvm::Function *Kernel = EmittedKernels[I];
+    llvm::Constant *KernelName = llvm::ConstantExpr::getBitCast(
+        CGM.GetAddrOfConstantCString(Kernel->getName()), CharPtrTy);
+    llvm::Constant *NullPtr = llvm::ConstantPointerNull::get(VoidPtrTy);
+    // There is no limit on the threads of the kernel, and the runtime fills
+    // in the rest.
+    llvm::Value *Args[] = {
+      &GpuBinaryHandlePtr, Builder.CreateBitCast(Kernel, CharPtrTy),
+      KernelName, KernelName, llvm::ConstantInt::get(IntTy, -1),
+      NullPtr, NullPtr, NullPtr, NullPtr,
+      llvm::ConstantPointerNull::get(IntTy->getPointerTo())
+    };
+    Builder.CreateCall(RegisterFunc, Args);
+  }
+
+  Builder.CreateRetVoid();
+  return RegisterKernelsFunc;
+}
+
+/// Creates the module constructor, which registers each GPU binary given
+/// with -fcuda-include-gpubinary, and the kernels of the module with it:
+/// \code
+/// void __cuda_module_ctor() {
+///   __cuda_gpubin_handle = __cudaRegisterFatBinary(&__cuda_fatbin_wrapper);
+///   __cuda_register_kernels(__cuda_gpubin_handle);
+///   ...
+/// }
+/// \endcode
+llvm::Function *CGNVCUDARuntime::makeModuleCtorFunction() {
+  const std::vector<std::string> &GpuBinaryFileNames =
+      CGM.getCodeGenOpts().CudaGpuBinaryFileNames;
+  if (GpuBinaryFileNames.empty())
+    return 0;
+
+  llvm::Function *RegisterKernelsFunc = makeRegisterKernelsFn();
+
+  // void **__cudaRegisterFatBinary(void *)
+  llvm::Constant *RegisterFatbinFunc = CGM.CreateRuntimeFunction(
+      llvm::FunctionType::get(VoidPtrPtrTy, VoidPtrTy, false),
+      "__cudaRegisterFatBinary");
+  // struct { int magic, int version, void *gpu_binary, void *dont_care };
+  llvm::StructType *FatbinWrapperTy =
+      llvm::StructType::get(IntTy, IntTy, VoidPtrTy, VoidPtrTy, NULL);
+
+  llvm::Function *ModuleCtorFunc = llvm::Function::Create(
+      llvm::FunctionType::get(VoidTy, false),
+      llvm::GlobalValue::InternalLinkage, "__cuda_module_ctor",
+      &CGM.getModule());
+  llvm::BasicBlock *CtorEntryBB = llvm::BasicBlock::Create(
+      CGM.getLLVMContext(), "entry", ModuleCtorFunc);
+  CGBuilderTy Builder(CGM.getLLVMContext());
+  Builder.SetInsertPoint(CtorEntryBB);
+
+  for (unsigned I = 0, E = GpuBinaryFileNames.size(); I != E; ++I) {
+    const std::string &GpuBinaryFileName = GpuBinaryFileNames[I];
+    OwningPtr<llvm::MemoryBuffer> GpuBinaryBuffer;
+    if (llvm::error_code EC = llvm::MemoryBuffer::getFileOrSTDIN(
+            GpuBinaryFileName, GpuBinaryBuffer)) {
+      CGM.getDiags().Report(diag::err_cannot_open_file)
+        << GpuBinaryFileName << EC.message();
+      continue;
+    }
+
+    // The wrapper that the runtime expects around a fat binary, whose data
+    // the runtime wants aligned.
+    llvm::Constant *GpuBinary = llvm::ConstantExpr::getBitCast(
+        CGM.GetAddrOfConstantString(GpuBinaryBuffer->getBuffer(), 0, 16),
+        VoidPtrTy);
+    llvm::Constant *Values[] = {
+      llvm::ConstantInt::get(IntTy, 0x466243b1), // Fatbin wrapper magic.
+      llvm::ConstantInt::get(IntTy, 1),          // Fatbin version.
+      GpuBinary,
+      llvm::ConstantPointerNull::get(VoidPtrTy)  // Unused in fatbin v1.
+    };
+    llvm::GlobalVariable *FatbinWrapper = new llvm::GlobalVariable(
+        CGM.getModule(), FatbinWrapperTy, true,
+        llvm::GlobalValue::InternalLinkage,
+        llvm::ConstantStruct::get(FatbinWrapperTy, Values),
+        "__cuda_fatbin_wrapper");
+
+    // GpuBinaryHandle = __cudaRegisterFatBinary(&FatbinWrapper);
+    llvm::CallInst *RegisterFatbinCall = Builder.CreateCall(
+        RegisterFatbinFunc, Builder.CreateBitCast(FatbinWrapper, VoidPtrTy));
+    llvm::GlobalVariable *GpuBinaryHandle = new llvm::GlobalVariable(
+        CGM.getModule(), VoidPtrPtrTy, false,
+        llvm::GlobalValue::InternalLinkage,
+        llvm::ConstantPointerNull::get(VoidPtrPtrTy), "__cuda_gpubin_handle");
+    Builder.CreateStore(RegisterFatbinCall, GpuBinaryHandle, false);
+
+    // Register the kernels of the module with the GPU binary.
+    Builder.CreateCall(RegisterKernelsFunc, RegisterFatbinCall);
+
+    GpuBinaryHandles.push_back(GpuBinaryHandle);
+  }
+
+  Builder.CreateRetVoid();
+  return ModuleCtorFunc;
+}
+
+/// Creates the module destructor, which unregisters the GPU binaries that
+/// the constructor registered:
+/// \code
+/// void __cuda_module_dtor() {
+///   __cudaUnregisterFatBinary(__cuda_gpubin_handle);
+///   ...
+/// }
+/// \endcode
+llvm::Function *CGNVCUDARuntime::makeModuleDtorFunction() {
+  if (GpuBinaryHandles.empty())
+    return 0;
+
+  // void __cudaUnregisterFatBinary(void **)
+  llvm::Constant *UnregisterFatbinFunc = CGM.CreateRuntimeFunction(
+      llvm::FunctionType::get(VoidTy, VoidPtrPtrTy, false),
+      "__cudaUnregisterFatBinary");
+
+  llvm::Function *ModuleDtorFunc = llvm::Function::Create(
+      llvm::FunctionType::get(VoidTy, false),
+      llvm::GlobalValue::InternalLinkage, "__cuda_module_dtor",
+      &CGM.getModule());
+  llvm::BasicBlock *DtorEntryBB = llvm::BasicBlock::Create(
+      CGM.getLLVMContext(), "entry", ModuleDtorFunc);
+  CGBuilderTy Builder(CGM.getLLVMContext());
+  Builder.SetInsertPoint(DtorEntryBB);
+
+  for (unsigned I = 0, E = GpuBinaryHandles.size(); I != E; ++I) {
+    llvm::Value *GpuBinaryHandle =
+        Builder.CreateLoad(GpuBinaryHandles[I], false);
+    Builder.CreateCall(UnregisterFatbinFunc, GpuBinaryHandle);
+  }
+
+  Builder.CreateRetVoid();
+  return ModuleDtorFunc;
+}
+
 CGCUDARuntime *CodeGen::CreateNVCUDARuntime(CodeGenModule &CGM) {
   return new CGNVCUDARuntime(CGM);
 }
@@ -16,6 +16,10 @@
 #ifndef CLANG_CODEGEN_CUDARUNTIME_H
 #define CLANG_CODEGEN_CUDARUNTIME_H
 
+namespace llvm {
+class Function;
+}
+
 namespace clang {
 
 class CUDAKernelCallExpr;
@@ -43,6 +47,14 @@ public:
   virtual void EmitDeviceStubBody(CodeGenFunction &CGF,
                                   FunctionArgList &Args) = 0;
 
+  /// Returns a module constructor that registers the GPU binaries and the
+  /// kernels of the module with the CUDA runtime, or null if there are no
+  /// GPU binaries to register.
+  virtual llvm::Function *makeModuleCtorFunction() = 0;
+
+  /// Returns a module destructor that unregisters the GPU binaries, or null
+  /// if none were registered.
+  virtual llvm::Function *makeModuleDtorFunction() = 0;
 };
 
 /// Creates an instance of a CUDA runtime class.
@@ -2587,6 +2587,8 @@ RValue CodeGenFunction::EmitCall(const CGFunctionInfo &CallInfo,
         llvm::Value *V = CI;
         if (V->getType() != RetIRTy)
           V = Builder.CreateBitCast(V, RetIRTy);
+        if (TargetDecl && V->getType()->isPointerTy())
+          EmitCallAlignmentAssumptions(TargetDecl, V, CallArgs);
         return RValue::get(V);
       }
       }
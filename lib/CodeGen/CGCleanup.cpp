@@ -204,6 +204,7 @@ EHFilterScope *EHScopeStack::pushFilter(unsigned numFilters) {
   char *buffer = allocate(EHFilterScope::getSizeForNumFilters(numFilters));
   EHFilterScope *filter = new (buffer) EHFilterScope(numFilters);
   InnermostEHScope = stable_begin();
+  HandlerScopes.push_back(InnermostEHScope);
   return filter;
 }
 
@@ -214,6 +215,7 @@ void EHScopeStack::popFilter() {
   StartOfData += EHFilterScope::getSizeForNumFilters(filter.getNumFilters());
 
   InnermostEHScope = filter.getEnclosingEHScope();
+  HandlerScopes.pop_back();
 }
 
 EHCatchScope *EHScopeStack::pushCatch(unsigned numHandlers) {
@@ -221,6 +223,7 @@ EHCatchScope *EHScopeStack::pushCatch(unsigned numHandlers) {
   EHCatchScope *scope =
     new (buffer) EHCatchScope(numHandlers, InnermostEHScope);
   InnermostEHScope = stable_begin();
+  HandlerScopes.push_back(InnermostEHScope);
   return scope;
 }
 
@@ -228,6 +231,7 @@ void EHScopeStack::pushTerminate() {
   char *Buffer = allocate(EHTerminateScope::getSize());
   new (Buffer) EHTerminateScope(InnermostEHScope);
   InnermostEHScope = stable_begin();
+  HandlerScopes.push_back(InnermostEHScope);
 }
 
 /// Remove any 'null' fixups on the stack.  However, we can't pop more
@@ -512,6 +512,7 @@ inline void EHScopeStack::popCatch() {
 
   EHCatchScope &scope = cast<EHCatchScope>(*begin());
   InnermostEHScope = scope.getEnclosingEHScope();
+  HandlerScopes.pop_back();
   StartOfData += EHCatchScope::getSizeForNumHandlers(scope.getNumHandlers());
 }
 
@@ -520,6 +521,7 @@ inline void EHScopeStack::popTerminate() {
 
   EHTerminateScope &scope = cast<EHTerminateScope>(*begin());
   InnermostEHScope = scope.getEnclosingEHScope();
+  HandlerScopes.pop_back();
   StartOfData += EHTerminateScope::getSize();
 }
 
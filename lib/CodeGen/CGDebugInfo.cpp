@@ -1416,13 +1416,28 @@ llvm::DIType CGDebugInfo::getOrCreateInterfaceType(QualType D,
   return T;
 }
 
+/// isDefinitionHomedElsewhere - Determine whether the full debug info of a
+/// dynamic class is left to the modules that emit its vtable, which is
+/// normally just the one that defines its key function.
+bool CGDebugInfo::isDefinitionHomedElsewhere(const RecordDecl *RD) {
+  if (CGM.getCodeGenOpts().EmitClassDebugAlways ||
+      DebugKind > CodeGenOptions::LimitedDebugInfo)
+    return false;
+  const CXXRecordDecl *CXXDecl = dyn_cast<CXXRecordDecl>(RD);
+  if (!CXXDecl || !CXXDecl->hasDefinition() || !CXXDecl->isDynamicClass())
+    return false;
+  return !ClassesWithVTables.count(CXXDecl->getDefinition());
+}
+
 /// CreateType - get structure or union type.
 llvm::DIType CGDebugInfo::CreateType(const RecordType *Ty, bool Declaration) {
   RecordDecl *RD = Ty->getDecl();
   // Limited debug info should only remove struct definitions that can
-  // safely be replaced by a forward declaration in the source code.
-  if (DebugKind <= CodeGenOptions::LimitedDebugInfo && Declaration &&
-      !RD->isCompleteDefinitionRequired() && CGM.getLangOpts().CPlusPlus) {
+  // safely be replaced by a forward declaration in the source code, or that
+  // another module provides.
+  if ((DebugKind <= CodeGenOptions::LimitedDebugInfo && Declaration &&
+       !RD->isCompleteDefinitionRequired() && CGM.getLangOpts().CPlusPlus) ||
+      isDefinitionHomedElsewhere(RD)) {
     // FIXME: This implementation is problematic; there are some test
     // cases where we violate the above principle, such as
     // test/CodeGen/debug-info-records.c .
@@ -1962,6 +1977,20 @@ void CGDebugInfo::completeFwdDecl(const RecordDecl &RD) {
     getOrCreateType(QTy, getOrCreateFile(RD.getLocation()));
 }
 
+void CGDebugInfo::completeClassData(const CXXRecordDecl *RD) {
+  RD = RD->getDefinition();
+  if (!ClassesWithVTables.insert(RD) ||
+      CGM.getCodeGenOpts().EmitClassDebugAlways)
+    return;
+
+  // Replace the declaration emitted before the vtable turned out to belong
+  // here.
+  QualType Ty = CGM.getContext().getRecordType(RD);
+  llvm::DIType T = getTypeOrNull(Ty);
+  if (T && T.isForwardDecl())
+    getOrCreateType(Ty, getOrCreateFile(RD->getLocation()));
+}
+
 /// getCachedInterfaceTypeOrNull - Get the type from the interface
 /// cache, unless it needs to regenerated. Otherwise return null.
 llvm::Value *CGDebugInfo::getCachedInterfaceTypeOrNull(QualType Ty) {
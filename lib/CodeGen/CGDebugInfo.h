@@ -20,6 +20,7 @@
 #include "clang/Basic/SourceLocation.h"
 #include "clang/Frontend/CodeGenOptions.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/DIBuilder.h"
 #include "llvm/DebugInfo.h"
 #include "llvm/Support/Allocator.h"
@@ -81,6 +82,11 @@ class CGDebugInfo {
   /// compilation.
   std::vector<std::pair<void *, llvm::WeakVH> >ReplaceMap;
 
+  /// ClassesWithVTables - The dynamic classes whose vtables this module
+  /// emits, which are the ones that get full debug info when it is not
+  /// emitted into every module.
+  llvm::SmallPtrSet<const CXXRecordDecl *, 16> ClassesWithVTables;
+
   // LexicalBlockStack - Keep track of our current nested lexical block.
   std::vector<llvm::TrackingVH<llvm::MDNode> > LexicalBlockStack;
   llvm::DenseMap<const Decl *, llvm::WeakVH> RegionMap;
@@ -115,6 +121,7 @@ class CGDebugInfo {
   llvm::DIType CreateType(const BlockPointerType *Ty, llvm::DIFile F);
   llvm::DIType CreateType(const FunctionType *Ty, llvm::DIFile F);
   llvm::DIType CreateType(const RecordType *Ty, bool Declaration);
+  bool isDefinitionHomedElsewhere(const RecordDecl *RD);
   llvm::DIType CreateLimitedType(const RecordType *Ty);
   llvm::DIType CreateType(const ObjCInterfaceType *Ty, llvm::DIFile F);
   llvm::DIType CreateType(const ObjCObjectType *Ty, llvm::DIFile F);
@@ -290,6 +297,10 @@ public:
 
   void completeFwdDecl(const RecordDecl &TD);
 
+  /// completeClassData - Note that the vtable of \p RD is emitted in this
+  /// module, so that its full debug info belongs here as well.
+  void completeClassData(const CXXRecordDecl *RD);
+
 private:
   /// EmitDeclare - Emit call to llvm.dbg.declare for a variable declaration.
   void EmitDeclare(const VarDecl *decl, unsigned Tag, llvm::Value *AI,
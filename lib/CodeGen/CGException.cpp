@@ -792,27 +792,46 @@ llvm::BasicBlock *CodeGenFunction::EmitLandingPad() {
   // try/catches.
   // Build the landingpad instruction.
 
-  // Accumulate all the handlers in scope.
+  // Accumulate all the handlers in scope.  Only EH scopes matter, and
+  // once we have seen one EH cleanup the cleanups enclosing it can't
+  // change the landingpad, so we skip straight to the next handler scope
+  // instead of walking past each of them.
   bool hasCatchAll = false;
   bool hasCleanup = false;
   bool hasFilter = false;
   SmallVector<llvm::Value*, 4> filterTypes;
   llvm::SmallPtrSet<llvm::Value*, 4> catchTypes;
-  for (EHScopeStack::iterator I = EHStack.begin(), E = EHStack.end();
-         I != E; ++I) {
+  ArrayRef<EHScopeStack::stable_iterator> handlerScopes =
+    EHStack.getHandlerScopes();
+  unsigned nextHandler = handlerScopes.size();
+  for (EHScopeStack::stable_iterator si = EHStack.getInnermostEHScope();
+         si != EHStack.stable_end(); ) {
+    EHScope &scope = *EHStack.find(si);
+
+    if (scope.getKind() == EHScope::Cleanup) {
+      // Every cleanup on the chain of EH scopes is an EH cleanup.
+      assert(cast<EHCleanupScope>(scope).isEHCleanup());
+      hasCleanup = true;
+      si = nextHandler ? handlerScopes[nextHandler - 1]
+                       : EHStack.stable_end();
+      continue;
+    }
+
+    assert(nextHandler && handlerScopes[nextHandler - 1] == si &&
+           "handler scopes out of sync with the EH stack");
+    --nextHandler;
 
-    switch (I->getKind()) {
+    switch (scope.getKind()) {
     case EHScope::Cleanup:
-      // If we have a cleanup, remember that.
-      hasCleanup = (hasCleanup || cast<EHCleanupScope>(*I).isEHCleanup());
-      continue;
+      llvm_unreachable("cleanup handled above");
 
     case EHScope::Filter: {
-      assert(I.next() == EHStack.end() && "EH filter is not end of EH stack");
+      assert(EHStack.find(si).next() == EHStack.end() &&
+             "EH filter is not end of EH stack");
       assert(!hasCatchAll && "EH filter reached after catch-all");
 
       // Filter scopes get added to the landingpad in weird ways.
-      EHFilterScope &filter = cast<EHFilterScope>(*I);
+      EHFilterScope &filter = cast<EHFilterScope>(scope);
       hasFilter = true;
 
       // Add all the filter values.
@@ -831,7 +850,7 @@ llvm::BasicBlock *CodeGenFunction::EmitLandingPad() {
       break;
     }
 
-    EHCatchScope &catchScope = cast<EHCatchScope>(*I);
+    EHCatchScope &catchScope = cast<EHCatchScope>(scope);
     for (unsigned hi = 0, he = catchScope.getNumHandlers(); hi != he; ++hi) {
       EHCatchScope::Handler handler = catchScope.getHandler(hi);
 
@@ -847,6 +866,8 @@ llvm::BasicBlock *CodeGenFunction::EmitLandingPad() {
         // If not, add it directly to the landingpad.
         LPadInst->addClause(handler.Type);
     }
+
+    si = catchScope.getEnclosingEHScope();
   }
 
  done:
@@ -23,6 +23,7 @@
 #include "clang/AST/DeclObjC.h"
 #include "clang/Frontend/CodeGenOptions.h"
 #include "llvm/ADT/Hashing.h"
+#include "llvm/ADT/StringSwitch.h"
 #include "llvm/IR/DataLayout.h"
 #include "llvm/IR/Intrinsics.h"
 #include "llvm/IR/LLVMContext.h"
@@ -2090,18 +2091,92 @@ llvm::Constant *CodeGenFunction::EmitCheckSourceLocation(SourceLocation Loc) {
   return llvm::ConstantStruct::getAnon(Data);
 }
 
+/// \brief Returns true if the failed checks reported by the runtime handler
+/// \p CheckName trap instead, given the sanitizers of -fsanitize-trap=. The
+/// checks a handler reports for several sanitizers trap if any of them does.
+static bool isTrappingCheck(const SanitizerOptions &Trap, StringRef CheckName) {
+  return llvm::StringSwitch<bool>(CheckName)
+    .Case("type_mismatch", Trap.Null || Trap.Alignment || Trap.ObjectSize)
+    .Case("out_of_bounds", Trap.Bounds)
+    .Case("load_invalid_value", Trap.Bool || Trap.Enum)
+    .Case("float_cast_overflow", Trap.FloatCastOverflow)
+    .Cases("add_overflow", "sub_overflow", "mul_overflow", "negate_overflow",
+           Trap.SignedIntegerOverflow || Trap.UnsignedIntegerOverflow)
+    .Case("shift_out_of_bounds", Trap.Shift)
+    .Case("divrem_overflow", Trap.IntegerDivideByZero ||
+                             Trap.FloatDivideByZero ||
+                             Trap.SignedIntegerOverflow)
+    .Case("missing_return", Trap.Return)
+    .Case("builtin_unreachable", Trap.Unreachable)
+    .Case("vla_bound_not_positive", Trap.VLABound)
+    .Default(false);
+}
+
+/// \brief Returns true if \p A and \p B are known to compute the same value,
+/// looking through at most \p Depth levels of instructions. Instructions
+/// that access memory are never the same, since it may change between them.
+static bool isSameValue(llvm::Value *A, llvm::Value *B, unsigned Depth) {
+  if (A == B)
+    return true;
+  if (!Depth)
+    return false;
+
+  llvm::Instruction *IA = dyn_cast<llvm::Instruction>(A);
+  llvm::Instruction *IB = dyn_cast<llvm::Instruction>(B);
+  if (!IA || !IB || !IA->isSameOperationAs(IB) ||
+      IA->mayReadOrWriteMemory() || isa<llvm::PHINode>(IA) ||
+      isa<llvm::AllocaInst>(IA))
+    return false;
+
+  for (unsigned i = 0, e = IA->getNumOperands(); i != e; ++i)
+    if (!isSameValue(IA->getOperand(i), IB->getOperand(i), Depth - 1))
+      return false;
+  return true;
+}
+
+bool CodeGenFunction::isRedundantCheck(llvm::Value *Checked) {
+  // Control flow since the last check may bypass the earlier ones.
+  if (Builder.GetInsertBlock() != SanitizerCheckedBB) {
+    SanitizerCheckedConds.clear();
+    SanitizerCheckedBB = 0;
+    return false;
+  }
+
+  for (unsigned i = 0, e = SanitizerCheckedConds.size(); i != e; ++i)
+    if (llvm::Value *V = SanitizerCheckedConds[i])
+      if (isSameValue(V, Checked, 4))
+        return true;
+  return false;
+}
+
+void CodeGenFunction::noteCheck(llvm::Value *Checked, bool IsFatal) {
+  SanitizerCheckedBB = Builder.GetInsertBlock();
+  if (IsFatal && !isa<llvm::Constant>(Checked))
+    SanitizerCheckedConds.push_back(Checked);
+}
+
 void CodeGenFunction::EmitCheck(llvm::Value *Checked, StringRef CheckName,
                                 ArrayRef<llvm::Constant *> StaticArgs,
                                 ArrayRef<llvm::Value *> DynamicArgs,
                                 CheckRecoverableKind RecoverKind) {
   assert(SanOpts != &SanitizerOptions::Disabled);
 
-  if (CGM.getCodeGenOpts().SanitizeUndefinedTrapOnError) {
+  if (CGM.getCodeGenOpts().SanitizeUndefinedTrapOnError ||
+      isTrappingCheck(CGM.getCodeGenOpts().SanitizeTrap, CheckName)) {
     assert (RecoverKind != CRK_AlwaysRecoverable &&
             "Runtime call required for AlwaysRecoverable kind!");
     return EmitTrapCheck(Checked);
   }
 
+  // A check can't fail after an identical one that doesn't return, as when
+  // the same pointer is checked twice.
+  if (isRedundantCheck(Checked))
+    return;
+
+  bool Recover = (RecoverKind == CRK_AlwaysRecoverable) ||
+                 ((RecoverKind == CRK_Recoverable) &&
+                   CGM.getCodeGenOpts().SanitizeRecover);
+
   llvm::BasicBlock *Cont = createBasicBlock("cont");
 
   llvm::BasicBlock *Handler = createBasicBlock("handler." + CheckName);
@@ -2137,10 +2212,6 @@ void CodeGenFunction::EmitCheck(llvm::Value *Checked, StringRef CheckName,
     ArgTypes.push_back(IntPtrTy);
   }
 
-  bool Recover = (RecoverKind == CRK_AlwaysRecoverable) ||
-                 ((RecoverKind == CRK_Recoverable) &&
-                   CGM.getCodeGenOpts().SanitizeRecover);
-
   llvm::FunctionType *FnType =
     llvm::FunctionType::get(CGM.VoidTy, ArgTypes, false);
   llvm::AttrBuilder B;
@@ -2168,10 +2239,16 @@ void CodeGenFunction::EmitCheck(llvm::Value *Checked, StringRef CheckName,
     Builder.CreateUnreachable();
   }
 
+  // After a recoverable check, the conditions of the earlier checks still
+  // hold, although this one may not.
   EmitBlock(Cont);
+  noteCheck(Checked, /*IsFatal=*/!Recover);
 }
 
 void CodeGenFunction::EmitTrapCheck(llvm::Value *Checked) {
+  if (isRedundantCheck(Checked))
+    return;
+
   llvm::BasicBlock *Cont = createBasicBlock("cont");
 
   // If we're optimizing, collapse all calls to trap down to just one per
@@ -2190,6 +2267,7 @@ void CodeGenFunction::EmitTrapCheck(llvm::Value *Checked) {
   }
 
   EmitBlock(Cont);
+  noteCheck(Checked, /*IsFatal=*/true);
 }
 
 /// isSimpleArrayDecayOperand - If the specified expr is a simple decay from an
@@ -991,6 +991,287 @@ public:
 
 }  // end anonymous namespace.
 
+/// Evaluate \p E if it is an integer literal, possibly negated and
+/// implicitly converted to another integer type.
+static bool evaluateIntegerLiteral(ASTContext &Ctx, const Expr *E,
+                                   llvm::APSInt &Value) {
+  E = E->IgnoreParens();
+  if (const IntegerLiteral *IL = dyn_cast<IntegerLiteral>(E)) {
+    Value = llvm::APSInt(IL->getValue(),
+                         IL->getType()->isUnsignedIntegerOrEnumerationType());
+    return true;
+  }
+  if (const CharacterLiteral *CL = dyn_cast<CharacterLiteral>(E)) {
+    Value = Ctx.MakeIntValue(CL->getValue(), CL->getType());
+    return true;
+  }
+  if (const UnaryOperator *UO = dyn_cast<UnaryOperator>(E)) {
+    if (UO->getOpcode() != UO_Minus && UO->getOpcode() != UO_Plus)
+      return false;
+    if (!evaluateIntegerLiteral(Ctx, UO->getSubExpr(), Value))
+      return false;
+    if (UO->getOpcode() == UO_Minus) {
+      // Leave signed overflow to the constant evaluator to diagnose.
+      if (Value.isSigned() && Value.isMinSignedValue())
+        return false;
+      Value = -Value;
+    }
+    return true;
+  }
+  if (const ImplicitCastExpr *ICE = dyn_cast<ImplicitCastExpr>(E)) {
+    QualType DestTy = ICE->getType();
+    if ((ICE->getCastKind() != CK_IntegralCast &&
+         ICE->getCastKind() != CK_NoOp) ||
+        !DestTy->isIntegerType() || DestTy->isBooleanType())
+      return false;
+    if (!evaluateIntegerLiteral(Ctx, ICE->getSubExpr(), Value))
+      return false;
+    Value = Value.extOrTrunc(Ctx.getIntWidth(DestTy));
+    Value.setIsUnsigned(DestTy->isUnsignedIntegerOrEnumerationType());
+    return true;
+  }
+  return false;
+}
+
+/// Evaluate \p E if it is a floating or integer literal, possibly negated
+/// and implicitly converted to a floating type.
+static bool evaluateFloatingLiteral(ASTContext &Ctx, const Expr *E,
+                                    llvm::APFloat &Value) {
+  E = E->IgnoreParens();
+  if (const FloatingLiteral *FL = dyn_cast<FloatingLiteral>(E)) {
+    Value = FL->getValue();
+    return true;
+  }
+  if (const UnaryOperator *UO = dyn_cast<UnaryOperator>(E)) {
+    if (UO->getOpcode() != UO_Minus && UO->getOpcode() != UO_Plus)
+      return false;
+    if (!evaluateFloatingLiteral(Ctx, UO->getSubExpr(), Value))
+      return false;
+    if (UO->getOpcode() == UO_Minus)
+      Value.changeSign();
+    return true;
+  }
+  if (const ImplicitCastExpr *ICE = dyn_cast<ImplicitCastExpr>(E)) {
+    QualType DestTy = ICE->getType();
+    if (!DestTy->isRealFloatingType())
+      return false;
+    const llvm::fltSemantics &Sem = Ctx.getFloatTypeSemantics(DestTy);
+    bool Ignored;
+    switch (ICE->getCastKind()) {
+    case CK_NoOp:
+      return evaluateFloatingLiteral(Ctx, ICE->getSubExpr(), Value);
+    case CK_FloatingCast:
+      if (!evaluateFloatingLiteral(Ctx, ICE->getSubExpr(), Value))
+        return false;
+      Value.convert(Sem, llvm::APFloat::rmNearestTiesToEven, &Ignored);
+      return true;
+    case CK_IntegralToFloating: {
+      llvm::APSInt Int;
+      if (!evaluateIntegerLiteral(Ctx, ICE->getSubExpr(), Int))
+        return false;
+      Value = llvm::APFloat(Sem, 1);
+      Value.convertFromAPInt(Int, Int.isSigned(),
+                             llvm::APFloat::rmNearestTiesToEven);
+      return true;
+    }
+    default:
+      return false;
+    }
+  }
+  return false;
+}
+
+template<typename T>
+static llvm::Constant *getDataArray(llvm::LLVMContext &Context,
+                                    ArrayRef<uint64_t> Values) {
+  SmallVector<T, 64> Elts(Values.begin(), Values.end());
+  return llvm::ConstantDataArray::get(Context, Elts);
+}
+
+/// Try to emit \p Init, the initializer of an object of type \p T, if it
+/// is an array of integer or floating literals, or an array of such arrays.
+///
+/// Lookup tables with many thousands of elements are common, and this
+/// builds their ConstantDataArrays directly, without evaluating the whole
+/// table into an APValue first and creating a constant for each element.
+/// Returns null for anything else, which the general paths then handle.
+static llvm::Constant *tryEmitScalarArrayInit(CodeGenModule &CGM,
+                                              const Expr *Init, QualType T) {
+  ASTContext &Ctx = CGM.getContext();
+  const ConstantArrayType *CAT = Ctx.getAsConstantArrayType(T);
+  const InitListExpr *ILE = dyn_cast<InitListExpr>(Init);
+  if (!CAT || !ILE || ILE->isStringLiteralInit())
+    return 0;
+
+  uint64_t NumElements = CAT->getSize().getZExtValue();
+  unsigned NumInits = ILE->getNumInits();
+  if (NumInits == 0 || NumInits > NumElements)
+    return 0;
+  if (const Expr *Filler = ILE->getArrayFiller())
+    if (!isa<ImplicitValueInitExpr>(Filler))
+      return 0;
+
+  QualType ElemTy = CAT->getElementType();
+  llvm::Type *ElemLLVMTy = CGM.getTypes().ConvertTypeForMem(ElemTy);
+
+  if (ElemTy->isArrayType()) {
+    std::vector<llvm::Constant*> Elts;
+    Elts.reserve(NumElements);
+    for (unsigned I = 0; I != NumInits; ++I) {
+      const Expr *E = ILE->getInit(I);
+      llvm::Constant *C = isa<ImplicitValueInitExpr>(E)
+          ? llvm::Constant::getNullValue(ElemLLVMTy)
+          : tryEmitScalarArrayInit(CGM, E, ElemTy);
+      if (!C || C->getType() != ElemLLVMTy)
+        return 0;
+      Elts.push_back(C);
+    }
+    Elts.resize(NumElements, llvm::Constant::getNullValue(ElemLLVMTy));
+    return llvm::ConstantArray::get(
+        llvm::ArrayType::get(ElemLLVMTy, NumElements), Elts);
+  }
+
+  if (ElemTy->isRealFloatingType()) {
+    bool IsFloat = ElemLLVMTy->isFloatTy();
+    if (!IsFloat && !ElemLLVMTy->isDoubleTy())
+      return 0;
+    SmallVector<float, 64> Floats;
+    SmallVector<double, 64> Doubles;
+    llvm::APFloat Value(0.0);
+    for (unsigned I = 0; I != NumInits; ++I) {
+      const Expr *E = ILE->getInit(I);
+      if (isa<ImplicitValueInitExpr>(E))
+        Value = llvm::APFloat::getZero(Ctx.getFloatTypeSemantics(ElemTy));
+      else if (!Ctx.hasSameUnqualifiedType(E->getType(), ElemTy) ||
+               !evaluateFloatingLiteral(Ctx, E, Value))
+        return 0;
+      if (IsFloat)
+        Floats.push_back(Value.convertToFloat());
+      else
+        Doubles.push_back(Value.convertToDouble());
+    }
+    if (IsFloat) {
+      Floats.resize(NumElements);
+      return llvm::ConstantDataArray::get(CGM.getLLVMContext(), Floats);
+    }
+    Doubles.resize(NumElements);
+    return llvm::ConstantDataArray::get(CGM.getLLVMContext(), Doubles);
+  }
+
+  if (!ElemTy->isIntegerType() || ElemTy->isBooleanType())
+    return 0;
+  unsigned Width = Ctx.getIntWidth(ElemTy);
+  if ((Width != 8 && Width != 16 && Width != 32 && Width != 64) ||
+      !ElemLLVMTy->isIntegerTy(Width))
+    return 0;
+
+  SmallVector<uint64_t, 64> Values;
+  Values.reserve(NumElements);
+  llvm::APSInt Value;
+  for (unsigned I = 0; I != NumInits; ++I) {
+    const Expr *E = ILE->getInit(I);
+    if (isa<ImplicitValueInitExpr>(E)) {
+      Values.push_back(0);
+      continue;
+    }
+    if (!Ctx.hasSameUnqualifiedType(E->getType(), ElemTy) ||
+        !evaluateIntegerLiteral(Ctx, E, Value) ||
+        Value.getBitWidth() != Width)
+      return 0;
+    Values.push_back(Value.getZExtValue());
+  }
+  Values.resize(NumElements);
+
+  llvm::LLVMContext &VMContext = CGM.getLLVMContext();
+  switch (Width) {
+  case 8:  return getDataArray<uint8_t>(VMContext, Values);
+  case 16: return getDataArray<uint16_t>(VMContext, Values);
+  case 32: return getDataArray<uint32_t>(VMContext, Values);
+  default: return getDataArray<uint64_t>(VMContext, Values);
+  }
+}
+
+/// Try to emit \p Value, the evaluated value of an array of type \p T, if
+/// all of its elements are integers or all are floating-point numbers.
+///
+/// Tables computed by constexpr functions can have many thousands of
+/// elements; this builds their ConstantDataArrays directly instead of
+/// creating and uniquing a constant for each element. Returns null for
+/// anything else.
+static llvm::Constant *tryEmitScalarArrayValue(CodeGenModule &CGM,
+                                               const APValue &Value,
+                                               QualType T) {
+  ASTContext &Ctx = CGM.getContext();
+  const ConstantArrayType *CAT = Ctx.getAsConstantArrayType(T);
+  unsigned NumElements = Value.getArraySize();
+  if (!CAT || NumElements == 0)
+    return 0;
+
+  unsigned NumInitElts = Value.getArrayInitializedElts();
+  QualType ElemTy = CAT->getElementType();
+  bool IsFloating = ElemTy->isRealFloatingType();
+  if (!IsFloating && (!ElemTy->isIntegerType() || ElemTy->isBooleanType()))
+    return 0;
+
+  // Integers can also be evaluated to addresses or label differences, which
+  // need the general path.
+  APValue::ValueKind Kind = IsFloating ? APValue::Float : APValue::Int;
+  if (Value.hasArrayFiller() && Value.getArrayFiller().getKind() != Kind)
+    return 0;
+  for (unsigned I = 0; I != NumInitElts; ++I)
+    if (Value.getArrayInitializedElt(I).getKind() != Kind)
+      return 0;
+
+  llvm::Type *ElemLLVMTy = CGM.getTypes().ConvertTypeForMem(ElemTy);
+  llvm::LLVMContext &VMContext = CGM.getLLVMContext();
+
+  if (IsFloating) {
+    bool IsFloat = ElemLLVMTy->isFloatTy();
+    if (!IsFloat && !ElemLLVMTy->isDoubleTy())
+      return 0;
+    SmallVector<float, 64> Floats;
+    SmallVector<double, 64> Doubles;
+    for (unsigned I = 0; I != NumElements; ++I) {
+      const APValue &Elt = I < NumInitElts ? Value.getArrayInitializedElt(I)
+                                           : Value.getArrayFiller();
+      if (IsFloat)
+        Floats.push_back(Elt.getFloat().convertToFloat());
+      else
+        Doubles.push_back(Elt.getFloat().convertToDouble());
+    }
+    if (IsFloat)
+      return llvm::ConstantDataArray::get(VMContext, Floats);
+    return llvm::ConstantDataArray::get(VMContext, Doubles);
+  }
+
+  unsigned Width = Ctx.getIntWidth(ElemTy);
+  if ((Width != 8 && Width != 16 && Width != 32 && Width != 64) ||
+      !ElemLLVMTy->isIntegerTy(Width))
+    return 0;
+
+  SmallVector<uint64_t, 64> Values;
+  Values.reserve(NumElements);
+  for (unsigned I = 0; I != NumInitElts; ++I) {
+    const llvm::APSInt &Elt = Value.getArrayInitializedElt(I).getInt();
+    if (Elt.getBitWidth() != Width)
+      return 0;
+    Values.push_back(Elt.getZExtValue());
+  }
+  if (NumInitElts != NumElements) {
+    const llvm::APSInt &Filler = Value.getArrayFiller().getInt();
+    if (Filler.getBitWidth() != Width)
+      return 0;
+    Values.resize(NumElements, Filler.getZExtValue());
+  }
+
+  switch (Width) {
+  case 8:  return getDataArray<uint8_t>(VMContext, Values);
+  case 16: return getDataArray<uint16_t>(VMContext, Values);
+  case 32: return getDataArray<uint32_t>(VMContext, Values);
+  default: return getDataArray<uint64_t>(VMContext, Values);
+  }
+}
+
 llvm::Constant *CodeGenModule::EmitConstantInit(const VarDecl &D,
                                                 CodeGenFunction *CGF) {
   // Make a quick check if variable can be default NULL initialized
@@ -1009,6 +1290,10 @@ llvm::Constant *CodeGenModule::EmitConstantInit(const VarDecl &D,
       }
   }
   
+  if (const Expr *Init = D.getInit())
+    if (llvm::Constant *C = tryEmitScalarArrayInit(*this, Init, D.getType()))
+      return C;
+
   if (const APValue *Value = D.evaluateValue())
     return EmitConstantValueForMemory(*Value, D.getType(), CGF);
 
@@ -1179,6 +1464,9 @@ llvm::Constant *CodeGenModule::EmitConstantValue(const APValue &Value,
   case APValue::Union:
     return ConstStructBuilder::BuildStruct(*this, CGF, Value, DestType);
   case APValue::Array: {
+    if (llvm::Constant *C = tryEmitScalarArrayValue(*this, Value, DestType))
+      return C;
+
     const ArrayType *CAT = Context.getAsArrayType(DestType);
     unsigned NumElements = Value.getArraySize();
     unsigned NumInitElts = Value.getArrayInitializedElts();
@@ -293,6 +293,87 @@ shouldExtendReceiverForInnerPointerMessage(const ObjCMessageExpr *message) {
   llvm_unreachable("invalid receiver kind");
 }
 
+/// Try to emit a message send of a common selector as a call to the
+/// runtime entrypoint that implements it, which skips the method lookup of
+/// objc_msgSend:
+///   [cls alloc]         -> objc_alloc(cls)
+///   [obj retain]        -> objc_retain(obj)
+///   [obj release]       -> objc_release(obj)
+///   [obj autorelease]   -> objc_autorelease(obj)
+/// The selectors carry the usual memory-management semantics even when a
+/// class overrides them, and the entrypoints send the message themselves to
+/// such classes.
+///
+/// Returns false if the message has to be sent normally.
+static bool tryEmitSpecializedMessageSend(CodeGenFunction &CGF,
+                                          const ObjCMessageExpr *E,
+                                          QualType ResultType,
+                                          llvm::Value *Receiver,
+                                          bool isClassMessage,
+                                          RValue &Result) {
+  CodeGenModule &CGM = CGF.CGM;
+  if (!CGM.getCodeGenOpts().ObjCConvertMessagesToRuntimeCalls)
+    return false;
+
+  // GC code doesn't use these messages, and their runtime functions
+  // don't implement GC semantics.
+  if (CGM.getLangOpts().getGC() != LangOptions::NonGC)
+    return false;
+
+  Selector Sel = E->getSelector();
+  if (!Sel.isUnarySelector())
+    return false;
+
+  const ObjCRuntime &Runtime = CGM.getLangOpts().ObjCRuntime;
+  StringRef Name = Sel.getNameForSlot(0);
+  switch (Sel.getMethodFamily()) {
+  case OMF_alloc:
+    // 'alloc' is allowed in ARC, and the retain count of the result is
+    // the same either way.
+    if (isClassMessage && Name == "alloc" &&
+        Runtime.shouldUseRuntimeFunctionsForAlloc() &&
+        ResultType->isObjCObjectPointerType()) {
+      Result = RValue::get(CGF.EmitObjCAlloc(Receiver,
+                                             CGF.ConvertType(ResultType)));
+      return true;
+    }
+    return false;
+
+  case OMF_retain:
+    if (Name == "retain" && !CGM.getLangOpts().ObjCAutoRefCount &&
+        Runtime.shouldUseRuntimeFunctionsForRetainRelease() &&
+        ResultType->isObjCObjectPointerType()) {
+      Result = RValue::get(CGF.EmitObjCRetainNonBlock(
+          Receiver, CGF.ConvertType(ResultType)));
+      return true;
+    }
+    return false;
+
+  case OMF_release:
+    if (Name == "release" && !CGM.getLangOpts().ObjCAutoRefCount &&
+        Runtime.shouldUseRuntimeFunctionsForRetainRelease() &&
+        ResultType->isVoidType()) {
+      CGF.EmitObjCRelease(Receiver);
+      Result = RValue::get(0);
+      return true;
+    }
+    return false;
+
+  case OMF_autorelease:
+    if (Name == "autorelease" && !CGM.getLangOpts().ObjCAutoRefCount &&
+        Runtime.shouldUseRuntimeFunctionsForRetainRelease() &&
+        ResultType->isObjCObjectPointerType()) {
+      Result = RValue::get(CGF.EmitObjCAutorelease(
+          Receiver, CGF.ConvertType(ResultType)));
+      return true;
+    }
+    return false;
+
+  default:
+    return false;
+  }
+}
+
 RValue CodeGenFunction::EmitObjCMessageExpr(const ObjCMessageExpr *E,
                                             ReturnValueSlot Return) {
   // Only the lookup mechanism and first two arguments of the method
@@ -406,7 +487,8 @@ RValue CodeGenFunction::EmitObjCMessageExpr(const ObjCMessageExpr *E,
                                               isClassMessage,
                                               Args,
                                               method);
-  } else {
+  } else if (!tryEmitSpecializedMessageSend(*this, E, ResultType, Receiver,
+                                            isClassMessage, result)) {
     result = Runtime.GenerateMessageSend(*this, Return, ResultType,
                                          E->getSelector(),
                                          Receiver, Args, OID,
@@ -2301,6 +2383,73 @@ void CodeGenFunction::EmitObjCMRRAutoreleasePoolPop(llvm::Value *Arg) {
                               getContext().VoidTy, DrainSel, Arg, Args); 
 }
 
+/// Perform an operation having the signature
+///   i8* (i8*)
+/// on behalf of a message send in non-ARC code. Unlike the ARC operations,
+/// these can run the method of a class that overrides the message, so they
+/// may throw.
+static llvm::Value *emitObjCValueOperation(CodeGenFunction &CGF,
+                                           llvm::Value *value,
+                                           llvm::Type *returnType,
+                                           llvm::Constant *&fn,
+                                           StringRef fnName) {
+  if (isa<llvm::ConstantPointerNull>(value))
+    return CGF.Builder.CreateBitCast(value, returnType);
+
+  if (!fn) {
+    llvm::FunctionType *fnType =
+      llvm::FunctionType::get(CGF.Int8PtrTy, CGF.Int8PtrTy, false);
+    fn = createARCRuntimeFunction(CGF.CGM, fnType, fnName);
+  }
+
+  value = CGF.Builder.CreateBitCast(value, CGF.Int8PtrTy);
+  llvm::Value *result = CGF.EmitRuntimeCallOrInvoke(fn, value).getInstruction();
+  return CGF.Builder.CreateBitCast(result, returnType);
+}
+
+/// Allocate an instance of the given class, instead of [cls alloc].
+///   call i8* \@objc_alloc(i8* %cls)
+llvm::Value *CodeGenFunction::EmitObjCAlloc(llvm::Value *cls,
+                                            llvm::Type *resultType) {
+  return emitObjCValueOperation(*this, cls, resultType,
+                                CGM.getRREntrypoints().objc_alloc,
+                                "objc_alloc");
+}
+
+/// Retain the given object, instead of [value retain].
+///   call i8* \@objc_retain(i8* %value)
+llvm::Value *CodeGenFunction::EmitObjCRetainNonBlock(llvm::Value *value,
+                                                     llvm::Type *resultType) {
+  return emitObjCValueOperation(*this, value, resultType,
+                                CGM.getRREntrypoints().objc_retain,
+                                "objc_retain");
+}
+
+/// Release the given object, instead of [value release].
+///   call void \@objc_release(i8* %value)
+void CodeGenFunction::EmitObjCRelease(llvm::Value *value) {
+  if (isa<llvm::ConstantPointerNull>(value)) return;
+
+  llvm::Constant *&fn = CGM.getRREntrypoints().objc_release;
+  if (!fn) {
+    llvm::FunctionType *fnType =
+      llvm::FunctionType::get(Builder.getVoidTy(), Int8PtrTy, false);
+    fn = createARCRuntimeFunction(CGM, fnType, "objc_release");
+  }
+
+  value = Builder.CreateBitCast(value, Int8PtrTy);
+  EmitRuntimeCallOrInvoke(fn, value);
+}
+
+/// Autorelease the given object, instead of [value autorelease].
+///   call i8* \@objc_autorelease(i8* %value)
+llvm::Value *CodeGenFunction::EmitObjCAutorelease(llvm::Value *value,
+                                                  llvm::Type *resultType) {
+  return emitObjCValueOperation(*this, value, resultType,
+                                CGM.getRREntrypoints().objc_autorelease,
+                                "objc_autorelease");
+}
+
 void CodeGenFunction::destroyARCStrongPrecise(CodeGenFunction &CGF,
                                               llvm::Value *addr,
                                               QualType type) {
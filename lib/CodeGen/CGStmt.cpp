@@ -15,10 +15,13 @@
 #include "CGDebugInfo.h"
 #include "CodeGenModule.h"
 #include "TargetInfo.h"
+#include "clang/AST/Attr.h"
+#include "clang/AST/StmtOpenMP.h"
 #include "clang/AST/StmtVisitor.h"
 #include "clang/Sema/SemaDiagnostic.h"
 #include "clang/Basic/PrettyStackTrace.h"
 #include "clang/Basic/TargetInfo.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/IR/DataLayout.h"
 #include "llvm/IR/InlineAsm.h"
@@ -41,7 +44,7 @@ void CodeGenFunction::EmitStopPoint(const Stmt *S) {
   }
 }
 
-void CodeGenFunction::EmitStmt(const Stmt *S) {
+void CodeGenFunction::EmitStmt(const Stmt *S, llvm::MDNode *LoopID) {
   assert(S && "Null statement?");
 
   // These statements have their own debug info handling.
@@ -75,7 +78,6 @@ void CodeGenFunction::EmitStmt(const Stmt *S) {
   case Stmt::SEHExceptStmtClass:
   case Stmt::SEHFinallyStmtClass:
   case Stmt::MSDependentExistsStmtClass:
-  case Stmt::OMPParallelDirectiveClass:
     llvm_unreachable("invalid statement class to emit generically");
   case Stmt::NullStmtClass:
   case Stmt::CompoundStmtClass:
@@ -127,9 +129,11 @@ void CodeGenFunction::EmitStmt(const Stmt *S) {
     EmitIndirectGotoStmt(cast<IndirectGotoStmt>(*S)); break;
 
   case Stmt::IfStmtClass:       EmitIfStmt(cast<IfStmt>(*S));             break;
-  case Stmt::WhileStmtClass:    EmitWhileStmt(cast<WhileStmt>(*S));       break;
-  case Stmt::DoStmtClass:       EmitDoStmt(cast<DoStmt>(*S));             break;
-  case Stmt::ForStmtClass:      EmitForStmt(cast<ForStmt>(*S));           break;
+  case Stmt::WhileStmtClass:
+    EmitWhileStmt(cast<WhileStmt>(*S), LoopID);
+    break;
+  case Stmt::DoStmtClass:       EmitDoStmt(cast<DoStmt>(*S), LoopID);     break;
+  case Stmt::ForStmtClass:      EmitForStmt(cast<ForStmt>(*S), LoopID);   break;
 
   case Stmt::ReturnStmtClass:   EmitReturnStmt(cast<ReturnStmt>(*S));     break;
 
@@ -139,6 +143,12 @@ void CodeGenFunction::EmitStmt(const Stmt *S) {
   case Stmt::CapturedStmtClass:
     EmitCapturedStmt(cast<CapturedStmt>(*S), CR_Default);
     break;
+  case Stmt::OMPParallelDirectiveClass:
+    EmitOMPParallelDirective(cast<OMPParallelDirective>(*S));
+    break;
+  case Stmt::OMPSimdDirectiveClass:
+    EmitOMPSimdDirective(cast<OMPSimdDirective>(*S));
+    break;
   case Stmt::ObjCAtTryStmtClass:
     EmitObjCAtTryStmt(cast<ObjCAtTryStmt>(*S));
     break;
@@ -165,7 +175,7 @@ void CodeGenFunction::EmitStmt(const Stmt *S) {
     EmitCXXTryStmt(cast<CXXTryStmt>(*S));
     break;
   case Stmt::CXXForRangeStmtClass:
-    EmitCXXForRangeStmt(cast<CXXForRangeStmt>(*S));
+    EmitCXXForRangeStmt(cast<CXXForRangeStmt>(*S), LoopID);
   case Stmt::SEHTryStmtClass:
     // FIXME Not yet implemented
     break;
@@ -388,7 +398,66 @@ void CodeGenFunction::EmitLabelStmt(const LabelStmt &S) {
 }
 
 void CodeGenFunction::EmitAttributedStmt(const AttributedStmt &S) {
-  EmitStmt(S.getSubStmt());
+  EmitStmt(S.getSubStmt(), EmitLoopHints(S.getAttrs()));
+}
+
+llvm::MDNode *CodeGenFunction::CreateLoopID(
+    ArrayRef<llvm::Value *> Properties) {
+  // The loop identifier refers to itself, so that it is distinct from the
+  // identifiers of the other loops.
+  llvm::LLVMContext &Ctx = getLLVMContext();
+  SmallVector<llvm::Value *, 4> Ops;
+  llvm::MDNode *TempNode = llvm::MDNode::getTemporary(Ctx, None);
+  Ops.push_back(TempNode);
+  Ops.append(Properties.begin(), Properties.end());
+  llvm::MDNode *LoopID = llvm::MDNode::get(Ctx, Ops);
+  LoopID->replaceOperandWith(0, LoopID);
+  llvm::MDNode::deleteTemporary(TempNode);
+  return LoopID;
+}
+
+llvm::MDNode *CodeGenFunction::EmitLoopHints(ArrayRef<const Attr *> Attrs) {
+  llvm::LLVMContext &Ctx = getLLVMContext();
+  SmallVector<llvm::Value *, 4> Properties;
+  for (ArrayRef<const Attr *>::iterator I = Attrs.begin(), E = Attrs.end();
+       I != E; ++I) {
+    const LoopHintAttr *LH = dyn_cast<LoopHintAttr>(*I);
+    if (!LH)
+      continue;
+
+    const char *Name = 0;
+    llvm::Value *Value = 0;
+    switch (LH->getOption()) {
+    case LoopHintAttr::Vectorize:
+      Name = "llvm.vectorizer.enable";
+      Value = Builder.getInt1(LH->getValue());
+      break;
+    case LoopHintAttr::VectorizeWidth:
+      Name = "llvm.vectorizer.width";
+      Value = Builder.getInt32(LH->getValue());
+      break;
+    case LoopHintAttr::InterleaveCount:
+      // The loop vectorizer calls the interleave count its unroll factor.
+      Name = "llvm.vectorizer.unroll";
+      Value = Builder.getInt32(LH->getValue());
+      break;
+    case LoopHintAttr::Unroll:
+      Name = "llvm.loop.unroll.enable";
+      Value = Builder.getInt1(LH->getValue());
+      break;
+    case LoopHintAttr::UnrollCount:
+      Name = "llvm.loop.unroll.count";
+      Value = Builder.getInt32(LH->getValue());
+      break;
+    }
+
+    llvm::Value *Property[] = { llvm::MDString::get(Ctx, Name), Value };
+    Properties.push_back(llvm::MDNode::get(Ctx, Property));
+  }
+
+  if (Properties.empty())
+    return 0;
+  return CreateLoopID(Properties);
 }
 
 void CodeGenFunction::EmitGotoStmt(const GotoStmt &S) {
@@ -489,7 +558,8 @@ void CodeGenFunction::EmitIfStmt(const IfStmt &S) {
   EmitBlock(ContBlock, true);
 }
 
-void CodeGenFunction::EmitWhileStmt(const WhileStmt &S) {
+void CodeGenFunction::EmitWhileStmt(const WhileStmt &S,
+                                    llvm::MDNode *LoopID) {
   // Emit the header for the loop, which will also become
   // the continue target.
   JumpDest LoopHeader = getJumpDestInCurrentScope("while.cond");
@@ -533,7 +603,7 @@ void CodeGenFunction::EmitWhileStmt(const WhileStmt &S) {
     if (ConditionScope.requiresCleanups())
       ExitBlock = createBasicBlock("while.exit");
 
-    Builder.CreateCondBr(BoolCondVal, LoopBody, ExitBlock);
+    PGO.emitCondBr(Builder, &S, BoolCondVal, LoopBody, ExitBlock);
 
     if (ExitBlock != LoopExit.getBlock()) {
       EmitBlock(ExitBlock);
@@ -555,7 +625,10 @@ void CodeGenFunction::EmitWhileStmt(const WhileStmt &S) {
   ConditionScope.ForceCleanup();
 
   // Branch to the loop header again.
+  llvm::BasicBlock *LatchBlock = Builder.GetInsertBlock();
   EmitBranch(LoopHeader.getBlock());
+  if (LoopID && LatchBlock && LatchBlock->getTerminator())
+    LatchBlock->getTerminator()->setMetadata("llvm.loop", LoopID);
 
   // Emit the exit block.
   EmitBlock(LoopExit.getBlock(), true);
@@ -566,7 +639,7 @@ void CodeGenFunction::EmitWhileStmt(const WhileStmt &S) {
     SimplifyForwardingBlocks(LoopHeader.getBlock());
 }
 
-void CodeGenFunction::EmitDoStmt(const DoStmt &S) {
+void CodeGenFunction::EmitDoStmt(const DoStmt &S, llvm::MDNode *LoopID) {
   JumpDest LoopExit = getJumpDestInCurrentScope("do.end");
   JumpDest LoopCond = getJumpDestInCurrentScope("do.cond");
 
@@ -601,8 +674,12 @@ void CodeGenFunction::EmitDoStmt(const DoStmt &S) {
       EmitBoolCondBranch = false;
 
   // As long as the condition is true, iterate the loop.
-  if (EmitBoolCondBranch)
-    Builder.CreateCondBr(BoolCondVal, LoopBody, LoopExit.getBlock());
+  if (EmitBoolCondBranch) {
+    llvm::BranchInst *CondBr =
+      PGO.emitCondBr(Builder, &S, BoolCondVal, LoopBody, LoopExit.getBlock());
+    if (LoopID)
+      CondBr->setMetadata("llvm.loop", LoopID);
+  }
 
   // Emit the exit block.
   EmitBlock(LoopExit.getBlock());
@@ -613,9 +690,35 @@ void CodeGenFunction::EmitDoStmt(const DoStmt &S) {
     SimplifyForwardingBlocks(LoopCond.getBlock());
 }
 
-void CodeGenFunction::EmitForStmt(const ForStmt &S) {
+/// \brief Mark the loads and stores of the blocks of \p Fn that are not in
+/// \p OldBlocks as parallel accesses of the loop \p LoopID.
+static void markParallelLoopAccesses(
+    llvm::Function *Fn,
+    const llvm::SmallPtrSet<llvm::BasicBlock *, 32> &OldBlocks,
+    llvm::MDNode *LoopID) {
+  for (llvm::Function::iterator BB = Fn->begin(), BE = Fn->end(); BB != BE;
+       ++BB) {
+    if (OldBlocks.count(BB))
+      continue;
+    for (llvm::BasicBlock::iterator I = BB->begin(), E = BB->end(); I != E;
+         ++I)
+      if (isa<llvm::LoadInst>(I) || isa<llvm::StoreInst>(I))
+        I->setMetadata("llvm.mem.parallel_loop_access", LoopID);
+  }
+}
+
+void CodeGenFunction::EmitForStmt(const ForStmt &S, llvm::MDNode *LoopID,
+                                  bool IsParallel) {
   JumpDest LoopExit = getJumpDestInCurrentScope("for.end");
 
+  // The blocks emitted from here on belong to the loop, or are only run when
+  // leaving it.
+  llvm::SmallPtrSet<llvm::BasicBlock *, 32> OldBlocks;
+  if (LoopID && IsParallel)
+    for (llvm::Function::iterator BB = CurFn->begin(), E = CurFn->end();
+         BB != E; ++BB)
+      OldBlocks.insert(BB);
+
   RunCleanupsScope ForScope(*this);
 
   CGDebugInfo *DI = getDebugInfo();
@@ -656,7 +759,7 @@ void CodeGenFunction::EmitForStmt(const ForStmt &S) {
     // C99 6.8.5p2/p4: The first substatement is executed if the expression
     // compares unequal to 0.  The condition must be a scalar type.
     BoolCondVal = EvaluateExprAsBool(S.getCond());
-    Builder.CreateCondBr(BoolCondVal, ForBody, ExitBlock);
+    PGO.emitCondBr(Builder, &S, BoolCondVal, ForBody, ExitBlock);
 
     if (ExitBlock != LoopExit.getBlock()) {
       EmitBlock(ExitBlock);
@@ -695,8 +798,14 @@ void CodeGenFunction::EmitForStmt(const ForStmt &S) {
   BreakContinueStack.pop_back();
 
   ConditionScope.ForceCleanup();
+  llvm::BasicBlock *LatchBlock = Builder.GetInsertBlock();
   EmitBranch(CondBlock);
 
+  if (LoopID && LatchBlock && LatchBlock->getTerminator())
+    LatchBlock->getTerminator()->setMetadata("llvm.loop", LoopID);
+  if (LoopID && IsParallel)
+    markParallelLoopAccesses(CurFn, OldBlocks, LoopID);
+
   ForScope.ForceCleanup();
 
   if (DI)
@@ -706,7 +815,8 @@ void CodeGenFunction::EmitForStmt(const ForStmt &S) {
   EmitBlock(LoopExit.getBlock(), true);
 }
 
-void CodeGenFunction::EmitCXXForRangeStmt(const CXXForRangeStmt &S) {
+void CodeGenFunction::EmitCXXForRangeStmt(const CXXForRangeStmt &S,
+                                          llvm::MDNode *LoopID) {
   JumpDest LoopExit = getJumpDestInCurrentScope("for.end");
 
   RunCleanupsScope ForScope(*this);
@@ -737,7 +847,7 @@ void CodeGenFunction::EmitCXXForRangeStmt(const CXXForRangeStmt &S) {
   // The body is executed if the expression, contextually converted
   // to bool, is true.
   llvm::Value *BoolCondVal = EvaluateExprAsBool(S.getCond());
-  Builder.CreateCondBr(BoolCondVal, ForBody, ExitBlock);
+  PGO.emitCondBr(Builder, &S, BoolCondVal, ForBody, ExitBlock);
 
   if (ExitBlock != LoopExit.getBlock()) {
     EmitBlock(ExitBlock);
@@ -765,7 +875,10 @@ void CodeGenFunction::EmitCXXForRangeStmt(const CXXForRangeStmt &S) {
 
   BreakContinueStack.pop_back();
 
+  llvm::BasicBlock *LatchBlock = Builder.GetInsertBlock();
   EmitBranch(CondBlock);
+  if (LoopID && LatchBlock && LatchBlock->getTerminator())
+    LatchBlock->getTerminator()->setMetadata("llvm.loop", LoopID);
 
   ForScope.ForceCleanup();
 
@@ -1769,20 +1882,20 @@ void CodeGenFunction::EmitAsmStmt(const AsmStmt &S) {
   }
 }
 
-static LValue InitCapturedStruct(CodeGenFunction &CGF, const CapturedStmt &S) {
+LValue CodeGenFunction::InitCapturedStruct(const CapturedStmt &S) {
   const RecordDecl *RD = S.getCapturedRecordDecl();
-  QualType RecordTy = CGF.getContext().getRecordType(RD);
+  QualType RecordTy = getContext().getRecordType(RD);
 
   // Initialize the captured struct.
-  LValue SlotLV = CGF.MakeNaturalAlignAddrLValue(
-                    CGF.CreateMemTemp(RecordTy, "agg.captured"), RecordTy);
+  LValue SlotLV = MakeNaturalAlignAddrLValue(
+                    CreateMemTemp(RecordTy, "agg.captured"), RecordTy);
 
   RecordDecl::field_iterator CurField = RD->field_begin();
   for (CapturedStmt::capture_init_iterator I = S.capture_init_begin(),
                                            E = S.capture_init_end();
        I != E; ++I, ++CurField) {
-    LValue LV = CGF.EmitLValueForFieldInitialization(SlotLV, *CurField);
-    CGF.EmitInitializerForField(*CurField, LV, *I, ArrayRef<VarDecl *>());
+    LValue LV = EmitLValueForFieldInitialization(SlotLV, *CurField);
+    EmitInitializerForField(*CurField, LV, *I, ArrayRef<VarDecl *>());
   }
 
   return SlotLV;
@@ -1796,7 +1909,7 @@ CodeGenFunction::EmitCapturedStmt(const CapturedStmt &S, CapturedRegionKind K) {
   const RecordDecl *RD = S.getCapturedRecordDecl();
   assert(CD->hasBody() && "missing CapturedDecl body");
 
-  LValue CapStruct = InitCapturedStruct(*this, S);
+  LValue CapStruct = InitCapturedStruct(S);
 
   // Emit the CapturedDecl
   CodeGenFunction CGF(CGM, true);
@@ -0,0 +1,182 @@
+//===--- CGStmtOpenMP.cpp - Emit LLVM Code from OpenMP Statements ---------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This contains code to emit OpenMP directives as LLVM code.
+//
+// The parallel regions are outlined like other captured statements, and run
+// through the GNU OpenMP runtime (libgomp), which the driver links with
+// -fopenmp. Since the region captures the variables it uses by reference,
+// they are shared between the threads unless a clause makes them private.
+//
+// The simd loops are emitted inline, with loop metadata telling the loop
+// vectorizer that their iterations can be run concurrently.
+//
+//===----------------------------------------------------------------------===//
+
+#include "CodeGenFunction.h"
+#include "CodeGenModule.h"
+#include "clang/AST/StmtOpenMP.h"
+
+using namespace clang;
+using namespace CodeGen;
+
+namespace {
+/// \brief Emits the body of an OpenMP parallel region, in the outlined
+/// function run by each thread of the team.
+class CGOpenMPRegionInfo : public CodeGenFunction::CGCapturedStmtInfo {
+  const OMPParallelDirective &Directive;
+
+public:
+  CGOpenMPRegionInfo(const OMPParallelDirective &Directive,
+                     const CapturedStmt &S)
+    : CGCapturedStmtInfo(S), Directive(Directive) {}
+
+  virtual void EmitBody(CodeGenFunction &CGF, Stmt *S) {
+    CGF.EmitOMPPrivateClauses(Directive);
+    CGF.EmitStmt(S);
+  }
+
+  virtual StringRef getHelperName() const { return "__omp_outlined"; }
+};
+}
+
+/// \brief Returns true if a private copy of \p VD is correctly initialized by
+/// just allocating it.
+static bool canEmitPrivateCopy(ASTContext &Ctx, const VarDecl *VD) {
+  // References to globals don't go through the local declarations.
+  if (VD->hasLinkage() || VD->isStaticDataMember())
+    return false;
+
+  QualType Ty = VD->getType();
+  if (Ty->isVariablyModifiedType())
+    return false;
+
+  const CXXRecordDecl *RD = Ctx.getBaseElementType(Ty)->getAsCXXRecordDecl();
+  return !RD ||
+         (RD->hasTrivialDefaultConstructor() && RD->hasTrivialDestructor());
+}
+
+/// \brief Collects the variables of the private clauses of \p S.
+static void getPrivateVars(const OMPExecutableDirective &S,
+                           SmallVectorImpl<const VarDecl *> &Vars) {
+  ArrayRef<OMPClause *> Clauses = S.clauses();
+  for (ArrayRef<OMPClause *>::iterator I = Clauses.begin(), E = Clauses.end();
+       I != E; ++I) {
+    const OMPPrivateClause *C = dyn_cast<OMPPrivateClause>(*I);
+    if (!C)
+      continue;
+
+    for (OMPPrivateClause::varlist_const_iterator VI = C->varlist_begin(),
+                                                  VE = C->varlist_end();
+         VI != VE; ++VI)
+      Vars.push_back(cast<VarDecl>(cast<DeclRefExpr>(*VI)->getDecl()));
+  }
+}
+
+void CodeGenFunction::EmitOMPPrivateClauses(const OMPExecutableDirective &S) {
+  SmallVector<const VarDecl *, 4> Vars;
+  getPrivateVars(S, Vars);
+  for (unsigned i = 0, e = Vars.size(); i != e; ++i) {
+    const VarDecl *VD = Vars[i];
+    if (!canEmitPrivateCopy(getContext(), VD)) {
+      ErrorUnsupported(&S, "OpenMP private variable");
+      continue;
+    }
+
+    // The private copy hides the captured variable in the region: local
+    // declarations are looked up before the captured fields.
+    LocalDeclMap[VD] = CreateMemTemp(VD->getType(),
+                                     VD->getName() + ".private");
+  }
+}
+
+void CodeGenFunction::EmitOMPParallelDirective(const OMPParallelDirective &S) {
+  const CapturedStmt *CS = cast<CapturedStmt>(S.getAssociatedStmt());
+  const CapturedDecl *CD = CS->getCapturedDecl();
+  const RecordDecl *RD = CS->getCapturedRecordDecl();
+  assert(CD->hasBody() && "missing CapturedDecl body");
+
+  LValue CapStruct = InitCapturedStruct(*CS);
+
+  // Outline the region.
+  CodeGenFunction CGF(CGM, true);
+  CGOpenMPRegionInfo RegionInfo(S, *CS);
+  CGF.CapturedStmtInfo = &RegionInfo;
+  llvm::Function *OutlinedFn = CGF.GenerateCapturedStmtFunction(CD, RD);
+  CGF.CapturedStmtInfo = 0;
+
+  // void GOMP_parallel_start(void (*fn)(void *), void *data,
+  //                          unsigned num_threads);
+  // starts the other threads of the team, which call fn(data). A zero
+  // num_threads lets the runtime pick the number of threads.
+  llvm::Type *FnTy = llvm::FunctionType::get(VoidTy, VoidPtrTy, false);
+  llvm::Type *StartParams[] = { FnTy->getPointerTo(), VoidPtrTy, Int32Ty };
+  llvm::Constant *StartFn = CGM.CreateRuntimeFunction(
+      llvm::FunctionType::get(VoidTy, StartParams, false),
+      "GOMP_parallel_start");
+  llvm::Value *StartArgs[] = {
+    Builder.CreateBitCast(OutlinedFn, FnTy->getPointerTo()),
+    Builder.CreateBitCast(CapStruct.getAddress(), VoidPtrTy),
+    Builder.getInt32(0)
+  };
+  EmitNounwindRuntimeCall(StartFn, StartArgs);
+
+  // The encountering thread is the master of the team and runs the region
+  // too.
+  EmitCallOrInvoke(OutlinedFn, CapStruct.getAddress());
+
+  // void GOMP_parallel_end(void);
+  // waits for the rest of the team.
+  llvm::Constant *EndFn = CGM.CreateRuntimeFunction(
+      llvm::FunctionType::get(VoidTy, false), "GOMP_parallel_end");
+  EmitNounwindRuntimeCall(EndFn);
+}
+
+void CodeGenFunction::EmitOMPSimdDirective(const OMPSimdDirective &S) {
+  const ForStmt *For = cast<ForStmt>(S.getAssociatedStmt());
+
+  // With a safelen clause, only that many consecutive iterations may run
+  // concurrently, which is the vectorization factor to use. Without it, the
+  // loop has no loop-carried dependences at all.
+  const OMPSafelenClause *Safelen = 0;
+  ArrayRef<OMPClause *> Clauses = S.clauses();
+  for (ArrayRef<OMPClause *>::iterator I = Clauses.begin(), E = Clauses.end();
+       I != E; ++I)
+    if (const OMPSafelenClause *C = dyn_cast<OMPSafelenClause>(*I))
+      Safelen = C;
+
+  SmallVector<llvm::Value *, 1> LoopProperties;
+  if (Safelen) {
+    llvm::APSInt Len =
+      Safelen->getSafelen()->EvaluateKnownConstInt(getContext());
+    llvm::Value *Width[] = {
+      llvm::MDString::get(getLLVMContext(), "llvm.vectorizer.width"),
+      Builder.getInt32(Len.getLimitedValue(UINT32_MAX))
+    };
+    LoopProperties.push_back(llvm::MDNode::get(getLLVMContext(), Width));
+  }
+  llvm::MDNode *LoopID = CreateLoopID(LoopProperties);
+
+  // The private copies are only used in the loop.
+  SmallVector<const VarDecl *, 4> Privates;
+  getPrivateVars(S, Privates);
+  SmallVector<llvm::Value *, 4> SavedAddrs;
+  for (unsigned i = 0, e = Privates.size(); i != e; ++i)
+    SavedAddrs.push_back(LocalDeclMap.lookup(Privates[i]));
+  EmitOMPPrivateClauses(S);
+
+  EmitForStmt(*For, LoopID, /*IsParallel=*/!Safelen);
+
+  for (unsigned i = 0, e = Privates.size(); i != e; ++i) {
+    if (SavedAddrs[i])
+      LocalDeclMap[Privates[i]] = SavedAddrs[i];
+    else
+      LocalDeclMap.erase(Privates[i]);
+  }
+}
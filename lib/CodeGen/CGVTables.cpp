@@ -13,6 +13,7 @@
 
 #include "CodeGenFunction.h"
 #include "CGCXXABI.h"
+#include "CGDebugInfo.h"
 #include "CodeGenModule.h"
 #include "clang/AST/CXXInheritance.h"
 #include "clang/AST/RecordLayout.h"
@@ -38,19 +39,24 @@ CodeGenVTables::CodeGenVTables(CodeGenModule &CGM)
   }
 }
 
-llvm::Constant *CodeGenModule::GetAddrOfThunk(GlobalDecl GD, 
-                                              const ThunkInfo &Thunk) {
+/// Compute the mangled name of the given thunk.
+static void getThunkName(CodeGenModule &CGM, GlobalDecl GD,
+                         const ThunkInfo &Thunk, SmallVectorImpl<char> &Name) {
   const CXXMethodDecl *MD = cast<CXXMethodDecl>(GD.getDecl());
+  MangleContext &MC = CGM.getCXXABI().getMangleContext();
 
-  // Compute the mangled name.
-  SmallString<256> Name;
   llvm::raw_svector_ostream Out(Name);
   if (const CXXDestructorDecl* DD = dyn_cast<CXXDestructorDecl>(MD))
-    getCXXABI().getMangleContext().mangleCXXDtorThunk(DD, GD.getDtorType(),
-                                                      Thunk.This, Out);
+    MC.mangleCXXDtorThunk(DD, GD.getDtorType(), Thunk.This, Out);
   else
-    getCXXABI().getMangleContext().mangleThunk(MD, Thunk, Out);
+    MC.mangleThunk(MD, Thunk, Out);
   Out.flush();
+}
+
+llvm::Constant *CodeGenModule::GetAddrOfThunk(GlobalDecl GD, 
+                                              const ThunkInfo &Thunk) {
+  SmallString<256> Name;
+  getThunkName(*this, GD, Thunk, Name);
 
   llvm::Type *Ty = getTypes().GetFunctionTypeForVTable(GD);
   return GetOrCreateLLVMFunction(Name, Ty, GD, /*ForVTable=*/true);
@@ -508,9 +514,25 @@ void CodeGenVTables::EmitThunks(GlobalDecl GD)
   if (!ThunkInfoVector)
     return;
 
-  for (unsigned I = 0, E = ThunkInfoVector->size(); I != E; ++I)
-    EmitThunk(GD, (*ThunkInfoVector)[I],
-              /*UseAvailableExternallyLinkage=*/false);
+  // Thunks are only called through vtables.  If a thunk can be discarded
+  // when unused, and no vtable emitted so far refers to it, leave it until
+  // one does; the vtables of a class whose key function is defined in
+  // another translation unit are never emitted here at all.
+  bool CanDefer = llvm::GlobalValue::isDiscardableIfUnused(
+      CGM.getFunctionLinkage(GD));
+
+  for (unsigned I = 0, E = ThunkInfoVector->size(); I != E; ++I) {
+    const ThunkInfo &Thunk = (*ThunkInfoVector)[I];
+    if (CanDefer) {
+      SmallString<256> Name;
+      getThunkName(CGM, GD, Thunk, Name);
+      if (!CGM.GetGlobalValue(Name)) {
+        DeferredThunks[GD.getWithDecl(MD)] = GD;
+        continue;
+      }
+    }
+    EmitThunk(GD, Thunk, /*UseAvailableExternallyLinkage=*/false);
+  }
 }
 
 llvm::Constant *
@@ -608,6 +630,22 @@ CodeGenVTables::CreateVTableInitializer(const CXXRecordDecl *RD,
           MaybeEmitThunkAvailableExternally(GD, Thunk);
           Init = CGM.GetAddrOfThunk(GD, Thunk);
 
+          // If the function has been emitted without this thunk, emit the
+          // thunk now that something refers to it.
+          llvm::DenseMap<GlobalDecl, GlobalDecl>::iterator Deferred =
+            DeferredThunks.find(GD.getWithDecl(
+                cast<CXXMethodDecl>(GD.getDecl())->getCanonicalDecl()));
+          if (Deferred != DeferredThunks.end()) {
+            llvm::GlobalValue *ThunkFn =
+              cast<llvm::GlobalValue>(Init->stripPointerCasts());
+            if (ThunkFn->isDeclaration() ||
+                ThunkFn->hasAvailableExternallyLinkage()) {
+              EmitThunk(Deferred->second, Thunk,
+                        /*UseAvailableExternallyLinkage=*/false);
+              Init = CGM.GetAddrOfThunk(GD, Thunk);
+            }
+          }
+
           NextVTableThunkIndex++;
         } else {
           llvm::Type *Ty = CGM.getTypes().GetFunctionTypeForVTable(GD);
@@ -837,6 +875,9 @@ CodeGenVTables::GenerateClassData(const CXXRecordDecl *RD) {
   llvm::GlobalVariable::LinkageTypes Linkage = CGM.getVTableLinkage(RD);
   EmitVTableDefinition(VTable, Linkage, RD);
 
+  if (CGDebugInfo *DI = CGM.getModuleDebugInfo())
+    DI->completeClassData(RD);
+
   if (RD->getNumVBases())
     CGM.getCXXABI().EmitVirtualInheritanceTables(Linkage, RD);
 
@@ -53,6 +53,11 @@ class CodeGenVTables {
   /// indices.
   SecondaryVirtualPointerIndicesMapTy SecondaryVirtualPointerIndices;
 
+  /// DeferredThunks - The virtual functions that have been emitted while
+  /// some of their discardable thunks were left for the vtables that refer
+  /// to them to emit, keyed on their canonical declarations.
+  llvm::DenseMap<GlobalDecl, GlobalDecl> DeferredThunks;
+
   /// EmitThunk - Emit a single thunk.
   void EmitThunk(GlobalDecl GD, const ThunkInfo &Thunk, 
                  bool UseAvailableExternallyLinkage);
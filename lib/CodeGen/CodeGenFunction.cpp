@@ -49,7 +49,7 @@ CodeGenFunction::CodeGenFunction(CodeGenModule &cgm, bool suppressNewContext)
     CXXDefaultInitExprThis(0),
     CXXStructorImplicitParamDecl(0), CXXStructorImplicitParamValue(0),
     OutermostConditional(0), CurLexicalScope(0), TerminateLandingPad(0),
-    TerminateHandler(0), TrapBB(0) {
+    TerminateHandler(0), TrapBB(0), SanitizerCheckedBB(0), PGO(cgm) {
   if (!suppressNewContext)
     CGM.getCXXABI().getMangleContext().startNewFunction();
 
@@ -683,6 +683,7 @@ void CodeGenFunction::GenerateCode(GlobalDecl GD, llvm::Function *Fn,
 
   // Emit the standard function prologue.
   StartFunction(GD, ResTy, Fn, FnInfo, Args, BodyRange.getBegin());
+  PGO.startFunction(Fn, Builder);
 
   // Generate the body of the function.
   if (isa<CXXDestructorDecl>(FD))
@@ -732,6 +733,7 @@ void CodeGenFunction::GenerateCode(GlobalDecl GD, llvm::Function *Fn,
 
   // Emit the standard function epilogue.
   FinishFunction(BodyRange.getEnd());
+  PGO.finishFunction(Fn);
 
   // If we haven't marked the function nothrow through other means, do
   // a quick pass now to see if we can.
@@ -948,7 +950,70 @@ void CodeGenFunction::EmitBranchOnBoolExpr(const Expr *Cond,
 
   // Emit the code with the fully general case.
   llvm::Value *CondV = EvaluateExprAsBool(Cond);
-  Builder.CreateCondBr(CondV, TrueBlock, FalseBlock);
+  PGO.emitCondBr(Builder, Cond, CondV, TrueBlock, FalseBlock);
+}
+
+void CodeGenFunction::EmitAssumption(llvm::Value *Cond) {
+  // Assumptions only matter to the optimizers.
+  if (CGM.getCodeGenOpts().OptimizationLevel == 0)
+    return;
+
+  // The IR has no way to state an assumption, so branch to unreachable when
+  // it doesn't hold, like "if (!cond) __builtin_unreachable();" does.
+  llvm::BasicBlock *Cont = createBasicBlock("assume.cont");
+  llvm::BasicBlock *Violated = createBasicBlock("assume.violated");
+  Builder.CreateCondBr(Cond, Cont, Violated);
+  EmitBlock(Violated);
+  Builder.CreateUnreachable();
+  EmitBlock(Cont);
+}
+
+void CodeGenFunction::EmitAlignmentAssumption(llvm::Value *PtrValue,
+                                              llvm::Value *Alignment,
+                                              llvm::Value *OffsetValue) {
+  if (CGM.getCodeGenOpts().OptimizationLevel == 0)
+    return;
+
+  llvm::Value *PtrIntValue = Builder.CreatePtrToInt(PtrValue, IntPtrTy,
+                                                    "ptrint");
+  if (OffsetValue) {
+    OffsetValue = Builder.CreateIntCast(OffsetValue, IntPtrTy,
+                                        /*isSigned=*/true);
+    PtrIntValue = Builder.CreateSub(PtrIntValue, OffsetValue, "offsetptr");
+  }
+
+  Alignment = Builder.CreateIntCast(Alignment, IntPtrTy, /*isSigned=*/false);
+  llvm::Value *Mask = Builder.CreateSub(Alignment,
+                                        llvm::ConstantInt::get(IntPtrTy, 1),
+                                        "mask");
+  llvm::Value *MaskedPtr = Builder.CreateAnd(PtrIntValue, Mask, "maskedptr");
+  llvm::Value *Zero = llvm::ConstantInt::get(IntPtrTy, 0);
+  EmitAssumption(Builder.CreateICmpEQ(MaskedPtr, Zero, "maskcond"));
+}
+
+void
+CodeGenFunction::EmitCallAlignmentAssumptions(const Decl *TargetDecl,
+                                              llvm::Value *RetValue,
+                                              const CallArgList &CallArgs) {
+  if (const AssumeAlignedAttr *AA = TargetDecl->getAttr<AssumeAlignedAttr>()) {
+    llvm::Value *OffsetValue = 0;
+    if (AA->getOffset())
+      OffsetValue = llvm::ConstantInt::get(IntPtrTy, AA->getOffset());
+    EmitAlignmentAssumption(RetValue,
+                            llvm::ConstantInt::get(IntPtrTy,
+                                                   AA->getAlignment()),
+                            OffsetValue);
+  }
+
+  if (const AllocAlignAttr *AA = TargetDecl->getAttr<AllocAlignAttr>()) {
+    // The index doesn't count the implicit object argument.
+    unsigned Index = AA->getParamIndex();
+    if (const CXXMethodDecl *MD = dyn_cast<CXXMethodDecl>(TargetDecl))
+      if (MD->isInstance())
+        ++Index;
+    if (Index < CallArgs.size() && CallArgs[Index].RV.isScalar())
+      EmitAlignmentAssumption(RetValue, CallArgs[Index].RV.getScalarVal());
+  }
 }
 
 /// ErrorUnsupported - Print out an error that codegen doesn't support the
@@ -19,6 +19,7 @@
 #include "CGValue.h"
 #include "EHScopeStack.h"
 #include "CodeGenModule.h"
+#include "CodeGenPGO.h"
 #include "clang/AST/CharUnits.h"
 #include "clang/AST/ExprCXX.h"
 #include "clang/AST/ExprObjC.h"
@@ -70,6 +71,9 @@ namespace clang {
   class ObjCAtThrowStmt;
   class ObjCAtSynchronizedStmt;
   class ObjCAutoreleasePoolStmt;
+  class OMPExecutableDirective;
+  class OMPParallelDirective;
+  class OMPSimdDirective;
 
 namespace CodeGen {
   class CodeGenTypes;
@@ -934,6 +938,16 @@ private:
   llvm::BasicBlock *TerminateHandler;
   llvm::BasicBlock *TrapBB;
 
+  /// The conditions of the checks emitted so far in straight-line code that
+  /// don't return when they fail, which hold in SanitizerCheckedBB, the block
+  /// after the last check. A check of the same condition there is redundant.
+  SmallVector<llvm::WeakVH, 8> SanitizerCheckedConds;
+  llvm::BasicBlock *SanitizerCheckedBB;
+
+  /// PGO - The profile counters of the function, with
+  /// -fprofile-instr-generate or -fprofile-instr-use.
+  CodeGenPGO PGO;
+
   /// Add a kernel metadata node to the named metadata node 'opencl.kernels'.
   /// In the kernel metadata node, reference the kernel function and metadata 
   /// nodes for its optional attribute qualifiers (OpenCL 1.1 6.7.2):
@@ -1792,7 +1806,9 @@ public:
   /// This function may clear the current insertion point; callers should use
   /// EnsureInsertPoint if they wish to subsequently generate code without first
   /// calling EmitBlock, EmitBranch, or EmitStmt.
-  void EmitStmt(const Stmt *S);
+  ///
+  /// If \p S is a loop, a non-null \p LoopID is attached to its back edge.
+  void EmitStmt(const Stmt *S, llvm::MDNode *LoopID = 0);
 
   /// EmitSimpleStmt - Try to emit a "simple" statement which does not
   /// necessarily require an insertion point or debug information; typically
@@ -1815,12 +1831,26 @@ public:
 
   void EmitLabelStmt(const LabelStmt &S);
   void EmitAttributedStmt(const AttributedStmt &S);
+
+  /// \brief Create a loop identifier with the given properties, for the
+  /// llvm.loop metadata of the back edge of a loop.
+  llvm::MDNode *CreateLoopID(ArrayRef<llvm::Value *> Properties);
+
+  /// \brief Create the loop identifier for the '#pragma clang loop' hints
+  /// among \p Attrs, or return null if there are none.
+  llvm::MDNode *EmitLoopHints(ArrayRef<const Attr *> Attrs);
+
   void EmitGotoStmt(const GotoStmt &S);
   void EmitIndirectGotoStmt(const IndirectGotoStmt &S);
   void EmitIfStmt(const IfStmt &S);
-  void EmitWhileStmt(const WhileStmt &S);
-  void EmitDoStmt(const DoStmt &S);
-  void EmitForStmt(const ForStmt &S);
+  void EmitWhileStmt(const WhileStmt &S, llvm::MDNode *LoopID = 0);
+  void EmitDoStmt(const DoStmt &S, llvm::MDNode *LoopID = 0);
+  /// \brief Emit the for statement \p S. If \p LoopID is not null, it is
+  /// attached to the back edge of the loop, and if \p IsParallel is true,
+  /// the memory accesses in the loop are marked as free of loop-carried
+  /// dependences.
+  void EmitForStmt(const ForStmt &S, llvm::MDNode *LoopID = 0,
+                   bool IsParallel = false);
   void EmitReturnStmt(const ReturnStmt &S);
   void EmitDeclStmt(const DeclStmt &S);
   void EmitBreakStmt(const BreakStmt &S);
@@ -1843,11 +1873,20 @@ public:
   void ExitCXXTryStmt(const CXXTryStmt &S, bool IsFnTryBlock = false);
 
   void EmitCXXTryStmt(const CXXTryStmt &S);
-  void EmitCXXForRangeStmt(const CXXForRangeStmt &S);
+  void EmitCXXForRangeStmt(const CXXForRangeStmt &S,
+                           llvm::MDNode *LoopID = 0);
 
   llvm::Function *EmitCapturedStmt(const CapturedStmt &S, CapturedRegionKind K);
   llvm::Function *GenerateCapturedStmtFunction(const CapturedDecl *CD,
                                                const RecordDecl *RD);
+  /// \brief Store the captured variables of \p S into a new captured struct.
+  LValue InitCapturedStruct(const CapturedStmt &S);
+
+  void EmitOMPParallelDirective(const OMPParallelDirective &S);
+  void EmitOMPSimdDirective(const OMPSimdDirective &S);
+  /// \brief Allocate the private copies of the variables in the private
+  /// clauses of \p S, used instead of the variables in the current region.
+  void EmitOMPPrivateClauses(const OMPExecutableDirective &S);
 
   //===--------------------------------------------------------------------===//
   //                         LValue Expression Emission
@@ -2231,6 +2270,13 @@ public:
   void EmitObjCAutoreleasePoolCleanup(llvm::Value *Ptr);
   void EmitObjCMRRAutoreleasePoolPop(llvm::Value *Ptr); 
 
+  llvm::Value *EmitObjCAlloc(llvm::Value *Class, llvm::Type *ResultType);
+  llvm::Value *EmitObjCRetainNonBlock(llvm::Value *Value,
+                                      llvm::Type *ResultType);
+  void EmitObjCRelease(llvm::Value *Value);
+  llvm::Value *EmitObjCAutorelease(llvm::Value *Value,
+                                   llvm::Type *ResultType);
+
   /// \brief Emits a reference binding to the passed in expression.
   RValue EmitReferenceBindingToExpr(const Expr *E);
 
@@ -2403,6 +2449,21 @@ public:
   void EmitBranchOnBoolExpr(const Expr *Cond, llvm::BasicBlock *TrueBlock,
                             llvm::BasicBlock *FalseBlock);
 
+  /// \brief Tell the optimizers that \p Cond, an i1, is true at this point.
+  void EmitAssumption(llvm::Value *Cond);
+
+  /// \brief Tell the optimizers that the pointer \p PtrValue, minus
+  /// \p OffsetValue if it's given, is a multiple of \p Alignment.
+  void EmitAlignmentAssumption(llvm::Value *PtrValue, llvm::Value *Alignment,
+                               llvm::Value *OffsetValue = 0);
+
+  /// \brief Emit the alignment assumptions of the assume_aligned and
+  /// alloc_align attributes of \p TargetDecl on the pointer \p RetValue it
+  /// returned when called with \p CallArgs.
+  void EmitCallAlignmentAssumptions(const Decl *TargetDecl,
+                                    llvm::Value *RetValue,
+                                    const CallArgList &CallArgs);
+
   /// \brief Emit a description of a type in a format suitable for passing to
   /// a runtime sanitizer handler.
   llvm::Constant *EmitCheckTypeDescriptor(QualType T);
@@ -2437,6 +2498,15 @@ public:
   /// conditional branch to it, for the -ftrapv checks.
   void EmitTrapCheck(llvm::Value *Checked);
 
+  /// \brief Returns true if a check of \p Checked at the insertion point is
+  /// redundant, because an earlier check of the same condition would have
+  /// ended the program.
+  bool isRedundantCheck(llvm::Value *Checked);
+
+  /// \brief Note a check of \p Checked that ends the program if \p IsFatal,
+  /// once the insertion point is in the block after it.
+  void noteCheck(llvm::Value *Checked, bool IsFatal);
+
   /// EmitCallArg - Emit a single call argument.
   void EmitCallArg(CallArgList &args, const Expr *E, QualType ArgType);
 
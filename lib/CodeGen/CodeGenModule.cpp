@@ -19,6 +19,7 @@
 #include "CGObjCRuntime.h"
 #include "CGOpenCLRuntime.h"
 #include "CodeGenFunction.h"
+#include "CodeGenPGO.h"
 #include "CodeGenTBAA.h"
 #include "TargetInfo.h"
 #include "clang/AST/ASTContext.h"
@@ -35,8 +36,11 @@
 #include "clang/Basic/Module.h"
 #include "clang/Basic/SourceManager.h"
 #include "clang/Basic/TargetInfo.h"
+#include "clang/Basic/TimeTrace.h"
 #include "clang/Frontend/CodeGenOptions.h"
+#include "clang/Frontend/FrontendDiagnostic.h"
 #include "llvm/ADT/APSInt.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/Triple.h"
 #include "llvm/IR/CallingConv.h"
 #include "llvm/IR/DataLayout.h"
@@ -46,7 +50,9 @@
 #include "llvm/Support/CallSite.h"
 #include "llvm/Support/ConvertUTF.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/raw_ostream.h"
 #include "llvm/Target/Mangler.h"
+#include <algorithm>
 
 using namespace clang;
 using namespace CodeGen;
@@ -77,8 +83,10 @@ CodeGenModule::CodeGenModule(ASTContext &C, const CodeGenOptions &CGO,
     TheTargetCodeGenInfo(0), Types(*this), VTables(*this),
     ObjCRuntime(0), OpenCLRuntime(0), CUDARuntime(0),
     DebugInfo(0), ARCData(0), NoObjCARCExceptionsMetadata(0),
-    RRData(0), CFConstantStringClassRef(0),
-    ConstantStringClassRef(0), NSConstantStringType(0),
+    RRData(0), PGOData(0), SampleProfile(0), NumPGOFunctions(0),
+    NumPGOMissing(0), NumPGOMismatched(0), NumDeferredBodiesSkipped(0),
+    CFConstantStringClassRef(0), ConstantStringClassRef(0),
+    NSConstantStringType(0),
     NSConcreteGlobalBlock(0), NSConcreteStackBlock(0),
     BlockObjectAssign(0), BlockObjectDispose(0),
     BlockDescriptorType(0), GenericBlockLiteralType(0),
@@ -131,6 +139,28 @@ CodeGenModule::CodeGenModule(ASTContext &C, const CodeGenOptions &CGO,
   if (C.getLangOpts().ObjCAutoRefCount)
     ARCData = new ARCEntrypoints();
   RRData = new RREntrypoints();
+
+  if (!CodeGenOpts.InstrProfileInput.empty()) {
+    PGOData = new PGOProfileData();
+    std::string Error;
+    if (!PGOData->readFile(CodeGenOpts.InstrProfileInput, Error)) {
+      Diags.Report(diag::err_fe_unreadable_profile_data)
+        << CodeGenOpts.InstrProfileInput << Error;
+      delete PGOData;
+      PGOData = 0;
+    }
+  }
+
+  if (!CodeGenOpts.SampleProfileFile.empty()) {
+    SampleProfile = new SampleProfileSummary();
+    std::string Error;
+    if (!SampleProfile->readFile(CodeGenOpts.SampleProfileFile, Error)) {
+      Diags.Report(diag::err_fe_unreadable_profile_data)
+        << CodeGenOpts.SampleProfileFile << Error;
+      delete SampleProfile;
+      SampleProfile = 0;
+    }
+  }
 }
 
 CodeGenModule::~CodeGenModule() {
@@ -143,6 +173,8 @@ CodeGenModule::~CodeGenModule() {
   delete DebugInfo;
   delete ARCData;
   delete RRData;
+  delete PGOData;
+  delete SampleProfile;
 }
 
 void CodeGenModule::createObjCRuntime() {
@@ -180,6 +212,15 @@ void CodeGenModule::Release() {
   if (ObjCRuntime)
     if (llvm::Function *ObjCInitFunction = ObjCRuntime->ModuleInitFunction())
       AddGlobalCtor(ObjCInitFunction);
+  if (CUDARuntime && !CodeGenOpts.CUDAIsDevice) {
+    if (llvm::Function *CudaCtorFunction =
+            CUDARuntime->makeModuleCtorFunction())
+      AddGlobalCtor(CudaCtorFunction);
+    if (llvm::Function *CudaDtorFunction =
+            CUDARuntime->makeModuleDtorFunction())
+      AddGlobalDtor(CudaDtorFunction);
+  }
+  EmitPGOWriteout();
   EmitCtorList(GlobalCtors, "llvm.global_ctors");
   EmitCtorList(GlobalDtors, "llvm.global_dtors");
   EmitGlobalAnnotations();
@@ -204,6 +245,10 @@ void CodeGenModule::Release() {
   if (getCodeGenOpts().EmitGcovArcs || getCodeGenOpts().EmitGcovNotes)
     EmitCoverageFile();
 
+  if (PGOData && (NumPGOMissing || NumPGOMismatched))
+    getDiags().Report(diag::warn_fe_profile_data_out_of_date)
+      << NumPGOFunctions << NumPGOMissing << NumPGOMismatched;
+
   if (DebugInfo)
     DebugInfo->finalize();
 }
@@ -605,6 +650,47 @@ static bool hasUnwindExceptions(const LangOptions &LangOpts) {
   return true;
 }
 
+void CodeGenModule::AddTargetFeatures(llvm::AttrBuilder &B,
+                                      const TargetAttr *TA) {
+  const TargetOptions &Opts = Target.getTargetOpts();
+  llvm::StringMap<bool> Features;
+  for (unsigned i = 0, e = Opts.Features.size(); i != e; ++i) {
+    StringRef Feature = Opts.Features[i];
+    Features[Feature.substr(1)] = Feature[0] == '+';
+  }
+
+  // The attribute was checked by Sema, and enabling a feature enables the
+  // ones it implies.
+  SmallVector<StringRef, 4> Names;
+  TA->getFeatures().split(Names, ",");
+  for (unsigned i = 0, e = Names.size(); i != e; ++i) {
+    StringRef Name = Names[i].trim();
+    if (Name.startswith("no-"))
+      Target.setFeatureEnabled(Features, Name.substr(3), false);
+    else
+      Target.setFeatureEnabled(Features, Name, true);
+  }
+
+  // Sort the features, so that the string doesn't depend on the order of the
+  // map.
+  std::vector<std::string> Sorted;
+  for (llvm::StringMap<bool>::const_iterator I = Features.begin(),
+                                             E = Features.end();
+       I != E; ++I)
+    Sorted.push_back((I->second ? "+" : "-") + I->first().str());
+  std::sort(Sorted.begin(), Sorted.end());
+
+  std::string FeatureString;
+  for (unsigned i = 0, e = Sorted.size(); i != e; ++i) {
+    if (i)
+      FeatureString += ',';
+    FeatureString += Sorted[i];
+  }
+  B.addAttribute("target-features", FeatureString);
+  if (!Opts.CPU.empty())
+    B.addAttribute("target-cpu", Opts.CPU);
+}
+
 void CodeGenModule::SetLLVMFunctionAttributesForDefinition(const Decl *D,
                                                            llvm::Function *F) {
   llvm::AttrBuilder B;
@@ -637,6 +723,9 @@ void CodeGenModule::SetLLVMFunctionAttributesForDefinition(const Decl *D,
   if (D->hasAttr<MinSizeAttr>())
     B.addAttribute(llvm::Attribute::MinSize);
 
+  if (const TargetAttr *TA = D->getAttr<TargetAttr>())
+    AddTargetFeatures(B, TA);
+
   if (LangOpts.getStackProtector() == LangOptions::SSPOn)
     B.addAttribute(llvm::Attribute::StackProtect);
   else if (LangOpts.getStackProtector() == LangOptions::SSPReq)
@@ -674,6 +763,37 @@ void CodeGenModule::SetLLVMFunctionAttributesForDefinition(const Decl *D,
   // C++ ABI requires 2-byte alignment for member functions.
   if (F->getAlignment() < 2 && isa<CXXMethodDecl>(D))
     F->setAlignment(2);
+
+  if (CodeGenOpts.ReorderFunctions)
+    setHotColdSection(D, F);
+}
+
+/// Place the functions marked hot or cold in the sections that the ELF
+/// linkers gather at the start and the end of the text, as GCC does, so the
+/// hot ones share cache lines and pages and the cold ones stay out of them.
+void CodeGenModule::setHotColdSection(const Decl *D, llvm::Function *F) {
+  const llvm::Triple &Triple = getTarget().getTriple();
+  if (Triple.isOSDarwin() || Triple.isOSWindows())
+    return;
+
+  // An explicit section wins. Functions that may be defined in several
+  // translation units need sections in their COMDAT groups, which a named
+  // section would lose.
+  if (F->hasSection() || F->isWeakForLinker())
+    return;
+
+  StringRef Prefix;
+  if (D->hasAttr<HotAttr>())
+    Prefix = ".text.hot";
+  else if (D->hasAttr<ColdAttr>())
+    Prefix = ".text.unlikely";
+  else
+    return;
+
+  if (CodeGenOpts.FunctionSections)
+    F->setSection((Prefix + "." + F->getName()).str());
+  else
+    F->setSection(Prefix);
 }
 
 void CodeGenModule::SetCommonAttributes(const Decl *D,
@@ -933,6 +1053,23 @@ void CodeGenModule::EmitDeferred() {
       assert(DeferredVTables.empty());
     }
 
+    // Before stopping, emit the functions set aside as unused that the code
+    // emitted since then refers to.
+    if (DeferredDeclsToEmit.empty()) {
+      for (unsigned I = 0; I != UnusedDeferredDecls.size(); ) {
+        llvm::GlobalValue *GV =
+          GetGlobalValue(getMangledName(UnusedDeferredDecls[I]));
+        GV->removeDeadConstantUsers();
+        if (GV->use_empty()) {
+          ++I;
+          continue;
+        }
+        DeferredDeclsToEmit.push_back(UnusedDeferredDecls[I]);
+        UnusedDeferredDecls[I] = UnusedDeferredDecls.back();
+        UnusedDeferredDecls.pop_back();
+      }
+    }
+
     // Stop if we're out of both deferred v-tables and deferred declarations.
     if (DeferredDeclsToEmit.empty()) break;
 
@@ -959,9 +1096,36 @@ void CodeGenModule::EmitDeferred() {
     if (isa<llvm::GlobalAlias>(CGRef))
       continue;
 
+    // Set aside functions that nothing refers to any more, rather than
+    // emitting bodies that the optimizer would only delete.  Deferred
+    // functions can always be dropped if they are not used.
+    if (isa<llvm::Function>(CGRef)) {
+      CGRef->removeDeadConstantUsers();
+      if (CGRef->use_empty()) {
+        UnusedDeferredDecls.push_back(D);
+        continue;
+      }
+    }
+
     // Otherwise, emit the definition and move on to the next one.
     EmitGlobalDefinition(D);
   }
+
+  // Whatever is still unused is not needed at all.  A function may have been
+  // set aside more than once.
+  llvm::SmallPtrSet<llvm::GlobalValue *, 16> Skipped;
+  for (unsigned I = 0, N = UnusedDeferredDecls.size(); I != N; ++I)
+    Skipped.insert(GetGlobalValue(getMangledName(UnusedDeferredDecls[I])));
+  NumDeferredBodiesSkipped += Skipped.size();
+  UnusedDeferredDecls.clear();
+}
+
+void CodeGenModule::PrintStats() const {
+  llvm::errs() << "\n*** CodeGen Stats:\n";
+  llvm::errs() << NumDeferredBodiesSkipped
+               << " deferred function bodies skipped as unused.\n";
+  if (TBAA)
+    TBAA->PrintStats();
 }
 
 void CodeGenModule::EmitGlobalAnnotations() {
@@ -2830,6 +2994,11 @@ void CodeGenModule::EmitTopLevelDecl(Decl *D) {
   if (D->getDeclContext() && D->getDeclContext()->isDependentContext())
     return;
 
+  TimeTraceScope TimeScope("EmitTopLevelDecl");
+  if (TimeScope.isActive())
+    if (NamedDecl *ND = dyn_cast<NamedDecl>(D))
+      TimeScope.setDetail(ND->getQualifiedNameAsString());
+
   switch (D->getKind()) {
   case Decl::CXXConversion:
   case Decl::CXXMethod:
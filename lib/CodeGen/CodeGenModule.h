@@ -34,6 +34,7 @@
 #include "llvm/Transforms/Utils/SpecialCaseList.h"
 
 namespace llvm {
+  class AttrBuilder;
   class Module;
   class Constant;
   class ConstantInt;
@@ -69,6 +70,7 @@ namespace clang {
   class CodeGenOptions;
   class DiagnosticsEngine;
   class AnnotateAttr;
+  class TargetAttr;
   class CXXDestructorDecl;
   class MangleBuffer;
   class Module;
@@ -83,6 +85,8 @@ namespace CodeGen {
   class CGObjCRuntime;
   class CGOpenCLRuntime;
   class CGCUDARuntime;
+  class PGOProfileData;
+  class SampleProfileSummary;
   class BlockFieldFlags;
   class FunctionArgList;
   
@@ -160,6 +164,18 @@ struct RREntrypoints {
 
   /// void *objc_autoreleasePoolPush(void);
   llvm::Constant *objc_autoreleasePoolPush;
+
+  /// id objc_alloc(Class);
+  llvm::Constant *objc_alloc;
+
+  /// id objc_autorelease(id);
+  llvm::Constant *objc_autorelease;
+
+  /// void objc_release(id);
+  llvm::Constant *objc_release;
+
+  /// id objc_retain(id);
+  llvm::Constant *objc_retain;
 };
 
 struct ARCEntrypoints {
@@ -260,6 +276,23 @@ class CodeGenModule : public CodeGenTypeCache {
   llvm::MDNode *NoObjCARCExceptionsMetadata;
   RREntrypoints *RRData;
 
+  /// PGOData - The profile given with -fprofile-instr-use, if any.
+  PGOProfileData *PGOData;
+
+  /// SampleProfile - The sampling profile given with -fprofile-sample-use,
+  /// if any.
+  SampleProfileSummary *SampleProfile;
+
+  /// PGOCounters - The name and the counters of each function instrumented
+  /// with -fprofile-instr-generate, in the order they were emitted.
+  std::vector<std::pair<std::string, llvm::GlobalVariable *> > PGOCounters;
+
+  /// The number of functions emitted with -fprofile-instr-use, and how many
+  /// of them had no data or mismatched data in the profile.
+  unsigned NumPGOFunctions;
+  unsigned NumPGOMissing;
+  unsigned NumPGOMismatched;
+
   // WeakRefReferences - A set of references that have only been seen via
   // a weakref so far. This is used to remove the weak of the reference if we
   // ever see a direct reference or a definition.
@@ -276,6 +309,16 @@ class CodeGenModule : public CodeGenTypeCache {
   /// is done.
   std::vector<GlobalDecl> DeferredDeclsToEmit;
 
+  /// UnusedDeferredDecls - Deferred functions whose references had all gone
+  /// away by the time they came to be emitted, for example because the
+  /// constant expressions that referred to them were discarded.  Their bodies
+  /// are emitted only if code emitted after them refers to them again.
+  std::vector<GlobalDecl> UnusedDeferredDecls;
+
+  /// NumDeferredBodiesSkipped - The number of deferred functions whose bodies
+  /// were not emitted because nothing refers to them.
+  unsigned NumDeferredBodiesSkipped;
+
   /// DeferredVTables - A queue of (optional) vtables to consider emitting.
   std::vector<const CXXRecordDecl*> DeferredVTables;
 
@@ -427,6 +470,9 @@ public:
   /// Release - Finalize LLVM code generation.
   void Release();
 
+  /// PrintStats - Print statistics about the code generated so far.
+  void PrintStats() const;
+
   /// getObjCRuntime() - Return a reference to the configured
   /// Objective-C runtime.
   CGObjCRuntime &getObjCRuntime() {
@@ -450,6 +496,30 @@ public:
     return *CUDARuntime;
   }
 
+  /// getPGOData() - Return the profile given with -fprofile-instr-use, or
+  /// null if there is none.
+  PGOProfileData *getPGOData() const { return PGOData; }
+
+  /// getSampleProfile() - Return the sampling profile given with
+  /// -fprofile-sample-use, or null if there is none.
+  SampleProfileSummary *getSampleProfile() const { return SampleProfile; }
+
+  /// addPGOCounters - Register the counters of a function instrumented with
+  /// -fprofile-instr-generate, to be written out when the program exits.
+  void addPGOCounters(StringRef FuncName, llvm::GlobalVariable *Counters) {
+    PGOCounters.push_back(std::make_pair(FuncName.str(), Counters));
+  }
+
+  /// notePGOFunction - Record whether the profile had usable data for a
+  /// function emitted with -fprofile-instr-use.
+  void notePGOFunction(bool HasData, bool Mismatched) {
+    ++NumPGOFunctions;
+    if (!HasData)
+      ++NumPGOMissing;
+    else if (Mismatched)
+      ++NumPGOMismatched;
+  }
+
   ARCEntrypoints &getARCEntrypoints() const {
     assert(getLangOpts().ObjCAutoRefCount && ARCData != 0);
     return *ARCData;
@@ -881,6 +951,10 @@ public:
   /// which only apply to a function definintion.
   void SetLLVMFunctionAttributesForDefinition(const Decl *D, llvm::Function *F);
 
+  /// setHotColdSection - Place a function that is marked hot or cold in the
+  /// text section for such functions, for -freorder-functions.
+  void setHotColdSection(const Decl *D, llvm::Function *F);
+
   /// ReturnTypeUsesSRet - Return true iff the given type uses 'sret' when used
   /// as a return type.
   bool ReturnTypeUsesSRet(const CGFunctionInfo &FI);
@@ -1098,6 +1172,14 @@ private:
   /// to emit the .gcno and .gcda files in a way that persists in .bc files.
   void EmitCoverageFile();
 
+  /// EmitPGOWriteout - Emit the global constructor that registers the
+  /// counters of -fprofile-instr-generate with the profile runtime.
+  void EmitPGOWriteout();
+
+  /// AddTargetFeatures - Add the features of the command line and of the
+  /// target attribute \p TA, as the features to compile the function for.
+  void AddTargetFeatures(llvm::AttrBuilder &B, const TargetAttr *TA);
+
   /// Emits the initializer for a uuidof string.
   llvm::Constant *EmitUuidofInitializer(StringRef uuidstr, QualType IIDType);
 
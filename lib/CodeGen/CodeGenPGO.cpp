@@ -0,0 +1,356 @@
+//===--- CodeGenPGO.cpp - PGO Instrumentation for LLVM CodeGen --*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Profile-guided optimization: the counters emitted with
+// -fprofile-instr-generate, the profile read with -fprofile-instr-use, and
+// the function totals of the sampling profile of -fprofile-sample-use.
+//
+// The instrumented program calls
+//   void llvm_pgo_register_writeout_function(void (*fn)(void));
+// from a global constructor, and the registered function calls
+//   void llvm_pgo_emit(const char *name, uint32_t n, uint64_t *counters);
+// with the counters of each function of the module when the program exits.
+// Both are provided by the profile runtime library.
+//
+//===----------------------------------------------------------------------===//
+
+#include "CodeGenPGO.h"
+#include "CodeGenModule.h"
+#include "clang/Basic/CharInfo.h"
+#include "clang/Frontend/CodeGenOptions.h"
+#include "llvm/ADT/OwningPtr.h"
+#include "llvm/ADT/Twine.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/GlobalVariable.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/MDBuilder.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/system_error.h"
+#include <algorithm>
+
+using namespace clang;
+using namespace CodeGen;
+
+namespace {
+/// \brief Splits a buffer into lines, keeping track of the line number.
+class LineReader {
+  StringRef Rest;
+  unsigned LineNo;
+
+public:
+  explicit LineReader(StringRef Buffer) : Rest(Buffer), LineNo(0) {}
+
+  bool atEnd() const { return Rest.empty(); }
+  unsigned getLineNo() const { return LineNo; }
+
+  StringRef next() {
+    std::pair<StringRef, StringRef> Split = Rest.split('\n');
+    Rest = Split.second;
+    ++LineNo;
+    return Split.first.rtrim();
+  }
+};
+}
+
+/// \brief Mark \p Fn as hot or cold from its share \p Count of the
+/// largest count \p MaxCount of a function in the profile.
+static void applyHotnessAttributes(llvm::Function *Fn, uint64_t Count,
+                                   uint64_t MaxCount) {
+  if (!MaxCount)
+    return;
+
+  // The functions called the most are worth inlining, and the ones that are
+  // hardly ever called are optimized for size.
+  double Ratio = double(Count) / MaxCount;
+  if (Ratio >= 0.3) {
+    if (!Fn->hasFnAttribute(llvm::Attribute::NoInline))
+      Fn->addFnAttr(llvm::Attribute::InlineHint);
+  } else if (Ratio <= 0.01) {
+    Fn->addFnAttr(llvm::Attribute::Cold);
+  }
+}
+
+/// \brief Read the next line of \p Reader as a number.
+static bool readNumber(LineReader &Reader, uint64_t &N) {
+  return !Reader.atEnd() && !Reader.next().getAsInteger(10, N);
+}
+
+bool PGOProfileData::readFile(StringRef Path, std::string &Error) {
+  OwningPtr<llvm::MemoryBuffer> Buffer;
+  if (llvm::error_code EC = llvm::MemoryBuffer::getFile(Path, Buffer)) {
+    Error = EC.message();
+    return false;
+  }
+
+  LineReader Reader(Buffer->getBuffer());
+  while (!Reader.atEnd()) {
+    StringRef FuncName = Reader.next();
+    if (FuncName.empty())
+      continue;
+
+    uint64_t NumCounters;
+    if (!readNumber(Reader, NumCounters) || NumCounters == 0) {
+      Error = ("malformed data at line " + Twine(Reader.getLineNo())).str();
+      return false;
+    }
+
+    std::vector<uint64_t> Counts;
+    for (uint64_t i = 0; i != NumCounters; ++i) {
+      uint64_t Count;
+      if (!readNumber(Reader, Count)) {
+        Error = ("malformed data at line " + Twine(Reader.getLineNo())).str();
+        return false;
+      }
+      Counts.push_back(Count);
+    }
+
+    // A function that is in several object files has a record for each.
+    std::vector<uint64_t> &Total = FunctionCounts[FuncName];
+    if (Total.empty())
+      Total.swap(Counts);
+    else if (Total.size() != Counts.size()) {
+      Error = ("conflicting data for function '" + FuncName + "'").str();
+      return false;
+    } else {
+      for (unsigned i = 0, e = Counts.size(); i != e; ++i)
+        Total[i] += Counts[i];
+    }
+    MaxFunctionCount = std::max(MaxFunctionCount, Total[0]);
+  }
+  return true;
+}
+
+bool SampleProfileSummary::readFile(StringRef Path, std::string &Error) {
+  OwningPtr<llvm::MemoryBuffer> Buffer;
+  if (llvm::error_code EC = llvm::MemoryBuffer::getFile(Path, Buffer)) {
+    Error = EC.message();
+    return false;
+  }
+
+  // The function records start with a "name:total_samples:head_samples"
+  // line, and the lines of their bodies start with a line number or with
+  // white space.
+  LineReader Reader(Buffer->getBuffer());
+  while (!Reader.atEnd()) {
+    StringRef Line = Reader.next();
+    if (Line.empty() || isDigit(Line[0]) || isWhitespace(Line[0]))
+      continue;
+
+    std::pair<StringRef, StringRef> Head = Line.rsplit(':');
+    std::pair<StringRef, StringRef> Total = Head.first.rsplit(':');
+    uint64_t Samples, HeadSamples;
+    if (Total.first.empty() || Total.second.getAsInteger(10, Samples) ||
+        Head.second.getAsInteger(10, HeadSamples)) {
+      Error = ("malformed function record at line " +
+               Twine(Reader.getLineNo())).str();
+      return false;
+    }
+
+    uint64_t &FuncSamples = FunctionSamples[Total.first];
+    FuncSamples += Samples;
+    MaxFunctionSamples = std::max(MaxFunctionSamples, FuncSamples);
+  }
+  return true;
+}
+
+const std::vector<uint64_t> *
+PGOProfileData::getFunctionCounts(StringRef FuncName) const {
+  llvm::StringMap<std::vector<uint64_t> >::const_iterator I =
+    FunctionCounts.find(FuncName);
+  if (I == FunctionCounts.end())
+    return 0;
+  return &I->getValue();
+}
+
+void CodeGenPGO::startFunction(llvm::Function *Fn, CGBuilderTy &Builder) {
+  const CodeGenOptions &Opts = CGM.getCodeGenOpts();
+  PGOProfileData *PGOData = CGM.getPGOData();
+  if (!Opts.ProfileInstrGenerate && !PGOData)
+    return;
+
+  // Functions with internal linkage are told apart by their file.
+  FuncName = Fn->getName();
+  if (Fn->hasLocalLinkage())
+    FuncName = Opts.MainFileName + ":" + FuncName;
+  NumCounters = 1;
+
+  if (!Opts.ProfileInstrGenerate) {
+    Counts = PGOData->getFunctionCounts(FuncName);
+    return;
+  }
+
+  // The placeholder isn't in the module: it only lives until finishFunction.
+  CounterPlaceholder =
+    new llvm::GlobalVariable(llvm::ArrayType::get(CGM.Int64Ty, 0),
+                             /*isConstant=*/false,
+                             llvm::GlobalValue::InternalLinkage);
+  emitCounterIncrement(Builder, 0, Builder.getInt64(1));
+}
+
+void CodeGenPGO::finishFunction(llvm::Function *Fn) {
+  applySampleProfile(Fn);
+  if (FuncName.empty())
+    return;
+
+  if (CounterPlaceholder) {
+    llvm::ArrayType *CounterTy =
+      llvm::ArrayType::get(CGM.Int64Ty, NumCounters);
+    llvm::GlobalVariable *Counters =
+      new llvm::GlobalVariable(CGM.getModule(), CounterTy,
+                               /*isConstant=*/false,
+                               llvm::GlobalValue::InternalLinkage,
+                               llvm::Constant::getNullValue(CounterTy),
+                               "__llvm_pgo_ctr");
+    CounterPlaceholder->replaceAllUsesWith(
+      llvm::ConstantExpr::getBitCast(Counters,
+                                     CounterPlaceholder->getType()));
+    delete CounterPlaceholder;
+    CounterPlaceholder = 0;
+    CGM.addPGOCounters(FuncName, Counters);
+  } else {
+    // The function changed since the profile was collected, and its counts
+    // would be given to the wrong branches.
+    bool Mismatched = Counts && Counts->size() != NumCounters;
+    CGM.notePGOFunction(Counts != 0, Mismatched);
+    if (Mismatched) {
+      for (unsigned i = 0, e = WeightedBranches.size(); i != e; ++i)
+        if (llvm::Value *Br = WeightedBranches[i])
+          cast<llvm::Instruction>(Br)->setMetadata(llvm::LLVMContext::MD_prof,
+                                                   0);
+    } else if (Counts) {
+      applyHotnessAttributes(Fn, (*Counts)[0],
+                             CGM.getPGOData()->getMaxFunctionCount());
+    }
+  }
+
+  FuncName.clear();
+  BranchCounters.clear();
+  NumCounters = 0;
+  Counts = 0;
+  WeightedBranches.clear();
+}
+
+llvm::BranchInst *CodeGenPGO::emitCondBr(CGBuilderTy &Builder, const Stmt *S,
+                                         llvm::Value *Cond,
+                                         llvm::BasicBlock *TrueBlock,
+                                         llvm::BasicBlock *FalseBlock) {
+  if (FuncName.empty())
+    return Builder.CreateCondBr(Cond, TrueBlock, FalseBlock);
+
+  std::pair<llvm::DenseMap<const Stmt *, unsigned>::iterator, bool> Entry =
+    BranchCounters.insert(std::make_pair(S, NumCounters));
+  if (Entry.second)
+    NumCounters += 2;
+  unsigned Counter = Entry.first->second;
+
+  if (CounterPlaceholder) {
+    emitCounterIncrement(Builder, Counter,
+                         Builder.CreateZExt(Cond, CGM.Int64Ty));
+    emitCounterIncrement(Builder, Counter + 1,
+                         Builder.CreateZExt(Builder.CreateNot(Cond),
+                                            CGM.Int64Ty));
+    return Builder.CreateCondBr(Cond, TrueBlock, FalseBlock);
+  }
+
+  llvm::MDNode *Weights = 0;
+  if (Counts && Counter + 1 < Counts->size())
+    Weights = createBranchWeights((*Counts)[Counter], (*Counts)[Counter + 1]);
+  llvm::BranchInst *Br =
+    Builder.CreateCondBr(Cond, TrueBlock, FalseBlock, Weights);
+  if (Weights)
+    WeightedBranches.push_back(Br);
+  return Br;
+}
+
+void CodeGenPGO::emitCounterIncrement(CGBuilderTy &Builder, unsigned Counter,
+                                      llvm::Value *Step) {
+  // The placeholder has no elements, so the address can't be inbounds.
+  llvm::Value *Addr = Builder.CreateConstGEP2_64(CounterPlaceholder, 0,
+                                                 Counter);
+  llvm::Value *Count = Builder.CreateLoad(Addr, "pgocount");
+  Builder.CreateStore(Builder.CreateAdd(Count, Step), Addr);
+}
+
+llvm::MDNode *CodeGenPGO::createBranchWeights(uint64_t TrueCount,
+                                              uint64_t FalseCount) {
+  if (!TrueCount && !FalseCount)
+    return 0;
+
+  // Branch weights are 32 bits wide, so large counts are scaled down. A
+  // branch that was never taken still gets a weight of 1, since the profile
+  // doesn't prove that it can't be.
+  uint64_t Scale = std::max(TrueCount, FalseCount) / UINT32_MAX + 1;
+  llvm::MDBuilder MDHelper(CGM.getLLVMContext());
+  return MDHelper.createBranchWeights(uint32_t(TrueCount / Scale + 1),
+                                      uint32_t(FalseCount / Scale + 1));
+}
+
+void CodeGenPGO::applySampleProfile(llvm::Function *Fn) {
+  const SampleProfileSummary *Samples = CGM.getSampleProfile();
+  if (!Samples)
+    return;
+
+  // Short functions are easily missed by sampling, so a function without
+  // samples isn't known to be cold.
+  if (uint64_t Count = Samples->getFunctionSamples(Fn->getName()))
+    applyHotnessAttributes(Fn, Count, Samples->getMaxFunctionSamples());
+}
+
+void CodeGenModule::EmitPGOWriteout() {
+  if (PGOCounters.empty())
+    return;
+
+  llvm::FunctionType *WriteoutTy = llvm::FunctionType::get(VoidTy, false);
+  llvm::Function *Writeout =
+    llvm::Function::Create(WriteoutTy, llvm::GlobalValue::InternalLinkage,
+                           "__llvm_pgo_writeout", &getModule());
+  Writeout->setUnnamedAddr(true);
+  Writeout->addFnAttr(llvm::Attribute::NoUnwind);
+
+  llvm::Type *EmitParams[] = {
+    Int8PtrTy, Int32Ty, Int64Ty->getPointerTo()
+  };
+  llvm::Constant *EmitFn = CreateRuntimeFunction(
+      llvm::FunctionType::get(VoidTy, EmitParams, false), "llvm_pgo_emit");
+
+  CGBuilderTy Builder(llvm::BasicBlock::Create(VMContext, "", Writeout));
+  for (unsigned i = 0, e = PGOCounters.size(); i != e; ++i) {
+    const std::string &Name = PGOCounters[i].first;
+    llvm::GlobalVariable *Counters = PGOCounters[i].second;
+    uint64_t NumCounters =
+      cast<llvm::ArrayType>(Counters->getType()->getElementType())
+        ->getNumElements();
+    llvm::Value *Args[] = {
+      llvm::ConstantExpr::getBitCast(GetAddrOfConstantCString(Name),
+                                     Int8PtrTy),
+      Builder.getInt32(NumCounters),
+      Builder.CreateConstInBoundsGEP2_64(Counters, 0, 0)
+    };
+    Builder.CreateCall(EmitFn, Args)->setDoesNotThrow();
+  }
+  Builder.CreateRetVoid();
+
+  llvm::Function *Init =
+    llvm::Function::Create(WriteoutTy, llvm::GlobalValue::InternalLinkage,
+                           "__llvm_pgo_init", &getModule());
+  Init->setUnnamedAddr(true);
+  Init->addFnAttr(llvm::Attribute::NoUnwind);
+
+  llvm::Constant *RegisterFn = CreateRuntimeFunction(
+      llvm::FunctionType::get(VoidTy, WriteoutTy->getPointerTo(), false),
+      "llvm_pgo_register_writeout_function");
+
+  Builder.SetInsertPoint(llvm::BasicBlock::Create(VMContext, "", Init));
+  Builder.CreateCall(RegisterFn, Writeout)->setDoesNotThrow();
+  Builder.CreateRetVoid();
+
+  AddGlobalCtor(Init, 0);
+}
@@ -0,0 +1,152 @@
+//===--- CodeGenPGO.h - PGO Instrumentation for LLVM CodeGen ----*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Profile-guided optimization: the counters emitted with
+// -fprofile-instr-generate, the profile read with -fprofile-instr-use, and
+// the function totals of the sampling profile of -fprofile-sample-use.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef CLANG_CODEGEN_CODEGENPGO_H
+#define CLANG_CODEGEN_CODEGENPGO_H
+
+#include "CGBuilder.h"
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/ValueHandle.h"
+#include <string>
+#include <vector>
+
+namespace llvm {
+  class BasicBlock;
+  class BranchInst;
+  class Function;
+  class GlobalVariable;
+  class MDNode;
+}
+
+namespace clang {
+  class Stmt;
+
+namespace CodeGen {
+  class CodeGenModule;
+
+/// \brief The execution counts of a profile data file, as given to
+/// -fprofile-instr-use.
+///
+/// The file has a record for each function, separated by empty lines: the
+/// name of the function on a line, the number of its counters on the next
+/// one, and then the value of each counter on a line of its own. The counts
+/// of the records of a function that is in several object files are added
+/// up.
+class PGOProfileData {
+  llvm::StringMap<std::vector<uint64_t> > FunctionCounts;
+  uint64_t MaxFunctionCount;
+
+public:
+  PGOProfileData() : MaxFunctionCount(0) {}
+
+  /// \brief Read the profile data file \p Path. Returns false and sets
+  /// \p Error if the file can't be read or is malformed.
+  bool readFile(StringRef Path, std::string &Error);
+
+  /// \brief Returns the counts of the function \p FuncName, or null if the
+  /// profile has no data for it.
+  const std::vector<uint64_t> *getFunctionCounts(StringRef FuncName) const;
+
+  /// \brief Returns the largest number of calls of a function.
+  uint64_t getMaxFunctionCount() const { return MaxFunctionCount; }
+};
+
+/// \brief The number of samples of each function in the sampling profile
+/// given to -fprofile-sample-use.
+///
+/// Only the header of each function record is read here, the
+/// "name:total_samples:head_samples" line; the samples of the lines of the
+/// functions are turned into branch weights by the sample profile loader
+/// pass of the backend.
+class SampleProfileSummary {
+  llvm::StringMap<uint64_t> FunctionSamples;
+  uint64_t MaxFunctionSamples;
+
+public:
+  SampleProfileSummary() : MaxFunctionSamples(0) {}
+
+  /// \brief Read the sampling profile \p Path. Returns false and sets
+  /// \p Error if the file can't be read.
+  bool readFile(StringRef Path, std::string &Error);
+
+  /// \brief Returns the number of samples in the function \p FuncName, or
+  /// zero if it wasn't sampled.
+  uint64_t getFunctionSamples(StringRef FuncName) const {
+    return FunctionSamples.lookup(FuncName);
+  }
+
+  /// \brief Returns the largest number of samples in a function.
+  uint64_t getMaxFunctionSamples() const { return MaxFunctionSamples; }
+};
+
+/// \brief The PGO counters of the function being emitted.
+///
+/// Counter 0 counts the calls of the function. Each conditional branch of
+/// the source has the next two counters, which count how many times it went
+/// to its true and its false destination. The counters are numbered in the
+/// order the branches are emitted, which is the same when generating the
+/// profile and when using it, so that the profile maps back to the source
+/// through the AST rather than through the optimized code.
+class CodeGenPGO {
+  CodeGenModule &CGM;
+
+  /// The name of the function in the profile, or empty when the function
+  /// isn't instrumented.
+  std::string FuncName;
+
+  /// The index of the first of the two counters of each branch.
+  llvm::DenseMap<const Stmt *, unsigned> BranchCounters;
+  unsigned NumCounters;
+
+  /// With -fprofile-instr-generate, the counters incremented by the function
+  /// until their number is known, when they are replaced by the real ones.
+  llvm::GlobalVariable *CounterPlaceholder;
+
+  /// With -fprofile-instr-use, the counts of the function, and the branches
+  /// given weights from them.
+  const std::vector<uint64_t> *Counts;
+  SmallVector<llvm::WeakVH, 8> WeightedBranches;
+
+  void emitCounterIncrement(CGBuilderTy &Builder, unsigned Counter,
+                            llvm::Value *Step);
+  llvm::MDNode *createBranchWeights(uint64_t TrueCount, uint64_t FalseCount);
+  void applySampleProfile(llvm::Function *Fn);
+
+public:
+  explicit CodeGenPGO(CodeGenModule &CGM)
+    : CGM(CGM), NumCounters(0), CounterPlaceholder(0), Counts(0) {}
+
+  /// \brief Start instrumenting the function \p Fn, or applying its profile,
+  /// at the current insertion point of \p Builder.
+  void startFunction(llvm::Function *Fn, CGBuilderTy &Builder);
+
+  /// \brief Finish the function started by startFunction.
+  void finishFunction(llvm::Function *Fn);
+
+  /// \brief Emit a conditional branch on \p Cond for the branch of the
+  /// statement or expression \p S. The branch is counted when instrumenting,
+  /// and weighted by the counts of the profile when using one.
+  llvm::BranchInst *emitCondBr(CGBuilderTy &Builder, const Stmt *S,
+                               llvm::Value *Cond, llvm::BasicBlock *TrueBlock,
+                               llvm::BasicBlock *FalseBlock);
+};
+
+}  // end namespace CodeGen
+}  // end namespace clang
+
+#endif
@@ -26,6 +26,7 @@
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Metadata.h"
 #include "llvm/IR/Type.h"
+#include "llvm/Support/raw_ostream.h"
 using namespace clang;
 using namespace CodeGen;
 
@@ -33,7 +34,8 @@ CodeGenTBAA::CodeGenTBAA(ASTContext &Ctx, llvm::LLVMContext& VMContext,
                          const CodeGenOptions &CGO,
                          const LangOptions &Features, MangleContext &MContext)
   : Context(Ctx), CodeGenOpts(CGO), Features(Features), MContext(MContext),
-    MDHelper(VMContext), Root(0), Char(0) {
+    MDHelper(VMContext), Root(0), Char(0), VTablePtr(0), NumTypeNodes(0),
+    NumTagNodes(0), NumStructNodes(0) {
 }
 
 CodeGenTBAA::~CodeGenTBAA() {
@@ -56,6 +58,7 @@ llvm::MDNode *CodeGenTBAA::getRoot() {
 // name and a parent pointer.
 llvm::MDNode *CodeGenTBAA::createTBAAScalarType(StringRef Name,
                                                 llvm::MDNode *Parent) {
+  ++NumTypeNodes;
   if (CodeGenOpts.StructPathTBAA)
     return MDHelper.createTBAAScalarTypeNode(Name, Parent);
   else
@@ -171,7 +174,10 @@ CodeGenTBAA::getTBAAInfo(QualType QTy) {
 }
 
 llvm::MDNode *CodeGenTBAA::getTBAAInfoForVTablePtr() {
-  return createTBAAScalarType("vtable pointer", getRoot());
+  if (!VTablePtr)
+    VTablePtr = createTBAAScalarType("vtable pointer", getRoot());
+
+  return VTablePtr;
 }
 
 bool
@@ -221,12 +227,17 @@ llvm::MDNode *
 CodeGenTBAA::getTBAAStructInfo(QualType QTy) {
   const Type *Ty = Context.getCanonicalType(QTy).getTypePtr();
 
-  if (llvm::MDNode *N = StructMetadataCache[Ty])
-    return N;
+  // Types we don't handle are cached as null, so look them up with find.
+  llvm::DenseMap<const Type *, llvm::MDNode *>::iterator Known =
+    StructMetadataCache.find(Ty);
+  if (Known != StructMetadataCache.end())
+    return Known->second;
 
   SmallVector<llvm::MDBuilder::TBAAStructField, 4> Fields;
-  if (CollectFields(0, QTy, Fields, TypeHasMayAlias(QTy)))
-    return MDHelper.createTBAAStructNode(Fields);
+  if (CollectFields(0, QTy, Fields, TypeHasMayAlias(QTy))) {
+    ++NumStructNodes;
+    return StructMetadataCache[Ty] = MDHelper.createTBAAStructNode(Fields);
+  }
 
   // For now, handle any other kind of type conservatively.
   return StructMetadataCache[Ty] = NULL;
@@ -251,8 +262,10 @@ CodeGenTBAA::getTBAAStructTypeInfo(QualType QTy) {
   const Type *Ty = Context.getCanonicalType(QTy).getTypePtr();
   assert(isTBAAPathStruct(QTy));
 
-  if (llvm::MDNode *N = StructTypeMetadataCache[Ty])
-    return N;
+  llvm::DenseMap<const Type *, llvm::MDNode *>::iterator Known =
+    StructTypeMetadataCache.find(Ty);
+  if (Known != StructTypeMetadataCache.end())
+    return Known->second;
 
   if (const RecordType *TTy = QTy->getAs<RecordType>()) {
     const RecordDecl *RD = TTy->getDecl()->getDefinition();
@@ -281,11 +294,12 @@ CodeGenTBAA::getTBAAStructTypeInfo(QualType QTy) {
     MContext.mangleCXXRTTIName(QualType(Ty, 0), Out);
     Out.flush();
     // Create the struct type node with a vector of pairs (offset, type).
+    ++NumTypeNodes;
     return StructTypeMetadataCache[Ty] =
       MDHelper.createTBAAStructTypeNode(OutName, Fields);
   }
 
-  return StructMetadataCache[Ty] = NULL;
+  return StructTypeMetadataCache[Ty] = NULL;
 }
 
 llvm::MDNode *
@@ -302,6 +316,7 @@ CodeGenTBAA::getTBAAStructTagInfo(QualType BaseQTy, llvm::MDNode *AccessNode,
   llvm::MDNode *BNode = 0;
   if (isTBAAPathStruct(BaseQTy))
     BNode  = getTBAAStructTypeInfo(BaseQTy);
+  ++NumTagNodes;
   if (!BNode)
     return StructTagMetadataCache[PathTag] =
        MDHelper.createTBAAStructTagNode(AccessNode, AccessNode, 0);
@@ -315,6 +330,13 @@ CodeGenTBAA::getTBAAScalarTagInfo(llvm::MDNode *AccessNode) {
   if (llvm::MDNode *N = ScalarTagMetadataCache[AccessNode])
     return N;
 
+  ++NumTagNodes;
   return ScalarTagMetadataCache[AccessNode] =
     MDHelper.createTBAAStructTagNode(AccessNode, AccessNode, 0);
 }
+
+void CodeGenTBAA::PrintStats() const {
+  llvm::errs() << NumTypeNodes << " TBAA type nodes, " << NumTagNodes
+               << " access tags and " << NumStructNodes
+               << " !tbaa.struct nodes created.\n";
+}
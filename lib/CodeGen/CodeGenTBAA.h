@@ -70,6 +70,13 @@ class CodeGenTBAA {
 
   llvm::MDNode *Root;
   llvm::MDNode *Char;
+  llvm::MDNode *VTablePtr;
+
+  /// The number of type nodes, access tags and !tbaa.struct nodes created,
+  /// for -print-stats.  Each is created once per distinct type or path.
+  unsigned NumTypeNodes;
+  unsigned NumTagNodes;
+  unsigned NumStructNodes;
 
   /// getRoot - This is the mdnode for the root of the metadata type graph
   /// for this translation unit.
@@ -119,6 +126,9 @@ public:
 
   /// Get the scalar tag MDNode for a given scalar type.
   llvm::MDNode *getTBAAScalarTagInfo(llvm::MDNode *AccessNode);
+
+  /// Print the number of nodes created to llvm::errs().
+  void PrintStats() const;
 };
 
 }  // end namespace CodeGen
@@ -17,6 +17,7 @@
 #define CLANG_CODEGEN_EHSCOPESTACK_H
 
 #include "clang/Basic/LLVM.h"
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/IR/BasicBlock.h"
 #include "llvm/IR/Value.h"
@@ -277,6 +278,12 @@ private:
   /// The innermost EH scope on the stack.
   stable_iterator InnermostEHScope;
 
+  /// The catch, filter and terminate scopes on the stack, outermost
+  /// first.  These are the only EH scopes besides cleanups, and they
+  /// are rare, so landing pads look them up here rather than walking
+  /// past every cleanup on the stack.
+  SmallVector<stable_iterator, 4> HandlerScopes;
+
   /// The current set of branch fixups.  A branch fixup is a jump to
   /// an as-yet unemitted label, i.e. a label for which we don't yet
   /// know the EH stack depth.  Whenever we pop a cleanup, we have
@@ -428,6 +435,12 @@ public:
 
   stable_iterator getInnermostActiveEHScope() const;
 
+  /// Returns the catch, filter and terminate scopes on the stack,
+  /// outermost first.
+  ArrayRef<stable_iterator> getHandlerScopes() const {
+    return HandlerScopes;
+  }
+
   /// An unstable reference to a scope-stack depth.  Invalidated by
   /// pushes but not pops.
   class iterator;
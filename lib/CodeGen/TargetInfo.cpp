@@ -18,6 +18,7 @@
 #include "CodeGenFunction.h"
 #include "clang/AST/RecordLayout.h"
 #include "clang/Frontend/CodeGenOptions.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/Triple.h"
 #include "llvm/IR/DataLayout.h"
 #include "llvm/IR/Type.h"
@@ -1143,6 +1144,11 @@ class X86_64ABIInfo : public ABIInfo {
   void classify(QualType T, uint64_t OffsetBase, Class &Lo, Class &Hi,
                 bool isNamedArg) const;
 
+  /// classifyUncached - Implement classify without consulting the
+  /// classifications of records remembered in RecordClassifications.
+  void classifyUncached(QualType T, uint64_t OffsetBase, Class &Lo,
+                        Class &Hi, bool isNamedArg) const;
+
   llvm::Type *GetByteVectorType(QualType Ty) const;
   llvm::Type *GetSSETypeAtOffset(llvm::Type *IRType,
                                  unsigned IROffset, QualType SourceTy,
@@ -1186,6 +1192,15 @@ class X86_64ABIInfo : public ABIInfo {
   // 64-bit hardware.
   bool Has64BitPointers;
 
+  /// RecordClassifications - The classification of each record type that
+  /// has been classified at offset 0, keyed on the canonical type and
+  /// whether it was a named argument.  Classifying a record walks all of
+  /// its fields and bases, and the same records turn up in the signatures
+  /// of many functions.
+  typedef std::pair<const Type *, unsigned> ClassificationKey;
+  mutable llvm::DenseMap<ClassificationKey,
+                         std::pair<Class, Class> > RecordClassifications;
+
 public:
   X86_64ABIInfo(CodeGen::CodeGenTypes &CGT, bool hasavx) :
       ABIInfo(CGT), HasAVX(hasavx),
@@ -1420,6 +1435,28 @@ X86_64ABIInfo::Class X86_64ABIInfo::merge(Class Accum, Class Field) {
 
 void X86_64ABIInfo::classify(QualType Ty, uint64_t OffsetBase,
                              Class &Lo, Class &Hi, bool isNamedArg) const {
+  // A record straddles eightbytes differently at different offsets, so only
+  // the classification at offset 0 is remembered.
+  if (OffsetBase != 0 || !Ty->isRecordType())
+    return classifyUncached(Ty, OffsetBase, Lo, Hi, isNamedArg);
+
+  ClassificationKey Key(Ty->getCanonicalTypeInternal().getTypePtr(),
+                        isNamedArg);
+  llvm::DenseMap<ClassificationKey, std::pair<Class, Class> >::iterator
+    Known = RecordClassifications.find(Key);
+  if (Known != RecordClassifications.end()) {
+    Lo = Known->second.first;
+    Hi = Known->second.second;
+    return;
+  }
+
+  classifyUncached(Ty, OffsetBase, Lo, Hi, isNamedArg);
+  RecordClassifications[Key] = std::make_pair(Lo, Hi);
+}
+
+void X86_64ABIInfo::classifyUncached(QualType Ty, uint64_t OffsetBase,
+                                     Class &Lo, Class &Hi,
+                                     bool isNamedArg) const {
   // FIXME: This code can be simplified by introducing a simple value class for
   // Class pairs with appropriate constructor methods for the various
   // situations.
@@ -8,6 +8,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "clang/Driver/Compilation.h"
+#include "clang/Basic/WorkerPool.h"
 #include "clang/Driver/Action.h"
 #include "clang/Driver/Driver.h"
 #include "clang/Driver/DriverDiagnostic.h"
@@ -29,7 +30,8 @@ using namespace llvm::opt;
 Compilation::Compilation(const Driver &D, const ToolChain &_DefaultToolChain,
                          InputArgList *_Args, DerivedArgList *_TranslatedArgs)
   : TheDriver(D), DefaultToolChain(_DefaultToolChain), Args(_Args),
-    TranslatedArgs(_TranslatedArgs), Redirects(0) {
+    TranslatedArgs(_TranslatedArgs), Redirects(0), MaxParallelJobs(1),
+    RunCC1InProcess(false) {
 }
 
 Compilation::~Compilation() {
@@ -258,14 +260,7 @@ bool Compilation::CleanupFileMap(const ArgStringMap &Files,
   return Success;
 }
 
-int Compilation::ExecuteCommand(const Command &C,
-                                const Command *&FailingCommand) const {
-  std::string Prog(C.getExecutable());
-  const char **Argv = new const char*[C.getArguments().size() + 2];
-  Argv[0] = C.getExecutable();
-  std::copy(C.getArguments().begin(), C.getArguments().end(), Argv+1);
-  Argv[C.getArguments().size() + 1] = 0;
-
+bool Compilation::PrintCommandIfRequested(const Command &C) const {
   if ((getDriver().CCPrintOptions ||
        getArgs().hasArg(options::OPT_v)) && !getDriver().CCGenDiagnostics) {
     raw_ostream *OS = &llvm::errs();
@@ -279,9 +274,8 @@ int Compilation::ExecuteCommand(const Command &C,
       if (!Error.empty()) {
         getDriver().Diag(clang::diag::err_drv_cc_print_options_failure)
           << Error;
-        FailingCommand = &C;
         delete OS;
-        return 1;
+        return false;
       }
     }
 
@@ -293,12 +287,57 @@ int Compilation::ExecuteCommand(const Command &C,
     if (OS != &llvm::errs())
       delete OS;
   }
+  return true;
+}
+
+/// RunCommand - Spawn \p C and wait for it to finish. This does not touch
+/// any driver state, so it may be called from several threads at once.
+static int RunCommand(const Command &C, const StringRef **Redirects,
+                      std::string &Error, bool &ExecutionFailed) {
+  std::string Prog(C.getExecutable());
+  const char **Argv = new const char*[C.getArguments().size() + 2];
+  Argv[0] = C.getExecutable();
+  std::copy(C.getArguments().begin(), C.getArguments().end(), Argv+1);
+  Argv[C.getArguments().size() + 1] = 0;
 
-  std::string Error;
-  bool ExecutionFailed;
   int Res = llvm::sys::ExecuteAndWait(Prog, Argv, /*env*/ 0, Redirects,
                                       /*secondsToWait*/ 0, /*memoryLimit*/ 0,
                                       &Error, &ExecutionFailed);
+  delete[] Argv;
+  return Res;
+}
+
+bool Compilation::CanRunInProcess(const Command &C) const {
+  if (!RunCC1InProcess || Redirects)
+    return false;
+
+  const ArgStringList &Args = C.getArguments();
+  if (Args.empty() || StringRef(Args[0]) != "-cc1" ||
+      StringRef(C.getExecutable()) != getDriver().getClangProgramPath())
+    return false;
+
+  return !setsLLVMOptions(Args);
+}
+
+int Compilation::ExecuteCommand(const Command &C,
+                                const Command *&FailingCommand) const {
+  if (!PrintCommandIfRequested(C)) {
+    FailingCommand = &C;
+    return 1;
+  }
+
+  std::string Error;
+  bool ExecutionFailed = false;
+  int Res;
+  if (CanRunInProcess(C)) {
+    // Skip the "-cc1" argument.
+    SmallVector<const char *, 128> Argv(C.getArguments().begin() + 1,
+                                        C.getArguments().end());
+    Res = getDriver().CC1Main(Argv.data(), Argv.data() + Argv.size(),
+                              C.getExecutable());
+  } else {
+    Res = RunCommand(C, Redirects, Error, ExecutionFailed);
+  }
   if (!Error.empty()) {
     assert(Res && "Error string set with 0 result code!");
     getDriver().Diag(clang::diag::err_drv_command_failure) << Error;
@@ -307,7 +346,6 @@ int Compilation::ExecuteCommand(const Command &C,
   if (Res)
     FailingCommand = &C;
 
-  delete[] Argv;
   return ExecutionFailed ? 1 : Res;
 }
 
@@ -346,12 +384,121 @@ void Compilation::ExecuteJob(const Job &J,
       FailingCommands.push_back(std::make_pair(Res, FailingCommand));
   } else {
     const JobList *Jobs = cast<JobList>(&J);
+    unsigned NumWorkers = getEffectiveWorkerCount(MaxParallelJobs);
+    if (NumWorkers > 1 && Jobs->size() > 1) {
+      ExecuteJobsInParallel(*Jobs, NumWorkers, FailingCommands);
+      return;
+    }
     for (JobList::const_iterator it = Jobs->begin(), ie = Jobs->end();
          it != ie; ++it)
       ExecuteJob(**it, FailingCommands);
   }
 }
 
+/// CollectCommands - Flatten \p J into the list of commands it runs, in
+/// execution order.
+static void CollectCommands(const Job &J,
+                            SmallVectorImpl<const Command *> &Commands) {
+  if (const Command *C = dyn_cast<Command>(&J)) {
+    Commands.push_back(C);
+    return;
+  }
+  const JobList *Jobs = cast<JobList>(&J);
+  for (JobList::const_iterator it = Jobs->begin(), ie = Jobs->end();
+       it != ie; ++it)
+    CollectCommands(**it, Commands);
+}
+
+/// ActionUsesOutputOf - Returns true if \p Dep is \p A or one of its
+/// (transitive) inputs, i.e. if a command for \p A consumes the result of a
+/// command for \p Dep.
+static bool ActionUsesOutputOf(const Action *A, const Action *Dep) {
+  if (A == Dep)
+    return true;
+  for (Action::const_iterator AI = A->begin(), AE = A->end(); AI != AE; ++AI)
+    if (ActionUsesOutputOf(*AI, Dep))
+      return true;
+  return false;
+}
+
+namespace {
+/// The commands of one scheduling level, which are independent of each other
+/// and can run concurrently.
+struct ParallelCommandLevel {
+  SmallVector<const Command *, 16> Commands;
+  const StringRef **Redirects;
+  SmallVector<int, 16> Results;
+  SmallVector<char, 16> ExecutionFailed;
+  std::vector<std::string> Errors;
+};
+}
+
+static void RunCommandInLevel(void *Context, unsigned Index) {
+  ParallelCommandLevel &Level = *static_cast<ParallelCommandLevel *>(Context);
+  bool ExecutionFailed = false;
+  Level.Results[Index] = RunCommand(*Level.Commands[Index], Level.Redirects,
+                                    Level.Errors[Index], ExecutionFailed);
+  Level.ExecutionFailed[Index] = ExecutionFailed;
+}
+
+void Compilation::ExecuteJobsInParallel(const JobList &Jobs,
+                                        unsigned NumWorkers,
+                                        FailingCommandList &FailingCommands)
+    const {
+  SmallVector<const Command *, 16> Commands;
+  CollectCommands(Jobs, Commands);
+
+  // Assign every command to a level one past the deepest command whose output
+  // it consumes. All commands of a level are independent of each other, and
+  // only depend on commands of earlier levels.
+  SmallVector<unsigned, 16> LevelOf(Commands.size(), 0);
+  unsigned NumLevels = 0;
+  for (unsigned I = 0, E = Commands.size(); I != E; ++I) {
+    for (unsigned J = 0; J != I; ++J)
+      if (LevelOf[J] + 1 > LevelOf[I] &&
+          ActionUsesOutputOf(&Commands[I]->getSource(),
+                             &Commands[J]->getSource()))
+        LevelOf[I] = LevelOf[J] + 1;
+    NumLevels = std::max(NumLevels, LevelOf[I] + 1);
+  }
+
+  for (unsigned L = 0; L != NumLevels; ++L) {
+    ParallelCommandLevel Level;
+    Level.Redirects = Redirects;
+    for (unsigned I = 0, E = Commands.size(); I != E; ++I) {
+      if (LevelOf[I] != L || !InputsOk(*Commands[I], FailingCommands))
+        continue;
+      if (!PrintCommandIfRequested(*Commands[I])) {
+        FailingCommands.push_back(std::make_pair(1, Commands[I]));
+        continue;
+      }
+      Level.Commands.push_back(Commands[I]);
+    }
+    if (Level.Commands.empty())
+      continue;
+
+    unsigned N = Level.Commands.size();
+    Level.Results.resize(N, 0);
+    Level.ExecutionFailed.resize(N, false);
+    Level.Errors.resize(N);
+    runTasksInParallel(N, NumWorkers, RunCommandInLevel, &Level);
+
+    // Report the results in job order, independent of completion order.
+    for (unsigned I = 0; I != N; ++I) {
+      int Res = Level.Results[I];
+      if (!Level.Errors[I].empty()) {
+        assert(Res && "Error string set with 0 result code!");
+        getDriver().Diag(clang::diag::err_drv_command_failure)
+          << Level.Errors[I];
+      }
+      if (Level.ExecutionFailed[I])
+        Res = 1;
+      if (Res)
+        FailingCommands.push_back(std::make_pair(Res, Level.Commands[I]));
+    }
+  }
+}
+
 void Compilation::initCompilationForDiagnostics() {
   // Free actions and jobs.
   DeleteContainerPointers(Actions);
@@ -58,7 +58,8 @@ Driver::Driver(StringRef ClangExecutable,
     CCLogDiagnosticsFilename(0),
     CCCPrintBindings(false),
     CCPrintOptions(false), CCPrintHeaders(false), CCLogDiagnostics(false),
-    CCGenDiagnostics(false), CCCGenericGCCName(""), CheckInputsExist(true),
+    CCGenDiagnostics(false), CC1Main(0), CCCGenericGCCName(""),
+    CheckInputsExist(true),
     CCCUsePCH(true), SuppressMissingInputWarning(false) {
 
   Name = llvm::sys::path::stem(ClangExecutable);
@@ -1383,6 +1384,22 @@ void Driver::BuildJobs(Compilation &C) const {
                        II);
   }
 
+  // Pick up the number of commands which may run concurrently.
+  if (Arg *A = C.getArgs().getLastArg(options::OPT_j)) {
+    unsigned N;
+    if (StringRef(A->getValue()).getAsInteger(10, N))
+      Diag(clang::diag::err_drv_invalid_int_value)
+        << A->getAsString(C.getArgs()) << A->getValue();
+    else
+      C.setMaxParallelJobs(N);
+  }
+
+  // Run -cc1 jobs in this process, if the frontend is linked in.
+  if (C.getArgs().hasFlag(options::OPT_fintegrated_cc1,
+                          options::OPT_fno_integrated_cc1, false) &&
+      CC1Main)
+    C.setRunCC1InProcess(true);
+
   // If the user passed -Qunused-arguments or there were errors, don't warn
   // about any unused arguments.
   if (Diags.hasErrorOccurred() ||
@@ -9,6 +9,7 @@
 
 #include "clang/Driver/Job.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringSwitch.h"
 #include <cassert>
 using namespace clang::driver;
 
@@ -37,3 +38,15 @@ void Job::addCommand(Command *C) {
   cast<JobList>(this)->addJob(C);
 }
 
+bool clang::driver::setsLLVMOptions(ArrayRef<const char *> Args) {
+  // These must match the options that EmitAssemblyHelper::CreateTargetMachine
+  // passes to llvm::cl::ParseCommandLineOptions.
+  for (unsigned i = 0, e = Args.size(); i != e; ++i)
+    if (llvm::StringSwitch<bool>(Args[i])
+            .Cases("-mllvm", "-backend-option", "-mdebug-pass", true)
+            .Cases("-mlimit-float-precision", "-ftime-report",
+                   "-mno-global-merge", true)
+            .Default(false))
+      return true;
+  return false;
+}
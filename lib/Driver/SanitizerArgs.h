@@ -43,14 +43,17 @@ class SanitizerArgs {
     HasZeroBaseShadow = Thread | Memory
   };
   unsigned Kind;
+  /// The sanitizers of Kind whose checks trap instead of calling the runtime.
+  unsigned TrapKind;
   std::string BlacklistFile;
   bool MsanTrackOrigins;
   bool AsanZeroBaseShadow;
   bool UbsanTrapOnError;
 
  public:
-  SanitizerArgs() : Kind(0), BlacklistFile(""), MsanTrackOrigins(false),
-                    AsanZeroBaseShadow(false), UbsanTrapOnError(false) {}
+  SanitizerArgs() : Kind(0), TrapKind(0), BlacklistFile(""),
+                    MsanTrackOrigins(false), AsanZeroBaseShadow(false),
+                    UbsanTrapOnError(false) {}
   /// Parses the sanitizer arguments from an argument list.
   SanitizerArgs(const ToolChain &TC, const llvm::opt::ArgList &Args);
 
@@ -64,7 +67,7 @@ class SanitizerArgs {
   bool needsUbsanRt() const {
     if (UbsanTrapOnError)
       return false;
-    return Kind & NeedsUbsanRt;
+    return Kind & NeedsUbsanRt & ~TrapKind;
   }
 
   bool sanitizesVptr() const { return Kind & Vptr; }
@@ -84,6 +87,15 @@ class SanitizerArgs {
 #include "clang/Basic/Sanitizers.def"
     SanitizeOpt.pop_back();
     CmdArgs.push_back(Args.MakeArgString(SanitizeOpt));
+    if (TrapKind) {
+      SmallString<256> TrapOpt("-fsanitize-trap=");
+#define SANITIZER(NAME, ID) \
+      if (TrapKind & ID) \
+        TrapOpt += NAME ",";
+#include "clang/Basic/Sanitizers.def"
+      TrapOpt.pop_back();
+      CmdArgs.push_back(Args.MakeArgString(TrapOpt));
+    }
     if (!BlacklistFile.empty()) {
       SmallString<64> BlacklistOpt("-fsanitize-blacklist=");
       BlacklistOpt += BlacklistFile;
@@ -27,6 +27,7 @@
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/TimeValue.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Support/system_error.h"
 
@@ -280,6 +281,7 @@ void DarwinClang::AddLinkRuntimeLibArgs(const ArgList &Args,
   // If we are building profile support, link that library in.
   if (Args.hasArg(options::OPT_fprofile_arcs) ||
       Args.hasArg(options::OPT_fprofile_generate) ||
+      Args.hasArg(options::OPT_fprofile_instr_generate) ||
       Args.hasArg(options::OPT_fcreate_profile) ||
       Args.hasArg(options::OPT_coverage)) {
     // Select the appropriate runtime library for the target.
@@ -981,18 +983,24 @@ static StringRef getGCCToolchainDir(const ArgList &Args) {
   return GCC_INSTALL_PREFIX;
 }
 
+static bool isMipsArch(llvm::Triple::ArchType Arch);
+
 /// \brief Construct a GCCInstallationDetector from the driver.
 ///
 /// This performs all of the autodetection and sets up the various paths.
 /// Once constructed, a GCCInstallationDetector is essentially immutable.
 ///
+/// If CLANG_GCC_INSTALLATION_CACHE names a file, the result of the detection
+/// is stored there and the directories are only scanned again when one of the
+/// directories looked at has been modified.
+///
 /// FIXME: We shouldn't need an explicit TargetTriple parameter here, and
 /// should instead pull the target out of the driver. This is currently
 /// necessary because the driver doesn't store the final version of the target
 /// triple.
 Generic_GCC::GCCInstallationDetector::GCCInstallationDetector(
     const Driver &D, const llvm::Triple &TargetTriple, const ArgList &Args)
-    : IsValid(false) {
+    : IsValid(false), CollectProbedDirs(false) {
   llvm::Triple BiarchVariantTriple =
       TargetTriple.isArch32Bit() ? TargetTriple.get64BitArchVariant()
                                  : TargetTriple.get32BitArchVariant();
@@ -1022,14 +1030,33 @@ Generic_GCC::GCCInstallationDetector::GCCInstallationDetector(
     Prefixes.push_back(D.InstalledDir + "/..");
   }
 
+  // The biarch suffixes of MIPS installations depend on the command line, so
+  // only the other targets are cached, keyed by the triple and the prefixes.
+  StringRef CachePath;
+  std::string CacheKey;
+  if (const char *env = ::getenv("CLANG_GCC_INSTALLATION_CACHE"))
+    CachePath = env;
+  if (!CachePath.empty() && !isMipsArch(TargetArch)) {
+    CacheKey = TargetTriple.str();
+    for (unsigned i = 0, ie = Prefixes.size(); i < ie; ++i)
+      CacheKey += "\t" + Prefixes[i];
+    if (LoadFromCache(CachePath, CacheKey))
+      return;
+    CollectProbedDirs = true;
+  }
+
   // Loop over the various components which exist and select the best GCC
   // installation available. GCC installs are ranked by version number.
   Version = GCCVersion::Parse("0.0.0");
   for (unsigned i = 0, ie = Prefixes.size(); i < ie; ++i) {
+    if (CollectProbedDirs)
+      AddProbedDirs(Prefixes[i], "");
     if (!llvm::sys::fs::exists(Prefixes[i]))
       continue;
     for (unsigned j = 0, je = CandidateLibDirs.size(); j < je; ++j) {
       const std::string LibDir = Prefixes[i] + CandidateLibDirs[j].str();
+      if (CollectProbedDirs)
+        AddProbedDirs(Prefixes[i], CandidateLibDirs[j]);
       if (!llvm::sys::fs::exists(LibDir))
         continue;
       for (unsigned k = 0, ke = CandidateTripleAliases.size(); k < ke; ++k)
@@ -1038,6 +1065,8 @@ Generic_GCC::GCCInstallationDetector::GCCInstallationDetector(
     }
     for (unsigned j = 0, je = CandidateBiarchLibDirs.size(); j < je; ++j) {
       const std::string LibDir = Prefixes[i] + CandidateBiarchLibDirs[j].str();
+      if (CollectProbedDirs)
+        AddProbedDirs(Prefixes[i], CandidateBiarchLibDirs[j]);
       if (!llvm::sys::fs::exists(LibDir))
         continue;
       for (unsigned k = 0, ke = CandidateBiarchTripleAliases.size(); k < ke;
@@ -1047,6 +1076,194 @@ Generic_GCC::GCCInstallationDetector::GCCInstallationDetector(
                                /*NeedsBiarchSuffix=*/ true);
     }
   }
+
+  if (CollectProbedDirs) {
+    SaveToCache(CachePath, CacheKey);
+    CollectProbedDirs = false;
+    ProbedDirs.clear();
+  }
+}
+
+/// \brief The stamp of a directory that does not exist.
+static const uint64_t MissingDirStamp = ~0ULL;
+
+/// \brief Returns the modification time of the directory \p Path, or
+/// MissingDirStamp if there is no such directory.
+static uint64_t getDirStamp(const Twine &Path) {
+  llvm::sys::fs::file_status Status;
+  if (llvm::sys::fs::status(Path, Status) ||
+      !llvm::sys::fs::is_directory(Status))
+    return MissingDirStamp;
+  return Status.getLastModificationTime().toEpochTime();
+}
+
+/// \brief Records the stamps of \p Base and of the directories below it on the
+/// way to \p Base + \p Suffix, up to the first one that does not exist.
+///
+/// Creating or removing any directory on the way changes the stamp of its
+/// parent, so the directories that do not exist need not be recorded.
+void Generic_GCC::GCCInstallationDetector::AddProbedDirs(
+    const std::string &Base, StringRef Suffix) {
+  SmallVector<StringRef, 4> Components;
+  Suffix.split(Components, "/", -1, /*KeepEmpty=*/false);
+  std::string Path = Base;
+  for (unsigned i = 0, e = Components.size(); ; ++i) {
+    llvm::StringMap<uint64_t>::iterator I = ProbedDirs.find(Path);
+    uint64_t Stamp;
+    if (I != ProbedDirs.end())
+      Stamp = I->second;
+    else
+      Stamp = ProbedDirs[Path] = getDirStamp(Path);
+    if (Stamp == MissingDirStamp || i == e)
+      return;
+    Path += "/";
+    Path += Components[i];
+  }
+}
+
+/// \brief Splits the contents of a GCC installation cache into its entries,
+/// mapping the key of each entry to its lines.
+///
+/// Each entry starts with an "entry" line holding its key and ends with an
+/// "end" line. The fields of a line are separated by tabs.
+static void
+splitCacheEntries(StringRef Buffer,
+                  SmallVectorImpl<std::pair<StringRef, StringRef> > &Entries) {
+  while (!Buffer.empty()) {
+    std::pair<StringRef, StringRef> Line = Buffer.split('\n');
+    Buffer = Line.second;
+    if (!Line.first.startswith("entry\t"))
+      continue;
+    StringRef Key = Line.first.substr(strlen("entry\t"));
+    size_t End = Buffer.startswith("end\n") ? 0 : Buffer.find("\nend\n");
+    if (End == StringRef::npos)
+      return;
+    if (End != 0)
+      ++End;
+    Entries.push_back(std::make_pair(Key, Buffer.substr(0, End)));
+    Buffer = Buffer.substr(End + strlen("end\n"));
+  }
+}
+
+bool Generic_GCC::GCCInstallationDetector::LoadFromCache(StringRef CachePath,
+                                                         StringRef Key) {
+  OwningPtr<llvm::MemoryBuffer> Buffer;
+  if (llvm::MemoryBuffer::getFile(CachePath, Buffer))
+    return false;
+
+  SmallVector<std::pair<StringRef, StringRef>, 4> Entries;
+  splitCacheEntries(Buffer->getBuffer(), Entries);
+  StringRef Lines;
+  bool Found = false;
+  for (unsigned i = 0, e = Entries.size(); i != e && !Found; ++i) {
+    if (Entries[i].first == Key) {
+      Lines = Entries[i].second;
+      Found = true;
+    }
+  }
+  if (!Found)
+    return false;
+
+  SmallVector<StringRef, 6> Fields;
+  SmallVector<std::string, 4> Candidates;
+  SmallVector<StringRef, 6> Result;
+  while (!Lines.empty()) {
+    std::pair<StringRef, StringRef> Line = Lines.split('\n');
+    Lines = Line.second;
+    Fields.clear();
+    Line.first.split(Fields, "\t");
+    if (Fields[0] == "dir" && Fields.size() == 3) {
+      uint64_t Stamp;
+      if (Fields[1].getAsInteger(10, Stamp) || getDirStamp(Fields[2]) != Stamp)
+        return false;
+    } else if (Fields[0] == "missing" && Fields.size() == 2) {
+      if (getDirStamp(Fields[1]) != MissingDirStamp)
+        return false;
+    } else if (Fields[0] == "candidate" && Fields.size() == 2) {
+      Candidates.push_back(Fields[1].str());
+    } else if (Fields[0] == "selected" && Fields.size() == 6) {
+      Result = Fields;
+    } else if (Fields[0] != "none" || Fields.size() != 1) {
+      return false;
+    }
+  }
+
+  // Nothing changed since the entry was written; use its result.
+  CandidateGCCInstallPaths.append(Candidates.begin(), Candidates.end());
+  Version = GCCVersion::Parse("0.0.0");
+  if (!Result.empty()) {
+    GCCTriple.setTriple(Result[1]);
+    GCCInstallPath = Result[2];
+    GCCBiarchSuffix = Result[3];
+    GCCParentLibPath = Result[4];
+    Version = GCCVersion::Parse(Result[5]);
+    IsValid = true;
+  }
+  return true;
+}
+
+void Generic_GCC::GCCInstallationDetector::SaveToCache(StringRef CachePath,
+                                                       StringRef Key) const {
+  // Modification times only have a resolution of a second, so a directory
+  // modified just now may be modified again without its stamp changing.
+  uint64_t Now = llvm::sys::TimeValue::now().toEpochTime();
+  std::string Entry = "entry\t" + Key.str() + "\n";
+  for (llvm::StringMap<uint64_t>::const_iterator I = ProbedDirs.begin(),
+                                                 E = ProbedDirs.end();
+       I != E; ++I) {
+    if (I->second == MissingDirStamp) {
+      Entry += "missing\t" + I->getKey().str() + "\n";
+      continue;
+    }
+    if (I->second + 1 >= Now)
+      return;
+    Entry += "dir\t" + llvm::utostr(I->second) + "\t" + I->getKey().str() +
+             "\n";
+  }
+  for (unsigned i = 0, e = CandidateGCCInstallPaths.size(); i != e; ++i)
+    Entry += "candidate\t" + CandidateGCCInstallPaths[i] + "\n";
+  if (IsValid)
+    Entry += "selected\t" + GCCTriple.str() + "\t" + GCCInstallPath + "\t" +
+             GCCBiarchSuffix + "\t" + GCCParentLibPath + "\t" + Version.Text +
+             "\n";
+  else
+    Entry += "none\n";
+  Entry += "end\n";
+
+  // Don't cache paths holding newlines, which would split their lines.
+  if (StringRef(Entry).count('\n') !=
+      ProbedDirs.size() + CandidateGCCInstallPaths.size() + 3)
+    return;
+
+  // Keep the entries for the other keys. The new file is written next to the
+  // cache and renamed over it, so that concurrent drivers never see a partial
+  // file; if two of them update the cache at once, one of the updates is lost.
+  std::string Contents;
+  OwningPtr<llvm::MemoryBuffer> Buffer;
+  if (!llvm::MemoryBuffer::getFile(CachePath, Buffer)) {
+    SmallVector<std::pair<StringRef, StringRef>, 4> Entries;
+    splitCacheEntries(Buffer->getBuffer(), Entries);
+    for (unsigned i = 0, e = Entries.size(); i != e; ++i) {
+      if (Entries[i].first == Key)
+        continue;
+      Contents += "entry\t" + Entries[i].first.str() + "\n";
+      Contents += Entries[i].second.str() + "end\n";
+    }
+  }
+  Contents += Entry;
+
+  int FD;
+  SmallString<128> TempPath;
+  if (llvm::sys::fs::createUniqueFile(CachePath + "-%%%%%%%%", FD, TempPath))
+    return;
+  {
+    llvm::raw_fd_ostream OS(FD, /*shouldClose=*/true);
+    OS << Contents;
+  }
+  if (llvm::sys::fs::rename(TempPath.str(), CachePath)) {
+    bool Existed;
+    llvm::sys::fs::remove(TempPath.str(), Existed);
+  }
 }
 
 void Generic_GCC::GCCInstallationDetector::print(raw_ostream &OS) const {
@@ -1390,6 +1607,8 @@ void Generic_GCC::GCCInstallationDetector::ScanLibDirForGCCTriple(
       (llvm::array_lengthof(LibSuffixes) - (TargetArch != llvm::Triple::x86));
   for (unsigned i = 0; i < NumLibSuffixes; ++i) {
     StringRef LibSuffix = LibSuffixes[i];
+    if (CollectProbedDirs)
+      AddProbedDirs(LibDir, LibSuffix);
     llvm::error_code EC;
     for (llvm::sys::fs::directory_iterator LI(LibDir + LibSuffix, EC), LE;
          !EC && LI != LE; LI = LI.increment(EC)) {
@@ -1402,6 +1621,10 @@ void Generic_GCC::GCCInstallationDetector::ScanLibDirForGCCTriple(
       if (CandidateVersion <= Version)
         continue;
 
+      // Whether the candidate has a crtbegin.o changes its stamp.
+      if (CollectProbedDirs)
+        AddProbedDirs(LI->path(), "");
+
       // Some versions of SUSE and Fedora on ppc64 put 32-bit libs
       // in what would normally be GCCInstallPath and put the 64-bit
       // libs in a subdirectory named 64. The simple logic we follow is that
@@ -15,6 +15,7 @@
 #include "clang/Driver/Action.h"
 #include "clang/Driver/ToolChain.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/Support/Compiler.h"
 
 #include <vector>
@@ -82,6 +83,11 @@ protected:
     // order to print out detailed information in verbose mode.
     SmallVector<std::string, 4> CandidateGCCInstallPaths;
 
+    // When the detection result is cached, the modification times of the
+    // directories looked at, which tell whether the result is still valid.
+    bool CollectProbedDirs;
+    llvm::StringMap<uint64_t> ProbedDirs;
+
   public:
     GCCInstallationDetector(const Driver &D, const llvm::Triple &TargetTriple,
                             const llvm::opt::ArgList &Args);
@@ -122,6 +128,10 @@ protected:
                                 const std::string &LibDir,
                                 StringRef CandidateTriple,
                                 bool NeedsBiarchSuffix = false);
+
+    void AddProbedDirs(const std::string &Base, StringRef Suffix);
+    bool LoadFromCache(StringRef CachePath, StringRef Key);
+    void SaveToCache(StringRef CachePath, StringRef Key) const;
   };
 
   GCCInstallationDetector GCCInstallation;
@@ -210,6 +210,7 @@ static void addProfileRT(const ToolChain &TC, const ArgList &Args,
                          llvm::Triple Triple) {
   if (!(Args.hasArg(options::OPT_fprofile_arcs) ||
         Args.hasArg(options::OPT_fprofile_generate) ||
+        Args.hasArg(options::OPT_fprofile_instr_generate) ||
         Args.hasArg(options::OPT_fcreate_profile) ||
         Args.hasArg(options::OPT_coverage)))
     return;
@@ -1622,7 +1623,7 @@ static void CollectArgsForIntegratedAssembler(Compilation &C,
 }
 
 SanitizerArgs::SanitizerArgs(const ToolChain &TC, const ArgList &Args)
-    : Kind(0), BlacklistFile(""), MsanTrackOrigins(false),
+    : Kind(0), TrapKind(0), BlacklistFile(""), MsanTrackOrigins(false),
       AsanZeroBaseShadow(false) {
   unsigned AllKinds = 0;  // All kinds of sanitizers that were turned on
                           // at least once (possibly, disabled further).
@@ -1650,6 +1651,19 @@ SanitizerArgs::SanitizerArgs(const ToolChain &TC, const ArgList &Args)
       << "-fno-sanitize-undefined-trap-on-error";
   }
 
+  // Parse -f(no-)sanitize-trap= options. Only the enabled UBSan checks can
+  // trap, except for the vptr check, which needs the runtime.
+  for (ArgList::const_iterator I = Args.begin(), E = Args.end(); I != E; ++I) {
+    if ((*I)->getOption().matches(options::OPT_fsanitize_trap_EQ))
+      TrapKind |= parse(D, *I, true);
+    else if ((*I)->getOption().matches(options::OPT_fno_sanitize_trap_EQ))
+      TrapKind &= ~parse(D, *I, true);
+    else
+      continue;
+    (*I)->claim();
+  }
+  TrapKind &= Kind & NeedsUbsanRt & ~NotAllowedWithTrap;
+
   // Warn about undefined sanitizer options that require runtime support.
   if (UbsanTrapOnError && notAllowedWithTrap()) {
     if (Args.hasArg(options::OPT_fcatch_undefined_behavior))
@@ -1749,6 +1763,7 @@ static void addProfileRTLinux(
     const ToolChain &TC, const ArgList &Args, ArgStringList &CmdArgs) {
   if (!(Args.hasArg(options::OPT_fprofile_arcs) ||
         Args.hasArg(options::OPT_fprofile_generate) ||
+        Args.hasArg(options::OPT_fprofile_instr_generate) ||
         Args.hasArg(options::OPT_fcreate_profile) ||
         Args.hasArg(options::OPT_coverage)))
     return;
@@ -2593,10 +2608,23 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
   }
 
 
-  Args.AddAllArgs(CmdArgs, options::OPT_fdebug_types_section);
+  // Type units are an LLVM backend feature; place each type in its own
+  // COMDAT section so the linker can drop duplicates.
+  if (Args.hasFlag(options::OPT_fdebug_types_section,
+                   options::OPT_fno_debug_types_section, false)) {
+    CmdArgs.push_back("-backend-option");
+    CmdArgs.push_back("-generate-type-units");
+  }
+
+  if (Args.hasFlag(options::OPT_fno_emit_class_debug_always,
+                   options::OPT_femit_class_debug_always, false))
+    CmdArgs.push_back("-fno-emit-class-debug-always");
 
   Args.AddAllArgs(CmdArgs, options::OPT_ffunction_sections);
   Args.AddAllArgs(CmdArgs, options::OPT_fdata_sections);
+  if (Args.hasFlag(options::OPT_freorder_functions,
+                   options::OPT_fno_reorder_functions, false))
+    CmdArgs.push_back("-freorder-functions");
 
   Args.AddAllArgs(CmdArgs, options::OPT_finstrument_functions);
 
@@ -2607,6 +2635,16 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
       Args.hasArg(options::OPT_coverage))
     CmdArgs.push_back("-femit-coverage-data");
 
+  // Instrumentation-based PGO either collects a profile or uses one.
+  Arg *ProfileGenerate = Args.getLastArg(options::OPT_fprofile_instr_generate);
+  Arg *ProfileUse = Args.getLastArg(options::OPT_fprofile_instr_use_EQ);
+  if (ProfileGenerate && ProfileUse)
+    D.Diag(diag::err_drv_argument_not_allowed_with)
+      << ProfileGenerate->getAsString(Args) << ProfileUse->getAsString(Args);
+  Args.AddLastArg(CmdArgs, options::OPT_fprofile_instr_generate);
+  Args.AddLastArg(CmdArgs, options::OPT_fprofile_instr_use_EQ);
+  Args.AddLastArg(CmdArgs, options::OPT_fprofile_sample_use_EQ);
+
   if (C.getArgs().hasArg(options::OPT_c) ||
       C.getArgs().hasArg(options::OPT_S)) {
     if (Output.isFilename()) {
@@ -2641,6 +2679,7 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
   CmdArgs.push_back(D.ResourceDir.c_str());
 
   Args.AddLastArg(CmdArgs, options::OPT_working_directory);
+  Args.AddLastArg(CmdArgs, options::OPT_fstat_cache_EQ);
 
   bool ARCMTEnabled = false;
   if (!Args.hasArg(options::OPT_fno_objc_arc)) {
@@ -2814,6 +2853,13 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
     CmdArgs.push_back(A->getValue());
   }
 
+  if (Arg *A = Args.getLastArg(options::OPT_fconstexpr_cache_size_EQ)) {
+    CmdArgs.push_back("-fconstexpr-cache-size");
+    CmdArgs.push_back(A->getValue());
+  }
+
+  Args.AddLastArg(CmdArgs, options::OPT_fconstexpr_bytecode);
+
   if (Arg *A = Args.getLastArg(options::OPT_fbracket_depth_EQ)) {
     CmdArgs.push_back("-fbracket-depth");
     CmdArgs.push_back(A->getValue());
@@ -2858,6 +2904,10 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
     CmdArgs.push_back(A->getValue());
   }
 
+  Args.AddLastArg(CmdArgs, options::OPT_ftemplate_profile_EQ);
+  Args.AddLastArg(CmdArgs, options::OPT_ftime_trace_EQ);
+  Args.AddLastArg(CmdArgs, options::OPT_fmemory_report_EQ);
+
   if (Arg *A = Args.getLastArg(options::OPT_fconstexpr_backtrace_limit_EQ)) {
     CmdArgs.push_back("-fconstexpr-backtrace-limit");
     CmdArgs.push_back(A->getValue());
@@ -3103,6 +3153,7 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
 
   // Pass through all -fmodules-ignore-macro arguments.
   Args.AddAllArgs(CmdArgs, options::OPT_fmodules_ignore_macro);
+  Args.AddLastArg(CmdArgs, options::OPT_fmodules_relocatable_root);
   Args.AddLastArg(CmdArgs, options::OPT_fmodules_prune_interval);
   Args.AddLastArg(CmdArgs, options::OPT_fmodules_prune_after);
 
@@ -3198,6 +3249,14 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
                    getToolChain().getTriple().getOS() == llvm::Triple::Win32))
     CmdArgs.push_back("-fdelayed-template-parsing");
 
+  if (Args.hasFlag(options::OPT_fdelayed_inline_method_parsing,
+                   options::OPT_fno_delayed_inline_method_parsing, false))
+    CmdArgs.push_back("-fdelayed-inline-method-parsing");
+
+  if (Args.hasFlag(options::OPT_fpch_instantiate_templates,
+                   options::OPT_fno_pch_instantiate_templates, false))
+    CmdArgs.push_back("-fpch-instantiate-templates");
+
   // -fgnu-keywords default varies depending on language; only pass if
   // specified.
   if (Arg *A = Args.getLastArg(options::OPT_fgnu_keywords,
@@ -3268,6 +3327,12 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
       CmdArgs.push_back("-fobjc-arc-exceptions");
   }
 
+  // -fobjc-convert-messages-to-runtime-calls is the default.
+  if (!Args.hasFlag(options::OPT_fobjc_convert_messages_to_runtime_calls,
+                    options::OPT_fno_objc_convert_messages_to_runtime_calls,
+                    /*default*/ true))
+    CmdArgs.push_back("-fno-objc-convert-messages-to-runtime-calls");
+
   // -fobjc-infer-related-result-type is the default, except in the Objective-C
   // rewriter.
   if (rewriteKind != RK_None)
@@ -3446,6 +3511,11 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
                     options::OPT_fno_spell_checking))
     CmdArgs.push_back("-fno-spell-checking");
 
+  if (Arg *A = Args.getLastArg(options::OPT_ftypo_correction_budget_EQ)) {
+    CmdArgs.push_back("-ftypo-correction-budget");
+    CmdArgs.push_back(A->getValue());
+  }
+
 
   // -fno-asm-blocks is default.
   if (Args.hasFlag(options::OPT_fasm_blocks, options::OPT_fno_asm_blocks,
@@ -116,6 +116,7 @@ template <> struct MappingTraits<clang::format::FormatStyle> {
                    Style.ExperimentalAutoDetectBinPacking);
     IO.mapOptional("IndentCaseLabels", Style.IndentCaseLabels);
     IO.mapOptional("MaxEmptyLinesToKeep", Style.MaxEmptyLinesToKeep);
+    IO.mapOptional("MaxStatesPerLine", Style.MaxStatesPerLine);
     IO.mapOptional("NamespaceIndentation", Style.NamespaceIndentation);
     IO.mapOptional("ObjCSpaceBeforeProtocolList",
                    Style.ObjCSpaceBeforeProtocolList);
@@ -149,6 +150,7 @@ void setDefaultPenalties(FormatStyle &Style) {
   Style.PenaltyBreakFirstLessLess = 120;
   Style.PenaltyBreakString = 1000;
   Style.PenaltyExcessCharacter = 1000000;
+  Style.MaxStatesPerLine = 100000;
 }
 
 FormatStyle getLLVMStyle() {
@@ -323,6 +325,9 @@ public:
         Whitespaces(Whitespaces), Count(0), Encoding(Encoding),
         BinPackInconclusiveFunctions(BinPackInconclusiveFunctions) {}
 
+  /// \brief Returns the number of \c StateNodes created so far.
+  unsigned getNumStateNodes() const { return Count; }
+
   /// \brief Formats an \c UnwrappedLine.
   void format(const AnnotatedLine *NextLine) {
     // Initialize state dependent on indent.
@@ -954,6 +959,16 @@ private:
   /// tokens) is handled in \c addNextStateToQueue.
   unsigned breakProtrudingToken(const FormatToken &Current, LineState &State,
                                 bool DryRun) {
+    // A string literal or block comment on a single line that fits needs no
+    // breaking and has nothing to reflow. This is checked for every state the
+    // line is formatted in, so don't build a BreakableToken just to find that
+    // out.
+    if ((Current.is(tok::string_literal) || Current.Type == TT_BlockComment) &&
+        Current.UnbreakableTailLength < getColumnLimit() &&
+        State.Column <= getColumnLimit() - Current.UnbreakableTailLength &&
+        Current.TokenText.find('\n') == StringRef::npos)
+      return 0;
+
     llvm::OwningPtr<BreakableToken> Token;
     unsigned StartColumn = State.Column - Current.CodePointCount;
     unsigned OriginalStartColumn =
@@ -1097,6 +1112,14 @@ private:
   typedef std::priority_queue<QueueItem, std::vector<QueueItem>,
                               std::greater<QueueItem> > QueueType;
 
+  /// \brief Orders the \c LineStates of \c StateNodes, to keep track of the
+  /// states that were examined without copying them.
+  struct CompareLineStates {
+    bool operator()(const LineState *LHS, const LineState *RHS) const {
+      return *LHS < *RHS;
+    }
+  };
+
   /// \brief Analyze the entire solution space starting from \p InitialState.
   ///
   /// This implements a variant of Dijkstra's algorithm on the graph that spans
@@ -1104,8 +1127,6 @@ private:
   /// find the shortest path (the one with lowest penalty) from \p InitialState
   /// to a state where all tokens are placed.
   void analyzeSolutionSpace(LineState &InitialState) {
-    std::set<LineState> Seen;
-
     // Insert start element into queue.
     StateNode *Node =
         new (Allocator.Allocate()) StateNode(InitialState, false, NULL);
@@ -1122,12 +1143,20 @@ private:
       }
       Queue.pop();
 
+      // Don't let pathological lines take unbounded time and memory. Settle
+      // for the cheapest partial solution found so far.
+      if (Style.MaxStatesPerLine && Count > Style.MaxStatesPerLine) {
+        DEBUG(llvm::dbgs() << "Too many states, breaking greedily\n");
+        reconstructPath(InitialState, completeGreedily(Node));
+        return;
+      }
+
       // Cut off the analysis of certain solutions if the analysis gets too
       // complex. See description of IgnoreStackForComparison.
       if (Count > 10000)
         Node->State.IgnoreStackForComparison = true;
 
-      if (!Seen.insert(Node->State).second)
+      if (!Seen.insert(&Node->State).second)
         // State already examined with lower penalty.
         continue;
 
@@ -1182,18 +1211,45 @@ private:
       Penalty += PreviousNode->State.NextToken->SplitPenalty;
     }
 
-    StateNode *Node = new (Allocator.Allocate())
-        StateNode(PreviousNode->State, NewLine, PreviousNode);
-    Penalty += addTokenToState(NewLine, true, Node->State);
-    if (Node->State.Column > getColumnLimit()) {
-      unsigned ExcessCharacters = Node->State.Column - getColumnLimit();
+    LineState State = PreviousNode->State;
+    Penalty += addTokenToState(NewLine, true, State);
+    if (State.Column > getColumnLimit()) {
+      unsigned ExcessCharacters = State.Column - getColumnLimit();
       Penalty += Style.PenaltyExcessCharacter * ExcessCharacters;
     }
 
+    // A state that was already examined was reached with a lower penalty, so
+    // there is no need to keep this one around.
+    if (Seen.count(&State))
+      return;
+
+    StateNode *Node = new (Allocator.Allocate())
+        StateNode(State, NewLine, PreviousNode);
     Queue.push(QueueItem(OrderedPenalty(Penalty, Count), Node));
     ++Count;
   }
 
+  /// \brief Places the remaining tokens after \p Node, breaking the line only
+  /// where necessary, and returns the node of the final state.
+  StateNode *completeGreedily(StateNode *Node) {
+    while (Node->State.NextToken != NULL) {
+      bool NewLine = false;
+      if (canBreak(Node->State)) {
+        NewLine = mustBreak(Node->State);
+        if (!NewLine) {
+          LineState State = Node->State;
+          addTokenToState(/*Newline=*/false, true, State);
+          NewLine = State.Column > getColumnLimit();
+        }
+      }
+      StateNode *Next = new (Allocator.Allocate())
+          StateNode(Node->State, NewLine, Node);
+      addTokenToState(NewLine, true, Next->State);
+      Node = Next;
+    }
+    return Node;
+  }
+
   /// \brief Returns \c true, if a line break after \p State is allowed.
   bool canBreak(const LineState &State) {
     const FormatToken &Current = *State.NextToken;
@@ -1320,6 +1376,8 @@ private:
 
   llvm::SpecificBumpPtrAllocator<StateNode> Allocator;
   QueueType Queue;
+  // The states that were examined, which are all owned by \c Allocator.
+  std::set<const LineState *, CompareLineStates> Seen;
   // Increasing count of \c StateNode items we have created. This is used
   // to create a deterministic order independent of the container.
   unsigned Count;
@@ -1448,13 +1506,39 @@ private:
   }
 };
 
+/// \brief Adds the time from its construction to its destruction to a
+/// \c TimeRecord, unless that is null.
+class PhaseTimer {
+public:
+  explicit PhaseTimer(llvm::TimeRecord *Total) : Total(Total) {
+    if (Total)
+      Start = llvm::TimeRecord::getCurrentTime(/*Start=*/true);
+  }
+
+  ~PhaseTimer() {
+    if (!Total)
+      return;
+    llvm::TimeRecord Elapsed =
+        llvm::TimeRecord::getCurrentTime(/*Start=*/false);
+    Elapsed -= Start;
+    *Total += Elapsed;
+  }
+
+private:
+  llvm::TimeRecord *Total;
+  llvm::TimeRecord Start;
+};
+
 class Formatter : public UnwrappedLineConsumer {
 public:
   Formatter(const FormatStyle &Style, Lexer &Lex, SourceManager &SourceMgr,
-            const std::vector<CharSourceRange> &Ranges)
+            const std::vector<CharSourceRange> &Ranges,
+            FormatStatistics *Statistics)
       : Style(Style), Lex(Lex), SourceMgr(SourceMgr),
-        Whitespaces(SourceMgr, Style), Ranges(Ranges),
-        Encoding(encoding::detectEncoding(Lex.getBuffer())) {
+        Whitespaces(SourceMgr, Style), Ranges(Ranges), Annotator(NULL),
+        Statistics(Statistics),
+        Encoding(encoding::detectEncoding(Lex.getBuffer())),
+        BinPackInconclusiveFunctions(true) {
     DEBUG(llvm::dbgs() << "File encoding: "
                        << (Encoding == encoding::Encoding_UTF8 ? "UTF8"
                                                                : "unknown")
@@ -1465,16 +1549,38 @@ public:
 
   tooling::Replacements format() {
     FormatTokenLexer Tokens(Lex, SourceMgr, Encoding);
+    ArrayRef<FormatToken *> AllTokens;
+    {
+      PhaseTimer Timer(timeOf(&FormatStatistics::Lexing));
+      AllTokens = Tokens.lex();
+    }
 
-    UnwrappedLineParser Parser(Style, Tokens.lex(), *this);
-    bool StructuralError = Parser.parse();
-    TokenAnnotator Annotator(Style, Tokens.getIdentTable().get("in"));
-    for (unsigned i = 0, e = AnnotatedLines.size(); i != e; ++i) {
-      Annotator.annotate(AnnotatedLines[i]);
+    UnwrappedLineParser Parser(Style, AllTokens, *this);
+    bool StructuralError;
+    {
+      PhaseTimer Timer(timeOf(&FormatStatistics::Parsing));
+      StructuralError = Parser.parse();
     }
-    deriveLocalStyle();
-    for (unsigned i = 0, e = AnnotatedLines.size(); i != e; ++i) {
-      Annotator.calculateFormattingInformation(AnnotatedLines[i]);
+    if (Statistics)
+      Statistics->NumUnwrappedLines += AnnotatedLines.size();
+    TokenAnnotator Annotator(Style, Tokens.getIdentTable().get("in"));
+    this->Annotator = &Annotator;
+    LineIsAnnotated.assign(AnnotatedLines.size(), false);
+
+    // Deriving the style looks at every line. Otherwise, only the lines that
+    // are formatted or might be merged with others need to be annotated,
+    // which saves most of the work when formatting a small part of a file.
+    if (Style.DerivePointerBinding || Style.Standard == FormatStyle::LS_Auto ||
+        Style.ExperimentalAutoDetectBinPacking) {
+      PhaseTimer Timer(timeOf(&FormatStatistics::Annotating));
+      for (unsigned i = 0, e = AnnotatedLines.size(); i != e; ++i) {
+        Annotator.annotate(AnnotatedLines[i]);
+      }
+      deriveLocalStyle();
+      for (unsigned i = 0, e = AnnotatedLines.size(); i != e; ++i) {
+        Annotator.calculateFormattingInformation(AnnotatedLines[i]);
+        LineIsAnnotated[i] = true;
+      }
     }
 
     // Adapt level to the next line if this is a comment.
@@ -1515,17 +1621,27 @@ public:
       unsigned Indent = getIndent(IndentForLevel, TheLine.Level);
       if (static_cast<int>(Indent) + Offset >= 0)
         Indent += Offset;
-      tryFitMultipleLinesInOne(Indent, I, E);
+      if (mightMergeWithNextLines(TheLine)) {
+        // Merging looks at most two lines ahead.
+        for (unsigned Ahead = 0; Ahead != 3 && I + Ahead != E; ++Ahead)
+          ensureAnnotated(I + Ahead);
+        tryFitMultipleLinesInOne(Indent, I, E);
+      }
 
       bool WasMoved = PreviousLineWasTouched && FirstTok->NewlinesBefore == 0;
+      bool FormatLine = TheLine.First->isNot(tok::eof) &&
+                        (WasMoved || FormatPPDirective || touchesLine(TheLine));
+      if (FormatLine) {
+        ensureAnnotated(I);
+        FormatLine = TheLine.Type != LT_Invalid;
+      }
       if (TheLine.First->is(tok::eof)) {
         if (PreviousLineWasTouched) {
           unsigned NewLines = std::min(FirstTok->NewlinesBefore, 1u);
           Whitespaces.replaceWhitespace(*TheLine.First, NewLines, /*Indent*/ 0,
                                         /*TargetColumn*/ 0);
         }
-      } else if (TheLine.Type != LT_Invalid &&
-                 (WasMoved || FormatPPDirective || touchesLine(TheLine))) {
+      } else if (FormatLine) {
         unsigned LevelIndent = getIndent(IndentForLevel, TheLine.Level);
         if (FirstTok->WhitespaceRange.isValid() &&
             // Insert a break even if there is a structural error in case where
@@ -1538,10 +1654,17 @@ public:
               SourceMgr.getSpellingColumnNumber(FirstTok->Tok.getLocation()) -
               1;
         }
-        UnwrappedLineFormatter Formatter(Style, SourceMgr, TheLine, Indent,
-                                         TheLine.First, Whitespaces, Encoding,
-                                         BinPackInconclusiveFunctions);
-        Formatter.format(I + 1 != E ? &*(I + 1) : NULL);
+        {
+          PhaseTimer Timer(timeOf(&FormatStatistics::LineFormatting));
+          UnwrappedLineFormatter Formatter(Style, SourceMgr, TheLine, Indent,
+                                           TheLine.First, Whitespaces, Encoding,
+                                           BinPackInconclusiveFunctions);
+          Formatter.format(I + 1 != E ? &*(I + 1) : NULL);
+          if (Statistics) {
+            ++Statistics->NumFormattedLines;
+            Statistics->NumStateNodes += Formatter.getNumStateNodes();
+          }
+        }
         IndentForLevel[TheLine.Level] = LevelIndent;
         PreviousLineWasTouched = true;
       } else {
@@ -1577,10 +1700,43 @@ public:
       }
       PreviousLineLastToken = I->Last;
     }
+    PhaseTimer Timer(timeOf(&FormatStatistics::Replacements));
     return Whitespaces.generateReplacements();
   }
 
 private:
+  /// \brief Returns where to add the time spent in \p Phase, if anywhere.
+  llvm::TimeRecord *timeOf(llvm::TimeRecord FormatStatistics::*Phase) {
+    return Statistics ? &(Statistics->*Phase) : NULL;
+  }
+
+  /// \brief Annotates \p I and calculates its formatting information, unless
+  /// that was done already.
+  void ensureAnnotated(std::vector<AnnotatedLine>::iterator I) {
+    unsigned Index = I - AnnotatedLines.begin();
+    if (LineIsAnnotated[Index])
+      return;
+    PhaseTimer Timer(timeOf(&FormatStatistics::Annotating));
+    Annotator->annotate(*I);
+    Annotator->calculateFormattingInformation(*I);
+    LineIsAnnotated[Index] = true;
+  }
+
+  /// \brief Returns \c false if \c tryFitMultipleLinesInOne will certainly
+  /// leave \p Line alone.
+  ///
+  /// This only looks at the tokens themselves, so that lines that cannot be
+  /// merged need not be annotated.
+  bool mightMergeWithNextLines(const AnnotatedLine &Line) {
+    return Line.Last->is(tok::l_brace) ||
+           (Style.AllowShortIfStatementsOnASingleLine &&
+            Line.First->is(tok::kw_if)) ||
+           (Style.AllowShortLoopsOnASingleLine &&
+            Line.First->isOneOf(tok::kw_for, tok::kw_while)) ||
+           (Line.InPPDirective &&
+            (Line.First->HasUnescapedNewline || Line.First->IsFirst));
+  }
+
   void deriveLocalStyle() {
     unsigned CountBoundToVariable = 0;
     unsigned CountBoundToType = 0;
@@ -1882,6 +2038,10 @@ private:
   WhitespaceManager Whitespaces;
   std::vector<CharSourceRange> Ranges;
   std::vector<AnnotatedLine> AnnotatedLines;
+  TokenAnnotator *Annotator;
+  // Whether each of \c AnnotatedLines has been annotated yet.
+  std::vector<bool> LineIsAnnotated;
+  FormatStatistics *Statistics;
 
   encoding::Encoding Encoding;
   bool BinPackInconclusiveFunctions;
@@ -1891,14 +2051,16 @@ private:
 
 tooling::Replacements reformat(const FormatStyle &Style, Lexer &Lex,
                                SourceManager &SourceMgr,
-                               std::vector<CharSourceRange> Ranges) {
-  Formatter formatter(Style, Lex, SourceMgr, Ranges);
+                               std::vector<CharSourceRange> Ranges,
+                               FormatStatistics *Statistics) {
+  Formatter formatter(Style, Lex, SourceMgr, Ranges, Statistics);
   return formatter.format();
 }
 
 tooling::Replacements reformat(const FormatStyle &Style, StringRef Code,
                                std::vector<tooling::Range> Ranges,
-                               StringRef FileName) {
+                               StringRef FileName,
+                               FormatStatistics *Statistics) {
   FileManager Files((FileSystemOptions()));
   DiagnosticsEngine Diagnostics(
       IntrusiveRefCntPtr<DiagnosticIDs>(new DiagnosticIDs),
@@ -1919,7 +2081,7 @@ tooling::Replacements reformat(const FormatStyle &Style, StringRef Code,
     SourceLocation End = Start.getLocWithOffset(Ranges[i].getLength());
     CharRanges.push_back(CharSourceRange::getCharRange(Start, End));
   }
-  return reformat(Style, Lex, SourceMgr, CharRanges);
+  return reformat(Style, Lex, SourceMgr, CharRanges, Statistics);
 }
 
 LangOptions getFormattingLangOpts(FormatStyle::LanguageStandard Standard) {
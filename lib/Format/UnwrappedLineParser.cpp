@@ -64,6 +64,8 @@ public:
     TokenSource = this;
     Line.Level = 0;
     Line.InPPDirective = true;
+    FakeEOF.Tok.startToken();
+    FakeEOF.Tok.setKind(tok::eof);
   }
 
   ~ScopedMacroState() {
@@ -80,7 +82,7 @@ public:
     assert(!eof());
     Token = PreviousTokenSource->getNextToken();
     if (eof())
-      return getFakeEOF();
+      return &FakeEOF;
     return Token;
   }
 
@@ -94,17 +96,6 @@ public:
 private:
   bool eof() { return Token && Token->HasUnescapedNewline; }
 
-  FormatToken *getFakeEOF() {
-    static bool EOFInitialized = false;
-    static FormatToken FormatTok;
-    if (!EOFInitialized) {
-      FormatTok.Tok.startToken();
-      FormatTok.Tok.setKind(tok::eof);
-      EOFInitialized = true;
-    }
-    return &FormatTok;
-  }
-
   UnwrappedLine &Line;
   FormatTokenSource *&TokenSource;
   FormatToken *&ResetToken;
@@ -114,6 +105,10 @@ private:
   bool PreviousStructuralError;
 
   FormatToken *Token;
+
+  /// The eof token returned at the end of the directive. It is not shared
+  /// between instances, so that several files can be formatted at once.
+  FormatToken FakeEOF;
 };
 
 } // end anonymous namespace
@@ -21,7 +21,10 @@
 #include "clang/Basic/Diagnostic.h"
 #include "clang/Basic/FileManager.h"
 #include "clang/Basic/SourceManager.h"
+#include "clang/Frontend/ASTExportReader.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/IR/Module.h"
+#include "llvm/Support/LEB128.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/Timer.h"
 #include "llvm/Support/raw_ostream.h"
@@ -500,3 +503,135 @@ public:
 ASTConsumer *clang::CreateASTDumperXML(raw_ostream &OS) {
   return new ASTDumpXML(OS);
 }
+
+//===----------------------------------------------------------------------===//
+/// ASTExporter - Compact binary export of ASTs, read by ASTExportReader.
+
+namespace {
+class ASTExporter : public ASTConsumer,
+                    public RecursiveASTVisitor<ASTExporter> {
+  typedef RecursiveASTVisitor<ASTExporter> base;
+
+  raw_ostream &OS;
+  SourceManager *SM;
+  llvm::StringMap<unsigned> StringIDs;
+  unsigned NumNodes;
+  /// The nodes being traversed, innermost last.
+  SmallVector<unsigned, 32> Parents;
+
+  void writeNumber(uint64_t Value) { llvm::encodeULEB128(Value, OS); }
+
+  /// \brief Returns the number of \p Str in the string table, writing it
+  /// first if it's new.
+  unsigned getStringID(StringRef Str) {
+    if (Str.empty())
+      return 0;
+    unsigned &ID = StringIDs[Str];
+    if (!ID) {
+      ID = StringIDs.size();
+      writeNumber(ast_export::REC_String);
+      writeNumber(Str.size());
+      OS << Str;
+    }
+    return ID;
+  }
+
+  void writeNode(ast_export::NodeClass Class, StringRef Kind,
+                 SourceRange Range, StringRef Name, QualType Type);
+
+public:
+  ASTExporter(raw_ostream &OS) : OS(OS), SM(0), NumNodes(0) {}
+
+  virtual void HandleTranslationUnit(ASTContext &Context) {
+    SM = &Context.getSourceManager();
+    OS.write(ast_export::Magic, sizeof(ast_export::Magic));
+    writeNumber(ast_export::Version);
+    TraverseDecl(Context.getTranslationUnitDecl());
+    writeNumber(ast_export::REC_End);
+  }
+
+  bool TraverseDecl(Decl *D);
+  bool TraverseStmt(Stmt *S);
+};
+}
+
+void ASTExporter::writeNode(ast_export::NodeClass Class, StringRef Kind,
+                            SourceRange Range, StringRef Name,
+                            QualType Type) {
+  // The strings come first, so that a reader knows them by the node.
+  unsigned KindID = getStringID(Kind);
+  unsigned FileStrID = 0;
+  unsigned BeginLine = 0, BeginColumn = 0, EndLine = 0, EndColumn = 0;
+  if (Range.getBegin().isValid()) {
+    SourceLocation Begin = SM->getExpansionLoc(Range.getBegin());
+    SourceLocation End = SM->getExpansionLoc(Range.getEnd());
+    if (const FileEntry *File = SM->getFileEntryForID(SM->getFileID(Begin)))
+      FileStrID = getStringID(File->getName());
+    BeginLine = SM->getExpansionLineNumber(Begin);
+    BeginColumn = SM->getExpansionColumnNumber(Begin);
+    if (End.isValid()) {
+      EndLine = SM->getExpansionLineNumber(End);
+      EndColumn = SM->getExpansionColumnNumber(End);
+    }
+  }
+  unsigned NameID = getStringID(Name);
+  unsigned TypeID = Type.isNull() ? 0 : getStringID(Type.getAsString());
+
+  writeNumber(ast_export::REC_Node);
+  writeNumber(Class);
+  writeNumber(KindID);
+  writeNumber(FileStrID);
+  writeNumber(BeginLine);
+  writeNumber(BeginColumn);
+  writeNumber(EndLine);
+  writeNumber(EndColumn);
+  writeNumber(NameID);
+  writeNumber(TypeID);
+  writeNumber(Parents.empty() ? 0 : Parents.back());
+}
+
+bool ASTExporter::TraverseDecl(Decl *D) {
+  if (!D)
+    return true;
+
+  std::string Name;
+  if (NamedDecl *ND = dyn_cast<NamedDecl>(D))
+    Name = ND->getNameAsString();
+  QualType Type;
+  if (ValueDecl *VD = dyn_cast<ValueDecl>(D))
+    Type = VD->getType();
+  else if (TypedefNameDecl *TD = dyn_cast<TypedefNameDecl>(D))
+    Type = TD->getUnderlyingType();
+  writeNode(ast_export::NC_Decl, D->getDeclKindName(), D->getSourceRange(),
+            Name, Type);
+
+  Parents.push_back(++NumNodes);
+  bool Result = base::TraverseDecl(D);
+  Parents.pop_back();
+  return Result;
+}
+
+bool ASTExporter::TraverseStmt(Stmt *S) {
+  if (!S)
+    return true;
+
+  std::string Name;
+  if (DeclRefExpr *DRE = dyn_cast<DeclRefExpr>(S))
+    Name = DRE->getDecl()->getNameAsString();
+  else if (MemberExpr *ME = dyn_cast<MemberExpr>(S))
+    Name = ME->getMemberDecl()->getNameAsString();
+  QualType Type;
+  if (Expr *E = dyn_cast<Expr>(S))
+    Type = E->getType();
+  writeNode(ast_export::NC_Stmt, S->getStmtClassName(), S->getSourceRange(),
+            Name, Type);
+
+  Parents.push_back(++NumNodes);
+  bool Result = base::TraverseStmt(S);
+  Parents.pop_back();
+  return Result;
+}
+
+ASTConsumer *clang::CreateASTExporter(raw_ostream &OS) {
+  return new ASTExporter(OS);
+}
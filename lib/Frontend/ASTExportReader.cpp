@@ -0,0 +1,103 @@
+//===--- ASTExportReader.cpp - Read binary AST exports --------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the reader of the exports of -ast-export-binary.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Frontend/ASTExportReader.h"
+using namespace clang;
+using namespace clang::ast_export;
+
+ASTExportReader::ASTExportReader(StringRef Data)
+    : Data(Data), Pos(0), Error(false), AtEnd(false), NumNodes(0) {
+  Strings.push_back(StringRef());
+  if (!Data.startswith(StringRef(Magic, sizeof(Magic)))) {
+    fail();
+    return;
+  }
+  Pos = sizeof(Magic);
+  uint64_t ExportVersion;
+  if (!readNumber(ExportVersion) || ExportVersion != Version)
+    fail();
+}
+
+bool ASTExportReader::readNumber(uint64_t &Value) {
+  Value = 0;
+  for (unsigned Shift = 0; Pos != Data.size(); Shift += 7) {
+    unsigned char Byte = Data[Pos++];
+    if (Shift >= 64)
+      return fail();
+    Value |= uint64_t(Byte & 0x7f) << Shift;
+    if (!(Byte & 0x80))
+      return true;
+  }
+  return fail();
+}
+
+bool ASTExportReader::readNumber(unsigned &Value) {
+  uint64_t Wide;
+  if (!readNumber(Wide) || Wide > ~0U)
+    return fail();
+  Value = Wide;
+  return true;
+}
+
+bool ASTExportReader::readString(StringRef &Str) {
+  unsigned ID;
+  if (!readNumber(ID) || ID >= Strings.size())
+    return fail();
+  Str = Strings[ID];
+  return true;
+}
+
+bool ASTExportReader::readNode(ASTExportNode &Node) {
+  while (!Error && !AtEnd) {
+    unsigned Code;
+    if (!readNumber(Code))
+      return false;
+
+    switch (Code) {
+    case REC_End:
+      AtEnd = true;
+      return false;
+
+    case REC_String: {
+      uint64_t Length;
+      if (!readNumber(Length) || Length > Data.size() - Pos)
+        return fail();
+      Strings.push_back(Data.substr(Pos, Length));
+      Pos += Length;
+      break;
+    }
+
+    case REC_Node: {
+      unsigned Class;
+      if (!readNumber(Class) || Class > NC_Stmt)
+        return fail();
+      Node.Index = ++NumNodes;
+      Node.Class = NodeClass(Class);
+      if (!readString(Node.Kind) || !readString(Node.File) ||
+          !readNumber(Node.BeginLine) || !readNumber(Node.BeginColumn) ||
+          !readNumber(Node.EndLine) || !readNumber(Node.EndColumn) ||
+          !readString(Node.Name) || !readString(Node.Type) ||
+          !readNumber(Node.Parent))
+        return false;
+      // The parent is written before its children.
+      if (Node.Parent >= Node.Index)
+        return fail();
+      return true;
+    }
+
+    default:
+      return fail();
+    }
+  }
+  return false;
+}
@@ -39,6 +39,9 @@ void ASTMergeAction::ExecuteAction() {
                                        &CI.getASTContext());
   IntrusiveRefCntPtr<DiagnosticIDs>
       DiagIDs(CI.getDiagnostics().getDiagnosticIDs());
+  // Headers that several of the AST files include only need to be merged
+  // once.
+  ImportedDeclCache SharedDecls(CI.getASTContext());
   for (unsigned I = 0, N = ASTFiles.size(); I != N; ++I) {
     IntrusiveRefCntPtr<DiagnosticsEngine>
         Diags(new DiagnosticsEngine(DiagIDs, &CI.getDiagnosticOpts(),
@@ -54,7 +57,7 @@ void ASTMergeAction::ExecuteAction() {
                          CI.getFileManager(),
                          Unit->getASTContext(), 
                          Unit->getFileManager(),
-                         /*MinimalImport=*/false);
+                         /*MinimalImport=*/false, &SharedDecls);
 
     TranslationUnitDecl *TU = Unit->getASTContext().getTranslationUnitDecl();
     for (DeclContext::decl_iterator D = TU->decls_begin(), 
@@ -17,9 +17,11 @@
 #include "clang/AST/DeclVisitor.h"
 #include "clang/AST/StmtVisitor.h"
 #include "clang/AST/TypeOrdering.h"
+#include "clang/Basic/CharInfo.h"
 #include "clang/Basic/Diagnostic.h"
 #include "clang/Basic/TargetInfo.h"
 #include "clang/Basic/TargetOptions.h"
+#include "clang/Basic/WorkerPool.h"
 #include "clang/Frontend/CompilerInstance.h"
 #include "clang/Frontend/FrontendActions.h"
 #include "clang/Frontend/FrontendDiagnostic.h"
@@ -27,17 +29,20 @@
 #include "clang/Frontend/MultiplexConsumer.h"
 #include "clang/Frontend/Utils.h"
 #include "clang/Lex/HeaderSearch.h"
+#include "clang/Lex/Lexer.h"
 #include "clang/Lex/Preprocessor.h"
 #include "clang/Lex/PreprocessorOptions.h"
 #include "clang/Serialization/ASTReader.h"
 #include "clang/Serialization/ASTWriter.h"
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/IntrusiveRefCntPtr.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/StringSet.h"
 #include "llvm/Support/Atomic.h"
 #include "llvm/Support/CrashRecoveryContext.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Host.h"
+#include "llvm/Support/MD5.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Mutex.h"
 #include "llvm/Support/MutexGuard.h"
@@ -79,10 +84,40 @@ namespace {
     }
   };
   
+  /// \brief A precompiled preamble that several ASTUnits for the same main
+  /// file can use, because they see the same preamble and are parsed with
+  /// the same options.
+  ///
+  /// The preamble file is removed once the last ASTUnit using it lets go.
+  /// References to a SharedPreamble are only taken or dropped with the
+  /// on-disk mutex held.
+  struct SharedPreamble : public llvm::RefCountedBase<SharedPreamble> {
+    /// \brief The key under which the preamble is registered.
+    std::string Key;
+
+    /// \brief The file in which the precompiled preamble is stored.
+    std::string PreambleFile;
+
+    /// \brief The state that the ASTUnit which built the preamble keeps
+    /// about it; see the ASTUnit members with the same names.
+    unsigned PreambleReservedSize;
+    llvm::StringMap<std::pair<off_t, time_t> > FilesInPreamble;
+    std::vector<serialization::DeclID> TopLevelDeclsInPreamble;
+    unsigned TopLevelHashValue;
+
+    SharedPreamble(StringRef Key, StringRef PreambleFile)
+      : Key(Key), PreambleFile(PreambleFile), PreambleReservedSize(0),
+        TopLevelHashValue(0) { }
+    ~SharedPreamble();
+  };
+
   struct OnDiskData {
     /// \brief The file in which the precompiled preamble is stored.
     std::string PreambleFile;
 
+    /// \brief The shared preamble that owns \c PreambleFile, if any.
+    IntrusiveRefCntPtr<SharedPreamble> SharedPreambleFile;
+
     /// \brief Temporary files that should be removed when the ASTUnit is
     /// destroyed.
     SmallVector<std::string, 4> TemporaryFiles;
@@ -138,7 +173,27 @@ static OnDiskData &getOnDiskData(const ASTUnit *AU) {
   return *D;
 }
 
+/// \brief The preambles that ASTUnits can share, by key.
+///
+/// Only accessed with the on-disk mutex held. The map is never freed, so that
+/// preambles released at exit can still unregister themselves.
+static llvm::StringMap<SharedPreamble *> &getSharedPreambleMap() {
+  static llvm::StringMap<SharedPreamble *> *M =
+      new llvm::StringMap<SharedPreamble *>();
+  return *M;
+}
+
+SharedPreamble::~SharedPreamble() {
+  llvm::MutexGuard Guard(getOnDiskMutex());
+  llvm::StringMap<SharedPreamble *> &M = getSharedPreambleMap();
+  llvm::StringMap<SharedPreamble *>::iterator Known = M.find(Key);
+  if (Known != M.end() && Known->second == this)
+    M.erase(Known);
+  llvm::sys::fs::remove(PreambleFile);
+}
+
 static void erasePreambleFile(const ASTUnit *AU) {
+  llvm::MutexGuard Guard(getOnDiskMutex());
   getOnDiskData(AU).CleanPreambleFile();
 }
 
@@ -159,10 +214,31 @@ static void setPreambleFile(const ASTUnit *AU, StringRef preambleFile) {
   getOnDiskData(AU).PreambleFile = preambleFile;
 }
 
+/// \brief Make \p AU use, and share ownership of, the preamble file of
+/// \p Shared.
+static void setSharedPreambleFile(const ASTUnit *AU, SharedPreamble *Shared) {
+  llvm::MutexGuard Guard(getOnDiskMutex());
+  OnDiskData &D = getOnDiskData(AU);
+  D.PreambleFile = Shared->PreambleFile;
+  D.SharedPreambleFile = Shared;
+}
+
 static const std::string &getPreambleFile(const ASTUnit *AU) {
   return getOnDiskData(AU).PreambleFile;  
 }
 
+/// \brief Make \p To use the preamble file of \p From in place of its own,
+/// and \p From use none.
+static void transferPreambleFile(const ASTUnit *From, const ASTUnit *To) {
+  llvm::MutexGuard Guard(getOnDiskMutex());
+  OnDiskData &Source = getOnDiskData(From);
+  OnDiskData &Dest = getOnDiskData(To);
+  Dest.CleanPreambleFile();
+  Dest.PreambleFile.swap(Source.PreambleFile);
+  Dest.SharedPreambleFile = Source.SharedPreambleFile;
+  Source.SharedPreambleFile = 0;
+}
+
 void OnDiskData::CleanTemporaryFiles() {
   for (unsigned I = 0, N = TemporaryFiles.size(); I != N; ++I)
     llvm::sys::fs::remove(TemporaryFiles[I]);
@@ -170,6 +246,13 @@ void OnDiskData::CleanTemporaryFiles() {
 }
 
 void OnDiskData::CleanPreambleFile() {
+  if (SharedPreambleFile) {
+    // The shared preamble removes the file when nobody uses it any more.
+    SharedPreambleFile = 0;
+    PreambleFile.clear();
+    return;
+  }
+
   if (!PreambleFile.empty()) {
     llvm::sys::fs::remove(PreambleFile);
     PreambleFile.clear();
@@ -210,6 +293,50 @@ void ASTUnit::addTemporaryFile(StringRef TempFile) {
 /// preamble.
 const unsigned DefaultPreambleRebuildInterval = 5;
 
+/// \brief A precompiled preamble being built on another thread.
+///
+/// The build is performed by an ASTUnit of its own, so that the thread shares
+/// no state with the ASTUnit that will take the preamble over.
+struct ASTUnit::BackgroundPreamble {
+  OwningPtr<ASTUnit> Builder;
+  PreambleRebuiltCallback Callback;
+  void *CallbackContext;
+
+  llvm::sys::Mutex Lock;
+  bool Done;
+
+  OwningPtr<BackgroundThread> Thread;
+
+  BackgroundPreamble() : Callback(0), CallbackContext(0), Done(false) { }
+
+  ~BackgroundPreamble() {
+    // Wait for the build before tearing down the builder.
+    Thread.reset();
+  }
+
+  bool isDone() {
+    llvm::sys::ScopedLock L(Lock);
+    return Done;
+  }
+
+  static void run(void *Context);
+};
+
+void ASTUnit::BackgroundPreamble::run(void *Context) {
+  BackgroundPreamble &BP = *static_cast<BackgroundPreamble *>(Context);
+  ASTUnit &Builder = *BP.Builder;
+  delete Builder.getMainBufferWithPrecompiledPreamble(*Builder.Invocation);
+  bool Succeeded = !getPreambleFile(&Builder).empty();
+
+  {
+    llvm::sys::ScopedLock L(BP.Lock);
+    BP.Done = true;
+  }
+
+  if (BP.Callback)
+    BP.Callback(BP.CallbackContext, Succeeded);
+}
+
 /// \brief Tracks the number of ASTUnit objects that are currently active.
 ///
 /// Used for debugging purposes only.
@@ -218,14 +345,18 @@ static llvm::sys::cas_flag ActiveASTUnitObjects;
 ASTUnit::ASTUnit(bool _MainFileIsAST)
   : Reader(0), HadModuleLoaderFatalFailure(false),
     OnlyLocalDecls(false), CaptureDiagnostics(false),
-    MainFileIsAST(_MainFileIsAST), 
+    MainFileIsAST(_MainFileIsAST), Hibernated(false),
     TUKind(TU_Complete), WantTiming(getenv("LIBCLANG_TIMING")),
     OwnsRemappedFileBuffers(true),
     NumStoredDiagnosticsFromDriver(0),
-    PreambleRebuildCounter(0), SavedMainFileBuffer(0), PreambleBuffer(0),
+    PreambleRebuildCounter(0), RebuildPreambleInBackground(false),
+    PreambleOutOfDate(false), PreambleRebuiltFn(0), PreambleRebuiltContext(0),
+    ReparseIncrementally(false), SharePreambles(false),
+    SavedMainFileBuffer(0), PreambleBuffer(0),
     NumWarningsInPreamble(0),
     ShouldCacheCodeCompletionResults(false),
     IncludeBriefCommentsInCodeCompletion(false), UserFilesAreVolatile(false),
+    NumCachedCompletionStringsAllocated(0),
     CompletionCacheTopLevelHashValue(0),
     PreambleTopLevelHashValue(0),
     CurrentTopLevelHashValue(0),
@@ -237,6 +368,9 @@ ASTUnit::ASTUnit(bool _MainFileIsAST)
 }
 
 ASTUnit::~ASTUnit() {
+  // Wait for, and throw away, any preamble still being built.
+  PendingPreamble.reset();
+
   // If we loaded from an AST file, balance out the BeginSourceFile call.
   if (MainFileIsAST && getDiagnostics().getClient()) {
     getDiagnostics().getClient()->EndSourceFile();
@@ -348,6 +482,67 @@ static unsigned getDeclShowContexts(const NamedDecl *ND,
   return Contexts;
 }
 
+/// \brief The kinds of cached completion results, which tell apart the
+/// results for one declaration or macro definition.
+enum CachedResultKind {
+  CRK_Declaration,
+  CRK_NestedNameSpecifier,
+  CRK_Macro
+};
+
+CodeCompletionString *
+ASTUnit::getCachedCompletionString(CodeCompletionResult &Result,
+                                   unsigned ResultKind,
+                                   CodeCompletionTUInfo &CCTUInfo,
+                             llvm::StringMap<CachedCompletionFile> &OldFiles) {
+  SourceLocation Loc;
+  if (Result.Kind == CodeCompletionResult::RK_Macro) {
+    if (const MacroInfo *MI
+          = TheSema->PP.getMacroInfo(const_cast<IdentifierInfo *>(Result.Macro)))
+      Loc = MI->getDefinitionLoc();
+  } else {
+    Loc = Result.Declaration->getLocation();
+  }
+
+  // Only the strings for results from files of the preamble whose contents
+  // come from disk can be reused, since the stamps of the others do not tell
+  // whether they have changed.
+  CachedCompletionFile *NewFile = 0;
+  uint64_t Key = 0;
+  CodeCompletionString *String = 0;
+  if (Loc.isValid()) {
+    SourceManager &SM = getSourceManager();
+    std::pair<FileID, unsigned> Decomposed = SM.getDecomposedExpansionLoc(Loc);
+    const FileEntry *File = SM.getFileEntryForID(Decomposed.first);
+    llvm::StringMap<std::pair<off_t, time_t> >::iterator Stamp
+      = File ? FilesInPreamble.find(File->getName()) : FilesInPreamble.end();
+    if (Stamp != FilesInPreamble.end() && !SM.isFileOverridden(File)) {
+      Key = (uint64_t(Decomposed.second) << 2) | ResultKind;
+      llvm::StringMap<CachedCompletionFile>::iterator Old
+        = OldFiles.find(File->getName());
+      if (Old != OldFiles.end() && Old->second.Stamp == Stamp->second) {
+        llvm::DenseMap<uint64_t, CodeCompletionString *>::iterator Known
+          = Old->second.Strings.find(Key);
+        if (Known != Old->second.Strings.end())
+          String = Known->second;
+      }
+      NewFile = &CachedCompletionFiles[File->getName()];
+      NewFile->Stamp = Stamp->second;
+    }
+  }
+
+  if (!String) {
+    String = Result.CreateCodeCompletionString(*TheSema,
+                                               *CachedCompletionAllocator,
+                                               CCTUInfo,
+                                          IncludeBriefCommentsInCodeCompletion);
+    ++NumCachedCompletionStringsAllocated;
+  }
+  if (NewFile)
+    NewFile->Strings[Key] = String;
+  return String;
+}
+
 void ASTUnit::CacheCodeCompletionResults() {
   if (!TheSema)
     return;
@@ -355,13 +550,34 @@ void ASTUnit::CacheCodeCompletionResults() {
   SimpleTimer Timer(WantTiming);
   Timer.setOutput("Cache global code completions for " + getMainFileName());
 
+  // Keep the strings of the previous results for the files that have not
+  // changed, unless most of the strings in their allocator are dead, in which
+  // case start over in a fresh one.
+  llvm::StringMap<CachedCompletionFile> OldFiles;
+  unsigned NumLiveStrings = 0;
+  for (llvm::StringMap<CachedCompletionFile>::iterator
+         F = CachedCompletionFiles.begin(), FEnd = CachedCompletionFiles.end();
+       F != FEnd; ++F)
+    NumLiveStrings += F->second.Strings.size();
+  IntrusiveRefCntPtr<GlobalCodeCompletionAllocator> Allocator;
+  if (CachedCompletionAllocator &&
+      NumLiveStrings * 2 >= NumCachedCompletionStringsAllocated) {
+    Allocator = CachedCompletionAllocator;
+    OldFiles.swap(CachedCompletionFiles);
+  }
+
   // Clear out the previous results.
   ClearCachedCompletionResults();
   
   // Gather the set of global code completions.
   typedef CodeCompletionResult Result;
   SmallVector<Result, 8> Results;
-  CachedCompletionAllocator = new GlobalCodeCompletionAllocator;
+  if (Allocator) {
+    CachedCompletionAllocator = Allocator;
+  } else {
+    CachedCompletionAllocator = new GlobalCodeCompletionAllocator;
+    NumCachedCompletionStringsAllocated = 0;
+  }
   CodeCompletionTUInfo CCTUInfo(CachedCompletionAllocator);
   TheSema->GatherGlobalCodeCompletions(*CachedCompletionAllocator,
                                        CCTUInfo, Results);
@@ -374,10 +590,9 @@ void ASTUnit::CacheCodeCompletionResults() {
     case Result::RK_Declaration: {
       bool IsNestedNameSpecifier = false;
       CachedCodeCompletionResult CachedResult;
-      CachedResult.Completion = Results[I].CreateCodeCompletionString(*TheSema,
-                                                    *CachedCompletionAllocator,
-                                                    CCTUInfo,
-                                          IncludeBriefCommentsInCodeCompletion);
+      CachedResult.Completion = getCachedCompletionString(Results[I],
+                                                          CRK_Declaration,
+                                                          CCTUInfo, OldFiles);
       CachedResult.ShowInContexts = getDeclShowContexts(Results[I].Declaration,
                                                         Ctx->getLangOpts(),
                                                         IsNestedNameSpecifier);
@@ -439,11 +654,9 @@ void ASTUnit::CacheCodeCompletionResults() {
           // nested-name-specifier but isn't already an option, create a 
           // nested-name-specifier completion.
           Results[I].StartsNestedNameSpecifier = true;
-          CachedResult.Completion 
-            = Results[I].CreateCodeCompletionString(*TheSema,
-                                                    *CachedCompletionAllocator,
-                                                    CCTUInfo,
-                                        IncludeBriefCommentsInCodeCompletion);
+          CachedResult.Completion
+            = getCachedCompletionString(Results[I], CRK_NestedNameSpecifier,
+                                        CCTUInfo, OldFiles);
           CachedResult.ShowInContexts = RemainingContexts;
           CachedResult.Priority = CCP_NestedNameSpecifier;
           CachedResult.TypeClass = STC_Void;
@@ -462,11 +675,8 @@ void ASTUnit::CacheCodeCompletionResults() {
       
     case Result::RK_Macro: {
       CachedCodeCompletionResult CachedResult;
-      CachedResult.Completion 
-        = Results[I].CreateCodeCompletionString(*TheSema,
-                                                *CachedCompletionAllocator,
-                                                CCTUInfo,
-                                          IncludeBriefCommentsInCodeCompletion);
+      CachedResult.Completion
+        = getCachedCompletionString(Results[I], CRK_Macro, CCTUInfo, OldFiles);
       CachedResult.ShowInContexts
         = (1LL << CodeCompletionContext::CCC_TopLevel)
         | (1LL << CodeCompletionContext::CCC_ObjCInterface)
@@ -499,6 +709,7 @@ void ASTUnit::CacheCodeCompletionResults() {
 void ASTUnit::ClearCachedCompletionResults() {
   CachedCompletionResults.clear();
   CachedCompletionTypes.clear();
+  CachedCompletionFiles.clear();
   CachedCompletionAllocator = 0;
 }
 
@@ -675,6 +886,93 @@ void ASTUnit::ConfigureDiags(IntrusiveRefCntPtr<DiagnosticsEngine> &Diags,
   }
 }
 
+bool ASTUnit::readASTFile(const std::string &Filename,
+                          bool AllowPCHWithCompilerErrors) {
+  unsigned Counter;
+
+  OwningPtr<ASTReader> NewReader;
+
+  PP = new Preprocessor(new PreprocessorOptions(),
+                        getDiagnostics(), ASTFileLangOpts,
+                        /*Target=*/0, getSourceManager(), *HeaderInfo,
+                        *this,
+                        /*IILookup=*/0,
+                        /*OwnsHeaderSearch=*/false,
+                        /*DelayInitialization=*/true);
+
+  Ctx = new ASTContext(ASTFileLangOpts,
+                       getSourceManager(),
+                       /*Target=*/0,
+                       PP->getIdentifierTable(),
+                       PP->getSelectorTable(),
+                       PP->getBuiltinInfo(),
+                       /* size_reserve = */0,
+                       /*DelayInitialization=*/true);
+  ASTContext &Context = *Ctx;
+
+  bool disableValid = false;
+  if (::getenv("LIBCLANG_DISABLE_PCH_VALIDATION"))
+    disableValid = true;
+  NewReader.reset(new ASTReader(*PP, Context,
+                                /*isysroot=*/"",
+                                /*DisableValidation=*/disableValid,
+                                AllowPCHWithCompilerErrors));
+
+  // Recover resources if we crash before exiting this method.
+  llvm::CrashRecoveryContextCleanupRegistrar<ASTReader>
+    ReaderCleanup(NewReader.get());
+
+  NewReader->setListener(new ASTInfoCollector(*PP, Context,
+                                              ASTFileLangOpts,
+                                              TargetOpts, Target,
+                                              Counter));
+
+  switch (NewReader->ReadAST(Filename, serialization::MK_MainFile,
+                             SourceLocation(), ASTReader::ARR_None)) {
+  case ASTReader::Success:
+    break;
+
+  case ASTReader::Failure:
+  case ASTReader::Missing:
+  case ASTReader::OutOfDate:
+  case ASTReader::VersionMismatch:
+  case ASTReader::ConfigurationMismatch:
+  case ASTReader::HadErrors:
+    getDiagnostics().Report(diag::err_fe_unable_to_load_pch);
+    return true;
+  }
+
+  OriginalSourceFile = NewReader->getOriginalSourceFile();
+
+  PP->setCounterValue(Counter);
+
+  // Attach the AST reader to the AST context as an external AST
+  // source, so that declarations will be deserialized from the
+  // AST file as needed.
+  ASTReader *ReaderPtr = NewReader.get();
+  OwningPtr<ExternalASTSource> Source(NewReader.take());
+
+  // Unregister the cleanup for ASTReader.  It will get cleaned up
+  // by the ASTUnit cleanup.
+  ReaderCleanup.unregister();
+
+  Context.setExternalSource(Source);
+
+  // Create an AST consumer, even though it isn't used.
+  Consumer.reset(new ASTConsumer);
+  
+  // Create a semantic analysis object and tell the AST reader about it.
+  TheSema.reset(new Sema(*PP, Context, *Consumer));
+  TheSema->Initialize();
+  ReaderPtr->InitializeSema(*TheSema);
+  Reader = ReaderPtr;
+
+  // Tell the diagnostic client that we have started a source file.
+  getDiagnostics().getClient()->BeginSourceFile(Context.getLangOpts(),
+                                               PP.getPtr());
+  return false;
+}
+
 ASTUnit *ASTUnit::LoadFromASTFile(const std::string &Filename,
                               IntrusiveRefCntPtr<DiagnosticsEngine> Diags,
                                   const FileSystemOptions &FileSystemOpts,
@@ -758,91 +1056,8 @@ ASTUnit *ASTUnit::LoadFromASTFile(const std::string &Filename,
     }
   }
   
-  // Gather Info for preprocessor construction later on.
-
-  HeaderSearch &HeaderInfo = *AST->HeaderInfo.get();
-  unsigned Counter;
-
-  OwningPtr<ASTReader> Reader;
-
-  AST->PP = new Preprocessor(new PreprocessorOptions(),
-                             AST->getDiagnostics(), AST->ASTFileLangOpts,
-                             /*Target=*/0, AST->getSourceManager(), HeaderInfo, 
-                             *AST, 
-                             /*IILookup=*/0,
-                             /*OwnsHeaderSearch=*/false,
-                             /*DelayInitialization=*/true);
-  Preprocessor &PP = *AST->PP;
-
-  AST->Ctx = new ASTContext(AST->ASTFileLangOpts,
-                            AST->getSourceManager(),
-                            /*Target=*/0,
-                            PP.getIdentifierTable(),
-                            PP.getSelectorTable(),
-                            PP.getBuiltinInfo(),
-                            /* size_reserve = */0,
-                            /*DelayInitialization=*/true);
-  ASTContext &Context = *AST->Ctx;
-
-  bool disableValid = false;
-  if (::getenv("LIBCLANG_DISABLE_PCH_VALIDATION"))
-    disableValid = true;
-  Reader.reset(new ASTReader(PP, Context,
-                             /*isysroot=*/"",
-                             /*DisableValidation=*/disableValid,
-                             AllowPCHWithCompilerErrors));
-  
-  // Recover resources if we crash before exiting this method.
-  llvm::CrashRecoveryContextCleanupRegistrar<ASTReader>
-    ReaderCleanup(Reader.get());
-
-  Reader->setListener(new ASTInfoCollector(*AST->PP, Context,
-                                           AST->ASTFileLangOpts,
-                                           AST->TargetOpts, AST->Target, 
-                                           Counter));
-
-  switch (Reader->ReadAST(Filename, serialization::MK_MainFile,
-                          SourceLocation(), ASTReader::ARR_None)) {
-  case ASTReader::Success:
-    break;
-
-  case ASTReader::Failure:
-  case ASTReader::Missing:
-  case ASTReader::OutOfDate:
-  case ASTReader::VersionMismatch:
-  case ASTReader::ConfigurationMismatch:
-  case ASTReader::HadErrors:
-    AST->getDiagnostics().Report(diag::err_fe_unable_to_load_pch);
+  if (AST->readASTFile(Filename, AllowPCHWithCompilerErrors))
     return NULL;
-  }
-
-  AST->OriginalSourceFile = Reader->getOriginalSourceFile();
-
-  PP.setCounterValue(Counter);
-
-  // Attach the AST reader to the AST context as an external AST
-  // source, so that declarations will be deserialized from the
-  // AST file as needed.
-  ASTReader *ReaderPtr = Reader.get();
-  OwningPtr<ExternalASTSource> Source(Reader.take());
-
-  // Unregister the cleanup for ASTReader.  It will get cleaned up
-  // by the ASTUnit cleanup.
-  ReaderCleanup.unregister();
-
-  Context.setExternalSource(Source);
-
-  // Create an AST consumer, even though it isn't used.
-  AST->Consumer.reset(new ASTConsumer);
-  
-  // Create a semantic analysis object and tell the AST reader about it.
-  AST->TheSema.reset(new Sema(PP, Context, *AST->Consumer));
-  AST->TheSema->Initialize();
-  ReaderPtr->InitializeSema(*AST->TheSema);
-  AST->Reader = ReaderPtr;
-
-  // Tell the diagnostic client that we have started a source file.
-  AST->getDiagnostics().getClient()->BeginSourceFile(Context.getLangOpts(),&PP);
 
   return AST.take();
 }
@@ -1182,6 +1397,7 @@ bool ASTUnit::Parse(llvm::MemoryBuffer *OverrideMainBuffer) {
                                                     = PreambleEndsAtStartOfLine;
     PreprocessorOpts.ImplicitPCHInclude = getPreambleFile(this);
     PreprocessorOpts.DisablePCHValidation = true;
+    PreprocessorOpts.AllowOutOfDatePreamble = PreambleOutOfDate;
     
     // The stored diagnostic has the old source manager in it; update
     // the locations to refer into the new source manager. Since we've
@@ -1220,6 +1436,9 @@ bool ASTUnit::Parse(llvm::MemoryBuffer *OverrideMainBuffer) {
 
   FailedParseDiagnostics.clear();
 
+  if (ReparseIncrementally)
+    recordDeclBoundaries(OverrideMainBuffer != 0);
+
   return false;
 
 error:
@@ -1332,6 +1551,169 @@ ASTUnit::ComputePreamble(CompilerInvocation &Invocation,
                                                        MaxLines));
 }
 
+/// \brief Determine whether any of \p FilesInPreamble has changed since the
+/// preamble was built, given the file remappings in \p PreprocessorOpts.
+static bool anyPreambleFileChanged(
+    FileManager &FileMgr, PreprocessorOptions &PreprocessorOpts,
+    const llvm::StringMap<std::pair<off_t, time_t> > &FilesInPreamble) {
+  // First, make a record of those files that have been overridden via
+  // remapping or unsaved_files.
+  llvm::StringMap<std::pair<off_t, time_t> > OverriddenFiles;
+  for (PreprocessorOptions::remapped_file_iterator
+            R = PreprocessorOpts.remapped_file_begin(),
+         REnd = PreprocessorOpts.remapped_file_end();
+       R != REnd;
+       ++R) {
+    llvm::sys::fs::file_status Status;
+    if (FileMgr.getNoncachedStatValue(R->second, Status)) {
+      // If we can't stat the file we're remapping to, assume that something
+      // horrible happened.
+      return true;
+    }
+
+    OverriddenFiles[R->first] = std::make_pair(
+        Status.getSize(), Status.getLastModificationTime().toEpochTime());
+  }
+  for (PreprocessorOptions::remapped_file_buffer_iterator
+            R = PreprocessorOpts.remapped_file_buffer_begin(),
+         REnd = PreprocessorOpts.remapped_file_buffer_end();
+       R != REnd;
+       ++R) {
+    // FIXME: Should we actually compare the contents of file->buffer
+    // remappings?
+    OverriddenFiles[R->first] = std::make_pair(R->second->getBufferSize(), 
+                                               0);
+  }
+   
+  // Check whether anything has changed.
+  for (llvm::StringMap<std::pair<off_t, time_t> >::const_iterator 
+         F = FilesInPreamble.begin(), FEnd = FilesInPreamble.end();
+       F != FEnd; 
+       ++F) {
+    llvm::StringMap<std::pair<off_t, time_t> >::iterator Overridden
+      = OverriddenFiles.find(F->first());
+    if (Overridden != OverriddenFiles.end()) {
+      // This file was remapped; check whether the newly-mapped file 
+      // matches up with the previous mapping.
+      if (Overridden->second != F->second)
+        return true;
+      continue;
+    }
+    
+    // The file was not remapped; check whether it has changed on disk.
+    llvm::sys::fs::file_status Status;
+    if (FileMgr.getNoncachedStatValue(F->first(), Status)) {
+      // If we can't stat the file, assume that something horrible happened.
+      return true;
+    }
+    if (Status.getSize() != uint64_t(F->second.first) ||
+        Status.getLastModificationTime().toEpochTime() !=
+            uint64_t(F->second.second))
+      return true;
+  }
+
+  return false;
+}
+
+static void addToPreambleKey(llvm::MD5 &Hash, StringRef Data) {
+  // Include the length, so that consecutive strings can't run together.
+  Hash.update(llvm::utostr(Data.size()));
+  Hash.update(":");
+  Hash.update(Data);
+}
+
+static void addToPreambleKey(llvm::MD5 &Hash, uint64_t Value) {
+  addToPreambleKey(Hash, llvm::utostr(Value));
+}
+
+/// \brief Compute the key under which the preamble \p PreambleText of the
+/// main file of \p Invocation can be shared with other ASTUnits, or an empty
+/// string if it must not be shared.
+///
+/// ASTUnits can share a precompiled preamble when they parse the same main
+/// file, whose buffer the preamble refers to, their preambles are identical
+/// and they are parsed with the same remapped files and options. Options are
+/// compared conservatively: anything that could affect the preamble is part
+/// of the key.
+static std::string getSharedPreambleKey(CompilerInvocation &Invocation,
+                                        StringRef PreambleText,
+                                        bool PreambleEndsAtStartOfLine) {
+  // Crash-recovery testing forces every preamble into the same file.
+  if (::getenv("CINDEXTEST_PREAMBLE_FILE"))
+    return std::string();
+
+  StringRef MainFilePath = Invocation.getFrontendOpts().Inputs[0].getFile();
+  llvm::MD5 Hash;
+  addToPreambleKey(Hash, Invocation.getFileSystemOpts().WorkingDir);
+  addToPreambleKey(Hash, MainFilePath);
+  addToPreambleKey(Hash, PreambleText);
+  addToPreambleKey(Hash, PreambleEndsAtStartOfLine);
+
+  // The module hash covers the compiler version, the target, the
+  // non-benign language options, the macro definitions and the sysroot.
+  addToPreambleKey(Hash, Invocation.getModuleHash());
+
+  const LangOptions &LangOpts = *Invocation.getLangOpts();
+#define LANGOPT(Name, Bits, Default, Description) \
+  addToPreambleKey(Hash, LangOpts.Name);
+#define ENUM_LANGOPT(Name, Type, Bits, Default, Description) \
+  addToPreambleKey(Hash, static_cast<unsigned>(LangOpts.get##Name()));
+#include "clang/Basic/LangOptions.def"
+
+  const DiagnosticOptions &DiagOpts = Invocation.getDiagnosticOpts();
+#define DIAGOPT(Name, Bits, Default) addToPreambleKey(Hash, DiagOpts.Name);
+#define ENUM_DIAGOPT(Name, Type, Bits, Default) \
+  addToPreambleKey(Hash, static_cast<unsigned>(DiagOpts.get##Name()));
+#include "clang/Basic/DiagnosticOptions.def"
+  for (unsigned I = 0, N = DiagOpts.Warnings.size(); I != N; ++I)
+    addToPreambleKey(Hash, DiagOpts.Warnings[I]);
+
+  const HeaderSearchOptions &HSOpts = Invocation.getHeaderSearchOpts();
+  addToPreambleKey(Hash, HSOpts.ResourceDir);
+  for (unsigned I = 0, N = HSOpts.UserEntries.size(); I != N; ++I) {
+    const HeaderSearchOptions::Entry &E = HSOpts.UserEntries[I];
+    addToPreambleKey(Hash, E.Path);
+    addToPreambleKey(Hash, E.Group);
+    addToPreambleKey(Hash, E.IsFramework);
+    addToPreambleKey(Hash, E.IgnoreSysRoot);
+  }
+  for (unsigned I = 0, N = HSOpts.SystemHeaderPrefixes.size(); I != N; ++I) {
+    addToPreambleKey(Hash, HSOpts.SystemHeaderPrefixes[I].Prefix);
+    addToPreambleKey(Hash, HSOpts.SystemHeaderPrefixes[I].IsSystemHeader);
+  }
+
+  PreprocessorOptions &PPOpts = Invocation.getPreprocessorOpts();
+  for (unsigned I = 0, N = PPOpts.Includes.size(); I != N; ++I)
+    addToPreambleKey(Hash, PPOpts.Includes[I]);
+  for (unsigned I = 0, N = PPOpts.MacroIncludes.size(); I != N; ++I)
+    addToPreambleKey(Hash, PPOpts.MacroIncludes[I]);
+  addToPreambleKey(Hash, PPOpts.ImplicitPCHInclude);
+  addToPreambleKey(Hash, PPOpts.ImplicitPTHInclude);
+
+  // The remappings, including those of the main file, must agree exactly.
+  for (PreprocessorOptions::remapped_file_iterator
+         R = PPOpts.remapped_file_begin(), REnd = PPOpts.remapped_file_end();
+       R != REnd; ++R) {
+    addToPreambleKey(Hash, R->first);
+    addToPreambleKey(Hash, R->second);
+  }
+  for (PreprocessorOptions::remapped_file_buffer_iterator
+         R = PPOpts.remapped_file_buffer_begin(),
+         REnd = PPOpts.remapped_file_buffer_end();
+       R != REnd; ++R) {
+    addToPreambleKey(Hash, R->first);
+    addToPreambleKey(Hash, R->second->getBuffer());
+  }
+
+  addToPreambleKey(Hash, Invocation.getFrontendOpts().SkipFunctionBodies);
+
+  llvm::MD5::MD5Result Result;
+  Hash.final(Result);
+  SmallString<32> Key;
+  llvm::MD5::stringifyResult(Result, Key);
+  return Key.str();
+}
+
 static llvm::MemoryBuffer *CreatePaddedMainFileBuffer(llvm::MemoryBuffer *Old,
                                                       unsigned NewSize,
                                                       StringRef NewName) {
@@ -1386,6 +1768,22 @@ llvm::MemoryBuffer *ASTUnit::getMainBufferWithPrecompiledPreamble(
   if (CreatedPreambleBuffer)
     OwnedPreambleBuffer.reset(NewPreamble.first);
 
+  PreambleOutOfDate = false;
+
+  // Take over a preamble that finished building in the background. Code
+  // completion leaves that to the reparses, which replace the whole AST.
+  if (AllowRebuild)
+    adoptBackgroundPreamble(NewPreamble.first, NewPreamble.second);
+
+  // When reparsing incrementally, the preamble also covers the top-level
+  // declarations that precede the first edit.
+  std::pair<unsigned, bool> DirectiveBounds = NewPreamble.second;
+  if (ReparseIncrementally && NewPreamble.first)
+    NewPreamble.second = getIncrementalPreambleBounds(NewPreamble.first,
+                                                      DirectiveBounds,
+                                                      MaxLines);
+  bool ExtendedPreamble = NewPreamble.second.first > DirectiveBounds.first;
+
   if (!NewPreamble.second.first) {
     // We couldn't find a preamble in the main source. Clear out the current
     // preamble, if we have one. It's obviously no good any more.
@@ -1411,65 +1809,8 @@ llvm::MemoryBuffer *ASTUnit::getMainBufferWithPrecompiledPreamble(
       // preamble.
 
       // Check that none of the files used by the preamble have changed.
-      bool AnyFileChanged = false;
-          
-      // First, make a record of those files that have been overridden via
-      // remapping or unsaved_files.
-      llvm::StringMap<std::pair<off_t, time_t> > OverriddenFiles;
-      for (PreprocessorOptions::remapped_file_iterator
-                R = PreprocessorOpts.remapped_file_begin(),
-             REnd = PreprocessorOpts.remapped_file_end();
-           !AnyFileChanged && R != REnd;
-           ++R) {
-        llvm::sys::fs::file_status Status;
-        if (FileMgr->getNoncachedStatValue(R->second, Status)) {
-          // If we can't stat the file we're remapping to, assume that something
-          // horrible happened.
-          AnyFileChanged = true;
-          break;
-        }
-
-        OverriddenFiles[R->first] = std::make_pair(
-            Status.getSize(), Status.getLastModificationTime().toEpochTime());
-      }
-      for (PreprocessorOptions::remapped_file_buffer_iterator
-                R = PreprocessorOpts.remapped_file_buffer_begin(),
-             REnd = PreprocessorOpts.remapped_file_buffer_end();
-           !AnyFileChanged && R != REnd;
-           ++R) {
-        // FIXME: Should we actually compare the contents of file->buffer
-        // remappings?
-        OverriddenFiles[R->first] = std::make_pair(R->second->getBufferSize(), 
-                                                   0);
-      }
-       
-      // Check whether anything has changed.
-      for (llvm::StringMap<std::pair<off_t, time_t> >::iterator 
-             F = FilesInPreamble.begin(), FEnd = FilesInPreamble.end();
-           !AnyFileChanged && F != FEnd; 
-           ++F) {
-        llvm::StringMap<std::pair<off_t, time_t> >::iterator Overridden
-          = OverriddenFiles.find(F->first());
-        if (Overridden != OverriddenFiles.end()) {
-          // This file was remapped; check whether the newly-mapped file 
-          // matches up with the previous mapping.
-          if (Overridden->second != F->second)
-            AnyFileChanged = true;
-          continue;
-        }
-        
-        // The file was not remapped; check whether it has changed on disk.
-        llvm::sys::fs::file_status Status;
-        if (FileMgr->getNoncachedStatValue(F->first(), Status)) {
-          // If we can't stat the file, assume that something horrible happened.
-          AnyFileChanged = true;
-        } else if (Status.getSize() != uint64_t(F->second.first) ||
-                   Status.getLastModificationTime().toEpochTime() !=
-                       uint64_t(F->second.second))
-          AnyFileChanged = true;
-      }
-          
-      if (!AnyFileChanged) {
+      if (!anyPreambleFileChanged(*FileMgr, PreprocessorOpts,
+                                  FilesInPreamble)) {
         // Okay! We can re-use the precompiled preamble.
 
         // Set the state of the diagnostic object to mimic its state
@@ -1485,6 +1826,24 @@ llvm::MemoryBuffer *ASTUnit::getMainBufferWithPrecompiledPreamble(
                                           PreambleReservedSize,
                                           FrontendOpts.Inputs[0].getFile());
       }
+
+      // Some file used by the preamble changed. If asked to, keep using the
+      // preamble we have while its replacement is built in the background.
+      if (RebuildPreambleInBackground) {
+        if (PreambleRebuildCounter > 1)
+          --PreambleRebuildCounter;
+        else
+          startBackgroundPreambleBuild(*PreambleInvocation);
+
+        PreambleOutOfDate = true;
+        getDiagnostics().Reset();
+        ProcessWarningOptions(getDiagnostics(),
+                              PreambleInvocation->getDiagnosticOpts());
+        getDiagnostics().setNumWarnings(NumWarningsInPreamble);
+        return CreatePaddedMainFileBuffer(NewPreamble.first,
+                                          PreambleReservedSize,
+                                          FrontendOpts.Inputs[0].getFile());
+      }
     }
 
     // If we aren't allowed to rebuild the precompiled preamble, just
@@ -1503,6 +1862,22 @@ llvm::MemoryBuffer *ASTUnit::getMainBufferWithPrecompiledPreamble(
     return 0;
   }
 
+  // Another ASTUnit may already have precompiled the same preamble. Using
+  // it is cheaper than building our own, even on the first parse. Preambles
+  // that contain declarations of the main file are never shared.
+  std::string SharedKey;
+  if (SharePreambles && !ExtendedPreamble)
+    SharedKey = getSharedPreambleKey(
+        *PreambleInvocation,
+        StringRef(NewPreamble.first->getBufferStart(),
+                  NewPreamble.second.first),
+        NewPreamble.second.second);
+  if (!SharedKey.empty())
+    if (llvm::MemoryBuffer *Result
+          = useSharedPreamble(SharedKey, NewPreamble.first, NewPreamble.second,
+                              *PreambleInvocation))
+      return Result;
+
   // If the preamble rebuild counter > 1, it's because we previously
   // failed to build a preamble and we're not yet ready to try
   // again. Decrement the counter and return a failure.
@@ -1640,6 +2015,15 @@ llvm::MemoryBuffer *ASTUnit::getMainBufferWithPrecompiledPreamble(
     PreambleRebuildCounter = DefaultPreambleRebuildInterval;
     PreprocessorOpts.eraseRemappedFile(
                                PreprocessorOpts.remapped_file_buffer_end() - 1);
+
+    // Retry without the declarations of the main file, which may well be
+    // what the precompiled header failed on.
+    if (ExtendedPreamble) {
+      DeclBoundaries.clear();
+      PreambleRebuildCounter = 1;
+      return getMainBufferWithPrecompiledPreamble(PreambleInvocationIn,
+                                                  AllowRebuild, MaxLines);
+    }
     return 0;
   }
   
@@ -1683,12 +2067,419 @@ llvm::MemoryBuffer *ASTUnit::getMainBufferWithPrecompiledPreamble(
     CompletionCacheTopLevelHashValue = 0;
     PreambleTopLevelHashValue = CurrentTopLevelHashValue;
   }
+
+  // Let other ASTUnits use this preamble. Diagnostics in the preamble would
+  // refer to our main file, so only clean preambles are shared.
+  if (!SharedKey.empty() && PreambleDiagnostics.empty() &&
+      NumWarningsInPreamble == 0)
+    sharePreamble(SharedKey);
   
   return CreatePaddedMainFileBuffer(NewPreamble.first, 
                                     PreambleReservedSize,
                                     FrontendOpts.Inputs[0].getFile());
 }
 
+llvm::MemoryBuffer *
+ASTUnit::useSharedPreamble(StringRef Key, llvm::MemoryBuffer *MainBuffer,
+                           std::pair<unsigned, bool> PreambleBounds,
+                           CompilerInvocation &PreambleInvocation) {
+  llvm::MutexGuard Guard(getOnDiskMutex());
+  llvm::StringMap<SharedPreamble *>::iterator Known
+    = getSharedPreambleMap().find(Key);
+  if (Known == getSharedPreambleMap().end())
+    return 0;
+
+  // The main file must fit in the space its builder reserved for it, and
+  // the files in the preamble must not have changed since it was built.
+  SharedPreamble *Shared = Known->second;
+  if (MainBuffer->getBufferSize() >= Shared->PreambleReservedSize - 2 ||
+      anyPreambleFileChanged(*FileMgr, PreambleInvocation.getPreprocessorOpts(),
+                             Shared->FilesInPreamble))
+    return 0;
+
+  // Take on the state that building the preamble would have left us with.
+  StringRef MainFilename
+    = PreambleInvocation.getFrontendOpts().Inputs[0].getFile();
+  Preamble.assign(FileMgr->getFile(MainFilename),
+                  MainBuffer->getBufferStart(),
+                  MainBuffer->getBufferStart() + PreambleBounds.first);
+  PreambleEndsAtStartOfLine = PreambleBounds.second;
+  PreambleReservedSize = Shared->PreambleReservedSize;
+  FilesInPreamble = Shared->FilesInPreamble;
+  NumWarningsInPreamble = 0;
+  PreambleDiagnostics.clear();
+  checkAndRemoveNonDriverDiags(StoredDiagnostics);
+  TopLevelDecls.clear();
+  TopLevelDeclsInPreamble = Shared->TopLevelDeclsInPreamble;
+  OriginalSourceFile = MainFilename;
+  setSharedPreambleFile(this, Shared);
+  PreambleRebuildCounter = 1;
+
+  CurrentTopLevelHashValue = Shared->TopLevelHashValue;
+  if (CurrentTopLevelHashValue != PreambleTopLevelHashValue) {
+    CompletionCacheTopLevelHashValue = 0;
+    PreambleTopLevelHashValue = CurrentTopLevelHashValue;
+  }
+
+  getDiagnostics().Reset();
+  ProcessWarningOptions(getDiagnostics(),
+                        PreambleInvocation.getDiagnosticOpts());
+
+  return CreatePaddedMainFileBuffer(MainBuffer, PreambleReservedSize,
+                                    MainFilename);
+}
+
+void ASTUnit::sharePreamble(StringRef Key) {
+  llvm::MutexGuard Guard(getOnDiskMutex());
+  SharedPreamble *&Slot = getSharedPreambleMap()[Key];
+  if (Slot)
+    return;
+
+  Slot = new SharedPreamble(Key, getPreambleFile(this));
+  Slot->PreambleReservedSize = PreambleReservedSize;
+  Slot->FilesInPreamble = FilesInPreamble;
+  Slot->TopLevelDeclsInPreamble = TopLevelDeclsInPreamble;
+  Slot->TopLevelHashValue = CurrentTopLevelHashValue;
+  setSharedPreambleFile(this, Slot);
+}
+
+void ASTUnit::startBackgroundPreambleBuild(
+                               const CompilerInvocation &PreambleInvocation) {
+  if (PendingPreamble)
+    return;
+
+  OwningPtr<BackgroundPreamble> BP(new BackgroundPreamble());
+  BP->Builder.reset(new ASTUnit(false));
+  ASTUnit &Builder = *BP->Builder;
+
+  // The diagnostics of the build become our preamble diagnostics if we take
+  // the preamble over, so they are always captured.
+  IntrusiveRefCntPtr<DiagnosticsEngine> Diags;
+  ConfigureDiags(Diags, 0, 0, Builder, /*CaptureDiagnostics=*/true);
+  Builder.Diagnostics = Diags;
+  Builder.CaptureDiagnostics = true;
+  Builder.OnlyLocalDecls = OnlyLocalDecls;
+  Builder.TUKind = TUKind;
+  Builder.UserFilesAreVolatile = UserFilesAreVolatile;
+  Builder.FileSystemOpts = FileSystemOpts;
+  Builder.FileMgr = new FileManager(Builder.FileSystemOpts);
+  Builder.PreambleRebuildCounter = 1;
+  Builder.ReparseIncrementally = ReparseIncrementally;
+  Builder.DeclBoundaries = DeclBoundaries;
+  Builder.DeclBoundariesMainFile = DeclBoundariesMainFile;
+
+  // The remapped file buffers may be replaced or freed while the build is
+  // under way, so the builder gets copies of its own.
+  Builder.Invocation = new CompilerInvocation(PreambleInvocation);
+  PreprocessorOptions &PPOpts = Builder.Invocation->getPreprocessorOpts();
+  for (PreprocessorOptions::remapped_file_buffer_iterator
+         R = PPOpts.remapped_file_buffer_begin(),
+         REnd = PPOpts.remapped_file_buffer_end();
+       R != REnd;
+       ++R)
+    R->second = llvm::MemoryBuffer::getMemBufferCopy(
+        R->second->getBuffer(), R->second->getBufferIdentifier());
+
+  BP->Callback = PreambleRebuiltFn;
+  BP->CallbackContext = PreambleRebuiltContext;
+  PendingPreamble.reset(BP.take());
+  PendingPreamble->Thread.reset(
+      new BackgroundThread(BackgroundPreamble::run, PendingPreamble.get()));
+}
+
+void ASTUnit::adoptBackgroundPreamble(const llvm::MemoryBuffer *MainBuffer,
+                                      std::pair<unsigned, bool> NewPreamble) {
+  if (!MainBuffer || !PendingPreamble || !PendingPreamble->isDone())
+    return;
+
+  OwningPtr<BackgroundPreamble> BP(PendingPreamble.take());
+  BP->Thread.reset();
+  ASTUnit &Builder = *BP->Builder;
+  if (getPreambleFile(&Builder).empty()) {
+    // Don't try again right away.
+    PreambleRebuildCounter = DefaultPreambleRebuildInterval;
+    return;
+  }
+
+  // The main file may have changed again while the preamble was built. A
+  // preamble that extends past the directives does so over declarations that
+  // were unchanged when the build started.
+  const PreambleData &Built = Builder.Preamble;
+  if (Built.size() > MainBuffer->getBufferSize() ||
+      memcmp(Built.getBufferStart(), MainBuffer->getBufferStart(),
+             Built.size()) != 0)
+    return;
+  if (Built.size() == NewPreamble.first
+        ? Builder.PreambleEndsAtStartOfLine != NewPreamble.second
+        : Built.size() < NewPreamble.first || !Builder.ReparseIncrementally)
+    return;
+
+  // Take on the state that building the preamble would have left us with.
+  Preamble.assign(FileMgr->getFile(Builder.OriginalSourceFile),
+                  Built.getBufferStart(),
+                  Built.getBufferStart() + Built.size());
+  PreambleEndsAtStartOfLine = Builder.PreambleEndsAtStartOfLine;
+  PreambleReservedSize = Builder.PreambleReservedSize;
+  FilesInPreamble = Builder.FilesInPreamble;
+  NumWarningsInPreamble = Builder.NumWarningsInPreamble;
+  PreambleDiagnostics = Builder.PreambleDiagnostics;
+  checkAndRemoveNonDriverDiags(StoredDiagnostics);
+  TopLevelDecls.clear();
+  TopLevelDeclsInPreamble = Builder.TopLevelDeclsInPreamble;
+  OriginalSourceFile = Builder.OriginalSourceFile;
+  transferPreambleFile(&Builder, this);
+  PreambleRebuildCounter = 1;
+
+  CurrentTopLevelHashValue = Builder.CurrentTopLevelHashValue;
+  if (CurrentTopLevelHashValue != PreambleTopLevelHashValue) {
+    CompletionCacheTopLevelHashValue = 0;
+    PreambleTopLevelHashValue = CurrentTopLevelHashValue;
+  }
+}
+
+/// \brief Returns the length of the common prefix of \p A and \p B.
+static unsigned getCommonPrefixLength(StringRef A, StringRef B) {
+  unsigned N = std::min(A.size(), B.size());
+  unsigned I = 0;
+  while (I != N && A[I] == B[I])
+    ++I;
+  return I;
+}
+
+std::pair<unsigned, bool>
+ASTUnit::getIncrementalPreambleBounds(const llvm::MemoryBuffer *MainBuffer,
+                                      std::pair<unsigned, bool> DirectiveBounds,
+                                      unsigned MaxLines) {
+  StringRef Contents = MainBuffer->getBuffer();
+
+  // Keep the preamble we have for as long as the text it covers is
+  // unchanged. Code completion can only use it if it ends before the line
+  // being completed.
+  if (Preamble.size() > DirectiveBounds.first &&
+      Preamble.size() <= Contents.size() &&
+      memcmp(Preamble.getBufferStart(), Contents.data(), Preamble.size()) == 0
+      && (!MaxLines || Preamble.getNumLines() <= MaxLines))
+    return std::make_pair(unsigned(Preamble.size()),
+                          PreambleEndsAtStartOfLine);
+
+  // Code completion doesn't build preambles.
+  if (MaxLines)
+    return DirectiveBounds;
+
+  // End after the last declaration that precedes the first change.
+  unsigned Unchanged = getCommonPrefixLength(Contents, DeclBoundariesMainFile);
+  std::vector<unsigned>::iterator Last
+    = std::upper_bound(DeclBoundaries.begin(), DeclBoundaries.end(), Unchanged);
+  if (Last == DeclBoundaries.begin() || *--Last <= DirectiveBounds.first)
+    return DirectiveBounds;
+  return std::make_pair(*Last, true);
+}
+
+/// \brief Determines whether \p D is complete without a trailing semicolon.
+static bool endsWithoutSemicolon(const Decl *D) {
+  if (const FunctionTemplateDecl *FTD = dyn_cast<FunctionTemplateDecl>(D))
+    D = FTD->getTemplatedDecl();
+  if (const FunctionDecl *FD = dyn_cast<FunctionDecl>(D))
+    return FD->doesThisDeclarationHaveABody();
+  if (const LinkageSpecDecl *LSD = dyn_cast<LinkageSpecDecl>(D))
+    return LSD->hasBraces();
+  return isa<NamespaceDecl>(D);
+}
+
+/// \brief Returns the offset of the line after the one that contains
+/// \p Offset, or zero if anything other than whitespace or a line comment
+/// follows \p Offset on its line.
+static unsigned getStartOfNextLine(StringRef Contents, unsigned Offset,
+                                   const LangOptions &LangOpts) {
+  for (unsigned I = Offset, N = Contents.size(); I < N; ++I) {
+    char C = Contents[I];
+    if (C == '\n' || C == '\r') {
+      if (C == '\r' && I + 1 != N && Contents[I + 1] == '\n')
+        ++I;
+      return I + 1;
+    }
+
+    if (C == '/' && I + 1 != N && Contents[I + 1] == '/' &&
+        LangOpts.LineComment) {
+      // The comment must not continue on the next line.
+      size_t End = Contents.find_first_of("\r\n", I);
+      if (End == StringRef::npos || Contents[End - 1] == '\\')
+        return 0;
+      I = End - 1;
+      continue;
+    }
+
+    if (!isHorizontalWhitespace(C))
+      return 0;
+  }
+  return 0;
+}
+
+/// \brief Finds the offsets in [\p Begin, \p End) of \p Contents at which a
+/// precompiled preamble can end right after a top-level declaration.
+///
+/// \p DeclEnds maps the offset of the last token of each top-level
+/// declaration to whether the declaration still needs a semicolon. A
+/// boundary starts the line after such a declaration and any semicolons
+/// following it, outside of any brackets or conditional directive. The scan
+/// stops at pragmas, which may leave state behind that a precompiled header
+/// does not record.
+static void findDeclBoundaries(StringRef Contents, unsigned Begin,
+                               unsigned End,
+                               const llvm::DenseMap<unsigned, bool> &DeclEnds,
+                               const LangOptions &LangOpts,
+                               std::vector<unsigned> &Boundaries) {
+  Lexer L(SourceLocation(), LangOpts, Contents.begin(),
+          Contents.begin() + Begin, Contents.end());
+  int Depth = 0;
+  unsigned IfDepth = 0;
+  enum { NoDecl, DeclNeedsSemicolon, DeclEnded } State = NoDecl;
+  unsigned DeclEnd = 0;
+
+  Token Tok;
+  L.LexFromRawLexer(Tok);
+  while (Tok.isNot(tok::eof)) {
+    unsigned Offset = L.getBufferLocation() - Tok.getLength()
+                        - Contents.begin();
+    if (Offset >= End)
+      return;
+
+    // A declaration followed by the start of a line ends at that line.
+    if (State != NoDecl && Tok.isNot(tok::semi)) {
+      if (State == DeclEnded && Tok.isAtStartOfLine() && Depth == 0 &&
+          IfDepth == 0) {
+        unsigned Boundary = getStartOfNextLine(Contents, DeclEnd, LangOpts);
+        if (Boundary && Boundary <= Offset)
+          Boundaries.push_back(Boundary);
+      }
+      State = NoDecl;
+    }
+
+    if (Tok.is(tok::hash) && Tok.isAtStartOfLine()) {
+      L.LexFromRawLexer(Tok);
+      if (Tok.is(tok::raw_identifier) && !Tok.isAtStartOfLine()) {
+        StringRef Directive(Tok.getRawIdentifierData(), Tok.getLength());
+        if (Directive == "if" || Directive == "ifdef" ||
+            Directive == "ifndef") {
+          ++IfDepth;
+        } else if (Directive == "endif") {
+          if (IfDepth == 0)
+            return;
+          --IfDepth;
+        } else if (Directive == "pragma") {
+          L.LexFromRawLexer(Tok);
+          StringRef Name;
+          if (Tok.is(tok::raw_identifier) && !Tok.isAtStartOfLine())
+            Name = StringRef(Tok.getRawIdentifierData(), Tok.getLength());
+          if (Name != "once" && Name != "mark")
+            return;
+        }
+      }
+
+      // Skip the rest of the directive.
+      while (Tok.isNot(tok::eof) && !Tok.isAtStartOfLine())
+        L.LexFromRawLexer(Tok);
+      continue;
+    }
+
+    switch (Tok.getKind()) {
+    case tok::l_brace:
+    case tok::l_paren:
+    case tok::l_square:
+      ++Depth;
+      break;
+    case tok::r_brace:
+    case tok::r_paren:
+    case tok::r_square:
+      --Depth;
+      break;
+    case tok::raw_identifier: {
+      StringRef Name(Tok.getRawIdentifierData(), Tok.getLength());
+      if (Name == "_Pragma" || Name == "__pragma")
+        return;
+      break;
+    }
+    default:
+      break;
+    }
+
+    if (Depth == 0) {
+      llvm::DenseMap<unsigned, bool>::const_iterator Known
+        = DeclEnds.find(Offset);
+      if (Known != DeclEnds.end()) {
+        State = Known->second ? DeclNeedsSemicolon : DeclEnded;
+        DeclEnd = Offset + Tok.getLength();
+      } else if (Tok.is(tok::semi) && State != NoDecl) {
+        State = DeclEnded;
+        DeclEnd = Offset + Tok.getLength();
+      }
+    }
+
+    L.LexFromRawLexer(Tok);
+  }
+}
+
+void ASTUnit::recordDeclBoundaries(bool UsedPreamble) {
+  SourceManager &SM = getSourceManager();
+  FileID MainFID = SM.getMainFileID();
+  StringRef Contents = SM.getBuffer(MainFID)->getBuffer();
+  const LangOptions &LangOpts = *Invocation->getLangOpts();
+
+  // The boundaries within the preamble were found when that part of the file
+  // was last parsed.
+  unsigned Begin = UsedPreamble ? Preamble.size() : 0;
+  unsigned Unchanged = getCommonPrefixLength(Contents, DeclBoundariesMainFile);
+  std::vector<unsigned> Boundaries;
+  for (unsigned I = 0, N = DeclBoundaries.size();
+       I != N && DeclBoundaries[I] < Begin && DeclBoundaries[I] <= Unchanged;
+       ++I)
+    Boundaries.push_back(DeclBoundaries[I]);
+  if (Begin && PreambleEndsAtStartOfLine)
+    Boundaries.push_back(Begin);
+
+  // Only what precedes the first error could be precompiled.
+  unsigned End = Contents.size();
+  bool FoundError = false;
+  for (stored_diag_iterator D = stored_diag_begin(), DEnd = stored_diag_end();
+       D != DEnd; ++D) {
+    if (D->getLevel() < DiagnosticsEngine::Error)
+      continue;
+    FoundError = true;
+    std::pair<FileID, unsigned> Loc(FileID(), 0);
+    if (D->getLocation().isValid())
+      Loc = SM.getDecomposedExpansionLoc(D->getLocation());
+    End = Loc.first == MainFID ? std::min(End, Loc.second) : 0;
+  }
+  if (!FoundError && getDiagnostics().hasErrorOccurred())
+    End = 0;
+
+  // Objective-C declarations nest within @interface and the like in ways
+  // that the raw lexer can't follow.
+  if (!LangOpts.ObjC1 && Begin < End) {
+    llvm::DenseMap<unsigned, bool> DeclEnds;
+    for (std::vector<Decl *>::iterator D = TopLevelDecls.begin(),
+                                       DEnd = TopLevelDecls.end();
+         D != DEnd; ++D) {
+      SourceLocation Last = (*D)->getLocEnd();
+      if (Last.isInvalid())
+        continue;
+      std::pair<FileID, unsigned> Loc
+        = SM.getDecomposedLoc(SM.getExpansionRange(Last).second);
+      if (Loc.first != MainFID || Loc.second < Begin)
+        continue;
+      bool NeedsSemicolon = !endsWithoutSemicolon(*D);
+      std::pair<llvm::DenseMap<unsigned, bool>::iterator, bool> Known
+        = DeclEnds.insert(std::make_pair(Loc.second, NeedsSemicolon));
+      if (!Known.second)
+        Known.first->second |= NeedsSemicolon;
+    }
+    findDeclBoundaries(Contents, Begin, End, DeclEnds, LangOpts, Boundaries);
+  }
+
+  DeclBoundaries.swap(Boundaries);
+  DeclBoundariesMainFile = Contents;
+}
+
 void ASTUnit::RealizeTopLevelDeclsFromPreamble() {
   std::vector<Decl *> Resolved;
   Resolved.reserve(TopLevelDeclsInPreamble.size());
@@ -1982,6 +2773,7 @@ ASTUnit *ASTUnit::LoadFromCommandLine(const char **ArgBegin,
                                       bool SkipFunctionBodies,
                                       bool UserFilesAreVolatile,
                                       bool ForSerialization,
+                                      bool SharePreamble,
                                       OwningPtr<ASTUnit> *ErrAST) {
   if (!Diags.getPtr()) {
     // No diagnostics engine was provided, so create our own diagnostics object
@@ -2040,6 +2832,7 @@ ASTUnit *ASTUnit::LoadFromCommandLine(const char **ArgBegin,
   AST->IncludeBriefCommentsInCodeCompletion
     = IncludeBriefCommentsInCodeCompletion;
   AST->UserFilesAreVolatile = UserFilesAreVolatile;
+  AST->SharePreambles = SharePreamble;
   AST->NumStoredDiagnosticsFromDriver = StoredDiagnostics.size();
   AST->StoredDiagnostics.swap(StoredDiagnostics);
   AST->Invocation = CI;
@@ -2064,10 +2857,31 @@ ASTUnit *ASTUnit::LoadFromCommandLine(const char **ArgBegin,
   return AST.take();
 }
 
+bool ASTUnit::ParseRemappedFiles() {
+  // If we have a preamble file lying around, or if we might try to
+  // build a precompiled preamble, do so now.
+  llvm::MemoryBuffer *OverrideMainBuffer = 0;
+  if (!getPreambleFile(this).empty() || PreambleRebuildCounter > 0)
+    OverrideMainBuffer = getMainBufferWithPrecompiledPreamble(*Invocation);
+    
+  // Clear out the diagnostics state.
+  getDiagnostics().Reset();
+  ProcessWarningOptions(getDiagnostics(), Invocation->getDiagnosticOpts());
+  if (OverrideMainBuffer)
+    getDiagnostics().setNumWarnings(NumWarningsInPreamble);
+
+  // Parse the sources
+  return Parse(OverrideMainBuffer);
+}
+
 bool ASTUnit::Reparse(RemappedFile *RemappedFiles, unsigned NumRemappedFiles) {
   if (!Invocation)
     return true;
 
+  // A hibernating or reloaded translation unit goes back to being parsed from
+  // source; the reparse replaces the AST that was written out.
+  stopHibernating();
+
   clearFileLevelDecls();
   
   SimpleTimer ParsingTimer(WantTiming);
@@ -2096,20 +2910,7 @@ bool ASTUnit::Reparse(RemappedFile *RemappedFiles, unsigned NumRemappedFiles) {
     }
   }
   
-  // If we have a preamble file lying around, or if we might try to
-  // build a precompiled preamble, do so now.
-  llvm::MemoryBuffer *OverrideMainBuffer = 0;
-  if (!getPreambleFile(this).empty() || PreambleRebuildCounter > 0)
-    OverrideMainBuffer = getMainBufferWithPrecompiledPreamble(*Invocation);
-    
-  // Clear out the diagnostics state.
-  getDiagnostics().Reset();
-  ProcessWarningOptions(getDiagnostics(), Invocation->getDiagnosticOpts());
-  if (OverrideMainBuffer)
-    getDiagnostics().setNumWarnings(NumWarningsInPreamble);
-
-  // Parse the sources
-  bool Result = Parse(OverrideMainBuffer);
+  bool Result = ParseRemappedFiles();
   
   // If we're caching global code-completion results, and the top-level 
   // declarations have changed, clear out the code-completion cache.
@@ -2497,6 +3298,7 @@ void ASTUnit::CodeComplete(StringRef File, unsigned Line, unsigned Column,
                                                     = PreambleEndsAtStartOfLine;
     PreprocessorOpts.ImplicitPCHInclude = getPreambleFile(this);
     PreprocessorOpts.DisablePCHValidation = true;
+    PreprocessorOpts.AllowOutOfDatePreamble = PreambleOutOfDate;
     
     OwnedBuffers.push_back(OverrideMainBuffer);
   } else {
@@ -2576,6 +3378,123 @@ bool ASTUnit::serialize(raw_ostream &OS) {
   return serializeUnit(Writer, Buffer, getSema(), hasErrors, OS);
 }
 
+void ASTUnit::releaseAST() {
+  TheSema.reset();
+  Consumer.reset();
+  Ctx = 0;
+  PP = 0;
+  Reader = 0;
+  HeaderInfo.reset();
+  WriterData.reset();
+  TopLevelDecls.clear();
+  clearFileLevelDecls();
+  CCTUInfo.reset();
+}
+
+bool ASTUnit::hibernate() {
+  if (Hibernated)
+    return false;
+
+  // Only a translation unit that can be parsed from source again can fall
+  // back to doing so if it cannot be reloaded.
+  if (!Invocation || !Ctx || !hasSema() || HadModuleLoaderFatalFailure)
+    return true;
+
+  // Don't wait for another thread that is using the translation unit.
+  if (!ConcurrencyCheckValue.tryStart())
+    return true;
+
+  // A translation unit that was reloaded and not reparsed since can just be
+  // reloaded from the same file again.
+  if (HibernationFile.empty()) {
+    SmallString<128> Path;
+    int FD;
+    if (llvm::sys::fs::createTemporaryFile("hibernated", "ast", FD, Path)) {
+      ConcurrencyCheckValue.finish();
+      return true;
+    }
+
+    llvm::raw_fd_ostream Out(FD, /*shouldClose=*/true);
+    serialize(Out);
+    Out.close();
+    if (Out.has_error()) {
+      Out.clear_error();
+      bool exists;
+      llvm::sys::fs::remove(Path.str(), exists);
+      ConcurrencyCheckValue.finish();
+      return true;
+    }
+
+    HibernationFile = Path.str();
+    addTemporaryFile(HibernationFile);
+
+    // Keep the diagnostics as they refer to the source manager being written,
+    // since only those locations can be translated when the file is read.
+    HibernatedDiagnostics.assign(StoredDiagnostics.begin(),
+                                 StoredDiagnostics.end());
+  }
+
+  // If we reloaded from the AST file, balance out the BeginSourceFile call.
+  if (MainFileIsAST && getDiagnostics().getClient())
+    getDiagnostics().getClient()->EndSourceFile();
+  MainFileIsAST = false;
+
+  releaseAST();
+  SourceMgr = new SourceManager(getDiagnostics(), getFileManager(),
+                                UserFilesAreVolatile);
+  Hibernated = true;
+
+  ConcurrencyCheckValue.finish();
+  return false;
+}
+
+bool ASTUnit::wakeUp() {
+  ConcurrencyCheck Check(*this);
+
+  if (!Hibernated)
+    return false;
+  Hibernated = false;
+
+  SimpleTimer ReloadTimer(WantTiming);
+  ReloadTimer.setOutput("Reloading " + getMainFileName());
+
+  if (!HSOpts)
+    HSOpts = new HeaderSearchOptions();
+  HeaderInfo.reset(new HeaderSearch(HSOpts, getFileManager(),
+                                    getDiagnostics(), ASTFileLangOpts,
+                                    /*Target=*/0));
+
+  unsigned NumDiags = StoredDiagnostics.size();
+  if (readASTFile(HibernationFile, /*AllowPCHWithCompilerErrors=*/true)) {
+    // The AST file is out of date, e.g. because a header changed since it was
+    // written; parse the translation unit from source instead.
+    StoredDiagnostics.erase(StoredDiagnostics.begin() + NumDiags,
+                            StoredDiagnostics.end());
+    releaseAST();
+    stopHibernating();
+    return ParseRemappedFiles();
+  }
+
+  MainFileIsAST = true;
+  TranslateStoredDiagnostics(Reader, HibernationFile, getSourceManager(),
+                             HibernatedDiagnostics, StoredDiagnostics);
+  return false;
+}
+
+void ASTUnit::stopHibernating() {
+  if (HibernationFile.empty())
+    return;
+
+  if (MainFileIsAST && getDiagnostics().getClient())
+    getDiagnostics().getClient()->EndSourceFile();
+  MainFileIsAST = false;
+  Hibernated = false;
+
+  // The file itself is removed along with the other temporary files.
+  HibernationFile.clear();
+  HibernatedDiagnostics.clear();
+}
+
 typedef ContinuousRangeMap<unsigned, int, 2> SLocRemap;
 
 static void TranslateSLoc(SourceLocation &L, SLocRemap &Remap) {
@@ -2701,6 +3620,20 @@ void ASTUnit::findFileRegionDecls(FileID File, unsigned Offset, unsigned Length,
                                                          Decls);
   }
 
+  // Declarations precompiled into the preamble live in the preamble's copy
+  // of the main file.
+  if (File == SourceMgr->getMainFileID() && Offset < Preamble.size()) {
+    FileID PreambleID = SourceMgr->getPreambleFileID();
+    if (!PreambleID.isInvalid() && Ctx->getExternalSource()) {
+      // Make sure the reader knows about the declarations in the file.
+      SourceMgr->getLocForStartOfFile(PreambleID);
+      unsigned PreambleLength = std::min(Length,
+                                         unsigned(Preamble.size()) - Offset);
+      Ctx->getExternalSource()->FindFileRegionDecls(PreambleID, Offset,
+                                                    PreambleLength, Decls);
+    }
+  }
+
   FileDeclsTy::iterator I = FileDecls.find(File);
   if (I == FileDecls.end())
     return;
@@ -2926,7 +3859,6 @@ void ASTUnit::PreambleData::countLines() const {
     ++NumLines;
 }
 
-#ifndef NDEBUG
 ASTUnit::ConcurrencyState::ConcurrencyState() {
   Mutex = new llvm::sys::MutexImpl(/*recursive=*/true);
 }
@@ -2936,19 +3868,13 @@ ASTUnit::ConcurrencyState::~ConcurrencyState() {
 }
 
 void ASTUnit::ConcurrencyState::start() {
-  bool acquired = static_cast<llvm::sys::MutexImpl *>(Mutex)->tryacquire();
-  assert(acquired && "Concurrent access to ASTUnit!");
+  static_cast<llvm::sys::MutexImpl *>(Mutex)->acquire();
+}
+
+bool ASTUnit::ConcurrencyState::tryStart() {
+  return static_cast<llvm::sys::MutexImpl *>(Mutex)->tryacquire();
 }
 
 void ASTUnit::ConcurrencyState::finish() {
   static_cast<llvm::sys::MutexImpl *>(Mutex)->release();
 }
-
-#else // NDEBUG
-
-ASTUnit::ConcurrencyState::ConcurrencyState() {}
-ASTUnit::ConcurrencyState::~ConcurrencyState() {}
-void ASTUnit::ConcurrencyState::start() {}
-void ASTUnit::ConcurrencyState::finish() {}
-
-#endif
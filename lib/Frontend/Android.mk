@@ -23,6 +23,7 @@ TBLGEN_TABLES := \
 
 clang_frontend_SRC_FILES := \
   ASTConsumers.cpp \
+  ASTExportReader.cpp \
   ASTMerge.cpp \
   ASTUnit.cpp \
   CacheTokens.cpp \
@@ -38,11 +39,13 @@ clang_frontend_SRC_FILES := \
   FrontendActions.cpp \
   FrontendOptions.cpp \
   HeaderIncludeGen.cpp \
+  IncludeProfiler.cpp \
   InitHeaderSearch.cpp \
   InitPreprocessor.cpp \
   LangStandards.cpp \
   LayoutOverrideSource.cpp \
   LogDiagnosticPrinter.cpp \
+  MemoryReport.cpp \
   MultiplexConsumer.cpp \
   PrintPreprocessedOutput.cpp \
   SerializedDiagnosticPrinter.cpp \
@@ -11,10 +11,13 @@
 #include "clang/AST/ASTConsumer.h"
 #include "clang/AST/ASTContext.h"
 #include "clang/AST/Decl.h"
+#include "clang/AST/Stmt.h"
 #include "clang/Basic/Diagnostic.h"
 #include "clang/Basic/FileManager.h"
+#include "clang/Basic/FileSystemStatCache.h"
 #include "clang/Basic/SourceManager.h"
 #include "clang/Basic/TargetInfo.h"
+#include "clang/Basic/TimeTrace.h"
 #include "clang/Basic/Version.h"
 #include "clang/Frontend/ChainedDiagnosticConsumer.h"
 #include "clang/Frontend/FrontendAction.h"
@@ -196,8 +199,29 @@ CompilerInstance::createDiagnostics(DiagnosticOptions *Opts,
 
 // File Manager
 
+/// \brief Make \p Dir absolute and exclude it from the persistent stat cache.
+static void addUncachedDirectory(PersistentStatCache &Cache, StringRef Dir) {
+  if (Dir.empty())
+    return;
+  SmallString<256> AbsDir(Dir);
+  if (llvm::sys::fs::make_absolute(AbsDir))
+    return;
+  Cache.addUncachedDirectory(AbsDir);
+}
+
 void CompilerInstance::createFileManager() {
   FileMgr = new FileManager(getFileSystemOpts());
+
+  if (!getFileSystemOpts().StatCacheFile.empty()) {
+    PersistentStatCache *Cache =
+        new PersistentStatCache(getFileSystemOpts().StatCacheFile);
+    // The compilation writes into these directories, so nothing about their
+    // contents may be cached while it runs.
+    addUncachedDirectory(*Cache, getHeaderSearchOpts().ModuleCachePath);
+    addUncachedDirectory(*Cache, llvm::sys::path::parent_path(
+                                     getFrontendOpts().OutputFile));
+    FileMgr->addStatCache(Cache);
+  }
 }
 
 // Source Manager
@@ -214,7 +238,8 @@ void CompilerInstance::createPreprocessor() {
   // Create a PTH manager if we are using some form of a token cache.
   PTHManager *PTHMgr = 0;
   if (!PPOpts.TokenCache.empty())
-    PTHMgr = PTHManager::Create(PPOpts.TokenCache, getDiagnostics());
+    PTHMgr = PTHManager::Create(PPOpts.TokenCache, getDiagnostics(),
+                                getLangOpts());
 
   // Create the Preprocessor.
   HeaderSearch *HeaderInfo = new HeaderSearch(&getHeaderSearchOpts(),
@@ -692,6 +717,12 @@ bool CompilerInstance::ExecuteAction(FrontendAction &Act) {
   if (getFrontendOpts().ShowStats)
     llvm::EnableStatistics();
 
+  // The memory report counts the declarations and statements of each kind.
+  if (!getFrontendOpts().MemoryReportFile.empty()) {
+    Decl::EnableStatistics();
+    Stmt::EnableStatistics();
+  }
+
   for (unsigned i = 0, e = getFrontendOpts().Inputs.size(); i != e; ++i) {
     // Reset the ID tables if we are reusing the SourceManager.
     if (hasSourceManager())
@@ -703,6 +734,10 @@ bool CompilerInstance::ExecuteAction(FrontendAction &Act) {
     }
   }
 
+  // Save what the stat caches have learned for subsequent compilations.
+  if (hasFileManager())
+    getFileManager().flushStatCaches();
+
   // Notify the diagnostic client that all files were processed.
   getDiagnostics().getClient()->finish();
 
@@ -774,6 +809,34 @@ namespace {
   };
 }
 
+/// \brief Wait for the process that holds the lock on \p ModuleFileName to
+/// finish building the module.
+///
+/// LockFileManager::waitForUnlock doubles the interval between its checks
+/// without bound and gives up after five minutes, so a process waiting for a
+/// big module may notice that it was built long after the fact, or not at
+/// all. Instead, check at least every few milliseconds for as long as the
+/// owner of the lock is alive; taking the lock again tells both whether it
+/// was released and whether its owner died.
+static void waitForModuleBuild(llvm::LockFileManager &Locked,
+                               StringRef ModuleFileName) {
+#ifdef LLVM_ON_WIN32
+  Locked.waitForUnlock();
+#else
+  const long MaxIntervalNS = 20 * 1000000;
+  struct timespec Interval;
+  Interval.tv_sec = 0;
+  Interval.tv_nsec = 1000000;
+  while (true) {
+    nanosleep(&Interval, NULL);
+    llvm::LockFileManager Relocked(ModuleFileName);
+    if (Relocked != llvm::LockFileManager::LFS_Shared)
+      return;
+    Interval.tv_nsec = std::min(Interval.tv_nsec * 2, MaxIntervalNS);
+  }
+#endif
+}
+
 /// \brief Compile a module file for the given module, using the options 
 /// provided by the importing compiler instance.
 static void compileModule(CompilerInstance &ImportingInstance,
@@ -794,12 +857,18 @@ static void compileModule(CompilerInstance &ImportingInstance,
     // We're responsible for building the module ourselves. Do so below.
     break;
 
-  case llvm::LockFileManager::LFS_Shared:
+  case llvm::LockFileManager::LFS_Shared: {
     // Someone else is responsible for building the module. Wait for them to
     // finish.
-    Locked.waitForUnlock();
+    TimeTraceScope TimeScope("WaitForModule", Module->getFullModuleName());
+    waitForModuleBuild(Locked, ModuleFileName);
     return;
   }
+  }
+
+  // Record how long each module takes to build, nested in the scopes of the
+  // modules importing it.
+  TimeTraceScope TimeScope("BuildModule", Module->getFullModuleName());
 
   ModuleMap &ModMap 
     = ImportingInstance.getPreprocessor().getHeaderSearchInfo().getModuleMap();
@@ -42,6 +42,7 @@ private:
   bool FileMatchesDepCriteria(const char *Filename,
                               SrcMgr::CharacteristicKind FileType);
   void AddFilename(StringRef Filename);
+  void AddFile(const FileEntry *FE, SrcMgr::CharacteristicKind FileType);
   void OutputDependencyFile();
 
 public:
@@ -56,6 +57,9 @@ public:
   virtual void FileChanged(SourceLocation Loc, FileChangeReason Reason,
                            SrcMgr::CharacteristicKind FileType,
                            FileID PrevFID);
+  virtual void FileSkipped(const FileEntry &SkippedFile,
+                           const Token &FilenameTok,
+                           SrcMgr::CharacteristicKind FileType);
   virtual void InclusionDirective(SourceLocation HashLoc,
                                   const Token &IncludeTok,
                                   StringRef FileName,
@@ -115,6 +119,21 @@ void DependencyFileCallback::FileChanged(SourceLocation Loc,
     SM.getFileEntryForID(SM.getFileID(SM.getExpansionLoc(Loc)));
   if (FE == 0) return;
 
+  AddFile(FE, FileType);
+}
+
+void DependencyFileCallback::FileSkipped(const FileEntry &SkippedFile,
+                                         const Token &FilenameTok,
+                                         SrcMgr::CharacteristicKind FileType) {
+  // A header that was skipped because its include guard was already defined
+  // is usually one we have entered before, but it may not be, for example if
+  // the guard was recorded by an earlier compilation. Either way, the
+  // translation unit depends on it.
+  AddFile(&SkippedFile, FileType);
+}
+
+void DependencyFileCallback::AddFile(const FileEntry *FE,
+                                     SrcMgr::CharacteristicKind FileType) {
   StringRef Filename = FE->getName();
   if (!FileMatchesDepCriteria(Filename.data(), FileType))
     return;
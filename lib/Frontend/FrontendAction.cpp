@@ -18,12 +18,16 @@
 #include "clang/Frontend/FrontendPluginRegistry.h"
 #include "clang/Frontend/LayoutOverrideSource.h"
 #include "clang/Frontend/MultiplexConsumer.h"
+#include "clang/Frontend/Utils.h"
 #include "clang/Lex/HeaderSearch.h"
 #include "clang/Lex/Preprocessor.h"
 #include "clang/Parse/ParseAST.h"
+#include "clang/Sema/Sema.h"
+#include "clang/Sema/TemplateProfiler.h"
 #include "clang/Serialization/ASTDeserializationListener.h"
 #include "clang/Serialization/ASTReader.h"
 #include "clang/Serialization/GlobalModuleIndex.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
@@ -131,12 +135,18 @@ ASTConsumer* FrontendAction::CreateWrappedASTConsumer(CompilerInstance &CI,
   if (!Consumer)
     return 0;
 
-  if (CI.getFrontendOpts().AddPluginActions.size() == 0)
+  const std::string &HeaderProfileFile =
+    CI.getDependencyOutputOpts().HeaderProfileFile;
+  bool ProfileHeaders = !HeaderProfileFile.empty() && CI.hasPreprocessor();
+  if (CI.getFrontendOpts().AddPluginActions.size() == 0 && !ProfileHeaders)
     return Consumer;
 
   // Make sure the non-plugin consumer is first, so that plugins can't
   // modifiy the AST.
   std::vector<ASTConsumer*> Consumers(1, Consumer);
+  if (ProfileHeaders)
+    Consumers.push_back(CreateIncludeProfiler(CI.getPreprocessor(),
+                                              HeaderProfileFile));
 
   for (size_t i = 0, e = CI.getFrontendOpts().AddPluginActions.size();
        i != e; ++i) { 
@@ -323,9 +333,10 @@ bool FrontendAction::BeginSourceFile(CompilerInstance &CI,
       goto failure;
   }
 
-  // Initialize built-in info as long as we aren't using an external AST
-  // source.
-  if (!CI.hasASTContext() || !CI.getASTContext().getExternalSource()) {
+  // Initialize built-in info. Identifiers that come from an external AST
+  // source keep the builtin IDs they were stored with; the others get theirs
+  // as they are created.
+  {
     Preprocessor &PP = CI.getPreprocessor();
     PP.getBuiltinInfo().InitializeBuiltins(PP.getIdentifierTable(),
                                            PP.getLangOpts());
@@ -398,6 +409,11 @@ void FrontendAction::EndSourceFile() {
   // Finalize the action.
   EndSourceFileAction();
 
+  // Report the memory while the AST and Sema are still around.
+  const std::string &MemoryReportFile = CI.getFrontendOpts().MemoryReportFile;
+  if (!MemoryReportFile.empty())
+    WriteMemoryReport(CI, MemoryReportFile);
+
   // Release the consumer and the AST, in that order since the consumer may
   // perform actions in its destructor which require the context.
   //
@@ -472,8 +488,22 @@ void ASTFrontendAction::ExecuteAction() {
   if (!CI.hasSema())
     CI.createSema(getTranslationUnitKind(), CompletionConsumer);
 
+  const std::string &ProfileFile = CI.getFrontendOpts().TemplateProfileFile;
+  if (!ProfileFile.empty())
+    CI.getSema().startTemplateProfiling();
+
   ParseAST(CI.getSema(), CI.getFrontendOpts().ShowStats,
            CI.getFrontendOpts().SkipFunctionBodies);
+
+  if (!ProfileFile.empty()) {
+    std::string Err;
+    llvm::raw_fd_ostream OS(ProfileFile.c_str(), Err);
+    if (!Err.empty())
+      CI.getDiagnostics().Report(diag::err_fe_unable_to_open_output)
+        << ProfileFile << Err;
+    else
+      CI.getSema().getTemplateProfiler()->write(OS);
+  }
 }
 
 void PluginASTAction::anchor() { }
@@ -526,3 +556,71 @@ bool WrapperFrontendAction::hasCodeCompletionSupport() const {
 WrapperFrontendAction::WrapperFrontendAction(FrontendAction *WrappedAction)
   : WrappedAction(WrappedAction) {}
 
+MultiplexFrontendAction::MultiplexFrontendAction(
+    ArrayRef<FrontendAction *> Actions)
+  : Actions(Actions.begin(), Actions.end()) {
+#ifndef NDEBUG
+  for (unsigned I = 0, N = Actions.size(); I != N; ++I)
+    assert(!Actions[I]->usesPreprocessorOnly() &&
+           "Only AST actions can share a parse");
+#endif
+}
+
+MultiplexFrontendAction::~MultiplexFrontendAction() {
+  llvm::DeleteContainerPointers(Actions);
+}
+
+ASTConsumer *MultiplexFrontendAction::CreateASTConsumer(CompilerInstance &CI,
+                                                        StringRef InFile) {
+  std::vector<ASTConsumer *> Consumers;
+  for (unsigned I = 0, N = Actions.size(); I != N; ++I) {
+    ASTConsumer *Consumer = Actions[I]->CreateASTConsumer(CI, InFile);
+    if (!Consumer) {
+      llvm::DeleteContainerPointers(Consumers);
+      return 0;
+    }
+    Consumers.push_back(Consumer);
+  }
+  return new MultiplexConsumer(Consumers);
+}
+bool MultiplexFrontendAction::BeginInvocation(CompilerInstance &CI) {
+  for (unsigned I = 0, N = Actions.size(); I != N; ++I)
+    if (!Actions[I]->BeginInvocation(CI))
+      return false;
+  return true;
+}
+bool MultiplexFrontendAction::BeginSourceFileAction(CompilerInstance &CI,
+                                                    StringRef Filename) {
+  for (unsigned I = 0, N = Actions.size(); I != N; ++I) {
+    Actions[I]->setCurrentInput(getCurrentInput());
+    Actions[I]->setCompilerInstance(&CI);
+    if (!Actions[I]->BeginSourceFileAction(CI, Filename))
+      return false;
+  }
+  return true;
+}
+void MultiplexFrontendAction::EndSourceFileAction() {
+  for (unsigned I = 0, N = Actions.size(); I != N; ++I)
+    Actions[I]->EndSourceFileAction();
+}
+
+TranslationUnitKind MultiplexFrontendAction::getTranslationUnitKind() {
+  // The translation unit is complete if any of the actions needs it to be.
+  for (unsigned I = 0, N = Actions.size(); I != N; ++I)
+    if (Actions[I]->getTranslationUnitKind() == TU_Complete)
+      return TU_Complete;
+  return Actions.empty() ? TU_Complete : Actions[0]->getTranslationUnitKind();
+}
+bool MultiplexFrontendAction::hasPCHSupport() const {
+  for (unsigned I = 0, N = Actions.size(); I != N; ++I)
+    if (!Actions[I]->hasPCHSupport())
+      return false;
+  return true;
+}
+bool MultiplexFrontendAction::hasASTFileSupport() const {
+  for (unsigned I = 0, N = Actions.size(); I != N; ++I)
+    if (!Actions[I]->hasASTFileSupport())
+      return false;
+  return true;
+}
+
@@ -74,6 +74,13 @@ ASTConsumer *ASTDumpXMLAction::CreateASTConsumer(CompilerInstance &CI,
   return CreateASTDumperXML(*OS);
 }
 
+ASTConsumer *ASTExportAction::CreateASTConsumer(CompilerInstance &CI,
+                                                StringRef InFile) {
+  if (raw_ostream *OS = CI.createDefaultOutputFile(true, InFile, "astx"))
+    return CreateASTExporter(*OS);
+  return 0;
+}
+
 ASTConsumer *ASTViewAction::CreateASTConsumer(CompilerInstance &CI,
                                               StringRef InFile) {
   return CreateASTViewer();
@@ -94,7 +101,9 @@ ASTConsumer *GeneratePCHAction::CreateASTConsumer(CompilerInstance &CI,
 
   if (!CI.getFrontendOpts().RelocatablePCH)
     Sysroot.clear();
-  return new PCHGenerator(CI.getPreprocessor(), OutputFile, 0, Sysroot, OS);
+  return new PCHGenerator(CI.getPreprocessor(), OutputFile, 0, Sysroot, OS,
+                          /*AllowASTWithErrors=*/false,
+                          CI.getFrontendOpts().CompressASTFiles);
 }
 
 bool GeneratePCHAction::ComputeASTConsumerArguments(CompilerInstance &CI,
@@ -130,7 +139,8 @@ ASTConsumer *GenerateModuleAction::CreateASTConsumer(CompilerInstance &CI,
     return 0;
   
   return new PCHGenerator(CI.getPreprocessor(), OutputFile, Module, 
-                          Sysroot, OS);
+                          Sysroot, OS, /*AllowASTWithErrors=*/false,
+                          CI.getFrontendOpts().CompressASTFiles);
 }
 
 static SmallVectorImpl<char> &
@@ -311,6 +321,7 @@ bool GenerateModuleAction::ComputeASTConsumerArguments(CompilerInstance &CI,
     return true;
   
   OutputFile = CI.getFrontendOpts().OutputFile;
+  Sysroot = CI.getHeaderSearchOpts().ModulesRelocatableRoot;
   return false;
 }
 
@@ -506,6 +517,22 @@ void PreprocessOnlyAction::ExecuteAction() {
   } while (Tok.isNot(tok::eof));
 }
 
+void RawLexOnlyAction::ExecuteAction() {
+  Preprocessor &PP = getCompilerInstance().getPreprocessor();
+  SourceManager &SM = PP.getSourceManager();
+
+  // Lex the main file the way -dump-raw-tokens does, without the cost of
+  // printing the tokens.
+  const llvm::MemoryBuffer *FromFile = SM.getBuffer(SM.getMainFileID());
+  Lexer RawLex(SM.getMainFileID(), FromFile, SM, PP.getLangOpts());
+  RawLex.SetKeepWhitespaceMode(true);
+
+  Token RawTok;
+  do {
+    RawLex.LexFromRawLexer(RawTok);
+  } while (RawTok.isNot(tok::eof));
+}
+
 void PrintPreprocessedAction::ExecuteAction() {
   CompilerInstance &CI = getCompilerInstance();
   // Output file may need to be set to 'Binary', to avoid converting Unix style
@@ -0,0 +1,293 @@
+//===--- IncludeProfiler.cpp - Profile the cost of included files ---------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the include profiler of -header-profile-file, which
+// writes what each included file costs the translation unit as JSON.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Frontend/Utils.h"
+#include "clang/AST/ASTConsumer.h"
+#include "clang/AST/DeclBase.h"
+#include "clang/AST/DeclGroup.h"
+#include "clang/Basic/FileManager.h"
+#include "clang/Basic/SourceManager.h"
+#include "clang/Frontend/FrontendDiagnostic.h"
+#include "clang/Lex/Lexer.h"
+#include "clang/Lex/PPCallbacks.h"
+#include "clang/Lex/Preprocessor.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/IntrusiveRefCntPtr.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Timer.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <vector>
+using namespace clang;
+
+namespace {
+/// \brief One entry of a file onto the include stack.
+struct Inclusion {
+  FileID FID;
+  /// The inclusion of the file that included this one, or -1.
+  int Parent;
+  double StartTime, EndTime;
+  unsigned NumDecls;
+};
+
+/// \brief The inclusions of a translation unit, shared by the callbacks that
+/// record them and the consumer that counts their declarations.
+class IncludeProfile : public RefCountedBase<IncludeProfile> {
+public:
+  std::vector<Inclusion> Inclusions;
+  SmallVector<int, 16> Stack;
+  llvm::DenseMap<FileID, int> InclusionOfFile;
+
+  static double now() {
+    return llvm::TimeRecord::getCurrentTime().getWallTime();
+  }
+};
+
+class IncludeProfilerCallbacks : public PPCallbacks {
+  IntrusiveRefCntPtr<IncludeProfile> Profile;
+  SourceManager &SM;
+
+public:
+  IncludeProfilerCallbacks(IncludeProfile *Profile, SourceManager &SM)
+    : Profile(Profile), SM(SM) {}
+
+  virtual void FileChanged(SourceLocation Loc, FileChangeReason Reason,
+                           SrcMgr::CharacteristicKind FileType,
+                           FileID PrevFID);
+};
+
+class IncludeProfilerConsumer : public ASTConsumer {
+  IntrusiveRefCntPtr<IncludeProfile> Profile;
+  Preprocessor &PP;
+  std::string OutputFile;
+
+  void writeProfile();
+
+public:
+  IncludeProfilerConsumer(IncludeProfile *Profile, Preprocessor &PP,
+                          StringRef OutputFile)
+    : Profile(Profile), PP(PP), OutputFile(OutputFile) {}
+
+  virtual bool HandleTopLevelDecl(DeclGroupRef D);
+  virtual void HandleTranslationUnit(ASTContext &Ctx) { writeProfile(); }
+};
+
+/// \brief The cost of a file, summed over its inclusions.
+struct FileCost {
+  unsigned NumInclusions;
+  uint64_t Bytes, Tokens, Decls;
+  uint64_t InclusiveBytes, InclusiveTokens, InclusiveDecls;
+  double SelfTime, InclusiveTime;
+  FileCost()
+    : NumInclusions(0), Bytes(0), Tokens(0), Decls(0), InclusiveBytes(0),
+      InclusiveTokens(0), InclusiveDecls(0), SelfTime(0), InclusiveTime(0) {}
+};
+
+/// \brief Orders files by the time spent in them and what they include, the
+/// most expensive first.
+struct InclusiveTimeCompare {
+  bool operator()(const llvm::StringMapEntry<FileCost> *X,
+                  const llvm::StringMapEntry<FileCost> *Y) const {
+    if (X->getValue().InclusiveTime != Y->getValue().InclusiveTime)
+      return X->getValue().InclusiveTime > Y->getValue().InclusiveTime;
+    return X->getKey() < Y->getKey();
+  }
+};
+}
+
+ASTConsumer *clang::CreateIncludeProfiler(Preprocessor &PP,
+                                          StringRef OutputFile) {
+  IncludeProfile *Profile = new IncludeProfile();
+  PP.addPPCallbacks(new IncludeProfilerCallbacks(Profile,
+                                                 PP.getSourceManager()));
+  return new IncludeProfilerConsumer(Profile, PP, OutputFile);
+}
+
+void IncludeProfilerCallbacks::FileChanged(SourceLocation Loc,
+                                           FileChangeReason Reason,
+                                           SrcMgr::CharacteristicKind FileType,
+                                           FileID PrevFID) {
+  if (Reason == EnterFile) {
+    Inclusion I;
+    I.FID = SM.getFileID(SM.getExpansionLoc(Loc));
+    I.Parent = Profile->Stack.empty() ? -1 : Profile->Stack.back();
+    I.StartTime = IncludeProfile::now();
+    I.EndTime = -1;
+    I.NumDecls = 0;
+    Profile->InclusionOfFile[I.FID] = Profile->Inclusions.size();
+    Profile->Stack.push_back(Profile->Inclusions.size());
+    Profile->Inclusions.push_back(I);
+    return;
+  }
+
+  // Leaving a _Pragma isn't leaving a file.
+  if (Reason != ExitFile || Profile->Stack.empty() ||
+      Profile->Inclusions[Profile->Stack.back()].FID != PrevFID)
+    return;
+  Profile->Inclusions[Profile->Stack.back()].EndTime = IncludeProfile::now();
+  Profile->Stack.pop_back();
+}
+
+bool IncludeProfilerConsumer::HandleTopLevelDecl(DeclGroupRef D) {
+  SourceManager &SM = PP.getSourceManager();
+  for (DeclGroupRef::iterator I = D.begin(), E = D.end(); I != E; ++I) {
+    SourceLocation Loc = (*I)->getLocation();
+    if (Loc.isInvalid())
+      continue;
+    llvm::DenseMap<FileID, int>::iterator Known =
+        Profile->InclusionOfFile.find(SM.getFileID(SM.getExpansionLoc(Loc)));
+    if (Known != Profile->InclusionOfFile.end())
+      ++Profile->Inclusions[Known->second].NumDecls;
+  }
+  return true;
+}
+
+/// \brief Write \p Str as a JSON string.
+static void writeString(raw_ostream &OS, StringRef Str) {
+  OS << '"';
+  for (unsigned I = 0, N = Str.size(); I != N; ++I) {
+    unsigned char C = Str[I];
+    if (C == '"' || C == '\\')
+      OS << '\\' << C;
+    else if (C < 0x20)
+      OS << llvm::format("\\u%04x", C);
+    else
+      OS << C;
+  }
+  OS << '"';
+}
+
+void IncludeProfilerConsumer::writeProfile() {
+  SourceManager &SM = PP.getSourceManager();
+  std::vector<Inclusion> &Inclusions = Profile->Inclusions;
+  unsigned N = Inclusions.size();
+
+  // The files still on the stack end now.
+  double Now = IncludeProfile::now();
+  for (unsigned I = 0; I != N; ++I)
+    if (Inclusions[I].EndTime < 0)
+      Inclusions[I].EndTime = Now;
+
+  // A file is included after the one including it, so walking backwards
+  // adds what each inclusion costs to its parent after its own children.
+  // The tokens are counted by lexing each file once more, which the times
+  // don't include.
+  llvm::DenseMap<const FileEntry *, unsigned> TokensOfFile;
+  std::vector<FileCost> Costs(N);
+  for (unsigned I = N; I != 0; --I) {
+    const Inclusion &Inc = Inclusions[I - 1];
+    FileCost &Cost = Costs[I - 1];
+    Cost.NumInclusions = 1;
+    Cost.Decls = Inc.NumDecls;
+    Cost.InclusiveTime = Inc.EndTime - Inc.StartTime;
+    if (const FileEntry *File = SM.getFileEntryForID(Inc.FID)) {
+      bool Invalid = false;
+      const llvm::MemoryBuffer *Buffer = SM.getBuffer(Inc.FID, &Invalid);
+      if (!Invalid) {
+        Cost.Bytes = Buffer->getBufferSize();
+        llvm::DenseMap<const FileEntry *, unsigned>::iterator Known =
+            TokensOfFile.find(File);
+        if (Known == TokensOfFile.end()) {
+          Lexer L(Inc.FID, Buffer, SM, PP.getLangOpts());
+          unsigned NumTokens = 0;
+          Token Tok;
+          do {
+            L.LexFromRawLexer(Tok);
+            ++NumTokens;
+          } while (Tok.isNot(tok::eof));
+          Known = TokensOfFile.insert(std::make_pair(File,
+                                                     NumTokens - 1)).first;
+        }
+        Cost.Tokens = Known->second;
+      }
+    }
+
+    Cost.InclusiveBytes += Cost.Bytes;
+    Cost.InclusiveTokens += Cost.Tokens;
+    Cost.InclusiveDecls += Cost.Decls;
+    Cost.SelfTime += Cost.InclusiveTime;
+    if (Inc.Parent >= 0) {
+      FileCost &ParentCost = Costs[Inc.Parent];
+      ParentCost.InclusiveBytes += Cost.InclusiveBytes;
+      ParentCost.InclusiveTokens += Cost.InclusiveTokens;
+      ParentCost.InclusiveDecls += Cost.InclusiveDecls;
+      ParentCost.SelfTime -= Cost.InclusiveTime;
+    }
+  }
+
+  // Sum the inclusions of each file. A file included from itself, directly
+  // or not, only counts the outermost inclusion in its inclusive cost.
+  llvm::StringMap<FileCost> Files;
+  for (unsigned I = 0; I != N; ++I) {
+    const FileEntry *File = SM.getFileEntryForID(Inclusions[I].FID);
+    if (!File)
+      continue;
+    bool Nested = false;
+    for (int P = Inclusions[I].Parent; P >= 0 && !Nested;
+         P = Inclusions[P].Parent)
+      Nested = SM.getFileEntryForID(Inclusions[P].FID) == File;
+
+    FileCost &Total = Files[File->getName()];
+    const FileCost &Cost = Costs[I];
+    Total.NumInclusions += Cost.NumInclusions;
+    Total.Bytes += Cost.Bytes;
+    Total.Tokens += Cost.Tokens;
+    Total.Decls += Cost.Decls;
+    Total.SelfTime += Cost.SelfTime;
+    if (!Nested) {
+      Total.InclusiveBytes += Cost.InclusiveBytes;
+      Total.InclusiveTokens += Cost.InclusiveTokens;
+      Total.InclusiveDecls += Cost.InclusiveDecls;
+      Total.InclusiveTime += Cost.InclusiveTime;
+    }
+  }
+
+  std::vector<const llvm::StringMapEntry<FileCost> *> Sorted;
+  for (llvm::StringMap<FileCost>::const_iterator I = Files.begin(),
+                                                 E = Files.end();
+       I != E; ++I)
+    Sorted.push_back(&*I);
+  std::sort(Sorted.begin(), Sorted.end(), InclusiveTimeCompare());
+
+  std::string Err;
+  llvm::raw_fd_ostream OS(OutputFile.c_str(), Err);
+  if (!Err.empty()) {
+    PP.getDiagnostics().Report(diag::err_fe_error_opening)
+      << OutputFile << Err;
+    return;
+  }
+
+  OS << "{\n  \"main-file\": ";
+  const FileEntry *MainFile = SM.getFileEntryForID(SM.getMainFileID());
+  writeString(OS, MainFile ? MainFile->getName() : "");
+  OS << ",\n  \"files\": [";
+  for (unsigned I = 0, E = Sorted.size(); I != E; ++I) {
+    const FileCost &Cost = Sorted[I]->getValue();
+    OS << (I ? ",\n" : "\n") << "    {\"file\": ";
+    writeString(OS, Sorted[I]->getKey());
+    OS << ", \"inclusions\": " << Cost.NumInclusions
+       << ",\n     \"bytes\": " << Cost.Bytes
+       << ", \"tokens\": " << Cost.Tokens
+       << ", \"decls\": " << Cost.Decls
+       << ", \"seconds\": " << llvm::format("%.6f", Cost.SelfTime)
+       << ",\n     \"inclusive-bytes\": " << Cost.InclusiveBytes
+       << ", \"inclusive-tokens\": " << Cost.InclusiveTokens
+       << ", \"inclusive-decls\": " << Cost.InclusiveDecls
+       << ", \"inclusive-seconds\": "
+       << llvm::format("%.6f", Cost.InclusiveTime) << "}";
+  }
+  OS << "\n  ]\n}\n";
+}
@@ -0,0 +1,236 @@
+//===--- MemoryReport.cpp - Report the memory used by the front end -------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the memory report of -fmemory-report=, which writes
+// the bytes held by each part of the front end as JSON.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Frontend/Utils.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/Decl.h"
+#include "clang/AST/DeclCXX.h"
+#include "clang/AST/DeclFriend.h"
+#include "clang/AST/DeclObjC.h"
+#include "clang/AST/DeclOpenMP.h"
+#include "clang/AST/DeclTemplate.h"
+#include "clang/AST/Expr.h"
+#include "clang/AST/ExprCXX.h"
+#include "clang/AST/ExprObjC.h"
+#include "clang/AST/ExternalASTSource.h"
+#include "clang/AST/Stmt.h"
+#include "clang/AST/StmtCXX.h"
+#include "clang/AST/StmtObjC.h"
+#include "clang/AST/StmtOpenMP.h"
+#include "clang/AST/Type.h"
+#include "clang/Basic/FileManager.h"
+#include "clang/Basic/SourceManager.h"
+#include "clang/Frontend/CompilerInstance.h"
+#include "clang/Frontend/FrontendDiagnostic.h"
+#include "clang/Lex/HeaderSearch.h"
+#include "clang/Lex/PreprocessingRecord.h"
+#include "clang/Lex/Preprocessor.h"
+#include "clang/Sema/Sema.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+#include <vector>
+using namespace clang;
+
+namespace {
+/// \brief The nodes of one kind, and the size of each.
+struct KindCount {
+  const char *Name;
+  unsigned Count;
+  size_t Size;
+};
+}
+
+static KindCount makeKindCount(const char *Name, unsigned Count, size_t Size) {
+  KindCount K = { Name, Count, Size };
+  return K;
+}
+
+/// \brief Write \p Str as a JSON string.
+static void writeString(raw_ostream &OS, StringRef Str) {
+  OS << '"';
+  for (unsigned I = 0, N = Str.size(); I != N; ++I) {
+    unsigned char C = Str[I];
+    if (C == '"' || C == '\\')
+      OS << '\\' << C;
+    else if (C < 0x20)
+      OS << llvm::format("\\u%04x", C);
+    else
+      OS << C;
+  }
+  OS << '"';
+}
+
+/// \brief Write the kinds of \p Kinds that have nodes as the JSON array
+/// \p Name, and return the bytes of their nodes.
+static uint64_t writeKinds(raw_ostream &OS, const char *Name,
+                           ArrayRef<KindCount> Kinds) {
+  uint64_t TotalBytes = 0;
+  bool First = true;
+  OS << "    \"" << Name << "\": [";
+  for (unsigned I = 0, E = Kinds.size(); I != E; ++I) {
+    if (!Kinds[I].Count)
+      continue;
+    uint64_t Bytes = (uint64_t)Kinds[I].Count * Kinds[I].Size;
+    TotalBytes += Bytes;
+    OS << (First ? "\n" : ",\n") << "      {\"kind\": \"" << Kinds[I].Name
+       << "\", \"count\": " << Kinds[I].Count << ", \"bytes\": " << Bytes
+       << "}";
+    First = false;
+  }
+  OS << (First ? "],\n" : "\n    ],\n");
+  return TotalBytes;
+}
+
+static void writeASTContext(raw_ostream &OS, ASTContext &Ctx) {
+  // The declarations and statements are counted as they are created, the
+  // types are counted from the context.
+  std::vector<KindCount> Decls;
+#define DECL(DERIVED, BASE) \
+  Decls.push_back(makeKindCount(#DERIVED, \
+                                Decl::getNumDeclsCreated(Decl::DERIVED), \
+                                sizeof(DERIVED##Decl)));
+#define ABSTRACT_DECL(DECL)
+#include "clang/AST/DeclNodes.inc"
+
+  std::vector<KindCount> Stmts;
+#define STMT(CLASS, PARENT) \
+  Stmts.push_back(makeKindCount(#CLASS, \
+                                Stmt::getNumStmtsCreated(Stmt::CLASS##Class), \
+                                sizeof(CLASS)));
+#define ABSTRACT_STMT(STMT)
+#include "clang/AST/StmtNodes.inc"
+
+  std::vector<unsigned> TypeCounts(Type::TypeLast + 1);
+  for (ASTContext::const_type_iterator I = Ctx.types_begin(),
+                                       E = Ctx.types_end();
+       I != E; ++I)
+    ++TypeCounts[(*I)->getTypeClass()];
+  std::vector<KindCount> Types;
+#define TYPE(Name, Parent) \
+  Types.push_back(makeKindCount(#Name, TypeCounts[Type::Name], \
+                                sizeof(Name##Type)));
+#define ABSTRACT_TYPE(Name, Parent)
+#include "clang/AST/TypeNodes.def"
+
+  OS << "  \"ast\": {\n";
+  uint64_t NodeBytes = writeKinds(OS, "decls", Decls);
+  NodeBytes += writeKinds(OS, "stmts", Stmts);
+  NodeBytes += writeKinds(OS, "types", Types);
+  // The nodes don't count what they allocate besides themselves, such as
+  // their parameter and argument lists.
+  OS << "    \"node-bytes\": " << NodeBytes
+     << ",\n    \"allocator-bytes\": " << Ctx.getASTAllocatedMemory()
+     << ",\n    \"side-table-bytes\": " << Ctx.getSideTableAllocatedMemory()
+     << "\n  },\n";
+
+  OS << "  \"identifiers\": {\"count\": " << Ctx.Idents.size()
+     << ", \"bytes\": " << Ctx.Idents.getAllocator().getTotalMemory()
+     << "},\n";
+  OS << "  \"selectors\": {\"bytes\": " << Ctx.Selectors.getTotalMemory()
+     << "},\n";
+
+  if (ExternalASTSource *Source = Ctx.getExternalSource()) {
+    ExternalASTSource::MemoryBufferSizes Sizes =
+        Source->getMemoryBufferSizes();
+    OS << "  \"external-source\": {\"malloc-buffer-bytes\": "
+       << Sizes.malloc_bytes << ", \"mmap-buffer-bytes\": " << Sizes.mmap_bytes
+       << "},\n";
+  }
+}
+
+static void writeSourceManager(raw_ostream &OS, SourceManager &SM) {
+  unsigned NumFiles = 0, NumExpansions = 0;
+  for (unsigned I = 0, E = SM.local_sloc_entry_size(); I != E; ++I) {
+    if (SM.getLocalSLocEntry(I).isFile())
+      ++NumFiles;
+    else
+      ++NumExpansions;
+  }
+  unsigned NumLoaded = SM.loaded_sloc_entry_size();
+  SourceManager::MemoryBufferSizes Sizes = SM.getMemoryBufferSizes();
+
+  OS << "  \"source-manager\": {\n"
+     << "    \"file-entries\": " << NumFiles
+     << ", \"expansion-entries\": " << NumExpansions
+     << ", \"loaded-entries\": " << NumLoaded
+     << ",\n    \"sloc-entry-bytes\": "
+     << (uint64_t)(NumFiles + NumExpansions + NumLoaded) *
+            sizeof(SrcMgr::SLocEntry)
+     << ",\n    \"content-cache-bytes\": " << SM.getContentCacheSize()
+     << ",\n    \"malloc-buffer-bytes\": " << Sizes.malloc_bytes
+     << ", \"mmap-buffer-bytes\": " << Sizes.mmap_bytes
+     // The tables of the entries are part of the data structures.
+     << ",\n    \"data-structure-bytes\": " << SM.getDataStructureSizes()
+     << "\n  },\n";
+}
+
+static void writePreprocessor(raw_ostream &OS, Preprocessor &PP) {
+  unsigned NumMacroInfos;
+  size_t MacroInfoBytes = PP.getMacroInfoMemory(NumMacroInfos);
+  // The macro infos are allocated by the preprocessor's allocator.
+  OS << "  \"preprocessor\": {\n"
+     << "    \"total-bytes\": " << PP.getTotalMemory()
+     << ", \"allocator-bytes\": "
+     << PP.getPreprocessorAllocator().getTotalMemory()
+     << ",\n    \"macro-infos\": " << NumMacroInfos
+     << ", \"macro-info-bytes\": " << MacroInfoBytes
+     << ",\n    \"token-lexer-cache-bytes\": "
+     << PP.getTokenLexerCacheMemory()
+     << ",\n    \"header-search-bytes\": "
+     << PP.getHeaderSearchInfo().getTotalMemory();
+  if (PreprocessingRecord *Record = PP.getPreprocessingRecord())
+    OS << ",\n    \"preprocessing-record-bytes\": " << Record->getTotalMemory();
+  OS << "\n  },\n";
+}
+
+static void writeSema(raw_ostream &OS, const Sema &S) {
+  Sema::MemoryUsage Usage = S.getMemoryUsage();
+  OS << "  \"sema\": {\n"
+     << "    \"special-members\": " << Usage.NumSpecialMembers
+     << ", \"allocator-bytes\": " << Usage.AllocatorBytes
+     << ",\n    \"cached-overloads\": " << Usage.NumOverloads
+     << ", \"overload-cache-bytes\": " << Usage.OverloadCacheBytes
+     << ",\n    \"cached-deductions\": " << Usage.NumDeductions
+     << ", \"deduction-cache-bytes\": " << Usage.DeductionCacheBytes
+     << ",\n    \"scratch-bytes\": " << Usage.ScratchBytes
+     << "\n  },\n";
+}
+
+void clang::WriteMemoryReport(CompilerInstance &CI, StringRef OutputFile) {
+  std::string Err;
+  llvm::raw_fd_ostream OS(OutputFile.str().c_str(), Err);
+  if (!Err.empty()) {
+    CI.getDiagnostics().Report(diag::err_fe_error_opening)
+      << OutputFile << Err;
+    return;
+  }
+
+  OS << "{\n";
+  if (CI.hasSourceManager()) {
+    SourceManager &SM = CI.getSourceManager();
+    const FileEntry *MainFile = SM.getFileEntryForID(SM.getMainFileID());
+    OS << "  \"main-file\": ";
+    writeString(OS, MainFile ? MainFile->getName() : "");
+    OS << ",\n";
+    writeSourceManager(OS, SM);
+  }
+  if (CI.hasASTContext())
+    writeASTContext(OS, CI.getASTContext());
+  if (CI.hasPreprocessor())
+    writePreprocessor(OS, CI.getPreprocessor());
+  if (CI.hasSema())
+    writeSema(OS, CI.getSema());
+  // Every section ends with a comma, so end with one that doesn't.
+  OS << "  \"version\": 1\n}\n";
+}
@@ -159,10 +159,11 @@ public:
   /// return true if the output stream required adjustment or if
   /// the requested location is on the first line.
   bool MoveToLine(SourceLocation Loc) {
-    PresumedLoc PLoc = SM.getPresumedLoc(Loc);
-    if (PLoc.isInvalid())
+    bool Invalid = false;
+    unsigned LineNo = SM.getPresumedLineNumber(Loc, &Invalid);
+    if (Invalid)
       return false;
-    return MoveToLine(PLoc.getLine()) || (PLoc.getLine() == 1);
+    return MoveToLine(LineNo) || (LineNo == 1);
   }
   bool MoveToLine(unsigned LineNo);
 
@@ -590,6 +591,18 @@ struct UnknownPragmaHandler : public PragmaHandler {
 } // end anonymous namespace
 
 
+/// \brief If \p Tok is a punctuator spelled the usual way, return its
+/// spelling, which saves looking it up in the source buffer.
+static const char *getSimplePunctuatorSpelling(const Token &Tok) {
+  if (Tok.needsCleaning())
+    return 0;
+  const char *Spelling = tok::getTokenSimpleSpelling(Tok.getKind());
+  // A digraph, such as '<:' for '[', is never as long as the usual spelling.
+  if (!Spelling || strlen(Spelling) != Tok.getLength())
+    return 0;
+  return Spelling;
+}
+
 static void PrintPreprocessedTokens(Preprocessor &PP, Token &Tok,
                                     PrintPPOutputPPCallbacks *Callbacks,
                                     raw_ostream &OS) {
@@ -629,6 +642,8 @@ static void PrintPreprocessedTokens(Preprocessor &PP, Token &Tok,
     } else if (Tok.isLiteral() && !Tok.needsCleaning() &&
                Tok.getLiteralData()) {
       OS.write(Tok.getLiteralData(), Tok.getLength());
+    } else if (const char *Punc = getSimplePunctuatorSpelling(Tok)) {
+      OS.write(Punc, Tok.getLength());
     } else if (Tok.getLength() < 256) {
       const char *TokPtr = Buffer;
       unsigned Len = PP.getSpelling(Tok, TokPtr);
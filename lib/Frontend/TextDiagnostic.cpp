@@ -248,10 +248,10 @@ static void columnToByte(StringRef SourceLine, unsigned TabStop,
   out.back() = i;
 }
 
-namespace {
+namespace clang {
 struct SourceColumnMap {
   SourceColumnMap(StringRef SourceLine, unsigned TabStop)
-  : m_SourceLine(SourceLine) {
+  : m_SourceLine(SourceLine), m_TabStop(TabStop) {
     
     ::byteToColumn(SourceLine, TabStop, m_byteToColumn);
     ::columnToByte(SourceLine, TabStop, m_columnToByte);
@@ -306,13 +306,18 @@ struct SourceColumnMap {
   StringRef getSourceLine() const {
     return m_SourceLine;
   }
+
+  unsigned getTabStop() const { return m_TabStop; }
   
 private:
   const std::string m_SourceLine;
+  const unsigned m_TabStop;
   SmallVector<int,200> m_byteToColumn;
   SmallVector<int,200> m_columnToByte;
 };
+} // end namespace clang
 
+namespace {
 // used in assert in selectInterestingSourceRegion()
 struct char_out_of_range {
   const char lower,upper;
@@ -1115,7 +1120,12 @@ void TextDiagnostic::emitSnippetAndCaret(
   // length as the line of source code.
   std::string CaretLine(LineEnd-LineStart, ' ');
 
-  const SourceColumnMap sourceColMap(SourceLine, DiagOpts->TabStop);
+  // Diagnostics often come in runs on the same line, such as the notes of a
+  // warning, so keep the column map of the last line for the next one.
+  if (!LastColumnMap || LastColumnMap->getSourceLine() != SourceLine ||
+      LastColumnMap->getTabStop() != DiagOpts->TabStop)
+    LastColumnMap.reset(new SourceColumnMap(SourceLine, DiagOpts->TabStop));
+  const SourceColumnMap &sourceColMap = *LastColumnMap;
 
   // Highlight all of the characters covered by Ranges with ~ characters.
   for (SmallVectorImpl<CharSourceRange>::iterator I = Ranges.begin(),
@@ -105,6 +105,27 @@ static void printDiagnosticOptions(raw_ostream &OS,
     OS << ']';
 }
 
+namespace {
+/// \brief Buffers an unbuffered stream while it lives, and flushes it.
+class BufferDiagnosticOutput {
+  raw_ostream &OS;
+  bool WasUnbuffered;
+
+public:
+  explicit BufferDiagnosticOutput(raw_ostream &OS)
+      : OS(OS), WasUnbuffered(OS.GetBufferSize() == 0) {
+    if (WasUnbuffered)
+      OS.SetBufferSize(4096);
+  }
+  ~BufferDiagnosticOutput() {
+    if (WasUnbuffered)
+      OS.SetUnbuffered();
+    else
+      OS.flush();
+  }
+};
+}
+
 void TextDiagnosticPrinter::HandleDiagnostic(DiagnosticsEngine::Level Level,
                                              const Diagnostic &Info) {
   // Default implementation (Warnings/errors count).
@@ -118,6 +139,10 @@ void TextDiagnosticPrinter::HandleDiagnostic(DiagnosticsEngine::Level Level,
   llvm::raw_svector_ostream DiagMessageStream(OutStr);
   printDiagnosticOptions(DiagMessageStream, Level, Info, *DiagOpts);
 
+  // The stream is usually stderr, which is unbuffered, and the diagnostic is
+  // printed a few characters at a time. Buffer it until it is done.
+  BufferDiagnosticOutput Buffer(OS);
+
   // Keeps track of the starting position of the location
   // information (e.g., "foo.c:10:4:") that precedes the error
   // message. We use this information to determine how long the
@@ -38,6 +38,7 @@ static FrontendAction *CreateFrontendBaseAction(CompilerInstance &CI) {
   case ASTDeclList:            return new ASTDeclListAction();
   case ASTDump:                return new ASTDumpAction();
   case ASTDumpXML:             return new ASTDumpXMLAction();
+  case ASTExport:              return new ASTExportAction();
   case ASTPrint:               return new ASTPrintAction();
   case ASTView:                return new ASTViewAction();
   case DumpRawTokens:          return new DumpRawTokensAction();
@@ -95,6 +96,7 @@ static FrontendAction *CreateFrontendBaseAction(CompilerInstance &CI) {
     }
     return new PrintPreprocessedAction();
   }
+  case RawLexOnly:             return new RawLexOnlyAction();
 
 #ifdef CLANG_ENABLE_REWRITER
   case RewriteMacros:          return new RewriteMacrosAction();
@@ -0,0 +1,55 @@
+/*===---- avx512cdintrin.h - AVX-512CD intrinsics --------------------------===
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ *===-----------------------------------------------------------------------===
+ */
+
+#ifndef __IMMINTRIN_H
+#error "Never use <avx512cdintrin.h> directly; include <immintrin.h> instead."
+#endif
+
+#ifndef __AVX512CDINTRIN_H
+#define __AVX512CDINTRIN_H
+
+static __inline __m512i __attribute__((__always_inline__, __nodebug__))
+_mm512_lzcnt_epi32(__m512i __a)
+{
+  return (__m512i)__builtin_ia32_vplzcntd512((__v16si)__a);
+}
+
+static __inline __m512i __attribute__((__always_inline__, __nodebug__))
+_mm512_lzcnt_epi64(__m512i __a)
+{
+  return (__m512i)__builtin_ia32_vplzcntq512((__v8di)__a);
+}
+
+static __inline __m512i __attribute__((__always_inline__, __nodebug__))
+_mm512_broadcastmw_epi32(__mmask16 __a)
+{
+  return _mm512_set1_epi32((int)__a);
+}
+
+static __inline __m512i __attribute__((__always_inline__, __nodebug__))
+_mm512_broadcastmb_epi64(__mmask8 __a)
+{
+  return _mm512_set1_epi64((long long)__a);
+}
+
+#endif /* __AVX512CDINTRIN_H */
@@ -0,0 +1,684 @@
+/*===---- avx512fintrin.h - AVX-512F intrinsics ----------------------------===
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ *===-----------------------------------------------------------------------===
+ */
+
+#ifndef __IMMINTRIN_H
+#error "Never use <avx512fintrin.h> directly; include <immintrin.h> instead."
+#endif
+
+#ifndef __AVX512FINTRIN_H
+#define __AVX512FINTRIN_H
+
+typedef double __v8df __attribute__((__vector_size__(64)));
+typedef float __v16sf __attribute__((__vector_size__(64)));
+typedef long long __v8di __attribute__((__vector_size__(64)));
+typedef int __v16si __attribute__((__vector_size__(64)));
+
+typedef float __m512 __attribute__((__vector_size__(64)));
+typedef double __m512d __attribute__((__vector_size__(64)));
+typedef long long __m512i __attribute__((__vector_size__(64)));
+
+/* A mask register holds one bit for each element of a vector. */
+typedef unsigned char __mmask8;
+typedef unsigned short __mmask16;
+
+/* Create vectors */
+static __inline __m512 __attribute__((__always_inline__, __nodebug__))
+_mm512_setzero_ps(void)
+{
+  return (__m512){ 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f,
+                   0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+}
+
+static __inline __m512d __attribute__((__always_inline__, __nodebug__))
+_mm512_setzero_pd(void)
+{
+  return (__m512d){ 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+}
+
+static __inline __m512i __attribute__((__always_inline__, __nodebug__))
+_mm512_setzero_si512(void)
+{
+  return (__m512i){ 0LL, 0LL, 0LL, 0LL, 0LL, 0LL, 0LL, 0LL };
+}
+
+static __inline __m512 __attribute__((__always_inline__, __nodebug__))
+_mm512_set1_ps(float __w)
+{
+  return (__m512){ __w, __w, __w, __w, __w, __w, __w, __w,
+                   __w, __w, __w, __w, __w, __w, __w, __w };
+}
+
+static __inline __m512d __attribute__((__always_inline__, __nodebug__))
+_mm512_set1_pd(double __w)
+{
+  return (__m512d){ __w, __w, __w, __w, __w, __w, __w, __w };
+}
+
+static __inline __m512i __attribute__((__always_inline__, __nodebug__))
+_mm512_set1_epi32(int __s)
+{
+  return (__m512i)(__v16si){ __s, __s, __s, __s, __s, __s, __s, __s,
+                             __s, __s, __s, __s, __s, __s, __s, __s };
+}
+
+static __inline __m512i __attribute__((__always_inline__, __nodebug__))
+_mm512_set1_epi64(long long __d)
+{
+  return (__m512i){ __d, __d, __d, __d, __d, __d, __d, __d };
+}
+
+/* Cast between vector types */
+static __inline __m512d __attribute__((__always_inline__, __nodebug__))
+_mm512_castps_pd(__m512 __a)
+{
+  return (__m512d)__a;
+}
+
+static __inline __m512i __attribute__((__always_inline__, __nodebug__))
+_mm512_castps_si512(__m512 __a)
+{
+  return (__m512i)__a;
+}
+
+static __inline __m512 __attribute__((__always_inline__, __nodebug__))
+_mm512_castpd_ps(__m512d __a)
+{
+  return (__m512)__a;
+}
+
+static __inline __m512i __attribute__((__always_inline__, __nodebug__))
+_mm512_castpd_si512(__m512d __a)
+{
+  return (__m512i)__a;
+}
+
+static __inline __m512 __attribute__((__always_inline__, __nodebug__))
+_mm512_castsi512_ps(__m512i __a)
+{
+  return (__m512)__a;
+}
+
+static __inline __m512d __attribute__((__always_inline__, __nodebug__))
+_mm512_castsi512_pd(__m512i __a)
+{
+  return (__m512d)__a;
+}
+
+static __inline __m256 __attribute__((__always_inline__, __nodebug__))
+_mm512_castps512_ps256(__m512 __a)
+{
+  return __builtin_shufflevector(__a, __a, 0, 1, 2, 3, 4, 5, 6, 7);
+}
+
+static __inline __m256d __attribute__((__always_inline__, __nodebug__))
+_mm512_castpd512_pd256(__m512d __a)
+{
+  return __builtin_shufflevector(__a, __a, 0, 1, 2, 3);
+}
+
+static __inline __m256i __attribute__((__always_inline__, __nodebug__))
+_mm512_castsi512_si256(__m512i __a)
+{
+  return __builtin_shufflevector(__a, __a, 0, 1, 2, 3);
+}
+
+/* Load and store */
+static __inline __m512 __attribute__((__always_inline__, __nodebug__))
+_mm512_load_ps(float const *__p)
+{
+  return *(__m512 *)__p;
+}
+
+static __inline __m512d __attribute__((__always_inline__, __nodebug__))
+_mm512_load_pd(double const *__p)
+{
+  return *(__m512d *)__p;
+}
+
+static __inline __m512i __attribute__((__always_inline__, __nodebug__))
+_mm512_load_si512(void const *__p)
+{
+  return *(__m512i *)__p;
+}
+
+static __inline __m512 __attribute__((__always_inline__, __nodebug__))
+_mm512_loadu_ps(float const *__p)
+{
+  struct __loadu_ps {
+    __m512 __v;
+  } __attribute__((packed, may_alias));
+  return ((struct __loadu_ps*)__p)->__v;
+}
+
+static __inline __m512d __attribute__((__always_inline__, __nodebug__))
+_mm512_loadu_pd(double const *__p)
+{
+  struct __loadu_pd {
+    __m512d __v;
+  } __attribute__((packed, may_alias));
+  return ((struct __loadu_pd*)__p)->__v;
+}
+
+static __inline __m512i __attribute__((__always_inline__, __nodebug__))
+_mm512_loadu_si512(void const *__p)
+{
+  struct __loadu_si512 {
+    __m512i __v;
+  } __attribute__((packed, may_alias));
+  return ((struct __loadu_si512*)__p)->__v;
+}
+
+static __inline void __attribute__((__always_inline__, __nodebug__))
+_mm512_store_ps(float *__p, __m512 __a)
+{
+  *(__m512 *)__p = __a;
+}
+
+static __inline void __attribute__((__always_inline__, __nodebug__))
+_mm512_store_pd(double *__p, __m512d __a)
+{
+  *(__m512d *)__p = __a;
+}
+
+static __inline void __attribute__((__always_inline__, __nodebug__))
+_mm512_store_si512(void *__p, __m512i __a)
+{
+  *(__m512i *)__p = __a;
+}
+
+static __inline void __attribute__((__always_inline__, __nodebug__))
+_mm512_storeu_ps(float *__p, __m512 __a)
+{
+  struct __storeu_ps {
+    __m512 __v;
+  } __attribute__((packed, may_alias));
+  ((struct __storeu_ps*)__p)->__v = __a;
+}
+
+static __inline void __attribute__((__always_inline__, __nodebug__))
+_mm512_storeu_pd(double *__p, __m512d __a)
+{
+  struct __storeu_pd {
+    __m512d __v;
+  } __attribute__((packed, may_alias));
+  ((struct __storeu_pd*)__p)->__v = __a;
+}
+
+static __inline void __attribute__((__always_inline__, __nodebug__))
+_mm512_storeu_si512(void *__p, __m512i __a)
+{
+  struct __storeu_si512 {
+    __m512i __v;
+  } __attribute__((packed, may_alias));
+  ((struct __storeu_si512*)__p)->__v = __a;
+}
+
+/* Arithmetic */
+static __inline __m512 __attribute__((__always_inline__, __nodebug__))
+_mm512_add_ps(__m512 __a, __m512 __b)
+{
+  return __a + __b;
+}
+
+static __inline __m512d __attribute__((__always_inline__, __nodebug__))
+_mm512_add_pd(__m512d __a, __m512d __b)
+{
+  return __a + __b;
+}
+
+static __inline __m512 __attribute__((__always_inline__, __nodebug__))
+_mm512_sub_ps(__m512 __a, __m512 __b)
+{
+  return __a - __b;
+}
+
+static __inline __m512d __attribute__((__always_inline__, __nodebug__))
+_mm512_sub_pd(__m512d __a, __m512d __b)
+{
+  return __a - __b;
+}
+
+static __inline __m512 __attribute__((__always_inline__, __nodebug__))
+_mm512_mul_ps(__m512 __a, __m512 __b)
+{
+  return __a * __b;
+}
+
+static __inline __m512d __attribute__((__always_inline__, __nodebug__))
+_mm512_mul_pd(__m512d __a, __m512d __b)
+{
+  return __a * __b;
+}
+
+static __inline __m512 __attribute__((__always_inline__, __nodebug__))
+_mm512_div_ps(__m512 __a, __m512 __b)
+{
+  return __a / __b;
+}
+
+static __inline __m512d __attribute__((__always_inline__, __nodebug__))
+_mm512_div_pd(__m512d __a, __m512d __b)
+{
+  return __a / __b;
+}
+
+static __inline __m512 __attribute__((__always_inline__, __nodebug__))
+_mm512_sqrt_ps(__m512 __a)
+{
+  return (__m512)__builtin_ia32_sqrtps512((__v16sf)__a);
+}
+
+static __inline __m512d __attribute__((__always_inline__, __nodebug__))
+_mm512_sqrt_pd(__m512d __a)
+{
+  return (__m512d)__builtin_ia32_sqrtpd512((__v8df)__a);
+}
+
+static __inline __m512 __attribute__((__always_inline__, __nodebug__))
+_mm512_min_ps(__m512 __a, __m512 __b)
+{
+  return (__m512)__builtin_ia32_minps512((__v16sf)__a, (__v16sf)__b);
+}
+
+static __inline __m512d __attribute__((__always_inline__, __nodebug__))
+_mm512_min_pd(__m512d __a, __m512d __b)
+{
+  return (__m512d)__builtin_ia32_minpd512((__v8df)__a, (__v8df)__b);
+}
+
+static __inline __m512 __attribute__((__always_inline__, __nodebug__))
+_mm512_max_ps(__m512 __a, __m512 __b)
+{
+  return (__m512)__builtin_ia32_maxps512((__v16sf)__a, (__v16sf)__b);
+}
+
+static __inline __m512d __attribute__((__always_inline__, __nodebug__))
+_mm512_max_pd(__m512d __a, __m512d __b)
+{
+  return (__m512d)__builtin_ia32_maxpd512((__v8df)__a, (__v8df)__b);
+}
+
+static __inline __m512 __attribute__((__always_inline__, __nodebug__))
+_mm512_fmadd_ps(__m512 __a, __m512 __b, __m512 __c)
+{
+  return (__m512)__builtin_ia32_vfmaddps512((__v16sf)__a, (__v16sf)__b,
+                                            (__v16sf)__c);
+}
+
+static __inline __m512d __attribute__((__always_inline__, __nodebug__))
+_mm512_fmadd_pd(__m512d __a, __m512d __b, __m512d __c)
+{
+  return (__m512d)__builtin_ia32_vfmaddpd512((__v8df)__a, (__v8df)__b,
+                                             (__v8df)__c);
+}
+
+static __inline __m512 __attribute__((__always_inline__, __nodebug__))
+_mm512_fmsub_ps(__m512 __a, __m512 __b, __m512 __c)
+{
+  return (__m512)__builtin_ia32_vfmaddps512((__v16sf)__a, (__v16sf)__b,
+                                            -(__v16sf)__c);
+}
+
+static __inline __m512d __attribute__((__always_inline__, __nodebug__))
+_mm512_fmsub_pd(__m512d __a, __m512d __b, __m512d __c)
+{
+  return (__m512d)__builtin_ia32_vfmaddpd512((__v8df)__a, (__v8df)__b,
+                                             -(__v8df)__c);
+}
+
+static __inline __m512 __attribute__((__always_inline__, __nodebug__))
+_mm512_fnmadd_ps(__m512 __a, __m512 __b, __m512 __c)
+{
+  return (__m512)__builtin_ia32_vfmaddps512(-(__v16sf)__a, (__v16sf)__b,
+                                            (__v16sf)__c);
+}
+
+static __inline __m512d __attribute__((__always_inline__, __nodebug__))
+_mm512_fnmadd_pd(__m512d __a, __m512d __b, __m512d __c)
+{
+  return (__m512d)__builtin_ia32_vfmaddpd512(-(__v8df)__a, (__v8df)__b,
+                                             (__v8df)__c);
+}
+
+/* Integer arithmetic */
+static __inline __m512i __attribute__((__always_inline__, __nodebug__))
+_mm512_add_epi32(__m512i __a, __m512i __b)
+{
+  return (__m512i)((__v16si)__a + (__v16si)__b);
+}
+
+static __inline __m512i __attribute__((__always_inline__, __nodebug__))
+_mm512_add_epi64(__m512i __a, __m512i __b)
+{
+  return __a + __b;
+}
+
+static __inline __m512i __attribute__((__always_inline__, __nodebug__))
+_mm512_sub_epi32(__m512i __a, __m512i __b)
+{
+  return (__m512i)((__v16si)__a - (__v16si)__b);
+}
+
+static __inline __m512i __attribute__((__always_inline__, __nodebug__))
+_mm512_sub_epi64(__m512i __a, __m512i __b)
+{
+  return __a - __b;
+}
+
+static __inline __m512i __attribute__((__always_inline__, __nodebug__))
+_mm512_mullo_epi32(__m512i __a, __m512i __b)
+{
+  return (__m512i)((__v16si)__a * (__v16si)__b);
+}
+
+static __inline __m512i __attribute__((__always_inline__, __nodebug__))
+_mm512_abs_epi32(__m512i __a)
+{
+  return (__m512i)__builtin_ia32_pabsd512((__v16si)__a);
+}
+
+static __inline __m512i __attribute__((__always_inline__, __nodebug__))
+_mm512_abs_epi64(__m512i __a)
+{
+  return (__m512i)__builtin_ia32_pabsq512((__v8di)__a);
+}
+
+static __inline __m512i __attribute__((__always_inline__, __nodebug__))
+_mm512_min_epi32(__m512i __a, __m512i __b)
+{
+  return (__m512i)__builtin_ia32_pminsd512((__v16si)__a, (__v16si)__b);
+}
+
+static __inline __m512i __attribute__((__always_inline__, __nodebug__))
+_mm512_min_epu32(__m512i __a, __m512i __b)
+{
+  return (__m512i)__builtin_ia32_pminud512((__v16si)__a, (__v16si)__b);
+}
+
+static __inline __m512i __attribute__((__always_inline__, __nodebug__))
+_mm512_min_epi64(__m512i __a, __m512i __b)
+{
+  return (__m512i)__builtin_ia32_pminsq512((__v8di)__a, (__v8di)__b);
+}
+
+static __inline __m512i __attribute__((__always_inline__, __nodebug__))
+_mm512_min_epu64(__m512i __a, __m512i __b)
+{
+  return (__m512i)__builtin_ia32_pminuq512((__v8di)__a, (__v8di)__b);
+}
+
+static __inline __m512i __attribute__((__always_inline__, __nodebug__))
+_mm512_max_epi32(__m512i __a, __m512i __b)
+{
+  return (__m512i)__builtin_ia32_pmaxsd512((__v16si)__a, (__v16si)__b);
+}
+
+static __inline __m512i __attribute__((__always_inline__, __nodebug__))
+_mm512_max_epu32(__m512i __a, __m512i __b)
+{
+  return (__m512i)__builtin_ia32_pmaxud512((__v16si)__a, (__v16si)__b);
+}
+
+static __inline __m512i __attribute__((__always_inline__, __nodebug__))
+_mm512_max_epi64(__m512i __a, __m512i __b)
+{
+  return (__m512i)__builtin_ia32_pmaxsq512((__v8di)__a, (__v8di)__b);
+}
+
+static __inline __m512i __attribute__((__always_inline__, __nodebug__))
+_mm512_max_epu64(__m512i __a, __m512i __b)
+{
+  return (__m512i)__builtin_ia32_pmaxuq512((__v8di)__a, (__v8di)__b);
+}
+
+/* Bitwise operations */
+static __inline __m512i __attribute__((__always_inline__, __nodebug__))
+_mm512_and_si512(__m512i __a, __m512i __b)
+{
+  return __a & __b;
+}
+
+static __inline __m512i __attribute__((__always_inline__, __nodebug__))
+_mm512_andnot_si512(__m512i __a, __m512i __b)
+{
+  return ~__a & __b;
+}
+
+static __inline __m512i __attribute__((__always_inline__, __nodebug__))
+_mm512_or_si512(__m512i __a, __m512i __b)
+{
+  return __a | __b;
+}
+
+static __inline __m512i __attribute__((__always_inline__, __nodebug__))
+_mm512_xor_si512(__m512i __a, __m512i __b)
+{
+  return __a ^ __b;
+}
+
+/* Conversions */
+static __inline __m512 __attribute__((__always_inline__, __nodebug__))
+_mm512_cvtepi32_ps(__m512i __a)
+{
+  return (__m512)__builtin_ia32_cvtdq2ps512((__v16si)__a);
+}
+
+static __inline __m512i __attribute__((__always_inline__, __nodebug__))
+_mm512_cvttps_epi32(__m512 __a)
+{
+  return (__m512i)__builtin_ia32_cvttps2dq512((__v16sf)__a);
+}
+
+/* Compare into a mask; the predicates are the _CMP_* ones of <avxintrin.h>. */
+#define _mm512_cmp_ps_mask(a, b, p) __extension__ ({ \
+  __m512 __a = (a); \
+  __m512 __b = (b); \
+  (__mmask16)__builtin_ia32_cmpps512_mask((__v16sf)__a, (__v16sf)__b, (p)); })
+
+#define _mm512_cmp_pd_mask(a, b, p) __extension__ ({ \
+  __m512d __a = (a); \
+  __m512d __b = (b); \
+  (__mmask8)__builtin_ia32_cmppd512_mask((__v8df)__a, (__v8df)__b, (p)); })
+
+static __inline __mmask16 __attribute__((__always_inline__, __nodebug__))
+_mm512_cmpeq_epi32_mask(__m512i __a, __m512i __b)
+{
+  return (__mmask16)__builtin_ia32_pcmpeqd512_mask((__v16si)__a,
+                                                   (__v16si)__b);
+}
+
+static __inline __mmask8 __attribute__((__always_inline__, __nodebug__))
+_mm512_cmpeq_epi64_mask(__m512i __a, __m512i __b)
+{
+  return (__mmask8)__builtin_ia32_pcmpeqq512_mask((__v8di)__a, (__v8di)__b);
+}
+
+static __inline __mmask16 __attribute__((__always_inline__, __nodebug__))
+_mm512_cmpgt_epi32_mask(__m512i __a, __m512i __b)
+{
+  return (__mmask16)__builtin_ia32_pcmpgtd512_mask((__v16si)__a,
+                                                   (__v16si)__b);
+}
+
+static __inline __mmask8 __attribute__((__always_inline__, __nodebug__))
+_mm512_cmpgt_epi64_mask(__m512i __a, __m512i __b)
+{
+  return (__mmask8)__builtin_ia32_pcmpgtq512_mask((__v8di)__a, (__v8di)__b);
+}
+
+/* Masked operations: the elements whose bit of the mask is clear are taken
+ * from __w, or zeroed by the maskz forms. */
+static __inline __m512 __attribute__((__always_inline__, __nodebug__))
+_mm512_mask_mov_ps(__m512 __w, __mmask16 __u, __m512 __a)
+{
+  return (__m512)__builtin_ia32_selectps512(__u, (__v16sf)__a,
+                                            (__v16sf)__w);
+}
+
+static __inline __m512d __attribute__((__always_inline__, __nodebug__))
+_mm512_mask_mov_pd(__m512d __w, __mmask8 __u, __m512d __a)
+{
+  return (__m512d)__builtin_ia32_selectpd512(__u, (__v8df)__a, (__v8df)__w);
+}
+
+static __inline __m512i __attribute__((__always_inline__, __nodebug__))
+_mm512_mask_mov_epi32(__m512i __w, __mmask16 __u, __m512i __a)
+{
+  return (__m512i)__builtin_ia32_selectd512(__u, (__v16si)__a,
+                                            (__v16si)__w);
+}
+
+static __inline __m512i __attribute__((__always_inline__, __nodebug__))
+_mm512_mask_mov_epi64(__m512i __w, __mmask8 __u, __m512i __a)
+{
+  return (__m512i)__builtin_ia32_selectq512(__u, (__v8di)__a, (__v8di)__w);
+}
+
+static __inline __m512 __attribute__((__always_inline__, __nodebug__))
+_mm512_maskz_mov_ps(__mmask16 __u, __m512 __a)
+{
+  return _mm512_mask_mov_ps(_mm512_setzero_ps(), __u, __a);
+}
+
+static __inline __m512d __attribute__((__always_inline__, __nodebug__))
+_mm512_maskz_mov_pd(__mmask8 __u, __m512d __a)
+{
+  return _mm512_mask_mov_pd(_mm512_setzero_pd(), __u, __a);
+}
+
+static __inline __m512i __attribute__((__always_inline__, __nodebug__))
+_mm512_maskz_mov_epi32(__mmask16 __u, __m512i __a)
+{
+  return _mm512_mask_mov_epi32(_mm512_setzero_si512(), __u, __a);
+}
+
+static __inline __m512i __attribute__((__always_inline__, __nodebug__))
+_mm512_maskz_mov_epi64(__mmask8 __u, __m512i __a)
+{
+  return _mm512_mask_mov_epi64(_mm512_setzero_si512(), __u, __a);
+}
+
+static __inline __m512 __attribute__((__always_inline__, __nodebug__))
+_mm512_mask_blend_ps(__mmask16 __u, __m512 __a, __m512 __w)
+{
+  return _mm512_mask_mov_ps(__a, __u, __w);
+}
+
+static __inline __m512d __attribute__((__always_inline__, __nodebug__))
+_mm512_mask_blend_pd(__mmask8 __u, __m512d __a, __m512d __w)
+{
+  return _mm512_mask_mov_pd(__a, __u, __w);
+}
+
+static __inline __m512i __attribute__((__always_inline__, __nodebug__))
+_mm512_mask_blend_epi32(__mmask16 __u, __m512i __a, __m512i __w)
+{
+  return _mm512_mask_mov_epi32(__a, __u, __w);
+}
+
+static __inline __m512i __attribute__((__always_inline__, __nodebug__))
+_mm512_mask_blend_epi64(__mmask8 __u, __m512i __a, __m512i __w)
+{
+  return _mm512_mask_mov_epi64(__a, __u, __w);
+}
+
+static __inline __m512 __attribute__((__always_inline__, __nodebug__))
+_mm512_mask_add_ps(__m512 __w, __mmask16 __u, __m512 __a, __m512 __b)
+{
+  return _mm512_mask_mov_ps(__w, __u, __a + __b);
+}
+
+static __inline __m512d __attribute__((__always_inline__, __nodebug__))
+_mm512_mask_add_pd(__m512d __w, __mmask8 __u, __m512d __a, __m512d __b)
+{
+  return _mm512_mask_mov_pd(__w, __u, __a + __b);
+}
+
+static __inline __m512 __attribute__((__always_inline__, __nodebug__))
+_mm512_mask_mul_ps(__m512 __w, __mmask16 __u, __m512 __a, __m512 __b)
+{
+  return _mm512_mask_mov_ps(__w, __u, __a * __b);
+}
+
+static __inline __m512d __attribute__((__always_inline__, __nodebug__))
+_mm512_mask_mul_pd(__m512d __w, __mmask8 __u, __m512d __a, __m512d __b)
+{
+  return _mm512_mask_mov_pd(__w, __u, __a * __b);
+}
+
+static __inline __m512 __attribute__((__always_inline__, __nodebug__))
+_mm512_mask_loadu_ps(__m512 __w, __mmask16 __u, float const *__p)
+{
+  return _mm512_mask_mov_ps(__w, __u, _mm512_loadu_ps(__p));
+}
+
+static __inline __m512d __attribute__((__always_inline__, __nodebug__))
+_mm512_mask_loadu_pd(__m512d __w, __mmask8 __u, double const *__p)
+{
+  return _mm512_mask_mov_pd(__w, __u, _mm512_loadu_pd(__p));
+}
+
+/* Mask operations */
+static __inline __mmask16 __attribute__((__always_inline__, __nodebug__))
+_mm512_kand(__mmask16 __a, __mmask16 __b)
+{
+  return __a & __b;
+}
+
+static __inline __mmask16 __attribute__((__always_inline__, __nodebug__))
+_mm512_kandn(__mmask16 __a, __mmask16 __b)
+{
+  return (__mmask16)~__a & __b;
+}
+
+static __inline __mmask16 __attribute__((__always_inline__, __nodebug__))
+_mm512_kor(__mmask16 __a, __mmask16 __b)
+{
+  return __a | __b;
+}
+
+static __inline __mmask16 __attribute__((__always_inline__, __nodebug__))
+_mm512_kxor(__mmask16 __a, __mmask16 __b)
+{
+  return __a ^ __b;
+}
+
+static __inline __mmask16 __attribute__((__always_inline__, __nodebug__))
+_mm512_knot(__mmask16 __a)
+{
+  return (__mmask16)~__a;
+}
+
+static __inline int __attribute__((__always_inline__, __nodebug__))
+_mm512_kortestz(__mmask16 __a, __mmask16 __b)
+{
+  return (__a | __b) == 0;
+}
+
+static __inline int __attribute__((__always_inline__, __nodebug__))
+_mm512_kortestc(__mmask16 __a, __mmask16 __b)
+{
+  return (__a | __b) == 0xFFFF;
+}
+
+#endif /* __AVX512FINTRIN_H */
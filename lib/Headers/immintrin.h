@@ -60,6 +60,14 @@
 #include <avx2intrin.h>
 #endif
 
+#ifdef __AVX512F__
+#include <avx512fintrin.h>
+#endif
+
+#ifdef __AVX512CD__
+#include <avx512cdintrin.h>
+#endif
+
 #ifdef __BMI__
 #include <bmiintrin.h>
 #endif
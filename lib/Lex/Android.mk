@@ -11,8 +11,10 @@ TBLGEN_TABLES := \
   AttrSpellings.inc
 
 clang_lex_SRC_FILES := \
+  DependencyDirectives.cpp \
   HeaderMap.cpp \
   HeaderSearch.cpp \
+  IncludePrefetcher.cpp \
   Lexer.cpp \
   LiteralSupport.cpp \
   MacroArgs.cpp \
@@ -0,0 +1,99 @@
+//===--- DependencyDirectives.cpp - Minimize sources for dep scans --------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file implements minimizeSourceToDependencyDirectives, which reduces a
+//  source file to the directives that can affect which files it includes.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Lex/DependencyDirectives.h"
+#include "clang/Lex/Lexer.h"
+#include "llvm/ADT/StringSwitch.h"
+
+using namespace clang;
+
+/// \brief Returns the spelling of the token that \p L just lexed.
+static StringRef getRawSpelling(const Lexer &L, const Token &Tok) {
+  return StringRef(L.getBufferLocation() - Tok.getLength(), Tok.getLength());
+}
+
+/// \brief Determines whether a line starting with the given tokens is one of
+/// the directives that minimizeSourceToDependencyDirectives keeps.
+static bool isDependencyDirective(ArrayRef<StringRef> Words) {
+  if (Words.size() < 2)
+    return false;
+
+  if (Words[0] == "@")
+    return Words[1] == "import";
+
+  if (Words[1] == "pragma") {
+    if (Words.size() < 3)
+      return false;
+    if (Words[2] == "GCC" || Words[2] == "clang")
+      return Words.size() > 3 && Words[3] == "system_header";
+    return llvm::StringSwitch<bool>(Words[2])
+      .Cases("once", "push_macro", "pop_macro", "include_alias", true)
+      .Default(false);
+  }
+
+  return llvm::StringSwitch<bool>(Words[1])
+    .Cases("include", "include_next", "import", "__include_macros", true)
+    .Cases("define", "undef", true)
+    .Cases("if", "ifdef", "ifndef", "elif", "else", "endif", true)
+    .Default(false);
+}
+
+bool clang::minimizeSourceToDependencyDirectives(StringRef Input,
+                                                 const LangOptions &LangOpts,
+                                                 SmallVectorImpl<char> &Output) {
+  Output.clear();
+
+  // Lex the file raw, one logical line at a time: every line that contains a
+  // token starts with a token that has the StartOfLine flag set, and the
+  // lexer takes care of comments, literals and escaped newlines for us.
+  Lexer L(SourceLocation(), LangOpts, Input.begin(), Input.begin(),
+          Input.end());
+  Token Tok;
+  L.LexFromRawLexer(Tok);
+  while (Tok.isNot(tok::eof)) {
+    const char *LineStart = L.getBufferLocation() - Tok.getLength();
+    bool IsCandidate = Tok.is(tok::hash) || Tok.is(tok::at);
+
+    // Remember enough of the line to identify the directive.
+    SmallVector<StringRef, 4> Words;
+    Words.push_back(getRawSpelling(L, Tok));
+    while (1) {
+      L.LexFromRawLexer(Tok);
+      if (Tok.is(tok::eof) || Tok.isAtStartOfLine())
+        break;
+      if (IsCandidate && Words.size() < 4)
+        Words.push_back(getRawSpelling(L, Tok));
+    }
+
+    if (!IsCandidate || !isDependencyDirective(Words))
+      continue;
+
+    // Copy the directive verbatim, including any comments or escaped
+    // newlines within it, up to the first token of the next line.
+    const char *LineEnd = Tok.is(tok::eof)
+                              ? Input.end()
+                              : L.getBufferLocation() - Tok.getLength();
+    StringRef Line = StringRef(LineStart, LineEnd - LineStart).rtrim();
+    Output.append(Line.begin(), Line.end());
+    Output.push_back('\n');
+
+    // A trailing escaped newline would otherwise splice the next directive
+    // onto this one.
+    if (Line.endswith("\\") || Line.endswith("?\?/"))
+      Output.push_back('\n');
+  }
+
+  // The result must fit in the source locations reserved for the original.
+  return Output.size() <= Input.size();
+}
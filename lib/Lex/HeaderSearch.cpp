@@ -12,6 +12,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "clang/Lex/HeaderSearch.h"
+#include "clang/Basic/CharInfo.h"
 #include "clang/Basic/Diagnostic.h"
 #include "clang/Basic/FileManager.h"
 #include "clang/Basic/IdentifierTable.h"
@@ -21,6 +22,7 @@
 #include "llvm/ADT/SmallString.h"
 #include "llvm/Support/Capacity.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include <cstdio>
 #if defined(LLVM_ON_UNIX)
@@ -57,13 +59,26 @@ HeaderSearch::HeaderSearch(IntrusiveRefCntPtr<HeaderSearchOptions> HSOpts,
   ExternalSource = 0;
   NumIncluded = 0;
   NumMultiIncludeFileOptzn = 0;
+  NumCachedControllingMacroOptzn = 0;
   NumFrameworkLookups = NumSubFrameworkLookups = 0;
+  NumListedDirectories = NumStatsAvoided = 0;
+  NumModuleMapsSkipped = 0;
 }
 
 HeaderSearch::~HeaderSearch() {
   // Delete headermaps.
   for (unsigned i = 0, e = HeaderMaps.size(); i != e; ++i)
     delete HeaderMaps[i].second;
+
+  for (llvm::DenseMap<const DirectoryEntry *, llvm::StringSet<> *>::iterator
+         I = DirectoryContents.begin(), E = DirectoryContents.end();
+       I != E; ++I)
+    delete I->second;
+
+  for (llvm::DenseMap<const FileEntry *, llvm::StringSet<> *>::iterator
+         I = ModuleMapNames.begin(), E = ModuleMapNames.end();
+       I != E; ++I)
+    delete I->second;
 }
 
 void HeaderSearch::PrintStats() {
@@ -83,9 +98,15 @@ void HeaderSearch::PrintStats() {
   fprintf(stderr, "  %d #include/#include_next/#import.\n", NumIncluded);
   fprintf(stderr, "    %d #includes skipped due to"
           " the multi-include optimization.\n", NumMultiIncludeFileOptzn);
+  fprintf(stderr, "    %d of them using include guards recorded by"
+          " earlier compilations.\n", NumCachedControllingMacroOptzn);
 
   fprintf(stderr, "%d framework lookups.\n", NumFrameworkLookups);
   fprintf(stderr, "%d subframework lookups.\n", NumSubFrameworkLookups);
+  fprintf(stderr, "%d header stats avoided by listing %d directories.\n",
+          NumStatsAvoided, NumListedDirectories);
+  fprintf(stderr, "%d module maps not parsed by module lookup.\n",
+          NumModuleMapsSkipped);
 }
 
 /// CreateHeaderMap - This method returns a HeaderMap for the specified
@@ -189,9 +210,9 @@ Module *HeaderSearch::lookupModule(StringRef ModuleName, bool AllowSearch) {
     if (SearchDirs[Idx].haveSearchedAllModuleMaps())
       continue;
 
-    // Load all module maps in the immediate subdirectories of this search
-    // directory.
-    loadSubdirectoryModuleMaps(SearchDirs[Idx]);
+    // Load the module maps in the immediate subdirectories of this search
+    // directory that may declare the module.
+    loadSubdirectoryModuleMaps(SearchDirs[Idx], ModuleName);
 
     // Look again for the module.
     Module = ModMap.findModule(ModuleName);
@@ -220,6 +241,53 @@ const char *DirectoryLookup::getName() const {
 
 /// LookupFile - Lookup the specified file in this search path, returning it
 /// if it exists or returning null if not.
+/// \brief Read the lowercased names of the entries of \p DirName, or return
+/// null if the directory can't be read.
+static llvm::StringSet<> *listDirectory(FileManager &FileMgr,
+                                        StringRef DirName) {
+  SmallString<256> Path(DirName);
+  FileMgr.FixupRelativePath(Path);
+
+  OwningPtr<llvm::StringSet<> > Names(new llvm::StringSet<>());
+  llvm::error_code EC;
+  for (llvm::sys::fs::directory_iterator Dir(Path.str(), EC), DirEnd;
+       !EC && Dir != DirEnd; Dir.increment(EC))
+    Names->insert(StringRef(llvm::sys::path::filename(Dir->path())).lower());
+  if (EC)
+    return 0;
+  return Names.take();
+}
+
+bool HeaderSearch::isKnownMissing(const DirectoryEntry *Dir,
+                                  StringRef Filename) {
+  // Files that only exist in the file manager don't show up in listings.
+  if (FileMgr.hasVirtualFiles())
+    return false;
+
+  StringRef FirstComponent = *llvm::sys::path::begin(Filename);
+  if (FirstComponent.empty() || FirstComponent == "." ||
+      FirstComponent == ".." || llvm::sys::path::is_absolute(Filename))
+    return false;
+
+  llvm::DenseMap<const DirectoryEntry *, llvm::StringSet<> *>::iterator
+    Known = DirectoryContents.find(Dir);
+  if (Known == DirectoryContents.end() || !Known->second ||
+      Known->second->count(FirstComponent.lower()))
+    return false;
+
+  ++NumStatsAvoided;
+  return true;
+}
+
+void HeaderSearch::noteMissingFile(const DirectoryEntry *Dir) {
+  // Only list a directory once a lookup in it has failed, since a stat is
+  // cheaper than a listing of a directory that is searched rarely.
+  if (DirectoryContents.count(Dir))
+    return;
+  DirectoryContents[Dir] = listDirectory(FileMgr, Dir->getName());
+  ++NumListedDirectories;
+}
+
 const FileEntry *DirectoryLookup::LookupFile(
     StringRef Filename,
     HeaderSearch &HS,
@@ -259,7 +327,14 @@ const FileEntry *DirectoryLookup::LookupFile(
       return File;
     }
     
-    return HS.getFileMgr().getFile(TmpDir.str(), /*openFile=*/true);
+    if (HS.isKnownMissing(getDir(), Filename))
+      return 0;
+
+    const FileEntry *File = HS.getFileMgr().getFile(TmpDir.str(),
+                                                    /*openFile=*/true);
+    if (!File)
+      HS.noteMissingFile(getDir());
+    return File;
   }
 
   if (isFramework())
@@ -881,7 +956,8 @@ void HeaderSearch::MarkFileModuleHeader(const FileEntry *FE,
   HFI.setHeaderRole(Role);
 }
 
-bool HeaderSearch::ShouldEnterIncludeFile(const FileEntry *File, bool isImport){
+bool HeaderSearch::ShouldEnterIncludeFile(const FileEntry *File, bool isImport,
+                                          IdentifierTable *CachedGuardNames) {
   ++NumIncluded; // Count # of attempted #includes.
 
   // Get information about this file.
@@ -911,6 +987,22 @@ bool HeaderSearch::ShouldEnterIncludeFile(const FileEntry *File, bool isImport){
       return false;
     }
 
+  // If we have never entered the file, an earlier compilation may still have
+  // found its guard. If that macro is defined, we can skip the file without
+  // even reading it.
+  std::string CachedMacro;
+  if (!FileInfo.ControllingMacro && !FileInfo.ControllingMacroID &&
+      !FileInfo.NumIncludes && CachedGuardNames &&
+      FileMgr.getCachedControllingMacro(File, CachedMacro)) {
+    IdentifierInfo &ControllingMacro = CachedGuardNames->get(CachedMacro);
+    if (ControllingMacro.hasMacroDefinition()) {
+      FileInfo.ControllingMacro = &ControllingMacro;
+      ++NumMultiIncludeFileOptzn;
+      ++NumCachedControllingMacroOptzn;
+      return false;
+    }
+  }
+
   // Increment the number of times this file has been included.
   ++FileInfo.NumIncludes;
 
@@ -1165,17 +1257,87 @@ void HeaderSearch::loadTopLevelSystemModules() {
   }
 }
 
-void HeaderSearch::loadSubdirectoryModuleMaps(DirectoryLookup &SearchDir) {
+/// \brief Collect the names that follow a \c module keyword in the text of a
+/// module map, which include the names of all of the modules it declares.
+///
+/// Where the keyword is followed by anything but a name, such as a comment or
+/// the '*' of an inferred submodule or framework, "*" is collected instead, so
+/// that the module map is taken to declare any module.
+static void collectModuleNames(StringRef Text, llvm::StringSet<> &Names) {
+  for (size_t Pos = Text.find("module"); Pos != StringRef::npos;
+       Pos = Text.find("module", Pos + 1)) {
+    size_t End = Pos + 6;
+    if ((Pos && isIdentifierBody(Text[Pos - 1])) ||
+        (End != Text.size() && isIdentifierBody(Text[End])))
+      continue;
+
+    while (End != Text.size() && isWhitespace(Text[End]))
+      ++End;
+    size_t Start = End;
+    while (End != Text.size() && isIdentifierBody(Text[End]))
+      ++End;
+    if (Start == End || !isIdentifierHead(Text[Start]))
+      Names.insert("*");
+    else
+      Names.insert(Text.slice(Start, End));
+  }
+}
+
+bool HeaderSearch::moduleMapMayDeclare(const FileEntry *File,
+                                       StringRef ModuleName) {
+  if (!File)
+    return false;
+
+  llvm::StringSet<> *&Names = ModuleMapNames[File];
+  if (!Names) {
+    OwningPtr<llvm::MemoryBuffer> Buffer(FileMgr.getBufferForFile(File));
+    // If the module map can't be read, leave the diagnostic to the parser.
+    if (!Buffer)
+      return true;
+    Names = new llvm::StringSet<>();
+    collectModuleNames(Buffer->getBuffer(), *Names);
+  }
+  return Names->count(ModuleName) || Names->count("*");
+}
+
+void HeaderSearch::loadSubdirectoryModuleMaps(DirectoryLookup &SearchDir,
+                                              StringRef ModuleName) {
   if (SearchDir.haveSearchedAllModuleMaps())
     return;
   
+  bool LoadedAll = true;
   llvm::error_code EC;
   SmallString<128> DirNative;
   llvm::sys::path::native(SearchDir.getDir()->getName(), DirNative);
   for (llvm::sys::fs::directory_iterator Dir(DirNative.str(), EC), DirEnd;
        Dir != DirEnd && !EC; Dir.increment(EC)) {
+    if (!ModuleName.empty()) {
+      const DirectoryEntry *SubDir = FileMgr.getDirectory(Dir->path());
+      if (!SubDir || DirectoryHasModuleMap.count(SubDir))
+        continue;
+
+      // Only parse the module maps that may declare the module; the rest
+      // are parsed when a header in their directory is looked up, or when
+      // some other module is looked up.
+      SmallString<128> MapName(SubDir->getName());
+      unsigned DirNameLen = MapName.size();
+      llvm::sys::path::append(MapName, "module.map");
+      const FileEntry *Map = FileMgr.getFile(MapName);
+      if (!Map)
+        continue;
+      MapName.resize(DirNameLen);
+      llvm::sys::path::append(MapName, "module_private.map");
+      if (!moduleMapMayDeclare(Map, ModuleName) &&
+          !moduleMapMayDeclare(FileMgr.getFile(MapName), ModuleName)) {
+        ++NumModuleMapsSkipped;
+        LoadedAll = false;
+        continue;
+      }
+    }
+
     loadModuleMapFile(Dir->path(), SearchDir.isSystemHeaderDirectory());
   }
 
-  SearchDir.setSearchedAllModuleMaps(true);
+  if (LoadedAll)
+    SearchDir.setSearchedAllModuleMaps(true);
 }
@@ -0,0 +1,258 @@
+//===--- IncludePrefetcher.cpp - Read included files ahead of time --------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file implements the IncludePrefetcher.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Lex/IncludePrefetcher.h"
+#include "clang/Basic/CharInfo.h"
+#include "clang/Basic/FileManager.h"
+#include "clang/Basic/FileSystemStatCache.h"
+#include "clang/Basic/SourceManager.h"
+#include "clang/Basic/WorkerPool.h"
+#include "clang/Lex/DirectoryLookup.h"
+#include "clang/Lex/HeaderSearch.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/system_error.h"
+
+using namespace clang;
+
+/// \brief Answers the stats of files from the checks of the prefetcher.
+///
+/// Only the paths that the prefetcher checked are answered, and only when
+/// they are asked about as files; everything else is passed down the chain.
+class IncludePrefetcher::PrefetchedStatCache : public FileSystemStatCache {
+  llvm::sys::Mutex Lock;
+  /// The stat data of the files that exist, and null for those that don't.
+  llvm::StringMap<FileData *> Results;
+
+public:
+  ~PrefetchedStatCache() {
+    for (llvm::StringMap<FileData *>::iterator I = Results.begin(),
+                                               E = Results.end();
+         I != E; ++I)
+      delete I->getValue();
+  }
+
+  /// \brief Remember that the file \p Path exists with the stat data \p Data,
+  /// or doesn't if \p Data is null, taking ownership of it.
+  void add(StringRef Path, FileData *Data) {
+    llvm::sys::ScopedLock L(Lock);
+    FileData *&Result = Results[Path];
+    delete Result;
+    Result = Data;
+  }
+
+protected:
+  virtual LookupResult getStat(const char *Path, FileData &Data, bool isFile,
+                               int *FileDescriptor) {
+    if (isFile) {
+      llvm::sys::ScopedLock L(Lock);
+      llvm::StringMap<FileData *>::iterator I = Results.find(Path);
+      if (I != Results.end()) {
+        if (!I->getValue())
+          return CacheMissing;
+        // The file is opened by name when it is read.
+        Data = *I->getValue();
+        return CacheExists;
+      }
+    }
+    return statChained(Path, Data, isFile, FileDescriptor);
+  }
+};
+
+IncludePrefetcher::IncludePrefetcher(SourceManager &SourceMgr,
+                                     HeaderSearch &HeaderInfo)
+    : SourceMgr(SourceMgr), HeaderInfo(HeaderInfo),
+      StatCache(new PrefetchedStatCache()), WorkerRunning(false) {
+  SourceMgr.getFileManager().addStatCache(StatCache, /*AtBeginning=*/true);
+}
+
+IncludePrefetcher::~IncludePrefetcher() {
+  {
+    // Leave the files that weren't started on.
+    llvm::sys::ScopedLock L(Lock);
+    Queue.clear();
+  }
+  Worker.reset();
+
+  SourceMgr.getFileManager().removeStatCache(StatCache);
+  for (llvm::StringMap<llvm::MemoryBuffer *>::iterator I = Buffers.begin(),
+                                                       E = Buffers.end();
+       I != E; ++I)
+    delete I->getValue();
+}
+
+void IncludePrefetcher::runWorker(void *Context) {
+  IncludePrefetcher &Self = *static_cast<IncludePrefetcher *>(Context);
+  while (true) {
+    std::vector<std::string> Candidates;
+    {
+      llvm::sys::ScopedLock L(Self.Lock);
+      if (Self.Queue.empty()) {
+        Self.WorkerRunning = false;
+        return;
+      }
+      Candidates.swap(Self.Queue.back());
+      Self.Queue.pop_back();
+    }
+    Self.prefetch(Candidates);
+  }
+}
+
+void IncludePrefetcher::prefetch(const std::vector<std::string> &Candidates) {
+  for (unsigned I = 0, E = Candidates.size(); I != E; ++I) {
+    const std::string &Path = Candidates[I];
+    FileData Data;
+    if (FileSystemStatCache::get(Path.c_str(), Data, /*isFile=*/true,
+                                 /*FileDescriptor=*/0, /*Cache=*/0)) {
+      StatCache->add(Path, 0);
+      continue;
+    }
+    StatCache->add(Path, new FileData(Data));
+
+    // The header search stops at the first file that exists.
+    OwningPtr<llvm::MemoryBuffer> Buffer;
+    if (!llvm::MemoryBuffer::getFile(Path, Buffer, Data.Size)) {
+      llvm::sys::ScopedLock L(Lock);
+      llvm::MemoryBuffer *&Entry = Buffers[Path];
+      delete Entry;
+      Entry = Buffer.take();
+    }
+    return;
+  }
+}
+
+/// \brief Finds the name of the file included by the directive at the start
+/// of \p Line, if it is an \#include or \#import directive that doesn't use
+/// macros. Sets \p IsAngled if the name is between angle brackets.
+static bool getIncludedName(StringRef Line, StringRef &Name, bool &IsAngled) {
+  Line = Line.ltrim(" \t");
+  if (!Line.startswith("#"))
+    return false;
+  Line = Line.substr(1).ltrim(" \t");
+  if (Line.startswith("include"))
+    Line = Line.substr(7);
+  else if (Line.startswith("import"))
+    Line = Line.substr(6);
+  else
+    return false;
+  // This rejects #include_next, whose lookup depends on where the including
+  // file was found.
+  if (Line.empty() || isIdentifierBody(Line[0]))
+    return false;
+  Line = Line.ltrim(" \t");
+  if (Line.empty())
+    return false;
+
+  char Close;
+  if (Line[0] == '"')
+    Close = '"';
+  else if (Line[0] == '<')
+    Close = '>';
+  else
+    return false;
+  size_t End = Line.find(Close, 1);
+  if (End == StringRef::npos || End == 1)
+    return false;
+  Name = Line.substr(1, End - 1);
+  IsAngled = Close == '>';
+  return true;
+}
+
+void IncludePrefetcher::scanFile(const FileEntry *File,
+                                 const llvm::MemoryBuffer *Buffer) {
+  const DirectoryEntry *FileDir = File ? File->getDir() : 0;
+  std::vector<std::vector<std::string> > Found;
+  StringRef Text = Buffer->getBuffer();
+  for (size_t Pos = Text.find('#'); Pos != StringRef::npos;
+       Pos = Text.find('#', Pos + 1)) {
+    // Only look at the lines whose first non-blank character is '#'.
+    size_t StartOfLine = Text.find_last_of("\n\r", Pos);
+    StartOfLine = StartOfLine == StringRef::npos ? 0 : StartOfLine + 1;
+    if (!Text.slice(StartOfLine, Pos).ltrim(" \t").empty())
+      continue;
+    StringRef Line = Text.slice(Pos, Text.find_first_of("\n\r", Pos));
+    StringRef Name;
+    bool IsAngled;
+    if (!getIncludedName(Line, Name, IsAngled))
+      continue;
+
+    // List the paths in the order the header search tries them, leaving out
+    // directories it doesn't look into by path, like frameworks and header
+    // maps.
+    std::vector<std::string> Candidates;
+    if (llvm::sys::path::is_absolute(Name)) {
+      Candidates.push_back(Name);
+    } else {
+      if (!IsAngled && FileDir) {
+        SmallString<256> Path(FileDir->getName());
+        Path.push_back('/');
+        Path.append(Name.begin(), Name.end());
+        Candidates.push_back(Path.str());
+      }
+      for (HeaderSearch::search_dir_iterator
+               I = IsAngled ? HeaderInfo.angled_dir_begin()
+                            : HeaderInfo.search_dir_begin(),
+               E = HeaderInfo.search_dir_end();
+           I != E; ++I) {
+        if (!I->isNormalDir())
+          continue;
+        SmallString<256> Path(I->getDir()->getName());
+        llvm::sys::path::append(Path, Name);
+        Candidates.push_back(Path.str());
+      }
+    }
+
+    // Leave out the paths that are known already.
+    unsigned NumNew = 0;
+    for (unsigned I = 0, E = Candidates.size(); I != E; ++I)
+      if (Requested.insert(Candidates[I]))
+        Candidates[NumNew++] = Candidates[I];
+    Candidates.resize(NumNew);
+    if (!Candidates.empty())
+      Found.push_back(Candidates);
+  }
+  if (Found.empty())
+    return;
+
+  llvm::sys::ScopedLock L(Lock);
+  // The worker takes the inclusions from the back, so that those at the
+  // start of the file are read first.
+  Queue.insert(Queue.end(), Found.rbegin(), Found.rend());
+  if (WorkerRunning)
+    return;
+  WorkerRunning = true;
+  // A worker that stopped is done, so destroying it doesn't wait.
+  Worker.reset();
+  Worker.reset(new BackgroundThread(runWorker, this));
+}
+
+void IncludePrefetcher::provideContents(const FileEntry *File) {
+  llvm::MemoryBuffer *Buffer = 0;
+  {
+    llvm::sys::ScopedLock L(Lock);
+    llvm::StringMap<llvm::MemoryBuffer *>::iterator I =
+        Buffers.find(File->getName());
+    if (I == Buffers.end())
+      return;
+    Buffer = I->getValue();
+    Buffers.erase(I);
+  }
+
+  // The file may have changed since it was read.
+  if (Buffer->getBufferSize() != (size_t)File->getSize()) {
+    delete Buffer;
+    return;
+  }
+  SourceMgr.setPrefetchedFileContents(File, Buffer);
+}
@@ -25,6 +25,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "clang/Lex/Lexer.h"
+#include "clang/Basic/ByteScan.h"
 #include "clang/Basic/CharInfo.h"
 #include "clang/Basic/SourceManager.h"
 #include "clang/Lex/CodeCompletionHandler.h"
@@ -1363,6 +1364,132 @@ void Lexer::SkipBytes(unsigned Bytes, bool StartOfLine) {
   IsAtStartOfLine = StartOfLine;
 }
 
+unsigned Lexer::SkipToPossibleDirective() {
+  assert(LexingRawMode && "Only skipped blocks can be scanned this way");
+  if (CurrentConflictMarkerState || LangOpts.AsmPreprocessor)
+    return 0;
+
+  // Trigraphs, which are only recognized when enabled, are left to the lexer.
+  char TrigraphChar = LangOpts.Trigraphs ? '?' : '\n';
+  const char *CurPtr = BufferPtr;
+  // Whether nothing but whitespace and comments precede CurPtr on its line,
+  // so that a token there would start the line.
+  bool AtStartOfLine = IsAtStartOfLine;
+  // Where the scan stops: the start of whatever it can't handle, which is
+  // always between two tokens.
+  const char *StopPtr;
+  while (true) {
+    StopPtr = CurPtr;
+    char C = *CurPtr++;
+    switch (C) {
+    case '\n':
+    case '\r':
+      AtStartOfLine = true;
+      continue;
+
+    case ' ':
+    case '\t':
+    case '\f':
+    case '\v':
+      CurPtr = skipHorizontalWhitespace(CurPtr, BufferEnd);
+      continue;
+
+    case '#':
+      if (AtStartOfLine)
+        break;
+      continue;
+
+    case '%':
+      // '%:' is a digraph for '#'.
+      if (AtStartOfLine && *CurPtr == ':')
+        break;
+      AtStartOfLine = false;
+      continue;
+
+    case '/':
+      if (*CurPtr == '*') {
+        // A block comment, which doesn't change whether the next token
+        // starts its line.  Leave "*\<newline>/" and trigraphs to the lexer.
+        const char *Star = CurPtr + 1;
+        while ((Star = scanForByte(Star, BufferEnd, '*')) != BufferEnd &&
+               Star[1] != '/' && Star[1] != '\\' && Star[1] != TrigraphChar)
+          ++Star;
+        if (Star == BufferEnd || Star[1] != '/')
+          break;
+        // So is a nul inside the comment, such as the code completion point.
+        if (scanForByte(CurPtr + 1, Star, 0) != Star)
+          break;
+        CurPtr = Star + 2;
+        continue;
+      }
+      if (*CurPtr == '/' && LangOpts.LineComment) {
+        // A line comment, which goes on past an escaped newline.
+        const char *LineEnd = scanForLineEnd(CurPtr, BufferEnd);
+        if (*LineEnd != '\n' && *LineEnd != '\r')
+          break;
+        if (scanForByte(CurPtr, LineEnd, '\\') != LineEnd ||
+            scanForByte(CurPtr, LineEnd, TrigraphChar) != LineEnd)
+          break;
+        CurPtr = LineEnd;
+        continue;
+      }
+      AtStartOfLine = false;
+      continue;
+
+    case '"':
+    case '\'':
+      // Raw string literals can span lines.
+      if (C == '"' && LangOpts.CPlusPlus11 && StopPtr != BufferStart &&
+          StopPtr[-1] == 'R') {
+        while (StopPtr != BufferStart && isIdentifierBody(StopPtr[-1]))
+          --StopPtr;
+        break;
+      }
+      // A literal ends at its closing quote or, if there is none, at the end
+      // of the line, as in "don't".
+      while (*CurPtr != C && *CurPtr != '\n' && *CurPtr != '\r') {
+        if (*CurPtr == '\\' && CurPtr[1] && CurPtr[1] != '\n' &&
+            CurPtr[1] != '\r')
+          CurPtr += 2;
+        else if (*CurPtr && *CurPtr != '\\' && *CurPtr != TrigraphChar)
+          ++CurPtr;
+        else
+          break;
+      }
+      if (*CurPtr == C)
+        ++CurPtr;
+      else if (*CurPtr != '\n' && *CurPtr != '\r')
+        break;
+      AtStartOfLine = false;
+      continue;
+
+    case '?':
+      if (C == TrigraphChar && *CurPtr == '?')
+        break;
+      AtStartOfLine = false;
+      continue;
+
+    case '\\':
+    case 0:
+      // Escaped newlines, the end of the buffer and the code completion point
+      // are left to the lexer.
+      break;
+
+    default:
+      if (isIdentifierBody(C))
+        CurPtr = skipIdentifierBody(CurPtr, BufferEnd);
+      AtStartOfLine = false;
+      continue;
+    }
+    break;
+  }
+
+  unsigned Skipped = StopPtr - BufferPtr;
+  if (Skipped)
+    SkipBytes(Skipped, AtStartOfLine);
+  return Skipped;
+}
+
 static bool isAllowedIDChar(uint32_t C, const LangOptions &LangOpts) {
   if (LangOpts.CPlusPlus11 || LangOpts.C11)
     return isCharInSet(C, C11AllowedIDChars);
@@ -1422,11 +1549,8 @@ static void maybeDiagnoseIDCharCompat(DiagnosticsEngine &Diags, uint32_t C,
 void Lexer::LexIdentifier(Token &Result, const char *CurPtr) {
   // Match [_A-Za-z0-9]*, we have already matched [_A-Za-z$]
   unsigned Size;
-  unsigned char C = *CurPtr++;
-  while (isIdentifierBody(C))
-    C = *CurPtr++;
-
-  --CurPtr;   // Back up over the skipped character.
+  CurPtr = skipIdentifierBody(CurPtr, BufferEnd);
+  unsigned char C = *CurPtr;
 
   // Fast path, no $,\,? in identifier found.  '\' might be an escaped newline
   // or UCN, and ? might be a trigraph for '\', an escaped newline or UCN.
@@ -1878,8 +2002,10 @@ bool Lexer::SkipWhitespace(Token &Result, const char *CurPtr) {
   // Skip consecutive spaces efficiently.
   while (1) {
     // Skip horizontal whitespace very aggressively.
-    while (isHorizontalWhitespace(Char))
-      Char = *++CurPtr;
+    if (isHorizontalWhitespace(Char)) {
+      CurPtr = skipHorizontalWhitespace(CurPtr + 1, BufferEnd);
+      Char = *CurPtr;
+    }
 
     // Otherwise if we have something other than whitespace, we're done.
     if (!isVerticalWhitespace(Char))
@@ -1939,11 +2065,10 @@ bool Lexer::SkipLineComment(Token &Result, const char *CurPtr) {
   // them.  As such, optimize for this case with the inner loop.
   char C;
   do {
+    // Skip over characters in the fast loop, stopping at a potential EOF, a
+    // newline or a DOS-style newline.
+    CurPtr = scanForLineEnd(CurPtr, BufferEnd);
     C = *CurPtr;
-    // Skip over characters in the fast loop.
-    while (C != 0 &&                // Potentially EOF.
-           C != '\n' && C != '\r')  // Newline or DOS-style newline.
-      C = *++CurPtr;
 
     const char *NextLine = CurPtr;
     if (C != 0) {
@@ -2136,13 +2261,6 @@ static bool isEndOfBlockCommentWithEscapedNewLine(const char *CurPtr,
   return true;
 }
 
-#ifdef __SSE2__
-#include <emmintrin.h>
-#elif __ALTIVEC__
-#include <altivec.h>
-#undef bool
-#endif
-
 /// We have just read from input the / and * characters that started a comment.
 /// Read until we find the * and / characters that terminate the comment.
 /// Note that we don't bother decoding trigraphs or escaped newlines in block
@@ -2187,52 +2305,17 @@ bool Lexer::SkipBlockComment(Token &Result, const char *CurPtr) {
 
   while (1) {
     // Skip over all non-interesting characters until we find end of buffer or a
-    // (probably ending) '/' character.
-    if (CurPtr + 24 < BufferEnd &&
-        // If there is a code-completion point avoid the fast scan because it
-        // doesn't check for '\0'.
+    // (probably ending) '/' character.  A nul might be the end of the buffer,
+    // so leave it to the loop below.  If there is a code-completion point
+    // avoid the fast scan because it doesn't check for '\0'.
+    if (C != '/' && C != '\0' &&
         !(PP && PP->getCodeCompletionFileLoc() == FileLoc)) {
-      // While not aligned to a 16-byte boundary.
-      while (C != '/' && ((intptr_t)CurPtr & 0x0F) != 0)
-        C = *CurPtr++;
+      CurPtr = scanForByte(CurPtr, BufferEnd, '/');
 
-      if (C == '/') goto FoundSlash;
-
-#ifdef __SSE2__
-      __m128i Slashes = _mm_set1_epi8('/');
-      while (CurPtr+16 <= BufferEnd) {
-        int cmp = _mm_movemask_epi8(_mm_cmpeq_epi8(*(const __m128i*)CurPtr,
-                                    Slashes));
-        if (cmp != 0) {
-          // Adjust the pointer to point directly after the first slash. It's
-          // not necessary to set C here, it will be overwritten at the end of
-          // the outer loop.
-          CurPtr += llvm::countTrailingZeros<unsigned>(cmp) + 1;
-          goto FoundSlash;
-        }
-        CurPtr += 16;
-      }
-#elif __ALTIVEC__
-      __vector unsigned char Slashes = {
-        '/', '/', '/', '/',  '/', '/', '/', '/',
-        '/', '/', '/', '/',  '/', '/', '/', '/'
-      };
-      while (CurPtr+16 <= BufferEnd &&
-             !vec_any_eq(*(vector unsigned char*)CurPtr, Slashes))
-        CurPtr += 16;
-#else
-      // Scan for '/' quickly.  Many block comments are very large.
-      while (CurPtr[0] != '/' &&
-             CurPtr[1] != '/' &&
-             CurPtr[2] != '/' &&
-             CurPtr[3] != '/' &&
-             CurPtr+4 < BufferEnd) {
-        CurPtr += 4;
-      }
-#endif
-
-      // It has to be one of the bytes scanned, increment to it and read one.
+      // Either we found a slash, or we're at the end of the buffer and read the
+      // terminating nul.
       C = *CurPtr++;
+      if (C == '/') goto FoundSlash;
     }
 
     // Loop to scan the remainder.
@@ -1230,9 +1230,16 @@ void StringLiteralParser::init(const Token *StringToks, unsigned NumStringToks){
   // Size the temporary buffer to hold the result string data.
   ResultBuf.resize(SizeBound);
 
-  // Likewise, but for each string piece.
+  // Likewise, but for each string piece. The pieces that need no cleaning are
+  // spelled in place, so the buffer only has to hold the ones that do, which
+  // spares zeroing a buffer as large as a multi-megabyte literal.
+  unsigned MaxCleanedLength = 0;
+  for (unsigned i = 0; i != NumStringToks; ++i)
+    if (StringToks[i].needsCleaning())
+      MaxCleanedLength = std::max(MaxCleanedLength,
+                                  StringToks[i].getLength());
   SmallString<512> TokenBuf;
-  TokenBuf.resize(MaxTokenLength);
+  TokenBuf.resize(MaxCleanedLength);
 
   // Loop over all the strings, getting their spelling, and expanding them to
   // wide strings as appropriate.
@@ -1243,7 +1250,7 @@ void StringLiteralParser::init(const Token *StringToks, unsigned NumStringToks){
   SourceLocation UDSuffixTokLoc;
 
   for (unsigned i = 0, e = NumStringToks; i != e; ++i) {
-    const char *ThisTokBuf = &TokenBuf[0];
+    const char *ThisTokBuf = TokenBuf.data();
     // Get the spelling of the token, which eliminates trigraphs, etc.  We know
     // that ThisTokBuf points to a buffer that is big enough for the whole token
     // and 'spelled' tokens can only shrink.
@@ -1342,9 +1349,10 @@ void StringLiteralParser::init(const Token *StringToks, unsigned NumStringToks){
         // Is this a span of non-escape characters?
         if (ThisTokBuf[0] != '\\') {
           const char *InStart = ThisTokBuf;
-          do {
-            ++ThisTokBuf;
-          } while (ThisTokBuf != ThisTokEnd && ThisTokBuf[0] != '\\');
+          ThisTokBuf = static_cast<const char *>(
+              memchr(ThisTokBuf, '\\', ThisTokEnd - ThisTokBuf));
+          if (!ThisTokBuf)
+            ThisTokBuf = ThisTokEnd;
 
           // Copy the character span over.
           if (CopyStringFragment(StringToks[i], ThisTokBegin,
@@ -1441,6 +1449,18 @@ static const char *resyncUTF8(const char *Err, const char *End) {
 bool StringLiteralParser::CopyStringFragment(const Token &Tok,
                                              const char *TokBegin,
                                              StringRef Fragment) {
+  // Most fragments are plain ASCII, which narrow strings take as it is.
+  if (CharByteWidth == 1) {
+    unsigned char Bits = 0;
+    for (unsigned I = 0, E = Fragment.size(); I != E; ++I)
+      Bits |= Fragment[I];
+    if (!(Bits & 0x80)) {
+      memcpy(ResultPtr, Fragment.data(), Fragment.size());
+      ResultPtr += Fragment.size();
+      return false;
+    }
+  }
+
   const UTF8 *ErrorPtrTmp;
   if (ConvertUTF8toWide(CharByteWidth, Fragment, ResultPtr, ErrorPtrTmp))
     return false;
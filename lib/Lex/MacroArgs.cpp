@@ -72,6 +72,8 @@ MacroArgs *MacroArgs::create(const MacroInfo *MI,
 ///
 void MacroArgs::destroy(Preprocessor &PP) {
   StringifiedArgs.clear();
+  UnexpArgStarts.clear();
+  ArgPreexpansionKinds.clear();
 
   // Don't clear PreExpArgTokens, just clear the entries.  Clearing the entries
   // would deallocate the element vectors.
@@ -114,15 +116,20 @@ const Token *MacroArgs::getUnexpArgument(unsigned Arg) const {
   // The unexpanded argument tokens start immediately after the MacroArgs object
   // in memory.
   const Token *Start = (const Token *)(this+1);
-  const Token *Result = Start;
-  // Scan to find Arg.
-  for (; Arg; ++Result) {
-    assert(Result < Start+NumUnexpArgTokens && "Invalid arg #");
-    if (Result->is(tok::eof))
-      --Arg;
+  if (Arg == 0)
+    return Start;
+
+  // Find where every argument starts, once, so that the uses of the arguments
+  // in the macro body don't each rescan the arguments before them.
+  if (UnexpArgStarts.empty()) {
+    UnexpArgStarts.push_back(Start);
+    for (const Token *Tok = Start, *End = Start+NumUnexpArgTokens; Tok != End;
+         ++Tok)
+      if (Tok->is(tok::eof) && Tok+1 != End)
+        UnexpArgStarts.push_back(Tok+1);
   }
-  assert(Result < Start+NumUnexpArgTokens && "Invalid arg #");
-  return Result;
+  assert(Arg < UnexpArgStarts.size() && "Invalid arg #");
+  return UnexpArgStarts[Arg];
 }
 
 
@@ -142,6 +149,15 @@ bool MacroArgs::ArgNeedsPreexpansion(const Token *ArgTok,
   return false;
 }
 
+bool MacroArgs::ArgNeedsPreexpansion(unsigned Arg, Preprocessor &PP) const {
+  if (ArgPreexpansionKinds.size() <= Arg)
+    ArgPreexpansionKinds.resize(Arg+1);
+  unsigned char &Kind = ArgPreexpansionKinds[Arg];
+  if (!Kind)
+    Kind = 1 + ArgNeedsPreexpansion(getUnexpArgument(Arg), PP);
+  return Kind - 1;
+}
+
 /// getPreExpArgument - Return the pre-expanded form of the specified
 /// argument.
 const std::vector<Token> &
@@ -18,6 +18,7 @@
 #include "clang/Lex/CodeCompletionHandler.h"
 #include "clang/Lex/HeaderSearch.h"
 #include "clang/Lex/HeaderSearchOptions.h"
+#include "clang/Lex/IncludePrefetcher.h"
 #include "clang/Lex/LexDiagnostic.h"
 #include "clang/Lex/LiteralSupport.h"
 #include "clang/Lex/MacroInfo.h"
@@ -257,6 +258,8 @@ void Preprocessor::SkipExcludedConditionalBlock(SourceLocation IfTokenLoc,
   CurPPLexer->LexingRawMode = true;
   Token Tok;
   while (1) {
+    // Jump over the text that can't hold a directive without lexing it.
+    NumSkippedBytes += CurLexer->SkipToPossibleDirective();
     CurLexer->Lex(Tok);
 
     if (Tok.is(tok::code_completion)) {
@@ -1597,8 +1600,12 @@ void Preprocessor::HandleIncludeDirective(SourceLocation HashLoc,
              SourceMgr.getFileCharacteristic(FilenameTok.getLocation()));
 
   // Ask HeaderInfo if we should enter this #include file.  If not, #including
-  // this file will have no effect.
-  if (!HeaderInfo.ShouldEnterIncludeFile(File, isImport)) {
+  // this file will have no effect.  Guards recorded by earlier compilations
+  // describe the file on disk, so they don't apply if its contents have been
+  // overridden.
+  if (!HeaderInfo.ShouldEnterIncludeFile(
+          File, isImport,
+          SourceMgr.isFileOverridden(File) ? 0 : &Identifiers)) {
     if (Callbacks)
       Callbacks->FileSkipped(*File, FilenameTok, FileCharacter);
     return;
@@ -1610,6 +1617,8 @@ void Preprocessor::HandleIncludeDirective(SourceLocation HashLoc,
   // position on the file where it will be included and after the expansions.
   if (IncludePos.isMacroID())
     IncludePos = SourceMgr.getExpansionRange(IncludePos).second;
+  if (Prefetcher)
+    Prefetcher->provideContents(File);
   FileID FID = SourceMgr.createFileID(File, IncludePos, FileCharacter);
   assert(!FID.isInvalid() && "Expected valid file ID");
 
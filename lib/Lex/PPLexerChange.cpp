@@ -15,9 +15,13 @@
 #include "clang/Lex/Preprocessor.h"
 #include "clang/Basic/FileManager.h"
 #include "clang/Basic/SourceManager.h"
+#include "clang/Basic/TimeTrace.h"
+#include "clang/Lex/DependencyDirectives.h"
 #include "clang/Lex/HeaderSearch.h"
+#include "clang/Lex/IncludePrefetcher.h"
 #include "clang/Lex/LexDiagnostic.h"
 #include "clang/Lex/MacroInfo.h"
+#include "clang/Lex/PreprocessorOptions.h"
 #include "llvm/ADT/StringSwitch.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
@@ -66,6 +70,32 @@ PreprocessorLexer *Preprocessor::getCurrentFileLexer() const {
 // Methods for Entering and Callbacks for leaving various contexts
 //===----------------------------------------------------------------------===//
 
+/// minimizeForDependencyScan - Replace the contents of the file with only the
+/// directives that affect its dependencies.  The replacement is stored in the
+/// SourceManager, so every later inclusion of the file reuses it.
+static void minimizeForDependencyScan(SourceManager &SM, FileID FID,
+                                      const LangOptions &LangOpts) {
+  const FileEntry *FE = SM.getFileEntryForID(FID);
+  // Leave buffers without a file, remapped files, and files that have
+  // already been minimized alone.
+  if (!FE || SM.isFileOverridden(FE))
+    return;
+
+  bool Invalid = false;
+  const llvm::MemoryBuffer *Buffer = SM.getBuffer(FID, &Invalid);
+  if (Invalid)
+    return;
+
+  SmallString<1024> Minimized;
+  if (!minimizeSourceToDependencyDirectives(Buffer->getBuffer(), LangOpts,
+                                            Minimized))
+    return;
+
+  SM.overrideFileContents(FE,
+      llvm::MemoryBuffer::getMemBufferCopy(Minimized,
+                                           Buffer->getBufferIdentifier()));
+}
+
 /// EnterSourceFile - Add a source file to the top of the include stack and
 /// start lexing tokens from it instead of the current buffer.
 void Preprocessor::EnterSourceFile(FileID FID, const DirectoryLookup *CurDir,
@@ -82,6 +112,9 @@ void Preprocessor::EnterSourceFile(FileID FID, const DirectoryLookup *CurDir,
       return;
     }
   }
+
+  if (PPOpts->DependencyDirectivesOnly)
+    minimizeForDependencyScan(SourceMgr, FID, LangOpts);
   
   // Get the MemoryBuffer for this FID, if it fails, we fail.
   bool Invalid = false;
@@ -94,6 +127,13 @@ void Preprocessor::EnterSourceFile(FileID FID, const DirectoryLookup *CurDir,
     return;
   }
 
+  // A virtual file system answers without waiting on a disk.
+  if (PPOpts->PrefetchIncludes && !FileMgr.getVirtualFileSystem()) {
+    if (!Prefetcher)
+      Prefetcher.reset(new IncludePrefetcher(SourceMgr, HeaderInfo));
+    Prefetcher->scanFile(SourceMgr.getFileEntryForID(FID), InputFile);
+  }
+
   if (isCodeCompletionEnabled() &&
       SourceMgr.getFileEntryForID(FID) == CodeCompletionFile) {
     CodeCompletionFileLoc = SourceMgr.getLocForStartOfFile(FID);
@@ -105,14 +145,25 @@ void Preprocessor::EnterSourceFile(FileID FID, const DirectoryLookup *CurDir,
   return;
 }
 
+/// \brief Begin the time-trace scope of a file entered from another one; it
+/// ends when HandleEndOfFile pops the file off the include stack.
+static void beginIncludeTrace(SourceManager &SM, FileID FID) {
+  if (TimeTrace::isEnabled())
+    TimeTrace::begin("Include", SM.getBufferName(SM.getLocForStartOfFile(FID)),
+                     TimeTrace::IncludeTrack);
+}
+
 /// EnterSourceFileWithLexer - Add a source file to the top of the include stack
 ///  and start lexing tokens from it instead of the current buffer.
 void Preprocessor::EnterSourceFileWithLexer(Lexer *TheLexer,
                                             const DirectoryLookup *CurDir) {
 
   // Add the current lexer to the include stack.
-  if (CurPPLexer || CurTokenLexer)
+  if (CurPPLexer || CurTokenLexer) {
     PushIncludeMacroStack();
+    if (!TheLexer->Is_PragmaLexer)
+      beginIncludeTrace(SourceMgr, TheLexer->getFileID());
+  }
 
   CurLexer.reset(TheLexer);
   CurPPLexer = TheLexer;
@@ -135,8 +186,10 @@ void Preprocessor::EnterSourceFileWithLexer(Lexer *TheLexer,
 void Preprocessor::EnterSourceFileWithPTH(PTHLexer *PL,
                                           const DirectoryLookup *CurDir) {
 
-  if (CurPPLexer || CurTokenLexer)
+  if (CurPPLexer || CurTokenLexer) {
     PushIncludeMacroStack();
+    beginIncludeTrace(SourceMgr, PL->getFileID());
+  }
 
   CurDirLookup = CurDir;
   CurPTHLexer.reset(PL);
@@ -246,6 +299,10 @@ bool Preprocessor::HandleEndOfFile(Token &Result, bool isEndOfMacro) {
       if (const FileEntry *FE =
             SourceMgr.getFileEntryForID(CurPPLexer->getFileID())) {
         HeaderInfo.SetFileControllingMacro(FE, ControllingMacro);
+        // Remember the guard for later compilations too, unless the contents
+        // we lexed are not the ones on disk.
+        if (!SourceMgr.isFileOverridden(FE))
+          FileMgr.setCachedControllingMacro(FE, ControllingMacro->getName());
         if (const IdentifierInfo *DefinedMacro =
               CurPPLexer->MIOpt.GetDefinedMacro()) {
           if (!ControllingMacro->hasMacroDefinition() &&
@@ -314,12 +371,19 @@ bool Preprocessor::HandleEndOfFile(Token &Result, bool isEndOfMacro) {
     }
 
     FileID ExitedFID;
-    if (Callbacks && !isEndOfMacro && CurPPLexer)
+    if ((Callbacks || PPOpts->ReleaseFinishedFiles) && !isEndOfMacro &&
+        CurPPLexer)
       ExitedFID = CurPPLexer->getFileID();
     
+    if (!isEndOfMacro && CurPPLexer && !(CurLexer && CurLexer->Is_PragmaLexer))
+      TimeTrace::end(TimeTrace::IncludeTrack);
+
     // We're done with the #included file.
     RemoveTopOfLexerStack();
 
+    if (PPOpts->ReleaseFinishedFiles && !ExitedFID.isInvalid())
+      SourceMgr.releaseFileContents(ExitedFID);
+
     // Notify the client, if desired, that we are in a new source file.
     if (Callbacks && !isEndOfMacro && CurPPLexer) {
       SrcMgr::CharacteristicKind FileType =
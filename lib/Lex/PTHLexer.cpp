@@ -22,8 +22,10 @@
 #include "clang/Lex/Preprocessor.h"
 #include "clang/Lex/Token.h"
 #include "llvm/ADT/OwningPtr.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/StringMap.h"
+#include "llvm/Support/MD5.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/system_error.h"
 using namespace clang;
@@ -307,12 +309,14 @@ namespace {
 class PTHFileData {
   const uint32_t TokenOff;
   const uint32_t PPCondOff;
+  const uint64_t ContentHash;
 public:
-  PTHFileData(uint32_t tokenOff, uint32_t ppCondOff)
-    : TokenOff(tokenOff), PPCondOff(ppCondOff) {}
+  PTHFileData(uint32_t tokenOff, uint32_t ppCondOff, uint64_t contentHash)
+    : TokenOff(tokenOff), PPCondOff(ppCondOff), ContentHash(contentHash) {}
 
   uint32_t getTokenOffset() const { return TokenOff; }
   uint32_t getPPCondOffset() const { return PPCondOff; }
+  uint64_t getContentHash() const { return ContentHash; }
 };
 
 
@@ -355,7 +359,9 @@ public:
     assert(k.first == 0x1 && "Only file lookups can match!");
     uint32_t x = ::ReadUnalignedLE32(d);
     uint32_t y = ::ReadUnalignedLE32(d);
-    return PTHFileData(x, y);
+    d += 8 * 4; // Skip the stat information.
+    uint64_t hash = ::ReadUnalignedLE64(d);
+    return PTHFileData(x, y, hash);
   }
 };
 
@@ -431,8 +437,37 @@ static void InvalidPTH(DiagnosticsEngine &Diags, const char *Msg) {
   Diags.Report(Diags.getCustomDiagID(DiagnosticsEngine::Error, Msg));
 }
 
+uint32_t PTHManager::getLangOptsSignature(const LangOptions &LangOpts) {
+  // These are the options that change how the Lexer splits a buffer into
+  // tokens.
+  const bool Bits[] = {
+    LangOpts.AsmPreprocessor, LangOpts.C99, LangOpts.C11, LangOpts.CPlusPlus,
+    LangOpts.CPlusPlus11, LangOpts.CPlusPlus1y, LangOpts.CUDA,
+    LangOpts.Digraphs, LangOpts.DollarIdents, LangOpts.LineComment,
+    LangOpts.MicrosoftExt, LangOpts.ObjC1, LangOpts.TraditionalCPP,
+    LangOpts.Trigraphs
+  };
+  uint32_t Signature = 0;
+  for (unsigned I = 0, E = llvm::array_lengthof(Bits); I != E; ++I)
+    Signature |= uint32_t(Bits[I]) << I;
+  return Signature;
+}
+
+uint64_t PTHManager::getContentHash(StringRef Contents) {
+  llvm::MD5 Hash;
+  Hash.update(Contents);
+  llvm::MD5::MD5Result Result;
+  Hash.final(Result);
+
+  uint64_t Value = 0;
+  for (unsigned I = 0; I != 8; ++I)
+    Value |= uint64_t(Result[I]) << (I * 8);
+  return Value;
+}
+
 PTHManager *PTHManager::Create(const std::string &file,
-                               DiagnosticsEngine &Diags) {
+                               DiagnosticsEngine &Diags,
+                               const LangOptions &LangOpts) {
   // Memory map the PTH file.
   OwningPtr<llvm::MemoryBuffer> File;
 
@@ -458,7 +493,7 @@ PTHManager *PTHManager::Create(const std::string &file,
   const unsigned char *p = BufBeg + (sizeof("cfe-pth"));
   unsigned Version = ReadLE32(p);
 
-  if (Version < PTHManager::Version) {
+  if (Version != PTHManager::Version) {
     InvalidPTH(Diags,
         Version < PTHManager::Version
         ? "PTH file uses an older PTH format that is no longer supported"
@@ -469,11 +504,18 @@ PTHManager *PTHManager::Create(const std::string &file,
   // Compute the address of the index table at the end of the PTH file.
   const unsigned char *PrologueOffset = p;
 
-  if (PrologueOffset >= BufEnd) {
+  if (PrologueOffset + sizeof(uint32_t)*5 >= BufEnd) {
     Diags.Report(diag::err_invalid_pth_file) << file;
     return 0;
   }
 
+  // Tokens lexed under different language options can't be reused.
+  const unsigned char* SignatureOffset = PrologueOffset + sizeof(uint32_t)*4;
+  if (ReadLE32(SignatureOffset) != getLangOptsSignature(LangOpts)) {
+    InvalidPTH(Diags, "PTH file was generated with different language options");
+    return 0;
+  }
+
   // Construct the file lookup table.  This will be used for mapping from
   // FileEntry*'s to cached tokens.
   const unsigned char* FileTableOffset = PrologueOffset + sizeof(uint32_t)*2;
@@ -538,7 +580,7 @@ PTHManager *PTHManager::Create(const std::string &file,
   }
 
   // Compute the address of the original source file.
-  const unsigned char* originalSourceBase = PrologueOffset + sizeof(uint32_t)*4;
+  const unsigned char* originalSourceBase = PrologueOffset + sizeof(uint32_t)*5;
   unsigned len = ReadUnalignedLE16(originalSourceBase);
   if (!len) originalSourceBase = 0;
 
@@ -599,6 +641,15 @@ PTHLexer *PTHManager::CreateLexer(FileID FID) {
 
   const PTHFileData& FileData = *I;
 
+  // Only use the cached tokens if the file is unchanged since they were
+  // generated.  Otherwise the caller falls back to lexing the file.
+  bool Invalid = false;
+  const llvm::MemoryBuffer *Contents =
+    PP->getSourceManager().getBuffer(FID, &Invalid);
+  if (Invalid ||
+      getContentHash(Contents->getBuffer()) != FileData.getContentHash())
+    return 0;
+
   const unsigned char *BufStart = (const unsigned char *)Buf->getBufferStart();
   // Compute the offset of the token data within the buffer.
   const unsigned char* data = BufStart + FileData.getTokenOffset();
@@ -63,13 +63,9 @@ PreprocessingRecord::getPreprocessedEntitiesInRange(SourceRange Range) {
   return std::make_pair(iterator(this, Res.first), iterator(this, Res.second));
 }
 
-static bool isPreprocessedEntityIfInFileID(PreprocessedEntity *PPE, FileID FID,
-                                           SourceManager &SM) {
+static bool isLocationInFileID(SourceLocation Loc, FileID FID,
+                               SourceManager &SM) {
   assert(!FID.isInvalid());
-  if (!PPE)
-    return false;
-
-  SourceLocation Loc = PPE->getSourceRange().getBegin();
   if (Loc.isInvalid())
     return false;
   
@@ -79,6 +75,13 @@ static bool isPreprocessedEntityIfInFileID(PreprocessedEntity *PPE, FileID FID,
     return false;
 }
 
+static bool isPreprocessedEntityIfInFileID(PreprocessedEntity *PPE, FileID FID,
+                                           SourceManager &SM) {
+  if (!PPE)
+    return false;
+  return isLocationInFileID(PPE->getSourceRange().getBegin(), FID, SM);
+}
+
 /// \brief Returns true if the preprocessed entity that \arg PPEI iterator
 /// points to is coming from the file \arg FID.
 ///
@@ -119,8 +122,7 @@ bool PreprocessingRecord::isEntityInFileID(iterator PPEI, FileID FID) {
     assert(0 && "Out-of bounds local preprocessed entity");
     return false;
   }
-  return isPreprocessedEntityIfInFileID(PreprocessedEntities[Pos],
-                                        FID, SourceMgr);
+  return isLocationInFileID(PreprocessedEntities[Pos].Begin, FID, SourceMgr);
 }
 
 /// \brief Returns a pair of [Begin, End) iterators of preprocessed entities
@@ -167,38 +169,24 @@ PreprocessingRecord::findLocalPreprocessedEntitiesInRange(
   return std::make_pair(Begin, End);
 }
 
-namespace {
-
-template <SourceLocation (SourceRange::*getRangeLoc)() const>
-struct PPEntityComp {
+struct PreprocessingRecord::PPEntityComp {
   const SourceManager &SM;
 
   explicit PPEntityComp(const SourceManager &SM) : SM(SM) { }
 
-  bool operator()(PreprocessedEntity *L, PreprocessedEntity *R) const {
-    SourceLocation LHS = getLoc(L);
-    SourceLocation RHS = getLoc(R);
-    return SM.isBeforeInTranslationUnit(LHS, RHS);
-  }
-
-  bool operator()(PreprocessedEntity *L, SourceLocation RHS) const {
-    SourceLocation LHS = getLoc(L);
-    return SM.isBeforeInTranslationUnit(LHS, RHS);
+  bool operator()(const LocalEntity &L, const LocalEntity &R) const {
+    return SM.isBeforeInTranslationUnit(L.Begin, R.Begin);
   }
 
-  bool operator()(SourceLocation LHS, PreprocessedEntity *R) const {
-    SourceLocation RHS = getLoc(R);
-    return SM.isBeforeInTranslationUnit(LHS, RHS);
+  bool operator()(const LocalEntity &L, SourceLocation RHS) const {
+    return SM.isBeforeInTranslationUnit(L.Begin, RHS);
   }
 
-  SourceLocation getLoc(PreprocessedEntity *PPE) const {
-    SourceRange Range = PPE->getSourceRange();
-    return (Range.*getRangeLoc)();
+  bool operator()(SourceLocation LHS, const LocalEntity &R) const {
+    return SM.isBeforeInTranslationUnit(LHS, R.Begin);
   }
 };
 
-}
-
 unsigned PreprocessingRecord::findBeginLocalPreprocessedEntity(
                                                      SourceLocation Loc) const {
   if (SourceMgr.isLoadedSourceLocation(Loc))
@@ -206,9 +194,8 @@ unsigned PreprocessingRecord::findBeginLocalPreprocessedEntity(
 
   size_t Count = PreprocessedEntities.size();
   size_t Half;
-  std::vector<PreprocessedEntity *>::const_iterator
-    First = PreprocessedEntities.begin();
-  std::vector<PreprocessedEntity *>::const_iterator I;
+  std::vector<LocalEntity>::const_iterator First = PreprocessedEntities.begin();
+  std::vector<LocalEntity>::const_iterator I;
 
   // Do a binary search manually instead of using std::lower_bound because
   // The end locations of entities may be unordered (when a macro expansion
@@ -218,8 +205,7 @@ unsigned PreprocessingRecord::findBeginLocalPreprocessedEntity(
     Half = Count/2;
     I = First;
     std::advance(I, Half);
-    if (SourceMgr.isBeforeInTranslationUnit((*I)->getSourceRange().getEnd(),
-                                            Loc)){
+    if (SourceMgr.isBeforeInTranslationUnit(I->End, Loc)) {
       First = I;
       ++First;
       Count = Count - Half - 1;
@@ -235,23 +221,34 @@ unsigned PreprocessingRecord::findEndLocalPreprocessedEntity(
   if (SourceMgr.isLoadedSourceLocation(Loc))
     return 0;
 
-  std::vector<PreprocessedEntity *>::const_iterator
+  std::vector<LocalEntity>::const_iterator
   I = std::upper_bound(PreprocessedEntities.begin(),
                        PreprocessedEntities.end(),
                        Loc,
-                       PPEntityComp<&SourceRange::getBegin>(SourceMgr));
+                       PPEntityComp(SourceMgr));
   return I - PreprocessedEntities.begin();
 }
 
 PreprocessingRecord::PPEntityID
 PreprocessingRecord::addPreprocessedEntity(PreprocessedEntity *Entity) {
   assert(Entity);
-  SourceLocation BeginLoc = Entity->getSourceRange().getBegin();
+  LocalEntity Local;
+  Local.Begin = Entity->getSourceRange().getBegin();
+  Local.End = Entity->getSourceRange().getEnd();
+  Local.Ref = LocalEntityObjects.size();
+  LocalEntityObjects.push_back(Entity);
+  return addLocalEntity(Local, isa<MacroDefinition>(Entity));
+}
 
-  if (isa<MacroDefinition>(Entity)) {
+PreprocessingRecord::PPEntityID
+PreprocessingRecord::addLocalEntity(const LocalEntity &Entity,
+                                    bool IsMacroDefinition) {
+  SourceLocation BeginLoc = Entity.Begin;
+
+  if (IsMacroDefinition) {
     assert((PreprocessedEntities.empty() ||
             !SourceMgr.isBeforeInTranslationUnit(BeginLoc,
-                   PreprocessedEntities.back()->getSourceRange().getBegin())) &&
+                   PreprocessedEntities.back().Begin)) &&
            "a macro definition was encountered out-of-order");
     PreprocessedEntities.push_back(Entity);
     return getPPEntityID(PreprocessedEntities.size()-1, /*isLoaded=*/false);
@@ -260,7 +257,7 @@ PreprocessingRecord::addPreprocessedEntity(PreprocessedEntity *Entity) {
   // Check normal case, this entity begin location is after the previous one.
   if (PreprocessedEntities.empty() ||
       !SourceMgr.isBeforeInTranslationUnit(BeginLoc,
-                   PreprocessedEntities.back()->getSourceRange().getBegin())) {
+                   PreprocessedEntities.back().Begin)) {
     PreprocessedEntities.push_back(Entity);
     return getPPEntityID(PreprocessedEntities.size()-1, /*isLoaded=*/false);
   }
@@ -277,7 +274,7 @@ PreprocessingRecord::addPreprocessedEntity(PreprocessedEntity *Entity) {
   //  FM(M1, M2)
   // \endcode
 
-  typedef std::vector<PreprocessedEntity *>::iterator pp_iter;
+  typedef std::vector<LocalEntity>::iterator pp_iter;
 
   // Usually there are few macro expansions when defining the filename, do a
   // linear search for a few entities.
@@ -287,8 +284,7 @@ PreprocessingRecord::addPreprocessedEntity(PreprocessedEntity *Entity) {
        RI != Begin && count < 4; --RI, ++count) {
     pp_iter I = RI;
     --I;
-    if (!SourceMgr.isBeforeInTranslationUnit(BeginLoc,
-                                           (*I)->getSourceRange().getBegin())) {
+    if (!SourceMgr.isBeforeInTranslationUnit(BeginLoc, I->Begin)) {
       pp_iter insertI = PreprocessedEntities.insert(RI, Entity);
       return getPPEntityID(insertI - PreprocessedEntities.begin(),
                            /*isLoaded=*/false);
@@ -299,7 +295,7 @@ PreprocessingRecord::addPreprocessedEntity(PreprocessedEntity *Entity) {
   pp_iter I = std::upper_bound(PreprocessedEntities.begin(),
                                PreprocessedEntities.end(),
                                BeginLoc,
-                               PPEntityComp<&SourceRange::getBegin>(SourceMgr));
+                               PPEntityComp(SourceMgr));
   pp_iter insertI = PreprocessedEntities.insert(I, Entity);
   return getPPEntityID(insertI - PreprocessedEntities.begin(),
                        /*isLoaded=*/false);
@@ -338,7 +334,27 @@ PreprocessedEntity *PreprocessingRecord::getPreprocessedEntity(PPEntityID PPID){
   unsigned Index = PPID.ID - 1;
   assert(Index < PreprocessedEntities.size() &&
          "Out-of bounds local preprocessed entity");
-  return PreprocessedEntities[Index];
+  return getLocalPreprocessedEntity(Index);
+}
+
+/// \brief Retrieve the local preprocessed entity at the given index.
+PreprocessedEntity *
+PreprocessingRecord::getLocalPreprocessedEntity(unsigned Index) {
+  LocalEntity &Local = PreprocessedEntities[Index];
+  if (Local.Ref & DeferredExpansionBit) {
+    ExpansionDefinition Def
+      = ExpansionDefinitions[Local.Ref & ~DeferredExpansionBit];
+    SourceRange Range(Local.Begin, Local.End);
+    MacroExpansion *Expansion;
+    if (MacroDefinition *MD = Def.dyn_cast<MacroDefinition *>())
+      Expansion = new (*this) MacroExpansion(MD, Range);
+    else
+      Expansion = new (*this) MacroExpansion(Def.get<IdentifierInfo *>(),
+                                             Range);
+    Local.Ref = LocalEntityObjects.size();
+    LocalEntityObjects.push_back(Expansion);
+  }
+  return LocalEntityObjects[Local.Ref];
 }
 
 /// \brief Retrieve the loaded preprocessed entity at the given index.
@@ -373,12 +389,27 @@ void PreprocessingRecord::addMacroExpansion(const Token &Id,
   if (Id.getLocation().isMacroID())
     return;
 
+  ExpansionDefinition Def;
   if (MI->isBuiltinMacro())
-    addPreprocessedEntity(
-                      new (*this) MacroExpansion(Id.getIdentifierInfo(),Range));
-  else if (MacroDefinition *Def = findMacroDefinition(MI))
-    addPreprocessedEntity(
-                       new (*this) MacroExpansion(Def, Range));
+    Def = Id.getIdentifierInfo();
+  else if (MacroDefinition *MD = findMacroDefinition(MI))
+    Def = MD;
+  else
+    return;
+
+  // Don't create the MacroExpansion until it is asked for; just remember the
+  // range and the definition.
+  std::pair<llvm::DenseMap<void *, unsigned>::iterator, bool> Known
+    = ExpansionDefinitionIndices.insert(
+        std::make_pair(Def.getOpaqueValue(), ExpansionDefinitions.size()));
+  if (Known.second)
+    ExpansionDefinitions.push_back(Def);
+
+  LocalEntity Local;
+  Local.Begin = Range.getBegin();
+  Local.End = Range.getEnd();
+  Local.Ref = Known.first->second | DeferredExpansionBit;
+  addLocalEntity(Local, /*IsMacroDefinition=*/false);
 }
 
 void PreprocessingRecord::Ifdef(SourceLocation Loc, const Token &MacroNameTok,
@@ -482,5 +513,8 @@ size_t PreprocessingRecord::getTotalMemory() const {
   return BumpAlloc.getTotalMemory()
     + llvm::capacity_in_bytes(MacroDefinitions)
     + llvm::capacity_in_bytes(PreprocessedEntities)
+    + llvm::capacity_in_bytes(LocalEntityObjects)
+    + llvm::capacity_in_bytes(ExpansionDefinitions)
+    + llvm::capacity_in_bytes(ExpansionDefinitionIndices)
     + llvm::capacity_in_bytes(LoadedPreprocessedEntities);
 }
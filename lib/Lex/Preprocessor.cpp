@@ -33,6 +33,7 @@
 #include "clang/Lex/CodeCompletionHandler.h"
 #include "clang/Lex/ExternalPreprocessorSource.h"
 #include "clang/Lex/HeaderSearch.h"
+#include "clang/Lex/IncludePrefetcher.h"
 #include "clang/Lex/LexDiagnostic.h"
 #include "clang/Lex/LiteralSupport.h"
 #include "clang/Lex/MacroInfo.h"
@@ -81,7 +82,7 @@ Preprocessor::Preprocessor(IntrusiveRefCntPtr<PreprocessorOptions> PPOpts,
   NumMacroExpanded = NumFnMacroExpanded = NumBuiltinMacroExpanded = 0;
   NumFastMacroExpanded = NumTokenPaste = NumFastTokenPaste = 0;
   MaxIncludeStackDepth = 0;
-  NumSkipped = 0;
+  NumSkipped = NumSkippedBytes = 0;
   
   // Default to discarding comments.
   KeepComments = false;
@@ -140,6 +141,9 @@ Preprocessor::Preprocessor(IntrusiveRefCntPtr<PreprocessorOptions> PPOpts,
 Preprocessor::~Preprocessor() {
   assert(BacktrackPositions.empty() && "EnableBacktrack/Backtrack imbalance!");
 
+  // Stop reading files ahead of time.
+  Prefetcher.reset();
+
   while (!IncludeMacroStack.empty()) {
     delete IncludeMacroStack.back().TheLexer;
     delete IncludeMacroStack.back().TheTokenLexer;
@@ -238,7 +242,8 @@ void Preprocessor::PrintStats() {
   llvm::errs() << "  " << NumElse << " #else/#elif.\n";
   llvm::errs() << "  " << NumEndif << " #endif.\n";
   llvm::errs() << "  " << NumPragma << " #pragma.\n";
-  llvm::errs() << NumSkipped << " #if/#ifndef#ifdef regions skipped\n";
+  llvm::errs() << NumSkipped << " #if/#ifndef#ifdef regions skipped, "
+             << NumSkippedBytes << " bytes of them without lexing.\n";
 
   llvm::errs() << NumMacroExpanded << "/" << NumFnMacroExpanded << "/"
              << NumBuiltinMacroExpanded << " obj/fn/builtin macros expanded, "
@@ -283,6 +288,37 @@ size_t Preprocessor::getTotalMemory() const {
     + llvm::capacity_in_bytes(CommentHandlers);
 }
 
+/// \brief The bytes taken by \p MI outside of itself.
+static size_t getMacroInfoExtraMemory(const MacroInfo &MI) {
+  size_t Bytes = MI.getNumArgs() * sizeof(IdentifierInfo *);
+  // The replacement tokens are stored in the MacroInfo until there are more
+  // of them than fit there.
+  if (MI.getNumTokens() > 8)
+    Bytes += MI.getNumTokens() * sizeof(Token);
+  return Bytes;
+}
+
+size_t Preprocessor::getMacroInfoMemory(unsigned &NumMacroInfos) const {
+  size_t Bytes = 0;
+  NumMacroInfos = 0;
+  for (MacroInfoChain *I = MIChainHead; I; I = I->Next) {
+    Bytes += sizeof(MacroInfoChain) + getMacroInfoExtraMemory(I->MI);
+    ++NumMacroInfos;
+  }
+  for (DeserializedMacroInfoChain *I = DeserialMIChainHead; I; I = I->Next) {
+    Bytes += sizeof(DeserializedMacroInfoChain) +
+             getMacroInfoExtraMemory(I->MI);
+    ++NumMacroInfos;
+  }
+  return Bytes;
+}
+
+size_t Preprocessor::getTokenLexerCacheMemory() const {
+  return NumCachedTokenLexers * sizeof(TokenLexer)
+    + llvm::capacity_in_bytes(MacroExpandedTokens)
+    + llvm::capacity_in_bytes(MacroExpandingLexersStack);
+}
+
 Preprocessor::macro_iterator
 Preprocessor::macro_end(bool IncludeExternalMacros) const {
   if (IncludeExternalMacros && ExternalSource &&
@@ -266,11 +266,11 @@ void TokenLexer::ExpandFunctionArguments() {
 
       // Only preexpand the argument if it could possibly need it.  This
       // avoids some work in common cases.
-      const Token *ArgTok = ActualArgs->getUnexpArgument(ArgNo);
-      if (ActualArgs->ArgNeedsPreexpansion(ArgTok, PP))
+      if (ActualArgs->ArgNeedsPreexpansion(ArgNo, PP))
         ResultArgToks = &ActualArgs->getPreExpArgument(ArgNo, Macro, PP)[0];
       else
-        ResultArgToks = ArgTok;  // Use non-preexpanded tokens.
+        // Use non-preexpanded tokens.
+        ResultArgToks = ActualArgs->getUnexpArgument(ArgNo);
 
       // If the arg token expanded into anything, append it.
       if (ResultArgToks->isNot(tok::eof)) {
@@ -17,6 +17,7 @@
 #include "clang/AST/DeclCXX.h"
 #include "clang/AST/ExternalASTSource.h"
 #include "clang/AST/Stmt.h"
+#include "clang/Basic/TimeTrace.h"
 #include "clang/Parse/ParseDiagnostic.h"
 #include "clang/Parse/Parser.h"
 #include "clang/Sema/CodeCompleteConsumer.h"
@@ -96,7 +97,35 @@ void clang::ParseAST(Preprocessor &PP, ASTConsumer *Consumer,
   ParseAST(*S.get(), PrintStats, SkipFunctionBodies);
 }
 
+/// \brief Name the declarations of \p DG in the time trace.
+static void setTimeTraceDetail(TimeTraceScope &Scope, DeclGroupRef DG) {
+  if (!Scope.isActive() || DG.isNull())
+    return;
+  if (NamedDecl *ND = dyn_cast<NamedDecl>(*DG.begin()))
+    Scope.setDetail(ND->getQualifiedNameAsString());
+}
+
+/// \brief Parse the next top-level declaration, recording the time it takes
+/// in the time trace.
+static bool ParseTopLevelDecl(Parser &P, Parser::DeclGroupPtrTy &ADecl) {
+  TimeTraceScope Scope("ParseTopLevelDecl");
+  bool AtEOF = P.ParseTopLevelDecl(ADecl);
+  if (ADecl)
+    setTimeTraceDetail(Scope, ADecl.get());
+  return AtEOF;
+}
+
+/// \brief Pass a top-level declaration to the consumer, recording the time it
+/// takes in the time trace.
+static bool HandleTopLevelDecl(ASTConsumer *Consumer, DeclGroupRef DG) {
+  TimeTraceScope Scope("HandleTopLevelDecl");
+  setTimeTraceDetail(Scope, DG);
+  return Consumer->HandleTopLevelDecl(DG);
+}
+
 void clang::ParseAST(Sema &S, bool PrintStats, bool SkipFunctionBodies) {
+  TimeTraceScope TimeScope("ParseAST");
+
   // Collect global stats on Decls/Stmts (until we have a module streamer).
   if (PrintStats) {
     Decl::EnableStatistics();
@@ -131,7 +160,7 @@ void clang::ParseAST(Sema &S, bool PrintStats, bool SkipFunctionBodies) {
   if (External)
     External->StartTranslationUnit(Consumer);
 
-  if (P.ParseTopLevelDecl(ADecl)) {
+  if (ParseTopLevelDecl(P, ADecl)) {
     if (!External && !S.getLangOpts().CPlusPlus)
       P.Diag(diag::ext_empty_translation_unit);
   } else {
@@ -139,9 +168,9 @@ void clang::ParseAST(Sema &S, bool PrintStats, bool SkipFunctionBodies) {
       // If we got a null return and something *was* parsed, ignore it.  This
       // is due to a top-level semicolon, an action override, or a parse error
       // skipping something.
-      if (ADecl && !Consumer->HandleTopLevelDecl(ADecl.get()))
+      if (ADecl && !HandleTopLevelDecl(Consumer, ADecl.get()))
         return;
-    } while (!P.ParseTopLevelDecl(ADecl));
+    } while (!ParseTopLevelDecl(P, ADecl));
   }
 
   // Process any TopLevelDecls generated by #pragma weak.
@@ -150,7 +179,10 @@ void clang::ParseAST(Sema &S, bool PrintStats, bool SkipFunctionBodies) {
        E = S.WeakTopLevelDecls().end(); I != E; ++I)
     Consumer->HandleTopLevelDecl(DeclGroupRef(*I));
   
-  Consumer->HandleTranslationUnit(S.getASTContext());
+  {
+    TimeTraceScope Scope("HandleTranslationUnit");
+    Consumer->HandleTranslationUnit(S.getASTContext());
+  }
 
   std::swap(OldCollectStats, S.CollectStats);
   if (PrintStats) {
@@ -13,6 +13,7 @@
 
 #include "clang/Parse/Parser.h"
 #include "RAIIObjectsForParser.h"
+#include "clang/AST/Attr.h"
 #include "clang/AST/DeclTemplate.h"
 #include "clang/Parse/ParseDiagnostic.h"
 #include "clang/Sema/DeclSpec.h"
@@ -26,6 +27,32 @@ static FunctionDecl *getFunctionDecl(Decl *D) {
   return cast<FunctionTemplateDecl>(D)->getTemplatedDecl();
 }
 
+/// \brief Whether the body of the inline member function FD, declared by D,
+/// can be left unparsed until the end of the translation unit.
+bool Parser::canDelayInlineMethodParsing(const ParsingDeclarator &D,
+                                         const ParsedTemplateInfo &TemplateInfo,
+                                         const FunctionDecl *FD) {
+  if (!getLangOpts().DelayedInlineMethodParsing ||
+      PP.isCodeCompletionEnabled() || PP.isIncrementalProcessingEnabled())
+    return false;
+
+  // Templates are instantiated from their bodies, and the bodies of local
+  // classes need the scope of the enclosing function.
+  if (TemplateInfo.Kind != ParsedTemplateInfo::NonTemplate ||
+      Actions.CurContext->isDependentContext())
+    return false;
+  const CXXRecordDecl *RD = dyn_cast<CXXRecordDecl>(Actions.CurContext);
+  if (!RD || RD->isLocalClass())
+    return false;
+
+  // Friends are not members, the bodies of constexpr functions are needed
+  // by constant expressions, and a deduced return type is needed as soon
+  // as the function is called.  Used functions are always emitted.
+  const DeclSpec &DS = D.getDeclSpec();
+  return !DS.isFriendSpecified() && !DS.isConstexprSpecified() &&
+         !FD->getResultType()->isUndeducedType() && !FD->hasAttr<UsedAttr>();
+}
+
 /// ParseCXXInlineMethodDef - We parsed and verified that the specified
 /// Declarator is a well formed C++ inline method definition. Now lex its body
 /// and store its tokens for parsing after the C++ class is complete.
@@ -137,6 +164,22 @@ NamedDecl *Parser::ParseCXXInlineMethodDef(AccessSpecifier AS,
     return FnD;
   }
 
+  // In delayed inline method parsing mode, store the tokens of the body for
+  // parsing at the end of the translation unit, where they are only parsed
+  // if the method turned out to be used.
+  if (FnD && DefinitionKind == FDK_Definition &&
+      canDelayInlineMethodParsing(D, TemplateInfo, getFunctionDecl(FnD))) {
+    LateParsedTemplatedFunction *LPT = new LateParsedTemplatedFunction(FnD);
+
+    FunctionDecl *FD = getFunctionDecl(FnD);
+    Actions.CheckForFunctionRedefinition(FD);
+
+    LateParsedTemplateMap[FD] = LPT;
+    Actions.MarkAsLateParsedInlineMethod(FD);
+    LexTemplateFunctionForLateParsing(LPT->Toks);
+    return FnD;
+  }
+
   // Consume the tokens and store them for later parsing.
 
   LexedMethod* LM = new LexedMethod(this, FnD);
@@ -15,6 +15,7 @@
 #include "clang/Lex/Preprocessor.h"
 #include "clang/Parse/ParseDiagnostic.h"
 #include "clang/Parse/Parser.h"
+#include "clang/Sema/LoopHint.h"
 #include "clang/Sema/Scope.h"
 #include "llvm/ADT/StringSwitch.h"
 using namespace clang;
@@ -151,6 +152,38 @@ StmtResult Parser::HandlePragmaCaptured()
   return Actions.ActOnCapturedRegionEnd(R.get());
 }
 
+namespace {
+  /// \brief The tokens of one 'option(value)' hint of a #pragma clang loop.
+  struct PragmaLoopHintInfo {
+    Token Option;
+    Token Value;
+    Token RParen;
+  };
+}
+
+LoopHint Parser::HandlePragmaLoopHint() {
+  assert(Tok.is(tok::annot_pragma_loop_hint));
+  PragmaLoopHintInfo *Info =
+    static_cast<PragmaLoopHintInfo *>(Tok.getAnnotationValue());
+
+  LoopHint Hint;
+  Hint.Range = SourceRange(Info->Option.getLocation(),
+                           Info->RParen.getLocation());
+  Hint.Option = Info->Option.getIdentifierInfo();
+  Hint.OptionLoc = Info->Option.getLocation();
+  Hint.ValueLoc = Info->Value.getLocation();
+  if (Info->Value.is(tok::numeric_constant)) {
+    ExprResult Value = Actions.ActOnNumericConstant(Info->Value);
+    if (!Value.isInvalid())
+      Hint.ValueExpr = Value.take();
+  } else {
+    Hint.ValueIdent = Info->Value.getIdentifierInfo();
+  }
+
+  ConsumeToken(); // The annotation token.
+  return Hint;
+}
+
 namespace {
   typedef llvm::PointerIntPair<IdentifierInfo *, 1, bool> OpenCLExtData;
 }
@@ -749,6 +782,94 @@ PragmaOpenCLExtensionHandler::HandlePragma(Preprocessor &PP,
                       /*OwnsTokens=*/false);
 }
 
+/// \brief Handle the loop optimization hints of
+/// \code
+///   #pragma clang loop vectorize(enable) vectorize_width(4)
+/// \endcode
+/// Each hint is 'option(value)', where the option is one of vectorize,
+/// vectorize_width, interleave_count, unroll or unroll_count. Every hint
+/// becomes an annot_pragma_loop_hint token; Sema checks the values once the
+/// parser has seen the loop that follows.
+void PragmaLoopHintHandler::HandlePragma(Preprocessor &PP,
+                                         PragmaIntroducerKind Introducer,
+                                         Token &Tok) {
+  SmallVector<Token, 4> TokenList;
+
+  PP.Lex(Tok);
+  if (Tok.isNot(tok::identifier)) {
+    PP.Diag(Tok.getLocation(), diag::err_pragma_loop_invalid_option)
+      << /*MissingOption=*/true << "";
+    return;
+  }
+
+  while (Tok.is(tok::identifier)) {
+    Token Option = Tok;
+    IdentifierInfo *OptionInfo = Tok.getIdentifierInfo();
+    bool OptionValid = llvm::StringSwitch<bool>(OptionInfo->getName())
+      .Case("vectorize", true)
+      .Case("vectorize_width", true)
+      .Case("interleave_count", true)
+      .Case("unroll", true)
+      .Case("unroll_count", true)
+      .Default(false);
+    if (!OptionValid) {
+      PP.Diag(Tok.getLocation(), diag::err_pragma_loop_invalid_option)
+        << /*MissingOption=*/false << OptionInfo;
+      return;
+    }
+
+    PP.Lex(Tok);
+    if (Tok.isNot(tok::l_paren)) {
+      PP.Diag(Tok.getLocation(), diag::err_expected_lparen);
+      return;
+    }
+
+    // The value is 'enable' or 'disable', or a number; Sema checks which one
+    // the option takes.
+    PP.Lex(Tok);
+    if (Tok.isNot(tok::identifier) && Tok.isNot(tok::numeric_constant)) {
+      PP.Diag(Tok.getLocation(), diag::err_pragma_loop_missing_argument)
+        << OptionInfo;
+      return;
+    }
+    Token Value = Tok;
+
+    PP.Lex(Tok);
+    if (Tok.isNot(tok::r_paren)) {
+      PP.Diag(Tok.getLocation(), diag::err_expected_rparen);
+      return;
+    }
+
+    PragmaLoopHintInfo *Info =
+      (PragmaLoopHintInfo*) PP.getPreprocessorAllocator().Allocate(
+        sizeof(PragmaLoopHintInfo), llvm::alignOf<PragmaLoopHintInfo>());
+    new (Info) PragmaLoopHintInfo();
+    Info->Option = Option;
+    Info->Value = Value;
+    Info->RParen = Tok;
+
+    Token LoopHintTok;
+    LoopHintTok.startToken();
+    LoopHintTok.setKind(tok::annot_pragma_loop_hint);
+    LoopHintTok.setLocation(Option.getLocation());
+    LoopHintTok.setAnnotationValue(static_cast<void *>(Info));
+    TokenList.push_back(LoopHintTok);
+
+    PP.Lex(Tok);
+  }
+
+  if (Tok.isNot(tok::eod)) {
+    PP.Diag(Tok.getLocation(), diag::warn_pragma_extra_tokens_at_eol)
+      << "clang loop";
+    return;
+  }
+
+  Token *Toks = new Token[TokenList.size()];
+  std::copy(TokenList.begin(), TokenList.end(), Toks);
+  PP.EnterTokenStream(Toks, TokenList.size(),
+                      /*DisableMacroExpansion=*/true, /*OwnsTokens=*/true);
+}
+
 /// \brief Handle '#pragma omp ...' when OpenMP is disabled.
 ///
 void
@@ -99,6 +99,14 @@ public:
                             Token &FirstToken);
 };
 
+/// PragmaLoopHintHandler - "\#pragma clang loop ...".
+class PragmaLoopHintHandler : public PragmaHandler {
+public:
+  PragmaLoopHintHandler() : PragmaHandler("loop") {}
+  virtual void HandlePragma(Preprocessor &PP, PragmaIntroducerKind Introducer,
+                            Token &FirstToken);
+};
+
 class PragmaNoOpenMPHandler : public PragmaHandler {
 public:
   PragmaNoOpenMPHandler() : PragmaHandler("omp") { }
@@ -20,6 +20,7 @@
 #include "clang/Basic/SourceManager.h"
 #include "clang/Basic/TargetInfo.h"
 #include "clang/Sema/DeclSpec.h"
+#include "clang/Sema/LoopHint.h"
 #include "clang/Sema/PrettyDeclStackTrace.h"
 #include "clang/Sema/Scope.h"
 #include "clang/Sema/TypoCorrection.h"
@@ -308,6 +309,10 @@ Retry:
   case tok::annot_pragma_openmp:
     return ParseOpenMPDeclarativeOrExecutableDirective();
 
+  case tok::annot_pragma_loop_hint:
+    ProhibitAttributes(Attrs);
+    return ParsePragmaLoopHint(Stmts, OnlyStatement, TrailingElseLoc);
+
   }
 
   // If we reached this code, the statement must end in a semicolon.
@@ -325,6 +330,22 @@ Retry:
   return Res;
 }
 
+/// \brief Parse the hints of one or more '#pragma clang loop' directives and
+/// the loop they apply to.
+StmtResult Parser::ParsePragmaLoopHint(StmtVector &Stmts, bool OnlyStatement,
+                                       SourceLocation *TrailingElseLoc) {
+  SmallVector<LoopHint, 4> Hints;
+  while (Tok.is(tok::annot_pragma_loop_hint))
+    Hints.push_back(HandlePragmaLoopHint());
+
+  StmtResult Loop = ParseStatementOrDeclaration(Stmts, OnlyStatement,
+                                                TrailingElseLoc);
+  if (!Loop.isUsable())
+    return Loop;
+
+  return Actions.ActOnPragmaLoopHints(Hints, Loop.get());
+}
+
 /// \brief Parse an expression statement.
 StmtResult Parser::ParseExprStatement() {
   // If a case keyword is missing, this is where it should be inserted.
@@ -1304,16 +1304,20 @@ void Parser::ParseLateTemplatedFuncDef(LateParsedTemplatedFunction &LMT) {
     TemplateParamScopeStack.push_back(new ParseScope(this, Scope::DeclScope));
     Actions.PushDeclContext(Actions.getCurScope(), *II);
   }
-  TemplateParamScopeStack.push_back(
-      new ParseScope(this, Scope::TemplateParamScope));
-
-  DeclaratorDecl *Declarator = dyn_cast<DeclaratorDecl>(FunD);
-  if (Declarator && Declarator->getNumTemplateParameterLists() != 0) {
-    Actions.ActOnReenterDeclaratorTemplateScope(getCurScope(), Declarator);
+  // Late parsed inline methods of non-template classes, which
+  // -fdelayed-inline-method-parsing produces, have no template scope.
+  if (FunD->isDependentContext()) {
+    TemplateParamScopeStack.push_back(
+        new ParseScope(this, Scope::TemplateParamScope));
+
+    DeclaratorDecl *Declarator = dyn_cast<DeclaratorDecl>(FunD);
+    if (Declarator && Declarator->getNumTemplateParameterLists() != 0) {
+      Actions.ActOnReenterDeclaratorTemplateScope(getCurScope(), Declarator);
+      ++CurTemplateDepthTracker;
+    }
+    Actions.ActOnReenterTemplateScope(getCurScope(), LMT.D);
     ++CurTemplateDepthTracker;
   }
-  Actions.ActOnReenterTemplateScope(getCurScope(), LMT.D);
-  ++CurTemplateDepthTracker;
 
   assert(!LMT.Toks.empty() && "Empty body!");
 
@@ -1350,10 +1354,10 @@ void Parser::ParseLateTemplatedFuncDef(LateParsedTemplatedFunction &LMT) {
              "TemplateParameterDepth should be greater than the depth of "
              "current template being instantiated!");
       ParseFunctionStatementBody(LMT.D, FnScope);
-      Actions.MarkAsLateParsedTemplate(FunD, false);
     } else
       Actions.ActOnFinishFunctionBody(LMT.D, 0);
   }
+  Actions.MarkAsLateParsedTemplate(FunD, false);
 
   // Exit scopes.
   FnScope.Exit();
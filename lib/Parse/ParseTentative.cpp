@@ -15,8 +15,61 @@
 #include "clang/Parse/Parser.h"
 #include "clang/Parse/ParseDiagnostic.h"
 #include "clang/Sema/ParsedTemplate.h"
+#include "clang/Sema/Scope.h"
 using namespace clang;
 
+/// \brief Returns the scope that the disambiguations at the current token
+/// depend on.  A function prototype scope without declarations, which the
+/// parser enters before checking for a function declarator, is the same as
+/// its parent.
+static Scope *getDisambiguationScope(Scope *S) {
+  while (S && S->isFunctionPrototypeScope() && S->decl_empty())
+    S = S->getParent();
+  return S;
+}
+
+/// \brief Returns the result of the disambiguation \p Query at the current
+/// token, if it was done before in the same context.
+const Parser::TentativeParseResult *
+Parser::findTentativeParseResult(TentativeParseQuery Query) const {
+  SourceLocation Loc = Tok.getLocation();
+  if (Loc.isInvalid() || PP.isCodeCompletionEnabled())
+    return 0;
+
+  TentativeParseResultMap::const_iterator Pos =
+    TentativeParseResults.find(std::make_pair(Loc.getRawEncoding(),
+                                              unsigned(Query)));
+  if (Pos == TentativeParseResults.end())
+    return 0;
+
+  const TentativeParseResult &Result = Pos->second;
+  if (Result.S != getDisambiguationScope(getCurScope()) ||
+      Result.NumTentativelyDeclared != TentativelyDeclaredIdentifiers.size() ||
+      (Result.NumTentativelyDeclared &&
+       Result.LastTentativelyDeclared != TentativelyDeclaredIdentifiers.back()))
+    return 0;
+  return &Result;
+}
+
+/// \brief Remembers the result of the disambiguation \p Query, which started
+/// at the current token.
+void Parser::rememberTentativeParseResult(TentativeParseQuery Query,
+                                          bool Result, bool IsAmbiguous) {
+  SourceLocation Loc = Tok.getLocation();
+  if (Loc.isInvalid() || PP.isCodeCompletionEnabled())
+    return;
+
+  TentativeParseResult &Entry =
+    TentativeParseResults[std::make_pair(Loc.getRawEncoding(),
+                                         unsigned(Query))];
+  Entry.S = getDisambiguationScope(getCurScope());
+  Entry.NumTentativelyDeclared = TentativelyDeclaredIdentifiers.size();
+  Entry.LastTentativelyDeclared = TentativelyDeclaredIdentifiers.empty()
+                                    ? 0 : TentativelyDeclaredIdentifiers.back();
+  Entry.Result = Result;
+  Entry.IsAmbiguous = IsAmbiguous;
+}
+
 /// isCXXDeclarationStatement - C++-specialized function that disambiguates
 /// between a declaration or an expression statement, when parsing function
 /// bodies. Returns true for declaration, false for expression.
@@ -125,6 +178,10 @@ bool Parser::isCXXSimpleDeclaration(bool AllowForRangeDecl) {
   // Ok, we have a simple-type-specifier/typename-specifier followed by a '(',
   // or an identifier which doesn't resolve as anything. We need tentative
   // parsing...
+  TentativeParseQuery Query = AllowForRangeDecl ? TPQ_ForRangeDeclaration
+                                                : TPQ_SimpleDeclaration;
+  if (const TentativeParseResult *Known = findTentativeParseResult(Query))
+    return Known->Result;
 
   TentativeParsingAction PA(*this);
   TPR = TryParseSimpleDeclaration(AllowForRangeDecl);
@@ -132,13 +189,14 @@ bool Parser::isCXXSimpleDeclaration(bool AllowForRangeDecl) {
 
   // In case of an error, let the declaration parsing code handle it.
   if (TPR == TPResult::Error())
-    return true;
+    TPR = TPResult::True();
 
   // Declarations take precedence over expressions.
   if (TPR == TPResult::Ambiguous())
     TPR = TPResult::True();
 
   assert(TPR == TPResult::True() || TPR == TPResult::False());
+  rememberTentativeParseResult(Query, TPR == TPResult::True());
   return TPR == TPResult::True();
 }
 
@@ -282,6 +340,13 @@ bool Parser::isCXXConditionDeclaration() {
 
   // Ok, we have a simple-type-specifier/typename-specifier followed by a '('.
   // We need tentative parsing...
+  TentativeParseQuery Query = Context == TypeIdInParens
+                                ? TPQ_TypeIdInParens
+                                : TPQ_TypeIdAsTemplateArgument;
+  if (const TentativeParseResult *Known = findTentativeParseResult(Query)) {
+    isAmbiguous = Known->IsAmbiguous;
+    return Known->Result;
+  }
 
   TentativeParsingAction PA(*this);
 
@@ -404,6 +469,7 @@ bool Parser::isCXXTypeId(TentativeCXXTypeIdContext Context, bool &isAmbiguous) {
   PA.Revert();
 
   assert(TPR == TPResult::True() || TPR == TPResult::False());
+  rememberTentativeParseResult(Query, TPR == TPResult::True(), isAmbiguous);
   return TPR == TPResult::True();
 }
 
@@ -1408,6 +1474,13 @@ bool Parser::isCXXFunctionDeclarator(bool *IsAmbiguous) {
   // ambiguities mentioned in 6.8, the resolution is to consider any construct
   // that could possibly be a declaration a declaration.
 
+  if (const TentativeParseResult *Known =
+        findTentativeParseResult(TPQ_FunctionDeclarator)) {
+    if (IsAmbiguous && Known->IsAmbiguous)
+      *IsAmbiguous = true;
+    return Known->Result;
+  }
+
   TentativeParsingAction PA(*this);
 
   ConsumeParen();
@@ -1440,6 +1513,9 @@ bool Parser::isCXXFunctionDeclarator(bool *IsAmbiguous) {
     *IsAmbiguous = true;
 
   // In case of an error, let the declaration parsing code handle it.
+  rememberTentativeParseResult(TPQ_FunctionDeclarator,
+                               TPR != TPResult::False(),
+                               TPR == TPResult::Ambiguous());
   return TPR != TPResult::False();
 }
 
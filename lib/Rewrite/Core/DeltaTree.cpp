@@ -103,16 +103,16 @@ namespace {
     /// this node.  If insertion is easy, do it and return false.  Otherwise,
     /// split the node, populate InsertRes with info about the split, and return
     /// true.
-    bool DoInsertion(unsigned FileIndex, int Delta, InsertResult *InsertRes);
+    bool DoInsertion(unsigned FileIndex, int Delta,
+                     llvm::BumpPtrAllocator &Allocator,
+                     InsertResult *InsertRes);
 
-    void DoSplit(InsertResult &InsertRes);
+    void DoSplit(InsertResult &InsertRes, llvm::BumpPtrAllocator &Allocator);
 
 
     /// RecomputeFullDeltaLocally - Recompute the FullDelta field by doing a
     /// local walk over our contained deltas.
     void RecomputeFullDeltaLocally();
-
-    void Destroy();
   };
 } // end anonymous namespace
 
@@ -121,10 +121,6 @@ namespace {
   /// This class tracks them.
   class DeltaTreeInteriorNode : public DeltaTreeNode {
     DeltaTreeNode *Children[2*WidthFactor];
-    ~DeltaTreeInteriorNode() {
-      for (unsigned i = 0, e = NumValuesUsed+1; i != e; ++i)
-        Children[i]->Destroy();
-    }
     friend class DeltaTreeNode;
   public:
     DeltaTreeInteriorNode() : DeltaTreeNode(false /*nonleaf*/) {}
@@ -152,14 +148,6 @@ namespace {
 }
 
 
-/// Destroy - A 'virtual' destructor.
-void DeltaTreeNode::Destroy() {
-  if (isLeaf())
-    delete this;
-  else
-    delete cast<DeltaTreeInteriorNode>(this);
-}
-
 /// RecomputeFullDeltaLocally - Recompute the FullDelta field by doing a
 /// local walk over our contained deltas.
 void DeltaTreeNode::RecomputeFullDeltaLocally() {
@@ -177,6 +165,7 @@ void DeltaTreeNode::RecomputeFullDeltaLocally() {
 /// split the node, populate InsertRes with info about the split, and return
 /// true.
 bool DeltaTreeNode::DoInsertion(unsigned FileIndex, int Delta,
+                                llvm::BumpPtrAllocator &Allocator,
                                 InsertResult *InsertRes) {
   // Maintain full delta for this node.
   FullDelta += Delta;
@@ -213,18 +202,20 @@ bool DeltaTreeNode::DoInsertion(unsigned FileIndex, int Delta,
     // Otherwise, if this is leaf is full, split the node at its median, insert
     // the value into one of the children, and return the result.
     assert(InsertRes && "No result location specified");
-    DoSplit(*InsertRes);
+    DoSplit(*InsertRes, Allocator);
 
     if (InsertRes->Split.FileLoc > FileIndex)
-      InsertRes->LHS->DoInsertion(FileIndex, Delta, 0 /*can't fail*/);
+      InsertRes->LHS->DoInsertion(FileIndex, Delta, Allocator,
+                                  0 /*can't fail*/);
     else
-      InsertRes->RHS->DoInsertion(FileIndex, Delta, 0 /*can't fail*/);
+      InsertRes->RHS->DoInsertion(FileIndex, Delta, Allocator,
+                                  0 /*can't fail*/);
     return true;
   }
 
   // Otherwise, this is an interior node.  Send the request down the tree.
   DeltaTreeInteriorNode *IN = cast<DeltaTreeInteriorNode>(this);
-  if (!IN->Children[i]->DoInsertion(FileIndex, Delta, InsertRes))
+  if (!IN->Children[i]->DoInsertion(FileIndex, Delta, Allocator, InsertRes))
     return false; // If there was space in the child, just return.
 
   // Okay, this split the subtree, producing a new value and two children to
@@ -254,7 +245,7 @@ bool DeltaTreeNode::DoInsertion(unsigned FileIndex, int Delta,
   SourceDelta SubSplit = InsertRes->Split;
 
   // Do the split.
-  DoSplit(*InsertRes);
+  DoSplit(*InsertRes, Allocator);
 
   // Figure out where to insert SubRHS/NewSplit.
   DeltaTreeInteriorNode *InsertSide;
@@ -290,7 +281,8 @@ bool DeltaTreeNode::DoInsertion(unsigned FileIndex, int Delta,
 /// DoSplit - Split the currently full node (which has 2*WidthFactor-1 values)
 /// into two subtrees each with "WidthFactor-1" values and a pivot value.
 /// Return the pieces in InsertRes.
-void DeltaTreeNode::DoSplit(InsertResult &InsertRes) {
+void DeltaTreeNode::DoSplit(InsertResult &InsertRes,
+                            llvm::BumpPtrAllocator &Allocator) {
   assert(isFull() && "Why split a non-full node?");
 
   // Since this node is full, it contains 2*WidthFactor-1 values.  We move
@@ -303,13 +295,15 @@ void DeltaTreeNode::DoSplit(InsertResult &InsertRes) {
   if (DeltaTreeInteriorNode *IN = dyn_cast<DeltaTreeInteriorNode>(this)) {
     // If this is an interior node, also move over 'WidthFactor' children
     // into the new node.
-    DeltaTreeInteriorNode *New = new DeltaTreeInteriorNode();
+    DeltaTreeInteriorNode *New =
+        new (Allocator.Allocate<DeltaTreeInteriorNode>())
+            DeltaTreeInteriorNode();
     memcpy(&New->Children[0], &IN->Children[WidthFactor],
            WidthFactor*sizeof(IN->Children[0]));
     NewNode = New;
   } else {
     // Just create the new leaf node.
-    NewNode = new DeltaTreeNode();
+    NewNode = new (Allocator.Allocate<DeltaTreeNode>()) DeltaTreeNode();
   }
 
   // Move over the last 'WidthFactor-1' values from here to NewNode.
@@ -385,18 +379,17 @@ static DeltaTreeNode *getRoot(void *Root) {
 }
 
 DeltaTree::DeltaTree() {
-  Root = new DeltaTreeNode();
+  Root = new (Allocator.Allocate<DeltaTreeNode>()) DeltaTreeNode();
 }
 DeltaTree::DeltaTree(const DeltaTree &RHS) {
   // Currently we only support copying when the RHS is empty.
   assert(getRoot(RHS.Root)->getNumValuesUsed() == 0 &&
          "Can only copy empty tree");
-  Root = new DeltaTreeNode();
+  Root = new (Allocator.Allocate<DeltaTreeNode>()) DeltaTreeNode();
 }
 
-DeltaTree::~DeltaTree() {
-  getRoot(Root)->Destroy();
-}
+// The nodes are trivially destructible, and freed along with Allocator.
+DeltaTree::~DeltaTree() {}
 
 /// getDeltaAt - Return the accumulated delta at the specified file offset.
 /// This includes all insertions or delections that occurred *before* the
@@ -453,8 +446,9 @@ void DeltaTree::AddDelta(unsigned FileIndex, int Delta) {
   DeltaTreeNode *MyRoot = getRoot(Root);
 
   DeltaTreeNode::InsertResult InsertRes;
-  if (MyRoot->DoInsertion(FileIndex, Delta, &InsertRes)) {
-    Root = MyRoot = new DeltaTreeInteriorNode(InsertRes);
+  if (MyRoot->DoInsertion(FileIndex, Delta, Allocator, &InsertRes)) {
+    Root = MyRoot = new (Allocator.Allocate<DeltaTreeInteriorNode>())
+        DeltaTreeInteriorNode(InsertRes);
   }
 
 #ifdef VERIFY_TREE
@@ -19,6 +19,7 @@
 #include "clang/Basic/DiagnosticIDs.h"
 #include "clang/Basic/FileManager.h"
 #include "clang/Basic/SourceManager.h"
+#include "clang/Basic/WorkerPool.h"
 #include "clang/Lex/Lexer.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/Support/FileSystem.h"
@@ -419,70 +420,85 @@ bool Rewriter::IncreaseIndentation(CharSourceRange range,
 }
 
 namespace {
-// A wrapper for a file stream that atomically overwrites the target.
-//
-// Creates a file output stream for a temporary file in the constructor,
-// which is later accessible via getStream() if ok() return true.
-// Flushes the stream and moves the temporary file to the target location
-// in the destructor.
-class AtomicallyMovedFile {
-public:
-  AtomicallyMovedFile(DiagnosticsEngine &Diagnostics, StringRef Filename,
-                      bool &AllWritten)
-    : Diagnostics(Diagnostics), Filename(Filename), AllWritten(AllWritten) {
-    TempFilename = Filename;
-    TempFilename += "-%%%%%%%%";
-    int FD;
-    if (llvm::sys::fs::createUniqueFile(TempFilename.str(), FD, TempFilename)) {
-      AllWritten = false;
-      Diagnostics.Report(clang::diag::err_unable_to_make_temp)
-        << TempFilename;
-    } else {
-      FileStream.reset(new llvm::raw_fd_ostream(FD, /*shouldClose=*/true));
-    }
-  }
-
-  ~AtomicallyMovedFile() {
-    if (!ok()) return;
-
-    FileStream->flush();
-#ifdef _WIN32
-    // Win32 does not allow rename/removing opened files.
-    FileStream.reset();
-#endif
-    if (llvm::error_code ec =
-          llvm::sys::fs::rename(TempFilename.str(), Filename)) {
-      AllWritten = false;
-      Diagnostics.Report(clang::diag::err_unable_to_rename_temp)
-        << TempFilename << Filename << ec.message();
-      bool existed;
-      // If the remove fails, there's not a lot we can do - this is already an
-      // error.
-      llvm::sys::fs::remove(TempFilename.str(), existed);
-    }
-  }
-
-  bool ok() { return FileStream.isValid(); }
-  raw_ostream &getStream() { return *FileStream; }
-
-private:
-  DiagnosticsEngine &Diagnostics;
-  StringRef Filename;
+// The outcome of atomically overwriting one file. Failures are reported by
+// overwriteChangedFiles() once all files have been written, as the writes
+// may run on several threads.
+struct OverwriteResult {
+  enum StatusKind { Written, TempFileFailed, RenameFailed };
+  StatusKind Status;
   SmallString<128> TempFilename;
-  OwningPtr<llvm::raw_fd_ostream> FileStream;
-  bool &AllWritten;
+  std::string Message;
+};
+
+// The state shared by the tasks of overwriteChangedFiles().
+struct OverwriteRun {
+  std::vector<StringRef> Filenames;
+  std::vector<const RewriteBuffer *> Buffers;
+  std::vector<OverwriteResult> Results;
 };
 } // end anonymous namespace
 
-bool Rewriter::overwriteChangedFiles() {
-  bool AllWritten = true;
+// Writes a buffer to a temporary file next to its target, and then moves the
+// temporary file over the target.
+static void overwriteFileTask(void *Context, unsigned Index) {
+  OverwriteRun &Run = *static_cast<OverwriteRun *>(Context);
+  StringRef Filename = Run.Filenames[Index];
+  OverwriteResult &Result = Run.Results[Index];
+  Result.TempFilename = Filename;
+  Result.TempFilename += "-%%%%%%%%";
+  int FD;
+  if (llvm::sys::fs::createUniqueFile(Result.TempFilename.str(), FD,
+                                      Result.TempFilename)) {
+    Result.Status = OverwriteResult::TempFileFailed;
+    return;
+  }
+  {
+    // Win32 does not allow rename/removing opened files, so close it first.
+    llvm::raw_fd_ostream FileStream(FD, /*shouldClose=*/true);
+    Run.Buffers[Index]->write(FileStream);
+  }
+  if (llvm::error_code ec =
+        llvm::sys::fs::rename(Result.TempFilename.str(), Filename)) {
+    Result.Status = OverwriteResult::RenameFailed;
+    Result.Message = ec.message();
+    bool existed;
+    // If the remove fails, there's not a lot we can do - this is already an
+    // error.
+    llvm::sys::fs::remove(Result.TempFilename.str(), existed);
+    return;
+  }
+  Result.Status = OverwriteResult::Written;
+}
+
+bool Rewriter::overwriteChangedFiles(unsigned NumThreads) {
+  OverwriteRun Run;
   for (buffer_iterator I = buffer_begin(), E = buffer_end(); I != E; ++I) {
     const FileEntry *Entry =
         getSourceMgr().getFileEntryForID(I->first);
-    AtomicallyMovedFile File(getSourceMgr().getDiagnostics(), Entry->getName(),
-                             AllWritten);
-    if (File.ok()) {
-      I->second.write(File.getStream());
+    Run.Filenames.push_back(Entry->getName());
+    Run.Buffers.push_back(&I->second);
+  }
+  Run.Results.resize(Run.Filenames.size());
+  runTasksInParallel(Run.Filenames.size(), getEffectiveWorkerCount(NumThreads),
+                     overwriteFileTask, &Run);
+
+  DiagnosticsEngine &Diagnostics = getSourceMgr().getDiagnostics();
+  bool AllWritten = true;
+  for (unsigned I = 0, E = Run.Results.size(); I != E; ++I) {
+    const OverwriteResult &Result = Run.Results[I];
+    switch (Result.Status) {
+    case OverwriteResult::Written:
+      break;
+    case OverwriteResult::TempFileFailed:
+      AllWritten = false;
+      Diagnostics.Report(clang::diag::err_unable_to_make_temp)
+        << Result.TempFilename;
+      break;
+    case OverwriteResult::RenameFailed:
+      AllWritten = false;
+      Diagnostics.Report(clang::diag::err_unable_to_rename_temp)
+        << Result.TempFilename << Run.Filenames[I] << Result.Message;
+      break;
     }
   }
   return !AllWritten;
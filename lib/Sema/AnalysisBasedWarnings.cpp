@@ -1453,6 +1453,23 @@ static void flushDiagnostics(Sema &S, sema::FunctionScopeInfo *fscope) {
   }
 }
 
+/// \brief Determine whether any of the diagnostics that depend on whether
+/// their statement is reachable would be emitted.
+static bool hasEnabledDiagnostic(DiagnosticsEngine &Diags,
+                                 sema::FunctionScopeInfo *fscope) {
+  for (SmallVectorImpl<sema::PossiblyUnreachableDiag>::iterator
+       i = fscope->PossiblyUnreachableDiags.begin(),
+       e = fscope->PossiblyUnreachableDiags.end();
+       i != e; ++i) {
+    // Notes are emitted only if the diagnostic they are attached to is.
+    unsigned DiagID = i->PD.getDiagID();
+    if (!DiagnosticIDs::isBuiltinNote(DiagID) &&
+        Diags.getDiagnosticLevel(DiagID, i->Loc) != DiagnosticsEngine::Ignored)
+      return true;
+  }
+  return false;
+}
+
 void clang::sema::
 AnalysisBasedWarnings::IssueWarnings(sema::AnalysisBasedWarnings::Policy P,
                                      sema::FunctionScopeInfo *fscope,
@@ -1485,6 +1502,27 @@ AnalysisBasedWarnings::IssueWarnings(sema::AnalysisBasedWarnings::Policy P,
   const Stmt *Body = D->getBody();
   assert(Body);
 
+  // Decide up front which of the analyses that need a CFG can warn in this
+  // function, so that the CFG is built only if one of them can, and only
+  // with the options that they need.
+  SourceLocation FuncLoc = D->getLocStart();
+  if (P.enableCheckUnreachable) {
+    // Only check for unreachable code on non-template instantiations.
+    // Different template instantiations can effectively change the
+    // control-flow and it is very difficult to prove that a snippet of code
+    // in a template is unreachable for all instantiations.
+    if (const FunctionDecl *Function = dyn_cast<FunctionDecl>(D))
+      if (Function->isTemplateInstantiation())
+        P.enableCheckUnreachable = 0;
+    if (Diags.getDiagnosticLevel(diag::warn_unreachable, FuncLoc) ==
+        DiagnosticsEngine::Ignored)
+      P.enableCheckUnreachable = 0;
+  }
+  if (P.enableThreadSafetyAnalysis &&
+      Diags.getDiagnosticLevel(diag::warn_double_lock, FuncLoc) ==
+        DiagnosticsEngine::Ignored)
+    P.enableThreadSafetyAnalysis = 0;
+
   AnalysisDeclContext AC(/* AnalysisDeclContextManager */ 0, D);
 
   // Don't generate EH edges for CallExprs as we'd like to avoid the n^2
@@ -1519,8 +1557,12 @@ AnalysisBasedWarnings::IssueWarnings(sema::AnalysisBasedWarnings::Policy P,
 
   // Construct the analysis context with the specified CFG build options.
   
-  // Emit delayed diagnostics.
-  if (!fscope->PossiblyUnreachableDiags.empty()) {
+  // Emit delayed diagnostics. If they are all ignored, there is no need to
+  // find out which of them are reachable.
+  if (!fscope->PossiblyUnreachableDiags.empty() &&
+      !hasEnabledDiagnostic(Diags, fscope))
+    flushDiagnostics(S, fscope);
+  else if (!fscope->PossiblyUnreachableDiags.empty()) {
     bool analyzed = false;
 
     // Register the expressions with the CFGBuilder.
@@ -1580,17 +1622,8 @@ AnalysisBasedWarnings::IssueWarnings(sema::AnalysisBasedWarnings::Policy P,
   }
 
   // Warning: check for unreachable code
-  if (P.enableCheckUnreachable) {
-    // Only check for unreachable code on non-template instantiations.
-    // Different template instantiations can effectively change the control-flow
-    // and it is very difficult to prove that a snippet of code in a template
-    // is unreachable for all instantiations.
-    bool isTemplateInstantiation = false;
-    if (const FunctionDecl *Function = dyn_cast<FunctionDecl>(D))
-      isTemplateInstantiation = Function->isTemplateInstantiation();
-    if (!isTemplateInstantiation)
-      CheckUnreachable(S, AC);
-  }
+  if (P.enableCheckUnreachable)
+    CheckUnreachable(S, AC);
 
   // Check for thread safety violations
   if (P.enableThreadSafetyAnalysis) {
@@ -35,6 +35,7 @@ clang_sema_SRC_FILES :=	\
 	MultiplexExternalSemaSource.cpp \
 	Scope.cpp \
 	ScopeInfo.cpp \
+	ScratchArena.cpp \
 	Sema.cpp	\
 	SemaAccess.cpp	\
 	SemaAttr.cpp	\
@@ -70,6 +71,7 @@ clang_sema_SRC_FILES :=	\
 	SemaTemplateVariadic.cpp	\
 	SemaType.cpp	\
 	TargetAttributesSema.cpp	\
+	TemplateProfiler.cpp	\
 	TypeLocBuilder.cpp
 
 LOCAL_SRC_FILES := $(clang_sema_SRC_FILES)
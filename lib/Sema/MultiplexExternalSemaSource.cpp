@@ -123,9 +123,9 @@ void MultiplexExternalSemaSource::CompleteType(ObjCInterfaceDecl *Class) {
     Sources[i]->CompleteType(Class);
 }
 
-void MultiplexExternalSemaSource::ReadComments() {
+void MultiplexExternalSemaSource::ReadCommentsInFile(FileID File) {
   for(size_t i = 0; i < Sources.size(); ++i)
-    Sources[i]->ReadComments();
+    Sources[i]->ReadCommentsInFile(File);
 }
 
 void MultiplexExternalSemaSource::StartedDeserializing() {
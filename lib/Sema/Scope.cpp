@@ -30,6 +30,7 @@ void Scope::Init(Scope *parent, unsigned flags) {
   }
 
   if (parent) {
+    DeclDepths = parent->DeclDepths;
     Depth = parent->Depth + 1;
     PrototypeDepth = parent->PrototypeDepth;
     PrototypeIndex = 0;
@@ -37,6 +38,9 @@ void Scope::Init(Scope *parent, unsigned flags) {
     BlockParent    = parent->BlockParent;
     TemplateParamParent = parent->TemplateParamParent;
   } else {
+    if (!OwnedDeclDepths)
+      OwnedDeclDepths.reset(new DeclDepthMap);
+    DeclDepths = OwnedDeclDepths.get();
     Depth = 0;
     PrototypeDepth = 0;
     PrototypeIndex = 0;
@@ -60,6 +64,51 @@ void Scope::Init(Scope *parent, unsigned flags) {
   ErrorTrap.reset();
 }
 
+/// The depth recorded for a declaration that was added to a scope while it
+/// was in an inner one, which only the walk of the scopes can find.
+static const unsigned AmbiguousDepth = ~0U;
+
+void Scope::AddDecl(Decl *D) {
+  DeclsInScope.insert(D);
+
+  // A declaration that is added to its scope again, or to an inner one, is
+  // found there first. One that is added to an outer scope might still be in
+  // an inner one that is alive.
+  std::pair<DeclDepthMap::iterator, bool> Entry =
+      DeclDepths->insert(std::make_pair(D, Depth));
+  if (!Entry.second) {
+    unsigned &Recorded = Entry.first->second;
+    Recorded = Recorded <= Depth ? Depth : AmbiguousDepth;
+  }
+}
+
+void Scope::RemoveDecl(Decl *D) {
+  DeclsInScope.erase(D);
+
+  DeclDepthMap::iterator Entry = DeclDepths->find(D);
+  if (Entry != DeclDepths->end() && Entry->second == Depth)
+    DeclDepths->erase(Entry);
+}
+
+Scope *Scope::getDeclScope(Decl *D) {
+  // Go straight to the scope at the recorded depth, if it holds the
+  // declaration. Otherwise the entry is stale or ambiguous, or belongs to a
+  // scope that isn't one of our parents, so probe every scope.
+  DeclDepthMap::const_iterator Entry = DeclDepths->find(D);
+  if (Entry != DeclDepths->end() && Entry->second <= Depth) {
+    Scope *S = this;
+    for (unsigned I = Entry->second; I != Depth; ++I)
+      S = S->getParent();
+    if (S->isDeclScope(D))
+      return S;
+  }
+
+  Scope *S = this;
+  while (S && !S->isDeclScope(D))
+    S = S->getParent();
+  return S;
+}
+
 bool Scope::containedInPrototypeScope() const {
   const Scope *S = this;
   while (S) {
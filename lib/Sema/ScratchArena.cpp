@@ -0,0 +1,125 @@
+//===--- ScratchArena.cpp - Scoped scratch memory for Sema ----------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the ScratchArena class.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Sema/ScratchArena.h"
+#include "llvm/Support/raw_ostream.h"
+#include <cstdlib>
+
+using namespace clang;
+
+static char *alignPtr(char *Ptr, size_t Alignment) {
+  assert(Alignment && (Alignment & (Alignment - 1)) == 0 &&
+         "alignment is not a power of two");
+  return reinterpret_cast<char *>(
+      (reinterpret_cast<uintptr_t>(Ptr) + Alignment - 1) &
+      ~uintptr_t(Alignment - 1));
+}
+
+ScratchArena::ScratchArena()
+  : NumUsedSlabs(0), Ptr(0), End(0), Innermost(0), NumAllocations(0),
+    NumMallocs(0), NumRefused(0), BytesAllocated(0) {}
+
+ScratchArena::~ScratchArena() {
+  assert(!Innermost && "scratch arena destroyed within a scope");
+  for (unsigned I = 0, N = LargeAllocations.size(); I != N; ++I)
+    std::free(LargeAllocations[I]);
+  for (unsigned I = 0, N = Slabs.size(); I != N; ++I)
+    std::free(Slabs[I]);
+}
+
+void *ScratchArena::AllocateSlow(size_t Size, size_t Alignment) {
+  // Give allocations that would waste most of a slab memory of their own.
+  if (Size + Alignment > SlabSize / 4) {
+    void *Mem = std::malloc(Size + Alignment);
+    if (!Mem)
+      return 0;
+    ++NumMallocs;
+    LargeAllocations.push_back(Mem);
+    return alignPtr(static_cast<char *>(Mem), Alignment);
+  }
+
+  // Move on to the next slab, allocating it if this is the furthest the
+  // arena has grown.
+  if (NumUsedSlabs == Slabs.size()) {
+    char *Slab = static_cast<char *>(std::malloc(SlabSize));
+    if (!Slab)
+      return 0;
+    ++NumMallocs;
+    Slabs.push_back(Slab);
+  }
+  Ptr = Slabs[NumUsedSlabs++];
+  End = Ptr + SlabSize;
+
+  char *Result = alignPtr(Ptr, Alignment);
+  Ptr = Result + Size;
+  return Result;
+}
+
+void ScratchArena::releaseTo(const Scope &Mark) {
+  while (LargeAllocations.size() > Mark.NumLargeAllocations)
+    std::free(LargeAllocations.pop_back_val());
+  NumUsedSlabs = Mark.NumSlabs;
+  Ptr = Mark.Ptr;
+  End = NumUsedSlabs ? Slabs[NumUsedSlabs - 1] + SlabSize : 0;
+}
+
+void ScratchArena::PrintStats() const {
+  llvm::errs() << NumAllocations << " scratch allocations (" << BytesAllocated
+               << " bytes), " << NumMallocs << " of which called malloc; "
+               << NumRefused << " refused to outer scopes.\n";
+  llvm::errs() << Slabs.size() << " scratch slabs of " << SlabSize
+               << " bytes.\n";
+}
+
+ScratchArena::Scope::Scope(ScratchArena *Arena)
+  : Arena(Arena), Parent(0), NumSlabs(0), Ptr(0), NumLargeAllocations(0) {
+  if (!Arena)
+    return;
+  Parent = Arena->Innermost;
+  Arena->Innermost = this;
+  NumSlabs = Arena->NumUsedSlabs;
+  Ptr = Arena->Ptr;
+  NumLargeAllocations = Arena->LargeAllocations.size();
+}
+
+ScratchArena::Scope::~Scope() {
+  if (!Arena)
+    return;
+  assert(Arena->Innermost == this &&
+         "scratch scopes must end in the reverse order they began");
+  Arena->releaseTo(*this);
+  Arena->Innermost = Parent;
+}
+
+void *ScratchArena::Scope::Allocate(size_t Size, size_t Alignment) {
+  if (!Arena)
+    return 0;
+  if (Arena->Innermost != this) {
+    ++Arena->NumRefused;
+    return 0;
+  }
+
+  ++Arena->NumAllocations;
+  Arena->BytesAllocated += Size;
+  char *Result = alignPtr(Arena->Ptr, Alignment);
+  if (Arena->Ptr && Result + Size <= Arena->End) {
+    Arena->Ptr = Result + Size;
+    return Result;
+  }
+  return Arena->AllocateSlow(Size, Alignment);
+}
+
+void ScratchArena::Scope::reset() {
+  if (Arena && Arena->Innermost == this)
+    Arena->releaseTo(*this);
+}
@@ -32,11 +32,13 @@
 #include "clang/Sema/ExternalSemaSource.h"
 #include "clang/Sema/MultiplexExternalSemaSource.h"
 #include "clang/Sema/ObjCMethodList.h"
+#include "clang/Sema/Overload.h"
 #include "clang/Sema/PrettyDeclStackTrace.h"
 #include "clang/Sema/Scope.h"
 #include "clang/Sema/ScopeInfo.h"
 #include "clang/Sema/SemaConsumer.h"
 #include "clang/Sema/TemplateDeduction.h"
+#include "clang/Sema/TemplateProfiler.h"
 #include "llvm/ADT/APFloat.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/SmallSet.h"
@@ -86,10 +88,13 @@ Sema::Sema(Preprocessor &pp, ASTContext &ctxt, ASTConsumer &consumer,
     NSDictionaryDecl(0), DictionaryWithObjectsMethod(0),
     GlobalNewDeleteDeclared(false),
     TUKind(TUKind),
-    NumSFINAEErrors(0), InFunctionDeclarator(0),
+    NumSFINAEErrors(0), NumOverloadConversionsRuledOut(0),
+    NumOverloadCacheHits(0), NumOverloadCacheMisses(0),
+    NumDeductionCacheHits(0), NumDeductionCacheMisses(0),
+    NumNonPublicAccessChecks(0), InFunctionDeclarator(0), StaleDocComment(0),
     AccessCheckingSFINAE(false), InNonInstantiationSFINAEContext(false),
     NonInstantiationEntries(0), ArgumentPackSubstitutionIndex(-1),
-    CurrentInstantiationScope(0), TyposCorrected(0),
+    CurrentInstantiationScope(0), TyposCorrected(0), TypoCorrectionTime(0),
     AnalysisWarnings(*this), CurScope(0), Ident_super(0), Ident___float128(0)
 {
   TUScope = 0;
@@ -101,8 +106,11 @@ Sema::Sema(Preprocessor &pp, ASTContext &ctxt, ASTConsumer &consumer,
   if (getLangOpts().ObjC1)
     NSAPIObj.reset(new NSAPI(Context));
 
-  if (getLangOpts().CPlusPlus)
+  if (getLangOpts().CPlusPlus) {
     FieldCollector.reset(new CXXFieldCollector());
+    OverloadCache.reset(new OverloadResolutionCache());
+    DeductionCache.reset(new TemplateDeductionCache());
+  }
 
   // Tell diagnostics how to render things from the AST library.
   PP.getDiagnostics().SetArgToStringFn(&FormatASTNodeDiagnosticArgument,
@@ -172,6 +180,11 @@ void Sema::Initialize() {
     PushOnScopeChains(Context.getBuiltinVaListDecl(), TUScope);
 }
 
+void Sema::startTemplateProfiling() {
+  if (!TemplateProf)
+    TemplateProf.reset(new TemplateProfiler(Context));
+}
+
 Sema::~Sema() {
   if (PackContext) FreePackedContext();
   if (VisContext) FreeVisContext();
@@ -251,11 +264,36 @@ void Sema::addExternalSource(ExternalSemaSource *E) {
 void Sema::PrintStats() const {
   llvm::errs() << "\n*** Semantic Analysis Stats:\n";
   llvm::errs() << NumSFINAEErrors << " SFINAE diagnostics trapped.\n";
+  llvm::errs() << NumOverloadConversionsRuledOut
+               << " overload candidate conversions ruled out early.\n";
+  llvm::errs() << NumOverloadCacheHits << " overload resolution cache hits, "
+               << NumOverloadCacheMisses << " misses.\n";
+  llvm::errs() << NumDeductionCacheHits
+               << " template argument deduction cache hits, "
+               << NumDeductionCacheMisses << " misses.\n";
+  if (!LateParsedInlineMethods.empty())
+    llvm::errs() << UnusedLateParsedInlineMethods.size() << " of "
+                 << LateParsedInlineMethods.size()
+                 << " late parsed inline method bodies never parsed.\n";
 
   BumpAlloc.PrintStats();
+  Scratch.PrintStats();
   AnalysisWarnings.PrintStats();
 }
 
+Sema::MemoryUsage Sema::getMemoryUsage() const {
+  MemoryUsage Usage;
+  Usage.NumSpecialMembers = SpecialMemberCache.size();
+  Usage.AllocatorBytes = BumpAlloc.getTotalMemory();
+  Usage.NumOverloads = OverloadCache ? OverloadCache->size() : 0;
+  Usage.OverloadCacheBytes = OverloadCache ? OverloadCache->getMemorySize() : 0;
+  Usage.NumDeductions = DeductionCache ? DeductionCache->size() : 0;
+  Usage.DeductionCacheBytes =
+      DeductionCache ? DeductionCache->getMemorySize() : 0;
+  Usage.ScratchBytes = Scratch.getTotalMemory();
+  return Usage;
+}
+
 /// ImpCastExprToType - If Expr is not of type 'Type', insert an implicit cast.
 /// If there is already an implicit cast, merge into the existing one.
 /// The result is of the given category.
@@ -536,6 +574,14 @@ static bool IsRecordFullyDefined(const CXXRecordDecl *RD,
   return Complete;
 }
 
+void Sema::ParseUsedLateParsedInlineMethods() {
+  while (!UsedLateParsedInlineMethods.empty()) {
+    assert(LateTemplateParser && "late parsed method without a parser");
+    FunctionDecl *FD = UsedLateParsedInlineMethods.pop_back_val();
+    LateTemplateParser(OpaqueParser, FD);
+  }
+}
+
 /// ActOnEndOfTranslationUnit - This is called at the very end of the
 /// translation unit when EOF is reached and all but the top-level scope is
 /// popped.
@@ -549,7 +595,23 @@ void Sema::ActOnEndOfTranslationUnit() {
     return;
 
   // Complete translation units and modules define vtables and perform implicit
-  // instantiations. PCH files do not.
+  // instantiations. PCH files do not, unless asked to perform the
+  // instantiations, which then get serialized along with the PCH and need not
+  // be performed again in each translation unit that uses it.
+  if (TUKind == TU_Prefix && LangOpts.PCHInstantiateTemplates)
+    PerformPendingInstantiations();
+
+  // A PCH file cannot tell which late parsed inline methods its users will
+  // use, so it parses all of them.
+  if (TUKind == TU_Prefix) {
+    for (unsigned I = LateParsedInlineMethods.size(); I != 0; --I) {
+      FunctionDecl *FD = LateParsedInlineMethods[I - 1];
+      if (UnusedLateParsedInlineMethods.erase(FD))
+        UsedLateParsedInlineMethods.push_back(FD);
+    }
+    ParseUsedLateParsedInlineMethods();
+  }
+
   if (TUKind != TU_Prefix) {
     DiagnoseUseOfUnimplementedSelectors();
 
@@ -583,6 +645,15 @@ void Sema::ActOnEndOfTranslationUnit() {
     // valid, but we could do better by diagnosing if an instantiation uses a
     // name that was not visible at its first point of instantiation.
     PerformPendingInstantiations();
+
+    // Parse the late parsed inline methods that were used.  Their bodies can
+    // use more of them, and need more vtables and instantiations, and vice
+    // versa.
+    while (!UsedLateParsedInlineMethods.empty()) {
+      ParseUsedLateParsedInlineMethods();
+      DefineUsedVTables();
+      PerformPendingInstantiations();
+    }
   }
 
   // Remove file scoped decls that turned out to be used.
@@ -1450,6 +1450,7 @@ static Sema::AccessResult CheckAccess(Sema &S, SourceLocation Loc,
   // If the access path is public, it's accessible everywhere.
   if (Entity.getAccess() == AS_public)
     return Sema::AR_accessible;
+  ++S.NumNonPublicAccessChecks;
 
   // If we're currently parsing a declaration, we may need to delay
   // access control checking, because our effective context might be
@@ -178,6 +178,14 @@ Sema::CheckBuiltinFunctionCall(unsigned BuiltinID, CallExpr *TheCall) {
     if (SemaBuiltinObjectSize(TheCall))
       return ExprError();
     break;
+  case Builtin::BI__builtin_assume:
+    if (SemaBuiltinAssume(TheCall))
+      return ExprError();
+    break;
+  case Builtin::BI__builtin_assume_aligned:
+    if (SemaBuiltinAssumeAligned(TheCall))
+      return ExprError();
+    break;
   case Builtin::BI__builtin_longjmp:
     if (SemaBuiltinLongjmp(TheCall))
       return ExprError();
@@ -1858,6 +1866,59 @@ bool Sema::SemaBuiltinPrefetch(CallExpr *TheCall) {
   return false;
 }
 
+/// SemaBuiltinAssume - Handle __builtin_assume(bool cond). The condition
+/// is never evaluated, so its side effects, if any, are discarded.
+bool Sema::SemaBuiltinAssume(CallExpr *TheCall) {
+  Expr *Arg = TheCall->getArg(0);
+  if (Arg->isInstantiationDependent())
+    return false;
+
+  if (Arg->HasSideEffects(Context))
+    Diag(Arg->getLocStart(), diag::warn_assume_side_effects)
+      << cast<FunctionDecl>(TheCall->getCalleeDecl())->getDeclName()
+      << Arg->getSourceRange();
+
+  return false;
+}
+
+/// SemaBuiltinAssumeAligned - Handle __builtin_assume_aligned(const void *ptr,
+/// size_t align, ...), which takes an optional size_t offset of the pointer
+/// from the aligned address.
+bool Sema::SemaBuiltinAssumeAligned(CallExpr *TheCall) {
+  unsigned NumArgs = TheCall->getNumArgs();
+
+  if (NumArgs > 3)
+    return Diag(TheCall->getLocEnd(),
+             diag::err_typecheck_call_too_many_args_at_most)
+             << 0 /*function call*/ << 3 << NumArgs
+             << TheCall->getSourceRange();
+
+  // The alignment must be a constant power of two.
+  Expr *Arg = TheCall->getArg(1);
+  if (!Arg->isTypeDependent() && !Arg->isValueDependent()) {
+    llvm::APSInt Result;
+    if (SemaBuiltinConstantArg(TheCall, 1, Result))
+      return true;
+
+    if (!Result.isPowerOf2())
+      return Diag(TheCall->getLocStart(),
+                  diag::err_attribute_aligned_not_power_of_two)
+               << Arg->getSourceRange();
+  }
+
+  if (NumArgs > 2) {
+    ExprResult Offset(TheCall->getArg(2));
+    InitializedEntity Entity = InitializedEntity::InitializeParameter(Context,
+        Context.getSizeType(), false);
+    Offset = PerformCopyInitialization(Entity, SourceLocation(), Offset);
+    if (Offset.isInvalid())
+      return true;
+    TheCall->setArg(2, Offset.take());
+  }
+
+  return false;
+}
+
 /// SemaBuiltinConstantArg - Handle a check if argument ArgNum of CallExpr
 /// TheCall is a constant expression.
 bool Sema::SemaBuiltinConstantArg(CallExpr *TheCall, int ArgNum,
@@ -5136,6 +5197,13 @@ void CheckImplicitConversion(Sema &S, Expr *E, QualType T,
   if (CC.isInvalid())
     return;
 
+  // Everything below only produces -Wconversion warnings, apart from the
+  // floating-point to bool one, so don't bother when they are all disabled.
+  if (S.Diags.isDiagnosticGroupIgnored("conversion", E->getExprLoc()) &&
+      S.Diags.isDiagnosticGroupIgnored(
+          "implicit-conversion-floating-point-to-bool", E->getExprLoc()))
+    return;
+
   // Diagnose implicit casts to bool.
   if (Target->isSpecificBuiltinType(BuiltinType::Bool)) {
     if (isa<StringLiteral>(E))
@@ -6227,6 +6295,12 @@ void Sema::CheckArrayAccess(const Expr *BaseExpr, const Expr *IndexExpr,
   if (!ArrayTy)
     return;
 
+  // Don't evaluate the index if the warnings are disabled anyway.
+  if (Diags.isDiagnosticGroupIgnored(ASE ? "array-bounds"
+                                         : "array-bounds-pointer-arithmetic",
+                                     BaseExpr->getLocStart()))
+    return;
+
   llvm::APSInt index;
   if (!IndexExpr->EvaluateAsInt(index, Context))
     return;
@@ -7219,6 +7219,14 @@ bool Sema::CheckFunctionDeclaration(Scope *S, FunctionDecl *NewFD,
   assert(!NewFD->getResultType()->isVariablyModifiedType() 
          && "Variably modified return types are not handled here");
 
+  // Argument-dependent lookup can find any function that is not a member of
+  // a class, so calls whose overload resolution was cached may now resolve
+  // differently. Specializations of function templates are not new
+  // candidates, and do not matter.
+  if ((!NewFD->isCXXClassMember() || NewFD->getFriendObjectKind()) &&
+      !NewFD->isFunctionTemplateSpecialization())
+    invalidateOverloadCache();
+
   // Filter out any non-conflicting previous declarations.
   filterNonConflictingPreviousDecls(Context, NewFD, Previous);
 
@@ -8837,9 +8845,10 @@ void Sema::ActOnDocumentableDecls(ArrayRef<Decl *> Group) {
   }
 
   // See if there are any new comments that are not attached to a decl.
-  ArrayRef<RawComment *> Comments = Context.getRawCommentList().getComments();
-  if (!Comments.empty() &&
-      !Comments.back()->isAttached()) {
+  const RawComment *LastComment =
+      Context.getRawCommentList().getLastComment();
+  if (LastComment && !LastComment->isAttached() &&
+      LastComment != StaleDocComment) {
     // There is at least one comment that not attached to a decl.
     // Maybe it should be attached to one of these decls?
     //
@@ -8849,6 +8858,15 @@ void Sema::ActOnDocumentableDecls(ArrayRef<Decl *> Group) {
     // ahead through comments.
     for (unsigned i = 0, e = Group.size(); i != e; ++i)
       Context.getCommentForDecl(Group[i], &PP);
+
+    // A comment that comes before these decls and isn't theirs, such as one
+    // that is followed by a preprocessor directive, won't be that of any decl
+    // that follows them either.
+    if (!LastComment->isAttached() &&
+        SourceMgr.isBeforeInTranslationUnit(
+            LastComment->getSourceRange().getBegin(),
+            Group.back()->getLocStart()))
+      StaleDocComment = LastComment;
   }
 }
 
@@ -1194,6 +1194,102 @@ static void handleAllocSizeAttr(Sema &S, Decl *D, const AttributeList &Attr) {
                            Attr.getAttributeSpellingListIndex()));
 }
 
+static void handleAllocAlignAttr(Sema &S, Decl *D,
+                                 const AttributeList &Attr) {
+  if (!isFunctionOrMethod(D)) {
+    S.Diag(Attr.getLoc(), diag::warn_attribute_wrong_decl_type)
+      << Attr.getName() << ExpectedFunctionOrMethod;
+    return;
+  }
+
+  if (!checkAttributeNumArgs(S, Attr, 1))
+    return;
+
+  Expr *IdxExpr = Attr.getArg(0);
+  uint64_t Idx;
+  if (!checkFunctionOrMethodArgumentIndex(S, D, Attr.getName()->getName(),
+                                          Attr.getLoc(), 1, IdxExpr, Idx))
+    return;
+
+  // The alignment is the value of an integer parameter.
+  QualType T = getFunctionOrMethodArgType(D, Idx).getNonReferenceType();
+  if (!T->isIntegerType()) {
+    S.Diag(Attr.getLoc(), diag::err_attribute_argument_type)
+      << Attr.getName() << AANT_ArgumentIntegerConstant
+      << IdxExpr->getSourceRange();
+    return;
+  }
+
+  if (!getFunctionType(D)->getResultType()->isAnyPointerType()) {
+    S.Diag(Attr.getLoc(), diag::warn_ns_attribute_wrong_return_type)
+      << Attr.getName() << 0 /*function*/<< 1 /*pointer*/
+      << D->getSourceRange();
+    return;
+  }
+
+  D->addAttr(::new (S.Context)
+             AllocAlignAttr(Attr.getRange(), S.Context, Idx,
+                            Attr.getAttributeSpellingListIndex()));
+}
+
+static void handleAssumeAlignedAttr(Sema &S, Decl *D,
+                                    const AttributeList &Attr) {
+  if (!isFunctionOrMethod(D)) {
+    S.Diag(Attr.getLoc(), diag::warn_attribute_wrong_decl_type)
+      << Attr.getName() << ExpectedFunctionOrMethod;
+    return;
+  }
+
+  if (!checkAttributeAtLeastNumArgs(S, Attr, 1))
+    return;
+  if (Attr.getNumArgs() > 2) {
+    S.Diag(Attr.getLoc(), diag::err_attribute_too_many_arguments) << 2;
+    return;
+  }
+
+  llvm::APSInt Alignment(32);
+  Expr *AlignmentExpr = Attr.getArg(0);
+  if (AlignmentExpr->isTypeDependent() || AlignmentExpr->isValueDependent() ||
+      !AlignmentExpr->isIntegerConstantExpr(Alignment, S.Context)) {
+    S.Diag(Attr.getLoc(), diag::err_attribute_argument_n_type)
+      << Attr.getName() << 1 << AANT_ArgumentIntegerConstant
+      << AlignmentExpr->getSourceRange();
+    return;
+  }
+
+  if (!Alignment.isPowerOf2()) {
+    S.Diag(AlignmentExpr->getExprLoc(),
+           diag::err_attribute_aligned_not_power_of_two)
+      << AlignmentExpr->getSourceRange();
+    return;
+  }
+
+  llvm::APSInt Offset(32);
+  if (Attr.getNumArgs() > 1) {
+    Expr *OffsetExpr = Attr.getArg(1);
+    if (OffsetExpr->isTypeDependent() || OffsetExpr->isValueDependent() ||
+        !OffsetExpr->isIntegerConstantExpr(Offset, S.Context)) {
+      S.Diag(Attr.getLoc(), diag::err_attribute_argument_n_type)
+        << Attr.getName() << 2 << AANT_ArgumentIntegerConstant
+        << OffsetExpr->getSourceRange();
+      return;
+    }
+  }
+
+  if (!getFunctionType(D)->getResultType()->isAnyPointerType()) {
+    S.Diag(Attr.getLoc(), diag::warn_ns_attribute_wrong_return_type)
+      << Attr.getName() << 0 /*function*/<< 1 /*pointer*/
+      << D->getSourceRange();
+    return;
+  }
+
+  D->addAttr(::new (S.Context)
+             AssumeAlignedAttr(Attr.getRange(), S.Context,
+                               Alignment.getZExtValue(),
+                               Offset.getSExtValue(),
+                               Attr.getAttributeSpellingListIndex()));
+}
+
 static void handleNonNullAttr(Sema &S, Decl *D, const AttributeList &Attr) {
   // GCC ignores the nonnull attribute on K&R style function prototypes, so we
   // ignore it as well
@@ -2823,6 +2919,47 @@ static void handleSectionAttr(Sema &S, Decl *D, const AttributeList &Attr) {
     D->addAttr(NewAttr);
 }
 
+static void handleTargetAttr(Sema &S, Decl *D, const AttributeList &Attr) {
+  if (!checkAttributeNumArgs(S, Attr, 1))
+    return;
+
+  if (!isa<FunctionDecl>(D)) {
+    S.Diag(Attr.getLoc(), diag::warn_attribute_wrong_decl_type)
+      << Attr.getName() << ExpectedFunction;
+    return;
+  }
+
+  Expr *ArgExpr = Attr.getArg(0);
+  StringLiteral *SE = dyn_cast<StringLiteral>(ArgExpr);
+  if (!SE) {
+    S.Diag(ArgExpr->getLocStart(), diag::err_attribute_argument_type)
+      << Attr.getName() << AANT_ArgumentString;
+    return;
+  }
+
+  // The string is a comma-separated list of features, each of which may be
+  // turned off with a "no-" prefix. They must all be known to the target,
+  // since the backend is given them as they are.
+  const TargetInfo &Target = S.Context.getTargetInfo();
+  llvm::StringMap<bool> Features;
+  Target.getDefaultFeatures(Features);
+  SmallVector<StringRef, 4> Names;
+  SE->getString().split(Names, ",");
+  for (unsigned i = 0, e = Names.size(); i != e; ++i) {
+    StringRef Name = Names[i].trim();
+    bool Enabled = !Name.startswith("no-");
+    if (!Target.setFeatureEnabled(Features, Enabled ? Name : Name.substr(3),
+                                  Enabled)) {
+      S.Diag(SE->getLocStart(), diag::warn_unsupported_target_attribute)
+        << Name;
+      return;
+    }
+  }
+
+  unsigned Index = Attr.getAttributeSpellingListIndex();
+  D->addAttr(::new (S.Context) TargetAttr(Attr.getRange(), S.Context,
+                                          SE->getString(), Index));
+}
 
 static void handleNothrowAttr(Sema &S, Decl *D, const AttributeList &Attr) {
   // check the attribute arguments.
@@ -4709,7 +4846,11 @@ static void ProcessInheritableDeclAttr(Sema &S, Scope *scope, Decl *D,
     break;
   case AttributeList::AT_Alias:       handleAliasAttr       (S, D, Attr); break;
   case AttributeList::AT_Aligned:     handleAlignedAttr     (S, D, Attr); break;
+  case AttributeList::AT_AllocAlign:  handleAllocAlignAttr  (S, D, Attr); break;
   case AttributeList::AT_AllocSize:   handleAllocSizeAttr   (S, D, Attr); break;
+  case AttributeList::AT_AssumeAligned:
+    handleAssumeAlignedAttr(S, D, Attr);
+    break;
   case AttributeList::AT_AlwaysInline:
     handleAlwaysInlineAttr  (S, D, Attr); break;
   case AttributeList::AT_AnalyzerNoReturn:
@@ -4807,6 +4948,7 @@ static void ProcessInheritableDeclAttr(Sema &S, Scope *scope, Decl *D,
       
   case AttributeList::AT_Packed:      handlePackedAttr      (S, D, Attr); break;
   case AttributeList::AT_Section:     handleSectionAttr     (S, D, Attr); break;
+  case AttributeList::AT_Target:      handleTargetAttr      (S, D, Attr); break;
   case AttributeList::AT_Unavailable:
     handleAttrWithMessage<UnavailableAttr>(S, D, Attr);
     break;
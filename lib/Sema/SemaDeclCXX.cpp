@@ -6994,6 +6994,12 @@ UsingShadowDecl *Sema::BuildUsingShadowDecl(Scope *S,
   else
     CurContext->addDecl(Shadow);
 
+  // Argument-dependent lookup can find functions named by using-declarations
+  // in namespaces.
+  if (!CurContext->isRecord() &&
+      (isa<FunctionDecl>(Target) || isa<FunctionTemplateDecl>(Target)))
+    invalidateOverloadCache();
+
 
   return Shadow;
 }
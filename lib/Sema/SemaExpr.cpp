@@ -11029,6 +11029,11 @@ void Sema::MarkFunctionReferenced(SourceLocation Loc, FunctionDecl *Func) {
   if (FPT && isUnresolvedExceptionSpec(FPT->getExceptionSpecType()))
     ResolveExceptionSpec(Loc, FPT);
 
+  // The body of a late parsed inline method is parsed at the end of the
+  // translation unit once the method is used.
+  if (Func->isLateTemplateParsed() && UnusedLateParsedInlineMethods.erase(Func))
+    UsedLateParsedInlineMethods.push_back(Func);
+
   // Implicit instantiation of function templates and member functions of
   // class templates.
   if (Func->isImplicitlyInstantiable()) {
@@ -1218,6 +1218,25 @@ void InitListChecker::CheckVectorType(const InitializedEntity &Entity,
   }
 }
 
+/// \brief Determine whether \p Init is a literal of the arithmetic type
+/// \p ElemType, possibly negated or parenthesized, which initializes an
+/// element of that type as it is, without any conversion.
+static bool isUnconvertedScalarLiteral(ASTContext &Context, Expr *Init,
+                                       QualType ElemType) {
+  if (!ElemType->isIntegerType() && !ElemType->isRealFloatingType())
+    return false;
+  if (!Init->isRValue() ||
+      !Context.hasSameUnqualifiedType(Init->getType(), ElemType))
+    return false;
+
+  Expr *E = Init->IgnoreParens();
+  if (UnaryOperator *UO = dyn_cast<UnaryOperator>(E))
+    if (UO->getOpcode() == UO_Minus || UO->getOpcode() == UO_Plus)
+      E = UO->getSubExpr()->IgnoreParens();
+  return isa<IntegerLiteral>(E) || isa<FloatingLiteral>(E) ||
+         isa<CharacterLiteral>(E) || isa<CXXBoolLiteralExpr>(E);
+}
+
 void InitListChecker::CheckArrayType(const InitializedEntity &Entity,
                                      InitListExpr *IList, QualType &DeclType,
                                      llvm::APSInt elementIndex,
@@ -1310,12 +1329,26 @@ void InitListChecker::CheckArrayType(const InitializedEntity &Entity,
     if (maxElementsKnown && elementIndex == maxElements)
       break;
 
-    InitializedEntity ElementEntity =
-      InitializedEntity::InitializeElement(SemaRef.Context, StructuredIndex,
-                                           Entity);
-    // Check this element.
-    CheckSubElementType(ElementEntity, IList, elementType, Index,
-                        StructuredList, StructuredIndex);
+    if (isUnconvertedScalarLiteral(SemaRef.Context, Init, elementType)) {
+      // Generated tables can have a great many elements, which are mostly
+      // literals of the element type; those are used as they are, without
+      // building an initialization sequence for each, as CheckScalarType
+      // would.
+      if (!VerifyOnly) {
+        if (hadError)
+          ++StructuredIndex;
+        else
+          UpdateStructuredListElement(StructuredList, StructuredIndex, Init);
+      }
+      ++Index;
+    } else {
+      InitializedEntity ElementEntity =
+        InitializedEntity::InitializeElement(SemaRef.Context, StructuredIndex,
+                                             Entity);
+      // Check this element.
+      CheckSubElementType(ElementEntity, IList, elementType, Index,
+                          StructuredList, StructuredIndex);
+    }
     ++elementIndex;
 
     // If the array is of incomplete type, keep track of the number of
@@ -39,6 +39,7 @@
 #include "llvm/ADT/TinyPtrVector.h"
 #include "llvm/ADT/edit_distance.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/Timer.h"
 #include <algorithm>
 #include <iterator>
 #include <limits>
@@ -1295,8 +1296,7 @@ bool Sema::LookupName(LookupResult &R, Scope *S, bool AllowBuiltinCreation) {
         if (I != IEnd) {
           // Find the scope in which this declaration was declared (if it
           // actually exists in a Scope).
-          while (S && !S->isDeclScope(D))
-            S = S->getParent();
+          S = S->getDeclScope(D);
           
           // If the scope containing the declaration is the translation unit,
           // then we'll need to perform our checks based on the matching
@@ -3421,6 +3421,71 @@ void TypoCorrectionConsumer::addCorrection(TypoCorrection Correction) {
     erase(llvm::prior(CorrectionResults.end()));
 }
 
+void TypoCorrectionNameIndex::addName(NamesByLength &Index, StringRef Name) {
+  if (Name.size() >= Index.size())
+    Index.resize(Name.size() + 1);
+  Index[Name.size()].push_back(Name);
+}
+
+void TypoCorrectionNameIndex::update(IdentifierTable &Idents) {
+  // Identifiers are never removed from the table, so it has new ones exactly
+  // when it has grown. We can't tell which those are, but collecting the
+  // names is cheap next to computing their edit distances.
+  if (Idents.size() != NumLocalNames) {
+    LocalNames.clear();
+    for (IdentifierTable::iterator I = Idents.begin(), IEnd = Idents.end();
+         I != IEnd; ++I)
+      addName(LocalNames, I->getKey());
+    NumLocalNames = Idents.size();
+  }
+
+  IdentifierInfoLookup *Lookup = Idents.getExternalIdentifierLookup();
+  if (Lookup == External &&
+      (!Lookup || Lookup->getIdentifiersGeneration() == ExternalGeneration))
+    return;
+
+  ExternalNames.clear();
+  External = Lookup;
+  if (!Lookup)
+    return;
+  ExternalGeneration = Lookup->getIdentifiersGeneration();
+  OwningPtr<IdentifierIterator> Iter(Lookup->getIdentifiers());
+  do {
+    StringRef Name = Iter->Next();
+    if (Name.empty())
+      break;
+
+    addName(ExternalNames, Name);
+  } while (true);
+}
+
+void TypoCorrectionNameIndex::getNames(
+    unsigned MinLength, unsigned MaxLength,
+    SmallVectorImpl<StringRef> &Names) const {
+  for (unsigned Length = MinLength; Length <= MaxLength; ++Length) {
+    if (Length < LocalNames.size())
+      Names.append(LocalNames[Length].begin(), LocalNames[Length].end());
+    if (Length < ExternalNames.size())
+      Names.append(ExternalNames[Length].begin(), ExternalNames[Length].end());
+  }
+}
+
+namespace {
+/// \brief Adds the time spent in its scope to the time spent correcting typos.
+class TypoCorrectionTimer {
+  double &TotalTime;
+  double Start;
+
+public:
+  explicit TypoCorrectionTimer(double &TotalTime)
+    : TotalTime(TotalTime),
+      Start(llvm::TimeRecord::getCurrentTime().getWallTime()) {}
+  ~TypoCorrectionTimer() {
+    TotalTime += llvm::TimeRecord::getCurrentTime(false).getWallTime() - Start;
+  }
+};
+}
+
 // Fill the supplied vector with the IdentifierInfo pointers for each piece of
 // the given NestedNameSpecifier (i.e. given a NestedNameSpecifier "foo::bar::",
 // fill the vector with the IdentifierInfo pointers for "foo" and "bar").
@@ -3892,6 +3957,13 @@ TypoCorrection Sema::CorrectTypo(const DeclarationNameInfo &TypoName,
   if (S && S->isInObjcMethodScope() && Typo == getSuperIdentifier())
     return TypoCorrection();
 
+  // Once the time budget for typo correction is used up, stop trying, so that
+  // error recovery on badly broken code stays quick.
+  unsigned Budget = getLangOpts().TypoCorrectionBudget;
+  if (Budget && TypoCorrectionTime * 1000 >= Budget)
+    return TypoCorrection();
+  TypoCorrectionTimer Timer(TypoCorrectionTime);
+
   NamespaceSpecifierSet Namespaces(Context, CurContext, SS);
 
   TypoCorrectionConsumer Consumer(*this, Typo);
@@ -3965,26 +4037,16 @@ TypoCorrection Sema::CorrectTypo(const DeclarationNameInfo &TypoName,
   
   if (IsUnqualifiedLookup || SearchNamespaces) {
     // For unqualified lookup, look through all of the names that we have
-    // seen in this translation unit.
-    // FIXME: Re-add the ability to skip very unlikely potential corrections.
-    for (IdentifierTable::iterator I = Context.Idents.begin(),
-                                IEnd = Context.Idents.end();
-         I != IEnd; ++I)
-      Consumer.FoundName(I->getKey());
-
-    // Walk through identifiers in external identifier sources.
-    // FIXME: Re-add the ability to skip very unlikely potential corrections.
-    if (IdentifierInfoLookup *External
-                            = Context.Idents.getExternalIdentifierLookup()) {
-      OwningPtr<IdentifierIterator> Iter(External->getIdentifiers());
-      do {
-        StringRef Name = Iter->Next();
-        if (Name.empty())
-          break;
-
-        Consumer.FoundName(Name);
-      } while (true);
-    }
+    // seen in this translation unit, and those in external identifier
+    // sources. Names whose lengths differ from that of the typo by more than
+    // a third of it can't be corrections, so only look at the others.
+    TypoNames.update(Context.Idents);
+    unsigned TypoLength = Typo->getName().size();
+    SmallVector<StringRef, 64> Names;
+    TypoNames.getNames(TypoLength - TypoLength / 3, TypoLength + TypoLength / 3,
+                       Names);
+    for (unsigned I = 0, N = Names.size(); I != N; ++I)
+      Consumer.FoundName(Names[I]);
   }
 
   AddKeywordsToConsumer(*this, Consumer, S, CCC, SS && SS->isNotEmpty());
@@ -27,6 +27,7 @@
 #include "clang/Sema/SemaInternal.h"
 #include "clang/Sema/Template.h"
 #include "clang/Sema/TemplateDeduction.h"
+#include "clang/Sema/TemplateProfiler.h"
 #include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallPtrSet.h"
@@ -789,6 +790,7 @@ void OverloadCandidateSet::destroyCandidates() {
 
 void OverloadCandidateSet::clear() {
   destroyCandidates();
+  Scratch.reset();
   NumInlineSequences = 0;
   Candidates.clear();
   Functions.clear();
@@ -1106,7 +1108,7 @@ TryUserDefinedConversion(Sema &S, Expr *From, QualType ToType,
   }
 
   // Attempt user-defined conversion.
-  OverloadCandidateSet Conversions(From->getExprLoc());
+  OverloadCandidateSet Conversions(From->getExprLoc(), &S.Scratch);
   OverloadingResult UserDefResult
     = IsUserDefinedConversion(S, From, ToType, ICS.UserDefined, Conversions,
                               AllowExplicit);
@@ -3994,7 +3996,7 @@ FindConversionForRefInit(Sema &S, ImplicitConversionSequence &ICS,
   CXXRecordDecl *T2RecordDecl
     = dyn_cast<CXXRecordDecl>(T2->getAs<RecordType>()->getDecl());
 
-  OverloadCandidateSet CandidateSet(DeclLoc);
+  OverloadCandidateSet CandidateSet(DeclLoc, &S.Scratch);
   std::pair<CXXRecordDecl::conversion_iterator,
             CXXRecordDecl::conversion_iterator>
     Conversions = T2RecordDecl->getVisibleConversionFunctions();
@@ -4628,6 +4630,125 @@ static bool TryCopyInitialization(const CanQualType FromQTy,
   return !ICS.isBad();
 }
 
+/// \brief Determine whether the class \p Class certainly has no converting
+/// constructor that could accept an argument of type \p FromType.
+///
+/// Copy and move constructors do not count: an argument that is neither of
+/// the class nor derived from it would first need a user-defined conversion
+/// to the class, which C++ [over.best.ics]p4 does not allow. For the same
+/// reason, an argument of class type only reaches the first parameter of a
+/// constructor if that parameter is of the argument's class or one of its
+/// bases.
+static bool hasNoConvertingConstructorFrom(Sema &S, CXXRecordDecl *Class,
+                                           QualType FromType) {
+  CanQualType ClassType
+    = S.Context.getCanonicalType(S.Context.getRecordType(Class));
+  DeclContext::lookup_result R
+    = Class->lookup(S.Context.DeclarationNames.getCXXConstructorName(ClassType));
+  for (DeclContext::lookup_iterator I = R.begin(), E = R.end(); I != E; ++I) {
+    // Constructor templates could be deduced to accept anything.
+    CXXConstructorDecl *Constructor = dyn_cast<CXXConstructorDecl>(*I);
+    if (!Constructor)
+      return false;
+    if (Constructor->isInvalidDecl() || Constructor->isCopyOrMoveConstructor() ||
+        !Constructor->isConvertingConstructor(/*AllowExplicit=*/true))
+      continue;
+    if (!FromType->isRecordType() || Constructor->getNumParams() == 0)
+      return false;
+
+    QualType ParamType
+      = Constructor->getParamDecl(0)->getType().getNonReferenceType();
+    if (ParamType->isDependentType())
+      return false;
+    if (ParamType->isRecordType() &&
+        (S.Context.hasSameUnqualifiedType(ParamType, FromType) ||
+         S.IsDerivedFrom(FromType, ParamType)))
+      return false;
+  }
+  return true;
+}
+
+/// \brief Determine, without enumerating constructors and conversion
+/// functions as the full check does, whether the argument \p From certainly
+/// cannot be converted to the parameter type \p ToType of an overload
+/// candidate.
+///
+/// Only conversions between a class and an unrelated type are recognized:
+/// those where the argument's class, if any, has no conversion functions
+/// and the parameter's class, if any, has no constructor that could accept
+/// the argument. These are common when expression-template libraries
+/// overload operators for many unrelated classes.
+static bool isCertainlyNotConvertible(Sema &S, Expr *From, QualType ToType) {
+  if (!S.getLangOpts().CPlusPlus || ToType->isDependentType() ||
+      From->isTypeDependent() || isa<InitListExpr>(From) ||
+      From->getType()->isPlaceholderType())
+    return false;
+
+  QualType FromType = From->getType();
+  QualType ToClassType = ToType.getNonReferenceType();
+  const RecordType *FromRecord = FromType->getAs<RecordType>();
+  const RecordType *ToRecord = ToClassType->getAs<RecordType>();
+  if (!FromRecord && !ToRecord)
+    return false;
+
+  if (FromRecord) {
+    if (FromType->isIncompleteType())
+      return false;
+    std::pair<CXXRecordDecl::conversion_iterator,
+              CXXRecordDecl::conversion_iterator>
+      Conversions = cast<CXXRecordDecl>(FromRecord->getDecl())
+                      ->getVisibleConversionFunctions();
+    if (Conversions.first != Conversions.second)
+      return false;
+  }
+
+  if (ToRecord) {
+    if (ToClassType->isIncompleteType())
+      return false;
+    if (FromRecord &&
+        (S.Context.hasSameUnqualifiedType(FromType, ToClassType) ||
+         S.IsDerivedFrom(FromType, ToClassType)))
+      return false;
+    if (!hasNoConvertingConstructorFrom(
+            S, cast<CXXRecordDecl>(ToRecord->getDecl()), FromType))
+      return false;
+  }
+  return true;
+}
+
+/// \brief Compute the implicit conversion sequence of the argument \p From
+/// of an overload candidate to its parameter type \p ToType, ruling out the
+/// argument cheaply if it certainly cannot be converted.
+static ImplicitConversionSequence
+TryArgumentInitialization(Sema &S, Expr *From, QualType ToType,
+                          bool SuppressUserConversions,
+                          bool AllowExplicit = false) {
+  if (!isCertainlyNotConvertible(S, From, ToType))
+    return TryCopyInitialization(S, From, ToType, SuppressUserConversions,
+                                 /*InOverloadResolution=*/true,
+                                 /*AllowObjCWritebackConversion=*/
+                                   S.getLangOpts().ObjCAutoRefCount,
+                                 AllowExplicit);
+
+  ++S.NumOverloadConversionsRuledOut;
+
+  // Describe the failure as TryCopyInitialization would, so that the notes
+  // on candidates do not change: only the initialization of the temporary
+  // that a reference to const or an rvalue reference binds to names the
+  // referenced type.
+  QualType BadToType = ToType;
+  if (const ReferenceType *RefType = ToType->getAs<ReferenceType>()) {
+    QualType T1 = RefType->getPointeeType();
+    if (!SuppressUserConversions &&
+        (ToType->isRValueReferenceType() ||
+         (T1.isConstQualified() && !T1.isVolatileQualified())))
+      BadToType = T1;
+  }
+  ImplicitConversionSequence ICS;
+  ICS.setBad(BadConversionSequence::no_conversion, From, BadToType);
+  return ICS;
+}
+
 /// TryObjectArgumentInitialization - Try to initialize the object
 /// parameter of the given member function (@c Method) from the
 /// expression @p From.
@@ -5510,12 +5631,8 @@ Sema::AddOverloadCandidate(FunctionDecl *Function,
       // parameter of F.
       QualType ParamType = Proto->getArgType(ArgIdx);
       Candidate.Conversions[ArgIdx]
-        = TryCopyInitialization(*this, Args[ArgIdx], ParamType,
-                                SuppressUserConversions,
-                                /*InOverloadResolution=*/true,
-                                /*AllowObjCWritebackConversion=*/
-                                  getLangOpts().ObjCAutoRefCount,
-                                AllowExplicit);
+        = TryArgumentInitialization(*this, Args[ArgIdx], ParamType,
+                                    SuppressUserConversions, AllowExplicit);
       if (Candidate.Conversions[ArgIdx].isBad()) {
         Candidate.Viable = false;
         Candidate.FailureKind = ovl_fail_bad_conversion;
@@ -5683,11 +5800,8 @@ Sema::AddMethodCandidate(CXXMethodDecl *Method, DeclAccessPair FoundDecl,
       // parameter of F.
       QualType ParamType = Proto->getArgType(ArgIdx);
       Candidate.Conversions[ArgIdx + 1]
-        = TryCopyInitialization(*this, Args[ArgIdx], ParamType,
-                                SuppressUserConversions,
-                                /*InOverloadResolution=*/true,
-                                /*AllowObjCWritebackConversion=*/
-                                  getLangOpts().ObjCAutoRefCount);
+        = TryArgumentInitialization(*this, Args[ArgIdx], ParamType,
+                                    SuppressUserConversions);
       if (Candidate.Conversions[ArgIdx + 1].isBad()) {
         Candidate.Viable = false;
         Candidate.FailureKind = ovl_fail_bad_conversion;
@@ -10176,6 +10290,24 @@ bool Sema::buildOverloadedCallSet(Scope *S, Expr *Fn,
   return false;
 }
 
+/// \brief Build the call through \p ULE to the function \p FDecl, found as
+/// \p FoundDecl, that overload resolution chose.
+static ExprResult FinishResolvedCallExpr(Sema &SemaRef, Expr *Fn,
+                                         UnresolvedLookupExpr *ULE,
+                                         SourceLocation LParenLoc,
+                                         MultiExprArg Args,
+                                         SourceLocation RParenLoc,
+                                         Expr *ExecConfig,
+                                         FunctionDecl *FDecl,
+                                         DeclAccessPair FoundDecl) {
+  SemaRef.CheckUnresolvedLookupAccess(ULE, FoundDecl);
+  if (SemaRef.DiagnoseUseOfDecl(FDecl, ULE->getNameLoc()))
+    return ExprError();
+  Fn = SemaRef.FixOverloadedFunctionReference(Fn, FoundDecl, FDecl);
+  return SemaRef.BuildResolvedCallExpr(Fn, FDecl, LParenLoc, Args, RParenLoc,
+                                       ExecConfig);
+}
+
 /// FinishOverloadedCallExpr - given an OverloadCandidateSet, builds and returns
 /// the completed call expression. If overload resolution fails, emits
 /// diagnostics and returns ExprError()
@@ -10195,15 +10327,10 @@ static ExprResult FinishOverloadedCallExpr(Sema &SemaRef, Scope *S, Expr *Fn,
                                  AllowTypoCorrection);
 
   switch (OverloadResult) {
-  case OR_Success: {
-    FunctionDecl *FDecl = (*Best)->Function;
-    SemaRef.CheckUnresolvedLookupAccess(ULE, (*Best)->FoundDecl);
-    if (SemaRef.DiagnoseUseOfDecl(FDecl, ULE->getNameLoc()))
-      return ExprError();
-    Fn = SemaRef.FixOverloadedFunctionReference(Fn, (*Best)->FoundDecl, FDecl);
-    return SemaRef.BuildResolvedCallExpr(Fn, FDecl, LParenLoc, Args, RParenLoc,
-                                         ExecConfig);
-  }
+  case OR_Success:
+    return FinishResolvedCallExpr(SemaRef, Fn, ULE, LParenLoc, Args, RParenLoc,
+                                  ExecConfig, (*Best)->Function,
+                                  (*Best)->FoundDecl);
 
   case OR_No_Viable_Function: {
     // Try to recover by looking for viable functions which the user might
@@ -10249,6 +10376,104 @@ static ExprResult FinishOverloadedCallExpr(Sema &SemaRef, Scope *S, Expr *Fn,
   return ExprError();
 }
 
+void Sema::invalidateOverloadCache() {
+  if (OverloadCache)
+    OverloadCache->clear();
+  if (DeductionCache)
+    DeductionCache->clear();
+}
+
+bool clang::mayBeCompletedLater(QualType T) {
+  T = T.getNonReferenceType();
+  if (const MemberPointerType *MemPtr = T->getAs<MemberPointerType>()) {
+    if (MemPtr->getClass()->isIncompleteType())
+      return true;
+    T = MemPtr->getPointeeType();
+  } else if (const PointerType *Ptr = T->getAs<PointerType>()) {
+    T = Ptr->getPointeeType();
+  }
+  const Type *Base = T->getBaseElementTypeUnsafe();
+  return (Base->isRecordType() || Base->isEnumeralType()) &&
+         Base->isIncompleteType();
+}
+
+/// \brief Build the key under which the result of overload resolution is
+/// cached for a call, of kind \p Kind, to \p Name, which name lookup found
+/// the functions [\p Begin, \p End) for, with the arguments \p Args.
+///
+/// \returns false if the result of overload resolution for the call may
+/// depend on more than the key, and so must not be cached.
+static bool buildOverloadCacheKey(Sema &S, unsigned Kind, DeclarationName Name,
+                                  bool ADL, UnresolvedSetIterator Begin,
+                                  UnresolvedSetIterator End,
+                                  ArrayRef<Expr *> Args,
+                                  OverloadResolutionCache::KeyTy &Key) {
+  const LangOptions &LangOpts = S.getLangOpts();
+  if (!S.OverloadCache || LangOpts.ObjC1 || LangOpts.CUDA ||
+      LangOpts.Modules || S.CurContext->isDependentContext())
+    return false;
+
+  Key.push_back(Kind);
+  Key.push_back(reinterpret_cast<uintptr_t>(Name.getAsOpaquePtr()));
+  Key.push_back(ADL);
+  for (UnresolvedSetIterator I = Begin; I != End; ++I) {
+    Key.push_back(reinterpret_cast<uintptr_t>(I.getDecl()));
+    Key.push_back(I.getAccess());
+  }
+  Key.push_back(0);
+
+  for (unsigned I = 0, N = Args.size(); I != N; ++I) {
+    Expr *Arg = Args[I];
+    QualType T = Arg->getType();
+
+    // The conversions of null pointer constants, string literals,
+    // initializer lists, overload sets and bit-fields depend on more than
+    // their types and value kinds.
+    if (Arg->isTypeDependent() || Arg->isValueDependent() ||
+        T->isPlaceholderType() || isa<InitListExpr>(Arg) ||
+        Arg->getObjectKind() != OK_Ordinary ||
+        isa<StringLiteral>(Arg->IgnoreParens()) || mayBeCompletedLater(T))
+      return false;
+    if (T->isIntegralOrEnumerationType() &&
+        Arg->isNullPointerConstant(S.Context,
+                                   Expr::NPC_ValueDependentIsNotNull))
+      return false;
+
+    if (CXXRecordDecl *Record = T->getAsCXXRecordDecl()) {
+      std::pair<CXXRecordDecl::conversion_iterator,
+                CXXRecordDecl::conversion_iterator>
+        Conversions = Record->getVisibleConversionFunctions();
+      for (CXXRecordDecl::conversion_iterator C = Conversions.first;
+           C != Conversions.second; ++C) {
+        CXXConversionDecl *Conv
+          = dyn_cast<CXXConversionDecl>((*C)->getUnderlyingDecl());
+        if (!Conv || mayBeCompletedLater(Conv->getConversionType()))
+          return false;
+      }
+    }
+
+    Key.push_back(reinterpret_cast<uintptr_t>(
+                    S.Context.getCanonicalType(T).getAsOpaquePtr()));
+    Key.push_back(Arg->getValueKind());
+  }
+  return true;
+}
+
+/// \brief Determine whether the parameters of the candidates in
+/// \p CandidateSet are complete enough for the result of overload resolution
+/// to be cached.
+static bool canCacheCandidates(OverloadCandidateSet &CandidateSet) {
+  for (OverloadCandidateSet::iterator Cand = CandidateSet.begin(),
+         CandEnd = CandidateSet.end(); Cand != CandEnd; ++Cand) {
+    if (!Cand->Function)
+      continue;
+    for (unsigned I = 0, N = Cand->Function->getNumParams(); I != N; ++I)
+      if (mayBeCompletedLater(Cand->Function->getParamDecl(I)->getType()))
+        return false;
+  }
+  return true;
+}
+
 /// BuildOverloadedCallExpr - Given the call expression that calls Fn
 /// (which eventually refers to the declaration Func) and the call
 /// arguments Args/NumArgs, attempt to resolve the function call down
@@ -10262,7 +10487,29 @@ ExprResult Sema::BuildOverloadedCallExpr(Scope *S, Expr *Fn,
                                          SourceLocation RParenLoc,
                                          Expr *ExecConfig,
                                          bool AllowTypoCorrection) {
-  OverloadCandidateSet CandidateSet(Fn->getExprLoc());
+  TemplateProfiler::Scope Profile(getTemplateProfiler(), "overload resolution",
+                                  ULE->getName());
+
+  // Reuse the result of overload resolution for an earlier call with the
+  // same candidates and arguments of the same types.
+  OverloadResolutionCache::KeyTy CacheKey;
+  bool Cacheable = !ExecConfig && !ULE->hasExplicitTemplateArgs() &&
+                   buildOverloadCacheKey(*this, /*Kind=*/0, ULE->getName(),
+                                         ULE->requiresADL(),
+                                         ULE->decls_begin(), ULE->decls_end(),
+                                         Args, CacheKey);
+  if (Cacheable) {
+    if (const OverloadResolutionCache::Result *Cached
+          = OverloadCache->lookup(CacheKey)) {
+      ++NumOverloadCacheHits;
+      return FinishResolvedCallExpr(*this, Fn, ULE, LParenLoc, Args, RParenLoc,
+                                    ExecConfig, Cached->Function,
+                                    Cached->FoundDecl);
+    }
+    ++NumOverloadCacheMisses;
+  }
+
+  OverloadCandidateSet CandidateSet(Fn->getExprLoc(), &Scratch);
   ExprResult result;
 
   if (buildOverloadedCallSet(S, Fn, ULE, Args, LParenLoc, &CandidateSet,
@@ -10273,6 +10520,14 @@ ExprResult Sema::BuildOverloadedCallExpr(Scope *S, Expr *Fn,
   OverloadingResult OverloadResult =
       CandidateSet.BestViableFunction(*this, Fn->getLocStart(), Best);
 
+  if (Cacheable && OverloadResult == OR_Success &&
+      canCacheCandidates(CandidateSet)) {
+    OverloadResolutionCache::Result R = {
+      Best->Function, Best->FoundDecl, CandidateSet.size() > 1
+    };
+    OverloadCache->insert(CacheKey, R);
+  }
+
   return FinishOverloadedCallExpr(*this, S, Fn, ULE, LParenLoc, Args,
                                   RParenLoc, ExecConfig, &CandidateSet,
                                   &Best, OverloadResult,
@@ -10351,7 +10606,7 @@ Sema::CreateOverloadedUnaryOp(SourceLocation OpLoc, unsigned OpcIn,
   }
 
   // Build an empty overload set.
-  OverloadCandidateSet CandidateSet(OpLoc);
+  OverloadCandidateSet CandidateSet(OpLoc, &Scratch);
 
   // Add the candidates from the given function set.
   AddFunctionCandidates(Fns, ArgsArray, CandidateSet, false);
@@ -10476,6 +10731,82 @@ Sema::CreateOverloadedUnaryOp(SourceLocation OpLoc, unsigned OpcIn,
   return CreateBuiltinUnaryOp(OpLoc, Opc, Input);
 }
 
+ExprResult
+Sema::BuildCallToOverloadedBinOp(SourceLocation OpLoc,
+                                 OverloadedOperatorKind Op, Expr **Args,
+                                 FunctionDecl *FnDecl,
+                                 DeclAccessPair FoundDecl,
+                                 bool HadMultipleCandidates) {
+  // Convert the arguments.
+  if (CXXMethodDecl *Method = dyn_cast<CXXMethodDecl>(FnDecl)) {
+    // FoundDecl's access is only meaningful for class members.
+    CheckMemberOperatorAccess(OpLoc, Args[0], Args[1], FoundDecl);
+
+    ExprResult Arg1 =
+      PerformCopyInitialization(
+        InitializedEntity::InitializeParameter(Context,
+                                               FnDecl->getParamDecl(0)),
+        SourceLocation(), Owned(Args[1]));
+    if (Arg1.isInvalid())
+      return ExprError();
+
+    ExprResult Arg0 =
+      PerformObjectArgumentInitialization(Args[0], /*Qualifier=*/0,
+                                          FoundDecl, Method);
+    if (Arg0.isInvalid())
+      return ExprError();
+    Args[0] = Arg0.takeAs<Expr>();
+    Args[1] = Arg1.takeAs<Expr>();
+  } else {
+    // Convert the arguments.
+    ExprResult Arg0 = PerformCopyInitialization(
+      InitializedEntity::InitializeParameter(Context,
+                                             FnDecl->getParamDecl(0)),
+      SourceLocation(), Owned(Args[0]));
+    if (Arg0.isInvalid())
+      return ExprError();
+
+    ExprResult Arg1 =
+      PerformCopyInitialization(
+        InitializedEntity::InitializeParameter(Context,
+                                               FnDecl->getParamDecl(1)),
+        SourceLocation(), Owned(Args[1]));
+    if (Arg1.isInvalid())
+      return ExprError();
+    Args[0] = Arg0.takeAs<Expr>();
+    Args[1] = Arg1.takeAs<Expr>();
+  }
+
+  // Determine the result type.
+  QualType ResultTy = FnDecl->getResultType();
+  ExprValueKind VK = Expr::getValueKindForType(ResultTy);
+  ResultTy = ResultTy.getNonLValueExprType(Context);
+
+  // Build the actual expression node.
+  ExprResult FnExpr = CreateFunctionRefExpr(*this, FnDecl, FoundDecl,
+                                            HadMultipleCandidates, OpLoc);
+  if (FnExpr.isInvalid())
+    return ExprError();
+
+  CXXOperatorCallExpr *TheCall =
+    new (Context) CXXOperatorCallExpr(Context, Op, FnExpr.take(),
+                                      llvm::makeArrayRef(Args, 2), ResultTy,
+                                      VK, OpLoc, FPFeatures.fp_contract);
+
+  if (CheckCallReturnType(FnDecl->getResultType(), OpLoc, TheCall,
+                          FnDecl))
+    return ExprError();
+
+  ArrayRef<const Expr *> ArgsArray(Args, 2);
+  // Cut off the implicit 'this'.
+  if (isa<CXXMethodDecl>(FnDecl))
+    ArgsArray = ArgsArray.slice(1);
+  checkCall(FnDecl, ArgsArray, 0, isa<CXXMethodDecl>(FnDecl), OpLoc,
+            TheCall->getSourceRange(), VariadicDoesNotApply);
+
+  return MaybeBindToTemporary(TheCall);
+}
+
 /// \brief Create a binary operation that may resolve to an overloaded
 /// operator.
 ///
@@ -10566,8 +10897,26 @@ Sema::CreateOverloadedBinOp(SourceLocation OpLoc,
   if (Opc == BO_PtrMemD)
     return CreateBuiltinBinOp(OpLoc, Opc, Args[0], Args[1]);
 
+  // Reuse the operator function that overload resolution chose for an
+  // earlier use of the operator with the same candidates and operands of the
+  // same types.
+  OverloadResolutionCache::KeyTy CacheKey;
+  bool Cacheable = buildOverloadCacheKey(*this, /*Kind=*/1 + Opc, OpName,
+                                         /*ADL=*/true, Fns.begin(), Fns.end(),
+                                         Args, CacheKey);
+  if (Cacheable) {
+    if (const OverloadResolutionCache::Result *Cached
+          = OverloadCache->lookup(CacheKey)) {
+      ++NumOverloadCacheHits;
+      return BuildCallToOverloadedBinOp(OpLoc, Op, Args, Cached->Function,
+                                        Cached->FoundDecl,
+                                        Cached->HadMultipleCandidates);
+    }
+    ++NumOverloadCacheMisses;
+  }
+
   // Build an empty overload set.
-  OverloadCandidateSet CandidateSet(OpLoc);
+  OverloadCandidateSet CandidateSet(OpLoc, &Scratch);
 
   // Add the candidates from the given function set.
   AddFunctionCandidates(Fns, Args, CandidateSet, false);
@@ -10596,76 +10945,15 @@ Sema::CreateOverloadedBinOp(SourceLocation OpLoc,
       if (FnDecl) {
         // We matched an overloaded operator. Build a call to that
         // operator.
-
-        // Convert the arguments.
-        if (CXXMethodDecl *Method = dyn_cast<CXXMethodDecl>(FnDecl)) {
-          // Best->Access is only meaningful for class members.
-          CheckMemberOperatorAccess(OpLoc, Args[0], Args[1], Best->FoundDecl);
-
-          ExprResult Arg1 =
-            PerformCopyInitialization(
-              InitializedEntity::InitializeParameter(Context,
-                                                     FnDecl->getParamDecl(0)),
-              SourceLocation(), Owned(Args[1]));
-          if (Arg1.isInvalid())
-            return ExprError();
-
-          ExprResult Arg0 =
-            PerformObjectArgumentInitialization(Args[0], /*Qualifier=*/0,
-                                                Best->FoundDecl, Method);
-          if (Arg0.isInvalid())
-            return ExprError();
-          Args[0] = Arg0.takeAs<Expr>();
-          Args[1] = RHS = Arg1.takeAs<Expr>();
-        } else {
-          // Convert the arguments.
-          ExprResult Arg0 = PerformCopyInitialization(
-            InitializedEntity::InitializeParameter(Context,
-                                                   FnDecl->getParamDecl(0)),
-            SourceLocation(), Owned(Args[0]));
-          if (Arg0.isInvalid())
-            return ExprError();
-
-          ExprResult Arg1 =
-            PerformCopyInitialization(
-              InitializedEntity::InitializeParameter(Context,
-                                                     FnDecl->getParamDecl(1)),
-              SourceLocation(), Owned(Args[1]));
-          if (Arg1.isInvalid())
-            return ExprError();
-          Args[0] = LHS = Arg0.takeAs<Expr>();
-          Args[1] = RHS = Arg1.takeAs<Expr>();
+        if (Cacheable && canCacheCandidates(CandidateSet)) {
+          OverloadResolutionCache::Result R = {
+            FnDecl, Best->FoundDecl, HadMultipleCandidates
+          };
+          OverloadCache->insert(CacheKey, R);
         }
-
-        // Determine the result type.
-        QualType ResultTy = FnDecl->getResultType();
-        ExprValueKind VK = Expr::getValueKindForType(ResultTy);
-        ResultTy = ResultTy.getNonLValueExprType(Context);
-
-        // Build the actual expression node.
-        ExprResult FnExpr = CreateFunctionRefExpr(*this, FnDecl,
-                                                  Best->FoundDecl,
-                                                  HadMultipleCandidates, OpLoc);
-        if (FnExpr.isInvalid())
-          return ExprError();
-
-        CXXOperatorCallExpr *TheCall =
-          new (Context) CXXOperatorCallExpr(Context, Op, FnExpr.take(),
-                                            Args, ResultTy, VK, OpLoc,
-                                            FPFeatures.fp_contract);
-
-        if (CheckCallReturnType(FnDecl->getResultType(), OpLoc, TheCall,
-                                FnDecl))
-          return ExprError();
-
-        ArrayRef<const Expr *> ArgsArray(Args, 2);
-        // Cut off the implicit 'this'.
-        if (isa<CXXMethodDecl>(FnDecl))
-          ArgsArray = ArgsArray.slice(1);
-        checkCall(FnDecl, ArgsArray, 0, isa<CXXMethodDecl>(FnDecl), OpLoc, 
-                  TheCall->getSourceRange(), VariadicDoesNotApply);
-
-        return MaybeBindToTemporary(TheCall);
+        return BuildCallToOverloadedBinOp(OpLoc, Op, Args, FnDecl,
+                                          Best->FoundDecl,
+                                          HadMultipleCandidates);
       } else {
         // We matched a built-in operator. Convert the arguments, then
         // break out so that we will build the appropriate built-in
@@ -10798,7 +11086,7 @@ Sema::CreateOverloadedArraySubscriptExpr(SourceLocation LLoc,
     return ExprError();
 
   // Build an empty overload set.
-  OverloadCandidateSet CandidateSet(LLoc);
+  OverloadCandidateSet CandidateSet(LLoc, &Scratch);
 
   // Subscript can only be overloaded as a member function.
 
@@ -11023,7 +11311,7 @@ Sema::BuildCallToMemberFunction(Scope *S, Expr *MemExprE,
                             : UnresExpr->getBase()->Classify(Context);
 
     // Add overload candidates
-    OverloadCandidateSet CandidateSet(UnresExpr->getMemberLoc());
+    OverloadCandidateSet CandidateSet(UnresExpr->getMemberLoc(), &Scratch);
 
     // FIXME: avoid copy.
     TemplateArgumentListInfo TemplateArgsBuffer, *TemplateArgs = 0;
@@ -11207,7 +11495,7 @@ Sema::BuildCallToObjectOfClassType(Scope *S, Expr *Obj,
   //  operators of T. The function call operators of T are obtained by
   //  ordinary lookup of the name operator() in the context of
   //  (E).operator().
-  OverloadCandidateSet CandidateSet(LParenLoc);
+  OverloadCandidateSet CandidateSet(LParenLoc, &Scratch);
   DeclarationName OpName = Context.DeclarationNames.getCXXOperatorName(OO_Call);
 
   if (RequireCompleteType(LParenLoc, Object.get()->getType(),
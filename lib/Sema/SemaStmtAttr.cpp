@@ -14,12 +14,16 @@
 #include "clang/Sema/SemaInternal.h"
 #include "TargetAttributesSema.h"
 #include "clang/AST/ASTContext.h"
+#include "clang/AST/StmtCXX.h"
 #include "clang/Basic/SourceManager.h"
 #include "clang/Lex/Lexer.h"
 #include "clang/Sema/DelayedDiagnostic.h"
+#include "clang/Sema/LoopHint.h"
 #include "clang/Sema/Lookup.h"
 #include "clang/Sema/ScopeInfo.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringSwitch.h"
 
 using namespace clang;
 using namespace sema;
@@ -77,3 +81,65 @@ StmtResult Sema::ProcessStmtAttributes(Stmt *S, AttributeList *AttrList,
 
   return ActOnAttributedStmt(Range.getBegin(), Attrs, S);
 }
+
+/// \brief Builds the LoopHintAttr of \p Hint, or returns null after
+/// diagnosing an invalid value.
+static Attr *handleLoopHint(Sema &S, const LoopHint &Hint) {
+  // The parser only makes hints of the known options.
+  LoopHintAttr::OptionType Option =
+    llvm::StringSwitch<LoopHintAttr::OptionType>(Hint.Option->getName())
+      .Case("vectorize", LoopHintAttr::Vectorize)
+      .Case("vectorize_width", LoopHintAttr::VectorizeWidth)
+      .Case("interleave_count", LoopHintAttr::InterleaveCount)
+      .Case("unroll", LoopHintAttr::Unroll)
+      .Case("unroll_count", LoopHintAttr::UnrollCount);
+
+  int Value;
+  if (LoopHintAttr::isEnableOption(Option)) {
+    if (!Hint.ValueIdent || !(Hint.ValueIdent->isStr("enable") ||
+                              Hint.ValueIdent->isStr("disable"))) {
+      S.Diag(Hint.ValueLoc, diag::err_pragma_loop_invalid_keyword)
+          << Hint.Option;
+      return 0;
+    }
+    Value = Hint.ValueIdent->isStr("enable");
+  } else {
+    llvm::APSInt Result;
+    if (!Hint.ValueExpr ||
+        !Hint.ValueExpr->isIntegerConstantExpr(Result, S.Context) ||
+        !Result.isStrictlyPositive() || Result.getActiveBits() > 31) {
+      S.Diag(Hint.ValueLoc, diag::err_pragma_loop_invalid_value)
+          << Hint.Option;
+      return 0;
+    }
+    Value = Result.getZExtValue();
+  }
+
+  return ::new (S.Context) LoopHintAttr(Hint.Range, S.Context, Option, Value);
+}
+
+StmtResult Sema::ActOnPragmaLoopHints(ArrayRef<LoopHint> Hints, Stmt *Loop) {
+  if (!isa<ForStmt>(Loop) && !isa<WhileStmt>(Loop) && !isa<DoStmt>(Loop) &&
+      !isa<CXXForRangeStmt>(Loop)) {
+    Diag(Hints.front().OptionLoc, diag::err_pragma_loop_precedes_nonloop);
+    return Loop;
+  }
+
+  SmallVector<const Attr *, 4> Attrs;
+  llvm::SmallPtrSet<IdentifierInfo *, 4> SeenOptions;
+  for (unsigned i = 0, e = Hints.size(); i != e; ++i) {
+    const LoopHint &Hint = Hints[i];
+    if (!SeenOptions.insert(Hint.Option)) {
+      Diag(Hint.OptionLoc, diag::err_pragma_loop_duplicate_option)
+          << Hint.Option;
+      continue;
+    }
+    if (Attr *A = handleLoopHint(*this, Hint))
+      Attrs.push_back(A);
+  }
+
+  if (Attrs.empty())
+    return Loop;
+
+  return ActOnAttributedStmt(Hints.front().Range.getBegin(), Attrs, Loop);
+}
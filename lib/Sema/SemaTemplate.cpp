@@ -7908,6 +7908,12 @@ void Sema::MarkAsLateParsedTemplate(FunctionDecl *FD, bool Flag) {
   FD->setLateTemplateParsed(Flag);
 } 
 
+void Sema::MarkAsLateParsedInlineMethod(FunctionDecl *FD) {
+  FD->setLateTemplateParsed(true);
+  LateParsedInlineMethods.push_back(FD);
+  UnusedLateParsedInlineMethods.insert(FD);
+}
+
 bool Sema::IsInsideALocalClassWithinATemplateFunction() {
   DeclContext *DC = CurContext;
 
@@ -19,8 +19,10 @@
 #include "clang/AST/ExprCXX.h"
 #include "clang/AST/StmtVisitor.h"
 #include "clang/Sema/DeclSpec.h"
+#include "clang/Sema/Overload.h"
 #include "clang/Sema/Sema.h"
 #include "clang/Sema/Template.h"
+#include "clang/Sema/TemplateProfiler.h"
 #include "llvm/ADT/SmallBitVector.h"
 #include <algorithm>
 
@@ -3238,6 +3240,100 @@ DeduceTemplateArgumentByListElement(Sema &S,
                                             ArgType, Info, Deduced, TDF);
 }
 
+void DeductionCacheResult::save(unsigned Kind, FunctionDecl *Specialization,
+                                const TemplateDeductionInfo &Info) {
+  this->Kind = Kind;
+  this->Specialization = Specialization;
+  Param = Info.Param;
+  FirstArg = Info.FirstArg;
+  SecondArg = Info.SecondArg;
+  Deduced = Info.getDeduced();
+  HasSFINAEDiagnostic = Info.hasSFINAEDiagnostic();
+  Diagnostics.assign(Info.diag_begin(), Info.diag_end());
+}
+
+void DeductionCacheResult::restore(TemplateDeductionInfo &Info) const {
+  Info.Param = Param;
+  Info.FirstArg = FirstArg;
+  Info.SecondArg = SecondArg;
+  Info.reset(Deduced);
+  for (unsigned I = 0, N = Diagnostics.size(); I != N; ++I) {
+    if (HasSFINAEDiagnostic)
+      Info.addSFINAEDiagnostic(Diagnostics[I].first, Diagnostics[I].second);
+    else
+      Info.addSuppressedDiagnostic(Diagnostics[I].first,
+                                   Diagnostics[I].second);
+  }
+}
+
+/// \brief Build the key under which the result of deducing the template
+/// arguments of \p FunctionTemplate from a call with the arguments \p Args
+/// and the explicit template arguments \p ExplicitTemplateArgs is cached.
+///
+/// \returns false if the result of the deduction may depend on more than the
+/// key, and so must not be cached.
+static bool buildDeductionCacheKey(Sema &S,
+                                   FunctionTemplateDecl *FunctionTemplate,
+                                   TemplateArgumentListInfo *ExplicitArgs,
+                                   ArrayRef<Expr *> Args,
+                                   TemplateDeductionCache::KeyTy &Key) {
+  const LangOptions &LangOpts = S.getLangOpts();
+  // A deduction nested in the substitution of another one can fail because
+  // of the depth of the instantiations, and turns its errors into the
+  // failure of the outer one.
+  if (!S.DeductionCache || LangOpts.ObjC1 || LangOpts.CUDA ||
+      LangOpts.Modules || S.CurContext->isDependentContext() ||
+      S.isSFINAEContext())
+    return false;
+
+  Key.push_back(reinterpret_cast<uintptr_t>(
+                  FunctionTemplate->getCanonicalDecl()));
+  Key.push_back(ExplicitArgs != 0);
+  if (ExplicitArgs) {
+    Key.push_back(ExplicitArgs->size());
+    // Only types and templates are compared by their canonical forms.
+    for (unsigned I = 0, N = ExplicitArgs->size(); I != N; ++I) {
+      const TemplateArgument &Arg = (*ExplicitArgs)[I].getArgument();
+      Key.push_back(Arg.getKind());
+      if (Arg.getKind() == TemplateArgument::Type) {
+        QualType T = Arg.getAsType();
+        if (T->isDependentType() || T->containsUnexpandedParameterPack() ||
+            mayBeCompletedLater(T))
+          return false;
+        Key.push_back(reinterpret_cast<uintptr_t>(
+                        S.Context.getCanonicalType(T).getAsOpaquePtr()));
+      } else if (Arg.getKind() == TemplateArgument::Template) {
+        TemplateName Name = Arg.getAsTemplate();
+        if (Name.isDependent())
+          return false;
+        Key.push_back(reinterpret_cast<uintptr_t>(
+                        S.Context.getCanonicalTemplateName(Name)
+                          .getAsVoidPointer()));
+      } else {
+        return false;
+      }
+    }
+  }
+
+  for (unsigned I = 0, N = Args.size(); I != N; ++I) {
+    Expr *Arg = Args[I];
+    QualType T = Arg->getType();
+
+    // Deduction from initializer lists and overload sets, and the
+    // derived-to-base deduction for classes that are not complete yet,
+    // depend on more than the type and value kind of the argument.
+    if (Arg->isTypeDependent() || Arg->isValueDependent() ||
+        T->isPlaceholderType() || isa<InitListExpr>(Arg) ||
+        Arg->getObjectKind() != OK_Ordinary || mayBeCompletedLater(T))
+      return false;
+
+    Key.push_back(reinterpret_cast<uintptr_t>(
+                    S.Context.getCanonicalType(T).getAsOpaquePtr()));
+    Key.push_back(Arg->getValueKind());
+  }
+  return true;
+}
+
 /// \brief Perform template argument deduction from a function call
 /// (C++ [temp.deduct.call]).
 ///
@@ -3266,6 +3362,54 @@ Sema::DeduceTemplateArguments(FunctionTemplateDecl *FunctionTemplate,
   if (FunctionTemplate->isInvalidDecl())
     return TDK_Invalid;
 
+  // Reuse the result of an earlier deduction for the same template with the
+  // same explicit template arguments and arguments of the same types.
+  TemplateDeductionCache::KeyTy CacheKey;
+  if (!buildDeductionCacheKey(*this, FunctionTemplate, ExplicitTemplateArgs,
+                              Args, CacheKey))
+    return DeduceTemplateArgumentsUncached(FunctionTemplate,
+                                           ExplicitTemplateArgs, Args,
+                                           Specialization, Info);
+
+  if (const TemplateDeductionCache::Result *Cached
+        = DeductionCache->lookup(CacheKey)) {
+    ++NumDeductionCacheHits;
+    Specialization = Cached->Specialization;
+    Cached->restore(Info);
+    return TemplateDeductionResult(Cached->Kind);
+  }
+  ++NumDeductionCacheMisses;
+
+  // A deduction that emitted errors, or checked accesses that another
+  // context could be denied, is not cached.
+  DiagnosticErrorTrap Trap(getDiagnostics());
+  unsigned PrevNonPublicAccessChecks = NumNonPublicAccessChecks;
+  TemplateDeductionResult Result
+    = DeduceTemplateArgumentsUncached(FunctionTemplate, ExplicitTemplateArgs,
+                                      Args, Specialization, Info);
+  // Running out of instantiation depth depends on where the deduction
+  // happens, and a failed overload resolution refers to the argument.
+  if (!Trap.hasErrorOccurred() &&
+      NumNonPublicAccessChecks == PrevNonPublicAccessChecks &&
+      Result != TDK_InstantiationDepth &&
+      Result != TDK_FailedOverloadResolution) {
+    TemplateDeductionCache::Result R;
+    R.save(Result, Result == TDK_Success ? Specialization : 0, Info);
+    DeductionCache->insert(CacheKey, R);
+  }
+  return Result;
+}
+
+/// \brief Perform template argument deduction from a function call
+/// (C++ [temp.deduct.call]), without DeductionCache.
+Sema::TemplateDeductionResult
+Sema::DeduceTemplateArgumentsUncached(
+    FunctionTemplateDecl *FunctionTemplate,
+    TemplateArgumentListInfo *ExplicitTemplateArgs, ArrayRef<Expr *> Args,
+    FunctionDecl *&Specialization, TemplateDeductionInfo &Info) {
+  TemplateProfiler::Scope Profile(getTemplateProfiler(), "deduction",
+                                  FunctionTemplate);
+
   FunctionDecl *Function = FunctionTemplate->getTemplatedDecl();
 
   // C++ [temp.deduct.call]p1:
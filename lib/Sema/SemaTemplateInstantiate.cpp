@@ -22,6 +22,7 @@
 #include "clang/Sema/Lookup.h"
 #include "clang/Sema/Template.h"
 #include "clang/Sema/TemplateDeduction.h"
+#include "clang/Sema/TemplateProfiler.h"
 
 using namespace clang;
 using namespace sema;
@@ -184,6 +185,39 @@ bool Sema::ActiveTemplateInstantiation::isInstantiationRecord() const {
   llvm_unreachable("Invalid InstantiationKind!");
 }
 
+/// \brief The activity that profiles of template instantiation record for an
+/// instantiation of the given kind.
+static const char *
+getProfiledActivity(Sema::ActiveTemplateInstantiation::InstantiationKind K) {
+  switch (K) {
+  case Sema::ActiveTemplateInstantiation::TemplateInstantiation:
+    return "instantiation";
+  case Sema::ActiveTemplateInstantiation::DefaultTemplateArgumentInstantiation:
+    return "default template argument";
+  case Sema::ActiveTemplateInstantiation::DefaultFunctionArgumentInstantiation:
+    return "default function argument";
+  case Sema::ActiveTemplateInstantiation::ExplicitTemplateArgumentSubstitution:
+    return "explicit template argument substitution";
+  case Sema::ActiveTemplateInstantiation::DeducedTemplateArgumentSubstitution:
+    return "deduced template argument substitution";
+  case Sema::ActiveTemplateInstantiation::PriorTemplateArgumentSubstitution:
+    return "prior template argument substitution";
+  case Sema::ActiveTemplateInstantiation::DefaultTemplateArgumentChecking:
+    return "default template argument checking";
+  case Sema::ActiveTemplateInstantiation::ExceptionSpecInstantiation:
+    return "exception specification";
+  }
+  llvm_unreachable("unknown instantiation kind");
+}
+
+static void
+pushActiveTemplateInstantiation(Sema &SemaRef,
+                                const Sema::ActiveTemplateInstantiation &Inst) {
+  SemaRef.ActiveTemplateInstantiations.push_back(Inst);
+  if (TemplateProfiler *Profiler = SemaRef.getTemplateProfiler())
+    Profiler->enter(getProfiledActivity(Inst.Kind), Inst.Entity);
+}
+
 Sema::InstantiatingTemplate::
 InstantiatingTemplate(Sema &SemaRef, SourceLocation PointOfInstantiation,
                       Decl *Entity,
@@ -203,7 +237,7 @@ InstantiatingTemplate(Sema &SemaRef, SourceLocation PointOfInstantiation,
     Inst.NumTemplateArgs = 0;
     Inst.InstantiationRange = InstantiationRange;
     SemaRef.InNonInstantiationSFINAEContext = false;
-    SemaRef.ActiveTemplateInstantiations.push_back(Inst);
+    pushActiveTemplateInstantiation(SemaRef, Inst);
   }
 }
 
@@ -226,7 +260,7 @@ InstantiatingTemplate(Sema &SemaRef, SourceLocation PointOfInstantiation,
     Inst.NumTemplateArgs = 0;
     Inst.InstantiationRange = InstantiationRange;
     SemaRef.InNonInstantiationSFINAEContext = false;
-    SemaRef.ActiveTemplateInstantiations.push_back(Inst);
+    pushActiveTemplateInstantiation(SemaRef, Inst);
   }
 }
 
@@ -251,7 +285,7 @@ InstantiatingTemplate(Sema &SemaRef, SourceLocation PointOfInstantiation,
     Inst.NumTemplateArgs = TemplateArgs.size();
     Inst.InstantiationRange = InstantiationRange;
     SemaRef.InNonInstantiationSFINAEContext = false;
-    SemaRef.ActiveTemplateInstantiations.push_back(Inst);
+    pushActiveTemplateInstantiation(SemaRef, Inst);
   }
 }
 
@@ -277,7 +311,7 @@ InstantiatingTemplate(Sema &SemaRef, SourceLocation PointOfInstantiation,
     Inst.DeductionInfo = &DeductionInfo;
     Inst.InstantiationRange = InstantiationRange;
     SemaRef.InNonInstantiationSFINAEContext = false;
-    SemaRef.ActiveTemplateInstantiations.push_back(Inst);
+    pushActiveTemplateInstantiation(SemaRef, Inst);
     
     if (!Inst.isInstantiationRecord())
       ++SemaRef.NonInstantiationEntries;
@@ -305,7 +339,7 @@ InstantiatingTemplate(Sema &SemaRef, SourceLocation PointOfInstantiation,
     Inst.DeductionInfo = &DeductionInfo;
     Inst.InstantiationRange = InstantiationRange;
     SemaRef.InNonInstantiationSFINAEContext = false;
-    SemaRef.ActiveTemplateInstantiations.push_back(Inst);
+    pushActiveTemplateInstantiation(SemaRef, Inst);
   }
 }
 
@@ -328,7 +362,7 @@ Sema::InstantiatingTemplate::InstantiatingTemplate(
     Inst.DeductionInfo = &DeductionInfo;
     Inst.InstantiationRange = InstantiationRange;
     SemaRef.InNonInstantiationSFINAEContext = false;
-    SemaRef.ActiveTemplateInstantiations.push_back(Inst);
+    pushActiveTemplateInstantiation(SemaRef, Inst);
   }
 }
 
@@ -352,7 +386,7 @@ InstantiatingTemplate(Sema &SemaRef, SourceLocation PointOfInstantiation,
     Inst.NumTemplateArgs = TemplateArgs.size();
     Inst.InstantiationRange = InstantiationRange;
     SemaRef.InNonInstantiationSFINAEContext = false;
-    SemaRef.ActiveTemplateInstantiations.push_back(Inst);
+    pushActiveTemplateInstantiation(SemaRef, Inst);
   }
 }
 
@@ -376,7 +410,7 @@ InstantiatingTemplate(Sema &SemaRef, SourceLocation PointOfInstantiation,
     Inst.NumTemplateArgs = TemplateArgs.size();
     Inst.InstantiationRange = InstantiationRange;
     SemaRef.InNonInstantiationSFINAEContext = false;
-    SemaRef.ActiveTemplateInstantiations.push_back(Inst);
+    pushActiveTemplateInstantiation(SemaRef, Inst);
   }
 }
 
@@ -400,7 +434,7 @@ InstantiatingTemplate(Sema &SemaRef, SourceLocation PointOfInstantiation,
     Inst.NumTemplateArgs = TemplateArgs.size();
     Inst.InstantiationRange = InstantiationRange;
     SemaRef.InNonInstantiationSFINAEContext = false;
-    SemaRef.ActiveTemplateInstantiations.push_back(Inst);
+    pushActiveTemplateInstantiation(SemaRef, Inst);
   }
 }
 
@@ -424,7 +458,7 @@ InstantiatingTemplate(Sema &SemaRef, SourceLocation PointOfInstantiation,
   Inst.NumTemplateArgs = TemplateArgs.size();
   Inst.InstantiationRange = InstantiationRange;
   SemaRef.InNonInstantiationSFINAEContext = false;
-  SemaRef.ActiveTemplateInstantiations.push_back(Inst);
+  pushActiveTemplateInstantiation(SemaRef, Inst);
   
   assert(!Inst.isInstantiationRecord());
   ++SemaRef.NonInstantiationEntries;
@@ -450,6 +484,8 @@ void Sema::InstantiatingTemplate::Clear() {
       SemaRef.ActiveTemplateInstantiationLookupModules.pop_back();
     }
 
+    if (TemplateProfiler *Profiler = SemaRef.getTemplateProfiler())
+      Profiler->exit();
     SemaRef.ActiveTemplateInstantiations.pop_back();
     Invalid = true;
   }
@@ -1572,13 +1608,13 @@ TypeSourceInfo *Sema::SubstType(TypeLoc TL,
       !TL.getType()->isVariablyModifiedType()) {
     // FIXME: Make a copy of the TypeLoc data here, so that we can
     // return a new TypeSourceInfo. Inefficient!
-    TypeLocBuilder TLB;
+    TypeLocBuilder TLB(&Scratch);
     TLB.pushFullCopy(TL);
     return TLB.getTypeSourceInfo(Context, TL.getType());
   }
 
   TemplateInstantiator Instantiator(*this, Args, Loc, Entity);
-  TypeLocBuilder TLB;
+  TypeLocBuilder TLB(&Scratch);
   TLB.reserve(TL.getFullDataSize());
   QualType Result = Instantiator.TransformType(TLB, TL);
   if (Result.isNull())
@@ -1654,7 +1690,7 @@ TypeSourceInfo *Sema::SubstFunctionDeclType(TypeSourceInfo *T,
 
   TemplateInstantiator Instantiator(*this, Args, Loc, Entity);
 
-  TypeLocBuilder TLB;
+  TypeLocBuilder TLB(&Scratch);
 
   TypeLoc TL = T->getTypeLoc();
   TLB.reserve(TL.getFullDataSize());
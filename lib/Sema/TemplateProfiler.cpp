@@ -0,0 +1,196 @@
+//===--- TemplateProfiler.cpp - Profile of template instantiation ---------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the TemplateProfiler class.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Sema/TemplateProfiler.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/DeclCXX.h"
+#include "clang/AST/DeclTemplate.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/Timer.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+
+using namespace clang;
+
+/// \brief Find the template that the totals for activity on \p D are kept
+/// for: the primary template of a specialization, or the member of a class
+/// template that a member of a specialization was instantiated from.
+static const Decl *getProfiledTemplate(const Decl *D) {
+  if (const ClassTemplateSpecializationDecl *Spec
+        = dyn_cast<ClassTemplateSpecializationDecl>(D))
+    return Spec->getSpecializedTemplate();
+  if (const VarTemplateSpecializationDecl *Spec
+        = dyn_cast<VarTemplateSpecializationDecl>(D))
+    return Spec->getSpecializedTemplate();
+  if (const FunctionDecl *FD = dyn_cast<FunctionDecl>(D)) {
+    if (FunctionTemplateDecl *Template = FD->getPrimaryTemplate())
+      return Template;
+    if (FunctionDecl *Pattern = FD->getInstantiatedFromMemberFunction())
+      return Pattern;
+  }
+  if (const CXXRecordDecl *RD = dyn_cast<CXXRecordDecl>(D))
+    if (CXXRecordDecl *Pattern = RD->getInstantiatedFromMemberClass())
+      return Pattern;
+  return D;
+}
+
+/// \brief Write \p Str as a JSON string.
+static void writeString(raw_ostream &OS, StringRef Str) {
+  OS << '"';
+  for (unsigned I = 0, N = Str.size(); I != N; ++I) {
+    unsigned char C = Str[I];
+    if (C == '"' || C == '\\')
+      OS << '\\' << C;
+    else if (C < 0x20)
+      OS << llvm::format("\\u%04x", C);
+    else
+      OS << C;
+  }
+  OS << '"';
+}
+
+static uint64_t toMicroseconds(double Seconds) {
+  return Seconds > 0 ? uint64_t(Seconds * 1000000 + 0.5) : 0;
+}
+
+TemplateProfiler::TemplateProfiler(ASTContext &Context)
+  : Context(Context), StartTime(0) {
+  StartTime = now();
+}
+
+double TemplateProfiler::now() const {
+  return llvm::TimeRecord::getCurrentTime().getWallTime() - StartTime;
+}
+
+void TemplateProfiler::enter(const char *Activity, const Decl *D) {
+  enter(Activity, D, DeclarationName());
+}
+
+void TemplateProfiler::enter(const char *Activity, DeclarationName Name) {
+  enter(Activity, 0, Name);
+}
+
+void TemplateProfiler::enter(const char *Activity, const Decl *D,
+                             DeclarationName Name) {
+  Event E;
+  E.Activity = Activity;
+  E.D = D;
+  E.Name = Name;
+  E.Template = D ? getProfiledTemplate(D) : 0;
+  E.Key = E.Template ? static_cast<const void *>(E.Template)
+                     : Name.getAsOpaquePtr();
+  E.Duration = E.NestedDuration = 0;
+  E.Memory = 0;
+  E.Outermost = ActiveKeys[E.Key]++ == 0;
+
+  Active.push_back(Events.size());
+  Events.push_back(E);
+
+  // Read the clocks last, so that the bookkeeping above is not counted.
+  Event &Current = Events.back();
+  Current.StartMemory = Context.getASTAllocatedMemory();
+  Current.Start = now();
+}
+
+void TemplateProfiler::exit() {
+  assert(!Active.empty() && "exit without enter");
+  double End = now();
+  Event &E = Events[Active.pop_back_val()];
+  E.Duration = End - E.Start;
+  E.Memory = Context.getASTAllocatedMemory() - E.StartMemory;
+  --ActiveKeys[E.Key];
+  if (!Active.empty())
+    Events[Active.back()].NestedDuration += E.Duration;
+}
+
+namespace {
+struct Totals {
+  std::string Name;
+  unsigned Count;
+  double Time, SelfTime;
+  uint64_t Memory;
+
+  Totals() : Count(0), Time(0), SelfTime(0), Memory(0) {}
+};
+
+/// \brief Orders totals most expensive first, and then by name so that the
+/// output does not depend on the addresses of the templates.
+struct MoreExpensive {
+  bool operator()(const Totals *A, const Totals *B) const {
+    if (A->SelfTime != B->SelfTime)
+      return A->SelfTime > B->SelfTime;
+    return A->Name < B->Name;
+  }
+};
+}
+
+void TemplateProfiler::write(raw_ostream &OS) const {
+  PrintingPolicy Policy = Context.getPrintingPolicy();
+  llvm::DenseMap<const void *, Totals> TotalsByKey;
+
+  OS << "{\"traceEvents\": [";
+  bool First = true;
+  for (std::vector<Event>::const_iterator I = Events.begin(),
+                                          E = Events.end();
+       I != E; ++I) {
+    std::string Detail;
+    llvm::raw_string_ostream DetailOS(Detail);
+    if (const NamedDecl *ND = dyn_cast_or_null<NamedDecl>(I->D))
+      ND->getNameForDiagnostic(DetailOS, Policy, /*Qualified=*/true);
+    else
+      DetailOS << I->Name.getAsString();
+    DetailOS.flush();
+
+    Totals &T = TotalsByKey[I->Key];
+    if (!T.Count) {
+      if (const NamedDecl *ND = dyn_cast_or_null<NamedDecl>(I->Template))
+        T.Name = ND->getQualifiedNameAsString();
+      else
+        T.Name = Detail;
+    }
+    ++T.Count;
+    T.SelfTime += I->Duration - I->NestedDuration;
+    if (I->Outermost) {
+      T.Time += I->Duration;
+      T.Memory += I->Memory;
+    }
+
+    OS << (First ? "\n" : ",\n") << "{\"name\": ";
+    First = false;
+    writeString(OS, I->Activity);
+    OS << ", \"ph\": \"X\", \"pid\": 0, \"tid\": 0, \"ts\": "
+       << toMicroseconds(I->Start) << ", \"dur\": "
+       << toMicroseconds(I->Duration) << ", \"args\": {\"detail\": ";
+    writeString(OS, Detail);
+    OS << ", \"memory\": " << I->Memory << "}}";
+  }
+  OS << "\n],\n\"templates\": [";
+
+  SmallVector<const Totals *, 32> Sorted;
+  for (llvm::DenseMap<const void *, Totals>::const_iterator
+         I = TotalsByKey.begin(), E = TotalsByKey.end();
+       I != E; ++I)
+    Sorted.push_back(&I->second);
+  std::sort(Sorted.begin(), Sorted.end(), MoreExpensive());
+
+  for (unsigned I = 0, N = Sorted.size(); I != N; ++I) {
+    const Totals &T = *Sorted[I];
+    OS << (I ? ",\n" : "\n") << "{\"name\": ";
+    writeString(OS, T.Name);
+    OS << ", \"count\": " << T.Count
+       << ", \"total_us\": " << toMicroseconds(T.Time)
+       << ", \"self_us\": " << toMicroseconds(T.SelfTime)
+       << ", \"memory\": " << T.Memory << "}";
+  }
+  OS << "\n]}\n";
+}
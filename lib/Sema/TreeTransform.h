@@ -324,6 +324,14 @@ public:
   /// \returns the transformed OpenMP clause.
   OMPClause *TransformOMPClause(OMPClause *S);
 
+  /// \brief Transform the clauses and the associated statement of the given
+  /// OpenMP directive, which are common to all the executable directives.
+  ///
+  /// \returns true if an error occurred, false otherwise.
+  bool TransformOMPExecutableDirective(OMPExecutableDirective *D,
+                                       SmallVectorImpl<OMPClause *> &TClauses,
+                                       StmtResult &AssociatedStmt);
+
   /// \brief Transform the given expression.
   ///
   /// By default, this routine transforms an expression by delegating to the
@@ -1282,6 +1290,18 @@ public:
                                                   StartLoc, EndLoc);
   }
 
+  /// \brief Build a new OpenMP 'simd' directive.
+  ///
+  /// By default, performs semantic analysis to build the new statement.
+  /// Subclasses may override this routine to provide different behavior.
+  StmtResult RebuildOMPSimdDirective(ArrayRef<OMPClause *> Clauses,
+                                     Stmt *AStmt,
+                                     SourceLocation StartLoc,
+                                     SourceLocation EndLoc) {
+    return getSema().ActOnOpenMPSimdDirective(Clauses, AStmt,
+                                              StartLoc, EndLoc);
+  }
+
   /// \brief Build a new OpenMP 'default' clause.
   ///
   /// By default, performs semantic analysis to build the new statement.
@@ -1295,6 +1315,18 @@ public:
                                               StartLoc, LParenLoc, EndLoc);
   }
 
+  /// \brief Build a new OpenMP 'safelen' clause.
+  ///
+  /// By default, performs semantic analysis to build the new statement.
+  /// Subclasses may override this routine to provide different behavior.
+  OMPClause *RebuildOMPSafelenClause(Expr *Len,
+                                     SourceLocation StartLoc,
+                                     SourceLocation LParenLoc,
+                                     SourceLocation EndLoc) {
+    return getSema().ActOnOpenMPSafelenClause(Len, StartLoc, LParenLoc,
+                                              EndLoc);
+  }
+
   /// \brief Build a new OpenMP 'private' clause.
   ///
   /// By default, performs semantic analysis to build the new statement.
@@ -3417,7 +3449,7 @@ TypeSourceInfo *TreeTransform<Derived>::TransformType(TypeSourceInfo *DI) {
   if (getDerived().AlreadyTransformed(DI->getType()))
     return DI;
 
-  TypeLocBuilder TLB;
+  TypeLocBuilder TLB(&SemaRef.Scratch);
 
   TypeLoc TL = DI->getTypeLoc();
   TLB.reserve(TL.getFullDataSize());
@@ -3432,6 +3464,15 @@ TypeSourceInfo *TreeTransform<Derived>::TransformType(TypeSourceInfo *DI) {
 template<typename Derived>
 QualType
 TreeTransform<Derived>::TransformType(TypeLocBuilder &TLB, TypeLoc T) {
+  // Copy a part of a type that the transform leaves alone as it is, rather
+  // than rebuilding it node by node. Function types are still rebuilt,
+  // since their parameters may need to be transformed.
+  if (!T.getType()->isFunctionType() &&
+      getDerived().AlreadyTransformed(T.getType())) {
+    TLB.pushFullCopy(T);
+    return T.getType();
+  }
+
   switch (T.getTypeLocClass()) {
 #define ABSTRACT_TYPELOC(CLASS, PARENT)
 #define TYPELOC(CLASS, PARENT)                                                 \
@@ -3528,7 +3569,7 @@ TreeTransform<Derived>::TransformTypeInObjectScope(TypeLoc TL,
   if (getDerived().AlreadyTransformed(T))
     return TL;
 
-  TypeLocBuilder TLB;
+  TypeLocBuilder TLB(&SemaRef.Scratch);
   QualType Result;
 
   if (isa<TemplateSpecializationType>(T)) {
@@ -3584,7 +3625,7 @@ TreeTransform<Derived>::TransformTypeInObjectScope(TypeSourceInfo *TSInfo,
   if (getDerived().AlreadyTransformed(T))
     return TSInfo;
 
-  TypeLocBuilder TLB;
+  TypeLocBuilder TLB(&SemaRef.Scratch);
   QualType Result;
 
   TypeLoc TL = TSInfo->getTypeLoc();
@@ -4086,7 +4127,7 @@ ParmVarDecl *TreeTransform<Derived>::TransformFunctionTypeParam(
     TypeLoc OldTL = OldDI->getTypeLoc();
     PackExpansionTypeLoc OldExpansionTL = OldTL.castAs<PackExpansionTypeLoc>();
 
-    TypeLocBuilder TLB;
+    TypeLocBuilder TLB(&SemaRef.Scratch);
     TypeLoc NewTL = OldDI->getTypeLoc();
     TLB.reserve(NewTL.getFullDataSize());
 
@@ -6248,10 +6289,12 @@ TreeTransform<Derived>::TransformSEHHandler(Stmt *Handler) {
 }
 
 template<typename Derived>
-StmtResult
-TreeTransform<Derived>::TransformOMPParallelDirective(OMPParallelDirective *D) {
+bool
+TreeTransform<Derived>::TransformOMPExecutableDirective(
+                                      OMPExecutableDirective *D,
+                                      SmallVectorImpl<OMPClause *> &TClauses,
+                                      StmtResult &AssociatedStmt) {
   // Transform the clauses
-  llvm::SmallVector<OMPClause *, 5> TClauses;
   ArrayRef<OMPClause *> Clauses = D->clauses();
   TClauses.reserve(Clauses.size());
   for (ArrayRef<OMPClause *>::iterator I = Clauses.begin(), E = Clauses.end();
@@ -6259,7 +6302,7 @@ TreeTransform<Derived>::TransformOMPParallelDirective(OMPParallelDirective *D) {
     if (*I) {
       OMPClause *Clause = getDerived().TransformOMPClause(*I);
       if (!Clause)
-        return StmtError();
+        return true;
       TClauses.push_back(Clause);
     }
     else {
@@ -6267,10 +6310,18 @@ TreeTransform<Derived>::TransformOMPParallelDirective(OMPParallelDirective *D) {
     }
   }
   if (!D->getAssociatedStmt())
-    return StmtError();
-  StmtResult AssociatedStmt =
-    getDerived().TransformStmt(D->getAssociatedStmt());
-  if (AssociatedStmt.isInvalid())
+    return true;
+  AssociatedStmt = getDerived().TransformStmt(D->getAssociatedStmt());
+  return AssociatedStmt.isInvalid();
+}
+
+template<typename Derived>
+StmtResult
+TreeTransform<Derived>::TransformOMPParallelDirective(OMPParallelDirective *D) {
+  llvm::SmallVector<OMPClause *, 5> TClauses;
+  StmtResult AssociatedStmt;
+  if (getDerived().TransformOMPExecutableDirective(D, TClauses,
+                                                   AssociatedStmt))
     return StmtError();
 
   return getDerived().RebuildOMPParallelDirective(TClauses,
@@ -6279,6 +6330,21 @@ TreeTransform<Derived>::TransformOMPParallelDirective(OMPParallelDirective *D) {
                                                   D->getLocEnd());
 }
 
+template<typename Derived>
+StmtResult
+TreeTransform<Derived>::TransformOMPSimdDirective(OMPSimdDirective *D) {
+  llvm::SmallVector<OMPClause *, 5> TClauses;
+  StmtResult AssociatedStmt;
+  if (getDerived().TransformOMPExecutableDirective(D, TClauses,
+                                                   AssociatedStmt))
+    return StmtError();
+
+  return getDerived().RebuildOMPSimdDirective(TClauses,
+                                              AssociatedStmt.take(),
+                                              D->getLocStart(),
+                                              D->getLocEnd());
+}
+
 template<typename Derived>
 OMPClause *
 TreeTransform<Derived>::TransformOMPDefaultClause(OMPDefaultClause *C) {
@@ -6289,6 +6355,18 @@ TreeTransform<Derived>::TransformOMPDefaultClause(OMPDefaultClause *C) {
                                               C->getLocEnd());
 }
 
+template<typename Derived>
+OMPClause *
+TreeTransform<Derived>::TransformOMPSafelenClause(OMPSafelenClause *C) {
+  ExprResult E = getDerived().TransformExpr(C->getSafelen());
+  if (E.isInvalid())
+    return 0;
+  return getDerived().RebuildOMPSafelenClause(E.take(),
+                                              C->getLocStart(),
+                                              C->getLParenLoc(),
+                                              C->getLocEnd());
+}
+
 template<typename Derived>
 OMPClause *
 TreeTransform<Derived>::TransformOMPPrivateClause(OMPPrivateClause *C) {
@@ -7852,7 +7930,7 @@ TreeTransform<Derived>::TransformTypeTraitExpr(TypeTraitExpr *E) {
     TypeSourceInfo *From = E->getArg(I);
     TypeLoc FromTL = From->getTypeLoc();
     if (!FromTL.getAs<PackExpansionTypeLoc>()) {
-      TypeLocBuilder TLB;
+      TypeLocBuilder TLB(&SemaRef.Scratch);
       TLB.reserve(FromTL.getFullDataSize());
       QualType To = getDerived().TransformType(TLB, FromTL);
       if (To.isNull())
@@ -7895,7 +7973,7 @@ TreeTransform<Derived>::TransformTypeTraitExpr(TypeTraitExpr *E) {
       // expansion.
       Sema::ArgumentPackSubstitutionIndexRAII SubstIndex(getSema(), -1);
 
-      TypeLocBuilder TLB;
+      TypeLocBuilder TLB(&SemaRef.Scratch);
       TLB.reserve(From->getTypeLoc().getFullDataSize());
 
       QualType To = getDerived().TransformType(TLB, PatternTL);
@@ -7920,7 +7998,7 @@ TreeTransform<Derived>::TransformTypeTraitExpr(TypeTraitExpr *E) {
     // pack(s).
     for (unsigned I = 0; I != *NumExpansions; ++I) {
       Sema::ArgumentPackSubstitutionIndexRAII SubstIndex(SemaRef, I);
-      TypeLocBuilder TLB;
+      TypeLocBuilder TLB(&SemaRef.Scratch);
       TLB.reserve(PatternTL.getFullDataSize());
       QualType To = getDerived().TransformType(TLB, PatternTL);
       if (To.isNull())
@@ -7949,7 +8027,7 @@ TreeTransform<Derived>::TransformTypeTraitExpr(TypeTraitExpr *E) {
     // forgetting the partially-substituted parameter pack.
     ForgetPartiallySubstitutedPackRAII Forget(getDerived());
 
-    TypeLocBuilder TLB;
+    TypeLocBuilder TLB(&SemaRef.Scratch);
     TLB.reserve(From->getTypeLoc().getFullDataSize());
 
     QualType To = getDerived().TransformType(TLB, PatternTL);
@@ -45,17 +45,24 @@ void TypeLocBuilder::pushFullCopy(TypeLoc L) {
 void TypeLocBuilder::grow(size_t NewCapacity) {
   assert(NewCapacity > Capacity);
 
-  // Allocate the new buffer and copy the old data into it.
-  char *NewBuffer = new char[NewCapacity];
+  // Allocate the new buffer and copy the old data into it. A buffer from the
+  // scratch arena is released with the builder, along with the ones it
+  // replaced.
+  char *NewBuffer =
+      static_cast<char *>(Scratch.Allocate(NewCapacity, BufferMaxAlignment));
+  bool NewBufferIsHeap = !NewBuffer;
+  if (NewBufferIsHeap)
+    NewBuffer = new char[NewCapacity];
   unsigned NewIndex = Index + NewCapacity - Capacity;
   memcpy(&NewBuffer[NewIndex],
          &Buffer[Index],
          Capacity - Index);
 
-  if (Buffer != InlineBuffer.buffer)
+  if (BufferIsHeap)
     delete[] Buffer;
 
   Buffer = NewBuffer;
+  BufferIsHeap = NewBufferIsHeap;
   Capacity = NewCapacity;
   Index = NewIndex;
 }
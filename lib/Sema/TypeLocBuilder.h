@@ -17,6 +17,7 @@
 
 #include "clang/AST/ASTContext.h"
 #include "clang/AST/TypeLoc.h"
+#include "clang/Sema/ScratchArena.h"
 
 namespace clang {
 
@@ -33,6 +34,15 @@ class TypeLocBuilder {
   /// The index of the first occupied byte in the buffer.
   size_t Index;
 
+  /// Whether the buffer was allocated with new[], rather than being the
+  /// inline buffer or coming from the scratch arena.
+  bool BufferIsHeap;
+
+  /// The scratch memory that buffers larger than the inline one come from
+  /// while it can provide them, so that transforming many types reuses the
+  /// same memory.
+  ScratchArena::Scope Scratch;
+
 #ifndef NDEBUG
   /// The last type pushed on this builder.
   QualType LastTy;
@@ -44,14 +54,15 @@ class TypeLocBuilder {
   unsigned NumBytesAtAlign4, NumBytesAtAlign8;
 
  public:
-  TypeLocBuilder()
+  explicit TypeLocBuilder(ScratchArena *Arena = 0)
     : Buffer(InlineBuffer.buffer), Capacity(InlineCapacity),
-      Index(InlineCapacity), NumBytesAtAlign4(0), NumBytesAtAlign8(0)
+      Index(InlineCapacity), BufferIsHeap(false), Scratch(Arena),
+      NumBytesAtAlign4(0), NumBytesAtAlign8(0)
   {
   }
 
   ~TypeLocBuilder() {
-    if (Buffer != InlineBuffer.buffer)
+    if (BufferIsHeap)
       delete[] Buffer;
   }
 
@@ -16,6 +16,8 @@
 #include "clang/Basic/IdentifierTable.h"
 #include "clang/Serialization/ASTDeserializationListener.h"
 #include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/Compression.h"
+#include "llvm/Support/MemoryBuffer.h"
 
 using namespace clang;
 
@@ -216,3 +218,80 @@ bool serialization::isRedeclarableDeclKind(unsigned Kind) {
 
   llvm_unreachable("Unhandled declaration kind");
 }
+
+/// \brief The signature of a compressed AST file. It is followed by the size
+/// of the uncompressed file and the size of the zlib data, as 64-bit
+/// little-endian integers, then by the zlib data padded to a multiple of
+/// 4 bytes.
+static const char CompressedASTSignature[] = { 'C', 'P', 'C', 'Z' };
+static const unsigned CompressedASTHeaderSize = 20;
+
+static void appendLE64(SmallVectorImpl<char> &Out, uint64_t Value) {
+  for (unsigned I = 0; I != 8; ++I)
+    Out.push_back(char(Value >> (8 * I)));
+}
+
+static uint64_t readLE64(const char *Data) {
+  uint64_t Value = 0;
+  for (unsigned I = 0; I != 8; ++I)
+    Value |= uint64_t((unsigned char)Data[I]) << (8 * I);
+  return Value;
+}
+
+bool serialization::compressASTFile(StringRef Contents,
+                                    SmallVectorImpl<char> &Compressed) {
+  if (!llvm::zlib::isAvailable())
+    return false;
+
+  // AST files are read much more often than they are written, but they are
+  // also written on the critical path of a build, so favour speed.
+  OwningPtr<llvm::MemoryBuffer> Data;
+  if (llvm::zlib::compress(Contents, Data,
+                           llvm::zlib::BestSpeedCompression) !=
+      llvm::zlib::StatusOK)
+    return false;
+
+  Compressed.clear();
+  Compressed.append(CompressedASTSignature,
+                    CompressedASTSignature + sizeof(CompressedASTSignature));
+  appendLE64(Compressed, Contents.size());
+  appendLE64(Compressed, Data->getBufferSize());
+  Compressed.append(Data->getBufferStart(), Data->getBufferEnd());
+  while (Compressed.size() % 4)
+    Compressed.push_back(0);
+  return true;
+}
+
+bool serialization::uncompressASTFile(OwningPtr<llvm::MemoryBuffer> &Buffer,
+                                      std::string &ErrorStr) {
+  StringRef Contents = Buffer->getBuffer();
+  if (!Contents.startswith(StringRef(CompressedASTSignature,
+                                     sizeof(CompressedASTSignature))))
+    return true;
+
+  if (!llvm::zlib::isAvailable()) {
+    ErrorStr = "the file is compressed, and zlib is not available";
+    return false;
+  }
+
+  uint64_t UncompressedSize = 0, CompressedSize = 0;
+  if (Contents.size() >= CompressedASTHeaderSize) {
+    UncompressedSize = readLE64(Contents.data() + 4);
+    CompressedSize = readLE64(Contents.data() + 12);
+  }
+  OwningPtr<llvm::MemoryBuffer> Uncompressed;
+  if (Contents.size() < CompressedASTHeaderSize ||
+      CompressedSize > Contents.size() - CompressedASTHeaderSize ||
+      UncompressedSize % 4 != 0 ||
+      llvm::zlib::uncompress(Contents.substr(CompressedASTHeaderSize,
+                                             CompressedSize),
+                             Uncompressed, UncompressedSize) !=
+        llvm::zlib::StatusOK ||
+      Uncompressed->getBufferSize() != UncompressedSize) {
+    ErrorStr = "the compressed file is corrupt";
+    return false;
+  }
+
+  Buffer.swap(Uncompressed);
+  return true;
+}
@@ -16,6 +16,11 @@
 
 #include "clang/AST/ASTContext.h"
 #include "clang/Serialization/ASTBitCodes.h"
+#include "llvm/ADT/OwningPtr.h"
+
+namespace llvm {
+  class MemoryBuffer;
+}
 
 namespace clang {
 
@@ -59,6 +64,40 @@ TypeID MakeTypeID(ASTContext &Context, QualType T, IdxForTypeTy IdxForType) {
 
 unsigned ComputeHash(Selector Sel);
 
+/// \brief Compress the contents of an AST file with zlib, prefixing them with
+/// a header that uncompressASTFile() recognizes.
+///
+/// \returns false if zlib is not available or the compression failed, in
+/// which case the file should be written uncompressed.
+bool compressASTFile(StringRef Contents, SmallVectorImpl<char> &Compressed);
+
+/// \brief If \p Buffer holds a compressed AST file, replace it with the
+/// uncompressed contents.
+///
+/// The whole file is uncompressed at once, so that the reader can keep
+/// loading it lazily through offsets and pointers into the buffer.
+///
+/// \returns false, and sets \p ErrorStr, if the file is compressed but
+/// cannot be uncompressed.
+bool uncompressASTFile(OwningPtr<llvm::MemoryBuffer> &Buffer,
+                       std::string &ErrorStr);
+
+/// \brief The number of bits each identifier sets in an IDENTIFIER_FILTER.
+const unsigned NumIdentifierFilterProbes = 2;
+
+/// \brief Retrieve the bit that an identifier whose name hashes to \p Hash
+/// sets in an IDENTIFIER_FILTER of 2^\p Log2Bits bits.
+///
+/// The probes use independent bits of the hash, one from its low bits and
+/// one from the high bits of a multiplicative rehash.
+inline unsigned getIdentifierFilterBit(uint32_t Hash, unsigned Probe,
+                                       unsigned Log2Bits) {
+  assert(Log2Bits > 0 && Log2Bits < 32 && "Invalid identifier filter size");
+  if (Probe == 0)
+    return Hash & ((1U << Log2Bits) - 1);
+  return (uint32_t)(Hash * 0x9E3779B1U) >> (32 - Log2Bits);
+}
+
 /// \brief Retrieve the "definitive" declaration that provides all of the
 /// visible entries for the given declaration context, if there is one.
 ///
@@ -27,6 +27,7 @@
 #include "clang/Basic/SourceManagerInternals.h"
 #include "clang/Basic/TargetInfo.h"
 #include "clang/Basic/TargetOptions.h"
+#include "clang/Basic/TimeTrace.h"
 #include "clang/Basic/Version.h"
 #include "clang/Basic/VersionTuple.h"
 #include "clang/Lex/HeaderSearch.h"
@@ -42,6 +43,7 @@
 #include "clang/Serialization/ModuleManager.h"
 #include "clang/Serialization/SerializationDiagnostic.h"
 #include "llvm/ADT/Hashing.h"
+#include "llvm/ADT/MapVector.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/Bitcode/BitstreamReader.h"
 #include "llvm/Support/ErrorHandling.h"
@@ -915,6 +917,32 @@ resolveFileRelativeToOriginalDir(const std::string &Filename,
   return currPCHPath.str();
 }
 
+unsigned ASTReader::getSLocEntryOffset(int ID) {
+  if (ID == 0 || ID > 0 || unsigned(-ID) - 2 >= getTotalNumSLocs())
+    return 0;
+
+  // Every kind of entry starts with its offset, so only the first record
+  // needs to be read; the entry's file isn't looked up.
+  ModuleFile *F = GlobalSLocEntryMap.find(-ID)->second;
+  BitstreamCursor &SLocEntryCursor = F->SLocEntryCursor;
+  SavedStreamPosition SavedPosition(SLocEntryCursor);
+  SLocEntryCursor.JumpToBit(F->SLocEntryOffsets[ID - F->SLocEntryBaseID]);
+  llvm::BitstreamEntry Entry = SLocEntryCursor.advance();
+  if (Entry.Kind != llvm::BitstreamEntry::Record)
+    return 0;
+
+  RecordData Record;
+  StringRef Blob;
+  switch (SLocEntryCursor.readRecord(Entry.ID, Record, &Blob)) {
+  case SM_SLOC_FILE_ENTRY:
+  case SM_SLOC_BUFFER_ENTRY:
+  case SM_SLOC_EXPANSION_ENTRY:
+    return Record.empty() ? 0 : F->SLocEntryBaseOffset + Record[0];
+  default:
+    return 0;
+  }
+}
+
 bool ASTReader::ReadSLocEntry(int ID) {
   if (ID == 0)
     return false;
@@ -1391,21 +1419,41 @@ namespace {
   /// \brief Visitor class used to look up identifirs in an AST file.
   class IdentifierLookupVisitor {
     StringRef Name;
+    unsigned NameHash;
     unsigned PriorGeneration;
     unsigned &NumIdentifierLookups;
     unsigned &NumIdentifierLookupHits;
+    unsigned &NumIdentifierLookupsFiltered;
     IdentifierInfo *Found;
 
   public:
     IdentifierLookupVisitor(StringRef Name, unsigned PriorGeneration,
                             unsigned &NumIdentifierLookups,
-                            unsigned &NumIdentifierLookupHits)
-      : Name(Name), PriorGeneration(PriorGeneration),
+                            unsigned &NumIdentifierLookupHits,
+                            unsigned &NumIdentifierLookupsFiltered)
+      : Name(Name), NameHash(ASTIdentifierLookupTrait::ComputeHash(Name)),
+        PriorGeneration(PriorGeneration),
         NumIdentifierLookups(NumIdentifierLookups),
         NumIdentifierLookupHits(NumIdentifierLookupHits),
+        NumIdentifierLookupsFiltered(NumIdentifierLookupsFiltered),
         Found()
     {
     }
+
+    /// \brief Determine whether the identifier filter of \p M, if any,
+    /// allows it to contain the name being looked up.
+    bool mayContainName(ModuleFile &M) const {
+      if (!M.IdentifierFilter)
+        return true;
+
+      for (unsigned Probe = 0; Probe != NumIdentifierFilterProbes; ++Probe) {
+        unsigned Bit = getIdentifierFilterBit(NameHash, Probe,
+                                              M.IdentifierFilterLog2Bits);
+        if (!(M.IdentifierFilter[Bit / 8] & (1 << (Bit % 8))))
+          return false;
+      }
+      return true;
+    }
     
     static bool visit(ModuleFile &M, void *UserData) {
       IdentifierLookupVisitor *This
@@ -1419,11 +1467,19 @@ namespace {
         = (ASTIdentifierLookupTable *)M.IdentifierLookupTable;
       if (!IdTable)
         return false;
+
+      // Most modules don't have most of the names we look up; the filter
+      // rules them out without touching the hash table.
+      if (!This->mayContainName(M)) {
+        ++This->NumIdentifierLookupsFiltered;
+        return false;
+      }
       
       ASTIdentifierLookupTrait Trait(IdTable->getInfoObj().getReader(),
                                      M, This->Found);
       ++This->NumIdentifierLookups;
-      ASTIdentifierLookupTable::iterator Pos = IdTable->find(This->Name,&Trait);
+      ASTIdentifierLookupTable::iterator Pos
+        = IdTable->find_hashed(This->Name, This->NameHash, &Trait);
       if (Pos == IdTable->end())
         return false;
       
@@ -1461,7 +1517,8 @@ void ASTReader::updateOutOfDateIdentifier(IdentifierInfo &II) {
 
   IdentifierLookupVisitor Visitor(II.getName(), PriorGeneration,
                                   NumIdentifierLookups,
-                                  NumIdentifierLookupHits);
+                                  NumIdentifierLookupHits,
+                                  NumIdentifierLookupsFiltered);
   ModuleMgr.visit(IdentifierLookupVisitor::visit, &Visitor, HitsPtr);
   markIdentifierUpToDate(&II);
 }
@@ -1715,8 +1772,12 @@ InputFile ASTReader::getInputFile(ModuleFile &F, unsigned ID, bool Complain) {
 
     bool IsOutOfDate = false;
 
-    // For an overridden file, there is nothing to validate.
-    if (!Overridden && (StoredSize != File->getSize()
+    // For an overridden file, there is nothing to validate. Nor is there for
+    // a preamble that ASTUnit knows to be out of date.
+    bool SkipValidation = F.Kind == MK_Preamble &&
+                          PP.getPreprocessorOpts().AllowOutOfDatePreamble;
+    if (!Overridden && !SkipValidation &&
+        (StoredSize != File->getSize()
 #if !defined(LLVM_ON_WIN32)
          // In our regression testing, the Windows file system seems to
          // have inconsistent modification times that sometimes
@@ -1775,6 +1836,13 @@ void ASTReader::MaybeAddSystemRootToFilename(ModuleFile &M,
   if (Filename.empty() || llvm::sys::path::is_absolute(Filename))
     return;
 
+  // The paths in a relocatable module are relative to the root given for
+  // the modules.
+  StringRef isysroot = this->isysroot;
+  if (M.Kind == MK_Module)
+    isysroot = PP.getHeaderSearchInfo().getHeaderSearchOpts()
+                   .ModulesRelocatableRoot;
+
   if (isysroot.empty()) {
     // If no system root was given, default to '/'
     Filename.insert(Filename.begin(), '/');
@@ -1895,6 +1963,16 @@ ASTReader::ReadControlBlock(ModuleFile &F,
                                       Record.begin() + Idx + Length);
         Idx += Length;
 
+        // A relocatable module refers to the modules next to it by their
+        // names.
+        if (F.Kind == MK_Module && F.RelocatablePCH &&
+            ImportedKind == MK_Module &&
+            !llvm::sys::path::has_parent_path(ImportedFile)) {
+          SmallString<128> Path(llvm::sys::path::parent_path(F.FileName));
+          llvm::sys::path::append(Path, ImportedFile.str());
+          ImportedFile = Path;
+        }
+
         // Load the AST file.
         switch(ReadASTCore(ImportedFile, ImportedKind, ImportLoc, &F, Loaded,
                            StoredSize, StoredModTime,
@@ -2083,16 +2161,14 @@ bool ASTReader::ReadASTBlock(ModuleFile &F) {
           return true;
         break;
         
-      case COMMENTS_BLOCK_ID: {
-        BitstreamCursor C = Stream;
+      case COMMENTS_BLOCK_ID:
+        F.CommentsCursor = Stream;
         if (Stream.SkipBlock() ||
-            ReadBlockAbbrevs(C, COMMENTS_BLOCK_ID)) {
+            ReadBlockAbbrevs(F.CommentsCursor, COMMENTS_BLOCK_ID)) {
           Error("malformed comments block in AST file");
           return true;
         }
-        CommentsCursors.push_back(std::make_pair(C, &F));
         break;
-      }
         
       default:
         if (Stream.SkipBlock()) {
@@ -2209,6 +2285,15 @@ bool ASTReader::ReadASTBlock(ModuleFile &F) {
       }
       break;
 
+    case IDENTIFIER_FILTER:
+      // Ignore a malformed filter rather than trusting it to rule names out.
+      if (Record[0] > 0 && Record[0] < 32 &&
+          Blob.size() == (1ULL << Record[0]) / 8) {
+        F.IdentifierFilter = (const unsigned char *)Blob.data();
+        F.IdentifierFilterLog2Bits = Record[0];
+      }
+      break;
+
     case IDENTIFIER_OFFSET: {
       if (F.LocalNumIdentifiers != 0) {
         Error("duplicate IDENTIFIER_OFFSET record in AST file");
@@ -2268,6 +2353,8 @@ bool ASTReader::ReadASTBlock(ModuleFile &F) {
       TotalNumMacros += Record[1];
       TotalLexicalDeclContexts += Record[2];
       TotalVisibleDeclContexts += Record[3];
+      if (Record.size() > 4)
+        TotalNumFunctionBodies += Record[4];
       break;
 
     case UNUSED_FILESCOPED_DECLS:
@@ -2599,6 +2686,25 @@ bool ASTReader::ReadASTBlock(ModuleFile &F) {
     case OBJC_CATEGORIES:
       F.ObjCCategories.swap(Record);
       break;
+
+    case RECORD_LAYOUTS_MAP: {
+      if (F.LocalNumRecordLayoutsInMap != 0) {
+        Error("duplicate RECORD_LAYOUTS_MAP record in AST file");
+        return true;
+      }
+
+      F.LocalNumRecordLayoutsInMap = Record[0];
+      F.RecordLayoutsMap = (const RecordLayoutsInfo *)Blob.data();
+      break;
+    }
+
+    case RECORD_LAYOUTS:
+      F.RecordLayouts.swap(Record);
+      break;
+
+    case COMMENTS_FILE_INDEX:
+      F.CommentsFileIndex.swap(Record);
+      break;
         
     case CXX_BASE_SPECIFIER_OFFSETS: {
       if (F.LocalNumCXXBaseSpecifiers != 0) {
@@ -2755,36 +2861,59 @@ bool ASTReader::ReadASTBlock(ModuleFile &F) {
   }
 }
 
-/// \brief Move the given method to the back of the global list of methods.
-static void moveMethodToBackOfGlobalList(Sema &S, ObjCMethodDecl *Method) {
-  // Find the entry for this selector in the method pool.
-  Sema::GlobalMethodPool::iterator Known
-    = S.MethodPool.find(Method->getSelector());
-  if (Known == S.MethodPool.end())
-    return;
+/// \brief Move the given methods to the back of the global lists of methods,
+/// as if each of them was moved in turn.
+static void moveMethodsToBackOfGlobalList(Sema &S,
+                                          ArrayRef<ObjCMethodDecl *> Methods) {
+  // Group the methods by the list they are in, so that a list is rewritten
+  // once however many of its methods are moved.
+  typedef llvm::MapVector<ObjCMethodList *, SmallVector<ObjCMethodDecl *, 4> >
+    MethodsByListMap;
+  MethodsByListMap MethodsByList;
+  for (unsigned I = 0, N = Methods.size(); I != N; ++I) {
+    // Find the entry for this selector in the method pool.
+    Sema::GlobalMethodPool::iterator Known
+      = S.MethodPool.find(Methods[I]->getSelector());
+    if (Known == S.MethodPool.end())
+      continue;
 
-  // Retrieve the appropriate method list.
-  ObjCMethodList &Start = Method->isInstanceMethod()? Known->second.first
-                                                    : Known->second.second;
-  bool Found = false;
-  for (ObjCMethodList *List = &Start; List; List = List->getNext()) {
-    if (!Found) {
-      if (List->Method == Method) {
-        Found = true;
-      } else {
-        // Keep searching.
-        continue;
-      }
-    }
+    // Retrieve the appropriate method list.
+    ObjCMethodList &Start = Methods[I]->isInstanceMethod()
+                              ? Known->second.first
+                              : Known->second.second;
+    MethodsByList[&Start].push_back(Methods[I]);
+  }
 
-    if (List->getNext())
-      List->Method = List->getNext()->Method;
-    else
-      List->Method = Method;
+  SmallVector<ObjCMethodDecl *, 16> Order;
+  for (MethodsByListMap::iterator I = MethodsByList.begin(),
+                                  E = MethodsByList.end();
+       I != E; ++I) {
+    llvm::SmallPtrSet<ObjCMethodDecl *, 16> InList;
+    for (ObjCMethodList *List = I->first; List; List = List->getNext())
+      InList.insert(List->Method);
+
+    // The methods that move keep the order they were moved in, after the
+    // others.
+    llvm::SmallPtrSet<ObjCMethodDecl *, 4> Moved;
+    SmallVector<ObjCMethodDecl *, 4> MovedInOrder;
+    for (unsigned J = 0, N = I->second.size(); J != N; ++J)
+      if (InList.count(I->second[J]) && Moved.insert(I->second[J]))
+        MovedInOrder.push_back(I->second[J]);
+
+    Order.clear();
+    for (ObjCMethodList *List = I->first; List; List = List->getNext())
+      if (!Moved.count(List->Method))
+        Order.push_back(List->Method);
+    Order.append(MovedInOrder.begin(), MovedInOrder.end());
+
+    unsigned Next = 0;
+    for (ObjCMethodList *List = I->first; List; List = List->getNext())
+      List->Method = Order[Next++];
   }
 }
 
 void ASTReader::makeNamesVisible(const HiddenNames &Names, Module *Owner) {
+  SmallVector<ObjCMethodDecl *, 16> UnhiddenMethods;
   for (unsigned I = 0, N = Names.size(); I != N; ++I) {
     switch (Names[I].getKind()) {
     case HiddenName::Declaration: {
@@ -2794,7 +2923,7 @@ void ASTReader::makeNamesVisible(const HiddenNames &Names, Module *Owner) {
 
       if (wasHidden && SemaObj) {
         if (ObjCMethodDecl *Method = dyn_cast<ObjCMethodDecl>(D)) {
-          moveMethodToBackOfGlobalList(*SemaObj, Method);
+          UnhiddenMethods.push_back(Method);
         }
       }
       break;
@@ -2806,6 +2935,10 @@ void ASTReader::makeNamesVisible(const HiddenNames &Names, Module *Owner) {
     }
     }
   }
+  NumHiddenNamesMadeVisible += Names.size();
+
+  if (!UnhiddenMethods.empty())
+    moveMethodsToBackOfGlobalList(*SemaObj, UnhiddenMethods);
 }
 
 void ASTReader::makeModuleVisible(Module *Mod, 
@@ -2814,6 +2947,7 @@ void ASTReader::makeModuleVisible(Module *Mod,
                                   bool Complain) {
   llvm::SmallPtrSet<Module *, 4> Visited;
   SmallVector<Module *, 4> Stack;
+  SmallVector<Module *, 16> Exports;
   Stack.push_back(Mod);  
   while (!Stack.empty()) {
     Mod = Stack.back();
@@ -2832,6 +2966,7 @@ void ASTReader::makeModuleVisible(Module *Mod,
 
     // Update the module's name visibility.
     Mod->NameVisibility = NameVisibility;
+    ++NumModulesMadeVisible;
     
     // If we've already deserialized any names from this module,
     // mark them as visible.
@@ -2851,7 +2986,7 @@ void ASTReader::makeModuleVisible(Module *Mod,
     }
     
     // Push any exported modules onto the stack to be marked as visible.
-    SmallVector<Module *, 16> Exports;
+    Exports.clear();
     Mod->getExportedModules(Exports);
     for (SmallVectorImpl<Module *>::iterator
            I = Exports.begin(), E = Exports.end(); I != E; ++I) {
@@ -2907,6 +3042,7 @@ ASTReader::ASTReadResult ASTReader::ReadAST(const std::string &FileName,
                                             ModuleKind Type,
                                             SourceLocation ImportLoc,
                                             unsigned ClientLoadCapabilities) {
+  TimeTraceScope TimeScope("ReadAST", FileName);
   llvm::SaveAndRestore<SourceLocation>
     SetCurImportLocRAII(CurrentImportLoc, ImportLoc);
 
@@ -3379,8 +3515,9 @@ std::string ASTReader::getOriginalSourceFile(const std::string &ASTFileName,
   // Open the AST file.
   std::string ErrStr;
   OwningPtr<llvm::MemoryBuffer> Buffer;
-  Buffer.reset(FileMgr.getBufferForFile(ASTFileName, &ErrStr));
-  if (!Buffer) {
+  Buffer.reset(FileMgr.getBufferForFile(ASTFileName, &ErrStr,
+                                        /*RequiresNullTerminator=*/false));
+  if (!Buffer || !serialization::uncompressASTFile(Buffer, ErrStr)) {
     Diags.Report(diag::err_fe_unable_to_read_pch_file) << ASTFileName << ErrStr;
     return std::string();
   }
@@ -3468,8 +3605,9 @@ bool ASTReader::readASTFileControlBlock(StringRef Filename,
   // Open the AST file.
   std::string ErrStr;
   OwningPtr<llvm::MemoryBuffer> Buffer;
-  Buffer.reset(FileMgr.getBufferForFile(Filename, &ErrStr));
-  if (!Buffer) {
+  Buffer.reset(FileMgr.getBufferForFile(Filename, &ErrStr,
+                                        /*RequiresNullTerminator=*/false));
+  if (!Buffer || !serialization::uncompressASTFile(Buffer, ErrStr)) {
     return true;
   }
 
@@ -5522,6 +5660,9 @@ serialization::DeclID ASTReader::ReadDeclID(ModuleFile &F,
 /// source each time it is called, and is meant to be used via a
 /// LazyOffsetPtr (which is used by Decls for the body of functions, etc).
 Stmt *ASTReader::GetExternalDeclStmt(uint64_t Offset) {
+  // Function and method bodies are the only statements loaded this way.
+  ++NumFunctionBodiesRead;
+
   // Switch case IDs are per Decl.
   ClearSwitchCaseIDs();
 
@@ -5894,6 +6035,7 @@ void ASTReader::completeVisibleDeclsMap(const DeclContext *DC) {
   ModuleMgr.visit(&DeclContextAllNamesVisitor::visit, &Visitor);
   ++NumVisibleDeclContextsRead;
 
+  ReserveExternalVisibleDecls(DC, Decls.size());
   for (DeclsMap::iterator I = Decls.begin(), E = Decls.end(); I != E; ++I) {
     SetExternalVisibleDeclsForName(DC, I->first, I->second);
   }
@@ -5948,6 +6090,83 @@ void ASTReader::StartTranslationUnit(ASTConsumer *Consumer) {
   PassInterestingDeclsToConsumer();
 }
 
+namespace {
+  struct CompareRecordLayoutsInfo {
+    bool operator()(const RecordLayoutsInfo &X, DeclID Y) {
+      return X.DefinitionID < Y;
+    }
+
+    bool operator()(DeclID X, const RecordLayoutsInfo &Y) {
+      return X < Y.DefinitionID;
+    }
+
+    bool operator()(const RecordLayoutsInfo &X, const RecordLayoutsInfo &Y) {
+      return X.DefinitionID < Y.DefinitionID;
+    }
+  };
+}
+
+bool ASTReader::layoutRecordType(const RecordDecl *Record,
+                                 uint64_t &Size, uint64_t &Alignment,
+                     llvm::DenseMap<const FieldDecl *, uint64_t> &FieldOffsets,
+                 llvm::DenseMap<const CXXRecordDecl *, CharUnits> &BaseOffsets,
+         llvm::DenseMap<const CXXRecordDecl *, CharUnits> &VirtualBaseOffsets) {
+  // The layout is stored by the module file that defines the record.
+  ModuleFile *M = getOwningModuleFile(Record);
+  if (!M || !M->LocalNumRecordLayoutsInMap)
+    return false;
+
+  DeclID LocalID = mapGlobalIDToModuleFileGlobalID(*M, Record->getGlobalID());
+  const RecordLayoutsInfo *Result
+    = std::lower_bound(M->RecordLayoutsMap,
+                       M->RecordLayoutsMap + M->LocalNumRecordLayoutsInMap,
+                       LocalID, CompareRecordLayoutsInfo());
+  if (Result == M->RecordLayoutsMap + M->LocalNumRecordLayoutsInMap ||
+      Result->DefinitionID != LocalID)
+    return false;
+
+  const SmallVectorImpl<uint64_t> &Layouts = M->RecordLayouts;
+  unsigned Idx = Result->Offset;
+  if (Idx + 3 > Layouts.size())
+    return false;
+  uint64_t LayoutSize = Layouts[Idx++];
+  uint64_t LayoutAlign = Layouts[Idx++];
+
+  // Every field must be given an offset; if the definition we have does not
+  // match the stored layout, let the ABI lay the record out.
+  unsigned NumFields = Layouts[Idx++];
+  if (Idx + NumFields >= Layouts.size())
+    return false;
+  for (RecordDecl::field_iterator F = Record->field_begin(),
+                                  FEnd = Record->field_end();
+       F != FEnd; ++F) {
+    if (NumFields-- == 0) {
+      FieldOffsets.clear();
+      return false;
+    }
+    FieldOffsets[*F] = Layouts[Idx++];
+  }
+  if (NumFields != 0) {
+    FieldOffsets.clear();
+    return false;
+  }
+
+  for (unsigned I = 0, N = Layouts[Idx++]; I != N; ++I) {
+    if (Idx + 2 > Layouts.size())
+      break;
+    const CXXRecordDecl *Base
+      = cast_or_null<CXXRecordDecl>(GetLocalDecl(*M, Layouts[Idx++]));
+    CharUnits Offset = CharUnits::fromQuantity(Layouts[Idx++]);
+    if (Base && (Base = Base->getDefinition()))
+      BaseOffsets[Base] = Offset;
+  }
+
+  Size = LayoutSize;
+  Alignment = LayoutAlign;
+  ++NumRecordLayoutsRead;
+  return true;
+}
+
 void ASTReader::PrintStats() {
   std::fprintf(stderr, "*** AST File Statistics:\n");
 
@@ -5998,6 +6217,10 @@ void ASTReader::PrintStats() {
     std::fprintf(stderr, "  %u/%u statements read (%f%%)\n",
                  NumStatementsRead, TotalNumStatements,
                  ((float)NumStatementsRead/TotalNumStatements * 100));
+  if (TotalNumFunctionBodies)
+    std::fprintf(stderr, "  %u/%u function bodies read (%f%%)\n",
+                 NumFunctionBodiesRead, TotalNumFunctionBodies,
+                 ((float)NumFunctionBodiesRead/TotalNumFunctionBodies * 100));
   if (TotalNumMacros)
     std::fprintf(stderr, "  %u/%u macros read (%f%%)\n",
                  NumMacrosRead, TotalNumMacros,
@@ -6030,12 +6253,24 @@ void ASTReader::PrintStats() {
                   * 100.0));
   }
 
+  if (NumRecordLayoutsRead)
+    std::fprintf(stderr, "  %u record layouts read\n", NumRecordLayoutsRead);
+
+  if (NumModulesMadeVisible)
+    std::fprintf(stderr, "  %u modules made visible, unhiding %u names\n",
+                 NumModulesMadeVisible, NumHiddenNamesMadeVisible);
+
   if (NumIdentifierLookupHits) {
     std::fprintf(stderr,
                  "  %u / %u identifier table lookups succeeded (%f%%)\n",
                  NumIdentifierLookupHits, NumIdentifierLookups,
                  (double)NumIdentifierLookupHits*100.0/NumIdentifierLookups);
   }
+  if (NumIdentifierLookupsFiltered) {
+    std::fprintf(stderr,
+                 "  %u identifier table lookups avoided by identifier filters\n",
+                 NumIdentifierLookupsFiltered);
+  }
 
   if (GlobalIndex) {
     std::fprintf(stderr, "\n");
@@ -6155,7 +6390,8 @@ IdentifierInfo* ASTReader::get(const char *NameStart, const char *NameEnd) {
   }
   IdentifierLookupVisitor Visitor(Name, /*PriorGeneration=*/0,
                                   NumIdentifierLookups,
-                                  NumIdentifierLookupHits);
+                                  NumIdentifierLookupHits,
+                                  NumIdentifierLookupsFiltered);
   ModuleMgr.visit(IdentifierLookupVisitor::visit, &Visitor, HitsPtr);
   IdentifierInfo *II = Visitor.getIdentifierInfo();
   markIdentifierUpToDate(II);
@@ -6303,8 +6539,14 @@ void ASTReader::ReadMethodPool(Selector Sel) {
   // Get the selector generation and update it to the current generation.
   unsigned &Generation = SelectorGeneration[Sel];
   unsigned PriorGeneration = Generation;
+
+  // If no module file was loaded since the last lookup of this selector, all
+  // of its methods are in the pool already. This is the common case since
+  // every method declaration and message send looks its selector up.
+  if (PriorGeneration == CurrentGeneration)
+    return;
   Generation = CurrentGeneration;
-  
+
   // Search for methods defined with this selector.
   ++NumMethodPoolLookups;
   ReadMethodPoolVisitor Visitor(*this, Sel, PriorGeneration);
@@ -7241,54 +7483,67 @@ void ASTReader::ClearSwitchCaseIDs() {
   CurrSwitchCaseStmts->clear();
 }
 
-void ASTReader::ReadComments() {
-  std::vector<RawComment *> Comments;
-  for (SmallVectorImpl<std::pair<BitstreamCursor,
-                                 serialization::ModuleFile *> >::iterator
-       I = CommentsCursors.begin(),
-       E = CommentsCursors.end();
-       I != E; ++I) {
-    BitstreamCursor &Cursor = I->first;
-    serialization::ModuleFile &F = *I->second;
-    SavedStreamPosition SavedPosition(Cursor);
+void ASTReader::ReadCommentsInFile(FileID File) {
+  SourceLocation Loc = SourceMgr.getLocForStartOfFile(File);
+  if (Loc.isInvalid() || SourceMgr.isLocalSourceLocation(Loc))
+    return;
 
-    RecordData Record;
-    while (true) {
-      llvm::BitstreamEntry Entry =
-        Cursor.advanceSkippingSubblocks(BitstreamCursor::AF_DontPopBlockAtEnd);
-      
-      switch (Entry.Kind) {
-      case llvm::BitstreamEntry::SubBlock: // Handled for us already.
-      case llvm::BitstreamEntry::Error:
-        Error("malformed block record in AST file");
-        return;
-      case llvm::BitstreamEntry::EndBlock:
-        goto NextCursor;
-      case llvm::BitstreamEntry::Record:
-        // The interesting case.
-        break;
-      }
+  GlobalSLocOffsetMapType::const_iterator
+    SLocMapI = GlobalSLocOffsetMap.find(SourceManager::MaxLoadedOffset -
+                                        Loc.getOffset() - 1);
+  if (SLocMapI == GlobalSLocOffsetMap.end())
+    return;
+  ModuleFile &F = *SLocMapI->second;
+
+  // Find the file in the index of the comments block by the location of its
+  // start in the AST file, undoing the remapping done by ReadSourceLocation.
+  const SmallVectorImpl<uint64_t> &Index = F.CommentsFileIndex;
+  uint64_t LocalLoc = Loc.getOffset() - (F.SLocEntryBaseOffset - 2);
+  unsigned Lo = 0, Hi = Index.size() / 3;
+  while (Lo != Hi) {
+    unsigned Mid = Lo + (Hi - Lo) / 2;
+    if (Index[Mid * 3] < LocalLoc)
+      Lo = Mid + 1;
+    else
+      Hi = Mid;
+  }
+  if (Lo == Index.size() / 3 || Index[Lo * 3] != LocalLoc)
+    return;
 
-      // Read a record.
-      Record.clear();
-      switch ((CommentRecordTypes)Cursor.readRecord(Entry.ID, Record)) {
-      case COMMENTS_RAW_COMMENT: {
-        unsigned Idx = 0;
-        SourceRange SR = ReadSourceRange(F, Record, Idx);
-        RawComment::CommentKind Kind =
-            (RawComment::CommentKind) Record[Idx++];
-        bool IsTrailingComment = Record[Idx++];
-        bool IsAlmostTrailingComment = Record[Idx++];
-        Comments.push_back(new (Context) RawComment(
-            SR, Kind, IsTrailingComment, IsAlmostTrailingComment,
-            Context.getLangOpts().CommentOpts.ParseAllComments));
-        break;
-      }
-      }
+  BitstreamCursor &Cursor = F.CommentsCursor;
+  SavedStreamPosition SavedPosition(Cursor);
+  Cursor.JumpToBit(Index[Lo * 3 + 1]);
+  unsigned NumComments = Index[Lo * 3 + 2];
+
+  std::vector<RawComment *> Comments;
+  Comments.reserve(NumComments);
+  RecordData Record;
+  while (Comments.size() != NumComments) {
+    llvm::BitstreamEntry Entry =
+      Cursor.advanceSkippingSubblocks(BitstreamCursor::AF_DontPopBlockAtEnd);
+    if (Entry.Kind != llvm::BitstreamEntry::Record) {
+      Error("malformed comments block in AST file");
+      return;
+    }
+
+    // Read a record.
+    Record.clear();
+    switch ((CommentRecordTypes)Cursor.readRecord(Entry.ID, Record)) {
+    case COMMENTS_RAW_COMMENT: {
+      unsigned Idx = 0;
+      SourceRange SR = ReadSourceRange(F, Record, Idx);
+      RawComment::CommentKind Kind =
+          (RawComment::CommentKind) Record[Idx++];
+      bool IsTrailingComment = Record[Idx++];
+      bool IsAlmostTrailingComment = Record[Idx++];
+      Comments.push_back(new (Context) RawComment(
+          SR, Kind, IsTrailingComment, IsAlmostTrailingComment,
+          Context.getLangOpts().CommentOpts.ParseAllComments));
+      break;
+    }
     }
-  NextCursor:;
   }
-  Context.Comments.addCommentsToFront(Comments);
+  Context.Comments.addDeserializedComments(File, Comments);
 }
 
 void ASTReader::finishPendingActions() {
@@ -7488,12 +7743,15 @@ ASTReader::ASTReader(Preprocessor &PP, ASTContext &Context,
     UseGlobalIndex(UseGlobalIndex), TriedLoadingGlobalIndex(false),
     CurrentGeneration(0), CurrSwitchCaseStmts(&SwitchCaseStmts),
     NumSLocEntriesRead(0), TotalNumSLocEntries(0), 
-    NumStatementsRead(0), TotalNumStatements(0), NumMacrosRead(0),
+    NumStatementsRead(0), TotalNumStatements(0),
+    NumFunctionBodiesRead(0), TotalNumFunctionBodies(0), NumMacrosRead(0),
     TotalNumMacros(0), NumIdentifierLookups(0), NumIdentifierLookupHits(0),
+    NumIdentifierLookupsFiltered(0),
     NumSelectorsRead(0), NumMethodPoolEntriesRead(0),
     NumMethodPoolLookups(0), NumMethodPoolHits(0),
     NumMethodPoolTableLookups(0), NumMethodPoolTableHits(0),
-    TotalNumMethodPoolEntries(0),
+    TotalNumMethodPoolEntries(0), NumRecordLayoutsRead(0),
+    NumModulesMadeVisible(0), NumHiddenNamesMadeVisible(0),
     NumLexicalDeclContextsRead(0), TotalLexicalDeclContexts(0), 
     NumVisibleDeclContextsRead(0), TotalVisibleDeclContexts(0),
     TotalModulesSizeInBits(0), NumCurrentElementsDeserializing(0),
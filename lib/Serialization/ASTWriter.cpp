@@ -20,6 +20,7 @@
 #include "clang/AST/DeclTemplate.h"
 #include "clang/AST/Expr.h"
 #include "clang/AST/ExprCXX.h"
+#include "clang/AST/RecordLayout.h"
 #include "clang/AST/Type.h"
 #include "clang/AST/TypeLocVisitor.h"
 #include "clang/Basic/FileManager.h"
@@ -46,6 +47,7 @@
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/Bitcode/BitstreamWriter.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MathExtras.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include <algorithm>
@@ -838,6 +840,7 @@ void ASTWriter::WriteBlockInfoBlock() {
   RECORD(DELEGATING_CTORS);
   RECORD(KNOWN_NAMESPACES);
   RECORD(UNDEFINED_BUT_USED);
+  RECORD(IDENTIFIER_FILTER);
   RECORD(MODULE_OFFSET_MAP);
   RECORD(SOURCE_MANAGER_LINE_TABLE);
   RECORD(OBJC_CATEGORIES_MAP);
@@ -848,6 +851,9 @@ void ASTWriter::WriteBlockInfoBlock() {
   RECORD(OBJC_CATEGORIES);
   RECORD(MACRO_OFFSET);
   RECORD(MACRO_TABLE);
+  RECORD(RECORD_LAYOUTS_MAP);
+  RECORD(RECORD_LAYOUTS);
+  RECORD(COMMENTS_FILE_INDEX);
 
   // SourceManager Block.
   BLOCK(SOURCE_MANAGER_BLOCK);
@@ -1052,8 +1058,15 @@ void ASTWriter::WriteControlBlock(Preprocessor &PP, ASTContext &Context,
       AddSourceLocation((*M)->ImportLoc, Record);
       Record.push_back((*M)->File->getSize());
       Record.push_back((*M)->File->getModificationTime());
-      // FIXME: This writes the absolute path for AST files we depend on.
-      const std::string &FileName = (*M)->FileName;
+      // FIXME: This writes the absolute path for AST files we depend on,
+      // except for the modules next to a relocatable module, which are found
+      // by their names alone.
+      StringRef FileName = (*M)->FileName;
+      if (WritingModule && !isysroot.empty() &&
+          (*M)->Kind == serialization::MK_Module &&
+          llvm::sys::path::parent_path(FileName) ==
+              llvm::sys::path::parent_path(OutputFile))
+        FileName = llvm::sys::path::filename(FileName);
       Record.push_back(FileName.size());
       Record.append(FileName.begin(), FileName.end());
     }
@@ -2680,20 +2693,40 @@ void ASTWriter::WriteFileDeclIDsMap() {
 }
 
 void ASTWriter::WriteComments() {
+  SourceManager &SM = Context->getSourceManager();
+  SmallVector<FileID, 16> Files;
+  Context->Comments.getFilesWithComments(Files);
+
+  // The comments are written grouped by file, so that a reader can load the
+  // comments of a single file when it needs them.
+  RecordData FileIndex;
   Stream.EnterSubblock(COMMENTS_BLOCK_ID, 3);
-  ArrayRef<RawComment *> RawComments = Context->Comments.getComments();
   RecordData Record;
-  for (ArrayRef<RawComment *>::iterator I = RawComments.begin(),
-                                        E = RawComments.end();
-       I != E; ++I) {
-    Record.clear();
-    AddSourceRange((*I)->getSourceRange(), Record);
-    Record.push_back((*I)->getKind());
-    Record.push_back((*I)->isTrailingComment());
-    Record.push_back((*I)->isAlmostTrailingComment());
-    Stream.EmitRecord(COMMENTS_RAW_COMMENT, Record);
+  for (unsigned I = 0, N = Files.size(); I != N; ++I) {
+    // The comments in a file loaded from another AST file are stored there.
+    if (SM.isLoadedFileID(Files[I]))
+      continue;
+
+    ArrayRef<RawComment *> RawComments =
+        Context->Comments.getCommentsInFile(Files[I]);
+    AddSourceLocation(SM.getLocForStartOfFile(Files[I]), FileIndex);
+    FileIndex.push_back(Stream.GetCurrentBitNo());
+    FileIndex.push_back(RawComments.size());
+    for (ArrayRef<RawComment *>::iterator C = RawComments.begin(),
+                                          CEnd = RawComments.end();
+         C != CEnd; ++C) {
+      Record.clear();
+      AddSourceRange((*C)->getSourceRange(), Record);
+      Record.push_back((*C)->getKind());
+      Record.push_back((*C)->isTrailingComment());
+      Record.push_back((*C)->isAlmostTrailingComment());
+      Stream.EmitRecord(COMMENTS_RAW_COMMENT, Record);
+    }
   }
   Stream.ExitBlock();
+
+  if (!FileIndex.empty())
+    Stream.EmitRecord(COMMENTS_FILE_INDEX, FileIndex);
 }
 
 //===----------------------------------------------------------------------===//
@@ -3196,14 +3229,17 @@ void ASTWriter::WriteIdentifierTable(Preprocessor &PP,
     // Create the on-disk hash table representation. We only store offsets
     // for identifiers that appear here for the first time.
     IdentifierOffsets.resize(NextIdentID - FirstIdentID);
+    SmallVector<uint32_t, 64> FilterHashes;
     for (llvm::DenseMap<const IdentifierInfo *, IdentID>::iterator
            ID = IdentifierIDs.begin(), IDEnd = IdentifierIDs.end();
          ID != IDEnd; ++ID) {
       assert(ID->first && "NULL identifier in identifier table");
       if (!Chain || !ID->first->isFromAST() || 
-          ID->first->hasChangedSinceDeserialization())
+          ID->first->hasChangedSinceDeserialization()) {
         Generator.insert(const_cast<IdentifierInfo *>(ID->first), ID->second,
                          Trait);
+        FilterHashes.push_back(ASTIdentifierTableTrait::ComputeHash(ID->first));
+      }
     }
 
     // Create the on-disk hash table in a buffer.
@@ -3229,6 +3265,32 @@ void ASTWriter::WriteIdentifierTable(Preprocessor &PP,
     Record.push_back(IDENTIFIER_TABLE);
     Record.push_back(BucketOffset);
     Stream.EmitRecordWithBlob(IDTableAbbrev, Record, IdentifierTable.str());
+
+    // Write the filter of the identifiers in the table, with at least 16
+    // bits per identifier so that about 1% of the lookups of names that
+    // aren't there still need to search the table.
+    unsigned Log2Bits =
+        std::max(6U, llvm::Log2_32_Ceil(FilterHashes.size() * 16));
+    SmallVector<unsigned char, 64> Filter((1U << Log2Bits) / 8);
+    for (unsigned I = 0, N = FilterHashes.size(); I != N; ++I) {
+      for (unsigned Probe = 0; Probe != NumIdentifierFilterProbes; ++Probe) {
+        unsigned Bit = getIdentifierFilterBit(FilterHashes[I], Probe, Log2Bits);
+        Filter[Bit / 8] |= 1 << (Bit % 8);
+      }
+    }
+
+    Abbrev = new BitCodeAbbrev();
+    Abbrev->Add(BitCodeAbbrevOp(IDENTIFIER_FILTER));
+    Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Fixed, 8));
+    Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Blob));
+    unsigned FilterAbbrev = Stream.EmitAbbrev(Abbrev);
+
+    Record.clear();
+    Record.push_back(IDENTIFIER_FILTER);
+    Record.push_back(Log2Bits);
+    Stream.EmitRecordWithBlob(FilterAbbrev, Record,
+                              StringRef((const char *)Filter.data(),
+                                        Filter.size()));
   }
 
   // Write the offsets table for identifier IDs.
@@ -3654,6 +3716,104 @@ void ASTWriter::WriteObjCCategories() {
   Stream.EmitRecord(OBJC_CATEGORIES, Categories);
 }
 
+/// \brief Determine whether the layout of \p D can be computed ahead of time
+/// and stored in the AST file.
+static bool canPrecomputeLayout(const RecordDecl *D) {
+  if (D->isFromASTFile() || !D->isCompleteDefinition() ||
+      D->isInvalidDecl() || D->isDependentType())
+    return false;
+
+  // The builder derives the alignment of the non-virtual part of a class from
+  // the alignment of the whole class when it is given an external layout, so
+  // leave classes with virtual bases to the ABI.
+  if (const CXXRecordDecl *RD = dyn_cast<CXXRecordDecl>(D))
+    return RD->getNumVBases() == 0;
+  return true;
+}
+
+namespace {
+  struct CompareRecordLayoutCandidates {
+    bool operator()(const std::pair<DeclID, const RecordDecl *> &X,
+                    const std::pair<DeclID, const RecordDecl *> &Y) const {
+      return X.first < Y.first;
+    }
+  };
+}
+
+void ASTWriter::WriteRecordLayouts(ASTContext &Context) {
+  // Records in an AST file written despite errors may be half-formed.
+  if (Context.getDiagnostics().hasErrorOccurred())
+    return;
+
+  // Collect the record definitions first: computing their layouts may
+  // deserialize declarations, which adds to DeclIDs.
+  SmallVector<std::pair<DeclID, const RecordDecl *>, 16> Records;
+  for (llvm::DenseMap<const Decl *, DeclID>::iterator I = DeclIDs.begin(),
+                                                      E = DeclIDs.end();
+       I != E; ++I) {
+    const RecordDecl *D = dyn_cast<RecordDecl>(I->first);
+    if (D && canPrecomputeLayout(D))
+      Records.push_back(std::make_pair(I->second, D));
+  }
+  if (Records.empty())
+    return;
+  std::sort(Records.begin(), Records.end(), CompareRecordLayoutCandidates());
+
+  SmallVector<RecordLayoutsInfo, 16> LayoutsMap;
+  RecordData Layouts;
+  for (unsigned I = 0, N = Records.size(); I != N; ++I) {
+    const RecordDecl *D = Records[I].second;
+    const ASTRecordLayout &Layout = Context.getASTRecordLayout(D);
+    unsigned StartIndex = Layouts.size();
+
+    Layouts.push_back(Context.toBits(Layout.getSize()));
+    Layouts.push_back(Context.toBits(Layout.getAlignment()));
+    Layouts.push_back(Layout.getFieldCount());
+    for (unsigned F = 0, NumFields = Layout.getFieldCount(); F != NumFields;
+         ++F)
+      Layouts.push_back(Layout.getFieldOffset(F));
+
+    // Add the offsets of the direct, non-virtual bases. A base that was never
+    // referenced from this file is left for the ABI to place.
+    unsigned NumBasesIndex = Layouts.size();
+    Layouts.push_back(0);
+    if (const CXXRecordDecl *RD = dyn_cast<CXXRecordDecl>(D)) {
+      for (CXXRecordDecl::base_class_const_iterator B = RD->bases_begin(),
+                                                    BEnd = RD->bases_end();
+           B != BEnd; ++B) {
+        const CXXRecordDecl *Base = B->getType()->getAsCXXRecordDecl();
+        if (!Base->isFromASTFile() && !DeclIDs.count(Base))
+          continue;
+        Layouts.push_back(getDeclID(Base));
+        Layouts.push_back(Layout.getBaseClassOffset(Base).getQuantity());
+        ++Layouts[NumBasesIndex];
+      }
+    }
+
+    RecordLayoutsInfo Info = { Records[I].first, StartIndex };
+    LayoutsMap.push_back(Info);
+  }
+
+  // Emit the layouts map, which is sorted by the definition ID since the
+  // reader will be performing binary searches on it.
+  using namespace llvm;
+  llvm::BitCodeAbbrev *Abbrev = new BitCodeAbbrev();
+  Abbrev->Add(BitCodeAbbrevOp(RECORD_LAYOUTS_MAP));
+  Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 6)); // # of entries
+  Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Blob));
+  unsigned AbbrevID = Stream.EmitAbbrev(Abbrev);
+
+  RecordData Record;
+  Record.push_back(RECORD_LAYOUTS_MAP);
+  Record.push_back(LayoutsMap.size());
+  Stream.EmitRecordWithBlob(AbbrevID, Record,
+                            reinterpret_cast<char*>(LayoutsMap.data()),
+                            LayoutsMap.size() * sizeof(RecordLayoutsInfo));
+
+  // Emit the layouts themselves.
+  Stream.EmitRecord(RECORD_LAYOUTS, Layouts);
+}
+
 void ASTWriter::WriteMergedDecls() {
   if (!Chain || Chain->MergedDecls.empty())
     return;
@@ -3757,7 +3917,7 @@ ASTWriter::ASTWriter(llvm::BitstreamWriter &Stream)
     NextSubmoduleID(FirstSubmoduleID),
     FirstSelectorID(NUM_PREDEF_SELECTOR_IDS), NextSelectorID(FirstSelectorID),
     CollectedStmts(&StmtsToEmit),
-    NumStatements(0), NumMacros(0), NumLexicalDeclContexts(0),
+    NumStatements(0), NumFunctionBodies(0), NumMacros(0), NumLexicalDeclContexts(0),
     NumVisibleDeclContexts(0),
     NextCXXBaseSpecifiersID(1),
     DeclParmVarAbbrev(0), DeclContextLexicalAbbrev(0),
@@ -4255,6 +4415,7 @@ void ASTWriter::WriteASTCore(Sema &SemaRef,
   WriteRedeclarations();
   WriteMergedDecls();
   WriteObjCCategories();
+  WriteRecordLayouts(Context);
   
   // Some simple statistics
   Record.clear();
@@ -4262,6 +4423,7 @@ void ASTWriter::WriteASTCore(Sema &SemaRef,
   Record.push_back(NumMacros);
   Record.push_back(NumLexicalDeclContexts);
   Record.push_back(NumVisibleDeclContexts);
+  Record.push_back(NumFunctionBodies);
   Stream.EmitRecord(STATISTICS, Record);
   Stream.ExitBlock();
 }
@@ -13,13 +13,16 @@
 //===----------------------------------------------------------------------===//
 
 #include "clang/Serialization/ASTWriter.h"
+#include "ASTCommon.h"
 #include "clang/AST/ASTConsumer.h"
 #include "clang/AST/ASTContext.h"
 #include "clang/Basic/FileManager.h"
 #include "clang/Lex/Preprocessor.h"
 #include "clang/Sema/SemaConsumer.h"
 #include "llvm/Bitcode/BitstreamWriter.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/raw_ostream.h"
+#include <climits>
 #include <string>
 
 using namespace clang;
@@ -28,11 +31,12 @@ PCHGenerator::PCHGenerator(const Preprocessor &PP,
                            StringRef OutputFile,
                            clang::Module *Module,
                            StringRef isysroot,
-                           raw_ostream *OS, bool AllowASTWithErrors)
+                           raw_ostream *OS, bool AllowASTWithErrors,
+                           bool Compress)
   : PP(PP), OutputFile(OutputFile), Module(Module), 
     isysroot(isysroot.str()), Out(OS), 
     SemaPtr(0), Stream(Buffer), Writer(Stream),
-    AllowASTWithErrors(AllowASTWithErrors),
+    AllowASTWithErrors(AllowASTWithErrors), Compress(Compress),
     HasEmittedPCH(false) {
 }
 
@@ -48,18 +52,34 @@ void PCHGenerator::HandleTranslationUnit(ASTContext &Ctx) {
   if (hasErrors && !AllowASTWithErrors)
     return;
   
+  // A rebuilt PCH is usually about as large as the one it replaces. Reserve
+  // room for it up front, so that the buffer isn't copied each time it
+  // grows, which for large files costs time and doubles the peak memory use.
+  uint64_t PreviousSize;
+  if (!llvm::sys::fs::file_size(OutputFile, PreviousSize) &&
+      PreviousSize < UINT_MAX / 2)
+    Buffer.reserve(PreviousSize + PreviousSize / 8);
+
   // Emit the PCH file
   assert(SemaPtr && "No Sema?");
   Writer.WriteAST(*SemaPtr, OutputFile, Module, isysroot, hasErrors);
 
-  // Write the generated bitstream to "Out".
-  Out->write((char *)&Buffer.front(), Buffer.size());
+  // Write the generated bitstream to "Out", compressed if requested and
+  // possible.
+  SmallVector<char, 0> Compressed;
+  if (Compress &&
+      serialization::compressASTFile(StringRef(Buffer.data(), Buffer.size()),
+                                     Compressed))
+    Out->write(Compressed.data(), Compressed.size());
+  else
+    Out->write((char *)&Buffer.front(), Buffer.size());
 
   // Make sure it hits disk now.
   Out->flush();
 
-  // Free up some memory, in case the process is kept alive.
-  Buffer.clear();
+  // Free up the memory, in case the process is kept alive; clear() alone
+  // would keep the buffer allocated.
+  SmallVector<char, 128>().swap(Buffer);
 
   HasEmittedPCH = true;
 }
@@ -11,14 +11,17 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "ASTCommon.h"
 #include "ASTReaderInternals.h"
 #include "clang/Basic/FileManager.h"
 #include "clang/Basic/OnDiskHashTable.h"
+#include "clang/Basic/WorkerPool.h"
 #include "clang/Serialization/ASTBitCodes.h"
 #include "clang/Serialization/GlobalModuleIndex.h"
 #include "clang/Serialization/Module.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/MapVector.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/Bitcode/BitstreamReader.h"
@@ -56,7 +59,17 @@ namespace {
 static const char * const IndexFileName = "modules.idx";
 
 /// \brief The global index file version.
-static const unsigned CurrentVersion = 1;
+static const unsigned CurrentVersion = 2;
+
+/// \brief Encodes an entry of the identifier index, which records that the
+/// given module file knows about an identifier.
+///
+/// Module files that know about an identifier without finding it interesting
+/// are recorded too, so that the index can be rebuilt from its own entries
+/// for the module files that haven't changed.
+static unsigned getIdentifierEntry(unsigned ModuleID, bool IsInteresting) {
+  return (ModuleID << 1) | IsInteresting;
+}
 
 //----------------------------------------------------------------------------//
 // Global module index reader.
@@ -229,7 +242,9 @@ GlobalModuleIndex::readIndex(StringRef Path) {
   llvm::sys::path::append(IndexPath, IndexFileName);
 
   llvm::OwningPtr<llvm::MemoryBuffer> Buffer;
-  if (llvm::MemoryBuffer::getFile(IndexPath, Buffer) != llvm::errc::success)
+  if (llvm::MemoryBuffer::getFile(IndexPath, Buffer, /*FileSize=*/-1,
+                                  /*RequiresNullTerminator=*/false) !=
+      llvm::errc::success)
     return std::make_pair((GlobalModuleIndex *)0, EC_NotFound);
 
   /// \brief The bitstream reader from which we'll read the AST file.
@@ -293,9 +308,11 @@ bool GlobalModuleIndex::lookupIdentifier(StringRef Name, HitSet &Hits) {
     return true;
   }
 
-  SmallVector<unsigned, 2> ModuleIDs = *Known;
-  for (unsigned I = 0, N = ModuleIDs.size(); I != N; ++I) {
-    if (ModuleFile *MF = Modules[ModuleIDs[I]].File)
+  SmallVector<unsigned, 2> Entries = *Known;
+  for (unsigned I = 0, N = Entries.size(); I != N; ++I) {
+    if (!(Entries[I] & 0x01))
+      continue;
+    if (ModuleFile *MF = Modules[Entries[I] >> 1].File)
       Hits.insert(MF);
   }
 
@@ -355,6 +372,40 @@ namespace {
     SmallVector<unsigned, 4> Dependencies;
   };
 
+  /// \brief The parts of a module file that the index is built from.
+  ///
+  /// Module files are read without the file manager, which isn't
+  /// thread-safe, so that several of them can be read at once.
+  struct LoadedModuleFile {
+    LoadedModuleFile() : Failed(false) { }
+
+    /// \brief A module file imported by this one.
+    struct Import {
+      std::string FileName;
+
+      /// \brief The size and modification time of the imported file when
+      /// this module file was built.
+      off_t Size;
+      time_t ModTime;
+    };
+
+    /// \brief The path of the module file.
+    std::string Path;
+
+    /// \brief The contents of the module file, which the identifiers refer to.
+    llvm::OwningPtr<llvm::MemoryBuffer> Buffer;
+
+    /// \brief The module files imported by this one.
+    SmallVector<Import, 4> Imports;
+
+    /// \brief The identifiers this module file knows about, and whether it
+    /// considers them to be interesting.
+    std::vector<std::pair<StringRef, bool> > Identifiers;
+
+    /// \brief Whether the module file could not be read.
+    bool Failed;
+  };
+
   /// \brief Builder that generates the global module index file.
   class GlobalModuleIndexBuilder {
     FileManager &FileMgr;
@@ -365,12 +416,12 @@ namespace {
     /// \brief Information about each of the known module files.
     ModuleFilesMap ModuleFiles;
 
-    /// \brief Mapping from identifiers to the list of module file IDs that
-    /// consider this identifier to be interesting.
+    /// \brief Mapping from identifiers to the list of identifier index
+    /// entries for the module files that know about them.
     typedef llvm::StringMap<SmallVector<unsigned, 2> > InterestingIdentifierMap;
 
-    /// \brief A mapping from all interesting identifiers to the set of module
-    /// files in which those identifiers are considered interesting.
+    /// \brief A mapping from all identifiers to the set of module files that
+    /// know about them, and whether they consider them to be interesting.
     InterestingIdentifierMap InterestingIdentifiers;
     
     /// \brief Write the block-info block for the global module index file.
@@ -392,10 +443,24 @@ namespace {
   public:
     explicit GlobalModuleIndexBuilder(FileManager &FileMgr) : FileMgr(FileMgr){}
 
-    /// \brief Load the contents of the given module file into the builder.
+    /// \brief Add the contents of the given module file, as read by
+    /// \c readModuleFile, to the builder.
     ///
     /// \returns true if an error occurred, false otherwise.
-    bool loadModuleFile(const FileEntry *File);
+    bool addModuleFile(const FileEntry *File, const LoadedModuleFile &Loaded);
+
+    /// \brief Add a module file that depends on the given module files, as
+    /// known from a previous index.
+    void addModuleFile(const FileEntry *File,
+                       ArrayRef<const FileEntry *> Dependencies);
+
+    /// \brief Note that the given module file knows about an identifier.
+    void addIdentifier(StringRef Name, const FileEntry *File,
+                       bool IsInteresting) {
+      unsigned ID = getModuleFileInfo(File).ID;
+      InterestingIdentifiers[Name].push_back(
+          getIdentifierEntry(ID, IsInteresting));
+    }
 
     /// \brief Write the index to the given bitstream.
     void writeIndex(llvm::BitstreamWriter &Stream);
@@ -465,20 +530,26 @@ namespace {
   };
 }
 
-bool GlobalModuleIndexBuilder::loadModuleFile(const FileEntry *File) {
-  // Open the module file.
-  OwningPtr<llvm::MemoryBuffer> Buffer;
+/// \brief Read the parts of the module file at \c Loaded.Path that the index
+/// is built from, setting \c Loaded.Failed if it cannot be read.
+///
+/// This doesn't use the file manager, so it may run on any thread.
+static void readModuleFile(LoadedModuleFile &Loaded) {
+  // Open the module file. It may be replaced by another process at any time,
+  // so don't trust any size we have seen for it before.
   std::string ErrorStr;
-  Buffer.reset(FileMgr.getBufferForFile(File, &ErrorStr, /*isVolatile=*/true));
-  if (!Buffer) {
-    return true;
+  if (llvm::MemoryBuffer::getFile(Loaded.Path, Loaded.Buffer, /*FileSize=*/-1,
+                                  /*RequiresNullTerminator=*/false) ||
+      !serialization::uncompressASTFile(Loaded.Buffer, ErrorStr)) {
+    Loaded.Failed = true;
+    return;
   }
 
   // Initialize the input stream
   llvm::BitstreamReader InStreamFile;
   llvm::BitstreamCursor InStream;
-  InStreamFile.init((const unsigned char *)Buffer->getBufferStart(),
-                  (const unsigned char *)Buffer->getBufferEnd());
+  InStreamFile.init((const unsigned char *)Loaded.Buffer->getBufferStart(),
+                  (const unsigned char *)Loaded.Buffer->getBufferEnd());
   InStream.init(InStreamFile);
 
   // Sniff for the signature.
@@ -486,13 +557,10 @@ bool GlobalModuleIndexBuilder::loadModuleFile(const FileEntry *File) {
       InStream.Read(8) != 'P' ||
       InStream.Read(8) != 'C' ||
       InStream.Read(8) != 'H') {
-    return true;
+    Loaded.Failed = true;
+    return;
   }
 
-  // Record this module file and assign it a unique ID (if it doesn't have
-  // one already).
-  unsigned ID = getModuleFileInfo(File).ID;
-
   // Search for the blocks and records we care about.
   enum { Other, ControlBlock, ASTBlock } State = Other;
   bool Done = false;
@@ -515,8 +583,10 @@ bool GlobalModuleIndexBuilder::loadModuleFile(const FileEntry *File) {
 
     case llvm::BitstreamEntry::SubBlock:
       if (Entry.ID == CONTROL_BLOCK_ID) {
-        if (InStream.EnterSubBlock(CONTROL_BLOCK_ID))
-          return true;
+        if (InStream.EnterSubBlock(CONTROL_BLOCK_ID)) {
+          Loaded.Failed = true;
+          return;
+        }
 
         // Found the control block.
         State = ControlBlock;
@@ -524,16 +594,20 @@ bool GlobalModuleIndexBuilder::loadModuleFile(const FileEntry *File) {
       }
 
       if (Entry.ID == AST_BLOCK_ID) {
-        if (InStream.EnterSubBlock(AST_BLOCK_ID))
-          return true;
+        if (InStream.EnterSubBlock(AST_BLOCK_ID)) {
+          Loaded.Failed = true;
+          return;
+        }
 
         // Found the AST block.
         State = ASTBlock;
         continue;
       }
 
-      if (InStream.SkipBlock())
-        return true;
+      if (InStream.SkipBlock()) {
+        Loaded.Failed = true;
+        return;
+      }
 
       continue;
 
@@ -561,27 +635,17 @@ bool GlobalModuleIndexBuilder::loadModuleFile(const FileEntry *File) {
         ++Idx;
 
         // Load stored size/modification time. 
-        off_t StoredSize = (off_t)Record[Idx++];
-        time_t StoredModTime = (time_t)Record[Idx++];
+        LoadedModuleFile::Import Import;
+        Import.Size = (off_t)Record[Idx++];
+        Import.ModTime = (time_t)Record[Idx++];
 
         // Retrieve the imported file name.
         unsigned Length = Record[Idx++];
-        SmallString<128> ImportedFile(Record.begin() + Idx,
-                                      Record.begin() + Idx + Length);
+        Import.FileName.assign(Record.begin() + Idx,
+                               Record.begin() + Idx + Length);
         Idx += Length;
 
-        // Find the imported module file.
-        const FileEntry *DependsOnFile
-          = FileMgr.getFile(ImportedFile, /*openFile=*/false,
-                            /*cacheFailure=*/false);
-        if (!DependsOnFile ||
-            (StoredSize != DependsOnFile->getSize()) ||
-            (StoredModTime != DependsOnFile->getModificationTime()))
-          return true;
-
-        // Record the dependency.
-        unsigned DependsOnID = getModuleFileInfo(DependsOnFile).ID;
-        getModuleFileInfo(File).Dependencies.push_back(DependsOnID);
+        Loaded.Imports.push_back(Import);
       }
 
       continue;
@@ -597,21 +661,56 @@ bool GlobalModuleIndexBuilder::loadModuleFile(const FileEntry *File) {
                 (const unsigned char *)Blob.data()));
       for (InterestingIdentifierTable::data_iterator D = Table->data_begin(),
                                                      DEnd = Table->data_end();
-           D != DEnd; ++D) {
-        std::pair<StringRef, bool> Ident = *D;
-        if (Ident.second)
-          InterestingIdentifiers[Ident.first].push_back(ID);
-        else
-          (void)InterestingIdentifiers[Ident.first];
-      }
+           D != DEnd; ++D)
+        Loaded.Identifiers.push_back(*D);
     }
 
     // We don't care about this record.
   }
+}
+
+bool GlobalModuleIndexBuilder::addModuleFile(const FileEntry *File,
+                                             const LoadedModuleFile &Loaded) {
+  if (Loaded.Failed)
+    return true;
+
+  // Record this module file and assign it a unique ID (if it doesn't have
+  // one already).
+  unsigned ID = getModuleFileInfo(File).ID;
+
+  for (unsigned I = 0, N = Loaded.Imports.size(); I != N; ++I) {
+    const LoadedModuleFile::Import &Import = Loaded.Imports[I];
+
+    // Find the imported module file.
+    const FileEntry *DependsOnFile
+      = FileMgr.getFile(Import.FileName, /*openFile=*/false,
+                        /*cacheFailure=*/false);
+    if (!DependsOnFile ||
+        (Import.Size != DependsOnFile->getSize()) ||
+        (Import.ModTime != DependsOnFile->getModificationTime()))
+      return true;
+
+    // Record the dependency.
+    unsigned DependsOnID = getModuleFileInfo(DependsOnFile).ID;
+    getModuleFileInfo(File).Dependencies.push_back(DependsOnID);
+  }
+
+  for (unsigned I = 0, N = Loaded.Identifiers.size(); I != N; ++I)
+    InterestingIdentifiers[Loaded.Identifiers[I].first].push_back(
+        getIdentifierEntry(ID, Loaded.Identifiers[I].second));
 
   return false;
 }
 
+void GlobalModuleIndexBuilder::addModuleFile(
+    const FileEntry *File, ArrayRef<const FileEntry *> Dependencies) {
+  getModuleFileInfo(File);
+  for (unsigned I = 0, N = Dependencies.size(); I != N; ++I) {
+    unsigned DependsOnID = getModuleFileInfo(Dependencies[I]).ID;
+    getModuleFileInfo(File).Dependencies.push_back(DependsOnID);
+  }
+}
+
 namespace {
 
 /// \brief Trait used to generate the identifier index as an on-disk hash
@@ -728,6 +827,13 @@ void GlobalModuleIndexBuilder::writeIndex(llvm::BitstreamWriter &Stream) {
   Stream.ExitBlock();
 }
 
+/// \brief Reads one of the module files to be added to a new index.
+static void readModuleFileTask(void *Context, unsigned Index) {
+  std::vector<LoadedModuleFile *> &Loaded
+    = *static_cast<std::vector<LoadedModuleFile *> *>(Context);
+  readModuleFile(*Loaded[Index]);
+}
+
 GlobalModuleIndex::ErrorCode
 GlobalModuleIndex::writeIndex(FileManager &FileMgr, StringRef Path) {
   llvm::SmallString<128> IndexPath;
@@ -751,10 +857,8 @@ GlobalModuleIndex::writeIndex(FileManager &FileMgr, StringRef Path) {
     return EC_Building;
   }
 
-  // The module index builder.
-  GlobalModuleIndexBuilder Builder(FileMgr);
-  
-  // Load each of the module files.
+  // Find the module files.
+  SmallVector<const FileEntry *, 16> ModuleFiles;
   llvm::error_code EC;
   for (llvm::sys::fs::directory_iterator D(Path, EC), DEnd;
        D != DEnd && !EC;
@@ -775,11 +879,101 @@ GlobalModuleIndex::writeIndex(FileManager &FileMgr, StringRef Path) {
     if (!ModuleFile)
       continue;
 
-    // Load this module file.
-    if (Builder.loadModuleFile(ModuleFile))
-      return EC_IOError;
+    ModuleFiles.push_back(ModuleFile);
   }
 
+  // The module index builder.
+  GlobalModuleIndexBuilder Builder(FileMgr);
+
+  // Reuse what the current index knows about the module files that haven't
+  // changed since it was written, provided that the module files they depend
+  // on haven't changed either.
+  llvm::OwningPtr<GlobalModuleIndex> OldIndex(readIndex(Path).first);
+  SmallVector<unsigned, 16> OldIDs(ModuleFiles.size(), ~0U);
+  llvm::DenseMap<unsigned, const FileEntry *> Reusable;
+  if (OldIndex) {
+    llvm::StringMap<unsigned> OldIDsByName;
+    for (unsigned I = 0, N = OldIndex->Modules.size(); I != N; ++I)
+      if (!OldIndex->Modules[I].FileName.empty())
+        OldIDsByName[OldIndex->Modules[I].FileName] = I;
+
+    for (unsigned I = 0, N = ModuleFiles.size(); I != N; ++I) {
+      llvm::StringMap<unsigned>::iterator Known
+        = OldIDsByName.find(ModuleFiles[I]->getName());
+      if (Known == OldIDsByName.end())
+        continue;
+      const ModuleInfo &Info = OldIndex->Modules[Known->second];
+      if (Info.Size != ModuleFiles[I]->getSize() ||
+          Info.ModTime != ModuleFiles[I]->getModificationTime())
+        continue;
+      OldIDs[I] = Known->second;
+      Reusable[Known->second] = ModuleFiles[I];
+    }
+
+    for (bool Changed = true; Changed; ) {
+      Changed = false;
+      for (unsigned I = 0, N = ModuleFiles.size(); I != N; ++I) {
+        if (OldIDs[I] == ~0U || !Reusable.count(OldIDs[I]))
+          continue;
+        ArrayRef<unsigned> Deps = OldIndex->Modules[OldIDs[I]].Dependencies;
+        for (unsigned J = 0, M = Deps.size(); J != M; ++J) {
+          if (!Reusable.count(Deps[J])) {
+            Reusable.erase(OldIDs[I]);
+            Changed = true;
+            break;
+          }
+        }
+      }
+    }
+  }
+
+  // Add the reused module files, and collect the others to load.
+  std::vector<LoadedModuleFile *> Loaded;
+  SmallVector<const FileEntry *, 16> LoadedFiles;
+  for (unsigned I = 0, N = ModuleFiles.size(); I != N; ++I) {
+    if (OldIDs[I] == ~0U || !Reusable.count(OldIDs[I])) {
+      Loaded.push_back(new LoadedModuleFile());
+      Loaded.back()->Path = ModuleFiles[I]->getName();
+      LoadedFiles.push_back(ModuleFiles[I]);
+      continue;
+    }
+
+    ArrayRef<unsigned> Deps = OldIndex->Modules[OldIDs[I]].Dependencies;
+    SmallVector<const FileEntry *, 4> DependsOn;
+    for (unsigned J = 0, M = Deps.size(); J != M; ++J)
+      DependsOn.push_back(Reusable[Deps[J]]);
+    Builder.addModuleFile(ModuleFiles[I], DependsOn);
+  }
+
+  // Copy the identifier index entries of the reused module files.
+  if (!Reusable.empty() && OldIndex->IdentifierIndex) {
+    IdentifierIndexTable &Table
+      = *static_cast<IdentifierIndexTable *>(OldIndex->IdentifierIndex);
+    IdentifierIndexTable::data_iterator Data = Table.data_begin();
+    for (IdentifierIndexTable::key_iterator Key = Table.key_begin(),
+                                            KeyEnd = Table.key_end();
+         Key != KeyEnd; ++Key, ++Data) {
+      SmallVector<unsigned, 2> Entries = *Data;
+      for (unsigned I = 0, N = Entries.size(); I != N; ++I) {
+        llvm::DenseMap<unsigned, const FileEntry *>::iterator Known
+          = Reusable.find(Entries[I] >> 1);
+        if (Known != Reusable.end())
+          Builder.addIdentifier(*Key, Known->second, Entries[I] & 0x01);
+      }
+    }
+  }
+
+  // Read the new and changed module files in parallel, then add them in
+  // directory order so that the index doesn't depend on the scheduling.
+  runTasksInParallel(Loaded.size(), getEffectiveWorkerCount(0),
+                     readModuleFileTask, &Loaded);
+  bool Failed = false;
+  for (unsigned I = 0, N = Loaded.size(); I != N && !Failed; ++I)
+    Failed = Builder.addModuleFile(LoadedFiles[I], *Loaded[I]);
+  llvm::DeleteContainerPointers(Loaded);
+  if (Failed)
+    return EC_IOError;
+
   // The output buffer, into which the global index will be written.
   SmallVector<char, 16> OutputBuffer;
   {
@@ -805,14 +999,12 @@ GlobalModuleIndex::writeIndex(FileManager &FileMgr, StringRef Path) {
   if (Out.has_error())
     return EC_IOError;
 
-  // Remove the old index file. It isn't relevant any more.
-  bool OldIndexExisted;
-  llvm::sys::fs::remove(IndexPath.str(), OldIndexExisted);
-
-  // Rename the newly-written index file to the proper name.
+  // Rename the newly-written index file over the old one. Don't remove the
+  // old one first: readers keep using it until the rename replaces it.
   if (llvm::sys::fs::rename(IndexTmpPath.str(), IndexPath.str())) {
-    // Rename failed; just remove the 
-    llvm::sys::fs::remove(IndexTmpPath.str(), OldIndexExisted);
+    // Rename failed; just remove the temporary file.
+    bool TmpExisted;
+    llvm::sys::fs::remove(IndexTmpPath.str(), TmpExisted);
     return EC_IOError;
   }
 
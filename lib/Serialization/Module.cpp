@@ -27,7 +27,8 @@ ModuleFile::ModuleFile(ModuleKind Kind, unsigned Generation)
     SLocEntryBaseOffset(0), SLocEntryOffsets(0),
     LocalNumIdentifiers(0),
     IdentifierOffsets(0), BaseIdentifierID(0), IdentifierTableData(0),
-    IdentifierLookupTable(0),
+    IdentifierLookupTable(0), IdentifierFilter(0),
+    IdentifierFilterLog2Bits(0),
     LocalNumMacros(0), MacroOffsets(0),
     BasePreprocessedEntityID(0),
     PreprocessedEntityOffsets(0), NumPreprocessedEntities(0),
@@ -41,6 +42,7 @@ ModuleFile::ModuleFile(ModuleKind Kind, unsigned Generation)
     FileSortedDecls(0), NumFileSortedDecls(0),
     RedeclarationsMap(0), LocalNumRedeclarationsInMap(0),
     ObjCCategoriesMap(0), LocalNumObjCCategoriesInMap(0),
+    RecordLayoutsMap(0), LocalNumRecordLayoutsInMap(0),
     LocalNumTypes(0), TypeOffsets(0), BaseTypeIndex(0)
 {}
 
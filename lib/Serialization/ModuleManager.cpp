@@ -11,6 +11,7 @@
 //  modules for the ASTReader.
 //
 //===----------------------------------------------------------------------===//
+#include "ASTCommon.h"
 #include "clang/Lex/ModuleMap.h"
 #include "clang/Serialization/ModuleManager.h"
 #include "clang/Serialization/GlobalModuleIndex.h"
@@ -18,6 +19,7 @@
 #include "llvm/Support/Path.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Support/system_error.h"
+#include <algorithm>
 
 #ifndef NDEBUG
 #include "llvm/Support/GraphWriter.h"
@@ -96,13 +98,20 @@ ModuleManager::addModule(StringRef FileName, ModuleKind Type,
         ec = llvm::MemoryBuffer::getSTDIN(New->Buffer);
         if (ec)
           ErrorStr = ec.message();
-      } else
-        New->Buffer.reset(FileMgr.getBufferForFile(FileName, &ErrorStr));
+      } else {
+        // The bitstream reader doesn't need a null terminator, so the file
+        // can always be mapped, and shared with other processes importing it.
+        New->Buffer.reset(FileMgr.getBufferForFile(FileName, &ErrorStr,
+                                              /*RequiresNullTerminator=*/false));
+      }
       
       if (!New->Buffer)
         return Missing;
     }
-    
+
+    if (!serialization::uncompressASTFile(New->Buffer, ErrorStr))
+      return Missing;
+
     // Initialize the stream
     New->StreamFile.init((const unsigned char *)New->Buffer->getBufferStart(),
                          (const unsigned char *)New->Buffer->getBufferEnd());
@@ -199,6 +208,7 @@ void ModuleManager::returnVisitState(VisitState *State) {
 
 void ModuleManager::setGlobalIndex(GlobalModuleIndex *Index) {
   GlobalIndex = Index;
+  ModulesNotInGlobalIndexOutOfDate = true;
   if (!GlobalIndex) {
     ModulesInCommonWithGlobalIndex.clear();
     return;
@@ -218,10 +228,27 @@ void ModuleManager::moduleFileAccepted(ModuleFile *MF) {
     return;
 
   ModulesInCommonWithGlobalIndex.push_back(MF);
+  ModulesNotInGlobalIndexOutOfDate = true;
 }
 
 ModuleManager::ModuleManager(FileManager &FileMgr)
-  : FileMgr(FileMgr), GlobalIndex(), FirstVisitState(0) { }
+  : FileMgr(FileMgr), ModulesNotInGlobalIndexOutOfDate(true), GlobalIndex(),
+    FirstVisitState(0) { }
+
+namespace {
+/// \brief Orders module files by their position in the visitation order.
+class VisitOrderCompare {
+  ArrayRef<unsigned> Position;
+
+public:
+  explicit VisitOrderCompare(ArrayRef<unsigned> Position)
+    : Position(Position) { }
+
+  bool operator()(const ModuleFile *X, const ModuleFile *Y) const {
+    return Position[X->Index] < Position[Y->Index];
+  }
+};
+}
 
 ModuleManager::~ModuleManager() {
   for (unsigned i = 0, e = Chain.size(); i != e; ++i)
@@ -280,6 +307,11 @@ ModuleManager::visit(bool (*Visitor)(ModuleFile &M, void *UserData),
 
     assert(VisitOrder.size() == N && "Visitation order is wrong?");
 
+    VisitOrderPosition.resize(N);
+    for (unsigned I = 0; I != N; ++I)
+      VisitOrderPosition[VisitOrder[I]->Index] = I;
+    ModulesNotInGlobalIndexOutOfDate = true;
+
     delete FirstVisitState;
     FirstVisitState = 0;
   }
@@ -288,25 +320,39 @@ ModuleManager::visit(bool (*Visitor)(ModuleFile &M, void *UserData),
   unsigned VisitNumber = State->NextVisitNumber++;
 
   // If the caller has provided us with a hit-set that came from the global
-  // module index, mark every module file in common with the global module
-  // index that is *not* in that set as 'visited'.
+  // module index, the only module files with anything to find are those in
+  // that set and those the global module index doesn't know about. Visit
+  // just those, in visitation order, so that a lookup costs as much as the
+  // modules it hits rather than as much as all of the modules loaded.
+  ArrayRef<ModuleFile *> Order = VisitOrder;
   if (ModuleFilesHit && !ModulesInCommonWithGlobalIndex.empty()) {
-    for (unsigned I = 0, N = ModulesInCommonWithGlobalIndex.size(); I != N; ++I)
-    {
-      ModuleFile *M = ModulesInCommonWithGlobalIndex[I];
-      if (!ModuleFilesHit->count(M))
-        State->VisitNumber[M->Index] = VisitNumber;
+    if (ModulesNotInGlobalIndexOutOfDate) {
+      llvm::SmallPtrSet<ModuleFile *, 4> InCommon(
+          ModulesInCommonWithGlobalIndex.begin(),
+          ModulesInCommonWithGlobalIndex.end());
+      ModulesNotInGlobalIndex.clear();
+      for (unsigned I = 0, N = VisitOrder.size(); I != N; ++I)
+        if (!InCommon.count(VisitOrder[I]))
+          ModulesNotInGlobalIndex.push_back(VisitOrder[I]);
+      ModulesNotInGlobalIndexOutOfDate = false;
     }
+
+    State->Candidates.assign(ModulesNotInGlobalIndex.begin(),
+                             ModulesNotInGlobalIndex.end());
+    State->Candidates.append(ModuleFilesHit->begin(), ModuleFilesHit->end());
+    std::sort(State->Candidates.begin(), State->Candidates.end(),
+              VisitOrderCompare(VisitOrderPosition));
+    Order = State->Candidates;
   }
 
-  for (unsigned I = 0, N = VisitOrder.size(); I != N; ++I) {
-    ModuleFile *CurrentModule = VisitOrder[I];
+  for (unsigned I = 0, N = Order.size(); I != N; ++I) {
+    ModuleFile *CurrentModule = Order[I];
     // Should we skip this module file?
     if (State->VisitNumber[CurrentModule->Index] == VisitNumber)
       continue;
 
     // Visit the module.
-    assert(State->VisitNumber[CurrentModule->Index] == VisitNumber - 1);
+    assert(State->VisitNumber[CurrentModule->Index] < VisitNumber);
     State->VisitNumber[CurrentModule->Index] = VisitNumber;
     if (!Visitor(*CurrentModule, UserData))
       continue;
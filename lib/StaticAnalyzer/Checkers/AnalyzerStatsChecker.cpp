@@ -30,6 +30,8 @@ STATISTIC(NumBlocks,
           "The # of blocks in top level functions");
 STATISTIC(NumBlocksUnreachable,
           "The # of unreachable blocks in analyzing top level functions");
+STATISTIC(MaxGraphMemory,
+          "The maximum # of bytes allocated for an exploded graph");
 
 namespace {
 class AnalyzerStatsChecker : public Checker<check::EndAnalysis> {
@@ -104,13 +106,19 @@ void AnalyzerStatsChecker::checkEndAnalysis(ExplodedGraph &G,
   
   NumBlocksUnreachable += unreachable;
   NumBlocks += total;
+  size_t GraphMemory = G.getAllocatedMemory();
+  if (GraphMemory > MaxGraphMemory)
+    MaxGraphMemory = GraphMemory;
   std::string NameOfRootFunction = output.str();
 
   output << " -> Total CFGBlocks: " << total << " | Unreachable CFGBlocks: "
       << unreachable << " | Exhausted Block: "
       << (Eng.wasBlocksExhausted() ? "yes" : "no")
       << " | Empty WorkList: "
-      << (Eng.hasEmptyWorkList() ? "yes" : "no");
+      << (Eng.hasEmptyWorkList() ? "yes" : "no")
+      << " | Nodes: " << G.size()
+      << " | Reclaimed Nodes: " << G.getNumReclaimedNodes()
+      << " | Peak Graph Memory: " << (GraphMemory + 1023) / 1024 << " KB";
 
   B.EmitBasicReport(D, "Analyzer Statistics", "Internal Statistics",
                     output.str(), PathDiagnosticLocation(D, SM));
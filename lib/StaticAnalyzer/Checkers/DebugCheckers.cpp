@@ -33,11 +33,8 @@ class DominatorsTreeDumper : public Checker<check::ASTCodeBody> {
 public:
   void checkASTCodeBody(const Decl *D, AnalysisManager& mgr,
                         BugReporter &BR) const {
-    if (AnalysisDeclContext *AC = mgr.getAnalysisDeclContext(D)) {
-      DominatorTree dom;
-      dom.buildDominatorTree(*AC);
-      dom.dump();
-    }
+    if (DominatorTree *dom = mgr.getAnalysis<DominatorTree>(D))
+      dom->dump();
   }
 };
 }
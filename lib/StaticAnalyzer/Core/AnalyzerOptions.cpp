@@ -65,6 +65,22 @@ IPAKind AnalyzerOptions::getIPAMode() {
   return IPAMode;
 }
 
+ExplorationStrategyKind AnalyzerOptions::getExplorationStrategy() {
+  if (ExplorationStrategy == ESK_NotSet) {
+    StringRef StratStr(Config.GetOrCreateValue("exploration_strategy",
+                                               "dfs").getValue());
+    ExplorationStrategy = llvm::StringSwitch<ExplorationStrategyKind>(StratStr)
+      .Case("dfs", ESK_DFS)
+      .Case("bfs", ESK_BFS)
+      .Case("bfs_block_dfs_contents", ESK_BFSBlockDFSContents)
+      .Case("unexplored_first", ESK_UnexploredFirst)
+      .Default(ESK_NotSet);
+    assert(ExplorationStrategy != ESK_NotSet &&
+           "Exploration strategy is invalid.");
+  }
+  return ExplorationStrategy;
+}
+
 bool
 AnalyzerOptions::mayInlineCXXMemberFunction(CXXInlineableMemberKind K) {
   if (getIPAMode() < IPAK_Inlining)
@@ -229,12 +245,27 @@ unsigned AnalyzerOptions::getGraphTrimInterval() {
   return GraphTrimInterval.getValue();
 }
 
+unsigned AnalyzerOptions::getDeadSymbolSweepInterval() {
+  if (!DeadSymbolSweepInterval.hasValue()) {
+    int Interval = getOptionAsInteger("dead-symbol-sweep-interval", 1);
+    DeadSymbolSweepInterval = Interval > 1 ? Interval : 1;
+  }
+  return DeadSymbolSweepInterval.getValue();
+}
+
 unsigned AnalyzerOptions::getMaxTimesInlineLarge() {
   if (!MaxTimesInlineLarge.hasValue())
     MaxTimesInlineLarge = getOptionAsInteger("max-times-inline-large", 32);
   return MaxTimesInlineLarge.getValue();
 }
 
+unsigned AnalyzerOptions::getMaxBifurcationsPerPath() {
+  if (!MaxBifurcationsPerPath.hasValue())
+    MaxBifurcationsPerPath = getOptionAsInteger("max-bifurcations-per-path",
+                                                0);
+  return MaxBifurcationsPerPath.getValue();
+}
+
 unsigned AnalyzerOptions::getMaxNodesPerTopLevelFunction() {
   if (!MaxNodesPerTopLevelFunction.hasValue()) {
     int DefaultValue = 0;
@@ -254,10 +285,41 @@ unsigned AnalyzerOptions::getMaxNodesPerTopLevelFunction() {
   return MaxNodesPerTopLevelFunction.getValue();
 }
 
+unsigned AnalyzerOptions::getPathDiagnosticTimeLimit() {
+  if (!PathDiagnosticTimeLimit.hasValue())
+    PathDiagnosticTimeLimit = getOptionAsInteger("path-diagnostics-time-limit",
+                                                 0);
+  return PathDiagnosticTimeLimit.getValue();
+}
+
+unsigned AnalyzerOptions::getAnalysisShardCount() {
+  if (!AnalysisShardCount.hasValue()) {
+    int Count = getOptionAsInteger("shard-count", 1);
+    AnalysisShardCount = Count > 1 ? Count : 1;
+  }
+  return AnalysisShardCount.getValue();
+}
+
+unsigned AnalyzerOptions::getAnalysisShardIndex() {
+  if (!AnalysisShardIndex.hasValue()) {
+    // Don't record the option for unsharded runs, where it's meaningless.
+    unsigned Index = 0;
+    if (getAnalysisShardCount() > 1)
+      Index = getOptionAsInteger("shard-index", 0);
+    AnalysisShardIndex = Index;
+  }
+  return AnalysisShardIndex.getValue();
+}
+
 bool AnalyzerOptions::shouldSynthesizeBodies() {
   return getBooleanOption("faux-bodies", true);
 }
 
+bool AnalyzerOptions::shouldUseSideEffectSummaries() {
+  return getBooleanOption(UseSideEffectSummaries, "side-effect-summaries",
+                          /* Default = */ false);
+}
+
 bool AnalyzerOptions::shouldPrunePaths() {
   return getBooleanOption("prune-paths", true);
 }
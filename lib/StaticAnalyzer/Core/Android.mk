@@ -37,6 +37,7 @@ clang_static_analyzer_core_SRC_FILES := \
   HTMLDiagnostics.cpp \
   MemRegion.cpp \
   PathDiagnostic.cpp \
+  PersistentAnalysisFile.cpp \
   PlistDiagnostics.cpp \
   ProgramState.cpp \
   RangeConstraintManager.cpp \
@@ -69,7 +69,54 @@ BasicValueFactory::~BasicValueFactory() {
   delete (PersistentSValPairsTy*) PersistentSValPairs;
 }
 
+const llvm::APSInt **
+BasicValueFactory::getSmallValueSlot(unsigned BitWidth, bool IsUnsigned,
+                                     int64_t X) {
+  if (X < MinSmallValue || X > MaxSmallValue)
+    return 0;
+
+  unsigned WidthIdx;
+  switch (BitWidth) {
+  case 1:  WidthIdx = 0; break;
+  case 8:  WidthIdx = 1; break;
+  case 16: WidthIdx = 2; break;
+  case 32: WidthIdx = 3; break;
+  case 64: WidthIdx = 4; break;
+  default: return 0;
+  }
+
+  return &SmallValues[WidthIdx][IsUnsigned][X - MinSmallValue];
+}
+
+const llvm::APSInt **
+BasicValueFactory::getSmallValueSlot(const llvm::APSInt &X) {
+  // Bail out early on the values too large for the table, which may not fit
+  // in an int64_t.
+  int64_t V;
+  if (X.isUnsigned()) {
+    if (X.getActiveBits() > 6)
+      return 0;
+    V = X.getZExtValue();
+  } else {
+    if (X.getMinSignedBits() > 7)
+      return 0;
+    V = X.getSExtValue();
+  }
+  return getSmallValueSlot(X.getBitWidth(), X.isUnsigned(), V);
+}
+
 const llvm::APSInt& BasicValueFactory::getValue(const llvm::APSInt& X) {
+  const llvm::APSInt **Slot = getSmallValueSlot(X);
+  if (!Slot)
+    return getUniquedValue(X);
+
+  if (!*Slot)
+    *Slot = &getUniquedValue(X);
+  return **Slot;
+}
+
+const llvm::APSInt &
+BasicValueFactory::getUniquedValue(const llvm::APSInt &X) {
   llvm::FoldingSetNodeID ID;
   void *InsertPos;
   typedef llvm::FoldingSetNodeWrapper<llvm::APSInt> FoldNodeTy;
@@ -100,8 +147,19 @@ const llvm::APSInt& BasicValueFactory::getValue(uint64_t X, unsigned BitWidth,
 }
 
 const llvm::APSInt& BasicValueFactory::getValue(uint64_t X, QualType T) {
+  APSIntType Ty = getAPSIntType(T);
+
+  // Look up the small values before building the APSInt. A slot is only
+  // filled with the APSInt of its own value, so a value that X truncates to
+  // something else in a narrow type, like 1 in a signed i1, finds no entry.
+  if (X <= (uint64_t)MaxSmallValue) {
+    const llvm::APSInt **Slot =
+      getSmallValueSlot(Ty.getBitWidth(), Ty.isUnsigned(), X);
+    if (Slot && *Slot)
+      return **Slot;
+  }
 
-  return getValue(getAPSIntType(T).getValue(X));
+  return getValue(Ty.getValue(X));
 }
 
 const CompoundValData*
@@ -34,6 +34,7 @@
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/Statistic.h"
+#include "llvm/Support/Timer.h"
 #include "llvm/Support/raw_ostream.h"
 #include <queue>
 
@@ -45,6 +46,9 @@ STATISTIC(MaxBugClassSize,
 STATISTIC(MaxValidBugClassSize,
           "The maximum number of bug reports in the same equivalence class "
           "where at least one report is valid (not suppressed)");
+STATISTIC(NumPathsOverTimeLimit,
+          "The number of bug reports whose path was not generated because "
+          "path generation ran out of time");
 
 BugReporterVisitor::~BugReporterVisitor() {}
 
@@ -3035,6 +3039,24 @@ static void CompactPathDiagnostic(PathPieces &path, const SourceManager& SM) {
     path.push_back(*I);
 }
 
+namespace {
+/// \brief Adds the wall time spent in its scope to a total, if it has one.
+class PathGenerationTimer {
+  double *Total;
+  double Start;
+public:
+  explicit PathGenerationTimer(double *Total) : Total(Total), Start(0) {
+    if (Total)
+      Start = llvm::TimeRecord::getCurrentTime(/*Start=*/true).getWallTime();
+  }
+  ~PathGenerationTimer() {
+    if (Total)
+      *Total += llvm::TimeRecord::getCurrentTime(/*Start=*/false)
+                    .getWallTime() - Start;
+  }
+};
+}
+
 bool GRBugReporter::generatePathDiagnostic(PathDiagnostic& PD,
                                            PathDiagnosticConsumer &PC,
                                            ArrayRef<BugReport *> &bugReports) {
@@ -3070,6 +3092,16 @@ bool GRBugReporter::generatePathDiagnostic(PathDiagnostic& PD,
     }
   }
 
+  // Once the paths of this function took too long, still run the visitors,
+  // which may suppress the report, but don't build the path pieces.
+  unsigned TimeLimit = getAnalyzerOptions().getPathDiagnosticTimeLimit();
+  PathGenerationTimer Timer(TimeLimit ? &PathGenerationTime : 0);
+  if (TimeLimit && PathGenerationTime * 1000 >= TimeLimit &&
+      ActiveScheme != PathDiagnosticConsumer::None) {
+    ActiveScheme = PathDiagnosticConsumer::None;
+    ++NumPathsOverTimeLimit;
+  }
+
   TrimmedGraph TrimG(&getGraph(), errorNodes);
   ReportGraph ErrorGraph;
 
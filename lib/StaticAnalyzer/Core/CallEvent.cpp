@@ -439,28 +439,10 @@ RuntimeDefinition CXXInstanceCall::getRuntimeDefinition() const {
   if (!RD || !RD->hasDefinition())
     return RuntimeDefinition();
 
-  // Find the decl for this method in that class.
-  const CXXMethodDecl *Result = MD->getCorrespondingMethodInClass(RD, true);
-  if (!Result) {
-    // We might not even get the original statically-resolved method due to
-    // some particularly nasty casting (e.g. casts to sister classes).
-    // However, we should at least be able to search up and down our own class
-    // hierarchy, and some real bugs have been caught by checking this.
-    assert(!RD->isDerivedFrom(MD->getParent()) && "Couldn't find known method");
-    
-    // FIXME: This is checking that our DynamicTypeInfo is at least as good as
-    // the static type. However, because we currently don't update
-    // DynamicTypeInfo when an object is cast, we can't actually be sure the
-    // DynamicTypeInfo is up to date. This assert should be re-enabled once
-    // this is fixed. <rdar://problem/12287087>
-    //assert(!MD->getParent()->isDerivedFrom(RD) && "Bad DynamicTypeInfo");
-
-    return RuntimeDefinition();
-  }
-
-  // Does the decl that we found have an implementation?
-  const FunctionDecl *Definition;
-  if (!Result->hasBody(Definition))
+  // Find the definition of this method in that class.
+  CallEventManager &Mgr = getState()->getStateManager().getCallEventManager();
+  const FunctionDecl *Definition = Mgr.getOverriderDefinition(MD, RD);
+  if (!Definition)
     return RuntimeDefinition();
 
   // We found a definition. If we're not sure that this devirtualization is
@@ -471,6 +453,7 @@ RuntimeDefinition CXXInstanceCall::getRuntimeDefinition() const {
   return RuntimeDefinition(Definition, /*DispatchRegion=*/0);
 }
 
+
 void CXXInstanceCall::getInitialStackFrameContents(
                                             const StackFrameContext *CalleeCtx,
                                             BindingsTy &Bindings) const {
@@ -885,6 +868,42 @@ void ObjCMethodCall::getInitialStackFrameContents(
   }
 }
 
+const FunctionDecl *
+CallEventManager::getOverriderDefinition(const CXXMethodDecl *MD,
+                                         const CXXRecordDecl *RD) {
+  std::pair<OverriderMapTy::iterator, bool> Cached =
+      OverriderDefinitions.insert(std::make_pair(std::make_pair(MD, RD),
+                                                 (const FunctionDecl *)0));
+  if (!Cached.second)
+    return Cached.first->second;
+
+  // Find the decl for this method in that class.
+  const CXXMethodDecl *Result = MD->getCorrespondingMethodInClass(RD, true);
+  if (!Result) {
+    // We might not even get the original statically-resolved method due to
+    // some particularly nasty casting (e.g. casts to sister classes).
+    // However, we should at least be able to search up and down our own class
+    // hierarchy, and some real bugs have been caught by checking this.
+    assert(!RD->isDerivedFrom(MD->getParent()) && "Couldn't find known method");
+    
+    // FIXME: This is checking that our DynamicTypeInfo is at least as good as
+    // the static type. However, because we currently don't update
+    // DynamicTypeInfo when an object is cast, we can't actually be sure the
+    // DynamicTypeInfo is up to date. This assert should be re-enabled once
+    // this is fixed. <rdar://problem/12287087>
+    //assert(!MD->getParent()->isDerivedFrom(RD) && "Bad DynamicTypeInfo");
+
+    return 0;
+  }
+
+  // Does the decl that we found have an implementation?
+  const FunctionDecl *Definition;
+  if (!Result->hasBody(Definition))
+    return 0;
+  Cached.first->second = Definition;
+  return Definition;
+}
+
 CallEventRef<>
 CallEventManager::getSimpleCall(const CallExpr *CE, ProgramStateRef State,
                                 const LocationContext *LCtx) {
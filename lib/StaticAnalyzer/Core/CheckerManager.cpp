@@ -13,6 +13,7 @@
 
 #include "clang/StaticAnalyzer/Core/CheckerManager.h"
 #include "clang/AST/DeclBase.h"
+#include "clang/AST/Stmt.h"
 #include "clang/Analysis/ProgramPoint.h"
 #include "clang/StaticAnalyzer/Core/Checker.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/CallEvent.h"
@@ -169,8 +170,14 @@ void CheckerManager::runCheckersForStmt(bool isPreVisit,
                                         const Stmt *S,
                                         ExprEngine &Eng,
                                         bool WasInlined) {
-  CheckStmtContext C(isPreVisit, *getCachedStmtCheckersFor(S, isPreVisit),
-                     S, Eng, WasInlined);
+  const CachedStmtCheckers &Checkers = *getCachedStmtCheckersFor(S, isPreVisit);
+  // Most statements are not of interest to any checker.
+  if (Checkers.empty()) {
+    Dst.insert(Src);
+    return;
+  }
+
+  CheckStmtContext C(isPreVisit, Checkers, S, Eng, WasInlined);
   expandGraphWithCheckers(C, Dst, Src);
 }
 
@@ -692,23 +699,24 @@ CheckerManager::CachedStmtCheckers *
 CheckerManager::getCachedStmtCheckersFor(const Stmt *S, bool isPreVisit) {
   assert(S);
 
-  CachedStmtCheckersKey key(S->getStmtClass(), isPreVisit);
-  CachedStmtCheckers *checkers = 0;
-  CachedStmtCheckersMapTy::iterator CCI = CachedStmtCheckersMap.find(key);
-  if (CCI != CachedStmtCheckersMap.end()) {
-    checkers = &(CCI->second);
-  } else {
+  if (CachedStmtCheckersTable.empty()) {
+    CachedStmtCheckersTable.resize(2 * (Stmt::lastStmtConstant + 1));
+    StmtCheckersComputed.resize(CachedStmtCheckersTable.size());
+  }
+
+  unsigned Index = 2 * S->getStmtClass() + isPreVisit;
+  CachedStmtCheckers &checkers = CachedStmtCheckersTable[Index];
+  if (!StmtCheckersComputed[Index]) {
     // Find the checkers that should run for this Stmt and cache them.
-    checkers = &CachedStmtCheckersMap[key];
+    StmtCheckersComputed.set(Index);
     for (unsigned i = 0, e = StmtCheckers.size(); i != e; ++i) {
       StmtCheckerInfo &info = StmtCheckers[i];
       if (info.IsPreVisit == isPreVisit && info.IsForStmtFn(S))
-        checkers->push_back(info.CheckFn);
+        checkers.push_back(info.CheckFn);
     }
   }
 
-  assert(checkers);
-  return checkers;
+  return &checkers;
 }
 
 CheckerManager::~CheckerManager() {
@@ -20,8 +20,11 @@
 #include "clang/StaticAnalyzer/Core/PathSensitive/AnalysisManager.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/ExprEngine.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/Support/Casting.h"
+#include <algorithm>
+#include <vector>
 
 using namespace clang;
 using namespace ento;
@@ -156,10 +159,112 @@ WorkList* WorkList::makeBFSBlockDFSContents() {
   return new BFSBlockDFSContents();
 }
 
+namespace {
+  /// Prefers the nodes entering blocks that no path has reached yet, so that
+  /// the node budget goes to new code rather than to yet another trip
+  /// through the same blocks. The other nodes are ordered by the number of
+  /// times their path has visited their block, and otherwise depth-first.
+  class UnexploredFirst : public WorkList {
+    struct Item {
+      WorkListUnit U;
+      unsigned Priority;
+      unsigned Order;
+
+      Item(const WorkListUnit &U, unsigned Priority, unsigned Order)
+        : U(U), Priority(Priority), Order(Order) {}
+    };
+
+    /// Orders the heap so that its top is the item with the lowest priority
+    /// value, and among those the most recently enqueued.
+    struct ComesAfter {
+      bool operator()(const Item &LHS, const Item &RHS) const {
+        if (LHS.Priority != RHS.Priority)
+          return LHS.Priority > RHS.Priority;
+        return LHS.Order < RHS.Order;
+      }
+    };
+
+    typedef std::pair<const CFGBlock *, const StackFrameContext *> BlockInFrame;
+
+    std::vector<Item> Heap;
+    llvm::DenseSet<BlockInFrame> Reached;
+    unsigned NumEnqueued;
+
+  public:
+    UnexploredFirst() : NumEnqueued(0) {}
+
+    virtual bool hasWork() const {
+      return !Heap.empty();
+    }
+
+    virtual void enqueue(const WorkListUnit& U) {
+      const ExplodedNode *N = U.getNode();
+      const StackFrameContext *SF =
+          N->getLocationContext()->getCurrentStackFrame();
+      const CFGBlock *B = U.getBlock();
+      Optional<BlockEntrance> BE = N->getLocation().getAs<BlockEntrance>();
+      if (BE)
+        B = BE->getBlock();
+
+      unsigned Priority = 1;
+      if (BE && Reached.insert(BlockInFrame(B, SF)).second)
+        Priority = 0;
+      else if (B)
+        Priority += U.getBlockCounter().getNumVisited(SF, B->getBlockID());
+
+      Heap.push_back(Item(U, Priority, NumEnqueued++));
+      std::push_heap(Heap.begin(), Heap.end(), ComesAfter());
+    }
+
+    virtual WorkListUnit dequeue() {
+      assert(!Heap.empty());
+      std::pop_heap(Heap.begin(), Heap.end(), ComesAfter());
+      WorkListUnit U = Heap.back().U;
+      Heap.pop_back();
+      return U;
+    }
+
+    virtual bool visitItemsInWorkList(Visitor &V) {
+      for (std::vector<Item>::iterator I = Heap.begin(), E = Heap.end();
+           I != E; ++I) {
+        if (V.visit(I->U))
+          return true;
+      }
+      return false;
+    }
+  };
+} // end anonymous namespace
+
+WorkList *WorkList::makeUnexploredFirst() {
+  return new UnexploredFirst();
+}
+
 //===----------------------------------------------------------------------===//
 // Core analysis engine.
 //===----------------------------------------------------------------------===//
 
+static WorkList *generateWorkList(AnalyzerOptions &Opts) {
+  switch (Opts.getExplorationStrategy()) {
+  case ESK_BFS:
+    return WorkList::makeBFS();
+  case ESK_BFSBlockDFSContents:
+    return WorkList::makeBFSBlockDFSContents();
+  case ESK_UnexploredFirst:
+    return WorkList::makeUnexploredFirst();
+  case ESK_DFS:
+  case ESK_NotSet:
+    break;
+  }
+  return WorkList::makeDFS();
+}
+
+CoreEngine::CoreEngine(SubEngine &subengine, FunctionSummariesTy *FS,
+                       AnalyzerOptions &Opts)
+  : SubEng(subengine), G(new ExplodedGraph()),
+    WList(generateWorkList(Opts)),
+    BCounterFactory(G->getAllocator()),
+    FunctionSummaries(FS) {}
+
 /// ExecuteWorkList - Run the worklist algorithm for a maximum number of steps.
 bool CoreEngine::ExecuteWorkList(const LocationContext *L, unsigned Steps,
                                    ProgramStateRef InitState) {
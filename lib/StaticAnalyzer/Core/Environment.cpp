@@ -56,8 +56,37 @@ EnvironmentEntry::EnvironmentEntry(const Stmt *S, const LocationContext *L)
               const StackFrameContext *>(ignoreTransparentExprs(S),
                                          L ? L->getCurrentStackFrame() : 0) {}
 
+EnvironmentSmallBindings::EnvironmentSmallBindings(
+    ArrayRef<value_type> Bindings) : NumBindings(Bindings.size()) {
+  value_type *Dest = reinterpret_cast<value_type *>(this + 1);
+  for (unsigned i = 0; i != NumBindings; ++i)
+    new (Dest + i) value_type(Bindings[i]);
+}
+
+void EnvironmentSmallBindings::Profile(llvm::FoldingSetNodeID &ID,
+                                       ArrayRef<value_type> Bindings) {
+  ID.AddInteger(Bindings.size());
+  for (ArrayRef<value_type>::iterator I = Bindings.begin(),
+                                      E = Bindings.end(); I != E; ++I) {
+    I->first.Profile(ID);
+    I->second.Profile(ID);
+  }
+}
+
+const SVal *Environment::lookup(const EnvironmentEntry &E) const {
+  if (!SmallBindings)
+    return ExprBindings.lookup(E);
+
+  for (const EnvironmentSmallBindings::value_type *I = SmallBindings->begin(),
+                                                  *IE = SmallBindings->end();
+       I != IE; ++I)
+    if (I->first == E)
+      return &I->second;
+  return 0;
+}
+
 SVal Environment::lookupExpr(const EnvironmentEntry &E) const {
-  const SVal* X = ExprBindings.lookup(E);
+  const SVal* X = lookup(E);
   if (X) {
     SVal V = *X;
     return V;
@@ -105,17 +134,74 @@ SVal Environment::getSVal(const EnvironmentEntry &Entry,
   }
 }
 
+typedef EnvironmentSmallBindings::value_type EnvironmentBinding;
+
+Environment
+EnvironmentManager::makeEnvironment(ArrayRef<EnvironmentBinding> Bindings) {
+  if (Bindings.empty())
+    return getInitialEnvironment();
+
+  if (Bindings.size() <= Environment::SmallBindingsLimit) {
+    llvm::FoldingSetNodeID ID;
+    EnvironmentSmallBindings::Profile(ID, Bindings);
+    void *InsertPos;
+    EnvironmentSmallBindings *SB =
+      SmallBindingsSet.FindNodeOrInsertPos(ID, InsertPos);
+    if (!SB) {
+      void *Mem = Alloc.Allocate(sizeof(EnvironmentSmallBindings) +
+                                     Bindings.size() *
+                                         sizeof(EnvironmentBinding),
+                                 llvm::alignOf<EnvironmentSmallBindings>());
+      SB = new (Mem) EnvironmentSmallBindings(Bindings);
+      SmallBindingsSet.InsertNode(SB, InsertPos);
+    }
+    return Environment(SB, F.getEmptyMap());
+  }
+
+  // Build the tree without canonicalizing every intermediate one.
+  llvm::ImmutableMapRef<EnvironmentEntry,SVal>
+    EBMapRef(F.getEmptyMap().getRootWithoutRetain(), F.getTreeFactory());
+  for (ArrayRef<EnvironmentBinding>::iterator I = Bindings.begin(),
+                                              E = Bindings.end(); I != E; ++I)
+    EBMapRef = EBMapRef.add(I->first, I->second);
+  return Environment(EBMapRef.asImmutableMap(), Bindings.size());
+}
+
 Environment EnvironmentManager::bindExpr(Environment Env,
                                          const EnvironmentEntry &E,
                                          SVal V,
                                          bool Invalidate) {
-  if (V.isUnknown()) {
-    if (Invalidate)
-      return Environment(F.remove(Env.ExprBindings, E));
-    else
-      return Env;
+  bool Remove = V.isUnknown();
+  if (Remove && !Invalidate)
+    return Env;
+
+  bool Bound = Env.lookup(E) != 0;
+  if (Remove && !Bound)
+    return Env;
+
+  // Stay with a tree as long as there are too many bindings for an array.
+  if (!Env.SmallBindings && Env.size() > Environment::SmallBindingsLimit) {
+    if (!Remove)
+      return Environment(F.add(Env.ExprBindings, E, V),
+                         Bound ? Env.size() : Env.size() + 1);
+    if (Env.size() - 1 > Environment::SmallBindingsLimit)
+      return Environment(F.remove(Env.ExprBindings, E), Env.size() - 1);
   }
-  return Environment(F.add(Env.ExprBindings, E, V));
+
+  // Otherwise, work on the sorted bindings.
+  SmallVector<EnvironmentBinding, Environment::SmallBindingsLimit + 1>
+    Bindings;
+  Environment::iterator I = Env.begin(), IE = Env.end();
+  for (; I != IE && I.getKey() < E; ++I)
+    Bindings.push_back(EnvironmentBinding(I.getKey(), I.getData()));
+  if (!Remove)
+    Bindings.push_back(EnvironmentBinding(E, V));
+  if (Bound)
+    ++I;
+  for (; I != IE; ++I)
+    Bindings.push_back(EnvironmentBinding(I.getKey(), I.getData()));
+
+  return makeEnvironment(Bindings);
 }
 
 namespace {
@@ -149,16 +235,12 @@ EnvironmentManager::removeDeadBindings(Environment Env,
   // We construct a new Environment object entirely, as this is cheaper than
   // individually removing all the subexpression bindings (which will greatly
   // outnumber block-level expression bindings).
-  Environment NewEnv = getInitialEnvironment();
+  SmallVector<EnvironmentBinding, 16> LiveBindings;
 
   MarkLiveCallback CB(SymReaper);
   ScanReachableSymbols RSScaner(ST, CB);
 
-  llvm::ImmutableMapRef<EnvironmentEntry,SVal>
-    EBMapRef(NewEnv.ExprBindings.getRootWithoutRetain(),
-             F.getTreeFactory());
-
-  // Iterate over the block-expr bindings.
+  // Iterate over the block-expr bindings, which are sorted by entry.
   for (Environment::iterator I = Env.begin(), E = Env.end();
        I != E; ++I) {
 
@@ -167,7 +249,7 @@ EnvironmentManager::removeDeadBindings(Environment Env,
 
     if (SymReaper.isLive(BlkExpr.getStmt(), BlkExpr.getLocationContext())) {
       // Copy the binding to the new map.
-      EBMapRef = EBMapRef.add(BlkExpr, X);
+      LiveBindings.push_back(EnvironmentBinding(BlkExpr, X));
 
       // If the block expr's value is a memory region, then mark that region.
       if (Optional<loc::MemRegionVal> R = X.getAs<loc::MemRegionVal>())
@@ -183,8 +265,10 @@ EnvironmentManager::removeDeadBindings(Environment Env,
     }
   }
 
-  NewEnv.ExprBindings = EBMapRef.asImmutableMap();
-  return NewEnv;
+  // Keep the environment if all of its bindings are live.
+  if (LiveBindings.size() == Env.size())
+    return Env;
+  return makeEnvironment(LiveBindings);
 }
 
 void Environment::print(raw_ostream &Out, const char *NL,
@@ -48,7 +48,7 @@ void ExplodedNode::SetAuditor(ExplodedNode::Auditor* A) {
 //===----------------------------------------------------------------------===//
 
 ExplodedGraph::ExplodedGraph()
-  : NumNodes(0), ReclaimNodeInterval(0) {}
+  : NumNodes(0), NumReclaimedNodes(0), ReclaimNodeInterval(0) {}
 
 ExplodedGraph::~ExplodedGraph() {}
 
@@ -169,11 +169,12 @@ void ExplodedGraph::collectNode(ExplodedNode *node) {
   FreeNodes.push_back(node);
   Nodes.RemoveNode(node);
   --NumNodes;
+  ++NumReclaimedNodes;
   node->~ExplodedNode();  
 }
 
 void ExplodedGraph::reclaimRecentlyAllocatedNodes() {
-  if (ChangedNodes.empty())
+  if (ChangedNodes.empty() && FrontierNodes.empty())
     return;
 
   // Only periodically reclaim nodes so that we can build up a set of
@@ -184,12 +185,25 @@ void ExplodedGraph::reclaimRecentlyAllocatedNodes() {
     return;
   ReclaimCounter = ReclaimNodeInterval;
 
-  for (NodeVector::iterator it = ChangedNodes.begin(), et = ChangedNodes.end();
+  // Nodes on the frontier of the previous round have usually been expanded
+  // since. Whatever is still on the frontier is likely the end of a path.
+  for (NodeVector::iterator it = FrontierNodes.begin(),
+                            et = FrontierNodes.end();
        it != et; ++it) {
     ExplodedNode *node = *it;
     if (shouldCollect(node))
       collectNode(node);
   }
+  FrontierNodes.clear();
+
+  for (NodeVector::iterator it = ChangedNodes.begin(), et = ChangedNodes.end();
+       it != et; ++it) {
+    ExplodedNode *node = *it;
+    if (node->succ_empty() && !node->isSink())
+      FrontierNodes.push_back(node);
+    else if (shouldCollect(node))
+      collectNode(node);
+  }
   ChangedNodes.clear();
 }
 
@@ -246,7 +260,8 @@ void ExplodedNode::NodeGroup::addNode(ExplodedNode *N, ExplodedGraph &G) {
 
     BumpVectorContext &Ctx = G.getNodeAllocator();
     V = G.getAllocator().Allocate<ExplodedNodeVector>();
-    new (V) ExplodedNodeVector(Ctx, 4);
+    // Most nodes with several predecessors or successors have two.
+    new (V) ExplodedNodeVector(Ctx, 2);
     V->push_back(Old, Ctx);
 
     Storage = V;
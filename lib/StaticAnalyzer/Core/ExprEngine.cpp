@@ -42,6 +42,13 @@ using llvm::APSInt;
 
 STATISTIC(NumRemoveDeadBindings,
             "The # of times RemoveDeadBindings is called");
+STATISTIC(NumRemoveDeadBindingsSkipped,
+            "The # of times RemoveDeadBindings is skipped because of the "
+            "dead symbol sweep interval");
+STATISTIC(NumRemoveDeadBindingsWithDeadSymbols,
+            "The # of times RemoveDeadBindings found dead symbols");
+STATISTIC(NumDeadSymbols,
+            "The # of dead symbols found by RemoveDeadBindings");
 STATISTIC(NumMaxBlockCountReached,
             "The # of aborted paths due to reaching the maximum block count in "
             "a top level function");
@@ -61,7 +68,7 @@ ExprEngine::ExprEngine(AnalysisManager &mgr, bool gcEnabled,
                        InliningModes HowToInlineIn)
   : AMgr(mgr),
     AnalysisDeclContexts(mgr.getAnalysisDeclContextManager()),
-    Engine(*this, FS),
+    Engine(*this, FS, mgr.getAnalyzerOptions()),
     G(Engine.getGraph()),
     StateMgr(getContext(), mgr.getStoreManagerCreator(),
              mgr.getConstraintManagerCreator(), G.getAllocator(),
@@ -297,6 +304,7 @@ void ExprEngine::processCFGElement(const CFGElement E, ExplodedNode *Pred,
 
 static bool shouldRemoveDeadBindings(AnalysisManager &AMgr,
                                      const CFGStmt S,
+                                     unsigned StmtIdx,
                                      const ExplodedNode *Pred,
                                      const LocationContext *LC) {
   
@@ -304,22 +312,35 @@ static bool shouldRemoveDeadBindings(AnalysisManager &AMgr,
   if (AMgr.options.AnalysisPurgeOpt == PurgeNone)
     return false;
 
+  unsigned Interval = AMgr.options.getDeadSymbolSweepInterval();
+
   // Is this the beginning of a basic block?
   if (Pred->getLocation().getAs<BlockEntrance>())
     return true;
 
-  // Is this on a non-expression?
-  if (!isa<Expr>(S.getStmt()))
-    return true;
-    
+  // Are we purging state values only at the beginning of basic blocks?
+  if (AMgr.options.AnalysisPurgeOpt == PurgeBlock)
+    return false;
+
   // Run before processing a call.
   if (CallEvent::isCallStmt(S.getStmt()))
     return true;
 
   // Is this an expression that is consumed by another expression?  If so,
   // postpone cleaning out the state.
-  ParentMap &PM = LC->getAnalysisDeclContext()->getParentMap();
-  return !PM.isConsumedExpr(cast<Expr>(S.getStmt()));
+  if (const Expr *Ex = dyn_cast<Expr>(S.getStmt())) {
+    ParentMap &PM = LC->getAnalysisDeclContext()->getParentMap();
+    if (PM.isConsumedExpr(Ex))
+      return false;
+  }
+
+  // Within a basic block, only clean out the state every few statements if
+  // the sweep interval asks for it.
+  if (StmtIdx % Interval != 0) {
+    ++NumRemoveDeadBindingsSkipped;
+    return false;
+  }
+  return true;
 }
 
 void ExprEngine::removeDead(ExplodedNode *Pred, ExplodedNodeSet &Out,
@@ -370,6 +391,11 @@ void ExprEngine::removeDead(ExplodedNode *Pred, ExplodedNodeSet &Out,
     Bldr.generateNode(DiagnosticStmt, Pred, CleanedState, &cleanupTag, K);
 
   } else {
+    ++NumRemoveDeadBindingsWithDeadSymbols;
+    for (SymbolReaper::dead_iterator I = SymReaper.dead_begin(),
+                                     E = SymReaper.dead_end(); I != E; ++I)
+      ++NumDeadSymbols;
+
     // Call checkers with the non-cleaned state so that they could query the
     // values of the soon to be dead symbols.
     ExplodedNodeSet CheckedSet;
@@ -416,7 +442,8 @@ void ExprEngine::ProcessStmt(const CFGStmt S,
 
   // Remove dead bindings and symbols.
   ExplodedNodeSet CleanedStates;
-  if (shouldRemoveDeadBindings(AMgr, S, Pred, Pred->getLocationContext())){
+  if (shouldRemoveDeadBindings(AMgr, S, currStmtIdx, Pred,
+                               Pred->getLocationContext())) {
     removeDead(Pred, CleanedStates, currStmt, Pred->getLocationContext());
   } else
     CleanedStates.Add(Pred);
@@ -668,6 +695,7 @@ void ExprEngine::Visit(const Stmt *S, ExplodedNode *Pred,
     case Expr::MSDependentExistsStmtClass:
     case Stmt::CapturedStmtClass:
     case Stmt::OMPParallelDirectiveClass:
+    case Stmt::OMPSimdDirectiveClass:
       llvm_unreachable("Stmt should not be in analyzer evaluation loop");
 
     case Stmt::ObjCSubscriptRefExprClass:
@@ -31,12 +31,20 @@ using namespace ento;
 STATISTIC(NumOfDynamicDispatchPathSplits,
   "The # of times we split the path due to imprecise dynamic dispatch info");
 
+STATISTIC(NumOfDynamicDispatchSplitsAvoided,
+  "The # of times we didn't split the path due to imprecise dynamic dispatch "
+  "info because of the limit on splits per path");
+
 STATISTIC(NumInlinedCalls,
   "The # of times we inlined a call");
 
 STATISTIC(NumReachedInlineCountMax,
   "The # of times we reached inline count maximum");
 
+STATISTIC(NumSummarizedCalls,
+  "The # of calls evaluated without invalidation because of the side effect "
+  "summary of the callee");
+
 void ExprEngine::processCallEnter(CallEnter CE, ExplodedNode *Pred) {
   // Get the entry block in the CFG of the callee.
   const StackFrameContext *calleeCtx = CE.getCalleeContext();
@@ -413,6 +421,10 @@ REGISTER_TRAIT_WITH_PROGRAMSTATE(DynamicDispatchBifurcationMap,
                                  CLANG_ENTO_PROGRAMSTATE_MAP(const MemRegion *,
                                                              unsigned))
 
+// The number of times the path has been split by dynamic dispatch
+// bifurcation, to be kept under the 'max-bifurcations-per-path' limit.
+REGISTER_TRAIT_WITH_PROGRAMSTATE(DynamicDispatchSplitCount, unsigned)
+
 bool ExprEngine::inlineCall(const CallEvent &Call, const Decl *D,
                             NodeBuilder &Bldr, ExplodedNode *Pred,
                             ProgramStateRef State) {
@@ -571,10 +583,35 @@ ProgramStateRef ExprEngine::bindReturnValue(const CallEvent &Call,
 
 // Conservatively evaluate call by invalidating regions and binding
 // a conjured return value.
+/// Returns true if the summary of the callee shows that \p Call can't change
+/// the memory of the caller, so that it needs no invalidation.
+static bool isSideEffectFreeCall(const CallEvent &Call, AnalyzerOptions &Opts,
+                                 FunctionSummariesTy &Summaries) {
+  if (!Opts.shouldUseSideEffectSummaries())
+    return false;
+  if (Call.getKind() != CE_Function)
+    return false;
+  const FunctionDecl *FD = dyn_cast_or_null<FunctionDecl>(Call.getDecl());
+  if (!FD)
+    return false;
+
+  // A pointer result could alias the arguments, which would otherwise
+  // escape through the invalidation.
+  QualType ResultTy = Call.getResultType();
+  if (!ResultTy->isVoidType() && !ResultTy->isIntegralOrEnumerationType() &&
+      !ResultTy->isRealFloatingType())
+    return false;
+
+  return !Summaries.mayHaveSideEffects(FD);
+}
+
 void ExprEngine::conservativeEvalCall(const CallEvent &Call, NodeBuilder &Bldr,
                                       ExplodedNode *Pred,
                                       ProgramStateRef State) {
-  State = Call.invalidateRegions(currBldrCtx->blockCount(), State);
+  if (isSideEffectFreeCall(Call, AMgr.options, *Engine.FunctionSummaries))
+    ++NumSummarizedCalls;
+  else
+    State = Call.invalidateRegions(currBldrCtx->blockCount(), State);
   State = bindReturnValue(Call, Pred->getLocationContext(), State);
 
   // And make the result node.
@@ -963,8 +1000,23 @@ void ExprEngine::BifurcateCall(const MemRegion *BifurReg,
     return;
   }
 
+  // If the path has been split too many times already, only take the
+  // inlined path, as -analyzer-config ipa=dynamic would.
+  unsigned Splits = State->get<DynamicDispatchSplitCount>();
+  unsigned MaxSplits = AMgr.options.getMaxBifurcationsPerPath();
+  if (MaxSplits && Splits >= MaxSplits) {
+    ProgramStateRef IState =
+        State->set<DynamicDispatchBifurcationMap>(BifurReg,
+                                                 DynamicDispatchModeInlined);
+    ++NumOfDynamicDispatchSplitsAvoided;
+    if (!inlineCall(Call, D, Bldr, Pred, IState))
+      conservativeEvalCall(Call, Bldr, Pred, IState);
+    return;
+  }
+
   // If we got here, this is the first time we process a message to this
   // region, so split the path.
+  State = State->set<DynamicDispatchSplitCount>(Splits + 1);
   ProgramStateRef IState =
       State->set<DynamicDispatchBifurcationMap>(BifurReg,
                                                DynamicDispatchModeInlined);
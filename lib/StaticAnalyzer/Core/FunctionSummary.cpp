@@ -11,10 +11,29 @@
 //
 //===----------------------------------------------------------------------===//
 
+#define DEBUG_TYPE "FunctionSummary"
+
 #include "clang/StaticAnalyzer/Core/PathSensitive/FunctionSummary.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/DeclObjC.h"
+#include "clang/AST/Expr.h"
+#include "clang/AST/PrettyPrinter.h"
+#include "clang/AST/Stmt.h"
+#include "clang/AST/StmtOpenMP.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Support/raw_ostream.h"
 using namespace clang;
 using namespace ento;
 
+STATISTIC(NumPersistentVerdictsUsed,
+          "The # of inlining decisions reused from other translation units");
+STATISTIC(NumPersistentVerdictsRecorded,
+          "The # of inlining decisions recorded for other translation units");
+
+/// The first word of a persistent summary file. Bump the version whenever
+/// the way functions are identified changes.
+static const char PersistentSummariesMagic[] = "clang-analyzer-summaries-1";
+
 unsigned FunctionSummariesTy::getTotalNumBasicBlocks() {
   unsigned Total = 0;
   for (MapTy::iterator I = Map.begin(), E = Map.end(); I != E; ++I) {
@@ -30,3 +49,199 @@ unsigned FunctionSummariesTy::getTotalNumVisitedBasicBlocks() {
   }
   return Total;
 }
+
+/// Returns true if \p E is a local variable of the function, or a field or
+/// element of one, rather than memory that outlives the stack frame.
+static bool isLocalLValue(const Expr *E) {
+  while (true) {
+    E = E->IgnoreParenImpCasts();
+    if (const MemberExpr *ME = dyn_cast<MemberExpr>(E)) {
+      if (ME->isArrow())
+        return false;
+      E = ME->getBase();
+    } else if (const ArraySubscriptExpr *ASE =
+                   dyn_cast<ArraySubscriptExpr>(E)) {
+      // Only subscripts of arrays, not of pointers, which decay to a
+      // pointer that IgnoreParenImpCasts strips.
+      const Expr *Base = ASE->getBase()->IgnoreParenImpCasts();
+      if (!Base->getType()->isArrayType())
+        return false;
+      E = Base;
+    } else {
+      break;
+    }
+  }
+
+  const DeclRefExpr *DRE = dyn_cast<DeclRefExpr>(E);
+  if (!DRE)
+    return false;
+  const VarDecl *VD = dyn_cast<VarDecl>(DRE->getDecl());
+  return VD && VD->hasLocalStorage() && !VD->getType()->isReferenceType();
+}
+
+bool FunctionSummariesTy::stmtMayHaveSideEffects(const Stmt *S) {
+  if (!S)
+    return false;
+
+  switch (S->getStmtClass()) {
+  case Stmt::BinaryOperatorClass:
+  case Stmt::CompoundAssignOperatorClass: {
+    const BinaryOperator *BO = cast<BinaryOperator>(S);
+    if (BO->isAssignmentOp() && !isLocalLValue(BO->getLHS()))
+      return true;
+    break;
+  }
+  case Stmt::UnaryOperatorClass: {
+    const UnaryOperator *UO = cast<UnaryOperator>(S);
+    if (UO->isIncrementDecrementOp() && !isLocalLValue(UO->getSubExpr()))
+      return true;
+    break;
+  }
+  case Stmt::CallExprClass: {
+    const FunctionDecl *Callee = cast<CallExpr>(S)->getDirectCallee();
+    if (!Callee)
+      return true;
+    if (unsigned BuiltinID = Callee->getBuiltinID()) {
+      if (!Callee->getASTContext().BuiltinInfo.isConst(BuiltinID))
+        return true;
+    } else if (mayHaveSideEffects(Callee)) {
+      return true;
+    }
+    break;
+  }
+  case Stmt::DeclStmtClass: {
+    // Static locals are initialized once for all the calls.
+    const DeclStmt *DS = cast<DeclStmt>(S);
+    for (DeclStmt::const_decl_iterator I = DS->decl_begin(),
+                                       E = DS->decl_end(); I != E; ++I)
+      if (const VarDecl *VD = dyn_cast<VarDecl>(*I))
+        if (VD->isStaticLocal())
+          return true;
+    break;
+  }
+  case Stmt::AtomicExprClass:
+  case Stmt::GCCAsmStmtClass:
+  case Stmt::MSAsmStmtClass:
+  case Stmt::CapturedStmtClass:
+    return true;
+  default:
+    if (isa<OMPExecutableDirective>(S))
+      return true;
+    break;
+  }
+
+  for (Stmt::const_child_iterator I = S->child_begin(), E = S->child_end();
+       I != E; ++I)
+    if (stmtMayHaveSideEffects(*I))
+      return true;
+  return false;
+}
+
+bool FunctionSummariesTy::mayHaveSideEffects(const FunctionDecl *FD) {
+  const FunctionDecl *Def;
+  if (!FD->hasBody(Def))
+    return true;
+
+  MapTy::iterator I = findOrInsertSummary(Def);
+  if (I->second.SideEffectsChecked)
+    return I->second.MayHaveSideEffects;
+
+  // Assume the worst of the recursive calls while the body is walked.
+  I->second.SideEffectsChecked = 1;
+  I->second.MayHaveSideEffects = 1;
+
+  // Only C is handled: the implicit constructor and destructor calls of C++
+  // and the message sends of Objective-C don't show in the statements
+  // walked here.
+  const LangOptions &LangOpts = Def->getASTContext().getLangOpts();
+  if (LangOpts.CPlusPlus || LangOpts.ObjC1)
+    return true;
+
+  bool Result = stmtMayHaveSideEffects(Def->getBody());
+
+  // The walk may have added summaries and moved this one.
+  findOrInsertSummary(Def)->second.MayHaveSideEffects = Result;
+  return Result;
+}
+
+PersistentFunctionSummaries::PersistentFunctionSummaries(
+    StringRef Path, StringRef OptionsSignature)
+  : File(Path, PersistentSummariesMagic, OptionsSignature) {
+  // Each entry is "<function key> <verdict>".
+  PersistentAnalysisFile::EntryMap Entries;
+  File.read(Entries);
+  for (PersistentAnalysisFile::EntryMap::iterator I = Entries.begin(),
+                                                  E = Entries.end();
+       I != E; ++I) {
+    if (I->getValue().size() != 1)
+      continue;
+    char V = I->getValue()[0];
+    if (V == NotInlinable || V == ReachedMaxBlockCount)
+      Verdicts[I->getKey()] = V;
+  }
+}
+
+const std::string &PersistentFunctionSummaries::getKey(const Decl *D) {
+  std::pair<llvm::DenseMap<const Decl *, std::string>::iterator, bool> Known =
+      Keys.insert(std::make_pair(D, std::string()));
+  std::string &Key = Known.first->second;
+  if (!Known.second)
+    return Key;
+
+  // Blocks have no name to be found by in another translation unit.
+  const NamedDecl *ND = dyn_cast<NamedDecl>(D);
+  const Stmt *Body = D->getBody();
+  if (!ND || !Body)
+    return Key;
+
+  // Print the body rather than hashing its spelling, so that the key
+  // reflects the definition after preprocessing.
+  std::string Identity;
+  llvm::raw_string_ostream OS(Identity);
+  OS << ND->getQualifiedNameAsString() << '\0';
+  if (const ValueDecl *VD = dyn_cast<ValueDecl>(ND))
+    OS << VD->getType().getAsString() << '\0';
+  else if (const ObjCMethodDecl *MD = dyn_cast<ObjCMethodDecl>(ND))
+    OS << (MD->isInstanceMethod() ? '-' : '+')
+       << cast<ObjCContainerDecl>(MD->getDeclContext())->getName() << '\0';
+  Body->printPretty(OS, 0, PrintingPolicy(D->getASTContext().getLangOpts()));
+  OS.flush();
+
+  Key = getHexDigest(Identity);
+  return Key;
+}
+
+bool PersistentFunctionSummaries::shouldNotInline(const Decl *D) {
+  if (Verdicts.empty())
+    return false;
+  const std::string &Key = getKey(D);
+  if (Key.empty() || !Verdicts.count(Key))
+    return false;
+  ++NumPersistentVerdictsUsed;
+  return true;
+}
+
+void PersistentFunctionSummaries::recordVerdict(const Decl *D, Verdict V) {
+  const std::string &Key = getKey(D);
+  if (Key.empty())
+    return;
+  llvm::StringMap<char>::iterator Known = Verdicts.find(Key);
+  if (Known != Verdicts.end() && Known->getValue() == V)
+    return;
+  Verdicts[Key] = V;
+  NewVerdicts[Key] = V;
+  ++NumPersistentVerdictsRecorded;
+}
+
+void PersistentFunctionSummaries::save() {
+  if (NewVerdicts.empty())
+    return;
+
+  PersistentAnalysisFile::EntryMap Entries;
+  for (llvm::StringMap<char>::iterator I = NewVerdicts.begin(),
+                                       E = NewVerdicts.end();
+       I != E; ++I)
+    Entries[I->getKey()] = std::string(1, I->getValue());
+  if (File.merge(Entries))
+    NewVerdicts.clear();
+}
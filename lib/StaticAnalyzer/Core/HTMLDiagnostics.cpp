@@ -25,6 +25,7 @@
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/raw_ostream.h"
+#include <map>
 
 using namespace clang;
 using namespace ento;
@@ -39,6 +40,11 @@ class HTMLDiagnostics : public PathDiagnosticConsumer {
   std::string Directory;
   bool createdDir, noDir;
   const Preprocessor &PP;
+
+  /// The syntax and macro highlighting of each file reports were written
+  /// for, which is the same for all the reports of a file.
+  std::map<FileID, html::HighlightedRanges> HighlightedFiles;
+
 public:
   HTMLDiagnostics(const std::string& prefix, const Preprocessor &pp);
 
@@ -145,10 +151,17 @@ void HTMLDiagnostics::ReportDiag(const PathDiagnostic& D,
 
   // If we have a preprocessor, relex the file and syntax highlight.
   // We might not have a preprocessor if we come from a deserialized AST file,
-  // for example.
-
-  html::SyntaxHighlight(R, FID, PP);
-  html::HighlightMacros(R, FID, PP);
+  // for example. This is only done for the first report in each file.
+
+  std::map<FileID, html::HighlightedRanges>::iterator HI =
+      HighlightedFiles.find(FID);
+  if (HI == HighlightedFiles.end()) {
+    HI = HighlightedFiles.insert(
+        std::make_pair(FID, html::HighlightedRanges())).first;
+    html::SyntaxHighlight(HI->second, FID, PP);
+    html::HighlightMacros(HI->second, FID, PP);
+  }
+  html::ApplyHighlighting(R, FID, HI->second);
 
   // Get the full directory name of the analyzed file.
 
@@ -0,0 +1,93 @@
+//===--- PersistentAnalysisFile.cpp - Results shared by runs ----*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements PersistentAnalysisFile.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/StaticAnalyzer/Core/PersistentAnalysisFile.h"
+#include "llvm/ADT/OwningPtr.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+using namespace clang;
+using namespace ento;
+
+bool PersistentAnalysisFile::read(EntryMap &Into) const {
+  OwningPtr<llvm::MemoryBuffer> Buffer;
+  if (llvm::MemoryBuffer::getFile(Path, Buffer))
+    return false;
+
+  std::pair<StringRef, StringRef> Line = Buffer->getBuffer().split('\n');
+  std::pair<StringRef, StringRef> Header = Line.first.split(' ');
+  if (Header.first != Magic || Header.second != OptionsSignature)
+    return false;
+
+  while (!Line.second.empty()) {
+    Line = Line.second.split('\n');
+    std::pair<StringRef, StringRef> Entry = Line.first.split(' ');
+    if (!Entry.first.empty())
+      Into[Entry.first] = Entry.second;
+  }
+  return true;
+}
+
+bool PersistentAnalysisFile::merge(const EntryMap &NewEntries) const {
+  EntryMap Merged;
+  read(Merged);
+  for (EntryMap::const_iterator I = NewEntries.begin(), E = NewEntries.end();
+       I != E; ++I)
+    Merged[I->getKey()] = I->getValue();
+
+  // Write a temporary file next to the file and move it into place.
+  SmallString<128> TempPath;
+  int FD;
+  if (llvm::sys::fs::createUniqueFile(Path + "-%%%%%%%%", FD, TempPath))
+    return false;
+  {
+    llvm::raw_fd_ostream Out(FD, /*shouldClose=*/true);
+    Out << Magic << ' ' << OptionsSignature << '\n';
+    for (EntryMap::const_iterator I = Merged.begin(), E = Merged.end();
+         I != E; ++I) {
+      Out << I->getKey();
+      if (!I->getValue().empty())
+        Out << ' ' << I->getValue();
+      Out << '\n';
+    }
+    Out.close();
+    if (Out.has_error()) {
+      Out.clear_error();
+      bool Existed;
+      llvm::sys::fs::remove(TempPath.str(), Existed);
+      return false;
+    }
+  }
+  if (llvm::sys::fs::rename(TempPath.str(), Path)) {
+    bool Existed;
+    llvm::sys::fs::remove(TempPath.str(), Existed);
+    return false;
+  }
+  return true;
+}
+
+std::string ento::getHexDigest(StringRef Data) {
+  llvm::MD5 Hash;
+  Hash.update(Data);
+  return getHexDigest(Hash);
+}
+
+std::string ento::getHexDigest(llvm::MD5 &Hash) {
+  llvm::MD5::MD5Result Result;
+  Hash.final(Result);
+  SmallString<32> Hex;
+  llvm::MD5::stringifyResult(Result, Hex);
+  return Hex.str();
+}
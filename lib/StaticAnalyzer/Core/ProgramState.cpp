@@ -74,7 +74,8 @@ ProgramStateManager::ProgramStateManager(ASTContext &Ctx,
                                          SubEngine *SubEng)
   : Eng(SubEng), EnvMgr(alloc), GDMFactory(alloc),
     svalBuilder(createSimpleSValBuilder(alloc, Ctx, *this)),
-    CallEventMgr(new CallEventManager(alloc)), Alloc(alloc) {
+    CallEventMgr(new CallEventManager(alloc)), Alloc(alloc),
+    MaxNumStates(0) {
   StoreMgr.reset((*CreateSMgr)(*this));
   ConstraintMgr.reset((*CreateCMgr)(*this, SubEng));
 }
@@ -418,6 +419,8 @@ ProgramStateRef ProgramStateManager::getPersistentState(ProgramState &State) {
   }
   new (newState) ProgramState(State);
   StateSet.InsertNode(newState, InsertPos);
+  if (StateSet.size() > MaxNumStates)
+    MaxNumStates = StateSet.size();
   return newState;
 }
 
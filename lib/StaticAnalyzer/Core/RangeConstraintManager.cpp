@@ -16,10 +16,13 @@
 #include "clang/StaticAnalyzer/Core/PathSensitive/APSIntType.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/ProgramState.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/ProgramStateTrait.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/FoldingSet.h"
-#include "llvm/ADT/ImmutableSet.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/Allocator.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/raw_ostream.h"
+#include <memory>
 
 using namespace clang;
 using namespace ento;
@@ -54,60 +57,107 @@ public:
   }
 };
 
-
-class RangeTrait : public llvm::ImutContainerInfo<Range> {
-public:
-  // When comparing if one Range is less than another, we should compare
-  // the actual APSInt values instead of their pointers.  This keeps the order
-  // consistent (instead of comparing by pointer values) and can potentially
-  // be used to speed up some of the operations in RangeSet.
-  static inline bool isLess(key_type_ref lhs, key_type_ref rhs) {
-    return *lhs.first < *rhs.first || (!(*rhs.first < *lhs.first) &&
-                                       *lhs.second < *rhs.second);
-  }
-};
-
 /// RangeSet contains a set of ranges. If the set is empty, then
 ///  there the value of a symbol is overly constrained and there are no
 ///  possible values for that symbol.
+///
+/// The ranges are kept sorted in a flat array, which is uniqued by the
+/// RangeSet::Factory. RangeSets can thus be compared and profiled by pointer,
+/// which keeps the constraint map of each ProgramState cheap to unique.
 class RangeSet {
-  typedef llvm::ImmutableSet<Range, RangeTrait> PrimRangeSet;
-  PrimRangeSet ranges; // no need to make const, since it is an
-                       // ImmutableSet - this allows default operator=
-                       // to work.
+  /// The sorted, disjoint ranges of a set.
+  struct Storage : public llvm::FoldingSetNode {
+    const Range *Begin;
+    unsigned Size;
+
+    Storage(const Range *Begin, unsigned Size) : Begin(Begin), Size(Size) {}
+
+    static void Profile(llvm::FoldingSetNodeID &ID, ArrayRef<Range> Ranges) {
+      for (ArrayRef<Range>::iterator I = Ranges.begin(), E = Ranges.end();
+           I != E; ++I)
+        I->Profile(ID);
+    }
+
+    void Profile(llvm::FoldingSetNodeID &ID) const {
+      Profile(ID, ArrayRef<Range>(Begin, Size));
+    }
+  };
+
+  /// The uniqued ranges, or null for the empty set.
+  const Storage *Impl;
+
+  explicit RangeSet(const Storage *Impl) : Impl(Impl) {}
+
 public:
-  typedef PrimRangeSet::Factory Factory;
-  typedef PrimRangeSet::iterator iterator;
+  class Factory {
+    llvm::BumpPtrAllocator Alloc;
+    llvm::FoldingSet<Storage> Sets;
+
+    /// Memoized results of Intersect, keyed by the set and the (pinned)
+    /// bounds it was intersected with. The same assumptions are made over
+    /// and over along different paths.
+    typedef std::pair<const Storage *,
+                      std::pair<const llvm::APSInt *, const llvm::APSInt *> >
+        IntersectionKey;
+    llvm::DenseMap<IntersectionKey, const Storage *> Intersections;
+
+    friend class RangeSet;
+
+  public:
+    RangeSet getEmptySet() { return RangeSet(0); }
+
+    /// Returns the set of the given ranges, which must be sorted and
+    /// disjoint.
+    RangeSet getRangeSet(ArrayRef<Range> Ranges) {
+      if (Ranges.empty())
+        return getEmptySet();
+
+      llvm::FoldingSetNodeID ID;
+      Storage::Profile(ID, Ranges);
+      void *InsertPos;
+      if (Storage *S = Sets.FindNodeOrInsertPos(ID, InsertPos))
+        return RangeSet(S);
+
+      Range *Begin = Alloc.Allocate<Range>(Ranges.size());
+      std::uninitialized_copy(Ranges.begin(), Ranges.end(), Begin);
+      Storage *S =
+          new (Alloc.Allocate<Storage>()) Storage(Begin, Ranges.size());
+      Sets.InsertNode(S, InsertPos);
+      return RangeSet(S);
+    }
+  };
 
-  RangeSet(PrimRangeSet RS) : ranges(RS) {}
+  typedef const Range *iterator;
 
-  iterator begin() const { return ranges.begin(); }
-  iterator end() const { return ranges.end(); }
+  iterator begin() const { return Impl ? Impl->Begin : 0; }
+  iterator end() const { return Impl ? Impl->Begin + Impl->Size : 0; }
 
-  bool isEmpty() const { return ranges.isEmpty(); }
+  bool isEmpty() const { return !Impl; }
 
   /// Construct a new RangeSet representing '{ [from, to] }'.
   RangeSet(Factory &F, const llvm::APSInt &from, const llvm::APSInt &to)
-    : ranges(F.add(F.getEmptySet(), Range(from, to))) {}
+    : Impl(F.getRangeSet(Range(from, to)).Impl) {}
 
   /// Profile - Generates a hash profile of this RangeSet for use
   ///  by FoldingSet.
-  void Profile(llvm::FoldingSetNodeID &ID) const { ranges.Profile(ID); }
+  void Profile(llvm::FoldingSetNodeID &ID) const { ID.AddPointer(Impl); }
 
   /// getConcreteValue - If a symbol is contrained to equal a specific integer
   ///  constant then this method returns that value.  Otherwise, it returns
   ///  NULL.
   const llvm::APSInt* getConcreteValue() const {
-    return ranges.isSingleton() ? ranges.begin()->getConcreteValue() : 0;
+    return Impl && Impl->Size == 1 ? Impl->Begin->getConcreteValue() : 0;
   }
 
 private:
-  void IntersectInRange(BasicValueFactory &BV, Factory &F,
+  typedef SmallVector<Range, 4> RangeVector;
+
+  void IntersectInRange(BasicValueFactory &BV,
                         const llvm::APSInt &Lower,
                         const llvm::APSInt &Upper,
-                        PrimRangeSet &newRanges,
-                        PrimRangeSet::iterator &i,
-                        PrimRangeSet::iterator &e) const {
+                        RangeVector &newRanges,
+                        iterator &i,
+                        iterator &e) const {
     // There are six cases for each range R in the set:
     //   1. R is entirely before the intersection range.
     //   2. R is entirely after the intersection range.
@@ -126,24 +176,23 @@ private:
 
       if (i->Includes(Lower)) {
         if (i->Includes(Upper)) {
-          newRanges = F.add(newRanges, Range(BV.getValue(Lower),
-                                             BV.getValue(Upper)));
+          newRanges.push_back(Range(BV.getValue(Lower), BV.getValue(Upper)));
           break;
         } else
-          newRanges = F.add(newRanges, Range(BV.getValue(Lower), i->To()));
+          newRanges.push_back(Range(BV.getValue(Lower), i->To()));
       } else {
         if (i->Includes(Upper)) {
-          newRanges = F.add(newRanges, Range(i->From(), BV.getValue(Upper)));
+          newRanges.push_back(Range(i->From(), BV.getValue(Upper)));
           break;
         } else
-          newRanges = F.add(newRanges, *i);
+          newRanges.push_back(*i);
       }
     }
   }
 
   const llvm::APSInt &getMinValue() const {
     assert(!isEmpty());
-    return ranges.begin()->From();
+    return begin()->From();
   }
 
   bool pin(llvm::APSInt &Lower, llvm::APSInt &Upper) const {
@@ -240,20 +289,28 @@ public:
     if (!pin(Lower, Upper))
       return F.getEmptySet();
 
-    PrimRangeSet newRanges = F.getEmptySet();
+    Factory::IntersectionKey Key(Impl, std::make_pair(&BV.getValue(Lower),
+                                                      &BV.getValue(Upper)));
+    llvm::DenseMap<Factory::IntersectionKey, const Storage *>::iterator Known =
+        F.Intersections.find(Key);
+    if (Known != F.Intersections.end())
+      return RangeSet(Known->second);
 
-    PrimRangeSet::iterator i = begin(), e = end();
+    RangeVector newRanges;
+    iterator i = begin(), e = end();
     if (Lower <= Upper)
-      IntersectInRange(BV, F, Lower, Upper, newRanges, i, e);
+      IntersectInRange(BV, Lower, Upper, newRanges, i, e);
     else {
       // The order of the next two statements is important!
       // IntersectInRange() does not reset the iteration state for i and e.
       // Therefore, the lower range most be handled first.
-      IntersectInRange(BV, F, BV.getMinValue(Upper), Upper, newRanges, i, e);
-      IntersectInRange(BV, F, Lower, BV.getMaxValue(Lower), newRanges, i, e);
+      IntersectInRange(BV, BV.getMinValue(Upper), Upper, newRanges, i, e);
+      IntersectInRange(BV, Lower, BV.getMaxValue(Lower), newRanges, i, e);
     }
 
-    return newRanges;
+    RangeSet Result = F.getRangeSet(newRanges);
+    F.Intersections[Key] = Result.Impl;
+    return Result;
   }
 
   void print(raw_ostream &os) const {
@@ -272,7 +329,7 @@ public:
   }
 
   bool operator==(const RangeSet &other) const {
-    return ranges == other.ranges;
+    return Impl == other.Impl;
   }
 };
 } // end anonymous namespace
@@ -281,12 +338,59 @@ REGISTER_TRAIT_WITH_PROGRAMSTATE(ConstraintRange,
                                  CLANG_ENTO_PROGRAMSTATE_MAP(SymbolRef,
                                                              RangeSet))
 
+/// The relations that two integer symbols can still have, as a mask of the
+/// Rel* values below, keyed by "$a == $b" where $a is the one of the two at
+/// the lower address. The relations are those of $a to $b.
+REGISTER_MAP_WITH_PROGRAMSTATE(SymbolRelations, SymbolRef, unsigned)
+
+namespace {
+enum {
+  RelLT = 1,
+  RelEQ = 2,
+  RelGT = 4,
+  RelAny = RelLT | RelEQ | RelGT
+};
+}
+
+/// Returns the relations of $a to $b for which "$a Op $b" holds.
+static unsigned getRelationsForComparison(BinaryOperator::Opcode Op) {
+  switch (Op) {
+  default:
+    llvm_unreachable("not a comparison");
+  case BO_LT: return RelLT;
+  case BO_GT: return RelGT;
+  case BO_LE: return RelLT | RelEQ;
+  case BO_GE: return RelGT | RelEQ;
+  case BO_EQ: return RelEQ;
+  case BO_NE: return RelLT | RelGT;
+  }
+}
+
+/// Turns the relations of $a to $b into those of $b to $a.
+static unsigned reverseRelations(unsigned Rels) {
+  return (Rels & RelEQ) | (Rels & RelLT ? RelGT : 0) |
+         (Rels & RelGT ? RelLT : 0);
+}
+
 namespace {
 class RangeConstraintManager : public SimpleConstraintManager{
   RangeSet GetRange(ProgramStateRef state, SymbolRef sym);
+
+  /// Constrains \p Sym to \p New, which was derived from its range \p Old.
+  ProgramStateRef setRange(ProgramStateRef St, SymbolRef Sym, RangeSet Old,
+                           RangeSet New);
+
+  /// Whether the relations of integer symbols to each other are tracked.
+  bool TrackRelations;
+
+  /// Returns the relations of \p LHS to \p RHS that their ranges allow.
+  unsigned getRelationsFromRanges(ProgramStateRef St, SymbolRef LHS,
+                                  SymbolRef RHS);
 public:
-  RangeConstraintManager(SubEngine *subengine, SValBuilder &SVB)
-    : SimpleConstraintManager(subengine, SVB) {}
+  RangeConstraintManager(SubEngine *subengine, SValBuilder &SVB,
+                         bool TrackRelations)
+    : SimpleConstraintManager(subengine, SVB),
+      TrackRelations(TrackRelations) {}
 
   ProgramStateRef assumeSymNE(ProgramStateRef state, SymbolRef sym,
                              const llvm::APSInt& Int,
@@ -312,6 +416,9 @@ public:
                              const llvm::APSInt& Int,
                              const llvm::APSInt& Adjustment);
 
+  ProgramStateRef assumeSymSymRel(ProgramStateRef state, SymbolRef LHS,
+                                  BinaryOperator::Opcode op, SymbolRef RHS);
+
   const llvm::APSInt* getSymVal(ProgramStateRef St, SymbolRef sym) const;
   ConditionTruthVal checkNull(ProgramStateRef State, SymbolRef Sym);
 
@@ -328,7 +435,15 @@ private:
 
 ConstraintManager *
 ento::CreateRangeConstraintManager(ProgramStateManager &StMgr, SubEngine *Eng) {
-  return new RangeConstraintManager(Eng, StMgr.getSValBuilder());
+  return new RangeConstraintManager(Eng, StMgr.getSValBuilder(),
+                                    /*TrackRelations=*/false);
+}
+
+ConstraintManager *
+ento::CreateRelationalConstraintManager(ProgramStateManager &StMgr,
+                                        SubEngine *Eng) {
+  return new RangeConstraintManager(Eng, StMgr.getSValBuilder(),
+                                    /*TrackRelations=*/true);
 }
 
 const llvm::APSInt* RangeConstraintManager::getSymVal(ProgramStateRef St,
@@ -375,8 +490,18 @@ RangeConstraintManager::removeDeadBindings(ProgramStateRef state,
     if (SymReaper.maybeDead(sym))
       CR = CRFactory.remove(CR, sym);
   }
-
-  return state->set<ConstraintRange>(CR);
+  state = state->set<ConstraintRange>(CR);
+
+  // A relation is dead once either of its symbols is.
+  SymbolRelationsTy Rels = state->get<SymbolRelations>();
+  SymbolRelationsTy::Factory &RelsFactory =
+      state->get_context<SymbolRelations>();
+  for (SymbolRelationsTy::iterator I = Rels.begin(), E = Rels.end(); I != E;
+       ++I) {
+    if (SymReaper.maybeDead(I.getKey()))
+      Rels = RelsFactory.remove(Rels, I.getKey());
+  }
+  return state->set<SymbolRelations>(Rels);
 }
 
 RangeSet
@@ -401,6 +526,19 @@ RangeConstraintManager::GetRange(ProgramStateRef state, SymbolRef sym) {
   return Result;
 }
 
+ProgramStateRef RangeConstraintManager::setRange(ProgramStateRef St,
+                                                 SymbolRef Sym, RangeSet Old,
+                                                 RangeSet New) {
+  if (New.isEmpty())
+    return NULL;
+
+  // The assumption told us nothing new, so there's no need for a new state.
+  if (New == Old)
+    return St;
+
+  return St->set<ConstraintRange>(Sym, New);
+}
+
 //===------------------------------------------------------------------------===
 // assumeSymX methods: public interface for RangeConstraintManager.
 //===------------------------------------------------------------------------===/
@@ -429,8 +567,9 @@ RangeConstraintManager::assumeSymNE(ProgramStateRef St, SymbolRef Sym,
 
   // [Int-Adjustment+1, Int-Adjustment-1]
   // Notice that the lower bound is greater than the upper bound.
-  RangeSet New = GetRange(St, Sym).Intersect(getBasicVals(), F, Upper, Lower);
-  return New.isEmpty() ? NULL : St->set<ConstraintRange>(Sym, New);
+  RangeSet Old = GetRange(St, Sym);
+  RangeSet New = Old.Intersect(getBasicVals(), F, Upper, Lower);
+  return setRange(St, Sym, Old, New);
 }
 
 ProgramStateRef 
@@ -444,8 +583,9 @@ RangeConstraintManager::assumeSymEQ(ProgramStateRef St, SymbolRef Sym,
 
   // [Int-Adjustment, Int-Adjustment]
   llvm::APSInt AdjInt = AdjustmentType.convert(Int) - Adjustment;
-  RangeSet New = GetRange(St, Sym).Intersect(getBasicVals(), F, AdjInt, AdjInt);
-  return New.isEmpty() ? NULL : St->set<ConstraintRange>(Sym, New);
+  RangeSet Old = GetRange(St, Sym);
+  RangeSet New = Old.Intersect(getBasicVals(), F, AdjInt, AdjInt);
+  return setRange(St, Sym, Old, New);
 }
 
 ProgramStateRef 
@@ -473,8 +613,9 @@ RangeConstraintManager::assumeSymLT(ProgramStateRef St, SymbolRef Sym,
   llvm::APSInt Upper = ComparisonVal-Adjustment;
   --Upper;
 
-  RangeSet New = GetRange(St, Sym).Intersect(getBasicVals(), F, Lower, Upper);
-  return New.isEmpty() ? NULL : St->set<ConstraintRange>(Sym, New);
+  RangeSet Old = GetRange(St, Sym);
+  RangeSet New = Old.Intersect(getBasicVals(), F, Lower, Upper);
+  return setRange(St, Sym, Old, New);
 }
 
 ProgramStateRef 
@@ -502,8 +643,9 @@ RangeConstraintManager::assumeSymGT(ProgramStateRef St, SymbolRef Sym,
   llvm::APSInt Upper = Max-Adjustment;
   ++Lower;
 
-  RangeSet New = GetRange(St, Sym).Intersect(getBasicVals(), F, Lower, Upper);
-  return New.isEmpty() ? NULL : St->set<ConstraintRange>(Sym, New);
+  RangeSet Old = GetRange(St, Sym);
+  RangeSet New = Old.Intersect(getBasicVals(), F, Lower, Upper);
+  return setRange(St, Sym, Old, New);
 }
 
 ProgramStateRef 
@@ -531,8 +673,9 @@ RangeConstraintManager::assumeSymGE(ProgramStateRef St, SymbolRef Sym,
   llvm::APSInt Lower = ComparisonVal-Adjustment;
   llvm::APSInt Upper = Max-Adjustment;
 
-  RangeSet New = GetRange(St, Sym).Intersect(getBasicVals(), F, Lower, Upper);
-  return New.isEmpty() ? NULL : St->set<ConstraintRange>(Sym, New);
+  RangeSet Old = GetRange(St, Sym);
+  RangeSet New = Old.Intersect(getBasicVals(), F, Lower, Upper);
+  return setRange(St, Sym, Old, New);
 }
 
 ProgramStateRef 
@@ -560,8 +703,67 @@ RangeConstraintManager::assumeSymLE(ProgramStateRef St, SymbolRef Sym,
   llvm::APSInt Lower = Min-Adjustment;
   llvm::APSInt Upper = ComparisonVal-Adjustment;
 
-  RangeSet New = GetRange(St, Sym).Intersect(getBasicVals(), F, Lower, Upper);
-  return New.isEmpty() ? NULL : St->set<ConstraintRange>(Sym, New);
+  RangeSet Old = GetRange(St, Sym);
+  RangeSet New = Old.Intersect(getBasicVals(), F, Lower, Upper);
+  return setRange(St, Sym, Old, New);
+}
+
+unsigned RangeConstraintManager::getRelationsFromRanges(ProgramStateRef St,
+                                                        SymbolRef LHS,
+                                                        SymbolRef RHS) {
+  RangeSet L = GetRange(St, LHS), R = GetRange(St, RHS);
+  if (L.isEmpty() || R.isEmpty())
+    return RelAny;
+
+  const llvm::APSInt &LMin = L.begin()->From(), &LMax = (L.end() - 1)->To();
+  const llvm::APSInt &RMin = R.begin()->From(), &RMax = (R.end() - 1)->To();
+  unsigned Rels = 0;
+  if (LMin < RMax)
+    Rels |= RelLT;
+  if (LMin <= RMax && RMin <= LMax)
+    Rels |= RelEQ;
+  if (LMax > RMin)
+    Rels |= RelGT;
+  return Rels;
+}
+
+ProgramStateRef
+RangeConstraintManager::assumeSymSymRel(ProgramStateRef St, SymbolRef LHS,
+                                        BinaryOperator::Opcode Op,
+                                        SymbolRef RHS) {
+  if (!TrackRelations)
+    return St;
+
+  // Only symbols of the same integer type compare as their values do; the
+  // casts between the others may have been dropped.
+  QualType LTy = LHS->getType(), RTy = RHS->getType();
+  if (!LTy->isIntegralOrEnumerationType() ||
+      !RTy->isIntegralOrEnumerationType())
+    return St;
+  BasicValueFactory &BV = getBasicVals();
+  if (BV.getAPSIntType(LTy) != BV.getAPSIntType(RTy))
+    return St;
+
+  unsigned Rels = getRelationsForComparison(Op);
+  if (LHS == RHS)
+    return Rels & RelEQ ? St : NULL;
+  if (RHS < LHS) {
+    std::swap(LHS, RHS);
+    Rels = reverseRelations(Rels);
+  }
+
+  SymbolManager &SymMgr = getSymbolManager();
+  SymbolRef Key =
+      SymMgr.getSymSymExpr(LHS, BO_EQ, RHS, SymMgr.getContext().IntTy);
+  if (const unsigned *Known = St->get<SymbolRelations>(Key))
+    Rels &= *Known;
+  // The ranges may have narrowed since the relation was recorded.
+  Rels &= getRelationsFromRanges(St, LHS, RHS);
+  if (!Rels)
+    return NULL;
+  if (Rels == RelAny)
+    return St;
+  return St->set<SymbolRelations>(Key, Rels);
 }
 
 //===------------------------------------------------------------------------===
@@ -583,5 +785,22 @@ void RangeConstraintManager::print(ProgramStateRef St, raw_ostream &Out,
     Out << nl << ' ' << I.getKey() << " : ";
     I.getData().print(Out);
   }
+
+  SymbolRelationsTy Rels = St->get<SymbolRelations>();
+  if (!Rels.isEmpty()) {
+    Out << nl << sep << "Relations of symbols:";
+    for (SymbolRelationsTy::iterator I = Rels.begin(), E = Rels.end(); I != E;
+         ++I) {
+      const SymSymExpr *Rel = cast<SymSymExpr>(I.getKey());
+      Out << nl << ' ' << Rel->getLHS() << " is";
+      if (I.getData() & RelLT)
+        Out << " <";
+      if (I.getData() & RelEQ)
+        Out << " ==";
+      if (I.getData() & RelGT)
+        Out << " >";
+      Out << ' ' << Rel->getRHS();
+    }
+  }
   Out << nl;
 }
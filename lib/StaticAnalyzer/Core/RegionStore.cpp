@@ -28,6 +28,7 @@
 #include "llvm/ADT/ImmutableList.h"
 #include "llvm/ADT/ImmutableMap.h"
 #include "llvm/ADT/Optional.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/Support/raw_ostream.h"
 
 using namespace clang;
@@ -330,11 +331,34 @@ public:
   mutable ClusterBindings::Factory CBFactory;
 
   typedef std::vector<SVal> SValListTy;
+
+  /// The regions and symbols that the bindings of a cluster refer to,
+  /// including those within lazy bindings.
+  struct ClusterReferences {
+    /// Keeps the cluster's tree alive, so that it can't be freed and its
+    /// address reused for a different cluster while it is cached.
+    ClusterBindings Cluster;
+    SmallVector<const MemRegion *, 4> Regions;
+    SmallVector<SymbolRef, 4> Symbols;
+
+    ClusterReferences() : Cluster(0) {}
+  };
+
 private:
   typedef llvm::DenseMap<const LazyCompoundValData *,
                          SValListTy> LazyBindingsMapTy;
   LazyBindingsMapTy LazyBindingsMap;
 
+  /// References of the clusters seen by removeDeadBindings. Clusters are
+  /// immutable, so a cluster that is unchanged since the last sweep is found
+  /// here by the address of its tree.
+  typedef llvm::DenseMap<const ClusterBindings::TreeTy *, ClusterReferences>
+      ClusterReferencesMapTy;
+  ClusterReferencesMapTy ClusterReferencesMap;
+
+  void collectReferences(SVal V, ClusterReferences &Refs,
+                         llvm::SmallPtrSet<const void *, 16> &Seen);
+
   /// The largest number of fields a struct can have and still be
   /// considered "small".
   ///
@@ -467,6 +491,11 @@ public: // Part of public interface to class.
   /// \param L the location whose binding should be removed.
   virtual StoreRef killBinding(Store ST, Loc L);
 
+  /// \brief Bind the initial contents of the callee's stack frame, all on
+  /// the same bindings rather than through a new store for each parameter.
+  virtual StoreRef enterStackFrame(Store store, const CallEvent &Call,
+                                   const StackFrameContext *CalleeCtx);
+
   void incrementReferenceCount(Store store) {
     getRegionBindings(store).manualRetain();    
   }
@@ -551,6 +580,10 @@ public: // Part of public interface to class.
   /// symbols, but may omit constants and other kinds of SVal.
   const SValListTy &getInterestingValues(nonloc::LazyCompoundVal LCV);
 
+  /// Returns the cached regions and symbols referred to by the bindings in
+  /// \p Cluster, which removeDeadBindings treats as live if the cluster is.
+  const ClusterReferences &getClusterReferences(const ClusterBindings &Cluster);
+
   //===------------------------------------------------------------------===//
   // State pruning.
   //===------------------------------------------------------------------===//
@@ -1803,6 +1836,7 @@ RegionStoreManager::getInterestingValues(nonloc::LazyCompoundVal LCV) {
   SmallVector<BindingPair, 32> Bindings;
   collectSubRegionBindings(Bindings, svalBuilder, *Cluster, LazyR,
                            /*IncludeAllDefaultBindings=*/true);
+  llvm::SmallPtrSet<const LazyCompoundValData *, 4> InnerLCVs;
   for (SmallVectorImpl<BindingPair>::const_iterator I = Bindings.begin(),
                                                     E = Bindings.end();
        I != E; ++I) {
@@ -1812,6 +1846,10 @@ RegionStoreManager::getInterestingValues(nonloc::LazyCompoundVal LCV) {
 
     if (Optional<nonloc::LazyCompoundVal> InnerLCV =
             V.getAs<nonloc::LazyCompoundVal>()) {
+      // Several fields may be bound to the same lazy binding. Its values only
+      // need to be listed once, which keeps chains of copies from growing.
+      if (!InnerLCVs.insert(InnerLCV->getCVData()))
+        continue;
       const SValListTy &InnerList = getInterestingValues(*InnerLCV);
       List.insert(List.end(), InnerList.begin(), InnerList.end());
       continue;
@@ -1823,6 +1861,61 @@ RegionStoreManager::getInterestingValues(nonloc::LazyCompoundVal LCV) {
   return (LazyBindingsMap[LCV.getCVData()] = llvm_move(List));
 }
 
+void RegionStoreManager::collectReferences(
+    SVal V, ClusterReferences &Refs,
+    llvm::SmallPtrSet<const void *, 16> &Seen) {
+  if (Optional<nonloc::LazyCompoundVal> LCV =
+          V.getAs<nonloc::LazyCompoundVal>()) {
+    // Copies of a struct often share the same lazy binding.
+    if (!Seen.insert(LCV->getCVData()))
+      return;
+    const SValListTy &Vals = getInterestingValues(*LCV);
+    for (SValListTy::const_iterator I = Vals.begin(), E = Vals.end(); I != E;
+         ++I)
+      collectReferences(*I, Refs, Seen);
+    return;
+  }
+
+  if (const MemRegion *R = V.getAsRegion()) {
+    if (Seen.insert(R))
+      Refs.Regions.push_back(R);
+
+    // All regions captured by a block are also live.
+    if (const BlockDataRegion *BR = dyn_cast<BlockDataRegion>(R)) {
+      BlockDataRegion::referenced_vars_iterator I = BR->referenced_vars_begin(),
+                                                E = BR->referenced_vars_end();
+      for ( ; I != E; ++I)
+        if (Seen.insert(I.getCapturedRegion()))
+          Refs.Regions.push_back(I.getCapturedRegion());
+    }
+  }
+
+  for (SymExpr::symbol_iterator SI = V.symbol_begin(), SE = V.symbol_end();
+       SI != SE; ++SI)
+    if (Seen.insert(*SI))
+      Refs.Symbols.push_back(*SI);
+}
+
+const RegionStoreManager::ClusterReferences &
+RegionStoreManager::getClusterReferences(const ClusterBindings &Cluster) {
+  const ClusterBindings::TreeTy *Root = Cluster.getRootWithoutRetain();
+  ClusterReferencesMapTy::iterator I = ClusterReferencesMap.find(Root);
+  if (I != ClusterReferencesMap.end())
+    return I->second;
+
+  // The cache keeps the clusters alive, so don't let it grow without bound.
+  if (ClusterReferencesMap.size() >= 4096)
+    ClusterReferencesMap.clear();
+
+  ClusterReferences &Refs = ClusterReferencesMap[Root];
+  Refs.Cluster = Cluster;
+  llvm::SmallPtrSet<const void *, 16> Seen;
+  for (ClusterBindings::iterator CI = Cluster.begin(), CE = Cluster.end();
+       CI != CE; ++CI)
+    collectReferences(CI.getData(), Refs, Seen);
+  return Refs;
+}
+
 NonLoc RegionStoreManager::createLazyBinding(RegionBindingsConstRef B,
                                              const TypedValueRegion *R) {
   if (Optional<nonloc::LazyCompoundVal> V =
@@ -1888,6 +1981,21 @@ StoreRef RegionStoreManager::killBinding(Store ST, Loc L) {
   return StoreRef(ST, *this);
 }
 
+StoreRef RegionStoreManager::enterStackFrame(Store store,
+                                             const CallEvent &Call,
+                                             const StackFrameContext *LCtx) {
+  SmallVector<CallEvent::FrameBindingTy, 16> InitialBindings;
+  Call.getInitialStackFrameContents(LCtx, InitialBindings);
+
+  RegionBindingsRef B = getRegionBindings(store);
+  for (CallEvent::BindingsTy::iterator I = InitialBindings.begin(),
+                                       E = InitialBindings.end();
+       I != E; ++I)
+    B = bind(B, I->first, I->second);
+
+  return StoreRef(B.asStore(), *this);
+}
+
 RegionBindingsRef
 RegionStoreManager::bind(RegionBindingsConstRef B, Loc L, SVal V) {
   if (L.getAs<loc::ConcreteInt>())
@@ -2195,7 +2303,6 @@ public:
   using ClusterAnalysis<removeDeadBindingsWorker>::VisitCluster;
 
   bool UpdatePostponed();
-  void VisitBinding(SVal V);
 };
 }
 
@@ -2244,43 +2351,14 @@ void removeDeadBindingsWorker::VisitCluster(const MemRegion *baseR,
   if (const SymbolicRegion *SymR = dyn_cast<SymbolicRegion>(baseR))
     SymReaper.markLive(SymR->getSymbol());
 
-  for (ClusterBindings::iterator I = C->begin(), E = C->end(); I != E; ++I)
-    VisitBinding(I.getData());
-}
-
-void removeDeadBindingsWorker::VisitBinding(SVal V) {
-  // Is it a LazyCompoundVal?  All referenced regions are live as well.
-  if (Optional<nonloc::LazyCompoundVal> LCS =
-          V.getAs<nonloc::LazyCompoundVal>()) {
-
-    const RegionStoreManager::SValListTy &Vals = RM.getInterestingValues(*LCS);
-
-    for (RegionStoreManager::SValListTy::const_iterator I = Vals.begin(),
-                                                        E = Vals.end();
-         I != E; ++I)
-      VisitBinding(*I);
-
-    return;
-  }
-
-  // If V is a region, then add it to the worklist.
-  if (const MemRegion *R = V.getAsRegion()) {
-    AddToWorkList(R);
-    
-    // All regions captured by a block are also live.
-    if (const BlockDataRegion *BR = dyn_cast<BlockDataRegion>(R)) {
-      BlockDataRegion::referenced_vars_iterator I = BR->referenced_vars_begin(),
-                                                E = BR->referenced_vars_end();
-      for ( ; I != E; ++I)
-        AddToWorkList(I.getCapturedRegion());
-    }
-  }
-    
-
-  // Update the set of live symbols.
-  for (SymExpr::symbol_iterator SI = V.symbol_begin(), SE = V.symbol_end();
-       SI!=SE; ++SI)
-    SymReaper.markLive(*SI);
+  // Most clusters are unchanged since the last sweep, so use the cached list
+  // of what they refer to instead of walking their bindings again.
+  const RegionStoreManager::ClusterReferences &Refs =
+      RM.getClusterReferences(*C);
+  for (unsigned I = 0, E = Refs.Regions.size(); I != E; ++I)
+    AddToWorkList(Refs.Regions[I]);
+  for (unsigned I = 0, E = Refs.Symbols.size(); I != E; ++I)
+    SymReaper.markLive(Refs.Symbols[I]);
 }
 
 bool removeDeadBindingsWorker::UpdatePostponed() {
@@ -146,6 +146,21 @@ ProgramStateRef SimpleConstraintManager::assumeAux(ProgramStateRef state,
                                                   NonLoc Cond,
                                                   bool Assumption) {
 
+  // Comparisons of integer symbols constrain neither of them on its own, but
+  // a subclass may track how they relate.
+  if (const SymSymExpr *SSE =
+          dyn_cast_or_null<SymSymExpr>(Cond.getAsSymExpr())) {
+    BinaryOperator::Opcode Op = SSE->getOpcode();
+    if (BinaryOperator::isComparisonOp(Op) &&
+        !Loc::isLocType(SSE->getLHS()->getType())) {
+      if (!Assumption)
+        Op = BinaryOperator::negateComparisonOp(Op);
+      state = assumeSymSymRel(state, SSE->getLHS(), Op, SSE->getRHS());
+      if (!state)
+        return NULL;
+    }
+  }
+
   // We cannot reason about SymSymExprs, and can only reason about some
   // SymIntExprs.
   if (!canReasonAbout(Cond)) {
@@ -77,6 +77,15 @@ protected:
                                      const llvm::APSInt& V,
                                      const llvm::APSInt& Adjustment) = 0;
 
+  /// Assumes "$lhs <> $rhs" of two integer symbols, which can't be folded
+  /// into the range of either. By default nothing is known about it.
+  virtual ProgramStateRef assumeSymSymRel(ProgramStateRef state,
+                                          SymbolRef LHS,
+                                          BinaryOperator::Opcode op,
+                                          SymbolRef RHS) {
+    return state;
+  }
+
   //===------------------------------------------------------------------===//
   // Internal implementation.
   //===------------------------------------------------------------------===//
@@ -14,6 +14,7 @@
 #define DEBUG_TYPE "AnalysisConsumer"
 
 #include "AnalysisConsumer.h"
+#include "FunctionFingerprints.h"
 #include "clang/AST/ASTConsumer.h"
 #include "clang/AST/Decl.h"
 #include "clang/AST/DeclCXX.h"
@@ -25,6 +26,7 @@
 #include "clang/Analysis/CallGraph.h"
 #include "clang/Basic/FileManager.h"
 #include "clang/Basic/SourceManager.h"
+#include "clang/Basic/Version.h"
 #include "clang/Lex/Preprocessor.h"
 #include "clang/StaticAnalyzer/Checkers/LocalCheckers.h"
 #include "clang/StaticAnalyzer/Core/AnalyzerOptions.h"
@@ -34,6 +36,7 @@
 #include "clang/StaticAnalyzer/Core/PathDiagnosticConsumers.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/AnalysisManager.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/ExprEngine.h"
+#include "clang/StaticAnalyzer/Core/PersistentAnalysisFile.h"
 #include "clang/StaticAnalyzer/Frontend/CheckerRegistration.h"
 #include "llvm/ADT/DepthFirstIterator.h"
 #include "llvm/ADT/OwningPtr.h"
@@ -41,10 +44,12 @@
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/Program.h"
 #include "llvm/Support/Timer.h"
 #include "llvm/Support/raw_ostream.h"
+#include <algorithm>
 #include <queue>
 
 using namespace clang;
@@ -116,6 +121,49 @@ public:
 };
 } // end anonymous namespace
 
+/// \brief Computes a signature of the options that affect inlining
+/// decisions, so that decisions are only shared between compatible runs.
+static std::string getInliningOptionsSignature(const AnalyzerOptions &Opts) {
+  // The config table only holds the options that were given explicitly or
+  // queried already, so include the compiler version for the defaults.
+  std::vector<std::pair<std::string, std::string> > Config;
+  for (AnalyzerOptions::ConfigTable::const_iterator I = Opts.Config.begin(),
+                                                   E = Opts.Config.end();
+       I != E; ++I) {
+    // Shards of one analysis share their decisions.
+    if (I->getKey() == "shard-count" || I->getKey() == "shard-index")
+      continue;
+    Config.push_back(std::make_pair(I->getKey().str(), I->getValue()));
+  }
+  std::sort(Config.begin(), Config.end());
+
+  std::string Signature;
+  llvm::raw_string_ostream OS(Signature);
+  OS << getClangFullVersion() << '\0' << Opts.maxBlockVisitOnPath << '\0'
+     << Opts.InlineMaxStackDepth << '\0' << Opts.InliningMode << '\0';
+  for (unsigned I = 0, E = Config.size(); I != E; ++I)
+    OS << Config[I].first << '=' << Config[I].second << '\0';
+  return getHexDigest(OS.str());
+}
+
+/// \brief Computes a signature of all the options that affect what the
+/// analysis of a function reports, so that incremental runs only trust the
+/// results of compatible runs.
+static std::string getAnalysisOptionsSignature(AnalyzerOptions &Opts) {
+  std::string Signature;
+  llvm::raw_string_ostream OS(Signature);
+  OS << getInliningOptionsSignature(Opts) << '\0';
+  for (unsigned I = 0, E = Opts.CheckersControlList.size(); I != E; ++I)
+    OS << (Opts.CheckersControlList[I].second ? '+' : '-')
+       << Opts.CheckersControlList[I].first << '\0';
+  OS << Opts.AnalysisStoreOpt << '\0' << Opts.AnalysisConstraintsOpt << '\0'
+     << Opts.AnalyzeAll << Opts.AnalyzeNestedBlocks
+     << Opts.eagerlyAssumeBinOpBifurcation << '\0'
+     << Opts.AnalyzeSpecificFunction << '\0'
+     << Opts.getAnalysisShardCount() << '\0' << Opts.getAnalysisShardIndex();
+  return getHexDigest(OS.str());
+}
+
 //===----------------------------------------------------------------------===//
 // AnalysisConsumer declaration.
 //===----------------------------------------------------------------------===//
@@ -135,6 +183,9 @@ class AnalysisConsumer : public ASTConsumer,
   AnalysisMode RecVisitorMode;
   /// Bug Reporter to use while recursively visiting Decls.
   BugReporter *RecVisitorBR;
+  /// The number of functions considered for path-sensitive analysis so far,
+  /// used to assign each of them to an analysis shard.
+  unsigned NumShardCandidates;
 
 public:
   ASTContext *Ctx;
@@ -166,11 +217,19 @@ public:
   /// translation unit.
   FunctionSummariesTy FunctionSummaries;
 
+  /// The inlining decisions shared with other translation units, if
+  /// requested with -analyzer-summary-cache.
+  OwningPtr<PersistentFunctionSummaries> PersistentSummaries;
+
+  /// The functions known to report nothing while unchanged, if requested
+  /// with -analyzer-incremental-db.
+  OwningPtr<FunctionFingerprints> Fingerprints;
+
   AnalysisConsumer(const Preprocessor& pp,
                    const std::string& outdir,
                    AnalyzerOptionsRef opts,
                    ArrayRef<std::string> plugins)
-    : RecVisitorMode(0), RecVisitorBR(0),
+    : RecVisitorMode(0), RecVisitorBR(0), NumShardCandidates(0),
       Ctx(0), PP(pp), OutDir(outdir), Opts(opts), Plugins(plugins) {
     DigestAnalyzerOptions();
     if (Opts->PrintStats) {
@@ -263,8 +322,46 @@ public:
     }
   }
 
+  /// \brief Print what the path-sensitive analysis of \p D cost: the time
+  /// spent exploring it and generating its reports, the nodes created, the
+  /// largest number of live states, and whether it ran out of steps.
+  void DisplayCosts(const Decl *D, ExprEngine &Eng, double ExploreTime,
+                    double ReportTime, bool Exhausted) {
+    if (!Opts->AnalyzerDisplayCosts)
+      return;
+
+    SourceManager &SM = Mgr->getASTContext().getSourceManager();
+    PresumedLoc Loc = SM.getPresumedLoc(D->getLocation());
+    if (Loc.isInvalid())
+      return;
+
+    llvm::errs() << "COSTS: " << Loc.getFilename() << ' ';
+    if (const NamedDecl *ND = dyn_cast<NamedDecl>(D))
+      llvm::errs() << *ND;
+    else
+      llvm::errs() << "block(line:" << Loc.getLine() << ",col:"
+                   << Loc.getColumn() << ')';
+
+    const ExplodedGraph &G = Eng.getGraph();
+    llvm::errs() << ": explore-ms=" << llvm::format("%.3f", ExploreTime * 1000)
+                 << " report-ms=" << llvm::format("%.3f", ReportTime * 1000)
+                 << " nodes=" << G.size() + G.getNumReclaimedNodes()
+                 << " max-states="
+                 << Eng.getStateManager().getMaxNumStates()
+                 << " exhausted=" << (Exhausted ? "yes" : "no") << '\n';
+  }
+
   virtual void Initialize(ASTContext &Context) {
     Ctx = &Context;
+    if (!Opts->SummaryCacheFile.empty()) {
+      PersistentSummaries.reset(new PersistentFunctionSummaries(
+          Opts->SummaryCacheFile, getInliningOptionsSignature(*Opts)));
+      FunctionSummaries.setPersistentSummaries(PersistentSummaries.get());
+    }
+    if (!Opts->IncrementalDatabaseFile.empty())
+      Fingerprints.reset(new FunctionFingerprints(
+          Opts->IncrementalDatabaseFile, getAnalysisOptionsSignature(*Opts),
+          Context, Opts->InlineMaxStackDepth));
     checkerMgr.reset(createCheckerManager(*Opts, PP.getLangOpts(), Plugins,
                                           PP.getDiagnostics()));
     Mgr.reset(new AnalysisManager(*Ctx,
@@ -304,10 +401,11 @@ public:
                   ExprEngine::InliningModes IMode = ExprEngine::Inline_Minimal,
                   SetOfConstDecls *VisitedCallees = 0);
 
-  void RunPathSensitiveChecks(Decl *D,
+  /// \returns true if any bug was reported.
+  bool RunPathSensitiveChecks(Decl *D,
                               ExprEngine::InliningModes IMode,
                               SetOfConstDecls *VisitedCallees);
-  void ActionExprEngine(Decl *D, bool ObjCGCEnabled,
+  bool ActionExprEngine(Decl *D, bool ObjCGCEnabled,
                         ExprEngine::InliningModes IMode,
                         SetOfConstDecls *VisitedCallees);
 
@@ -332,7 +430,7 @@ public:
     if (FD->isThisDeclarationADefinition() &&
         !FD->isDependentContext()) {
       assert(RecVisitorMode == AM_Syntax || Mgr->shouldInlineCall() == false);
-      HandleCode(FD, RecVisitorMode);
+      HandleCode(FD, getShardedVisitorMode());
     }
     return true;
   }
@@ -340,7 +438,7 @@ public:
   bool VisitObjCMethodDecl(ObjCMethodDecl *MD) {
     if (MD->isThisDeclarationADefinition()) {
       assert(RecVisitorMode == AM_Syntax || Mgr->shouldInlineCall() == false);
-      HandleCode(MD, RecVisitorMode);
+      HandleCode(MD, getShardedVisitorMode());
     }
     return true;
   }
@@ -348,7 +446,7 @@ public:
   bool VisitBlockDecl(BlockDecl *BD) {
     if (BD->hasBody()) {
       assert(RecVisitorMode == AM_Syntax || Mgr->shouldInlineCall() == false);
-      HandleCode(BD, RecVisitorMode);
+      HandleCode(BD, getShardedVisitorMode());
     }
     return true;
   }
@@ -356,6 +454,23 @@ public:
 private:
   void storeTopLevelDecls(DeclGroupRef DG);
 
+  /// \brief Check if the next function considered for path-sensitive
+  /// analysis belongs to the shard this run is analyzing.
+  bool isNextCandidateInShard() {
+    unsigned Index = NumShardCandidates++;
+    return Index % Opts->getAnalysisShardCount() ==
+           Opts->getAnalysisShardIndex();
+  }
+
+  /// \brief Returns RecVisitorMode, without path-sensitive analysis if the
+  /// function being visited belongs to another shard.
+  AnalysisMode getShardedVisitorMode() {
+    AnalysisMode Mode = RecVisitorMode;
+    if ((Mode & AM_Path) && !isNextCandidateInShard())
+      Mode &= ~AM_Path;
+    return Mode;
+  }
+
   /// \brief Check if we should skip (not analyze) the given function.
   AnalysisMode getModeForDecl(Decl *D, AnalysisMode Mode);
 
@@ -456,6 +571,13 @@ void AnalysisConsumer::HandleDeclsCallGraph(const unsigned LocalTUDeclsSize) {
     if (!D)
       continue;
 
+    // Leave the function to the shard that owns it. Ownership is decided by
+    // the position in the traversal, which is the same in every shard.
+    // Functions inlined into the roots of other shards are not known to be
+    // covered here, so they may still be analyzed by their own shard.
+    if (!isNextCandidateInShard())
+      continue;
+
     // Skip the functions which have been processed already or previously
     // inlined.
     if (shouldSkipFunction(D, Visited, VisitedAsTopLevel))
@@ -488,12 +610,17 @@ void AnalysisConsumer::HandleTranslationUnit(ASTContext &C) {
     // Introduce a scope to destroy BR before Mgr.
     BugReporter BR(*Mgr);
     TranslationUnitDecl *TU = C.getTranslationUnitDecl();
-    checkerMgr->runCheckersOnASTDecl(TU, *Mgr, BR);
+
+    // When the analysis is split into shards, the AST-only checks are run by
+    // the first shard alone so that their warnings are reported once.
+    bool RunSyntaxChecks = Opts->getAnalysisShardIndex() == 0;
+    if (RunSyntaxChecks)
+      checkerMgr->runCheckersOnASTDecl(TU, *Mgr, BR);
 
     // Run the AST-only checks using the order in which functions are defined.
     // If inlining is not turned on, use the simplest function order for path
     // sensitive analyzes as well.
-    RecVisitorMode = AM_Syntax;
+    RecVisitorMode = RunSyntaxChecks ? AM_Syntax : AM_None;
     if (!Mgr->shouldInlineCall())
       RecVisitorMode |= AM_Path;
     RecVisitorBR = &BR;
@@ -505,15 +632,18 @@ void AnalysisConsumer::HandleTranslationUnit(ASTContext &C) {
     // random access.  By doing so, we automatically compensate for iterators
     // possibly being invalidated, although this is a bit slower.
     const unsigned LocalTUDeclsSize = LocalTUDecls.size();
-    for (unsigned i = 0 ; i < LocalTUDeclsSize ; ++i) {
-      TraverseDecl(LocalTUDecls[i]);
+    if (RecVisitorMode != AM_None) {
+      for (unsigned i = 0 ; i < LocalTUDeclsSize ; ++i) {
+        TraverseDecl(LocalTUDecls[i]);
+      }
     }
 
     if (Mgr->shouldInlineCall())
       HandleDeclsCallGraph(LocalTUDeclsSize);
 
     // After all decls handled, run checkers on the entire TranslationUnit.
-    checkerMgr->runCheckersOnEndOfTranslationUnit(TU, *Mgr, BR);
+    if (RunSyntaxChecks)
+      checkerMgr->runCheckersOnEndOfTranslationUnit(TU, *Mgr, BR);
 
     RecVisitorBR = 0;
   }
@@ -524,6 +654,11 @@ void AnalysisConsumer::HandleTranslationUnit(ASTContext &C) {
   // used with option -disable-free.
   Mgr.reset(NULL);
 
+  if (PersistentSummaries)
+    PersistentSummaries->save();
+  if (Fingerprints)
+    Fingerprints->save();
+
   if (TUTotalTimer) TUTotalTimer->stopTimer();
 
   // Count how many basic blocks we have not covered.
@@ -578,6 +713,10 @@ void AnalysisConsumer::HandleCode(Decl *D, AnalysisMode Mode,
   if (Mode == AM_None)
     return;
 
+  // An unchanged function would report nothing again.
+  if (Fingerprints && Fingerprints->isUnchangedAndClean(D))
+    return;
+
   DisplayFunction(D, Mode, IMode);
   CFG *DeclCFG = Mgr->getCFG(D);
   if (DeclCFG) {
@@ -589,30 +728,37 @@ void AnalysisConsumer::HandleCode(Decl *D, AnalysisMode Mode,
   Mgr->ClearContexts();
   BugReporter BR(*Mgr);
 
-  if (Mode & AM_Syntax)
+  bool Reported = false;
+  if (Mode & AM_Syntax) {
     checkerMgr->runCheckersOnASTBody(D, *Mgr, BR);
+    Reported = BR.EQClasses_begin() != BR.EQClasses_end();
+  }
   if ((Mode & AM_Path) && checkerMgr->hasPathSensitiveCheckers()) {
-    RunPathSensitiveChecks(D, IMode, VisitedCallees);
+    if (RunPathSensitiveChecks(D, IMode, VisitedCallees))
+      Reported = true;
     if (IMode != ExprEngine::Inline_Minimal)
       NumFunctionsAnalyzed++;
   }
+
+  if (Fingerprints)
+    Fingerprints->recordAnalysis(D, Reported);
 }
 
 //===----------------------------------------------------------------------===//
 // Path-sensitive checking.
 //===----------------------------------------------------------------------===//
 
-void AnalysisConsumer::ActionExprEngine(Decl *D, bool ObjCGCEnabled,
+bool AnalysisConsumer::ActionExprEngine(Decl *D, bool ObjCGCEnabled,
                                         ExprEngine::InliningModes IMode,
                                         SetOfConstDecls *VisitedCallees) {
   // Construct the analysis engine.  First check if the CFG is valid.
   // FIXME: Inter-procedural analysis will need to handle invalid CFGs.
   if (!Mgr->getCFG(D))
-    return;
+    return false;
 
   // See if the LiveVariables analysis scales.
   if (!Mgr->getAnalysisDeclContext(D)->getAnalysis<RelaxedLiveVariables>())
-    return;
+    return false;
 
   ExprEngine Eng(*Mgr, ObjCGCEnabled, VisitedCallees, &FunctionSummaries,IMode);
 
@@ -623,9 +769,19 @@ void AnalysisConsumer::ActionExprEngine(Decl *D, bool ObjCGCEnabled,
     ExplodedNode::SetAuditor(Auditor.get());
   }
 
+  double StartTime = 0;
+  if (Opts->AnalyzerDisplayCosts)
+    StartTime = llvm::TimeRecord::getCurrentTime(/*Start=*/true).getWallTime();
+
   // Execute the worklist algorithm.
-  Eng.ExecuteWorkList(Mgr->getAnalysisDeclContextManager().getStackFrame(D),
-                      Mgr->options.getMaxNodesPerTopLevelFunction());
+  bool Exhausted =
+    Eng.ExecuteWorkList(Mgr->getAnalysisDeclContextManager().getStackFrame(D),
+                        Mgr->options.getMaxNodesPerTopLevelFunction());
+
+  double ExploreEndTime = 0;
+  if (Opts->AnalyzerDisplayCosts)
+    ExploreEndTime =
+      llvm::TimeRecord::getCurrentTime(/*Start=*/false).getWallTime();
 
   // Release the auditor (if any) so that it doesn't monitor the graph
   // created BugReporter.
@@ -636,27 +792,37 @@ void AnalysisConsumer::ActionExprEngine(Decl *D, bool ObjCGCEnabled,
     Eng.ViewGraph(Mgr->options.TrimGraph);
 
   // Display warnings.
-  Eng.getBugReporter().FlushReports();
+  BugReporter &BR = Eng.getBugReporter();
+  BR.FlushReports();
+
+  if (Opts->AnalyzerDisplayCosts) {
+    double EndTime =
+      llvm::TimeRecord::getCurrentTime(/*Start=*/false).getWallTime();
+    DisplayCosts(D, Eng, ExploreEndTime - StartTime, EndTime - ExploreEndTime,
+                 Exhausted);
+  }
+  return BR.EQClasses_begin() != BR.EQClasses_end();
 }
 
-void AnalysisConsumer::RunPathSensitiveChecks(Decl *D,
+bool AnalysisConsumer::RunPathSensitiveChecks(Decl *D,
                                               ExprEngine::InliningModes IMode,
                                               SetOfConstDecls *Visited) {
 
   switch (Mgr->getLangOpts().getGC()) {
   case LangOptions::NonGC:
-    ActionExprEngine(D, false, IMode, Visited);
-    break;
+    return ActionExprEngine(D, false, IMode, Visited);
   
   case LangOptions::GCOnly:
-    ActionExprEngine(D, true, IMode, Visited);
-    break;
+    return ActionExprEngine(D, true, IMode, Visited);
   
-  case LangOptions::HybridGC:
-    ActionExprEngine(D, false, IMode, Visited);
-    ActionExprEngine(D, true, IMode, Visited);
-    break;
+  case LangOptions::HybridGC: {
+    bool Reported = ActionExprEngine(D, false, IMode, Visited);
+    if (ActionExprEngine(D, true, IMode, Visited))
+      Reported = true;
+    return Reported;
+  }
   }
+  llvm_unreachable("Unknown GC mode");
 }
 
 //===----------------------------------------------------------------------===//
@@ -16,7 +16,8 @@ clang_static_analyzer_frontend_TBLGEN_TABLES := \
 clang_static_analyzer_frontend_SRC_FILES := \
   AnalysisConsumer.cpp \
   CheckerRegistration.cpp \
-  FrontendActions.cpp
+  FrontendActions.cpp \
+  FunctionFingerprints.cpp
 
 # For the host only
 # =====================================================
@@ -0,0 +1,289 @@
+//===--- FunctionFingerprints.cpp - Skip unchanged functions ----*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements FunctionFingerprints, which remembers across analyzer
+// runs the functions whose analysis reported nothing.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "FunctionFingerprints"
+
+#include "FunctionFingerprints.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/DeclCXX.h"
+#include "clang/AST/DeclObjC.h"
+#include "clang/AST/DeclTemplate.h"
+#include "clang/AST/ExprCXX.h"
+#include "clang/AST/ExprObjC.h"
+#include "clang/AST/PrettyPrinter.h"
+#include "clang/AST/RecursiveASTVisitor.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <vector>
+
+using namespace clang;
+using namespace ento;
+
+STATISTIC(NumFunctionsUnchanged,
+          "The # of functions skipped because they are unchanged and clean.");
+STATISTIC(NumFunctionsRecordedClean,
+          "The # of functions recorded as clean for later runs.");
+
+/// The first word of a fingerprint database. Bump the version whenever the
+/// way fingerprints are computed changes.
+static const char FingerprintsMagic[] = "clang-analyzer-fingerprints-1";
+
+namespace {
+/// \brief A stream that hashes what is written to it, so that large outputs
+/// need not be kept in memory.
+class MD5Stream : public llvm::raw_ostream {
+  llvm::MD5 &Hash;
+  uint64_t Pos;
+
+  virtual void write_impl(const char *Ptr, size_t Size) {
+    Hash.update(ArrayRef<uint8_t>(reinterpret_cast<const uint8_t *>(Ptr),
+                                  Size));
+    Pos += Size;
+  }
+  virtual uint64_t current_pos() const { return Pos; }
+
+public:
+  explicit MD5Stream(llvm::MD5 &Hash) : Hash(Hash), Pos(0) {}
+  ~MD5Stream() { flush(); }
+};
+
+/// \brief Collects the functions that the analysis of a body may inline:
+/// the ones it calls, takes the address of, constructs or destroys objects
+/// with, or sends messages to.
+class ReferencedFunctions : public RecursiveASTVisitor<ReferencedFunctions> {
+  SmallVectorImpl<const Decl *> &Found;
+
+  void add(const FunctionDecl *FD) {
+    const FunctionDecl *Definition;
+    if (FD && FD->hasBody(Definition))
+      Found.push_back(Definition);
+  }
+
+  void addDestructor(QualType T) {
+    if (const CXXRecordDecl *RD = T->getAsCXXRecordDecl())
+      if (RD->hasDefinition())
+        add(RD->getDestructor());
+  }
+
+public:
+  explicit ReferencedFunctions(SmallVectorImpl<const Decl *> &Found)
+    : Found(Found) {}
+
+  bool VisitDeclRefExpr(DeclRefExpr *E) {
+    add(dyn_cast<FunctionDecl>(E->getDecl()));
+    return true;
+  }
+
+  bool VisitMemberExpr(MemberExpr *E) {
+    add(dyn_cast<FunctionDecl>(E->getMemberDecl()));
+    return true;
+  }
+
+  bool VisitCXXConstructExpr(CXXConstructExpr *E) {
+    add(E->getConstructor());
+    addDestructor(E->getType());
+    return true;
+  }
+
+  bool VisitCXXBindTemporaryExpr(CXXBindTemporaryExpr *E) {
+    add(E->getTemporary()->getDestructor());
+    return true;
+  }
+
+  bool VisitCXXNewExpr(CXXNewExpr *E) {
+    add(E->getOperatorNew());
+    return true;
+  }
+
+  bool VisitCXXDeleteExpr(CXXDeleteExpr *E) {
+    add(E->getOperatorDelete());
+    addDestructor(E->getDestroyedType());
+    return true;
+  }
+
+  bool VisitObjCMessageExpr(ObjCMessageExpr *E) {
+    // Look for the definition the same way the call graph does.
+    if (const ObjCInterfaceDecl *ID = E->getReceiverInterface()) {
+      const ObjCMethodDecl *MD =
+          E->isInstanceMessage() ? ID->lookupPrivateMethod(E->getSelector())
+                                 : ID->lookupPrivateClassMethod(
+                                       E->getSelector());
+      if (MD && MD->hasBody())
+        Found.push_back(MD);
+    }
+    return true;
+  }
+};
+} // end anonymous namespace
+
+/// \brief Prints the declarations in \p DC without the bodies of functions,
+/// which are part of the fingerprints of the functions themselves.
+static void printDeclarations(const DeclContext *DC, raw_ostream &OS,
+                              const PrintingPolicy &Policy) {
+  for (DeclContext::decl_iterator I = DC->decls_begin(), E = DC->decls_end();
+       I != E; ++I) {
+    const Decl *D = *I;
+    if (D->isImplicit())
+      continue;
+    D->print(OS, Policy);
+    OS << '\n';
+
+    // The terse policy leaves out the contents of declaration contexts.
+    if (isa<FunctionDecl>(D) || isa<ObjCMethodDecl>(D) || isa<BlockDecl>(D))
+      continue;
+    if (const ClassTemplateDecl *CTD = dyn_cast<ClassTemplateDecl>(D))
+      printDeclarations(CTD->getTemplatedDecl(), OS, Policy);
+    else if (const DeclContext *Inner = dyn_cast<DeclContext>(D))
+      printDeclarations(Inner, OS, Policy);
+  }
+}
+
+FunctionFingerprints::FunctionFingerprints(StringRef Path,
+                                           StringRef OptionsSignature,
+                                           ASTContext &Ctx,
+                                           unsigned CalleeDepth)
+  : File(Path, FingerprintsMagic, OptionsSignature),
+    OptionsSignature(OptionsSignature), Ctx(Ctx), CalleeDepth(CalleeDepth) {
+  File.read(Clean);
+}
+
+const std::string &FunctionFingerprints::getContextHash() {
+  if (!ContextHash.empty())
+    return ContextHash;
+
+  PrintingPolicy Policy(Ctx.getLangOpts());
+  Policy.TerseOutput = true;
+  llvm::MD5 Hash;
+  {
+    MD5Stream OS(Hash);
+    printDeclarations(Ctx.getTranslationUnitDecl(), OS, Policy);
+  }
+  ContextHash = getHexDigest(Hash);
+  return ContextHash;
+}
+
+const std::string &FunctionFingerprints::getBodyHash(const Decl *D) {
+  std::pair<llvm::DenseMap<const Decl *, std::string>::iterator, bool> Known =
+      BodyHashes.insert(std::make_pair(D, std::string()));
+  std::string &BodyHash = Known.first->second;
+  if (!Known.second)
+    return BodyHash;
+
+  // Blocks have no name to be found by in another run.
+  const NamedDecl *ND = dyn_cast<NamedDecl>(D);
+  const Stmt *Body = D->getBody();
+  if (!ND || !Body)
+    return BodyHash;
+
+  llvm::MD5 Hash;
+  {
+    MD5Stream OS(Hash);
+    OS << ND->getQualifiedNameAsString() << '\0';
+    if (const ValueDecl *VD = dyn_cast<ValueDecl>(ND))
+      OS << VD->getType().getAsString() << '\0';
+    else if (const ObjCMethodDecl *MD = dyn_cast<ObjCMethodDecl>(ND))
+      OS << (MD->isInstanceMethod() ? '-' : '+')
+         << cast<ObjCContainerDecl>(MD->getDeclContext())->getName() << '\0';
+    Body->printPretty(OS, 0, PrintingPolicy(Ctx.getLangOpts()));
+  }
+  BodyHash = getHexDigest(Hash);
+  return BodyHash;
+}
+
+const std::string &FunctionFingerprints::getFingerprint(const Decl *D) {
+  std::pair<llvm::DenseMap<const Decl *, std::string>::iterator, bool> Known =
+      Fingerprints.insert(std::make_pair(D, std::string()));
+  if (!Known.second)
+    return Known.first->second;
+
+  std::string OwnHash = getBodyHash(D);
+  if (OwnHash.empty())
+    return Known.first->second;
+
+  // Gather the functions that may be inlined into D, level by level. Their
+  // order must not depend on the run, so only their hashes are kept.
+  std::vector<std::string> CalleeHashes;
+  SmallPtrSet<const Decl *, 32> Seen;
+  Seen.insert(D);
+  SmallVector<const Decl *, 16> Frontier(1, D);
+  for (unsigned Depth = 0; Depth != CalleeDepth && !Frontier.empty();
+       ++Depth) {
+    SmallVector<const Decl *, 16> Referenced;
+    for (unsigned I = 0, E = Frontier.size(); I != E; ++I)
+      ReferencedFunctions(Referenced)
+          .TraverseStmt(const_cast<Stmt *>(Frontier[I]->getBody()));
+
+    SmallVector<const Decl *, 16> Next;
+    for (unsigned I = 0, E = Referenced.size(); I != E; ++I) {
+      if (!Seen.insert(Referenced[I]))
+        continue;
+      Next.push_back(Referenced[I]);
+      CalleeHashes.push_back(getBodyHash(Referenced[I]));
+    }
+    Frontier.swap(Next);
+  }
+  std::sort(CalleeHashes.begin(), CalleeHashes.end());
+
+  llvm::MD5 Hash;
+  {
+    MD5Stream OS(Hash);
+    OS << OptionsSignature << '\0' << getContextHash() << '\0' << OwnHash
+       << '\0';
+    for (unsigned I = 0, E = CalleeHashes.size(); I != E; ++I)
+      OS << CalleeHashes[I] << '\0';
+  }
+
+  std::string &Fingerprint = Known.first->second;
+  Fingerprint = getHexDigest(Hash);
+  return Fingerprint;
+}
+
+bool FunctionFingerprints::isUnchangedAndClean(const Decl *D) {
+  if (Clean.empty())
+    return false;
+  const std::string &Fingerprint = getFingerprint(D);
+  if (Fingerprint.empty() || !Clean.count(Fingerprint))
+    return false;
+  ++NumFunctionsUnchanged;
+  return true;
+}
+
+void FunctionFingerprints::recordAnalysis(const Decl *D, bool Reported) {
+  // A function is analyzed once for the AST checks and once for the path
+  // sensitive ones; it is clean only if neither reported anything.
+  bool &AnyReported = Analyzed[D];
+  AnyReported |= Reported;
+}
+
+void FunctionFingerprints::save() {
+  for (llvm::DenseMap<const Decl *, bool>::iterator I = Analyzed.begin(),
+                                                    E = Analyzed.end();
+       I != E; ++I) {
+    if (I->second)
+      continue;
+    const std::string &Fingerprint = getFingerprint(I->first);
+    if (Fingerprint.empty() || Clean.count(Fingerprint))
+      continue;
+    NewClean.GetOrCreateValue(Fingerprint);
+    ++NumFunctionsRecordedClean;
+  }
+  if (NewClean.empty())
+    return;
+
+  if (File.merge(NewClean))
+    NewClean.clear();
+}
@@ -0,0 +1,90 @@
+//===--- FunctionFingerprints.h - Skip unchanged functions ------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines FunctionFingerprints, which remembers across analyzer
+// runs the functions whose analysis reported nothing, so that they need not
+// be analyzed again until they change.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_GR_FUNCTIONFINGERPRINTS_H
+#define LLVM_CLANG_GR_FUNCTIONFINGERPRINTS_H
+
+#include "clang/Basic/LLVM.h"
+#include "clang/StaticAnalyzer/Core/PersistentAnalysisFile.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/StringRef.h"
+#include <string>
+
+namespace clang {
+
+class ASTContext;
+class Decl;
+
+namespace ento {
+
+/// \brief A database of the functions whose analysis reported no issues.
+///
+/// A function is identified by a fingerprint of everything its analysis can
+/// depend on: its own definition, the definitions of the functions it refers
+/// to (transitively, as deep as they can be inlined), the declarations of the
+/// translation unit other than function bodies, and the analyzer options.
+/// When none of them changed since a run that reported nothing in the
+/// function, analyzing it again would report nothing either.
+///
+/// The database is a PersistentAnalysisFile whose keys are the fingerprints.
+class FunctionFingerprints {
+  PersistentAnalysisFile File;
+  std::string OptionsSignature;
+  ASTContext &Ctx;
+  unsigned CalleeDepth;
+
+  /// The hash of the translation unit's declarations, computed on demand.
+  std::string ContextHash;
+
+  /// The fingerprints of the functions known to report nothing.
+  PersistentAnalysisFile::EntryMap Clean;
+
+  /// The fingerprints of the functions found to report nothing by this run.
+  PersistentAnalysisFile::EntryMap NewClean;
+
+  /// Whether each function analyzed by this run reported anything.
+  llvm::DenseMap<const Decl *, bool> Analyzed;
+
+  llvm::DenseMap<const Decl *, std::string> BodyHashes;
+  llvm::DenseMap<const Decl *, std::string> Fingerprints;
+
+  const std::string &getContextHash();
+  const std::string &getBodyHash(const Decl *D);
+  const std::string &getFingerprint(const Decl *D);
+
+public:
+  /// \param CalleeDepth How many levels of calls may be inlined into a
+  /// function, and thus affect the result of analyzing it.
+  FunctionFingerprints(StringRef Path, StringRef OptionsSignature,
+                       ASTContext &Ctx, unsigned CalleeDepth);
+
+  /// \brief Returns true if \p D is unchanged since an earlier run found
+  /// nothing to report in it.
+  bool isUnchangedAndClean(const Decl *D);
+
+  /// \brief Records that \p D was analyzed by this run, and whether it
+  /// reported anything.
+  void recordAnalysis(const Decl *D, bool Reported);
+
+  /// \brief Adds the functions this run analyzed without reporting anything
+  /// to the database on disk.
+  void save();
+};
+
+} // end GR namespace
+
+} // end clang namespace
+
+#endif
@@ -51,6 +51,9 @@ const char *const CommonOptionsParser::HelpMessage =
     "\tworking directory. \"./\" prefixes in the relative files will be\n"
     "\tautomatically removed, but the rest of a relative path must be a\n"
     "\tsuffix of a path in the compile command database.\n"
+    "\n"
+    "-j <N> processes up to N translation units concurrently. -j 0 uses\n"
+    "\tone thread per hardware thread.\n"
     "\n";
 
 CommonOptionsParser::CommonOptionsParser(int &argc, const char **argv,
@@ -61,10 +64,15 @@ CommonOptionsParser::CommonOptionsParser(int &argc, const char **argv,
   static cl::list<std::string> SourcePaths(
       cl::Positional, cl::desc("<source0> [... <sourceN>]"), cl::OneOrMore);
 
+  static cl::opt<unsigned> Jobs(
+      "j", cl::desc("Number of translation units to process concurrently"),
+      cl::init(1), cl::Prefix);
+
   Compilations.reset(FixedCompilationDatabase::loadFromCommandLine(argc,
                                                                    argv));
   cl::ParseCommandLineOptions(argc, argv, Overview);
   SourcePathList = SourcePaths;
+  NumThreads = Jobs;
   if (!Compilations) {
     std::string ErrorMessage;
     if (!BuildPath.empty()) {
@@ -17,6 +17,8 @@
 #include "clang/Tooling/Tooling.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/YAMLParser.h"
 #include "llvm/Support/system_error.h"
 
 namespace clang {
@@ -117,6 +119,84 @@ std::vector<std::string> unescapeCommandLine(
   return parser.parse();
 }
 
+/// \brief A scanner for the plain JSON that build systems write compilation
+/// databases in.
+///
+/// Only double-quoted strings are supported, whose only escape sequences are
+/// those for quotes, backslashes, backspace, form feed, newline, carriage
+/// return and tab. Anything else makes the scanner fail, and the caller falls
+/// back to the YAML parser.
+class SimpleJSONScanner {
+ public:
+  SimpleJSONScanner(StringRef Input)
+      : Position(Input.begin()), End(Input.end()) {}
+
+  /// \brief Skips whitespace and consumes \p C if it comes next.
+  bool consume(char C) {
+    skipWhitespace();
+    if (Position == End || *Position != C)
+      return false;
+    ++Position;
+    return true;
+  }
+
+  /// \brief Returns whether only whitespace is left.
+  bool atEnd() {
+    skipWhitespace();
+    return Position == End;
+  }
+
+  /// \brief Scans a string into \p Value, which points into the input if the
+  /// string has no escape sequences, and into \p Storage otherwise.
+  bool scanString(StringRef &Value, std::string &Storage) {
+    if (!consume('"'))
+      return false;
+    const char *Start = Position;
+    bool HasEscapes = false;
+    for (; Position != End && *Position != '"'; ++Position) {
+      char C = *Position;
+      // YAML folds line breaks in strings; leave those to the YAML parser.
+      if (static_cast<unsigned char>(C) < 0x20)
+        return false;
+      if (C != '\\') {
+        if (HasEscapes)
+          Storage.push_back(C);
+        continue;
+      }
+      if (!HasEscapes) {
+        Storage.assign(Start, Position);
+        HasEscapes = true;
+      }
+      if (++Position == End)
+        return false;
+      switch (*Position) {
+      case '"': case '\\': Storage.push_back(*Position); break;
+      case 'b': Storage.push_back('\b'); break;
+      case 'f': Storage.push_back('\f'); break;
+      case 'n': Storage.push_back('\n'); break;
+      case 'r': Storage.push_back('\r'); break;
+      case 't': Storage.push_back('\t'); break;
+      default: return false;
+      }
+    }
+    if (Position == End)
+      return false;
+    Value = HasEscapes ? StringRef(Storage) : StringRef(Start, Position - Start);
+    ++Position;
+    return true;
+  }
+
+ private:
+  void skipWhitespace() {
+    while (Position != End && (*Position == ' ' || *Position == '\t' ||
+                               *Position == '\n' || *Position == '\r'))
+      ++Position;
+  }
+
+  const char *Position;
+  const char *const End;
+};
+
 class JSONCompilationDatabasePlugin : public CompilationDatabasePlugin {
   virtual CompilationDatabase *loadFromDirectory(
       StringRef Directory, std::string &ErrorMessage) {
@@ -189,6 +269,78 @@ JSONCompilationDatabase::getCompileCommands(StringRef FilePath) const {
   return Commands;
 }
 
+/// \brief Returns \p Path without its extension.
+static StringRef dropExtension(StringRef Path) {
+  return Path.drop_back(llvm::sys::path::extension(Path).size());
+}
+
+std::vector<CompileCommand>
+JSONCompilationDatabase::getInferredCompileCommands(StringRef FilePath) const {
+  std::vector<CompileCommand> Commands = getCompileCommands(FilePath);
+  if (!Commands.empty())
+    return Commands;
+
+  SmallString<128> NativeFilePath;
+  llvm::sys::path::native(FilePath, NativeFilePath);
+  StringRef Path = NativeFilePath.str();
+
+  StringRef Closest;
+  llvm::StringMap<StringRef>::const_iterator I =
+    FileByStem.find(dropExtension(Path));
+  if (I != FileByStem.end()) {
+    Closest = I->getValue();
+  } else {
+    for (StringRef Dir = llvm::sys::path::parent_path(Path); !Dir.empty();
+         Dir = llvm::sys::path::parent_path(Dir)) {
+      I = FileByDirectory.find(Dir);
+      if (I != FileByDirectory.end()) {
+        Closest = I->getValue();
+        break;
+      }
+    }
+  }
+  if (Closest.empty())
+    return Commands;
+
+  getCommands(IndexByFile.find(Closest)->getValue(), Commands);
+
+  // Compile FilePath instead of the file the commands are for.
+  for (unsigned C = 0, CE = Commands.size(); C != CE; ++C) {
+    std::vector<std::string> &CommandLine = Commands[C].CommandLine;
+    for (unsigned A = 1, AE = CommandLine.size(); A < AE; ++A) {
+      SmallString<128> Arg;
+      if (llvm::sys::path::is_relative(CommandLine[A])) {
+        SmallString<128> AbsolutePath(Commands[C].Directory);
+        llvm::sys::path::append(AbsolutePath, CommandLine[A]);
+        llvm::sys::path::native(AbsolutePath.str(), Arg);
+      } else {
+        llvm::sys::path::native(CommandLine[A], Arg);
+      }
+      if (Arg.str() == Closest)
+        CommandLine[A] = FilePath.str();
+    }
+  }
+  return Commands;
+}
+
+void JSONCompilationDatabase::buildInferenceIndex() {
+  for (llvm::StringMap< std::vector<CompileCommandRef> >::const_iterator
+        I = IndexByFile.begin(), E = IndexByFile.end(); I != E; ++I) {
+    StringRef File = I->getKey();
+    // StringMap iteration order is arbitrary; keep the smallest path so that
+    // the inferred commands don't depend on it.
+    StringRef &ByStem = FileByStem[dropExtension(File)];
+    if (ByStem.empty() || File < ByStem)
+      ByStem = File;
+    for (StringRef Dir = llvm::sys::path::parent_path(File); !Dir.empty();
+         Dir = llvm::sys::path::parent_path(Dir)) {
+      StringRef &ByDir = FileByDirectory[Dir];
+      if (ByDir.empty() || File < ByDir)
+        ByDir = File;
+    }
+  }
+}
+
 std::vector<std::string>
 JSONCompilationDatabase::getAllFiles() const {
   std::vector<std::string> Result;
@@ -219,16 +371,96 @@ void JSONCompilationDatabase::getCommands(
                                   ArrayRef<CompileCommandRef> CommandsRef,
                                   std::vector<CompileCommand> &Commands) const {
   for (int I = 0, E = CommandsRef.size(); I != E; ++I) {
-    SmallString<8> DirectoryStorage;
-    SmallString<1024> CommandStorage;
     Commands.push_back(CompileCommand(
       // FIXME: Escape correctly:
-      CommandsRef[I].first->getValue(DirectoryStorage),
-      unescapeCommandLine(CommandsRef[I].second->getValue(CommandStorage))));
+      CommandsRef[I].first,
+      unescapeCommandLine(CommandsRef[I].second)));
+  }
+}
+
+StringRef JSONCompilationDatabase::save(StringRef Value) {
+  StringRef Buffer = Database->getBuffer();
+  if (Value.begin() >= Buffer.begin() && Value.end() <= Buffer.end())
+    return Value;
+  return Strings.GetOrCreateValue(Value).getKey();
+}
+
+void JSONCompilationDatabase::addCommand(StringRef Directory,
+                                         StringRef Command, StringRef File) {
+  SmallString<128> NativeFilePath;
+  if (llvm::sys::path::is_relative(File)) {
+    SmallString<128> AbsolutePath(Directory);
+    llvm::sys::path::append(AbsolutePath, File);
+    llvm::sys::path::native(AbsolutePath.str(), NativeFilePath);
+  } else {
+    llvm::sys::path::native(File, NativeFilePath);
   }
+  IndexByFile[NativeFilePath].push_back(CompileCommandRef(Directory, Command));
+  MatchTrie.insert(NativeFilePath.str());
 }
 
 bool JSONCompilationDatabase::parse(std::string &ErrorMessage) {
+  if (!parseSimpleJSON()) {
+    Strings.clear();
+    if (!parseYAML(ErrorMessage))
+      return false;
+  }
+  buildInferenceIndex();
+  return true;
+}
+
+bool JSONCompilationDatabase::parseSimpleJSON() {
+  SimpleJSONScanner Scanner(Database->getBuffer());
+  // Tuples (directory, command, file); nothing is indexed until the whole
+  // database has been scanned successfully.
+  std::vector<std::pair<CompileCommandRef, StringRef> > Entries;
+  std::string KeyStorage, ValueStorage;
+  if (!Scanner.consume('['))
+    return false;
+  if (!Scanner.consume(']')) {
+    do {
+      if (!Scanner.consume('{'))
+        return false;
+      StringRef Directory, Command, File;
+      bool HasDirectory = false, HasCommand = false, HasFile = false;
+      do {
+        StringRef Key, Value;
+        if (!Scanner.scanString(Key, KeyStorage) || !Scanner.consume(':') ||
+            !Scanner.scanString(Value, ValueStorage))
+          return false;
+        if (Key == "directory") {
+          Directory = save(Value);
+          HasDirectory = true;
+        } else if (Key == "command") {
+          Command = save(Value);
+          HasCommand = true;
+        } else if (Key == "file") {
+          File = save(Value);
+          HasFile = true;
+        } else {
+          return false;
+        }
+      } while (Scanner.consume(','));
+      if (!Scanner.consume('}') || !HasDirectory || !HasCommand || !HasFile)
+        return false;
+      Entries.push_back(
+          std::make_pair(CompileCommandRef(Directory, Command), File));
+    } while (Scanner.consume(','));
+    if (!Scanner.consume(']'))
+      return false;
+  }
+  if (!Scanner.atEnd())
+    return false;
+
+  for (unsigned I = 0, E = Entries.size(); I != E; ++I)
+    addCommand(Entries[I].first.first, Entries[I].first.second,
+               Entries[I].second);
+  return true;
+}
+
+bool JSONCompilationDatabase::parseYAML(std::string &ErrorMessage) {
+  llvm::SourceMgr SM;
+  llvm::yaml::Stream YAMLStream(Database->getBuffer(), SM);
   llvm::yaml::document_iterator I = YAMLStream.begin();
   if (I == YAMLStream.end()) {
     ErrorMessage = "Error while parsing YAML.";
@@ -300,21 +532,12 @@ bool JSONCompilationDatabase::parse(std::string &ErrorMessage) {
       ErrorMessage = "Missing key: \"directory\".";
       return false;
     }
+    SmallString<8> DirectoryStorage;
+    SmallString<1024> CommandStorage;
     SmallString<8> FileStorage;
-    StringRef FileName = File->getValue(FileStorage);
-    SmallString<128> NativeFilePath;
-    if (llvm::sys::path::is_relative(FileName)) {
-      SmallString<8> DirectoryStorage;
-      SmallString<128> AbsolutePath(
-          Directory->getValue(DirectoryStorage));
-      llvm::sys::path::append(AbsolutePath, FileName);
-      llvm::sys::path::native(AbsolutePath.str(), NativeFilePath);
-    } else {
-      llvm::sys::path::native(FileName, NativeFilePath);
-    }
-    IndexByFile[NativeFilePath].push_back(
-        CompileCommandRef(Directory, Command));
-    MatchTrie.insert(NativeFilePath.str());
+    addCommand(save(Directory->getValue(DirectoryStorage)),
+               save(Command->getValue(CommandStorage)),
+               File->getValue(FileStorage));
   }
   return true;
 }
@@ -14,6 +14,7 @@
 #include "clang/Basic/DiagnosticOptions.h"
 #include "clang/Basic/FileManager.h"
 #include "clang/Basic/SourceManager.h"
+#include "clang/Basic/WorkerPool.h"
 #include "clang/Frontend/TextDiagnosticPrinter.h"
 #include "clang/Lex/Lexer.h"
 #include "clang/Rewrite/Core/Rewriter.h"
@@ -47,17 +48,24 @@ bool Replacement::isApplicable() const {
   return FilePath != InvalidLocation;
 }
 
-bool Replacement::apply(Rewriter &Rewrite) const {
-  SourceManager &SM = Rewrite.getSourceMgr();
+/// \brief Returns the FileID for \p FilePath in \p SM, creating one if the
+/// file was not loaded yet, or an invalid FileID if there is no such file.
+static FileID getFileIDForPath(SourceManager &SM, StringRef FilePath) {
   const FileEntry *Entry = SM.getFileManager().getFile(FilePath);
   if (Entry == NULL)
-    return false;
-  FileID ID;
+    return FileID();
   // FIXME: Use SM.translateFile directly.
   SourceLocation Location = SM.translateFileLineCol(Entry, 1, 1);
-  ID = Location.isValid() ?
+  return Location.isValid() ?
     SM.getFileID(Location) :
     SM.createFileID(Entry, SourceLocation(), SrcMgr::C_User);
+}
+
+bool Replacement::apply(Rewriter &Rewrite) const {
+  SourceManager &SM = Rewrite.getSourceMgr();
+  FileID ID = getFileIDForPath(SM, FilePath);
+  if (ID.isInvalid())
+    return false;
   // FIXME: We cannot check whether Offset + Length is in the file, as
   // the remapping API is not public in the RewriteBuffer.
   const SourceLocation Start =
@@ -125,14 +133,29 @@ void Replacement::setFromSourceRange(SourceManager &Sources,
 
 bool applyAllReplacements(const Replacements &Replaces, Rewriter &Rewrite) {
   bool Result = true;
-  for (Replacements::const_iterator I = Replaces.begin(),
-                                    E = Replaces.end();
-       I != E; ++I) {
-    if (I->isApplicable()) {
-      Result = I->apply(Rewrite) && Result;
-    } else {
+  // Replacements are ordered by file first, so those of a file are adjacent.
+  // Finding a file's FileID is the expensive part of applying a replacement,
+  // so do it once per file rather than once per replacement.
+  Replacements::const_iterator I = Replaces.begin(), E = Replaces.end();
+  while (I != E) {
+    StringRef FilePath = I->getFilePath();
+    Replacements::const_iterator FileEnd = I;
+    while (FileEnd != E && FileEnd->getFilePath() == FilePath)
+      ++FileEnd;
+    FileID ID;
+    if (I->isApplicable())
+      ID = getFileIDForPath(Rewrite.getSourceMgr(), FilePath);
+    if (ID.isInvalid()) {
       Result = false;
+      I = FileEnd;
+      continue;
     }
+    // FIXME: We cannot check whether Offset + Length is in the file, as
+    // the remapping API is not public in the RewriteBuffer.
+    RewriteBuffer &Buffer = Rewrite.getEditBuffer(ID);
+    for (; I != FileEnd; ++I)
+      Buffer.ReplaceText(I->getOffset(), I->getLength(),
+                         I->getReplacementText());
   }
   return Result;
 }
@@ -152,13 +175,11 @@ std::string applyAllReplacements(StringRef Code, const Replacements &Replaces) {
   SourceMgr.overrideFileContents(Entry, Buf);
   FileID ID =
       SourceMgr.createFileID(Entry, SourceLocation(), clang::SrcMgr::C_User);
+  RewriteBuffer &Buffer = Rewrite.getEditBuffer(ID);
   for (Replacements::const_iterator I = Replaces.begin(), E = Replaces.end();
-       I != E; ++I) {
-    Replacement Replace("<stdin>", I->getOffset(), I->getLength(),
-                        I->getReplacementText());
-    if (!Replace.apply(Rewrite))
-      return "";
-  }
+       I != E; ++I)
+    Buffer.ReplaceText(I->getOffset(), I->getLength(),
+                       I->getReplacementText());
   std::string Result;
   llvm::raw_string_ostream OS(Result);
   Rewrite.getEditBuffer(ID).write(OS);
@@ -166,6 +187,44 @@ std::string applyAllReplacements(StringRef Code, const Replacements &Replaces) {
   return Result;
 }
 
+bool findConflicts(const Replacements &Replaces, Replacements &Conflicts) {
+  bool Found = false;
+  // The replacement of the current file that ends furthest; since they are
+  // ordered by offset, a later one overlaps an earlier one iff it starts
+  // before that end.
+  Replacements::const_iterator Furthest = Replaces.end();
+  // The insertions at an offset come before the other replacements there, so
+  // the insertions at the same offset follow each other.
+  Replacements::const_iterator PrevInsertion = Replaces.end();
+  for (Replacements::const_iterator I = Replaces.begin(), E = Replaces.end();
+       I != E; ++I) {
+    bool IsInsertion = I->getLength() == 0;
+    if (Furthest == E || Furthest->getFilePath() != I->getFilePath()) {
+      Furthest = I;
+      PrevInsertion = IsInsertion ? I : E;
+      continue;
+    }
+
+    if (IsInsertion && PrevInsertion != E &&
+        PrevInsertion->getOffset() == I->getOffset()) {
+      Conflicts.insert(*PrevInsertion);
+      Conflicts.insert(*I);
+      Found = true;
+    }
+    PrevInsertion = IsInsertion ? I : E;
+
+    unsigned FurthestEnd = Furthest->getOffset() + Furthest->getLength();
+    if (I->getOffset() < FurthestEnd) {
+      Conflicts.insert(*Furthest);
+      Conflicts.insert(*I);
+      Found = true;
+    }
+    if (I->getOffset() + I->getLength() > FurthestEnd)
+      Furthest = I;
+  }
+  return Found;
+}
+
 unsigned shiftedCodePosition(const Replacements &Replaces, unsigned Position) {
   unsigned NewPosition = Position;
   for (Replacements::iterator I = Replaces.begin(), E = Replaces.end(); I != E;
@@ -185,6 +244,11 @@ RefactoringTool::RefactoringTool(const CompilationDatabase &Compilations,
 
 Replacements &RefactoringTool::getReplacements() { return Replace; }
 
+void RefactoringTool::addReplacements(const Replacements &Replaces) {
+  llvm::sys::ScopedLock L(ReplaceLock);
+  Replace.insert(Replaces.begin(), Replaces.end());
+}
+
 int RefactoringTool::runAndSave(FrontendActionFactory *ActionFactory) {
   if (int Result = run(ActionFactory)) {
     return Result;
@@ -199,6 +263,16 @@ int RefactoringTool::runAndSave(FrontendActionFactory *ActionFactory) {
   SourceManager Sources(Diagnostics, getFiles());
   Rewriter Rewrite(Sources, DefaultLangOptions);
 
+  Replacements Conflicts;
+  if (findConflicts(Replace, Conflicts)) {
+    for (Replacements::const_iterator I = Conflicts.begin(),
+                                      E = Conflicts.end(); I != E; ++I) {
+      llvm::errs() << "Skipped conflicting replacement " << I->toString()
+                   << "\n";
+      Replace.erase(*I);
+    }
+  }
+
   if (!applyAllReplacements(Rewrite)) {
     llvm::errs() << "Skipped some replacements.\n";
   }
@@ -210,23 +284,48 @@ bool RefactoringTool::applyAllReplacements(Rewriter &Rewrite) {
   return tooling::applyAllReplacements(Replace, Rewrite);
 }
 
+namespace {
+// The state shared by the tasks of RefactoringTool::saveRewrittenFiles.
+struct ParallelSave {
+  std::vector<const char *> Filenames;
+  std::vector<const RewriteBuffer *> Buffers;
+  std::vector<char> Failed;
+};
+} // end namespace
+
+static void saveRewrittenFileTask(void *Context, unsigned Index) {
+  ParallelSave &Save = *static_cast<ParallelSave *>(Context);
+  std::string ErrorInfo;
+  llvm::raw_fd_ostream FileStream(Save.Filenames[Index], ErrorInfo,
+                                  llvm::sys::fs::F_Binary);
+  if (!ErrorInfo.empty()) {
+    Save.Failed[Index] = true;
+    return;
+  }
+  Save.Buffers[Index]->write(FileStream);
+  FileStream.flush();
+}
+
 int RefactoringTool::saveRewrittenFiles(Rewriter &Rewrite) {
+  // FIXME: This code is copied from the FixItRewriter.cpp - I think it should
+  // go into directly into Rewriter (there we also have the Diagnostics to
+  // handle the error cases better).
+  ParallelSave Save;
   for (Rewriter::buffer_iterator I = Rewrite.buffer_begin(),
                                  E = Rewrite.buffer_end();
        I != E; ++I) {
-    // FIXME: This code is copied from the FixItRewriter.cpp - I think it should
-    // go into directly into Rewriter (there we also have the Diagnostics to
-    // handle the error cases better).
     const FileEntry *Entry =
         Rewrite.getSourceMgr().getFileEntryForID(I->first);
-    std::string ErrorInfo;
-    llvm::raw_fd_ostream FileStream(Entry->getName(), ErrorInfo,
-                                    llvm::sys::fs::F_Binary);
-    if (!ErrorInfo.empty())
-      return 1;
-    I->second.write(FileStream);
-    FileStream.flush();
+    Save.Filenames.push_back(Entry->getName());
+    Save.Buffers.push_back(&I->second);
   }
+  Save.Failed.resize(Save.Filenames.size(), false);
+  runTasksInParallel(Save.Filenames.size(),
+                     getEffectiveWorkerCount(getNumThreads()),
+                     saveRewrittenFileTask, &Save);
+  for (unsigned I = 0, E = Save.Failed.size(); I != E; ++I)
+    if (Save.Failed[I])
+      return 1;
   return 0;
 }
 
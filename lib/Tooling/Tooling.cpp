@@ -13,6 +13,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "clang/Tooling/Tooling.h"
+#include "clang/Basic/WorkerPool.h"
 #include "clang/Driver/Compilation.h"
 #include "clang/Driver/Driver.h"
 #include "clang/Driver/Tool.h"
@@ -26,6 +27,7 @@
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Host.h"
+#include "llvm/Support/Mutex.h"
 #include "llvm/Support/raw_ostream.h"
 
 // For chdir, see the comment in ClangTool::run for more information.
@@ -40,6 +42,29 @@ namespace tooling {
 
 FrontendActionFactory::~FrontendActionFactory() {}
 
+namespace {
+class MultiplexFrontendActionFactory : public FrontendActionFactory {
+  std::vector<FrontendActionFactory *> Factories;
+
+public:
+  explicit MultiplexFrontendActionFactory(
+      ArrayRef<FrontendActionFactory *> Factories)
+      : Factories(Factories.begin(), Factories.end()) {}
+
+  virtual clang::FrontendAction *create() {
+    std::vector<clang::FrontendAction *> Actions;
+    for (unsigned I = 0, E = Factories.size(); I != E; ++I)
+      Actions.push_back(Factories[I]->create());
+    return new MultiplexFrontendAction(Actions);
+  }
+};
+}
+
+FrontendActionFactory *
+newMultiplexFrontendActionFactory(ArrayRef<FrontendActionFactory *> Factories) {
+  return new MultiplexFrontendActionFactory(Factories);
+}
+
 // FIXME: This file contains structural duplication with other parts of the
 // code that sets up a compiler to run tools on it, and we should refactor
 // it to be based on the same framework.
@@ -238,7 +263,7 @@ void ToolInvocation::addFileMappingsTo(SourceManager &Sources) {
 
 ClangTool::ClangTool(const CompilationDatabase &Compilations,
                      ArrayRef<std::string> SourcePaths)
-    : Files((FileSystemOptions())) {
+    : Files((FileSystemOptions())), NumThreads(1) {
   ArgsAdjusters.push_back(new ClangStripOutputAdjuster());
   ArgsAdjusters.push_back(new ClangSyntaxOnlyAdjuster());
   for (unsigned I = 0, E = SourcePaths.size(); I != E; ++I) {
@@ -281,6 +306,16 @@ void ClangTool::clearArgumentsAdjusters() {
   ArgsAdjusters.clear();
 }
 
+std::vector<std::string> ClangTool::getCommandLine(unsigned I,
+                                                  StringRef MainExecutable) {
+  std::vector<std::string> CommandLine = CompileCommands[I].second.CommandLine;
+  for (unsigned J = 0, E = ArgsAdjusters.size(); J != E; ++J)
+    CommandLine = ArgsAdjusters[J]->Adjust(CommandLine);
+  assert(!CommandLine.empty());
+  CommandLine[0] = MainExecutable;
+  return CommandLine;
+}
+
 int ClangTool::run(FrontendActionFactory *ActionFactory) {
   // Exists solely for the purpose of lookup of the resource path.
   // This just needs to be some symbol in the binary.
@@ -293,6 +328,10 @@ int ClangTool::run(FrontendActionFactory *ActionFactory) {
   std::string MainExecutable =
       llvm::sys::fs::getMainExecutable("clang_tool", &StaticSymbol);
 
+  unsigned NumWorkers = getEffectiveWorkerCount(NumThreads);
+  if (NumWorkers > 1 && CompileCommands.size() > 1)
+    return runInParallel(ActionFactory, MainExecutable, NumWorkers);
+
   bool ProcessingFailed = false;
   for (unsigned I = 0; I < CompileCommands.size(); ++I) {
     std::string File = CompileCommands[I].first;
@@ -306,11 +345,7 @@ int ClangTool::run(FrontendActionFactory *ActionFactory) {
     if (chdir(CompileCommands[I].second.Directory.c_str()))
       llvm::report_fatal_error("Cannot chdir into \"" +
                                CompileCommands[I].second.Directory + "\n!");
-    std::vector<std::string> CommandLine = CompileCommands[I].second.CommandLine;
-    for (unsigned I = 0, E = ArgsAdjusters.size(); I != E; ++I)
-      CommandLine = ArgsAdjusters[I]->Adjust(CommandLine);
-    assert(!CommandLine.empty());
-    CommandLine[0] = MainExecutable;
+    std::vector<std::string> CommandLine = getCommandLine(I, MainExecutable);
     // FIXME: We need a callback mechanism for the tool writer to output a
     // customized message for each file.
     DEBUG({
@@ -330,5 +365,89 @@ int ClangTool::run(FrontendActionFactory *ActionFactory) {
   return ProcessingFailed ? 1 : 0;
 }
 
+namespace {
+/// \brief The state shared by the workers of a parallel ClangTool::run for
+/// the translation units of one compile directory.
+struct ParallelToolRun {
+  FrontendActionFactory *ActionFactory;
+  const std::vector< std::pair<StringRef, StringRef> > *MappedFileContents;
+  std::vector< std::vector<std::string> > CommandLines;
+  /// \brief Per-task result; char rather than bool so that workers write to
+  /// distinct memory locations.
+  std::vector<char> Succeeded;
+  /// \brief Serializes calls into ActionFactory, which need not be
+  /// thread-safe.
+  llvm::sys::Mutex FactoryLock;
+};
+}
+
+static void runToolInvocationTask(void *Context, unsigned Index) {
+  ParallelToolRun &Run = *static_cast<ParallelToolRun *>(Context);
+  FrontendAction *ToolAction;
+  {
+    llvm::sys::ScopedLock L(Run.FactoryLock);
+    ToolAction = Run.ActionFactory->create();
+  }
+  // Every translation unit gets its own FileManager; ToolInvocation::run
+  // creates a fresh DiagnosticsEngine for it.
+  FileManager Files((FileSystemOptions()));
+  ToolInvocation Invocation(Run.CommandLines[Index], ToolAction, &Files);
+  for (unsigned I = 0, E = Run.MappedFileContents->size(); I != E; ++I) {
+    Invocation.mapVirtualFile((*Run.MappedFileContents)[I].first,
+                              (*Run.MappedFileContents)[I].second);
+  }
+  Run.Succeeded[Index] = Invocation.run();
+}
+
+int ClangTool::runInParallel(FrontendActionFactory *ActionFactory,
+                             StringRef MainExecutable, unsigned NumWorkers) {
+  // chdir is process-wide, so group the compile commands by directory, in
+  // order of first appearance, and only run commands from the same
+  // directory concurrently.
+  std::vector<std::string> Directories;
+  std::vector< std::vector<unsigned> > CommandsInDirectory;
+  llvm::StringMap<unsigned> DirectoryIndex;
+  for (unsigned I = 0, E = CompileCommands.size(); I != E; ++I) {
+    const std::string &Directory = CompileCommands[I].second.Directory;
+    llvm::StringMap<unsigned>::iterator Known = DirectoryIndex.find(Directory);
+    if (Known == DirectoryIndex.end()) {
+      Known = DirectoryIndex.insert(
+          std::make_pair(Directory, (unsigned)Directories.size())).first;
+      Directories.push_back(Directory);
+      CommandsInDirectory.resize(Directories.size());
+    }
+    CommandsInDirectory[Known->getValue()].push_back(I);
+  }
+
+  bool ProcessingFailed = false;
+  for (unsigned D = 0, DE = Directories.size(); D != DE; ++D) {
+    if (chdir(Directories[D].c_str()))
+      llvm::report_fatal_error("Cannot chdir into \"" + Directories[D] +
+                               "\n!");
+    const std::vector<unsigned> &Commands = CommandsInDirectory[D];
+    ParallelToolRun Run;
+    Run.ActionFactory = ActionFactory;
+    Run.MappedFileContents = &MappedFileContents;
+    for (unsigned I = 0, E = Commands.size(); I != E; ++I)
+      Run.CommandLines.push_back(getCommandLine(Commands[I], MainExecutable));
+    Run.Succeeded.resize(Commands.size(), false);
+
+    runTasksInParallel(Commands.size(), NumWorkers, runToolInvocationTask,
+                       &Run);
+
+    // Report failures in the order the files were given, independent of the
+    // order in which the workers finished.
+    for (unsigned I = 0, E = Commands.size(); I != E; ++I) {
+      if (!Run.Succeeded[I]) {
+        // FIXME: Diagnostics should be used instead.
+        llvm::errs() << "Error while processing "
+                     << CompileCommands[Commands[I]].first << ".\n";
+        ProcessingFailed = true;
+      }
+    }
+  }
+  return ProcessingFailed ? 1 : 0;
+}
+
 } // end namespace tooling
 } // end namespace clang
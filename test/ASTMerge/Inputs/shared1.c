@@ -0,0 +1,7 @@
+#define CONFIGURED_WIDE
+#include "shared1.h"
+
+struct Shared s1;
+SharedT t1;
+enum SharedE e1;
+struct Configured c;
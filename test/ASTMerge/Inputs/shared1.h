@@ -0,0 +1,16 @@
+struct Shared {
+  int i;
+  float f;
+};
+
+typedef struct Shared SharedT;
+
+enum SharedE { SharedA, SharedB = 4 };
+
+// The same header, preprocessed differently.
+struct Configured {
+  int i;
+#ifdef CONFIGURED_WIDE
+  long l;
+#endif
+};
@@ -0,0 +1,6 @@
+#include "shared1.h"
+
+struct Shared s2;
+SharedT t2;
+enum SharedE e2;
+struct Configured c;
@@ -0,0 +1,16 @@
+// RUN: %clang_cc1 -emit-pch -o %t.1.ast %S/Inputs/shared1.c
+// RUN: %clang_cc1 -emit-pch -o %t.2.ast %S/Inputs/shared2.c
+// RUN: not %clang_cc1 -ast-merge %t.1.ast -ast-merge %t.2.ast -fsyntax-only %s 2>&1 | FileCheck %s
+
+// Declarations from a header that both AST files include are merged, except
+// when the header was preprocessed differently.
+
+// CHECK-NOT: 'struct Shared'
+// CHECK-NOT: 'SharedT'
+// CHECK-NOT: 'enum SharedE'
+// CHECK: shared1.h:11:8: warning: type 'struct Configured' has incompatible definitions in different translation units
+// CHECK: shared1.h:14:8: note: field 'l' has type 'long' here
+// CHECK: shared1.h:11:8: note: no corresponding field here
+// CHECK: shared2.c:6:19: error: external variable 'c' declared with incompatible types in different translation units ('struct Configured' vs. 'struct Configured')
+// CHECK: shared1.c:7:19: note: declared here with type 'struct Configured'
+// CHECK: 1 warning and 1 error generated
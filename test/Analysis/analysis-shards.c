@@ -0,0 +1,25 @@
+// RUN: %clang_cc1 -analyze -analyzer-checker=core,deadcode.DeadStores %s 2>&1 | FileCheck -check-prefix=ALL %s
+// RUN: %clang_cc1 -analyze -analyzer-checker=core,deadcode.DeadStores -analyzer-config shard-count=2,shard-index=0 %s 2>&1 | FileCheck -check-prefix=SHARD0 %s
+// RUN: %clang_cc1 -analyze -analyzer-checker=core,deadcode.DeadStores -analyzer-config shard-count=2,shard-index=1 %s 2>&1 | FileCheck -check-prefix=SHARD1 %s
+
+// Each function is analyzed path-sensitively by exactly one shard, and the
+// AST-only checks are run by shard 0 alone.
+
+void f1(int *p) {
+  p = 0;
+  *p = 1;
+}
+
+void f2(int *q) {
+  q = 0;
+  *q = 2;
+}
+
+void f3() {
+  int x;
+  x = 3;
+}
+
+// ALL: 3 warnings generated.
+// SHARD0: 2 warnings generated.
+// SHARD1: 1 warning generated.
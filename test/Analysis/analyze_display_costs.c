@@ -0,0 +1,17 @@
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -analyzer-display-costs %s 2>&1 | FileCheck %s
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -analyzer-display-costs -analyzer-config max-nodes=10 %s 2>&1 | FileCheck -check-prefix=EXHAUSTED %s
+
+int f(int x) {
+  return x + 1;
+}
+
+int g(int n) {
+  int sum = 0;
+  for (int i = 0; i < n; ++i)
+    sum += f(i);
+  return sum;
+}
+
+// CHECK: COSTS: {{.*}}analyze_display_costs.c g: explore-ms={{[0-9.]+}} report-ms={{[0-9.]+}} nodes={{[1-9][0-9]*}} max-states={{[1-9][0-9]*}} exhausted=no
+
+// EXHAUSTED: COSTS: {{.*}}analyze_display_costs.c g: {{.*}} exhausted=yes
@@ -2,7 +2,7 @@
 
 int foo();
 
-int test() { // expected-warning-re{{test -> Total CFGBlocks: [0-9]+ \| Unreachable CFGBlocks: 0 \| Exhausted Block: no \| Empty WorkList: yes}}
+int test() { // expected-warning-re{{test -> Total CFGBlocks: [0-9]+ \| Unreachable CFGBlocks: 0 \| Exhausted Block: no \| Empty WorkList: yes \| Nodes: [0-9]+ \| Reclaimed Nodes: [0-9]+ \| Peak Graph Memory: [0-9]+ KB}}
   int a = 1;
   a = 34 / 12;
 
@@ -0,0 +1,21 @@
+// RUN: %clang_cc1 -analyze -analyzer-checker=core,unix.Malloc -verify %s
+// RUN: %clang_cc1 -analyze -analyzer-checker=core,unix.Malloc -analyzer-config dead-symbol-sweep-interval=4 -verify %s
+
+typedef __typeof(sizeof(int)) size_t;
+void *malloc(size_t);
+void free(void *);
+void use(void);
+
+// Dead symbols are always swept before a call, whatever the interval.
+void leakBeforeCall() {
+  int *p = malloc(sizeof(int));
+  p = 0;
+  use(); // expected-warning{{Potential leak of memory pointed to by 'p'}}
+}
+
+// ...and at the end of the function.
+void leakAtEnd(int x) {
+  int *p = malloc(sizeof(int));
+  if (x)
+    free(p);
+} // expected-warning{{Potential leak of memory pointed to by 'p'}}
@@ -0,0 +1,22 @@
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -analyzer-config exploration_strategy=dfs -verify %s
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -analyzer-config exploration_strategy=bfs -verify %s
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -analyzer-config exploration_strategy=bfs_block_dfs_contents -verify %s
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -analyzer-config exploration_strategy=unexplored_first -verify %s
+
+// Every strategy must reach the same bugs when the node budget suffices.
+
+int check(int *p, int n) {
+  int sum = 0;
+  for (int i = 0; i < n; ++i)
+    sum += i;
+  if (p)
+    return sum;
+  return *p; // expected-warning {{Dereference of null pointer}}
+}
+
+void loopThenCrash(int n) {
+  int *p = 0;
+  while (n-- > 0)
+    ;
+  *p = 1; // expected-warning {{Dereference of null pointer}}
+}
@@ -0,0 +1,26 @@
+// RUN: rm -fR %t
+// RUN: mkdir %t
+// RUN: %clang_cc1 -analyze -analyzer-output=html -analyzer-checker=core -o %t %s
+// RUN: ls %t | grep report | count 2
+// RUN: for report in %t/report-*.html; do FileCheck %s < $report; done
+
+// REQUIRES: shell
+
+// Both reports are highlighted, even though the highlighting of the file is
+// only computed for the first one.
+
+#define DEREF(p) *p = 0
+
+// CHECK: <span class='keyword'>void</span> first_bug
+void first_bug(int *p) {
+  if (p)
+    return;
+  DEREF(p);
+}
+
+// CHECK: <span class='macro'>DEREF(q)<span class='expansion'>*q = 0</span></span>
+void second_bug(int *q) {
+  if (q)
+    return;
+  DEREF(q);
+}
@@ -0,0 +1,46 @@
+// RUN: rm -f %t.db
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -analyzer-incremental-db %t.db -verify %s
+// RUN: FileCheck -check-prefix=DB -input-file=%t.db %s
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -analyzer-incremental-db %t.db -analyzer-display-progress -verify %s 2>&1 | FileCheck -check-prefix=UNCHANGED %s
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -analyzer-incremental-db %t.db -analyzer-display-progress -DCHANGED -verify %s 2>&1 | FileCheck -check-prefix=CHANGED %s
+
+int helper(int x) {
+#ifdef CHANGED
+  return x + 1;
+#else
+  return x;
+#endif
+}
+
+int clean(int x) {
+  return helper(x);
+}
+
+void unrelated(void) {
+}
+
+// Functions that reported something are analyzed again, so that their
+// warnings are not lost.
+void buggy(void) {
+  int *p = 0;
+  *p = 1; // expected-warning {{Dereference of null pointer}}
+}
+
+// DB: clang-analyzer-fingerprints-1 {{[0-9a-f]+$}}
+// DB-NEXT: {{^[0-9a-f]+$}}
+// DB-NEXT: {{^[0-9a-f]+$}}
+// DB-NEXT: {{^[0-9a-f]+$}}
+
+// UNCHANGED-NOT: {{helper|clean|unrelated}}
+// UNCHANGED: ANALYZE (Syntax): {{.*}} buggy
+// UNCHANGED-NOT: {{helper|clean|unrelated}}
+// UNCHANGED: ANALYZE (Path,  Inline_Regular): {{.*}} buggy
+// UNCHANGED-NOT: {{helper|clean|unrelated}}
+
+// A change to a callee invalidates its callers too.
+// CHANGED-NOT: unrelated
+// CHANGED: ANALYZE (Syntax): {{.*}} helper
+// CHANGED: ANALYZE (Syntax): {{.*}} clean
+// CHANGED-NOT: unrelated
+// CHANGED: ANALYZE (Syntax): {{.*}} buggy
+// CHANGED-NOT: unrelated
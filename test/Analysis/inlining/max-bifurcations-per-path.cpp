@@ -0,0 +1,22 @@
+// RUN: %clang_cc1 -analyze -analyzer-checker=core,debug.ExprInspection -analyzer-config ipa=dynamic-bifurcate -analyzer-config max-bifurcations-per-path=1 -verify %s
+
+void clang_analyzer_eval(bool);
+
+class A {
+public:
+  virtual int get() { return 0; }
+};
+
+void testLimit(A *a, A *b) {
+  // The first receiver splits the path...
+  clang_analyzer_eval(a->get() == 0); // expected-warning{{TRUE}} expected-warning{{UNKNOWN}}
+
+  // ...but the second one is only inlined, on both paths.
+  clang_analyzer_eval(b->get() == 0); // expected-warning{{TRUE}}
+}
+
+void testSameReceiver(A *a) {
+  // Calls on a receiver that already split the path still follow it.
+  clang_analyzer_eval(a->get() == 0); // expected-warning{{TRUE}} expected-warning{{UNKNOWN}}
+  clang_analyzer_eval(a->get() == 0); // expected-warning{{TRUE}} expected-warning{{UNKNOWN}}
+}
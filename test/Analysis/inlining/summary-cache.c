@@ -0,0 +1,40 @@
+// RUN: rm -f %t.summaries
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -verify %s
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -analyzer-summary-cache %t.summaries -DEXHAUST -verify %s
+// RUN: FileCheck -check-prefix=FILE -input-file=%t.summaries %s
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -analyzer-summary-cache %t.summaries -DCACHED -verify %s
+
+int count(int n) {
+  int i;
+  for (i = 0; i < n; ++i)
+    ;
+  return i;
+}
+
+#ifdef EXHAUST
+// expected-no-diagnostics
+
+// Inlining the call exhausts the block visit budget, and the decision not to
+// inline count() is recorded for other translation units.
+int exhaust() {
+  return count(100);
+}
+#else
+#ifndef CACHED
+// expected-no-diagnostics
+#endif
+
+void test() {
+  int *p = 0;
+  // When the call is inlined, the analyzer knows it returns 2. When it was
+  // found not worth inlining by an earlier run, the result is unknown.
+  if (count(2) != 2)
+    *p = 1;
+#ifdef CACHED
+  // expected-warning@-2 {{Dereference of null pointer}}
+#endif
+}
+#endif
+
+// FILE: clang-analyzer-summaries-1 {{[0-9a-f]+$}}
+// FILE-NEXT: {{^[0-9a-f]+ b$}}
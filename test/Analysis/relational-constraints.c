@@ -0,0 +1,42 @@
+// RUN: %clang_cc1 -analyze -analyzer-checker=core,debug.ExprInspection -analyzer-constraints=relational -verify %s
+
+void clang_analyzer_eval(int);
+
+void compare(int a, int b) {
+  if (a < b) {
+    clang_analyzer_eval(a < b); // expected-warning{{TRUE}}
+    clang_analyzer_eval(b > a); // expected-warning{{TRUE}}
+    clang_analyzer_eval(a <= b); // expected-warning{{TRUE}}
+    clang_analyzer_eval(a != b); // expected-warning{{TRUE}}
+    clang_analyzer_eval(a == b); // expected-warning{{FALSE}}
+    clang_analyzer_eval(b <= a); // expected-warning{{FALSE}}
+  } else {
+    clang_analyzer_eval(a >= b); // expected-warning{{TRUE}}
+    clang_analyzer_eval(b > a); // expected-warning{{FALSE}}
+  }
+}
+
+void narrow(int a, int b) {
+  if (a <= b && a != b)
+    clang_analyzer_eval(a < b); // expected-warning{{TRUE}}
+}
+
+void ranges(int a, int b) {
+  if (a > 10 && b < 5)
+    clang_analyzer_eval(a > b); // expected-warning{{TRUE}}
+}
+
+void pruned(int a, int b) {
+  int x = 0;
+  if (a < b)
+    x = 1;
+  if (b <= a)
+    return;
+  clang_analyzer_eval(x == 1); // expected-warning{{TRUE}}
+}
+
+void mixedTypes(int a, unsigned b) {
+  // The casts between the types aren't part of the symbols.
+  if (a < b)
+    clang_analyzer_eval(b > a); // expected-warning{{UNKNOWN}}
+}
@@ -0,0 +1,71 @@
+// RUN: %clang_cc1 -analyze -analyzer-checker=core,debug.ExprInspection -analyzer-config ipa=none -analyzer-config side-effect-summaries=true -verify %s
+// RUN: %clang_cc1 -analyze -analyzer-checker=core,debug.ExprInspection -analyzer-config ipa=none -DNO_SUMMARIES -verify %s
+
+void clang_analyzer_eval(int);
+
+int global;
+
+int readGlobal(void) { return global; }
+
+int sum(int *p, int n) {
+  int s = 0;
+  for (int i = 0; i < n; ++i)
+    s += p[i];
+  return s;
+}
+
+void touchLocals(void) {
+  int a[2];
+  struct { int x; } s;
+  a[0] = 1;
+  s.x = a[0];
+}
+
+int callsPure(int *p) { return sum(p, 2) + readGlobal(); }
+
+void writeGlobal(void) { global = 1; }
+void writeThrough(int *p) { *p = 1; }
+void callsWriter(int *p) { writeThrough(p); }
+void callsUnknown(int *p);
+int recursive(int *p, int n) { return n ? recursive(p, n - 1) : *p; }
+int *identity(int *p) { return p; }
+
+void testPure(int *p) {
+  global = 0;
+  *p = 0;
+  readGlobal();
+  sum(p, 4);
+  touchLocals();
+  callsPure(p);
+#ifdef NO_SUMMARIES
+  clang_analyzer_eval(global == 0); // expected-warning{{UNKNOWN}}
+  clang_analyzer_eval(*p == 0); // expected-warning{{UNKNOWN}}
+#else
+  clang_analyzer_eval(global == 0); // expected-warning{{TRUE}}
+  clang_analyzer_eval(*p == 0); // expected-warning{{TRUE}}
+#endif
+}
+
+void testWriters(int *p) {
+  global = 0;
+  writeGlobal();
+  clang_analyzer_eval(global == 0); // expected-warning{{UNKNOWN}}
+
+  *p = 0;
+  callsWriter(p);
+  clang_analyzer_eval(*p == 0); // expected-warning{{UNKNOWN}}
+
+  *p = 0;
+  callsUnknown(p);
+  clang_analyzer_eval(*p == 0); // expected-warning{{UNKNOWN}}
+
+  // Recursive functions are assumed to have side effects.
+  *p = 0;
+  recursive(p, 3);
+  clang_analyzer_eval(*p == 0); // expected-warning{{UNKNOWN}}
+
+  // Pointer results are always invalidated, since they may alias.
+  *p = 0;
+  identity(p);
+  clang_analyzer_eval(*p == 0); // expected-warning{{UNKNOWN}}
+}
@@ -0,0 +1,58 @@
+// RUN: %clang_cc1 -triple x86_64-linux-gnu -emit-llvm %s -o - | FileCheck %s -check-prefix=NOCX16
+// RUN: %clang_cc1 -triple x86_64-linux-gnu -target-feature +cx16 -emit-llvm %s -o - | FileCheck %s -check-prefix=CX16
+// RUN: %clang_cc1 -triple i686-linux-gnu -emit-llvm %s -o - | FileCheck %s -check-prefix=I686
+
+// Atomic operations are done inline when the target can do operations of
+// their size, and the object is aligned to its size, either by its type or
+// by the declaration of the variable it is.
+
+typedef struct { long a, b; } pair;
+
+_Atomic(pair) atomic_pair;
+pair plain_pair;
+pair aligned_pair __attribute__((aligned(16)));
+long long ll;
+long long aligned_ll __attribute__((aligned(8)));
+char aligned_char __attribute__((aligned(4)));
+
+#ifdef __x86_64__
+__int128 i128;
+
+void test_int128(__int128 desired) {
+  // NOCX16: define void @test_int128
+  // NOCX16: call void @__atomic_load(i64 16, i8* bitcast (i128* @i128 to i8*)
+  // NOCX16: call zeroext i1 @__atomic_compare_exchange(i64 16, i8* bitcast (i128* @i128 to i8*)
+  // CX16: define void @test_int128
+  // CX16: load atomic i128* @i128 seq_cst
+  // CX16: cmpxchg i128* @i128
+  __int128 expected = __atomic_load_n(&i128, 5);
+  __atomic_compare_exchange_n(&i128, &expected, desired, 0, 5, 5);
+}
+#endif
+
+void test_pair(void) {
+  pair p;
+  // NOCX16: define void @test_pair
+  // NOCX16: call void @__atomic_load(i64 16, i8* bitcast ({{.*}} @atomic_pair to i8*)
+  // NOCX16: call void @__atomic_load(i64 16, i8* bitcast ({{.*}} @plain_pair to i8*)
+  // NOCX16: call void @__atomic_load(i64 16, i8* bitcast ({{.*}} @aligned_pair to i8*)
+  // CX16: define void @test_pair
+  // CX16: load atomic i128* bitcast ({{.*}} @atomic_pair to i128*) seq_cst
+  // The type of plain_pair is only aligned to 8 bytes.
+  // CX16: call void @__atomic_load(i64 16, i8* bitcast ({{.*}} @plain_pair to i8*)
+  // CX16: load atomic i128* bitcast ({{.*}} @aligned_pair to i128*) seq_cst
+  p = __c11_atomic_load(&atomic_pair, 5);
+  __atomic_load(&plain_pair, &p, 5);
+  __atomic_load(&aligned_pair, &p, 5);
+}
+
+void test_aligned_variables(void) {
+  // I686: define void @test_aligned_variables
+  // long long is only aligned to 4 bytes on i686.
+  // I686: call i64 @__atomic_load_8(i8* bitcast (i64* @ll to i8*)
+  // I686: load atomic i64* @aligned_ll seq_cst
+  // I686: load atomic i8* @aligned_char seq_cst, align 4
+  (void)__atomic_load_n(&ll, 5);
+  (void)__atomic_load_n(&aligned_ll, 5);
+  (void)__atomic_load_n(&aligned_char, 5);
+}
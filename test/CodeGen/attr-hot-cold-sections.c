@@ -0,0 +1,34 @@
+// RUN: %clang_cc1 -triple x86_64-linux-gnu -freorder-functions -emit-llvm -o - %s | FileCheck %s
+// RUN: %clang_cc1 -triple x86_64-linux-gnu -freorder-functions -ffunction-sections -emit-llvm -o - %s | FileCheck -check-prefix=FUNCTION-SECTIONS %s
+// RUN: %clang_cc1 -triple x86_64-linux-gnu -emit-llvm -o - %s | FileCheck -check-prefix=NO-REORDER %s
+// RUN: %clang_cc1 -triple x86_64-apple-darwin10 -freorder-functions -emit-llvm -o - %s | FileCheck -check-prefix=NO-REORDER %s
+
+// NO-REORDER-NOT: section ".text
+
+// CHECK: define void @hot() {{.*}}section ".text.hot"
+// FUNCTION-SECTIONS: define void @hot() {{.*}}section ".text.hot.hot"
+__attribute__((hot)) void hot(void) {}
+
+// CHECK: define void @cold() {{.*}}section ".text.unlikely"
+// FUNCTION-SECTIONS: define void @cold() {{.*}}section ".text.unlikely.cold"
+__attribute__((cold)) void cold(void) {}
+
+// An explicit section wins.
+// CHECK: define void @cold_in_section() {{.*}}section "foo"
+__attribute__((cold, section("foo"))) void cold_in_section(void) {}
+
+// Functions that are weak for the linker keep their own sections.
+// CHECK: define weak void @weak_hot()
+// CHECK-NOT: section
+// CHECK: }
+__attribute__((hot, weak)) void weak_hot(void) {}
+
+// CHECK: define void @plain()
+// CHECK-NOT: section
+// CHECK: }
+void plain(void) {}
+
+// Deferred definitions come last.
+// CHECK: define internal void @static_cold() {{.*}}section ".text.unlikely"
+__attribute__((cold)) static void static_cold(void) {}
+void use_static_cold(void) { static_cold(); }
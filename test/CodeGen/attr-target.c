@@ -0,0 +1,16 @@
+// RUN: %clang_cc1 -triple x86_64-linux-gnu -target-cpu x86-64 -emit-llvm %s -o - | FileCheck %s
+
+int baz(int a) { return 4; }
+
+int __attribute__((target("avx,sse4.2"))) foo(int a) { return 4; }
+
+int __attribute__((target("no-sse2"))) bar(int a) { return 4; }
+
+// CHECK: define i32 @baz(i32 %a) #0
+// CHECK: define i32 @foo(i32 %a) #1
+// CHECK: define i32 @bar(i32 %a) #2
+// CHECK-NOT: attributes #0 = {{.*}}"target-features"
+// The attribute adds to the features of the command line, and enabling a
+// feature enables the ones it implies.
+// CHECK: attributes #1 = {{.*}}"target-cpu"="x86-64" "target-features"="{{.*}}+avx{{.*}}+sse3{{.*}}+sse42{{.*}}"
+// CHECK: attributes #2 = {{.*}}"target-features"="{{.*}}-sse2{{.*}}"
@@ -0,0 +1,80 @@
+// RUN: %clang_cc1 %s -O3 -triple=x86_64-apple-darwin -target-feature +avx512f -target-feature +avx512cd -emit-llvm -o - | FileCheck %s
+
+// Don't include mm_malloc.h, it's system specific.
+#define __MM_MALLOC_H
+
+#include <immintrin.h>
+
+__m512 test_mm512_sqrt_ps(__m512 a) {
+  // CHECK: @llvm.sqrt.v16f32
+  return _mm512_sqrt_ps(a);
+}
+
+__m512d test_mm512_fmadd_pd(__m512d a, __m512d b, __m512d c) {
+  // CHECK: @llvm.fma.v8f64
+  return _mm512_fmadd_pd(a, b, c);
+}
+
+__m512 test_mm512_min_ps(__m512 a, __m512 b) {
+  // CHECK: fcmp olt <16 x float>
+  // CHECK: select <16 x i1>
+  return _mm512_min_ps(a, b);
+}
+
+__m512i test_mm512_max_epu32(__m512i a, __m512i b) {
+  // CHECK: icmp ugt <16 x i32>
+  // CHECK: select <16 x i1>
+  return _mm512_max_epu32(a, b);
+}
+
+__m512i test_mm512_min_epi64(__m512i a, __m512i b) {
+  // CHECK: icmp slt <8 x i64>
+  // CHECK: select <8 x i1>
+  return _mm512_min_epi64(a, b);
+}
+
+__m512i test_mm512_add_epi32(__m512i a, __m512i b) {
+  // CHECK: add <16 x i32>
+  return _mm512_add_epi32(a, b);
+}
+
+__m512 test_mm512_cvtepi32_ps(__m512i a) {
+  // CHECK: sitofp <16 x i32> {{.*}} to <16 x float>
+  return _mm512_cvtepi32_ps(a);
+}
+
+__mmask16 test_mm512_cmp_ps_mask(__m512 a, __m512 b) {
+  // CHECK: fcmp ole <16 x float>
+  // CHECK: bitcast <16 x i1> {{.*}} to i16
+  return _mm512_cmp_ps_mask(a, b, _CMP_LE_OS);
+}
+
+__mmask8 test_mm512_cmp_pd_mask(__m512d a, __m512d b) {
+  // CHECK: fcmp uno <8 x double>
+  // CHECK: bitcast <8 x i1> {{.*}} to i8
+  return _mm512_cmp_pd_mask(a, b, _CMP_UNORD_Q);
+}
+
+__mmask16 test_mm512_cmpgt_epi32_mask(__m512i a, __m512i b) {
+  // CHECK: icmp sgt <16 x i32>
+  // CHECK: bitcast <16 x i1> {{.*}} to i16
+  return _mm512_cmpgt_epi32_mask(a, b);
+}
+
+__m512 test_mm512_mask_add_ps(__m512 w, __mmask16 u, __m512 a, __m512 b) {
+  // CHECK: fadd <16 x float>
+  // CHECK: bitcast i16 {{.*}} to <16 x i1>
+  // CHECK: select <16 x i1>
+  return _mm512_mask_add_ps(w, u, a, b);
+}
+
+__m512i test_mm512_maskz_mov_epi64(__mmask8 u, __m512i a) {
+  // CHECK: bitcast i8 {{.*}} to <8 x i1>
+  // CHECK: select <8 x i1>
+  return _mm512_maskz_mov_epi64(u, a);
+}
+
+__m512i test_mm512_lzcnt_epi32(__m512i a) {
+  // CHECK: @llvm.ctlz.v16i32({{.*}}, i1 false)
+  return _mm512_lzcnt_epi32(a);
+}
@@ -0,0 +1,65 @@
+// RUN: %clang_cc1 -triple x86_64-apple-darwin10 -O1 -disable-llvm-optzns -emit-llvm -o - %s | FileCheck %s
+// RUN: %clang_cc1 -triple x86_64-apple-darwin10 -emit-llvm -o - %s | FileCheck %s -check-prefix=O0
+
+// CHECK-LABEL: @test_assume(
+// O0-LABEL: @test_assume(
+int test_assume(int x) {
+  // CHECK: [[CMP:%.*]] = icmp sgt i32 {{.*}}, 0
+  // CHECK: br i1 [[CMP]], label %assume.cont, label %assume.violated
+  // CHECK: assume.violated:
+  // CHECK-NEXT: unreachable
+  // O0-NOT: icmp
+  // O0-NOT: assume.violated
+  // O0: ret i32
+  __builtin_assume(x > 0);
+  return x / 2;
+}
+
+int f(void);
+
+// The condition isn't evaluated when it has side effects.
+// CHECK-LABEL: @test_assume_side_effects(
+void test_assume_side_effects(void) {
+  // CHECK-NOT: call i32 @f
+  // CHECK: ret void
+  __builtin_assume(f());
+}
+
+// CHECK-LABEL: @test_assume_aligned(
+float *test_assume_aligned(float *p) {
+  // CHECK: [[INT:%.*]] = ptrtoint float* {{.*}} to i64
+  // CHECK: [[MASKED:%.*]] = and i64 [[INT]], 31
+  // CHECK: [[COND:%.*]] = icmp eq i64 [[MASKED]], 0
+  // CHECK: br i1 [[COND]], label %assume.cont, label %assume.violated
+  return __builtin_assume_aligned(p, 32);
+}
+
+// CHECK-LABEL: @test_assume_aligned_offset(
+char *test_assume_aligned_offset(char *p) {
+  // CHECK: [[INT:%.*]] = ptrtoint i8* {{.*}} to i64
+  // CHECK: [[OFF:%.*]] = sub i64 [[INT]], 4
+  // CHECK: [[MASKED:%.*]] = and i64 [[OFF]], 15
+  // CHECK: icmp eq i64 [[MASKED]], 0
+  return __builtin_assume_aligned(p, 16, 4);
+}
+
+void *my_aligned_alloc(int size) __attribute__((assume_aligned(64)));
+void *my_alloc(int alignment, int size) __attribute__((alloc_align(1)));
+
+// CHECK-LABEL: @test_assume_aligned_attr(
+void *test_assume_aligned_attr(void) {
+  // CHECK: [[CALL:%.*]] = call i8* @my_aligned_alloc(i32 100)
+  // CHECK: ptrtoint i8* [[CALL]] to i64
+  // CHECK: and i64 {{.*}}, 63
+  return my_aligned_alloc(100);
+}
+
+// CHECK-LABEL: @test_alloc_align_attr(
+void *test_alloc_align_attr(int a) {
+  // CHECK: [[CALL:%.*]] = call i8* @my_alloc(i32 [[A:%.*]], i32 100)
+  // CHECK: [[INT:%.*]] = ptrtoint i8* [[CALL]] to i64
+  // CHECK: [[ALIGN:%.*]] = zext i32 [[A]] to i64
+  // CHECK: [[MASK:%.*]] = sub i64 [[ALIGN]], 1
+  // CHECK: and i64 [[INT]], [[MASK]]
+  return my_alloc(a, 100);
+}
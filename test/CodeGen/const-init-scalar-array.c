@@ -0,0 +1,32 @@
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -emit-llvm -o - %s | FileCheck %s
+
+// Arrays of literals are emitted directly as data arrays; check that the
+// values still go through the usual conversions.
+
+// CHECK: @i = global [5 x i32] [i32 1, i32 -2, i32 3, i32 0, i32 0]
+int i[5] = { 1, -2, +3 };
+
+// CHECK: @uc = global [4 x i8] c"\01\FF,a"
+unsigned char uc[] = { 1, -1, 300, 'a' };
+
+// CHECK: @s = global [3 x i16] [i16 -1, i16 0, i16 7]
+short s[] = { 65535, [2] = 7 };
+
+// CHECK: @ll = global [2 x i64] [i64 -9223372036854775807, i64 4294967295]
+long long ll[] = { -9223372036854775807LL, 4294967295U };
+
+// CHECK: @f = global [4 x float] [float 1.500000e+00, float -2.000000e+00, float 3.000000e+00, float 0.000000e+00]
+float f[4] = { 1.5, -2.0f, 3 };
+
+// CHECK: @d = global [2 x double] [double -5.000000e-01, double 4.000000e+00]
+double d[] = { -0.5, 4 };
+
+// CHECK: @m = global [3 x [2 x i32]] {{\[}}[2 x i32] [i32 1, i32 2], [2 x i32] [i32 3, i32 0], [2 x i32] zeroinitializer]
+int m[3][2] = { { 1, 2 }, { 3 } };
+
+// Anything else still goes through the constant evaluator.
+enum { E = 5 };
+// CHECK: @e = global [2 x i32] [i32 5, i32 6]
+int e[] = { E, E + 1 };
+// CHECK: @b = global [2 x i8] c"\01\00"
+_Bool b[] = { 2, 0 };
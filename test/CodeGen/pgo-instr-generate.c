@@ -0,0 +1,60 @@
+// Test the counters emitted with -fprofile-instr-generate.
+
+// RUN: %clang_cc1 -triple x86_64-apple-macosx10.9 -main-file-name pgo-instr-generate.c %s -o - -emit-llvm -fprofile-instr-generate | FileCheck %s
+
+// CHECK: @[[FOO:__llvm_pgo_ctr[0-9]*]] = internal global [3 x i64] zeroinitializer
+// CHECK: @[[LOOPS:__llvm_pgo_ctr[0-9]*]] = internal global [7 x i64] zeroinitializer
+// CHECK: @[[LOGIC:__llvm_pgo_ctr[0-9]*]] = internal global [5 x i64] zeroinitializer
+// CHECK: @[[FOONAME:.*]] = private unnamed_addr constant [4 x i8] c"foo\00"
+// CHECK: @[[LOOPSNAME:.*]] = private unnamed_addr constant [6 x i8] c"loops\00"
+// Functions with internal linkage are named after their file.
+// CHECK: @[[LOGICNAME:.*]] = private unnamed_addr constant [27 x i8] c"pgo-instr-generate.c:logic\00"
+// CHECK: @llvm.global_ctors = appending global {{.*}} @__llvm_pgo_init
+
+static int logic(int a, int b);
+
+// CHECK-LABEL: define i32 @foo(
+int foo(int x) {
+  // The entry counter.
+  // CHECK: [[ENTRY:%.*]] = load i64* {{.*}}@[[FOO]]{{.*}}i64 0, i64 0)
+  // CHECK-NEXT: add i64 [[ENTRY]], 1
+  // The true and false counters of the branch.
+  // CHECK: [[COND:%.*]] = icmp ne i32
+  // CHECK-NEXT: [[TRUE:%.*]] = zext i1 [[COND]] to i64
+  // CHECK-NEXT: [[C1:%.*]] = load i64* {{.*}}@[[FOO]]{{.*}}i64 0, i64 1)
+  // CHECK-NEXT: add i64 [[C1]], [[TRUE]]
+  // CHECK: [[NOT:%.*]] = xor i1 [[COND]], true
+  // CHECK-NEXT: [[FALSE:%.*]] = zext i1 [[NOT]] to i64
+  // CHECK-NEXT: [[C2:%.*]] = load i64* {{.*}}@[[FOO]]{{.*}}i64 0, i64 2)
+  // CHECK-NEXT: add i64 [[C2]], [[FALSE]]
+  // CHECK: br i1 [[COND]]
+  if (x)
+    return logic(x, 1);
+  return 0;
+}
+
+// CHECK-LABEL: define void @loops(
+void loops(int n) {
+  // CHECK: load i64* {{.*}}@[[LOOPS]]{{.*}}i64 0, i64 2)
+  for (int i = 0; i < n; ++i) {}
+  // CHECK: load i64* {{.*}}@[[LOOPS]]{{.*}}i64 0, i64 4)
+  while (n--) {}
+  // CHECK: load i64* {{.*}}@[[LOOPS]]{{.*}}i64 0, i64 6)
+  do {} while (n > 0);
+}
+
+// Each operand of && has a branch of its own.
+// CHECK-LABEL: define internal i32 @logic(
+static int logic(int a, int b) {
+  // CHECK: load i64* {{.*}}@[[LOGIC]]{{.*}}i64 0, i64 2)
+  // CHECK: load i64* {{.*}}@[[LOGIC]]{{.*}}i64 0, i64 4)
+  return a && b ? a : b;
+}
+
+// CHECK-LABEL: define internal void @__llvm_pgo_writeout()
+// CHECK: call void @llvm_pgo_emit(i8* {{.*}}@[[FOONAME]]{{.*}}, i32 3, i64* {{.*}}@[[FOO]]
+// CHECK: call void @llvm_pgo_emit(i8* {{.*}}@[[LOOPSNAME]]{{.*}}, i32 7, i64* {{.*}}@[[LOOPS]]
+// CHECK: call void @llvm_pgo_emit(i8* {{.*}}@[[LOGICNAME]]{{.*}}, i32 5, i64* {{.*}}@[[LOGIC]]
+
+// CHECK-LABEL: define internal void @__llvm_pgo_init()
+// CHECK: call void @llvm_pgo_register_writeout_function(void ()* @__llvm_pgo_writeout)
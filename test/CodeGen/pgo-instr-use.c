@@ -0,0 +1,50 @@
+// Test the branch weights and function attributes of -fprofile-instr-use.
+
+// RUN: %clang_cc1 -triple x86_64-apple-macosx10.9 -main-file-name pgo-instr-use.c %s -o - -emit-llvm -fprofile-instr-use=%S/Inputs/pgo-instr-use.profdata | FileCheck %s
+// RUN: %clang_cc1 -triple x86_64-apple-macosx10.9 -main-file-name pgo-instr-use.c %s -o /dev/null -emit-llvm -fprofile-instr-use=%S/Inputs/pgo-instr-use.profdata 2>&1 | FileCheck -check-prefix=WARN %s
+// RUN: not %clang_cc1 %s -o /dev/null -emit-llvm -fprofile-instr-use=%t.missing 2>&1 | FileCheck -check-prefix=MISSING %s
+
+// WARN: warning: profile data may be out of date: of 4 functions, 1 has no data and 1 has mismatched data that will be ignored
+// MISSING: error: could not read profile data file '{{.*}}.missing'
+
+// The most called function is hinted for inlining.
+// CHECK-LABEL: define i32 @hot(i32 %x) #[[HOT:[0-9]+]]
+int hot(int x) {
+  // CHECK: br i1 %{{.*}}, label %{{.*}}, label %{{.*}}, !prof ![[HOTW:[0-9]+]]
+  if (x)
+    return 1;
+  return 0;
+}
+
+// A function called a hundredth as often as the hottest one is cold.
+// CHECK-LABEL: define void @cold_fn(i32 %n) #[[COLD:[0-9]+]]
+void cold_fn(int n) {
+  // CHECK: br i1 %{{.*}}, label %{{.*}}, label %{{.*}}, !prof ![[COLDW:[0-9]+]]
+  while (n--) {}
+}
+
+// The profile has a different number of counters for this function, so the
+// function changed and its counts are ignored.
+// CHECK-LABEL: define i32 @stale(
+int stale(int x) {
+  // CHECK-NOT: !prof
+  // CHECK: ret i32
+  if (x)
+    return 1;
+  return 0;
+}
+
+// CHECK-LABEL: define i32 @missing(
+int missing(int x) {
+  // CHECK-NOT: !prof
+  // CHECK: ret i32
+  return x ? 1 : 0;
+}
+
+// CHECK: attributes #[[HOT]] = { inlinehint
+// CHECK: attributes #[[COLD]] = { cold
+
+// Every count is one more than in the profile, so that branches which were
+// never taken still have a weight.
+// CHECK: ![[HOTW]] = metadata !{metadata !"branch_weights", i32 91, i32 11}
+// CHECK: ![[COLDW]] = metadata !{metadata !"branch_weights", i32 6, i32 2}
@@ -0,0 +1,49 @@
+// RUN: %clang_cc1 -std=c++11 -emit-llvm %s -o - | FileCheck %s
+
+// CHECK-LABEL: define void @_Z4testPii(
+void test(int *List, int Length) {
+  int i = 0;
+
+#pragma clang loop vectorize(enable) vectorize_width(4)
+  while (i < Length) {
+    // CHECK: br label {{.*}}, !llvm.loop ![[LOOP_1:[0-9]+]]
+    List[i] = i * 2;
+    i++;
+  }
+
+#pragma clang loop interleave_count(2) unroll(disable)
+  do {
+    // CHECK: br i1 {{.*}}, label {{.*}}, label {{.*}}, !llvm.loop ![[LOOP_2:[0-9]+]]
+    List[i] = i * 2;
+    i++;
+  } while (i < Length);
+
+#pragma clang loop unroll(enable) unroll_count(8)
+  for (int j = 0; j < Length; j++) {
+    // CHECK: br label {{.*}}, !llvm.loop ![[LOOP_3:[0-9]+]]
+    List[j] = j * 2;
+  }
+
+#pragma clang loop vectorize(disable)
+  for (int &x : (int(&)[4])*List)
+    // CHECK: br label {{.*}}, !llvm.loop ![[LOOP_4:[0-9]+]]
+    x = 0;
+
+  // Loops without hints have no loop identifier.
+  for (int j = 0; j < Length; j++)
+    List[j] = 0;
+  // CHECK-NOT: !llvm.loop
+  // CHECK: ret void
+}
+
+// CHECK: ![[LOOP_1]] = metadata !{metadata ![[LOOP_1]], metadata ![[VECTORIZE_ENABLE:[0-9]+]], metadata ![[WIDTH_4:[0-9]+]]}
+// CHECK: ![[VECTORIZE_ENABLE]] = metadata !{metadata !"llvm.vectorizer.enable", i1 true}
+// CHECK: ![[WIDTH_4]] = metadata !{metadata !"llvm.vectorizer.width", i32 4}
+// CHECK: ![[LOOP_2]] = metadata !{metadata ![[LOOP_2]], metadata ![[INTERLEAVE_2:[0-9]+]], metadata ![[UNROLL_DISABLE:[0-9]+]]}
+// CHECK: ![[INTERLEAVE_2]] = metadata !{metadata !"llvm.vectorizer.unroll", i32 2}
+// CHECK: ![[UNROLL_DISABLE]] = metadata !{metadata !"llvm.loop.unroll.enable", i1 false}
+// CHECK: ![[LOOP_3]] = metadata !{metadata ![[LOOP_3]], metadata ![[UNROLL_ENABLE:[0-9]+]], metadata ![[UNROLL_8:[0-9]+]]}
+// CHECK: ![[UNROLL_ENABLE]] = metadata !{metadata !"llvm.loop.unroll.enable", i1 true}
+// CHECK: ![[UNROLL_8]] = metadata !{metadata !"llvm.loop.unroll.count", i32 8}
+// CHECK: ![[LOOP_4]] = metadata !{metadata ![[LOOP_4]], metadata ![[VECTORIZE_DISABLE:[0-9]+]]}
+// CHECK: ![[VECTORIZE_DISABLE]] = metadata !{metadata !"llvm.vectorizer.enable", i1 false}
@@ -0,0 +1,26 @@
+// Test the function attributes of -fprofile-sample-use.
+
+// RUN: %clang_cc1 -triple x86_64-apple-macosx10.9 %s -o - -emit-llvm -fprofile-sample-use=%S/Inputs/sample-profile.prof | FileCheck %s
+// RUN: not %clang_cc1 %s -o /dev/null -emit-llvm -fprofile-sample-use=%t.missing 2>&1 | FileCheck -check-prefix=MISSING %s
+
+// MISSING: error: could not read profile data file '{{.*}}.missing'
+
+// CHECK-LABEL: define i32 @hot(i32 %x) #[[HOT:[0-9]+]]
+int hot(int x) { return x + 1; }
+
+// CHECK-LABEL: define i32 @warm(i32 %x) #[[WARM:[0-9]+]]
+int warm(int x) { return x + 2; }
+
+// CHECK-LABEL: define i32 @cold_fn(i32 %x) #[[COLD:[0-9]+]]
+int cold_fn(int x) { return x + 3; }
+
+// A function without samples is left alone.
+// CHECK-LABEL: define i32 @unsampled(i32 %x) #[[WARM]]
+int unsampled(int x) { return x + 4; }
+
+// CHECK: attributes #[[HOT]] = { inlinehint
+// CHECK: attributes #[[WARM]] = { nounwind
+// CHECK: attributes #[[COLD]] = { cold
+
+// The samples are mapped to the code through its line table.
+// CHECK: !llvm.dbg.cu
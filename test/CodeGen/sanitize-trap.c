@@ -0,0 +1,10 @@
+// RUN: %clang_cc1 -triple x86_64-apple-darwin10 -fsanitize=signed-integer-overflow,shift -fsanitize-trap=shift %s -emit-llvm -o - | FileCheck %s
+
+// CHECK-LABEL: @f(
+int f(int x, int y) {
+  // CHECK: @llvm.sadd.with.overflow.i32
+  // CHECK: call void @__ubsan_handle_add_overflow(
+  // CHECK: call void @llvm.trap()
+  // CHECK-NOT: __ubsan_handle_shift_out_of_bounds
+  return (x + y) << y;
+}
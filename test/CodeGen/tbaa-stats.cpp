@@ -0,0 +1,36 @@
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -O1 -disable-llvm-optzns -struct-path-tbaa -emit-llvm -o - %s | FileCheck %s
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -O1 -disable-llvm-optzns -struct-path-tbaa -emit-llvm -o /dev/null -print-stats %s 2>&1 | FileCheck -check-prefix=STATS %s
+
+// Each struct gets one !tbaa.struct node however often it is copied, and
+// a struct that can't have one is not looked at again.
+
+struct Inner { int a; float b; };
+struct Outer { Inner i; int c; };
+struct Base { int x; };
+struct Derived : Base { int y; };
+
+// CHECK-LABEL: define void @_Z5copy1P5OuterS0_
+// CHECK: call void @llvm.memcpy{{.*}}, !tbaa.struct [[TS:!.*]]
+// CHECK: call void @llvm.memcpy{{.*}}, !tbaa.struct [[TS]]
+void copy1(Outer *d, Outer *s) {
+  *d = *s;
+  *d = *s;
+}
+
+// CHECK-LABEL: define void @_Z5copy2P5OuterS0_
+// CHECK: call void @llvm.memcpy{{.*}}, !tbaa.struct [[TS]]
+void copy2(Outer *d, Outer *s) {
+  *d = *s;
+}
+
+// CHECK-LABEL: define void @_Z5copy3P7DerivedS0_
+// CHECK: call void @llvm.memcpy
+// CHECK-NOT: !tbaa.struct
+// CHECK: ret void
+void copy3(Derived *d, Derived *s) {
+  *d = *s;
+  *d = *s;
+}
+
+// STATS: *** CodeGen Stats:
+// STATS: {{[0-9]+}} TBAA type nodes, {{[0-9]+}} access tags and 1 !tbaa.struct nodes created.
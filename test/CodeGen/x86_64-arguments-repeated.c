@@ -0,0 +1,32 @@
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -emit-llvm -o - %s | FileCheck %s
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -emit-llvm -o - %s -target-feature +avx | FileCheck %s -check-prefix=AVX
+
+// The classification of a record is remembered from one signature to the
+// next; check that it still depends on the offset of the record and on
+// whether the argument is named.
+
+struct S { float a, b; int c; };
+struct T { int x; struct S s; };
+
+// CHECK: define { <2 x float>, i32 } @f0(<2 x float> %{{.*}}, i32 %{{.*}})
+struct S f0(struct S s) { return s; }
+// CHECK: define { i64, i64 } @f1(i64 %{{.*}}, i64 %{{.*}})
+struct T f1(struct T t) { return t; }
+// CHECK: define void @f2(<2 x float> %{{.*}}, i32 %{{.*}}, i64 %{{.*}}, i64 %{{.*}})
+void f2(struct S s, struct T t) {}
+
+typedef float __m256 __attribute__ ((__vector_size__ (32)));
+typedef struct { __m256 m; } s256;
+
+void f3(s256 x);
+void f4(int n, ...);
+
+// AVX: define void @test
+// AVX: call void @f3(<8 x float> %{{.*}})
+// AVX: call void {{.*}}@f4(i32 0, %struct.s256* byval align 32 %{{.*}})
+// AVX: call void @f3(<8 x float> %{{.*}})
+void test(s256 *p) {
+  f3(*p);
+  f4(0, *p);
+  f3(*p);
+}
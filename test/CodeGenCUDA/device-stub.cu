@@ -1,7 +1,14 @@
-// RUN: %clang_cc1 -emit-llvm %s -o - | FileCheck %s
+// RUN: %clang_cc1 -emit-llvm %s -o - | FileCheck %s --check-prefix=CHECK --check-prefix=NOGPUBIN
+// RUN: %clang_cc1 -emit-llvm %s -fcuda-include-gpubinary %s -o - | FileCheck %s --check-prefix=CHECK --check-prefix=GPUBIN
 
 #include "../SemaCUDA/cuda.h"
 
+// The GPU binary is wrapped for the runtime, and its handle kept.
+// GPUBIN: @__cuda_fatbin_wrapper = internal constant { i32, i32, i8*, i8* } { i32 1180844977, i32 1, i8* {{.*}}, i8* null }
+// GPUBIN: @__cuda_gpubin_handle = internal global i8** null
+// GPUBIN: @llvm.global_ctors = appending global {{.*}}@__cuda_module_ctor
+// GPUBIN: @llvm.global_dtors = appending global {{.*}}@__cuda_module_dtor
+
 // Test that we build the correct number of calls to cudaSetupArgument followed
 // by a call to cudaLaunch.
 
@@ -11,3 +18,18 @@
 // CHECK: call{{.*}}cudaSetupArgument
 // CHECK: call{{.*}}cudaLaunch
 __global__ void kernelfunc(int i, int j, int k) {}
+
+// The kernels are registered with the GPU binary by the module constructor.
+// GPUBIN: define internal void @__cuda_register_kernels(i8**
+// GPUBIN: call{{.*}}@__cudaRegisterFunction(i8** %0, {{.*}}kernelfunc
+// GPUBIN: define internal void @__cuda_module_ctor()
+// GPUBIN: call{{.*}}@__cudaRegisterFatBinary({{.*}}@__cuda_fatbin_wrapper
+// GPUBIN: store{{.*}}@__cuda_gpubin_handle
+// GPUBIN: call void @__cuda_register_kernels
+// GPUBIN: define internal void @__cuda_module_dtor()
+// GPUBIN: load{{.*}}@__cuda_gpubin_handle
+// GPUBIN: call void @__cudaUnregisterFatBinary
+
+// Without a GPU binary there is nothing to register.
+// NOGPUBIN-NOT: __cuda_register_kernels
+// NOGPUBIN-NOT: __cudaRegisterFatBinary
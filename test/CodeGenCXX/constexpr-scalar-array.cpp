@@ -0,0 +1,36 @@
+// RUN: %clang_cc1 -std=c++11 -triple x86_64-unknown-unknown -emit-llvm -o - %s | FileCheck %s
+
+// Arrays of scalars computed by the constant evaluator are emitted directly
+// as data arrays; check the elements, the filler and the fallbacks.
+
+template<typename T, int N> struct Table { T elems[N]; };
+
+constexpr Table<int, 6> squares() {
+  return Table<int, 6>{ { 0, 1, 4, 9, 16 } };
+}
+
+// CHECK: @sq = global %struct.Table { [6 x i32] [i32 0, i32 1, i32 4, i32 9, i32 16, i32 0] }
+Table<int, 6> sq = squares();
+
+constexpr int twice(int n) { return 2 * n; }
+
+// CHECK: @uc = global [4 x i8] c"\02\FE\00\00"
+unsigned char uc[4] = { twice(1), (unsigned char)twice(-1) };
+
+// CHECK: @ll = global [3 x i64] [i64 -4, i64 42, i64 42]
+long long ll[3] = { twice(-2), [1 ... 2] = 42 };
+
+constexpr double half(double d) { return d / 2; }
+
+// CHECK: @f = global [3 x float] [float 2.500000e-01, float -1.000000e+00, float 0.000000e+00]
+float f[3] = { half(0.5), half(-2) };
+
+// CHECK: @d = global [2 x double] [double 1.500000e+00, double 0.000000e+00]
+double d[2] = { half(3) };
+
+// Addresses and booleans take the general path.
+int g;
+// CHECK: @p = global [2 x i64] [i64 ptrtoint (i32* @g to i64), i64 0]
+long p[2] = { (long)&g };
+// CHECK: @b = global [3 x i8] c"\01\00\01"
+bool b[3] = { twice(1) != 0, false, true };
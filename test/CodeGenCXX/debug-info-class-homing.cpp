@@ -0,0 +1,25 @@
+// RUN: %clang_cc1 -triple x86_64-linux-gnu -emit-llvm -g -fno-emit-class-debug-always %s -o - | FileCheck %s
+// RUN: %clang_cc1 -triple x86_64-linux-gnu -emit-llvm -g %s -o - | FileCheck -check-prefix=ALWAYS %s
+
+// With -fno-emit-class-debug-always, a dynamic class gets its full debug
+// info only in the module that emits its vtable.
+
+// CHECK-DAG: [ DW_TAG_structure_type ] [elsewhere] [line [[@LINE+2]], {{.*}} [decl]
+// ALWAYS-DAG: [ DW_TAG_structure_type ] [elsewhere] [line [[@LINE+1]], {{.*}} [def]
+struct elsewhere {
+  virtual void key();
+  int i;
+};
+
+// CHECK-DAG: [ DW_TAG_structure_type ] [here] [line [[@LINE+2]], {{.*}} [def]
+// ALWAYS-DAG: [ DW_TAG_structure_type ] [here] [line [[@LINE+1]], {{.*}} [def]
+struct here {
+  virtual void key();
+  int i;
+};
+
+// The definition of 'here' is only found to belong in this module after it
+// has been used.
+int use(elsewhere &e, here &h) { return e.i + h.i; }
+
+void here::key() {}
@@ -0,0 +1,29 @@
+// RUN: %clang_cc1 -triple x86_64-linux-gnu -emit-llvm -o - %s | FileCheck %s
+// RUN: %clang_cc1 -triple x86_64-linux-gnu -emit-llvm -o /dev/null -print-stats %s 2>&1 | FileCheck -check-prefix=STATS %s
+
+// Deferred functions are emitted only if the code emitted refers to them,
+// directly or through other deferred functions.
+inline int leaf() { return 1; }
+inline int middle() { return leaf() + 1; }
+inline int unused() { return middle(); }
+
+struct S {
+  void (*fp)();
+  int n;
+};
+inline void target() {}
+int next();
+// The constant emitter refers to target() before falling back to dynamic
+// initialization, which refers to it again.
+S s = { &target, next() };
+
+int root() { return middle(); }
+
+// CHECK-LABEL: define i32 @_Z4rootv()
+// CHECK-DAG: define linkonce_odr i32 @_Z6middlev()
+// CHECK-DAG: define linkonce_odr i32 @_Z4leafv()
+// CHECK-DAG: define linkonce_odr void @_Z6targetv()
+// CHECK-NOT: @_Z6unusedv
+
+// STATS: *** CodeGen Stats:
+// STATS-NEXT: {{[0-9]+}} deferred function bodies skipped as unused.
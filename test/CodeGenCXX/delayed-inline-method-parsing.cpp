@@ -0,0 +1,28 @@
+// RUN: %clang_cc1 -fdelayed-inline-method-parsing -triple x86_64-linux-gnu -emit-llvm -o - %s | FileCheck %s
+// RUN: %clang_cc1 -fdelayed-inline-method-parsing -triple x86_64-linux-gnu -emit-llvm -o - %s | FileCheck -check-prefix=UNUSED %s
+
+// Inline methods whose bodies are parsed at the end of the translation unit
+// are still emitted when they are used.
+struct S {
+  int unused() { return 1; }
+  int used() { return helper() + 2; }
+  int helper() { return 3; }
+  virtual int v() { return 4; }
+  S() {}
+};
+
+int f() {
+  S s;
+  return s.used();
+}
+
+// CHECK-LABEL: define i32 @_Z1fv()
+// CHECK: call void @_ZN1SC1Ev(
+// CHECK: call i32 @_ZN1S4usedEv(
+
+// CHECK-DAG: define linkonce_odr void @_ZN1SC2Ev(
+// CHECK-DAG: define linkonce_odr i32 @_ZN1S4usedEv(
+// CHECK-DAG: define linkonce_odr i32 @_ZN1S6helperEv(
+// CHECK-DAG: define linkonce_odr i32 @_ZN1S1vEv(
+
+// UNUSED-NOT: _ZN1S6unusedEv
@@ -0,0 +1,54 @@
+// RUN: %clang_cc1 -fcxx-exceptions -fexceptions -triple x86_64-linux-gnu -emit-llvm %s -o - | FileCheck %s
+
+// Landing pads skip over the cleanups between handler scopes; check that
+// they still collect every handler and note the cleanups.
+
+struct A { A(); ~A(); };
+void g();
+
+// CHECK-LABEL: define void @_Z2t1v()
+void t1() {
+  try {
+    // CHECK: invoke void @_ZN1AC1Ev
+    // CHECK: landingpad { i8*, i32 } personality
+    // CHECK-NEXT: catch i8* bitcast (i8** @_ZTIi to i8*)
+    // CHECK-NEXT: extractvalue
+    A a1;
+    try {
+      A a2;
+      A a3;
+      // CHECK: landingpad { i8*, i32 } personality
+      // CHECK-NEXT: cleanup
+      // CHECK-NEXT: catch i8* bitcast (i8** @_ZTIf to i8*)
+      // CHECK-NEXT: catch i8* bitcast (i8** @_ZTIi to i8*)
+      // CHECK-NEXT: extractvalue
+      g();
+    } catch (float) {
+    }
+  } catch (int) {
+  }
+}
+
+// CHECK-LABEL: define void @_Z2t2v()
+void t2() throw(int) {
+  A a1;
+  A a2;
+  // CHECK: landingpad { i8*, i32 } personality
+  // CHECK-NEXT: filter [1 x i8*] [i8* bitcast (i8** @_ZTIi to i8*)]
+  // CHECK-NEXT: extractvalue
+  // CHECK: landingpad { i8*, i32 } personality
+  // CHECK-NEXT: cleanup
+  // CHECK-NEXT: filter [1 x i8*] [i8* bitcast (i8** @_ZTIi to i8*)]
+  // CHECK-NEXT: extractvalue
+  g();
+}
+
+// CHECK-LABEL: define void @_Z2t3v()
+void t3() {
+  A a1;
+  A a2;
+  // CHECK: landingpad { i8*, i32 } personality
+  // CHECK-NEXT: cleanup
+  // CHECK-NEXT: extractvalue
+  g();
+}
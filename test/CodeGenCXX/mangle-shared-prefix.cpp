@@ -0,0 +1,32 @@
+// RUN: %clang_cc1 -triple x86_64-linux-gnu -emit-llvm -o - %s | FileCheck %s
+
+// Members of one class share the mangling of its prefix, which is computed
+// once and replayed with its substitutions for each of them.
+namespace ns {
+  template<typename T> struct A {
+    template<typename U> struct B {
+      void f(T, U);
+      void g(A, B);
+      static void h(U *, T *);
+    };
+  };
+}
+
+namespace std {
+  template<typename T> struct alloc {
+    void f(alloc);
+  };
+}
+
+void use(ns::A<int>::B<char> b, ns::A<int> a, std::alloc<int> s) {
+  // CHECK: call void @_ZN2ns1AIiE1BIcE1fEic(
+  b.f(1, 'a');
+  // CHECK: call void @_ZN2ns1AIiE1BIcE1gES1_S3_(
+  b.g(a, b);
+  // CHECK: call void @_ZN2ns1AIiE1BIcE1hEPcPi(
+  ns::A<int>::B<char>::h(0, 0);
+  // CHECK: call void @_ZNSt5allocIiE1fES0_(
+  s.f(s);
+  // CHECK: call void @_ZN2ns1AIiE1BIcE1fEic(
+  b.f(2, 'b');
+}
@@ -0,0 +1,21 @@
+// RUN: %clang_cc1 -triple x86_64-apple-darwin10 -fsanitize=null -fno-sanitize-recover %s -emit-llvm -o - | FileCheck %s
+// RUN: %clang_cc1 -triple x86_64-apple-darwin10 -fsanitize=null %s -emit-llvm -o - | FileCheck %s --check-prefix=RECOVER
+
+struct S {
+  int a, b;
+  int sum();
+};
+
+// The member accesses check 'this' once when a failed check aborts.
+// CHECK-LABEL: define i32 @_ZN1S3sumEv(
+// CHECK: icmp ne %struct.S* [[THIS:%.*]], null
+// CHECK: call void @__ubsan_handle_type_mismatch_abort
+// CHECK-NOT: icmp ne %struct.S* [[THIS]], null
+// CHECK: ret i32
+// RECOVER-LABEL: define i32 @_ZN1S3sumEv(
+// RECOVER: icmp ne %struct.S* [[THIS:%.*]], null
+// RECOVER: icmp ne %struct.S* [[THIS]], null
+// RECOVER: ret i32
+int S::sum() {
+  return a + b;
+}
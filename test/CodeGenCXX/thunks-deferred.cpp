@@ -0,0 +1,41 @@
+// RUN: %clang_cc1 -triple x86_64-linux-gnu -emit-llvm -o %t %s
+// RUN: FileCheck %s < %t
+// RUN: FileCheck -check-prefix=NOTHUNK %s < %t
+// RUN: %clang_cc1 -triple x86_64-linux-gnu -emit-llvm -O1 -disable-llvm-optzns -o - %s | FileCheck %s
+
+// Discardable thunks are emitted only along with a vtable that refers to
+// them.
+
+struct A { virtual void f(); };
+struct B { virtual void g(); };
+
+// The key function of C is defined elsewhere, so its vtable is not emitted
+// here, and neither is the thunk for C::g.
+struct C : A, B {
+  virtual void g();
+  virtual void h();
+};
+inline void C::g() {}
+void useC(C *c) { c->C::g(); }
+
+// CHECK-DAG: define linkonce_odr void @_ZN1C1gEv(
+// NOTHUNK-NOT: _ZThn8_N1C1gEv
+
+// D has no key function, so its vtable is emitted wherever it is used.
+struct D : A, B {
+  virtual void g() {}
+};
+void useD(D *d) { d->D::g(); }
+D *makeD() { return new D; }
+
+// CHECK-DAG: @_ZTV1D = linkonce_odr unnamed_addr constant {{.*}} @_ZThn8_N1D1gEv
+// CHECK-DAG: define linkonce_odr void @_ZN1D1gEv(
+// CHECK-DAG: define linkonce_odr void @_ZThn8_N1D1gEv(
+
+// Non-inline virtual functions still get their thunks.
+struct E : A, B {
+  virtual void g();
+};
+void E::g() {}
+
+// CHECK-DAG: define void @_ZThn8_N1E1gEv(
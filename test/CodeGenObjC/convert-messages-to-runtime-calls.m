@@ -0,0 +1,70 @@
+// RUN: %clang_cc1 %s -emit-llvm -fobjc-runtime=macosx-10.10.0 -triple x86_64-apple-macosx10.10.0 -o - | FileCheck %s --check-prefix=CALLS
+// RUN: %clang_cc1 %s -emit-llvm -fobjc-runtime=ios-8.0 -triple armv7-apple-ios8.0 -o - | FileCheck %s --check-prefix=CALLS
+// RUN: %clang_cc1 %s -emit-llvm -fobjc-runtime=macosx-10.9.0 -triple x86_64-apple-macosx10.9.0 -o - | FileCheck %s --check-prefix=MSGS
+// RUN: %clang_cc1 %s -emit-llvm -fobjc-runtime=macosx-10.10.0 -triple x86_64-apple-macosx10.10.0 -fno-objc-convert-messages-to-runtime-calls -o - | FileCheck %s --check-prefix=MSGS
+// RUN: %clang_cc1 %s -emit-llvm -fobjc-runtime=macosx-10.10.0 -triple x86_64-apple-macosx10.10.0 -fobjc-gc -o - | FileCheck %s --check-prefix=MSGS
+
+@interface NSObject
++ (id)alloc;
++ (id)alloc2;
+- (id)init;
+- (id)retain;
+- (void)release;
+- (id)autorelease;
+@end
+
+@interface NSString : NSObject
+@end
+
+// CALLS-LABEL: define {{.*}}void @test1
+// MSGS-LABEL: define {{.*}}void @test1
+void test1(id x) {
+  // CALLS: {{call|invoke}} i8* @objc_alloc
+  // CALLS-NOT: @objc_alloc
+  // CALLS: {{call|invoke}} i8* @objc_retain
+  // CALLS: {{call|invoke}} void @objc_release
+  // CALLS: {{call|invoke}} i8* @objc_autorelease
+  // MSGS: {{call|invoke}} {{.*}} @objc_msgSend
+  // MSGS: {{call|invoke}} {{.*}} @objc_msgSend
+  // MSGS: {{call|invoke}} {{.*}} @objc_msgSend
+  // MSGS: {{call|invoke}} {{.*}} @objc_msgSend
+  // MSGS: {{call|invoke}} {{.*}} @objc_msgSend
+  // MSGS-NOT: @objc_alloc
+  // MSGS-NOT: @objc_retain
+  // MSGS-NOT: @objc_release
+  // MSGS-NOT: @objc_autorelease
+  [NSObject alloc];
+  [NSObject alloc2];
+  [x retain];
+  [x release];
+  [x autorelease];
+}
+
+// Only the selectors with the standard signatures are converted.
+@interface Odd
+- (void)retain;
+- (id)release;
+@end
+
+// CALLS-LABEL: define {{.*}}void @test2
+void test2(Odd *o) {
+  // CALLS-NOT: @objc_retain
+  // CALLS-NOT: @objc_release
+  // CALLS: {{call|invoke}} {{.*}} @objc_msgSend
+  // CALLS: {{call|invoke}} {{.*}} @objc_msgSend
+  [o retain];
+  [o release];
+}
+
+// The conversion doesn't apply to super messages.
+@interface Sub : NSObject
+@end
+
+@implementation Sub
+// CALLS-LABEL: define {{.*}} @"\01+[Sub alloc]"
++ (id)alloc {
+  // CALLS-NOT: @objc_alloc
+  // CALLS: {{call|invoke}} {{.*}} @objc_msgSendSuper2
+  return [super alloc];
+}
+@end
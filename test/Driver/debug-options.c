@@ -47,6 +47,14 @@
 // RUN:        -fno-debug-types-section %s 2>&1                       \
 // RUN:        | FileCheck -check-prefix=GIGNORE %s
 //
+// RUN: %clang -### -c -g -fdebug-types-section %s 2>&1 \
+// RUN:             | FileCheck -check-prefix=GTYPES %s
+// RUN: %clang -### -c -g -fno-emit-class-debug-always %s 2>&1 \
+// RUN:             | FileCheck -check-prefix=GHOME %s
+// RUN: %clang -### -c -g -fno-emit-class-debug-always \
+// RUN:        -femit-class-debug-always %s 2>&1 \
+// RUN:             | FileCheck -check-prefix=GNOHOME %s
+//
 // G: "-cc1"
 // G: "-g"
 //
@@ -78,3 +86,11 @@
 // GLTO_NO-NOT: "-gline-tables-only"
 //
 // GIGNORE-NOT: "argument unused during compilation"
+//
+// GIGNORE-NOT: "-generate-type-units"
+//
+// GTYPES: "-backend-option" "-generate-type-units"
+//
+// GHOME: "-fno-emit-class-debug-always"
+//
+// GNOHOME-NOT: "-fno-emit-class-debug-always"
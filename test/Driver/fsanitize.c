@@ -4,6 +4,13 @@
 // CHECK-UNDEFINED-TRAP: "-fsanitize={{((signed-integer-overflow|integer-divide-by-zero|float-divide-by-zero|shift|unreachable|return|vla-bound|alignment|null|object-size|float-cast-overflow|bounds|enum|bool),?){14}"}}
 // CHECK-UNDEFINED-TRAP: "-fsanitize-undefined-trap-on-error"
 
+// RUN: %clang -target x86_64-linux-gnu -fsanitize=undefined-trap -fsanitize-trap=shift,bounds %s -### 2>&1 | FileCheck %s --check-prefix=CHECK-TRAP-SOME
+// CHECK-TRAP-SOME: "-fsanitize-trap=bounds,shift"
+// CHECK-TRAP-SOME-NOT: "-fsanitize-undefined-trap-on-error"
+
+// RUN: %clang -target x86_64-linux-gnu -fsanitize=shift -fsanitize-trap=undefined -fno-sanitize-trap=bounds %s -### 2>&1 | FileCheck %s --check-prefix=CHECK-TRAP-ENABLED
+// CHECK-TRAP-ENABLED: "-fsanitize-trap=shift"
+
 // RUN: %clang -target x86_64-linux-gnu -fsanitize=undefined %s -### 2>&1 | FileCheck %s --check-prefix=CHECK-UNDEFINED
 // CHECK-UNDEFINED: "-fsanitize={{((signed-integer-overflow|integer-divide-by-zero|float-divide-by-zero|shift|unreachable|return|vla-bound|alignment|null|vptr|object-size|float-cast-overflow|bounds|enum|bool),?){15}"}}
 
@@ -0,0 +1,38 @@
+// Check that the GCC installation found through CLANG_GCC_INSTALLATION_CACHE
+// is the one found by scanning the directories.
+//
+// RUN: rm -f %t.cache
+// RUN: env CLANG_GCC_INSTALLATION_CACHE=%t.cache \
+// RUN:   %clang -no-canonical-prefixes %s -### -o %t.o 2>&1 \
+// RUN:     --target=i386-unknown-linux \
+// RUN:     --sysroot=%S/Inputs/basic_linux_tree \
+// RUN:   | FileCheck --check-prefix=CHECK-LD %s
+// RUN: FileCheck --check-prefix=CHECK-CACHE %s < %t.cache
+// RUN: env CLANG_GCC_INSTALLATION_CACHE=%t.cache \
+// RUN:   %clang -no-canonical-prefixes %s -### -o %t.o 2>&1 \
+// RUN:     --target=i386-unknown-linux \
+// RUN:     --sysroot=%S/Inputs/basic_linux_tree \
+// RUN:   | FileCheck --check-prefix=CHECK-LD %s
+// RUN: env CLANG_GCC_INSTALLATION_CACHE=%t.cache \
+// RUN:   %clang -no-canonical-prefixes %s -### -o %t.o 2>&1 \
+// RUN:     --target=x86_64-unknown-linux \
+// RUN:     --sysroot=%S/Inputs/basic_linux_tree \
+// RUN:   | FileCheck --check-prefix=CHECK-LD-64 %s
+// RUN: FileCheck --check-prefix=CHECK-CACHE-BOTH %s < %t.cache
+//
+// CHECK-LD-NOT: warning:
+// CHECK-LD: "{{.*}}ld{{(.exe)?}}" "--sysroot=[[SYSROOT:[^"]+]]"
+// CHECK-LD: "{{.*}}/usr/lib/gcc/i386-unknown-linux/4.6.0{{/|\\\\}}crtbegin.o"
+// CHECK-LD: "-L[[SYSROOT]]/usr/lib/gcc/i386-unknown-linux/4.6.0"
+//
+// CHECK-LD-64-NOT: warning:
+// CHECK-LD-64: "{{.*}}ld{{(.exe)?}}" "--sysroot=[[SYSROOT:[^"]+]]"
+// CHECK-LD-64: "{{.*}}/usr/lib/gcc/x86_64-unknown-linux/4.6.0{{/|\\\\}}crtbegin.o"
+//
+// CHECK-CACHE: entry{{.}}i386-unknown-linux{{.}}{{.*}}basic_linux_tree
+// CHECK-CACHE: selected{{.}}i386-unknown-linux{{.}}{{.*}}/usr/lib/gcc/i386-unknown-linux/4.6.0{{.*}}4.6.0
+// CHECK-CACHE-NEXT: end
+//
+// CHECK-CACHE-BOTH: entry{{.}}i386-unknown-linux
+// CHECK-CACHE-BOTH: entry{{.}}x86_64-unknown-linux
+// CHECK-CACHE-BOTH: selected{{.}}x86_64-unknown-linux
@@ -0,0 +1,14 @@
+// Jobs that set LLVM's command line options, here through the
+// -backend-option that -fdebug-types-section adds, are spawned even with
+// -fintegrated-cc1, since those options can only be given once per process.
+// Otherwise the second job would fail since the option occurs twice.
+//
+// RUN: rm -rf %t
+// RUN: mkdir %t
+// RUN: cp %s %t/other.c
+// RUN: cd %t && %clang -fintegrated-cc1 -target x86_64-unknown-linux -g \
+// RUN:   -fdebug-types-section -c %s %t/other.c
+// RUN: ls %t/integrated-cc1-llvm-options.o %t/other.o
+// REQUIRES: x86-registered-target
+
+int f(void) { return 0; }
@@ -0,0 +1,19 @@
+// RUN: %clang -fintegrated-cc1 -fsyntax-only -### %s 2>&1 \
+// RUN:   | FileCheck --check-prefix=CHECK-JOBS %s
+// CHECK-JOBS-NOT: warning: argument unused
+// CHECK-JOBS: "-cc1"
+
+// A job that runs in the driver's process is under a crash recovery context,
+// so the pragma below crashes it; a spawned job ignores it.
+//
+// RUN: rm -rf %t
+// RUN: mkdir %t
+// RUN: not env TMPDIR=%t TEMP=%t TMP=%t %clang -fintegrated-cc1 \
+// RUN:   -fsyntax-only %s 2>&1 | FileCheck --check-prefix=CHECK-CRASH %s
+// RUN: env TMPDIR=%t TEMP=%t TMP=%t %clang -fintegrated-cc1 \
+// RUN:   -fno-integrated-cc1 -fsyntax-only %s
+// REQUIRES: crash-recovery
+
+#pragma clang __debug handle_crash
+// CHECK-CRASH: error: clang frontend command failed due to signal
+// CHECK-CRASH: Preprocessed source(s) and associated run script(s) are located at:
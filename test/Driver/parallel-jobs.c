@@ -0,0 +1,23 @@
+// Check that -j is accepted by the driver and not forwarded to cc1.
+// RUN: %clang -### -j4 -c %s %s 2>&1 | FileCheck -check-prefix=CHECK-HASH %s
+// CHECK-HASH-NOT: argument unused
+// CHECK-HASH: "-cc1"
+// CHECK-HASH-NOT: "-j
+// CHECK-HASH: "-cc1"
+// CHECK-HASH-NOT: "-j
+
+// RUN: %clang -### -jfoo -c %s 2>&1 | FileCheck -check-prefix=CHECK-INVALID %s
+// CHECK-INVALID: invalid integral value 'foo' in '-jfoo'
+
+// Independent jobs run concurrently, but failures are still reported for
+// every failing command.
+// RUN: %clang -j 2 -fsyntax-only %s %s
+// RUN: not %clang -j 2 -fsyntax-only -DBROKEN %s %s 2>&1 \
+// RUN:   | FileCheck -check-prefix=CHECK-FAIL %s
+// CHECK-FAIL: error: expected
+// CHECK-FAIL: error: expected
+
+#ifdef BROKEN
+int x = ;
+#endif
+int y;
@@ -0,0 +1,29 @@
+// Test the driver flags of profile-guided optimization.
+//
+// RUN: %clang -### -c -fprofile-instr-generate %s 2>&1 \
+// RUN:   | FileCheck -check-prefix=GEN %s
+// GEN: "-cc1"
+// GEN: "-fprofile-instr-generate"
+//
+// RUN: %clang -### -c -fprofile-instr-use=foo.profdata %s 2>&1 \
+// RUN:   | FileCheck -check-prefix=USE %s
+// USE: "-cc1"
+// USE: "-fprofile-instr-use=foo.profdata"
+//
+// RUN: %clang -### -c -fprofile-instr-generate \
+// RUN:     -fprofile-instr-use=foo.profdata %s 2>&1 \
+// RUN:   | FileCheck -check-prefix=BOTH %s
+// BOTH: error: invalid argument '-fprofile-instr-generate' not allowed with '-fprofile-instr-use=foo.profdata'
+//
+// RUN: %clang -no-canonical-prefixes %s -### -o %t.o 2>&1 \
+// RUN:     -target i386-unknown-linux -fprofile-instr-generate \
+// RUN:     -resource-dir=%S/Inputs/resource_dir \
+// RUN:     --sysroot=%S/Inputs/basic_linux_tree \
+// RUN:   | FileCheck -check-prefix=LINK %s
+// LINK: "{{(.*[^-.0-9A-Z_a-z])?}}ld{{(.exe)?}}"
+// LINK: "{{.*}}/Inputs/resource_dir{{/|\\\\}}lib{{/|\\\\}}linux{{/|\\\\}}libclang_rt.profile-i386.a"
+//
+// RUN: %clang -### -c -fprofile-sample-use=foo.prof %s 2>&1 \
+// RUN:   | FileCheck -check-prefix=SAMPLE %s
+// SAMPLE: "-cc1"
+// SAMPLE: "-fprofile-sample-use=foo.prof"
@@ -0,0 +1,21 @@
+// RUN: rm -rf %t && mkdir -p %t/a %t/b
+// RUN: echo "IndentWidth: 3" > %t/a/.clang-format
+// RUN: echo "IndentWidth: 5" > %t/b/.clang-format
+// RUN: grep -Ev "// *[A-Z0-9-]+:" %s > %t/a/1.cpp
+// RUN: cp %t/a/1.cpp %t/a/2.cpp
+// RUN: cp %t/a/1.cpp %t/b/3.cpp
+// RUN: clang-format -j2 -style=file %t/a/1.cpp %t/b/3.cpp %t/a/2.cpp \
+// RUN:   | FileCheck -strict-whitespace %s
+// RUN: clang-format -j0 -style=file -i %t/a/1.cpp %t/b/3.cpp %t/a/2.cpp
+// RUN: FileCheck -strict-whitespace -check-prefix=INPLACE3 \
+// RUN:   -input-file=%t/a/2.cpp %s
+// RUN: FileCheck -strict-whitespace -check-prefix=INPLACE5 \
+// RUN:   -input-file=%t/b/3.cpp %s
+void f() {
+ int   *  i  ;
+}
+// CHECK: {{^   int \*i;$}}
+// CHECK: {{^     int \*i;$}}
+// CHECK: {{^   int \*i;$}}
+// INPLACE3: {{^   int \*i;$}}
+// INPLACE5: {{^     int \*i;$}}
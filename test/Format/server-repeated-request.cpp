@@ -0,0 +1,9 @@
+// RUN: printf 'a.cpp\nsize=10\nint    i;\na.cpp\nsize=10\nint    i;\na.cpp\nsize=10\nint    j;\n' \
+// RUN:   | clang-format -style=LLVM -server \
+// RUN:   | FileCheck -strict-whitespace %s
+// CHECK: {{^ok 7$}}
+// CHECK-NEXT: {{^int\ i;$}}
+// CHECK-NEXT: {{^ok 7$}}
+// CHECK-NEXT: {{^int\ i;$}}
+// CHECK-NEXT: {{^ok 7$}}
+// CHECK-NEXT: {{^int\ j;$}}
@@ -0,0 +1,10 @@
+// RUN: printf 'a.cpp\nsize=10 cursor=6\nint    i;\nb.cpp\nsize=7 offset=20\nint  j;\nc.cpp\nsize=7 lines=1:1\nint  k;' \
+// RUN:   | clang-format -style=LLVM -server \
+// RUN:   | FileCheck -strict-whitespace %s
+// CHECK: {{^ok 23$}}
+// CHECK-NEXT: {{^\{ "Cursor": 4 \}$}}
+// CHECK-NEXT: {{^int\ i;$}}
+// CHECK-NEXT: {{^error [0-9]+$}}
+// CHECK-NEXT: {{^error: offset 20 is outside the file$}}
+// CHECK-NEXT: {{^ok 6$}}
+// CHECK-NEXT: {{^int\ k;$}}
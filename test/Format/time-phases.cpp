@@ -0,0 +1,14 @@
+// RUN: grep -Ev "// *[A-Z-]+:" %s > %t.cpp
+// RUN: clang-format -style=LLVM -time-phases %t.cpp %t.cpp 2>&1 >/dev/null \
+// RUN:   | FileCheck %s
+int   f(int  a) {
+  return a+1;
+}
+// CHECK: clang-format phase timings
+// CHECK: Lexing
+// CHECK: Parsing unwrapped lines
+// CHECK: Annotating tokens
+// CHECK: Formatting lines
+// CHECK: Generating replacements
+// CHECK: Total
+// CHECK: {{[0-9]+}} unwrapped lines, {{[0-9]+}} formatted, {{[0-9]+}} line states created
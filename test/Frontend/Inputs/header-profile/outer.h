@@ -0,0 +1,3 @@
+#include "inner.h"
+int outer1;
+int outer2;
@@ -0,0 +1,27 @@
+// RUN: echo '-fsyntax-only %s' > %t.requests
+// RUN: echo '-fsyntax-only -DBROKEN %s' >> %t.requests
+// RUN: echo '' >> %t.requests
+// RUN: echo '-emit-llvm -o %t.ll "%s"' >> %t.requests
+// RUN: echo '-fsyntax-only -mllvm -debug-pass=Structure %s' >> %t.requests
+// RUN: echo '-emit-llvm -o %t.1.ll -backend-option -generate-type-units %s' >> %t.requests
+// RUN: echo '-emit-llvm -o %t.2.ll -backend-option -generate-type-units %s' >> %t.requests
+// RUN: %clang -cc1server < %t.requests 2> %t.stderr | FileCheck %s
+// RUN: FileCheck --check-prefix=CHECK-DIAGS %s < %t.stderr
+// RUN: FileCheck --check-prefix=CHECK-IR %s < %t.ll
+
+// CHECK: {{^}}0{{$}}
+// CHECK-NEXT: {{^}}1{{$}}
+// CHECK-NEXT: {{^}}0{{$}}
+// CHECK-NEXT: {{^}}0{{$}}
+// CHECK-NEXT: {{^}}0{{$}}
+// CHECK-NEXT: {{^}}0{{$}}
+
+#ifdef BROKEN
+// CHECK-DIAGS: cc1server.c:[[@LINE+1]]:1: error: unknown type name 'broken'
+broken x;
+#endif
+
+// CHECK-DIAGS-NOT: error:
+
+// CHECK-IR: define {{.*}}i32 @f
+int f(void) { return 0; }
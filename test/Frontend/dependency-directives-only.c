@@ -0,0 +1,33 @@
+// RUN: rm -rf %t.dir
+// RUN: mkdir -p %t.dir
+// RUN: echo '#define WANT_B 1' > %t.dir/a.h
+// RUN: echo 'int b;' > %t.dir/b.h
+// RUN: echo 'int c;' > %t.dir/c.h
+// RUN: echo '#include "a.h"' > %t.dir/d.h
+// RUN: %clang_cc1 -Eonly -dependency-directives-only -I %t.dir %s \
+// RUN:   -dependency-file %t.dir/deps.d -MT out.o
+// RUN: FileCheck %s < %t.dir/deps.d
+// RUN: %clang_cc1 -Eonly -I %t.dir %s -dependency-file %t.dir/full.d -MT out.o
+// RUN: diff %t.dir/deps.d %t.dir/full.d
+
+// CHECK: out.o:
+// CHECK-NEXT: dependency-directives-only.c
+// CHECK-NEXT: a.h
+// CHECK-NEXT: b.h
+// CHECK-NEXT: d.h
+// CHECK-NOT: c.h
+
+#include "a.h"
+
+int x; /* #include "c.h" */
+const char *s = "#include \"c.h\"";
+
+#if WANT_B
+#include "b.h"
+#else
+#include "c.h"
+#endif
+
+#define HEADER "d.h"
+#include HEADER
+#include HEADER
@@ -0,0 +1,22 @@
+// RUN: %clang_cc1 -fsyntax-only -I %S/Inputs/header-profile -header-profile-file %t.json %s
+// RUN: FileCheck -check-prefix=MAIN %s < %t.json
+// RUN: FileCheck -check-prefix=OUTER %s < %t.json
+// RUN: FileCheck -check-prefix=INNER %s < %t.json
+
+#include "outer.h"
+#include "inner.h"
+int main_decl;
+
+// MAIN: "main-file": "{{.*}}header-profile.c",
+// MAIN: {"file": "{{.*}}header-profile.c", "inclusions": 1,
+// MAIN-NEXT: "bytes": {{[0-9]+}}, "tokens": {{[0-9]+}}, "decls": 1,
+// MAIN-NEXT: "inclusive-bytes": {{[0-9]+}}, "inclusive-tokens": {{[0-9]+}}, "inclusive-decls": 4,
+
+// OUTER: {"file": "{{.*}}outer.h", "inclusions": 1,
+// OUTER-NEXT: "bytes": 43, "tokens": 9, "decls": 2,
+// OUTER-NEXT: "inclusive-bytes": 67, "inclusive-tokens": 15, "inclusive-decls": 3,
+
+// The second inclusion of inner.h is skipped for its #pragma once.
+// INNER: {"file": "{{.*}}inner.h", "inclusions": 1,
+// INNER-NEXT: "bytes": 24, "tokens": 6, "decls": 1,
+// INNER-NEXT: "inclusive-bytes": 24, "inclusive-tokens": 6, "inclusive-decls": 1,
@@ -0,0 +1,32 @@
+// RUN: %clang_cc1 -fsyntax-only -fmemory-report=%t.json %s
+// RUN: FileCheck %s < %t.json
+// RUN: %clang -### -fsyntax-only -fmemory-report=%t.json %s 2>&1 | \
+// RUN:   FileCheck -check-prefix=DRIVER %s
+
+#define SQUARE(x) ((x) * (x))
+
+int square(int x) { return SQUARE(x); }
+int twice(int x, int y) { return x + y; }
+
+// CHECK: "main-file": "{{.*}}memory-report.c",
+// CHECK: "source-manager": {
+// CHECK-NEXT: "file-entries": {{[0-9]+}}, "expansion-entries": {{[1-9][0-9]*}}
+// CHECK: "ast": {
+// CHECK: "decls": [
+// CHECK-DAG: {"kind": "Function", "count": 2, "bytes": {{[1-9][0-9]*}}}
+// CHECK-DAG: {"kind": "ParmVar", "count": 3, "bytes": {{[1-9][0-9]*}}}
+// CHECK: "stmts": [
+// CHECK-DAG: {"kind": "CompoundStmt", "count": 2, "bytes": {{[1-9][0-9]*}}}
+// CHECK-DAG: {"kind": "ReturnStmt", "count": 2, "bytes": {{[1-9][0-9]*}}}
+// CHECK: "types": [
+// CHECK-DAG: {"kind": "FunctionProto", "count": {{[1-9][0-9]*}},
+// CHECK: "node-bytes": {{[1-9][0-9]*}},
+// CHECK-NEXT: "allocator-bytes": {{[1-9][0-9]*}},
+// CHECK: "identifiers": {"count": {{[1-9][0-9]*}}, "bytes": {{[1-9][0-9]*}}},
+// CHECK: "preprocessor": {
+// CHECK: "macro-infos": {{[1-9][0-9]*}}, "macro-info-bytes": {{[1-9][0-9]*}},
+// CHECK-NEXT: "token-lexer-cache-bytes": {{[0-9]+}},
+// CHECK: "sema": {
+// CHECK: "version": 1
+
+// DRIVER: "-fmemory-report={{.*}}.json"
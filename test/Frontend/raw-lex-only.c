@@ -0,0 +1,7 @@
+// RUN: %clang_cc1 -raw-lex-only %s 2>&1 | count 0
+
+#define FOO(x) x "string" 'c' 1.5e3
+int main(void) { return FOO(0); } /* comment */
+#if 0
+#error not preprocessed
+#endif
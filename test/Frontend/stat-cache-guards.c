@@ -0,0 +1,32 @@
+// Check that the include guards recorded in a persistent stat cache let a
+// later compilation skip a header whose guard is already defined, and that the
+// header is still listed as a dependency.
+// RUN: rm -rf %t
+// RUN: mkdir -p %t
+// RUN: echo '#ifndef GUARDED_H' > %t/guarded.h
+// RUN: echo '#define GUARDED_H' >> %t/guarded.h
+// RUN: echo 'int guarded;' >> %t/guarded.h
+// RUN: echo '#endif' >> %t/guarded.h
+// The cache ignores files modified within the last couple of seconds.
+// RUN: touch -t 200001010000 %t/guarded.h
+// RUN: %clang_cc1 -fsyntax-only -fstat-cache=%t/stats -I %t %s -verify
+// RUN: %clang_cc1 -fsyntax-only -fstat-cache=%t/stats -I %t %s -verify \
+// RUN:   -DGUARDED_H -print-stats -dependency-file %t/deps -MT %s.o 2>&1 \
+// RUN:   | FileCheck %s
+// RUN: FileCheck -check-prefix=CHECK-DEPS %s < %t/deps
+// CHECK: 1 of them using include guards recorded by earlier compilations.
+// CHECK-DEPS: guarded.h
+
+// A header that has changed since is read again.
+// RUN: echo 'int changed;' > %t/guarded.h
+// RUN: touch -t 200001020000 %t/guarded.h
+// RUN: %clang_cc1 -fsyntax-only -fstat-cache=%t/stats -I %t %s -verify \
+// RUN:   -DGUARDED_H -DEXPECT_CHANGED
+
+// expected-no-diagnostics
+
+#include "guarded.h"
+
+#ifdef EXPECT_CHANGED
+int *p = &changed;
+#endif
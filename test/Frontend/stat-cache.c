@@ -0,0 +1,38 @@
+// Check that a persistent stat cache is created and used, and that a header
+// which appears in an earlier search directory is found once the directory's
+// time stamp changes. Nothing is cached about directories modified within
+// the last couple of seconds, so the search directories are backdated.
+// RUN: rm -rf %t
+// RUN: mkdir -p %t/a %t/b
+// RUN: echo '#define FROM_B' > %t/b/stat-cache.h
+// RUN: touch -t 200001010000 %t/a %t/b
+// RUN: %clang_cc1 -fsyntax-only -fstat-cache=%t/stats -I %t/a -I %t/b %s -verify -DEXPECT_B -print-stats 2>&1 \
+// RUN:   | FileCheck -check-prefix=CHECK-COLD %s
+// CHECK-COLD: 0 persistent stat cache hits
+
+// With the time stamp of a restored, only the cache can still claim that
+// a/stat-cache.h is missing.
+// RUN: echo '#define FROM_A' > %t/a/stat-cache.h
+// RUN: touch -t 200001010000 %t/a
+// RUN: %clang_cc1 -fsyntax-only -fstat-cache=%t/stats -I %t/a -I %t/b %s -verify -DEXPECT_B -print-stats 2>&1 \
+// RUN:   | FileCheck -check-prefix=CHECK-WARM %s
+// CHECK-WARM: {{[1-9][0-9]*}} persistent stat cache hits
+
+// RUN: touch %t/a
+// RUN: %clang_cc1 -fsyntax-only -fstat-cache=%t/stats -I %t/a -I %t/b %s -verify -DEXPECT_A
+
+// Check that the driver forwards the option.
+// RUN: %clang -### -fsyntax-only -fstat-cache=%t/stats %s 2>&1 \
+// RUN:   | FileCheck -check-prefix=CHECK-DRIVER %s
+// CHECK-DRIVER: "-fstat-cache={{.*}}stats"
+
+// expected-no-diagnostics
+
+#include "stat-cache.h"
+
+#if defined(EXPECT_A) && !defined(FROM_A)
+#error should have found a/stat-cache.h
+#endif
+#if defined(EXPECT_B) && !defined(FROM_B)
+#error should have found b/stat-cache.h
+#endif
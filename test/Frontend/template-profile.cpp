@@ -0,0 +1,27 @@
+// RUN: %clang_cc1 -fsyntax-only -ftemplate-profile=%t.json %s
+// RUN: FileCheck %s < %t.json
+// RUN: %clang -### -fsyntax-only -ftemplate-profile=%t.json %s 2>&1 \
+// RUN:   | FileCheck %s -check-prefix=DRIVER
+
+template<int N> struct Fib {
+  static const int value = Fib<N - 1>::value + Fib<N - 2>::value;
+};
+template<> struct Fib<1> { static const int value = 1; };
+template<> struct Fib<0> { static const int value = 0; };
+int x = Fib<5>::value;
+
+template<typename T> T twice(T t) { return t + t; }
+int y = twice(21);
+
+// CHECK: {"traceEvents": [
+// CHECK-DAG: {"name": "instantiation", "ph": "X", "pid": 0, "tid": 0, "ts": {{[0-9]+}}, "dur": {{[0-9]+}}, "args": {"detail": "Fib<5>", "memory": {{[0-9]+}}}}
+// CHECK-DAG: {"name": "instantiation", {{.*}}"detail": "Fib<2>"
+// CHECK-DAG: {"name": "overload resolution", {{.*}}"detail": "twice"
+// CHECK-DAG: {"name": "deduction", {{.*}}"detail": "twice"
+// CHECK-DAG: {"name": "instantiation", {{.*}}"detail": "twice<int>"
+// CHECK: "templates": [
+// CHECK-DAG: {"name": "Fib", "count": {{[0-9]+}}, "total_us": {{[0-9]+}}, "self_us": {{[0-9]+}}, "memory": {{[0-9]+}}}
+// CHECK-DAG: {"name": "twice", "count": {{[0-9]+}},
+// CHECK: ]}
+
+// DRIVER: "-ftemplate-profile={{.*}}.json"
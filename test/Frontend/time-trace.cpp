@@ -0,0 +1,31 @@
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -emit-llvm -o %t.ll \
+// RUN:   -ftime-trace=%t.json %s
+// RUN: FileCheck %s < %t.json
+// RUN: %clang -### -c -ftime-trace=%t.json %s 2>&1 \
+// RUN:   | FileCheck %s -check-prefix=DRIVER
+
+#ifndef HEADER
+#define HEADER
+
+#include __FILE__
+
+int twice(int x) { return header(x) + header(x); }
+
+#else
+
+inline int header(int x) { return x; }
+
+#endif
+
+// CHECK: {"traceEvents": [
+// CHECK-DAG: {"name": "Include", "ph": "X", "pid": 0, "tid": 1, "ts": {{[0-9]+}}, "dur": {{[0-9]+}}, "args": {"detail": "{{.*}}time-trace.cpp"}}
+// CHECK-DAG: {"name": "ParseTopLevelDecl", "ph": "X", "pid": 0, "tid": 0, {{.*}}"detail": "twice"}}
+// CHECK-DAG: {"name": "EmitTopLevelDecl", {{.*}}"detail": "twice"}}
+// CHECK-DAG: {"name": "HandleTopLevelDecl", {{.*}}"detail": "header"}}
+// CHECK-DAG: {"name": "ParseAST", "ph": "X", "pid": 0, "tid": 0, "ts": {{[0-9]+}}, "dur": {{[0-9]+}}}
+// CHECK-DAG: {"name": "CodeGenPasses",
+// CHECK-DAG: {"name": "Total ParseAST", "ph": "X", "pid": 0, "tid": 2, {{.*}}"detail": "1 time"}}
+// CHECK-DAG: {"name": "Total ParseTopLevelDecl", {{.*}}"detail": "{{[0-9]+}} times"}}
+// CHECK: ]}
+
+// DRIVER: "-ftime-trace={{.*}}.json"
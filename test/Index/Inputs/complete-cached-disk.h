@@ -0,0 +1,2 @@
+int cached_disk_value;
+#define CACHED_DISK_MACRO 1
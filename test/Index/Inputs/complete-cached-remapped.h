@@ -0,0 +1 @@
+int cached_remapped_old;
@@ -0,0 +1,3 @@
+struct HibernateHeader {
+  int member;
+};
@@ -0,0 +1 @@
+int before_edit;
@@ -0,0 +1,9 @@
+int first(int x) {
+  return x + 1;
+}
+
+struct Pair { int a, b; };
+
+int last(struct Pair p) {
+  return first(p.b) + 2;
+}
@@ -0,0 +1,2 @@
+#include "unit-index.h"
+int unit_index_other(void) { return unit_index_shared(1); }
@@ -0,0 +1,4 @@
+#ifndef UNIT_INDEX_H
+#define UNIT_INDEX_H
+int unit_index_shared(int x);
+#endif
@@ -0,0 +1,20 @@
+struct Point { int x, y; };
+
+int benchmark_sum(struct Point *p) {
+  return p->x + p->y;
+}
+
+// RUN: c-index-test -benchmark-parse 3 %s | FileCheck -check-prefix=PARSE %s
+// PARSE: parse: 3 iterations, p50 {{[0-9.]+}} ms, p95 {{[0-9.]+}} ms, p99 {{[0-9.]+}} ms, peak RSS {{[0-9]+}} KB
+
+// RUN: env CINDEXTEST_EDITING=1 c-index-test -benchmark-reparse 3 %s | FileCheck -check-prefix=REPARSE %s
+// REPARSE: reparse: 3 iterations, p50 {{[0-9.]+}} ms
+
+// RUN: env CINDEXTEST_EDITING=1 c-index-test -benchmark-complete=%s:4:13 3 %s | FileCheck -check-prefix=COMPLETE %s
+// COMPLETE: complete: 3 iterations, p50 {{[0-9.]+}} ms
+
+// RUN: c-index-test -benchmark-cursor=%s:4:10 100 %s | FileCheck -check-prefix=CURSOR %s
+// CURSOR: cursor: 100 iterations, p50 {{[0-9.]+}} ms
+
+// RUN: not c-index-test -benchmark-parse 0 %s 2>&1 | FileCheck -check-prefix=INVALID %s
+// INVALID: invalid number of iterations '0'
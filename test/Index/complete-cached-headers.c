@@ -0,0 +1,21 @@
+// Note: the run lines follow their respective tests, since line/column
+// matter in this test.
+#include "Inputs/complete-cached-disk.h"
+#include "Inputs/complete-cached-remapped.h"
+
+void test() {
+  
+}
+
+// The cached global completions come from the headers as they are on disk or
+// as they are remapped, even though the strings for unchanged headers are
+// kept when the cache is refreshed.
+// RUN: env CINDEXTEST_EDITING=1 CINDEXTEST_COMPLETION_CACHING=1 \
+// RUN:   c-index-test -code-completion-at=%s:7:1 \
+// RUN:   "-remap-file=%S/Inputs/complete-cached-remapped.h;%S/Inputs/complete-cached-remapped-new.h" \
+// RUN:   %s | FileCheck %s
+// CHECK: macro definition:{TypedText CACHED_DISK_MACRO}
+// CHECK: VarDecl:{ResultType int}{TypedText cached_disk_value}
+// CHECK-NOT: cached_remapped_old
+// CHECK: VarDecl:{ResultType int}{TypedText cached_remapped_new}
+// CHECK-NOT: cached_remapped_old
@@ -0,0 +1,40 @@
+// Note: the run lines follow their respective tests, since line/column
+// matter in this test.
+int filter_apple;
+int Filter_banana;
+int fancy_identifier_list;
+int other_value;
+void filter_func(int);
+
+void test() {
+  
+}
+
+// RUN: env CINDEXTEST_COMPLETION_FILTER=filter c-index-test -code-completion-at=%s:10:1 %s | FileCheck -check-prefix=CHECK-FILTER %s
+// CHECK-FILTER: VarDecl:{ResultType int}{TypedText filter_apple} ({{[0-9]+}})
+// CHECK-FILTER: VarDecl:{ResultType int}{TypedText Filter_banana} ({{[0-9]+}})
+// CHECK-FILTER: FunctionDecl:{ResultType void}{TypedText filter_func}{LeftParen (}{Placeholder int}{RightParen )} ({{[0-9]+}})
+// CHECK-FILTER-NOT: other_value
+// CHECK-FILTER-NOT: fancy_identifier_list
+
+// Characters of the filter that appear in order are a weaker match.
+// RUN: env CINDEXTEST_COMPLETION_FILTER=fil c-index-test -code-completion-at=%s:10:1 %s | FileCheck -check-prefix=CHECK-FUZZY %s
+// CHECK-FUZZY: VarDecl:{ResultType int}{TypedText fancy_identifier_list} ({{[0-9]+}})
+// CHECK-FUZZY-NOT: other_value
+
+// Only the best results are kept: exact prefixes before other matches.
+// RUN: env CINDEXTEST_COMPLETION_FILTER=fil CINDEXTEST_COMPLETION_MAX_RESULTS=2 c-index-test -code-completion-at=%s:10:1 %s | FileCheck -check-prefix=CHECK-LIMIT %s
+// CHECK-LIMIT-NOT: Filter_banana
+// CHECK-LIMIT-NOT: fancy_identifier_list
+// CHECK-LIMIT: VarDecl:{ResultType int}{TypedText filter_apple} ({{[0-9]+}})
+// CHECK-LIMIT-NEXT: FunctionDecl:{ResultType void}{TypedText filter_func}{LeftParen (}{Placeholder int}{RightParen )} ({{[0-9]+}})
+// CHECK-LIMIT-NOT: Filter_banana
+// CHECK-LIMIT-NOT: fancy_identifier_list
+
+// The same results come from the cached global completions.
+// RUN: env CINDEXTEST_EDITING=1 CINDEXTEST_COMPLETION_CACHING=1 CINDEXTEST_COMPLETION_FILTER=fil CINDEXTEST_COMPLETION_MAX_RESULTS=2 c-index-test -code-completion-at=%s:10:1 %s | FileCheck -check-prefix=CHECK-LIMIT %s
+
+// The same results come from the complete results kept by the previous
+// completion at the same point.
+// RUN: env CINDEXTEST_EDITING=1 CINDEXTEST_COMPLETION_REUSE_RESULTS=1 CINDEXTEST_COMPLETION_FILTER=fil CINDEXTEST_COMPLETION_MAX_RESULTS=2 c-index-test -code-completion-at=%s:10:1 "-remap-file=%s;%s" %s | FileCheck -check-prefix=CHECK-LIMIT %s
+// RUN: env CINDEXTEST_EDITING=1 CINDEXTEST_COMPLETION_REUSE_RESULTS=1 CINDEXTEST_COMPLETION_FILTER=filter c-index-test -code-completion-at=%s:10:1 "-remap-file=%s;%s" %s | FileCheck -check-prefix=CHECK-FILTER %s
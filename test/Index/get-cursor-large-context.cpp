@@ -0,0 +1,177 @@
+// Check that clang_getCursor finds the right declarations in contexts large
+// enough to be indexed.
+namespace ns {
+int v0;
+int v1;
+int v2;
+int v3;
+int v4;
+int v5;
+int v6;
+int v7;
+int v8;
+int v9;
+int v10;
+int v11;
+int v12;
+int v13;
+int v14;
+int v15;
+int v16;
+int v17;
+int v18;
+int v19;
+int v20;
+int v21;
+int v22;
+int v23;
+int v24;
+int v25;
+int v26;
+int v27;
+int v28;
+int v29;
+int v30;
+int v31;
+int v32;
+int v33;
+int v34;
+int v35;
+int v36;
+int v37;
+int v38;
+int v39;
+
+void f(int p) { int local = p; }
+int v40;
+int v41;
+int v42;
+int v43;
+int v44;
+int v45;
+int v46;
+int v47;
+int v48;
+int v49;
+int v50;
+int v51;
+int v52;
+int v53;
+int v54;
+int v55;
+int v56;
+int v57;
+int v58;
+int v59;
+int v60;
+int v61;
+int v62;
+int v63;
+int v64;
+int v65;
+int v66;
+int v67;
+int v68;
+int v69;
+int v70;
+int v71;
+int v72;
+int v73;
+int v74;
+int v75;
+int v76;
+int v77;
+int v78;
+int v79;
+struct S {
+  int m0;
+  int m1;
+  int m2;
+  int m3;
+  int m4;
+  int m5;
+  int m6;
+  int m7;
+  int m8;
+  int m9;
+  int m10;
+  int m11;
+  int m12;
+  int m13;
+  int m14;
+  int m15;
+  int m16;
+  int m17;
+  int m18;
+  int m19;
+  int m20;
+  int m21;
+  int m22;
+  int m23;
+  int m24;
+  int m25;
+  int m26;
+  int m27;
+  int m28;
+  int m29;
+  int m30;
+  int m31;
+  int m32;
+  int m33;
+  int m34;
+  int m35;
+  int m36;
+  int m37;
+  int m38;
+  int m39;
+  int m40;
+  int m41;
+  int m42;
+  int m43;
+  int m44;
+  int m45;
+  int m46;
+  int m47;
+  int m48;
+  int m49;
+  int m50;
+  int m51;
+  int m52;
+  int m53;
+  int m54;
+  int m55;
+  int m56;
+  int m57;
+  int m58;
+  int m59;
+  int m60;
+  int m61;
+  int m62;
+  int m63;
+  int m64;
+  int m65;
+  int m66;
+  int m67;
+  int m68;
+  int m69;
+  void g() { m35 = 0; }
+};
+}
+
+// RUN: c-index-test -cursor-at=%s:4:5 \
+// RUN:              -cursor-at=%s:44:1 \
+// RUN:              -cursor-at=%s:45:6 \
+// RUN:              -cursor-at=%s:45:21 \
+// RUN:              -cursor-at=%s:45:29 \
+// RUN:              -cursor-at=%s:85:5 \
+// RUN:              -cursor-at=%s:122:7 \
+// RUN:              -cursor-at=%s:157:14 \
+// RUN:       %s | FileCheck %s
+// CHECK: VarDecl=v0:4:5
+// CHECK: Namespace=ns:3:11 (Definition)
+// CHECK: FunctionDecl=f:45:6 (Definition)
+// CHECK: VarDecl=local:45:21 (Definition)
+// CHECK: DeclRefExpr=p:45:12
+// CHECK: VarDecl=v79:85:5
+// CHECK: FieldDecl=m35:122:7 (Definition)
+// CHECK: MemberRefExpr=m35:122:7
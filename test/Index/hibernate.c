@@ -0,0 +1,24 @@
+#include "hibernate.h"
+
+int hibernate_use(struct HibernateHeader *h) {
+  int *p = &h->member;
+  float *q = 0;
+  p = q;
+  return *p;
+}
+
+// A hibernating translation unit is reloaded, with its diagnostics, when it
+// is used again, and reparsed from source without being reloaded.
+// RUN: env CINDEXTEST_HIBERNATE=1 c-index-test -test-load-source all -I %S/Inputs %s 2> %t.stderr.txt | FileCheck %s
+// RUN: FileCheck -check-prefix=CHECK-DIAG %s < %t.stderr.txt
+// RUN: env CINDEXTEST_EDITING=1 CINDEXTEST_HIBERNATE=1 c-index-test -test-load-source-reparse 2 all -I %S/Inputs %s 2> %t.reparse.txt | FileCheck %s
+// RUN: FileCheck -check-prefix=CHECK-DIAG %s < %t.reparse.txt
+
+// CHECK: hibernate.h:1:8: StructDecl=HibernateHeader:1:8 (Definition) Extent=[1:1 - 3:2]
+// CHECK: hibernate.h:2:7: FieldDecl=member:2:7 (Definition) Extent=[2:3 - 2:13]
+// CHECK: hibernate.c:3:5: FunctionDecl=hibernate_use:3:5 (Definition) Extent=[3:1 - 8:2]
+// CHECK: hibernate.c:4:8: VarDecl=p:4:8 (Definition) Extent=[4:3 - 4:22]
+// CHECK: hibernate.c:6:3: BinaryOperator= Extent=[6:3 - 6:8]
+
+// CHECK-DIAG: hibernate.c:6:5:{6:7-6:8}: warning: incompatible pointer types assigning to 'int *' from 'float *'
+// CHECK-DIAG-NEXT: Number FIX-ITs = 0
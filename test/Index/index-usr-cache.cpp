@@ -0,0 +1,39 @@
+// RUN: c-index-test -index-file %s | FileCheck %s
+// RUN: env CINDEXTEST_INTERN_USRS=1 c-index-test -index-file %s | FileCheck %s
+
+// The USRs of members reuse the memoized USRs of their enclosing
+// declarations, and are the same whether or not they are interned.
+
+namespace outer {
+namespace inner {
+struct Record {
+  void method(int);
+  struct Nested {
+    int field;
+  };
+};
+}
+}
+
+namespace outer {
+namespace inner {
+void Record::method(int) {}
+}
+}
+
+template <typename T>
+struct Tmpl {
+  typedef T Type;
+  void use(T);
+};
+
+// CHECK: [indexDeclaration]: kind: namespace | name: outer | USR: c:@N@outer |
+// CHECK: [indexDeclaration]: kind: namespace | name: inner | USR: c:@N@outer@N@inner |
+// CHECK: [indexDeclaration]: kind: struct | name: Record | USR: c:@N@outer@N@inner@S@Record |
+// CHECK: [indexDeclaration]: kind: c++-instance-method | name: method | USR: c:@N@outer@N@inner@S@Record@F@method#I# |
+// CHECK: [indexDeclaration]: kind: struct | name: Nested | USR: c:@N@outer@N@inner@S@Record@S@Nested |
+// CHECK: [indexDeclaration]: kind: field | name: field | USR: c:@N@outer@N@inner@S@Record@S@Nested@FI@field |
+// CHECK: [indexDeclaration]: kind: c++-instance-method | name: method | USR: c:@N@outer@N@inner@S@Record@F@method#I# | {{.*}} | loc: 20:14
+// CHECK: [indexDeclaration]: kind: c++-class-template | name: Tmpl | USR: c:@ST>1#T@Tmpl |
+// CHECK: [indexDeclaration]: kind: typedef | name: Type | USR: c:index-usr-cache.cpp@{{[0-9]+}}@ST>1#T@Tmpl@T@Type |
+// CHECK: [indexDeclaration]: kind: c++-instance-method | name: use | USR: c:@ST>1#T@Tmpl@F@use#t0.0# |
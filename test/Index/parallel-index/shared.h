@@ -0,0 +1,8 @@
+#ifndef SHARED_H
+#define SHARED_H
+
+extern int shared_val;
+
+inline int shared_def() { return shared_val; }
+
+#endif
@@ -0,0 +1,2 @@
+#include "shared.h"
+int t1() { return shared_def() + shared_val; }
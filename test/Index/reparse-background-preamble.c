@@ -0,0 +1,26 @@
+#include "Inputs/reparse-background-preamble.h"
+
+int use(void) {
+  return before_edit;
+}
+
+// The first reparse precompiles the preamble. The header is edited before
+// the second one, which the preamble built for the header on disk serves
+// while its replacement is built in the background.
+
+// RUN: env CINDEXTEST_EDITING=1 CINDEXTEST_BACKGROUND_PREAMBLE=1 \
+// RUN:     CINDEXTEST_REMAP_AFTER_TRIAL=1 \
+// RUN:     c-index-test -test-load-source-reparse 2 local \
+// RUN:     "-remap-file=%S/Inputs/reparse-background-preamble.h;%S/Inputs/reparse-background-preamble.h.remap" \
+// RUN:     %s 2>&1 | FileCheck -check-prefix=BACKGROUND %s
+// BACKGROUND-NOT: error:
+// BACKGROUND: reparse-background-preamble.c:4:10: DeclRefExpr=before_edit:1:5
+
+// Without the flag, the second reparse rebuilds the preamble and sees the
+// edit.
+
+// RUN: env CINDEXTEST_EDITING=1 CINDEXTEST_REMAP_AFTER_TRIAL=1 \
+// RUN:     c-index-test -test-load-source-reparse 2 local \
+// RUN:     "-remap-file=%S/Inputs/reparse-background-preamble.h;%S/Inputs/reparse-background-preamble.h.remap" \
+// RUN:     %s 2>&1 | FileCheck -check-prefix=SYNC %s
+// SYNC: reparse-background-preamble.c:4:10: error: use of undeclared identifier 'before_edit'
@@ -0,0 +1,21 @@
+int first(int x) {
+  return x + 1;
+}
+
+struct Pair { int a, b; };
+
+int last(struct Pair p) {
+  return first(p.a);
+}
+
+// The RUN lines come last so that this file and the one it is remapped to
+// share everything before the body of last().
+
+// RUN: env CINDEXTEST_EDITING=1 CINDEXTEST_INCREMENTAL_REPARSE=1 \
+// RUN:     CINDEXTEST_REMAP_AFTER_TRIAL=2 c-index-test -test-load-source-reparse 3 local \
+// RUN:     "-remap-file=%s;%S/Inputs/reparse-incremental.c" %s 2>&1 | FileCheck %s
+
+// CHECK-NOT: error:
+// CHECK: reparse-incremental.c:1:5: FunctionDecl=first:1:5 (Definition) Extent=[1:1 - 3:2]
+// CHECK: reparse-incremental.c:7:5: FunctionDecl=last:7:5 (Definition) Extent=[7:1 - 9:2]
+// CHECK: reparse-incremental.c:8:{{[0-9]+}}: MemberRefExpr=b:5:22
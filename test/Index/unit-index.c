@@ -0,0 +1,31 @@
+// RUN: rm -rf %t
+// RUN: env CINDEXTEST_UNIT_INDEX_DIR=%t/units c-index-test -index-file %s > /dev/null
+// RUN: env CINDEXTEST_UNIT_INDEX_DIR=%t/units c-index-test -index-file %S/Inputs/unit-index-other.c > /dev/null
+
+// RUN: c-index-test -unit-index-find-usr c:@F@unit_index_shared %t/units/unit-index.c-*.cxunit | FileCheck -check-prefix=UNIT %s
+// UNIT: Inputs{{/|\\}}unit-index.h:3:5: declaration
+// UNIT-NEXT: unit-index.c:31:5: definition
+// UNIT-NOT: unit-index-other.c
+
+// RUN: c-index-test -unit-index-merge %t/units %t/units/project.cxunit
+// RUN: c-index-test -unit-index-find-usr c:@F@unit_index_shared %t/units/project.cxunit | FileCheck -check-prefix=PROJECT %s
+// PROJECT: Inputs{{/|\\}}unit-index-other.c:2:37: reference
+// PROJECT-NEXT: Inputs{{/|\\}}unit-index.h:3:5: declaration
+// PROJECT-NEXT: unit-index.c:31:5: definition
+// PROJECT-NOT: {{.}}
+
+// Merging again ignores the project index in the directory.
+// RUN: c-index-test -unit-index-merge %t/units %t/units/project.cxunit
+// RUN: c-index-test -unit-index-find-usr c:@F@unit_index_shared %t/units/project.cxunit | FileCheck -check-prefix=PROJECT %s
+
+// RUN: c-index-test -unit-index-inclusions %t/units/project.cxunit | FileCheck -check-prefix=INCLUDES %s
+// INCLUDES: Inputs{{/|\\}}unit-index-other.c:1: includes {{.*}}Inputs{{/|\\}}unit-index.h
+// INCLUDES-NEXT: unit-index.c:29: includes {{.*}}Inputs{{/|\\}}unit-index.h
+// INCLUDES-NOT: {{.}}
+
+// RUN: not c-index-test -unit-index-inclusions %s 2>&1 | FileCheck -check-prefix=INVALID %s
+// INVALID: could not read unit index
+
+#include "Inputs/unit-index.h"
+
+int unit_index_shared(int x) { return x; }
@@ -0,0 +1,11 @@
+// RUN: %clang_cc1 -std=c11 -trigraphs -Wno-trigraphs -fsyntax-only -verify %s
+// expected-no-diagnostics
+
+// Plain runs, escapes, UTF-8 and pieces that need cleaning, concatenated.
+_Static_assert(sizeof("abc" "\x41\n" "def\\") == 10, "");
+_Static_assert(sizeof("\xc3\xa9" "é") == 5, "");
+_Static_assert(sizeof(u"é" "abc") == 10, "");
+_Static_assert(sizeof("ab??/
+cd" "ef\
+gh") == 9, "");
+_Static_assert(sizeof("ab??/n") == 4, "");
@@ -0,0 +1,13 @@
+// RUN: %clang_cc1 -ast-export-binary %s -o %t
+// RUN: FileCheck %s < %t
+
+// The export starts with its magic, and holds the strings of the nodes.
+// CHECK: CLAX
+// CHECK: TranslationUnit
+// CHECK: Function
+// CHECK: exported_function
+// CHECK: int (int)
+// CHECK: ReturnStmt
+int exported_function(int x) {
+  return x;
+}
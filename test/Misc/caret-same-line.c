@@ -0,0 +1,14 @@
+// RUN: %clang_cc1 -fsyntax-only -Wunused-value %s 2>&1 | FileCheck -strict-whitespace %s
+
+// Each diagnostic on a line that has several gets its own caret.
+
+void f(int a, int b) {
+	a == b, b == a;
+}
+
+// CHECK: {{.*}}caret-same-line.c:6:4: warning: equality comparison result unused
+// CHECK-NEXT: {{^}}        a == b, b == a;{{$}}
+// CHECK-NEXT: {{^}}        ~~^~~~{{$}}
+// CHECK: {{.*}}caret-same-line.c:6:12: warning: equality comparison result unused
+// CHECK-NEXT: {{^}}        a == b, b == a;{{$}}
+// CHECK-NEXT: {{^}}                ~~^~~~{{$}}
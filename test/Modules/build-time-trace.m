@@ -0,0 +1,16 @@
+// RUN: rm -rf %t
+// RUN: %clang_cc1 -fmodules -x objective-c -fmodules-cache-path=%t \
+// RUN:   -I %S/Inputs -fsyntax-only -ftime-trace=%t.json %s
+// RUN: FileCheck %s < %t.json
+// RUN: %clang_cc1 -fmodules -x objective-c -fmodules-cache-path=%t \
+// RUN:   -I %S/Inputs -fsyntax-only -ftime-trace=%t-cached.json %s
+// RUN: FileCheck --check-prefix=CHECK-CACHED %s < %t-cached.json
+
+@import diamond_bottom;
+
+// CHECK-DAG: {"name": "BuildModule", "ph": "X", "pid": 0, "tid": 0, {{.*}}"detail": "diamond_bottom"}}
+// CHECK-DAG: {"name": "BuildModule", {{.*}}"detail": "diamond_left"}}
+// CHECK-DAG: {"name": "BuildModule", {{.*}}"detail": "diamond_right"}}
+// CHECK-DAG: {"name": "BuildModule", {{.*}}"detail": "diamond_top"}}
+
+// CHECK-CACHED-NOT: "BuildModule"
@@ -0,0 +1,22 @@
+// RUN: rm -rf %t
+// Create the global module index with the module files for Module alone.
+// RUN: %clang_cc1 -fmodules-cache-path=%t -fdisable-module-hash -fmodules -F %S/Inputs -DMODULE_ONLY %s -verify
+// RUN: ls %t|grep modules.idx
+// Build another module file. The index is rebuilt from the existing entries
+// for the unchanged module files and from the new module file.
+// RUN: %clang_cc1 -fmodules-cache-path=%t -fdisable-module-hash -fmodules -F %S/Inputs %s -verify
+// RUN: ls %t|grep modules.idx
+// Use the rebuilt index.
+// RUN: %clang_cc1 -fmodules-cache-path=%t -fdisable-module-hash -fmodules -F %S/Inputs %s -verify -print-stats 2>&1 | FileCheck %s
+
+// expected-no-diagnostics
+#ifndef MODULE_ONLY
+@import DependsOnModule;
+#endif
+@import Module;
+
+// CHECK: *** Global Module Index Statistics:
+
+int *get_sub() {
+  return Module_Sub;
+}
@@ -0,0 +1,16 @@
+// RUN: rm -rf %t
+// RUN: %clang_cc1 -fmodules-cache-path=%t -fdisable-module-hash -fmodules -fno-modules-global-index -F %S/Inputs %s -verify -print-stats 2>&1 | FileCheck %s
+
+// Names that the imported modules don't have are ruled out by each module's
+// identifier filter without searching its identifier table.
+
+// expected-no-diagnostics
+@import DependsOnModule;
+@import Module;
+
+// CHECK: identifier table lookups avoided by identifier filters
+
+int not_in_any_module(int unknown_parameter) {
+  int unknown_local = unknown_parameter;
+  return unknown_local + *Module_Sub;
+}
@@ -0,0 +1,16 @@
+// RUN: rm -rf %t
+// RUN: %clang_cc1 -fmodules -x objective-c -fmodules-cache-path=%t/cache -fmodules-relocatable-root=%S/Inputs -I %S/Inputs %s -verify
+// RUN: mv %t/cache %t/moved-cache
+// RUN: %clang_cc1 -fmodules -x objective-c -fmodules-cache-path=%t/moved-cache -fmodules-relocatable-root=%S/Inputs -I %S/Inputs %s -verify
+
+@import diamond_bottom;
+
+void test_diamond(int i, float f, double d, char c) {
+  top(&i);
+  left(&f);
+  right(&d);
+  bottom(&c);
+  bottom(&d);
+  // expected-warning@-1{{incompatible pointer types passing 'double *' to parameter of type 'char *'}}
+  // expected-note@Inputs/diamond_bottom.h:4{{passing argument to parameter 'x' here}}
+}
@@ -0,0 +1,14 @@
+// RUN: rm -rf %t
+// RUN: %clang_cc1 -fmodules -x objective-c -fmodules-cache-path=%t -I %S/Inputs/subdir-maps -fsyntax-only -verify %s
+// RUN: rm -rf %t
+// RUN: %clang_cc1 -fmodules -x objective-c -fmodules-cache-path=%t -I %S/Inputs/subdir-maps -fsyntax-only %s -print-stats 2>&1 | FileCheck %s
+// expected-no-diagnostics
+
+// Looking up a module only parses the module maps in the subdirectories of a
+// search directory that may declare it.
+
+@import Used;
+
+int *p = &used;
+
+// CHECK: 2 module maps not parsed by module lookup.
@@ -0,0 +1,54 @@
+// RUN: %clang_cc1 -fopenmp -emit-llvm %s -o - | FileCheck %s
+// RUN: %clang_cc1 -fopenmp -emit-llvm -verify -DERROR %s -o /dev/null
+
+#ifndef ERROR
+
+void foo(int);
+
+// CHECK-LABEL: define void @shared(
+void shared(int n) {
+  int sum = 0;
+// CHECK: [[CAP:%.*]] = alloca %struct.anon
+// CHECK: store i32* %sum
+// CHECK: store i32* %n.addr
+// CHECK: [[DATA:%.*]] = bitcast %struct.anon* [[CAP]] to i8*
+// CHECK: call void @GOMP_parallel_start(void (i8*)* bitcast (void (%struct.anon*)* @[[OUTLINED:__omp_outlined[0-9]*]] to void (i8*)*), i8* [[DATA]], i32 0)
+// CHECK: call void @[[OUTLINED]](%struct.anon* [[CAP]])
+// CHECK: call void @GOMP_parallel_end()
+#pragma omp parallel
+  sum += n;
+  foo(sum);
+}
+
+// CHECK: define internal void @[[OUTLINED]](%struct.anon*
+// CHECK: load i32**
+// CHECK: add nsw i32
+
+// The private copy is used instead of the captured variable.
+// CHECK-LABEL: define void @private(
+void private(int x) {
+// CHECK: call void @GOMP_parallel_start(void (i8*)* bitcast (void (%struct.anon{{.*}}*)* @[[PRIV_OUTLINED:__omp_outlined[0-9]*]] to void (i8*)*)
+// CHECK: call void @[[PRIV_OUTLINED]](
+#pragma omp parallel private(x)
+  {
+    x = 1;
+    foo(x);
+  }
+}
+
+// CHECK: define internal void @[[PRIV_OUTLINED]](
+// CHECK: [[X:%x.private]] = alloca i32
+// CHECK: store i32 1, i32* [[X]]
+// CHECK: [[V:%.*]] = load i32* [[X]]
+// CHECK: call void @foo(i32 [[V]])
+
+#else
+
+int global;
+
+void private_global() {
+#pragma omp parallel private(global) // expected-error {{cannot compile this OpenMP private variable yet}}
+  global = 1;
+}
+
+#endif
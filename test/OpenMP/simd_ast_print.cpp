@@ -0,0 +1,45 @@
+// RUN: %clang_cc1 -verify -fopenmp -ast-print %s | FileCheck %s
+// RUN: %clang_cc1 -fopenmp -x c++ -std=c++11 -emit-pch -o %t %s
+// RUN: %clang_cc1 -fopenmp -std=c++11 -include-pch %t -fsyntax-only -verify %s -ast-print | FileCheck %s
+// expected-no-diagnostics
+
+#ifndef HEADER
+#define HEADER
+
+void foo(int);
+
+template <int N>
+void tmpl(int *a) {
+#pragma omp simd safelen(N)
+  for (int i = 0; i < 16; ++i)
+    a[i] = i;
+}
+
+// CHECK: template <int N = 4> void tmpl(int *a) {
+// CHECK-NEXT: #pragma omp simd safelen(4)
+// CHECK-NEXT: for (int i = 0; i < 16; ++i)
+// CHECK: template <int N> void tmpl(int *a) {
+// CHECK-NEXT: #pragma omp simd safelen(N)
+// CHECK-NEXT: for (int i = 0; i < 16; ++i)
+
+int main (int argc, char **argv) {
+  int a[16], t;
+// CHECK: int a[16], t;
+#pragma omp simd
+// CHECK-NEXT: #pragma omp simd
+  for (int i = 0; i < 16; ++i)
+// CHECK-NEXT: for (int i = 0; i < 16; ++i)
+    a[i] = i;
+// CHECK-NEXT: a[i] = i;
+#pragma omp simd private(t) safelen(2 * 4)
+// CHECK-NEXT: #pragma omp simd private(t) safelen(2 * 4)
+  for (int i = 0; i < 16; ++i) {
+// CHECK-NEXT: for (int i = 0; i < 16; ++i) {
+    t = a[i];
+    foo(t);
+  }
+  tmpl<4>(a);
+  return (0);
+}
+
+#endif
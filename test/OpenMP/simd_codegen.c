@@ -0,0 +1,47 @@
+// RUN: %clang_cc1 -fopenmp -emit-llvm %s -o - | FileCheck %s
+
+void foo(int);
+
+// Without safelen, the iterations don't depend on each other.
+// CHECK-LABEL: define void @parallel_access(
+void parallel_access(float *a, float *b, int n) {
+#pragma omp simd
+  for (int i = 0; i < n; ++i)
+// CHECK: load float** {{.*}}, !llvm.mem.parallel_loop_access ![[LOOP1:[0-9]+]]
+// CHECK: store float {{.*}}, !llvm.mem.parallel_loop_access ![[LOOP1]]
+    a[i] = b[i] * 2;
+// CHECK: br label %for.cond, !llvm.loop ![[LOOP1]]
+// CHECK-NOT: parallel_loop_access
+// CHECK: ret void
+}
+
+// CHECK-LABEL: define void @safelen(
+void safelen(float *a, int n) {
+#pragma omp simd safelen(4)
+  for (int i = 4; i < n; ++i)
+// CHECK-NOT: parallel_loop_access
+    a[i] = a[i - 4] + 1;
+// CHECK: br label %for.cond, !llvm.loop ![[LOOP2:[0-9]+]]
+}
+
+// The private copy is only used in the loop.
+// CHECK-LABEL: define void @private(
+void private(int *a, int n) {
+  int t = 0;
+// CHECK: [[T:%t]] = alloca i32
+// CHECK: [[TP:%t.private]] = alloca i32
+// CHECK: store i32 0, i32* [[T]],
+#pragma omp simd private(t)
+  for (int i = 0; i < n; ++i) {
+// CHECK: store i32 {{.*}}, i32* [[TP]]
+    t = a[i];
+    a[i] = t * t;
+  }
+// CHECK: [[V:%.*]] = load i32* [[T]],
+// CHECK: call void @foo(i32 [[V]])
+  foo(t);
+}
+
+// CHECK: ![[LOOP1]] = metadata !{metadata ![[LOOP1]]}
+// CHECK: ![[LOOP2]] = metadata !{metadata ![[LOOP2]], metadata ![[WIDTH:[0-9]+]]}
+// CHECK: ![[WIDTH]] = metadata !{metadata !"llvm.vectorizer.width", i32 4}
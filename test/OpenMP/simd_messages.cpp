@@ -0,0 +1,35 @@
+// RUN: %clang_cc1 -verify -fopenmp -ferror-limit 100 -o - %s
+
+void foo();
+
+template <int N>
+void tmpl(int *a) {
+#pragma omp simd safelen(N) // expected-error {{argument to 'safelen' clause must be a positive integer value}}
+  for (int i = 0; i < 16; ++i)
+    a[i] = i;
+}
+
+int main(int argc, char **argv) {
+  int a[16];
+  #pragma omp simd
+  foo(); // expected-error {{statement after '#pragma omp simd' must be a for loop}}
+  #pragma omp simd safelen // expected-error {{expected '(' after 'safelen'}}
+  for (int i = 0; i < 16; ++i) a[i] = i;
+  #pragma omp simd safelen( // expected-error {{expected expression}} expected-error {{expected ')'}} expected-note {{to match this '('}}
+  for (int i = 0; i < 16; ++i) a[i] = i;
+  #pragma omp simd safelen(4 // expected-error {{expected ')'}} expected-note {{to match this '('}}
+  for (int i = 0; i < 16; ++i) a[i] = i;
+  #pragma omp simd safelen(0) // expected-error {{argument to 'safelen' clause must be a positive integer value}}
+  for (int i = 0; i < 16; ++i) a[i] = i;
+  #pragma omp simd safelen(-4) // expected-error {{argument to 'safelen' clause must be a positive integer value}}
+  for (int i = 0; i < 16; ++i) a[i] = i;
+  #pragma omp simd safelen(4), safelen(8) // expected-error {{directive '#pragma omp simd' cannot contain more than one 'safelen' clause}}
+  for (int i = 0; i < 16; ++i) a[i] = i;
+  #pragma omp simd default(none) // expected-error {{unexpected OpenMP clause 'default' in directive '#pragma omp simd'}}
+  for (int i = 0; i < 16; ++i) a[i] = i;
+  #pragma omp parallel safelen(4) // expected-error {{unexpected OpenMP clause 'safelen' in directive '#pragma omp parallel'}}
+  foo();
+  tmpl<4>(a);
+  tmpl<0>(a); // expected-note {{in instantiation of function template specialization 'tmpl<0>' requested here}}
+  return 0;
+}
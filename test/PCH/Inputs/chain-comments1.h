@@ -0,0 +1,5 @@
+/// Comment for f1.
+void f1(void);
+
+/// Comment for g.
+void g(void);
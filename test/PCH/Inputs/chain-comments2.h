@@ -0,0 +1,5 @@
+/// Comment for f2.
+void f2(void);
+
+/// Comment for the redeclaration of g.
+void g(void);
@@ -0,0 +1,3 @@
+static inline int used_inline(int x) { return x + 1; }
+static inline int unused_inline(int x) { return x + 2; }
+static inline int unused_inline2(int x) { return unused_inline(x) * 2; }
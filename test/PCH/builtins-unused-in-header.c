@@ -0,0 +1,36 @@
+// Builtins that the headers never mention must still be recognized when the
+// headers come from a PCH.
+
+// Without PCH
+// RUN: %clang_cc1 -fsyntax-only -verify -include %s -include %s %s
+
+// With PCH
+// RUN: %clang_cc1 -x c-header -emit-pch -o %t %s
+// RUN: %clang_cc1 -fsyntax-only -verify -include-pch %t -include %s %s
+
+// With chained PCH
+// RUN: %clang_cc1 -fsyntax-only -verify %s -chain-include %s -chain-include %s
+
+// expected-no-diagnostics
+
+#ifndef HEADER1
+#define HEADER1
+
+static inline int likely(int x) { return __builtin_expect(x, 1); }
+
+#elif !defined(HEADER2)
+#define HEADER2
+
+static inline int count(unsigned x) {
+  return __builtin_popcount(x) + likely(x);
+}
+
+#else
+
+int is_nan(double d) { return __builtin_isnan(d) + count(1); }
+
+void *copy(void *dst, const void *src, unsigned long n) {
+  return __builtin_memcpy(dst, src, n);
+}
+
+#endif
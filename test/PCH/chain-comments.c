@@ -0,0 +1,24 @@
+// Comments are read from each PCH in a chain only for the files that contain
+// the declarations whose comments are requested.
+
+// RUN: %clang_cc1 -emit-pch -o %t1 %S/Inputs/chain-comments1.h
+// RUN: %clang_cc1 -emit-pch -o %t2 -include-pch %t1 %S/Inputs/chain-comments2.h
+// RUN: %clang_cc1 -include-pch %t2 -ast-dump -ast-dump-filter f %s \
+// RUN:   | FileCheck %s
+// RUN: %clang_cc1 -include-pch %t2 -ast-dump -ast-dump-filter g %s \
+// RUN:   | FileCheck -check-prefix=CHECK-G %s
+
+// CHECK: Dumping f1:
+// CHECK: TextComment {{.*}} Text=" Comment for f1."
+// CHECK: Dumping f2:
+// CHECK: TextComment {{.*}} Text=" Comment for f2."
+// CHECK: Dumping f3:
+// CHECK: TextComment {{.*}} Text=" Comment for f3."
+
+// CHECK-G: Dumping g:
+// CHECK-G: TextComment {{.*}} Text=" Comment for g."
+// CHECK-G: Dumping g:
+// CHECK-G: TextComment {{.*}} Text=" Comment for the redeclaration of g."
+
+/// Comment for f3.
+void f3(void);
@@ -0,0 +1,25 @@
+// Test with a compressed pch.
+// RUN: %clang_cc1 -x c-header -emit-pch -compress-ast-files -o %t %s
+// RUN: %clang_cc1 -include-pch %t -fsyntax-only -verify %s
+
+// An uncompressed pch of the same header works the same way.
+// RUN: %clang_cc1 -x c-header -emit-pch -o %t.uncompressed %s
+// RUN: %clang_cc1 -include-pch %t.uncompressed -fsyntax-only -verify %s
+
+// expected-no-diagnostics
+
+#ifndef HEADER
+#define HEADER
+
+struct point { int x, y; };
+int origin_distance(struct point p);
+#define ORIGIN { 0, 0 }
+
+#else
+
+int test(void) {
+  struct point p = ORIGIN;
+  return origin_distance(p);
+}
+
+#endif
@@ -0,0 +1,16 @@
+// Test that only the function bodies the translation unit needs are
+// deserialized from a precompiled header.
+
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -emit-pch -o %t %S/Inputs/lazy-function-bodies.h
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -include-pch %t -emit-llvm -o - %s | FileCheck %s
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -include-pch %t -emit-llvm -o %t.ll %s -print-stats 2>&1 | FileCheck -check-prefix=STATS %s
+
+// CHECK: define i32 @main
+// CHECK: define internal i32 @used_inline
+// CHECK-NOT: unused_inline
+
+// STATS: 1/3 function bodies read
+
+int main(void) {
+  return used_inline(1);
+}
@@ -0,0 +1,36 @@
+// Without -fpch-instantiate-templates, f<int> is instantiated in each user of
+// the PCH.
+// RUN: %clang_cc1 -emit-pch -o %t.1.pch %s -DHEADER -verify
+// RUN: %clang_cc1 -include-pch %t.1.pch %s -DLATE -verify
+//
+// With it, f<int> is instantiated while building the PCH, and its users
+// reuse that instantiation.
+// RUN: %clang_cc1 -emit-pch -fpch-instantiate-templates -o %t.2.pch %s -DHEADER -DEARLY -verify
+// RUN: %clang_cc1 -include-pch %t.2.pch %s -verify
+
+#ifdef HEADER
+
+template<typename T> T f() {
+  return T(1) / T(0);
+}
+inline int g() { return f<int>(); }
+
+#ifdef EARLY
+// expected-warning@14 {{division by zero is undefined}}
+// expected-note@16 {{in instantiation of function template specialization 'f<int>' requested here}}
+#else
+// expected-no-diagnostics
+#endif
+
+#else
+
+int h() { return g() + f<int>(); }
+
+#ifdef LATE
+// expected-warning@14 {{division by zero is undefined}}
+// expected-note@16 {{in instantiation of function template specialization 'f<int>' requested here}}
+#else
+// expected-no-diagnostics
+#endif
+
+#endif
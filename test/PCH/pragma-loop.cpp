@@ -0,0 +1,43 @@
+// RUN: %clang_cc1 -std=c++11 -verify -ast-print %s | FileCheck %s
+// RUN: %clang_cc1 -x c++ -std=c++11 -emit-pch -o %t %s
+// RUN: %clang_cc1 -std=c++11 -include-pch %t -fsyntax-only -verify %s -ast-print | FileCheck %s
+// expected-no-diagnostics
+
+#ifndef HEADER
+#define HEADER
+
+// CHECK: #pragma clang loop vectorize(enable) vectorize_width(4)
+// CHECK-NEXT: for (int i = 0; i < Length; ++i)
+// CHECK: #pragma clang loop interleave_count(2) unroll(disable)
+// CHECK-NEXT: while (i < Length)
+// CHECK: #pragma clang loop unroll(enable) unroll_count(8)
+// CHECK-NEXT: do {
+
+template <typename T>
+void run(T *List, int Length) {
+#pragma clang loop vectorize(enable) vectorize_width(4)
+  for (int i = 0; i < Length; ++i)
+    List[i] = i;
+
+  int i = 0;
+#pragma clang loop interleave_count(2)
+#pragma clang loop unroll(disable)
+  while (i < Length) {
+    List[i] = i;
+    ++i;
+  }
+
+  i = 0;
+#pragma clang loop unroll(enable) unroll_count(8)
+  do {
+    List[i] = i;
+  } while (++i < Length);
+}
+
+#else
+
+void test(int *List, int Length) {
+  run(List, Length);
+}
+
+#endif
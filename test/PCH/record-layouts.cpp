@@ -0,0 +1,75 @@
+// Check that record layouts computed when building a PCH are reused by
+// translation units that include it, and that they match the layouts computed
+// from source.
+
+// RUN: %clang_cc1 -triple x86_64-apple-darwin10 -fsyntax-only -include %s \
+// RUN:   -fdump-record-layouts-simple %s > %t.source
+// RUN: %clang_cc1 -triple x86_64-apple-darwin10 -x c++-header -emit-pch \
+// RUN:   -o %t.pch %s
+// RUN: %clang_cc1 -triple x86_64-apple-darwin10 -fsyntax-only \
+// RUN:   -include-pch %t.pch -fdump-record-layouts-simple %s > %t.pch.layouts
+// RUN: diff -u %t.source %t.pch.layouts
+// RUN: FileCheck %s < %t.pch.layouts
+// RUN: %clang_cc1 -triple x86_64-apple-darwin10 -fsyntax-only \
+// RUN:   -include-pch %t.pch -print-stats %s 2>&1 \
+// RUN:   | FileCheck -check-prefix=CHECK-STATS %s
+
+// The same layouts are reused under the Microsoft ABI.
+// RUN: %clang_cc1 -triple i686-pc-win32 -cxx-abi microsoft -fsyntax-only \
+// RUN:   -include %s -fdump-record-layouts-simple %s > %t.ms.source
+// RUN: %clang_cc1 -triple i686-pc-win32 -cxx-abi microsoft \
+// RUN:   -x c++-header -emit-pch -o %t.ms.pch %s
+// RUN: %clang_cc1 -triple i686-pc-win32 -cxx-abi microsoft -fsyntax-only \
+// RUN:   -include-pch %t.ms.pch -fdump-record-layouts-simple %s > %t.ms.layouts
+// RUN: diff -u %t.ms.source %t.ms.layouts
+
+// CHECK: Type: struct Empty
+// CHECK: Type: struct Base
+// CHECK: Type: struct Packed
+// CHECK: Type: struct Derived
+// CHECK: Type: struct Dynamic
+// CHECK: Type: struct WithVirtualBase
+// CHECK-STATS: 5 record layouts read
+
+#ifndef HEADER
+#define HEADER
+
+struct Empty { };
+
+struct Base {
+  char c;
+  int i;
+  unsigned bits : 3;
+};
+
+#pragma pack(push, 1)
+struct Packed {
+  char c;
+  double d;
+};
+#pragma pack(pop)
+
+struct Derived : Empty, Base {
+  Packed p;
+  short s;
+  Empty e;
+};
+
+struct Dynamic : Base {
+  virtual ~Dynamic();
+  long l;
+};
+
+// Classes with virtual bases are always laid out by the ABI.
+struct WithVirtualBase : virtual Base {
+  int j;
+};
+
+#else
+
+int sizes[] = {
+  sizeof(Empty), sizeof(Base), sizeof(Packed), sizeof(Derived),
+  sizeof(Dynamic), sizeof(WithVirtualBase)
+};
+
+#endif
@@ -0,0 +1,28 @@
+// Without PCH
+// RUN: %clang_cc1 -include %s -verify %s
+
+// With PCH
+// RUN: %clang_cc1 -emit-pch %s -o %t.pch
+// RUN: %clang_cc1 -include-pch %t.pch -verify %s
+
+// With a time budget that is never used up
+// RUN: %clang_cc1 -include-pch %t.pch -verify %s -ftypo-correction-budget 100000
+
+#ifndef HEADER_INCLUDED
+#define HEADER_INCLUDED
+
+int countWidgets(int Limit);
+int a_rather_long_identifier_from_the_header;
+
+#else
+
+int x = countWidgetz(1); // expected-error {{use of undeclared identifier 'countWidgetz'; did you mean 'countWidgets'?}}
+// expected-note@14 {{'countWidgets' declared here}}
+int y = a_rather_long_identifier_from_header; // expected-error {{did you mean 'a_rather_long_identifier_from_the_header'?}}
+// expected-note@15 {{declared here}}
+
+// Identifiers seen after a typo was corrected are considered too.
+int localCounter; // expected-note {{'localCounter' declared here}}
+int z = localCountr; // expected-error {{use of undeclared identifier 'localCountr'; did you mean 'localCounter'?}}
+
+#endif
@@ -0,0 +1,55 @@
+// RUN: %clang_cc1 -fdelayed-inline-method-parsing -fsyntax-only -verify -std=c++11 %s
+// RUN: not %clang_cc1 -fdelayed-inline-method-parsing -fsyntax-only -std=c++11 -print-stats %s 2>&1 | FileCheck %s
+
+// The bodies of inline methods are only parsed if the methods are used, so
+// the errors in the unused ones are not diagnosed.
+struct A {
+  void unused() { undeclared(); }
+  void used() { undeclared(); } // expected-error {{use of undeclared identifier 'undeclared'}}
+  void calledByUsed() { int x = "string"; } // expected-error {{cannot initialize a variable of type 'int'}}
+  void usedTwice() { helper(); calledByUsed(); }
+  static int helper() { return 0; }
+};
+
+void f(A &a) {
+  a.used();
+  a.usedTwice();
+  a.usedTwice();
+}
+
+// The virtual methods of a class are used when its vtable is.
+struct B {
+  B() {}
+  virtual void v() { undeclared(); } // expected-error {{use of undeclared identifier 'undeclared'}}
+  virtual ~B() {}
+};
+
+B b;
+
+// Constexpr methods are parsed at once.
+struct C {
+  constexpr int value() const { return 4; }
+};
+static_assert(C().value() == 4, "");
+
+// Inline methods can use names declared after the class, which are found at
+// the end of the translation unit.
+struct D {
+  int get() { return later(); }
+};
+int later();
+int g(D d) { return d.get(); }
+
+// Methods of class templates and local classes are parsed as usual.
+template <typename T> struct E {
+  void m() { T::undeclared(); } // expected-error {{type 'int' cannot be used prior to '::'}}
+};
+template struct E<int>; // expected-note {{in instantiation of member function}}
+
+void h() {
+  struct Local {
+    void m() { undeclared(); } // expected-error {{use of undeclared identifier 'undeclared'}}
+  };
+}
+
+// CHECK: 1 of 9 late parsed inline method bodies never parsed.
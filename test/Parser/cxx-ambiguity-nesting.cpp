@@ -0,0 +1,39 @@
+// RUN: %clang_cc1 -fsyntax-only -Wno-vexing-parse -verify %s
+// expected-no-diagnostics
+
+// Deeply nested declarators that are ambiguous with function-style casts.
+// Each one is disambiguated once, however many constructs enclose it.
+struct T {
+  T();
+  T(int);
+};
+
+#define N1(x) T(x)
+#define N2(x) N1(N1(x))
+#define N4(x) N2(N2(x))
+#define N8(x) N4(N4(x))
+#define N16(x) N8(N8(x))
+#define N32(x) N16(N16(x))
+#define N64(x) N32(N32(x))
+
+int y;
+
+// A declaration of a function, whose parameter is a pointer to a function
+// ... taking a T.
+T f(N64(y));
+
+// An object, initialized with nested casts.
+T g(N64(1));
+
+void test() {
+  T (a)(N64(y));
+  T (b)(N64(y + 1));
+  f(0);
+  a(0);
+  T c = g;
+  T d = b;
+  for (int i = 0; i != 2; ++i) {
+    T (e)(N32(y));
+    e(0);
+  }
+}
@@ -0,0 +1,58 @@
+// RUN: %clang_cc1 -std=c++11 -verify %s
+
+#define WIDTH 4
+
+void test(int *List, int Length) {
+  int i = 0;
+  int Array[4];
+
+#pragma clang loop vectorize(enable)
+#pragma clang loop interleave_count(4)
+  while (i + 1 < Length) {
+    List[i] = i;
+  }
+
+#pragma clang loop vectorize_width(WIDTH) unroll(disable)
+  do {
+    List[i] = i;
+  } while (i < Length);
+
+#pragma clang loop unroll_count(8)
+  for (int j = 0; j < Length; ++j)
+    List[j] = j;
+
+#pragma clang loop vectorize(disable)
+  for (int &x : Array)
+    x = 0;
+
+/* expected-error {{missing option in '#pragma clang loop'}} */ #pragma clang loop
+/* expected-error {{invalid option 'vectorise' in '#pragma clang loop'}} */ #pragma clang loop vectorise(enable)
+/* expected-error {{expected '('}} */ #pragma clang loop vectorize
+/* expected-error {{missing argument to 'unroll_count'}} */ #pragma clang loop unroll_count()
+/* expected-error {{expected ')'}} */ #pragma clang loop unroll_count(4
+/* expected-warning {{extra tokens at end of '#pragma clang loop'}} */ #pragma clang loop unroll(enable) ;
+  while (i < Length)
+    List[i] = i;
+
+/* expected-error {{invalid argument to 'vectorize' in '#pragma clang loop'; expected 'enable' or 'disable'}} */ #pragma clang loop vectorize(4)
+/* expected-error {{invalid argument to 'unroll' in '#pragma clang loop'; expected 'enable' or 'disable'}} */ #pragma clang loop unroll(on)
+/* expected-error {{invalid argument to 'vectorize_width' in '#pragma clang loop'; expected a positive integer value}} */ #pragma clang loop vectorize_width(0)
+/* expected-error {{invalid argument to 'interleave_count' in '#pragma clang loop'; expected a positive integer value}} */ #pragma clang loop interleave_count(enable)
+/* expected-error {{invalid argument to 'unroll_count' in '#pragma clang loop'; expected a positive integer value}} */ #pragma clang loop unroll_count(2.5)
+  while (i < Length)
+    List[i] = i;
+
+/* expected-error {{duplicate 'vectorize_width' hint in '#pragma clang loop'}} */ #pragma clang loop vectorize_width(4) vectorize_width(8)
+  for (int j = 0; j < Length; ++j)
+    List[j] = j;
+
+/* expected-error {{expected a for, while, or do-while loop to follow '#pragma clang loop'}} */ #pragma clang loop unroll(enable)
+  i = 0;
+
+/* expected-error {{expected a for, while, or do-while loop to follow '#pragma clang loop'}} */ #pragma clang loop unroll(enable)
+  if (i < Length)
+    List[i] = i;
+}
+
+/* expected-error {{'#pragma clang loop' can only appear in front of a loop in a function body}} */ #pragma clang loop unroll(enable)
+int global;
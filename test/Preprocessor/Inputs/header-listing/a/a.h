@@ -0,0 +1 @@
+// Only here so that the directory exists.
@@ -0,0 +1 @@
+int also_in_c;
@@ -0,0 +1,2 @@
+#pragma clang diagnostic ignored "-Wunused-variable"
+static void in_leaking_header(void) { int y; }
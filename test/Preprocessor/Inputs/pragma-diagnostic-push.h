@@ -0,0 +1,4 @@
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wunused-variable"
+static void in_pushed_header(void) { int x; }
+#pragma clang diagnostic pop
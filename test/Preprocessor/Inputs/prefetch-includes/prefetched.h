@@ -0,0 +1,2 @@
+#include "nested.h"
+int prefetched;
@@ -0,0 +1,2 @@
+#define FROM_HEADER "from the header"
+#warning in the header
@@ -0,0 +1,17 @@
+// RUN: %clang_cc1 -E -I %S/Inputs/header-listing/a -I %S/Inputs/header-listing/b -I %S/Inputs/header-listing/c %s -o - | FileCheck %s
+// RUN: %clang_cc1 -E -I %S/Inputs/header-listing/a -I %S/Inputs/header-listing/b -I %S/Inputs/header-listing/c %s -o /dev/null -print-stats 2>&1 | FileCheck -check-prefix=STATS %s
+
+// Once a header has been missed in a search directory, the directory is
+// listed, and later headers that aren't in the listing are skipped without
+// a stat.
+
+// CHECK: int in_c;
+#include <in-c.h>
+// CHECK: int also_in_c;
+#include <also-in-c.h>
+// CHECK: int in_sub;
+#include <sub/in-sub.h>
+// CHECK: int in_b;
+#include <sub-b.h>
+
+// STATS: 5 header stats avoided by listing 2 directories.
@@ -0,0 +1,22 @@
+// RUN: %clang_cc1 %s -E | FileCheck %s
+
+// Each use of an argument, pre-expanded or not, gets the tokens of the right
+// argument, including when earlier arguments are empty.
+
+#define ONE 1
+#define MAX(a, b) ((a) > (b) ? (a) : (b))
+#define THIRD(a, b, c) c c
+#define PASTE_AND_USE(a, b) a##b b a
+
+// CHECK: ((1) > (2) ? (1) : (2))
+MAX(ONE, 2)
+// CHECK: ((1 + 1) > (x) ? (1 + 1) : (x))
+MAX(ONE + ONE, x)
+// CHECK: z z
+THIRD(, , z)
+// CHECK: 1 1
+THIRD(x, , ONE)
+// CHECK: xy y x
+PASTE_AND_USE(x, y)
+// CHECK: 1 1
+PASTE_AND_USE(, ONE)
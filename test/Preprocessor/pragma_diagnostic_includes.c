@@ -0,0 +1,22 @@
+// RUN: %clang_cc1 -fsyntax-only -verify -Wunused-variable -I %S/Inputs %s
+
+// Diagnostic pragmas in a header apply to the code after the #include,
+// unless they are undone by a pop.
+
+#include "pragma-diagnostic-push.h"
+
+void f1(void) { int a; } // expected-warning {{unused variable 'a'}}
+
+#include "pragma-diagnostic-leak.h"
+
+void f2(void) { int b; }
+
+#pragma clang diagnostic warning "-Wunused-variable"
+
+#define DECLARE_UNUSED int c
+
+void f3(void) { DECLARE_UNUSED; } // expected-warning {{unused variable 'c'}}
+
+#include "pragma-diagnostic-push.h"
+
+void f4(void) { int d; } // expected-warning {{unused variable 'd'}}
@@ -0,0 +1,10 @@
+// RUN: %clang_cc1 -fprefetch-includes -E -I %S/Inputs/prefetch-includes %s | FileCheck %s
+// RUN: %clang_cc1 -E -I %S/Inputs/prefetch-includes %s | FileCheck %s
+
+#include <prefetched.h>
+#include "prefetched.h"
+# include "nested.h"
+#include_next <nested.h>
+
+// CHECK: int nested;
+// CHECK: int prefetched;
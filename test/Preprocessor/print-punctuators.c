@@ -0,0 +1,26 @@
+// RUN: %clang_cc1 -E %s | FileCheck -strict-whitespace %s
+
+// Punctuators are printed with the spelling they were written with.
+
+// CHECK: int a<:2:> = <% 1, 2 %>;
+int a<:2:> = <% 1, 2 %>;
+// CHECK: x ->* y >>= z ... ;
+x ->* y >>= z ... ;
+// CHECK: p[0] = q ? r : s;
+p[0] = q ? r : s;
+// CHECK: a + b;
+a +\
+ b;
+#define CAT(x, y) x %:%: y
+// CHECK: ab;
+CAT(a, b);
+
+// Lines after a #line directive are still numbered from it.
+// CHECK: {{^}}# 100 "{{.*}}print-punctuators.c"
+// CHECK-NEXT: {{^}}last;
+// CHECK-NEXT: {{^$}}
+// CHECK-NEXT: {{^}}after;
+#line 100
+last;
+
+after;
@@ -0,0 +1,15 @@
+// RUN: rm -rf %t
+// RUN: mkdir %t
+// RUN: echo 'int old_decl;' > %t/header.h
+// RUN: %clang_cc1 -emit-pth %t/header.h -o %t/header.pth
+
+// Tokens cached for a file whose contents have changed are not used.
+// RUN: echo 'int new_decl;' > %t/header.h
+// RUN: %clang_cc1 -include-pth %t/header.pth %s -E | FileCheck %s
+// CHECK: new_decl
+// CHECK-NOT: old_decl
+
+// A PTH file generated with different language options is rejected.
+// RUN: not %clang_cc1 -x c++ -include-pth %t/header.pth %s -E 2>&1 \
+// RUN:   | FileCheck -check-prefix=LANGOPTS %s
+// LANGOPTS: PTH file was generated with different language options
@@ -0,0 +1,15 @@
+// RUN: %clang_cc1 -frelease-finished-files -E -I %S/Inputs/release-finished-files %s -o - | FileCheck %s
+// RUN: %clang_cc1 -frelease-finished-files -fsyntax-only -I %S/Inputs/release-finished-files %s 2>&1 | FileCheck -check-prefix=DIAG %s
+
+// The header is read again after it was released, to be lexed, for the
+// expansion of a macro it defines and for its diagnostics.
+#include "header.h"
+#include "header.h"
+const char *s = FROM_HEADER;
+
+// CHECK: const char *s = "from the header";
+
+// DIAG: header.h:2:2: warning: in the header
+// DIAG-NEXT: #warning in the header
+// DIAG: header.h:2:2: warning: in the header
+// DIAG-NEXT: #warning in the header
@@ -0,0 +1,48 @@
+// RUN: %clang_cc1 -E %s | FileCheck %s
+// RUN: %clang_cc1 -E %s -o /dev/null -print-stats 2>&1 | FileCheck -check-prefix=STATS %s
+
+// Excluded blocks are scanned for directives without being lexed, which must
+// not be fooled by comments, literals or escaped newlines.
+
+// CHECK-NOT: leaked
+#if 0
+leaked: don't end the block at the #endif in this line
+/* leaked
+#endif
+*/
+// leaked \
+#endif
+"leaked: an escaped newline continues the literal \
+#endif
+leaked \
+#endif
+/* a comment before the directive */ #else
+// CHECK: kept_else
+kept_else
+#endif
+
+#if 0
+leaked: '\'' "\"" '"' "'" '#'
+  %:else
+// CHECK: kept_digraph
+kept_digraph
+%:endif
+
+#if 0
+leaked: "/*" #endif
+#elif 1
+// CHECK: kept_elif
+kept_elif
+#endif
+
+#if 0
+leaked_identifier /** a comment * with ** stars
+#endif
+**/ leaked // a line comment */
+#else
+// CHECK: kept_stars
+kept_stars
+#endif
+// CHECK-NOT: leaked
+
+// STATS: 4 #if/#ifndef#ifdef regions skipped, {{[1-9][0-9]*}} bytes of them without lexing.
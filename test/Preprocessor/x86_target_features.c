@@ -30,3 +30,13 @@
 // SSE2: #define __SSE_MATH__ 1
 // SSE2: #define __SSE__ 1
 // SSE2-NOT: #define __SSSE3__ 1
+
+// RUN: %clang -target x86_64-unknown-unknown -march=core2 -x c -E -dM -o - %s | FileCheck --check-prefix=CX16 %s
+// RUN: %clang -target x86_64-unknown-unknown -march=x86-64 -mcx16 -x c -E -dM -o - %s | FileCheck --check-prefix=CX16 %s
+
+// CX16: #define __GCC_HAVE_SYNC_COMPARE_AND_SWAP_16 1
+
+// RUN: %clang -target x86_64-unknown-unknown -march=x86-64 -x c -E -dM -o - %s | FileCheck --check-prefix=NOCX16 %s
+// RUN: %clang -target x86_64-unknown-unknown -march=core2 -mno-cx16 -x c -E -dM -o - %s | FileCheck --check-prefix=NOCX16 %s
+
+// NOCX16-NOT: #define __GCC_HAVE_SYNC_COMPARE_AND_SWAP_16 1
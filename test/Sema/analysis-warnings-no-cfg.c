@@ -0,0 +1,20 @@
+// RUN: %clang_cc1 -fsyntax-only -verify %s
+// RUN: %clang_cc1 -fsyntax-only -Wno-array-bounds -Wunreachable-code -print-stats %s 2>&1 | FileCheck %s
+
+// No CFG is built for a function when the diagnostics that would need one
+// are ignored, whether on the command line or by a pragma.
+void f(void) {
+  int a[2];
+  a[2] = 0; // expected-warning {{array index 2 is past the end of the array}}
+  // expected-note@-2 {{array 'a' declared here}}
+}
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wunreachable-code"
+void g(int x) {
+  return;
+  x = 1;
+}
+#pragma clang diagnostic pop
+
+// CHECK: 0 functions analyzed (0 w/o CFGs).
@@ -0,0 +1,41 @@
+// RUN: %clang_cc1 -fsyntax-only -verify %s
+// RUN: %clang_cc1 -ast-dump %s | FileCheck %s
+
+// Literals of the element type initialize the elements as they are; others
+// are still converted.
+int ints[] = { 1, -2, (3), +4, 'a', 5u };
+// CHECK: VarDecl {{.*}} ints 'int [6]'
+// CHECK-NEXT: InitListExpr {{.*}} 'int [6]'
+// CHECK-NEXT: IntegerLiteral {{.*}} 'int' 1
+// CHECK-NEXT: UnaryOperator {{.*}} 'int' prefix '-'
+// CHECK-NEXT: IntegerLiteral {{.*}} 'int' 2
+// CHECK-NEXT: ParenExpr {{.*}} 'int'
+// CHECK-NEXT: IntegerLiteral {{.*}} 'int' 3
+// CHECK-NEXT: UnaryOperator {{.*}} 'int' prefix '+'
+// CHECK-NEXT: IntegerLiteral {{.*}} 'int' 4
+// CHECK-NEXT: CharacterLiteral {{.*}} 'int' 97
+// CHECK-NEXT: ImplicitCastExpr {{.*}} 'int' <IntegralCast>
+// CHECK-NEXT: IntegerLiteral {{.*}} 'unsigned int' 5
+
+double doubles[4] = { 1.0, -2.5, 3 };
+// CHECK: VarDecl {{.*}} doubles 'double [4]'
+// CHECK-NEXT: InitListExpr {{.*}} 'double [4]'
+// CHECK-NEXT: FloatingLiteral {{.*}} 'double' 1{{$}}
+// CHECK-NEXT: UnaryOperator {{.*}} 'double' prefix '-'
+// CHECK-NEXT: FloatingLiteral {{.*}} 'double' 2.5
+// CHECK-NEXT: ImplicitCastExpr {{.*}} 'double' <IntegralToFloating>
+// CHECK-NEXT: IntegerLiteral {{.*}} 'int' 3
+
+const int table[2][2] = { 1, 2, 3, 4 };
+// CHECK: VarDecl {{.*}} table 'const int [2][2]'
+// CHECK-NEXT: InitListExpr {{.*}} 'const int [2][2]'
+// CHECK-NEXT: InitListExpr {{.*}} 'const int [2]'
+// CHECK-NEXT: IntegerLiteral {{.*}} 'int' 1
+// CHECK-NEXT: IntegerLiteral {{.*}} 'int' 2
+// CHECK-NEXT: InitListExpr {{.*}} 'const int [2]'
+// CHECK-NEXT: IntegerLiteral {{.*}} 'int' 3
+// CHECK-NEXT: IntegerLiteral {{.*}} 'int' 4
+
+// The usual diagnostics still apply.
+int too_many[2] = { 1, 2, 3 }; // expected-warning {{excess elements in array initializer}}
+int overridden[2] = { [0] = 1, [0] = 2 }; // expected-warning {{initializer overrides prior initialization of this subobject}} expected-note {{previous initialization is here}}
@@ -0,0 +1,8 @@
+// RUN: %clang_cc1 -triple x86_64-linux-gnu -fsyntax-only -verify %s
+
+int __attribute__((target("avx,sse4.2"))) foo(void) { return 4; }
+int __attribute__((target("no-sse4a"))) bar(void) { return 4; }
+int __attribute__((target("avx2,hello"))) baz(void) { return 4; } // expected-warning {{ignoring the target attribute: 'hello' is not a feature of this target}}
+int __attribute__((target())) qux(void); // expected-error {{'target' attribute takes one argument}}
+int __attribute__((target(4))) quux(void); // expected-error {{'target' attribute requires a string}}
+int x __attribute__((target("avx"))); // expected-warning {{'target' attribute only applies to functions}}
@@ -0,0 +1,32 @@
+// RUN: %clang_cc1 -fsyntax-only -verify %s
+
+int f(void);
+
+void test_assume(int x, int *p) {
+  __builtin_assume(x > 0);
+  __builtin_assume(p);
+  __builtin_assume(f()); // expected-warning {{the argument to '__builtin_assume' has side effects that will be discarded}}
+  __builtin_assume(x++); // expected-warning {{the argument to '__builtin_assume' has side effects that will be discarded}}
+}
+
+void test_assume_aligned(int *p, int a) {
+  int *q = __builtin_assume_aligned(p, 16);
+  q = __builtin_assume_aligned(p, 16, 8);
+  q = __builtin_assume_aligned(p, 16, a);
+  q = __builtin_assume_aligned(p, a); // expected-error {{argument to '__builtin_assume_aligned' must be a constant integer}}
+  q = __builtin_assume_aligned(p, 12); // expected-error {{requested alignment is not a power of 2}}
+  q = __builtin_assume_aligned(p, 16, 8, 4); // expected-error {{too many arguments to function call, expected at most 3, have 4}}
+  q = __builtin_assume_aligned(p, 16, p); // expected-warning {{incompatible pointer to integer conversion}}
+}
+
+void *a1(int) __attribute__((assume_aligned(32)));
+void *a2(int) __attribute__((assume_aligned(32, 8)));
+void *a3(int) __attribute__((assume_aligned(12))); // expected-error {{requested alignment is not a power of 2}}
+void *a4(int) __attribute__((assume_aligned(32, 8, 4))); // expected-error {{attribute takes no more than 2 arguments}}
+int a5(int) __attribute__((assume_aligned(32))); // expected-warning {{'assume_aligned' attribute only applies to functions that return a pointer}}
+int a6 __attribute__((assume_aligned(32))); // expected-warning {{'assume_aligned' attribute only applies to functions and methods}}
+
+void *b1(int, int) __attribute__((alloc_align(1)));
+void *b2(int, int) __attribute__((alloc_align(3))); // expected-error {{'alloc_align' attribute parameter 1 is out of bounds}}
+void *b3(int *, int) __attribute__((alloc_align(1))); // expected-error {{'alloc_align' attribute requires an integer constant}}
+int b4(int) __attribute__((alloc_align(1))); // expected-warning {{'alloc_align' attribute only applies to functions that return a pointer}}
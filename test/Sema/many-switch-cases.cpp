@@ -0,0 +1,36 @@
+// RUN: %clang_cc1 -fsyntax-only -Wunreachable-code -Wuninitialized -verify %s
+// expected-no-diagnostics
+
+// Check that the CFG of a switch with thousands of cases, each of which has
+// an object with a destructor, is built in reasonable time. Interpreters
+// generated from instruction tables look like this.
+
+struct Guard {
+  Guard(int);
+  ~Guard();
+};
+
+int step(int);
+
+#define CASE(N) case N: { Guard g(N); r = step(N); break; }
+#define CASE10(N) \
+  CASE(N##0) CASE(N##1) CASE(N##2) CASE(N##3) CASE(N##4) \
+  CASE(N##5) CASE(N##6) CASE(N##7) CASE(N##8) CASE(N##9)
+#define CASE100(N) \
+  CASE10(N##0) CASE10(N##1) CASE10(N##2) CASE10(N##3) CASE10(N##4) \
+  CASE10(N##5) CASE10(N##6) CASE10(N##7) CASE10(N##8) CASE10(N##9)
+#define CASE1000(N) \
+  CASE100(N##0) CASE100(N##1) CASE100(N##2) CASE100(N##3) CASE100(N##4) \
+  CASE100(N##5) CASE100(N##6) CASE100(N##7) CASE100(N##8) CASE100(N##9)
+
+int interpret(int op) {
+  Guard outer(0);
+  int r;
+  switch (op) {
+  CASE1000(1) CASE1000(2) CASE1000(3) CASE1000(4) CASE1000(5)
+  CASE1000(6) CASE1000(7) CASE1000(8) CASE1000(9)
+  default:
+    r = 0;
+  }
+  return r;
+}
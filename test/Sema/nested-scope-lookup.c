@@ -0,0 +1,39 @@
+// RUN: %clang_cc1 -fsyntax-only -verify %s
+
+// Lookups from deeply nested blocks must still find the innermost
+// declaration, and the declarations of other kinds in the same scope.
+
+struct s { int m; };
+int s;
+
+void f(void) {
+  {
+    {
+      {
+        struct s v = { s };
+        int s = 1;
+        {
+          {
+            char c[sizeof(s) == sizeof(int) ? 1 : -1];
+            struct s w = { s };
+            (void)v; (void)w; (void)c;
+          }
+        }
+      }
+    }
+  }
+}
+
+void g(int p) {
+  {
+    int p = 2;
+    {
+      {
+        extern int y;
+        int *q = &p;
+        (void)q;
+      }
+      y = 3; // expected-error {{use of undeclared identifier 'y'}}
+    }
+  }
+}
@@ -0,0 +1,13 @@
+// RUN: %clang_cc1 -fsyntax-only -verify %s
+// RUN: %clang_cc1 -fsyntax-only -print-stats %s 2>&1 | FileCheck %s
+
+// The declarations in the prototype scope of a function are kept apart from
+// the function, and are still visible in its body.
+int f(enum E { E1, E2 } e) { // expected-warning {{declaration of 'enum E' will not be visible outside of this function}}
+  return e == E2;
+}
+
+int g(int x) { return x; }
+
+// CHECK: 1 Enum types, {{[0-9]+}} each ({{[0-9]+}} bytes)
+// CHECK: 1 functions with declarations in their prototype scope
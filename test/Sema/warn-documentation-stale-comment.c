@@ -0,0 +1,22 @@
+// RUN: %clang_cc1 -fsyntax-only -Wdocumentation -verify %s
+
+/// A comment that belongs to no declaration, because of the directive.
+#define X 1
+
+int a;
+int b;
+
+// The declarations that follow still get their own comments.
+
+// expected-warning@+1 {{parameter 'y' not found in the function declaration}}
+/// \param y Aaa
+void f(int x);
+
+int c, d;
+
+// expected-warning@+1 {{empty paragraph passed to '\brief' command}}
+/// \brief\author Aaa
+int g(void);
+
+int h(int x); ///< \param z Aaa
+// expected-warning@-1 {{parameter 'z' not found in the function declaration}}
@@ -0,0 +1,26 @@
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -fsyntax-only -verify -Wconversion %s
+
+// Checks that are skipped when their warnings are disabled must still run
+// wherever a pragma enables the warnings again.
+
+int f1(long l) { return l; } // expected-warning {{implicit conversion loses integer precision}}
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wconversion"
+int f2(long l) { return l; }
+#pragma clang diagnostic pop
+
+int f3(long l) { return l; } // expected-warning {{implicit conversion loses integer precision}}
+
+#pragma clang diagnostic ignored "-Wconversion"
+#pragma clang diagnostic error "-Wshorten-64-to-32"
+int f4(long l) { return l; } // expected-error {{implicit conversion loses integer precision}}
+
+int array[2]; // expected-note {{array 'array' declared here}}
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Warray-bounds"
+int g1(void) { return array[2]; }
+#pragma clang diagnostic pop
+
+int g2(void) { return array[2]; } // expected-warning {{array index 2 is past the end of the array}}
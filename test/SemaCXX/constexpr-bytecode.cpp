@@ -0,0 +1,112 @@
+// RUN: %clang_cc1 -std=c++1y -fsyntax-only -verify %s -triple x86_64-linux-gnu -fconstexpr-bytecode
+// RUN: %clang_cc1 -std=c++1y -fsyntax-only -verify %s -triple x86_64-linux-gnu
+
+// The bytecode interpreter must compute the same values as the AST-walking
+// evaluator, and leave the diagnostics to it.
+
+namespace Arithmetic {
+  constexpr unsigned fnv1a(unsigned long long Value) {
+    unsigned Hash = 2166136261u;
+    for (int I = 0; I != 8; ++I) {
+      Hash ^= (Value >> (8 * I)) & 0xff;
+      Hash *= 16777619u;
+    }
+    return Hash;
+  }
+  static_assert(fnv1a(0x0102030405060708) == 0xb37ef675u, "");
+
+  constexpr long long collatz(long long N) {
+    long long Steps = 0;
+    while (N != 1) {
+      N = N % 2 ? 3 * N + 1 : N / 2;
+      ++Steps;
+    }
+    return Steps;
+  }
+  static_assert(collatz(27) == 111, "");
+
+  constexpr int divmod(int A, int B) { return (A / B) * 100 + A % B; }
+  static_assert(divmod(-7, 2) == -301, "");
+
+  constexpr unsigned char wrap(unsigned char C) { return C + 200; }
+  static_assert(wrap(100) == 44, "");
+
+  constexpr short narrow(long long V) { return V; }
+  static_assert(narrow(0x12345) == 0x2345, "");
+  static_assert(narrow(0xffff) == -1, "");
+
+  constexpr int shifts(int A, int B) { return (A << B) | (-A >> B); }
+  static_assert(shifts(3, 2) == -1, "");
+  constexpr int shl(int A, int B) { return A << B; }
+  static_assert(shl(1, 31) < 0, "");
+}
+
+namespace ControlFlow {
+  constexpr int sumOddBelow(int N) {
+    int Sum = 0;
+    for (int I = 0; ; ++I) {
+      if (I >= N)
+        break;
+      if (I % 2 == 0)
+        continue;
+      Sum += I;
+    }
+    int J = 0;
+    do {
+      Sum += J;
+    } while (++J < 3);
+    return Sum;
+  }
+  static_assert(sumOddBelow(10) == 28, "");
+
+  constexpr bool shortCircuit(int N) { return N != 0 && 10 / N > 2; }
+  static_assert(!shortCircuit(0), "");
+  static_assert(shortCircuit(3), "");
+
+  constexpr int postfix(int N) {
+    int Old = N++;
+    return Old * 10 + N--;
+  }
+  static_assert(postfix(4) == 45, "");
+}
+
+namespace Calls {
+  enum Color { Red = 1, Green = 2, Blue = 4 };
+  constexpr Color operator|(Color A, Color B) { return Color(int(A) | int(B)); }
+  static_assert((Red | Blue) == 5, "");
+
+  const int Base = 10;
+  constexpr int Scale = 3;
+  constexpr int undefinedYet(int N);
+  constexpr int recurse(int N) {
+    return N == 0 ? Base : Scale * recurse(N - 1) + undefinedYet(N);
+  }
+  constexpr int undefinedYet(int N) { return N; }
+  static_assert(recurse(3) == 10 * 27 + 9 + 6 + 3, "");
+
+  template<int N> constexpr int fib() { return fib<N - 1>() + fib<N - 2>(); }
+  template<> constexpr int fib<1>() { return 1; }
+  template<> constexpr int fib<0>() { return 0; }
+  static_assert(fib<20>() == 6765, "");
+
+  constexpr int withDefault(int A, int B = sizeof(long)) { return A + B; }
+  static_assert(withDefault(1) == 9, "");
+}
+
+namespace Diagnostics {
+  constexpr int overflow(int N) {
+    return N * 2; // expected-note {{value 4294967294 is outside the range}}
+  }
+  constexpr int A = overflow(2147483647); // expected-error {{constant expression}} expected-note {{in call to 'overflow(2147483647)'}}
+
+  constexpr int div(int A, int B) {
+    return A / B; // expected-note {{division by zero}}
+  }
+  constexpr int B = div(1, 0); // expected-error {{constant expression}} expected-note {{in call to 'div(1, 0)'}}
+
+  constexpr int noReturn(int N) {
+    if (N)
+      return 1;
+  } // expected-warning {{control may reach end}} expected-note {{control reached end of constexpr function}}
+  constexpr int D = noReturn(0); // expected-error {{constant expression}} expected-note {{in call to 'noReturn(0)'}}
+}
@@ -0,0 +1,26 @@
+// RUN: %clang_cc1 -std=c++11 -fsyntax-only -verify %s -fconstexpr-depth 48 -fconstexpr-backtrace-limit 0 -DN=40 -DFIB=102334155
+// RUN: %clang_cc1 -std=c++11 -fsyntax-only -verify %s -fconstexpr-depth 48 -fconstexpr-backtrace-limit 0 -fconstexpr-cache-size 0 -DN=20 -DFIB=6765
+// RUN: %clang_cc1 -std=c++11 -fsyntax-only -verify %s -fconstexpr-depth 48 -fconstexpr-backtrace-limit 0 -fconstexpr-cache-size 1 -DN=20 -DFIB=6765
+
+// Without memoization, fib(40) would take hundreds of millions of steps.
+constexpr int fib(int N) { return N < 2 ? N : fib(N - 1) + fib(N - 2); }
+static_assert(fib(N) == FIB, "");
+
+// A memoized call still counts towards the depth limit wherever it is made.
+namespace Depth {
+  constexpr int depth(int N) {
+    return N ? depth(N - 1) : 0; // expected-note {{exceeded maximum depth of 48 calls}} expected-note +{{in call to}}
+  }
+  constexpr int deeper(int N, int Extra) {
+    return Extra ? deeper(N, Extra - 1) : depth(N); // expected-note +{{in call to}}
+  }
+  constexpr int Shallow = depth(41);
+  constexpr int Deep = deeper(41, 10); // expected-error {{constant expression}} expected-note {{in call to 'deeper(41, 10)'}}
+}
+
+// A memoized call still counts towards the step limit.
+namespace Steps {
+  constexpr int count(int N) { return N ? count(N - 1) + 1 : 0; }
+  constexpr int Once = count(200);
+  constexpr int Twice = count(200) + count(200);
+}
@@ -0,0 +1,35 @@
+// RUN: %clang_cc1 -fsyntax-only -verify %s
+
+// Derivation queries on a complete class are answered from the base class
+// subobjects ASTContext caches for it; check that they agree with a walk of
+// the bases, both before and after the class is complete.
+
+struct Root { };
+struct L1 : virtual Root { };
+struct R1 : virtual Root { };
+struct Join : L1, R1 { };
+struct L2 : Join { };
+struct R2 : Join { };
+struct Twice : L2, R2 { };
+struct Deep : Twice { };
+struct Unrelated { };
+
+struct Incomplete : virtual Root {
+  // The class is still being defined, so this conversion is checked without
+  // the cache.
+  Root *self() { return this; }
+};
+
+Root *toRoot(Deep *d) { return d; }
+L1 *toL1(Deep *d) { return d; } // expected-error{{ambiguous conversion from derived class 'Deep' to base class 'L1':}}
+Join *toJoin(Deep *d) { return d; } // expected-error{{ambiguous conversion from derived class 'Deep' to base class 'Join':}}
+L2 *toL2(Deep *d) { return d; }
+Unrelated *toUnrelated(Deep *d) { return d; } // expected-error{{cannot initialize return object of type 'Unrelated *' with an lvalue of type 'Deep *'}}
+
+// Casting from a virtual base to a derived class is not allowed.
+Deep *fromRoot(Root *r) { return static_cast<Deep *>(r); } // expected-error{{cannot cast 'Root *' to 'Deep *' via virtual base 'Root'}}
+Deep *fromL2(L2 *l) { return static_cast<Deep *>(l); }
+
+void overloaded(Unrelated *);
+int overloaded(L2 *);
+int useOverloaded(Deep *d) { return overloaded(d); }
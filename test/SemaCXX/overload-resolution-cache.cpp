@@ -0,0 +1,61 @@
+// RUN: %clang_cc1 -fsyntax-only -verify %s
+// RUN: %clang_cc1 -fsyntax-only -print-stats %s 2>&1 | FileCheck %s
+
+// Repeated calls with arguments of the same types reuse the result of
+// overload resolution, but functions declared later are still found by
+// argument-dependent lookup.
+namespace N {
+  struct X {};
+  char &h(X, long);
+  X operator+(X, X);
+}
+
+void t1(N::X x, int i) {
+  char &c1 = h(x, i);
+  char &c2 = h(x, i);
+  N::X x1 = x + x;
+  N::X x2 = x + x;
+}
+
+namespace N {
+  int &h(X, int);
+  int &operator+(X, int);
+}
+
+void t2(N::X x, int i) {
+  int &r1 = h(x, i);
+  int &r2 = x + i;
+}
+
+// A class that is completed later can make a different candidate viable.
+struct Base {};
+struct Derived;
+int &k(Base *);
+char &k(void *);
+
+void t3(Derived *p) {
+  char &c = k(p);
+}
+
+struct Derived : Base {};
+
+void t4(Derived *p) {
+  int &r = k(p);
+}
+
+// Candidates with parameters of unrelated classes are ruled out without
+// enumerating conversions, with the same notes as before.
+struct P {};
+struct Q {};
+struct R { R(int); };
+
+void m(const P &); // expected-note {{candidate function not viable: no known conversion from 'Q' to 'const P' for 1st argument}}
+void m(P &); // expected-note {{candidate function not viable: no known conversion from 'Q' to 'P &' for 1st argument}}
+void m(R); // expected-note {{candidate function not viable: no known conversion from 'Q' to 'R' for 1st argument}}
+
+void t5(Q q) {
+  m(q); // expected-error {{no matching function for call to 'm'}}
+}
+
+// CHECK: {{[1-9][0-9]*}} overload candidate conversions ruled out early.
+// CHECK: {{[1-9][0-9]*}} overload resolution cache hits, {{[0-9]+}} misses.
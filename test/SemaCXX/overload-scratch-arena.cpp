@@ -0,0 +1,28 @@
+// RUN: %clang_cc1 -fsyntax-only -verify %s
+// RUN: %clang_cc1 -fsyntax-only -print-stats %s 2>&1 | FileCheck %s
+// expected-no-diagnostics
+
+// Sets of more candidates than fit inline take their conversion sequences
+// from Sema's scratch arena, which reuses the memory of earlier sets.
+template<int N> struct A {};
+
+int &f(A<0>); int &f(A<1>); int &f(A<2>); int &f(A<3>); int &f(A<4>);
+int &f(A<5>); int &f(A<6>); int &f(A<7>); int &f(A<8>); int &f(A<9>);
+char &f(A<10>); char &f(A<11>); char &f(A<12>); char &f(A<13>);
+char &f(A<14>); char &f(A<15>); char &f(A<16>); char &f(A<17>);
+char &f(A<18>); char &f(A<19>);
+
+struct B {
+  operator A<4>();
+};
+
+void test(A<3> a3, A<17> a17, B b) {
+  int &i1 = f(a3);
+  char &c1 = f(a17);
+  // Converting the argument resolves the conversion functions of B while the
+  // outer set is still being built.
+  int &i2 = f(b);
+}
+
+// CHECK: {{[1-9][0-9]*}} scratch allocations ({{[0-9]+}} bytes), 1 of which called malloc; {{[0-9]+}} refused to outer scopes.
+// CHECK: 1 scratch slabs of 16384 bytes.
@@ -0,0 +1,60 @@
+// RUN: %clang_cc1 -fsyntax-only -std=c++11 -verify %s
+// RUN: %clang_cc1 -fsyntax-only -std=c++11 -print-stats %s 2>&1 | FileCheck %s
+
+// Repeated deductions with explicit template arguments and arguments of the
+// same types reuse the earlier result.
+template<typename To, typename From> To convert(From f) { return f; }
+
+void t1(int i, long l) {
+  double d1 = convert<double>(i);
+  double d2 = convert<double>(i);
+  float f1 = convert<float>(l);
+}
+
+// Cached failures still produce the same notes.
+template<typename T> typename T::type member_type(T); // expected-note 2 {{candidate template ignored: substitution failure [with T = int]: type 'int' cannot be used prior to '::' because it has no members}}
+template<typename T> void same(T, T); // expected-note 2 {{candidate template ignored: deduced conflicting types for parameter 'T' ('int' vs. 'double')}}
+
+void t2(int i, double d) {
+  member_type(i); // expected-error {{no matching function for call to 'member_type'}}
+  member_type(i); // expected-error {{no matching function for call to 'member_type'}}
+  same(i, d); // expected-error {{no matching function for call to 'same'}}
+  same(i, d); // expected-error {{no matching function for call to 'same'}}
+}
+
+// Substituting into the return type can depend on functions declared later.
+namespace N {
+  struct X {};
+}
+template<typename T> decltype(g(T())) call_g(T);
+int call_g(...);
+
+void t3(N::X x) {
+  int i = call_g(x);
+}
+
+namespace N {
+  char g(X);
+}
+
+void t4(N::X x) {
+  char c = call_g(x);
+}
+
+// A class that is completed later can be deduced from differently.
+template<typename T> struct B {};
+struct D;
+template<typename T> char &derived(B<T> *);
+int &derived(void *);
+
+void t5(D *p) {
+  int &r = derived(p);
+}
+
+struct D : B<int> {};
+
+void t6(D *p) {
+  char &c = derived(p);
+}
+
+// CHECK: {{[1-9][0-9]*}} template argument deduction cache hits, {{[0-9]+}} misses.
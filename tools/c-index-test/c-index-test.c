@@ -17,7 +17,10 @@
 
 #ifdef _WIN32
 #  include <direct.h>
+#  include <windows.h>
 #else
+#  include <sys/resource.h>
+#  include <sys/time.h>
 #  include <unistd.h>
 #endif
 
@@ -74,6 +77,10 @@ static unsigned getDefaultParsingOptions() {
     options |= CXTranslationUnit_SkipFunctionBodies;
   if (getenv("CINDEXTEST_COMPLETION_BRIEF_COMMENTS"))
     options |= CXTranslationUnit_IncludeBriefCommentsInCodeCompletion;
+  if (getenv("CINDEXTEST_BACKGROUND_PREAMBLE"))
+    options |= CXTranslationUnit_BackgroundPreambleRebuild;
+  if (getenv("CINDEXTEST_INCREMENTAL_REPARSE"))
+    options |= CXTranslationUnit_IncrementalReparse;
   
   return options;
 }
@@ -1359,6 +1366,16 @@ int perform_test_load_tu(const char *file, const char *filter,
   return result;
 }
 
+/* Hibernate the translation unit if requested, so that the next use of it
+ * reloads it. */
+static int hibernate_if_requested(CXTranslationUnit TU) {
+  if (getenv("CINDEXTEST_HIBERNATE") && clang_hibernateTranslationUnit(TU)) {
+    fprintf(stderr, "Unable to hibernate translation unit!\n");
+    return 1;
+  }
+  return 0;
+}
+
 int perform_test_load_source(int argc, const char **argv,
                              const char *filter, CXCursorVisitor Visitor,
                              PostVisitTU PV) {
@@ -1396,6 +1413,13 @@ int perform_test_load_source(int argc, const char **argv,
     return 1;
   }
 
+  if (hibernate_if_requested(TU)) {
+    clang_disposeTranslationUnit(TU);
+    free_remapped_files(unsaved_files, num_unsaved_files);
+    clang_disposeIndex(Idx);
+    return 1;
+  }
+
   result = perform_test_load(Idx, TU, filter, NULL, Visitor, PV,
                              CommentSchemaFile);
   free_remapped_files(unsaved_files, num_unsaved_files);
@@ -1446,6 +1470,13 @@ int perform_test_reparse_source(int argc, const char **argv, int trials,
   }
 
   for (trial = 0; trial < trials; ++trial) {
+    if (hibernate_if_requested(TU)) {
+      clang_disposeTranslationUnit(TU);
+      free_remapped_files(unsaved_files, num_unsaved_files);
+      clang_disposeIndex(Idx);
+      return -1;
+    }
+
     if (clang_reparseTranslationUnit(TU,
                              trial >= remap_after_trial ? num_unsaved_files : 0,
                              trial >= remap_after_trial ? unsaved_files : 0,
@@ -1460,6 +1491,13 @@ int perform_test_reparse_source(int argc, const char **argv, int trials,
     if (checkForErrors(TU) != 0)
       return -1;
   }
+
+  if (hibernate_if_requested(TU)) {
+    clang_disposeTranslationUnit(TU);
+    free_remapped_files(unsaved_files, num_unsaved_files);
+    clang_disposeIndex(Idx);
+    return -1;
+  }
   
   result = perform_test_load(Idx, TU, filter, NULL, Visitor, PV, NULL);
 
@@ -1875,11 +1913,18 @@ int perform_code_completion(int argc, const char **argv, int timing_only) {
   CXTranslationUnit TU = 0;
   unsigned I, Repeats = 1;
   unsigned completionOptions = clang_defaultCodeCompleteOptions();
+  const char *completionFilter = getenv("CINDEXTEST_COMPLETION_FILTER");
+  const char *completionMaxResults = getenv("CINDEXTEST_COMPLETION_MAX_RESULTS");
+  unsigned maxResults = 0;
   
+  if (completionMaxResults)
+    maxResults = (unsigned)atoi(completionMaxResults);
   if (getenv("CINDEXTEST_CODE_COMPLETE_PATTERNS"))
     completionOptions |= CXCodeComplete_IncludeCodePatterns;
   if (getenv("CINDEXTEST_COMPLETION_BRIEF_COMMENTS"))
     completionOptions |= CXCodeComplete_IncludeBriefComments;
+  if (getenv("CINDEXTEST_COMPLETION_REUSE_RESULTS"))
+    completionOptions |= CXCodeComplete_ReuseResults;
   
   if (timing_only)
     input += strlen("-code-completion-timing=");
@@ -1913,9 +1958,15 @@ int perform_code_completion(int argc, const char **argv, int timing_only) {
   }
   
   for (I = 0; I != Repeats; ++I) {
-    results = clang_codeCompleteAt(TU, filename, line, column,
-                                   unsaved_files, num_unsaved_files,
-                                   completionOptions);
+    if (completionFilter || maxResults)
+      results = clang_codeCompleteAtWithFilter(TU, filename, line, column,
+                                               unsaved_files, num_unsaved_files,
+                                               completionOptions,
+                                               completionFilter, maxResults);
+    else
+      results = clang_codeCompleteAt(TU, filename, line, column,
+                                     unsaved_files, num_unsaved_files,
+                                     completionOptions);
     if (!results) {
       fprintf(stderr, "Unable to perform code completion!\n");
       return 1;
@@ -2833,10 +2884,18 @@ static unsigned getIndexOptions(void) {
     index_opts |= CXIndexOpt_IndexFunctionLocalSymbols;
   if (!getenv("CINDEXTEST_DISABLE_SKIPPARSEDBODIES"))
     index_opts |= CXIndexOpt_SkipParsedBodiesInSession;
+  if (getenv("CINDEXTEST_INTERN_USRS"))
+    index_opts |= CXIndexOpt_InternUSRs;
 
   return index_opts;
 }
 
+static void setUnitIndexDirectory(CXIndexAction idxAction) {
+  const char *dir = getenv("CINDEXTEST_UNIT_INDEX_DIR");
+  if (dir && clang_IndexAction_setUnitIndexDirectory(idxAction, dir))
+    fprintf(stderr, "could not use unit index directory '%s'\n", dir);
+}
+
 static int index_compile_args(int num_args, const char **args,
                               CXIndexAction idxAction,
                               ImportedASTFilesData *importedASTs,
@@ -2921,6 +2980,7 @@ static int index_file(int argc, const char **argv, int full) {
     return 1;
   }
   idxAction = clang_IndexAction_create(Idx);
+  setUnitIndexDirectory(idxAction);
   importedASTs = 0;
   if (full)
     importedASTs = importedASTs_create();
@@ -2974,6 +3034,65 @@ static int index_tu(int argc, const char **argv) {
   return result;
 }
 
+static int index_compile_commands_parallel(CXIndexAction idxAction,
+                                           CXCompileCommands CCmds,
+                                           unsigned num_threads) {
+  IndexerCallbacks silentCB;
+  CXIndexSourceFileCommand *cmds;
+  CXString *dirs;
+  CXString **cxargs;
+  const char ***args;
+  unsigned *numArgs;
+  unsigned i, a, numCmds, numFailed;
+
+  numCmds = clang_CompileCommands_getSize(CCmds);
+  cmds = (CXIndexSourceFileCommand *)malloc(numCmds * sizeof(*cmds));
+  dirs = (CXString *)malloc(numCmds * sizeof(*dirs));
+  cxargs = (CXString **)malloc(numCmds * sizeof(*cxargs));
+  args = (const char ***)malloc(numCmds * sizeof(*args));
+  numArgs = (unsigned *)malloc(numCmds * sizeof(*numArgs));
+
+  for (i = 0; i != numCmds; ++i) {
+    CXCompileCommand CCmd = clang_CompileCommands_getCommand(CCmds, i);
+    dirs[i] = clang_CompileCommand_getDirectory(CCmd);
+    numArgs[i] = clang_CompileCommand_getNumArgs(CCmd);
+    cxargs[i] = (CXString *)malloc(numArgs[i] * sizeof(CXString));
+    args[i] = (const char **)malloc(numArgs[i] * sizeof(const char *));
+    for (a = 0; a != numArgs[i]; ++a) {
+      cxargs[i][a] = clang_CompileCommand_getArg(CCmd, a);
+      args[i][a] = clang_getCString(cxargs[i][a]);
+    }
+    cmds[i].working_directory = clang_getCString(dirs[i]);
+    cmds[i].source_filename = 0;
+    /* Skip the name of the compiler. */
+    cmds[i].command_line_args = numArgs[i] ? args[i] + 1 : args[i];
+    cmds[i].num_command_line_args = numArgs[i] ? numArgs[i] - 1 : 0;
+  }
+
+  /* The callbacks would run on several threads at once, so there are none;
+     the results are checked through the unit indexes. */
+  memset(&silentCB, 0, sizeof(silentCB));
+  numFailed = clang_indexSourceFiles(idxAction, 0, &silentCB,
+                                     sizeof(silentCB), getIndexOptions(),
+                                     cmds, numCmds, num_threads,
+                                     getDefaultParsingOptions());
+  printf("indexed %u translation units, %u failed\n", numCmds, numFailed);
+
+  for (i = 0; i != numCmds; ++i) {
+    for (a = 0; a != numArgs[i]; ++a)
+      clang_disposeString(cxargs[i][a]);
+    clang_disposeString(dirs[i]);
+    free(cxargs[i]);
+    free(args[i]);
+  }
+  free(cmds);
+  free(dirs);
+  free(cxargs);
+  free(args);
+  free(numArgs);
+  return numFailed ? -1 : 0;
+}
+
 static int index_compile_db(int argc, const char **argv) {
   const char *check_prefix;
   CXIndex Idx;
@@ -3000,6 +3119,7 @@ static int index_compile_db(int argc, const char **argv) {
     return 1;
   }
   idxAction = clang_IndexAction_create(Idx);
+  setUnitIndexDirectory(idxAction);
 
   {
     const char *database = argv[0];
@@ -3052,6 +3172,12 @@ static int index_compile_db(int argc, const char **argv) {
         goto cdb_end;
       }
 
+      if (getenv("CINDEXTEST_INDEX_THREADS")) {
+        errorCode = index_compile_commands_parallel(idxAction, CCmds,
+                                     atoi(getenv("CINDEXTEST_INDEX_THREADS")));
+        goto cdb_end;
+      }
+
       for (i=0; i<numCmds && errorCode == 0; ++i) {
         CCmd = clang_CompileCommands_getCommand(CCmds, i);
 
@@ -3097,6 +3223,51 @@ static int index_compile_db(int argc, const char **argv) {
   return errorCode;
 }
 
+static void print_unit_index_occurrence(CXClientData client_data,
+                                        const char *file,
+                                        unsigned line, unsigned column,
+                                        CXUnitIndexRole role) {
+  const char *kind = "reference";
+  if (role == CXUnitIndexRole_Declaration)
+    kind = "declaration";
+  else if (role == CXUnitIndexRole_Definition)
+    kind = "definition";
+  printf("%s:%u:%u: %s\n", file, line, column, kind);
+}
+
+static int unit_index_find_usr(const char *usr, const char *index_path) {
+  if (clang_UnitIndex_findOccurrences(index_path, usr,
+                                      print_unit_index_occurrence, 0)) {
+    fprintf(stderr, "could not read unit index '%s'\n", index_path);
+    return 1;
+  }
+  return 0;
+}
+
+static void print_unit_index_inclusion(CXClientData client_data,
+                                       const char *includer,
+                                       const char *included,
+                                       unsigned line) {
+  printf("%s:%u: includes %s\n", includer, line, included);
+}
+
+static int unit_index_inclusions(const char *index_path) {
+  if (clang_UnitIndex_visitInclusions(index_path,
+                                      print_unit_index_inclusion, 0)) {
+    fprintf(stderr, "could not read unit index '%s'\n", index_path);
+    return 1;
+  }
+  return 0;
+}
+
+static int unit_index_merge(const char *unit_dir, const char *output_path) {
+  if (clang_mergeUnitIndexes(unit_dir, output_path)) {
+    fprintf(stderr, "could not merge unit indexes into '%s'\n", output_path);
+    return 1;
+  }
+  return 0;
+}
+
 int perform_token_annotation(int argc, const char **argv) {
   const char *input = argv[1];
   char *filename = 0;
@@ -3555,6 +3726,216 @@ int write_pch_file(const char *filename, int argc, const char *argv[]) {
   return result;
 }
 
+/******************************************************************************/
+/* Benchmarking.                                                              */
+/******************************************************************************/
+
+typedef enum {
+  Benchmark_Parse,
+  Benchmark_Reparse,
+  Benchmark_Complete,
+  Benchmark_Cursor
+} BenchmarkKind;
+
+/* Return the current wall-clock time, in milliseconds. */
+static double get_benchmark_time(void) {
+#ifdef _WIN32
+  LARGE_INTEGER Frequency, Counter;
+  QueryPerformanceFrequency(&Frequency);
+  QueryPerformanceCounter(&Counter);
+  return (double)Counter.QuadPart * 1000.0 / (double)Frequency.QuadPart;
+#else
+  struct timeval Now;
+  gettimeofday(&Now, 0);
+  return (double)Now.tv_sec * 1000.0 + (double)Now.tv_usec / 1000.0;
+#endif
+}
+
+/* Return the peak resident set size of the process, in kilobytes, or 0 if it
+   is not known. */
+static unsigned long get_peak_rss_kb(void) {
+#ifdef _WIN32
+  return 0;
+#else
+  struct rusage Usage;
+  if (getrusage(RUSAGE_SELF, &Usage))
+    return 0;
+#  ifdef __APPLE__
+  return (unsigned long)Usage.ru_maxrss / 1024;
+#  else
+  return (unsigned long)Usage.ru_maxrss;
+#  endif
+#endif
+}
+
+static int compare_durations(const void *LHS, const void *RHS) {
+  double L = *(const double *)LHS, R = *(const double *)RHS;
+  return L < R ? -1 : L > R ? 1 : 0;
+}
+
+/* Return the nearest-rank percentile of the sorted durations. */
+static double get_percentile(const double *Durations, unsigned N,
+                             unsigned Percent) {
+  unsigned Rank = (N * Percent + 99) / 100;
+  return Durations[Rank ? Rank - 1 : 0];
+}
+
+/* Repeat a parse, reparse, code completion or clang_getCursor() call and
+   print the distribution of its latency along with the peak RSS, e.g.
+     c-index-test -benchmark-complete=file.c:10:5 20 file.c -Iinclude
+   Reparses, completions and cursor lookups are measured against a translation
+   unit that has already been parsed and reparsed once, so that its preamble
+   and completion cache are in place, as they would be in an editor. */
+static int perform_benchmark(int argc, const char **argv) {
+  const char *Mode = argv[1] + strlen("-benchmark-");
+  const char *Name = Mode;
+  BenchmarkKind Kind;
+  char *Filename = 0;
+  unsigned Line = 0, Column = 0;
+  unsigned Iterations, I;
+  char *EndPtr = 0;
+  double *Durations;
+  double Start;
+  struct CXUnsavedFile *UnsavedFiles = 0;
+  int NumUnsavedFiles = 0;
+  CXIndex Idx;
+  CXTranslationUnit TU = 0;
+  CXSourceLocation Loc = clang_getNullLocation();
+  unsigned CompletionOptions = clang_defaultCodeCompleteOptions();
+  int Result = 0;
+
+  if (strcmp(Mode, "parse") == 0)
+    Kind = Benchmark_Parse;
+  else if (strcmp(Mode, "reparse") == 0)
+    Kind = Benchmark_Reparse;
+  else if (strncmp(Mode, "complete=", 9) == 0) {
+    Kind = Benchmark_Complete;
+    Name = "complete";
+  } else if (strncmp(Mode, "cursor=", 7) == 0) {
+    Kind = Benchmark_Cursor;
+    Name = "cursor";
+  } else {
+    fprintf(stderr, "unknown benchmark '%s'\n", argv[1]);
+    return 1;
+  }
+
+  if (Kind == Benchmark_Complete || Kind == Benchmark_Cursor) {
+    int ErrorCode = parse_file_line_column(strchr(Mode, '=') + 1, &Filename,
+                                           &Line, &Column, 0, 0);
+    if (ErrorCode)
+      return ErrorCode;
+  }
+
+  Iterations = (unsigned)strtol(argv[2], &EndPtr, 10);
+  if (*EndPtr != '\0' || Iterations == 0) {
+    fprintf(stderr, "invalid number of iterations '%s'\n", argv[2]);
+    free(Filename);
+    return 1;
+  }
+
+  if (parse_remapped_files(argc, argv, 3, &UnsavedFiles, &NumUnsavedFiles)) {
+    free(Filename);
+    return -1;
+  }
+  argv += 3 + NumUnsavedFiles;
+  argc -= 3 + NumUnsavedFiles;
+
+  if (getenv("CINDEXTEST_CODE_COMPLETE_PATTERNS"))
+    CompletionOptions |= CXCodeComplete_IncludeCodePatterns;
+  if (getenv("CINDEXTEST_COMPLETION_BRIEF_COMMENTS"))
+    CompletionOptions |= CXCodeComplete_IncludeBriefComments;
+  if (getenv("CINDEXTEST_COMPLETION_REUSE_RESULTS"))
+    CompletionOptions |= CXCodeComplete_ReuseResults;
+
+  Durations = (double *)malloc(Iterations * sizeof(double));
+  Idx = clang_createIndex(0, 0);
+
+  if (Kind != Benchmark_Parse) {
+    TU = clang_parseTranslationUnit(Idx, 0, argv, argc, UnsavedFiles,
+                                    NumUnsavedFiles,
+                                    getDefaultParsingOptions());
+    if (!TU ||
+        clang_reparseTranslationUnit(TU, NumUnsavedFiles, UnsavedFiles,
+                                     clang_defaultReparseOptions(TU))) {
+      fprintf(stderr, "Unable to load translation unit!\n");
+      Result = 1;
+      goto done;
+    }
+  }
+
+  if (Kind == Benchmark_Cursor) {
+    CXFile File = clang_getFile(TU, Filename);
+    if (!File) {
+      fprintf(stderr, "file '%s' is not part of the translation unit\n",
+              Filename);
+      Result = 1;
+      goto done;
+    }
+    Loc = clang_getLocation(TU, File, Line, Column);
+  }
+
+  for (I = 0; I != Iterations; ++I) {
+    Start = get_benchmark_time();
+    switch (Kind) {
+    case Benchmark_Parse:
+      TU = clang_parseTranslationUnit(Idx, 0, argv, argc, UnsavedFiles,
+                                      NumUnsavedFiles,
+                                      getDefaultParsingOptions());
+      if (!TU)
+        Result = 1;
+      break;
+
+    case Benchmark_Reparse:
+      Result = clang_reparseTranslationUnit(TU, NumUnsavedFiles, UnsavedFiles,
+                                            clang_defaultReparseOptions(TU));
+      break;
+
+    case Benchmark_Complete: {
+      CXCodeCompleteResults *Results
+        = clang_codeCompleteAt(TU, Filename, Line, Column, UnsavedFiles,
+                               NumUnsavedFiles, CompletionOptions);
+      if (Results)
+        clang_disposeCodeCompleteResults(Results);
+      else
+        Result = 1;
+      break;
+    }
+
+    case Benchmark_Cursor:
+      clang_getCursor(TU, Loc);
+      break;
+    }
+    Durations[I] = get_benchmark_time() - Start;
+
+    if (Result) {
+      fprintf(stderr, "benchmark iteration %u failed\n", I);
+      goto done;
+    }
+
+    if (Kind == Benchmark_Parse) {
+      clang_disposeTranslationUnit(TU);
+      TU = 0;
+    }
+  }
+
+  qsort(Durations, Iterations, sizeof(double), compare_durations);
+  printf("%s: %u iterations, p50 %.3f ms, p95 %.3f ms, p99 %.3f ms, "
+         "peak RSS %lu KB\n", Name, Iterations,
+         get_percentile(Durations, Iterations, 50),
+         get_percentile(Durations, Iterations, 95),
+         get_percentile(Durations, Iterations, 99),
+         get_peak_rss_kb());
+
+done:
+  if (TU)
+    clang_disposeTranslationUnit(TU);
+  clang_disposeIndex(Idx);
+  free(Durations);
+  free(Filename);
+  free_remapped_files(UnsavedFiles, NumUnsavedFiles);
+  return Result;
+}
+
 /******************************************************************************/
 /* Serialized diagnostics.                                                    */
 /******************************************************************************/
@@ -3742,6 +4123,9 @@ static void print_usage(void) {
     "       c-index-test -index-file-full [-check-prefix=<FileCheck prefix>] <compiler arguments>\n"
     "       c-index-test -index-tu [-check-prefix=<FileCheck prefix>] <AST file>\n"
     "       c-index-test -index-compile-db [-check-prefix=<FileCheck prefix>] <compilation database>\n"
+    "       c-index-test -unit-index-merge <unit index directory> <output>\n"
+    "       c-index-test -unit-index-find-usr <USR> <unit index>\n"
+    "       c-index-test -unit-index-inclusions <unit index>\n"
     "       c-index-test -test-file-scan <AST file> <source file> "
           "[FileCheck prefix]\n");
   fprintf(stderr,
@@ -3772,7 +4156,12 @@ static void print_usage(void) {
   fprintf(stderr,
     "       c-index-test -compilation-db [lookup <filename>] database\n");
   fprintf(stderr,
-    "       c-index-test -read-diagnostics <file>\n\n");
+    "       c-index-test -read-diagnostics <file>\n");
+  fprintf(stderr,
+    "       c-index-test -benchmark-parse <iterations> {<args>}*\n"
+    "       c-index-test -benchmark-reparse <iterations> {<args>}*\n"
+    "       c-index-test -benchmark-complete=<site> <iterations> {<args>}*\n"
+    "       c-index-test -benchmark-cursor=<site> <iterations> {<args>}*\n\n");
   fprintf(stderr,
     " <symbol filter> values:\n%s",
     "   all - load all symbols, including those from PCH\n"
@@ -3795,6 +4184,8 @@ int cindextest_main(int argc, const char **argv) {
     return perform_code_completion(argc, argv, 0);
   if (argc > 2 && strstr(argv[1], "-code-completion-timing=") == argv[1])
     return perform_code_completion(argc, argv, 1);
+  if (argc > 3 && strstr(argv[1], "-benchmark-") == argv[1])
+    return perform_benchmark(argc, argv);
   if (argc > 2 && strstr(argv[1], "-cursor-at=") == argv[1])
     return inspect_cursor_at(argc, argv);
   if (argc > 2 && strstr(argv[1], "-file-refs-at=") == argv[1])
@@ -3809,6 +4200,12 @@ int cindextest_main(int argc, const char **argv) {
     return index_tu(argc - 2, argv + 2);
   if (argc > 2 && strcmp(argv[1], "-index-compile-db") == 0)
     return index_compile_db(argc - 2, argv + 2);
+  if (argc > 3 && strcmp(argv[1], "-unit-index-merge") == 0)
+    return unit_index_merge(argv[2], argv[3]);
+  if (argc > 3 && strcmp(argv[1], "-unit-index-find-usr") == 0)
+    return unit_index_find_usr(argv[2], argv[3]);
+  if (argc > 2 && strcmp(argv[1], "-unit-index-inclusions") == 0)
+    return unit_index_inclusions(argv[2]);
   else if (argc >= 4 && strncmp(argv[1], "-test-load-tu", 13) == 0) {
     CXCursorVisitor I = GetVisitor(argv[1] + 13);
     if (I)
@@ -17,13 +17,17 @@
 #include "clang/Basic/DiagnosticOptions.h"
 #include "clang/Basic/FileManager.h"
 #include "clang/Basic/SourceManager.h"
+#include "clang/Basic/WorkerPool.h"
 #include "clang/Format/Format.h"
 #include "clang/Lex/Lexer.h"
 #include "clang/Rewrite/Core/Rewriter.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Mutex.h"
+#include "llvm/Support/Program.h"
 #include "llvm/Support/Signals.h"
 #include "llvm/ADT/StringMap.h"
+#include <cstdio>
 
 using namespace llvm;
 
@@ -91,12 +95,33 @@ static cl::opt<unsigned>
                     " an editor integration"),
            cl::init(0), cl::cat(ClangFormatCategory));
 
+static cl::opt<bool>
+    TimePhases("time-phases",
+               cl::desc("Print the time spent in each phase of formatting\n"
+                        "to stderr. Formats one file at a time."),
+               cl::cat(ClangFormatCategory));
+static cl::opt<unsigned>
+    Jobs("j", cl::desc("Number of files to format concurrently, or 0 for one\n"
+                       "per hardware thread. Only used with several\n"
+                       "input files."),
+         cl::init(1), cl::Prefix, cl::cat(ClangFormatCategory));
+
+static cl::opt<bool>
+    Server("server",
+           cl::desc("Keep running and format the code of each request read\n"
+                    "from stdin, as used by editor integrations. Can't\n"
+                    "be used with input files."),
+           cl::cat(ClangFormatCategory));
+
 static cl::list<std::string> FileNames(cl::Positional, cl::desc("[<file> ...]"),
                                        cl::cat(ClangFormatCategory));
 
 namespace clang {
 namespace format {
 
+// The totals for all the files, if -time-phases is given.
+static FormatStatistics PhaseStatistics;
+
 static FileID createInMemoryFile(StringRef FileName, const MemoryBuffer *Source,
                                  SourceManager &Sources, FileManager &Files) {
   const FileEntry *Entry = Files.getVirtualFile(FileName == "-" ? "<stdin>" :
@@ -106,6 +131,39 @@ static FileID createInMemoryFile(StringRef FileName, const MemoryBuffer *Source,
   return Sources.createFileID(Entry, SourceLocation(), SrcMgr::C_User);
 }
 
+/// \brief Reads the .clang-format file in \p Directory into \p Style, if
+/// there is one.
+///
+/// \returns true if \p Directory has a usable .clang-format, and reports to
+/// \p Errs why it is unusable otherwise.
+static bool readConfigFileInDirectory(StringRef Directory, FormatStyle *Style,
+                                      raw_ostream &Errs) {
+  SmallString<128> ConfigFile(Directory);
+  llvm::sys::path::append(ConfigFile, ".clang-format");
+  DEBUG(llvm::dbgs() << "Trying " << ConfigFile << "...\n");
+  bool IsFile = false;
+  // Ignore errors from is_regular_file: we only need to know if we can read
+  // the file or not.
+  llvm::sys::fs::is_regular_file(Twine(ConfigFile), IsFile);
+  if (!IsFile)
+    return false;
+
+  OwningPtr<MemoryBuffer> Text;
+  if (error_code ec = MemoryBuffer::getFile(ConfigFile, Text)) {
+    Errs << ec.message() << "\n";
+    return false;
+  }
+  FormatStyle FileStyle;
+  getPredefinedStyle(DefaultStyle, &FileStyle);
+  if (error_code ec = parseConfiguration(Text->getBuffer(), &FileStyle)) {
+    Errs << "Error reading " << ConfigFile << ": " << ec.message() << "\n";
+    return false;
+  }
+  DEBUG(llvm::dbgs() << "Using configuration file " << ConfigFile << "\n");
+  *Style = FileStyle;
+  return true;
+}
+
 FormatStyle getStyle(StringRef StyleName, StringRef FileName) {
   FormatStyle Style;
   getPredefinedStyle(DefaultStyle, &Style);
@@ -131,33 +189,82 @@ FormatStyle getStyle(StringRef StyleName, StringRef FileName) {
   for (StringRef Directory = llvm::sys::path::parent_path(Path);
        !Directory.empty();
        Directory = llvm::sys::path::parent_path(Directory)) {
-    SmallString<128> ConfigFile(Directory);
-    llvm::sys::path::append(ConfigFile, ".clang-format");
-    DEBUG(llvm::dbgs() << "Trying " << ConfigFile << "...\n");
-    bool IsFile = false;
-    // Ignore errors from is_regular_file: we only need to know if we can read
-    // the file or not.
-    llvm::sys::fs::is_regular_file(Twine(ConfigFile), IsFile);
-    if (IsFile) {
-      OwningPtr<MemoryBuffer> Text;
-      if (error_code ec = MemoryBuffer::getFile(ConfigFile, Text)) {
-        llvm::errs() << ec.message() << "\n";
-        continue;
-      }
-      if (error_code ec = parseConfiguration(Text->getBuffer(), &Style)) {
-        llvm::errs() << "Error reading " << ConfigFile << ": " << ec.message()
-                     << "\n";
-        continue;
-      }
-      DEBUG(llvm::dbgs() << "Using configuration file " << ConfigFile << "\n");
+    if (readConfigFileInDirectory(Directory, &Style, llvm::errs()))
       return Style;
-    }
   }
   llvm::errs() << "Can't find usable .clang-format, using " << DefaultStyle
                << " style\n";
   return Style;
 }
 
+namespace {
+/// \brief Finds the style of each file formatted during one run.
+///
+/// Every file gets the same style unless -style=file is used, in which case
+/// the style found for a file is remembered for its directory and all the
+/// directories searched on the way to its .clang-format. The other files in
+/// those directories then need no file system accesses at all. It is safe to
+/// use from several threads at once.
+class StyleCache {
+public:
+  explicit StyleCache(StringRef StyleName)
+      : StyleName(StyleName), HaveFixedStyle(false) {}
+
+  /// \brief Returns the style to format \p FileName with, and reports any
+  /// problems finding it to \p Errs.
+  FormatStyle getStyleForFile(StringRef FileName, raw_ostream &Errs);
+
+private:
+  std::string StyleName;
+  llvm::sys::Mutex Lock;
+  bool HaveFixedStyle;
+  FormatStyle FixedStyle;
+  llvm::StringMap<FormatStyle> StylesByDirectory;
+};
+}
+
+FormatStyle StyleCache::getStyleForFile(StringRef FileName, raw_ostream &Errs) {
+  if (!StringRef(StyleName).equals_lower("file")) {
+    llvm::sys::ScopedLock L(Lock);
+    if (!HaveFixedStyle) {
+      FixedStyle = getStyle(StyleName, FileName);
+      HaveFixedStyle = true;
+    }
+    return FixedStyle;
+  }
+
+  SmallString<128> Path(FileName);
+  llvm::sys::fs::make_absolute(Path);
+  SmallVector<StringRef, 8> Searched;
+  FormatStyle Style;
+  bool Found = false;
+  for (StringRef Directory = llvm::sys::path::parent_path(Path);
+       !Directory.empty() && !Found;
+       Directory = llvm::sys::path::parent_path(Directory)) {
+    {
+      llvm::sys::ScopedLock L(Lock);
+      llvm::StringMap<FormatStyle>::iterator Known
+        = StylesByDirectory.find(Directory);
+      if (Known != StylesByDirectory.end())
+        return Known->getValue();
+    }
+    Searched.push_back(Directory);
+    Found = readConfigFileInDirectory(Directory, &Style, Errs);
+  }
+  if (!Found) {
+    Errs << "Can't find usable .clang-format, using " << DefaultStyle
+         << " style\n";
+    getPredefinedStyle(DefaultStyle, &Style);
+  }
+
+  // Another thread may have searched the same directories meanwhile, and
+  // found the same style.
+  llvm::sys::ScopedLock L(Lock);
+  for (unsigned I = 0, E = Searched.size(); I != E; ++I)
+    StylesByDirectory[Searched[I]] = Style;
+  return Style;
+}
+
 // Parses <start line>:<end line> input to a pair of line numbers.
 // Returns true on error.
 static bool parseLineRange(StringRef Input, unsigned &FromLine,
@@ -167,23 +274,36 @@ static bool parseLineRange(StringRef Input, unsigned &FromLine,
          LineRange.second.getAsInteger(0, ToLine);
 }
 
+namespace {
+/// \brief The ranges of a file to format, as given by -lines, or by -offset
+/// and -length.
+struct RangeOptions {
+  ArrayRef<std::string> LineRanges;
+  ArrayRef<unsigned> Offsets;
+  ArrayRef<unsigned> Lengths;
+};
+}
+
 static bool fillRanges(SourceManager &Sources, FileID ID,
-                       const MemoryBuffer *Code,
-                       std::vector<CharSourceRange> &Ranges) {
+                       const MemoryBuffer *Code, const RangeOptions &Options,
+                       std::vector<CharSourceRange> &Ranges,
+                       raw_ostream &Errs) {
+  ArrayRef<std::string> LineRanges = Options.LineRanges;
+  ArrayRef<unsigned> Lengths = Options.Lengths;
   if (!LineRanges.empty()) {
-    if (!Offsets.empty() || !Lengths.empty()) {
-      llvm::errs() << "error: cannot use -lines with -offset/-length\n";
+    if (!Options.Offsets.empty() || !Lengths.empty()) {
+      Errs << "error: cannot use -lines with -offset/-length\n";
       return true;
     }
 
     for (unsigned i = 0, e = LineRanges.size(); i < e; ++i) {
       unsigned FromLine, ToLine;
       if (parseLineRange(LineRanges[i], FromLine, ToLine)) {
-        llvm::errs() << "error: invalid <start line>:<end line> pair\n";
+        Errs << "error: invalid <start line>:<end line> pair\n";
         return true;
       }
       if (FromLine > ToLine) {
-        llvm::errs() << "error: start line should be less than end line\n";
+        Errs << "error: start line should be less than end line\n";
         return true;
       }
       SourceLocation Start = Sources.translateLineCol(ID, FromLine, 1);
@@ -195,28 +315,29 @@ static bool fillRanges(SourceManager &Sources, FileID ID,
     return false;
   }
 
-  if (Offsets.empty())
-    Offsets.push_back(0);
-  if (Offsets.size() != Lengths.size() &&
-      !(Offsets.size() == 1 && Lengths.empty())) {
-    llvm::errs()
-        << "error: number of -offset and -length arguments must match.\n";
+  // Don't modify Offsets, which is shared by all the files being formatted.
+  std::vector<unsigned> FileOffsets(Options.Offsets.begin(),
+                                    Options.Offsets.end());
+  if (FileOffsets.empty())
+    FileOffsets.push_back(0);
+  if (FileOffsets.size() != Lengths.size() &&
+      !(FileOffsets.size() == 1 && Lengths.empty())) {
+    Errs << "error: number of -offset and -length arguments must match.\n";
     return true;
   }
-  for (unsigned i = 0, e = Offsets.size(); i != e; ++i) {
-    if (Offsets[i] >= Code->getBufferSize()) {
-      llvm::errs() << "error: offset " << Offsets[i]
-                   << " is outside the file\n";
+  for (unsigned i = 0, e = FileOffsets.size(); i != e; ++i) {
+    if (FileOffsets[i] >= Code->getBufferSize()) {
+      Errs << "error: offset " << FileOffsets[i] << " is outside the file\n";
       return true;
     }
     SourceLocation Start =
-        Sources.getLocForStartOfFile(ID).getLocWithOffset(Offsets[i]);
+        Sources.getLocForStartOfFile(ID).getLocWithOffset(FileOffsets[i]);
     SourceLocation End;
     if (i < Lengths.size()) {
-      if (Offsets[i] + Lengths[i] > Code->getBufferSize()) {
-        llvm::errs() << "error: invalid length " << Lengths[i]
-                     << ", offset + length (" << Offsets[i] + Lengths[i]
-                     << ") is outside the file.\n";
+      if (FileOffsets[i] + Lengths[i] > Code->getBufferSize()) {
+        Errs << "error: invalid length " << Lengths[i]
+             << ", offset + length (" << FileOffsets[i] + Lengths[i]
+             << ") is outside the file.\n";
         return true;
       }
       End = Start.getLocWithOffset(Lengths[i]);
@@ -228,41 +349,40 @@ static bool fillRanges(SourceManager &Sources, FileID ID,
   return false;
 }
 
-// Returns true on error.
-static bool format(std::string FileName) {
+// Formats the ranges of Code, the contents of FileName, with the given style,
+// writing the result or the replacements to Outs and any errors to Errs. The
+// position of the cursor after formatting is printed first if HasCursor is
+// set. Returns true on error.
+static bool formatCode(StringRef FileName, const MemoryBuffer *Code,
+                       const RangeOptions &RangeOpts, bool HasCursor,
+                       unsigned CursorOffset, const FormatStyle &FormatStyle,
+                       raw_ostream &Outs, raw_ostream &Errs) {
   FileManager Files((FileSystemOptions()));
   DiagnosticsEngine Diagnostics(
       IntrusiveRefCntPtr<DiagnosticIDs>(new DiagnosticIDs),
       new DiagnosticOptions);
   SourceManager Sources(Diagnostics, Files);
-  OwningPtr<MemoryBuffer> Code;
-  if (error_code ec = MemoryBuffer::getFileOrSTDIN(FileName, Code)) {
-    llvm::errs() << ec.message() << "\n";
-    return true;
-  }
-  if (Code->getBufferSize() == 0)
-    return true; // Empty files are formatted correctly.
-  FileID ID = createInMemoryFile(FileName, Code.get(), Sources, Files);
+  FileID ID = createInMemoryFile(FileName, Code, Sources, Files);
   std::vector<CharSourceRange> Ranges;
-  if (fillRanges(Sources, ID, Code.get(), Ranges))
+  if (fillRanges(Sources, ID, Code, RangeOpts, Ranges, Errs))
     return true;
 
-  FormatStyle FormatStyle = getStyle(Style, FileName);
   Lexer Lex(ID, Sources.getBuffer(ID), Sources,
             getFormattingLangOpts(FormatStyle.Standard));
-  tooling::Replacements Replaces = reformat(FormatStyle, Lex, Sources, Ranges);
+  tooling::Replacements Replaces =
+      reformat(FormatStyle, Lex, Sources, Ranges,
+               TimePhases ? &PhaseStatistics : NULL);
   if (OutputXML) {
-    llvm::outs()
-        << "<?xml version='1.0'?>\n<replacements xml:space='preserve'>\n";
+    Outs << "<?xml version='1.0'?>\n<replacements xml:space='preserve'>\n";
     for (tooling::Replacements::const_iterator I = Replaces.begin(),
                                                E = Replaces.end();
          I != E; ++I) {
-      llvm::outs() << "<replacement "
-                   << "offset='" << I->getOffset() << "' "
-                   << "length='" << I->getLength() << "'>"
-                   << I->getReplacementText() << "</replacement>\n";
+      Outs << "<replacement "
+           << "offset='" << I->getOffset() << "' "
+           << "length='" << I->getLength() << "'>"
+           << I->getReplacementText() << "</replacement>\n";
     }
-    llvm::outs() << "</replacements>\n";
+    Outs << "</replacements>\n";
   } else {
     Rewriter Rewrite(Sources, LangOptions());
     tooling::applyAllReplacements(Replaces, Rewrite);
@@ -271,24 +391,280 @@ static bool format(std::string FileName) {
         return false; // Nothing changed, don't touch the file.
 
       std::string ErrorInfo;
-      llvm::raw_fd_ostream FileStream(FileName.c_str(), ErrorInfo,
+      llvm::raw_fd_ostream FileStream(FileName.str().c_str(), ErrorInfo,
                                       llvm::sys::fs::F_Binary);
       if (!ErrorInfo.empty()) {
-        llvm::errs() << "Error while writing file: " << ErrorInfo << "\n";
+        Errs << "Error while writing file: " << ErrorInfo << "\n";
         return true;
       }
       Rewrite.getEditBuffer(ID).write(FileStream);
       FileStream.flush();
     } else {
-      if (Cursor.getNumOccurrences() != 0)
-        outs() << "{ \"Cursor\": " << tooling::shiftedCodePosition(
-                                          Replaces, Cursor) << " }\n";
-      Rewrite.getEditBuffer(ID).write(outs());
+      if (HasCursor)
+        Outs << "{ \"Cursor\": "
+             << tooling::shiftedCodePosition(Replaces, CursorOffset)
+             << " }\n";
+      Rewrite.getEditBuffer(ID).write(Outs);
+    }
+  }
+  return false;
+}
+
+// Formats FileName with the given style, writing the result or the
+// replacements to Outs and any errors to Errs. Returns true on error.
+static bool format(StringRef FileName, const FormatStyle &FormatStyle,
+                   raw_ostream &Outs, raw_ostream &Errs) {
+  OwningPtr<MemoryBuffer> Code;
+  if (error_code ec = MemoryBuffer::getFileOrSTDIN(FileName, Code)) {
+    Errs << ec.message() << "\n";
+    return true;
+  }
+  if (Code->getBufferSize() == 0)
+    return true; // Empty files are formatted correctly.
+  RangeOptions RangeOpts;
+  RangeOpts.LineRanges = LineRanges;
+  RangeOpts.Offsets = Offsets;
+  RangeOpts.Lengths = Lengths;
+  return formatCode(FileName, Code.get(), RangeOpts,
+                    Cursor.getNumOccurrences() != 0, Cursor, FormatStyle, Outs,
+                    Errs);
+}
+
+static bool format(StringRef FileName) {
+  return format(FileName, getStyle(Style, FileName), outs(), errs());
+}
+
+// Reads a line from stdin into Line, without the newline. Returns false at
+// the end of the input.
+static bool readRequestLine(std::string &Line) {
+  Line.clear();
+  int C;
+  while ((C = std::getc(stdin)) != EOF && C != '\n')
+    Line += char(C);
+  return C != EOF || !Line.empty();
+}
+
+// Parses the header line of a request, of the form
+// "size=<N> [cursor=<N>] [offset=<N> length=<N>]... [lines=<A>:<B>]...".
+// Returns true on error.
+static bool parseRequestHeader(StringRef Header, unsigned &Size,
+                               bool &HasCursor, unsigned &CursorOffset,
+                               std::vector<std::string> &RequestLines,
+                               std::vector<unsigned> &RequestOffsets,
+                               std::vector<unsigned> &RequestLengths) {
+  bool HasSize = false;
+  SmallVector<StringRef, 8> Fields;
+  Header.split(Fields, " ", -1, /*KeepEmpty=*/false);
+  for (unsigned i = 0, e = Fields.size(); i != e; ++i) {
+    std::pair<StringRef, StringRef> Field = Fields[i].split('=');
+    unsigned Value;
+    if (Field.first == "lines") {
+      RequestLines.push_back(Field.second);
+      continue;
+    }
+    if (Field.second.getAsInteger(0, Value))
+      return true;
+    if (Field.first == "size") {
+      Size = Value;
+      HasSize = true;
+    } else if (Field.first == "cursor") {
+      CursorOffset = Value;
+      HasCursor = true;
+    } else if (Field.first == "offset") {
+      RequestOffsets.push_back(Value);
+    } else if (Field.first == "length") {
+      RequestLengths.push_back(Value);
+    } else {
+      return true;
+    }
+  }
+  return !HasSize;
+}
+
+// Writes the response to a request, which is "ok" or "error" and the size of
+// the text that follows, on a line of their own.
+static void writeResponse(bool Failed, StringRef Text) {
+  outs() << (Failed ? "error " : "ok ") << Text.size() << "\n" << Text;
+  outs().flush();
+}
+
+namespace {
+/// \brief A request to the server of -server, and its response.
+struct ServerResponse {
+  ServerResponse() : Failed(false) {}
+  std::string Request;
+  bool Failed;
+  std::string Text;
+};
+}
+
+// Formats the code of each request read from stdin until its end, for
+// -server.
+//
+// A request is the name of the file the code is from, which is used to find
+// its style, on a line of its own, a header line as parsed by
+// parseRequestHeader() giving the size of the code in bytes and the (line or
+// offset) ranges to format, and then the code. The response is what
+// formatting the file would have printed, or the errors. The styles found
+// are kept for all the requests, so that .clang-format files are read once,
+// and so is the last response for each file, which is sent again without
+// formatting anything if the same request comes next for that file, as it
+// does when an editor formats a file that wasn't changed since.
+static bool runServer() {
+  llvm::sys::ChangeStdinToBinary();
+  llvm::sys::ChangeStdoutToBinary();
+  StyleCache Styles(Style);
+  llvm::StringMap<ServerResponse> LastResponses;
+  std::string FileName, Header;
+  while (readRequestLine(FileName)) {
+    if (!readRequestLine(Header)) {
+      errs() << "error: incomplete request for " << FileName << "\n";
+      return true;
+    }
+    unsigned Size = 0, CursorOffset = 0;
+    bool HasCursor = false;
+    std::vector<std::string> RequestLines;
+    std::vector<unsigned> RequestOffsets, RequestLengths;
+    if (parseRequestHeader(Header, Size, HasCursor, CursorOffset, RequestLines,
+                           RequestOffsets, RequestLengths)) {
+      // Without a size, the rest of the input can't be made sense of.
+      errs() << "error: invalid request header '" << Header << "'\n";
+      return true;
+    }
+
+    std::vector<char> Code(Size);
+    if (Size != 0 && std::fread(&Code[0], 1, Size, stdin) != Size) {
+      errs() << "error: incomplete request for " << FileName << "\n";
+      return true;
+    }
+
+    ServerResponse &Last = LastResponses[FileName];
+    std::string Request = Header + '\n';
+    if (Size != 0)
+      Request.append(&Code[0], Size);
+    if (!Last.Request.empty() && Last.Request == Request) {
+      writeResponse(Last.Failed, Last.Text);
+      continue;
     }
+
+    std::string Output, Errors;
+    llvm::raw_string_ostream Outs(Output), Errs(Errors);
+    bool Failed = false;
+    if (Size != 0) {
+      OwningPtr<MemoryBuffer> Buffer(MemoryBuffer::getMemBufferCopy(
+          StringRef(&Code[0], Size), FileName));
+      RangeOptions RangeOpts;
+      RangeOpts.LineRanges = RequestLines;
+      RangeOpts.Offsets = RequestOffsets;
+      RangeOpts.Lengths = RequestLengths;
+      Failed = formatCode(FileName, Buffer.get(), RangeOpts, HasCursor,
+                          CursorOffset,
+                          Styles.getStyleForFile(FileName, Errs), Outs, Errs);
+    } else if (HasCursor) {
+      Outs << "{ \"Cursor\": " << CursorOffset << " }\n";
+    }
+    if (!Failed)
+      errs() << Errs.str();
+    Last.Request.swap(Request);
+    Last.Failed = Failed;
+    Last.Text = Failed ? Errs.str() : Outs.str();
+    writeResponse(Last.Failed, Last.Text);
   }
   return false;
 }
 
+static void printPhase(const llvm::TimeRecord &Time,
+                       const llvm::TimeRecord &Total, StringRef Name) {
+  Time.print(Total, errs());
+  errs() << "  " << Name << "\n";
+}
+
+// Prints PhaseStatistics in the format of an LLVM timer report.
+static void printPhaseStatistics() {
+  const FormatStatistics &Stats = PhaseStatistics;
+  llvm::TimeRecord Total;
+  Total += Stats.Lexing;
+  Total += Stats.Parsing;
+  Total += Stats.Annotating;
+  Total += Stats.LineFormatting;
+  Total += Stats.Replacements;
+
+  raw_ostream &OS = errs();
+  OS << "===" << std::string(73, '-') << "===\n"
+     << "                        clang-format phase timings\n"
+     << "===" << std::string(73, '-') << "===\n";
+  if (Total.getUserTime())
+    OS << "   ---User Time---";
+  if (Total.getSystemTime())
+    OS << "   --System Time--";
+  if (Total.getProcessTime())
+    OS << "   --User+System--";
+  OS << "   ---Wall Time---";
+  if (Total.getMemUsed())
+    OS << "  ---Mem---";
+  OS << "  --- Name ---\n";
+  printPhase(Stats.Lexing, Total, "Lexing");
+  printPhase(Stats.Parsing, Total, "Parsing unwrapped lines");
+  printPhase(Stats.Annotating, Total, "Annotating tokens");
+  printPhase(Stats.LineFormatting, Total, "Formatting lines");
+  printPhase(Stats.Replacements, Total, "Generating replacements");
+  printPhase(Total, Total, "Total");
+  OS << "\n" << Stats.NumUnwrappedLines << " unwrapped lines, "
+     << Stats.NumFormattedLines << " formatted, "
+     << Stats.NumStateNodes << " line states created\n";
+}
+
+namespace {
+/// \brief The files being formatted concurrently, and what formatting each
+/// of them printed.
+struct ParallelFormatRun {
+  StyleCache *Styles;
+  std::vector<std::string> Outputs;
+  std::vector<std::string> Errors;
+  /// \brief Per-file result; char rather than bool so that workers write to
+  /// distinct memory locations.
+  std::vector<char> Failed;
+};
+}
+
+static void formatFileTask(void *Context, unsigned Index) {
+  ParallelFormatRun &Run = *static_cast<ParallelFormatRun *>(Context);
+  llvm::raw_string_ostream Outs(Run.Outputs[Index]);
+  llvm::raw_string_ostream Errs(Run.Errors[Index]);
+  FormatStyle FileStyle = Run.Styles->getStyleForFile(FileNames[Index], Errs);
+  Run.Failed[Index] = format(FileNames[Index], FileStyle, Outs, Errs);
+}
+
+// Formats all of FileNames, using up to NumWorkers threads. Returns true on
+// error.
+static bool formatFiles(unsigned NumWorkers) {
+  StyleCache Styles(Style);
+  bool Error = false;
+  if (NumWorkers == 1) {
+    for (unsigned i = 0; i < FileNames.size(); ++i)
+      Error |= format(FileNames[i],
+                      Styles.getStyleForFile(FileNames[i], errs()), outs(),
+                      errs());
+    return Error;
+  }
+
+  ParallelFormatRun Run;
+  Run.Styles = &Styles;
+  Run.Outputs.resize(FileNames.size());
+  Run.Errors.resize(FileNames.size());
+  Run.Failed.resize(FileNames.size(), false);
+  runTasksInParallel(FileNames.size(), NumWorkers, formatFileTask, &Run);
+
+  // Print everything in the order the files were given, independent of the
+  // order in which the workers finished.
+  for (unsigned i = 0; i < FileNames.size(); ++i) {
+    outs() << Run.Outputs[i];
+    errs() << Run.Errors[i];
+    Error |= Run.Failed[i];
+  }
+  return Error;
+}
+
 }  // namespace format
 }  // namespace clang
 
@@ -324,6 +700,17 @@ int main(int argc, const char **argv) {
     return 0;
   }
 
+  if (Server) {
+    if (!FileNames.empty() || Inplace || !Offsets.empty() ||
+        !Lengths.empty() || !LineRanges.empty() ||
+        Cursor.getNumOccurrences() != 0) {
+      llvm::errs() << "error: -server can't be used with input files, -i, "
+                      "-offset, -length, -lines or -cursor.\n";
+      return 1;
+    }
+    return clang::format::runServer() ? 1 : 0;
+  }
+
   bool Error = false;
   switch (FileNames.size()) {
   case 0:
@@ -338,9 +725,12 @@ int main(int argc, const char **argv) {
                       "single file.\n";
       return 1;
     }
-    for (unsigned i = 0; i < FileNames.size(); ++i)
-      Error |= clang::format::format(FileNames[i]);
+    // The phase statistics are not thread-safe.
+    Error = clang::format::formatFiles(
+        TimePhases ? 1 : clang::getEffectiveWorkerCount(Jobs));
     break;
   }
+  if (TimePhases)
+    clang::format::printPhaseStatistics();
   return Error ? 1 : 0;
 }
@@ -14,6 +14,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/Option/Arg.h"
+#include "clang/Basic/TimeTrace.h"
 #include "clang/Driver/DriverDiagnostic.h"
 #include "clang/Driver/Options.h"
 #include "clang/Frontend/CompilerInstance.h"
@@ -26,6 +27,7 @@
 #include "llvm/LinkAllPasses.h"
 #include "llvm/Option/ArgList.h"
 #include "llvm/Option/OptTable.h"
+#include "llvm/Support/CrashRecoveryContext.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/Signals.h"
@@ -40,6 +42,9 @@ using namespace llvm::opt;
 // Main driver
 //===----------------------------------------------------------------------===//
 
+/// The status cc1_main_in_process returns after a fatal error.
+static int FatalErrorStatus;
+
 static void LLVMErrorHandler(void *UserData, const std::string &Message,
                              bool GenCrashDiag) {
   DiagnosticsEngine &Diags = *static_cast<DiagnosticsEngine*>(UserData);
@@ -53,11 +58,25 @@ static void LLVMErrorHandler(void *UserData, const std::string &Message,
   // We cannot recover from llvm errors.  When reporting a fatal error, exit
   // with status 70 to generate crash diagnostics.  For BSD systems this is
   // defined as an internal software error.  Otherwise, exit with status 1.
-  exit(GenCrashDiag ? 70 : 1);
+  int Status = GenCrashDiag ? 70 : 1;
+
+  // When running in the driver's process, return the status to the driver
+  // instead of exiting.
+  if (llvm::CrashRecoveryContext *CRC =
+        llvm::CrashRecoveryContext::GetCurrent()) {
+    FatalErrorStatus = Status;
+    CRC->HandleCrash();
+  }
+  exit(Status);
 }
 
-int cc1_main(const char **ArgBegin, const char **ArgEnd,
-             const char *Argv0, void *MainAddr) {
+/// \brief Run a compilation. If \p Persistent, the process runs other
+/// compilations after this one, so it must free everything it allocates.
+/// Unless it owns its process, it also must not shut LLVM down, since the
+/// libraries do not initialize themselves again.
+static int ExecuteCC1(const char **ArgBegin, const char **ArgEnd,
+                      const char *Argv0, void *MainAddr, bool OwnsProcess,
+                      bool Persistent) {
   OwningPtr<CompilerInstance> Clang(new CompilerInstance());
   IntrusiveRefCntPtr<DiagnosticIDs> DiagID(new DiagnosticIDs());
 
@@ -93,12 +112,33 @@ int cc1_main(const char **ArgBegin, const char **ArgEnd,
                                   static_cast<void*>(&Clang->getDiagnostics()));
 
   DiagsBuffer->FlushDiagnostics(Clang->getDiagnostics());
-  if (!Success)
+  if (!Success) {
+    llvm::remove_fatal_error_handler();
     return 1;
+  }
+
+  if (Persistent)
+    Clang->getFrontendOpts().DisableFree = false;
+
+  // Execute the frontend actions, tracing where they spend their time if
+  // asked to.
+  const std::string &TraceFile = Clang->getFrontendOpts().TimeTraceFile;
+  if (!TraceFile.empty())
+    TimeTrace::start();
 
-  // Execute the frontend actions.
   Success = ExecuteCompilerInvocation(Clang.get());
 
+  if (!TraceFile.empty()) {
+    std::string Err;
+    llvm::raw_fd_ostream OS(TraceFile.c_str(), Err);
+    if (!Err.empty()) {
+      Clang->getDiagnostics().Report(diag::err_fe_unable_to_open_output)
+        << TraceFile << Err;
+      Success = false;
+    }
+    TimeTrace::finish(OS);
+  }
+
   // If any timers were active but haven't been destroyed yet, print their
   // results now.  This happens in -disable-free mode.
   llvm::TimerGroup::printAll(llvm::errs());
@@ -118,7 +158,56 @@ int cc1_main(const char **ArgBegin, const char **ArgEnd,
 
   // Managed static deconstruction. Useful for making things like
   // -time-passes usable.
-  llvm::llvm_shutdown();
+  if (OwnsProcess)
+    llvm::llvm_shutdown();
 
   return !Success;
 }
+
+int cc1_main(const char **ArgBegin, const char **ArgEnd,
+             const char *Argv0, void *MainAddr) {
+  return ExecuteCC1(ArgBegin, ArgEnd, Argv0, MainAddr, /*OwnsProcess=*/true,
+                    /*Persistent=*/false);
+}
+
+namespace {
+struct CC1Invocation {
+  const char **ArgBegin;
+  const char **ArgEnd;
+  const char *Argv0;
+  void *MainAddr;
+  bool Persistent;
+  int Res;
+};
+}
+
+static void RunCC1Invocation(void *UserData) {
+  CC1Invocation &Invocation = *static_cast<CC1Invocation *>(UserData);
+  Invocation.Res = ExecuteCC1(Invocation.ArgBegin, Invocation.ArgEnd,
+                              Invocation.Argv0, Invocation.MainAddr,
+                              /*OwnsProcess=*/false, Invocation.Persistent);
+}
+
+/// cc1_main_in_process - Run a compilation in a process that outlives it:
+/// the driver's, or a compile server's if \p Persistent. Crashes are caught,
+/// so that the caller sees the same status as if it had spawned the job: the
+/// exit status of a fatal error, or -1 for a crash. \p Recovered tells
+/// whether the compilation was cut short, after which the state of the
+/// process can't be trusted for more compilations.
+int cc1_main_in_process(const char **ArgBegin, const char **ArgEnd,
+                        const char *Argv0, void *MainAddr, bool Persistent,
+                        bool &Recovered) {
+  llvm::CrashRecoveryContext::Enable();
+
+  CC1Invocation Invocation = { ArgBegin, ArgEnd, Argv0, MainAddr, Persistent,
+                               1 };
+  FatalErrorStatus = 0;
+  llvm::CrashRecoveryContext CRC;
+  Recovered = !CRC.RunSafely(RunCC1Invocation, &Invocation);
+  if (!Recovered)
+    return Invocation.Res;
+
+  // The job did not get to remove its error handler.
+  llvm::remove_fatal_error_handler();
+  return FatalErrorStatus ? FatalErrorStatus : -1;
+}
@@ -0,0 +1,121 @@
+//===-- cc1server_main.cpp - Clang CC1 Compile Server ---------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This is the entry point to clang -cc1server, which runs many -cc1 jobs in
+// one process, so that they do not each pay for starting a new clang.
+//
+// The server reads one request per line on its standard input: the arguments
+// of a -cc1 job, without "-cc1", quoted as in a response file. When the job is
+// done, the server writes its exit status on a line of its standard output.
+// Diagnostics go to standard error, so jobs must not write their output to
+// standard output. The server exits at the end of its input, or after a job
+// crashed, since it can't trust its own state from then on.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Basic/LLVM.h"
+#include "clang/Driver/Job.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Compiler.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Program.h"
+#include "llvm/Support/raw_ostream.h"
+#include <cstdio>
+#include <list>
+#include <string>
+using namespace clang;
+
+extern int cc1_main_in_process(const char **ArgBegin, const char **ArgEnd,
+                               const char *Argv0, void *MainAddr,
+                               bool Persistent, bool &Recovered);
+
+namespace {
+  /// \brief Keeps the arguments of one request.
+  class RequestStringSaver : public llvm::cl::StringSaver {
+  public:
+    const char *SaveString(const char *Str) LLVM_OVERRIDE {
+      Strings.push_back(Str);
+      return Strings.back().c_str();
+    }
+
+  private:
+    std::list<std::string> Strings;
+  };
+}
+
+/// \brief Read a line of standard input into \p Line, without its newline.
+///
+/// \returns false at the end of the input.
+static bool readRequest(std::string &Line) {
+  Line.clear();
+  int C;
+  while ((C = getchar()) != EOF) {
+    if (C == '\n')
+      return true;
+    Line += char(C);
+  }
+  return !Line.empty();
+}
+
+/// \brief Run a job in a new process, for the jobs that can't share one.
+static int spawnCC1(const std::string &Executable,
+                    const SmallVectorImpl<const char *> &Args) {
+  SmallVector<const char *, 128> Argv;
+  Argv.push_back(Executable.c_str());
+  Argv.push_back("-cc1");
+  Argv.append(Args.begin(), Args.end());
+  Argv.push_back(0);
+
+  std::string Error;
+  bool ExecutionFailed;
+  int Res = llvm::sys::ExecuteAndWait(Executable, Argv.data(), /*env*/ 0,
+                                      /*redirects*/ 0, /*secondsToWait*/ 0,
+                                      /*memoryLimit*/ 0, &Error,
+                                      &ExecutionFailed);
+  if (!Error.empty())
+    llvm::errs() << "error: unable to execute command: " << Error << "\n";
+  return ExecutionFailed ? 1 : Res;
+}
+
+int cc1server_main(const char **ArgBegin, const char **ArgEnd,
+                   const char *Argv0, void *MainAddr) {
+  if (ArgBegin != ArgEnd) {
+    llvm::errs() << "error: -cc1server does not take arguments\n";
+    return 1;
+  }
+
+  std::string Executable = llvm::sys::fs::getMainExecutable(Argv0, MainAddr);
+  std::string Line;
+  while (readRequest(Line)) {
+    if (StringRef(Line).trim().empty())
+      continue;
+
+    RequestStringSaver Saver;
+    SmallVector<const char *, 128> Args;
+    llvm::cl::TokenizeGNUCommandLine(Line, Saver, Args);
+
+    int Res;
+    bool Recovered = false;
+    if (driver::setsLLVMOptions(Args))
+      Res = spawnCC1(Executable, Args);
+    else
+      Res = cc1_main_in_process(Args.data(), Args.data() + Args.size(),
+                                Argv0, MainAddr, /*Persistent=*/true,
+                                Recovered);
+
+    llvm::errs().flush();
+    llvm::outs() << Res << "\n";
+    llvm::outs().flush();
+    if (Recovered)
+      return 1;
+  }
+  return 0;
+}
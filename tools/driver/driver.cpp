@@ -26,6 +26,7 @@
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringSet.h"
 #include "llvm/Option/ArgList.h"
 #include "llvm/Option/OptTable.h"
 #include "llvm/Option/Option.h"
@@ -59,9 +60,13 @@ std::string GetExecutablePath(const char *Argv0, bool CanonicalPrefixes) {
   return llvm::sys::fs::getMainExecutable(Argv0, P);
 }
 
-static const char *SaveStringInSet(std::set<std::string> &SavedStrings,
+/// SaveStringInSet - Return a copy of \p S that lives as long as
+/// \p SavedStrings. Response files can hold tens of thousands of arguments,
+/// so the copies are hashed rather than kept in order.
+static const char *SaveStringInSet(llvm::StringSet<> &SavedStrings,
                                    StringRef S) {
-  return SavedStrings.insert(S).first->c_str();
+  // The keys of a StringMap are null terminated.
+  return SavedStrings.GetOrCreateValue(S).getKeyData();
 }
 
 /// ApplyQAOverride - Apply a list of edits to the input argument lists.
@@ -94,7 +99,7 @@ static const char *SaveStringInSet(std::set<std::string> &SavedStrings,
 static void ApplyOneQAOverride(raw_ostream &OS,
                                SmallVectorImpl<const char*> &Args,
                                StringRef Edit,
-                               std::set<std::string> &SavedStrings) {
+                               llvm::StringSet<> &SavedStrings) {
   // This does not need to be efficient.
 
   if (Edit[0] == '^') {
@@ -160,7 +165,7 @@ static void ApplyOneQAOverride(raw_ostream &OS,
 /// input argument lists. See ApplyOneQAOverride.
 static void ApplyQAOverride(SmallVectorImpl<const char*> &Args,
                             const char *OverrideStr,
-                            std::set<std::string> &SavedStrings) {
+                            llvm::StringSet<> &SavedStrings) {
   raw_ostream *OS = &llvm::errs();
 
   if (OverrideStr[0] == '#') {
@@ -189,9 +194,24 @@ extern int cc1_main(const char **ArgBegin, const char **ArgEnd,
                     const char *Argv0, void *MainAddr);
 extern int cc1as_main(const char **ArgBegin, const char **ArgEnd,
                       const char *Argv0, void *MainAddr);
+extern int cc1server_main(const char **ArgBegin, const char **ArgEnd,
+                          const char *Argv0, void *MainAddr);
+extern int cc1_main_in_process(const char **ArgBegin, const char **ArgEnd,
+                               const char *Argv0, void *MainAddr,
+                               bool Persistent, bool &Recovered);
+
+/// ExecuteCC1Tool - Run a -cc1 job of the driver without spawning it; see
+/// -fintegrated-cc1.
+static int ExecuteCC1Tool(const char **ArgBegin, const char **ArgEnd,
+                          const char *Argv0) {
+  bool Recovered;
+  return cc1_main_in_process(ArgBegin, ArgEnd, Argv0,
+                             (void*) (intptr_t) GetExecutablePath,
+                             /*Persistent=*/false, Recovered);
+}
 
 static void ParseProgName(SmallVectorImpl<const char *> &ArgVector,
-                          std::set<std::string> &SavedStrings,
+                          llvm::StringSet<> &SavedStrings,
                           Driver &TheDriver)
 {
   // Try to infer frontend type and default target from the program name.
@@ -276,12 +296,12 @@ static void ParseProgName(SmallVectorImpl<const char *> &ArgVector,
 namespace {
   class StringSetSaver : public llvm::cl::StringSaver {
   public:
-    StringSetSaver(std::set<std::string> &Storage) : Storage(Storage) {}
+    StringSetSaver(llvm::StringSet<> &Storage) : Storage(Storage) {}
     const char *SaveString(const char *Str) LLVM_OVERRIDE {
       return SaveStringInSet(Storage, Str);
     }
   private:
-    std::set<std::string> &Storage;
+    llvm::StringSet<> &Storage;
   };
 }
 
@@ -289,7 +309,7 @@ int main(int argc_, const char **argv_) {
   llvm::sys::PrintStackTraceOnErrorSignal();
   llvm::PrettyStackTraceProgram X(argc_, argv_);
 
-  std::set<std::string> SavedStrings;
+  llvm::StringSet<> SavedStrings;
   SmallVector<const char*, 256> argv(argv_, argv_ + argc_);
   StringSetSaver Saver(SavedStrings);
   llvm::cl::ExpandResponseFiles(Saver, llvm::cl::TokenizeGNUCommandLine, argv);
@@ -304,6 +324,9 @@ int main(int argc_, const char **argv_) {
     if (Tool == "as")
       return cc1as_main(argv.data()+2, argv.data()+argv.size(), argv[0],
                       (void*) (intptr_t) GetExecutablePath);
+    if (Tool == "server")
+      return cc1server_main(argv.data()+2, argv.data()+argv.size(), argv[0],
+                            (void*) (intptr_t) GetExecutablePath);
 
     // Reject unknown tools.
     llvm::errs() << "error: unknown integrated tool '" << Tool << "'\n";
@@ -350,6 +373,7 @@ int main(int argc_, const char **argv_) {
   ProcessWarningOptions(Diags, *DiagOpts, /*ReportDiags=*/false);
 
   Driver TheDriver(Path, llvm::sys::getDefaultTargetTriple(), "a.out", Diags);
+  TheDriver.CC1Main = ExecuteCC1Tool;
 
   // Attempt to find the original path used to invoke the driver, to determine
   // the installed path. We do this manually, because we want to support that
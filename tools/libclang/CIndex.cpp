@@ -68,11 +68,34 @@ CXTranslationUnit cxtu::MakeCXTranslationUnit(CIndexer *CIdx, ASTUnit *AU) {
   D->StringPool = new cxstring::CXStringPool();
   D->Diagnostics = 0;
   D->OverridenCursorsPool = createOverridenCXCursorsPool();
+  D->DeclContextIndex = 0;
+  D->CompletionCache = 0;
   D->FormatContext = 0;
   D->FormatInMemoryUniqueId = 0;
+  D->PreambleRebuiltCallback = 0;
+  D->PreambleRebuiltClientData = 0;
+  D->IsHibernating = false;
+  D->TracksUse = false;
+  D->LastUse = 0;
+  if (CIdx) {
+    CIdx->addTranslationUnit(D);
+    CIdx->enforceMemoryBudget(D);
+  }
   return D;
 }
 
+void cxtu::noteUse(CXTranslationUnit TU) {
+  if (TU->TracksUse)
+    TU->LastUse = TU->CIdx->getUseStamp();
+
+  if (TU->IsHibernating) {
+    TU->IsHibernating = false;
+    TU->TheASTUnit->wakeUp();
+    if (TU->CIdx)
+      TU->CIdx->enforceMemoryBudget(TU);
+  }
+}
+
 cxtu::CXTUOwner::~CXTUOwner() {
   if (TU)
     clang_disposeTranslationUnit(TU);
@@ -588,9 +611,159 @@ Optional<bool> CursorVisitor::shouldVisitCursor(CXCursor Cursor) {
   return true;
 }
 
+/// \brief Make the cursor that CursorVisitor::VisitDeclContext visits for the
+/// declaration \p D of \p DC, returning false if it does not visit one.
+static bool getDeclContextMemberCursor(Decl *D, DeclContext *DC,
+                                       CXTranslationUnit TU,
+                                       SourceRange RegionOfInterest,
+                                       CXCursor &Cursor) {
+  if (D->getLexicalDeclContext() != DC)
+    return false;
+  Cursor = MakeCXCursor(D, TU, RegionOfInterest);
+
+  // Ignore synthesized ivars here, otherwise if we have something like:
+  //   @synthesize prop = _prop;
+  // and '_prop' is not declared, we will encounter a '_prop' ivar before
+  // encountering the 'prop' synthesize declaration and we will think that
+  // we passed the region-of-interest.
+  if (ObjCIvarDecl *ivarD = dyn_cast<ObjCIvarDecl>(D)) {
+    if (ivarD->getSynthesize())
+      return false;
+  }
+
+  // FIXME: ObjCClassRef/ObjCProtocolRef for forward class/protocol
+  // declarations is a mismatch with the compiler semantics.
+  if (Cursor.kind == CXCursor_ObjCInterfaceDecl) {
+    ObjCInterfaceDecl *ID = cast<ObjCInterfaceDecl>(D);
+    if (!ID->isThisDeclarationADefinition())
+      Cursor = MakeCursorObjCClassRef(ID, ID->getLocation(), TU);
+
+  } else if (Cursor.kind == CXCursor_ObjCProtocolDecl) {
+    ObjCProtocolDecl *PD = cast<ObjCProtocolDecl>(D);
+    if (!PD->isThisDeclarationADefinition())
+      Cursor = MakeCursorObjCProtocolRef(PD, PD->getLocation(), TU);
+  }
+  return true;
+}
+
+namespace {
+/// \brief The declarations of the large DeclContexts of a translation unit,
+/// each with the last end of the extents visited by
+/// CursorVisitor::VisitDeclContext up to and including it.
+///
+/// Since those ends only grow, a visitation with a region of interest can
+/// find the declarations that lie before the region by a binary search
+/// instead of computing the extent of each of them, which makes point queries
+/// like clang_getCursor cheap in contexts with many declarations. The index
+/// is built lazily and dropped when the translation unit is reparsed.
+class DeclContextIndex {
+public:
+  struct Member {
+    Decl *D;
+    /// \brief The last end of the valid extents of the members up to and
+    /// including this one, or an invalid location if there is none yet.
+    SourceLocation MaxEnd;
+  };
+
+  struct Context {
+    /// \brief The last declaration of the context when the index was built,
+    /// used to notice declarations added since.
+    Decl *Last;
+    /// \brief The members, or none if the context is too small to index.
+    std::vector<Member> Members;
+  };
+
+  /// \brief The smallest number of declarations of an indexed context.
+  enum { MinIndexedDecls = 64 };
+
+  ~DeclContextIndex() { clear(); }
+
+  void clear() {
+    llvm::DeleteContainerSeconds(Contexts);
+  }
+
+  /// \brief Returns the index of \p DC, building it if necessary.
+  const Context &get(DeclContext *DC, CXTranslationUnit TU);
+
+private:
+  llvm::DenseMap<const DeclContext *, Context *> Contexts;
+};
+}
+
+const DeclContextIndex::Context &
+DeclContextIndex::get(DeclContext *DC, CXTranslationUnit TU) {
+  Context *&Ctx = Contexts[DC];
+  if (Ctx && (!Ctx->Last || !Ctx->Last->getNextDeclInContext()))
+    return *Ctx;
+
+  if (!Ctx)
+    Ctx = new Context;
+  Ctx->Last = 0;
+  Ctx->Members.clear();
+
+  unsigned NumDecls = 0;
+  for (DeclContext::decl_iterator I = DC->decls_begin(), E = DC->decls_end();
+       I != E; ++I) {
+    Ctx->Last = *I;
+    ++NumDecls;
+  }
+  if (NumDecls < MinIndexedDecls)
+    return *Ctx;
+
+  SourceManager &SM = cxtu::getASTUnit(TU)->getSourceManager();
+  Ctx->Members.reserve(NumDecls);
+  SourceLocation MaxEnd;
+  for (DeclContext::decl_iterator I = DC->decls_begin(), E = DC->decls_end();
+       I != E; ++I) {
+    CXCursor Cursor;
+    if (getDeclContextMemberCursor(*I, DC, TU, SourceRange(), Cursor)) {
+      SourceRange Range = getFullCursorExtent(Cursor, SM);
+      if (Range.isValid() &&
+          (MaxEnd.isInvalid() ||
+           SM.isBeforeInTranslationUnit(MaxEnd, Range.getEnd())))
+        MaxEnd = Range.getEnd();
+    }
+    Member M = { *I, MaxEnd };
+    Ctx->Members.push_back(M);
+  }
+  return *Ctx;
+}
+
+namespace {
+/// \brief Orders the members of a DeclContextIndex before a location that
+/// their extents, and those of the members before them, all end before.
+struct MemberEndsBefore {
+  SourceManager &SM;
+  explicit MemberEndsBefore(SourceManager &SM) : SM(SM) { }
+
+  bool operator()(const DeclContextIndex::Member &M, SourceLocation Loc) const {
+    return M.MaxEnd.isInvalid() ||
+           (M.MaxEnd != Loc && SM.isBeforeInTranslationUnit(M.MaxEnd, Loc));
+  }
+};
+}
+
 bool CursorVisitor::VisitDeclContext(DeclContext *DC) {
   DeclContext::decl_iterator I = DC->decls_begin(), E = DC->decls_end();
 
+  // Skip the declarations whose extents all end before the region of
+  // interest; the loop below would skip them one at a time.
+  if (RegionOfInterest.isValid()) {
+    if (!TU->DeclContextIndex)
+      TU->DeclContextIndex = new DeclContextIndex;
+    const DeclContextIndex::Context &Ctx
+      = static_cast<DeclContextIndex *>(TU->DeclContextIndex)->get(DC, TU);
+    if (!Ctx.Members.empty()) {
+      std::vector<DeclContextIndex::Member>::const_iterator First
+        = std::lower_bound(Ctx.Members.begin(), Ctx.Members.end(),
+                           RegionOfInterest.getBegin(),
+                           MemberEndsBefore(AU->getSourceManager()));
+      if (First == Ctx.Members.end())
+        return false;
+      I = DeclContext::decl_iterator(First->D);
+    }
+  }
+
   // FIXME: Eventually remove.  This part of a hack to support proper
   // iteration over all Decls contained lexically within an ObjC container.
   SaveAndRestore<DeclContext::decl_iterator*> DI_saved(DI_current, &I);
@@ -598,32 +771,9 @@ bool CursorVisitor::VisitDeclContext(DeclContext *DC) {
 
   for ( ; I != E; ++I) {
     Decl *D = *I;
-    if (D->getLexicalDeclContext() != DC)
+    CXCursor Cursor;
+    if (!getDeclContextMemberCursor(D, DC, TU, RegionOfInterest, Cursor))
       continue;
-    CXCursor Cursor = MakeCXCursor(D, TU, RegionOfInterest);
-
-    // Ignore synthesized ivars here, otherwise if we have something like:
-    //   @synthesize prop = _prop;
-    // and '_prop' is not declared, we will encounter a '_prop' ivar before
-    // encountering the 'prop' synthesize declaration and we will think that
-    // we passed the region-of-interest.
-    if (ObjCIvarDecl *ivarD = dyn_cast<ObjCIvarDecl>(D)) {
-      if (ivarD->getSynthesize())
-        continue;
-    }
-
-    // FIXME: ObjCClassRef/ObjCProtocolRef for forward class/protocol
-    // declarations is a mismatch with the compiler semantics.
-    if (Cursor.kind == CXCursor_ObjCInterfaceDecl) {
-      ObjCInterfaceDecl *ID = cast<ObjCInterfaceDecl>(D);
-      if (!ID->isThisDeclarationADefinition())
-        Cursor = MakeCursorObjCClassRef(ID, ID->getLocation(), TU);
-
-    } else if (Cursor.kind == CXCursor_ObjCProtocolDecl) {
-      ObjCProtocolDecl *PD = cast<ObjCProtocolDecl>(D);
-      if (!PD->isThisDeclarationADefinition())
-        Cursor = MakeCursorObjCProtocolRef(PD, PD->getLocation(), TU);
-    }
 
     const Optional<bool> &V = shouldVisitCursor(Cursor);
     if (!V.hasValue())
@@ -1856,6 +2006,7 @@ public:
   void VisitLambdaExpr(const LambdaExpr *E);
   void VisitOMPExecutableDirective(const OMPExecutableDirective *D);
   void VisitOMPParallelDirective(const OMPParallelDirective *D);
+  void VisitOMPSimdDirective(const OMPSimdDirective *D);
 
 private:
   void AddDeclarationNameInfo(const Stmt *S);
@@ -1926,6 +2077,9 @@ public:
 };
 
 void OMPClauseEnqueue::VisitOMPDefaultClause(const OMPDefaultClause *C) { }
+void OMPClauseEnqueue::VisitOMPSafelenClause(const OMPSafelenClause *C) {
+  Visitor->AddStmt(C->getSafelen());
+}
 #define PROCESS_OMP_CLAUSE_LIST(Class, Node)                                   \
   for (OMPVarList<Class>::varlist_const_iterator I = Node->varlist_begin(),    \
                                                  E = Node->varlist_end();      \
@@ -2239,6 +2393,10 @@ void EnqueueVisitor::VisitOMPParallelDirective(const OMPParallelDirective *D) {
   VisitOMPExecutableDirective(D);
 }
 
+void EnqueueVisitor::VisitOMPSimdDirective(const OMPSimdDirective *D) {
+  VisitOMPExecutableDirective(D);
+}
+
 void CursorVisitor::EnqueueWorkList(VisitorWorkList &WL, const Stmt *S) {
   EnqueueVisitor(WL, MakeCXCursor(S, StmtParent, TU,RegionOfInterest)).Visit(S);
 }
@@ -2539,18 +2697,19 @@ static void fatal_error_handler(void *user_data, const std::string& reason,
 extern "C" {
 CXIndex clang_createIndex(int excludeDeclarationsFromPCH,
                           int displayDiagnostics) {
-  // Disable pretty stack trace functionality, which will otherwise be a very
-  // poor citizen of the world and set up all sorts of signal handlers.
-  llvm::DisablePrettyStackTrace = true;
-
   // We use crash recovery to make some of our APIs more reliable, implicitly
   // enable it.
   llvm::CrashRecoveryContext::Enable();
 
-  // Enable support for multithreading in LLVM.
+  // Enable support for multithreading in LLVM, once for all the indexes that
+  // threads may be creating at the same time.
   {
     llvm::sys::ScopedLock L(EnableMultithreadingMutex);
     if (!EnabledMultithreading) {
+      // Disable pretty stack trace functionality, which will otherwise be a
+      // very poor citizen of the world and set up all sorts of signal
+      // handlers.
+      llvm::DisablePrettyStackTrace = true;
       llvm::install_fatal_error_handler(fatal_error_handler, 0);
       llvm::llvm_start_multithreaded();
       EnabledMultithreading = true;
@@ -2583,6 +2742,11 @@ void clang_CXIndex_setGlobalOptions(CXIndex CIdx, unsigned options) {
     static_cast<CIndexer *>(CIdx)->setCXGlobalOptFlags(options);
 }
 
+void clang_CXIndex_setMemoryBudget(CXIndex CIdx, unsigned long long bytes) {
+  if (CIdx)
+    static_cast<CIndexer *>(CIdx)->setMemoryBudget(bytes);
+}
+
 unsigned clang_CXIndex_getGlobalOptions(CXIndex CIdx) {
   if (CIdx)
     return static_cast<CIndexer *>(CIdx)->getCXGlobalOptFlags();
@@ -2677,6 +2841,10 @@ static void clang_parseTranslationUnit_Impl(void *UserData) {
     = options & CXTranslationUnit_IncludeBriefCommentsInCodeCompletion;
   bool SkipFunctionBodies = options & CXTranslationUnit_SkipFunctionBodies;
   bool ForSerialization = options & CXTranslationUnit_ForSerialization;
+  bool BackgroundPreambleRebuild
+    = options & CXTranslationUnit_BackgroundPreambleRebuild;
+  bool IncrementalReparse = options & CXTranslationUnit_IncrementalReparse;
+  bool SharePreamble = options & CXTranslationUnit_SharePreamble;
 
   // Configure the diagnostics.
   IntrusiveRefCntPtr<DiagnosticsEngine>
@@ -2763,6 +2931,7 @@ static void clang_parseTranslationUnit_Impl(void *UserData) {
                                  SkipFunctionBodies,
                                  /*UserFilesAreVolatile=*/true,
                                  ForSerialization,
+                                 SharePreamble,
                                  &ErrUnit));
 
   if (NumErrors != Diags->getClient()->getNumErrors()) {
@@ -2771,6 +2940,11 @@ static void clang_parseTranslationUnit_Impl(void *UserData) {
       printDiagsToStderr(Unit ? Unit.get() : ErrUnit.get());
   }
 
+  if (Unit) {
+    Unit->setRebuildPreambleInBackground(BackgroundPreambleRebuild);
+    Unit->setReparseIncrementally(IncrementalReparse);
+  }
+
   PTUI->result = MakeCXTranslationUnit(CXXIdx, Unit.take());
 }
 CXTranslationUnit clang_parseTranslationUnit(CXIndex CIdx,
@@ -2895,20 +3069,50 @@ int clang_saveTranslationUnit(CXTranslationUnit TU, const char *FileName,
 
 void clang_disposeTranslationUnit(CXTranslationUnit CTUnit) {
   if (CTUnit) {
+    if (CTUnit->CIdx)
+      CTUnit->CIdx->removeTranslationUnit(CTUnit);
+
     // If the translation unit has been marked as unsafe to free, just discard
-    // it.
-    if (cxtu::getASTUnit(CTUnit)->isUnsafeToFree())
+    // it. A hibernating one is not woken up just to be freed.
+    if (CTUnit->TheASTUnit->isUnsafeToFree())
       return;
 
-    delete cxtu::getASTUnit(CTUnit);
+    delete CTUnit->TheASTUnit;
     delete CTUnit->StringPool;
-    delete static_cast<CXDiagnosticSetImpl *>(CTUnit->Diagnostics);
+    resetASTData(CTUnit);
     disposeOverridenCXCursorsPool(CTUnit->OverridenCursorsPool);
     delete CTUnit->FormatContext;
     delete CTUnit;
   }
 }
 
+void cxtu::resetASTData(CXTranslationUnit TU) {
+  delete static_cast<CXDiagnosticSetImpl *>(TU->Diagnostics);
+  TU->Diagnostics = 0;
+
+  delete static_cast<DeclContextIndex *>(TU->DeclContextIndex);
+  TU->DeclContextIndex = 0;
+
+  disposeCompletionCache(TU);
+}
+
+int clang_hibernateTranslationUnit(CXTranslationUnit TU) {
+  LOG_FUNC_SECTION {
+    *Log << TU;
+  }
+
+  if (!TU)
+    return 1;
+  if (TU->IsHibernating)
+    return 0;
+  if (TU->TheASTUnit->hibernate())
+    return 1;
+
+  resetASTData(TU);
+  TU->IsHibernating = true;
+  return 0;
+}
+
 unsigned clang_defaultReparseOptions(CXTranslationUnit TU) {
   return CXReparse_None;
 }
@@ -2928,9 +3132,9 @@ static void clang_reparseTranslationUnit_Impl(void *UserData) {
   if (!TU)
     return;
 
-  // Reset the associated diagnostics.
-  delete static_cast<CXDiagnosticSetImpl*>(TU->Diagnostics);
-  TU->Diagnostics = 0;
+  // Reset the associated diagnostics and the index of the declarations,
+  // which refer to the AST being replaced.
+  resetASTData(TU);
 
   unsigned num_unsaved_files = RTUI->num_unsaved_files;
   struct CXUnsavedFile *unsaved_files = RTUI->unsaved_files;
@@ -2942,7 +3146,9 @@ static void clang_reparseTranslationUnit_Impl(void *UserData) {
   if (CXXIdx->isOptEnabled(CXGlobalOpt_ThreadBackgroundPriorityForEditing))
     setThreadBackgroundPriority();
 
-  ASTUnit *CXXUnit = cxtu::getASTUnit(TU);
+  // A hibernating translation unit is reparsed without being reloaded first.
+  ASTUnit *CXXUnit = TU->TheASTUnit;
+  TU->IsHibernating = false;
   ASTUnit::ConcurrencyCheck Check(*CXXUnit);
   
   OwningPtr<std::vector<ASTUnit::RemappedFile> >
@@ -2963,6 +3169,8 @@ static void clang_reparseTranslationUnit_Impl(void *UserData) {
   if (!CXXUnit->Reparse(RemappedFiles->size() ? &(*RemappedFiles)[0] : 0,
                         RemappedFiles->size()))
     RTUI->result = 0;
+
+  CXXIdx->enforceMemoryBudget(TU);
 }
 
 int clang_reparseTranslationUnit(CXTranslationUnit TU,
@@ -2985,7 +3193,7 @@ int clang_reparseTranslationUnit(CXTranslationUnit TU,
 
   if (!RunSafely(CRC, clang_reparseTranslationUnit_Impl, &RTUI)) {
     fprintf(stderr, "libclang: crash detected during reparsing\n");
-    cxtu::getASTUnit(TU)->setUnsafeToFree(true);
+    TU->TheASTUnit->setUnsafeToFree(true);
     return 1;
   } else if (getenv("LIBCLANG_RESOURCE_USAGE"))
     PrintLibclangResourceUsage(TU);
@@ -2993,6 +3201,27 @@ int clang_reparseTranslationUnit(CXTranslationUnit TU,
   return RTUI.result;
 }
 
+static void notifyPreambleRebuilt(void *Context, bool Succeeded) {
+  CXTranslationUnit TU = static_cast<CXTranslationUnit>(Context);
+  if (CXPreambleRebuiltCallback Callback = TU->PreambleRebuiltCallback)
+    Callback(TU, Succeeded, TU->PreambleRebuiltClientData);
+}
+
+void clang_setPreambleRebuiltCallback(CXTranslationUnit TU,
+                                      CXPreambleRebuiltCallback callback,
+                                      CXClientData client_data) {
+  ASTUnit *CXXUnit = cxtu::getASTUnit(TU);
+  if (!CXXUnit)
+    return;
+
+  TU->PreambleRebuiltCallback = callback;
+  TU->PreambleRebuiltClientData = client_data;
+  if (callback)
+    CXXUnit->setPreambleRebuiltCallback(notifyPreambleRebuilt, TU);
+  else
+    CXXUnit->setPreambleRebuiltCallback(0, 0);
+}
+
 
 CXString clang_getTranslationUnitSpelling(CXTranslationUnit CTUnit) {
   if (!CTUnit)
@@ -3149,6 +3378,62 @@ unsigned clang_visitChildren(CXCursor parent,
   return CursorVis.VisitChildren(parent);
 }
 
+namespace {
+struct DescendantsData {
+  SmallVector<CXCursor, 64> Cursors;
+  SmallVector<int, 64> Parents;
+  /// The indices of the cursors on the path from the root to the cursor
+  /// visited last.
+  SmallVector<unsigned, 16> Ancestors;
+};
+}
+
+static enum CXChildVisitResult collectDescendant(CXCursor C, CXCursor Parent,
+                                                 CXClientData ClientData) {
+  DescendantsData *Data = static_cast<DescendantsData *>(ClientData);
+
+  // The traversal is in preorder, so the parent of C is on the path to the
+  // cursor visited last, unless it is the root.
+  while (!Data->Ancestors.empty() &&
+         !clang_equalCursors(Data->Cursors[Data->Ancestors.back()], Parent))
+    Data->Ancestors.pop_back();
+
+  Data->Parents.push_back(Data->Ancestors.empty() ? -1
+                                                  : Data->Ancestors.back());
+  Data->Ancestors.push_back(Data->Cursors.size());
+  Data->Cursors.push_back(C);
+  return CXChildVisit_Recurse;
+}
+
+void clang_getCursorDescendants(CXCursor parent, CXCursor **cursors,
+                                int **parents, unsigned *num_cursors) {
+  if (cursors)
+    *cursors = 0;
+  if (parents)
+    *parents = 0;
+  if (num_cursors)
+    *num_cursors = 0;
+  if (!cursors || !parents || !num_cursors)
+    return;
+
+  DescendantsData Data;
+  clang_visitChildren(parent, collectDescendant, &Data);
+  if (Data.Cursors.empty())
+    return;
+
+  *cursors = (CXCursor *)malloc(sizeof(CXCursor) * Data.Cursors.size());
+  *parents = (int *)malloc(sizeof(int) * Data.Parents.size());
+  memmove(*cursors, Data.Cursors.data(),
+          sizeof(CXCursor) * Data.Cursors.size());
+  memmove(*parents, Data.Parents.data(), sizeof(int) * Data.Parents.size());
+  *num_cursors = Data.Cursors.size();
+}
+
+void clang_disposeCursorDescendants(CXCursor *cursors, int *parents) {
+  free(cursors);
+  free(parents);
+}
+
 #ifndef __has_feature
 #define __has_feature(x) 0
 #endif
@@ -3815,6 +4100,8 @@ CXString clang_getCursorKindSpelling(enum CXCursorKind Kind) {
     return cxstring::createRef("ModuleImport");
   case CXCursor_OMPParallelDirective:
       return cxstring::createRef("OMPParallelDirective");
+  case CXCursor_OMPSimdDirective:
+      return cxstring::createRef("OMPSimdDirective");
   }
 
   llvm_unreachable("Unhandled CXCursorKind");
@@ -4322,7 +4609,9 @@ static SourceRange getRawCursorExtent(CXCursor C) {
       if (!cxcursor::isFirstInDeclGroup(C))
         R.setBegin(VD->getLocation());
     }
-    return R;
+    // Declarations of the main file may have been precompiled into the
+    // preamble.
+    return getCursorASTUnit(C)->mapRangeFromPreamble(R);
   }
   return SourceRange();
 }
@@ -4362,7 +4651,7 @@ static SourceRange getFullCursorExtent(CXCursor C, SourceManager &SrcMgr) {
         R.setBegin(VD->getLocation());
     }
 
-    return R;    
+    return getCursorASTUnit(C)->mapRangeFromPreamble(R);
   }
   
   return getRawCursorExtent(C);
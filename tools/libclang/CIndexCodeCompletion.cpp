@@ -21,12 +21,14 @@
 #include "clang/AST/Decl.h"
 #include "clang/AST/DeclObjC.h"
 #include "clang/AST/Type.h"
+#include "clang/Basic/CharInfo.h"
 #include "clang/Basic/FileManager.h"
 #include "clang/Basic/SourceManager.h"
 #include "clang/Frontend/ASTUnit.h"
 #include "clang/Frontend/CompilerInstance.h"
 #include "clang/Frontend/FrontendDiagnostic.h"
 #include "clang/Sema/CodeCompleteConsumer.h"
+#include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/Support/Atomic.h"
@@ -36,6 +38,7 @@
 #include "llvm/Support/Program.h"
 #include "llvm/Support/Timer.h"
 #include "llvm/Support/raw_ostream.h"
+#include <algorithm>
 #include <cstdio>
 #include <cstdlib>
 #include <string>
@@ -525,35 +528,326 @@ static unsigned long long getContextsForContextKind(
 }
 
 namespace {
+  /// \brief How well the typed text of a result matches the filter given to
+  /// clang_codeCompleteAtWithFilter, from best to worst.
+  enum FilterMatch {
+    FM_ExactPrefix,
+    FM_Prefix,
+    FM_Fuzzy,
+    FM_None
+  };
+
+  FilterMatch matchFilter(StringRef Text, StringRef Filter) {
+    if (Text.startswith(Filter))
+      return FM_ExactPrefix;
+    if (Text.size() >= Filter.size() &&
+        Text.substr(0, Filter.size()).equals_lower(Filter))
+      return FM_Prefix;
+
+    // Look for the characters of the filter in order, ignoring case.
+    StringRef::size_type Pos = 0;
+    for (StringRef::iterator I = Filter.begin(), E = Filter.end(); I != E;
+         ++I) {
+      char C = toLowercase(*I);
+      while (Pos != Text.size() && toLowercase(Text[Pos]) != C)
+        ++Pos;
+      if (Pos == Text.size())
+        return FM_None;
+      ++Pos;
+    }
+    return FM_Fuzzy;
+  }
+
+  /// \brief Returns the text that \p R would insert, if that is known without
+  /// building its completion string.
+  bool getTypedText(const CodeCompletionResult &R, StringRef &Text) {
+    switch (R.Kind) {
+    case CodeCompletionResult::RK_Declaration: {
+      DeclarationName Name = R.Declaration->getDeclName();
+      if (IdentifierInfo *II = Name.getAsIdentifierInfo()) {
+        Text = II->getName();
+        return true;
+      }
+      if (Name.getNameKind() == DeclarationName::ObjCZeroArgSelector ||
+          Name.getNameKind() == DeclarationName::ObjCOneArgSelector ||
+          Name.getNameKind() == DeclarationName::ObjCMultiArgSelector) {
+        Text = Name.getObjCSelector().getNameForSlot(0);
+        return true;
+      }
+      // Constructors, operators and the like.
+      return false;
+    }
+
+    case CodeCompletionResult::RK_Keyword:
+      Text = R.Keyword;
+      return true;
+
+    case CodeCompletionResult::RK_Macro:
+      Text = R.Macro->getName();
+      return true;
+
+    case CodeCompletionResult::RK_Pattern:
+      if (const char *TypedText = R.Pattern->getTypedText())
+        Text = TypedText;
+      else
+        Text = StringRef();
+      return true;
+    }
+    llvm_unreachable("Invalid CodeCompletionResult::ResultKind!");
+  }
+
+  /// \brief A result that passed the filter, with what it is ranked by.
+  struct RankedCompletion {
+    unsigned Index;
+    FilterMatch Match;
+    unsigned Priority;
+    StringRef Text;
+    /// \brief The completion string of the result, if it had to be built to
+    /// find its typed text.
+    CodeCompletionString *String;
+  };
+
+  struct RankedCompletionLess {
+    bool operator()(const RankedCompletion &X,
+                    const RankedCompletion &Y) const {
+      if (X.Match != Y.Match)
+        return X.Match < Y.Match;
+      if (X.Priority != Y.Priority)
+        return X.Priority < Y.Priority;
+      if (int Cmp = X.Text.compare(Y.Text))
+        return Cmp < 0;
+      return X.Index < Y.Index;
+    }
+  };
+
+  /// \brief Sort \p Ranked best first and drop all but the best
+  /// \p MaxResults, if that is not zero.
+  void selectBestCompletions(SmallVectorImpl<RankedCompletion> &Ranked,
+                             unsigned MaxResults) {
+    if (MaxResults && Ranked.size() > MaxResults) {
+      std::partial_sort(Ranked.begin(), Ranked.begin() + MaxResults,
+                        Ranked.end(), RankedCompletionLess());
+      Ranked.resize(MaxResults);
+    } else {
+      std::sort(Ranked.begin(), Ranked.end(), RankedCompletionLess());
+    }
+  }
+
+  /// \brief The complete results of the last code completion in a translation
+  /// unit that asked for CXCodeComplete_ReuseResults, and what they depend on.
+  struct CompletionResultCache {
+    /// \brief Whether the results are complete and may be reused.
+    bool Valid;
+    std::string Filename;
+    unsigned Line, Column, Options;
+    /// \brief The hash of the unsaved files, of which the file that was
+    /// completed in only counts up to the completion point.
+    llvm::hash_code TextHash;
+
+    IntrusiveRefCntPtr<GlobalCodeCompletionAllocator> CodeCompletionAllocator;
+    IntrusiveRefCntPtr<GlobalCodeCompletionAllocator> CachedCompletionAllocator;
+    std::vector<CXCompletionResult> Results;
+    std::vector<CXCompletionResult> Candidates;
+
+    enum CodeCompletionContext::Kind ContextKind;
+    unsigned long long Contexts;
+    enum CXCursorKind ContainerKind;
+    std::string ContainerUSR;
+    unsigned ContainerIsIncomplete;
+    std::string Selector;
+
+    /// \brief The filter that the results were last filtered by, and the
+    /// indices of the results that matched it. A longer filter that starts
+    /// with it can only match some of those.
+    std::string LastFilter;
+    std::vector<unsigned> LastMatches;
+    bool HasLastMatches;
+
+    CompletionResultCache() : Valid(false), HasLastMatches(false) { }
+
+    bool isFor(StringRef File, unsigned L, unsigned C, unsigned Opts,
+               llvm::hash_code Hash) const {
+      return Valid && StringRef(Filename) == File && Line == L &&
+             Column == C && Options == Opts && TextHash == Hash;
+    }
+
+    /// \brief Start collecting the results of a code completion.
+    void reset(StringRef File, unsigned L, unsigned C, unsigned Opts,
+               llvm::hash_code Hash) {
+      Valid = false;
+      Filename = File.str();
+      Line = L;
+      Column = C;
+      Options = Opts;
+      TextHash = Hash;
+      CodeCompletionAllocator = 0;
+      CachedCompletionAllocator = 0;
+      Results.clear();
+      Candidates.clear();
+      LastFilter.clear();
+      LastMatches.clear();
+      HasLastMatches = false;
+    }
+
+    /// \brief Remember the results captured in \p AllocatedResults.
+    void store(const AllocatedCXCodeCompleteResults &AllocatedResults,
+               ArrayRef<CXCompletionResult> NewResults,
+               ArrayRef<CXCompletionResult> NewCandidates) {
+      CodeCompletionAllocator = AllocatedResults.CodeCompletionAllocator;
+      CachedCompletionAllocator = AllocatedResults.CachedCompletionAllocator;
+      Results.assign(NewResults.begin(), NewResults.end());
+      Candidates.assign(NewCandidates.begin(), NewCandidates.end());
+      ContextKind = AllocatedResults.ContextKind;
+      Contexts = AllocatedResults.Contexts;
+      ContainerKind = AllocatedResults.ContainerKind;
+      ContainerUSR = AllocatedResults.ContainerUSR;
+      ContainerIsIncomplete = AllocatedResults.ContainerIsIncomplete;
+      Selector = AllocatedResults.Selector;
+      Valid = AllocatedResults.Diagnostics.empty();
+    }
+
+    /// \brief Fill in \p AllocatedResults with the cached results, filtered
+    /// and ranked as clang_codeCompleteAtWithFilter would.
+    void fill(AllocatedCXCodeCompleteResults &AllocatedResults,
+              const char *Filter, unsigned MaxResults);
+  };
+
+  void CompletionResultCache::fill(
+                              AllocatedCXCodeCompleteResults &AllocatedResults,
+                              const char *Filter, unsigned MaxResults) {
+    AllocatedResults.CodeCompletionAllocator = CodeCompletionAllocator;
+    AllocatedResults.CachedCompletionAllocator = CachedCompletionAllocator;
+    AllocatedResults.ContextKind = ContextKind;
+    AllocatedResults.Contexts = Contexts;
+    AllocatedResults.ContainerKind = ContainerKind;
+    AllocatedResults.ContainerUSR = ContainerUSR;
+    AllocatedResults.ContainerIsIncomplete = ContainerIsIncomplete;
+    AllocatedResults.Selector = Selector;
+
+    SmallVector<CXCompletionResult, 16> Selected;
+    if (!Filter && !MaxResults) {
+      Selected.append(Results.begin(), Results.end());
+    } else {
+      StringRef FilterText = Filter ? Filter : "";
+      bool Narrowing = HasLastMatches && FilterText.startswith(LastFilter);
+      unsigned NumCandidates = Narrowing ? LastMatches.size() : Results.size();
+      SmallVector<RankedCompletion, 16> Ranked;
+      std::vector<unsigned> Matches;
+      for (unsigned I = 0; I != NumCandidates; ++I) {
+        unsigned Index = Narrowing ? LastMatches[I] : I;
+        CodeCompletionString *String
+          = static_cast<CodeCompletionString *>(
+              Results[Index].CompletionString);
+        RankedCompletion C;
+        C.Index = Index;
+        C.Priority = String->getPriority();
+        const char *TypedText = String->getTypedText();
+        C.Text = TypedText ? TypedText : "";
+        C.Match = matchFilter(C.Text, FilterText);
+        C.String = String;
+        if (C.Match == FM_None)
+          continue;
+        Ranked.push_back(C);
+        Matches.push_back(Index);
+      }
+      LastFilter = FilterText.str();
+      LastMatches.swap(Matches);
+      HasLastMatches = true;
+
+      selectBestCompletions(Ranked, MaxResults);
+      Selected.reserve(Ranked.size() + Candidates.size());
+      for (unsigned I = 0, N = Ranked.size(); I != N; ++I)
+        Selected.push_back(Results[Ranked[I].Index]);
+    }
+    Selected.append(Candidates.begin(), Candidates.end());
+
+    AllocatedResults.Results = new CXCompletionResult [Selected.size()];
+    AllocatedResults.NumResults = Selected.size();
+    std::memcpy(AllocatedResults.Results, Selected.data(),
+                Selected.size() * sizeof(CXCompletionResult));
+  }
+
+  /// \brief Compute the hash that a CompletionResultCache is keyed on, or
+  /// return false if the file being completed in is not an unsaved file, in
+  /// which case the results are not cached.
+  bool getCompletionTextHash(StringRef Filename, unsigned Line,
+                             unsigned Column,
+                             struct CXUnsavedFile *UnsavedFiles,
+                             unsigned NumUnsavedFiles,
+                             llvm::hash_code &Hash) {
+    bool FoundFile = false;
+    Hash = llvm::hash_value(NumUnsavedFiles);
+    for (unsigned I = 0; I != NumUnsavedFiles; ++I) {
+      StringRef Name = UnsavedFiles[I].Filename;
+      StringRef Contents(UnsavedFiles[I].Contents, UnsavedFiles[I].Length);
+      if (Name == Filename) {
+        // Only the text before the completion point matters.
+        StringRef::size_type Offset = 0;
+        for (unsigned L = 1; L < Line && Offset != StringRef::npos; ++L) {
+          Offset = Contents.find('\n', Offset);
+          if (Offset != StringRef::npos)
+            ++Offset;
+        }
+        if (Offset != StringRef::npos)
+          Contents = Contents.substr(0, Offset + Column - 1);
+        FoundFile = true;
+      }
+      Hash = llvm::hash_combine(Hash, Name, Contents);
+    }
+    return FoundFile;
+  }
+
   class CaptureCompletionResults : public CodeCompleteConsumer {
     AllocatedCXCodeCompleteResults &AllocatedResults;
     CodeCompletionTUInfo CCTUInfo;
     SmallVector<CXCompletionResult, 16> StoredResults;
     CXTranslationUnit *TU;
+    /// \brief The filter and limit from clang_codeCompleteAtWithFilter.
+    const char *Filter;
+    unsigned MaxResults;
+    /// \brief When ranking, the overload candidates, which are kept apart
+    /// from the ranked results.
+    SmallVector<CXCompletionResult, 4> StoredCandidates;
+    /// \brief The number of batches of results that have been ranked.
+    unsigned NumRankedBatches;
+    /// \brief The cache that keeps all of the results, if any, in which case
+    /// they are only filtered and ranked once they are all known.
+    CompletionResultCache *Cache;
+
+    bool isRanking() const { return Filter || MaxResults; }
+
   public:
     CaptureCompletionResults(const CodeCompleteOptions &Opts,
                              AllocatedCXCodeCompleteResults &Results,
-                             CXTranslationUnit *TranslationUnit)
+                             CXTranslationUnit *TranslationUnit,
+                             const char *Filter = 0,
+                             unsigned MaxResults = 0,
+                             CompletionResultCache *Cache = 0)
       : CodeCompleteConsumer(Opts, false), 
         AllocatedResults(Results), CCTUInfo(Results.CodeCompletionAllocator),
-        TU(TranslationUnit) { }
+        TU(TranslationUnit), Filter(Filter), MaxResults(MaxResults),
+        NumRankedBatches(0), Cache(Cache) { }
     ~CaptureCompletionResults() { Finish(); }
     
     virtual void ProcessCodeCompleteResults(Sema &S, 
                                             CodeCompletionContext Context,
                                             CodeCompletionResult *Results,
                                             unsigned NumResults) {
-      StoredResults.reserve(StoredResults.size() + NumResults);
-      for (unsigned I = 0; I != NumResults; ++I) {
-        CodeCompletionString *StoredCompletion        
-          = Results[I].CreateCodeCompletionString(S, getAllocator(),
-                                                  getCodeCompletionTUInfo(),
-                                                  includeBriefComments());
-        
-        CXCompletionResult R;
-        R.CursorKind = Results[I].CursorKind;
-        R.CompletionString = StoredCompletion;
-        StoredResults.push_back(R);
+      if (isRanking() && !Cache) {
+        storeBestResults(S, Results, NumResults);
+      } else {
+        StoredResults.reserve(StoredResults.size() + NumResults);
+        for (unsigned I = 0; I != NumResults; ++I) {
+          CodeCompletionString *StoredCompletion        
+            = Results[I].CreateCodeCompletionString(S, getAllocator(),
+                                                    getCodeCompletionTUInfo(),
+                                                    includeBriefComments());
+          
+          CXCompletionResult R;
+          R.CursorKind = Results[I].CursorKind;
+          R.CompletionString = StoredCompletion;
+          StoredResults.push_back(R);
+        }
       }
       
       enum CodeCompletionContext::Kind contextKind = Context.getKind();
@@ -628,7 +922,10 @@ namespace {
         CXCompletionResult R;
         R.CursorKind = CXCursor_NotImplemented;
         R.CompletionString = StoredCompletion;
-        StoredResults.push_back(R);
+        if (isRanking() || Cache)
+          StoredCandidates.push_back(R);
+        else
+          StoredResults.push_back(R);
       }
     }
     
@@ -639,7 +936,88 @@ namespace {
     virtual CodeCompletionTUInfo &getCodeCompletionTUInfo() { return CCTUInfo; }
     
   private:
+    /// \brief Store the results that pass the filter, best first, building
+    /// completion strings only for the ones that are kept.
+    void storeBestResults(Sema &S, CodeCompletionResult *Results,
+                          unsigned NumResults) {
+      StringRef FilterText = Filter ? Filter : "";
+      SmallVector<RankedCompletion, 16> Ranked;
+      for (unsigned I = 0; I != NumResults; ++I) {
+        RankedCompletion C;
+        C.Index = I;
+        C.Priority = Results[I].Priority;
+        C.String = 0;
+        if (!getTypedText(Results[I], C.Text)) {
+          C.String = Results[I].CreateCodeCompletionString(S, getAllocator(),
+                                                    getCodeCompletionTUInfo(),
+                                                    includeBriefComments());
+          const char *TypedText = C.String->getTypedText();
+          C.Text = TypedText ? TypedText : "";
+        }
+        C.Match = matchFilter(C.Text, FilterText);
+        if (C.Match != FM_None)
+          Ranked.push_back(C);
+      }
+      selectBestCompletions(Ranked, MaxResults);
+
+      StoredResults.reserve(StoredResults.size() + Ranked.size());
+      for (unsigned I = 0, N = Ranked.size(); I != N; ++I) {
+        CodeCompletionResult &Result = Results[Ranked[I].Index];
+        CXCompletionResult R;
+        R.CursorKind = Result.CursorKind;
+        R.CompletionString = Ranked[I].String;
+        if (!R.CompletionString)
+          R.CompletionString
+            = Result.CreateCodeCompletionString(S, getAllocator(),
+                                                getCodeCompletionTUInfo(),
+                                                includeBriefComments());
+        StoredResults.push_back(R);
+      }
+      ++NumRankedBatches;
+    }
+
+    /// \brief Rank the results of all batches together, once each batch has
+    /// been ranked on its own.
+    void mergeRankedBatches() {
+      StringRef FilterText = Filter ? Filter : "";
+      SmallVector<RankedCompletion, 16> Ranked;
+      Ranked.reserve(StoredResults.size());
+      for (unsigned I = 0, N = StoredResults.size(); I != N; ++I) {
+        CodeCompletionString *String
+          = static_cast<CodeCompletionString *>(
+              StoredResults[I].CompletionString);
+        RankedCompletion C;
+        C.Index = I;
+        C.Priority = String->getPriority();
+        const char *TypedText = String->getTypedText();
+        C.Text = TypedText ? TypedText : "";
+        C.Match = matchFilter(C.Text, FilterText);
+        C.String = String;
+        Ranked.push_back(C);
+      }
+      selectBestCompletions(Ranked, MaxResults);
+
+      SmallVector<CXCompletionResult, 16> Merged;
+      Merged.reserve(Ranked.size());
+      for (unsigned I = 0, N = Ranked.size(); I != N; ++I)
+        Merged.push_back(StoredResults[Ranked[I].Index]);
+      StoredResults.swap(Merged);
+    }
+
     void Finish() {
+      if (Cache) {
+        Cache->store(AllocatedResults, StoredResults, StoredCandidates);
+        Cache->fill(AllocatedResults, Filter, MaxResults);
+        StoredResults.clear();
+        StoredCandidates.clear();
+        return;
+      }
+
+      if (NumRankedBatches > 1)
+        mergeRankedBatches();
+      StoredResults.append(StoredCandidates.begin(), StoredCandidates.end());
+      StoredCandidates.clear();
+
       AllocatedResults.Results = new CXCompletionResult [StoredResults.size()];
       AllocatedResults.NumResults = StoredResults.size();
       std::memcpy(AllocatedResults.Results, StoredResults.data(), 
@@ -649,6 +1027,11 @@ namespace {
   };
 }
 
+void cxtu::disposeCompletionCache(CXTranslationUnit TU) {
+  delete static_cast<CompletionResultCache *>(TU->CompletionCache);
+  TU->CompletionCache = 0;
+}
+
 extern "C" {
 struct CodeCompleteAtInfo {
   CXTranslationUnit TU;
@@ -658,6 +1041,8 @@ struct CodeCompleteAtInfo {
   struct CXUnsavedFile *unsaved_files;
   unsigned num_unsaved_files;
   unsigned options;
+  const char *filter;
+  unsigned max_results;
   CXCodeCompleteResults *result;
 };
 void clang_codeCompleteAt_Impl(void *UserData) {
@@ -669,6 +1054,8 @@ void clang_codeCompleteAt_Impl(void *UserData) {
   struct CXUnsavedFile *unsaved_files = CCAI->unsaved_files;
   unsigned num_unsaved_files = CCAI->num_unsaved_files;
   unsigned options = CCAI->options;
+  const char *filter = CCAI->filter;
+  unsigned max_results = CCAI->max_results;
   bool IncludeBriefComments = options & CXCodeComplete_IncludeBriefComments;
   CCAI->result = 0;
 
@@ -690,6 +1077,28 @@ void clang_codeCompleteAt_Impl(void *UserData) {
 
   ASTUnit::ConcurrencyCheck Check(*AST);
 
+  // Reuse the results of the last completion if nothing they depend on has
+  // changed.
+  CompletionResultCache *Cache = 0;
+  llvm::hash_code TextHash;
+  if ((options & CXCodeComplete_ReuseResults) &&
+      getCompletionTextHash(complete_filename, complete_line, complete_column,
+                            unsaved_files, num_unsaved_files, TextHash)) {
+    if (!TU->CompletionCache)
+      TU->CompletionCache = new CompletionResultCache;
+    Cache = static_cast<CompletionResultCache *>(TU->CompletionCache);
+    if (Cache->isFor(complete_filename, complete_line, complete_column,
+                     options, TextHash)) {
+      AllocatedCXCodeCompleteResults *Results =
+        new AllocatedCXCodeCompleteResults(AST->getFileSystemOpts());
+      Cache->fill(*Results, filter, max_results);
+      CCAI->result = Results;
+      return;
+    }
+    Cache->reset(complete_filename, complete_line, complete_column, options,
+                 TextHash);
+  }
+
   // Perform the remapping of source files.
   SmallVector<ASTUnit::RemappedFile, 4> RemappedFiles;
   for (unsigned I = 0; I != num_unsaved_files; ++I) {
@@ -713,7 +1122,8 @@ void clang_codeCompleteAt_Impl(void *UserData) {
   // Create a code-completion consumer to capture the results.
   CodeCompleteOptions Opts;
   Opts.IncludeBriefComments = IncludeBriefComments;
-  CaptureCompletionResults Capture(Opts, *Results, &TU);
+  CaptureCompletionResults Capture(Opts, *Results, &TU, filter, max_results,
+                                   Cache);
 
   // Perform completion.
   AST->CodeComplete(complete_filename, complete_line, complete_column,
@@ -808,6 +1218,26 @@ void clang_codeCompleteAt_Impl(void *UserData) {
 #endif
   CCAI->result = Results;
 }
+static CXCodeCompleteResults *codeCompleteAt(CodeCompleteAtInfo &CCAI) {
+  CXTranslationUnit TU = CCAI.TU;
+
+  if (getenv("LIBCLANG_NOTHREADS")) {
+    clang_codeCompleteAt_Impl(&CCAI);
+    return CCAI.result;
+  }
+
+  llvm::CrashRecoveryContext CRC;
+
+  if (!RunSafely(CRC, clang_codeCompleteAt_Impl, &CCAI)) {
+    fprintf(stderr, "libclang: crash detected in code completion\n");
+    cxtu::getASTUnit(TU)->setUnsafeToFree(true);
+    return 0;
+  } else if (getenv("LIBCLANG_RESOURCE_USAGE"))
+    PrintLibclangResourceUsage(TU);
+
+  return CCAI.result;
+}
+
 CXCodeCompleteResults *clang_codeCompleteAt(CXTranslationUnit TU,
                                             const char *complete_filename,
                                             unsigned complete_line,
@@ -822,23 +1252,30 @@ CXCodeCompleteResults *clang_codeCompleteAt(CXTranslationUnit TU,
 
   CodeCompleteAtInfo CCAI = { TU, complete_filename, complete_line,
                               complete_column, unsaved_files, num_unsaved_files,
-                              options, 0 };
+                              options, 0, 0, 0 };
+  return codeCompleteAt(CCAI);
+}
 
-  if (getenv("LIBCLANG_NOTHREADS")) {
-    clang_codeCompleteAt_Impl(&CCAI);
-    return CCAI.result;
+CXCodeCompleteResults *
+clang_codeCompleteAtWithFilter(CXTranslationUnit TU,
+                               const char *complete_filename,
+                               unsigned complete_line,
+                               unsigned complete_column,
+                               struct CXUnsavedFile *unsaved_files,
+                               unsigned num_unsaved_files,
+                               unsigned options,
+                               const char *filter,
+                               unsigned max_results) {
+  LOG_FUNC_SECTION {
+    *Log << TU << ' '
+         << complete_filename << ':' << complete_line << ':' << complete_column
+         << " filter=" << (filter ? filter : "") << " max=" << max_results;
   }
 
-  llvm::CrashRecoveryContext CRC;
-
-  if (!RunSafely(CRC, clang_codeCompleteAt_Impl, &CCAI)) {
-    fprintf(stderr, "libclang: crash detected in code completion\n");
-    cxtu::getASTUnit(TU)->setUnsafeToFree(true);
-    return 0;
-  } else if (getenv("LIBCLANG_RESOURCE_USAGE"))
-    PrintLibclangResourceUsage(TU);
-
-  return CCAI.result;
+  CodeCompleteAtInfo CCAI = { TU, complete_filename, complete_line,
+                              complete_column, unsaved_files, num_unsaved_files,
+                              options, filter, max_results, 0 };
+  return codeCompleteAt(CCAI);
 }
 
 unsigned clang_defaultCodeCompleteOptions(void) {
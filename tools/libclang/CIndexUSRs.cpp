@@ -35,17 +35,20 @@ class USRGenerator : public ConstDeclVisitor<USRGenerator> {
   bool IgnoreResults;
   ASTContext *Context;
   bool generatedLoc;
+  cxcursor::USRCache *Cache;
   
   llvm::DenseMap<const Type *, unsigned> TypeSubstitutions;
   
 public:
-  explicit USRGenerator(ASTContext *Ctx = 0, SmallVectorImpl<char> *extBuf = 0)
+  explicit USRGenerator(ASTContext *Ctx = 0, SmallVectorImpl<char> *extBuf = 0,
+                        cxcursor::USRCache *Cache = 0)
   : OwnedBuf(extBuf ? 0 : new SmallString<128>()),
     Buf(extBuf ? *extBuf : *OwnedBuf.get()),
     Out(Buf),
     IgnoreResults(false),
     Context(Ctx),
-    generatedLoc(false)
+    generatedLoc(false),
+    Cache(Cache)
   {
     // Add the USR space prefix.
     Out << "c:";
@@ -64,8 +67,11 @@ public:
   }
 
   bool ignoreResults() const { return IgnoreResults; }
+  bool hasGeneratedLoc() const { return generatedLoc; }
+  bool usedTypeSubstitutions() const { return !TypeSubstitutions.empty(); }
 
   // Visitation methods from generating USRs from AST elements.
+  void VisitParentDecl(const NamedDecl *D);
   void VisitDeclContext(const DeclContext *D);
   void VisitFieldDecl(const FieldDecl *D);
   void VisitFunctionDecl(const FunctionDecl *D);
@@ -154,16 +160,36 @@ static inline bool ShouldGenerateLocation(const NamedDecl *D) {
   return !D->isExternallyVisible();
 }
 
+static const cxcursor::USRCache::Entry &
+getUSRCacheEntry(const Decl *D, cxcursor::USRCache &Cache);
+
+/// \brief Generate the USR of the declaration enclosing the one whose USR is
+/// being generated, reusing its memoized USR if possible.
+void USRGenerator::VisitParentDecl(const NamedDecl *D) {
+  // Appending the memoized USR is only equivalent to visiting the declaration
+  // if nothing generated so far affects how the rest of it is generated.
+  if (Cache && !IgnoreResults && !generatedLoc && TypeSubstitutions.empty()) {
+    cxcursor::USRCache::Entry Entry = getUSRCacheEntry(D, *Cache);
+    if (Entry.Reusable) {
+      Out << StringRef(Entry.USR).substr(2);
+      IgnoreResults = Entry.Ignore;
+      generatedLoc = Entry.GeneratedLoc;
+      return;
+    }
+  }
+  Visit(D);
+}
+
 void USRGenerator::VisitDeclContext(const DeclContext *DC) {
   if (const NamedDecl *D = dyn_cast<NamedDecl>(DC))
-    Visit(D);
+    VisitParentDecl(D);
 }
 
 void USRGenerator::VisitFieldDecl(const FieldDecl *D) {
   // The USR for an ivar declared in a class extension is based on the
   // ObjCInterfaceDecl, not the ObjCCategoryDecl.
   if (const ObjCInterfaceDecl *ID = Context->getObjContainingInterface(D))
-    Visit(ID);
+    VisitParentDecl(ID);
   else
     VisitDeclContext(D->getDeclContext());
   Out << (isa<ObjCIvarDecl>(D) ? "@" : "@FI@");
@@ -294,7 +320,7 @@ void USRGenerator::VisitNamespaceAliasDecl(const NamespaceAliasDecl *D) {
 void USRGenerator::VisitObjCMethodDecl(const ObjCMethodDecl *D) {
   const DeclContext *container = D->getDeclContext();
   if (const ObjCProtocolDecl *pd = dyn_cast<ObjCProtocolDecl>(container)) {
-    Visit(pd);
+    VisitParentDecl(pd);
   }
   else {
     // The USR for a method declared in a class extension or category is based on
@@ -304,7 +330,7 @@ void USRGenerator::VisitObjCMethodDecl(const ObjCMethodDecl *D) {
       IgnoreResults = true;
       return;
     }
-    Visit(ID);
+    VisitParentDecl(ID);
   }
   // Ideally we would use 'GenObjCMethod', but this is such a hot path
   // for Objective-C code that we don't want to use
@@ -460,7 +486,7 @@ void USRGenerator::VisitTypedefDecl(const TypedefDecl *D) {
     return;
   const DeclContext *DC = D->getDeclContext();
   if (const NamedDecl *DCN = dyn_cast<NamedDecl>(DC))
-    Visit(DCN);
+    VisitParentDecl(DCN);
   Out << "@T@";
   Out << D->getName();
 }
@@ -817,6 +843,40 @@ bool cxcursor::getDeclCursorUSR(const Decl *D, SmallVectorImpl<char> &Buf) {
   return false;
 }
 
+const cxcursor::USRCache::Entry &
+cxcursor::USRCache::insert(const Decl *D, StringRef USR, bool Ignore,
+                           bool GeneratedLoc, bool Reusable) {
+  Entry &E = Entries[D];
+  E.USR = Strings.GetOrCreateValue(USR).getKeyData();
+  E.Ignore = Ignore;
+  E.GeneratedLoc = GeneratedLoc;
+  E.Reusable = Reusable;
+  return E;
+}
+
+static const cxcursor::USRCache::Entry &
+getUSRCacheEntry(const Decl *D, cxcursor::USRCache &Cache) {
+  // The USRs of redeclarations are the same.
+  D = D->getCanonicalDecl();
+  if (const cxcursor::USRCache::Entry *E = Cache.lookup(D))
+    return *E;
+
+  SmallString<128> Buf;
+  USRGenerator UG(&D->getASTContext(), &Buf, &Cache);
+  UG->Visit(D);
+  return Cache.insert(D, UG.str(), UG->ignoreResults(), UG->hasGeneratedLoc(),
+                      !UG->usedTypeSubstitutions());
+}
+
+const char *cxcursor::getCachedDeclCursorUSR(const Decl *D, USRCache &Cache) {
+  // Don't generate USRs for things with invalid locations.
+  if (!D || D->getLocStart().isInvalid())
+    return 0;
+
+  const USRCache::Entry &E = getUSRCacheEntry(D, Cache);
+  return E.Ignore ? 0 : E.USR;
+}
+
 extern "C" {
 
 CXString clang_getCursorUSR(CXCursor C) {
@@ -12,12 +12,17 @@
 //===----------------------------------------------------------------------===//
 
 #include "CIndexer.h"
+#include "CXTranslationUnit.h"
+#include "clang/AST/ASTContext.h"
 #include "clang/AST/Decl.h"
 #include "clang/AST/DeclVisitor.h"
 #include "clang/AST/StmtVisitor.h"
 #include "clang/Basic/FileManager.h"
 #include "clang/Basic/SourceManager.h"
 #include "clang/Basic/Version.h"
+#include "clang/Frontend/ASTUnit.h"
+#include "clang/Lex/PreprocessingRecord.h"
+#include "clang/Lex/Preprocessor.h"
 #include "clang/Sema/CodeCompleteConsumer.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/Config/llvm-config.h"
@@ -25,6 +30,7 @@
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Program.h"
 #include "llvm/Support/raw_ostream.h"
+#include <algorithm>
 #include <cstdio>
 #include <sstream>
 #include <vector>
@@ -44,6 +50,8 @@
 using namespace clang;
 
 const std::string &CIndexer::getClangResourcesPath() {
+  llvm::sys::ScopedLock L(Lock);
+
   // Did we already compute the path?
   if (!ResourcesPath.empty())
     return ResourcesPath;
@@ -85,3 +93,89 @@ const std::string &CIndexer::getClangResourcesPath() {
   ResourcesPath = LibClangPath.str();
   return ResourcesPath;
 }
+
+void CIndexer::addTranslationUnit(CXTranslationUnit TU) {
+  llvm::sys::ScopedLock L(Lock);
+  TU->TracksUse = MemoryBudget != 0;
+  TU->LastUse = getUseStamp();
+  TranslationUnits.push_back(TU);
+}
+
+void CIndexer::removeTranslationUnit(CXTranslationUnit TU) {
+  llvm::sys::ScopedLock L(Lock);
+  TranslationUnits.erase(std::remove(TranslationUnits.begin(),
+                                     TranslationUnits.end(), TU),
+                         TranslationUnits.end());
+}
+
+void CIndexer::setMemoryBudget(unsigned long long Bytes) {
+  {
+    llvm::sys::ScopedLock L(Lock);
+    MemoryBudget = Bytes;
+    for (unsigned I = 0, N = TranslationUnits.size(); I != N; ++I)
+      TranslationUnits[I]->TracksUse = Bytes != 0;
+  }
+  enforceMemoryBudget(0);
+}
+
+/// \brief Estimate the memory used by the AST, the preprocessor and the
+/// source buffers of \p Unit, which is what hibernating releases.
+static unsigned long long getReleasableMemory(ASTUnit &Unit) {
+  if (Unit.isHibernating() || !Unit.hasSema())
+    return 0;
+
+  ASTContext &Ctx = Unit.getASTContext();
+  SourceManager &SM = Unit.getSourceManager();
+  Preprocessor &PP = Unit.getPreprocessor();
+  unsigned long long Bytes = Ctx.getASTAllocatedMemory() +
+                             Ctx.getSideTableAllocatedMemory() +
+                             Ctx.Idents.getAllocator().getTotalMemory() +
+                             SM.getContentCacheSize() +
+                             SM.getDataStructureSizes() +
+                             SM.getMemoryBufferSizes().malloc_bytes +
+                             PP.getTotalMemory();
+  if (PreprocessingRecord *PPRec = PP.getPreprocessingRecord())
+    Bytes += PPRec->getTotalMemory();
+  return Bytes;
+}
+
+namespace {
+struct LessRecentlyUsed {
+  bool operator()(const std::pair<unsigned, CXTranslationUnit> &X,
+                  const std::pair<unsigned, CXTranslationUnit> &Y) const {
+    return X.first < Y.first;
+  }
+};
+}
+
+void CIndexer::enforceMemoryBudget(CXTranslationUnit Keep) {
+  // The lock keeps the translation units from being disposed of meanwhile.
+  llvm::sys::ScopedLock L(Lock);
+  if (!MemoryBudget)
+    return;
+
+  unsigned long long Used = 0;
+  std::vector<std::pair<unsigned, CXTranslationUnit> > Candidates;
+  for (unsigned I = 0, N = TranslationUnits.size(); I != N; ++I) {
+    CXTranslationUnit TU = TranslationUnits[I];
+    if (TU->IsHibernating)
+      continue;
+    Used += getReleasableMemory(*TU->TheASTUnit);
+    if (TU != Keep && !TU->TheASTUnit->isUnsafeToFree())
+      Candidates.push_back(std::make_pair(TU->LastUse, TU));
+  }
+  if (Used <= MemoryBudget)
+    return;
+
+  std::sort(Candidates.begin(), Candidates.end(), LessRecentlyUsed());
+  for (unsigned I = 0, N = Candidates.size(); I != N && Used > MemoryBudget;
+       ++I) {
+    CXTranslationUnit TU = Candidates[I].second;
+    unsigned long long Bytes = getReleasableMemory(*TU->TheASTUnit);
+    if (TU->TheASTUnit->hibernate())
+      continue;
+    cxtu::resetASTData(TU);
+    TU->IsHibernating = true;
+    Used -= std::min(Used, Bytes);
+  }
+}
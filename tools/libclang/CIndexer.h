@@ -17,6 +17,8 @@
 
 #include "clang-c/Index.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Atomic.h"
+#include "llvm/Support/Mutex.h"
 #include "llvm/Support/Path.h"
 #include <vector>
 
@@ -39,9 +41,26 @@ class CIndexer {
 
   std::string ResourcesPath;
 
+  /// \brief The translation units of this index, among which the memory
+  /// budget is enforced.
+  std::vector<CXTranslationUnit> TranslationUnits;
+
+  /// \brief The memory, in bytes, that the awake translation units may use,
+  /// or zero for no limit.
+  unsigned long long MemoryBudget;
+
+  /// \brief Counts uses of the translation units, to find the least recently
+  /// used ones.
+  volatile llvm::sys::cas_flag UseClock;
+
+  /// \brief Guards \c Options, \c ResourcesPath, \c TranslationUnits and
+  /// \c MemoryBudget, which translation units of this index read from
+  /// whichever thread uses them.
+  mutable llvm::sys::Mutex Lock;
+
 public:
  CIndexer() : OnlyLocalDecls(false), DisplayDiagnostics(false),
-              Options(CXGlobalOpt_None) { }
+              Options(CXGlobalOpt_None), MemoryBudget(0), UseClock(0) { }
   
   /// \brief Whether we only want to see "local" declarations (that did not
   /// come from a previous precompiled header). If false, we want to see all
@@ -54,15 +73,34 @@ public:
     DisplayDiagnostics = Display;
   }
 
-  unsigned getCXGlobalOptFlags() const { return Options; }
-  void setCXGlobalOptFlags(unsigned options) { Options = options; }
+  unsigned getCXGlobalOptFlags() const {
+    llvm::sys::ScopedLock L(Lock);
+    return Options;
+  }
+  void setCXGlobalOptFlags(unsigned options) {
+    llvm::sys::ScopedLock L(Lock);
+    Options = options;
+  }
 
   bool isOptEnabled(CXGlobalOptFlags opt) const {
-    return Options & opt;
+    return getCXGlobalOptFlags() & opt;
   }
 
   /// \brief Get the path of the clang resource files.
   const std::string &getClangResourcesPath();
+
+  void addTranslationUnit(CXTranslationUnit TU);
+  void removeTranslationUnit(CXTranslationUnit TU);
+
+  void setMemoryBudget(unsigned long long Bytes);
+
+  /// \brief Returns a value greater than the one returned by any previous
+  /// call.
+  unsigned getUseStamp() { return llvm::sys::AtomicIncrement(&UseClock); }
+
+  /// \brief Hibernate the least recently used translation units of this
+  /// index, other than \p Keep, until the awake ones fit in the memory budget.
+  void enforceMemoryBudget(CXTranslationUnit Keep);
 };
 
   /// \brief Return the current size to request for "safety".
@@ -16,7 +16,10 @@
 
 #include "clang-c/Index.h"
 #include "clang/Basic/SourceLocation.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/PointerUnion.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/Allocator.h"
 #include <utility>
 
 namespace clang {
@@ -287,6 +290,47 @@ CXCursor getTypeRefCursor(CXCursor cursor);
 /// false otherwise.
 bool getDeclCursorUSR(const Decl *D, SmallVectorImpl<char> &Buf);
 
+/// \brief Memoizes the USRs of the declarations of one translation unit.
+///
+/// USRs are keyed by canonical declaration and interned, so equal USRs share
+/// a pointer. The USR of an enclosing declaration is reused as the prefix of
+/// the USRs of its members instead of being generated again.
+class USRCache {
+public:
+  struct Entry {
+    /// \brief The interned USR, including the "c:" prefix.
+    const char *USR;
+    /// \brief Whether the USR should be ignored.
+    bool Ignore;
+    /// \brief Whether the USR contains the location of the declaration.
+    bool GeneratedLoc;
+    /// \brief Whether the USR can be used as the prefix of another USR; this
+    /// is false when generating it used type substitutions, which the rest of
+    /// the other USR would refer to.
+    bool Reusable;
+  };
+
+private:
+  llvm::DenseMap<const Decl *, Entry> Entries;
+  llvm::StringMap<char, llvm::BumpPtrAllocator> Strings;
+
+public:
+  /// \brief Returns the entry of the canonical declaration \p D, or null if
+  /// its USR has not been generated yet.
+  const Entry *lookup(const Decl *D) const {
+    llvm::DenseMap<const Decl *, Entry>::const_iterator I = Entries.find(D);
+    return I == Entries.end() ? 0 : &I->second;
+  }
+
+  const Entry &insert(const Decl *D, StringRef USR, bool Ignore,
+                      bool GeneratedLoc, bool Reusable);
+};
+
+/// \brief Like \c getDeclCursorUSR, but memoizes the USR in \p Cache.
+/// \returns the interned USR, or null if no USR was computed or the result
+/// should be ignored.
+const char *getCachedDeclCursorUSR(const Decl *D, USRCache &Cache);
+
 bool operator==(CXCursor X, CXCursor Y);
   
 inline bool operator!=(CXCursor X, CXCursor Y) {
@@ -29,8 +29,21 @@ struct CXTranslationUnitImpl {
   clang::cxstring::CXStringPool *StringPool;
   void *Diagnostics;
   void *OverridenCursorsPool;
+  void *DeclContextIndex;
+  /// \brief The results of the last code completion that asked for
+  /// CXCodeComplete_ReuseResults, if they can still be reused.
+  void *CompletionCache;
   clang::SimpleFormatContext *FormatContext;
   unsigned FormatInMemoryUniqueId;
+  CXPreambleRebuiltCallback PreambleRebuiltCallback;
+  CXClientData PreambleRebuiltClientData;
+  /// \brief Whether the AST unit is hibernating, and must be woken up before
+  /// it is used.
+  bool IsHibernating;
+  /// \brief Whether uses of the translation unit are recorded in \c LastUse,
+  /// because its index has a memory budget.
+  bool TracksUse;
+  unsigned LastUse;
 };
 
 namespace clang {
@@ -38,9 +51,22 @@ namespace cxtu {
 
 CXTranslationUnitImpl *MakeCXTranslationUnit(CIndexer *CIdx, ASTUnit *AU);
 
+/// \brief Record a use of \p TU, waking its AST unit up if it is
+/// hibernating.
+void noteUse(CXTranslationUnit TU);
+
+/// \brief Throw away the data that libclang computed from the AST of \p TU,
+/// before the AST is replaced or released.
+void resetASTData(CXTranslationUnit TU);
+
+/// \brief Throw away the code-completion results cached for \p TU.
+void disposeCompletionCache(CXTranslationUnit TU);
+
 static inline ASTUnit *getASTUnit(CXTranslationUnit TU) {
   if (!TU)
     return 0;
+  if (TU->IsHibernating || TU->TracksUse)
+    noteUse(TU);
   return TU->TheASTUnit;
 }
 
@@ -8,6 +8,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "IndexingContext.h"
+#include "UnitIndex.h"
 #include "CIndexDiagnostic.h"
 #include "CIndexer.h"
 #include "CLog.h"
@@ -17,6 +18,7 @@
 #include "CXTranslationUnit.h"
 #include "clang/AST/ASTConsumer.h"
 #include "clang/AST/DeclVisitor.h"
+#include "clang/Basic/WorkerPool.h"
 #include "clang/Frontend/ASTUnit.h"
 #include "clang/Frontend/CompilerInstance.h"
 #include "clang/Frontend/CompilerInvocation.h"
@@ -28,6 +30,7 @@
 #include "clang/Lex/Preprocessor.h"
 #include "clang/Sema/SemaConsumer.h"
 #include "llvm/Support/CrashRecoveryContext.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Mutex.h"
 #include "llvm/Support/MutexGuard.h"
@@ -40,6 +43,19 @@ static void indexDiagnostics(CXTranslationUnit TU, IndexingContext &IdxCtx);
 
 namespace {
 
+/// \brief Where the unit index of a translation unit goes, when the indexing
+/// session writes unit indexes.
+struct UnitIndexInfo {
+  /// \brief The unit index directory.
+  StringRef Dir;
+  /// \brief The path of the translation unit's unit index.
+  StringRef Path;
+  UnitIndexBuilder &Builder;
+
+  UnitIndexInfo(StringRef Dir, StringRef Path, UnitIndexBuilder &Builder)
+    : Dir(Dir), Path(Path), Builder(Builder) {}
+};
+
 //===----------------------------------------------------------------------===//
 // Skip Parsed Bodies
 //===----------------------------------------------------------------------===//
@@ -55,7 +71,8 @@ class TUSkipBodyControl {
 public:
   TUSkipBodyControl(SessionSkipBodyData &sessionData,
                     PPConditionalDirectiveRecord &ppRec,
-                    Preprocessor &pp) { }
+                    Preprocessor &pp,
+                    const UnitIndexInfo *unitInfo) { }
   bool isParsed(SourceLocation Loc, FileID FID, const FileEntry *FE) {
     return false;
   }
@@ -108,8 +125,6 @@ public:
   }
 };
 
-typedef llvm::DenseSet<PPRegion> PPRegionSetTy;
-
 } // end anonymous namespace
 
 namespace llvm {
@@ -145,23 +160,89 @@ namespace llvm {
 namespace {
 
 class SessionSkipBodyData {
+public:
+  /// \brief The regions parsed by the translation unit of a unit index.
+  typedef llvm::StringMapEntry<std::vector<PPRegion> > UnitRegionsEntry;
+
+private:
   llvm::sys::Mutex Mux;
-  PPRegionSetTy ParsedRegions;
+
+  /// \brief The regions that a translation unit of the session has parsed or
+  /// started to parse, with the unit index that records them, or null when
+  /// the session writes no unit indexes. Translation units indexed
+  /// concurrently claim regions here as they reach them, so that a region is
+  /// parsed by only one of them.
+  llvm::DenseMap<PPRegion, UnitRegionsEntry *> ParsedRegions;
+
+  /// \brief When the session writes unit indexes, the regions parsed by each
+  /// unit, by the path of its unit index, starting with those recorded in the
+  /// unit index directory.
+  llvm::StringMap<std::vector<PPRegion> > UnitRegions;
+  bool LoadedUnitRegions;
 
 public:
-  SessionSkipBodyData() : Mux(/*recursive=*/false) {}
-  ~SessionSkipBodyData() {
-    //llvm::errs() << "RegionData: " << Skipped.size() << " - " << Skipped.getMemorySize() << "\n";
-  }
+  SessionSkipBodyData() : Mux(/*recursive=*/false), LoadedUnitRegions(false) {}
+
+  /// \brief Called when a translation unit starts, returning the entry that
+  /// will record the regions it parses in its unit index, if it has one.
+  ///
+  /// The regions that only the translation unit's own unit index records are
+  /// released, since the unit index is about to be replaced.
+  UnitRegionsEntry *beginUnit(const UnitIndexInfo *UnitInfo) {
+    if (!UnitInfo)
+      return 0;
 
-  void copyTo(PPRegionSetTy &Set) {
     llvm::MutexGuard MG(Mux);
-    Set = ParsedRegions;
+    if (!LoadedUnitRegions) {
+      loadUnitRegions(UnitInfo->Dir);
+      LoadedUnitRegions = true;
+    }
+    UnitRegionsEntry &Unit = UnitRegions.GetOrCreateValue(UnitInfo->Path);
+    std::vector<PPRegion> &Regions = Unit.getValue();
+    for (unsigned I = 0, N = Regions.size(); I != N; ++I) {
+      llvm::DenseMap<PPRegion, UnitRegionsEntry *>::iterator
+        Known = ParsedRegions.find(Regions[I]);
+      if (Known != ParsedRegions.end() && Known->second == &Unit)
+        ParsedRegions.erase(Known);
+    }
+    Regions.clear();
+    return &Unit;
   }
 
-  void update(ArrayRef<PPRegion> Regions) {
+  /// \brief Determine whether another translation unit has parsed, or is
+  /// parsing, \p Region. If not, the region is claimed for the translation
+  /// unit whose unit index regions are \p Unit.
+  bool claim(const PPRegion &Region, UnitRegionsEntry *Unit) {
     llvm::MutexGuard MG(Mux);
-    ParsedRegions.insert(Regions.begin(), Regions.end());
+    if (!ParsedRegions.insert(std::make_pair(Region, Unit)).second)
+      return true;
+    if (Unit)
+      Unit->getValue().push_back(Region);
+    return false;
+  }
+
+private:
+  void loadUnitRegions(StringRef Dir) {
+    llvm::error_code EC;
+    SmallVector<UnitRegion, 32> Regions;
+    for (llvm::sys::fs::directory_iterator I(Dir, EC), E; !EC && I != E;
+         I.increment(EC)) {
+      if (!isUnitIndexPath(I->path()) || UnitRegions.count(I->path()))
+        continue;
+      OwningPtr<UnitIndexReader> Reader(UnitIndexReader::load(I->path()));
+      if (!Reader)
+        continue;
+      Regions.clear();
+      Reader->getRegions(Regions);
+      UnitRegionsEntry &Unit = UnitRegions.GetOrCreateValue(I->path());
+      for (unsigned R = 0, N = Regions.size(); R != N; ++R) {
+        PPRegion Region(llvm::sys::fs::UniqueID(Regions[R].Device,
+                                                Regions[R].File),
+                        Regions[R].Offset, Regions[R].ModTime);
+        Unit.getValue().push_back(Region);
+        ParsedRegions.insert(std::make_pair(Region, &Unit));
+      }
+    }
   }
 };
 
@@ -169,8 +250,13 @@ class TUSkipBodyControl {
   SessionSkipBodyData &SessionData;
   PPConditionalDirectiveRecord &PPRec;
   Preprocessor &PP;
+  const UnitIndexInfo *UnitInfo;
+  SessionSkipBodyData::UnitRegionsEntry *Unit;
 
-  PPRegionSetTy ParsedRegions;
+  /// \brief Whether the bodies of each region seen so far are skipped, so
+  /// that this translation unit does not skip the regions that it claimed
+  /// itself when it comes back to them.
+  llvm::DenseMap<PPRegion, bool> KnownRegions;
   SmallVector<PPRegion, 32> NewParsedRegions;
   PPRegion LastRegion;
   bool LastIsParsed;
@@ -178,9 +264,10 @@ class TUSkipBodyControl {
 public:
   TUSkipBodyControl(SessionSkipBodyData &sessionData,
                     PPConditionalDirectiveRecord &ppRec,
-                    Preprocessor &pp)
-    : SessionData(sessionData), PPRec(ppRec), PP(pp) {
-    SessionData.copyTo(ParsedRegions);
+                    Preprocessor &pp,
+                    const UnitIndexInfo *unitInfo)
+    : SessionData(sessionData), PPRec(ppRec), PP(pp), UnitInfo(unitInfo) {
+    Unit = SessionData.beginUnit(UnitInfo);
   }
 
   bool isParsed(SourceLocation Loc, FileID FID, const FileEntry *FE) {
@@ -193,14 +280,33 @@ public:
       return LastIsParsed;
 
     LastRegion = region;
-    LastIsParsed = ParsedRegions.count(region);
+    llvm::DenseMap<PPRegion, bool>::iterator
+      Known = KnownRegions.find(region);
+    if (Known != KnownRegions.end()) {
+      LastIsParsed = Known->second;
+      return LastIsParsed;
+    }
+
+    LastIsParsed = SessionData.claim(region, Unit);
+    KnownRegions[region] = LastIsParsed;
     if (!LastIsParsed)
       NewParsedRegions.push_back(region);
     return LastIsParsed;
   }
 
   void finished() {
-    SessionData.update(NewParsedRegions);
+    if (!UnitInfo)
+      return;
+    // The occurrences in these bodies are only recorded in this unit, so it
+    // records the regions as well, for the units that skip them.
+    for (unsigned I = 0, N = NewParsedRegions.size(); I != N; ++I) {
+      const PPRegion &Region = NewParsedRegions[I];
+      UnitRegion Parsed = { Region.getUniqueID().getDevice(),
+                            Region.getUniqueID().getFile(),
+                            uint64_t(Region.getModTime()),
+                            Region.getOffset() };
+      UnitInfo->Builder.addRegion(Parsed);
+    }
   }
 
 private:
@@ -411,15 +517,17 @@ class IndexingFrontendAction : public ASTFrontendAction {
 
   SessionSkipBodyData *SKData;
   OwningPtr<TUSkipBodyControl> SKCtrl;
+  const UnitIndexInfo *UnitInfo;
 
 public:
   IndexingFrontendAction(CXClientData clientData,
                          IndexerCallbacks &indexCallbacks,
                          unsigned indexOptions,
                          CXTranslationUnit cxTU,
-                         SessionSkipBodyData *skData)
+                         SessionSkipBodyData *skData,
+                         const UnitIndexInfo *unitInfo)
     : IndexCtx(clientData, indexCallbacks, indexOptions, cxTU),
-      CXTU(cxTU), SKData(skData) { }
+      CXTU(cxTU), SKData(skData), UnitInfo(unitInfo) { }
 
   virtual ASTConsumer *CreateASTConsumer(CompilerInstance &CI,
                                          StringRef InFile) {
@@ -439,7 +547,7 @@ public:
       PPConditionalDirectiveRecord *
         PPRec = new PPConditionalDirectiveRecord(PP.getSourceManager());
       PP.addPPCallbacks(PPRec);
-      SKCtrl.reset(new TUSkipBodyControl(*SKData, *PPRec, PP));
+      SKCtrl.reset(new TUSkipBodyControl(*SKData, *PPRec, PP, UnitInfo));
     }
 
     return new IndexingConsumer(IndexCtx, SKCtrl.get());
@@ -465,6 +573,9 @@ public:
 struct IndexSessionData {
   CXIndex CIdx;
   OwningPtr<SessionSkipBodyData> SkipBodyData;
+  /// \brief The absolute path of the directory to write unit indexes to, or
+  /// empty if none are written.
+  std::string UnitIndexDir;
 
   explicit IndexSessionData(CXIndex cIdx)
     : CIdx(cIdx), SkipBodyData(new SessionSkipBodyData) {}
@@ -624,10 +735,36 @@ static void clang_indexSourceFile_Impl(void *UserData) {
   if (SkipBodies)
     CInvok->getFrontendOpts().SkipFunctionBodies = true;
 
+  // When writing a unit index, the recorder stands between the indexer and
+  // the client's callbacks.
+  OwningPtr<UnitIndexRecorder> Recorder;
+  std::string UnitPath;
+  IndexerCallbacks RecorderCB;
+  if (!IdxSession->UnitIndexDir.empty()) {
+    StringRef WorkingDir = CInvok->getFileSystemOpts().WorkingDir;
+    SmallString<128> MainFile(CInvok->getFrontendOpts().Inputs[0].getFile());
+    makeAbsolutePath(MainFile, WorkingDir);
+    UnitPath = getUnitIndexPath(IdxSession->UnitIndexDir, MainFile);
+    Recorder.reset(new UnitIndexRecorder(client_data, CB, WorkingDir));
+    RecorderCB = Recorder->getCallbacks();
+  }
+
+  // Recover resources if we crash before exiting this method.
+  llvm::CrashRecoveryContextCleanupRegistrar<UnitIndexRecorder>
+    RecorderCleanup(Recorder.get());
+
+  OwningPtr<UnitIndexInfo> UnitInfo;
+  if (Recorder)
+    UnitInfo.reset(new UnitIndexInfo(IdxSession->UnitIndexDir, UnitPath,
+                                     Recorder->getBuilder()));
+
   OwningPtr<IndexingFrontendAction> IndexAction;
-  IndexAction.reset(new IndexingFrontendAction(client_data, CB,
-                                               index_options, CXTU->getTU(),
-                              SkipBodies ? IdxSession->SkipBodyData.get() : 0));
+  IndexAction.reset(new IndexingFrontendAction(
+                              Recorder ? Recorder.get() : client_data,
+                              Recorder ? RecorderCB : CB,
+                              index_options, CXTU->getTU(),
+                              SkipBodies ? IdxSession->SkipBodyData.get() : 0,
+                              UnitInfo.get()));
 
   // Recover resources if we crash before exiting this method.
   llvm::CrashRecoveryContextCleanupRegistrar<IndexingFrontendAction>
@@ -673,6 +810,15 @@ static void clang_indexSourceFile_Impl(void *UserData) {
   if (!Success)
     return;
 
+  if (Recorder) {
+    std::string ErrorMsg;
+    if (!Recorder->getBuilder().write(UnitPath, ErrorMsg)) {
+      LOG_FUNC_SECTION {
+        *Log << UnitPath << ": " << ErrorMsg;
+      }
+    }
+  }
+
   if (out_TU)
     *out_TU = CXTU->takeTU();
 
@@ -809,6 +955,49 @@ static void clang_indexTranslationUnit_Impl(void *UserData) {
   ITUI->result = 0;
 }
 
+//===----------------------------------------------------------------------===//
+// clang_indexSourceFiles Implementation
+//===----------------------------------------------------------------------===//
+
+namespace {
+
+struct IndexSourceFilesInfo {
+  CXIndexAction idxAction;
+  CXClientData client_data;
+  IndexerCallbacks *index_callbacks;
+  unsigned index_callbacks_size;
+  unsigned index_options;
+  const CXIndexSourceFileCommand *commands;
+  unsigned TU_options;
+  /// \brief The result of indexing each command.
+  std::vector<int> results;
+};
+
+} // anonymous namespace
+
+static void indexSourceFileCommand(void *UserData, unsigned Index) {
+  IndexSourceFilesInfo *Info = static_cast<IndexSourceFilesInfo *>(UserData);
+  const CXIndexSourceFileCommand &Cmd = Info->commands[Index];
+
+  // The threads share the current directory, so the working directory is
+  // passed to the frontend instead.
+  SmallVector<const char *, 32> Args;
+  if (Cmd.working_directory) {
+    Args.push_back("-working-directory");
+    Args.push_back(Cmd.working_directory);
+  }
+  Args.append(Cmd.command_line_args,
+              Cmd.command_line_args + Cmd.num_command_line_args);
+
+  Info->results[Index] =
+    clang_indexSourceFile(Info->idxAction, Info->client_data,
+                          Info->index_callbacks, Info->index_callbacks_size,
+                          Info->index_options, Cmd.source_filename,
+                          Args.data(), Args.size(),
+                          /*unsaved_files=*/0, /*num_unsaved_files=*/0,
+                          /*out_TU=*/0, Info->TU_options);
+}
+
 //===----------------------------------------------------------------------===//
 // libclang public APIs.
 //===----------------------------------------------------------------------===//
@@ -956,6 +1145,19 @@ void clang_IndexAction_dispose(CXIndexAction idxAction) {
     delete static_cast<IndexSessionData *>(idxAction);
 }
 
+int clang_IndexAction_setUnitIndexDirectory(CXIndexAction idxAction,
+                                            const char *path) {
+  if (!idxAction || !path)
+    return 1;
+  SmallString<128> Dir(path);
+  bool Existed;
+  if (llvm::sys::fs::make_absolute(Dir) ||
+      llvm::sys::fs::create_directories(Dir.str(), Existed))
+    return 1;
+  static_cast<IndexSessionData *>(idxAction)->UnitIndexDir = Dir.str();
+  return 0;
+}
+
 int clang_indexSourceFile(CXIndexAction idxAction,
                           CXClientData client_data,
                           IndexerCallbacks *index_callbacks,
@@ -1017,6 +1219,30 @@ int clang_indexSourceFile(CXIndexAction idxAction,
   return ITUI.result;
 }
 
+unsigned clang_indexSourceFiles(CXIndexAction idxAction,
+                                CXClientData client_data,
+                                IndexerCallbacks *index_callbacks,
+                                unsigned index_callbacks_size,
+                                unsigned index_options,
+                                const CXIndexSourceFileCommand *commands,
+                                unsigned num_commands,
+                                unsigned num_threads,
+                                unsigned TU_options) {
+  if (!commands)
+    return num_commands;
+
+  IndexSourceFilesInfo Info = { idxAction, client_data, index_callbacks,
+                                index_callbacks_size, index_options, commands,
+                                TU_options, std::vector<int>(num_commands) };
+  runTasksInParallel(num_commands, num_threads, indexSourceFileCommand, &Info);
+
+  unsigned NumFailed = 0;
+  for (unsigned I = 0; I != num_commands; ++I)
+    if (Info.results[I])
+      ++NumFailed;
+  return NumFailed;
+}
+
 int clang_indexTranslationUnit(CXIndexAction idxAction,
                                CXClientData client_data,
                                IndexerCallbacks *index_callbacks,
@@ -1106,15 +1106,9 @@ void IndexingContext::getEntityInfo(const NamedDecl *D,
     EntityInfo.name = SA.copyCStr(StrBuf.str());
   }
 
-  {
-    SmallString<512> StrBuf;
-    bool Ignore = getDeclCursorUSR(D, StrBuf);
-    if (Ignore) {
-      EntityInfo.USR = 0;
-    } else {
-      EntityInfo.USR = SA.copyCStr(StrBuf.str());
-    }
-  }
+  EntityInfo.USR = getCachedDeclCursorUSR(D, USRs);
+  if (EntityInfo.USR && !shouldInternUSRs())
+    EntityInfo.USR = SA.copyCStr(EntityInfo.USR);
 }
 
 void IndexingContext::getContainerInfo(const DeclContext *DC,
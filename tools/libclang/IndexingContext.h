@@ -297,6 +297,8 @@ class IndexingContext {
   llvm::DenseSet<RefFileOccurence> RefFileOccurences;
 
   std::deque<DeclGroupRef> TUDeclsInObjCContainer;
+
+  cxcursor::USRCache USRs;
   
   llvm::BumpPtrAllocator StrScratch;
   unsigned StrAdapterCount;
@@ -361,6 +363,10 @@ public:
     return IndexOptions & CXIndexOpt_IndexImplicitTemplateInstantiations;
   }
 
+  bool shouldInternUSRs() const {
+    return IndexOptions & CXIndexOpt_InternUSRs;
+  }
+
   static bool isFunctionLocalDecl(const Decl *D);
 
   bool shouldAbort();
@@ -0,0 +1,715 @@
+//===- UnitIndex.cpp - Persistent per-translation-unit indexes ------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// A unit index is laid out as follows, with all integers little-endian:
+//
+//   "CXUI", version
+//   on-disk hash table from USRs to occurrences (file, line, column, role)
+//   files:     count, then length and bytes of each path
+//   includes:  count, then includer, included and line of each edge
+//   regions:   count, then device, file, modification time and offset
+//   offsets of the table, files, includes and regions, "CXUI"
+//
+//===----------------------------------------------------------------------===//
+
+#include "UnitIndex.h"
+#include "CLog.h"
+#include "clang/Basic/FileManager.h"
+#include "clang/Basic/OnDiskHashTable.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <cstring>
+
+using namespace clang;
+using namespace cxindex;
+
+static const char UnitIndexMagic[4] = { 'C', 'X', 'U', 'I' };
+static const unsigned UnitIndexVersion = 1;
+
+/// \brief The size of an occurrence, inclusion and region on disk.
+enum {
+  OccurrenceSize = 4 + 4 + 4 + 1,
+  InclusionSize = 4 + 4 + 4,
+  RegionSize = 8 + 8 + 8 + 4,
+  TrailerSize = 4 * 4 + sizeof(UnitIndexMagic)
+};
+
+namespace {
+/// \brief The occurrences of one USR, sorted and with their file indexes
+/// already renumbered.
+typedef std::vector<UnitOccurrence> OccurrenceList;
+
+class UnitIndexWriterTrait {
+public:
+  typedef StringRef key_type;
+  typedef StringRef key_type_ref;
+  typedef const OccurrenceList *data_type;
+  typedef const OccurrenceList *data_type_ref;
+
+  static unsigned ComputeHash(StringRef Key) {
+    return llvm::HashString(Key);
+  }
+
+  static std::pair<unsigned, unsigned>
+  EmitKeyDataLength(raw_ostream &Out, StringRef Key, data_type_ref Data) {
+    unsigned KeyLen = Key.size() + 1;
+    unsigned DataLen = Data->size() * OccurrenceSize;
+    io::Emit16(Out, KeyLen);
+    io::Emit32(Out, DataLen);
+    return std::make_pair(KeyLen, DataLen);
+  }
+
+  static void EmitKey(raw_ostream &Out, StringRef Key, unsigned) {
+    Out.write(Key.data(), Key.size());
+    io::Emit8(Out, 0);
+  }
+
+  static void EmitData(raw_ostream &Out, StringRef, data_type_ref Data,
+                       unsigned) {
+    for (OccurrenceList::const_iterator I = Data->begin(), E = Data->end();
+         I != E; ++I) {
+      io::Emit32(Out, I->File);
+      io::Emit32(Out, I->Line);
+      io::Emit32(Out, I->Column);
+      io::Emit8(Out, I->Role);
+    }
+  }
+};
+
+class UnitIndexReaderTrait {
+public:
+  typedef const char *external_key_type;
+  typedef const char *internal_key_type;
+  /// \brief The occurrences on disk and their number.
+  typedef std::pair<const unsigned char *, unsigned> data_type;
+
+  static unsigned ComputeHash(const char *Key) {
+    return llvm::HashString(Key);
+  }
+
+  static internal_key_type GetInternalKey(external_key_type Key) {
+    return Key;
+  }
+
+  static external_key_type GetExternalKey(internal_key_type Key) {
+    return Key;
+  }
+
+  static bool EqualKey(internal_key_type A, internal_key_type B) {
+    return strcmp(A, B) == 0;
+  }
+
+  static std::pair<unsigned, unsigned>
+  ReadKeyDataLength(const unsigned char *&D) {
+    unsigned KeyLen = io::ReadUnalignedLE16(D);
+    unsigned DataLen = io::ReadUnalignedLE32(D);
+    return std::make_pair(KeyLen, DataLen);
+  }
+
+  static internal_key_type ReadKey(const unsigned char *D, unsigned) {
+    return reinterpret_cast<const char *>(D);
+  }
+
+  static data_type ReadData(internal_key_type, const unsigned char *D,
+                            unsigned DataLen) {
+    return std::make_pair(D, DataLen / OccurrenceSize);
+  }
+};
+
+typedef OnDiskChainedHashTable<UnitIndexReaderTrait> UnitIndexTable;
+
+/// \brief Orders occurrences by file, line and column.
+struct OccurrenceLess {
+  bool operator()(const UnitOccurrence &A, const UnitOccurrence &B) const {
+    if (A.File != B.File)
+      return A.File < B.File;
+    if (A.Line != B.Line)
+      return A.Line < B.Line;
+    if (A.Column != B.Column)
+      return A.Column < B.Column;
+    return A.Role < B.Role;
+  }
+};
+
+struct InclusionLess {
+  bool operator()(const UnitInclusion &A, const UnitInclusion &B) const {
+    if (A.Includer != B.Includer)
+      return A.Includer < B.Includer;
+    if (A.Line != B.Line)
+      return A.Line < B.Line;
+    return A.Included < B.Included;
+  }
+};
+
+struct RegionLess {
+  bool operator()(const UnitRegion &A, const UnitRegion &B) const {
+    if (A.Device != B.Device)
+      return A.Device < B.Device;
+    if (A.File != B.File)
+      return A.File < B.File;
+    if (A.ModTime != B.ModTime)
+      return A.ModTime < B.ModTime;
+    return A.Offset < B.Offset;
+  }
+};
+}
+
+namespace clang {
+namespace cxindex {
+static bool operator==(const UnitOccurrence &A, const UnitOccurrence &B) {
+  return A.File == B.File && A.Line == B.Line && A.Column == B.Column &&
+         A.Role == B.Role;
+}
+
+static bool operator==(const UnitInclusion &A, const UnitInclusion &B) {
+  return A.Includer == B.Includer && A.Included == B.Included &&
+         A.Line == B.Line;
+}
+
+static bool operator==(const UnitRegion &A, const UnitRegion &B) {
+  return A.Device == B.Device && A.File == B.File && A.ModTime == B.ModTime &&
+         A.Offset == B.Offset;
+}
+} // end namespace cxindex
+} // end namespace clang
+
+template <typename T, typename Less>
+static void sortAndUnique(std::vector<T> &V, Less L) {
+  std::sort(V.begin(), V.end(), L);
+  V.erase(std::unique(V.begin(), V.end()), V.end());
+}
+
+//===----------------------------------------------------------------------===//
+// UnitIndexBuilder
+//===----------------------------------------------------------------------===//
+
+unsigned UnitIndexBuilder::getFileID(StringRef Path) {
+  llvm::StringMapEntry<unsigned> &Entry =
+      FileIDs.GetOrCreateValue(Path, Files.size());
+  if (Entry.getValue() == Files.size())
+    Files.push_back(Path);
+  return Entry.getValue();
+}
+
+namespace {
+struct FileIndexLess {
+  const std::vector<std::string> &Files;
+  explicit FileIndexLess(const std::vector<std::string> &Files)
+    : Files(Files) {}
+  bool operator()(unsigned A, unsigned B) const {
+    return Files[A] < Files[B];
+  }
+};
+}
+
+bool UnitIndexBuilder::write(StringRef Path, std::string &ErrorMsg) {
+  // Number the files in path order, so that the index does not depend on the
+  // order in which they were seen and occurrences sort in file order.
+  std::vector<unsigned> Order(Files.size());
+  for (unsigned I = 0, N = Files.size(); I != N; ++I)
+    Order[I] = I;
+  std::sort(Order.begin(), Order.end(), FileIndexLess(Files));
+  std::vector<unsigned> NewID(Files.size());
+  for (unsigned I = 0, N = Order.size(); I != N; ++I)
+    NewID[Order[I]] = I;
+
+  // The generator never destroys its items, so it is given pointers to lists
+  // that live here.
+  std::vector<std::pair<StringRef, OccurrenceList> > Entries;
+  Entries.reserve(Occurrences.size());
+  for (llvm::StringMap<OccurrenceList>::iterator I = Occurrences.begin(),
+                                                 E = Occurrences.end();
+       I != E; ++I) {
+    Entries.push_back(std::make_pair(I->getKey(), I->getValue()));
+    OccurrenceList &List = Entries.back().second;
+    for (unsigned J = 0, N = List.size(); J != N; ++J)
+      List[J].File = NewID[List[J].File];
+    sortAndUnique(List, OccurrenceLess());
+  }
+  OnDiskChainedHashTableGenerator<UnitIndexWriterTrait> Generator;
+  for (unsigned I = 0, N = Entries.size(); I != N; ++I)
+    Generator.insert(Entries[I].first, &Entries[I].second);
+
+  std::vector<UnitInclusion> SortedInclusions(Inclusions);
+  for (unsigned I = 0, N = SortedInclusions.size(); I != N; ++I) {
+    SortedInclusions[I].Includer = NewID[SortedInclusions[I].Includer];
+    SortedInclusions[I].Included = NewID[SortedInclusions[I].Included];
+  }
+  sortAndUnique(SortedInclusions, InclusionLess());
+
+  std::vector<UnitRegion> SortedRegions(Regions);
+  sortAndUnique(SortedRegions, RegionLess());
+
+  // Write a temporary file next to the index and move it into place, so that
+  // concurrent readers always see a complete index.
+  SmallString<128> TempPath;
+  int FD;
+  if (llvm::error_code EC =
+          llvm::sys::fs::createUniqueFile(Path + "-%%%%%%%%", FD, TempPath)) {
+    ErrorMsg = EC.message();
+    return false;
+  }
+  {
+    llvm::raw_fd_ostream Out(FD, /*shouldClose=*/true);
+    Out.write(UnitIndexMagic, sizeof(UnitIndexMagic));
+    io::Emit32(Out, UnitIndexVersion);
+    io::Offset TableOffset = Generator.Emit(Out);
+
+    io::Offset FilesOffset = Out.tell();
+    io::Emit32(Out, Order.size());
+    for (unsigned I = 0, N = Order.size(); I != N; ++I) {
+      const std::string &File = Files[Order[I]];
+      io::Emit32(Out, File.size());
+      Out.write(File.data(), File.size());
+    }
+
+    io::Offset InclusionsOffset = Out.tell();
+    io::Emit32(Out, SortedInclusions.size());
+    for (unsigned I = 0, N = SortedInclusions.size(); I != N; ++I) {
+      io::Emit32(Out, SortedInclusions[I].Includer);
+      io::Emit32(Out, SortedInclusions[I].Included);
+      io::Emit32(Out, SortedInclusions[I].Line);
+    }
+
+    io::Offset RegionsOffset = Out.tell();
+    io::Emit32(Out, SortedRegions.size());
+    for (unsigned I = 0, N = SortedRegions.size(); I != N; ++I) {
+      io::Emit64(Out, SortedRegions[I].Device);
+      io::Emit64(Out, SortedRegions[I].File);
+      io::Emit64(Out, SortedRegions[I].ModTime);
+      io::Emit32(Out, SortedRegions[I].Offset);
+    }
+
+    io::Emit32(Out, TableOffset);
+    io::Emit32(Out, FilesOffset);
+    io::Emit32(Out, InclusionsOffset);
+    io::Emit32(Out, RegionsOffset);
+    Out.write(UnitIndexMagic, sizeof(UnitIndexMagic));
+    Out.close();
+    if (Out.has_error()) {
+      Out.clear_error();
+      ErrorMsg = "could not write '" + TempPath.str().str() + "'";
+      bool Existed;
+      llvm::sys::fs::remove(TempPath.str(), Existed);
+      return false;
+    }
+  }
+  if (llvm::error_code EC = llvm::sys::fs::rename(TempPath.str(), Path)) {
+    ErrorMsg = EC.message();
+    bool Existed;
+    llvm::sys::fs::remove(TempPath.str(), Existed);
+    return false;
+  }
+  return true;
+}
+
+//===----------------------------------------------------------------------===//
+// UnitIndexReader
+//===----------------------------------------------------------------------===//
+
+UnitIndexReader::~UnitIndexReader() {
+  delete static_cast<UnitIndexTable *>(Table);
+}
+
+UnitIndexReader *UnitIndexReader::load(StringRef Path) {
+  OwningPtr<UnitIndexReader> Reader(new UnitIndexReader());
+  if (llvm::MemoryBuffer::getFile(Path, Reader->Buffer, -1,
+                                  /*RequiresNullTerminator=*/false) ||
+      !Reader->init())
+    return 0;
+  return Reader.take();
+}
+
+bool UnitIndexReader::init() {
+  const unsigned char *Start =
+      reinterpret_cast<const unsigned char *>(Buffer->getBufferStart());
+  uint64_t Size = Buffer->getBufferSize();
+  if (Size < sizeof(UnitIndexMagic) + 4 + TrailerSize ||
+      memcmp(Start, UnitIndexMagic, sizeof(UnitIndexMagic)) ||
+      memcmp(Start + Size - sizeof(UnitIndexMagic), UnitIndexMagic,
+             sizeof(UnitIndexMagic)))
+    return false;
+  const unsigned char *D = Start + sizeof(UnitIndexMagic);
+  if (io::ReadUnalignedLE32(D) != UnitIndexVersion)
+    return false;
+
+  uint64_t End = Size - TrailerSize;
+  D = Start + End;
+  uint64_t TableOffset = io::ReadUnalignedLE32(D);
+  uint64_t FilesOffset = io::ReadUnalignedLE32(D);
+  uint64_t InclusionsOffset = io::ReadUnalignedLE32(D);
+  uint64_t RegionsOffset = io::ReadUnalignedLE32(D);
+  if (TableOffset % 4 != 0 || TableOffset + 8 > FilesOffset ||
+      FilesOffset + 4 > InclusionsOffset ||
+      InclusionsOffset + 4 > RegionsOffset || RegionsOffset + 4 > End)
+    return false;
+
+  D = Start + TableOffset;
+  uint64_t NumBuckets = io::ReadUnalignedLE32(D);
+  if (TableOffset + 8 + NumBuckets * 4 != FilesOffset)
+    return false;
+
+  D = Start + FilesOffset;
+  uint64_t NumFiles = io::ReadUnalignedLE32(D);
+  const unsigned char *FilesEnd = Start + InclusionsOffset;
+  for (uint64_t I = 0; I != NumFiles; ++I) {
+    if (FilesEnd - D < 4)
+      return false;
+    uint64_t Len = io::ReadUnalignedLE32(D);
+    if (uint64_t(FilesEnd - D) < Len)
+      return false;
+    Files.push_back(StringRef(reinterpret_cast<const char *>(D), Len));
+    D += Len;
+  }
+
+  D = Start + InclusionsOffset;
+  uint64_t NumInclusions = io::ReadUnalignedLE32(D);
+  if (InclusionsOffset + 4 + NumInclusions * InclusionSize != RegionsOffset)
+    return false;
+  InclusionsData = D;
+
+  D = Start + RegionsOffset;
+  uint64_t NumRegions = io::ReadUnalignedLE32(D);
+  if (RegionsOffset + 4 + NumRegions * RegionSize != End)
+    return false;
+  RegionsData = D;
+
+  FilesData = Start + FilesOffset;
+  Table = UnitIndexTable::Create(Start + TableOffset, Start);
+  return true;
+}
+
+/// \brief Read the occurrences in \p Data, dropping any that name a file that
+/// is not in the index.
+static void readOccurrences(UnitIndexReaderTrait::data_type Data,
+                            unsigned NumFiles,
+                            SmallVectorImpl<UnitOccurrence> &Result) {
+  const unsigned char *D = Data.first;
+  for (unsigned I = 0; I != Data.second; ++I) {
+    UnitOccurrence O;
+    O.File = io::ReadUnalignedLE32(D);
+    O.Line = io::ReadUnalignedLE32(D);
+    O.Column = io::ReadUnalignedLE32(D);
+    O.Role = CXUnitIndexRole(*D++);
+    if (O.File < NumFiles)
+      Result.push_back(O);
+  }
+}
+
+void UnitIndexReader::findOccurrences(
+    const char *USR, SmallVectorImpl<UnitOccurrence> &Result) const {
+  UnitIndexTable *T = static_cast<UnitIndexTable *>(Table);
+  UnitIndexTable::iterator I = T->find(USR);
+  if (I != T->end())
+    readOccurrences(*I, Files.size(), Result);
+}
+
+void UnitIndexReader::getInclusions(
+    SmallVectorImpl<UnitInclusion> &Result) const {
+  const unsigned char *D = InclusionsData - 4;
+  unsigned NumInclusions = io::ReadUnalignedLE32(D);
+  for (unsigned I = 0; I != NumInclusions; ++I) {
+    UnitInclusion Inc;
+    Inc.Includer = io::ReadUnalignedLE32(D);
+    Inc.Included = io::ReadUnalignedLE32(D);
+    Inc.Line = io::ReadUnalignedLE32(D);
+    if (Inc.Includer < Files.size() && Inc.Included < Files.size())
+      Result.push_back(Inc);
+  }
+}
+
+void UnitIndexReader::getRegions(SmallVectorImpl<UnitRegion> &Result) const {
+  const unsigned char *D = RegionsData - 4;
+  unsigned NumRegions = io::ReadUnalignedLE32(D);
+  for (unsigned I = 0; I != NumRegions; ++I) {
+    UnitRegion R;
+    R.Device = io::ReadUnalignedLE64(D);
+    R.File = io::ReadUnalignedLE64(D);
+    R.ModTime = io::ReadUnalignedLE64(D);
+    R.Offset = io::ReadUnalignedLE32(D);
+    Result.push_back(R);
+  }
+}
+
+void UnitIndexReader::addTo(UnitIndexBuilder &Builder) const {
+  SmallVector<unsigned, 32> FileIDs;
+  for (unsigned I = 0, N = Files.size(); I != N; ++I)
+    FileIDs.push_back(Builder.getFileID(Files[I]));
+
+  UnitIndexTable *T = static_cast<UnitIndexTable *>(Table);
+  UnitIndexTable::key_iterator KI = T->key_begin(), KE = T->key_end();
+  UnitIndexTable::data_iterator DI = T->data_begin();
+  SmallVector<UnitOccurrence, 16> Occurrences;
+  for (; KI != KE; ++KI, ++DI) {
+    Occurrences.clear();
+    readOccurrences(*DI, Files.size(), Occurrences);
+    for (unsigned I = 0, N = Occurrences.size(); I != N; ++I) {
+      Occurrences[I].File = FileIDs[Occurrences[I].File];
+      Builder.addOccurrence(*KI, Occurrences[I]);
+    }
+  }
+
+  SmallVector<UnitInclusion, 32> Inclusions;
+  getInclusions(Inclusions);
+  for (unsigned I = 0, N = Inclusions.size(); I != N; ++I) {
+    Inclusions[I].Includer = FileIDs[Inclusions[I].Includer];
+    Inclusions[I].Included = FileIDs[Inclusions[I].Included];
+    Builder.addInclusion(Inclusions[I]);
+  }
+
+  SmallVector<UnitRegion, 32> Regions;
+  getRegions(Regions);
+  for (unsigned I = 0, N = Regions.size(); I != N; ++I)
+    Builder.addRegion(Regions[I]);
+}
+
+std::string cxindex::getUnitIndexPath(StringRef Dir, StringRef MainFile) {
+  // Main files with the same name in different directories get different
+  // units, through the hash of the full path.
+  SmallString<128> Path(Dir);
+  llvm::sys::path::append(Path, llvm::sys::path::filename(MainFile) + "-" +
+                                llvm::utohexstr(llvm::HashString(MainFile)) +
+                                ".cxunit");
+  return Path.str();
+}
+
+bool cxindex::isUnitIndexPath(StringRef Path) {
+  return llvm::sys::path::extension(Path) == ".cxunit";
+}
+
+void cxindex::makeAbsolutePath(SmallVectorImpl<char> &Path,
+                               StringRef WorkingDir) {
+  StringRef Relative(Path.data(), Path.size());
+  if (!WorkingDir.empty() && !llvm::sys::path::is_absolute(Relative)) {
+    SmallString<128> Joined(WorkingDir);
+    llvm::sys::path::append(Joined, Relative);
+    Path.assign(Joined.begin(), Joined.end());
+  }
+  llvm::sys::fs::make_absolute(Path);
+}
+
+//===----------------------------------------------------------------------===//
+// UnitIndexRecorder
+//===----------------------------------------------------------------------===//
+
+IndexerCallbacks UnitIndexRecorder::getCallbacks() const {
+  IndexerCallbacks CB;
+  memset(&CB, 0, sizeof(CB));
+  if (ClientCallbacks.abortQuery)
+    CB.abortQuery = abortQuery;
+  if (ClientCallbacks.diagnostic)
+    CB.diagnostic = diagnostic;
+  if (ClientCallbacks.enteredMainFile)
+    CB.enteredMainFile = enteredMainFile;
+  if (ClientCallbacks.importedASTFile)
+    CB.importedASTFile = importedASTFile;
+  if (ClientCallbacks.startedTranslationUnit)
+    CB.startedTranslationUnit = startedTranslationUnit;
+  CB.ppIncludedFile = ppIncludedFile;
+  CB.indexDeclaration = indexDeclaration;
+  CB.indexEntityReference = indexEntityReference;
+  return CB;
+}
+
+static UnitIndexRecorder &getRecorder(CXClientData D) {
+  return *static_cast<UnitIndexRecorder *>(D);
+}
+
+unsigned UnitIndexRecorder::getFileID(CXFile File) {
+  llvm::DenseMap<CXFile, unsigned>::iterator Known = FileIDs.find(File);
+  if (Known != FileIDs.end())
+    return Known->second;
+
+  // Record absolute paths, so that the units of main files in different
+  // directories agree on the names of the files they share.
+  SmallString<128> Path(static_cast<const FileEntry *>(File)->getName());
+  makeAbsolutePath(Path, WorkingDir);
+  unsigned ID = Builder.getFileID(Path);
+  FileIDs[File] = ID;
+  return ID;
+}
+
+int UnitIndexRecorder::abortQuery(CXClientData D, void *Reserved) {
+  UnitIndexRecorder &R = getRecorder(D);
+  return R.ClientCallbacks.abortQuery(R.ClientData, Reserved);
+}
+
+void UnitIndexRecorder::diagnostic(CXClientData D, CXDiagnosticSet Diags,
+                                   void *Reserved) {
+  UnitIndexRecorder &R = getRecorder(D);
+  R.ClientCallbacks.diagnostic(R.ClientData, Diags, Reserved);
+}
+
+CXIdxClientFile UnitIndexRecorder::enteredMainFile(CXClientData D,
+                                                   CXFile MainFile,
+                                                   void *Reserved) {
+  UnitIndexRecorder &R = getRecorder(D);
+  return R.ClientCallbacks.enteredMainFile(R.ClientData, MainFile, Reserved);
+}
+
+CXIdxClientFile
+UnitIndexRecorder::ppIncludedFile(CXClientData D,
+                                  const CXIdxIncludedFileInfo *Info) {
+  UnitIndexRecorder &R = getRecorder(D);
+  CXFile Includer;
+  unsigned Line;
+  clang_indexLoc_getFileLocation(Info->hashLoc, 0, &Includer, &Line, 0, 0);
+  if (Includer && Info->file) {
+    UnitInclusion Inc;
+    Inc.Includer = R.getFileID(Includer);
+    Inc.Included = R.getFileID(Info->file);
+    Inc.Line = Line;
+    R.Builder.addInclusion(Inc);
+  }
+  if (!R.ClientCallbacks.ppIncludedFile)
+    return 0;
+  return R.ClientCallbacks.ppIncludedFile(R.ClientData, Info);
+}
+
+CXIdxClientASTFile
+UnitIndexRecorder::importedASTFile(CXClientData D,
+                                   const CXIdxImportedASTFileInfo *Info) {
+  UnitIndexRecorder &R = getRecorder(D);
+  return R.ClientCallbacks.importedASTFile(R.ClientData, Info);
+}
+
+CXIdxClientContainer
+UnitIndexRecorder::startedTranslationUnit(CXClientData D, void *Reserved) {
+  UnitIndexRecorder &R = getRecorder(D);
+  return R.ClientCallbacks.startedTranslationUnit(R.ClientData, Reserved);
+}
+
+void UnitIndexRecorder::indexDeclaration(CXClientData D,
+                                         const CXIdxDeclInfo *Info) {
+  UnitIndexRecorder &R = getRecorder(D);
+  if (Info->entityInfo)
+    R.addOccurrence(Info->entityInfo->USR, Info->loc,
+                    Info->isDefinition ? CXUnitIndexRole_Definition
+                                       : CXUnitIndexRole_Declaration);
+  if (R.ClientCallbacks.indexDeclaration)
+    R.ClientCallbacks.indexDeclaration(R.ClientData, Info);
+}
+
+void UnitIndexRecorder::indexEntityReference(CXClientData D,
+                                             const CXIdxEntityRefInfo *Info) {
+  UnitIndexRecorder &R = getRecorder(D);
+  if (Info->referencedEntity)
+    R.addOccurrence(Info->referencedEntity->USR, Info->loc,
+                    CXUnitIndexRole_Reference);
+  if (R.ClientCallbacks.indexEntityReference)
+    R.ClientCallbacks.indexEntityReference(R.ClientData, Info);
+}
+
+void UnitIndexRecorder::addOccurrence(const char *USR, CXIdxLoc Loc,
+                                      CXUnitIndexRole Role) {
+  // Keys are stored with a 16-bit length.
+  if (!USR || !*USR || strlen(USR) >= 0xFFFF)
+    return;
+  CXFile File;
+  UnitOccurrence O;
+  clang_indexLoc_getFileLocation(Loc, 0, &File, &O.Line, &O.Column, 0);
+  if (!File)
+    return;
+  O.File = getFileID(File);
+  O.Role = Role;
+  Builder.addOccurrence(USR, O);
+}
+
+//===----------------------------------------------------------------------===//
+// libclang public APIs.
+//===----------------------------------------------------------------------===//
+
+extern "C" {
+
+int clang_mergeUnitIndexes(const char *unit_dir, const char *output_path) {
+  if (!unit_dir || !output_path)
+    return 1;
+
+  // Merge the units in path order, so that the project index does not depend
+  // on the order of the directory entries.
+  std::vector<std::string> Units;
+  llvm::error_code EC;
+  for (llvm::sys::fs::directory_iterator Dir(unit_dir, EC), DirEnd;
+       !EC && Dir != DirEnd; Dir.increment(EC))
+    if (isUnitIndexPath(Dir->path()))
+      Units.push_back(Dir->path());
+  if (EC)
+    return 1;
+  std::sort(Units.begin(), Units.end());
+
+  llvm::sys::fs::UniqueID OutputID(0, 0);
+  bool HaveOutputID = !llvm::sys::fs::getUniqueID(output_path, OutputID);
+  UnitIndexBuilder Builder;
+  for (unsigned I = 0, N = Units.size(); I != N; ++I) {
+    // The project index may itself live in the directory.
+    llvm::sys::fs::UniqueID ID(0, 0);
+    if (HaveOutputID && !llvm::sys::fs::getUniqueID(Units[I], ID) &&
+        ID == OutputID)
+      continue;
+    OwningPtr<UnitIndexReader> Reader(UnitIndexReader::load(Units[I]));
+    if (Reader)
+      Reader->addTo(Builder);
+  }
+
+  std::string ErrorMsg;
+  if (!Builder.write(output_path, ErrorMsg)) {
+    LOG_FUNC_SECTION {
+      *Log << output_path << ": " << ErrorMsg;
+    }
+    return 1;
+  }
+  return 0;
+}
+
+int clang_UnitIndex_findOccurrences(const char *index_path, const char *usr,
+                                    CXUnitIndexOccurrenceVisitor visitor,
+                                    CXClientData client_data) {
+  if (!index_path || !usr || !visitor)
+    return 1;
+  OwningPtr<UnitIndexReader> Reader(UnitIndexReader::load(index_path));
+  if (!Reader)
+    return 1;
+
+  SmallVector<UnitOccurrence, 16> Occurrences;
+  Reader->findOccurrences(usr, Occurrences);
+  ArrayRef<StringRef> Files = Reader->getFiles();
+  for (unsigned I = 0, N = Occurrences.size(); I != N; ++I) {
+    std::string File = Files[Occurrences[I].File];
+    visitor(client_data, File.c_str(), Occurrences[I].Line,
+            Occurrences[I].Column, Occurrences[I].Role);
+  }
+  return 0;
+}
+
+int clang_UnitIndex_visitInclusions(const char *index_path,
+                                    CXUnitIndexInclusionVisitor visitor,
+                                    CXClientData client_data) {
+  if (!index_path || !visitor)
+    return 1;
+  OwningPtr<UnitIndexReader> Reader(UnitIndexReader::load(index_path));
+  if (!Reader)
+    return 1;
+
+  SmallVector<UnitInclusion, 32> Inclusions;
+  Reader->getInclusions(Inclusions);
+  ArrayRef<StringRef> Files = Reader->getFiles();
+  for (unsigned I = 0, N = Inclusions.size(); I != N; ++I) {
+    std::string Includer = Files[Inclusions[I].Includer];
+    std::string Included = Files[Inclusions[I].Included];
+    visitor(client_data, Includer.c_str(), Included.c_str(),
+            Inclusions[I].Line);
+  }
+  return 0;
+}
+
+} // end: extern "C"
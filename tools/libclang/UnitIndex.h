@@ -0,0 +1,165 @@
+//===- UnitIndex.h - Persistent per-translation-unit indexes ----*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the classes that write, read and merge the unit indexes
+// produced by clang_indexSourceFile (see
+// clang_IndexAction_setUnitIndexDirectory).
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_LIBCLANG_UNITINDEX_H
+#define LLVM_CLANG_LIBCLANG_UNITINDEX_H
+
+#include "clang-c/Index.h"
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/OwningPtr.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/DataTypes.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include <string>
+#include <vector>
+
+namespace clang {
+namespace cxindex {
+
+/// \brief An occurrence of an entity, identified by the index of its file in
+/// the unit's file table.
+struct UnitOccurrence {
+  unsigned File, Line, Column;
+  CXUnitIndexRole Role;
+};
+
+/// \brief An edge of the include graph: the file \c Includer includes the
+/// file \c Included on line \c Line.
+struct UnitInclusion {
+  unsigned Includer, Included, Line;
+};
+
+/// \brief A region of a header whose function bodies a translation unit
+/// parsed, identified by the file's unique ID and modification time and by
+/// the offset of the conditional directive that starts the region.
+struct UnitRegion {
+  uint64_t Device, File, ModTime;
+  unsigned Offset;
+};
+
+/// \brief Collects the contents of a unit or project index and writes it.
+class UnitIndexBuilder {
+  llvm::StringMap<unsigned> FileIDs;
+  std::vector<std::string> Files;
+  llvm::StringMap<std::vector<UnitOccurrence> > Occurrences;
+  std::vector<UnitInclusion> Inclusions;
+  std::vector<UnitRegion> Regions;
+
+public:
+  /// \brief Returns the index of \p Path in the file table, adding it if
+  /// necessary.
+  unsigned getFileID(StringRef Path);
+
+  void addOccurrence(StringRef USR, const UnitOccurrence &Occurrence) {
+    Occurrences[USR].push_back(Occurrence);
+  }
+  void addInclusion(const UnitInclusion &Inclusion) {
+    Inclusions.push_back(Inclusion);
+  }
+  void addRegion(const UnitRegion &Region) { Regions.push_back(Region); }
+
+  /// \brief Write the index to \p Path, replacing any file there atomically.
+  /// Duplicate occurrences, inclusions and regions are only written once.
+  bool write(StringRef Path, std::string &ErrorMsg);
+};
+
+/// \brief A unit or project index, memory-mapped from disk.
+class UnitIndexReader {
+  OwningPtr<llvm::MemoryBuffer> Buffer;
+  /// \brief The on-disk hash table from USRs to occurrences.
+  void *Table;
+  const unsigned char *FilesData, *InclusionsData, *RegionsData;
+  std::vector<StringRef> Files;
+
+  UnitIndexReader() : Table(0) {}
+  bool init();
+
+public:
+  ~UnitIndexReader();
+
+  /// \brief Load the index at \p Path, returning null if it is not valid.
+  static UnitIndexReader *load(StringRef Path);
+
+  ArrayRef<StringRef> getFiles() const { return Files; }
+
+  /// \brief Append the occurrences of \p USR to \p Result.
+  void findOccurrences(const char *USR,
+                       SmallVectorImpl<UnitOccurrence> &Result) const;
+  void getInclusions(SmallVectorImpl<UnitInclusion> &Result) const;
+  void getRegions(SmallVectorImpl<UnitRegion> &Result) const;
+
+  /// \brief Add the whole contents of the index to \p Builder.
+  void addTo(UnitIndexBuilder &Builder) const;
+};
+
+/// \brief Returns the path of the unit index for the main file \p MainFile in
+/// the unit index directory \p Dir.
+std::string getUnitIndexPath(StringRef Dir, StringRef MainFile);
+
+/// \brief Returns whether \p Path names a unit index written by
+/// clang_indexSourceFile.
+bool isUnitIndexPath(StringRef Path);
+
+/// \brief Make \p Path, which is relative to \p WorkingDir if that is not
+/// empty, absolute.
+void makeAbsolutePath(SmallVectorImpl<char> &Path, StringRef WorkingDir);
+
+/// \brief Records the occurrences and inclusions that the indexer reports to
+/// a client, by standing between the indexer and the client's callbacks.
+class UnitIndexRecorder {
+  CXClientData ClientData;
+  IndexerCallbacks ClientCallbacks;
+  /// \brief The working directory of the translation unit, which the names of
+  /// its files are relative to, or empty for the current directory.
+  std::string WorkingDir;
+  UnitIndexBuilder Builder;
+  /// \brief The index in the builder's file table of each file seen.
+  llvm::DenseMap<CXFile, unsigned> FileIDs;
+
+public:
+  UnitIndexRecorder(CXClientData ClientData,
+                    const IndexerCallbacks &ClientCallbacks,
+                    StringRef WorkingDir)
+    : ClientData(ClientData), ClientCallbacks(ClientCallbacks),
+      WorkingDir(WorkingDir) {}
+
+  /// \brief Returns the callbacks to give the indexer, with this recorder as
+  /// their client data. Only the callbacks that the recorder or the client
+  /// needs are set, since the indexer skips work for the others.
+  IndexerCallbacks getCallbacks() const;
+
+  UnitIndexBuilder &getBuilder() { return Builder; }
+
+private:
+  static int abortQuery(CXClientData, void *);
+  static void diagnostic(CXClientData, CXDiagnosticSet, void *);
+  static CXIdxClientFile enteredMainFile(CXClientData, CXFile, void *);
+  static CXIdxClientFile ppIncludedFile(CXClientData,
+                                        const CXIdxIncludedFileInfo *);
+  static CXIdxClientASTFile importedASTFile(CXClientData,
+                                            const CXIdxImportedASTFileInfo *);
+  static CXIdxClientContainer startedTranslationUnit(CXClientData, void *);
+  static void indexDeclaration(CXClientData, const CXIdxDeclInfo *);
+  static void indexEntityReference(CXClientData, const CXIdxEntityRefInfo *);
+
+  unsigned getFileID(CXFile File);
+  void addOccurrence(const char *USR, CXIdxLoc Loc, CXUnitIndexRole Role);
+};
+
+} // end namespace cxindex
+} // end namespace clang
+
+#endif
@@ -67,5 +67,33 @@ TEST(GetParents, ReturnsMultipleParentsInTemplateInstantiations) {
                 hasAncestor(recordDecl(unless(isTemplateInstantiation())))))));
 }
 
+TEST(GetParents, ReturnsParentsInLaterTopLevelDecls) {
+  MatchVerifier<Stmt> Verifier;
+  EXPECT_TRUE(Verifier.match(
+      "void f() { if (true) {} }"
+      "void g() { while (true) {} }",
+      compoundStmt(hasParent(whileStmt()),
+                   hasAncestor(functionDecl(hasName("g"))))));
+  EXPECT_FALSE(Verifier.match(
+      "void f() { if (true) {} }"
+      "void g() { while (true) {} }",
+      compoundStmt(hasParent(whileStmt()),
+                   hasAncestor(functionDecl(hasName("f"))))));
+}
+
+TEST(GetParents, ReturnsParentsAcrossOutOfLineDefinitions) {
+  MatchVerifier<Stmt> Verifier;
+  EXPECT_TRUE(Verifier.match(
+      "template<typename T> struct C { void f(); };"
+      "template<typename T> void C<T>::f() { if (true) {} }"
+      "void g() { C<int> c; c.f(); }",
+      ifStmt(hasAncestor(recordDecl(isTemplateInstantiation())))));
+  EXPECT_TRUE(Verifier.match(
+      "template<typename T> struct C { void f(); };"
+      "template<typename T> void C<T>::f() { if (true) {} }"
+      "void g() { C<int> c; c.f(); }",
+      ifStmt(hasAncestor(methodDecl(unless(hasParent(recordDecl())))))));
+}
+
 } // end namespace ast_matchers
 } // end namespace clang
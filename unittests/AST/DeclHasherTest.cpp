@@ -0,0 +1,122 @@
+//===- unittests/AST/DeclHasherTest.cpp - DeclHasher tests ----------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Tests for the structural hashes of declarations computed by DeclHasher.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/DeclHasher.h"
+#include "clang/ASTMatchers/ASTMatchFinder.h"
+#include "clang/ASTMatchers/ASTMatchers.h"
+#include "clang/Tooling/Tooling.h"
+#include "gtest/gtest.h"
+
+namespace clang {
+namespace ast_matchers {
+
+using clang::tooling::newFrontendActionFactory;
+using clang::tooling::runToolOnCodeWithArgs;
+using clang::tooling::FrontendActionFactory;
+
+namespace {
+
+/// \brief Records the hash of the declaration bound to "decl" in each match.
+class HashCollector : public MatchFinder::MatchCallback {
+public:
+  std::vector<uint64_t> Hashes;
+
+  virtual void run(const MatchFinder::MatchResult &Result) {
+    const Decl *D = Result.Nodes.getNodeAs<Decl>("decl");
+    Hashes.push_back(DeclHasher(*Result.Context).getHash(D));
+  }
+};
+
+/// \brief Returns the hashes of the declarations matching \p Matcher in \p
+/// Code, in source order.
+std::vector<uint64_t> hashDecls(const std::string &Code,
+                                const DeclarationMatcher &Matcher) {
+  HashCollector Collector;
+  MatchFinder Finder;
+  Finder.addMatcher(Matcher, &Collector);
+  llvm::OwningPtr<FrontendActionFactory> Factory(
+      newFrontendActionFactory(&Finder));
+  std::vector<std::string> Args(1, "-std=c++11");
+  if (!runToolOnCodeWithArgs(Factory->create(), Code, Args))
+    return std::vector<uint64_t>();
+  return Collector.Hashes;
+}
+
+} // end anonymous namespace
+
+TEST(DeclHasher, SameDeclarationInDifferentContexts) {
+  const char *Code =
+      "struct S { int a; char b : 3; };"
+      "int f(S s) { return s.a + sizeof(S); }";
+  DeclarationMatcher Matcher =
+      decl(anyOf(recordDecl(hasName("S"), isDefinition()),
+                 functionDecl(hasName("f")))).bind("decl");
+  std::vector<uint64_t> First = hashDecls(Code, Matcher);
+  std::vector<uint64_t> Second =
+      hashDecls(std::string("typedef int Unrelated;\n") + Code, Matcher);
+  ASSERT_EQ(2u, First.size());
+  EXPECT_EQ(First, Second);
+}
+
+TEST(DeclHasher, IgnoresEnclosingNamespace) {
+  std::vector<uint64_t> Hashes = hashDecls(
+      "namespace a { int f(int x) { return x * 2; } }"
+      "namespace b { int f(int x) { return x * 2; } }",
+      functionDecl(hasName("f")).bind("decl"));
+  ASSERT_EQ(2u, Hashes.size());
+  EXPECT_EQ(Hashes[0], Hashes[1]);
+}
+
+TEST(DeclHasher, DistinguishesBodies) {
+  std::vector<uint64_t> Hashes = hashDecls(
+      "namespace a { int f(int x) { return x * 2; } }"
+      "namespace b { int f(int x) { return x * 3; } }"
+      "namespace c { int f(int x) { return x + 2; } }"
+      "namespace d { int g(int x); int f(int x) { return g(x); } }"
+      "namespace e { int g(int x); int f(int x) { return e::g(x); } }",
+      functionDecl(hasName("f")).bind("decl"));
+  ASSERT_EQ(5u, Hashes.size());
+  EXPECT_NE(Hashes[0], Hashes[1]);
+  EXPECT_NE(Hashes[0], Hashes[2]);
+  EXPECT_NE(Hashes[1], Hashes[2]);
+  // The functions call different functions called g.
+  EXPECT_NE(Hashes[3], Hashes[4]);
+}
+
+TEST(DeclHasher, DistinguishesMembers) {
+  std::vector<uint64_t> Hashes = hashDecls(
+      "namespace a { struct S { int x; }; }"
+      "namespace b { struct S { long x; }; }"
+      "namespace c { struct S { int y; }; }"
+      "namespace d { struct S { int x; void f(); }; }"
+      "namespace e { struct S : a::S { int x; }; }",
+      recordDecl(hasName("S"), isDefinition()).bind("decl"));
+  ASSERT_EQ(5u, Hashes.size());
+  for (unsigned I = 0; I != Hashes.size(); ++I)
+    for (unsigned J = I + 1; J != Hashes.size(); ++J)
+      EXPECT_NE(Hashes[I], Hashes[J]) << I << " " << J;
+}
+
+TEST(DeclHasher, DistinguishesSpecializations) {
+  std::vector<uint64_t> Hashes = hashDecls(
+      "template<int N> struct A { int x[N]; };"
+      "template<> struct A<1> { int x; };"
+      "template<> struct A<2> { int x; };",
+      classTemplateSpecializationDecl(hasName("A")).bind("decl"));
+  ASSERT_EQ(2u, Hashes.size());
+  EXPECT_NE(Hashes[0], Hashes[1]);
+}
+
+} // end namespace ast_matchers
+} // end namespace clang
@@ -12,6 +12,7 @@
 #include "clang/ASTMatchers/ASTMatchFinder.h"
 #include "clang/ASTMatchers/ASTMatchers.h"
 #include "clang/Tooling/Tooling.h"
+#include "llvm/ADT/StringExtras.h"
 #include "gtest/gtest.h"
 
 namespace clang {
@@ -4108,6 +4109,68 @@ TEST(MatchFinder, InterceptsEndOfTranslationUnit) {
   EXPECT_TRUE(VerifyCallback.Called);
 }
 
+class CountMatches : public MatchFinder::MatchCallback {
+public:
+  CountMatches() : Count(0) {}
+  virtual void run(const MatchFinder::MatchResult &Result) { ++Count; }
+  unsigned Count;
+};
+
+TEST(MatchFinder, MatchesEachNodeKindWithItsOwnMatchers) {
+  MatchFinder Finder;
+  CountMatches DeclCount, StmtCount, TypeCount;
+  Finder.addMatcher(recordDecl(hasName("X")), &DeclCount);
+  Finder.addMatcher(returnStmt(), &StmtCount);
+  Finder.addMatcher(qualType(asString("class X")), &TypeCount);
+  OwningPtr<FrontendActionFactory> Factory(newFrontendActionFactory(&Finder));
+  ASSERT_TRUE(tooling::runToolOnCode(
+      Factory->create(), "class X {}; X f() { return X(); }"));
+  EXPECT_EQ(1u, DeclCount.Count);
+  EXPECT_EQ(1u, StmtCount.Count);
+  EXPECT_LE(1u, TypeCount.Count);
+}
+
+class RecordNames : public MatchFinder::MatchCallback {
+public:
+  virtual void run(const MatchFinder::MatchResult &Result) {
+    const NamedDecl *Node = Result.Nodes.getNodeAs<NamedDecl>("");
+    Names.push_back(Node->getNameAsString());
+  }
+  std::vector<std::string> Names;
+};
+
+static std::vector<std::string> matchNames(const std::string &Code,
+                                           unsigned NumThreads) {
+  MatchFinder Finder;
+  RecordNames Callback;
+  Finder.addMatcher(functionDecl(hasAncestor(namespaceDecl())).bind(""),
+                    &Callback);
+  Finder.addMatcher(recordDecl(isDefinition(), isDerivedFrom("Alias")).bind(""),
+                    &Callback);
+  Finder.addMatcher(varDecl().bind(""), &Callback);
+  Finder.setNumThreads(NumThreads);
+  OwningPtr<FrontendActionFactory> Factory(newFrontendActionFactory(&Finder));
+  EXPECT_TRUE(tooling::runToolOnCode(Factory->create(), Code));
+  return Callback.Names;
+}
+
+TEST(MatchFinder, MatchesInParallelInTraversalOrder) {
+  std::string Code = "class Base {}; typedef Base Alias;";
+  for (unsigned I = 0; I != 20; ++I) {
+    std::string N = llvm::utostr(I);
+    Code += "namespace n" + N + " { void f" + N + "() { int v" + N + "; } }"
+            "class C" + N + " : public Base {}; int g" + N + ";";
+  }
+  std::vector<std::string> Serial = matchNames(Code, 1);
+  std::vector<std::string> Parallel = matchNames(Code, 4);
+  EXPECT_EQ(80u, Serial.size());
+  EXPECT_EQ("f0", Serial[0]);
+  EXPECT_EQ("v0", Serial[1]);
+  EXPECT_EQ("C0", Serial[2]);
+  EXPECT_EQ("g0", Serial[3]);
+  EXPECT_TRUE(Serial == Parallel);
+}
+
 TEST(EqualsBoundNodeMatcher, QualType) {
   EXPECT_TRUE(matches(
       "int i = 1;", varDecl(hasType(qualType().bind("type")),
@@ -209,6 +209,25 @@ TEST(ParserTest, FullParserTest) {
             Error.toStringFull());
 }
 
+TEST(ParserTest, CachesParsedMatchers) {
+  ParsedMatcherCache Cache;
+  Diagnostics Error;
+  const DynTypedMatcher *First =
+      Cache.getMatcher("functionDecl(hasName(\"f\"))", &Error);
+  EXPECT_EQ("", Error.toStringFull());
+  ASSERT_TRUE(First != NULL);
+  EXPECT_EQ(First, Cache.getMatcher("functionDecl(hasName(\"f\"))", &Error));
+  EXPECT_NE(First, Cache.getMatcher("functionDecl(hasName(\"g\"))", &Error));
+  Matcher<Decl> M = Matcher<Decl>::constructFrom(*First);
+  EXPECT_TRUE(matches("void f();", M));
+  EXPECT_FALSE(matches("void g();", M));
+
+  EXPECT_TRUE(Cache.getMatcher("functionDecl(", &Error) == NULL);
+  Diagnostics SecondError;
+  EXPECT_TRUE(Cache.getMatcher("functionDecl(", &SecondError) == NULL);
+  EXPECT_NE("", SecondError.toStringFull());
+}
+
 std::string ParseWithError(StringRef Code) {
   Diagnostics Error;
   VariantValue Value;
@@ -0,0 +1,99 @@
+//===- unittests/Basic/ByteScanTest.cpp -- Source buffer scanning tests ---===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Basic/ByteScan.h"
+#include "clang/Basic/CharInfo.h"
+#include "gtest/gtest.h"
+#include <string>
+
+using namespace clang;
+
+namespace {
+
+// Long enough that every vector width sees several full chunks plus a tail.
+const unsigned BufferSize = 100;
+
+// Places \p Stop at every offset of a buffer filled with \p Fill, at every
+// starting alignment, and checks that \p Scan stops exactly there.
+template <typename ScanFn>
+void checkStopsAt(ScanFn Scan, char Fill, char Stop) {
+  for (unsigned Start = 0; Start != 32; ++Start) {
+    for (unsigned Pos = Start; Pos != BufferSize; ++Pos) {
+      std::string Buffer(BufferSize, Fill);
+      Buffer[Pos] = Stop;
+      const char *Begin = Buffer.data();
+      const char *End = Begin + Buffer.size();
+      EXPECT_EQ(Begin + Pos, Scan(Begin + Start, End))
+          << "start " << Start << ", stop at " << Pos;
+    }
+  }
+
+  // Without a stop character the scan must run to the end of the range, even
+  // if the byte just past it would stop the scan.
+  std::string Buffer(BufferSize, Fill);
+  Buffer += Stop;
+  for (unsigned Len = 0; Len != BufferSize; ++Len) {
+    const char *Begin = Buffer.data() + (BufferSize - Len);
+    EXPECT_EQ(Begin + Len, Scan(Begin, Begin + Len)) << "length " << Len;
+  }
+}
+
+const char *scanForSlash(const char *Ptr, const char *End) {
+  return scanForByte(Ptr, End, '/');
+}
+
+TEST(ByteScanTest, scanForByte) {
+  checkStopsAt(scanForSlash, '*', '/');
+  checkStopsAt(scanForSlash, '\0', '/');
+}
+
+TEST(ByteScanTest, scanForLineEnd) {
+  checkStopsAt(scanForLineEnd, 'x', '\n');
+  checkStopsAt(scanForLineEnd, 'x', '\r');
+  checkStopsAt(scanForLineEnd, 'x', '\0');
+  checkStopsAt(scanForLineEnd, '\t', '\n');
+}
+
+TEST(ByteScanTest, skipHorizontalWhitespace) {
+  checkStopsAt(skipHorizontalWhitespace, ' ', 'x');
+  checkStopsAt(skipHorizontalWhitespace, '\t', '\n');
+  checkStopsAt(skipHorizontalWhitespace, '\f', '\r');
+  checkStopsAt(skipHorizontalWhitespace, '\v', '\0');
+}
+
+TEST(ByteScanTest, skipIdentifierBody) {
+  checkStopsAt(skipIdentifierBody, 'a', ' ');
+  checkStopsAt(skipIdentifierBody, 'Z', '$');
+  checkStopsAt(skipIdentifierBody, '_', '\\');
+  checkStopsAt(skipIdentifierBody, '9', '\x80');
+}
+
+// Every byte value must be classified exactly as the CharInfo predicates
+// classify it.
+TEST(ByteScanTest, agreesWithCharInfo) {
+  for (unsigned C = 0; C != 256; ++C) {
+    std::string Buffer(BufferSize, char(C));
+    const char *Begin = Buffer.data();
+    const char *End = Begin + Buffer.size();
+
+    bool IsWhitespace = isHorizontalWhitespace(C);
+    EXPECT_EQ(IsWhitespace ? End : Begin, skipHorizontalWhitespace(Begin, End))
+        << "character " << C;
+
+    bool IsIdentifier = isIdentifierBody(C);
+    EXPECT_EQ(IsIdentifier ? End : Begin, skipIdentifierBody(Begin, End))
+        << "character " << C;
+
+    bool IsLineEnd = C == '\n' || C == '\r' || C == '\0';
+    EXPECT_EQ(IsLineEnd ? Begin : End, scanForLineEnd(Begin, End))
+        << "character " << C;
+  }
+}
+
+} // anonymous namespace
@@ -10,6 +10,11 @@
 #include "clang/Basic/FileManager.h"
 #include "clang/Basic/FileSystemOptions.h"
 #include "clang/Basic/FileSystemStatCache.h"
+#include "clang/Basic/VirtualFileSystem.h"
+#include "llvm/ADT/OwningPtr.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
 #include "gtest/gtest.h"
 
 using namespace llvm;
@@ -231,6 +236,87 @@ TEST_F(FileManagerTest, getFileReturnsSameFileEntryForAliasedVirtualFiles) {
   EXPECT_EQ(manager.getFile("abc/foo.cpp"), manager.getFile("abc/bar.cpp"));
 }
 
+// A PersistentStatCache answers lookups that failed in an earlier process
+// from its cache file, as long as the parent directory is unchanged.
+TEST(PersistentStatCacheTest, remembersMissingFilesAcrossInstances) {
+  SmallString<128> CachePath;
+  int FD;
+  ASSERT_FALSE(llvm::sys::fs::createTemporaryFile("stat-cache", "", FD,
+                                                  CachePath));
+  { llvm::raw_fd_ostream Closer(FD, /*shouldClose=*/true); }
+  // The root directory is unlikely to have been modified recently.
+  const char *Path = "/clang-persistent-stat-cache-test.h";
+  FileData Data;
+
+  {
+    PersistentStatCache Cache(CachePath);
+    Cache.setNextStatCache(new FakeStatCache);
+    EXPECT_TRUE(FileSystemStatCache::get(Path, Data, true, 0, &Cache));
+    EXPECT_EQ(0u, Cache.getNumHits());
+    EXPECT_EQ(1u, Cache.getNumMisses());
+    Cache.flush();
+  }
+
+  // The file now "exists" in the next cache, but the persistent cache still
+  // answers from its entry.
+  PersistentStatCache Cache(CachePath);
+  FakeStatCache *Next = new FakeStatCache;
+  Next->InjectFile(Path, 42);
+  Cache.setNextStatCache(Next);
+  EXPECT_TRUE(FileSystemStatCache::get(Path, Data, true, 0, &Cache));
+  EXPECT_EQ(1u, Cache.getNumHits());
+
+  bool Existed;
+  llvm::sys::fs::remove(CachePath.str(), Existed);
+}
+
 #endif  // !_WIN32
 
+// The files of an in-memory file system, and their directories, are found and
+// read without going to the disk.
+TEST_F(FileManagerTest, getFileFromInMemoryFileSystem) {
+  IntrusiveRefCntPtr<vfs::InMemoryFileSystem> FS =
+    new vfs::InMemoryFileSystem();
+  FS->addFile("/src/dir/foo.h",
+              MemoryBuffer::getMemBufferCopy("int foo;", "/src/dir/foo.h"));
+  manager.setVirtualFileSystem(FS);
+
+  const FileEntry *File = manager.getFile("/src/dir/foo.h");
+  ASSERT_TRUE(File != NULL);
+  EXPECT_EQ(8, File->getSize());
+  EXPECT_STREQ("/src/dir", File->getDir()->getName());
+  EXPECT_TRUE(manager.getDirectory("/src") != NULL);
+  EXPECT_EQ(NULL, manager.getFile("/src/dir"));
+  EXPECT_EQ(NULL, manager.getFile("/src/dir/bar.h"));
+
+  OwningPtr<MemoryBuffer> Buffer(manager.getBufferForFile(File));
+  ASSERT_TRUE(Buffer.get() != NULL);
+  EXPECT_EQ("int foo;", Buffer->getBuffer());
+}
+
+// The last file system pushed on an overlay hides the files of the others.
+TEST(OverlayFileSystemTest, lastOverlayWins) {
+  IntrusiveRefCntPtr<vfs::InMemoryFileSystem> Base =
+    new vfs::InMemoryFileSystem();
+  Base->addFile("/a.h", MemoryBuffer::getMemBufferCopy("base", "/a.h"));
+  Base->addFile("/b.h", MemoryBuffer::getMemBufferCopy("base", "/b.h"));
+  IntrusiveRefCntPtr<vfs::InMemoryFileSystem> Top =
+    new vfs::InMemoryFileSystem();
+  Top->addFile("/a.h", MemoryBuffer::getMemBufferCopy("top", "/a.h"));
+
+  vfs::OverlayFileSystem Overlay(Base);
+  Overlay.pushOverlay(Top);
+
+  FileData Data;
+  EXPECT_FALSE(Overlay.getStatus("/b.h", Data, /*IsFile=*/true));
+  EXPECT_TRUE(Overlay.getStatus("/c.h", Data, /*IsFile=*/true));
+
+  OwningPtr<MemoryBuffer> A(Overlay.getBuffer("/a.h", 0, -1, true));
+  ASSERT_TRUE(A.get() != NULL);
+  EXPECT_EQ("top", A->getBuffer());
+  OwningPtr<MemoryBuffer> B(Overlay.getBuffer("/b.h", 0, -1, true));
+  ASSERT_TRUE(B.get() != NULL);
+  EXPECT_EQ("base", B->getBuffer());
+}
+
 } // anonymous namespace
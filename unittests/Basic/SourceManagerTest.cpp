@@ -233,6 +233,43 @@ TEST_F(SourceManagerTest, getMacroArgExpandedLocation) {
   EXPECT_TRUE(defLoc2.isFileID());
 }
 
+TEST_F(SourceManagerTest, getFileIDRandomAccess) {
+  // Interleave files of very different sizes with short macro expansions, as
+  // a preprocessed translation unit does.
+  FileID mainFileID = SourceMgr.createMainFileIDForMemBuffer(
+      MemoryBuffer::getMemBuffer("int main;\n"));
+  SourceLocation spellingLoc = SourceMgr.getLocForStartOfFile(mainFileID);
+
+  std::vector<SourceLocation> starts;
+  std::vector<unsigned> lengths;
+  for (unsigned i = 0; i != 200; ++i) {
+    if (i % 3 == 0) {
+      std::string contents(1 + (i * 37) % 1000, 'x');
+      FileID fid = SourceMgr.createFileIDForMemBuffer(
+          MemoryBuffer::getMemBufferCopy(contents));
+      starts.push_back(SourceMgr.getLocForStartOfFile(fid));
+      lengths.push_back(contents.size());
+    } else {
+      unsigned length = 1 + i % 5;
+      starts.push_back(SourceMgr.createExpansionLoc(spellingLoc, spellingLoc,
+                                                    spellingLoc, length));
+      lengths.push_back(length);
+    }
+  }
+
+  // Look up locations all over the table, jumping back and forth, and make
+  // sure that each lookup finds the entry the location was created in: only
+  // that entry puts the location at the offset it was made with.
+  unsigned seed = 1;
+  for (unsigned i = 0; i != 5000; ++i) {
+    seed = seed * 1103515245 + 12345;
+    unsigned entry = (seed >> 8) % starts.size();
+    unsigned offset = (seed >> 4) % lengths[entry];
+    SourceLocation loc = starts[entry].getLocWithOffset(offset);
+    ASSERT_EQ(offset, SourceMgr.getDecomposedLoc(loc).second);
+  }
+}
+
 namespace {
 
 struct MacroAction {
@@ -185,6 +185,18 @@ TEST_F(FormatTest, FormatsCorrectRegionForLeadingWhitespace) {
                    25, 0, getLLVMStyleWithColumns(12)));
 }
 
+TEST_F(FormatTest, MergesLinesWhenFormattingPartOfAFile) {
+  EXPECT_EQ("int   a  ;\n"
+            "void f() { return; }\n"
+            "int   b  ;",
+            format("int   a  ;\n"
+                   "void f() {\n"
+                   "return;\n"
+                   "}\n"
+                   "int   b  ;",
+                   11, 0, getLLVMStyle()));
+}
+
 TEST_F(FormatTest, RemovesWhitespaceWhenTriggeredOnEmptyLine) {
   EXPECT_EQ("int  a;\n\n int b;",
             format("int  a;\n  \n\n int b;", 7, 0, getLLVMStyle()));
@@ -746,6 +758,13 @@ TEST_F(FormatTest, UnderstandsSingleLineComments) {
                    "otherLine();   // comment"));
 }
 
+TEST_F(FormatTest, FormatsLongSequencesOfTrailingComments) {
+  std::string Code = "int a; // comment";
+  for (unsigned i = 0; i < 2000; ++i)
+    Code += i % 2 ? "\nint b; // comment" : "\nint c; /* comment */";
+  EXPECT_EQ(Code, format(Code));
+}
+
 TEST_F(FormatTest, CanFormatCommentsLocally) {
   EXPECT_EQ("int a;    // comment\n"
             "int    b; // comment",
@@ -5347,6 +5366,52 @@ TEST_F(FormatTest, ConfigurableFunctionDeclarationIndentAfterType) {
                getLLVMStyleWithColumns(8));
 }
 
+TEST_F(FormatTest, LimitsTheNumberOfStatesPerLine) {
+  FormatStyle Unlimited = getLLVMStyle();
+  Unlimited.MaxStatesPerLine = 0;
+  verifyFormat("aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa(\n"
+               "    bbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbb);",
+               Unlimited);
+
+  // Even when the search is cut short, every token is still placed.
+  FormatStyle Limited = getLLVMStyle();
+  Limited.MaxStatesPerLine = 50;
+  std::string Code = "int a[] = { ";
+  for (unsigned i = 0; i < 100; ++i)
+    Code += "f(aaaaaaaaaa, bbbbbbbbbb, g(cccccccccc, dddddddddd)), ";
+  Code += "};";
+  std::string Result = format(Code, Limited);
+  std::string CodeTokens, ResultTokens;
+  for (unsigned i = 0, e = Code.size(); i != e; ++i)
+    if (Code[i] != ' ')
+      CodeTokens += Code[i];
+  for (unsigned i = 0, e = Result.size(); i != e; ++i)
+    if (Result[i] != ' ' && Result[i] != '\n')
+      ResultTokens += Result[i];
+  EXPECT_EQ(CodeTokens, ResultTokens);
+}
+
+TEST_F(FormatTest, CollectsStatistics) {
+  FormatStatistics Stats;
+  std::string Code = "int a;\n"
+                     "int b;\n";
+  reformat(getLLVMStyle(), Code,
+           std::vector<tooling::Range>(1, tooling::Range(0, Code.size())),
+           "<stdin>", &Stats);
+  EXPECT_EQ(2u, Stats.NumFormattedLines);
+  // Lines that fit only need their initial state.
+  EXPECT_EQ(2u, Stats.NumStateNodes);
+
+  Stats = FormatStatistics();
+  Code = "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa(bbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbb, "
+         "cccccccccccccccccccccccccccccccc);";
+  reformat(getLLVMStyle(), Code,
+           std::vector<tooling::Range>(1, tooling::Range(0, Code.size())),
+           "<stdin>", &Stats);
+  EXPECT_EQ(1u, Stats.NumFormattedLines);
+  EXPECT_LT(Stats.NumStateNodes, 256u);
+}
+
 TEST_F(FormatTest, ConfigurableUseOfTab) {
   FormatStyle Tab = getLLVMStyleWithColumns(42);
   Tab.IndentWidth = 8;
@@ -5641,6 +5706,7 @@ TEST_F(FormatTest, ParsesConfiguration) {
   CHECK_PARSE("AccessModifierOffset: -1234", AccessModifierOffset, -1234);
   CHECK_PARSE("ColumnLimit: 1234", ColumnLimit, 1234u);
   CHECK_PARSE("MaxEmptyLinesToKeep: 1234", MaxEmptyLinesToKeep, 1234u);
+  CHECK_PARSE("MaxStatesPerLine: 1234", MaxStatesPerLine, 1234u);
   CHECK_PARSE("PenaltyExcessCharacter: 1234", PenaltyExcessCharacter, 1234u);
   CHECK_PARSE("PenaltyReturnTypeOnItsOwnLine: 1234",
               PenaltyReturnTypeOnItsOwnLine, 1234u);
@@ -0,0 +1,128 @@
+//===- unittests/Frontend/ASTExportTest.cpp - Binary AST export tests -----===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Frontend/ASTExportReader.h"
+#include "clang/Frontend/ASTConsumers.h"
+#include "clang/Frontend/CompilerInstance.h"
+#include "clang/Frontend/CompilerInvocation.h"
+#include "clang/Frontend/FrontendAction.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+using namespace clang;
+
+namespace {
+
+class ExportAction : public ASTFrontendAction {
+  raw_ostream &OS;
+
+public:
+  ExportAction(raw_ostream &OS) : OS(OS) {}
+
+  virtual ASTConsumer *CreateASTConsumer(CompilerInstance &CI,
+                                         StringRef InFile) {
+    return CreateASTExporter(OS);
+  }
+};
+
+std::string exportCode(StringRef Code) {
+  CompilerInvocation *Invocation = new CompilerInvocation;
+  Invocation->getPreprocessorOpts().addRemappedFile(
+    "test.c", MemoryBuffer::getMemBuffer(Code));
+  Invocation->getFrontendOpts().Inputs.push_back(FrontendInputFile("test.c",
+                                                                   IK_C));
+  Invocation->getFrontendOpts().ProgramAction = frontend::ParseSyntaxOnly;
+  Invocation->getTargetOpts().Triple = "i386-unknown-linux-gnu";
+  CompilerInstance Compiler;
+  Compiler.setInvocation(Invocation);
+  Compiler.createDiagnostics();
+
+  std::string Export;
+  {
+    raw_string_ostream OS(Export);
+    ExportAction Action(OS);
+    EXPECT_TRUE(Compiler.ExecuteAction(Action));
+  }
+  return Export;
+}
+
+TEST(ASTExport, RoundTrip) {
+  std::string Export = exportCode("int f(int x) {\n  return x;\n}\n");
+  ASTExportReader Reader(Export);
+  std::vector<ASTExportNode> Nodes;
+  ASTExportNode Node;
+  while (Reader.readNode(Node))
+    Nodes.push_back(Node);
+  ASSERT_FALSE(Reader.hasError());
+
+  ASSERT_LT(0U, Nodes.size());
+  EXPECT_EQ("TranslationUnit", Nodes[0].Kind);
+  EXPECT_EQ(0U, Nodes[0].Parent);
+
+  const ASTExportNode *F = 0, *X = 0, *Return = 0, *Ref = 0;
+  for (unsigned I = 0, E = Nodes.size(); I != E; ++I) {
+    EXPECT_EQ(I + 1, Nodes[I].Index);
+    if (Nodes[I].Kind == "Function" && Nodes[I].Name == "f")
+      F = &Nodes[I];
+    else if (Nodes[I].Kind == "ParmVar")
+      X = &Nodes[I];
+    else if (Nodes[I].Kind == "ReturnStmt")
+      Return = &Nodes[I];
+    else if (Nodes[I].Kind == "DeclRefExpr")
+      Ref = &Nodes[I];
+  }
+  ASSERT_TRUE(F && X && Return && Ref);
+
+  EXPECT_EQ(Nodes[0].Index, F->Parent);
+  EXPECT_EQ("test.c", F->File);
+  EXPECT_EQ(1U, F->BeginLine);
+  EXPECT_EQ(1U, F->BeginColumn);
+  EXPECT_EQ(3U, F->EndLine);
+  EXPECT_EQ("int (int)", F->Type);
+
+  EXPECT_EQ(F->Index, X->Parent);
+  EXPECT_EQ("x", X->Name);
+  EXPECT_EQ("int", X->Type);
+
+  EXPECT_EQ(ast_export::NC_Stmt, Return->Class);
+  EXPECT_EQ(2U, Return->BeginLine);
+  EXPECT_EQ("x", Ref->Name);
+  EXPECT_EQ("int", Ref->Type);
+  EXPECT_LT(Return->Index, Ref->Index);
+}
+
+TEST(ASTExport, MalformedExport) {
+  ASTExportNode Node;
+
+  ASTExportReader NoMagic("CLAY\x01");
+  EXPECT_FALSE(NoMagic.readNode(Node));
+  EXPECT_TRUE(NoMagic.hasError());
+
+  ASTExportReader NewerVersion("CLAX\x02");
+  EXPECT_FALSE(NewerVersion.readNode(Node));
+  EXPECT_TRUE(NewerVersion.hasError());
+
+  // A node whose kind was never written.
+  ASTExportReader UnknownString(StringRef("CLAX\x01\x02\x00\x05", 8));
+  EXPECT_FALSE(UnknownString.readNode(Node));
+  EXPECT_TRUE(UnknownString.hasError());
+
+  // A string longer than the export.
+  ASTExportReader Truncated(StringRef("CLAX\x01\x01\x10" "ab", 9));
+  EXPECT_FALSE(Truncated.readNode(Node));
+  EXPECT_TRUE(Truncated.hasError());
+
+  ASTExportReader Empty(StringRef("CLAX\x01\x00", 6));
+  EXPECT_FALSE(Empty.readNode(Node));
+  EXPECT_FALSE(Empty.hasError());
+}
+
+} // anonymous namespace
@@ -0,0 +1,108 @@
+//===- unittests/Frontend/ASTUnitTest.cpp - ASTUnit tests -----------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Frontend/ASTUnit.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/Decl.h"
+#include "clang/Basic/SourceManager.h"
+#include "clang/Frontend/CompilerInstance.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/raw_ostream.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+using namespace clang;
+
+namespace {
+
+class ASTUnitTest : public ::testing::Test {
+protected:
+  ~ASTUnitTest() {
+    for (StringMap<std::string>::iterator I = TemporaryFiles.begin(),
+                                          E = TemporaryFiles.end();
+         I != E; ++I) {
+      error_code EC = sys::fs::remove(I->second);
+      (void)EC;
+      assert(!EC);
+    }
+  }
+
+  std::string createFile(StringRef Name, StringRef Content) {
+    SmallString<1024> Path;
+    int FD;
+    error_code EC = sys::fs::createTemporaryFile(Name, "c", FD, Path);
+    assert(!EC);
+    (void)EC;
+
+    raw_fd_ostream OutStream(FD, true);
+    OutStream << Content;
+    OutStream.close();
+    TemporaryFiles[Name] = Path.str();
+    return Path.str();
+  }
+
+  ASTUnit *parse(StringRef Path) {
+    std::string File = Path;
+    const char *Args[] = { "-xc", File.c_str() };
+    return ASTUnit::LoadFromCommandLine(
+        Args, Args + 2,
+        CompilerInstance::createDiagnostics(new DiagnosticOptions()),
+        /*ResourceFilesPath=*/"", /*OnlyLocalDecls=*/false,
+        /*CaptureDiagnostics=*/true, /*RemappedFiles=*/0,
+        /*NumRemappedFiles=*/0, /*RemappedFilesKeepOriginalName=*/true,
+        /*PrecompilePreamble=*/true, TU_Complete,
+        /*CacheCodeCompletionResults=*/false,
+        /*IncludeBriefCommentsInCodeCompletion=*/false,
+        /*AllowPCHWithCompilerErrors=*/false, /*SkipFunctionBodies=*/false,
+        /*UserFilesAreVolatile=*/false, /*ForSerialization=*/false,
+        /*SharePreamble=*/true);
+  }
+
+  static NamedDecl *lookup(ASTUnit &AST, StringRef Name) {
+    ASTContext &Ctx = AST.getASTContext();
+    DeclContext::lookup_result R =
+        Ctx.getTranslationUnitDecl()->lookup(&Ctx.Idents.get(Name));
+    return R.empty() ? 0 : R[0];
+  }
+
+  StringMap<std::string> TemporaryFiles;
+};
+
+TEST_F(ASTUnitTest, DoesNotSharePreambleBetweenMainFiles) {
+  std::string PathA =
+      createFile("preamble-a", "#define SHARED 1\nint a_only = SHARED;\n");
+  std::string PathB =
+      createFile("preamble-b", "#define SHARED 1\nint b_only = SHARED;\n");
+
+  // The first reparse of A precompiles a preamble that B starts with too.
+  OwningPtr<ASTUnit> A(parse(PathA));
+  ASSERT_TRUE(A.get() != 0);
+  ASSERT_FALSE(A->Reparse());
+  ASSERT_TRUE(lookup(*A, "a_only") != 0);
+
+  OwningPtr<ASTUnit> B(parse(PathB));
+  ASSERT_TRUE(B.get() != 0);
+  EXPECT_FALSE(B->getDiagnostics().hasErrorOccurred());
+  EXPECT_TRUE(lookup(*B, "a_only") == 0);
+  NamedDecl *BOnly = lookup(*B, "b_only");
+  ASSERT_TRUE(BOnly != 0);
+  EXPECT_EQ(PathB,
+            B->getSourceManager().getFilename(BOnly->getLocation()).str());
+
+  // A second unit for A may use its preamble, and sees A's declarations.
+  OwningPtr<ASTUnit> OtherA(parse(PathA));
+  ASSERT_TRUE(OtherA.get() != 0);
+  EXPECT_FALSE(OtherA->getDiagnostics().hasErrorOccurred());
+  EXPECT_TRUE(lookup(*OtherA, "a_only") != 0);
+  EXPECT_TRUE(lookup(*OtherA, "b_only") == 0);
+}
+
+} // anonymous namespace
@@ -0,0 +1,99 @@
+//===- unittests/Lex/DependencyDirectivesTest.cpp - Minimizer tests -------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Lex/DependencyDirectives.h"
+#include "clang/Basic/LangOptions.h"
+#include "llvm/ADT/SmallString.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+using namespace clang;
+
+namespace {
+
+std::string minimize(StringRef Source) {
+  LangOptions LangOpts;
+  LangOpts.CPlusPlus = true;
+  LangOpts.LineComment = true;
+  LangOpts.ObjC1 = true;
+
+  // The minimizer expects a null-terminated buffer.
+  std::string Input = Source;
+  SmallString<128> Output;
+  EXPECT_TRUE(minimizeSourceToDependencyDirectives(
+      StringRef(Input.c_str(), Input.size()), LangOpts, Output));
+  return Output.str();
+}
+
+TEST(DependencyDirectivesTest, keepsIncludesAndConditionals) {
+  EXPECT_EQ("#ifndef GUARD\n"
+            "#define GUARD\n"
+            "#include \"a.h\"\n"
+            "# if defined(X) && X > 2\n"
+            "#include_next <b.h>\n"
+            "#elif 0\n"
+            "#else\n"
+            "#import <c.h>\n"
+            "#endif\n"
+            "#undef Y\n"
+            "#endif\n",
+            minimize("#ifndef GUARD\n"
+                     "#define GUARD\n"
+                     "int x;\n"
+                     "#include \"a.h\"\n"
+                     "struct S { int y; };\n"
+                     "# if defined(X) && X > 2\n"
+                     "#include_next <b.h>\n"
+                     "#elif 0\n"
+                     "#error nope\n"
+                     "#else\n"
+                     "#import <c.h>\n"
+                     "#endif\n"
+                     "#undef Y\n"
+                     "#line 12\n"
+                     "#endif\n"));
+}
+
+TEST(DependencyDirectivesTest, ignoresDirectivesInCommentsAndLiterals) {
+  EXPECT_EQ("#include \"real.h\"\n",
+            minimize("// #include \"line-comment.h\"\n"
+                     "/* #include \"block-comment.h\"\n"
+                     "#include \"still-in-comment.h\" */\n"
+                     "const char *s = \"#include \\\"string.h\\\"\";\n"
+                     "int a; #include \"not-at-start-of-line.h\"\n"
+                     "#include \"real.h\"\n"));
+}
+
+TEST(DependencyDirectivesTest, keepsMultiLineDirectivesIntact) {
+  EXPECT_EQ("#define MACRO(a, b) \\\n"
+            "  a + b\n"
+            "#define COMMENTED /* spans\n"
+            "  lines */ 1\n",
+            minimize("#define MACRO(a, b) \\\n"
+                     "  a + b\n"
+                     "int x = MACRO(1, 2);\n"
+                     "#define COMMENTED /* spans\n"
+                     "  lines */ 1\n"));
+}
+
+TEST(DependencyDirectivesTest, keepsInclusionPragmasAndImports) {
+  EXPECT_EQ("#pragma once\n"
+            "#pragma push_macro(\"X\")\n"
+            "#pragma GCC system_header\n"
+            "@import Foundation;\n",
+            minimize("#pragma once\n"
+                     "#pragma push_macro(\"X\")\n"
+                     "#pragma GCC diagnostic ignored \"-Wall\"\n"
+                     "#pragma GCC system_header\n"
+                     "#pragma mark - Section\n"
+                     "@import Foundation;\n"
+                     "@interface I @end\n"));
+}
+
+} // anonymous namespace
@@ -0,0 +1,141 @@
+//===- unittests/Lex/PreprocessingRecordTest.cpp - PPRecord tests ---------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Lex/PreprocessingRecord.h"
+#include "clang/Basic/Diagnostic.h"
+#include "clang/Basic/DiagnosticOptions.h"
+#include "clang/Basic/FileManager.h"
+#include "clang/Basic/LangOptions.h"
+#include "clang/Basic/SourceManager.h"
+#include "clang/Basic/TargetInfo.h"
+#include "clang/Basic/TargetOptions.h"
+#include "clang/Lex/HeaderSearch.h"
+#include "clang/Lex/HeaderSearchOptions.h"
+#include "clang/Lex/ModuleLoader.h"
+#include "clang/Lex/Preprocessor.h"
+#include "clang/Lex/PreprocessorOptions.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+using namespace clang;
+
+namespace {
+
+// The test fixture.
+class PreprocessingRecordTest : public ::testing::Test {
+protected:
+  PreprocessingRecordTest()
+    : FileMgr(FileMgrOpts),
+      DiagID(new DiagnosticIDs()),
+      Diags(DiagID, new DiagnosticOptions, new IgnoringDiagConsumer()),
+      SourceMgr(Diags, FileMgr),
+      TargetOpts(new TargetOptions)
+  {
+    TargetOpts->Triple = "x86_64-apple-darwin11.1.0";
+    Target = TargetInfo::CreateTargetInfo(Diags, &*TargetOpts);
+  }
+
+  FileSystemOptions FileMgrOpts;
+  FileManager FileMgr;
+  IntrusiveRefCntPtr<DiagnosticIDs> DiagID;
+  DiagnosticsEngine Diags;
+  SourceManager SourceMgr;
+  LangOptions LangOpts;
+  IntrusiveRefCntPtr<TargetOptions> TargetOpts;
+  IntrusiveRefCntPtr<TargetInfo> Target;
+};
+
+class VoidModuleLoader : public ModuleLoader {
+  virtual ModuleLoadResult loadModule(SourceLocation ImportLoc,
+                                      ModuleIdPath Path,
+                                      Module::NameVisibilityKind Visibility,
+                                      bool IsInclusionDirective) {
+    return ModuleLoadResult();
+  }
+
+  virtual void makeModuleVisible(Module *Mod,
+                                 Module::NameVisibilityKind Visibility,
+                                 SourceLocation ImportLoc,
+                                 bool Complain) { }
+};
+
+TEST_F(PreprocessingRecordTest, MacroExpansions) {
+  const char *source =
+      "#define M1 1\n"
+      "#define M2 2\n"
+      "#define FM(x,y) y x\n"
+      "M1 __LINE__\n"
+      "FM(M1, M2)\n"
+      "M2\n";
+
+  MemoryBuffer *buf = MemoryBuffer::getMemBuffer(source);
+  SourceMgr.createMainFileIDForMemBuffer(buf);
+
+  VoidModuleLoader ModLoader;
+  HeaderSearch HeaderInfo(new HeaderSearchOptions, FileMgr, Diags, LangOpts,
+                          Target.getPtr());
+  Preprocessor PP(new PreprocessorOptions(), Diags, LangOpts,Target.getPtr(),
+                  SourceMgr, HeaderInfo, ModLoader,
+                  /*IILookup =*/ 0,
+                  /*OwnsHeaderSearch =*/false,
+                  /*DelayInitialization =*/ false);
+  PP.createPreprocessingRecord();
+  PP.EnterMainSourceFile();
+
+  std::vector<Token> toks;
+  while (1) {
+    Token tok;
+    PP.Lex(tok);
+    if (tok.is(tok::eof))
+      break;
+    toks.push_back(tok);
+  }
+  ASSERT_EQ(5U, toks.size());
+
+  PreprocessingRecord &PPRec = *PP.getPreprocessingRecord();
+  std::vector<PreprocessedEntity *> Entities(PPRec.local_begin(),
+                                             PPRec.local_end());
+
+  // Three definitions, then the expansions in source order, including the
+  // ones in the arguments of FM, which are expanded the other way around.
+  ASSERT_EQ(9U, Entities.size());
+  const char *Names[] = { "M1", "M2", "FM", "M1", "__LINE__", "FM", "M1", "M2",
+                          "M2" };
+  // The index of the definition of each expansion, or -1 for builtins.
+  int Definitions[] = { -1, -1, -1, 0, -1, 2, 0, 1, 1 };
+  for (unsigned I = 0; I != 3; ++I) {
+    MacroDefinition *Def = dyn_cast<MacroDefinition>(Entities[I]);
+    ASSERT_TRUE(Def != 0);
+    EXPECT_EQ(Names[I], Def->getName()->getName().str());
+  }
+  for (unsigned I = 3; I != 9; ++I) {
+    MacroExpansion *Expansion = dyn_cast<MacroExpansion>(Entities[I]);
+    ASSERT_TRUE(Expansion != 0);
+    EXPECT_EQ(Names[I], Expansion->getName()->getName().str());
+    if (Definitions[I] < 0)
+      EXPECT_TRUE(Expansion->isBuiltinMacro());
+    else
+      EXPECT_EQ(Entities[Definitions[I]], Expansion->getDefinition());
+  }
+
+  // Every expansion is created only once.
+  EXPECT_EQ(Entities[5], *(PPRec.local_begin() + 5));
+
+  // A range query covering the expansion of FM finds it and the expansions
+  // in its arguments.
+  std::pair<PreprocessingRecord::iterator, PreprocessingRecord::iterator>
+    Range = PPRec.getPreprocessedEntitiesInRange(
+              Entities[5]->getSourceRange());
+  ASSERT_EQ(3, Range.second - Range.first);
+  EXPECT_EQ(Entities[5], *Range.first);
+  EXPECT_EQ(Entities[6], *(Range.first + 1));
+  EXPECT_EQ(Entities[7], *(Range.first + 2));
+}
+
+} // anonymous namespace
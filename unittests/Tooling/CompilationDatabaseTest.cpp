@@ -202,6 +202,40 @@ TEST_F(FileMatchTrieTest, CannotResolveRelativePath) {
   EXPECT_EQ("Cannot resolve relative paths", Error);
 }
 
+static std::vector<CompileCommand> getAllCommands(StringRef JSONDatabase) {
+  std::string ErrorMessage;
+  OwningPtr<CompilationDatabase> Database(
+      JSONCompilationDatabase::loadFromBuffer(JSONDatabase, ErrorMessage));
+  if (!Database) {
+    ADD_FAILURE() << ErrorMessage;
+    return std::vector<CompileCommand>();
+  }
+  return Database->getAllCompileCommands();
+}
+
+TEST(JSONCompilationDatabase, ParsesJSONAndYAMLAlike) {
+  // The first database is plain JSON, the second one is only valid YAML.
+  std::vector<CompileCommand> FromJSON = getAllCommands(
+      "[ {\"directory\": \"//net/dir\",\n"
+      "   \"command\": \"cc -DX=\\\\\\\"a b\\\\\\\" file.cc\",\n"
+      "   \"file\": \"file.cc\"},\n"
+      "  {\"file\": \"//net/dir/other.cc\", \"directory\": \"//net/dir\",\n"
+      "   \"command\": \"cc\\tother.cc\"} ]\n");
+  std::vector<CompileCommand> FromYAML = getAllCommands(
+      "[ {'directory': '//net/dir',\n"
+      "   'command': 'cc -DX=\\\"a b\\\" file.cc',\n"
+      "   'file': 'file.cc'},\n"
+      "  {file: //net/dir/other.cc, directory: //net/dir,\n"
+      "   command: \"cc\\tother.cc\"} ]\n");
+  ASSERT_EQ(2u, FromJSON.size());
+  ASSERT_EQ(2u, FromYAML.size());
+  for (unsigned I = 0; I != 2; ++I) {
+    EXPECT_EQ("//net/dir", FromJSON[I].Directory);
+    EXPECT_EQ(FromJSON[I].Directory, FromYAML[I].Directory);
+    EXPECT_EQ(FromJSON[I].CommandLine, FromYAML[I].CommandLine);
+  }
+}
+
 TEST(findCompileArgsInJsonDatabase, FindsNothingIfEmpty) {
   std::string ErrorMessage;
   CompileCommand NotFound = findCompileArgsInJsonDatabase(
@@ -291,6 +325,53 @@ TEST(findCompileArgsInJsonDatabase, FindsEntry) {
   EXPECT_EQ("command4", FoundCommand.CommandLine[0]) << ErrorMessage;
 }
 
+static std::vector<CompileCommand>
+getInferredCommands(StringRef FileName, StringRef JSONDatabase) {
+  std::string ErrorMessage;
+  OwningPtr<JSONCompilationDatabase> Database(
+      JSONCompilationDatabase::loadFromBuffer(JSONDatabase, ErrorMessage));
+  if (!Database) {
+    ADD_FAILURE() << ErrorMessage;
+    return std::vector<CompileCommand>();
+  }
+  return Database->getInferredCompileCommands(FileName);
+}
+
+TEST(JSONCompilationDatabase, InfersCommandsOfHeaders) {
+  StringRef JSONDatabase =
+    "[{\"directory\":\"//net/dir\","
+    "  \"command\":\"clang++ -DA a/foo.cpp\","
+    "  \"file\":\"a/foo.cpp\"},"
+    " {\"directory\":\"//net/dir\","
+    "  \"command\":\"clang++ -DB a/bar.cpp\","
+    "  \"file\":\"a/bar.cpp\"},"
+    " {\"directory\":\"//net/dir\","
+    "  \"command\":\"clang++ -DC b/c/baz.cpp\","
+    "  \"file\":\"b/c/baz.cpp\"}]";
+
+  // A file with the same name wins.
+  std::vector<CompileCommand> Commands =
+    getInferredCommands("//net/dir/a/foo.h", JSONDatabase);
+  ASSERT_EQ(1u, Commands.size());
+  ASSERT_EQ(3u, Commands[0].CommandLine.size());
+  EXPECT_EQ("-DA", Commands[0].CommandLine[1]);
+  EXPECT_EQ("//net/dir/a/foo.h", Commands[0].CommandLine[2]);
+
+  // Otherwise, a file of the nearest directory.
+  Commands = getInferredCommands("//net/dir/b/c/d/qux.h", JSONDatabase);
+  ASSERT_EQ(1u, Commands.size());
+  ASSERT_EQ(3u, Commands[0].CommandLine.size());
+  EXPECT_EQ("-DC", Commands[0].CommandLine[1]);
+  EXPECT_EQ("//net/dir/b/c/d/qux.h", Commands[0].CommandLine[2]);
+
+  // The commands of a file of the database are its own.
+  Commands = getInferredCommands("//net/dir/a/bar.cpp", JSONDatabase);
+  ASSERT_EQ(1u, Commands.size());
+  EXPECT_EQ("a/bar.cpp", Commands[0].CommandLine[2]);
+
+  EXPECT_TRUE(getInferredCommands("//other/x.h", JSONDatabase).empty());
+}
+
 static std::vector<std::string> unescapeJsonCommandLine(StringRef Command) {
   std::string JsonDatabase =
     ("[{\"directory\":\"//net/root\", \"file\":\"test\", \"command\": \"" +
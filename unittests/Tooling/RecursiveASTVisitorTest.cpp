@@ -503,4 +503,72 @@ TEST(RecursiveASTVisitor, TraverseLambdaBodyCanBeOverridden) {
   EXPECT_TRUE(Visitor.allBodiesHaveBeenTraversed());
 }
 
+/// \brief A visitor that records the classes of the statements it visits, in
+/// order, and optionally uses data recursion for all of them.
+template <bool DataRecursive>
+class StmtOrderVisitor : public TestVisitor<StmtOrderVisitor<DataRecursive> > {
+public:
+  std::vector<std::string> Visited;
+
+  bool shouldUseDataRecursionForAllStmts() const { return DataRecursive; }
+
+  bool VisitStmt(Stmt *S) {
+    Visited.push_back(S->getStmtClassName());
+    return true;
+  }
+};
+
+TEST(RecursiveASTVisitor, DataRecursionForAllStmtsKeepsOrder) {
+  const char *Code =
+    "struct S { int m; int g(int); };\n"
+    "int f(int *p, S s) {\n"
+    "  int k = (p[0] + s.g((1))) * s.m;\n"
+    "  if (k) { for (int i = 0; i < k; ++i) k -= f(p, s); }\n"
+    "  auto l = [&](int x) { return x + k; };\n"
+    "  return l(sizeof(S)) ? k : -k;\n"
+    "}\n";
+  StmtOrderVisitor<false> Recursive;
+  EXPECT_TRUE(Recursive.runOver(Code, StmtOrderVisitor<false>::Lang_CXX11));
+  StmtOrderVisitor<true> DataRecursive;
+  EXPECT_TRUE(DataRecursive.runOver(Code, StmtOrderVisitor<true>::Lang_CXX11));
+  EXPECT_FALSE(Recursive.Visited.empty());
+  EXPECT_EQ(Recursive.Visited, DataRecursive.Visited);
+}
+
+/// \brief A visitor that uses data recursion for all statements, and records
+/// the nesting of calls around each integer literal.
+class CallDepthVisitor : public ExpectedLocationVisitor<CallDepthVisitor> {
+public:
+  CallDepthVisitor() : Depth(0) {}
+
+  bool shouldUseDataRecursionForAllStmts() const { return true; }
+
+  // The children of a call must be traversed before this returns, even
+  // though the other statements are traversed using data recursion.
+  bool TraverseCallExpr(CallExpr *Call) {
+    ++Depth;
+    bool Result =
+      ExpectedLocationVisitor<CallDepthVisitor>::TraverseCallExpr(Call);
+    --Depth;
+    return Result;
+  }
+
+  bool VisitIntegerLiteral(IntegerLiteral *Literal) {
+    if (Depth == 2)
+      Match("2", Literal->getLocation());
+    return true;
+  }
+
+private:
+  unsigned Depth;
+};
+
+TEST(RecursiveASTVisitor, DataRecursionForAllStmtsHonorsTraverseOverrides) {
+  CallDepthVisitor Visitor;
+  Visitor.ExpectMatch("2", 2, 20);
+  EXPECT_TRUE(Visitor.runOver(
+    "int f(int);\n"
+    "int k = (1 + f((f((2)))));\n"));
+}
+
 } // end namespace clang
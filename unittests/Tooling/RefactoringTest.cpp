@@ -151,6 +151,70 @@ TEST_F(ReplacementTest, ApplyAllFailsIfOneApplyFails) {
   EXPECT_EQ("z", Context.getRewrittenText(IDz));
 }
 
+TEST_F(ReplacementTest, AppliesManyReplacementsPerFile) {
+  FileID IDa = Context.createInMemoryFile("a.cpp", "0123456789");
+  FileID IDb = Context.createInMemoryFile("b.cpp", "abcdefghij");
+  Replacements Replaces;
+  for (unsigned I = 0; I != 10; I += 2) {
+    Replaces.insert(Replacement("a.cpp", I, 1, "<>"));
+    Replaces.insert(Replacement("b.cpp", I + 1, 1, ""));
+  }
+  Replaces.insert(Replacement("missing.cpp", 0, 1, ""));
+  EXPECT_FALSE(applyAllReplacements(Replaces, Context.Rewrite));
+  EXPECT_EQ("<>1<>3<>5<>7<>9", Context.getRewrittenText(IDa));
+  EXPECT_EQ("acegi", Context.getRewrittenText(IDb));
+}
+
+TEST(FindConflictsTest, FindsOverlappingReplacements) {
+  Replacements Replaces;
+  Replaces.insert(Replacement("a.cc", 0, 10, "x"));
+  Replaces.insert(Replacement("a.cc", 5, 2, "y"));
+  Replaces.insert(Replacement("a.cc", 10, 2, "z"));
+  Replaces.insert(Replacement("b.cc", 5, 2, "y"));
+
+  Replacements Conflicts;
+  EXPECT_TRUE(findConflicts(Replaces, Conflicts));
+  EXPECT_EQ(2u, Conflicts.size());
+  EXPECT_EQ(1u, Conflicts.count(Replacement("a.cc", 0, 10, "x")));
+  EXPECT_EQ(1u, Conflicts.count(Replacement("a.cc", 5, 2, "y")));
+}
+
+TEST(FindConflictsTest, FindsInsertionsAtTheSameOffset) {
+  Replacements Replaces;
+  Replaces.insert(Replacement("a.cc", 3, 0, "x"));
+  Replaces.insert(Replacement("a.cc", 3, 0, "y"));
+  Replaces.insert(Replacement("a.cc", 3, 2, "z"));
+
+  Replacements Conflicts;
+  EXPECT_TRUE(findConflicts(Replaces, Conflicts));
+  EXPECT_EQ(2u, Conflicts.size());
+  EXPECT_EQ(0u, Conflicts.count(Replacement("a.cc", 3, 2, "z")));
+}
+
+TEST(FindConflictsTest, FindsInsertionsAtTheEndOfAReplacement) {
+  Replacements Replaces;
+  Replaces.insert(Replacement("a.cc", 0, 5, "a"));
+  Replaces.insert(Replacement("a.cc", 5, 0, "x"));
+  Replaces.insert(Replacement("a.cc", 5, 0, "y"));
+
+  Replacements Conflicts;
+  EXPECT_TRUE(findConflicts(Replaces, Conflicts));
+  EXPECT_EQ(2u, Conflicts.size());
+  EXPECT_EQ(0u, Conflicts.count(Replacement("a.cc", 0, 5, "a")));
+}
+
+TEST(FindConflictsTest, IgnoresDuplicatesAndAdjacentReplacements) {
+  Replacements Replaces;
+  Replaces.insert(Replacement("a.cc", 0, 5, "x"));
+  Replaces.insert(Replacement("a.cc", 0, 5, "x"));
+  Replaces.insert(Replacement("a.cc", 5, 5, "y"));
+  Replaces.insert(Replacement("a.cc", 10, 0, "z"));
+
+  Replacements Conflicts;
+  EXPECT_FALSE(findConflicts(Replaces, Conflicts));
+  EXPECT_TRUE(Conflicts.empty());
+}
+
 TEST(ShiftedCodePositionTest, FindsNewCodePosition) {
   Replacements Replaces;
   Replaces.insert(Replacement("", 0, 1, ""));
@@ -236,6 +300,20 @@ TEST_F(FlushRewrittenFilesTest, StoresChangesOnDisk) {
             getFileContentFromDisk("input.cpp"));
 }
 
+TEST_F(FlushRewrittenFilesTest, StoresChangesOnDiskInParallel) {
+  FileID ID1 = createFile("input1.cpp", "line1\nline2");
+  FileID ID2 = createFile("input2.cpp", "line1\nline2");
+  Replacements Replaces;
+  Replaces.insert(Replacement(Context.Sources, Context.getLocation(ID1, 2, 1),
+                              5, "first"));
+  Replaces.insert(Replacement(Context.Sources, Context.getLocation(ID2, 1, 1),
+                              5, "second"));
+  EXPECT_TRUE(applyAllReplacements(Replaces, Context.Rewrite));
+  EXPECT_FALSE(Context.Rewrite.overwriteChangedFiles(2));
+  EXPECT_EQ("line1\nfirst", getFileContentFromDisk("input1.cpp"));
+  EXPECT_EQ("second\nline2", getFileContentFromDisk("input2.cpp"));
+}
+
 namespace {
 template <typename T>
 class TestVisitor : public clang::RecursiveASTVisitor<T> {
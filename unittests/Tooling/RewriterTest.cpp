@@ -34,4 +34,27 @@ TEST(Rewriter, ContinuesOverwritingFilesOnError) {
             Context.getFileContentFromDisk("working.cpp")); 
 }
 
+TEST(Rewriter, AppliesManyEditsToOneFile) {
+  // Enough edits to grow the rewrite buffer's trees several levels deep.
+  const unsigned NumLines = 5000;
+  std::string Code, Expected;
+  for (unsigned i = 0; i != NumLines; ++i) {
+    Code += "line;\n";
+    Expected += i % 2 ? "line;\n" : "[replaced];\n";
+  }
+  RewriterTestContext Context;
+  FileID ID = Context.createInMemoryFile("input.cpp", Code);
+  // Edit every other line, back to front and then front to back, so that
+  // each edit lands between deltas that are already in the tree.
+  for (unsigned Line = NumLines - 1; Line >= 1; Line -= 2) {
+    Context.Rewrite.InsertText(Context.getLocation(ID, Line, 1), "[");
+    if (Line == 1)
+      break;
+  }
+  for (unsigned Line = 1; Line <= NumLines; Line += 2)
+    Context.Rewrite.ReplaceText(Context.getLocation(ID, Line, 1), 4,
+                                "replaced]");
+  EXPECT_EQ(Expected, Context.getRewrittenText(ID));
+}
+
 } // end namespace clang
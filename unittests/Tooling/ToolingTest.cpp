@@ -110,6 +110,44 @@ struct IndependentFrontendActionCreator {
   }
 };
 
+namespace {
+struct FindTopLevelDeclConsumerCreator {
+  explicit FindTopLevelDeclConsumerCreator(bool *FoundTopLevelDecl)
+      : FoundTopLevelDecl(FoundTopLevelDecl) {}
+  ASTConsumer *newASTConsumer() {
+    return new FindTopLevelDeclConsumer(FoundTopLevelDecl);
+  }
+  bool *FoundTopLevelDecl;
+};
+
+struct FindClassDeclXConsumerCreator {
+  explicit FindClassDeclXConsumerCreator(bool *FoundClassDeclX)
+      : FoundClassDeclX(FoundClassDeclX) {}
+  ASTConsumer *newASTConsumer() {
+    return new FindClassDeclXConsumer(FoundClassDeclX);
+  }
+  bool *FoundClassDeclX;
+};
+} // end namespace
+
+TEST(newMultiplexFrontendActionFactory, RunsAllActionsOverOneParse) {
+  bool FoundTopLevelDecl = false;
+  bool FoundClassDeclX = false;
+  FindTopLevelDeclConsumerCreator TopLevelCreator(&FoundTopLevelDecl);
+  FindClassDeclXConsumerCreator ClassXCreator(&FoundClassDeclX);
+  OwningPtr<FrontendActionFactory> TopLevelFactory(
+      newFrontendActionFactory(&TopLevelCreator));
+  OwningPtr<FrontendActionFactory> ClassXFactory(
+      newFrontendActionFactory(&ClassXCreator));
+  FrontendActionFactory *Factories[] = { TopLevelFactory.get(),
+                                         ClassXFactory.get() };
+  OwningPtr<FrontendActionFactory> Factory(
+      newMultiplexFrontendActionFactory(Factories));
+  EXPECT_TRUE(runToolOnCode(Factory->create(), "class X;"));
+  EXPECT_TRUE(FoundTopLevelDecl);
+  EXPECT_TRUE(FoundClassDeclX);
+}
+
 TEST(newFrontendActionFactory, CreatesFrontendActionFactoryFromFactoryType) {
   IndependentFrontendActionCreator Creator;
   OwningPtr<FrontendActionFactory> Factory(
@@ -234,5 +272,36 @@ TEST(ClangToolTest, ArgumentAdjusters) {
   EXPECT_FALSE(Found);
 }
 
+struct CountingActionFactory : public FrontendActionFactory {
+  unsigned Created;
+  CountingActionFactory() : Created(0) {}
+  virtual FrontendAction *create() {
+    ++Created;
+    return new SyntaxOnlyAction;
+  }
+};
+
+TEST(ClangToolTest, RunsTranslationUnitsInParallel) {
+  FixedCompilationDatabase Compilations("/", std::vector<std::string>());
+  std::vector<std::string> Sources;
+  Sources.push_back("/a.cc");
+  Sources.push_back("/b.cc");
+  Sources.push_back("/c.cc");
+  ClangTool Tool(Compilations, Sources);
+  Tool.mapVirtualFile("/a.cc", "void a() {}");
+  Tool.mapVirtualFile("/b.cc", "void b() {}");
+  Tool.mapVirtualFile("/c.cc", "void c() {}");
+  Tool.setNumThreads(2);
+
+  CountingActionFactory Factory;
+  EXPECT_EQ(0, Tool.run(&Factory));
+  EXPECT_EQ(3u, Factory.Created);
+
+  Tool.mapVirtualFile("/b.cc", "void b() { an_error_here }");
+  Factory.Created = 0;
+  EXPECT_EQ(1, Tool.run(&Factory));
+  EXPECT_EQ(3u, Factory.Created);
+}
+
 } // end namespace tooling
 } // end namespace clang
@@ -0,0 +1,232 @@
+#!/usr/bin/env python
+
+"""
+Script to measure the throughput of the lexer and the preprocessor.
+
+Every input file is run through the front end in these modes, each of which
+adds a part of the work to the previous one:
+
+  raw    '-raw-lex-only': Lexer::LexFromRawLexer over the main file.
+  pp     '-Eonly': Preprocessor::Lex, with macro expansion, header search and
+         the lexing of the included files.
+  print  '-E': PrintPreprocessedOutput writing the preprocessed file.
+
+The time of each mode is the fastest of several runs, minus the time of the
+same mode on an empty file so that the startup of clang doesn't count, and is
+turned into tokens per second with the token counts of '-dump-raw-tokens' and
+'-dump-tokens'. Real-world inputs are given as files, which should be
+preprocessed unless their include paths are given with --cc1-arg; with
+--synthetic, generated inputs stressing identifiers and literals, macro
+expansion and header search are added:
+
+  LexBenchmark.py --clang=<clang> --synthetic -o new.csv corpus/*.i
+  LexBenchmark.py --clang=<clang> --synthetic --baseline=old.csv corpus/*.i
+
+When a baseline is given, the script prints the inputs whose throughput
+changed, and exits with 1 if any of them got slower than allowed.
+"""
+
+import csv
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+from optparse import OptionParser
+
+Modes = [('raw', ['-raw-lex-only']),
+         ('pp', ['-Eonly']),
+         ('print', ['-E', '-o', os.devnull])]
+
+Fields = ['input', 'mode', 'tokens', 'seconds', 'tokens-per-second']
+
+def runClang(Clang, Args):
+    """Runs 'clang -cc1' with Args and returns its stderr."""
+    P = subprocess.Popen([Clang, '-cc1'] + Args, stdout=subprocess.PIPE,
+                         stderr=subprocess.PIPE)
+    _, Err = P.communicate()
+    if P.returncode != 0:
+        print >> sys.stderr, 'error: clang -cc1 %s failed:\n%s' % \
+            (' '.join(Args), Err)
+        sys.exit(-1)
+    return Err
+
+def countTokens(Clang, Args, FileName):
+    """Returns the number of raw and of preprocessed tokens of FileName."""
+    Raw = runClang(Clang, Args + ['-dump-raw-tokens', FileName])
+    Preprocessed = runClang(Clang, Args + ['-dump-tokens', FileName])
+    # Don't count the eof token.
+    return len(Raw.splitlines()), len(Preprocessed.splitlines()) - 1
+
+def fastestRun(Clang, Args, Repeat):
+    Best = None
+    for _ in range(Repeat):
+        Start = time.time()
+        runClang(Clang, Args)
+        Elapsed = time.time() - Start
+        if Best is None or Elapsed < Best:
+            Best = Elapsed
+    return Best
+
+def writeSyntheticInputs(Dir, Scale):
+    """Writes the synthetic inputs to Dir, and returns them with the extra
+    arguments they need."""
+    Inputs = []
+
+    # Identifiers, keywords, literals and comments, without any macros.
+    FileName = os.path.join(Dir, 'declarations.c')
+    F = open(FileName, 'w')
+    for i in range(1000 * Scale):
+        F.write('/* Function number %d. */\n' % i)
+        F.write('static int function_%d(int argument, const char *name) {\n'
+                % i)
+        F.write('  double value = %d.5e-3; // A floating literal.\n' % i)
+        F.write('  return argument * 0x%x + name[%d] + (int)value + '
+                '"string literal %d"[0];\n' % (i, i % 7, i))
+        F.write('}\n')
+    F.close()
+    Inputs.append((FileName, []))
+
+    # Nested object-like and function-like macros, expanded many times.
+    FileName = os.path.join(Dir, 'macros.c')
+    F = open(FileName, 'w')
+    F.write('#define CAT(a, b) a ## b\n')
+    F.write('#define STR(a) #a\n')
+    F.write('#define ADD(a, b) ((a) + (b))\n')
+    F.write('#define ADD4(a, b, c, d) ADD(ADD(a, b), ADD(c, d))\n')
+    F.write('#define ADD16(a) ADD4(ADD4(a, a, a, a), ADD4(a, a, a, a), '
+            'ADD4(a, a, a, a), ADD4(a, a, a, a))\n')
+    F.write('#define ONE 1\n')
+    for i in range(1000 * Scale):
+        F.write('int CAT(variable_, %d) = ADD16(ONE); '
+                'const char *CAT(name_, %d) = STR(variable_%d);\n' % (i, i, i))
+    F.close()
+    Inputs.append((FileName, []))
+
+    # Headers found in the last of many include directories, included twice
+    # each so that the second inclusion only looks for the header and skips
+    # it for its include guard.
+    FileName = os.path.join(Dir, 'headers.c')
+    Args = []
+    NumDirs = 50
+    for d in range(NumDirs):
+        IncludeDir = os.path.join(Dir, 'include%d' % d)
+        os.mkdir(IncludeDir)
+        Args += ['-I', IncludeDir]
+    LastDir = os.path.join(Dir, 'include%d' % (NumDirs - 1))
+    F = open(FileName, 'w')
+    for i in range(100 * Scale):
+        H = open(os.path.join(LastDir, 'header%d.h' % i), 'w')
+        H.write('#ifndef HEADER_%d\n#define HEADER_%d\n' % (i, i))
+        H.write('int header_%d(void);\n#endif\n' % i)
+        H.close()
+        F.write('#include "header%d.h"\n#include <header%d.h>\n' % (i, i))
+    F.close()
+    Inputs.append((FileName, Args))
+    return Inputs
+
+def benchmark(Clang, Args, Inputs, Repeat, Dir):
+    """Returns the result of each input in each mode, keyed by both."""
+    Empty = os.path.join(Dir, 'empty.c')
+    open(Empty, 'w').close()
+    Startup = {}
+    for Mode, ModeArgs in Modes:
+        Startup[Mode] = fastestRun(Clang, Args + ModeArgs + [Empty], Repeat)
+
+    Results = {}
+    for FileName, InputArgs in Inputs:
+        RawTokens, Tokens = countTokens(Clang, Args + InputArgs, FileName)
+        for Mode, ModeArgs in Modes:
+            Seconds = fastestRun(Clang, Args + InputArgs + ModeArgs +
+                                 [FileName], Repeat) - Startup[Mode]
+            Seconds = max(Seconds, 1e-6)
+            NumTokens = RawTokens if Mode == 'raw' else Tokens
+            Name = os.path.basename(FileName)
+            Results[(Name, Mode)] = {
+                'input': Name,
+                'mode': Mode,
+                'tokens': NumTokens,
+                'seconds': Seconds,
+                'tokens-per-second': NumTokens / Seconds}
+    return Results
+
+def readResults(FileName):
+    Results = {}
+    for Row in csv.DictReader(open(FileName, 'rb')):
+        Row['tokens'] = int(Row['tokens'])
+        for Key in ['seconds', 'tokens-per-second']:
+            Row[Key] = float(Row[Key])
+        Results[(Row['input'], Row['mode'])] = Row
+    return Results
+
+def writeResults(FileName, Results):
+    W = csv.DictWriter(open(FileName, 'wb'), Fields)
+    W.writerow(dict((F, F) for F in Fields))
+    for Key in sorted(Results):
+        W.writerow(Results[Key])
+
+def printResults(Results):
+    for Key in sorted(Results):
+        R = Results[Key]
+        print '%-30s %-6s %10d tokens %10.4f s %14.0f tokens/s' % \
+              (R['input'], R['mode'], R['tokens'], R['seconds'],
+               R['tokens-per-second'])
+
+def compare(Old, New, Threshold):
+    """Prints the differences between two runs and returns whether the
+    throughput of an input dropped by more than Threshold percent."""
+    Regressed = False
+    Limit = 1 - Threshold / 100.0
+    for Key in sorted(New):
+        if Key not in Old:
+            continue
+        O, N = Old[Key], New[Key]
+        OldSpeed, NewSpeed = O['tokens-per-second'], N['tokens-per-second']
+        print '%-30s %-6s %14.0f -> %14.0f tokens/s (%+.1f%%)' % \
+              (Key[0], Key[1], OldSpeed, NewSpeed,
+               (NewSpeed / OldSpeed - 1) * 100)
+        if NewSpeed < OldSpeed * Limit:
+            Regressed = True
+    return Regressed
+
+if __name__ == '__main__':
+    Parser = OptionParser(usage='%prog [options] files...')
+    Parser.add_option('--clang', dest='clang', default='clang',
+                      help='The clang binary to benchmark.')
+    Parser.add_option('--cc1-arg', dest='args', action='append', default=[],
+                      help='An extra -cc1 argument, such as an include path.')
+    Parser.add_option('--synthetic', dest='synthetic', action='store_true',
+                      default=False,
+                      help='Add the generated inputs to the given files.')
+    Parser.add_option('--scale', dest='scale', type='int', default=10,
+                      help='The size of the generated inputs.')
+    Parser.add_option('--repeat', dest='repeat', type='int', default=5,
+                      help='The number of runs to take the fastest time of.')
+    Parser.add_option('--baseline', dest='baseline',
+                      help='The CSV file of a previous run to compare to.')
+    Parser.add_option('--threshold', dest='threshold', type='float',
+                      default=5.0,
+                      help='The allowed regression, in percent.')
+    Parser.add_option('-o', dest='output', help='The CSV file to write.')
+    Opts, Files = Parser.parse_args()
+    if not Files and not Opts.synthetic:
+        Parser.error('no input files')
+
+    Dir = tempfile.mkdtemp(prefix='lex-benchmark-')
+    try:
+        Inputs = [(FileName, []) for FileName in Files]
+        if Opts.synthetic:
+            Inputs += writeSyntheticInputs(Dir, Opts.scale)
+        Results = benchmark(Opts.clang, Opts.args, Inputs, Opts.repeat, Dir)
+    finally:
+        shutil.rmtree(Dir)
+
+    if Opts.output:
+        writeResults(Opts.output, Results)
+
+    if Opts.baseline:
+        if compare(readResults(Opts.baseline), Results, Opts.threshold):
+            sys.exit(1)
+    else:
+        printResults(Results)
@@ -0,0 +1,77 @@
+#!/usr/bin/env python
+
+"""
+Script to merge the header profiles of many translation units.
+
+Each translation unit compiled with '-Xclang -header-profile-file -Xclang
+<file>.json' writes what each file it includes costs it: its bytes, raw
+tokens, top-level declarations and seconds, both on its own and with
+everything it includes. This script sums them over the translation units, and
+prints the files that cost the most, which are the first ones worth cleaning
+up or turning into modules:
+
+  MergeHeaderProfiles.py --sort=inclusive-seconds --limit=20 build/*.json
+  MergeHeaderProfiles.py -o merged.json build/*.json
+
+A merged profile can be merged again with other profiles.
+"""
+
+import json
+import sys
+from optparse import OptionParser
+
+Counters = ['inclusions', 'bytes', 'tokens', 'decls', 'seconds',
+            'inclusive-bytes', 'inclusive-tokens', 'inclusive-decls',
+            'inclusive-seconds']
+
+def mergeProfiles(FileNames):
+    """Returns the sums of the counters of each file, and the number of
+    translation units that included it, keyed by file name."""
+    Files = {}
+    for FileName in FileNames:
+        Profile = json.load(open(FileName))
+        for Entry in Profile['files']:
+            Total = Files.get(Entry['file'])
+            if Total is None:
+                Total = dict((C, 0) for C in Counters)
+                Total['file'] = Entry['file']
+                Total['translation-units'] = 0
+                Files[Entry['file']] = Total
+            for C in Counters:
+                Total[C] += Entry[C]
+            # A merged profile counts its translation units already.
+            Total['translation-units'] += Entry.get('translation-units', 1)
+    return Files
+
+def printTable(Files, Limit):
+    print '%-8s %10s %12s %10s %12s %12s  %s' % \
+          ('TUs', 'inclusions', 'incl. bytes', 'incl. decls', 'seconds',
+           'incl. secs', 'file')
+    for F in Files[:Limit]:
+        print '%-8d %10d %12d %10d %12.3f %12.3f  %s' % \
+              (F['translation-units'], F['inclusions'], F['inclusive-bytes'],
+               F['inclusive-decls'], F['seconds'], F['inclusive-seconds'],
+               F['file'])
+
+if __name__ == '__main__':
+    Parser = OptionParser(usage='%prog [options] profiles...')
+    Parser.add_option('--sort', dest='sort', default='inclusive-seconds',
+                      choices=Counters + ['translation-units'],
+                      help='The counter to sort the files by.')
+    Parser.add_option('--limit', dest='limit', type='int', default=50,
+                      help='The number of files to print.')
+    Parser.add_option('-o', dest='output',
+                      help='The file to write the merged profile to, as '
+                           'JSON, instead of printing it.')
+    Opts, Profiles = Parser.parse_args()
+    if not Profiles:
+        Parser.error('no profiles')
+
+    Files = mergeProfiles(Profiles).values()
+    Files.sort(key=lambda F: (-F[Opts.sort], F['file']))
+
+    if Opts.output:
+        json.dump({'files': Files}, open(Opts.output, 'w'), indent=2,
+                  sort_keys=True)
+    else:
+        printTable(Files, Opts.limit)
@@ -0,0 +1,145 @@
+#!/usr/bin/env python
+
+"""
+Script to measure the cost of the path-sensitive analysis of a corpus.
+
+The analyzer is run with '-analyzer-display-costs' on every file of the
+corpus, which should be preprocessed so that the results don't depend on the
+headers of the machine. The per-function costs are written as a CSV file,
+which can be used as the baseline of a later run:
+
+  SABenchmark.py --clang=<clang> -o new.csv corpus/*.i
+  SABenchmark.py --clang=<clang> --baseline=old.csv -o new.csv corpus/*.i
+
+When a baseline is given, the script prints the functions whose analysis got
+slower or created more nodes, and exits with 1 if the total time or node count
+regressed by more than the allowed threshold.
+"""
+
+import csv
+import re
+import subprocess
+import sys
+from optparse import OptionParser
+
+CostsRE = re.compile(r'^COSTS: (.*): explore-ms=([0-9.]+) report-ms=([0-9.]+) '
+                     r'nodes=([0-9]+) max-states=([0-9]+) exhausted=(yes|no)$')
+
+Fields = ['function', 'explore-ms', 'report-ms', 'nodes', 'max-states',
+          'exhausted']
+
+def analyzeFile(Clang, Args, FileName):
+    """Returns the costs of the functions of FileName, keyed by function."""
+    Cmd = [Clang, '-cc1', '-analyze', '-analyzer-display-costs'] + Args + \
+          [FileName]
+    P = subprocess.Popen(Cmd, stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+    _, Err = P.communicate()
+    if P.returncode != 0:
+        print >> sys.stderr, 'error: analyzing %s failed:\n%s' % (FileName, Err)
+        sys.exit(-1)
+
+    Costs = {}
+    for Line in Err.splitlines():
+        M = CostsRE.match(Line)
+        if not M:
+            continue
+        Costs[M.group(1)] = {
+            'function': M.group(1),
+            'explore-ms': float(M.group(2)),
+            'report-ms': float(M.group(3)),
+            'nodes': int(M.group(4)),
+            'max-states': int(M.group(5)),
+            'exhausted': M.group(6)}
+    return Costs
+
+def benchmark(Clang, Args, Files, Repeat):
+    """Analyzes every file Repeat times, keeping the fastest time of each
+    function; the node and state counts don't change between runs."""
+    Costs = {}
+    for FileName in Files:
+        for _ in range(Repeat):
+            for Name, C in analyzeFile(Clang, Args, FileName).items():
+                Old = Costs.get(Name)
+                if Old is None:
+                    Costs[Name] = C
+                    continue
+                for Key in ['explore-ms', 'report-ms']:
+                    Old[Key] = min(Old[Key], C[Key])
+    return Costs
+
+def readCosts(FileName):
+    Costs = {}
+    for Row in csv.DictReader(open(FileName, 'rb')):
+        for Key in ['explore-ms', 'report-ms']:
+            Row[Key] = float(Row[Key])
+        for Key in ['nodes', 'max-states']:
+            Row[Key] = int(Row[Key])
+        Costs[Row['function']] = Row
+    return Costs
+
+def writeCosts(FileName, Costs):
+    W = csv.DictWriter(open(FileName, 'wb'), Fields)
+    W.writerow(dict((F, F) for F in Fields))
+    for Name in sorted(Costs):
+        W.writerow(Costs[Name])
+
+def totals(Costs):
+    Time = sum(C['explore-ms'] + C['report-ms'] for C in Costs.values())
+    Nodes = sum(C['nodes'] for C in Costs.values())
+    Exhausted = len([C for C in Costs.values() if C['exhausted'] == 'yes'])
+    return Time, Nodes, Exhausted
+
+def compare(Old, New, Threshold):
+    """Prints the differences between two runs and returns whether the new
+    one regressed by more than Threshold percent."""
+    for Name in sorted(New):
+        if Name not in Old:
+            continue
+        O, N = Old[Name], New[Name]
+        if N['nodes'] > O['nodes'] or N['exhausted'] != O['exhausted']:
+            print '%s: nodes %d -> %d, exhausted %s -> %s' % \
+                  (Name, O['nodes'], N['nodes'], O['exhausted'],
+                   N['exhausted'])
+
+    OldTime, OldNodes, OldExhausted = totals(Old)
+    NewTime, NewNodes, NewExhausted = totals(New)
+    print 'Time %.3f ms -> %.3f ms' % (OldTime, NewTime)
+    print 'Nodes %d -> %d' % (OldNodes, NewNodes)
+    print 'Functions out of steps %d -> %d' % (OldExhausted, NewExhausted)
+
+    Limit = 1 + Threshold / 100.0
+    return NewTime > OldTime * Limit or NewNodes > OldNodes * Limit
+
+if __name__ == '__main__':
+    Parser = OptionParser(usage='%prog [options] files...')
+    Parser.add_option('--clang', dest='clang', default='clang',
+                      help='The clang binary to benchmark.')
+    Parser.add_option('--analyzer-arg', dest='args', action='append',
+                      default=[],
+                      help='An extra -cc1 argument, such as a checker.')
+    Parser.add_option('--repeat', dest='repeat', type='int', default=3,
+                      help='The number of runs to take the fastest time of.')
+    Parser.add_option('--baseline', dest='baseline',
+                      help='The CSV file of a previous run to compare to.')
+    Parser.add_option('--threshold', dest='threshold', type='float',
+                      default=5.0,
+                      help='The allowed regression, in percent.')
+    Parser.add_option('-o', dest='output', help='The CSV file to write.')
+    Opts, Files = Parser.parse_args()
+    if not Files:
+        Parser.error('no input files')
+
+    Args = Opts.args or ['-analyzer-checker=core,unix,deadcode']
+    Costs = benchmark(Opts.clang, Args, Files, Opts.repeat)
+    if Opts.output:
+        writeCosts(Opts.output, Costs)
+
+    if Opts.baseline:
+        if compare(readCosts(Opts.baseline), Costs, Opts.threshold):
+            sys.exit(1)
+    else:
+        Time, Nodes, Exhausted = totals(Costs)
+        print 'Functions %d' % len(Costs)
+        print 'Time %.3f ms' % Time
+        print 'Nodes %d' % Nodes
+        print 'Functions out of steps %d' % Exhausted